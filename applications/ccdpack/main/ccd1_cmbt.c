@@ -0,0 +1,398 @@
+/*
+*+
+*  Name:
+*     CCD1_CMBT
+
+*  Purpose:
+*     Combines a stack of data lines using multiple threads.
+
+*  Language:
+*     Starlink C, designed to be called from Fortran.
+
+*  Invocation:
+*     CALL CCD1_CMBT( ITYPE, UVAR, EL, NII, DATSTK, VARSTK, VARLIN,
+*                     IMETH, MINPIX, RESDAT, RESVAR, STATUS )
+
+*  Description:
+*     This routine combines a stack of NII lines of EL pixels each, as
+*     assembled by CCD1_DOMOS, into a single output line, using the
+*     MEAN or UNWEIGHTED MEDIAN (FASTMED) method. It gives the same
+*     results as the corresponding CCG1_CM1 and CCG1_CM3 routines, but
+*     the pixels are divided into blocks and each block is combined by
+*     a separate thread.
+*
+*     For the mean, each value is weighted by the reciprocal of its
+*     variance, taken from the variance stack if UVAR is .TRUE., or
+*     from the variance of its line otherwise. Output variances (the
+*     reciprocal of the sum of the weights) are returned if UVAR is
+*     .TRUE.. For the median, the central value is found by selection
+*     rather than by sorting, and the median of an even number of
+*     values is the mean of the two central values. An output pixel is
+*     set bad if fewer than MINPIX good input values contribute to it.
+*
+*     The number of threads is given by the CCDPACK_THREADS environment
+*     variable, and defaults to the number of processors. Small stacks
+*     are combined in the calling thread.
+
+*  Arguments:
+*     ITYPE = CHARACTER * ( * ) (Given)
+*        The processing data type, "_REAL" or "_DOUBLE".
+*     UVAR = LOGICAL (Given)
+*        Whether the variance stack is used for weighting (in which case
+*        output variances are generated). Must be .FALSE. for the
+*        median.
+*     EL = INTEGER (Given)
+*        The number of pixels in each line.
+*     NII = INTEGER (Given)
+*        The number of lines in the stack.
+*     DATSTK = INTEGER (Given)
+*        Pointer to the data stack, an array of ( EL, NII ) values.
+*     VARSTK = INTEGER (Given)
+*        Pointer to the variance stack, an array of ( EL, NII ) values.
+*        Only used if UVAR is .TRUE..
+*     VARLIN( NII ) = DOUBLE PRECISION (Given)
+*        The variance of each line. Only used for the mean if UVAR is
+*        .FALSE..
+*     IMETH = INTEGER (Given)
+*        The combination method, as described in CCD1_DOMOS. Must be 2
+*        (MEAN) or 11 (UNWEIGHTED MEDIAN).
+*     MINPIX = INTEGER (Given)
+*        The minimum number of contributing pixels.
+*     RESDAT = INTEGER (Given)
+*        Pointer to the returned line of EL combined data values.
+*     RESVAR = INTEGER (Given)
+*        Pointer to the returned line of EL combined variances. Only
+*        written if UVAR is .TRUE..
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+#include <stdlib.h>
+#include <string.h>
+#include "f77.h"
+#include "cnf.h"
+#include "sae_par.h"
+#include "prm_par.h"
+#include "mers.h"
+#include "star/thr.h"
+
+/* Stacks with fewer pixels in each line than this are combined in a
+   single thread. */
+#define CCD1_CMBT_MINTHR 4096
+
+/* The combination methods handled by this file. */
+#define CCD1_CMBT_MEAN 2
+#define CCD1_CMBT_FASTMED 11
+
+/* Data describing a job that combines one block of pixels. */
+typedef struct {
+   int dbl;              /* Double precision processing? */
+   int uvar;             /* Use the variance stack? */
+   size_t el;            /* No. of pixels in each stack line */
+   int nii;              /* No. of stack lines */
+   size_t p0;            /* Index of first pixel in block */
+   size_t p1;            /* Index of last pixel in block, plus one */
+   const void *datstk;   /* Data stack */
+   const void *varstk;   /* Variance stack */
+   const double *varlin; /* Variance of each line */
+   int imeth;            /* Combination method */
+   int minpix;           /* Min. no. of contributing pixels */
+   void *resdat;         /* Output data line */
+   void *resvar;         /* Output variance line */
+} Ccd1CmbtData;
+
+/* Prototypes for private functions defined in this file. */
+static double ccd1CmbtMedian( double *buf, int n );
+static void ccd1CmbtJob( void *job_data, int *status );
+
+F77_SUBROUTINE(ccd1_cmbt)( CHARACTER(ITYPE), LOGICAL(UVAR), INTEGER(EL),
+                           INTEGER(NII), INTEGER(DATSTK), INTEGER(VARSTK),
+                           DOUBLE_ARRAY(VARLIN), INTEGER(IMETH),
+                           INTEGER(MINPIX), INTEGER(RESDAT),
+                           INTEGER(RESVAR), INTEGER(STATUS)
+                           TRAIL(ITYPE) ) {
+   GENPTR_CHARACTER(ITYPE)
+   GENPTR_LOGICAL(UVAR)
+   GENPTR_INTEGER(EL)
+   GENPTR_INTEGER(NII)
+   GENPTR_INTEGER(DATSTK)
+   GENPTR_INTEGER(VARSTK)
+   GENPTR_DOUBLE_ARRAY(VARLIN)
+   GENPTR_INTEGER(IMETH)
+   GENPTR_INTEGER(MINPIX)
+   GENPTR_INTEGER(RESDAT)
+   GENPTR_INTEGER(RESVAR)
+   GENPTR_INTEGER(STATUS)
+
+/* Local Variables: */
+   Ccd1CmbtData *data;
+   Ccd1CmbtData *job_data;
+   ThrWorkForce *wf = NULL;
+   char type[ 16 ];
+   int ijob;
+   int njob;
+   size_t el;
+
+/* Check the inherited status. */
+   if( *STATUS != SAI__OK ) return;
+   if( *EL <= 0 || *NII <= 0 ) return;
+   el = (size_t) *EL;
+
+   cnfImprt( ITYPE, ITYPE_length, type );
+   if( strcmp( type, "_REAL" ) && strcmp( type, "_DOUBLE" ) ) {
+      *STATUS = SAI__ERROR;
+      msgSetc( "TYPE", type );
+      errRep( "CCD1_CMBT_TYPE", "CCD1_CMBT: Unsupported processing data "
+              "type ^TYPE (programming error).", STATUS );
+      return;
+   }
+
+   if( *IMETH != CCD1_CMBT_MEAN && ( *IMETH != CCD1_CMBT_FASTMED ||
+                                     F77_ISTRUE( *UVAR ) ) ) {
+      *STATUS = SAI__ERROR;
+      msgSeti( "METH", *IMETH );
+      errRep( "CCD1_CMBT_METH", "CCD1_CMBT: Unsupported combination "
+              "method ^METH (programming error).", STATUS );
+      return;
+   }
+
+/* Decide how many blocks to use. A few blocks are used for each thread
+   so that the loads are balanced, but each block contains at least a
+   quarter of the minimum number of pixels. */
+   njob = 1;
+   if( el >= CCD1_CMBT_MINTHR ) {
+      wf = thrGetWorkforce( thrGetNThread( "CCDPACK_THREADS", STATUS ),
+                            STATUS );
+      if( wf ) njob = 4*wf->nworker;
+      if( (size_t) njob > el/( CCD1_CMBT_MINTHR/4 ) ) {
+         njob = (int)( el/( CCD1_CMBT_MINTHR/4 ) );
+      }
+      if( njob < 1 ) njob = 1;
+   }
+
+   job_data = malloc( njob*sizeof( *job_data ) );
+   if( !job_data ) {
+      *STATUS = SAI__ERROR;
+      errRep( "CCD1_CMBT_MEM", "CCD1_CMBT: Unable to allocate memory.",
+              STATUS );
+      return;
+   }
+
+/* Combine each block of pixels. */
+   for( ijob = 0; ijob < njob && *STATUS == SAI__OK; ijob++ ) {
+      data = job_data + ijob;
+      data->dbl = !strcmp( type, "_DOUBLE" );
+      data->uvar = F77_ISTRUE( *UVAR );
+      data->el = el;
+      data->nii = *NII;
+      data->p0 = ( ijob*el )/njob;
+      data->p1 = ( ( ijob + 1 )*el )/njob;
+      data->datstk = cnfCptr( *DATSTK );
+      data->varstk = data->uvar ? cnfCptr( *VARSTK ) : NULL;
+      data->varlin = VARLIN;
+      data->imeth = *IMETH;
+      data->minpix = *MINPIX;
+      data->resdat = cnfCptr( *RESDAT );
+      data->resvar = data->uvar ? cnfCptr( *RESVAR ) : NULL;
+      thrAddJob( wf, 0, data, ccd1CmbtJob, 0, NULL, STATUS );
+   }
+   thrWait( wf, STATUS );
+
+   free( job_data );
+}
+
+/* Combine the pixels from data->p0 to data->p1 - 1. This is run in a
+   worker thread. */
+static void ccd1CmbtJob( void *job_data, int *status ) {
+   Ccd1CmbtData *data;
+   const double *dd;
+   const double *dv;
+   const float *rd;
+   const float *rv;
+   double *buf = NULL;
+   double *wlin = NULL;
+   double sum;
+   double sumw;
+   double v;
+   double var;
+   double w;
+   int i;
+   int ngood;
+   size_t ip;
+   size_t k;
+
+   if( *status != SAI__OK ) return;
+   data = (Ccd1CmbtData *) job_data;
+
+   rd = (const float *) data->datstk;
+   dd = (const double *) data->datstk;
+   rv = (const float *) data->varstk;
+   dv = (const double *) data->varstk;
+
+/* The median needs the values for one output pixel, and the mean
+   without a variance stack needs the weight of each line. */
+   buf = malloc( data->nii*sizeof( *buf ) );
+   wlin = malloc( data->nii*sizeof( *wlin ) );
+   if( !buf || !wlin ) {
+      *status = SAI__ERROR;
+      errRep( "CCD1_CMBT_MEM", "CCD1_CMBT: Unable to allocate memory.",
+              status );
+      goto CLEANUP;
+   }
+
+   if( !data->uvar ) {
+      for( i = 0; i < data->nii; i++ ) {
+         wlin[ i ] = ( data->varlin[ i ] > 0.0 ) ?
+                     1.0/data->varlin[ i ] : 0.0;
+      }
+   }
+
+/* Loop round each output pixel in the block. The stack lines are only
+   read contiguously along each line, which is where neighbouring
+   output pixels find their values. */
+   for( ip = data->p0; ip < data->p1; ip++ ) {
+      ngood = 0;
+      sum = 0.0;
+      sumw = 0.0;
+
+      for( i = 0; i < data->nii; i++ ) {
+         k = i*data->el + ip;
+         if( data->dbl ) {
+            if( dd[ k ] == VAL__BADD ) continue;
+            v = dd[ k ];
+         } else {
+            if( rd[ k ] == VAL__BADR ) continue;
+            v = rd[ k ];
+         }
+
+         if( data->imeth == CCD1_CMBT_FASTMED ) {
+            buf[ ngood++ ] = v;
+
+/* Values with bad or non-positive variances do not contribute to the
+   weighted mean. */
+         } else {
+            if( data->uvar ) {
+               if( data->dbl ) {
+                  var = ( dv[ k ] != VAL__BADD ) ? dv[ k ] : 0.0;
+               } else {
+                  var = ( rv[ k ] != VAL__BADR ) ? rv[ k ] : 0.0;
+               }
+               if( var <= 0.0 ) continue;
+               w = 1.0/var;
+            } else {
+               w = wlin[ i ];
+               if( w == 0.0 ) continue;
+            }
+            sum += w*v;
+            sumw += w;
+            ngood++;
+         }
+      }
+
+/* Form the result. */
+      if( ngood < data->minpix || ngood == 0 ) {
+         v = VAL__BADD;
+         var = VAL__BADD;
+      } else if( data->imeth == CCD1_CMBT_FASTMED ) {
+         v = ccd1CmbtMedian( buf, ngood );
+         var = VAL__BADD;
+      } else {
+         v = sum/sumw;
+         var = 1.0/sumw;
+      }
+
+      if( data->dbl ) {
+         ( (double *) data->resdat )[ ip ] = v;
+         if( data->uvar ) ( (double *) data->resvar )[ ip ] = var;
+      } else {
+         ( (float *) data->resdat )[ ip ] = ( v != VAL__BADD ) ?
+                                            (float) v : VAL__BADR;
+         if( data->uvar ) {
+            ( (float *) data->resvar )[ ip ] = ( var != VAL__BADD ) ?
+                                               (float) var : VAL__BADR;
+         }
+      }
+   }
+
+CLEANUP:
+   free( buf );
+   free( wlin );
+}
+
+/* Return the median of the "n" values in "buf" (n > 0), which are
+   re-ordered. The central value is found using Wirth's selection
+   algorithm. */
+static double ccd1CmbtMedian( double *buf, int n ) {
+   double result;
+   double t;
+   double x;
+   int i;
+   int j;
+   int k;
+   int l;
+   int m;
+
+   k = n/2;
+   l = 0;
+   m = n - 1;
+   while( l < m ) {
+      x = buf[ k ];
+      i = l;
+      j = m;
+      do {
+         while( buf[ i ] < x ) i++;
+         while( x < buf[ j ] ) j--;
+         if( i <= j ) {
+            t = buf[ i ];
+            buf[ i ] = buf[ j ];
+            buf[ j ] = t;
+            i++;
+            j--;
+         }
+      } while( i <= j );
+      if( j < k ) l = i;
+      if( k < i ) m = j;
+   }
+   result = buf[ k ];
+
+/* For an even number of values, the other central value is the largest
+   of the values below element k. */
+   if( n % 2 == 0 ) {
+      t = buf[ 0 ];
+      for( i = 1; i < k; i++ ) {
+         if( buf[ i ] > t ) t = buf[ i ];
+      }
+      result = 0.5*( result + t );
+   }
+
+   return result;
+}
@@ -334,6 +334,10 @@
 *        if the first chunk had no contributing pixels.  Think I've done
 *        this correctly, but it is slightly surprising that it hasn't
 *        been spotted before.
+*     14-OCT-2026:
+*        Combine with the MEAN and FASTMED methods using CCD1_CMBT,
+*        which divides the pixels of each interval between multiple
+*        threads.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -450,6 +454,7 @@
       LOGICAL UVAR              ! Use variances for weighting?
       LOGICAL VAR               ! Input NDF has variance information?
       LOGICAL EVAR              ! Create variances from data
+      LOGICAL FAST              ! Combine using CCD1_CMBT?
 
 *.
 
@@ -897,9 +902,24 @@
 
 *  Combine input data for the current interval.
 *  ===========================================
-*  Allocate workspace for combining the input data.
+*  Allocate space for the results.
                         CALL PSX_CALLOC( EL, ITYPE1, RESDAT, STATUS )
                         CALL PSX_CALLOC( EL, ITYPE1, RESVAR, STATUS )
+
+*  The weighted mean, and the unweighted median of data without
+*  variances, are formed by CCD1_CMBT, which divides the pixels
+*  between multiple threads.
+                        FAST = IMETH .EQ. 2 .OR.
+     :                         ( IMETH .EQ. 11 .AND. .NOT. UVAR )
+                        IF ( FAST ) THEN
+                           CALL CCD1_CMBT( ITYPE1, UVAR, EL, NII,
+     :                                     DATSTK, VARSTK, VARLIN,
+     :                                     IMETH, MINPIX, RESDAT,
+     :                                     RESVAR, STATUS )
+                           GO TO 97
+                        END IF
+
+*  Allocate workspace for the other combination methods.
                         CALL PSX_CALLOC( NII, ITYPE1, WRK1, STATUS )
                         CALL PSX_CALLOC( NII, ITYPE1, WRK2, STATUS )
                         IF ( UVAR ) THEN
@@ -989,6 +1009,18 @@
                            END IF
                         END IF
 
+*  Release the workspace.
+                        CALL PSX_FREE( WRK1, STATUS )
+                        CALL PSX_FREE( WRK2, STATUS )
+                        IF ( UVAR ) THEN
+                           CALL PSX_FREE( WRK3, STATUS )
+                           CALL PSX_FREE( WRK4, STATUS )
+                        END IF
+                        CALL PSX_FREE( WRK5, STATUS )
+                        CALL PSX_FREE( WRK6, STATUS )
+                        CALL PSX_FREE( WRK7, STATUS )
+ 97                     CONTINUE
+
 *  Generate estimated variances, if required.
                         IF ( EVAR ) THEN
                            IF ( ITYPE1 .EQ. '_REAL' ) THEN
@@ -1013,18 +1045,9 @@
                         END IF
 
 
-*  Release the workspace.
+*  Release the input stacks.
                         CALL PSX_FREE( DATSTK, STATUS )
                         IF ( UVAR ) CALL PSX_FREE( VARSTK, STATUS )
-                        CALL PSX_FREE( WRK1, STATUS )
-                        CALL PSX_FREE( WRK2, STATUS )
-                        IF ( UVAR ) THEN
-                           CALL PSX_FREE( WRK3, STATUS )
-                           CALL PSX_FREE( WRK4, STATUS )
-                        END IF
-                        CALL PSX_FREE( WRK5, STATUS )
-                        CALL PSX_FREE( WRK6, STATUS )
-                        CALL PSX_FREE( WRK7, STATUS )
 
 *  After combined results have been obtained for each interval, copy
 *  them into the appropriate part of the mapped output array(s). No
@@ -0,0 +1,631 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "f77.h"
+#include "sae_par.h"
+#include "prm_par.h"
+#include "mers.h"
+#include "star/thr.h"
+
+/* The number of offset voting cells whose candidate offsets are tested,
+   and the maximum number of candidates that are tested in each. */
+#define NPEAK 4
+#define MAXCAND 64
+
+/* The maximum number of cells in the offset voting table. */
+#define MAXCELL 33554432
+
+/* Marks an unused entry in the voting table. */
+#define EMPTY INT64_MIN
+
+/* A cell in the offset voting table. */
+typedef struct {
+   int64_t key;
+   int count;
+} Ccd1GoffVote;
+
+/* A first list position and the key of the grid cell holding it. */
+typedef struct {
+   int64_t key;
+   int index;
+} Ccd1GoffCell;
+
+/* The positions of the first list, sorted into square cells whose side
+   is the position error. */
+typedef struct {
+   const double *x;
+   const double *y;
+   int n;
+   double xmin;
+   double ymin;
+   double cell;
+   Ccd1GoffCell *cells;
+} Ccd1GoffGrid;
+
+/* A candidate offset and the result of testing it. */
+typedef struct {
+   double xoff;
+   double yoff;
+   int ncon;
+   double rms;
+} Ccd1GoffCand;
+
+/* Data for a job that tests a range of candidate offsets. */
+typedef struct {
+   const Ccd1GoffGrid *grid;
+   const double *x2;
+   const double *y2;
+   int n2;
+   double error;
+   Ccd1GoffCand *cand;
+   int ncand;
+} Ccd1GoffJob;
+
+/* Prototypes for private functions defined in this file. */
+static int ccd1GoffLook( const Ccd1GoffGrid *grid, double x, double y,
+                         double error, int strict, double *dev2 );
+static int64_t ccd1GoffKey( int64_t ix, int64_t iy );
+static int ccd1GoffCmp( const void *a, const void *b );
+static size_t ccd1GoffHash( int64_t key, size_t mask );
+static Ccd1GoffVote *ccd1GoffFind( Ccd1GoffVote *table, size_t mask,
+                                   int64_t key, int add );
+static void ccd1GoffTest( void *job_data, int *status );
+
+   F77_SUBROUTINE(ccd1_goff)( DOUBLE(error), DOUBLE(maxdis),
+                              DOUBLE_ARRAY(xin1), DOUBLE_ARRAY(yin1),
+                              INTEGER_ARRAY(indi1), INTEGER(nrec1),
+                              DOUBLE_ARRAY(xin2), DOUBLE_ARRAY(yin2),
+                              INTEGER_ARRAY(indi2), INTEGER(nrec2),
+                              DOUBLE_ARRAY(xout1), DOUBLE_ARRAY(yout1),
+                              DOUBLE_ARRAY(xout2), DOUBLE_ARRAY(yout2),
+                              INTEGER(nout), DOUBLE(xoff), DOUBLE(yoff),
+                              INTEGER_ARRAY(indo1), INTEGER_ARRAY(indo2),
+                              INTEGER(status) ) {
+
+/*
+*+
+*  Name:
+*     CCD1_GOFF
+
+*  Purpose:
+*     Finds the positions which are consistent with a simple offset,
+*     using offset voting.
+
+*  Language:
+*     ANSI C.
+
+*  Invocation:
+*     CALL CCD1_GOFF( ERROR, MAXDIS, XIN1, YIN1, INDI1, NREC1, XIN2,
+*                     YIN2, INDI2, NREC2, XOUT1, YOUT1, XOUT2, YOUT2,
+*                     NOUT, XOFF, YOFF, INDO1, INDO2, STATUS )
+
+*  Description:
+*     This routine does the same job as CCD1_SOFF. It uses two sets of
+*     X and Y positions and determines the most likely X and Y
+*     translation between them, returning the positions which
+*     correspond to this match and the offset from the second positions
+*     to the first positions. The translation selected is, as in
+*     CCD1_SOFF, the offset between a pair of positions which brings the
+*     largest number of second list positions within a box of side
+*     ERROR of a first list position, the one with the smallest
+*     deviation sum being chosen if there is more than one.
+*
+*     Rather than testing the offset of every pair of positions, the
+*     offsets of all pairs are first binned into a table of cells of
+*     side ERROR. The offsets of true matches pile up in one part of
+*     this table, so only the pairs in the few most populated parts
+*     are tested. Each test locates the first list positions near to
+*     the second list positions using a grid of cells of side ERROR, so
+*     it takes a time proportional to NREC2 rather than NREC1 * NREC2.
+*     The tests are divided between the threads of the CCDPACK_THREADS
+*     workforce. No workspace needs to be supplied.
+*
+*     Each second list position is paired with the nearest first list
+*     position that lies within the error box.
+
+*  Arguments:
+*     ERROR = DOUBLE PRECISION (Given)
+*        The error in the positions. Must be positive.
+*     MAXDIS = DOUBLE PRECISION (Given)
+*        The maximum acceptable displacement in pixels between two
+*        frames.  If an object match requires a displacement greater
+*        than this it will be rejected.  If it is set to zero, there
+*        are no restrictions.
+*     XIN1( NREC1 ) = DOUBLE PRECISION (Given)
+*        First set of X positions.
+*     YIN1( NREC1 ) = DOUBLE PRECISION (Given)
+*        First set of Y positions.
+*     INDI1( NREC1 ) = INTEGER (Given)
+*        Indices for each of the points in the first set.
+*     NREC1 = INTEGER (Given)
+*        The number of values given in the XIN1 and YIN1 arrays.
+*     XIN2( NREC2 ) = DOUBLE PRECISION (Given)
+*        Second set of X positions.
+*     YIN2( NREC2 ) = DOUBLE PRECISION (Given)
+*        Second set of Y positions.
+*     INDI2( NREC2 ) = INTEGER (Given)
+*        Indices for each of the points in the second set.
+*     NREC2 = INTEGER (Given)
+*        The number of values given in the XIN2 and YIN2 arrays.
+*     XOUT1( * ) = DOUBLE PRECISION (Returned)
+*        X values selected from first set of input X positions.
+*        The size of this array should be at least NREC2.
+*     YOUT1( * ) = DOUBLE PRECISION (Returned)
+*        Y values selected from first set of input Y positions.
+*        The size of this array should be at least NREC2.
+*     XOUT2( * ) = DOUBLE PRECISION (Returned)
+*        X values selected from second set of input X positions.
+*        The size of this array should be at least NREC2.
+*     YOUT2( * ) = DOUBLE PRECISION (Returned)
+*        Y values selected from second set of input Y positions.
+*        The size of this array should be at least NREC2.
+*     NOUT = INTEGER (Returned)
+*        The number of matched positions.
+*     XOFF = DOUBLE PRECISION (Returned)
+*        The offset in X which was selected.
+*     YOFF = DOUBLE PRECISION (Returned)
+*        The offset in Y which was selected.
+*     INDO1( * ) = INTEGER (Returned)
+*        The indices in the input X and Y arrays of the selected
+*        positions. Should be the same size as XOUT1.
+*     INDO2( * ) = INTEGER (Returned)
+*        The indices in the input X and Y arrays of the selected
+*        positions. Should be the same size as XOUT2.
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+      GENPTR_DOUBLE(error)
+      GENPTR_DOUBLE(maxdis)
+      GENPTR_DOUBLE_ARRAY(xin1)
+      GENPTR_DOUBLE_ARRAY(yin1)
+      GENPTR_INTEGER_ARRAY(indi1)
+      GENPTR_INTEGER(nrec1)
+      GENPTR_DOUBLE_ARRAY(xin2)
+      GENPTR_DOUBLE_ARRAY(yin2)
+      GENPTR_INTEGER_ARRAY(indi2)
+      GENPTR_INTEGER(nrec2)
+      GENPTR_DOUBLE_ARRAY(xout1)
+      GENPTR_DOUBLE_ARRAY(yout1)
+      GENPTR_DOUBLE_ARRAY(xout2)
+      GENPTR_DOUBLE_ARRAY(yout2)
+      GENPTR_INTEGER(nout)
+      GENPTR_DOUBLE(xoff)
+      GENPTR_DOUBLE(yoff)
+      GENPTR_INTEGER_ARRAY(indo1)
+      GENPTR_INTEGER_ARRAY(indo2)
+      GENPTR_INTEGER(status)
+
+/* Local Variables: */
+      Ccd1GoffCand *cand = NULL;
+      Ccd1GoffGrid grid;
+      Ccd1GoffJob *jobs = NULL;
+      Ccd1GoffVote *peak[ NPEAK ];
+      Ccd1GoffVote *table = NULL;
+      Ccd1GoffVote *v;
+      ThrWorkForce *wf = NULL;
+      double best;
+      double cell;
+      double d2max;
+      double dev2;
+      double dx;
+      double dy;
+      double ncell;
+      double xhi1, xhi2, xlo1, xlo2;
+      double yhi1, yhi2, ylo1, ylo2;
+      int dix;
+      int diy;
+      int i;
+      int ibest;
+      int ijob;
+      int ip;
+      int j;
+      int k;
+      int ncand;
+      int nc[ NPEAK ];
+      int njob;
+      int score;
+      int scores[ NPEAK ];
+      int64_t ix;
+      int64_t iy;
+      int64_t key;
+      size_t itab;
+      size_t mask;
+      size_t npair;
+      size_t ntab;
+
+/* Check inherited global status. */
+      if ( *status != SAI__OK ) return;
+
+      grid.cells = NULL;
+
+      if ( *error <= 0.0 ) {
+         *status = SAI__ERROR;
+         errRep( "CCD1_GOFF_ERR", "  The position error must be positive",
+                 status );
+         goto cleanup;
+      }
+      if ( *nrec1 <= 0 || *nrec2 <= 0 ) goto nomatch;
+
+/* Set the maximum acceptable displacement squared. */
+      d2max = ( *maxdis == 0.0 ) ? VAL__MAXD :
+              ( *maxdis + *error ) * ( *maxdis + *error );
+
+/* Sort the first list into cells of side ERROR, so that the positions
+   near to any point can be located quickly. */
+      xlo1 = xhi1 = xin1[ 0 ];
+      ylo1 = yhi1 = yin1[ 0 ];
+      for ( i = 1; i < *nrec1; i++ ) {
+         if ( xin1[ i ] < xlo1 ) xlo1 = xin1[ i ];
+         if ( xin1[ i ] > xhi1 ) xhi1 = xin1[ i ];
+         if ( yin1[ i ] < ylo1 ) ylo1 = yin1[ i ];
+         if ( yin1[ i ] > yhi1 ) yhi1 = yin1[ i ];
+      }
+      xlo2 = xhi2 = xin2[ 0 ];
+      ylo2 = yhi2 = yin2[ 0 ];
+      for ( i = 1; i < *nrec2; i++ ) {
+         if ( xin2[ i ] < xlo2 ) xlo2 = xin2[ i ];
+         if ( xin2[ i ] > xhi2 ) xhi2 = xin2[ i ];
+         if ( yin2[ i ] < ylo2 ) ylo2 = yin2[ i ];
+         if ( yin2[ i ] > yhi2 ) yhi2 = yin2[ i ];
+      }
+
+      grid.x = xin1;
+      grid.y = yin1;
+      grid.n = *nrec1;
+      grid.xmin = xlo1;
+      grid.ymin = ylo1;
+      grid.cell = *error;
+      grid.cells = malloc( *nrec1 * sizeof( *grid.cells ) );
+      if ( !grid.cells ) goto nomem;
+      for ( i = 0; i < *nrec1; i++ ) {
+         grid.cells[ i ].key =
+            ccd1GoffKey( (int64_t) ( ( xin1[ i ] - xlo1 ) / *error ),
+                         (int64_t) ( ( yin1[ i ] - ylo1 ) / *error ) );
+         grid.cells[ i ].index = i;
+      }
+      qsort( grid.cells, *nrec1, sizeof( *grid.cells ), ccd1GoffCmp );
+
+/* Choose the size of the offset voting cells. This is normally ERROR,
+   but it is increased if that would need too large a table. */
+      npair = (size_t) *nrec1 * (size_t) *nrec2;
+      cell = *error;
+      for ( ;; ) {
+         ncell = ( ( xhi1 - xlo2 - xlo1 + xhi2 ) / cell + 3.0 ) *
+                 ( ( yhi1 - ylo2 - ylo1 + yhi2 ) / cell + 3.0 );
+         if ( ncell > (double) npair ) ncell = (double) npair;
+         if ( ncell <= MAXCELL ) break;
+         cell *= 2.0;
+      }
+      ntab = 16;
+      while ( (double) ntab < 2.0 * ncell ) ntab *= 2;
+      mask = ntab - 1;
+
+      table = malloc( ntab * sizeof( *table ) );
+      if ( !table ) goto nomem;
+      for ( itab = 0; itab < ntab; itab++ ) {
+         table[ itab ].key = EMPTY;
+         table[ itab ].count = 0;
+      }
+
+/* Vote for the offset of every pair of positions. */
+      for ( j = 0; j < *nrec2; j++ ) {
+         for ( i = 0; i < *nrec1; i++ ) {
+            dx = xin1[ i ] - xin2[ j ];
+            dy = yin1[ i ] - yin2[ j ];
+            if ( dx * dx + dy * dy > d2max ) continue;
+            ix = (int64_t) floor( dx / cell );
+            iy = (int64_t) floor( dy / cell );
+            v = ccd1GoffFind( table, mask, ccd1GoffKey( ix, iy ), 1 );
+            v->count++;
+         }
+      }
+
+/* Find the cells with the most votes in the surrounding 3x3 block of
+   cells, since the offsets of a true match are spread over a box of
+   side twice the error. */
+      for ( ip = 0; ip < NPEAK; ip++ ) {
+         peak[ ip ] = NULL;
+         scores[ ip ] = 0;
+      }
+      for ( itab = 0; itab < ntab; itab++ ) {
+         if ( table[ itab ].key == EMPTY ) continue;
+         ix = table[ itab ].key >> 32;
+         iy = (int32_t) ( table[ itab ].key & 0xFFFFFFFF );
+         score = 0;
+         for ( dix = -1; dix <= 1; dix++ ) {
+            for ( diy = -1; diy <= 1; diy++ ) {
+               v = ccd1GoffFind( table, mask,
+                                 ccd1GoffKey( ix + dix, iy + diy ), 0 );
+               if ( v ) score += v->count;
+            }
+         }
+         for ( ip = NPEAK - 1; ip >= 0 && score > scores[ ip ]; ip-- ) {
+            if ( ip < NPEAK - 1 ) {
+               peak[ ip + 1 ] = peak[ ip ];
+               scores[ ip + 1 ] = scores[ ip ];
+            }
+            peak[ ip ] = table + itab;
+            scores[ ip ] = score;
+         }
+      }
+
+/* Gather the offsets of the pairs that lie in the voting cells found
+   above, keeping the order of the pairs so that ties are resolved in
+   the same way on every run. */
+      cand = malloc( NPEAK * MAXCAND * sizeof( *cand ) );
+      if ( !cand ) goto nomem;
+      for ( ip = 0; ip < NPEAK; ip++ ) nc[ ip ] = 0;
+      for ( j = 0; j < *nrec2; j++ ) {
+         for ( i = 0; i < *nrec1; i++ ) {
+            dx = xin1[ i ] - xin2[ j ];
+            dy = yin1[ i ] - yin2[ j ];
+            if ( dx * dx + dy * dy > d2max ) continue;
+            key = ccd1GoffKey( (int64_t) floor( dx / cell ),
+                               (int64_t) floor( dy / cell ) );
+            for ( ip = 0; ip < NPEAK; ip++ ) {
+               if ( peak[ ip ] && peak[ ip ]->key == key &&
+                    nc[ ip ] < MAXCAND ) {
+                  k = ip * MAXCAND + nc[ ip ]++;
+                  cand[ k ].xoff = dx;
+                  cand[ k ].yoff = dy;
+                  cand[ k ].ncon = 0;
+                  cand[ k ].rms = VAL__MAXD;
+               }
+            }
+         }
+      }
+
+/* Pack the candidates together. */
+      ncand = 0;
+      for ( ip = 0; ip < NPEAK; ip++ ) {
+         for ( k = 0; k < nc[ ip ]; k++ ) {
+            cand[ ncand++ ] = cand[ ip * MAXCAND + k ];
+         }
+      }
+      if ( ncand == 0 ) goto nomatch;
+
+/* Test the candidates, dividing them between the threads. */
+      njob = 1;
+      if ( (double) ncand * (double) *nrec2 > 100000.0 ) {
+         wf = thrGetWorkforce( thrGetNThread( "CCDPACK_THREADS", status ),
+                               status );
+         if ( wf ) njob = wf->nworker;
+         if ( njob > ncand ) njob = ncand;
+      }
+      jobs = malloc( njob * sizeof( *jobs ) );
+      if ( !jobs ) goto nomem;
+      for ( ijob = 0; ijob < njob && *status == SAI__OK; ijob++ ) {
+         jobs[ ijob ].grid = &grid;
+         jobs[ ijob ].x2 = xin2;
+         jobs[ ijob ].y2 = yin2;
+         jobs[ ijob ].n2 = *nrec2;
+         jobs[ ijob ].error = *error;
+         jobs[ ijob ].cand = cand + ( ijob * ncand ) / njob;
+         jobs[ ijob ].ncand = ( ( ijob + 1 ) * ncand ) / njob -
+                              ( ijob * ncand ) / njob;
+         thrAddJob( wf, 0, jobs + ijob, ccd1GoffTest, 0, NULL, status );
+      }
+      thrWait( wf, status );
+      if ( *status != SAI__OK ) goto cleanup;
+
+/* Select the candidate with the most matches, and the smallest
+   deviations among those. At least two matches are needed. */
+      ibest = -1;
+      best = VAL__MAXD;
+      for ( k = 0; k < ncand; k++ ) {
+         if ( cand[ k ].ncon < 2 ) continue;
+         if ( ibest < 0 || cand[ k ].ncon > cand[ ibest ].ncon ||
+              ( cand[ k ].ncon == cand[ ibest ].ncon &&
+                cand[ k ].rms < best ) ) {
+            ibest = k;
+            best = cand[ k ].rms;
+         }
+      }
+      if ( ibest < 0 ) goto nomatch;
+
+/* Re-select the positions which are associated with the chosen
+   translation. */
+      *xoff = cand[ ibest ].xoff;
+      *yoff = cand[ ibest ].yoff;
+      *nout = 0;
+      for ( j = 0; j < *nrec2; j++ ) {
+         i = ccd1GoffLook( &grid, xin2[ j ] + *xoff, yin2[ j ] + *yoff,
+                           *error, 0, &dev2 );
+         if ( i >= 0 ) {
+            xout1[ *nout ] = xin1[ i ];
+            yout1[ *nout ] = yin1[ i ];
+            xout2[ *nout ] = xin2[ j ];
+            yout2[ *nout ] = yin2[ j ];
+            indo1[ *nout ] = indi1[ i ];
+            indo2[ *nout ] = indi2[ j ];
+            ( *nout )++;
+         }
+      }
+      goto cleanup;
+
+/* No translation has been selected. */
+nomatch:
+      *status = SAI__ERROR;
+      errRep( "CCD1_GOFF_NOM", "  The positions are not related by a "
+              "determinable translation (with the given error)", status );
+      goto cleanup;
+
+nomem:
+      *status = SAI__ERROR;
+      errRep( "CCD1_GOFF_MEM", "  Unable to allocate workspace for "
+              "position matching", status );
+
+cleanup:
+      free( jobs );
+      free( cand );
+      free( table );
+      free( grid.cells );
+   }
+
+/* Test the candidate offsets for one job. Each second list position is
+   counted once, if a first list position lies within the error box
+   around its offset position. */
+   static void ccd1GoffTest( void *job_data, int *status ) {
+      Ccd1GoffJob *job = (Ccd1GoffJob *) job_data;
+      Ccd1GoffCand *c;
+      double dev2;
+      double sum;
+      int j;
+      int k;
+
+      if ( *status != SAI__OK ) return;
+
+      for ( k = 0; k < job->ncand; k++ ) {
+         c = job->cand + k;
+         c->ncon = 0;
+         sum = 0.0;
+         for ( j = 0; j < job->n2; j++ ) {
+            if ( ccd1GoffLook( job->grid, job->x2[ j ] + c->xoff,
+                               job->y2[ j ] + c->yoff, job->error, 1,
+                               &dev2 ) >= 0 ) {
+               c->ncon++;
+               sum += dev2;
+            }
+         }
+         c->rms = ( c->ncon > 1 ) ? sum / ( c->ncon - 1 ) : VAL__MAXD;
+      }
+   }
+
+/* Return the index of the first list position nearest to (x,y) that
+   lies within a box of half-side "error" (exclusive if "strict" is
+   set), or -1 if there is none. The squared distance is returned in
+   "dev2". */
+   static int ccd1GoffLook( const Ccd1GoffGrid *grid, double x, double y,
+                            double error, int strict, double *dev2 ) {
+      double d2;
+      double dx;
+      double dy;
+      double fx;
+      double fy;
+      int i;
+      int ibest = -1;
+      int lo, hi, mid;
+      int64_t cx;
+      int64_t cy;
+      int64_t ix;
+      int64_t iy;
+      int64_t key;
+
+      fx = ( x - grid->xmin ) / grid->cell;
+      fy = ( y - grid->ymin ) / grid->cell;
+      if ( fx < -1.0 || fy < -1.0 || fx > 2147483647.0 ||
+           fy > 2147483647.0 ) return -1;
+      cx = (int64_t) floor( fx );
+      cy = (int64_t) floor( fy );
+
+      *dev2 = VAL__MAXD;
+      for ( ix = cx - 1; ix <= cx + 1; ix++ ) {
+         if ( ix < 0 ) continue;
+         for ( iy = cy - 1; iy <= cy + 1; iy++ ) {
+            if ( iy < 0 ) continue;
+            key = ccd1GoffKey( ix, iy );
+
+/* Find the first position in this cell. */
+            lo = 0;
+            hi = grid->n;
+            while ( lo < hi ) {
+               mid = lo + ( hi - lo ) / 2;
+               if ( grid->cells[ mid ].key < key ) {
+                  lo = mid + 1;
+               } else {
+                  hi = mid;
+               }
+            }
+
+            for ( ; lo < grid->n && grid->cells[ lo ].key == key; lo++ ) {
+               i = grid->cells[ lo ].index;
+               dx = fabs( grid->x[ i ] - x );
+               dy = fabs( grid->y[ i ] - y );
+               if ( strict ? ( dx < error && dy < error ) :
+                             ( dx <= error && dy <= error ) ) {
+                  d2 = dx * dx + dy * dy;
+                  if ( d2 < *dev2 ) {
+                     *dev2 = d2;
+                     ibest = i;
+                  }
+               }
+            }
+         }
+      }
+      return ibest;
+   }
+
+/* Return the key of a grid or voting cell. The high 32 bits hold the X
+   cell index and the low 32 bits the Y cell index. */
+   static int64_t ccd1GoffKey( int64_t ix, int64_t iy ) {
+      return (int64_t) ( ( (uint64_t) ix << 32 ) ^
+                         ( (uint64_t) iy & 0xFFFFFFFF ) );
+   }
+
+/* Compare two first list positions by their grid keys, for qsort. The
+   input order is kept within each cell. */
+   static int ccd1GoffCmp( const void *a, const void *b ) {
+      const Ccd1GoffCell *ca = (const Ccd1GoffCell *) a;
+      const Ccd1GoffCell *cb = (const Ccd1GoffCell *) b;
+      if ( ca->key < cb->key ) return -1;
+      if ( ca->key > cb->key ) return 1;
+      return ( ca->index < cb->index ) ? -1 : ( ca->index > cb->index );
+   }
+
+/* Return the hash table slot for a voting cell key. */
+   static size_t ccd1GoffHash( int64_t key, size_t mask ) {
+      uint64_t h = (uint64_t) key;
+      h ^= h >> 33;
+      h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 33;
+      h *= 0xc4ceb9fe1a85ec53ULL;
+      h ^= h >> 33;
+      return (size_t) h & mask;
+   }
+
+/* Find a voting cell in the table, adding it if "add" is set. NULL is
+   returned if it is not present and "add" is not set. */
+   static Ccd1GoffVote *ccd1GoffFind( Ccd1GoffVote *table, size_t mask,
+                                      int64_t key, int add ) {
+      size_t i = ccd1GoffHash( key, mask );
+      while ( table[ i ].key != EMPTY ) {
+         if ( table[ i ].key == key ) return table + i;
+         i = ( i + 1 ) & mask;
+      }
+      if ( !add ) return NULL;
+      table[ i ].key = key;
+      return table + i;
+   }
+
+/* $Id$ */
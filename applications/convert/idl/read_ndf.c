@@ -32,7 +32,9 @@
 
 *  Description:
 *     The specified component of the specified NDF is mapped as the specified
-*     type into memory and then copied to the IDL array. If badset is true,
+*     type into memory and then copied to the IDL array. To limit the memory
+*     needed for large NDFs, the component is mapped and copied in chunks of
+*     at most MXPIX pixels. If badset is true,
 *     any occurrence to the appropriate PRIMDAT bad value in the NDF is
 *     replaced in the IDL array by the specified bad value.
 
@@ -68,6 +70,9 @@
 *        ndfOpen
 *        ndfMap
 *        ndfBad
+*        ndfNchnk
+*        ndfChunk
+*        ndfAnnul
 *     PRIMDAT
 *        prm_par.h
 
@@ -77,6 +82,7 @@
 
 *  Copyright:
 *     Copyright (C) 1999 Central Laboratory of the Research Councils
+*     Copyright (C) 2026 East Asian Observatory.
 
 *  Authors:
 *     AJC: A.J.Chipperfield (Starlink, RAL)
@@ -92,6 +98,8 @@
 *        IDL has re-defined IDL_STRING - use updated header file export.h
 *     10-JUL-2004 (TIMJ):
 *        Really use prm_par.h
+*     14-OCT-2026:
+*        Map and copy the component in chunks of at most MXPIX pixels.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -109,6 +117,9 @@
 #include "mers.h"
 #include "export.h"
 
+/* Maximum number of pixels of the NDF to map at once */
+#define MXPIX 1048576
+
 void copybadin( void *dest, void *source, int npix, int type, void *badval );
 
 int read_ndf( int argc, void *argv[] ) {
@@ -127,6 +138,10 @@ int status;        /* Starlink status */
 int ndf;           /* NDF identifier */
 int place;         /* NDF placeholder */
 int npix;          /* Number of pixels */
+int nchunk;        /* Number of chunks in NDF */
+int ichunk;        /* Chunk index */
+int chunk;         /* NDF identifier for chunk */
+char *dest;        /* Next element of ARR to be filled */
 void *ptr[3];      /* Pointer to mapped NDF data Fortran style */
 size_t nbytes;     /* Number of bytes in NDF */
 int bpix=1;        /* Number of bits/pixel */
@@ -176,69 +191,75 @@ int oplen;              /* Length of error message */
    */
       ndfOpen( NULL, ndf_name->s, "READ", "OLD", &ndf, &place, &status );
    /*
-   **  Obtain mapped access to the array component of the first NDF
-   */
-      ndfMap( ndf, comp->s, type->s, "READ", ptr, &npix, &status );
-   /*
-   **  Now copy the values from the mapped NDF into ARR
+   **  Get the IDL type and number of bytes per pixel
    */
       if ( status == SAI__OK ) {
-      /*
-      **  First check the returned pointer is good
-      */
-         if ( ptr[0] == NULL ) {
-         /*
-         **  Fortran to C pointer conversion failed
-         */
+         if (!strcmp(type->s, "_REAL")) {
+            idltype = 4;
+            bpix = 4;
+         } else if (!strcmp(type->s, "_INTEGER")) {
+            idltype = 3;
+            bpix = 4;
+         } else if (!strcmp(type->s, "_WORD")) {
+            idltype = 2;
+            bpix = 2;
+         } else if (!strcmp(type->s, "_DOUBLE")) {
+            idltype = 5;
+            bpix = 8;
+         } else if (!strcmp(type->s, "_UBYTE")) {
+            idltype = 1;
+            bpix = 1;
+         } else {
             status = SAI__ERROR;
-            errRep( " ",
-              "read_ndf: Fortran to C pointer conversion failed", &status );
+            msgSetc( "TYPE", type->s );
+            errRep( " ", "Illegal type ^TYPE", &status );
+         }
+      }
+   /*
+   **  If badset is false, we can just copy everything; otherwise see if
+   **  bad pixels may be set and act accordingly. Set bad if we need to check
+   **  for bad pixels.
+   */
+      bad = 0;
+      if ( badset ) ndfBad( ndf, "DATA", 0, &bad, &status );
 
-         } else {
+   /*
+   **  Now copy the values from the NDF into ARR a chunk at a time, so that
+   **  no more than MXPIX pixels of the component need be mapped at once
+   **  alongside the IDL array. Chunks are contiguous in the NDF's pixel
+   **  order, so each is copied to the next part of ARR.
+   */
+      ndfNchnk( ndf, MXPIX, &nchunk, &status );
+      dest = (char *)arr;
+      for ( ichunk = 1; ichunk <= nchunk && status == SAI__OK; ichunk++ ) {
+         ndfChunk( ndf, MXPIX, ichunk, &chunk, &status );
+         ndfMap( chunk, comp->s, type->s, "READ", ptr, &npix, &status );
+         if ( status == SAI__OK ) {
          /*
-         **  then get the IDL type and number of bytes per pixel
+         **  First check the returned pointer is good
          */
-            if (!strcmp(type->s, "_REAL")) {
-               idltype = 4;
-               bpix = 4;
-            } else if (!strcmp(type->s, "_INTEGER")) {
-               idltype = 3;
-               bpix = 4;
-            } else if (!strcmp(type->s, "_WORD")) {
-               idltype = 2;
-               bpix = 2;
-            } else if (!strcmp(type->s, "_DOUBLE")) {
-               idltype = 5;
-               bpix = 8;
-            } else if (!strcmp(type->s, "_UBYTE")) {
-               idltype = 1;
-               bpix = 1;
-            } else {
+            if ( ptr[0] == NULL ) {
+            /*
+            **  Fortran to C pointer conversion failed
+            */
                status = SAI__ERROR;
-               msgSetc( "TYPE", type->s );
-               errRep( " ", "Illegal type ^TYPE", &status );
-            }
-         /*
-         **  If badset is false, we can just copy everything; otherwise see if
-         **  bad pixels may be set and act accordingly. Set bad if we need to check
-         **  for bad pixels.
-         */
-            bad = 0;
-            if ( badset ) ndfBad( ndf, "DATA", 0, &bad, &status );
+               errRep( " ",
+                 "read_ndf: Fortran to C pointer conversion failed", &status );
 
-         /*
-         **  Now copy the data from the NDF to the array.
-         **  If we need not check for bad pixels just copy the whole lot
-         */
-            if ( status == SAI__OK ) {
+            } else {
+            /*
+            **  If we need not check for bad pixels just copy the whole chunk
+            */
+               nbytes = (size_t) bpix * npix;
                if ( bad ) {
-                  copybadin( arr, ptr[0], npix, idltype, bad_value );
+                  copybadin( dest, ptr[0], npix, idltype, bad_value );
                } else {
-                  nbytes = bpix * npix;
-                  memcpy( arr, ptr[0], nbytes );
+                  memcpy( dest, ptr[0], nbytes );
                }
+               dest += nbytes;
             }
          }
+         ndfAnnul( &chunk, &status );
       }
 
    /*
@@ -42,6 +42,8 @@
 *     the specified NDF is expected to already exist. For component 'QUALITY'
 *     the type must be '_UBYTE'; for components 'QUALITY' and 'VARIANCE' the
 *     number of elements in the array must equal those in the NDF.
+*     To limit the memory needed for large NDFs, the component is mapped
+*     and copied in chunks of at most MXPIX pixels.
 *
 *     If a bad value is specified, any occurrence of that value in the array
 *     will be replaced by the appropriate PRIMDAT bad value in the NDF
@@ -85,6 +87,9 @@
 *        ndfSize
 *        ndfMap
 *        ndfSbad
+*        ndfNchnk
+*        ndfChunk
+*        ndfAnnul
 *     PRIMDAT
 *        prm_par.h
 *
@@ -107,6 +112,7 @@
 
 *  Copyright:
 *     Copyright (C) 1999 Central Laboratory of the Research Councils
+*     Copyright (C) 2026 East Asian Observatory.
 
 *  Authors:
 *     AJC: A.J.Chipperfield (Starlink, RAL)
@@ -122,6 +128,8 @@
 *        IDL has re-defined IDL_STRING - use updated header file export.h
 *     10-JUL-2004 (TIMJ):
 *        Really use prm_par.h
+*     14-OCT-2026:
+*        Map and copy the component in chunks of at most MXPIX pixels.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -139,6 +147,9 @@
 #include "mers.h"
 #include "export.h"
 
+/* Maximum number of pixels of the NDF to map at once */
+#define MXPIX 1048576
+
 int copybadout( void *dest, void *source, int npix, int type, void *badval );
 
 unsigned long __taso_mode=1;
@@ -162,6 +173,11 @@ int lbnd[5]={1L,1L,1L,1L,1L}; /* Lower bounds array */
 int ndf;           /* NDF identifier */
 int place;         /* NDF placeholder */
 int npix;          /* Number of pixels */
+int nchunk;        /* Number of chunks in NDF */
+int ichunk;        /* Chunk index */
+int chunk;         /* NDF identifier for chunk */
+int nbad=0;        /* Number of bad values found */
+char *source;      /* Next element of ARR to be copied */
 void *ptr[3];      /* Pointer to mapped NDF data Fortran style */
 size_t nbytes;     /* Number of bytes in NDF */
 int bpix=1;        /* Number of bits/pixel */
@@ -244,70 +260,75 @@ int oplen;              /* Length of error message */
       }
 
    /*
-   **  Obtain mapped access to the array component of the NDF
-   */
-      ndfMap( ndf, comp->s, type->s, "WRITE", ptr, &npix, &status );
-
-   /*
-   **  Now copy the values from ARR into the mapped NDF
+   **  Get the IDL type code and number of bytes per pixel
    */
       if ( status == SAI__OK ) {
-      /*
-      **  First check the returned pointer is good
-      */
-         if ( ptr[0] == NULL ) {
-         /*
-         **  Fortran to C pointer conversion failed
-         */
+         if (!strcmp(type->s, "_REAL")) {
+            idltype = 4;
+            bpix = 4;
+         } else if (!strcmp(type->s, "_INTEGER")) {
+            idltype = 3;
+            bpix = 4;
+         } else if (!strcmp(type->s, "_WORD")) {
+            idltype = 2;
+            bpix = 2;
+         } else if (!strcmp(type->s, "_DOUBLE")) {
+            idltype = 5;
+            bpix = 8;
+         } else if (!strcmp(type->s, "_UBYTE")) {
+            idltype = 1;
+            bpix = 1;
+         } else {
             status = SAI__ERROR;
-            errRep( " ",
-              "write_ndf: Fortran to C pointer conversion failed", &status );
+            msgSetc( "TYPE", type->s );
+            errRep( " ", "Illegal type ^TYPE", &status );
+         }
+      }
 
-         } else {
+   /*
+   **  Now copy the values from ARR into the NDF a chunk at a time, so that
+   **  no more than MXPIX pixels of the component need be mapped at once
+   **  alongside the IDL array. Chunks are contiguous in the NDF's pixel
+   **  order, so each is filled from the next part of ARR.
+   **  If we need to check for bad values in the array, use copybadout.
+   **  If any bad values are found copybadout will replace them with the
+   **  appropriate PRIMDAT bad value. The NDF bad pixel flag is then set
+   **  depending on whether copybadout detected any bad values in any chunk.
+   **  If we need not check for bad pixels just copy the whole chunk.
+   */
+      ndfNchnk( ndf, MXPIX, &nchunk, &status );
+      source = (char *)arr;
+      for ( ichunk = 1; ichunk <= nchunk && status == SAI__OK; ichunk++ ) {
+         ndfChunk( ndf, MXPIX, ichunk, &chunk, &status );
+         ndfMap( chunk, comp->s, type->s, "WRITE", ptr, &npix, &status );
+         if ( status == SAI__OK ) {
          /*
-         **  then get the IDL type code and number of bytes per pixel
+         **  First check the returned pointer is good
          */
-            if (!strcmp(type->s, "_REAL")) {
-               idltype = 4;
-               bpix = 4;
-            } else if (!strcmp(type->s, "_INTEGER")) {
-               idltype = 3;
-               bpix = 4;
-            } else if (!strcmp(type->s, "_WORD")) {
-               idltype = 2;
-               bpix = 2;
-            } else if (!strcmp(type->s, "_DOUBLE")) {
-               idltype = 5;
-               bpix = 8;
-            } else if (!strcmp(type->s, "_UBYTE")) {
-               idltype = 1;
-               bpix = 1;
-            } else {
+            if ( ptr[0] == NULL ) {
+            /*
+            **  Fortran to C pointer conversion failed
+            */
                status = SAI__ERROR;
-               msgSetc( "TYPE", type->s );
-               errRep( " ", "Illegal type ^TYPE", &status );
-            }
+               errRep( " ",
+                 "write_ndf: Fortran to C pointer conversion failed", &status );
 
-         /*
-         **  Now copy the data from the array to the NDF.
-         **  If we need to check for bad values in the array, use copybadout.
-         **  If any bad values are found copybadout will replace them with the
-         **  appropriate PRIMDAT bad value. The NDF bad pixel flag is then set
-         **  depending on whether copybadout detected any bad values.
-         **  If we need not check for bad pixels just copy the whole lot;
-         */
-            if ( status == SAI__OK ) {
+            } else {
+               nbytes = (size_t) bpix * npix;
                if ( badset ) {
-                  if ( !copybadout( ptr[0], arr, npix, idltype, bad_value ) )
-                     ndfSbad( 0, ndf, comp->s, &status);
+                  nbad += copybadout( ptr[0], source, npix, idltype,
+                                      bad_value );
                } else {
-                  nbytes = bpix * npix;
-                  memcpy( ptr[0], arr, nbytes );
+                  memcpy( ptr[0], source, nbytes );
                }
+               source += nbytes;
             }
          }
+         ndfAnnul( &chunk, &status );
       }
 
+      if ( badset && !nbad ) ndfSbad( 0, ndf, comp->s, &status );
+
    /*
    **  Close NDF
    */
@@ -86,6 +86,7 @@ void clumpinfo( int *status ) {
 
 *  Copyright:
 *     Copyright (C) 2007 Particle Physics & Astronomy Research Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -111,6 +112,9 @@ void clumpinfo( int *status ) {
 *  History:
 *     22-MAR-2007 (DSB):
 *        Original version.
+*     14-OCT-2026:
+*        Report a more helpful error if the NDF holds a CLUMPTAB structure
+*        instead of an array of clumps.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -190,6 +194,13 @@ void clumpinfo( int *status ) {
             errRep( "", "The CUPID extension within NDF \"^NDF\" does not "
                     "contain an array of clumps such as created by "
                     "FINDCLUMPS or EXTRACTCLUMPS.", status );
+
+            datThere( xloc, "CLUMPTAB", &there, status );
+            if( there ) {
+               errRep( "", "It was created by FINDCLUMPS with CLUMPNDFS "
+                       "set to FALSE. Use EXTRACTCLUMPS to create the "
+                       "clump NDFs.", status );
+            }
          }
 
       } else {
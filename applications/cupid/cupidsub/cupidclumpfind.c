@@ -134,6 +134,10 @@ HDSLoc *cupidClumpFind( int type, int ndim, int *slbnd, int *subnd, void *ipd,
 *        Switch off group history and provenance recording whilst creating
 *        clump NDFs. This is because it can inflate the time taken to run
 *        findclumps enormously if there are many thousands of clumps.
+*     14-OCT-2026:
+*        Sort the pixels by contour level once, using cupidCFSort, so
+*        that each contour level only visits the pixels that first appear
+*        at that level.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -152,10 +156,11 @@ HDSLoc *cupidClumpFind( int type, int ndim, int *slbnd, int *subnd, void *ipd,
    double clevel;       /* Current data level */
    double dd;           /* Data value */
    double maxd;         /* Maximum value in data array */
-   double maxrem;       /* Maximum of remaining unassigned pixel values */
    double mind;         /* Minimum value in data array */
    float fd;            /* Data value */
    int *ipa;            /* Pointer to pixel assignment array */
+   int *lstart;         /* Index of first pixel in "order" at each level */
+   int *order;          /* Pixel vector indices sorted by contour level */
    int allow_edge;      /* Are clumps allowed to touch an edge of the data array? */
    int dims[3];         /* Pointer to array of array dimensions */
    int el;              /* Number of elements in array */
@@ -308,8 +313,11 @@ HDSLoc *cupidClumpFind( int type, int ndim, int *slbnd, int *subnd, void *ipd,
 /* Get the contour levels at which to check for clumps. */
       levels = cupidCFLevels( config, maxd, mind, rms, &nlevels, status );
 
-/* Initialise the largest data value in the remaining unassigned pixels. */
-      maxrem = maxd;
+/* Sort the good pixels by the contour level at which they will first be
+   visited, so that each level only needs to visit its new pixels. */
+      lstart = astMalloc( sizeof( int )*( nlevels + 1 ) );
+      order = lstart ? cupidCFSort( type, ipd, el, levels, nlevels, lstart,
+                                    status ) : NULL;
 
 /* Loop round all contour levels. */
       for( ilev = 0; ilev < nlevels; ilev++ ) {
@@ -319,17 +327,17 @@ HDSLoc *cupidClumpFind( int type, int ndim, int *slbnd, int *subnd, void *ipd,
          msgSetd( "C", clevel );
          msgOutif( MSG__VERB, "", "Contour level ^C:", status );
 
-/* Scan the data array at a new contour level. This extends clumps found
+/* Visit the new pixels at this contour level. This extends clumps found
    at a higher contour level, and adds any new clumps found at this contour
-   level. New clumps are stored at the end of the returned array. If the
-   current contour level is higher than the maximum of the remaining
-   unassigned pixel values, there is no point in doing this scan since it
-   will find no pixels. */
-         if( clevel <= maxrem ) {
+   level. New clumps are stored at the end of the returned array. If there
+   are no new pixels at this contour level, there is nothing to do. */
+         if( order && lstart[ ilev + 1 ] > lstart[ ilev ] ) {
             clumps = cupidCFScan( type, ipd, ipa, el, ndim, dims, skip,
                                   ( ndim == 3 && perspectrum ) ? ( velax + 1 ) : 0,
                                   clumps, idl, clevel, &index, naxis,
-                                  idl || ilev < nlevels - 1, slbnd, &maxrem, status );
+                                  idl || ilev < nlevels - 1, slbnd, order,
+                                  lstart[ ilev ], lstart[ ilev + 1 ] - lstart[ ilev ],
+                                  status );
 
          } else {
            msgOutif(MSG__DEBUG, "",
@@ -476,6 +484,8 @@ HDSLoc *cupidClumpFind( int type, int ndim, int *slbnd, int *subnd, void *ipd,
       }
       clumps = astFree( clumps );
       levels = astFree( levels );
+      lstart = astFree( lstart );
+      order = astFree( order );
 
    }
 
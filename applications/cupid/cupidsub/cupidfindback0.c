@@ -19,7 +19,11 @@ void cupidFindback0( void *data, int *status ){
 
 *  Description:
 *     This is the main function that gets run in a worker thread in order
-*     to filter a slice of the supplied base NDF.
+*     to filter a slice of the supplied base NDF. If a single slice is
+*     being processed, it is instead called directly from the thread that
+*     manages the workforce, and the workforce is included in the data
+*     structure so that the box filters can be divided between the
+*     workers.
 
 *  Parameters:
 *     data
@@ -55,6 +59,8 @@ void cupidFindback0( void *data, int *status ){
 *  History:
 *     13-SEP-2011 (DSB):
 *        Original version.
+*     14-OCT-2026:
+*        Pass the workforce (if any) to cupidFindback1.
 *     {enter_further_changes_here}
 
 *-
@@ -62,6 +68,7 @@ void cupidFindback0( void *data, int *status ){
 
 /* Local Variables: */
    CupidFindback0Data *pdata;/* Pointer to structure holding requied info */
+   ThrWorkForce *wf;         /* Workforce for the box filters, or NULL */
    double rms;               /* Global rms error in data */
    float wlim;              /* Min. fraction of good i/p values for a good o/p value */
    int box[ 3 ];             /* Dimensions of each cell in pixels */
@@ -105,6 +112,7 @@ void cupidFindback0( void *data, int *status ){
    type = pdata->type;
    newalg = pdata->newalg;
    wlim = pdata->wlim;
+   wf = pdata->wf;
 
 /* Report the bounds of the slice if required. */
    msgBlankif( MSG__VERB, status );
@@ -116,13 +124,13 @@ void cupidFindback0( void *data, int *status ){
    if( type == CUPID__FLOAT ) {
       wa = astMalloc( sizeof( float )*slice_size );
       wb = astMalloc( sizeof( float )*slice_size );
-      cupidFindback1F( wlim, ndim, slice_dim, slice_lbnd, box, rms, ipd1, ipd2,
-                       wa, wb, newalg, status );
+      cupidFindback1F( wf, wlim, ndim, slice_dim, slice_lbnd, box, rms, ipd1,
+                       ipd2, wa, wb, newalg, status );
    } else {
       wa = astMalloc( sizeof( double )*slice_size );
       wb = astMalloc( sizeof( double )*slice_size );
-      cupidFindback1D( wlim, ndim, slice_dim, slice_lbnd, box, rms, ipd1, ipd2,
-                       wa, wb, newalg, status  );
+      cupidFindback1D( wf, wlim, ndim, slice_dim, slice_lbnd, box, rms, ipd1,
+                       ipd2, wa, wb, newalg, status  );
    }
 
 /* Free workspace. */
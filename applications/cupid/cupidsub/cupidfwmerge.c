@@ -0,0 +1,167 @@
+#include "sae_par.h"
+#include "mers.h"
+#include "cupid.h"
+#include "ast.h"
+#include <stdlib.h>
+
+/* A structure describing a peak reached by a walk from a tile. */
+typedef struct CupidFWPeak {
+   int start;          /* Vector index at which the walk started */
+   int peak;           /* Vector index of the peak */
+   int first;          /* Lowest start index of any walk to the peak */
+   int *dest;          /* Where to store the clump index */
+} CupidFWPeak;
+
+static int cupid1PeakCmp( const void *a, const void *b );
+static int cupid1FirstCmp( const void *a, const void *b );
+
+int cupidFWMerge( int ntile, CupidFWTile *tiles, int *status ){
+/*
+*+
+*  Name:
+*     cupidFWMerge
+
+*  Purpose:
+*     Merge the peaks found in separate tiles by the FellWalker algorithm.
+
+*  Language:
+*     Starlink C
+
+*  Synopsis:
+*     int cupidFWMerge( int ntile, CupidFWTile *tiles, int *status )
+
+*  Description:
+*     When the FellWalker algorithm walks from the pixels in several tiles
+*     concurrently (see cupidFWMain<X>), each tile records the vector index
+*     of every peak reached by its walks, together with the vector index
+*     of the pixel from which the first such walk started. Walks from
+*     different tiles may reach the same peak. This function assigns a
+*     single clump index to each distinct peak, and stores it in the "map"
+*     array of each tile. Clumps are numbered from 1 in order of the
+*     lowest vector index from which a walk reached them, which is the
+*     order in which the serial algorithm would have found them.
+
+*  Parameters:
+*     ntile
+*        The number of tiles.
+*     tiles
+*        The tiles. The "map" array of each tile is returned holding the
+*        clump index for each of the "npeak" peaks in its "peaks" list.
+*     status
+*        Pointer to the inherited status value.
+
+*  Returned Value:
+*     The number of distinct clumps.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+/* Local Variables: */
+   CupidFWPeak *list;  /* List of all peaks from all tiles */
+   CupidFWPeak *p;     /* Pointer to next peak */
+   CupidFWTile *tile;  /* Pointer to next tile */
+   int first;          /* Lowest start index for the current peak */
+   int i;              /* Peak index within tile */
+   int itile;          /* Tile index */
+   int ntot;           /* Total number of peaks in all tiles */
+   int ret;            /* Number of distinct peaks */
+
+/* Initialise */
+   ret = 0;
+
+/* Abort if an error has already occurred. */
+   if( *status != SAI__OK ) return ret;
+
+/* Allocate the clump index map for each tile, and count the peaks. */
+   ntot = 0;
+   for( itile = 0; itile < ntile; itile++ ) {
+      tile = tiles + itile;
+      tile->map = astMalloc( sizeof( int )*( tile->npeak ? tile->npeak : 1 ) );
+      ntot += tile->npeak;
+   }
+
+/* Form a single list of all the peaks. */
+   list = astMalloc( sizeof( *list )*( ntot ? ntot : 1 ) );
+   if( list && *status == SAI__OK ) {
+      p = list;
+      for( itile = 0; itile < ntile; itile++ ) {
+         tile = tiles + itile;
+         for( i = 0; i < tile->npeak; i++, p++ ) {
+            p->start = tile->peaks[ 2*i ];
+            p->peak = tile->peaks[ 2*i + 1 ];
+            p->dest = tile->map + i;
+         }
+      }
+
+/* Sort the list by peak, and within each peak by starting pixel, and
+   then note the lowest starting pixel for each peak. */
+      qsort( list, ntot, sizeof( *list ), cupid1PeakCmp );
+      first = 0;
+      for( i = 0; i < ntot; i++ ) {
+         if( i == 0 || list[ i ].peak != list[ i - 1 ].peak ) {
+            first = list[ i ].start;
+         }
+         list[ i ].first = first;
+      }
+
+/* Sort the list by the lowest starting pixel of each peak. Since each
+   walk reaches only one peak, this brings the entries for each peak
+   together in the required order. Number the peaks. */
+      qsort( list, ntot, sizeof( *list ), cupid1FirstCmp );
+      for( i = 0; i < ntot; i++ ) {
+         if( i == 0 || list[ i ].first != list[ i - 1 ].first ) ret++;
+         *( list[ i ].dest ) = ret;
+      }
+   }
+
+/* Free resources. */
+   list = astFree( list );
+
+/* Return the number of clumps. */
+   return ret;
+}
+
+/* Compare two peaks by peak vector index, and then by start index. */
+static int cupid1PeakCmp( const void *a, const void *b ){
+   const CupidFWPeak *pa = (const CupidFWPeak *) a;
+   const CupidFWPeak *pb = (const CupidFWPeak *) b;
+   if( pa->peak != pb->peak ) return ( pa->peak < pb->peak ) ? -1 : 1;
+   if( pa->start != pb->start ) return ( pa->start < pb->start ) ? -1 : 1;
+   return 0;
+}
+
+/* Compare two peaks by the lowest start index of any walk to the peak. */
+static int cupid1FirstCmp( const void *a, const void *b ){
+   const CupidFWPeak *pa = (const CupidFWPeak *) a;
+   const CupidFWPeak *pb = (const CupidFWPeak *) b;
+   if( pa->first != pb->first ) return ( pa->first < pb->first ) ? -1 : 1;
+   return 0;
+}
@@ -28,7 +28,9 @@ void cupidGCcalcg( int n, double *x, int *nf, double *g ){
 *  Description:
 *     This function evaluates the gradient of the merit function describing
 *     the fit between a given Gaussian model and a given data array. It is
-*     designed to be called by the pdaSumsl minimisation function.
+*     designed to be called by the pdaSumsl minimisation function. The
+*     gradients with respect to all parameters are found together in a
+*     single pass through the data array.
 
 *  Parameters:
 *     n
@@ -73,6 +75,8 @@ void cupidGCcalcg( int n, double *x, int *nf, double *g ){
 *  History:
 *     18-OCT-2005 (DSB):
 *        Original version.
+*     14-OCT-2026:
+*        Find all gradients in a single call to cupidGCChiSq.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -99,16 +103,11 @@ void cupidGCcalcg( int n, double *x, int *nf, double *g ){
       cupidGC.nf = *nf;
    }
 
-/* Loop round each parameter */
-   for( ipar = 0; ipar < n; ipar++ ) {
-
-/* Calculate the rate of change of the chi-squared with respect to this
-   parameter. */
-      g[ ipar ] = cupidGCChiSq( cupidGC.ndim, x, ipar, newx, &status );
-
-/* The second and subsequent passes through this loop use the same "x"
-   position as the first. */
-      newx = 0;
+/* Calculate the rate of change of the chi-squared with respect to each
+   parameter. If they cannot be found, return bad values. */
+   if( cupidGCChiSq( cupidGC.ndim, x, CUPID__GCGRAD, newx, g,
+                     &status ) == VAL__BADD ) {
+      for( ipar = 0; ipar < n; ipar++ ) g[ ipar ] = VAL__BADD;
    }
 
 }
@@ -13,7 +13,7 @@ extern CupidGC cupidGC;
 
 
 double cupidGCChiSq( int ndim, double *xpar, int xwhat, int newp,
-         int *status ){
+         double *grad, int *status ){
 /*
 *+
 *  Name:
@@ -27,13 +27,13 @@ double cupidGCChiSq( int ndim, double *xpar, int xwhat, int newp,
 
 *  Synopsis:
 *     double cupidGCChiSq( int ndim, double *xpar, int xwhat, int newp,
-*        int *status )
+*        double *grad, int *status )
 
 *  Description:
 *     This function evaluates the modified chi squared used to estimate
 *     the goodness of fit between a given Gaussian clump model and the
 *     residual data array, or the rate of change of the modified
-*     chi-squared with respect to one of the model parameters.
+*     chi-squared with respect to one or all of the model parameters.
 *
 *     The basic chi-squared is normalised by the sum of the weights (not
 *     the number of degrees of freedom as in the Stutzki & Gusten paper).
@@ -73,19 +73,30 @@ double cupidGCChiSq( int ndim, double *xpar, int xwhat, int newp,
 *           depends on the value of "ndim"), and the other values are shifted
 *           down to fill the gap left at element 1.
 *     xwhat
-*        If negative, then the chi-squared value is returned. Otherwise, the
-*        partial derivative of the chi-squared value with respect to the
+*        If CUPID__GCGRAD, then the partial derivatives of the chi-squared
+*        value with respect to all the free parameters are returned in
+*        "grad". This is faster than finding each derivative separately
+*        since the data array is only traversed once. If negative (but not
+*        CUPID__GCGRAD), then the chi-squared value is returned. Otherwise,
+*        the partial derivative of the chi-squared value with respect to the
 *        parameter "xpar[what]" is returned.
 *     newp
 *        If zero, it is assumed that "xpar" is the same as on the previous
 *        invocation of this function. This causes cached intermediate values
 *        to be re-used, thus speeding things up. A non-zero value should
 *        be supplied if "xpar" is not the same as on the previous invocation.
+*     grad
+*        Pointer to an array in which to return the partial derivatives if
+*        "xwhat" is CUPID__GCGRAD. It should have one element for each
+*        free parameter (see "xpar"). Not used, and may be NULL, if "xwhat"
+*        is not CUPID__GCGRAD.
 *     status
 *        Pointer to the inherited status value.
 
 *  Returned Value:
-*     The chi-squared value or gradient.
+*     The chi-squared value or gradient. If "xwhat" is CUPID__GCGRAD, the
+*     returned value is zero, or VAL__BADD if the gradients could not be
+*     found.
 
 *  Copyright:
 *     Copyright (C) 2009 Science & Technology Facilities Council.
@@ -121,6 +132,9 @@ double cupidGCChiSq( int ndim, double *xpar, int xwhat, int newp,
 *        that do not contribute to the fit.
 *     14-JAN-2009 (TIMJ):
 *        Use MERS for message filtering.
+*     14-OCT-2026:
+*        Added "grad" parameter, and the option to find the gradient with
+*        respect to all free parameters in a single pass through the data.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -142,6 +156,7 @@ double cupidGCChiSq( int ndim, double *xpar, int xwhat, int newp,
    double back_term;       /* chi squared term to stop large shifts in bg level */
    double dx_sq;           /* Smoothed beam width */
    double g;               /* Rat eof change of model value */
+   double gsum[ CUPID__GCNP3 ];/* Running sums for each required gradient */
    double gback_term;      /* Gradient term to stop large shifts in bg level */
    double m;               /* Model value */
    double res;             /* Difference between data and model value */
@@ -156,6 +171,9 @@ double cupidGCChiSq( int ndim, double *xpar, int xwhat, int newp,
    int i;                  /* Parameter index */
    int iax;                /* Axis index */
    int iel;                /* Index of pixel within section currently being fitted */
+   int iw;                 /* Index into "whats" */
+   int nw;                 /* Number of required gradients */
+   int whats[ CUPID__GCNP3 ];/* Indices of parameters for required gradients */
    int what;               /* "xwhat" value assuming bckgnd is being fitted */
    int wmod;               /* Were the weights changed? */
 
@@ -404,7 +422,7 @@ double cupidGCChiSq( int ndim, double *xpar, int xwhat, int newp,
 
 /* Select or calculate the required return value.  If the chi squared
    value itself is required, just return the value found above. */
-   if( what < 0 ) {
+   if( what < 0 && what != CUPID__GCGRAD ) {
       ret = chisq;
 
         cupidGCDumpF( MSG__DEBUG3, NULL, 0, NULL, NULL, status );
@@ -444,9 +462,21 @@ double cupidGCChiSq( int ndim, double *xpar, int xwhat, int newp,
             }
          }
 
-/* If the rate of change of the chi squared with respect to one of the
-   model parameters is required, we have more work. */
+/* If the rate of change of the chi squared with respect to one or all of
+   the model parameters is required, we have more work. First form a list
+   of the indices of the parameters within "par" for which the gradient
+   is required. */
    } else {
+      if( what == CUPID__GCGRAD ) {
+         nw = cupidGC.fixback ? cupidGC.npar - 1 : cupidGC.npar;
+         for( iw = 0; iw < nw; iw++ ) {
+            whats[ iw ] = ( cupidGC.fixback && iw > 0 ) ? iw + 1 : iw;
+         }
+      } else {
+         nw = 1;
+         whats[ 0 ] = what;
+      }
+      for( iw = 0; iw < nw; iw++ ) gsum[ iw ] = 0.0;
 
 /* Initialise pointer to the next element to be used in the array
    holding the scaled residuals at each pixel. */
@@ -457,18 +487,21 @@ double cupidGCChiSq( int ndim, double *xpar, int xwhat, int newp,
       for( iax = 0; iax < ndim; iax++ ) x[ iax ] = cupidGC.lbnd[ iax ];
 
 /* Loop over all pixels in the section of the data array which is being
-   fitted, accumulating the contribution to the required value caused by the
-   rate of change of the model itself with respect to the required
-   parameter. */
-      ret = 0.0;
+   fitted, accumulating the contribution to the required values caused by
+   the rate of change of the model itself with respect to the required
+   parameters. */
       for( iel = 0; iel < cupidGC.nel; iel++ ){
 
-/* Get the rate of change of the Gaussian model value with respect to the
-   required parameter, at the centre of the current pixel. */
-         g = cupidGCModel( ndim, x, par, what, 1, 0, status );
-
-/* Increment the running sum of the returned value. */
-         ret += *pr*g;
+/* Get the rate of change of the Gaussian model value with respect to
+   each required parameter, at the centre of the current pixel, and
+   increment the running sums. The values that depend on the pixel
+   position are cached by cupidGCModel on the first call, and re-used
+   for the other parameters. */
+         for( iw = 0; iw < nw; iw++ ) {
+            g = cupidGCModel( ndim, x, par, whats[ iw ], ( iw == 0 ), 0,
+                              status );
+            gsum[ iw ] += *pr*g;
+         }
 
 /* Move the pointer on to the next pixel in the section of the data
    array being fitted. */
@@ -485,37 +518,45 @@ double cupidGCChiSq( int ndim, double *xpar, int xwhat, int newp,
          }
       }
 
-/* Scale the returned value to relate to a normalised chi-squared. */
-      ret *= -2.0/cupidGC.wsum;
+/* Loop round each required gradient. */
+      for( iw = 0; iw < nw; iw++ ) {
+
+/* Scale the value to relate to a normalised chi-squared. */
+         ret = gsum[ iw ]*( -2.0/cupidGC.wsum );
 
 /* If the parameter for which we are finding the gradient is involved in
    the extra terms added to chi squared by the Stutski & Gusten paper,
    then we have extra terms to add to the gradient found above. */
-      if( what == 0 ) {
-         ret += 2*cupidGC.sa*pdiff*peakfactor;
+         if( whats[ iw ] == 0 ) {
+            ret += 2*cupidGC.sa*pdiff*peakfactor;
 
-      } else if( what == 1 ) {
-         ret += 2*cupidGC.sa*pdiff + gback_term;
+         } else if( whats[ iw ] == 1 ) {
+            ret += 2*cupidGC.sa*pdiff + gback_term;
 
-      } else if( what == 2 ) {
-         if( cupidGC.beam_sq > 0.0 ) ret += 2*cupidGC.sc4*x0_off/cupidGC.beam_sq;
+         } else if( whats[ iw ] == 2 ) {
+            if( cupidGC.beam_sq > 0.0 ) ret += 2*cupidGC.sc4*x0_off/cupidGC.beam_sq;
 
-      } else if( what == 3 ) {
-         ret += 2*cupidGC.sa*pdiff*f3;
+         } else if( whats[ iw ] == 3 ) {
+            ret += 2*cupidGC.sa*pdiff*f3;
 
-      } else if( what == 4 ) {
-         if( cupidGC.beam_sq > 0.0 ) ret += 2*cupidGC.sc4*x1_off/cupidGC.beam_sq;
+         } else if( whats[ iw ] == 4 ) {
+            if( cupidGC.beam_sq > 0.0 ) ret += 2*cupidGC.sc4*x1_off/cupidGC.beam_sq;
 
-      } else if( what == 5 ) {
-         ret += 2*cupidGC.sa*pdiff*f5;
+         } else if( whats[ iw ] == 5 ) {
+            ret += 2*cupidGC.sa*pdiff*f5;
 
-      } else if( what == 7 ) {
-         if( cupidGC.velres_sq > 0.0 ) ret += 2*cupidGC.sc4*v_off/cupidGC.velres_sq;
+         } else if( whats[ iw ] == 7 ) {
+            if( cupidGC.velres_sq > 0.0 ) ret += 2*cupidGC.sc4*v_off/cupidGC.velres_sq;
 
-      } else if( what == 8 ) {
-         ret += 2*cupidGC.sa*pdiff*f8;
+         } else if( whats[ iw ] == 8 ) {
+            ret += 2*cupidGC.sa*pdiff*f8;
+
+         }
 
+/* Store the gradient if all gradients are required. */
+         if( what == CUPID__GCGRAD ) grad[ iw ] = ret;
       }
+      if( what == CUPID__GCGRAD ) ret = 0.0;
 
    }
 
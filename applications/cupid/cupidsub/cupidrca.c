@@ -1,6 +1,30 @@
 #include "sae_par.h"
 #include "ast.h"
 #include "cupid.h"
+#include "star/thr.h"
+
+/* A structure holding the information needed to process a range of rows. */
+typedef struct CupidRCAData {
+   int *in;            /* The input mask array */
+   int *out;           /* The output mask array */
+   unsigned char *s1;  /* Counts of "on" pixels summed along axis 1 */
+   unsigned char *s2;  /* Counts of "on" pixels summed along axes 1 and 2 */
+   int dims[ 3 ];      /* The number of pixels along each axis */
+   int skip[ 3 ];      /* The vector index increment along each axis */
+   double thresh;      /* Threshold fraction of "on" neighbours */
+   int magic;          /* Values copied unchanged from input to output */
+   int on;             /* The "on" value */
+   int off;            /* The "off" value */
+   int centre;         /* Must the central pixel be on? */
+} CupidRCAData;
+
+/* Prototypes for private functions defined in this file. */
+static void cupid1RCAx( void *job_data, size_t first, size_t last,
+                        int *status );
+static void cupid1RCAy( void *job_data, size_t first, size_t last,
+                        int *status );
+static void cupid1RCAz( void *job_data, size_t first, size_t last,
+                        int *status );
 
 int *cupidRCA( int *in, int *out, int nel, int dims[ 3 ], int skip[ 3 ],
                double thresh, int magic, int on, int off, int centre,
@@ -37,6 +61,12 @@ int *cupidRCA( int *in, int *out, int nel, int dims[ 3 ], int skip[ 3 ],
 *     pixel value is set to "on", otherwise it is set to "off". Optionally,
 *     an additional requirement for an output pixel to be set on is that
 *     the corresponding input pixel must be on.
+*
+*     The neighbourhood counts are formed by summing the "on" pixels
+*     along each axis in turn, which needs 3 additions per pixel instead
+*     of visiting all 27 pixels in every cube. The rows of the array are
+*     divided between threads, using the number of threads given by the
+*     CUPID_THREADS environment variable.
 
 *  Parameters:
 *     in
@@ -100,6 +130,9 @@ int *cupidRCA( int *in, int *out, int nel, int dims[ 3 ], int skip[ 3 ],
 *  History:
 *     19-JAN-2006 (DSB):
 *        Original version.
+*     14-OCT-2026:
+*        Form neighbourhood counts using separable sums along each axis,
+*        and divide the rows between threads.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -109,22 +142,12 @@ int *cupidRCA( int *in, int *out, int nel, int dims[ 3 ], int skip[ 3 ],
 */
 
 /* Local Variables: */
-
-   int *pin0;          /* Pointer to input pixel [0,0,0] */
-   int *pin;           /* Pointer to input pixel */
-   int *piny;          /* Pointer to input pixel at start of row */
-   int *pinz;          /* Pointer to input pixel at start of plane */
-   int *pout;          /* Pointer to output pixel */
+   CupidRCAData data;  /* Information needed by each range of rows */
+   ThrWorkForce *wf;   /* Pool of persistent worker threads */
    int *ret;           /* Pointer to the returned array */
-   int iv;             /* Vector index into input array */
-   int ix;             /* Input pixel GRID index on axis 1 */
-   int iy;             /* Input pixel GRID index on axis 2 */
-   int iz;             /* Input pixel GRID index on axis 3 */
-   int ox;             /* Output pixel GRID index on axis 1 */
-   int oy;             /* Output pixel GRID index on axis 2 */
-   int oz;             /* Output pixel GRID index on axis 3 */
-   int sum;            /* No. of edge neighbours */
-   int tot;            /* Total no. of neighbours */
+   int i;              /* Axis index */
+   size_t grain;       /* Minimum number of rows in each job */
+   size_t nrow;        /* Number of rows in the array */
 
 /* Initialise */
    ret = out;
@@ -135,72 +158,207 @@ int *cupidRCA( int *in, int *out, int nel, int dims[ 3 ], int skip[ 3 ],
 /* If no output array was supplied, allocate one now. */
    if( !out ) ret = astMalloc( sizeof( int )*nel );
 
+/* Allocate the work arrays holding the number of "on" pixels in each
+   1-pixel line and 3x3 square. These are at most 27, so a byte is
+   enough. */
+   data.s1 = astMalloc( nel );
+   data.s2 = astMalloc( nel );
+
 /* Check the memory was allocated. */
-   if( ret ) {
+   if( ret && *status == SAI__OK ) {
+      data.in = in;
+      data.out = ret;
+      for( i = 0; i < 3; i++ ) {
+         data.dims[ i ] = dims[ i ];
+         data.skip[ i ] = skip[ i ];
+      }
+      data.thresh = thresh;
+      data.magic = magic;
+      data.on = on;
+      data.off = off;
+      data.centre = centre;
+
+/* Get a pool of worker threads, and choose a grain size that gives each
+   job a reasonable number of pixels. */
+      wf = thrGetWorkforce( thrGetNThread( "CUPID_THREADS", status ), status );
+      nrow = (size_t) dims[ 1 ]*(size_t) dims[ 2 ];
+      grain = 4096/dims[ 0 ] + 1;
+
+/* Sum the "on" pixels along axis 1, then along axis 2, and finally along
+   axis 3 when forming the output values. Each stage is complete before
+   the next starts, so that each row can be processed independently. */
+      thrParallelFor( wf, 0, nrow - 1, grain, &data, cupid1RCAx, status );
+      thrParallelFor( wf, 0, nrow - 1, grain, &data, cupid1RCAy, status );
+      thrParallelFor( wf, 0, nrow - 1, grain, &data, cupid1RCAz, status );
+   }
+
+/* Free resources. */
+   data.s1 = astFree( data.s1 );
+   data.s2 = astFree( data.s2 );
+
+/* Return the pointer to the output array. */
+   return ret;
+}
+
+static void cupid1RCAx( void *job_data, size_t first, size_t last,
+                        int *status ){
+/*
+*  Name:
+*     cupid1RCAx
+
+*  Purpose:
+*     Count the "on" pixels in each 3 pixel line along axis 1.
+
+*  Description:
+*     This function is called by thrParallelFor to store the number of
+*     "on" pixels in the 3 pixel line along axis 1 centred on each pixel
+*     in rows "first" to "last" (inclusive), in the "s1" array. Lines
+*     are truncated at the edges of the array.
+
+*/
+
+/* Local Variables: */
+   CupidRCAData *data = (CupidRCAData *) job_data;
+   int *pin;           /* Pointer to first input pixel in row */
+   int ix;             /* Zero-based pixel index on axis 1 */
+   int nx;             /* Number of pixels on axis 1 */
+   int on;             /* The "on" value */
+   size_t irow;        /* Row index */
+   unsigned char *ps;  /* Pointer to first count in row */
+
+   if( *status != SAI__OK ) return;
+
+   nx = data->dims[ 0 ];
+   on = data->on;
+   for( irow = first; irow <= last; irow++ ) {
+      pin = data->in + irow*nx;
+      ps = data->s1 + irow*nx;
+
+/* Count the central pixel, and its neighbours on either side. */
+      for( ix = 0; ix < nx; ix++ ) ps[ ix ] = ( pin[ ix ] == on );
+      for( ix = 1; ix < nx; ix++ ) ps[ ix ] += ( pin[ ix - 1 ] == on );
+      for( ix = 0; ix < nx - 1; ix++ ) ps[ ix ] += ( pin[ ix + 1 ] == on );
+   }
+}
+
+static void cupid1RCAy( void *job_data, size_t first, size_t last,
+                        int *status ){
+/*
+*  Name:
+*     cupid1RCAy
+
+*  Purpose:
+*     Count the "on" pixels in each 3x3 square.
+
+*  Description:
+*     This function is called by thrParallelFor to store the number of
+*     "on" pixels in the 3x3 square in the plane of axes 1 and 2 centred
+*     on each pixel in rows "first" to "last" (inclusive), in the "s2"
+*     array. The "s1" array must already have been created.
+
+*/
+
+/* Local Variables: */
+   CupidRCAData *data = (CupidRCAData *) job_data;
+   int ix;             /* Zero-based pixel index on axis 1 */
+   int iy;             /* Zero-based pixel index on axis 2 */
+   int nx;             /* Number of pixels on axis 1 */
+   size_t irow;        /* Row index */
+   int sy;             /* Vector index increment along axis 2 */
+   unsigned char *pi;  /* Pointer to first axis 1 count in row */
+   unsigned char *po;  /* Pointer to first axis 1+2 count in row */
+
+   if( *status != SAI__OK ) return;
+
+   nx = data->dims[ 0 ];
+   sy = data->skip[ 1 ];
+   for( irow = first; irow <= last; irow++ ) {
+      iy = irow % data->dims[ 1 ];
+      pi = data->s1 + irow*nx;
+      po = data->s2 + irow*nx;
+
+      for( ix = 0; ix < nx; ix++ ) po[ ix ] = pi[ ix ];
+      if( iy > 0 ) {
+         for( ix = 0; ix < nx; ix++ ) po[ ix ] += pi[ ix - sy ];
+      }
+      if( iy < data->dims[ 1 ] - 1 ) {
+         for( ix = 0; ix < nx; ix++ ) po[ ix ] += pi[ ix + sy ];
+      }
+   }
+}
+
+static void cupid1RCAz( void *job_data, size_t first, size_t last,
+                        int *status ){
+/*
+*  Name:
+*     cupid1RCAz
 
-/* Get a pointer to the input pixel which would have GRID indices [0,0,0]
-   if the input array extended that far (in fact the first pixel in the
-   input array has GRID indices [1,1,1]). */
-      pin0 = in - skip[ 0 ] - skip[ 1 ] - skip[ 2 ];
+*  Purpose:
+*     Form the output values for a range of rows.
 
-/* Store a pointer to the first output pixel. */
-      pout = ret;
+*  Description:
+*     This function is called by thrParallelFor to count the "on" pixels
+*     in the 3x3x3 cube centred on each pixel in rows "first" to "last"
+*     (inclusive), using the "s2" array, and to store the corresponding
+*     output values.
 
-/* Loop round all elements of the output array. */
-      iv = 0;
-      for( oz = 1; oz <= dims[ 2 ]; oz++ ) {
-         for( oy = 1; oy <= dims[ 1 ]; oy++ ) {
-            for( ox = 1; ox <= dims[ 0 ]; ox++, iv++ ) {
+*/
+
+/* Local Variables: */
+   CupidRCAData *data = (CupidRCAData *) job_data;
+   int *pin;           /* Pointer to first input pixel in row */
+   int *pout;          /* Pointer to first output pixel in row */
+   int ix;             /* Zero-based pixel index on axis 1 */
+   int iy;             /* Zero-based pixel index on axis 2 */
+   int iz;             /* Zero-based pixel index on axis 3 */
+   int nx;             /* Number of pixels on axis 1 */
+   int sum;            /* No. of edge neighbours */
+   int tot;            /* Total no. of neighbours */
+   int totyz;          /* No. of neighbours on axes 2 and 3 */
+   size_t irow;        /* Row index */
+   int sz;             /* Vector index increment along axis 3 */
+   unsigned char *ps;  /* Pointer to first axis 1+2 count in row */
+
+   if( *status != SAI__OK ) return;
+
+   nx = data->dims[ 0 ];
+   sz = data->skip[ 2 ];
+   for( irow = first; irow <= last; irow++ ) {
+      iy = irow % data->dims[ 1 ];
+      iz = irow / data->dims[ 1 ];
+      pin = data->in + irow*nx;
+      pout = data->out + irow*nx;
+      ps = data->s2 + irow*nx;
+
+/* Find the number of pixels in the neighbourhood on axes 2 and 3. If the
+   row is close to an edge of the array, there will be fewer than 3
+   pixels on each axis. */
+      totyz = ( 1 + ( iy > 0 ) + ( iy < data->dims[ 1 ] - 1 ) )*
+              ( 1 + ( iz > 0 ) + ( iz < data->dims[ 2 ] - 1 ) );
+
+      for( ix = 0; ix < nx; ix++ ) {
 
 /* If the corresponding input pixel is equal to or greater than the magic
    value, copy it to the output. */
-               if( in[ iv ] >= magic ){
-                  *(pout++) = magic;
+         if( pin[ ix ] >= data->magic ){
+            pout[ ix ] = data->magic;
 
 /* If the corresponding input pixel is off, then the output must also be
    off if "centre" is true. */
-               } else if( centre && in[ iv ] != on ){
-                  *(pout++) = off;
-
-/* Otherwise, loop round all input pixels in the neighbourhood of the current
-   output pixel, this is a cube of 3x3x3 input pixels, centred on the current
-   output pixel. Count how many of these input pixels are set to "on". If
-   the current output pixel is close to an edge of the array, there will be
-   fewer than 3x3x3 pixels in the cube. Count the total number of pixels
-   in the cube. */
-               } else {
-                  tot = 0;
-                  sum = 0;
-                  pinz = pin0 + iv;
-                  for( iz = oz - 1; iz <= oz + 1; iz++ ) {
-                     if( iz >= 1 && iz <= dims[ 2 ] ) {
-                        piny = pinz;
-                        for( iy = oy - 1; iy <= oy + 1; iy++ ) {
-                           if( iy >= 1 && iy <= dims[ 1 ] ) {
-                              pin = piny;
-                              for( ix = ox - 1; ix <= ox + 1; ix++ ) {
-                                 if( ix >= 1 && ix <= dims[ 0 ] ) {
-                                    tot++;
-                                    if( *pin == on ) sum++;
-                                 }
-                                 pin++;
-                              }
-                           }
-                           piny = piny + skip[ 1 ];
-                        }
-                     }
-                     pinz = pinz + skip[ 2 ];
-                  }
-
-/* If the fraction of neighbouring on pixels is more than "thresh", set the
-   output pixel on. Otherwise set it off. Move on to the next output pixel. */
-                  *(pout++) = ( ( (float) sum )/( (float) tot ) > thresh ) ? on : off;
-               }
-            }
+         } else if( data->centre && pin[ ix ] != data->on ){
+            pout[ ix ] = data->off;
+
+/* Otherwise, count the "on" pixels in the 3x3x3 cube centred on the
+   current pixel. If the fraction of neighbouring on pixels is more than
+   "thresh", set the output pixel on. Otherwise set it off. */
+         } else {
+            sum = ps[ ix ];
+            if( iz > 0 ) sum += ps[ ix - sz ];
+            if( iz < data->dims[ 2 ] - 1 ) sum += ps[ ix + sz ];
+            tot = totyz*( 1 + ( ix > 0 ) + ( ix < nx - 1 ) );
+            pout[ ix ] = ( ( (float) sum )/( (float) tot ) > data->thresh ) ?
+                         data->on : data->off;
          }
       }
    }
-
-/* Return the pointer to the output array. */
-   return ret;
 }
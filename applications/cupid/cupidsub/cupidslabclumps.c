@@ -0,0 +1,291 @@
+#include "sae_par.h"
+#include "mers.h"
+#include "ndf.h"
+#include "star/hds.h"
+#include "cupid.h"
+#include <string.h>
+
+HDSLoc *cupidSlabClumps( const char *method, int type, int indf, int nsig,
+                         int *slbnd, int *subnd, double rms,
+                         AstKeyMap *config, int velax, int perspectrum,
+                         double beamcorr[ 3 ], int slabax, int slabsize,
+                         int overlap, int *backoff, int *status ){
+/*
+*+
+*  Name:
+*     cupidSlabClumps
+
+*  Purpose:
+*     Identify clumps within an NDF one slab at a time.
+
+*  Language:
+*     Starlink C
+
+*  Synopsis:
+*     HDSLoc *cupidSlabClumps( const char *method, int type, int indf,
+*                              int nsig, int *slbnd, int *subnd, double rms,
+*                              AstKeyMap *config, int velax,
+*                              int perspectrum, double beamcorr[ 3 ],
+*                              int slabax, int slabsize, int overlap,
+*                              int *backoff, int *status )
+
+*  Description:
+*     This function identifies clumps within an NDF that may be too large
+*     to map in one go, using the ClumpFind or FellWalker algorithm. The
+*     NDF is divided into "core" slabs of "slabsize" pixel planes along
+*     pixel axis "slabax". Each core slab is extended by "overlap" planes
+*     on both sides (where possible), and the resulting section of the NDF
+*     is mapped and searched for clumps.
+*
+*     Each clump found within a slab is retained only if its lowest pixel
+*     plane on the slab axis lies within the core of the slab. This means
+*     that a clump that straddles the boundary between two cores is
+*     retained from exactly one slab, and since that slab extends
+*     "overlap" planes beyond its core, the whole clump is seen provided
+*     it spans no more than "overlap" planes on the slab axis. Retained
+*     clumps that reach the outer edge of an overlap region may have been
+*     truncated. Such clumps are kept, but a warning is issued giving the
+*     number of them.
+
+*  Parameters:
+*     method
+*        The algorithm to use: "CLUMPFIND" or "FELLWALKER".
+*     type
+*        An integer identifying the data type in which the Data array
+*        should be mapped (CUPID__FLOAT or CUPID__DOUBLE).
+*     indf
+*        Identifier for the input NDF.
+*     nsig
+*        The number of significant pixel axes in the NDF.
+*     slbnd
+*        The lower pixel bounds of the significant pixel axes of the NDF.
+*     subnd
+*        The upper pixel bounds of the significant pixel axes of the NDF.
+*     rms
+*        The global RMS noise level in the data.
+*     config
+*        An AST KeyMap holding tuning parameters for the algorithm.
+*     velax
+*        The index of the pixel axis within the data array which corresponds
+*        to velocity. Only used if "nsig" is 3.
+*     perspectrum
+*        If non-zero, then each spectrum is processed independently of its
+*        neighbours.
+*     beamcorr
+*        An array holding the FWHM (in pixels) describing the instrumental
+*        smoothing along each pixel axis, as returned by the algorithm.
+*     slabax
+*        The zero-based index of the significant pixel axis along which
+*        the NDF is divided into slabs.
+*     slabsize
+*        The number of pixel planes in the core of each slab.
+*     overlap
+*        The number of pixel planes by which each slab extends beyond its
+*        core.
+*     backoff
+*        Pointer to an int to receive the value returned by the algorithm
+*        (ClumpFind only).
+*     status
+*        Pointer to the inherited status value.
+
+*  Returned Value:
+*     A locator for a new HDS object which is an array of NDF structures,
+*     in the same form as returned by cupidClumpFind and cupidFellWalker.
+*     NULL is returned if no clumps are found.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+/* Local Variables: */
+   HDSLoc *cloc;                  /* Locator for a cell of an NDF array */
+   HDSLoc *ndfs;                  /* Clumps found in the current slab */
+   HDSLoc *ret;                   /* Returned array of clump NDFs */
+   char unit[ 10 ];               /* NDF Unit component */
+   double *ipv;                   /* Pointer to mapped slab Variance array */
+   hdsdim icell;                  /* Index of cell within NDF array */
+   hdsdim nret;                   /* Number of clumps in returned array */
+   int clbnd[ 3 ];                /* Lower pixel bounds of clump NDF */
+   int cndim;                     /* Number of pixel axes in clump NDF */
+   int cubnd[ 3 ];                /* Upper pixel bounds of clump NDF */
+   int corehi;                    /* Upper bound of slab core */
+   int corelo;                    /* Lower bound of slab core */
+   int el;                        /* Number of pixels in slab */
+   int i;                         /* Axis index */
+   int icndf;                     /* Identifier for clump NDF */
+   int indf2;                     /* Identifier for copied clump NDF */
+   int isect;                     /* Identifier for slab section */
+   int islab;                     /* Slab index */
+   int lbnd[ 3 ];                 /* Lower bounds of slab */
+   int nslab;                     /* Number of slabs */
+   int ntrunc;                    /* Number of truncated clumps */
+   int place;                     /* NDF place holder */
+   int ubnd[ 3 ];                 /* Upper bounds of slab */
+   int var;                       /* Does the NDF have a Variance array? */
+   size_t j;                      /* Clump index within slab */
+   size_t nclump;                 /* Number of clumps in slab */
+   void *ipd;                     /* Pointer to mapped slab Data array */
+
+/* Initialise */
+   ret = NULL;
+
+/* Abort if an error has already occurred. */
+   if( *status != SAI__OK ) return ret;
+
+/* Find the number of slabs. */
+   nslab = ( subnd[ slabax ] - slbnd[ slabax ] + slabsize )/slabsize;
+   ndfState( indf, "VARIANCE", &var, status );
+
+/* Initialise the bounds of the slab. */
+   for( i = 0; i < nsig; i++ ) {
+      lbnd[ i ] = slbnd[ i ];
+      ubnd[ i ] = subnd[ i ];
+   }
+
+/* Loop round each slab. */
+   nret = 0;
+   ntrunc = 0;
+   for( islab = 0; islab < nslab && *status == SAI__OK; islab++ ) {
+
+/* Find the bounds of the core of the slab, and of the whole slab. */
+      corelo = slbnd[ slabax ] + islab*slabsize;
+      corehi = corelo + slabsize - 1;
+      if( corehi > subnd[ slabax ] ) corehi = subnd[ slabax ];
+
+      lbnd[ slabax ] = corelo - overlap;
+      if( lbnd[ slabax ] < slbnd[ slabax ] ) lbnd[ slabax ] = slbnd[ slabax ];
+      ubnd[ slabax ] = corehi + overlap;
+      if( ubnd[ slabax ] > subnd[ slabax ] ) ubnd[ slabax ] = subnd[ slabax ];
+
+      msgSeti( "I", islab + 1 );
+      msgSeti( "N", nslab );
+      msgSeti( "L", lbnd[ slabax ] );
+      msgSeti( "U", ubnd[ slabax ] );
+      msgOutif( MSG__NORM, "", "Processing slab ^I of ^N (pixel planes "
+                "^L to ^U)...", status );
+
+/* Map the Data array, and if present, the Variance array of the slab. */
+      ndfBegin();
+      isect = cupidSlabSect( indf, slabax, lbnd[ slabax ], ubnd[ slabax ],
+                             status );
+      ndfMap( isect, "DATA", ( type == CUPID__DOUBLE ) ? "_DOUBLE" : "_REAL",
+              "READ", &ipd, &el, status );
+      ipv = NULL;
+      if( var ) ndfMap( isect, "VARIANCE", "_DOUBLE", "READ", (void *) &ipv,
+                        &el, status );
+
+/* Find the clumps in the slab. */
+      ndfs = NULL;
+      if( *status == SAI__OK ) {
+         if( !strcmp( method, "CLUMPFIND" ) ) {
+            ndfs = cupidClumpFind( type, nsig, lbnd, ubnd, ipd, ipv, rms,
+                                   config, velax, perspectrum, beamcorr,
+                                   backoff, status );
+         } else {
+            ndfs = cupidFellWalker( type, nsig, lbnd, ubnd, ipd, ipv, rms,
+                                    config, velax, perspectrum, beamcorr,
+                                    status );
+         }
+      }
+
+/* The slab data is no longer needed. */
+      ndfAnnul( &isect, status );
+
+/* Check each clump found in the slab. */
+      nclump = 0;
+      if( ndfs ) datSize( ndfs, &nclump, status );
+      for( j = 1; j <= nclump && *status == SAI__OK; j++ ) {
+         icell = j;
+         cloc = NULL;
+         datCell( ndfs, 1, &icell, &cloc, status );
+         errBegin( status );
+         ndfFind( cloc, " ", &icndf, status );
+         errEnd( status );
+         datAnnul( &cloc, status );
+         if( icndf == NDF__NOID ) continue;
+
+/* Skip clumps flagged as unusable by the algorithm, and clumps that
+   start outside the core of the slab (these are retained from a
+   neighbouring slab). */
+         unit[ 0 ] = 0;
+         ndfCget( icndf, "Unit", unit, 9, status );
+         ndfBound( icndf, 3, clbnd, cubnd, &cndim, status );
+         if( !strcmp( unit, "BAD" ) || clbnd[ slabax ] < corelo ||
+             clbnd[ slabax ] > corehi ) {
+            ndfAnnul( &icndf, status );
+            continue;
+         }
+
+/* Count the clumps that reach the outer edge of the upper overlap
+   region, since these may have been truncated. */
+         if( cubnd[ slabax ] == ubnd[ slabax ] &&
+             ubnd[ slabax ] < subnd[ slabax ] ) ntrunc++;
+
+/* Copy the clump into a new cell at the end of the returned array. */
+         nret++;
+         if( !ret ) {
+            datTemp( "NDF", 1, &nret, &ret, status );
+         } else {
+            datAlter( ret, 1, &nret, status );
+         }
+         cloc = NULL;
+         datCell( ret, 1, &nret, &cloc, status );
+         ndfPlace( cloc, " ", &place, status );
+         ndfCopy( icndf, &place, &indf2, status );
+         ndfAnnul( &indf2, status );
+         datAnnul( &cloc, status );
+         ndfAnnul( &icndf, status );
+      }
+
+/* Free the clumps found in the slab. */
+      if( ndfs ) datAnnul( &ndfs, status );
+      ndfEnd( status );
+   }
+
+/* Report the total number of clumps, and warn about any that may have
+   been truncated. */
+   if( *status == SAI__OK ) {
+      msgBlankif( MSG__NORM, status );
+      msgSeti( "N", (int) nret );
+      msgOutif( MSG__NORM, "", "^N clumps found in total after combining "
+                "all slabs.", status );
+      if( ntrunc > 0 ) {
+         msgSeti( "N", ntrunc );
+         msgSeti( "O", overlap );
+         msgOutif( MSG__QUIET, "", "WARNING: ^N clumps extend more than "
+                   "^O pixel planes into the next slab and may have been "
+                   "truncated. Consider increasing the value of parameter "
+                   "SLABOVERLAP.", status );
+      }
+   }
+
+/* Return the merged array of clumps. */
+   return ret;
+}
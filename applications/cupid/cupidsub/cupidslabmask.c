@@ -0,0 +1,252 @@
+#include "sae_par.h"
+#include "prm_par.h"
+#include "mers.h"
+#include "ast.h"
+#include "ndf.h"
+#include "star/hds.h"
+#include "star/irq.h"
+#include "cupid.h"
+#include <string.h>
+
+static void cupid1Core( const char *ext, int edims[ 3 ], int off[ 3 ],
+                        int cdims[ 3 ], size_t size, char *core );
+
+void cupidSlabMask( int type, int indf, int indf2, int nsig, int *slbnd,
+                    int *subnd, int slabax, int slabsize, HDSLoc *ndfs,
+                    const char *method, int *status ){
+/*
+*+
+*  Name:
+*     cupidSlabMask
+
+*  Purpose:
+*     Create the clump index and Quality arrays in the main FINDCLUMPS
+*     output NDF one slab at a time.
+
+*  Language:
+*     Starlink C
+
+*  Synopsis:
+*     void cupidSlabMask( int type, int indf, int indf2, int nsig,
+*                         int *slbnd, int *subnd, int slabax, int slabsize,
+*                         HDSLoc *ndfs, const char *method, int *status )
+
+*  Description:
+*     This function stores the index of the clump containing each pixel
+*     in the _INTEGER Data array of the supplied output NDF, and sets the
+*     "CLUMP", "BACKGROUND" and "EDGE" quality names in its Quality array,
+*     without mapping the whole of either NDF at once. The arrays are
+*     created by cupidSumClumps and cupidEdges, as for the whole array,
+*     but working on one slab of "slabsize" pixel planes at a time. Each
+*     slab is extended by one pixel plane on either side so that clump
+*     edges on the slab boundaries are identified correctly.
+*
+*     The quality names must already have been added to the output NDF
+*     using irqNew and irqAddqn.
+
+*  Parameters:
+*     type
+*        An integer identifying the data type in which the input Data
+*        array should be mapped (CUPID__FLOAT or CUPID__DOUBLE).
+*     indf
+*        Identifier for the input NDF.
+*     indf2
+*        Identifier for the output NDF. It should have the same bounds as
+*        the input NDF.
+*     nsig
+*        The number of significant pixel axes in the NDFs.
+*     slbnd
+*        The lower pixel bounds of the significant pixel axes of the NDFs.
+*     subnd
+*        The upper pixel bounds of the significant pixel axes of the NDFs.
+*     slabax
+*        The zero-based index of the significant pixel axis along which
+*        the NDFs are divided into slabs.
+*     slabsize
+*        The number of pixel planes in each slab.
+*     ndfs
+*        A locator for an HDS array of clump NDF structures.
+*     method
+*        The name of the algorithm being used (e.g. "CLUMPFIND").
+*     status
+*        Pointer to the inherited status value.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+/* Local Variables: */
+   IRQLocs *qlocs;           /* HDS locators for quality name information */
+   char xname[ DAT__SZNAM + 1 ]; /* Name of extension holding quality names */
+   float *cmask;             /* Mask for the core of the slab */
+   float *rmask;             /* Mask for the extended slab */
+   int *iout;                /* Clump indices for the extended slab */
+   int cdims[ 3 ];           /* Dimensions of the core of the slab */
+   int corehi;               /* Upper bound of slab core */
+   int corelo;               /* Lower bound of slab core */
+   int edims[ 3 ];           /* Dimensions of the extended slab */
+   int eel;                  /* Number of pixels in extended slab */
+   int el;                   /* Number of pixels in core of slab */
+   int eskip[ 3 ];           /* Vector index skips in the extended slab */
+   int i;                    /* Axis index */
+   int isect;                /* Identifier for input slab section */
+   int lbnd[ 3 ];            /* Lower bounds of extended slab */
+   int n;                    /* Number of pixels set in Quality array */
+   int off[ 3 ];             /* Offset of core within extended slab */
+   int osect;                /* Identifier for output slab section */
+   int ubnd[ 3 ];            /* Upper bounds of extended slab */
+   void *ipd;                /* Pointer to mapped input Data array */
+   void *ipo;                /* Pointer to mapped output Data array */
+   void *ipq;                /* Pointer to mapped output Quality array */
+
+/* Abort if an error has already occurred. */
+   if( *status != SAI__OK ) return;
+
+/* Initialise the bounds of the extended slab, and the offset of its core. */
+   for( i = 0; i < nsig; i++ ) {
+      lbnd[ i ] = slbnd[ i ];
+      ubnd[ i ] = subnd[ i ];
+   }
+   for( i = 0; i < 3; i++ ) off[ i ] = 0;
+
+/* Loop round each slab. */
+   for( corelo = slbnd[ slabax ]; corelo <= subnd[ slabax ] &&
+        *status == SAI__OK; corelo += slabsize ) {
+      corehi = corelo + slabsize - 1;
+      if( corehi > subnd[ slabax ] ) corehi = subnd[ slabax ];
+
+/* Extend the core by one pixel plane on each side, where possible. */
+      lbnd[ slabax ] = ( corelo > slbnd[ slabax ] ) ? corelo - 1 : corelo;
+      ubnd[ slabax ] = ( corehi < subnd[ slabax ] ) ? corehi + 1 : corehi;
+      off[ slabax ] = corelo - lbnd[ slabax ];
+
+/* Find the dimensions of the extended slab and its core. */
+      eel = 1;
+      for( i = 0; i < 3; i++ ) {
+         if( i < nsig ) {
+            edims[ i ] = ubnd[ i ] - lbnd[ i ] + 1;
+            eskip[ i ] = ( i == 0 ) ? 1 : eskip[ i - 1 ]*edims[ i - 1 ];
+         } else {
+            edims[ i ] = 1;
+            eskip[ i ] = 0;
+         }
+         cdims[ i ] = edims[ i ];
+         eel *= edims[ i ];
+      }
+      cdims[ slabax ] = corehi - corelo + 1;
+
+/* Sum the clumps within the extended slab, masking out any bad input
+   pixels. */
+      ndfBegin();
+      rmask = astMalloc( sizeof( *rmask )*(size_t) eel );
+      iout = astMalloc( sizeof( *iout )*(size_t) eel );
+      isect = cupidSlabSect( indf, slabax, lbnd[ slabax ], ubnd[ slabax ],
+                             status );
+      ndfMap( isect, "DATA", ( type == CUPID__DOUBLE ) ? "_DOUBLE" : "_REAL",
+              "READ", &ipd, &el, status );
+      cupidSumClumps( type, ipd, nsig, lbnd, ubnd, eel, ndfs, rmask, iout,
+                      method, status );
+      ndfAnnul( &isect, status );
+
+/* Store the clump indices for the core in the output Data array. */
+      osect = cupidSlabSect( indf2, slabax, corelo, corehi, status );
+      ndfMap( osect, "DATA", "_INTEGER", "WRITE", &ipo, &el, status );
+      if( *status == SAI__OK ) {
+         cupid1Core( (char *) iout, edims, off, cdims, sizeof( *iout ),
+                     (char *) ipo );
+      }
+      ndfUnmap( osect, "DATA", status );
+
+/* Ensure the Quality array of the core is defined before IRQ updates it,
+   so that no undefined values are left in it. */
+      ndfMap( osect, "QUALITY", "_UBYTE", "WRITE/ZERO", &ipq, &el, status );
+      ndfUnmap( osect, "QUALITY", status );
+
+/* Transfer the pixel mask for the core to the Quality array. */
+      cmask = astMalloc( sizeof( *cmask )*(size_t) el );
+      qlocs = NULL;
+      irqFind( osect, &qlocs, xname, status );
+      if( *status == SAI__OK ) {
+         cupid1Core( (char *) rmask, edims, off, cdims, sizeof( *rmask ),
+                     (char *) cmask );
+      }
+      irqSetqm( qlocs, 1, "BACKGROUND", el, cmask, &n, status );
+      irqSetqm( qlocs, 0, "CLUMP", el, cmask, &n, status );
+
+/* Find the edges of the clumps within the extended slab, and then set
+   the "EDGE" Quality flag for the core. */
+      cupidEdges( rmask, eel, edims, eskip, 1.0, VAL__BADR, status );
+      if( *status == SAI__OK ) {
+         cupid1Core( (char *) rmask, edims, off, cdims, sizeof( *rmask ),
+                     (char *) cmask );
+      }
+      irqSetqm( qlocs, 0, "EDGE", el, cmask, &n, status );
+
+/* Free resources. */
+      if( qlocs ) irqRlse( &qlocs, status );
+      ndfAnnul( &osect, status );
+      cmask = astFree( cmask );
+      rmask = astFree( rmask );
+      iout = astFree( iout );
+      ndfEnd( status );
+   }
+}
+
+static void cupid1Core( const char *ext, int edims[ 3 ], int off[ 3 ],
+                        int cdims[ 3 ], size_t size, char *core ){
+/*
+*  Name:
+*     cupid1Core
+
+*  Purpose:
+*     Copy the core of an extended slab into a separate array.
+
+*  Description:
+*     This function copies the elements of the sub-array with dimensions
+*     "cdims", starting at offset "off" within the array "ext" (which has
+*     dimensions "edims"), into the array "core". Each element occupies
+*     "size" bytes.
+
+*/
+
+/* Local Variables: */
+   int iy;                   /* Row index on axis 2 */
+   int iz;                   /* Plane index on axis 3 */
+   size_t rowlen;            /* Number of bytes in each row of the core */
+
+   rowlen = cdims[ 0 ]*size;
+   for( iz = 0; iz < cdims[ 2 ]; iz++ ) {
+      for( iy = 0; iy < cdims[ 1 ]; iy++ ) {
+         memcpy( core, ext + ( off[ 0 ] + edims[ 0 ]*( ( iy + off[ 1 ] ) +
+                 edims[ 1 ]*( iz + off[ 2 ] ) ) )*size, rowlen );
+         core += rowlen;
+      }
+   }
+}
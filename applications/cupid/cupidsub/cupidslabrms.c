@@ -0,0 +1,153 @@
+#include "sae_par.h"
+#include "prm_par.h"
+#include "mers.h"
+#include "ndf.h"
+#include "cupid.h"
+#include <math.h>
+
+double cupidSlabRms( int type, int indf, int *slbnd, int *subnd, int slabax,
+                     int slabsize, int var, int *status ){
+/*
+*+
+*  Name:
+*     cupidSlabRms
+
+*  Purpose:
+*     Find the default RMS noise level one slab at a time.
+
+*  Language:
+*     Starlink C
+
+*  Synopsis:
+*     double cupidSlabRms( int type, int indf, int *slbnd, int *subnd,
+*                          int slabax, int slabsize, int var, int *status )
+
+*  Description:
+*     This function returns the default RMS noise level used by
+*     FINDCLUMPS, without mapping the whole of the supplied NDF at once.
+*     The NDF is divided into non-overlapping slabs along a significant
+*     pixel axis, and each slab is mapped in turn.
+*
+*     If "var" is non-zero, the returned value is the square root of the
+*     mean of all the good Variance values, exactly as for the whole
+*     array. Otherwise, the noise in each slab is estimated using
+*     cupidRms and the returned value is the square root of the mean of
+*     the squared slab estimates, weighted by the number of pixels in
+*     each slab.
+
+*  Parameters:
+*     type
+*        An integer identifying the data type in which the Data array
+*        should be mapped (CUPID__FLOAT or CUPID__DOUBLE).
+*     indf
+*        Identifier for the NDF.
+*     slbnd
+*        The lower pixel bounds of the significant pixel axes of the NDF.
+*     subnd
+*        The upper pixel bounds of the significant pixel axes of the NDF.
+*     slabax
+*        The zero-based index of the significant pixel axis along which
+*        the NDF is divided into slabs.
+*     slabsize
+*        The number of pixel planes in each slab.
+*     var
+*        Should the Variance array be used?
+*     status
+*        Pointer to the inherited status value.
+
+*  Returned Value:
+*     The RMS noise level. VAL__BADD is returned if "var" is non-zero and
+*     the Variance array contains no good values.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+/* Local Variables: */
+   double *ipv;           /* Pointer to mapped slab Variance array */
+   double rms;            /* RMS noise in slab */
+   double ret;            /* Returned value */
+   double sum;            /* Sum of variances */
+   int el;                /* Number of pixels in slab */
+   int hi;                /* Upper bound of slab on slab axis */
+   int i;                 /* Pixel index */
+   int isect;             /* Identifier for slab section */
+   int lo;                /* Lower bound of slab on slab axis */
+   size_t n;              /* Number of values summed in "sum" */
+   void *ipd;             /* Pointer to mapped slab Data array */
+
+/* Initialise */
+   ret = VAL__BADD;
+
+/* Abort if an error has already occurred. */
+   if( *status != SAI__OK ) return ret;
+
+/* Loop round each slab. */
+   sum = 0.0;
+   n = 0;
+   for( lo = slbnd[ slabax ]; lo <= subnd[ slabax ] && *status == SAI__OK;
+        lo += slabsize ) {
+      hi = lo + slabsize - 1;
+      if( hi > subnd[ slabax ] ) hi = subnd[ slabax ];
+      isect = cupidSlabSect( indf, slabax, lo, hi, status );
+
+/* Either sum the good variances, or sum the squared noise estimate for
+   each pixel in the slab. */
+      if( var ) {
+         ndfMap( isect, "VARIANCE", "_DOUBLE", "READ", (void *) &ipv, &el,
+                 status );
+         if( *status == SAI__OK ) {
+            for( i = 0; i < el; i++ ) {
+               if( ipv[ i ] != VAL__BADD ) {
+                  sum += ipv[ i ];
+                  n++;
+               }
+            }
+         }
+
+      } else {
+         ndfMap( isect, "DATA", ( type == CUPID__DOUBLE ) ? "_DOUBLE" :
+                 "_REAL", "READ", &ipd, &el, status );
+         rms = cupidRms( type, ipd, el, ( slabax == 0 ) ? hi - lo + 1 :
+                         subnd[ 0 ] - slbnd[ 0 ] + 1, status );
+         if( *status == SAI__OK ) {
+            sum += rms*rms*el;
+            n += el;
+         }
+      }
+
+      ndfAnnul( &isect, status );
+   }
+
+/* Form the returned value. */
+   if( n > 0 && *status == SAI__OK ) ret = sqrt( sum/n );
+
+   return ret;
+}
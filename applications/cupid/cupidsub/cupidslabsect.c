@@ -0,0 +1,106 @@
+#include "sae_par.h"
+#include "ndf.h"
+#include "cupid.h"
+
+int cupidSlabSect( int indf, int slabax, int lo, int hi, int *status ){
+/*
+*+
+*  Name:
+*     cupidSlabSect
+
+*  Purpose:
+*     Create an NDF section covering a slab of the supplied NDF.
+
+*  Language:
+*     Starlink C
+
+*  Synopsis:
+*     int cupidSlabSect( int indf, int slabax, int lo, int hi, int *status )
+
+*  Description:
+*     This function returns an identifier for a section of the supplied
+*     NDF that has the same bounds as the NDF on all pixel axes except
+*     one, which has the supplied bounds. Sections are used in preference
+*     to the blocks created by ndfBlock, since adjacent slabs need to be
+*     able to overlap.
+
+*  Parameters:
+*     indf
+*        Identifier for the NDF.
+*     slabax
+*        The zero-based index of the axis to be restricted, counting only
+*        significant pixel axes (i.e. axes spanning more than one pixel).
+*     lo
+*        The lower pixel index bound of the section on axis "slabax".
+*     hi
+*        The upper pixel index bound of the section on axis "slabax".
+*     status
+*        Pointer to the inherited status value.
+
+*  Returned Value:
+*     An identifier for the section. NDF__NOID is returned if an error
+*     occurs.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+/* Local Variables: */
+   int i;                   /* Pixel axis index */
+   int isig;                /* Significant axis index */
+   int lbnd[ NDF__MXDIM ];  /* Lower pixel bounds of section */
+   int ndim;                /* Number of pixel axes */
+   int ret;                 /* Returned section identifier */
+   int ubnd[ NDF__MXDIM ];  /* Upper pixel bounds of section */
+
+/* Initialise */
+   ret = NDF__NOID;
+
+/* Abort if an error has already occurred. */
+   if( *status != SAI__OK ) return ret;
+
+/* Get the bounds of the NDF, and replace the bounds of the requested
+   significant axis. */
+   ndfBound( indf, NDF__MXDIM, lbnd, ubnd, &ndim, status );
+   isig = -1;
+   for( i = 0; i < ndim; i++ ) {
+      if( ubnd[ i ] > lbnd[ i ] && ++isig == slabax ) {
+         lbnd[ i ] = lo;
+         ubnd[ i ] = hi;
+         break;
+      }
+   }
+
+/* Create the section. */
+   ndfSect( indf, ndim, lbnd, ubnd, &ret, status );
+
+/* Return the section identifier. */
+   return ret;
+}
@@ -21,8 +21,9 @@
 #define LOGTAB   16   /* Width of one log file column, in characters */
 
 void cupidStoreClumps( const char *param1, const char *param2, int indf,
-                       HDSLoc *xloc, HDSLoc *obj, int ndim, int deconv,
-                       int backoff, int stccol, int velax, double beamcorr[ 3 ],
+                       HDSLoc *xloc, int batch, HDSLoc *obj, int ndim,
+                       int deconv, int backoff, int stccol, int velax,
+                       double beamcorr[ 3 ],
                        const char *ttl, int usewcs, AstFrameSet *iwcs,
                        const char *dataunits, Grp *hist,
                        FILE *logfile, int *nclumps, int *status ){
@@ -39,7 +40,8 @@ void cupidStoreClumps( const char *param1, const char *param2, int indf,
 
 *  Synopsis:
 *     void cupidStoreClumps( const char *param1, const char *param2, int indf,
-*                            HDSLoc *xloc, HDSLoc *obj, int ndim, int deconv,
+*                            HDSLoc *xloc, int batch, HDSLoc *obj, int ndim,
+*                            int deconv,
 *                            int backoff, int stccol, int velax,
 *                            double beamcorr[ 3 ], const char *ttl, int usewcs,
 *                            AstFrameSet *iwcs, const char *dataunits,
@@ -49,6 +51,14 @@ void cupidStoreClumps( const char *param1, const char *param2, int indf,
 *     This function optionally saves the clump properties in an output
 *     catalogue, and then copies the NDF describing the found clumps into
 *     the supplied CUPID extension.
+*
+*     Creating a separate HDS structure and NDF for every clump can take
+*     much longer than finding the clumps if there are many thousands of
+*     them. If "batch" is non-zero, the CUPID extension instead receives
+*     a single CLUMPTAB structure holding the parameters and pixel bounds
+*     of all the usable clumps. Together with the clump index array in
+*     the main output NDF, this allows the individual clump NDFs to be
+*     re-created later by EXTRACTCLUMPS if they are needed.
 
 *  Parameters:
 *     param1
@@ -66,6 +76,26 @@ void cupidStoreClumps( const char *param1, const char *param2, int indf,
 *     xloc
 *        HDS locator for the CUPID extension of the NDF in which to store
 *        the clump properties. May be NULL.
+*     batch
+*        If zero, an array of CLUMP structures called CLUMPS is stored in
+*        the CUPID extension, one for each usable clump, holding the clump
+*        parameters, a copy of the clump NDF (MODEL) and the clump outline
+*        (OUTLINE). If non-zero, a single structure called CLUMPTAB is
+*        stored instead, containing the following components, in which the
+*        clumps are stored in the same order as the clump indices used in
+*        the main output NDF:
+*
+*        - NAMES: A _CHAR array holding the names of the clump parameters.
+*        - UNITS: A _CHAR array holding the units of the clump parameters.
+*        - PARAMS: A 2-dimensional _DOUBLE array holding the parameter
+*        values, with the parameters of each clump on the first axis, and
+*        one element for each clump on the second axis.
+*        - LBND: A 2-dimensional _INTEGER array holding the lower pixel
+*        bounds of the box enclosing each clump, with one element for each
+*        pixel axis on the first axis.
+*        - UBND: As LBND, but holding the upper pixel bounds.
+*
+*        Ignored if "xloc" is NULL.
 *     obj
 *        A locator for an HDS array the clump NDF structures.
 *     ndim
@@ -135,6 +165,7 @@ void cupidStoreClumps( const char *param1, const char *param2, int indf,
 *  Copyright:
 *     Copyright (C) 2005 Particle Physics & Astronomy Research Council.
 *     Copyright (C) 2008-2013 Science & Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -201,6 +232,8 @@ void cupidStoreClumps( const char *param1, const char *param2, int indf,
 *        Switch off group history and provenance recording during this
 *        function. This is because it can inflate the time taken to run
 *        findclumps enormously if there are many thousands of clumps.
+*     14-OCT-2026:
+*        Added argument "batch".
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -223,6 +256,7 @@ void cupidStoreClumps( const char *param1, const char *param2, int indf,
    HDSLoc *cloc;            /* Locator for array cell */
    HDSLoc *dloc;            /* Locator for cell value */
    HDSLoc *ncloc;           /* Locator for array cell */
+   HDSLoc *tloc;            /* Locator for CLUMPTAB structure */
    NdgProvenance *prov;     /* Provenance info from input NDF */
    char *line = NULL;       /* Pointer to buffer for log file output */
    char *p1;                /* Pointer to next character */
@@ -240,22 +274,29 @@ void cupidStoreClumps( const char *param1, const char *param2, int indf,
    const char *cname;       /* Pointer to column name string */
    const char *dom;         /* Pointer to domain string */
    double *cpars;           /* Array of parameters for a single clump */
+   double *pars;            /* Parameters of all usable clumps */
    double *t;               /* Pointer to next table value */
    double *tab;             /* Pointer to catalogue table */
    double *tj;              /* Pointer to next table entry to write*/
    fitsfile *fptr;          /* Pointer to FITS file structure */
+   int *clbnd;              /* Lower pixel bounds of all usable clumps */
+   int *cubnd;              /* Upper pixel bounds of all usable clumps */
    int bad;                 /* Does clump touch an area of bad pixels? */
+   int idim;                /* Zero based pixel axis index */
    hdsdim i;                /* Index of next locator */
    hdsdim iclump;           /* Usable clump index */
+   hdsdim tdims[ 2 ];       /* Dimensions of a CLUMPTAB array */
    int icol;                /* Zero based column index */
    int ifrm;                /* Frame index */
    int indf1;               /* Identifier for supplied NDF */
    int indf2;               /* Identifier for copied NDF */
    int irow;                /* One-based row index */
    int istc;                /* Number of STC-S descriptions created */
+   int lbnd[ NDF__MXDIM ];  /* Lower pixel bounds of clump NDF */
    int nbad;                /* No. of clumps touching an area of bad pixels */
    int nc;                  /* Number of characters currently in "line" */
    int ncpar;               /* Number of clump parameters */
+   int nd;                  /* Number of pixel axes in clump NDF */
    int nfrm;                /* Total number of Frames */
    int nok;                 /* No. of usable clumps */
    int nsmall1;             /* No. of clumps smaller than the spatial beam size */
@@ -266,7 +307,9 @@ void cupidStoreClumps( const char *param1, const char *param2, int indf,
    int pixfrm;              /* Index of PIXEL Frame */
    int place;               /* Place holder for copied NDF */
    int there;               /* Does component exist?*/
+   int ubnd[ NDF__MXDIM ];  /* Upper pixel bounds of clump NDF */
    size_t max_stclen;       /* Max length of any STC string */
+   size_t maxlen;           /* Max length of any name or unit string */
    size_t nndf;             /* Total number of NDFs */
    size_t stclen;           /* Length of STC string */
 
@@ -287,18 +330,29 @@ void cupidStoreClumps( const char *param1, const char *param2, int indf,
 /* Get the total number of NDFs supplied. */
    datSize( obj, &nndf, status );
 
-/* If we are writing the information to an NDF extension, create an array
-   of "nndf" Clump structures in the extension, and get a locator to it. */
+/* If we are writing the information to an NDF extension, erase any
+   existing clump information. Then create an array of "nndf" Clump
+   structures in the extension, and get a locator to it. In batched mode,
+   just allocate arrays to hold the pixel bounds of every clump. */
+   aloc = NULL;
+   clbnd = NULL;
+   cubnd = NULL;
    if( xloc ) {
-      hdsdim ndfdims[1];
-      aloc = NULL;
       datThere( xloc, "CLUMPS", &there, status );
       if( there ) datErase( xloc, "CLUMPS", status );
-      ndfdims[0] = nndf;
-      datNew( xloc, "CLUMPS", "CLUMP", 1, ndfdims, status );
-      datFind( xloc, "CLUMPS", &aloc, status );
-   } else {
-      aloc = NULL;
+      datThere( xloc, "CLUMPTAB", &there, status );
+      if( there ) datErase( xloc, "CLUMPTAB", status );
+
+      if( batch ) {
+         clbnd = astMalloc( sizeof( *clbnd )*nndf*ndim );
+         cubnd = astMalloc( sizeof( *cubnd )*nndf*ndim );
+
+      } else {
+         hdsdim ndfdims[1];
+         ndfdims[0] = nndf;
+         datNew( xloc, "CLUMPS", "CLUMP", 1, ndfdims, status );
+         datFind( xloc, "CLUMPS", &aloc, status );
+      }
    }
 
 /* Indicate that no memory has yet been allocated to store the parameters
@@ -484,8 +538,20 @@ void cupidStoreClumps( const char *param1, const char *param2, int indf,
                t += nndf;
             }
 
-/* If required, put the clump parameters into the current CLUMP structure. */
-            if( aloc && ok > 0  ) {
+/* In batched mode, just record the pixel bounds of the clump. The
+   parameters are copied from "tab" once all clumps have been seen. */
+            if( cubnd && ok > 0 ) {
+               ndfBound( indf1, NDF__MXDIM, lbnd, ubnd, &nd, status );
+               for( idim = 0; idim < ndim; idim++ ) {
+                  clbnd[ iclump*ndim + idim ] = lbnd[ idim ];
+                  cubnd[ iclump*ndim + idim ] = ubnd[ idim ];
+               }
+               iclump++;
+               if( region ) region = astAnnul( region );
+
+/* Otherwise, if required, put the clump parameters into the current CLUMP
+   structure. */
+            } else if( aloc && ok > 0  ) {
 
 /* Get an HDS locator for the next cell in the array of CLUMP structures. */
                iclump++;
@@ -590,6 +656,70 @@ void cupidStoreClumps( const char *param1, const char *param2, int indf,
    if( aloc && iclump < nndf && iclump ) datAlter( aloc, 1, &iclump, status );
    *nclumps = iclump;
 
+/* In batched mode, store the names, units and values of the parameters of
+   all usable clumps, together with their pixel bounds, in a single
+   CLUMPTAB structure. The usable clumps are the rows of "tab" that do not
+   hold bad values. */
+   if( cubnd && iclump && *status == SAI__OK ) {
+      datNew( xloc, "CLUMPTAB", "CLUMP_TABLE", 0, NULL, status );
+      tloc = NULL;
+      datFind( xloc, "CLUMPTAB", &tloc, status );
+
+      maxlen = 1;
+      for( icol = 0; icol < ncpar; icol++ ) {
+         if( strlen( names[ icol ] ) > maxlen ) maxlen = strlen( names[ icol ] );
+         if( strlen( units[ icol ] ) > maxlen ) maxlen = strlen( units[ icol ] );
+      }
+
+      dloc = NULL;
+      datNew1C( tloc, "NAMES", maxlen, ncpar, status );
+      datFind( tloc, "NAMES", &dloc, status );
+      datPut1C( dloc, ncpar, names, status );
+      datAnnul( &dloc, status );
+
+      datNew1C( tloc, "UNITS", maxlen, ncpar, status );
+      datFind( tloc, "UNITS", &dloc, status );
+      datPut1C( dloc, ncpar, units, status );
+      datAnnul( &dloc, status );
+
+      pars = astMalloc( sizeof( *pars )*ncpar*iclump );
+      if( pars ) {
+         tj = pars;
+         for( irow = 0; tj < pars + ncpar*iclump; irow++ ) {
+            if( tab[ irow ] != VAL__BADD ) {
+               t = tab + irow;
+               for( icol = 0; icol < ncpar; icol++ ) {
+                  *(tj++) = *t;
+                  t += nndf;
+               }
+            }
+         }
+
+         tdims[ 0 ] = ncpar;
+         tdims[ 1 ] = iclump;
+         datNew( tloc, "PARAMS", "_DOUBLE", 2, tdims, status );
+         datFind( tloc, "PARAMS", &dloc, status );
+         datPutD( dloc, 2, tdims, pars, status );
+         datAnnul( &dloc, status );
+         pars = astFree( pars );
+      }
+
+      tdims[ 0 ] = ndim;
+      datNew( tloc, "LBND", "_INTEGER", 2, tdims, status );
+      datFind( tloc, "LBND", &dloc, status );
+      datPutI( dloc, 2, tdims, clbnd, status );
+      datAnnul( &dloc, status );
+
+      datNew( tloc, "UBND", "_INTEGER", 2, tdims, status );
+      datFind( tloc, "UBND", &dloc, status );
+      datPutI( dloc, 2, tdims, cubnd, status );
+      datAnnul( &dloc, status );
+
+      datAnnul( &tloc, status );
+   }
+   clbnd = astFree( clbnd );
+   cubnd = astFree( cubnd );
+
 /* Abort if an error has occurred. */
    if( *status != SAI__OK ) goto L999;
 
@@ -48,6 +48,12 @@ void extractclumps( int *status ) {
 *     of the output NDF, and may also be stored in an output catalogue.
 *     These are in the same form as the clump parameters created by the
 *     FINDCLUMPS command.
+*
+*     If FINDCLUMPS was run with parameter CLUMPNDFS set to FALSE, its
+*     output NDF holds only a table of clump parameters and bounds. Running
+*     EXTRACTCLUMPS with that NDF as the MASK, and the FINDCLUMPS input NDF
+*     as the DATA, creates the full CUPID extension including an NDF
+*     for each clump.
 
 *  Usage:
 *     extractclumps mask data out outcat
@@ -194,6 +200,7 @@ void extractclumps( int *status ) {
 *     Copyright (C) 2006 Particle Physics & Astronomy Research Council.
 *     Copyright (C) 2008,2013 Science & Technology Facilities Council.
 *     Copyright (C) 2009 University of British Columbia.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -235,6 +242,9 @@ void extractclumps( int *status ) {
 *        Add parameter JSACAT.
 *     15-OCT-2014 (SFG):
 *        Add paramter SHAPE.
+*     14-OCT-2026:
+*        Allow the mask to contain a CLUMPTAB structure in place of a
+*        CLUMPS array.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -604,11 +614,11 @@ void extractclumps( int *status ) {
    if( ndfs ) {
 
 /* Get a locator for the CUPID extension in the output NDF, creating a
-   new one if none exists. Erase any CLUMPS component from the extension. */
+   new one if none exists. Any CLUMPS or CLUMPTAB component in the
+   extension is replaced by cupidStoreClumps. */
       ndfXstat( indf3, "CUPID", &there, status );
       if( there ) {
          ndfXloc( indf3, "CUPID", "UPDATE", &xloc, status );
-         datErase( xloc, "CLUMPS", status );
       } else {
          ndfXnew( indf3, "CUPID", "CUPID_EXT", 0, NULL, &xloc, status );
       }
@@ -674,8 +684,8 @@ void extractclumps( int *status ) {
    (if needed). */
       ndfState( indf1, "WCS", &gotwcs, status );
       msgBlank( status );
-      cupidStoreClumps( "OUTCAT", "JSACAT", indf1, xloc, ndfs, nsig, deconv,
-                        backoff, ishape, velax, beamcorr, "Output from CUPID:EXTRACTCLUMPS",
+      cupidStoreClumps( "OUTCAT", "JSACAT", indf1, xloc, 0, ndfs, nsig,
+                        deconv, backoff, ishape, velax, beamcorr, "Output from CUPID:EXTRACTCLUMPS",
                         usewcs, gotwcs ? iwcs : NULL, dataunits, NULL, logfile,
                         &nclumps, status );
 
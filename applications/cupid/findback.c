@@ -189,6 +189,9 @@ void findback( int *status ){
 *        - Added parameter WLIM.
 *        - Fixed incorrect lower bounds when any insignificant axes are 
 *        present (this only affected debugging tools).
+*     14-OCT-2026:
+*        Divide the box filters between the threads when there is only
+*        one slice to process.
 *     {enter_further_changes_here}
 
 *-
@@ -493,8 +496,17 @@ void findback( int *status ){
             pdata->wlim = wlim;
             pdata->slice_size = slice_size;
 
-/* Submit a job to the workforce to process the current slice. */
-            thrAddJob( wf, 0, pdata, cupidFindback0, 0, NULL, status );
+/* If there is only one slice, process it in this thread, dividing each
+   box filter between the workers. Otherwise, submit a job to the
+   workforce to process the current slice, applying the box filters in
+   the worker thread. */
+            if( nslice == 1 ) {
+               pdata->wf = wf;
+               cupidFindback0( pdata, status );
+            } else {
+               pdata->wf = NULL;
+               thrAddJob( wf, 0, pdata, cupidFindback0, 0, NULL, status );
+            }
 
 /* Update pointers to the start of the next slice in the input and output
    arrays. */
@@ -135,6 +135,18 @@ void findclumps( int *status ) {
 *        Note, the other reported clump properties such as total data
 *        value, peak data value, etc, are always based on the full clump
 *        data values, including background. []
+*     CLUMPNDFS = _LOGICAL (Read)
+*        If TRUE, the CUPID extension of the output NDF contains a
+*        separate CLUMP structure for each clump, including an NDF holding
+*        the clump data values (see "Use of CUPID Extension" below).
+*        Creating these structures can take much longer than finding the
+*        clumps if there are many thousands of clumps. If FALSE, the CUPID
+*        extension instead contains a single CLUMPTAB structure holding
+*        the parameters and pixel bounds of all clumps. The individual
+*        clump NDFs can then be created later, if required, by running
+*        EXTRACTCLUMPS with the output NDF as the MASK and the input NDF
+*        as the DATA. CLUMPINFO cannot be used on an NDF created with
+*        CLUMPNDFS set to FALSE. [TRUE]
 *     CONFIG = GROUP (Read)
 *        Specifies values for the configuration parameters used by the
 *        clump finding algorithms. If the string "def" (case-insensitive)
@@ -401,6 +413,26 @@ void findclumps( int *status ) {
 *        otherwise. Note, if a JSA-style catalogue is being created an
 *        error will be reported if "Ellipse", "Ellipse2", "Ellipse 3"
 *        or "None" is selected. []
+*     SLABOVERLAP = _INTEGER (Read)
+*        The number of pixel planes by which each slab is extended on
+*        either side when SLABSIZE is non-zero. Each clump is retained
+*        only from the slab in which its lowest pixel plane lies, so a
+*        clump is found in full provided it spans no more than SLABOVERLAP
+*        pixel planes beyond the end of that slab. A warning is issued if
+*        any clumps may have been truncated. [20]
+*     SLABSIZE = _INTEGER (Read)
+*        If a positive value is supplied, the input NDF is processed in
+*        slabs of SLABSIZE pixel planes along the velocity axis (or the
+*        last significant pixel axis if there is no velocity axis), so
+*        that only one slab of the input and output NDFs need be held in
+*        memory at any time. This allows very large cubes to be processed.
+*        Each slab is extended by SLABOVERLAP pixel planes on either side,
+*        and the clumps found in all slabs are then combined. Clumps that
+*        straddle a slab boundary may differ slightly from those found
+*        when processing the whole array at once. Slabs can only be used
+*        with the ClumpFind and FellWalker methods. If zero is supplied,
+*        or if SLABSIZE is at least as large as the array, the whole input
+*        array is processed at once. [0]
 *     WCSPAR = _LOGICAL (Read)
 *        If a TRUE value is supplied, then the clump parameters stored in
 *        the output catalogue and in the CUPID extension of the output NDF,
@@ -440,6 +472,20 @@ void findclumps( int *status ) {
 *
 *     contour noclear "fred2.more.cupid.clumps(9).model" mode=good labpos=\!
 *
+*     - CLUMPTAB: This is created in place of CLUMPS if parameter
+*     CLUMPNDFS is FALSE. It contains the following components, in which
+*     the clump with index N in the output NDF is described by the Nth
+*     element of the last axis of each array:
+*
+*        - NAMES: The names of the clump parameters.
+*        - UNITS: The units of the clump parameters.
+*        - PARAMS: A 2-dimensional array holding the clump parameters,
+*        with one element for each parameter on the first axis.
+*        - LBND: A 2-dimensional array holding the lower pixel bounds of
+*        the box enclosing each clump, with one element for each pixel
+*        axis on the first axis.
+*        - UBND: As LBND, but holding the upper pixel bounds.
+*
 *     - CONFIG: Lists the algorithm configuration parameters used to
 *     identify the clumps (see parameter CONFIG).
 *
@@ -934,6 +980,10 @@ void findclumps( int *status ) {
 *        Ensure any pre-existing output NDF is deleted if no clumps are found.
 *     8-DEC-2017 (DSB):
 *        Add "Ellipse2" option for parameter SHAPE.
+*     14-OCT-2026:
+*        Add parameters SLABSIZE and SLABOVERLAP.
+*     14-OCT-2026:
+*        Add parameter CLUMPNDFS.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -982,6 +1032,7 @@ void findclumps( int *status ) {
    float *rmask;                /* Pointer to cump mask array */
    int backoff;                 /* Remove background when finding clump sizes? */
    int blockf;                  /* FITS file blocking factor */
+   int clumpndfs;               /* Create an NDF for each clump? */
    int confpar;                 /* Is this line a config parameter setting? */
    int deconv;                  /* Should clump parameters be deconvolved? */
    int dim[ NDF__MXDIM ];       /* Pixel axis dimensions */
@@ -1007,6 +1058,9 @@ void findclumps( int *status ) {
    int repconf;                 /* Report configuration? */
    int sdim[ NDF__MXDIM ];      /* The indices of the significant pixel axes */
    int skip[3];                 /* Pointer to array of axis skips */
+   int slabax;                  /* Significant axis along which slabs lie */
+   int slaboverlap;             /* Overlap between slabs, in pixel planes */
+   int slabsize;                /* Pixel planes in each slab (0 = no slabs) */
    int slbnd[ NDF__MXDIM ];     /* The lower bounds of the significant pixel axes */
    int subnd[ NDF__MXDIM ];     /* The upper bounds of the significant pixel axes */
    int there;                   /* Does object exist? */
@@ -1145,6 +1199,10 @@ void findclumps( int *status ) {
              status );
    parGet0l( "WCSPAR", &usewcs, status );
 
+/* See if a separate NDF is to be created for each clump in the CUPID
+   extension, or a single table of clump parameters and bounds. */
+   parGet0l( "CLUMPNDFS", &clumpndfs, status );
+
 /* Report an error if we are creating a JSA-style catalogue and the user
    has selected to use pixel axes. */
    if( jsacat && !usewcs && *status == SAI__OK ) {
@@ -1270,14 +1328,32 @@ void findclumps( int *status ) {
       type = CUPID__FLOAT;
    }
 
+/* See if the data is to be processed in slabs along the velocity axis,
+   or the last significant pixel axis if there is no velocity axis. Slabs
+   as large as the whole array are not needed. */
+   slabax = ( velax != -1 ) ? velax : nsig - 1;
+   if( slabax < 0 ) slabax = 0;
+   parGet0i( "SLABSIZE", &slabsize, status );
+   if( slabsize < 0 || slabsize >= dims[ slabax ] ) slabsize = 0;
+
+   slaboverlap = 0;
+   if( slabsize > 0 ) {
+      parGet0i( "SLABOVERLAP", &slaboverlap, status );
+      if( slaboverlap < 0 ) slaboverlap = 0;
+   }
+
 /* Map the Data array, and if present, variance array. The variance array
-   is always mapped as _DOUBLE. */
-   ndfMap( indf, "DATA", itype, "READ", &ipd, &el, status );
+   is always mapped as _DOUBLE. When using slabs, each slab is mapped
+   separately later on. */
    ndfState( indf, "VARIANCE", &var, status );
-   if( var ) {
-      ndfMap( indf, "VARIANCE", "_DOUBLE", "READ", (void *) &ipv, &el, status );
-   } else {
-      ipv = NULL;
+   ipd = NULL;
+   ipv = NULL;
+   if( !slabsize ) {
+      ndfMap( indf, "DATA", itype, "READ", &ipd, &el, status );
+      if( var ) {
+         ndfMap( indf, "VARIANCE", "_DOUBLE", "READ", (void *) &ipv, &el,
+                 status );
+      }
    }
 
    msgBlankif( MSG__NORM, status );
@@ -1325,6 +1401,14 @@ void findclumps( int *status ) {
    parChoic( "METHOD", "GAUSSCLUMPS", "GAUSSCLUMPS,CLUMPFIND,REINHOLD,"
              "FELLWALKER", 1, method, 15,  status );
 
+   if( slabsize && strcmp( method, "FELLWALKER" ) &&
+                   strcmp( method, "CLUMPFIND" ) && *status == SAI__OK ){
+      *status = SAI__ERROR;
+      msgSetc( "M", method );
+      errRep( "", "Parameter SLABSIZE has been set non-zero, but this "
+              "option cannot currently be used with METHOD=^M.", status );
+   }
+
 /* Get a keymap holding the configuration parameters for the method being
    used. */
    if( !astMapGet0A( keymap, method, (AstObject *) &aconfig ) ) {
@@ -1347,7 +1431,16 @@ void findclumps( int *status ) {
    Variance value. Otherwise, it is found by looking at differences between
    adjacent pixel values in the Data component. */
    if( rms == VAL__BADD ) {
-      if( *status == SAI__OK && var ) {
+      if( slabsize ) {
+         rms = cupidSlabRms( type, indf, slbnd, subnd, slabax, slabsize,
+                             var, status );
+         if( rms == VAL__BADD && *status == SAI__OK ) {
+            *status = SAI__ERROR;
+            errRep( "FINDCLUMPS_ERR3", "The supplied data contains insufficient "
+                    "good Variance values to continue.", status );
+         }
+
+      } else if( *status == SAI__OK && var ) {
 
          sum = 0.0;
          n = 0;
@@ -1400,7 +1493,12 @@ void findclumps( int *status ) {
    ndgHltpv( 0, &old, status );
 
 /* Switch for each method */
-   if( !strcmp( method, "GAUSSCLUMPS" ) ) {
+   if( slabsize ) {
+      ndfs = cupidSlabClumps( method, type, indf, nsig, slbnd, subnd, rms,
+                              aconfig, velax, perspectrum, beamcorr, slabax,
+                              slabsize, slaboverlap, &backoff, status );
+
+   } else if( !strcmp( method, "GAUSSCLUMPS" ) ) {
       ndfs = cupidGaussClumps( type, nsig, slbnd, subnd, ipd, ipv, rms,
                                aconfig, velax, beamcorr, status );
 
@@ -1469,6 +1567,14 @@ void findclumps( int *status ) {
    sprintf( buffer, "BACKOFF = %s", backoff ? "yes" : "no" );
    grpPut1( confgrp, buffer, 0, status );
 
+   if( slabsize ) {
+      sprintf( buffer, "SLABSIZE = %d", slabsize );
+      grpPut1( confgrp, buffer, 0, status );
+
+      sprintf( buffer, "SLABOVERLAP = %d", slaboverlap );
+      grpPut1( confgrp, buffer, 0, status );
+   }
+
 /* Issue a logfile header for the clump parameters. */
    if( logfile ) {
       fprintf( logfile, "           Clump properties:\n" );
@@ -1495,7 +1601,9 @@ void findclumps( int *status ) {
                  !strcmp( method, "REINHOLD" ) ||
                  !strcmp( method, "FELLWALKER" ) ) {
          ndfStype( "_INTEGER", indf2, "DATA", status );
-         ndfMap( indf2, "DATA", "_INTEGER", "WRITE", &ipo, &el, status );
+         if( !slabsize ) {
+            ndfMap( indf2, "DATA", "_INTEGER", "WRITE", &ipo, &el, status );
+         }
          ndfSbad( 1, indf2, "DATA", status );
 
       } else {
@@ -1520,8 +1628,8 @@ void findclumps( int *status ) {
    (if needed). This may reject further clumps (such clumps will have the
    "Unit" component set to "BAD"). */
       ndfState( indf, "WCS", &gotwcs, status );
-      cupidStoreClumps( "OUTCAT", "JSACAT", indf, xloc, ndfs, nsig, deconv,
-                        backoff, ishape, velax, beamcorr,
+      cupidStoreClumps( "OUTCAT", "JSACAT", indf, xloc, !clumpndfs, ndfs,
+                        nsig, deconv, backoff, ishape, velax, beamcorr,
                         "Output from CUPID:FINDCLUMPS", usewcs,
                         gotwcs ? iwcs : NULL, dataunits, confgrp, logfile,
                         &nclumps, status );
@@ -1530,12 +1638,14 @@ void findclumps( int *status ) {
 
 /* Allocate room for a mask holding bad values for points which are not
    inside any clump. */
-      rmask = astMalloc( sizeof( *rmask )*(size_t) el );
+      if( !slabsize ) {
+         rmask = astMalloc( sizeof( *rmask )*(size_t) el );
 
 /* Create any output NDF by summing the contents of the NDFs describing the
    found and usable clumps. This also fills the above mask array. */
-      cupidSumClumps( type, ipd, nsig, slbnd, subnd, el, ndfs,
-                      rmask, ipo, method, status );
+         cupidSumClumps( type, ipd, nsig, slbnd, subnd, el, ndfs,
+                         rmask, ipo, method, status );
+      }
 
 /* Delete any existing quality name information from the output NDF, and
    create a structure to hold new quality name info. */
@@ -1551,13 +1661,15 @@ void findclumps( int *status ) {
                 status );
 
 /* Transfer the pixel mask to the NDF quality array. */
-      irqSetqm( qlocs, 1, "BACKGROUND", el, rmask, &n, status );
-      irqSetqm( qlocs, 0, "CLUMP", el, rmask, &n, status );
+      if( !slabsize ) {
+         irqSetqm( qlocs, 1, "BACKGROUND", el, rmask, &n, status );
+         irqSetqm( qlocs, 0, "CLUMP", el, rmask, &n, status );
 
 /* Find the edges of the clumps (all other pixels will be set to
    VAL__BADR in "rmask"), and then set the "EDGE" Quality flag. */
-      cupidEdges( rmask, el, dims, skip, 1.0, VAL__BADR, status );
-      irqSetqm( qlocs, 0, "EDGE", el, rmask, &n, status );
+         cupidEdges( rmask, el, dims, skip, 1.0, VAL__BADR, status );
+         irqSetqm( qlocs, 0, "EDGE", el, rmask, &n, status );
+      }
 
 /* Store the configuration parameters relating to the used algorithm in the
    CUPID extension. We put them into a new KeyMap so that the CUPID NDF
@@ -1571,6 +1683,13 @@ void findclumps( int *status ) {
       rmask = astFree( rmask );
       irqRlse( &qlocs, status );
 
+/* When using slabs, create the clump indices and Quality flags in the
+   output NDF one slab at a time. */
+      if( slabsize ) {
+         cupidSlabMask( type, indf, indf2, nsig, slbnd, subnd, slabax,
+                        slabsize, ndfs, method, status );
+      }
+
 /* If required create the QOUT output NDF containing a copy of the input
    NDF (minus Quality). Annul the error if a null parameter value is
    supplied. */
@@ -801,16 +801,18 @@ void makeclumps( int *status ) {
       beamcorr[ 0 ] = 0.0;
       beamcorr[ 1 ] = 0.0;
       beamcorr[ 2 ] = 0.0;
-      cupidStoreClumps( "OUTCAT", NULL, NDF__NOID, xloc, obj_precat, sdims, 0,
-                        1, ishape, 2, beamcorr, "Output from CUPID:MAKECLUMPS",
-                        1, iwcs, "", NULL, NULL, &nclumps, status );
+      cupidStoreClumps( "OUTCAT", NULL, NDF__NOID, xloc, 0, obj_precat, sdims,
+                        0, 1, ishape, 2, beamcorr,
+                        "Output from CUPID:MAKECLUMPS", 1, iwcs, "", NULL,
+                        NULL, &nclumps, status );
    } else {
       beamcorr[ 0 ] = beamfwhm;
       beamcorr[ 1 ] = beamfwhm;
       beamcorr[ 2 ] = velfwhm;
-      cupidStoreClumps( "OUTCAT", NULL, NDF__NOID, xloc, obj, sdims, deconv, 1,
-                        ishape, 2, beamcorr, "Output from CUPID:MAKECLUMPS", 1,
-                        iwcs, "", NULL, NULL, &nclumps, status );
+      cupidStoreClumps( "OUTCAT", NULL, NDF__NOID, xloc, 0, obj, sdims, deconv,
+                        1, ishape, 2, beamcorr,
+                        "Output from CUPID:MAKECLUMPS", 1, iwcs, "", NULL,
+                        NULL, &nclumps, status );
    }
 
 /* Relase the extension locator.*/
@@ -36,6 +36,8 @@
  *  History:
  *     12-APR-1999 (PWD):
  *        Original version.
+ *     14-OCT-2026:
+ *        Added ContourLines and a cache of traced contours.
  *     {enter_changes_here}
  *-
  */
@@ -57,6 +59,54 @@ extern "C" {
 #define DEFER_JOIN_STRINGS(string1,string2) string1 ## string2
 #define JOIN_STRINGS(string1,string2) DEFER_JOIN_STRINGS(string1,string2)
 
+//  The contour lines traced at one level of a region of an image, in
+//  GRID coordinates. Line "i" has npts[i] positions, starting at element
+//  start[i] of the x and y arrays. The remaining members identify the
+//  image data, region and level, so that the lines can be kept in a
+//  cache and redrawn without being traced again.
+class ContourLines {
+
+public:
+  ContourLines();
+  ~ContourLines();
+
+  //  Add a line.
+  void add( const int npts, const double xl[], const double yl[] );
+
+  //  The lines.
+  int nlines;
+  int *npts;
+  int *start;
+  double *x;
+  double *y;
+
+  //  Number of points used in the contour (as returned by
+  //  drawContours), and the total number of positions stored.
+  int ndrawn;
+  int ntotal;
+
+  //  The image data, region and level that were contoured.
+  const void *data;
+  int nx;
+  int ny;
+  int type;
+  int swap;
+  int isfits;
+  int xlower;
+  int ylower;
+  int xsize;
+  int ysize;
+  double cval;
+  unsigned long checksum;
+
+  //  Next entry in the cache.
+  ContourLines *next;
+
+private:
+  int nlalloc;
+  int nxalloc;
+};
+
 class Contour {
 
 public:
@@ -109,6 +159,14 @@ public:
   //  NaN in the floating point.
   void setIsFITS( const int isfits) { isfits_ = isfits; }
 
+  //  Trace the contours for every stride'th level starting at first,
+  //  using the given workspace. Public for use by threads.
+  void traceLevels( ContourLines *lines[], const int nlines,
+                    const int first, const int stride, char *done );
+
+  //  Release all cached contour lines.
+  static void clearCache();
+
  protected:
   //  Pointer to imageIO object. This has the image data and its type.
   ImageIO imageio_;
@@ -365,6 +423,25 @@ public:
   void contPlot( const AstPlot *lplot, const int npts,
                  const double x[], const double y[] );
 
+  //  Trace the contour lines for a level.
+  void traceLevel( ContourLines *lines, char *done );
+
+  //  Checksum of the data in the region to be contoured.
+  unsigned long regionChecksum( const int xlower, const int ylower,
+                                const int xsize, const int ysize );
+
+  //  Look for traced lines in the cache.
+  ContourLines *findCached( const ContourLines& key );
+
+  //  Add traced lines to the cache, removing old entries to keep it
+  //  within size.
+  void addCached( ContourLines *lines );
+
+  //  The cache of traced contour lines, most recently used first, and
+  //  the number of positions it holds.
+  static ContourLines *cache_;
+  static long cacheSize_;
+
   //  Data type dependent definitions, use overloaded members.
 #define DATA_TYPE char
 #define DATA_FORMAT NDF
@@ -36,23 +36,51 @@
  * History:
  *    24-MAR-2009 (PWD):
  *       Original version.
+ *    14-OCT-2026:
+ *       Keep the decoded positions of the rows of the searched table.
  *-
  */
 
 #include "QueryResult.h"
 #include "WorldOrImageCoords.h"
 
+//  A decoded row position. The hash is of the strings the position was
+//  decoded from, so that changes to the table are noticed.
+typedef struct GaiaQueryPos {
+    unsigned long hash;
+    int status;
+    WorldOrImageCoords pos;
+} GaiaQueryPos;
+
 class GaiaQueryResult : public QueryResult
 {
 protected:
     //  If set true assume catalogure presents degrees, not sexagesimal.
     int assume_degrees_;
 
+    //  The positions of the rows of the table last searched. Decoding
+    //  these dominates the time taken by a search, so they are only
+    //  decoded again when the strings in a row change.
+    GaiaQueryPos *posCache_;
+    int posRows_;
+
+    //  Get the position of a row of a table being searched.
+    int rowPos( const TabTable& table, int row,
+                WorldOrImageCoords **pos );
+
+private:
+    //  Copying would share the position cache.
+    GaiaQueryResult( const GaiaQueryResult& );
+    GaiaQueryResult& operator=( const GaiaQueryResult& );
+
 public:
 
     //  Constructor: initialize empty table
     GaiaQueryResult();
 
+    //  Destructor.
+    virtual ~GaiaQueryResult();
+
     //  Get the position from the given row as world or image coords.
     virtual int getPos( int row, WorldOrImageCoords& pos ) const;
 
@@ -36,6 +36,8 @@
  *  History:
  *     23-JUL-2001 (PWD):
  *        Original version.
+ *     14-OCT-2026:
+ *        Added summed-area tables and threaded loops.
  *     {enter_changes_here}
  *-
  */
@@ -47,11 +49,25 @@
 
 #include <sys/types.h>
 #include <netinet/in.h>
+#if TCL_THREADS
+#include <pthread.h>
+#endif
 extern "C" {
 #include "img.h"
 }
 #include "ImageData.h"
 
+//  Partial statistics for a range of image rows. The sums are of the
+//  pixel values less a reference value.
+struct RegionStatsPart
+{
+    long pixels;
+    double min;
+    double max;
+    double total;
+    double stotal;
+};
+
 class RegionStats
 {
  public:
@@ -65,6 +81,26 @@ class RegionStats
     //  Calculate the statistics.
     void calc();
 
+    //  Set whether to use summed-area tables for the sums. These are
+    //  worth having when the same image is used for many regions, but
+    //  need the image data to remain unchanged.
+    void setUseTables( const int use ) { useTables_ = use; }
+
+    //  Discard the summed-area tables, use when the image data changes.
+    void reset();
+
+    //  Whether this object is for the given image data.
+    int sameImage( const ImageIO imio, const int swap );
+
+    //  Build the summed-area tables. Public for use by threads.
+    void buildTables();
+
+    //  Calculate the statistics for a range of rows of the region,
+    //  optionally just the minimum and maximum. Public for use by
+    //  threads.
+    void calcRows( const int y0, const int y1, const int sums,
+                   RegionStatsPart& part );
+
     //  Set the region of the image.
     void setRegion( const int x0, const int y0, const int x1, const int y1 );
 
@@ -105,6 +141,38 @@ class RegionStats
     //  native form).
     int swap_;
 
+    //  Array indices of the region being calculated.
+    int ix0_;
+    int iy0_;
+    int ix1_;
+    int iy1_;
+
+    //  Summed-area tables of the pixel values, their squares and the
+    //  number of good pixels. Each has an extra leading row and column
+    //  of zeros. The values are offset by tableRef_ to reduce rounding
+    //  errors. tableState_ is 0 when there are no tables, 1 when they
+    //  are being built and 2 when they are ready.
+    int useTables_;
+    int tableState_;
+    double tableRef_;
+    double *sumTable_;
+    double *sum2Table_;
+    int *countTable_;
+#if TCL_THREADS
+    pthread_t tableThread_;
+    pthread_mutex_t tableMutex_;
+#endif
+
+    //  Calculate the statistics of the region without the tables,
+    //  using several threads for large regions.
+    void calcDirect( const int sums, RegionStatsPart& part );
+
+    //  Get the sums for the region from the tables.
+    void tableSums( RegionStatsPart& part );
+
+    //  Combine partial statistics into the results.
+    void setResults( const RegionStatsPart& part, const double ref );
+
     //  Get pixel value from 2D array, "span" is second dimension. Use
     //  a macro to define this and expand for all possible data types.
 #define GENERATE_ARRAYVAL( T ) \
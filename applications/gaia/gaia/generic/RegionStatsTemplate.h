@@ -1,11 +1,17 @@
 //
 //  Declare data type dependent members of RegionStats class.
 //
-void calcNative( const DATA_TYPE *image, const int nx, const int ny,
-                 const double bscale, const double bzero,
-                 const int x0, const int y0, const int x1, const int y1 );
+void calcNative( const DATA_TYPE *image, const int nx,
+                 const int x0, const int y0, const int x1, const int y1,
+                 const int sums, RegionStatsPart& part );
 
-void calcSwap( const DATA_TYPE *image, const int nx, const int ny,
-               const double bscale, const double bzero,
-               const int x0, const int y0, const int x1, const int y1 );
+void calcSwap( const DATA_TYPE *image, const int nx,
+               const int x0, const int y0, const int x1, const int y1,
+               const int sums, RegionStatsPart& part );
+
+void tablesNative( const DATA_TYPE *image, const int nx, const int ny,
+                   double& ref, double *sums, double *sums2, int *counts );
+
+void tablesSwap( const DATA_TYPE *image, const int nx, const int ny,
+                 double& ref, double *sums, double *sums2, int *counts );
 
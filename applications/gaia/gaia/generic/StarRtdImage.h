@@ -75,6 +75,8 @@
  *        Added astgetcloneCmd.
  *     09-JUN-2012 (PWD):
  *        Added stcplotCmd.
+ *     14-OCT-2026:
+ *        Added qlStats_ to keep the UKIRT quick look statistics tables.
  *-
  */
 
@@ -86,6 +88,8 @@ extern "C" {
 #include "ast.h"
 }
 
+class RegionStats;
+
 //
 //  Image options used for image configuration. Note inheriting this struct
 //  means that it is no longer POD (in the C++ sense), so cannot be used with
@@ -624,6 +628,14 @@ class StarRtdImage : public Skycat
    int ql_y1;
    int ql_rowcut;
 
+   //  Statistics for the UKIRT quick look region. Kept between motion
+   //  events so that its tables can be reused.
+   RegionStats *qlStats_;
+
+   //  Whether real-time image events have been received, in which case
+   //  the image data may change at any time.
+   int qlRealtime_;
+
    // Flag indicating if image data has been updated externally.
    int volatile_;
 
@@ -16,6 +16,8 @@
  * History:
  *    09-JAN-2014 (PWD):
  *       Original version.
+ *    14-OCT-2026:
+ *       Divide the region between threads when forming the histogram.
  *    {enter_changes_here}
  *-
  */
@@ -62,6 +64,15 @@ typedef struct Histogram {
     double psd;             /* Width of parabolic fit to histogram (bins) */
 } Histogram;
 
+/**  Partial results for a range of rows. The histogram has an extra bin
+ *   for values that round up to NHIST, these are not used. */
+typedef struct HistogramPart {
+    double dmin;            /* Data minimum */
+    double dmax;            /* Data maximum */
+    long count;             /* Number of good and valid pixels */
+    int hist[NHIST+1];      /* The histogram */
+} HistogramPart;
+
 /**  Structure for passing data into GSL minimising functions. */
 typedef struct FunctionData {
     size_t n;
@@ -101,6 +112,10 @@ public:
   //  Set fraction of counts for mode bin.
   void setBinningFactor( const double factor ) { factor_ = factor; };
 
+  //  Scan a range of rows of the region. Public for use by threads.
+  void scanRows( const int pass, const int y0, const int y1,
+                 HistogramPart *part );
+
  protected:
 
   //  Pointer to imageIO object. This has the image data and its type.
@@ -124,6 +139,20 @@ public:
   //  Binning factor.
   double factor_;
 
+  //  The region being scanned (array indices), range of data values to
+  //  use and the zero point and scale of the bins (all unscaled).
+  int ix0_;
+  int iy0_;
+  int ix1_;
+  int iy1_;
+  double scanLow_;
+  double scanHigh_;
+  double binZero_;
+  double binScale_;
+
+  //  Scan the whole region, using several threads for large regions.
+  void scanRegion( const int pass, HistogramPart *part );
+
   //  Get pixel value from 2D array, "span" is second dimension. Use a
   //  macro to define this and expand for all possible data types.
 #define GENERATE_ARRAYVAL( T ) \
@@ -5,6 +5,7 @@
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <string.h>
 #if HAVE_CONFIG_H
 #include "config.h"     /* Local config.h */
 #endif
@@ -86,5 +87,62 @@ static inline unsigned short SWAP_USHORT( unsigned short x )
     return SWAP16( x );
 }
 
+/* Byte swap arrays of 2, 4 and 8 byte values in place. The values are
+ * copied in and out using memcpy so these can be used for any type, and
+ * the loops are simple enough for the compiler to vectorise (using byte
+ * shuffles), which makes them much faster than swapping each value in
+ * turn with the functions above.
+ */
+#if defined(__GNUC__)
+#  define BSWAP16_(x) __builtin_bswap16(x)
+#  define BSWAP32_(x) __builtin_bswap32(x)
+#  define BSWAP64_(x) __builtin_bswap64(x)
+#else
+#  define BSWAP16_(x) \
+    ((unsigned short)((((x) >> 8) & 0xff) | (((x) & 0xff) << 8)))
+#  define BSWAP32_(x) \
+    ((((x) & 0xff000000U) >> 24) | (((x) & 0x00ff0000U) >>  8) | \
+     (((x) & 0x0000ff00U) <<  8) | (((x) & 0x000000ffU) << 24))
+#  define BSWAP64_(x) \
+    ( ( (unsigned long long) BSWAP32_( (unsigned int) (x) ) << 32 ) | \
+      BSWAP32_( (unsigned int) ( (x) >> 32 ) ) )
+#endif
+
+static inline void SWAP_ARRAY16( void *ptr, size_t nel )
+{
+    unsigned char *p = (unsigned char *) ptr;
+    unsigned short v;
+    size_t i;
+    for ( i = 0; i < nel; i++, p += 2 ) {
+        memcpy( &v, p, 2 );
+        v = BSWAP16_( v );
+        memcpy( p, &v, 2 );
+    }
+}
+
+static inline void SWAP_ARRAY32( void *ptr, size_t nel )
+{
+    unsigned char *p = (unsigned char *) ptr;
+    unsigned int v;
+    size_t i;
+    for ( i = 0; i < nel; i++, p += 4 ) {
+        memcpy( &v, p, 4 );
+        v = BSWAP32_( v );
+        memcpy( p, &v, 4 );
+    }
+}
+
+static inline void SWAP_ARRAY64( void *ptr, size_t nel )
+{
+    unsigned char *p = (unsigned char *) ptr;
+    unsigned long long v;
+    size_t i;
+    for ( i = 0; i < nel; i++, p += 8 ) {
+        memcpy( &v, p, 8 );
+        v = BSWAP64_( v );
+        memcpy( p, &v, 8 );
+    }
+}
+
 #endif /* _BYTESWAP_INCLUDED_ */
 
@@ -63,6 +63,9 @@
  *         Changed to use public HDS C interface.
  *      02-SEP-2014 (TIMJ):
  *         Use DAT__FLEXT rather than explicit ".sdf"
+ *      14-OCT-2026:
+ *         Map read-only components using file mapping, so that data are
+ *         paged in as they are used, not read when the NDF is opened.
  *      {enter_changes_here}
  *-
  */
@@ -444,13 +447,21 @@ int gaiaCopyComponent( int ndfid, void **data, const char* component,
  *   Note:
  *      If the data values require modification, then a copy should be
  *      made instead.
+ *
+ *      READ access to a component in its native type uses file mapping,
+ *      if HDS can provide it, so that the data are paged in as they are
+ *      used rather than being read when the component is mapped. This
+ *      makes opening large images and cubes much faster.
  */
 int gaiaMapComponent( int ndfid, void **data, const char* component,
                       const char *access, char **error_mess )
 {
    char dtype[NDF__SZTYP+1];
    int el;
+   int oldmap = 0;
    int status = SAI__OK;
+   int tstatus;
+   int tuned = 0;
    void *ptr[1];
 
    /* Get the type of the NDF component. */
@@ -465,10 +476,22 @@ int gaiaMapComponent( int ndfid, void **data, const char* component,
        ndfType( ndfid, component, dtype, NDF__SZTYP+1, &status );
    }
 
-   /*  Trap _BYTE and map _WORD */
+   /*  Trap _BYTE and map _WORD. Otherwise use file mapping for READ
+    *  access, as no type conversion is needed. Tuning errors are not
+    *  fatal. */
    if ( strncmp( dtype, "_BYTE", 7 ) == 0 ) {
       strcpy( dtype, "_WORD" );
    }
+   else if ( status == SAI__OK && strcasecmp( access, "READ" ) == 0 ) {
+      hdsGtune( "MAP", &oldmap, &status );
+      hdsTune( "MAP", 1, &status );
+      if ( status == SAI__OK ) {
+         tuned = 1;
+      }
+      else {
+         emsAnnul( &status );
+      }
+   }
 
    /*  Take care to not pass back a random pointer if this fails
     *  (corrupt data component or invalid ERROR values). */
@@ -480,6 +503,17 @@ int gaiaMapComponent( int ndfid, void **data, const char* component,
        }
    }
 
+   /*  Restore the previous mapping mode. */
+   if ( tuned ) {
+      emsMark();
+      tstatus = SAI__OK;
+      hdsTune( "MAP", oldmap, &tstatus );
+      if ( tstatus != SAI__OK ) {
+         emsAnnul( &tstatus );
+      }
+      emsRlse();
+   }
+
    /* If an error occurred return an error message */
    if ( status != SAI__OK ) {
       *error_mess = gaiaUtilsErrMessage();
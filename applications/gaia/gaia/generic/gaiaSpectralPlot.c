@@ -18,6 +18,15 @@
  *
  *     The spectra can have error bars plotted using associated standard
  *     deviations.
+ *
+ *     Spectra with many more channels than there are pixels across the plot
+ *     are decimated before drawing. The minimum and maximum data values in
+ *     blocks of 2, 4, 8... channels are cached when the data are new. When
+ *     drawing, the largest blocks that each lie within one pixel column
+ *     are used, and each column is then reduced to its first, lowest,
+ *     highest and last points. This draws the same envelope as plotting
+ *     every channel, but at a cost set by the width of the plot rather
+ *     than the channel count.
 
  *  Notes:
  *     The reference spectrum idea is primitive and should not be
@@ -27,6 +36,7 @@
  *  Copyright:
  *     Copyright (C) 2006-2007 Particle Physics & Astronomy Research Council.
  *     Copyright (C) 2008-2009 Science and Technology Facilities Council.
+ *     Copyright (C) 2026 East Asian Observatory.
  *     All Rights Reserved.
 
  *  Licence:
@@ -51,6 +61,9 @@
  *  Changes:
  *     14-FEB-2006: (PWD)
  *        Original version.
+ *     14-OCT-2026:
+ *        Decimate spectra with many channels using cached min/max
+ *        envelopes.
  *-
  *.
  */
@@ -83,6 +96,31 @@
 /*  Length of the serifs on errors bars, pixels. */
 #define SERIF_LENGTH 2.5
 
+/*  Spectra with more than this many channels per pixel column are
+ *  decimated before drawing. */
+#define DECIMATE_FACTOR 4
+
+/*  Maximum number of envelope levels, and the number of blocks at which
+ *  no coarser levels are made. */
+#define MAX_LEVELS 32
+#define MIN_BLOCKS 16
+
+/*
+ * Cached envelope of a spectrum. Level l divides the channels into blocks
+ * of 2^(l+1) channels and records the indices of the channels holding the
+ * minimum and maximum good values in each block (-1 when all are bad),
+ * and whether any of the channels are bad.
+ */
+typedef struct SPEnvelope {
+    int nlevel;                 /* Number of levels */
+    int nblock[MAX_LEVELS];     /* Number of blocks in each level */
+    int *imin[MAX_LEVELS];      /* Index of minimum value in each block */
+    int *imax[MAX_LEVELS];      /* Index of maximum value in each block */
+    unsigned char *bad[MAX_LEVELS]; /* Whether block has any bad values */
+    double *xwork;              /* Workspace for decimated coordinates */
+    double *ywork;              /* Workspace for decimated data values */
+} SPEnvelope;
+
 /*
  * Define a structure for containing all the necessary information
  * to describe an item.
@@ -101,6 +139,7 @@ typedef struct SPItem  {
     XColor *linecolour;         /* Foreground color for polyline */
     XColor *reflinecolour;      /* Foreground color for reference polyline */
     XColor *errorcolour;        /* Colour for any error bars */
+    SPEnvelope *envelopes[2];   /* Cached envelopes, reference and main */
     char *datalabel;            /* The data units label */
     char *dataunits;            /* The data units */
     char *options;              /* AST options used when drawing item */
@@ -309,6 +348,15 @@ static void ClearSubItems( Tk_Canvas canvas, SPItem *spPtr );
 static void ComputeBBox( Tk_Canvas canvas, SPItem *spPtr );
 static void GeneratePlotFrameSet( SPItem *spPtr );
 static void MakeSpectral( SPItem *spPtr );
+static SPEnvelope *MakeEnvelope( const double *dataPtr, int numPoints,
+                                 double badvalue );
+static void FreeEnvelope( SPEnvelope **envPtr );
+static int DecimateSpectrum( SPItem *spPtr, int which,
+                             const double *dataPtr );
+static int AddBlock( SPItem *spPtr, SPEnvelope *envPtr,
+                     const double *dataPtr, int l, int b, double offset,
+                     double slope, int n );
+static int DecimateColumns( double *x, double *y, int n );
 
 /*
  * The structure below defines the item type, by means of procedures that can
@@ -394,6 +442,8 @@ static int SPCreate( Tcl_Interp *interp, Tk_Canvas canvas, Tk_Item *itemPtr,
     spPtr->dataPtr = NULL;
     spPtr->datalabel = NULL;
     spPtr->dataunits = NULL;
+    spPtr->envelopes[0] = NULL;
+    spPtr->envelopes[1] = NULL;
     spPtr->errorcolour = None;
     spPtr->fixdatarange = 0;
     spPtr->fixedscale = 0;
@@ -679,6 +729,7 @@ static int SPCoords( Tcl_Interp *interp, Tk_Canvas canvas, Tk_Item *itemPtr,
         /* If the address is 0 and this is a reference spectrum, that's a
            request to clear it, just do that and return. */
         if ( isref && adr == 0L ) {
+            FreeEnvelope( &spPtr->envelopes[0] );
             if ( spPtr->refDataPtr != NULL ) {
                 ckfree( (char *) spPtr->refDataPtr );
                 spPtr->refDataPtr = NULL;
@@ -797,6 +848,13 @@ static int SPCoords( Tcl_Interp *interp, Tk_Canvas canvas, Tk_Item *itemPtr,
     }
     spPtr->numPoints = nel;
 
+    /* New data values, so the cached envelope is no longer valid. Also
+     * drop that of the reference spectrum if it has been discarded. */
+    FreeEnvelope( &spPtr->envelopes[isref ? 0 : 1] );
+    if ( spPtr->refDataPtr == NULL ) {
+        FreeEnvelope( &spPtr->envelopes[0] );
+    }
+
     /* Read in data and work out limits */
     spPtr->ymax = -DBL_MAX;
     spPtr->ymin = DBL_MAX;
@@ -968,6 +1026,8 @@ static void SPDelete( Tk_Canvas canvas, Tk_Item *itemPtr, Display *display )
     if ( spPtr->tmpPtr[1] != NULL ) {
         ckfree( (char *) spPtr->tmpPtr[1] );
     }
+    FreeEnvelope( &spPtr->envelopes[0] );
+    FreeEnvelope( &spPtr->envelopes[1] );
     spPtr->numPoints = 0;
 
     if ( spPtr->framesets[0] != NULL ) {
@@ -1034,6 +1094,8 @@ static void SPDisplay( Tk_Canvas canvas, Tk_Item *itemPtr, Display *display,
     int current;
     int i;
     int j;
+    int nplot;
+    int npix;
     int xborder;
     int yborder;
 
@@ -1197,13 +1259,22 @@ static void SPDisplay( Tk_Canvas canvas, Tk_Item *itemPtr, Display *display,
                 segment = spPtr->mainsegment;
             }
 
-            astTran2( spPtr->plot, spPtr->numPoints, spPtr->coordPtr,
-                      dataPtr, 0, spPtr->tmpPtr[0], spPtr->tmpPtr[1] );
+            /* Spectra with many channels per pixel column are decimated,
+             * otherwise transform all the points. */
+            npix = (int) ( spPtr->header.x2 - spPtr->header.x1 );
+            if ( npix > 0 && spPtr->numPoints > DECIMATE_FACTOR * npix ) {
+                nplot = DecimateSpectrum( spPtr, i, dataPtr );
+            }
+            else {
+                astTran2( spPtr->plot, spPtr->numPoints, spPtr->coordPtr,
+                          dataPtr, 0, spPtr->tmpPtr[0], spPtr->tmpPtr[1] );
+                nplot = spPtr->numPoints;
+            }
 
             /* Set line coordinates */
             RtdLineQuickSetCoords( spPtr->interp, canvas, polyline,
                                    spPtr->tmpPtr[0], spPtr->tmpPtr[1],
-                                   spPtr->numPoints );
+                                   nplot );
 
             RtdLineSetColour( tkwin, display, polyline, linecolour );
             RtdLineSetWidth( display, polyline, spPtr->linewidth );
@@ -2043,3 +2114,325 @@ static void MakeSpectral( SPItem *spPtr )
     }
     astEnd;
 }
+
+/**
+ * MakeEnvelope --
+ *
+ *     Create the cached min/max envelope of a spectrum. Each level is made
+ *     from the one below by combining pairs of blocks, so this takes a
+ *     single pass through the data values. Levels stop once there are
+ *     MIN_BLOCKS or fewer blocks.
+ */
+static SPEnvelope *MakeEnvelope( const double *dataPtr, int numPoints,
+                                 double badvalue )
+{
+    SPEnvelope *envPtr;
+    int *imax;
+    int *imin;
+    int *pmax = NULL;
+    int *pmin = NULL;
+    int b;
+    int hi;
+    int isbad;
+    int j;
+    int l;
+    int lo;
+    int n;
+    int nb;
+    unsigned char *bad;
+    unsigned char *pbad = NULL;
+
+    envPtr = (SPEnvelope *) ckalloc( sizeof( SPEnvelope ) );
+    envPtr->nlevel = 0;
+
+    n = numPoints;
+    for ( l = 0; l < MAX_LEVELS && n > 1; l++ ) {
+        nb = ( n + 1 ) / 2;
+        imin = (int *) ckalloc( sizeof( int ) * nb );
+        imax = (int *) ckalloc( sizeof( int ) * nb );
+        bad = (unsigned char *) ckalloc( nb );
+
+        for ( b = 0; b < nb; b++ ) {
+            imin[b] = -1;
+            imax[b] = -1;
+            bad[b] = 0;
+            for ( j = 2 * b; j < 2 * b + 2 && j < n; j++ ) {
+                if ( l == 0 ) {
+                    lo = ( dataPtr[j] != badvalue ) ? j : -1;
+                    hi = lo;
+                    isbad = ( lo == -1 );
+                }
+                else {
+                    lo = pmin[j];
+                    hi = pmax[j];
+                    isbad = pbad[j];
+                }
+                if ( isbad ) {
+                    bad[b] = 1;
+                }
+                if ( lo != -1 ) {
+                    if ( imin[b] == -1 || dataPtr[lo] < dataPtr[imin[b]] ) {
+                        imin[b] = lo;
+                    }
+                    if ( imax[b] == -1 || dataPtr[hi] > dataPtr[imax[b]] ) {
+                        imax[b] = hi;
+                    }
+                }
+            }
+        }
+
+        envPtr->nblock[l] = nb;
+        envPtr->imin[l] = imin;
+        envPtr->imax[l] = imax;
+        envPtr->bad[l] = bad;
+        envPtr->nlevel = l + 1;
+
+        pmin = imin;
+        pmax = imax;
+        pbad = bad;
+        n = nb;
+        if ( nb <= MIN_BLOCKS ) {
+            break;
+        }
+    }
+
+    /* Each block gives at most two extremes and a line break. */
+    n = ( envPtr->nlevel > 0 ) ? 3 * envPtr->nblock[0] : 1;
+    envPtr->xwork = (double *) ckalloc( sizeof( double ) * n );
+    envPtr->ywork = (double *) ckalloc( sizeof( double ) * n );
+    return envPtr;
+}
+
+/**
+ * FreeEnvelope --
+ *
+ *     Free a cached envelope, if any, and set the pointer to NULL.
+ */
+static void FreeEnvelope( SPEnvelope **envPtr )
+{
+    int l;
+    if ( *envPtr != NULL ) {
+        for ( l = 0; l < (*envPtr)->nlevel; l++ ) {
+            ckfree( (char *) (*envPtr)->imin[l] );
+            ckfree( (char *) (*envPtr)->imax[l] );
+            ckfree( (char *) (*envPtr)->bad[l] );
+        }
+        ckfree( (char *) (*envPtr)->xwork );
+        ckfree( (char *) (*envPtr)->ywork );
+        ckfree( (char *) *envPtr );
+        *envPtr = NULL;
+    }
+}
+
+/**
+ * DecimateSpectrum --
+ *
+ *     Transform a decimated version of a spectrum into canvas coordinates,
+ *     leaving the result in tmpPtr. The blocks of the coarsest envelope
+ *     level are visited in order, and any block whose channels fall in more
+ *     than one pixel column is replaced by its two halves from the level
+ *     below, so that the extremes of every block are drawn in the right
+ *     column and the plotted envelope is the same as that of the full
+ *     spectrum. The Plot maps the spectral coordinate linearly to canvas X
+ *     (see SPDisplay), so the column of each channel can be found without
+ *     using AST. "which" selects the reference (0) or main (1) spectrum.
+ *     Returns the number of points to plot.
+ */
+static int DecimateSpectrum( SPItem *spPtr, int which,
+                             const double *dataPtr )
+{
+    SPEnvelope *envPtr;
+    double cx[2];
+    double cy[2];
+    double gx[2];
+    double gy[2];
+    double slope;
+    int b;
+    int l;
+    int n;
+
+    if ( spPtr->envelopes[which] == NULL ) {
+        spPtr->envelopes[which] = MakeEnvelope( dataPtr, spPtr->numPoints,
+                                                spPtr->badvalue );
+    }
+    envPtr = spPtr->envelopes[which];
+
+    /* Get the linear transformation from spectral coordinate to canvas X.
+     * If that isn't possible just transform all the points. */
+    cx[0] = spPtr->coordPtr[0];
+    cx[1] = spPtr->coordPtr[spPtr->numPoints - 1];
+    cy[0] = cy[1] = spPtr->ybot;
+    astTran2( spPtr->plot, 2, cx, cy, 0, gx, gy );
+    if ( envPtr->nlevel == 0 || cx[0] == cx[1] || gx[0] == AST__BAD ||
+         gx[1] == AST__BAD ) {
+        astTran2( spPtr->plot, spPtr->numPoints, spPtr->coordPtr,
+                  dataPtr, 0, spPtr->tmpPtr[0], spPtr->tmpPtr[1] );
+        return spPtr->numPoints;
+    }
+    slope = ( gx[1] - gx[0] ) / ( cx[1] - cx[0] );
+
+    /* Gather the extremes of each block in channel order. */
+    n = 0;
+    l = envPtr->nlevel - 1;
+    for ( b = 0; b < envPtr->nblock[l]; b++ ) {
+        n = AddBlock( spPtr, envPtr, dataPtr, l, b, gx[0] - slope * cx[0],
+                      slope, n );
+    }
+
+    astTran2( spPtr->plot, n, envPtr->xwork, envPtr->ywork, 0,
+              spPtr->tmpPtr[0], spPtr->tmpPtr[1] );
+    return DecimateColumns( spPtr->tmpPtr[0], spPtr->tmpPtr[1], n );
+}
+
+/**
+ * AddBlock --
+ *
+ *     Append the extremes of block "b" of envelope level "l" to the
+ *     workspace of an envelope, which already holds "n" points, splitting
+ *     the block if its first and last channels are in different pixel
+ *     columns (canvas X is "offset" plus "slope" times the spectral
+ *     coordinate). Blocks with bad values are followed by a line break.
+ *     Returns the new number of points.
+ */
+static int AddBlock( SPItem *spPtr, SPEnvelope *envPtr,
+                     const double *dataPtr, int l, int b, double offset,
+                     double slope, int n )
+{
+    double *xPtr = envPtr->xwork;
+    double *yPtr = envPtr->ywork;
+    int first;
+    int i0;
+    int i1;
+    int j;
+    int last;
+
+    first = b << ( l + 1 );
+    last = MIN( first + ( 2 << l ), spPtr->numPoints ) - 1;
+
+    if ( floor( offset + slope * spPtr->coordPtr[first] ) !=
+         floor( offset + slope * spPtr->coordPtr[last] ) ) {
+
+        /* Split the block. The lowest level is made of channel pairs,
+         * so use the channels themselves. */
+        if ( l > 0 ) {
+            n = AddBlock( spPtr, envPtr, dataPtr, l - 1, 2 * b, offset,
+                          slope, n );
+            if ( 2 * b + 1 < envPtr->nblock[l - 1] ) {
+                n = AddBlock( spPtr, envPtr, dataPtr, l - 1, 2 * b + 1,
+                              offset, slope, n );
+            }
+        }
+        else {
+            for ( j = first; j <= last; j++ ) {
+                if ( dataPtr[j] != spPtr->badvalue ||
+                     n == 0 || yPtr[n-1] != spPtr->badvalue ) {
+                    xPtr[n] = spPtr->coordPtr[j];
+                    yPtr[n++] = dataPtr[j];
+                }
+            }
+        }
+        return n;
+    }
+
+    i0 = envPtr->imin[l][b];
+    i1 = envPtr->imax[l][b];
+    if ( i0 != -1 ) {
+        if ( i0 > i1 ) {
+            i0 = i1;
+            i1 = envPtr->imin[l][b];
+        }
+        xPtr[n] = spPtr->coordPtr[i0];
+        yPtr[n++] = dataPtr[i0];
+        if ( i1 != i0 ) {
+            xPtr[n] = spPtr->coordPtr[i1];
+            yPtr[n++] = dataPtr[i1];
+        }
+    }
+    if ( envPtr->bad[l][b] && ( n == 0 || yPtr[n-1] != spPtr->badvalue ) ) {
+        xPtr[n] = spPtr->coordPtr[first];
+        yPtr[n++] = spPtr->badvalue;
+    }
+    return n;
+}
+
+/**
+ * DecimateColumns --
+ *
+ *     Reduce each run of canvas coordinates that fall in the same pixel
+ *     column to its first, lowest, highest and last points, in their
+ *     original order. Bad points (line breaks) are kept, but runs of them
+ *     are reduced to one. The coordinates are modified in place and the
+ *     new number of points is returned.
+ */
+static int DecimateColumns( double *x, double *y, int n )
+{
+    double px[4];
+    double py[4];
+    int col;
+    int hi;
+    int i;
+    int j;
+    int k;
+    int keep[4];
+    int lo;
+    int nkeep;
+    int nout = 0;
+
+    i = 0;
+    while ( i < n ) {
+
+        /* Line breaks. */
+        if ( x[i] == AST__BAD || y[i] == AST__BAD ) {
+            if ( nout == 0 || y[nout-1] != AST__BAD ) {
+                x[nout] = x[i];
+                y[nout++] = AST__BAD;
+            }
+            i++;
+            continue;
+        }
+
+        /* Find the end of the run of points in this column and the
+         * positions of its extremes. */
+        col = (int) floor( x[i] );
+        lo = i;
+        hi = i;
+        for ( j = i + 1; j < n; j++ ) {
+            if ( x[j] == AST__BAD || y[j] == AST__BAD ||
+                 (int) floor( x[j] ) != col ) {
+                break;
+            }
+            if ( y[j] < y[lo] ) lo = j;
+            if ( y[j] > y[hi] ) hi = j;
+        }
+
+        /* Short runs are kept as they are. Otherwise keep the first,
+         * extreme and last points, reading them all before any are
+         * overwritten (nout never exceeds i). */
+        if ( j - i <= 4 ) {
+            for ( k = i; k < j; k++ ) {
+                x[nout] = x[k];
+                y[nout++] = y[k];
+            }
+        }
+        else {
+            keep[0] = i;
+            keep[1] = MIN( lo, hi );
+            keep[2] = MAX( lo, hi );
+            keep[3] = j - 1;
+            nkeep = 0;
+            for ( k = 0; k < 4; k++ ) {
+                if ( nkeep == 0 || keep[k] != keep[nkeep-1] ) {
+                    keep[nkeep] = keep[k];
+                    px[nkeep] = x[keep[k]];
+                    py[nkeep++] = y[keep[k]];
+                }
+            }
+            for ( k = 0; k < nkeep; k++ ) {
+                x[nout] = px[k];
+                y[nout++] = py[k];
+            }
+        }
+        i = j;
+    }
+    return nout;
+}
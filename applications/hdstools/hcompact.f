@@ -0,0 +1,201 @@
+      SUBROUTINE HCOMPACT( STATUS )
+*+
+* Name:
+*    HCOMPACT
+
+* Purpose:
+*    Rewrite an HDS container file without unused space.
+
+* Language:
+*    Fortran 77
+
+* Type of Module:
+*    ADAM A-task
+
+* Usage:
+*    hcompact inp [out] [version]
+
+* ADAM Parameters:
+*    INP=UNIV (Read)
+*          The container file to be compacted. This must be a complete
+*          container file rather than an object within one.
+*    OUT=CHAR (Read)
+*          The name of the new container file. If a null (!) value is
+*          supplied, the compacted copy replaces the input file. [!]
+*    VERSION=_INTEGER (Read)
+*          The HDS data format of the new container file - 4 or 5. The
+*          default is the format used by HDS when creating new files
+*          (which may be set by the HDS_VERSION environment variable).
+
+* Description:
+*    Container files that are repeatedly extended and modified (for
+*    instance by adding history records or by HRESHAPE) accumulate
+*    unused space, and the components of each structure become spread
+*    through the file, so that later reads are slower than they need
+*    be. HCOMPACT copies the complete contents of a container file, in
+*    a single pass, to a new file in which there is no unused space and
+*    each object is stored contiguously. The new file may be written
+*    in either HDS data format, so HCOMPACT may also be used to convert
+*    files between the version 4 and version 5 formats.
+*
+*    If no output file is given, the copy is written to a temporary
+*    file alongside the input, which is then renamed to replace the
+*    input file. The input file is left unchanged if an error occurs.
+
+* Examples:
+*    % hcompact file
+*       Compact file.sdf in place.
+*
+*    % hcompact file newfile
+*       Write a compacted copy of file.sdf to newfile.sdf.
+*
+*    % hcompact file version=5
+*       Convert file.sdf to the HDS version 5 format.
+
+* Method:
+*    Uses HDS_COPY with the HDS VERSION tuning parameter set to the
+*    required format, and PSX_RENAME to replace the input file.
+
+* Deficiencies:
+*    The format of the input file is not known, so when replacing the
+*    input file the default format is used rather than that of the
+*    input.
+
+* Bugs:
+
+* Authors:
+*    {enter_new_authors_here}
+
+* History:
+*    14-OCT-2026:
+*       V1.0-0 Original version.
+*    {enter_further_changes_here}
+
+* Copyright:
+*    Copyright (C) 2026 East Asian Observatory.
+*    All Rights Reserved.
+*-
+
+*    Type Definitions :
+      IMPLICIT NONE
+
+*    Global constants :
+      INCLUDE 'SAE_PAR'
+      INCLUDE 'DAT_PAR'
+      INCLUDE 'MSG_PAR'
+      INCLUDE 'PAR_ERR'
+
+*    Status :
+      INTEGER STATUS
+
+*    External references :
+      INTEGER CHR_LEN
+
+*    Local Constants :
+      CHARACTER*(*) TMPSUF            ! Suffix for temporary file
+        PARAMETER (TMPSUF='_hcompact')
+
+*    Local variables :
+      CHARACTER*(DAT__SZLOC) ILOC     ! input locator
+      CHARACTER*(DAT__SZNAM) NAME     ! Top-level object name
+      CHARACTER*200 PATH              ! Input object path
+      CHARACTER*200 FILE              ! Input container file name
+      CHARACTER*200 OUT               ! Output container file name
+      CHARACTER*200 TMPFIL            ! Temporary output file name
+
+      INTEGER DEFVER                  ! Default HDS format
+      INTEGER HDSVER                  ! Required HDS format
+      INTEGER LFILE                   ! Used length of FILE
+      INTEGER NLEV                    ! Number of levels in PATH
+
+      LOGICAL INPLACE                 ! Replace input file?
+
+*    Version id :
+      CHARACTER*(22) VERSION
+        PARAMETER(VERSION= 'HCOMPACT Version 1.0-0')
+*.
+
+*    Check inherited global status.
+      IF ( STATUS .NE. SAI__OK ) RETURN
+
+*    Initialise Locators
+      ILOC = DAT__NOLOC
+
+*    Set MSG environment
+      CALL MSG_TUNE( 'ENVIRONMENT', 0, STATUS )
+
+*    Version id
+      CALL MSG_OUTIF( MSG__NORM, ' ', VERSION, STATUS )
+
+*    Associate the input object and check it is a top-level object
+      CALL DAT_ASSOC( 'INP', 'READ', ILOC, STATUS )
+      CALL HDS_TRACE( ILOC, NLEV, PATH, FILE, STATUS )
+      CALL DAT_NAME( ILOC, NAME, STATUS )
+      IF ( STATUS .EQ. SAI__OK .AND. NLEV .GT. 1 ) THEN
+         STATUS = SAI__ERROR
+         CALL MSG_SETC( 'OBJ', PATH )
+         CALL ERR_REP( ' ', '^OBJ is not a complete container file',
+     :                 STATUS )
+      END IF
+      IF ( STATUS .NE. SAI__OK ) GOTO 99
+
+*    Get the output file name. A null value means replace the input
+*    file, via a temporary file in the same directory.
+      INPLACE = .FALSE.
+      CALL PAR_GET0C( 'OUT', OUT, STATUS )
+      IF ( STATUS .EQ. PAR__NULL ) THEN
+         CALL ERR_ANNUL( STATUS )
+         INPLACE = .TRUE.
+         LFILE = CHR_LEN( FILE )
+         IF ( LFILE .GT. 4 ) THEN
+            IF ( FILE(LFILE-3:LFILE) .EQ. '.sdf' ) LFILE = LFILE - 4
+         END IF
+         TMPFIL = FILE(:LFILE)//TMPSUF
+         OUT = TMPFIL
+      END IF
+
+*    Get the required HDS format
+      CALL HDS_GTUNE( 'VERSION', DEFVER, STATUS )
+      CALL PAR_DEF0I( 'VERSION', DEFVER, STATUS )
+      CALL PAR_GET0I( 'VERSION', HDSVER, STATUS )
+      IF ( STATUS .EQ. SAI__OK .AND.
+     :     HDSVER .NE. 4 .AND. HDSVER .NE. 5 ) THEN
+         STATUS = SAI__ERROR
+         CALL MSG_SETI( 'V', HDSVER )
+         CALL ERR_REP( ' ', 'Invalid HDS version ^V - must be 4 or 5',
+     :                 STATUS )
+      END IF
+      IF ( STATUS .NE. SAI__OK ) GOTO 99
+
+*    Copy the whole container to the new file in the required format,
+*    restoring the default format afterwards even if the copy fails
+      CALL HDS_TUNE( 'VERSION', HDSVER, STATUS )
+      CALL HDS_COPY( ILOC, OUT, NAME, STATUS )
+      CALL ERR_BEGIN( STATUS )
+      CALL HDS_TUNE( 'VERSION', DEFVER, STATUS )
+      CALL ERR_END( STATUS )
+
+*    Close the input file before replacing it
+      CALL DAT_ANNUL( ILOC, STATUS )
+      ILOC = DAT__NOLOC
+      CALL DAT_CANCL( 'INP', STATUS )
+
+      IF ( INPLACE ) THEN
+         IF ( STATUS .EQ. SAI__OK ) THEN
+            CALL PSX_RENAME( TMPFIL(:CHR_LEN(TMPFIL))//'.sdf',
+     :                       FILE, STATUS )
+         ELSE
+
+*          Remove any partial copy, leaving the input file unchanged
+            CALL ERR_BEGIN( STATUS )
+            CALL PSX_REMOVE( TMPFIL(:CHR_LEN(TMPFIL))//'.sdf', STATUS )
+            IF ( STATUS .NE. SAI__OK ) CALL ERR_ANNUL( STATUS )
+            CALL ERR_END( STATUS )
+         END IF
+      END IF
+
+*    Tidy up
+ 99   CONTINUE
+      IF (ILOC .NE. DAT__NOLOC) CALL DAT_ANNUL( ILOC, STATUS )
+      CALL DAT_CANCL('INP', STATUS)
+      END
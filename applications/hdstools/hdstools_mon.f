@@ -37,6 +37,8 @@
 *        Add GRP and HDS locator tracking code.
 *     04-FEB-2007 (TIMJ):
 *        GRP not used by HDSTOOLS so don't check it.
+*     14-OCT-2026:
+*        Add HCOMPACT.
 *     {date} ({author_identifier}):
 *        {changes}
 *     {enter_further_changes_here}
@@ -94,7 +96,10 @@
 *  appropriate routine...
 
 
-      IF ( NAME .EQ. 'HCOPY' ) THEN
+      IF ( NAME .EQ. 'HCOMPACT' ) THEN
+         CALL HCOMPACT( STATUS )
+
+      ELSE IF ( NAME .EQ. 'HCOPY' ) THEN
          CALL HCOPY( STATUS )
 
       ELSE IF ( NAME .EQ. 'HCREATE' ) THEN
@@ -20,6 +20,10 @@
  *                      A.J.Chipperfield 25/01/94
  *      Use restore_adamstring in quoted_string_interpret
  *                      A.J.Chipperfield 28/11/96
+ *      Add folded_interpret() and fold_constants() to evaluate constant
+ *      expressions once, when they are parsed, and use lookup_name_value()
+ *      in name_interpret()
+ *                      14/10/2026
  *
  ******************************************************************************
  */
@@ -352,11 +356,11 @@ openstring_interpret(node *n, int op)
 value
 name_interpret(node *n, int op)
 {
-    extern value lookup_variable_value (char *name);		/* symtab.c */
+    extern value lookup_name_value (node *n);			/* symtab.c */
 
     switch (op) {
       case OP_INTERPRET:
-	return lookup_variable_value(string_part(n->val));
+	return lookup_name_value(n);
       case OP_PRINT:
 	outfpstring(string_part(n->val));
 	return noval;
@@ -765,6 +769,99 @@ reloperator_interpret(node *n, int op)
     }
 }
 
+/******************************************************************************
+ *
+ *	F O L D E D _ I N T E R P R E T (node *n, int op)
+ *
+ * The parser generates this node (via fold_constants()) in place of an
+ * arithmetic or relational operator node all of whose operands are
+ * constants. The value of the expression, evaluated once when it was parsed,
+ * is held in the node's value member and the sub[0] member points to the
+ * original expression, which is kept so that printing the node (by LIST
+ * etc.) regenerates the source as it was typed.
+ *
+ ******************************************************************************
+ */
+value
+folded_interpret(node *n, int op)
+{
+    switch (op) {
+      case OP_INTERPRET:
+	return n->val;
+      case OP_PRINT:
+	print(n->sub[0]);
+	return noval;
+      case OP_DESTROY:
+	return noval;
+      case OP_FORMAT:
+	return noval;
+      default:
+	interpret_fail("folded_interpret");
+	return noval;	/* for lint */
+    }
+}
+
+/******************************************************************************
+ *
+ *	I S _ C O N S T A N T (node *n)
+ *
+ * Returns TRUE if the node n is a numeric or logical constant, a folded
+ * constant expression or a parenthesised constant.
+ *
+ ******************************************************************************
+ */
+static int
+is_constant(node *n)
+{
+    if (n == NODENIL)
+	return FALSE;
+    else if (n->interpret == integer_interpret ||
+	     n->interpret == real_interpret ||
+	     n->interpret == logical_interpret ||
+	     n->interpret == folded_interpret)
+	return TRUE;
+    else if (n->interpret == paren_interpret)
+	return is_constant(n->sub[0]);
+    else
+	return FALSE;
+}
+
+/******************************************************************************
+ *
+ *	F O L D _ C O N S T A N T S (node *n)
+ *
+ * Called by the parser with a newly built unaryarith_interpret(),
+ * binaryoperator_interpret() or reloperator_interpret() node. If all the
+ * operands of the node are constants, the expression is evaluated now and a
+ * folded_interpret() node holding the result (and pointing to n) returned,
+ * so that the arithmetic is not repeated each time a procedure statement is
+ * executed. Otherwise, or if evaluating the expression gives an exception
+ * (which is then left to occur at run time as before), n is returned.
+ *
+ ******************************************************************************
+ */
+node *
+fold_constants(node *n)
+{
+    extern node *node1 (value (*interpreter)(), value val, node *n0);
+								/* node.c   */
+    int i;
+    node *folded;
+    value val;
+
+    if (n == NODENIL)
+	return n;
+    for (i = 0; i < n->n_nodes; i++)
+	if (!is_constant(n->sub[i]))
+	    return n;
+    if (isexc(val = interpret(n)))
+	return n;
+    else if ((folded = node1(folded_interpret, val, n)) == NODENIL)
+	return n;
+    else
+	return folded;
+}
+
 /******************************************************************************
  *
  *	F O R M A T _ I N T E R P R E T (node *n, int op)
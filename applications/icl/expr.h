@@ -32,6 +32,8 @@ extern value not_interpret		  ( node *n, int op );
 extern value unaryarith_interpret         ( node *n, int op );
 extern value binaryoperator_interpret     ( node *n, int op );
 extern value reloperator_interpret        ( node *n, int op );
+extern value folded_interpret             ( node *n, int op );
+extern node *fold_constants               ( node *n );
 extern value format_interpret             ( node *n, int op );
 extern value function_call_interpret      ( node *n, int op );
 extern value nonary_func_interpret        ( node *n, int op );
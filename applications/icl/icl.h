@@ -32,6 +32,9 @@ typedef struct _node
  	int n_nodes;
 	struct _node **sub;
 	value val;
+	struct _symtab *symtable;	/* Symbol table, entry and generation */
+	struct _symtab *symentry;	/* cached by symtab.c when a variable */
+	unsigned long symgen;		/* name is looked up		      */
  } node;
 /*
  * Node Structure nils.  NODENIL is defined in node.c
@@ -6,6 +6,8 @@
  *	Created :	S.K.Robinson	12/11/91
  *	Tidied and reformatted :
  *			B.K.McIlwrath	21/07/93
+ *	Initialise the symbol table cache in nodebuild() :
+ *					14/10/2026
  *
  ******************************************************************************
  */
@@ -110,6 +112,8 @@ static node
 	new->interpret = interpreter;
 	new->n_nodes = nsub;
 	new->val = val;
+	new->symtable = new->symentry = (struct _symtab *) 0;
+	new->symgen = 0;
 	if (nsub == 0) {
 	    new->sub = SUBNIL;
 	    return (new);
@@ -933,21 +933,23 @@ expression
 
 exp0
   : exp1 EQUAL exp1
-      { $$ = node2 (reloperator_interpret, value_integer (EQUAL), $1, $3); }
+      { $$ = fold_constants (node2 (reloperator_interpret,
+		    value_integer (EQUAL), $1, $3)); }
   | exp1 LESS_THAN exp1
-      { $$ = node2 (reloperator_interpret, value_integer (LESS_THAN), $1, $3); }
+      { $$ = fold_constants (node2 (reloperator_interpret,
+		    value_integer (LESS_THAN), $1, $3)); }
   | exp1 LESS_EQUAL exp1
-      { $$ = node2 (reloperator_interpret, 
-		    value_integer (LESS_EQUAL), $1, $3); }
+      { $$ = fold_constants (node2 (reloperator_interpret, 
+		    value_integer (LESS_EQUAL), $1, $3)); }
   | exp1 GREATER_THAN exp1
-      { $$ = node2 (reloperator_interpret, 
-		    value_integer (GREATER_THAN), $1, $3); }
+      { $$ = fold_constants (node2 (reloperator_interpret, 
+		    value_integer (GREATER_THAN), $1, $3)); }
   | exp1 GREATER_EQUAL exp1 
-      { $$ = node2 (reloperator_interpret, 
-		    value_integer (GREATER_EQUAL), $1, $3); }
+      { $$ = fold_constants (node2 (reloperator_interpret, 
+		    value_integer (GREATER_EQUAL), $1, $3)); }
   | exp1 NOT_EQUAL exp1
-      { $$ = node2 (reloperator_interpret,
-		    value_integer (NOT_EQUAL), $1, $3); }
+      { $$ = fold_constants (node2 (reloperator_interpret,
+		    value_integer (NOT_EQUAL), $1, $3)); }
   | exp1 FORMAT exp1 FORMAT exp1
       { $$ = node3 (format_interpret, noval, $1, $3, $5); }
   | exp1 FORMAT exp1
@@ -957,31 +959,34 @@ exp0
 
 exp1
   : exp1 ADD exp2
-      { $$ = node2 (binaryoperator_interpret, value_integer (ADD), $1, $3); }
+      { $$ = fold_constants (node2 (binaryoperator_interpret,
+		    value_integer (ADD), $1, $3)); }
   | exp1 SUBTRACT exp2
-      { $$ = node2 (binaryoperator_interpret,
-		    value_integer (SUBTRACT), $1, $3); }
+      { $$ = fold_constants (node2 (binaryoperator_interpret,
+		    value_integer (SUBTRACT), $1, $3)); }
   | SUBTRACT exp2
-      { $$ = node1 (unaryarith_interpret, value_integer (SUBTRACT),$2); }
+      { $$ = fold_constants (node1 (unaryarith_interpret,
+		    value_integer (SUBTRACT), $2)); }
   | ADD exp2
-      { $$ = node1 (unaryarith_interpret, value_integer (ADD), $2); }
+      { $$ = fold_constants (node1 (unaryarith_interpret,
+		    value_integer (ADD), $2)); }
   | exp2
   ;
 
 exp2
   : exp2 MULTIPLY exp3
-      { $$ = node2 (binaryoperator_interpret,
-		    value_integer (MULTIPLY), $1, $3); }
+      { $$ = fold_constants (node2 (binaryoperator_interpret,
+		    value_integer (MULTIPLY), $1, $3)); }
   | exp2 DIVIDE exp3
-      { $$ = node2 (binaryoperator_interpret,
-		    value_integer (DIVIDE), $1, $3); }
+      { $$ = fold_constants (node2 (binaryoperator_interpret,
+		    value_integer (DIVIDE), $1, $3)); }
   | exp3
   ;
 
 exp3
   : exp4 POWER exp3
-      { $$ = node2 (binaryoperator_interpret,
-		    value_integer (POWER), $1, $3); }
+      { $$ = fold_constants (node2 (binaryoperator_interpret,
+		    value_integer (POWER), $1, $3)); }
   | exp4
   ;
 
@@ -8,6 +8,8 @@
  *			B.K.McIlwrath	27/7/93 + 15/11/93
  *      Add assign_helper1 :
  *                      A.J.Chipperfield 24/1/93
+ *      Cache the symbol table entries of variables in their name nodes :
+ *                      14/10/2026
  *
  * These routines implement operations on the ICL symbol tables.
  *
@@ -87,6 +89,18 @@ static symtab world_syms =
 static symtab *world = &world_syms;
 static symtab *symbols = &world_syms;
 
+/******************************************************************************
+ *
+ * symtab_generation is incremented whenever a symbol table entry is created
+ * or freed. lookup_name_value() records it in a name node along with the
+ * entry found for that name, so that the entry can be reused (without
+ * searching the table again) for as long as the generation is unchanged.
+ * Changing the value of an existing entry does not affect the generation.
+ *
+ ******************************************************************************
+ */
+static unsigned long symtab_generation = 1;
+
 /******************************************************************************
  *
  * A procedure's local variables and parameters are held in its own symbol
@@ -207,6 +221,7 @@ new_symtab(char *name, int type, node * n)
     sym->type = type;
     sym->value = n;
     sym->next = sym->prev = sym;
+    symtab_generation++;
     return sym;
 }
 
@@ -254,19 +269,18 @@ symbol_total(symtab *sym, int type)
 
 /******************************************************************************
  *
- *	G E T _ S Y M B O L (symtab *sym, char *name, int type)
+ *	F I N D _ S Y M B O L (symtab *sym, char *name, int type)
  *
  * Look up a symbol of the given type in the given symbol table.
  *
  * If a symbol is found, it is moved to the front of the list (if it is not
  * already there).
- * The found symbol's pointer to its nodevalue is returned, otherwise we return
- * NODENIL.
+ * The found symbol table entry is returned, otherwise we return SYMBNIL.
  *
  ******************************************************************************
  */
-static node *
-get_symbol(symtab * sym, char *name, int type)
+static symtab *
+find_symbol(symtab * sym, char *name, int type)
 {
     symtab *p;
 
@@ -279,12 +293,35 @@ get_symbol(symtab * sym, char *name, int type)
 		p->prev = sym;
 		sym->next->prev = p;
 		sym->next = p;
-		return (p->value);
+		return (p);
 	    } else
-		return (p->value);
+		return (p);
 	else
 	    continue;
-    return NODENIL;
+    return SYMBNIL;
+}
+
+/******************************************************************************
+ *
+ *	G E T _ S Y M B O L (symtab *sym, char *name, int type)
+ *
+ * Look up a symbol of the given type in the given symbol table using
+ * find_symbol().
+ *
+ * The found symbol's pointer to its nodevalue is returned, otherwise we return
+ * NODENIL.
+ *
+ ******************************************************************************
+ */
+static node *
+get_symbol(symtab * sym, char *name, int type)
+{
+    symtab *p;
+
+    if ((p = find_symbol(sym, name, type)) == SYMBNIL)
+	return NODENIL;
+    else
+	return (p->value);
 }
 
 /******************************************************************************
@@ -405,6 +442,56 @@ lookup_variable_value(char *name)
     return (lookfor_variable_value(symbols, name));
 }
 
+/******************************************************************************
+ *
+ *	L O O K U P _ N A M E _ V A L U E (node *n)
+ *
+ * Looks up the variable named by the name_interpret() node n in the active
+ * symbol table, in the same way as lookup_variable_value().
+ *
+ * The symbol table entry found is remembered in the node so that, when the
+ * node is next interpreted (typically by the next iteration of a loop in a
+ * procedure), the entry can be used directly rather than searching the table
+ * by name. The remembered entry is only used if the node is interpreted
+ * with the same active symbol table and no entries have been created or
+ * freed since (see symtab_generation), so that it still exists and is the
+ * entry that lookfor_variable_value() would find.
+ *
+ ******************************************************************************
+ */
+value
+lookup_name_value(node *n)
+{
+    symtab *entry;
+    node *var, *var2;
+
+    entry = n->symentry;
+    if (n->symtable != symbols || n->symgen != symtab_generation ||
+	entry == SYMBNIL || entry->value == NODENIL) {
+	if ((entry = find_symbol(symbols, string_part(n->val), SYM_VARIABLE))
+		== SYMBNIL || entry->value == NODENIL)
+	    entry = find_symbol(symbols, string_part(n->val), SYM_PARAMETER);
+	if (entry == SYMBNIL || entry->value == NODENIL)
+	    return (lookfor_variable_value(symbols, string_part(n->val)));
+	n->symtable = symbols;
+	n->symentry = entry;
+	n->symgen = symtab_generation;
+    }
+    var = entry->value;
+/*
+ * do we have a variable or a parameter that was passed an expression ?
+ */
+    if (entry->type == SYM_VARIABLE || var->interpret != parameter_interpret)
+	return var->val;
+    else if ((var2 = get_passbyreferencevar(var)) != NODENIL)
+	return var2->val;
+    else
+	return exception2(
+		"UNDEFVAR Parameter \"%s\" is undefined variable \"%s\"",
+		 string_part(n->val),
+		 string_part(var->sub[0]->val));
+}
+
 /******************************************************************************
  *
  *	L O O K U P _ P R O C V A R I A B L E _ V A L U E
@@ -741,6 +828,7 @@ delete_symbol(char *name, int type)
 	destroy(found->value);
 	free((void *) (found->name));
 	free((void *) found);
+	symtab_generation++;
 	return TRUE;
     }
 }
@@ -788,6 +876,7 @@ delete_sym_parameters(value symbval)
 /* Finish deletion of found entry */
 	    free((void *) (found->name));
 	    free((void *) found);
+	    symtab_generation++;
 	} /* if */
     } /* for */
     return;
@@ -18,6 +18,7 @@ extern value restoresymboltablecontext (void);
 extern value value_emptysymtab(void);
 extern value lookfor_variable_value(struct _symtab *sym, char *name);
 extern value lookup_variable_value (char *name);
+extern value lookup_name_value (node *n);
 extern value lookup_procvariable_value (node *procnode, char *name);
 extern node *lookup_symbol (char *name, int type);
 extern node *lookup_proc (char *name);
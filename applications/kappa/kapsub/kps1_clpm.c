@@ -0,0 +1,490 @@
+#include <math.h>
+#include <string.h>
+#include "f77.h"
+#include "sae_par.h"
+#include "prm_par.h"
+#include "ast.h"
+#include "star/thr.h"
+
+/* Collapses with fewer input values than this are done in a single
+   thread, since the overheads of using the workforce would outweigh
+   any gain. */
+#define KPS1_CLPM_MINTHR 262144
+
+/* The maximum number of adjacent output pixels whose accumulators are
+   updated together as each input plane is read. This keeps the
+   accumulators in cache. */
+#define KPS1_CLPM_MAXRUN 4096
+
+/* The maximum number of input values gathered at once by each thread
+   for the median. */
+#define KPS1_CLPM_MAXBUF 262144
+
+/* The collapse methods handled by this file, using the method numbers
+   of KPS1_CLPSx. */
+#define KPS1_CLPM_MEAN 1
+#define KPS1_CLPM_MEDIAN 3
+#define KPS1_CLPM_SUM 12
+#define KPS1_CLPM_RMS 24
+#define KPS1_CLPM_MAX 31
+#define KPS1_CLPM_MIN 32
+#define KPS1_CLPM_NGOOD 35
+#define KPS1_CLPM_NBAD 36
+#define KPS1_CLPM_FGOOD 37
+#define KPS1_CLPM_FBAD 38
+
+/* Data describing a job that collapses a range of output pixels. */
+typedef struct {
+   int type;             /* 'R' or 'D' */
+   int imeth;            /* Collapse method */
+   int minpix;           /* Min. no. of good values for a good output */
+   size_t nlin;          /* No. of values collapsed into each output */
+   size_t dimax;         /* No. of input planes along the collapse axis */
+   size_t step;          /* Step between input planes */
+   size_t el0;           /* Index of first output pixel to create */
+   size_t el1;           /* Index of last output pixel to create */
+   size_t nrun;          /* Max. no. of output pixels handled together */
+   const void *in;       /* Input data, starting at the first plane */
+   void *out;            /* Output data */
+   double *work;         /* Work space for the job */
+   int nflag;            /* Returned no. of WLIM-flagged outputs */
+} Kps1ClpmData;
+
+/* Prototypes for private functions defined in this file. */
+static double kps1ClpmMedian( double *buf, size_t n );
+static void kps1ClpmF( int type, int imeth, int minpix, int nlin, int dimax,
+                       int step, int nouter, const void *in, void *out,
+                       int *nflag, int *status );
+static void kps1ClpmJob( void *job_data, int *status );
+static void kps1ClpmStore( Kps1ClpmData *data, size_t iel, double value,
+                           int ngood );
+
+/*
+*+
+*  Name:
+*     KPS1_CLPMx
+
+*  Purpose:
+*     Collapses an array along one axis using multiple threads.
+
+*  Language:
+*     C, designed to be called from Fortran.
+
+*  Invocation:
+*     CALL KPS1_CLPMx( IMETH, MINPIX, NLIN, DIMAX, STEP, NOUTER, DIN,
+*                      DOUT, NFLAG, STATUS )
+
+*  Description:
+*     This routine collapses an array along one pixel axis, without
+*     variances, using one of the simpler estimators supported by
+*     KPS1_CLPSx. It produces the same results as the CCDPACK
+*     combination routines used by KPS1_CLPSx, but reads the input array
+*     in its natural order, so that the input values need not be
+*     re-ordered into work arrays first.
+*
+*     The moments are accumulated along the collapse axis one input
+*     plane at a time for runs of adjacent output pixels, so that the
+*     input values are read contiguously. For the median, the values
+*     for a run of output pixels are gathered plane by plane into a
+*     buffer, and the median of each output pixel is then found by
+*     selection rather than by sorting.
+*
+*     Large arrays are divided between the threads of the singleton
+*     workforce. The number of threads is given by the KAPPA_THREADS
+*     environment variable, and defaults to the number of processors.
+
+*  Arguments:
+*     IMETH = INTEGER (Given)
+*        The KPS1_CLPSx method number. This must be one of 1 (MEAN),
+*        3 (MEDIAN), 12 (SUM), 24 (RMS), 31 (MAX), 32 (MIN), 35 (NGOOD),
+*        36 (NBAD), 37 (FGOOD) or 38 (FBAD).
+*     MINPIX = INTEGER (Given)
+*        The minimum number of good input values needed to create a
+*        good output value for methods MEAN, MEDIAN, SUM and RMS.
+*     NLIN = INTEGER (Given)
+*        The number of input planes to collapse.
+*     DIMAX = INTEGER (Given)
+*        The number of input planes along the collapse axis.
+*     STEP = INTEGER (Given)
+*        The vector step between adjacent input planes, i.e. the product
+*        of the dimensions below the collapse axis.
+*     NOUTER = INTEGER (Given)
+*        The product of the dimensions above the collapse axis.
+*     DIN( * ) = ? (Given)
+*        The input data values, starting at the first element of the
+*        first plane to be collapsed.
+*     DOUT( STEP, NOUTER ) = ? (Returned)
+*        The output data values. This will be of type _INTEGER for
+*        methods NGOOD and NBAD.
+*     NFLAG = INTEGER (Given & Returned)
+*        Incremented by the number of output pixels set bad because
+*        fewer than MINPIX of their input values were good. Lines with
+*        no good values are not included.
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Notes:
+*     -  There is a routine for real and double-precision data: replace
+*     "x" in the routine name by R or D as appropriate. The data type
+*     of the DIN and DOUT arrays must match the routine used.
+*     -  The median of an even number of values is the mean of the two
+*     central values.
+*     -  These routines should only be called from the main thread.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either Version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+*     02110-1301, USA.
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+#define MAKE_KPS1_CLPM(x,Ftype,Ctype) \
+F77_SUBROUTINE(kps1_clpm##x)( INTEGER(IMETH), INTEGER(MINPIX), \
+                              INTEGER(NLIN), INTEGER(DIMAX), \
+                              INTEGER(STEP), INTEGER(NOUTER), \
+                              Ftype##_ARRAY(DIN), Ftype##_ARRAY(DOUT), \
+                              INTEGER(NFLAG), INTEGER(STATUS) ) { \
+   GENPTR_INTEGER(IMETH) \
+   GENPTR_INTEGER(MINPIX) \
+   GENPTR_INTEGER(NLIN) \
+   GENPTR_INTEGER(DIMAX) \
+   GENPTR_INTEGER(STEP) \
+   GENPTR_INTEGER(NOUTER) \
+   GENPTR_##Ftype##_ARRAY(DIN) \
+   GENPTR_##Ftype##_ARRAY(DOUT) \
+   GENPTR_INTEGER(NFLAG) \
+   GENPTR_INTEGER(STATUS) \
+\
+   kps1ClpmF( Ctype, *IMETH, *MINPIX, *NLIN, *DIMAX, *STEP, *NOUTER, \
+              DIN, DOUT, NFLAG, STATUS ); \
+}
+
+MAKE_KPS1_CLPM(r,REAL,'R')
+MAKE_KPS1_CLPM(d,DOUBLE,'D')
+
+#undef MAKE_KPS1_CLPM
+
+/* Do the work for all the above routines. */
+static void kps1ClpmF( int type, int imeth, int minpix, int nlin, int dimax,
+                       int step, int nouter, const void *in, void *out,
+                       int *nflag, int *status ){
+   Kps1ClpmData *data;
+   Kps1ClpmData *job_data = NULL;
+   ThrWorkForce *wf = NULL;
+   int *old_status;
+   int ijob;
+   int njob;
+   size_t nbuf;
+   size_t nel;
+   size_t nrun;
+
+   if( *status != SAI__OK ) return;
+   nel = (size_t) step * (size_t) nouter;
+   if( nel == 0 || nlin <= 0 ) return;
+
+/* The AST memory functions report errors through the Fortran status. */
+   old_status = astWatch( status );
+
+/* Only use the workforce for large arrays, and then use a few jobs for
+   each thread so that the loads are balanced. */
+   njob = 1;
+   if( nel * (size_t) nlin >= KPS1_CLPM_MINTHR ) {
+      wf = thrGetWorkforce( thrGetNThread( "KAPPA_THREADS", status ),
+                            status );
+      if( wf ) njob = 4*wf->nworker;
+      if( (size_t) njob > nel ) njob = (int) nel;
+   }
+
+/* Decide how many output pixels can be handled at once. The median
+   needs a count and all the input values for each output pixel, but
+   the other methods need only three accumulators. */
+   if( imeth == KPS1_CLPM_MEDIAN ) {
+      nrun = KPS1_CLPM_MAXBUF/(size_t) nlin;
+      if( nrun < 1 ) nrun = 1;
+      if( nrun > KPS1_CLPM_MAXRUN ) nrun = KPS1_CLPM_MAXRUN;
+      nbuf = nrun*( (size_t) nlin + 1 );
+   } else {
+      nrun = KPS1_CLPM_MAXRUN;
+      nbuf = 3*nrun;
+   }
+
+/* Divide the output pixels evenly between the jobs. */
+   job_data = astMalloc( njob*sizeof( *job_data ) );
+   for( ijob = 0; ijob < njob && *status == SAI__OK; ijob++ ) {
+      data = job_data + ijob;
+      data->type = type;
+      data->imeth = imeth;
+      data->minpix = minpix;
+      data->nlin = (size_t) nlin;
+      data->dimax = (size_t) dimax;
+      data->step = (size_t) step;
+      data->el0 = ( ijob*nel )/njob;
+      data->el1 = ( ( ijob + 1 )*nel )/njob - 1;
+      data->nrun = nrun;
+      data->in = in;
+      data->out = out;
+      data->work = astMalloc( nbuf*sizeof( *data->work ) );
+      data->nflag = 0;
+      thrAddJob( wf, 0, data, kps1ClpmJob, 0, NULL, status );
+   }
+   thrWait( wf, status );
+
+/* Add up the number of flagged output pixels, and free resources. */
+   if( job_data ) {
+      for( ijob = 0; ijob < njob; ijob++ ) {
+         data = job_data + ijob;
+         if( *status == SAI__OK ) *nflag += data->nflag;
+         data->work = astFree( data->work );
+      }
+      job_data = astFree( job_data );
+   }
+
+   astWatch( old_status );
+}
+
+/* Collapse the output pixels from data->el0 to data->el1. This is run
+   in a worker thread. */
+static void kps1ClpmJob( void *job_data, int *status ) {
+   Kps1ClpmData *data;
+   const double *pd;
+   const float *pr;
+   double *cnt;
+   double *hi;
+   double *lo;
+   double *sum;
+   double *sum2;
+   double v;
+   int ngood;
+   size_t i;
+   size_t iel;
+   size_t iin;
+   size_t inner;
+   size_t iouter;
+   size_t k;
+   size_t nrun;
+   size_t nrunmax;
+
+   if( *status != SAI__OK ) return;
+   data = (Kps1ClpmData *) job_data;
+   pr = (const float *) data->in;
+   pd = (const double *) data->in;
+
+/* Up to three accumulators are needed for each output pixel in a run.
+   Which ones are used depends on the method. */
+   nrunmax = data->nrun;
+   cnt = data->work;
+   sum = data->work + nrunmax;
+   sum2 = data->work + 2*nrunmax;
+   hi = sum;
+   lo = sum;
+
+/* Loop over runs of adjacent output pixels. Each run lies within a
+   single row of pixels below the collapse axis, so that its input
+   values are contiguous within each plane. */
+   iel = data->el0;
+   while( iel <= data->el1 ) {
+      iouter = iel/data->step;
+      inner = iel - iouter*data->step;
+      nrun = data->step - inner;
+      if( nrun > data->el1 - iel + 1 ) nrun = data->el1 - iel + 1;
+      if( nrun > nrunmax ) nrun = nrunmax;
+
+/* The index within the input array of the first value in the run. */
+      iin = iouter*data->dimax*data->step + inner;
+
+/* For the median, gather the good values for each output pixel in the
+   run, plane by plane, and then find their median. The values for
+   output pixel i are stored starting at work[ i*nlin ]. */
+      if( data->imeth == KPS1_CLPM_MEDIAN ) {
+         for( i = 0; i < nrun; i++ ) cnt[ i ] = 0.0;
+         for( k = 0; k < data->nlin; k++ ) {
+            for( i = 0; i < nrun; i++ ) {
+               if( data->type == 'R' ) {
+                  v = ( pr[ iin + i ] != VAL__BADR ) ? pr[ iin + i ] : VAL__BADD;
+               } else {
+                  v = pd[ iin + i ];
+               }
+               if( v != VAL__BADD ) {
+                  data->work[ nrunmax + i*data->nlin + (size_t) cnt[ i ] ] = v;
+                  cnt[ i ] += 1.0;
+               }
+            }
+            iin += data->step;
+         }
+
+         for( i = 0; i < nrun; i++ ) {
+            ngood = (int) cnt[ i ];
+            v = ( ngood > 0 ) ? kps1ClpmMedian( data->work + nrunmax +
+                                                i*data->nlin,
+                                                (size_t) ngood ) : VAL__BADD;
+            kps1ClpmStore( data, iel + i, v, ngood );
+         }
+
+/* For the other methods, update the accumulators for every output pixel
+   in the run from each plane in turn. */
+      } else {
+         for( i = 0; i < nrun; i++ ) {
+            cnt[ i ] = 0.0;
+            sum[ i ] = 0.0;
+            sum2[ i ] = 0.0;
+         }
+         if( data->imeth == KPS1_CLPM_MAX ) {
+            for( i = 0; i < nrun; i++ ) hi[ i ] = -VAL__MAXD;
+         } else if( data->imeth == KPS1_CLPM_MIN ) {
+            for( i = 0; i < nrun; i++ ) lo[ i ] = VAL__MAXD;
+         }
+
+         for( k = 0; k < data->nlin; k++ ) {
+            for( i = 0; i < nrun; i++ ) {
+               if( data->type == 'R' ) {
+                  if( pr[ iin + i ] == VAL__BADR ) continue;
+                  v = pr[ iin + i ];
+               } else {
+                  if( pd[ iin + i ] == VAL__BADD ) continue;
+                  v = pd[ iin + i ];
+               }
+
+               cnt[ i ] += 1.0;
+               if( data->imeth == KPS1_CLPM_MAX ) {
+                  if( v > hi[ i ] ) hi[ i ] = v;
+               } else if( data->imeth == KPS1_CLPM_MIN ) {
+                  if( v < lo[ i ] ) lo[ i ] = v;
+               } else if( data->imeth == KPS1_CLPM_RMS ) {
+                  sum2[ i ] += v*v;
+               } else {
+                  sum[ i ] += v;
+               }
+            }
+            iin += data->step;
+         }
+
+         for( i = 0; i < nrun; i++ ) {
+            ngood = (int) cnt[ i ];
+            if( data->imeth == KPS1_CLPM_MEAN ) {
+               v = ( ngood > 0 ) ? sum[ i ]/cnt[ i ] : VAL__BADD;
+            } else if( data->imeth == KPS1_CLPM_SUM ) {
+               v = ( ngood > 0 ) ? sum[ i ] : VAL__BADD;
+            } else if( data->imeth == KPS1_CLPM_RMS ) {
+               v = ( ngood > 0 ) ? sqrt( sum2[ i ]/cnt[ i ] ) : VAL__BADD;
+            } else if( data->imeth == KPS1_CLPM_MAX ) {
+               v = ( ngood > 0 ) ? hi[ i ] : VAL__BADD;
+            } else if( data->imeth == KPS1_CLPM_MIN ) {
+               v = ( ngood > 0 ) ? lo[ i ] : VAL__BADD;
+            } else {
+               v = 0.0;
+            }
+            kps1ClpmStore( data, iel + i, v, ngood );
+         }
+      }
+
+      iel += nrun;
+   }
+}
+
+/* Store the output value for output pixel "iel", given the estimate
+   "value" (VAL__BADD if undefined) and the number of good input values
+   "ngood". */
+static void kps1ClpmStore( Kps1ClpmData *data, size_t iel, double value,
+                           int ngood ) {
+   int nlin = (int) data->nlin;
+
+/* The counts are returned as integers. */
+   if( data->imeth == KPS1_CLPM_NGOOD ) {
+      ( (int *) data->out )[ iel ] = ngood;
+      return;
+   } else if( data->imeth == KPS1_CLPM_NBAD ) {
+      ( (int *) data->out )[ iel ] = nlin - ngood;
+      return;
+   } else if( data->imeth == KPS1_CLPM_FGOOD ) {
+      value = (double) ngood / (double) nlin;
+   } else if( data->imeth == KPS1_CLPM_FBAD ) {
+      value = (double) ( nlin - ngood ) / (double) nlin;
+
+/* The estimators that depend on the number of good values are bad if
+   there are too few of them. */
+   } else if( data->imeth < KPS1_CLPM_MAX && ngood < data->minpix ) {
+      if( ngood > 0 ) data->nflag++;
+      value = VAL__BADD;
+   }
+
+   if( data->type == 'R' ) {
+      ( (float *) data->out )[ iel ] = ( value != VAL__BADD ) ?
+                                       (float) value : VAL__BADR;
+   } else {
+      ( (double *) data->out )[ iel ] = value;
+   }
+}
+
+/* Return the median of the "n" values in "buf" (n > 0), which are
+   re-ordered. The central value is found using Wirth's selection
+   algorithm. */
+static double kps1ClpmMedian( double *buf, size_t n ) {
+   double result;
+   double t;
+   double x;
+   long int i;
+   long int j;
+   long int k;
+   long int l;
+   long int m;
+
+   k = (long int)( n/2 );
+   l = 0;
+   m = (long int) n - 1;
+   while( l < m ) {
+      x = buf[ k ];
+      i = l;
+      j = m;
+      do {
+         while( buf[ i ] < x ) i++;
+         while( x < buf[ j ] ) j--;
+         if( i <= j ) {
+            t = buf[ i ];
+            buf[ i ] = buf[ j ];
+            buf[ j ] = t;
+            i++;
+            j--;
+         }
+      } while( i <= j );
+      if( j < k ) l = i;
+      if( k < i ) m = j;
+   }
+   result = buf[ k ];
+
+/* For an even number of values, the other central value is the largest
+   of the values below element k, all of which are no larger than
+   element k. */
+   if( n % 2 == 0 ) {
+      t = buf[ 0 ];
+      for( i = 1; i < k; i++ ) {
+         if( buf[ i ] > t ) t = buf[ i ];
+      }
+      result = 0.5*( result + t );
+   }
+
+   return result;
+}
@@ -0,0 +1,595 @@
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "f77.h"
+#include "sae_par.h"
+#include "prm_par.h"
+#include "ast.h"
+#include "mers.h"
+#include "star/thr.h"
+
+/* The number of output tiles used for each worker thread. */
+#define KPS1_WMOSP_NTILE 2
+
+/* The minimum number of output rows (i.e. values on the last output
+   axis) in each tile. */
+#define KPS1_WMOSP_MINROW 16
+
+/* Maximum number of pixel axes. */
+#define KPS1_WMOSP_MXDIM 7
+
+/* Data shared by all the tiles. */
+typedef struct Kps1WmospData {
+   char type;            /* 'I', 'R' or 'D' */
+   int nin;              /* No. of inputs in the batch */
+   int mxd;              /* Leading dimension of bound arrays */
+   const int *ndim1;     /* No. of input axes */
+   const int *lbnd1;     /* Lower bounds of input arrays */
+   const int *ubnd1;     /* Upper bounds of input arrays */
+   void **in;            /* Input data arrays */
+   void **in_var;        /* Input variance arrays */
+   const int *flags;     /* AST_REBINSEQ flags for each input */
+   const double *params; /* Spreading parameters for each input */
+   int method;           /* Spreading method */
+   double wlim;          /* Minimum good output weight */
+   double tol;           /* Positional accuracy */
+   int maxpix;           /* Initial scale size */
+   int ndim;             /* No. of output axes */
+   void *out;            /* Output data array */
+   void *out_var;        /* Output variance array */
+   double *weights;      /* Output weights array */
+} Kps1WmospData;
+
+/* Data describing the job that pastes a batch of input arrays into one
+   output tile. */
+typedef struct {
+   struct Kps1WmospData *data;  /* The values shared by all tiles */
+   AstMapping **maps;    /* Copies of the Mappings (NULL if not used) */
+   int *lsect;           /* Lower bounds of the input sections */
+   int *usect;           /* Upper bounds of the input sections */
+   int lbnd[ KPS1_WMOSP_MXDIM ];  /* Lower bounds of the tile */
+   int ubnd[ KPS1_WMOSP_MXDIM ];  /* Upper bounds of the tile */
+   int64_t nused;        /* No. of input values used */
+   size_t off;           /* Offset of the tile within the output */
+   size_t woff;          /* Offset of the tile within the weights */
+} Kps1WmospTile;
+
+/* Prototypes for private functions defined in this file. */
+static void kps1WmospJob( void *job_data, int *status );
+static void kps1WmospPaste( Kps1WmospData *data, int i, AstMapping *map,
+                            const int *lsect, const int *usect,
+                            const int *lbnd, const int *ubnd, size_t off,
+                            size_t woff, int64_t *nused, int *status );
+static int kps1WmospSect( Kps1WmospData *data, int i, AstMapping *map,
+                          const int *lbnd, const int *ubnd, int margin,
+                          int *lsect, int *usect, int *status );
+
+F77_SUBROUTINE(kps1_wmosp)( CHARACTER(TYPE), INTEGER(NIN),
+                            INTEGER_ARRAY(NDIM1), INTEGER(MXD),
+                            INTEGER_ARRAY(LBND1), INTEGER_ARRAY(UBND1),
+                            INTEGER_ARRAY(IPD1), INTEGER_ARRAY(IPV1),
+                            INTEGER_ARRAY(MAP), INTEGER_ARRAY(FLAGS),
+                            DOUBLE_ARRAY(PARAMS), INTEGER(METHOD),
+                            DOUBLE(WLIM), DOUBLE(ERRLIM), INTEGER(MAXPIX),
+                            INTEGER(NDIM), INTEGER_ARRAY(LBND),
+                            INTEGER_ARRAY(UBND), INTEGER(IPD2),
+                            INTEGER(IPV2), INTEGER(IPW), INTEGER8(NUSED),
+                            INTEGER(STATUS) TRAIL(TYPE) ){
+/*
+*+
+*  Name:
+*     KPS1_WMOSP
+
+*  Purpose:
+*     Pastes a batch of input arrays into the WCSMOSAIC output arrays
+*     using multiple threads.
+
+*  Language:
+*     Starlink C, designed to be called from Fortran.
+
+*  Invocation:
+*     CALL KPS1_WMOSP( TYPE, NIN, NDIM1, MXD, LBND1, UBND1, IPD1, IPV1,
+*                      MAP, FLAGS, PARAMS, METHOD, WLIM, ERRLIM,
+*                      MAXPIX, NDIM, LBND, UBND, IPD2, IPV2, IPW, NUSED,
+*                      STATUS )
+
+*  Description:
+*     This routine pastes each of a batch of input arrays into the
+*     output arrays using AST_REBINSEQ<x>, in the same way as
+*     WCSMOSAIC does for a single input array.
+*
+*     The output array is divided into tiles along its last pixel
+*     axis, and each tile is handled by a separate thread. Each thread
+*     pastes the inputs of the batch into its own tile in turn, so the
+*     values are summed into each output pixel in the same order as if
+*     the inputs were pasted one at a time. Only the section of each
+*     input that could contribute to a tile is used, and tiles that an
+*     input does not reach are skipped, so each thread has a share of
+*     the inputs in a batch. For this reason, the larger the batch, the
+*     better the threads are used.
+*
+*     The input that completes the mosaic (i.e. the one with the
+*     AST__REBINEND flag) is pasted into the whole output array in the
+*     calling thread, so that the final normalisation uses all the
+*     output pixels. The same is done for all inputs if only one thread
+*     is available, or if output variances are generated from the
+*     spread of input values (AST__GENVAR), since AST then uses the
+*     weights array in a way that does not allow it to be divided up.
+*
+*     The number of threads is given by the KAPPA_THREADS environment
+*     variable, and defaults to the number of processors.
+
+*  Arguments:
+*     TYPE = CHARACTER * ( * ) (Given)
+*        The data type of the input and output arrays: "_INTEGER",
+*        "_REAL" or "_DOUBLE".
+*     NIN = INTEGER (Given)
+*        The number of inputs in the batch.
+*     NDIM1( NIN ) = INTEGER (Given)
+*        The number of pixel axes in each input array.
+*     MXD = INTEGER (Given)
+*        The declared first dimension of LBND1 and UBND1.
+*     LBND1( MXD, NIN ) = INTEGER (Given)
+*        The lower pixel-index bounds of each input array.
+*     UBND1( MXD, NIN ) = INTEGER (Given)
+*        The upper pixel-index bounds of each input array.
+*     IPD1( NIN ) = INTEGER (Given)
+*        Pointers to the input data arrays.
+*     IPV1( NIN ) = INTEGER (Given)
+*        Pointers to the input variance arrays.
+*     MAP( NIN ) = INTEGER (Given)
+*        The Mappings from input to output pixel co-ordinates.
+*     FLAGS( NIN ) = INTEGER (Given)
+*        The AST_REBINSEQ<x> flags for each input.
+*     PARAMS( 3, NIN ) = DOUBLE PRECISION (Given)
+*        The AST_REBINSEQ<x> spreading parameters for each input.
+*     METHOD = INTEGER (Given)
+*        The AST_REBINSEQ<x> spreading method.
+*     WLIM = DOUBLE PRECISION (Given)
+*        The minimum acceptable output weight.
+*     ERRLIM = DOUBLE PRECISION (Given)
+*        The positional accuracy required, in pixels.
+*     MAXPIX = INTEGER (Given)
+*        The initial scale size, in pixels.
+*     NDIM = INTEGER (Given)
+*        The number of pixel axes in the output array.
+*     LBND( NDIM ) = INTEGER (Given)
+*        The lower pixel-index bounds of the output array.
+*     UBND( NDIM ) = INTEGER (Given)
+*        The upper pixel-index bounds of the output array.
+*     IPD2 = INTEGER (Given)
+*        Pointer to the output data array.
+*     IPV2 = INTEGER (Given)
+*        Pointer to the output variance array.
+*     IPW = INTEGER (Given)
+*        Pointer to the output weights array.
+*     NUSED = INTEGER*8 (Given and Returned)
+*        The number of input values used so far.
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Notes:
+*     -  The same division of the output into tiles is used for every
+*     batch, and so the weights for each tile are kept in a fixed part
+*     of the weights array.
+*     -  When tiles are used, an input value that is spread into two
+*     tiles is counted in NUSED for each tile.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*-
+*/
+
+   GENPTR_CHARACTER(TYPE)
+   GENPTR_INTEGER(NIN)
+   GENPTR_INTEGER_ARRAY(NDIM1)
+   GENPTR_INTEGER(MXD)
+   GENPTR_INTEGER_ARRAY(LBND1)
+   GENPTR_INTEGER_ARRAY(UBND1)
+   GENPTR_INTEGER_ARRAY(IPD1)
+   GENPTR_INTEGER_ARRAY(IPV1)
+   GENPTR_INTEGER_ARRAY(MAP)
+   GENPTR_INTEGER_ARRAY(FLAGS)
+   GENPTR_DOUBLE_ARRAY(PARAMS)
+   GENPTR_INTEGER(METHOD)
+   GENPTR_DOUBLE(WLIM)
+   GENPTR_DOUBLE(ERRLIM)
+   GENPTR_INTEGER(MAXPIX)
+   GENPTR_INTEGER(NDIM)
+   GENPTR_INTEGER_ARRAY(LBND)
+   GENPTR_INTEGER_ARRAY(UBND)
+   GENPTR_INTEGER(IPD2)
+   GENPTR_INTEGER(IPV2)
+   GENPTR_INTEGER(IPW)
+   GENPTR_INTEGER8(NUSED)
+   GENPTR_INTEGER(STATUS)
+
+/* Local Variables: */
+   AstMapping *map;
+   Kps1WmospData data;
+   Kps1WmospTile *tile;
+   Kps1WmospTile *tiles = NULL;
+   ThrWorkForce *wf;
+   char type[ 16 ];
+   int *lsect = NULL;
+   int *old_status;
+   int *usect = NULL;
+   int genvar;
+   int i;
+   int idim;
+   int itile;
+   int last;
+   int margin;
+   int nrow;
+   int ntile;
+   int width;
+   int wpar;
+   int64_t nused;
+   size_t rowsize;
+   size_t wfac;
+
+/* Check the global status. */
+   if( *STATUS != SAI__OK ) return;
+
+/* Store the values shared by all tiles. */
+   cnfImprt( TYPE, TYPE_length, type );
+   if( !strcmp( type, "_INTEGER" ) ) {
+      data.type = 'I';
+   } else if( !strcmp( type, "_REAL" ) ) {
+      data.type = 'R';
+   } else if( !strcmp( type, "_DOUBLE" ) ) {
+      data.type = 'D';
+   } else {
+      *STATUS = SAI__ERROR;
+      msgSetc( "TY", type );
+      errRep( "KPS1_WMOSP_ERR1", "KPS1_WMOSP: Unsupported rebinning data "
+              "type '^TY' (programming error).", STATUS );
+      return;
+   }
+
+   if( *NDIM > KPS1_WMOSP_MXDIM ) {
+      *STATUS = SAI__ERROR;
+      errRep( "KPS1_WMOSP_ERR2", "KPS1_WMOSP: Too many output pixel axes "
+              "(programming error).", STATUS );
+      return;
+   }
+
+   data.nin = *NIN;
+   data.mxd = *MXD;
+   data.ndim1 = NDIM1;
+   data.lbnd1 = LBND1;
+   data.ubnd1 = UBND1;
+   data.flags = FLAGS;
+   data.params = PARAMS;
+   data.method = *METHOD;
+   data.wlim = *WLIM;
+   data.tol = *ERRLIM;
+   data.maxpix = *MAXPIX;
+   data.ndim = *NDIM;
+   data.out = cnfCptr( *IPD2 );
+   data.out_var = cnfCptr( *IPV2 );
+   data.weights = cnfCptr( *IPW );
+
+/* Make AST use the Fortran status variable. */
+   old_status = astWatch( STATUS );
+
+   data.in = astMalloc( data.nin*sizeof( *data.in ) );
+   data.in_var = astMalloc( data.nin*sizeof( *data.in_var ) );
+   if( *STATUS == SAI__OK ) {
+      for( i = 0; i < data.nin; i++ ) {
+         data.in[ i ] = cnfCptr( IPD1[ i ] );
+         data.in_var[ i ] = cnfCptr( IPV1[ i ] );
+      }
+   }
+
+/* Decide how many tiles to use. Output variances generated from the
+   spread of input values need the whole weights array. */
+   genvar = 0;
+   for( i = 0; i < data.nin; i++ ) {
+      if( FLAGS[ i ] & AST__GENVAR ) genvar = 1;
+   }
+
+   nrow = UBND[ data.ndim - 1 ] - LBND[ data.ndim - 1 ] + 1;
+   wf = NULL;
+   ntile = 1;
+   if( !genvar ) {
+      wf = thrGetWorkforce( thrGetNThread( "KAPPA_THREADS", STATUS ),
+                            STATUS );
+      if( wf ) ntile = KPS1_WMOSP_NTILE*wf->nworker;
+      if( ntile > nrow/KPS1_WMOSP_MINROW ) ntile = nrow/KPS1_WMOSP_MINROW;
+      if( ntile < 1 ) ntile = 1;
+   }
+
+/* If only one tile is to be used, paste each input into the whole
+   output array in this thread. */
+   if( ntile == 1 ) {
+      for( i = 0; i < data.nin && *STATUS == SAI__OK; i++ ) {
+         kps1WmospPaste( &data, i, astI2P( MAP[ i ] ),
+                         LBND1 + i*data.mxd, UBND1 + i*data.mxd, LBND,
+                         UBND, 0, 0, NUSED, STATUS );
+      }
+
+/* Otherwise, divide the output array into tiles along its last axis. */
+   } else {
+      tiles = astCalloc( ntile, sizeof( *tiles ) );
+      lsect = astMalloc( ntile*data.nin*data.mxd*sizeof( *lsect ) );
+      usect = astMalloc( ntile*data.nin*data.mxd*sizeof( *usect ) );
+
+      rowsize = 1;
+      for( idim = 0; idim < data.ndim - 1; idim++ ) {
+         rowsize *= (size_t) ( UBND[ idim ] - LBND[ idim ] + 1 );
+      }
+      wfac = genvar ? 2 : 1;
+
+/* The amount by which the bounds of each tile are extended to include
+   all the input pixels that may be spread into the tile. The kernel
+   width is in the first spreading parameter, or the second if the
+   first holds the weight for the input. */
+      margin = 1;
+      if( data.method == AST__LINEAR ) {
+         margin = 2;
+      } else if( data.method != AST__NEAREST ) {
+         for( i = 0; i < data.nin; i++ ) {
+            wpar = 3*i + ( ( FLAGS[ i ] & AST__PARWGT ) ? 1 : 0 );
+            if( PARAMS[ wpar ] > 0.0 ) {
+               width = 2 + (int) ceil( PARAMS[ wpar ] );
+            } else {
+               width = 2 + (int) ceil( 4.0*fmax( PARAMS[ wpar + 1 ], 2.0 ) );
+            }
+            if( width > margin ) margin = width;
+         }
+      }
+
+      for( itile = 0; itile < ntile && *STATUS == SAI__OK; itile++ ) {
+         tile = tiles + itile;
+         for( idim = 0; idim < data.ndim; idim++ ) {
+            tile->lbnd[ idim ] = LBND[ idim ];
+            tile->ubnd[ idim ] = UBND[ idim ];
+         }
+         last = data.ndim - 1;
+         tile->lbnd[ last ] = LBND[ last ] + ( itile*nrow )/ntile;
+         tile->ubnd[ last ] = LBND[ last ] + ( ( itile + 1 )*nrow )/ntile - 1;
+         tile->off = (size_t) ( tile->lbnd[ last ] - LBND[ last ] )*rowsize;
+         tile->woff = wfac*tile->off;
+         tile->lsect = lsect + itile*data.nin*data.mxd;
+         tile->usect = usect + itile*data.nin*data.mxd;
+         tile->maps = astCalloc( data.nin, sizeof( *tile->maps ) );
+
+/* Each tile gets its own copy of the Mapping for each input that
+   contributes to it, except for any input that completes the mosaic.
+   Every tile must see the input that starts the mosaic, so that the
+   tile is initialised. The copies are unlocked so that the worker
+   threads can lock them. */
+         for( i = 0; i < data.nin && *STATUS == SAI__OK; i++ ) {
+            if( FLAGS[ i ] & AST__REBINEND ) continue;
+            map = astI2P( MAP[ i ] );
+            if( kps1WmospSect( &data, i, map, tile->lbnd, tile->ubnd,
+                               margin, tile->lsect + i*data.mxd,
+                               tile->usect + i*data.mxd, STATUS ) ||
+                ( FLAGS[ i ] & AST__REBININIT ) ) {
+               tile->maps[ i ] = astCopy( map );
+               astUnlock( tile->maps[ i ], 1 );
+            }
+         }
+      }
+
+/* Paste the inputs into the tiles, using a separate job for each tile. */
+      for( itile = 0; itile < ntile && *STATUS == SAI__OK; itile++ ) {
+         tiles[ itile ].data = &data;
+         thrAddJob( wf, 0, tiles + itile, kps1WmospJob, 0, NULL, STATUS );
+      }
+      thrWait( wf, STATUS );
+
+/* Lock and annul the Mapping copies, and add up the number of input
+   values used. */
+      nused = 0;
+      for( itile = 0; itile < ntile; itile++ ) {
+         tile = tiles + itile;
+         if( tile->maps ) {
+            for( i = 0; i < data.nin; i++ ) {
+               if( tile->maps[ i ] ) {
+                  astLock( tile->maps[ i ], 0 );
+                  tile->maps[ i ] = astAnnul( tile->maps[ i ] );
+               }
+            }
+            tile->maps = astFree( tile->maps );
+         }
+         nused += tile->nused;
+      }
+      *NUSED += nused;
+
+/* Paste any input that completes the mosaic into the whole output array. */
+      for( i = 0; i < data.nin && *STATUS == SAI__OK; i++ ) {
+         if( FLAGS[ i ] & AST__REBINEND ) {
+            kps1WmospPaste( &data, i, astI2P( MAP[ i ] ),
+                            LBND1 + i*data.mxd, UBND1 + i*data.mxd, LBND,
+                            UBND, 0, 0, NUSED, STATUS );
+         }
+      }
+
+      tiles = astFree( tiles );
+      lsect = astFree( lsect );
+      usect = astFree( usect );
+   }
+
+   data.in = astFree( data.in );
+   data.in_var = astFree( data.in_var );
+
+   astWatch( old_status );
+}
+
+/* Paste the contributing inputs into a single output tile. This is
+   run in a worker thread. */
+static void kps1WmospJob( void *job_data, int *status ) {
+   Kps1WmospData *data;
+   Kps1WmospTile *tile;
+   int i;
+
+   if( *status != SAI__OK ) return;
+
+   tile = (Kps1WmospTile *) job_data;
+   data = tile->data;
+
+/* Allow the AST objects to be used in this thread. */
+   astWatch( status );
+
+   for( i = 0; i < data->nin && *status == SAI__OK; i++ ) {
+      if( tile->maps[ i ] ) {
+         astLock( tile->maps[ i ], 0 );
+         kps1WmospPaste( data, i, tile->maps[ i ], tile->lsect + i*data->mxd,
+                         tile->usect + i*data->mxd, tile->lbnd, tile->ubnd,
+                         tile->off, tile->woff, &tile->nused, status );
+         astUnlock( tile->maps[ i ], 1 );
+      }
+   }
+}
+
+/* Paste the section of input "i" given by "lsect" and "usect" into the
+   part of the output array given by "lbnd" and "ubnd". The output
+   arrays passed to AST start at offset "off" (or "woff" for the
+   weights) within the full output arrays. */
+static void kps1WmospPaste( Kps1WmospData *data, int i, AstMapping *map,
+                            const int *lsect, const int *usect,
+                            const int *lbnd, const int *ubnd, size_t off,
+                            size_t woff, int64_t *nused, int *status ) {
+   const int *lbnd1;
+   const int *ubnd1;
+   const double *params;
+   int flags;
+
+   if( *status != SAI__OK ) return;
+
+   lbnd1 = data->lbnd1 + i*data->mxd;
+   ubnd1 = data->ubnd1 + i*data->mxd;
+   params = data->params + 3*i;
+   flags = data->flags[ i ];
+
+   if( data->type == 'I' ) {
+      astRebinSeqI( map, data->wlim, data->ndim1[ i ], lbnd1, ubnd1,
+                    (int *) data->in[ i ], (int *) data->in_var[ i ],
+                    data->method, params, flags, data->tol, data->maxpix,
+                    VAL__BADI, data->ndim, lbnd, ubnd, lsect, usect,
+                    (int *) data->out + off, (int *) data->out_var + off,
+                    data->weights + woff, nused );
+
+   } else if( data->type == 'R' ) {
+      astRebinSeqF( map, data->wlim, data->ndim1[ i ], lbnd1, ubnd1,
+                    (float *) data->in[ i ], (float *) data->in_var[ i ],
+                    data->method, params, flags, data->tol, data->maxpix,
+                    VAL__BADR, data->ndim, lbnd, ubnd, lsect, usect,
+                    (float *) data->out + off, (float *) data->out_var + off,
+                    data->weights + woff, nused );
+
+   } else {
+      astRebinSeqD( map, data->wlim, data->ndim1[ i ], lbnd1, ubnd1,
+                    (double *) data->in[ i ], (double *) data->in_var[ i ],
+                    data->method, params, flags, data->tol, data->maxpix,
+                    VAL__BADD, data->ndim, lbnd, ubnd, lsect, usect,
+                    (double *) data->out + off, (double *) data->out_var + off,
+                    data->weights + woff, nused );
+   }
+}
+
+/* Find the section of input "i" that may contribute to the output tile
+   with bounds "lbnd" and "ubnd", extended by "margin" pixels to allow
+   for the spreading kernel. Returns zero if no part of the input falls
+   within the tile. */
+static int kps1WmospSect( Kps1WmospData *data, int i, AstMapping *map,
+                          const int *lbnd, const int *ubnd, int margin,
+                          int *lsect, int *usect, int *status ) {
+   const int *lbnd1;
+   const int *ubnd1;
+   double dlbnd[ KPS1_WMOSP_MXDIM ];
+   double dubnd[ KPS1_WMOSP_MXDIM ];
+   double lo;
+   double hi;
+   int idim;
+   int ndim1;
+   int result;
+
+   if( *status != SAI__OK ) return 0;
+
+   lbnd1 = data->lbnd1 + i*data->mxd;
+   ubnd1 = data->ubnd1 + i*data->mxd;
+   ndim1 = data->ndim1[ i ];
+
+/* By default, use the whole input. */
+   for( idim = 0; idim < ndim1; idim++ ) {
+      lsect[ idim ] = lbnd1[ idim ];
+      usect[ idim ] = ubnd1[ idim ];
+   }
+
+/* Find the output pixel-index box that holds the whole input. Pixel
+   centres are at integer values of the pixel co-ordinates used by the
+   Mapping. If this does not overlap the tile (including the margin),
+   the input makes no contribution. */
+   for( idim = 0; idim < ndim1; idim++ ) {
+      dlbnd[ idim ] = lbnd1[ idim ] - 0.5;
+      dubnd[ idim ] = ubnd1[ idim ] + 0.5;
+   }
+
+   result = 1;
+   for( idim = 0; idim < data->ndim && result; idim++ ) {
+      astMapBox( map, dlbnd, dubnd, 1, idim + 1, &lo, &hi, NULL, NULL );
+      if( *status != SAI__OK ) return 0;
+      if( lo == AST__BAD || hi == AST__BAD ) break;
+      if( hi < lbnd[ idim ] - margin || lo > ubnd[ idim ] + margin ) {
+         result = 0;
+      }
+   }
+
+/* If the input overlaps the tile and the inverse transformation is
+   available, restrict the input to the section that falls within the
+   tile and its margin. */
+   if( result && astGetI( map, "TranInverse" ) ) {
+      for( idim = 0; idim < data->ndim; idim++ ) {
+         dlbnd[ idim ] = lbnd[ idim ] - margin - 0.5;
+         dubnd[ idim ] = ubnd[ idim ] + margin + 0.5;
+      }
+
+      for( idim = 0; idim < ndim1; idim++ ) {
+         astMapBox( map, dlbnd, dubnd, 0, idim + 1, &lo, &hi, NULL, NULL );
+         if( *status != SAI__OK ) return 0;
+         if( lo == AST__BAD || hi == AST__BAD ) break;
+
+         lo = floor( lo ) - margin;
+         hi = ceil( hi ) + margin;
+         if( lo > lsect[ idim ] ) lsect[ idim ] = (int) lo;
+         if( hi < usect[ idim ] ) usect[ idim ] = (int) hi;
+         if( lsect[ idim ] > usect[ idim ] ) result = 0;
+      }
+
+/* If the section could not be found, or is empty, use the whole input. */
+      if( idim < ndim1 || !result ) {
+         for( idim = 0; idim < ndim1; idim++ ) {
+            lsect[ idim ] = lbnd1[ idim ];
+            usect[ idim ] = ubnd1[ idim ];
+         }
+      }
+   }
+
+   return result;
+}
@@ -388,6 +388,11 @@
 *     level is at least as verbose as NORMAL, the interpolation method
 *     being used will be displayed.  If set to VERBOSE, the name of each
 *     input NDF will also be displayed as it is processed.
+*     -  The input NDFs are pasted into the output in batches, and the
+*     output is divided between several threads while each batch is
+*     pasted. The number of threads is given by the KAPPA_THREADS
+*     environment variable, and defaults to the number of processors.
+*     A single thread is used if GENVAR is TRUE.
 
 *  Related Applications:
 *     KAPPA: WCSFRAME, WCSALIGN, REGRID; CCDPACK: TRANNDF.
@@ -470,6 +475,9 @@
 *        Added parameter ALIGNREF.
 *     9-MAR-2018 (DSB):
 *        Added parameter WEIGHTS.
+*     14-OCT-2026:
+*        Paste the input NDFs in batches using KPS1_WMOSP, which divides
+*        the output between several threads.
 *     {enter_further_changes_here}
 
 *-
@@ -490,6 +498,13 @@
 *  Status:
       INTEGER STATUS         ! Global status
 
+*  Local Constants:
+      INTEGER MXBAT          ! Max. no. of input NDFs in a batch
+      PARAMETER ( MXBAT = 100 )
+
+      INTEGER*8 MXMEM        ! Max. no. of mapped input bytes in a batch
+      PARAMETER ( MXMEM = 1073741824 )
+
 *  Local Variables:
       CHARACTER DTYPE*(NDF__SZFTP) ! Data type
       CHARACTER MESS*60      ! Message text
@@ -500,6 +515,7 @@
       DOUBLE PRECISION FUBND( NDF__MXDIM ) ! Upper WCS bounds of output
       DOUBLE PRECISION GLBND( NDF__MXDIM ) ! Lower GRID bounds of output
       DOUBLE PRECISION GUBND( NDF__MXDIM ) ! Upper GRID bounds of output
+      DOUBLE PRECISION PARAMB( 3, MXBAT ) ! PARAMS for the batch
       DOUBLE PRECISION PARAMS( 3 )! Param values passed to AST_RESAMPLE
       DOUBLE PRECISION XL( NDF__MXDIM ) ! GRID position at lower limit
       DOUBLE PRECISION XU( NDF__MXDIM ) ! GRID position at upper limit
@@ -507,41 +523,47 @@
       INTEGER DUBND( NDF__MXDIM )! Defaults for UBND
       INTEGER EL             ! Number of array elements mapped
       INTEGER FLAGS          ! Flags for AST_REBINSEQ
+      INTEGER FLAGSB( MXBAT )! AST_REBINSEQ flags for the batch
       INTEGER I              ! Index into input and output groups
       INTEGER IGRP1          ! GRP id. for group holding input NDFs
       INTEGER IGRP2          ! GRP id. for group holding input weights
       INTEGER INDF0          ! NDF id. for the first input NDF
       INTEGER INDF1          ! NDF id. for the input NDF
+      INTEGER INDFB( MXBAT ) ! NDF ids. for the batch
       INTEGER INDF2          ! NDF id. for the output NDF
       INTEGER INDFR          ! NDF id. for the reference NDF
-      INTEGER IPD1           ! Pntr. to input data array
       INTEGER IPD2           ! Pntr. to output data array
+      INTEGER IPDB( MXBAT )  ! Pntrs. to input data arrays in the batch
       INTEGER IPIX2          ! Index of PIXEL Frame in o/p FrameSet
       INTEGER IPIXR          ! Index of PIXEL Frame in ref. FrameSet
       INTEGER IPMAP          ! Pntr. to array of pix_in->pix_out Mappings
-      INTEGER IPV1           ! Pntr. to input variance array
       INTEGER IPV2           ! Pntr. to output variance array
+      INTEGER IPVB( MXBAT )  ! Pntrs. to input variances in the batch
       INTEGER IPW            ! Pntr. to work array
       INTEGER ISTAT          ! Local status value
       INTEGER IWCS2          ! Original output WCS FrameSet
       INTEGER IWCSR          ! WCS FrameSet for reference NDF
       INTEGER IWCSR2         ! New output WCS FrameSet
+      INTEGER J              ! Index into the batch
       INTEGER LBND( NDF__MXDIM ) ! Indices of lower-left corner of o/p
-      INTEGER LBND1( NDF__MXDIM )! Indices of lower-left corner of input
-      INTEGER MAP            ! AST id for (pix_in->pix_out) Mapping
+      INTEGER LBNDB( NDF__MXDIM, MXBAT ) ! Lower bounds of batch inputs
       INTEGER MAP2           ! Mapping from PIXEL to output GRID Frame
       INTEGER MAP3           ! AST Mapping (ref. GRID -> o/p GRID)
       INTEGER MAPR           ! AST Mapping (ref. GRID -> ref. PIXEL)
+      INTEGER MAPB( MXBAT )  ! pix_in->pix_out Mappings for the batch
       INTEGER MAXPIX         ! Initial scale size in pixels
       INTEGER METHOD_CODE    ! Integer identifier for spreading method
       INTEGER NAX            ! No. of axes in reference WCS Frame
+      INTEGER NB             ! No. of input NDFs in the current batch
+      INTEGER NBPIX          ! No. of mapped bytes per input pixel
       INTEGER NDIM           ! Number of pixel axes in output NDF
-      INTEGER NDIM1          ! Number of pixel axes in input NDF
+      INTEGER NDIMB( MXBAT ) ! No. of pixel axes in batch inputs
       INTEGER NPAR           ! No. of required interpolation parameters
       INTEGER SIZE           ! Total size of the input group
       INTEGER UBND( NDF__MXDIM ) ! Indices of upper-right corner of o/p
-      INTEGER UBND1( NDF__MXDIM )! Indices of upper-right corner of i/p
+      INTEGER UBNDB( NDF__MXDIM, MXBAT ) ! Upper bounds of batch inputs
       INTEGER WSIZE          ! Number of NDF weights given
+      INTEGER*8 NBYTE        ! No. of mapped input bytes in the batch
       INTEGER*8 NUSED        ! No. of input values used so far
       LOGICAL BAD_DV         ! Any bad data/variance values in input?
       LOGICAL CONSRV         ! Conserve flux in each input NDF?
@@ -893,11 +915,30 @@
 *  output array.
       NUSED = 0
 
+*  Find the number of bytes in each mapped input pixel.
+      IF ( TY_IN .EQ. '_INTEGER' ) THEN
+         NBPIX = VAL__NBI
+      ELSE IF ( TY_IN .EQ. '_REAL' ) THEN
+         NBPIX = VAL__NBR
+      ELSE
+         NBPIX = VAL__NBD
+      END IF
+      IF ( USEVAR .OR. VARWGT  ) NBPIX = 2*NBPIX
+
+*  The input NDFs are pasted into the output in batches, so that each
+*  batch can be shared between several threads by KPS1_WMOSP. Each batch
+*  contains no more than MXBAT NDFs, and is closed as soon as the mapped
+*  input arrays use more than MXMEM bytes.
+      NB = 0
+      NBYTE = 0
+
 *  Loop round each NDF to be processed.
       DO I = 1, SIZE
+         NB = NB + 1
 
 *  Get an NDF identifier for the input NDF.
-         CALL NDG_NDFAS( IGRP1, I, 'Read', INDF1, STATUS )
+         CALL NDG_NDFAS( IGRP1, I, 'Read', INDFB( NB ), STATUS )
+         INDF1 = INDFB( NB )
 
 *  If required, tell the user which input NDF is currently being
 *  processed.
@@ -942,68 +983,48 @@
          CALL NDF_BAD( INDF1, 'DATA,VARIANCE', .FALSE., BAD_DV, STATUS )
          IF( BAD_DV ) FLAGS = FLAGS + AST__USEBAD
 
+*  Store the flags and spreading parameters for this input.
+         FLAGSB( NB ) = FLAGS
+         PARAMB( 1, NB ) = PARAMS( 1 )
+         PARAMB( 2, NB ) = PARAMS( 2 )
+         PARAMB( 3, NB ) = PARAMS( 3 )
+
 *  Get the pixel bounds of the input NDF.
-         CALL NDF_BOUND( INDF1, NDF__MXDIM, LBND1, UBND1, NDIM1,
-     :                   STATUS )
+         CALL NDF_BOUND( INDF1, NDF__MXDIM, LBNDB( 1, NB ),
+     :                   UBNDB( 1, NB ), NDIMB( NB ), STATUS )
 
 *  Map the required components of the input.
-         CALL NDF_MAP( INDF1, 'DATA', TY_IN, 'READ', IPD1, EL, STATUS )
+         CALL NDF_MAP( INDF1, 'DATA', TY_IN, 'READ', IPDB( NB ), EL,
+     :                 STATUS )
          IF ( USEVAR .OR. VARWGT  ) THEN
-            CALL NDF_MAP( INDF1, 'VAR', TY_IN, 'READ', IPV1, EL,
+            CALL NDF_MAP( INDF1, 'VAR', TY_IN, 'READ', IPVB( NB ), EL,
      :                    STATUS )
          ELSE
-            IPV1 = IPD1
+            IPVB( NB ) = IPDB( NB )
          END IF
+         NBYTE = NBYTE + INT( EL, 8 )*NBPIX
 
 *  Get a pointer to the Mapping from input to output pixel co-ordinates.
-         CALL KPG1_RETRI( SIZE, I, %VAL( CNF_PVAL( IPMAP ) ), MAP,
-     :                    STATUS )
-
-*  Call the appropriate rebinning routine.
-         IF ( TY_IN .EQ. '_INTEGER' ) THEN
-            CALL AST_REBINSEQI( MAP, DBLE( WLIM ), NDIM1, LBND1, UBND1,
-     :                          %VAL( CNF_PVAL( IPD1 ) ),
-     :                          %VAL( CNF_PVAL( IPV1 ) ), METHOD_CODE,
-     :                          PARAMS, FLAGS, DBLE( ERRLIM ), MAXPIX,
-     :                          VAL__BADI, NDIM, LBND, UBND, LBND1,
-     :                          UBND1, %VAL( CNF_PVAL( IPD2 ) ),
-     :                          %VAL( CNF_PVAL( IPV2 ) ),
-     :                          %VAL( CNF_PVAL( IPW ) ), NUSED,
-     :                          STATUS )
-
-         ELSE IF ( TY_IN .EQ. '_REAL' ) THEN
-            CALL AST_REBINSEQR( MAP, DBLE( WLIM ), NDIM1, LBND1, UBND1,
-     :                          %VAL( CNF_PVAL( IPD1 ) ),
-     :                          %VAL( CNF_PVAL( IPV1 ) ), METHOD_CODE,
-     :                          PARAMS, FLAGS, DBLE( ERRLIM ), MAXPIX,
-     :                          VAL__BADR, NDIM, LBND, UBND, LBND1,
-     :                          UBND1, %VAL( CNF_PVAL( IPD2 ) ),
-     :                          %VAL( CNF_PVAL( IPV2 ) ),
-     :                          %VAL( CNF_PVAL( IPW ) ), NUSED,
-     :                          STATUS )
-
-         ELSE IF ( TY_IN .EQ. '_DOUBLE' ) THEN
-            CALL AST_REBINSEQD( MAP, DBLE( WLIM ), NDIM1, LBND1, UBND1,
-     :                          %VAL( CNF_PVAL( IPD1 ) ),
-     :                          %VAL( CNF_PVAL( IPV1 ) ), METHOD_CODE,
-     :                          PARAMS, FLAGS, DBLE( ERRLIM ), MAXPIX,
-     :                          VAL__BADD, NDIM, LBND, UBND, LBND1,
-     :                          UBND1, %VAL( CNF_PVAL( IPD2 ) ),
-     :                          %VAL( CNF_PVAL( IPV2 ) ),
-     :                          %VAL( CNF_PVAL( IPW ) ), NUSED,
-     :                          STATUS )
-
-         ELSE IF( STATUS .EQ. SAI__OK ) THEN
-            STATUS = SAI__ERROR
-            CALL MSG_SETC( 'TY', TY_IN )
-            CALL ERR_REP( 'KPS1_WMOS2_ERR1', 'KPS1_WMOS2: Unsupported'//
-     :             ' rebinning data type ''^TY'' (programming error).',
-     :             STATUS )
+         CALL KPG1_RETRI( SIZE, I, %VAL( CNF_PVAL( IPMAP ) ),
+     :                    MAPB( NB ), STATUS )
+
+*  If the batch is complete, paste its inputs into the output arrays.
+         IF( NB .EQ. MXBAT .OR. NBYTE .GE. MXMEM .OR.
+     :       I .EQ. SIZE ) THEN
+            CALL KPS1_WMOSP( TY_IN, NB, NDIMB, NDF__MXDIM, LBNDB,
+     :                       UBNDB, IPDB, IPVB, MAPB, FLAGSB, PARAMB,
+     :                       METHOD_CODE, DBLE( WLIM ), DBLE( ERRLIM ),
+     :                       MAXPIX, NDIM, LBND, UBND, IPD2, IPV2, IPW,
+     :                       NUSED, STATUS )
+
+*  Annul the input NDF identifiers in the batch.
+            DO J = 1, NB
+               CALL NDF_ANNUL( INDFB( J ), STATUS )
+            END DO
+            NB = 0
+            NBYTE = 0
          END IF
 
-*  Annul the input NDF identifier.
-         CALL NDF_ANNUL( INDF1, STATUS )
-
 *  If an error occurred processing the current input NDF, abort.
          IF( STATUS .NE. SAI__OK  ) GO TO 999
 
@@ -0,0 +1,273 @@
+#include "sae_par.h"
+#include "polsub.h"
+#include "math.h"
+#include "prm_par.h"
+#include "star/thr.h"
+
+/* Arrays with fewer pixels than this are processed in a single thread. */
+#define POL1_SNG_MINTHR 20000
+
+typedef struct pol1SngadJobData {
+   const float *din;
+   const float *vin;
+   double rcos;
+   double rsin;
+   double rt;
+   double t;
+   float *ie1;
+   float *ie2;
+   float *ie3;
+   float *mat11;
+   float *mat21;
+   float *mat31;
+   float *mat22;
+   float *mat32;
+   float *mat33;
+   float *count;
+   size_t p1;
+   size_t p2;
+} pol1SngadJobData;
+
+static void pol1SngadJob( void *job_data_ptr, int *status );
+
+void pol1Sngad( size_t el, const float *din, const float *vin, float phi,
+                float t, float eps, float *ie1, float *ie2, float *ie3,
+                float *mat11, float *mat21, float *mat31, float *mat22,
+                float *mat32, float *mat33, float *count, int *status ){
+/*
+*+
+*  Name:
+*     pol1Sngad
+
+*  Purpose:
+*     Add a single-beam input intensity image into the running total images.
+
+*  Language:
+*     ANSI C
+
+*  Synopsis:
+*     void pol1Sngad( size_t el, const float *din, const float *vin,
+*                     float phi, float t, float eps, float *ie1,
+*                     float *ie2, float *ie3, float *mat11, float *mat21,
+*                     float *mat31, float *mat22, float *mat32,
+*                     float *mat33, float *count, int *status )
+
+*  Description:
+*     This function updates a set of images holding different quanities by
+*     adding a contribution to each based on the supplied intensity array.
+*     The returned quantities are needed to calculate the Stokes vectors,
+*     variances, and co-variances corresponding to the supplied set of
+*     intensity images. See POL1_SNGAD for details.
+*
+*     The pixels are divided between the threads of the POLPACK
+*     workforce.
+
+*  Arguments:
+*     el
+*        The number of pixels in each image.
+*     din( el )
+*        The input intensity values.
+*     vin( el )
+*        The input variance values.
+*     phi
+*        The analyser angle for the supplied array. In radians.
+*     t
+*        The analyser transmission factor for the supplied array.
+*     eps
+*        The analyser efficieny factor for the supplied array.
+*     ie1( el )
+*        The effective intensity values for the first effective analyser.
+*     ie2( el )
+*        The effective intensity values for the second effective analyser.
+*     ie3( el )
+*        The effective intensity values for the third effective analyser.
+*     mat11( el )
+*        Column 1, row 1 of the matrix giving the effective intensities.
+*     mat21( el )
+*        Column 2, row 1 of the matrix giving the effective intensities.
+*     mat31( el )
+*        Column 3, row 1 of the matrix giving the effective intensities.
+*     mat22( el )
+*        Column 2, row 2 of the matrix giving the effective intensities.
+*     mat32( el )
+*        Column 3, row 2 of the matrix giving the effective intensities.
+*     mat33( el )
+*        Column 3, row 3 of the matrix giving the effective intensities.
+*     count( el )
+*        The number of input images contributing to each output pixel.
+*     status
+*        The global status.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either Version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+*     02110-1301, USA.
+
+*  History:
+*     14-OCT-2026:
+*        Original version, based on the Fortran POL1_SNGAD.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+/* Local Variables: */
+   ThrWorkForce *wf = NULL;
+   double cos2;
+   double sin2;
+   int iworker;
+   int nw;
+   pol1SngadJobData *job_data;
+   pol1SngadJobData *pdata;
+   size_t pstep;
+
+/* Check inherited status */
+   if( *status != SAI__OK || el == 0 ) return;
+
+/* Store some constants. */
+   cos2 = cos( (double)( 2*phi ) );
+   sin2 = sin( (double)( 2*phi ) );
+
+/* Only use the workforce for large images. */
+   nw = 1;
+   if( el >= POL1_SNG_MINTHR ) {
+      nw = thrGetNThread( POLPACK__THREADS, status );
+      wf = thrGetWorkforce( nw, status );
+      if( nw < 1 ) nw = 1;
+   }
+
+   job_data = astMalloc( nw*sizeof( *job_data ) );
+   if( *status == SAI__OK ) {
+
+/* Determine which pixels are to be processed by which threads. */
+      pstep = el/nw;
+      if( pstep < 1 ) pstep = 1;
+
+      for( iworker = 0; iworker < nw; iworker++ ) {
+         pdata = job_data + iworker;
+         pdata->p1 = iworker*pstep;
+         if( iworker < nw - 1 ) {
+            pdata->p2 = pdata->p1 + pstep - 1;
+         } else {
+            pdata->p2 = el - 1;
+         }
+         if( pdata->p1 >= el ) break;
+
+         pdata->din = din;
+         pdata->vin = vin;
+         pdata->rcos = (double) eps*cos2;
+         pdata->rsin = (double) eps*sin2;
+         pdata->rt = (double) t*(double) t;
+         pdata->t = t;
+         pdata->ie1 = ie1;
+         pdata->ie2 = ie2;
+         pdata->ie3 = ie3;
+         pdata->mat11 = mat11;
+         pdata->mat21 = mat21;
+         pdata->mat31 = mat31;
+         pdata->mat22 = mat22;
+         pdata->mat32 = mat32;
+         pdata->mat33 = mat33;
+         pdata->count = count;
+
+/* Pass the job to the workforce for execution. */
+         thrAddJob( wf, 0, pdata, pol1SngadJob, 0, NULL, status );
+      }
+
+/* Wait for the workforce to complete all jobs. */
+      thrWait( wf, status );
+   }
+
+/* Free resources. */
+   job_data = astFree( job_data );
+}
+
+
+static void pol1SngadJob( void *job_data, int *status ) {
+/*
+*  Name:
+*     pol1SngadJob
+
+*  Purpose:
+*     Executed in a worker thread to do the calculations for pol1Sngad.
+
+*  Invocation:
+*     pol1SngadJob( void *job_data, int *status )
+
+*  Arguments:
+*     job_data = pol1SngadJobData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+/* Local Variables: */
+   pol1SngadJobData *pdata;
+   double r1;
+   double r2;
+   double rc;
+   double rs;
+   float dval;
+   float varval;
+   size_t i;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Get a pointer to the job description. */
+   pdata = (pol1SngadJobData *) job_data;
+
+/* Loop round every pixel in the range. The arithmetic is the same as in
+   the Fortran version, so that the results are identical. */
+   for( i = pdata->p1; i <= pdata->p2; i++ ) {
+      dval = pdata->din[ i ];
+      varval = pdata->vin[ i ];
+
+/* Ignore this pixel if either the input variance or intensity is bad,
+   or if the variance is less than or equal to zero. */
+      if( dval != VAL__BADR && varval != VAL__BADR && varval > 0.0 ) {
+
+/* Constants... */
+         r1 = pdata->rt/varval;
+         r2 = pdata->t/(double) varval;
+         rc = r1*pdata->rcos;
+         rs = r1*pdata->rsin;
+
+/* Effective intensities... */
+         pdata->ie1[ i ] = pdata->ie1[ i ] + dval*r2;
+         pdata->ie2[ i ] = pdata->ie2[ i ] + dval*r2*pdata->rcos;
+         pdata->ie3[ i ] = pdata->ie3[ i ] + dval*r2*pdata->rsin;
+
+/* Matrix elements... */
+         pdata->mat11[ i ] = pdata->mat11[ i ] + r1;
+         pdata->mat21[ i ] = pdata->mat21[ i ] + rc;
+         pdata->mat31[ i ] = pdata->mat31[ i ] + rs;
+         pdata->mat22[ i ] = pdata->mat22[ i ] + rc*pdata->rcos;
+         pdata->mat32[ i ] = pdata->mat32[ i ] + rs*pdata->rcos;
+         pdata->mat33[ i ] = pdata->mat33[ i ] + rs*pdata->rsin;
+
+/* Increase the count of input images contributing to this pixel. */
+         pdata->count[ i ] = pdata->count[ i ] + 1.0;
+      }
+   }
+}
@@ -0,0 +1,313 @@
+#include "sae_par.h"
+#include "polsub.h"
+#include "math.h"
+#include "mers.h"
+#include "prm_par.h"
+#include "star/thr.h"
+
+/* Arrays with fewer pixels than this are processed in a single thread. */
+#define POL1_SNG_MINTHR 20000
+
+typedef struct pol1SngclJobData {
+   const float *ie1;
+   const float *ie2;
+   const float *ie3;
+   const float *mat11;
+   const float *mat21;
+   const float *mat31;
+   const float *mat22;
+   const float *mat32;
+   const float *mat33;
+   const float *count;
+   float *dout;
+   float *vout;
+   float *cout;
+   size_t el;
+   size_t p1;
+   size_t p2;
+   size_t ngood;
+} pol1SngclJobData;
+
+static void pol1SngclJob( void *job_data_ptr, int *status );
+
+void pol1Sngcl( size_t el, const float *ie1, const float *ie2,
+                const float *ie3, const float *mat11, const float *mat21,
+                const float *mat31, const float *mat22, const float *mat32,
+                const float *mat33, const float *count, float *dout,
+                float *vout, float *cout, int *status ){
+/*
+*+
+*  Name:
+*     pol1Sngcl
+
+*  Purpose:
+*     Calculate the Stokes vectors, variances and co-variances for
+*     single-beam data.
+
+*  Language:
+*     ANSI C
+
+*  Synopsis:
+*     void pol1Sngcl( size_t el, const float *ie1, const float *ie2,
+*                     const float *ie3, const float *mat11,
+*                     const float *mat21, const float *mat31,
+*                     const float *mat22, const float *mat32,
+*                     const float *mat33, const float *count, float *dout,
+*                     float *vout, float *cout, int *status )
+
+*  Description:
+*     This function calculates the Stokes vectors, variances and
+*     co-variances for a single-beam data set, and writes them into the
+*     supplied arrays. See POL1_SNGCL for details.
+*
+*     Each pixel requires the solution of a symmetric 3x3 system of
+*     linear equations, which is done in closed form. The pixels are
+*     divided between the threads of the POLPACK workforce.
+
+*  Arguments:
+*     el
+*        The number of pixels in each image.
+*     ie1( el )
+*        The effective intensity values for the first effective analyser.
+*     ie2( el )
+*        The effective intensity values for the second effective analyser.
+*     ie3( el )
+*        The effective intensity values for the third effective analyser.
+*     mat11( el )
+*        Column 1, row 1 of the matrix giving the effective intensities.
+*     mat21( el )
+*        Column 2, row 1 of the matrix giving the effective intensities.
+*     mat31( el )
+*        Column 3, row 1 of the matrix giving the effective intensities.
+*     mat22( el )
+*        Column 2, row 2 of the matrix giving the effective intensities.
+*     mat32( el )
+*        Column 3, row 2 of the matrix giving the effective intensities.
+*     mat33( el )
+*        Column 3, row 3 of the matrix giving the effective intensities.
+*     count( el )
+*        The number of input images contributing to each output pixel.
+*     dout( el, 3 )
+*        The output Stokes vectors. Plane 1 holds I, plane 2 holds Q
+*        and plane 3 holds U.
+*     vout( el, 3 )
+*        The output variance values.
+*     cout( el )
+*        The output QU co-variance values.
+*     status
+*        The global status.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either Version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+*     02110-1301, USA.
+
+*  History:
+*     14-OCT-2026:
+*        Original version, based on the Fortran POL1_SNGCL.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+/* Local Variables: */
+   ThrWorkForce *wf = NULL;
+   int iworker;
+   int nw;
+   pol1SngclJobData *job_data;
+   pol1SngclJobData *pdata;
+   size_t ngood;
+   size_t pstep;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Only use the workforce for large images. */
+   nw = 1;
+   if( el >= POL1_SNG_MINTHR ) {
+      nw = thrGetNThread( POLPACK__THREADS, status );
+      wf = thrGetWorkforce( nw, status );
+      if( nw < 1 ) nw = 1;
+   }
+
+   ngood = 0;
+   job_data = astMalloc( nw*sizeof( *job_data ) );
+   if( *status == SAI__OK && el > 0 ) {
+
+/* Determine which pixels are to be processed by which threads. */
+      pstep = el/nw;
+      if( pstep < 1 ) pstep = 1;
+
+      for( iworker = 0; iworker < nw; iworker++ ) {
+         pdata = job_data + iworker;
+         pdata->ngood = 0;
+         pdata->p1 = iworker*pstep;
+         if( iworker < nw - 1 ) {
+            pdata->p2 = pdata->p1 + pstep - 1;
+         } else {
+            pdata->p2 = el - 1;
+         }
+         if( pdata->p1 >= el ) continue;
+
+         pdata->ie1 = ie1;
+         pdata->ie2 = ie2;
+         pdata->ie3 = ie3;
+         pdata->mat11 = mat11;
+         pdata->mat21 = mat21;
+         pdata->mat31 = mat31;
+         pdata->mat22 = mat22;
+         pdata->mat32 = mat32;
+         pdata->mat33 = mat33;
+         pdata->count = count;
+         pdata->dout = dout;
+         pdata->vout = vout;
+         pdata->cout = cout;
+         pdata->el = el;
+
+/* Pass the job to the workforce for execution. */
+         thrAddJob( wf, 0, pdata, pol1SngclJob, 0, NULL, status );
+      }
+
+/* Wait for the workforce to complete all jobs. */
+      thrWait( wf, status );
+
+/* Find the total number of good output pixels. */
+      for( iworker = 0; iworker < nw; iworker++ ) {
+         ngood += job_data[ iworker ].ngood;
+      }
+   }
+
+/* Report an error if all output pixels are bad. */
+   if( ngood == 0 && *status == SAI__OK ) {
+      *status = SAI__ERROR;
+      errRep( " ", "Output would contain no good values.", status );
+   }
+
+/* Free resources. */
+   job_data = astFree( job_data );
+}
+
+
+static void pol1SngclJob( void *job_data, int *status ) {
+/*
+*  Name:
+*     pol1SngclJob
+
+*  Purpose:
+*     Executed in a worker thread to do the calculations for pol1Sngcl.
+
+*  Invocation:
+*     pol1SngclJob( void *job_data, int *status )
+
+*  Arguments:
+*     job_data = pol1SngclJobData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+/* Local Variables: */
+   pol1SngclJobData *pdata;
+   double d1, d2, d3, d5, d6, d9;
+   double den;
+   double v11, v22, v33, v23, v31, v21;
+   double vlim;
+   double y1, y2, y3;
+   float *dout;
+   float *vout;
+   size_t el;
+   size_t i;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Get a pointer to the job description. */
+   pdata = (pol1SngclJobData *) job_data;
+   el = pdata->el;
+   dout = pdata->dout;
+   vout = pdata->vout;
+
+/* Store the smallest variance which can be used. */
+   vlim = 1.0/pow( (double) VAL__MAXR, 0.25 );
+
+/* Loop round every pixel in the range. The arithmetic is the same as in
+   the Fortran version, so that the results are identical. */
+   for( i = pdata->p1; i <= pdata->p2; i++ ) {
+
+/* Store commonly used array elements. */
+      d1 = pdata->mat11[ i ];
+      d2 = pdata->mat21[ i ];
+      d3 = pdata->mat31[ i ];
+      d5 = pdata->mat22[ i ];
+      d6 = pdata->mat32[ i ];
+      d9 = pdata->mat33[ i ];
+
+/* Evaluate the denominator term. */
+      den = d3*d3*d5 + d6*d6*d1 + d9*d2*d2 - d9*d5*d1 - 2*d2*d3*d6;
+
+/* Store bad output values if the denominator is zero, or if less than
+   three input images contributed to this output pixel. */
+      if( den == 0.0 || pdata->count[ i ] < 3 ) {
+         dout[ i ] = VAL__BADR;
+         dout[ i + el ] = VAL__BADR;
+         dout[ i + 2*el ] = VAL__BADR;
+         vout[ i ] = VAL__BADR;
+         vout[ i + el ] = VAL__BADR;
+         vout[ i + 2*el ] = VAL__BADR;
+         pdata->cout[ i ] = VAL__BADR;
+
+/* Otherwise, calculate the required values. */
+      } else {
+         y1 = 2.0f*pdata->ie1[ i ];
+         y2 = 2.0f*pdata->ie2[ i ];
+         y3 = 2.0f*pdata->ie3[ i ];
+
+         v11 = d6*d6 - d9*d5;
+         v22 = d3*d3 - d1*d9;
+         v33 = d2*d2 - d5*d1;
+         v23 = d6*d1 - d2*d3;
+         v31 = d5*d3 - d2*d6;
+         v21 = d2*d9 - d6*d3;
+
+         dout[ i ] = ( y1*v11 + y2*v21 + y3*v31 ) / den;
+         dout[ i + el ] = ( y1*v21 + y2*v22 + y3*v23 ) / den;
+         dout[ i + 2*el ] = ( y1*v31 + y2*v23 + y3*v33 ) / den;
+
+/* Store the I, Q and U variances, and the the QU co-variance. Store bad
+   values if the matrix is singular. */
+         vout[ i ] = 4.0*v11/den;
+         if( vout[ i ] < vlim ) vout[ i ] = VAL__BADR;
+
+         vout[ i + el ] = 4.0*v22/den;
+         if( vout[ i + el ] < vlim ) vout[ i + el ] = VAL__BADR;
+
+         vout[ i + 2*el ] = 4.0*v33/den;
+         if( vout[ i + 2*el ] < vlim ) vout[ i + 2*el ] = VAL__BADR;
+
+         pdata->cout[ i ] = 4.0*v23/den;
+
+/* Increment the number of good output pixels. */
+         pdata->ngood++;
+      }
+   }
+}
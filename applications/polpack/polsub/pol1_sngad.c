@@ -1,6 +1,15 @@
-      SUBROUTINE POL1_SNGAD( EL, DIN, VIN, PHI, T, EPS, IE1, IE2,
-     :                       IE3, MAT11, MAT21, MAT31, MAT22, MAT32,
-     :                       MAT33, COUNT, STATUS )
+#include "f77.h"
+#include "polsub.h"
+
+F77_SUBROUTINE(pol1_sngad)( INTEGER(EL), REAL_ARRAY(DIN), REAL_ARRAY(VIN),
+                            REAL(PHI), REAL(T), REAL(EPS),
+                            REAL_ARRAY(IE1), REAL_ARRAY(IE2),
+                            REAL_ARRAY(IE3), REAL_ARRAY(MAT11),
+                            REAL_ARRAY(MAT21), REAL_ARRAY(MAT31),
+                            REAL_ARRAY(MAT22), REAL_ARRAY(MAT32),
+                            REAL_ARRAY(MAT33), REAL_ARRAY(COUNT),
+                            INTEGER(STATUS) ){
+/*
 *+
 *  Name:
 *     POL1_SNGAD
@@ -9,7 +18,7 @@
 *     Add a single-beam input intensity image into the running total images.
 
 *  Language:
-*     Starlink Fortran 77
+*     C, designed to be called from Fortran.
 
 *  Invocation:
 *     CALL POL1_SNGAD( EL, DIN, VIN, PHI, T, EPS, IE1, IE2, IE3,
@@ -64,6 +73,7 @@
 
 *  Copyright:
 *     Copyright (C) 1999 Central Laboratory of the Research Councils
+*     Copyright (C) 2026 East Asian Observatory.
 
 *  Authors:
 *     DSB: David Berry (STARLINK)
@@ -72,96 +82,36 @@
 *  History:
 *     15-JAN-1999 (DSB):
 *        Original version.
+*     14-OCT-2026:
+*        Re-written in C. The work is now done by pol1Sngad, which uses
+*        multiple threads.
 *     {enter_further_changes_here}
 
 *  Bugs:
 *     {note_any_bugs_here}
 
 *-
-
-*  Type Definitions:
-      IMPLICIT NONE              ! No implicit typing
-
-*  Global Constants:
-      INCLUDE 'SAE_PAR'          ! Standard SAE constants
-      INCLUDE 'PRM_PAR'          ! VAL__ constants
-
-*  Arguments Given:
-      INTEGER EL
-      REAL DIN( EL )
-      REAL VIN( EL )
-      REAL PHI
-      REAL T
-      REAL EPS
-
-*  Arguments Given and Returned:
-      REAL IE1( EL )
-      REAL IE2( EL )
-      REAL IE3( EL )
-      REAL MAT11( EL )
-      REAL MAT21( EL )
-      REAL MAT31( EL )
-      REAL MAT22( EL )
-      REAL MAT32( EL )
-      REAL MAT33( EL )
-      REAL COUNT( EL )
-
-*  Status:
-      INTEGER STATUS             ! Global status
-
-*  Local Variables:
-      INTEGER I                  ! Element index
-      DOUBLE PRECISION COS2, SIN2, RCOS, RSIN, RT, R1, R2, RC, RS ! Constant terms
-      REAL VARVAL                ! Variance value to use
-*.
-
-*  Check the inherited global status.
-      IF ( STATUS .NE. SAI__OK ) RETURN
-
-*  Store some constants.
-      COS2 = COS( DBLE( 2*PHI ) )
-      SIN2 = SIN( DBLE( 2*PHI ) )
-      RCOS = DBLE( EPS )*COS2
-      RSIN = DBLE( EPS )*SIN2
-      RT = DBLE( T )**2
-
-*  Loop round every pixel.
-      DO I = 1, EL
-         VARVAL = VIN( I )
-
-*  Ignore this pixel if either the input variance or intensity is bad, or if
-*  the variance is less than or equal to zero.
-         IF( DIN( I ) .NE. VAL__BADR .AND. VARVAL .NE. VAL__BADR .AND.
-     :       VARVAL .GT. 0.0 ) THEN
-
-*  Constants...
-            R1 = RT/VARVAL
-            R2 = DBLE( T )/DBLE( VARVAL )
-            RC = R1*RCOS
-            RS = R1*RSIN
-
-*  Effective intensities...
-            IE1( I ) = IE1( I ) + DIN( I )*R2
-            IE2( I ) = IE2( I ) + DIN( I )*R2*RCOS
-            IE3( I ) = IE3( I ) + DIN( I )*R2*RSIN
-
-*  Matrix elements... Row 1:
-            MAT11( I ) = MAT11( I ) + R1
-            MAT21( I ) = MAT21( I ) + RC
-            MAT31( I ) = MAT31( I ) + RS
-
-*  Matrix elements... Row 2:
-            MAT22( I ) = MAT22( I ) + RC*RCOS
-            MAT32( I ) = MAT32( I ) + RS*RCOS
-
-*  Matrix elements... Row 3:
-            MAT33( I ) = MAT33( I ) + RS*RSIN
-
-*  Increase the count of input images contributing to this pixel.
-            COUNT( I ) = COUNT( I ) + 1.0D0
-
-         END IF
-
-      END DO
-
-      END
+*/
+
+   GENPTR_INTEGER(EL)
+   GENPTR_REAL_ARRAY(DIN)
+   GENPTR_REAL_ARRAY(VIN)
+   GENPTR_REAL(PHI)
+   GENPTR_REAL(T)
+   GENPTR_REAL(EPS)
+   GENPTR_REAL_ARRAY(IE1)
+   GENPTR_REAL_ARRAY(IE2)
+   GENPTR_REAL_ARRAY(IE3)
+   GENPTR_REAL_ARRAY(MAT11)
+   GENPTR_REAL_ARRAY(MAT21)
+   GENPTR_REAL_ARRAY(MAT31)
+   GENPTR_REAL_ARRAY(MAT22)
+   GENPTR_REAL_ARRAY(MAT32)
+   GENPTR_REAL_ARRAY(MAT33)
+   GENPTR_REAL_ARRAY(COUNT)
+   GENPTR_INTEGER(STATUS)
+
+   pol1Sngad( ( *EL > 0 ) ? (size_t) *EL : 0, DIN, VIN, *PHI, *T, *EPS,
+              IE1, IE2, IE3, MAT11, MAT21, MAT31, MAT22, MAT32, MAT33,
+              COUNT, STATUS );
+}
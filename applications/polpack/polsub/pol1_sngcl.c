@@ -0,0 +1,109 @@
+#include "f77.h"
+#include "polsub.h"
+
+F77_SUBROUTINE(pol1_sngcl)( INTEGER(EL), REAL_ARRAY(IE1), REAL_ARRAY(IE2),
+                            REAL_ARRAY(IE3), REAL_ARRAY(MAT11),
+                            REAL_ARRAY(MAT21), REAL_ARRAY(MAT31),
+                            REAL_ARRAY(MAT22), REAL_ARRAY(MAT32),
+                            REAL_ARRAY(MAT33), REAL_ARRAY(COUNT),
+                            REAL_ARRAY(DOUT), REAL_ARRAY(VOUT),
+                            REAL_ARRAY(COUT), INTEGER(STATUS) ){
+/*
+*+
+*  Name:
+*     POL1_SNGCL
+
+*  Purpose:
+*     Calculate the Stokes vectors, variances and co-variances for single-beam
+*     data.
+
+*  Language:
+*     C, designed to be called from Fortran.
+
+*  Invocation:
+*     CALL POL1_SNGCL( EL, IE1, IE2, IE3, MAT11, MAT21, MAT31, MAT22,
+*                      MAT32, MAT33, COUNT, DOUT, VOUT, COUT,
+*                      STATUS )
+
+*  Description:
+*     This routine calculates the Stokes vectors, variances and co-variances
+*     for a single-beam data set, and writes them into the supplied arrays.
+*     The method used is described by Sparks & Axon (PASP ????).
+
+*  Arguments:
+*     EL = INTEGER (Given)
+*        The number of pixels in each image.
+*     IE1( EL ) = REAL (Given)
+*        The effective intensity values for the first effective analyser.
+*     IE2( EL ) = REAL (Given)
+*        The effective intensity values for the second effective analyser.
+*     IE3( EL ) = REAL (Given)
+*        The effective intensity values for the third effective analyser.
+*     MAT11( EL ) = REAL (Given)
+*        Column 1, row 1 of the matrix giving the effective intensities.
+*     MAT21( EL ) = REAL (Given)
+*        Column 2, row 1 of the matrix giving the effective intensities
+*        (equals column 1, row 2).
+*     MAT31( EL ) = REAL (Given)
+*        Column 3, row 1 of the matrix giving the effective intensities
+*        (equals column 1, row 3).
+*     MAT22( EL ) = REAL (Given)
+*        Column 2, row 2 of the matrix giving the effective intensities.
+*     MAT32( EL ) = REAL (Given)
+*        Column 3, row 2 of the matrix giving the effective intensities
+*        (equals column 2, row 3).
+*     MAT33( EL ) = REAL (Given)
+*        Column 3, row 3 of the matrix giving the effective intensities.
+*     COUNT( EL ) = REAL (Given)
+*        The number of input images contributing to each output pixel.
+*     DOUT( EL, 3 ) = REAL (Returned)
+*        The output Stokes vectors. Plane 1 holds I, plane 2 holds Q
+*        and plane 3 holds U.
+*     VOUT( EL, 3 ) = REAL (Returned)
+*        The output variance values.
+*     COUT( EL ) = REAL (Returned)
+*        The output QU co-variance values.
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Copyright:
+*     Copyright (C) 1999 Central Laboratory of the Research Councils
+*     Copyright (C) 2026 East Asian Observatory.
+
+*  Authors:
+*     DSB: David Berry (STARLINK)
+*     {enter_new_authors_here}
+
+*  History:
+*     28-JAN-1999 (DSB):
+*        Original version.
+*     14-OCT-2026:
+*        Re-written in C. The work is now done by pol1Sngcl, which uses
+*        multiple threads.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+   GENPTR_INTEGER(EL)
+   GENPTR_REAL_ARRAY(IE1)
+   GENPTR_REAL_ARRAY(IE2)
+   GENPTR_REAL_ARRAY(IE3)
+   GENPTR_REAL_ARRAY(MAT11)
+   GENPTR_REAL_ARRAY(MAT21)
+   GENPTR_REAL_ARRAY(MAT31)
+   GENPTR_REAL_ARRAY(MAT22)
+   GENPTR_REAL_ARRAY(MAT32)
+   GENPTR_REAL_ARRAY(MAT33)
+   GENPTR_REAL_ARRAY(COUNT)
+   GENPTR_REAL_ARRAY(DOUT)
+   GENPTR_REAL_ARRAY(VOUT)
+   GENPTR_REAL_ARRAY(COUT)
+   GENPTR_INTEGER(STATUS)
+
+   pol1Sngcl( ( *EL > 0 ) ? (size_t) *EL : 0, IE1, IE2, IE3, MAT11, MAT21,
+              MAT31, MAT22, MAT32, MAT33, COUNT, DOUT, VOUT, COUT, STATUS );
+}
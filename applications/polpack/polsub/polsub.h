@@ -1,5 +1,6 @@
 #ifndef POLSUB_DEFINED
 #define POLSUB_DEFINED
+#include <stddef.h>
 #include "ast.h"
 
 /* The name of the environment variable used to get the number of worker
@@ -16,5 +17,15 @@ void pol1Rotrf( int nrow, int ncol, AstFrameSet *wcs, AstFrameSet *twcs,
                 const double *qinv, const double *uinv, double *qoutv,
                 double *uoutv, AstMapping **map, int *status );
 
+void pol1Sngad( size_t el, const float *din, const float *vin, float phi,
+                float t, float eps, float *ie1, float *ie2, float *ie3,
+                float *mat11, float *mat21, float *mat31, float *mat22,
+                float *mat32, float *mat33, float *count, int *status );
+
+void pol1Sngcl( size_t el, const float *ie1, const float *ie2,
+                const float *ie3, const float *mat11, const float *mat21,
+                const float *mat31, const float *mat22, const float *mat32,
+                const float *mat33, const float *count, float *dout,
+                float *vout, float *cout, int *status );
 
 #endif
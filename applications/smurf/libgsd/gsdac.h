@@ -63,10 +63,14 @@
 *        Add gsdac_flagBad.
 *     2013-07-28 (TIMJ):
 *        Add gsdac_getRealInstrumentName
+*     2026-10-14:
+*        Add gsdac_getData, and arguments to read the spectra a scan at
+*        a time.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2008 Science and Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -257,6 +261,15 @@ dasFlag *dasFlag,    /* DAS file type (given and returned) */
 int *status          /* pointer to global status (given and returned) */
 );
 
+void gsdac_getData
+(
+const gsd *gsd,      /* GSD file access parameters (given) */
+const gsdVars *gsdVars, /* GSD headers and arrays (given) */
+const unsigned int scan, /* zero-based scan index (given) */
+float *data,         /* spectra for the scan (returned) */
+int *status          /* pointer to global status (given and returned) */
+);
+
 void gsdac_getDateVars
 (
 const gsdVars *gsdVars, /* GSD headers and arrays (given) */
@@ -270,6 +283,7 @@ void gsdac_getGSDVars
 (
 const gsd *gsd,      /* GSD file access parameters (given) */
 const dasFlag dasFlag, /* DAS file type (given) */
+const int getData,   /* copy the whole data array? (given) */
 gsdVars *gsdVars,    /* GSD headers and arrays (given and returned) */
 int *status          /* pointer to global status (given and returned) */
 );
@@ -433,6 +447,8 @@ int *status          /* pointer to global status (given and returned) */
 void gsdac_wrtData
 (
 const gsdVars *gsdVars, /* GSD headers and arrays (given) */
+const gsd *gsd,      /* GSD file to read spectra from, if
+                        gsdVars->data is NULL (given) */
 const char *directory,     /* output write directory (given) */
 const unsigned int nSteps, /* number of steps in the observation (given) */
 const dasFlag dasFlag,  /* DAS file structure flag (given) */
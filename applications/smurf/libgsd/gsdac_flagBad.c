@@ -35,9 +35,12 @@
 *  History:
 *     2008-04-21 (JB):
 *        Original.
+*     2026-10-14:
+*        Allow for a NULL data array.
 
 *  Copyright:
 *     Copyright (C) 2008 Science and Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -227,10 +230,14 @@ void gsdac_flagBad ( const dasFlag dasFlag, gsdVars *gsdVars,
       gsdVars->intTimes[i] = VAL__BADI;
   }
 
-  for ( i = 0; i < gsdVars->nBEChansOut  * gsdVars->nScanPts  *
-	gsdVars->noScans; i++ ) {
-    if ( gsdVars->data[i] == gsdVars->badVal )
-      gsdVars->data[i] = VAL__BADR;
+  /* The data array is absent if the spectra are to be read a scan at
+     a time (gsdac_getData flags them as it goes). */
+  if ( gsdVars->data ) {
+    for ( i = 0; i < gsdVars->nBEChansOut  * gsdVars->nScanPts  *
+	  gsdVars->noScans; i++ ) {
+      if ( gsdVars->data[i] == gsdVars->badVal )
+        gsdVars->data[i] = VAL__BADR;
+    }
   }
 
   if ( dasFlag == DAS_CROSS_CORR ) {
@@ -0,0 +1,152 @@
+/*
+*+
+*  Name:
+*     gsdac_getData
+
+*  Purpose:
+*     Get the spectra for a single scan from a GSD file.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     ADAM A-task
+
+*  Invocation:
+*     gsdac_getData ( const gsd *gsd, const gsdVars *gsdVars,
+*                     const unsigned int scan, float *data,
+*                     int *status );
+
+*  Arguments:
+*     gsd = const gsd* (Given)
+*        GSD file access parameters
+*     gsdVars = const gsdVars* (Given)
+*        GSD headers and arrays
+*     scan = const unsigned int (Given)
+*        Zero-based index of the scan
+*     data = float* (Returned)
+*        The spectra for the scan. Must have room for
+*        gsdVars->nBEChansOut * gsdVars->nScanPts values.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     Retrieves the part of the C13DAT array holding the spectra of
+*     every point in one scan, and replaces GSD bad values with the
+*     STARLINK bad value. This allows the spectra of an observation to
+*     be converted a scan at a time, rather than copying the whole
+*     data array with gsdac_getGSDVars.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     2026-10-14:
+*        Original.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful,but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* Standard includes */
+#include <string.h>
+#include <stdio.h>
+
+/* STARLINK includes */
+#include "gsd.h"
+#include "sae_par.h"
+#include "prm_par.h"
+#include "mers.h"
+
+/* SMURF includes */
+#include "gsdac.h"
+
+#define FUNC_NAME "gsdac_getData"
+
+void gsdac_getData ( const gsd *gsd, const gsdVars *gsdVars,
+                     const unsigned int scan, float *data,
+                     int *status )
+{
+
+  /* Local variables */
+  int actVals;                 /* actual number of values retrieved */
+  char array;                  /* array flag (should always be true) */
+  int end;                     /* end index of the array values */
+  long i;                      /* loop counter */
+  int itemno;                  /* item number of the GSD header */
+  int size;                    /* number of elements in the array */
+  int start;                   /* start index of the array values */
+  int scanSize;                /* number of values in one scan */
+  char type;                   /* data type of the item (should always be R) */
+  char unit[11];               /* unit of the GSD header */
+
+  /* Check inherited status */
+  if ( *status != SAI__OK ) return;
+
+  /* Get the item number. */
+  CALLGSD( gsdFind ( gsd->fileDsc, gsd->itemDsc, "C13DAT", &itemno,
+		     unit, &type, &array ),
+           status,
+           errRep ( FUNC_NAME, "gsdFind : Could not find element C13DAT in file", status ); );
+
+  if ( *status != SAI__OK ) return;
+
+  if ( !array || type != 'R' ) {
+    *status = SAI__ERROR;
+    errRep ( FUNC_NAME, "Expected a REAL array for C13DAT", status );
+    return;
+  }
+
+  /* The spectra are stored in time order, so those for one scan are
+     contiguous within the array. */
+  scanSize = gsdVars->nBEChansOut * gsdVars->nScanPts;
+  size = scanSize * gsdVars->noScans;
+  start = scan * scanSize + 1;
+  end = start + scanSize - 1;
+
+  if ( scan >= (unsigned int) gsdVars->noScans ) {
+    *status = SAI__ERROR;
+    msgSeti ( "SCAN", scan + 1 );
+    msgSeti ( "NSCAN", gsdVars->noScans );
+    errRep ( FUNC_NAME, "Scan ^SCAN requested from a file with ^NSCAN scans",
+             status );
+    return;
+  }
+
+  /* Get the array data. */
+  CALLGSD( gsdGet1r ( gsd->fileDsc, gsd->itemDsc, gsd->dataPtr,
+		      itemno, 1, &size, &start, &end,
+                      data, &actVals ),
+           status,
+           errRep ( FUNC_NAME, "gsdGet1r : Could not get C13DAT from GSD file", status ); );
+
+  if ( *status != SAI__OK ) return;
+
+  /* Replace GSD bad values with Starlink bad values. */
+  for ( i = 0; i < scanSize; i++ ) {
+    if ( data[i] == gsdVars->badVal )
+      data[i] = VAL__BADR;
+  }
+
+}
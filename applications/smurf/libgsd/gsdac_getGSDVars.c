@@ -14,13 +14,18 @@
 
 *  Invocation:
 *     gsdac_getGSDVars ( const gsd *gsd, const dasFlag dasFlag,
-*                        gsdVars *gsdVars, int *status );
+*                        const int getData, gsdVars *gsdVars,
+*                        int *status );
 
 *  Arguments:
 *     gsd = const gsd* (Given)
 *        GSD file access parameters
 *     dasFlag = const dasFlag (Given)
 *        DAS file type
+*     getData = const int (Given)
+*        If non-zero the whole data array is copied to gsdVars->data.
+*        Otherwise gsdVars->data is returned NULL, and the spectra can
+*        be read a scan at a time with gsdac_getData.
 *     gsdVars = gsdVars* (Given and returned)
 *        GSD headers and array data
 *     status = int* (Given and Returned)
@@ -60,9 +65,12 @@
 *        lowercase respectively.  Replace non-standard switch mode
 *        "freq" with "freqsw".  Make default sbMode UNKNOWN rather
 *        than null.
+*     2026-10-14:
+*        Add getData argument.
 
 *  Copyright:
 *     Copyright (C) 2008, 2014 Science and Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -99,7 +107,8 @@
 #define FUNC_NAME "gsdac_getGSDVars.c"
 
 void gsdac_getGSDVars ( const gsd *gsd, const dasFlag dasFlag,
-                        gsdVars *gsdVars, int *status )
+                        const int getData, gsdVars *gsdVars,
+                        int *status )
 {
 
   /* Local variables.*/
@@ -599,8 +608,12 @@ void gsdac_getGSDVars ( const gsd *gsd, const dasFlag dasFlag,
 
   gsdVars->intTimes = astMalloc ( gsdVars->noScans*
                                    sizeof(int) );
-  gsdVars->data = astMalloc ( ( gsdVars->nBEChansOut * gsdVars->nScanPts
-                                 * gsdVars->noScans )*sizeof(float) );
+  if ( getData ) {
+    gsdVars->data = astMalloc ( ( gsdVars->nBEChansOut * gsdVars->nScanPts
+                                   * gsdVars->noScans )*sizeof(float) );
+  } else {
+    gsdVars->data = NULL;
+  }
 
   if ( dasFlag == DAS_CROSS_CORR ) {
     gsdVars->hotPower = astMalloc ( gsdVars->nBESections * gsdVars->IFPerSection*
@@ -766,7 +779,7 @@ void gsdac_getGSDVars ( const gsd *gsd, const dasFlag dasFlag,
   gsdac_get1i ( gsd, "C3INTT", gsdVars->intTimes, status );
 
   /* Get the data. */
-  gsdac_get1r ( gsd, "C13DAT", gsdVars->data, status );
+  if ( getData ) gsdac_get1r ( gsd, "C13DAT", gsdVars->data, status );
 
   if ( dasFlag == DAS_CROSS_CORR ) {
     gsdac_get1r ( gsd, "C55HOTPOWER", gsdVars->hotPower, status );
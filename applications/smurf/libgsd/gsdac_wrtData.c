@@ -13,13 +13,18 @@
 *     ADAM A-task
 
 *  Invocation:
-*     gsdac_wrtData ( const gsdVars *gsdVars, char *directory,
-*                     const unsigned int nSteps, const dasFlag dasFlag,
-*                     int *status );
+*     gsdac_wrtData ( const gsdVars *gsdVars, const gsd *gsd,
+*                     char *directory, const unsigned int nSteps,
+*                     const dasFlag dasFlag, int *status );
 
 *  Arguments:
 *     gsdVars = const gsdVars* (Given)
 *        GSD headers and arrays.
+*     gsd = const gsd* (Given)
+*        The open GSD file. If gsdVars->data is NULL the spectra are
+*        read from this file a scan at a time, so that the whole data
+*        array is never copied. Otherwise it is not used and may be
+*        NULL.
 *     directory = char* (Given)
 *        Directory to write the file
 *     nSteps = const unsigned int (Given)
@@ -81,9 +86,12 @@
 *        Fix some warnings.
 *     2009-06-15 (TIMJ):
 *        New API for acsSpecWriteTS
+*     2026-10-14:
+*        Optionally read the spectra a scan at a time.
 
 *  Copyright:
 *     Copyright (C) 2008 Science and Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -129,9 +137,9 @@
 #define MAXRECEP 2
 #define MAXSUBSYS 16
 
-void gsdac_wrtData ( const gsdVars *gsdVars, const char *directory,
-                     const unsigned int nSteps, const dasFlag dasFlag,
-                     int *status )
+void gsdac_wrtData ( const gsdVars *gsdVars, const gsd *gsd,
+                     const char *directory, const unsigned int nSteps,
+                     const dasFlag dasFlag, int *status )
 {
 
   /* Local variables */
@@ -164,6 +172,9 @@ void gsdac_wrtData ( const gsdVars *gsdVars, const char *directory,
   char *recepNames[MAXRECEP]; /* names of the receptors */
   int recepsUsed;             /* number of used receptors */
   char samMode[SZFITSTR];     /* sampling mode (raster or grid) */
+  float *scanData = NULL;     /* spectra for the current scan */
+  unsigned long scanStart = 0;/* index of the first spectrum value in
+                                 scanData */
   ACSISSpecHdr *specHdr;      /* ACSIS spectrum-specific information */
   unsigned long specIndex;    /* index into spectral data */
   long spectrumSize;          /* size of spectrum data */
@@ -294,11 +305,25 @@ void gsdac_wrtData ( const gsdVars *gsdVars, const char *directory,
   /* Get the size of the data array */
   spectrumSize = gsdVars->nBEChansOut * gsdVars->nScanPts * gsdVars->nScan;
 
+  /* If the whole data array has not been read, allocate room for the
+     spectra of one scan. */
+  if ( !gsdVars->data ) {
+    scanData = astMalloc ( gsdVars->nBEChansOut * gsdVars->nScanPts *
+                           sizeof(*scanData) );
+  }
+
   /* Iterate through each time step. */
   for ( stepNum = 0; stepNum < nSteps; stepNum++ ) {
 
     specIndex = ( stepNum * spectrumSize ) / nSteps;
 
+    /* Read the spectra for each new scan. */
+    if ( scanData && stepNum % gsdVars->nScanPts == 0 ) {
+      gsdac_getData ( gsd, gsdVars, stepNum / gsdVars->nScanPts,
+                      scanData, status );
+      scanStart = specIndex;
+    }
+
     /* Fill JCMTState. */
     gsdac_putJCMTStateC ( gsdVars, stepNum, backend, dasFlag,
                           record, status );
@@ -340,6 +365,7 @@ void gsdac_wrtData ( const gsdVars *gsdVars, const char *directory,
       /* Write a spectrum to the file. */
       acsSpecWriteTS( ( subBandNum % nSubsys ) + 1,
                       gsdVars->BEChans[subBandNum],
+                      scanData ? &(scanData[specIndex - scanStart]) :
       	              &(gsdVars->data[specIndex]), record,
                       specHdr, NULL, status );
 
@@ -409,6 +435,7 @@ void gsdac_wrtData ( const gsdVars *gsdVars, const char *directory,
   astFree( specHdr );
   astFree( lineFreqs );
   astFree( IFFreqs );
+  astFree( scanData );
 
   for ( i = 0; i < gsdVars->nFEChans; i++ ) {
     astFree( recepNames[i] );
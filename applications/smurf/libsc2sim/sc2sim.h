@@ -90,12 +90,17 @@
 *        Add focposn to sc2sim_ndfwrdata API
 *     2009-11-20 (DSB):
 *        Add interp and params to sc2sim_getast_wcs API.
+*     2026-10-14:
+*        Add sc2sim_crand and sc2sim_cdrand. Add the random number stream
+*        to the sc2sim_addpnoise API, and a workforce and random number
+*        stream to the sc2sim_simframe API.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2005-2007 Particle Physics and Astronomy Research
 *     Council. Copyright (C) 2005-2008 University of British
 *     Columbia. All Rights Reserved.
+*     Copyright (C) 2026 East Asian Observatory.
 
 *  Licence:
 *     This program is free software; you can redistribute it and/or
@@ -118,7 +123,10 @@
 *-
 */
 
+#include <stdint.h>
+
 #include "ast.h"
+#include "star/thr.h"
 #include "sc2sim_par.h"
 #include "sc2da/Dits_Err.h"
 #include "sc2da/Ers.h"
@@ -144,7 +152,8 @@
 /* #define JY2PW (1.0e-5*AST__DPI*0.25*DIAMETER*DIAMETER) */
 
 void sc2sim_addpnoise( double flux_0, double sig_0, double integ_time,
-		       double *flux, int *status );
+                       uint64_t key, uint64_t counter, double *flux,
+                       int *status );
 
 void sc2sim_atmsky
 (
@@ -214,6 +223,19 @@ int digits[],         /* digitised currents (returned) */
 int *status           /* global status (given and returned) */
 );
 
+double sc2sim_cdrand
+(
+double sigma,         /* sigma of distribution (given) */
+uint64_t key,         /* random number stream (given) */
+uint64_t counter      /* position of first value in stream (given) */
+);
+
+double sc2sim_crand
+(
+uint64_t key,         /* random number stream (given) */
+uint64_t counter      /* position within stream (given) */
+);
+
 double sc2sim_drand
 (
 double sigma          /* sigma of distribution (given) */
@@ -659,6 +681,7 @@ void sc2sim_sex2double ( char *string, double *value, int *status );
 
 void sc2sim_simframe
 (
+ThrWorkForce *wf,            /* pool of worker threads (given) */
 struct sc2sim_obs_struct inx,      /* structure for values from XML (given) */
 struct sc2sim_sim_struct sinx, /* structure for sim values from XML (given)*/
 int astnaxes[2],             /* dimensions of simulated image (given) */
@@ -680,6 +703,7 @@ double *noisecoeffs,         /* 1/f noise coeffs (given) */
 double *pzero,               /* bolometer power offsets (given) */
 double samptime,             /* sample time in sec (given) */
 double start_time,           /* time at start of scan in sec  (given) */
+uint64_t rkey,               /* random number stream for this frame (given) */
 double *weights,             /* impulse response (given) */
 AstMapping *sky2map,         /* Mapping celestial->map coordinates */
 double *xbolo,               /* native X offsets of bolometers */
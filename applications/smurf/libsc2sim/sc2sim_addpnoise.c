@@ -14,7 +14,8 @@
 
  *  Invocation:
  *     sc2sim_addpnoise( double flux_0, double sig_0, double integ_time,
- *                       double *flux, int *status ) {
+ *                       uint64_t key, uint64_t counter, double *flux,
+ *                       int *status ) {
 
  *  Arguments:
  *     flux_0 = double (Given)
@@ -23,6 +24,11 @@
  *        NEP at reference power in pW/sqrt(Hz)
  *     integ_time = double (Given)
  *        Effective integration time in sec
+ *     key = uint64_t (Given)
+ *        Key identifying the random number stream (see sc2sim_crand)
+ *     counter = uint64_t (Given)
+ *        Position of the first random value to use within the stream.
+ *        Three values are used.
  *     flux = double* (Given and Returned)
  *        Flux value in pW
  *     status = int* (Given and Returned)
@@ -53,10 +59,14 @@
  *     2007-06-29 (EC):
  *        Removed physical model for noise and replaced with simple scaling
  *        from reference power/noise
+ *     2026-10-14:
+ *        Take the random number from a counter-based stream, so that
+ *        this routine can be called from several threads.
 
  *  Copyright:
  *     Copyright (C) 2005-2006 Particle Physics and Astronomy Research
  *     Council. University of British Columbia. All Rights Reserved.
+ *     Copyright (C) 2026 East Asian Observatory.
 
  *  Licence:
  *     This program is free software; you can redistribute it and/or
@@ -86,7 +96,8 @@
 #include "sc2sim.h"
 
 void sc2sim_addpnoise( double flux_0, double sig_0, double integ_time,
-                       double *flux, int *status ) {
+                       uint64_t key, uint64_t counter, double *flux,
+                       int *status ) {
 
   double err;                  /* error offset */
   double sigma;                /* NEP in pW */
@@ -98,7 +109,7 @@ void sc2sim_addpnoise( double flux_0, double sig_0, double integ_time,
   sc2sim_getsigma( flux_0, sig_0, *flux, &sigma, status );
 
   /* Calculate a random number and scale it to the required sigma */
-  err = sc2sim_drand( sigma );
+  err = sc2sim_cdrand( sigma, key, counter );
 
   /* err is already measured /sqrt(Hz) so no factor of 2 needed */
   *flux = *flux + err/sqrt(integ_time);
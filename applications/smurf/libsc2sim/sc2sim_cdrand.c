@@ -0,0 +1,95 @@
+/*
+ *+
+ *  Name:
+ *     sc2sim_cdrand
+
+ *  Purpose:
+ *     Return a zero-mean random number from a counter-based stream
+
+ *  Language:
+ *     Starlink ANSI C
+
+ *  Type of Module:
+ *     Subroutine
+
+ *  Invocation:
+ *     sc2sim_cdrand ( double sigma, uint64_t key, uint64_t counter )
+
+ *  Arguments:
+ *     sigma = double (Given)
+ *        Sigma of distribution
+ *     key = uint64_t (Given)
+ *        Key identifying the random number stream
+ *     counter = uint64_t (Given)
+ *        Position of the first value used within the stream. Values
+ *        counter, counter+1 and counter+2 are used.
+
+ *  Returned Value:
+ *     The random number.
+
+ *  Description:
+ *     Generate a double random number with zero mean, the given sigma
+ *     and the same bell-shaped distribution as sc2sim_drand. The three
+ *     uniform values that are added together are taken from
+ *     sc2sim_crand, so it is safe to call this routine from several
+ *     threads.
+
+ *  Authors:
+ *     {enter_new_authors_here}
+
+ *  History :
+ *     14-OCT-2026:
+ *        Original version.
+
+ *  Copyright:
+ *     Copyright (C) 2026 East Asian Observatory.
+ *     All Rights Reserved.
+
+ *  Licence:
+ *     This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 3 of
+ *     the License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be
+ *     useful, but WITHOUT ANY WARRANTY; without even the implied
+ *     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *     PURPOSE. See the GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this program; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ *     MA 02110-1301, USA
+
+ *  Bugs:
+ *     {note_any_bugs_here}
+ *-
+ */
+
+/* Standard includes */
+#include <stdint.h>
+
+/* SC2SIM includes */
+#include "sc2sim.h"
+
+double sc2sim_cdrand
+(
+ double sigma,         /* sigma of distribution (given) */
+ uint64_t key,         /* random number stream (given) */
+ uint64_t counter      /* position of first value in stream (given) */
+ )
+
+{
+  /* Local variables */
+  double tvalue;       /* intermediate result */
+
+  /* Add three uniform values together to shape the distribution. */
+  tvalue = sc2sim_crand( key, counter ) + sc2sim_crand( key, counter + 1 ) +
+    sc2sim_crand( key, counter + 2 );
+
+  /* tvalue is now in the range 0 to 3 with sigma 0.5 */
+  tvalue = 2.0 * ( tvalue - 1.5 );
+
+  return sigma * tvalue;
+
+}
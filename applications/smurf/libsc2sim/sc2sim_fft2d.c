@@ -35,6 +35,9 @@
  *
  *     When going from data to frequency, the result leaves low frequencies
  *     at the corners of the 2-D transform.
+ *
+ *     Each pass transforms all the rows together using a single batched
+ *     FFTW plan.
 
  *  Authors:
  *     B.D.Kelly (ROE)
@@ -43,10 +46,14 @@
  *  History :
  *     2006-09-25 (JB):
  *        Split from dsim.c
+ *     2026-10-14:
+ *        Transform the rows with one batched FFTW plan rather than
+ *        calling sc2sim_four1 for each row.
 
  *  Copyright:
  *     Copyright (C) 2005-2006 Particle Physics and Astronomy Research
  *     Council. University of British Columbia. All Rights Reserved.
+ *     Copyright (C) 2026 East Asian Observatory.
 
  *  Licence:
  *     This program is free software; you can redistribute it and/or
@@ -71,6 +78,11 @@
 
 /* Standard includes */
 #include <math.h>
+#include <fftw3.h>
+
+/* Starlink includes */
+#include "sae_par.h"
+#include "mers.h"
 
 /* SC2SIM includes */
 #include "sc2sim.h"
@@ -88,17 +100,31 @@ void sc2sim_fft2d
   /* Local variables */
   int i;
   int j;                 /* loop counter */
+  fftw_plan plan;        /* batched plan transforming every row */
   double vali;           /* stored imaginary value */
   double valr;           /* stored real value */
 
   /* Check status */
   if ( !StatusOkP(status) ) return;
 
-  /* first of all transform all the rows */
-  for ( j=0; j<size; j++ ) {
-    sc2sim_four1 ( direction, size, &(array[j*2*size]) );
+  /* Plan an unnormalised in-place transform of all the rows. As in
+     sc2sim_four1, a direction of +1 uses a positive exponent. The plan
+     is executed twice, since the rotation leaves the array layout
+     unchanged. */
+  plan = fftw_plan_many_dft( 1, &size, size,
+                             (fftw_complex *) array, NULL, 1, size,
+                             (fftw_complex *) array, NULL, 1, size,
+                             ( direction > 0 ) ? FFTW_BACKWARD : FFTW_FORWARD,
+                             FFTW_ESTIMATE );
+  if ( !plan ) {
+    *status = SAI__ERROR;
+    errRep( "sc2sim_fft2d", "Unable to create an FFTW plan", status );
+    return;
   }
 
+  /* first of all transform all the rows */
+  fftw_execute ( plan );
+
   /* Rotate through 90 degrees */
   if ( direction == 1 ) {
 
@@ -163,8 +189,7 @@ void sc2sim_fft2d
 
 
   /* Transform all the rows (formerly columns) */
-  for ( j=0; j<size; j++ ) {
-    sc2sim_four1 ( direction, size, &(array[j*2*size]) );
-  }
+  fftw_execute ( plan );
+  fftw_destroy_plan ( plan );
 
 }
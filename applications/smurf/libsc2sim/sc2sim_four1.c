@@ -4,7 +4,7 @@
  *     sc2sim_four1
 
  *  Purpose:
- *     Cooley-Tukey fft by Brenner
+ *     1-D complex FFT
 
  *  Language:
  *     Starlink ANSI C
@@ -25,8 +25,10 @@
  *        real values, odd imaginary
 
  *  Description:
- *     1-D Fourier transform originally published in FORTRAN by Brenner
- *     (see Mertz, Applied Optics vol 10 p386 1971).
+ *     Unnormalised in-place 1-D Fourier transform. This was originally
+ *     the FORTRAN algorithm published by Brenner (see Mertz, Applied
+ *     Optics vol 10 p386 1971) and now uses FFTW, so that NN need not
+ *     be a power of two.
 
  *  Authors:
  *     B.D.Kelly (bdk@roe.ac.uk)
@@ -37,10 +39,13 @@
  *        Original
  *     2006-07-20 (JB):
  *        Split from dsim.c
+ *     2026-10-14:
+ *        Use FFTW.
 
  *  Copyright:
  *     Copyright (C) 2005-2006 Particle Physics and Astronomy Research
  *     Council. University of British Columbia. All Rights Reserved.
+ *     Copyright (C) 2026 East Asian Observatory.
 
  *  Licence:
  *     This program is free software; you can redistribute it and/or
@@ -64,7 +69,7 @@
  */
 
 /* Standard includes */
-#include <math.h>
+#include <fftw3.h>
 
 /* SC2SIM includes */
 #include "sc2sim.h"
@@ -79,75 +84,18 @@ void sc2sim_four1
 
 {
   /* Local variables */
-  int m;
-  int mmax;
-  int n;
-  int j;
-  int i;
-  int istep;
-  double tempr;
-  double tempi;
-  double sinth;
-  double wstpr;
-  double wstpi;
-  double wr;
-  double wi;
-  double theta;
-
-  n = 2 * nn;
-  j = 0;
-
-  for ( i=0; i<n; i+=2 ) {
-    if( i < j )  {
-      tempr = data[j];
-      tempi = data[j+1];
-      data[j] = data[i];
-      data[j+1] = data[i+1];
-      data[i] = tempr;
-      data[i+1] = tempi;
-    }
-
-    m = n / 2;
-
-    while ( m >= 2) {
-      if ( j < m ) break;
-      j = j - m;
-      m = m / 2;
-    }
-
-    j = j + m;
-
-  }
-
-  mmax = 2;
-
-  while ( mmax < n ) {
-    istep = 2 * mmax;
-    theta = 6.28318530717959 / (double)( isign * mmax );
-    sinth = sin ( theta / 2.0 );
-    wstpr = -2.0 * sinth * sinth;
-    wstpi = sin ( theta );
-    wr = 1.0;
-    wi = 0.0;
-    for ( m=0; m<mmax; m+=2 ) {
-
-      for ( i=m; i<n; i+=istep ) {
-        j = i + mmax;
-        tempr = wr * data[j] - wi * data[j+1];
-        tempi = wr * data[j+1] + wi * data[j];
-        data[j] = data[i] - tempr;
-        data[j+1] = data[i+1] - tempi;
-        data[i] = data[i] + tempr;
-        data[i+1] = data[i+1] + tempi;
-      }
-
-      tempr = wr;
-      wr = wr * wstpr - wi * wstpi + wr;
-      wi = wi * wstpr + tempr * wstpi + wi;
-    }
-
-    mmax = istep;
-
+  fftw_plan plan;    /* FFTW plan for the transform */
+
+  /* The interleaved real/imaginary layout is the same as an array of
+     fftw_complex, so the transform can be done in-place. An isign of +1
+     uses a positive exponent, which FFTW calls a backward transform.
+     Neither direction is normalised. */
+  plan = fftw_plan_dft_1d( nn, (fftw_complex *) data, (fftw_complex *) data,
+                           ( isign > 0 ) ? FFTW_BACKWARD : FFTW_FORWARD,
+                           FFTW_ESTIMATE );
+  if( plan ) {
+    fftw_execute( plan );
+    fftw_destroy_plan( plan );
   }
 
 }
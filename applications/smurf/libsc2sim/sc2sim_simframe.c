@@ -13,18 +13,20 @@
  *     Subroutine
 
  *  Invocation:
- *     sc2sim_simframe ( struct sc2sim_obs_struct inx,
+ *     sc2sim_simframe ( ThrWorkForce *wf, struct sc2sim_obs_struct inx,
  *                       struct sc2sim_sim_struct sinx,
  *                       int astnaxes[2], double astscale, double *astsim,
  *                       int atmnaxes[2], double atmscale, double *atmsim,
  *                       double coeffs[], AstFrameSet *fset, double heater[],
  *                       int nbol, double focposn, int frame, int nterms, double *noisecoeffs,
  *                       double *pzero, double samptime, double start_time,
- *                       double *weights, AstMapping *sky2map,
+ *                       uint64_t rkey, double *weights, AstMapping *sky2map,
  *                       double *xbolo, double *ybolo, double *xbc, double *ybc,
  *                       double *position, double *dbuf, int *status )
 
  *  Arguments:
+ *     wf = ThrWorkForce * (Given)
+ *        Pointer to a pool of worker threads (may be NULL)
  *     inx = sc2sim_obs_struct (Given)
  *        Structure for values from XML
  *     sinx = sc2sim_sim_struct (Given)
@@ -63,6 +65,9 @@
  *        Sample time in sec
  *     start_time = double (Given)
  *        Time at start of scan in seconds since the simulation started
+ *     rkey = uint64_t (Given)
+ *        Key for the random number stream used by this frame (see
+ *        sc2sim_crand); each frame should have a different key.
  *     weights = double* (Given)
  *        Impulse response
  *     sky2map = AstMapping* (Given)
@@ -89,6 +94,11 @@
  *     simulation is of a FOCUS observation then a simple quadratic
  *     model is used to reduce (defocus) the astronomical signal as a
  *     function of the given focus position.
+ *
+ *     The bolometers are divided between the threads in the supplied
+ *     workforce. The photon noise and spikes use counter-based random
+ *     numbers, so that the results are the same for any number of
+ *     threads.
 
  *  Authors:
  *     B.D.Kelly (ROE)
@@ -146,11 +156,18 @@
  *        Allow NOISE observations, set the astronomical signal to zero
  *     2009-11-20 (DSB):
  *        Pass "interp" and "params" to sc2sim_getast_wcs.
+ *     2026-10-14:
+ *        - Simulate the bolometers in parallel.
+ *        - Use counter-based random numbers keyed on RKEY rather than rand().
+ *        - Use the zenith transmission for the mean atmospheric emission
+ *          of every bolometer. Previously each bolometer after the first
+ *          used the line-of-sight transmission of the previous bolometer.
  *     {enter_further_changes_here}
 
  *  Copyright:
  *     Copyright (C) 2005-2008 Particle Physics and Astronomy Research
  *     Council. University of British Columbia. All Rights Reserved.
+ *     Copyright (C) 2026 East Asian Observatory.
 
  *  Licence:
  *     This program is free software; you can redistribute it and/or
@@ -175,6 +192,7 @@
 
 /* Standard includes */
 #include <math.h>
+#include <stdint.h>
 
 /* SC2SIM includes */
 #include "sc2sim.h"
@@ -190,8 +208,47 @@
 
 #define FUNC_NAME "sc2sim_simframe"
 
+/* Number of random values reserved for each bolometer in a frame: two
+   for spikes and three for photon noise */
+#define SC2SIM__NDRAW 5
+
+/* Structure containing information about blocks of bolometers to be
+   simulated by each thread. */
+typedef struct SimframeData {
+  const struct sc2sim_obs_struct *inx;
+  const struct sc2sim_sim_struct *sinx;
+  int b1;
+  int b2;
+  int *astnaxes;
+  double astscale;
+  int *atmnaxes;
+  double atmscale;
+  double *atmsim;
+  double *coeffs;
+  double *dbuf;
+  double defocus;
+  double *heater;
+  int nbol;
+  double *noisecoeffs;
+  int nterms;
+  double *position;
+  double *pzero;
+  uint64_t rkey;
+  double samptime;
+  double *skycoord;
+  double start_time;
+  double *xbc;
+  double *ybc;
+  double zenatm;
+  double zentrans;
+} SimframeData;
+
+/* Prototypes for local functions */
+static void sc2sim1_simframe( void *job_data_ptr, int *status );
+
 void sc2sim_simframe
 (
+ ThrWorkForce *wf,            /* pool of worker threads (given) */
  struct sc2sim_obs_struct inx,  /* structure for values from XML (given) */
  struct sc2sim_sim_struct sinx, /* structure for sim values from XML (given)*/
  int astnaxes[2],             /* dimensions of simulated image (given) */
@@ -214,6 +271,7 @@ void sc2sim_simframe
  double samptime,             /* sample time in sec (given) */
  double start_time,           /* time at start of scan in sec since start of
                                  simulation (given) */
+ uint64_t rkey,               /* random number stream for this frame (given) */
  double *weights,             /* impulse response (given) */
  AstMapping *sky2map,         /* Mapping celestial->map coordinates */
  double *xbolo,               /* native X offsets of bolometers */
@@ -228,32 +286,19 @@ void sc2sim_simframe
 {
   /* Local variables */
   double a[3];                    /* Quadratic coefficients for defocus multiplier */
-  double airmass;                 /* airmass for each bolometer */
-  double astvalue;                /* obs. astronomical value in pW */
-  double atmvalue;                /* obs. atmospheric emission in pW */
-  int bol;                        /* counter for indexing bolometers */
   AstMapping *bolo2azel=NULL;     /* Mapping bolo-azel coordinates */
   AstCmpMap *bolo2map=NULL;       /* Combined mapping bolo->map coordinates */
   AstMapping *bolo2sky=NULL;      /* Mapping bolo->celestial coordinates */
-  double current;                 /* bolometer current in amps */
+  int bolstep;                    /* Number of bolometers per thread */
   double defocus = 1.0;           /* Multiplier for `de-focussing' an image */
-  double exponent;                /* Exponent of spike power law integral */
-  double flux;                    /* flux at bolometer in pW */
-  double fnoise;                  /* 1/f noise value */
-  int i;                          /* loop counter */
+  int iw;                         /* Thread index */
+  SimframeData *job_data=NULL;    /* Array of job descriptions */
   int lbnd_in[2];                 /* Pixel bounds for astTranGrid */
-  double meanatm;                 /* Mean boresight atmosphere level */
-  double phase;                   /* 1/f phase calculation */
-  int pos;                        /* lookup in noise coefficients */
-  double sigma;                   /* photon noise standard deviation */
+  int nw;                         /* Number of worker threads */
+  SimframeData *pdata;            /* Pointer to job description */
   double *skycoord=NULL;          /* az & el coordinates */
   double skytrans;                /* sky transmission (%) */
-  double spike;                   /* Spike value */
   int ubnd_in[2];
-  double xpos;                    /* X measurement position */
-  double xsky;                    /* X position on sky screen */
-  double ypos;                    /* Y measurement position */
-  double ysky;                    /* Y position on sky screen */
   double zenatm;                  /* zenith atmospheric signal (pW) */
 
   /* Check status */
@@ -345,162 +390,290 @@ void sc2sim_simframe
   sc2sim_calctrans( inx.lambda, &skytrans, sinx.tauzen, status );
   sc2sim_atmsky( inx.lambda, skytrans, &zenatm, status );
 
+  /* Check that the spike power law can be integrated */
+  if( *status == SAI__OK && sinx.spike_t0 != 0 && sinx.spike_alpha == -1 ) {
+    *status = SAI__ERROR;
+    errRep(FUNC_NAME, "Spike power-law alpha can't be -1.",status);
+  }
+
+  /* Divide the bolometers between the worker threads. The random
+     numbers used for each bolometer come from the frame's own stream,
+     so the results do not depend on the number of threads. */
+  nw = wf ? wf->nworker : 1;
+  job_data = astMalloc( nw*sizeof(*job_data) );
   if( *status == SAI__OK ) {
-    for ( bol=0; bol<nbol; bol++ ) {
-
-      /* Calculate the elevation and airmass */
-      airmass = 1.0 / sin ( skycoord[nbol + bol] );
-      xpos = position[0] + xbc[bol] + 0.5 * (double)astnaxes[0] * astscale;
-      ypos = position[1] + ybc[bol] + 0.5 * (double)astnaxes[1] * astscale;
-
-      /* Get the observed astronomical value in Jy and convert it to pW.
-         This value is not yet corrected for atmospheric transmission! */
-      astvalue = dbuf[bol];
-      astvalue = astvalue * sinx.jy2pw * defocus;
-
-      /* Calculate mean atmospheric emission at current airmass
-         from zenith emission */
-      meanatm = zenatm * ( 1.0 - pow(0.01*skytrans,airmass) ) /
-        ( 1.0 - (0.01*skytrans) );
-
-      /* Calculate the photon noise from this mean loading */
-      sc2sim_getsigma( sinx.refload, sinx.refnoise,
-                       meanatm + sinx.telemission, &sigma, status );
-
-      /* Add spikes if desired. In a given sample there is approximately
-         a inx.steptime/sinx.spike_t0 chance of there being a spike. Spikes
-         probably don't correlate with opacity, so the units are
-         non-extinction corrected Jy. The brightness distribution
-         is a power-law with fixed lower and upper limits */
-
-      spike = 0;
-      if( sinx.spike_t0 != 0 ) {
-
-        if( sinx.spike_alpha == -1 ) {
-          *status = SAI__ERROR;
-          errRep(FUNC_NAME, "Spike power-law alpha can't be -1.",status);
-          spike = 0;
-          break;
-        } else if( (((double) rand())/((double)RAND_MAX)) <
-                   inx.steptime/sinx.spike_t0 ) {
-
-          exponent = sinx.spike_alpha+1;
-          spike = pow( (((double) rand())/((double) RAND_MAX)) *
-                       ( pow(sinx.spike_p1,exponent) -
-                         pow(sinx.spike_p0,exponent) ) +
-                       pow(sinx.spike_p0,exponent), 1./exponent ) *
-            sinx.jy2pw;
-        }
+    bolstep = nbol/nw;
+    if( bolstep == 0 ) bolstep = 1;
+
+    for( iw = 0; iw < nw; iw++ ) {
+      pdata = job_data + iw;
+      pdata->b1 = iw*bolstep;
+      if( iw < nw - 1 ) {
+        pdata->b2 = pdata->b1 + bolstep - 1;
+      } else {
+        pdata->b2 = nbol - 1 ;
       }
+      if( pdata->b2 >= nbol ) pdata->b2 = nbol - 1;
+
+      pdata->inx = &inx;
+      pdata->sinx = &sinx;
+      pdata->astnaxes = astnaxes;
+      pdata->astscale = astscale;
+      pdata->atmnaxes = atmnaxes;
+      pdata->atmscale = atmscale;
+      pdata->atmsim = atmsim;
+      pdata->coeffs = coeffs;
+      pdata->heater = heater;
+      pdata->nbol = nbol;
+      pdata->nterms = nterms;
+      pdata->noisecoeffs = noisecoeffs;
+      pdata->pzero = pzero;
+      pdata->samptime = samptime;
+      pdata->start_time = start_time;
+      pdata->rkey = rkey;
+      pdata->xbc = xbc;
+      pdata->ybc = ybc;
+      pdata->position = position;
+      pdata->skycoord = skycoord;
+      pdata->defocus = defocus;
+      pdata->zentrans = skytrans;
+      pdata->zenatm = zenatm;
+      pdata->dbuf = dbuf;
+
+      thrAddJob( wf, 0, pdata, sc2sim1_simframe, 0, NULL, status );
+    }
+    thrWait( wf, status );
+  }
+  job_data = astFree( job_data );
 
-      /* Initialize atmvalue to 0 */
-      atmvalue = 0;
+  /* Free resources */
+  if( bolo2sky) bolo2sky = astAnnul(bolo2sky);
+  if( bolo2map ) bolo2map = astAnnul(bolo2map);
+  if( bolo2azel ) bolo2azel = astAnnul(bolo2azel);
+  skycoord = astFree( skycoord );
+}
 
-      /* If the add atmospheric emission flag is set, use bilinear
-         interpolation to find the atmvalue from the input sky noise
-         image */
-      if ( sinx.add_atm == 1 ) {
 
-        /* Lookup atmospheric emission - offset to near centre of the
-           atm frame.  A typical windspeed moves the sky screen at
-           equivalent to 5000 arcsec per sec.  The scalar ATMVALUE
-           contains the atmosphere map value for the current position
-           (XPOS,YPOS). */
+/* Function to be executed in a worker thread. It simulates the values
+   for the block of bolometers b1 to b2 in the current frame. */
+static void sc2sim1_simframe( void *job_data_ptr, int *status ) {
 
-        xsky = xpos + sinx.atmxvel * start_time + sinx.atmzerox;
-        ysky = ypos + sinx.atmyvel * start_time + sinx.atmzeroy;
+  /* Local variables */
+  SimframeData *pdata;            /* job description */
+  const struct sc2sim_obs_struct *inx; /* values from XML */
+  const struct sc2sim_sim_struct *sinx; /* sim values from XML */
+  double airmass;                 /* airmass for each bolometer */
+  double astvalue;                /* obs. astronomical value in pW */
+  double atmvalue;                /* obs. atmospheric emission in pW */
+  int bol;                        /* counter for indexing bolometers */
+  double current;                 /* bolometer current in amps */
+  double exponent;                /* Exponent of spike power law integral */
+  double flux;                    /* flux at bolometer in pW */
+  double fnoise;                  /* 1/f noise value */
+  int i;                          /* loop counter */
+  double meanatm;                 /* Mean boresight atmosphere level */
+  double phase;                   /* 1/f phase calculation */
+  int pos;                        /* lookup in noise coefficients */
+  uint64_t rbase;                 /* first random value for a bolometer */
+  double sigma;                   /* photon noise standard deviation */
+  double skytrans;                /* bolometer sky transmission (%) */
+  double spike;                   /* Spike value */
+  double xpos;                    /* X measurement position */
+  double xsky;                    /* X position on sky screen */
+  double ypos;                    /* Y measurement position */
+  double ysky;                    /* Y position on sky screen */
+
+  /* Copies of job description values */
+  int *astnaxes;
+  double astscale;
+  int *atmnaxes;
+  double atmscale;
+  double *atmsim;
+  double *coeffs;
+  double *dbuf;
+  double defocus;
+  double *heater;
+  int nbol;
+  double *noisecoeffs;
+  int nterms;
+  double *position;
+  double *pzero;
+  uint64_t rkey;
+  double samptime;
+  double *skycoord;
+  double start_time;
+  double *xbc;
+  double *ybc;
+  double zenatm;
+  double zentrans;
+
+  /* Check status */
+  if ( *status != SAI__OK ) return;
+
+  /* Get a pointer to the job description, and copy its values */
+  pdata = (SimframeData *) job_data_ptr;
+  inx = pdata->inx;
+  sinx = pdata->sinx;
+  astnaxes = pdata->astnaxes;
+  astscale = pdata->astscale;
+  atmnaxes = pdata->atmnaxes;
+  atmscale = pdata->atmscale;
+  atmsim = pdata->atmsim;
+  coeffs = pdata->coeffs;
+  dbuf = pdata->dbuf;
+  defocus = pdata->defocus;
+  heater = pdata->heater;
+  nbol = pdata->nbol;
+  noisecoeffs = pdata->noisecoeffs;
+  nterms = pdata->nterms;
+  position = pdata->position;
+  pzero = pdata->pzero;
+  rkey = pdata->rkey;
+  samptime = pdata->samptime;
+  skycoord = pdata->skycoord;
+  start_time = pdata->start_time;
+  xbc = pdata->xbc;
+  ybc = pdata->ybc;
+  zenatm = pdata->zenatm;
+  zentrans = pdata->zentrans;
+
+  for ( bol = pdata->b1; bol <= pdata->b2 && *status == SAI__OK; bol++ ) {
+
+    /* First random value used by this bolometer */
+    rbase = (uint64_t) bol * SC2SIM__NDRAW;
+
+    /* Calculate the elevation and airmass */
+    airmass = 1.0 / sin ( skycoord[nbol + bol] );
+    xpos = position[0] + xbc[bol] + 0.5 * (double)astnaxes[0] * astscale;
+    ypos = position[1] + ybc[bol] + 0.5 * (double)astnaxes[1] * astscale;
+
+    /* Get the observed astronomical value in Jy and convert it to pW.
+       This value is not yet corrected for atmospheric transmission! */
+    astvalue = dbuf[bol];
+    astvalue = astvalue * sinx->jy2pw * defocus;
+
+    /* Calculate mean atmospheric emission at current airmass
+       from zenith emission */
+    meanatm = zenatm * ( 1.0 - pow(0.01*zentrans,airmass) ) /
+      ( 1.0 - (0.01*zentrans) );
+
+    /* Calculate the photon noise from this mean loading */
+    sc2sim_getsigma( sinx->refload, sinx->refnoise,
+                     meanatm + sinx->telemission, &sigma, status );
+
+    /* Add spikes if desired. In a given sample there is approximately
+       a inx.steptime/sinx.spike_t0 chance of there being a spike. Spikes
+       probably don't correlate with opacity, so the units are
+       non-extinction corrected Jy. The brightness distribution
+       is a power-law with fixed lower and upper limits */
+
+    spike = 0;
+    if( sinx->spike_t0 != 0 ) {
+      if( sc2sim_crand( rkey, rbase ) < inx->steptime/sinx->spike_t0 ) {
+        exponent = sinx->spike_alpha+1;
+        spike = pow( sc2sim_crand( rkey, rbase + 1 ) *
+                     ( pow(sinx->spike_p1,exponent) -
+                       pow(sinx->spike_p0,exponent) ) +
+                     pow(sinx->spike_p0,exponent), 1./exponent ) *
+          sinx->jy2pw;
+      }
+    }
 
-        sc2sim_getbilinear ( xsky, ysky, atmscale, atmnaxes[0], atmsim,
-                             &atmvalue, status );
+    /* Initialize atmvalue to 0 */
+    atmvalue = 0;
 
-        if ( !StatusOkP(status) ) {
-          printf( "sc2sim_simframe: failed to interpolate sky bol=%d x=%e y=%e\n",
-                  bol, xpos, ypos );
+    /* If the add atmospheric emission flag is set, use bilinear
+       interpolation to find the atmvalue from the input sky noise
+       image */
+    if ( sinx->add_atm == 1 ) {
 
-          break;
-        } else {
+      /* Lookup atmospheric emission - offset to near centre of the
+         atm frame.  A typical windspeed moves the sky screen at
+         equivalent to 5000 arcsec per sec.  The scalar ATMVALUE
+         contains the atmosphere map value for the current position
+         (XPOS,YPOS). */
 
-          /* If we successfully sampled a brightness from the sky
-             noise simulation, and we have the normalization of the
-             noise power spectrum at the knee frequency (sigma),
-             scale the normalized sky noise value by sigma and add on
-             the mean level */
+      xsky = xpos + sinx->atmxvel * start_time + sinx->atmzerox;
+      ysky = ypos + sinx->atmyvel * start_time + sinx->atmzeroy;
 
-          atmvalue = atmvalue*sigma + meanatm;
-        }
+      sc2sim_getbilinear ( xsky, ysky, atmscale, atmnaxes[0], atmsim,
+                           &atmvalue, status );
 
+      if ( !StatusOkP(status) ) {
+        printf( "sc2sim_simframe: failed to interpolate sky bol=%d x=%e y=%e\n",
+                bol, xpos, ypos );
+
+        break;
       } else {
-        /* Otherwise, set atmvalue to smooth meanatm value */
-        atmvalue = meanatm;
-      }
 
-      /* Calculate atmospheric transmission for this bolometer */
-      sc2sim_atmtrans ( inx.lambda, meanatm, &skytrans, status );
+        /* If we successfully sampled a brightness from the sky
+           noise simulation, and we have the normalization of the
+           noise power spectrum at the knee frequency (sigma),
+           scale the normalized sky noise value by sigma and add on
+           the mean level */
 
-      if( *status == SAI__OK ) {
-        /*  Add atmospheric and telescope emission.
-            TELEMISSION is a constant value for all bolometers.
-            The 0.01 is needed because skytrans is a % */
-        flux = 0.01 * skytrans * astvalue + atmvalue + sinx.telemission + spike;
-      }
-      /*  Add photon noise */
-      if ( sinx.add_pns == 1 ) {
-        sc2sim_addpnoise( sinx.refload, sinx.refnoise, samptime, &flux,
-                          status );
+        atmvalue = atmvalue*sigma + meanatm;
       }
 
-      /* Add heater, assuming mean heater level is set to add onto meanatm and
-         TELEMISSION to give targetpow */
-      if( *status == SAI__OK ) {
-        if ( sinx.add_hnoise == 1 ) {
-          flux = flux + ( inx.targetpow - meanatm - sinx.telemission ) *
-            heater[bol];
-        } else {
-          flux = flux + ( inx.targetpow - meanatm - sinx.telemission );
-        }
-      }
+    } else {
+      /* Otherwise, set atmvalue to smooth meanatm value */
+      atmvalue = meanatm;
+    }
 
-      /* Convert to current with bolometer power offset.
-         The bolometer offset in PZERO(BOL) is added to the FLUX, and then
-         the power in FLUX is converted to a current in scalar CURRENT with
-         help of the polynomial expression with coefficients in COEFFS(*) */
-      if ( sinx.flux2cur == 1 ) {
+    /* Calculate atmospheric transmission for this bolometer */
+    sc2sim_atmtrans ( inx->lambda, meanatm, &skytrans, status );
 
-        sc2sim_ptoi ( flux, SC2SIM__NCOEFFS, coeffs, pzero[bol], &current,
-                      status );
+    if( *status == SAI__OK ) {
+      /*  Add atmospheric and telescope emission.
+          TELEMISSION is a constant value for all bolometers.
+          The 0.01 is needed because skytrans is a % */
+      flux = 0.01 * skytrans * astvalue + atmvalue + sinx->telemission + spike;
+    }
+    /*  Add photon noise */
+    if ( sinx->add_pns == 1 ) {
+      sc2sim_addpnoise( sinx->refload, sinx->refnoise, samptime, rkey,
+                        rbase + 2, &flux, status );
+    }
 
+    /* Add heater, assuming mean heater level is set to add onto meanatm and
+       TELEMISSION to give targetpow */
+    if( *status == SAI__OK ) {
+      if ( sinx->add_hnoise == 1 ) {
+        flux = flux + ( inx->targetpow - meanatm - sinx->telemission ) *
+          heater[bol];
       } else {
-        current = flux;
+        flux = flux + ( inx->targetpow - meanatm - sinx->telemission );
       }
+    }
 
-      if ( (sinx.add_fnoise == 1) && (*status == SAI__OK) ) {
+    /* Convert to current with bolometer power offset.
+       The bolometer offset in PZERO(BOL) is added to the FLUX, and then
+       the power in FLUX is converted to a current in scalar CURRENT with
+       help of the polynomial expression with coefficients in COEFFS(*) */
+    if ( sinx->flux2cur == 1 ) {
 
-        /*  Add instrumental 1/f noise to the smoothed data in output */
-        pos = bol * nterms * 3;
-        fnoise = 0.0;
+      sc2sim_ptoi ( flux, SC2SIM__NCOEFFS, coeffs, pzero[bol], &current,
+                    status );
 
-        for ( i=0; i<nterms*3; i+=3 ) {
-          phase = fmod ( start_time, noisecoeffs[pos+i] ) / noisecoeffs[pos+i];
-          fnoise += noisecoeffs[pos+i+1] * cos ( 2.0 * AST__DPI * phase )
-            + noisecoeffs[pos+i+2] * sin ( 2.0 * AST__DPI * phase );
-        }
+    } else {
+      current = flux;
+    }
 
-        current += fnoise;
-      }
+    if ( (sinx->add_fnoise == 1) && (*status == SAI__OK) ) {
 
-      dbuf[bol] = current;
+      /*  Add instrumental 1/f noise to the smoothed data in output */
+      pos = bol * nterms * 3;
+      fnoise = 0.0;
 
-      /* Break out of loop if bad status */
-      if( *status != SAI__OK ) {
-        bol = nbol;
+      for ( i=0; i<nterms*3; i+=3 ) {
+        phase = fmod ( start_time, noisecoeffs[pos+i] ) / noisecoeffs[pos+i];
+        fnoise += noisecoeffs[pos+i+1] * cos ( 2.0 * AST__DPI * phase )
+          + noisecoeffs[pos+i+2] * sin ( 2.0 * AST__DPI * phase );
       }
+
+      current += fnoise;
     }
-  }
 
-  /* Free resources */
-  if( bolo2sky) bolo2sky = astAnnul(bolo2sky);
-  if( bolo2map ) bolo2map = astAnnul(bolo2map);
-  if( bolo2azel ) bolo2azel = astAnnul(bolo2azel);
-  skycoord = astFree( skycoord );
+    dbuf[bol] = current;
+  }
 }
-
@@ -285,6 +285,9 @@
  *        Assign values to state.tcs_az_bc1/2 before calling sc2ast_createwcs.
  *     2012-03-06 (TIMJ):
  *        Use PAL+SOFA instead of SLA for all SLA routines except slaRdplan.
+ *     2026-10-14:
+ *        Simulate the bolometers of each frame in parallel, giving each
+ *        simulated frame its own counter-based random number stream.
  *     {enter_further_changes_here}
 
  *  Copyright:
@@ -293,6 +296,7 @@
  *     Council.
  *     Copyright (C) 2006-2008 University of British Columbia. All
  *     Rights Reserved.
+ *     Copyright (C) 2026 East Asian Observatory.
 
  *  Licence:
  *     This program is free software; you can redistribute it and/or
@@ -521,9 +525,14 @@ void sc2sim_simulate ( struct sc2sim_obs_struct *inx,
   char utdate[SZFITSTR] = "\0";   /* UT date in YYYYMMDD form */
   double vmax[2];                 /* telescope maximum velocities (arcsec) */
   double zenatm;                  /* zenith atmospheric emission */
+  uint64_t nsimframe = 0;         /* Number of frames simulated so far */
+  ThrWorkForce *wf = NULL;        /* Pointer to a pool of worker threads */
 
   if ( *status != SAI__OK) return;
 
+  /* Get a pointer to a pool of worker threads */
+  wf = thrGetWorkforce( thrGetNThread( SMF__THREADS, status ), status );
+
   /* Main routine */
   ndfBegin ();
 
@@ -1309,11 +1318,13 @@ void sc2sim_simulate ( struct sc2sim_obs_struct *inx,
 
               /* simulate one frame of data */
               if( *status == SAI__OK ) {
-                sc2sim_simframe ( *inx, *sinx, astnaxes, astscale,
+                sc2sim_simframe ( wf, *inx, *sinx, astnaxes, astscale,
                                   astdata->pntr[0], atmnaxes, atmscale,
                                   atmdata->pntr[0], coeffs, fs, heater, nbol,
                                   focposn, curframe, nterms, noisecoeffs, pzero, samptime,
-                                  timesincestart, weights,
+                                  timesincestart,
+                                  ( (uint64_t) (unsigned int) rseed << 40 ) + nsimframe++,
+                                  weights,
                                   sky2map, xbolo, ybolo, xbc, ybc,
                                   &(posptr[curframe*2]),
                                   &(dbuf[(k*nbol*maxwrite) + (nbol*frame)]),
@@ -49,9 +49,10 @@ typedef struct smfJSATiling {
 void         smf_jsainstrument( const char *param, AstFitsChan *fc,
                                 smf_inst_t def, smfJSATiling *tiling,
                                 int *status );
-void         smf_jsadicer( int indf, const char *base, int trim,
-                           smf_inst_t instrument, smf_jsaproj_t proj,
-                           size_t *ntile, Grp *grp, int *status );
+void         smf_jsadicer( ThrWorkForce *wf, int indf, const char *base,
+                           int trim, smf_inst_t instrument,
+                           smf_jsaproj_t proj, size_t *ntile, Grp *grp,
+                           int *status );
 void         smf_jsatile( int itile, smfJSATiling *jsatiling, int local_origin,
                           smf_jsaproj_t proj, AstFitsChan **fc,
                           AstFrameSet **fs, AstRegion **region, int lbnd[2],
@@ -63,6 +64,9 @@ void         smf_jsatilei2xy( int itile, smfJSATiling *jsatiling, int *xt,
                               int *yt, int *fi, int *status );
 int *        smf_jsatiles_region( AstRegion *region, smfJSATiling *tiling,
                                   int *ntile, int *status );
+int **       smf_jsatiles_regions( int nregion, AstRegion **regions,
+                                   smfJSATiling *tiling, int *ntiles,
+                                   int *status );
 int *        smf_jsatiles_data( ThrWorkForce *wf, Grp *igrp, size_t size,
                                 smfJSATiling *tiling, int *ntile, int *status );
 int          smf_jsatilexy2i( int xt, int yt, smfJSATiling *jsatiling,
@@ -62,10 +62,14 @@
 *        Added parameter "chunkfactor".
 *     10-MAY-2018 (DSB):
 *        Allow each chunk of data to have a different fakescale.
+*     2026-10-14:
+*        Multi-thread the sampling of the fake map, and use single
+*        precision extinction values directly rather than first
+*        converting them to double precision.
 *     {enter_further_changes_here}
 
 *  Copyright:
-*     Copyright (C) 2015-2018 East Asian Observatory.
+*     Copyright (C) 2015-2018,2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -100,28 +104,51 @@
 #include "libsmf/smf_typ.h"
 #include "libsmf/smf_err.h"
 
+/* Prototypes for local static functions. */
+static void smf1_addfakemap( void *job_data_ptr, int *status );
+
+/* Local data types */
+typedef struct smfAddFakeMapData {
+   const double *dext;
+   const double *fmapdata;
+   const float *fext;
+   const int *lutptr;
+   dim_t k1;
+   dim_t k2;
+   double *fakestream;
+   double *resptr;
+   double fakescale;
+   int oper;
+} SmfAddFakeMapData;
+
 void smf_addfakemap( ThrWorkForce *wf, smfArray *res, smfArray *ext,
                      smfArray *lut, int *lbnd_out, int *ubnd_out,
                      AstKeyMap *keymap, double chunkfactor, int contchunk,
                      int *status ){
 
 /* Local Variables: */
+   SmfAddFakeMapData *job_data = NULL;
+   SmfAddFakeMapData *pdata;
    char *fakemap;
    const char *tempstr;
-   double *extptr;
+   double *dextptr;
    double *fakestream = NULL;
    double *fmapdata;
    double *resptr;
    double fakedelay;
    double fakescale;
+   float *fextptr;
    int *lutptr;
    int fakemce;
    int fakendf;
+   int iw;
    int nmap;
+   int nw;
+   int oper;
    int tndf;
    size_t idx;
-   dim_t k;
    dim_t dsize;
+   dim_t kstep;
 
 /* Check inherited status */
    if( *status != SAI__OK ) return;
@@ -166,6 +193,10 @@ void smf_addfakemap( ThrWorkForce *wf, smfArray *res, smfArray *ext,
       ndfMap( fakendf, "DATA", "_DOUBLE", "READ", (void **) &fmapdata,
               &nmap, status );
 
+/* Create structures used to pass information to the worker threads. */
+      nw = wf ? wf->nworker : 1;
+      job_data = astMalloc( nw*sizeof( *job_data ) );
+
 /* Check the NDF was mapped successfully. */
       if( *status == SAI__OK  ) {
 
@@ -183,45 +214,58 @@ void smf_addfakemap( ThrWorkForce *wf, smfArray *res, smfArray *ext,
    which each bolometer value will be placed. */
             lutptr = lut->sdata[idx]->pntr[0];
 
+/* Get a pointer to the extinction correction factors, which may be
+   stored in single or double precision. */
+            dextptr = NULL;
+            fextptr = NULL;
+            if( ext && ext->sdata[idx]->dtype == SMF__FLOAT ) {
+               fextptr = ext->sdata[idx]->pntr[0];
+            } else if( ext ) {
+               dextptr = ext->sdata[idx]->pntr[0];
+            }
+
 /* If we will later be filtering the data to remove the MCE response or
    delay, we need to apply the opposite effects the fake data before adding
    it to the real data, so that the later filtering will affect only the
-   real data and not the fake data. */
+   real data and not the fake data. So first sample the fake map into a
+   separate time stream. Otherwise, the fake map values can be added
+   directly onto the residuals. */
             if( fakemce || fakedelay != 0.0 ) {
-
-/* Sample the fake map at the position of each sample, applying
-   extinction correction or not as required. Note that fakestream is set to
-   0 wherever there are no data, bad value encountered, etc. The quality
-   normally flags wherever there are gaps (which then get filled), but in
-   the case where fmapdata are missing values, QUALITY won't know about it,
-   and we'll get junk when we do the filtering. A better way to do this
-   would be to actually (temporarily) set some sort of quality (so that we
-   can gap fill)... but probably not worth the effort. */
                fakestream = astGrow( fakestream, dsize, sizeof(*fakestream));
-               if( ext ) {
-                  extptr = ext->sdata[idx]->pntr[0];
-
-                  for( k = 0; k < dsize; k++ ) {
-                     if( (resptr[k] != VAL__BADD) && (lutptr[k] != VAL__BADI) &&
-                         (extptr[k] > 0) && (fmapdata[lutptr[k]] != VAL__BADD) &&
-                         (resptr[k] != VAL__BADD) ) {
-                        fakestream[k] = fakescale*fmapdata[lutptr[k]] / extptr[k];
-                     } else {
-                        fakestream[k] = 0;
-                     }
-                  }
+               oper = 1;
+            } else {
+               oper = 2;
+            }
+
+/* See how many samples to process in each thread. */
+            kstep = dsize/nw;
+            if( kstep == 0 ) kstep = 1;
+
+/* Create jobs to sample the fake map at the position of each sample,
+   applying extinction correction or not as required. */
+            for( iw = 0; iw < nw && *status == SAI__OK; iw++ ) {
+               pdata = job_data + iw;
+               pdata->k1 = iw*kstep;
+               if( iw < nw - 1 ) {
+                  pdata->k2 = pdata->k1 + kstep - 1;
                } else {
-                  for( k=0; k<dsize; k++ ) {
-                     if( (resptr[k] != VAL__BADD) && (lutptr[k] != VAL__BADI) &&
-                         (fmapdata[lutptr[k]] != VAL__BADD) &&
-                         (resptr[k] != VAL__BADD) ) {
-                        fakestream[k] = fakescale*fmapdata[lutptr[k]];
-                     } else {
-                        fakestream[k] = 0;
-                     }
-                  }
+                  pdata->k2 = dsize - 1 ;
                }
 
+               pdata->resptr = resptr;
+               pdata->lutptr = lutptr;
+               pdata->fmapdata = fmapdata;
+               pdata->dext = dextptr;
+               pdata->fext = fextptr;
+               pdata->fakestream = fakestream;
+               pdata->fakescale = fakescale;
+               pdata->oper = oper;
+               thrAddJob( wf, 0, pdata, smf1_addfakemap, 0, NULL, status );
+            }
+            thrWait( wf, status );
+
+            if( oper == 1 ) {
+
 /* Apply any delay specified by the "fakedelay" config parameter, and
    also smooth with the MCE response. These are done in the opposite order
    to that used in smf_clean_smfArray. We temporarily hijack the RES smfData
@@ -251,39 +295,12 @@ void smf_addfakemap( ThrWorkForce *wf, smfArray *res, smfArray *ext,
                res->sdata[idx]->pntr[0] = resptr;
 
 /* Add the modified fake time stream data onto the residuals. */
-               for( k = 0; k < dsize; k++ ) {
-                  if( resptr[k] != VAL__BADD && fakestream[k] != VAL__BADD ){
-                     resptr[k] += fakestream[k];
-                  }
-               }
-
-/* If we will not be filtering the data later to remove the MCE response
-   or delay, we do not need to first find the intermediate fake time stream
-   data. So we can use less memory :-) */
-            } else {
-
-/* Version in which we are applying extinction correction */
-               if( ext ) {
-                  extptr = ext->sdata[idx]->pntr[0];
-
-                  for( k = 0; k < dsize; k++ ) {
-                     if( (resptr[k] != VAL__BADD) && (lutptr[k] != VAL__BADI) &&
-                        (extptr[k] > 0) && (fmapdata[lutptr[k]] != VAL__BADD) &&
-                        (resptr[k] != VAL__BADD) ) {
-                        resptr[k] += fakescale*fmapdata[lutptr[k]] / extptr[k];
-                     }
-                  }
-
-/* Version in which we are not applying extinction correction */
-               } else {
-                  for( k = 0; k < dsize; k++ ) {
-                     if( (resptr[k] != VAL__BADD) && (lutptr[k] != VAL__BADI) &&
-                        (fmapdata[lutptr[k]] != VAL__BADD) &&
-                        (resptr[k] != VAL__BADD) ) {
-                        resptr[k] += fakescale*fmapdata[lutptr[k]];
-                     }
-                  }
+               for( iw = 0; iw < nw && *status == SAI__OK; iw++ ) {
+                  pdata = job_data + iw;
+                  pdata->oper = 3;
+                  thrAddJob( wf, 0, pdata, smf1_addfakemap, 0, NULL, status );
                }
+               thrWait( wf, status );
             }
 
 /* Next scuba-2 subarray... */
@@ -292,9 +309,107 @@ void smf_addfakemap( ThrWorkForce *wf, smfArray *res, smfArray *ext,
 /* Free resources. */
          fakestream = astFree( fakestream );
       }
+      job_data = astFree( job_data );
       ndfAnnul( &fakendf, status );
    }
    fakemap = astFree( fakemap );
 }
 
 
+static void smf1_addfakemap( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_addfakemap
+
+*  Purpose:
+*     Executed in a worker thread to add fake map values onto a range of
+*     bolometer samples.
+
+*  Invocation:
+*     smf1_addfakemap( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = SmfAddFakeMapData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+/* Local Variables: */
+   SmfAddFakeMapData *pdata;
+   const double *dext;
+   const double *fmapdata;
+   const float *fext;
+   const int *lutptr;
+   dim_t k;
+   double *fakestream;
+   double *resptr;
+   double extval;
+   double fakescale;
+   double fval;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Get a pointer that can be used for accessing the required items in the
+   supplied structure. */
+   pdata = (SmfAddFakeMapData *) job_data_ptr;
+
+/* Save some local values for speed. */
+   dext = pdata->dext;
+   fext = pdata->fext;
+   fmapdata = pdata->fmapdata;
+   lutptr = pdata->lutptr;
+   fakestream = pdata->fakestream;
+   resptr = pdata->resptr;
+   fakescale = pdata->fakescale;
+
+/* Add the fake time stream created by a previous job onto the residuals. */
+   if( pdata->oper == 3 ) {
+      for( k = pdata->k1; k <= pdata->k2; k++ ) {
+         if( resptr[k] != VAL__BADD && fakestream[k] != VAL__BADD ){
+            resptr[k] += fakestream[k];
+         }
+      }
+
+/* Otherwise, sample the fake map at the position of each sample. A zero
+   value is used if the sample is not to be modified. */
+   } else {
+      for( k = pdata->k1; k <= pdata->k2; k++ ) {
+         fval = 0.0;
+
+         if( (resptr[k] != VAL__BADD) && (lutptr[k] != VAL__BADI) &&
+             (fmapdata[lutptr[k]] != VAL__BADD) ) {
+
+/* Apply any extinction correction. */
+            if( dext ) {
+               extval = dext[k];
+            } else if( fext ) {
+               extval = ( fext[k] == VAL__BADR ) ? VAL__BADD : fext[k];
+            } else {
+               extval = 1.0;
+            }
+
+            if( extval > 0 ) fval = fakescale*fmapdata[lutptr[k]]/extval;
+         }
+
+/* Store the value in the fake time stream (oper 1), or add it directly
+   onto the residuals (oper 2). Note that fakestream is set to 0 wherever
+   there are no data, bad value encountered, etc. The quality normally
+   flags wherever there are gaps (which then get filled), but in the case
+   where fmapdata are missing values, QUALITY won't know about it, and
+   we'll get junk when we do the filtering. A better way to do this would
+   be to actually (temporarily) set some sort of quality (so that we can
+   gap fill)... but probably not worth the effort. */
+         if( pdata->oper == 1 ) {
+            fakestream[k] = fval;
+         } else if( fval != 0.0 ) {
+            resptr[k] += fval;
+         }
+      }
+   }
+}
+
+
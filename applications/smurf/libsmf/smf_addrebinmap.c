@@ -0,0 +1,206 @@
+/*
+*+
+*  Name:
+*     smf_addrebinmap
+
+*  Purpose:
+*     Add an existing REBIN map into a newly rebinned map
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     smf_addrebinmap( int indf, const int *lbnd, const int *ubnd,
+*                      double *map, double *variance, double *weights,
+*                      double *exp_time, int *status )
+
+*  Arguments:
+*     indf = int (Given)
+*        Identifier for an existing map created by MAKEMAP using
+*        METHOD=REBIN. It must be aligned in pixel coordinates with the
+*        new map, and must have WEIGHTS and EXP_TIME NDFs in its SMURF
+*        extension.
+*     lbnd = const int * (Given)
+*        The lower pixel bounds of the new map (2 elements).
+*     ubnd = const int * (Given)
+*        The upper pixel bounds of the new map (2 elements).
+*     map = double * (Given and Returned)
+*        The data values of the new map. Returned holding the combined
+*        map.
+*     variance = double * (Given and Returned)
+*        The variances of the new map. Returned holding the variances of
+*        the combined map.
+*     weights = double * (Given and Returned)
+*        The values to be stored in the WEIGHTS NDF of the new map.
+*        Returned holding the sum of the new and existing weights.
+*     exp_time = double * (Given and Returned)
+*        The exposure time in each pixel of the new map. Returned holding
+*        the total exposure time of the combined map.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     This function adds the map held in an existing NDF into a map that
+*     has just been made by MAKEMAP using METHOD=REBIN, so that a map of
+*     an observation that is still in progress can be updated by
+*     rebinning only the data written since the existing map was made.
+*
+*     The data values are combined using the exposure times as weights.
+*     Since the exposure time in a pixel is proportional to the sum of
+*     the weights of the samples that fell in it, the combined data
+*     values equal those that would have been produced by rebinning all
+*     the data at once, provided both maps use the same step time and
+*     pixel spreading scheme. The variances are combined in the same
+*     way as the variances of the weighted mean of two independent
+*     estimates, and the weights and exposure times are summed.
+*     Existing pixels that fall outside the new map are ignored, and new
+*     pixels that fall outside the existing map are left unchanged.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     2026-10-14:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* Starlink includes */
+#include "sae_par.h"
+#include "mers.h"
+#include "ndf.h"
+#include "prm_par.h"
+#include "star/hds.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+#include "libsmf/smf_typ.h"
+
+#define FUNC_NAME "smf_addrebinmap"
+
+void smf_addrebinmap( int indf, const int *lbnd, const int *ubnd,
+                      double *map, double *variance, double *weights,
+                      double *exp_time, int *status ) {
+
+/* Local Variables */
+  HDSLoc *xloc = NULL;       /* Locator for SMURF extension */
+  dim_t i;                   /* Pixel index */
+  double *odata = NULL;      /* Existing data values */
+  double *oexp = NULL;       /* Existing exposure times */
+  double *ovar = NULL;       /* Existing variances */
+  double *owgt = NULL;       /* Existing weights */
+  double e1;                 /* Existing exposure time */
+  double e2;                 /* New exposure time */
+  double esum;               /* Combined exposure time */
+  int el;                    /* Number of mapped elements */
+  int endf = NDF__NOID;      /* Existing EXP_TIME NDF */
+  int esect = NDF__NOID;     /* Section of EXP_TIME NDF */
+  int isect = NDF__NOID;     /* Section of existing map */
+  int there = 0;             /* Is the component present? */
+  int wndf = NDF__NOID;      /* Existing WEIGHTS NDF */
+  int wsect = NDF__NOID;     /* Section of WEIGHTS NDF */
+
+/* Check inherited status */
+  if( *status != SAI__OK ) return;
+
+  ndfBegin();
+
+/* Get a section of the existing map that matches the new map. Any parts
+   that fall outside the existing map are padded with bad values. */
+  ndfSect( indf, 2, lbnd, ubnd, &isect, status );
+  ndfMap( isect, "DATA", "_DOUBLE", "READ", (void **) &odata, &el, status );
+  ndfState( isect, "VARIANCE", &there, status );
+  if( there ) {
+    ndfMap( isect, "VARIANCE", "_DOUBLE", "READ", (void **) &ovar, &el,
+            status );
+  }
+
+/* Get the same sections of the WEIGHTS and EXP_TIME NDFs. */
+  ndfXstat( indf, SMURF__EXTNAME, &there, status );
+  if( there ) {
+    ndfXloc( indf, SMURF__EXTNAME, "READ", &xloc, status );
+    datThere( xloc, "WEIGHTS", &there, status );
+    if( there ) datThere( xloc, "EXP_TIME", &there, status );
+  }
+
+  if( !there ) {
+    if( *status == SAI__OK ) {
+      *status = SAI__ERROR;
+      ndfMsg( "NDF", indf );
+      errRep( "", FUNC_NAME ": ^NDF has no WEIGHTS and EXP_TIME arrays - "
+              "was it created by MAKEMAP using METHOD=REBIN?", status );
+    }
+
+  } else {
+    ndfFind( xloc, "WEIGHTS", &wndf, status );
+    ndfSect( wndf, 2, lbnd, ubnd, &wsect, status );
+    ndfMap( wsect, "DATA", "_DOUBLE", "READ", (void **) &owgt, &el, status );
+
+    ndfFind( xloc, "EXP_TIME", &endf, status );
+    ndfSect( endf, 2, lbnd, ubnd, &esect, status );
+    ndfMap( esect, "DATA", "_DOUBLE", "READ", (void **) &oexp, &el, status );
+  }
+  if( xloc ) datAnnul( &xloc, status );
+
+/* Combine each pixel. The NDF context is ended below, annulling all
+   identifiers. */
+  if( *status == SAI__OK ) {
+    for( i = 0; i < (dim_t) el; i++ ) {
+      e1 = oexp[ i ];
+      if( odata[ i ] == VAL__BADD || e1 == VAL__BADD || e1 <= 0.0 ) continue;
+
+      e2 = exp_time[ i ];
+      if( map[ i ] == VAL__BADD || e2 == VAL__BADD || e2 <= 0.0 ) {
+        map[ i ] = odata[ i ];
+        variance[ i ] = ovar ? ovar[ i ] : VAL__BADD;
+        weights[ i ] = owgt[ i ];
+        exp_time[ i ] = e1;
+
+      } else {
+        esum = e1 + e2;
+        map[ i ] = ( odata[ i ]*e1 + map[ i ]*e2 )/esum;
+
+        if( ovar && ovar[ i ] != VAL__BADD && variance[ i ] != VAL__BADD ) {
+          variance[ i ] = ( ovar[ i ]*e1*e1 + variance[ i ]*e2*e2 )/
+                          ( esum*esum );
+        } else {
+          variance[ i ] = VAL__BADD;
+        }
+
+        if( owgt[ i ] != VAL__BADD && weights[ i ] != VAL__BADD ) {
+          weights[ i ] += owgt[ i ];
+        }
+        exp_time[ i ] = esum;
+      }
+    }
+  }
+
+  ndfEnd( status );
+}
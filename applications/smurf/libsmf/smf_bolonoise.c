@@ -16,8 +16,8 @@
 *     smf_bolonoise( ThrWorkForce *wf, smfData *data,
 *                    double gfrac, size_t window, double f_low,
 *                    double f_white1, double f_white2,
-*                    int nep, size_t len, double *whitenoise, double *fratio,
-*                    smfData **fftpow, int *status )
+*                    int nep, size_t len, dim_t seglen, double *whitenoise,
+*                    double *fratio, smfData **fftpow, int *status )
 
 *  Arguments:
 *     wf = ThrWorkForce * (Given)
@@ -49,6 +49,13 @@
 *        apodised). Set it to SMF__BADSZT to cause the paddded regions
 *        to be filled with artificial data based on the current contents
 *        of the smfData (no apodising is performed in this case).
+*        Ignored if the noise is estimated from segments (see "seglen").
+*     seglen = dim_t (Given)
+*        If non-zero, and less than the number of time slices, the power
+*        spectrum of each bolometer is estimated by averaging the power
+*        spectra of overlapping segments of this many samples, rather
+*        than from a single FFT of the whole time stream. Ignored (and
+*        the whole time stream is used) if "fftpow" is not NULL.
 *     whitenoise = double* (Returned)
 *        Externally allocated array (nbolos) that will hold estimates of
 *        the mean-square variances in bolo signals produced by white noise.
@@ -87,6 +94,19 @@
 *     If either the low-frequency or white noise power are zero, and
 *     a quality array exists, the bolometer in question will have the
 *     SMF__Q_BADB flag set.
+*
+*     If "seglen" is supplied, Welch's method is used instead of a
+*     single FFT: the time stream of each bolometer is divided into
+*     segments of "seglen" samples that overlap by half a segment.
+*     Segments containing any padding, apodisation, gaps or bad values
+*     are skipped. Each remaining segment has its mean removed and is
+*     multiplied by a Hann window, and the power spectral densities of
+*     all segments are averaged. The segments are transformed in batches
+*     using a single FFTW plan, and the bolometers are shared between the
+*     worker threads. This needs far less memory than a full-length
+*     transform, and the averaging reduces the scatter in the noise
+*     estimates. The frequency resolution is coarser, so "seglen" must
+*     be long enough to resolve "f_low".
 
 *  Notes:
 
@@ -121,10 +141,14 @@
 *        Remove flagratio argument.
 *     2011-03-04 (EC):
 *        Account for smf_fft_cart2pol behaviour change when PSD requested
+*     2026-10-14:
+*        Add "seglen" argument to allow the noise to be estimated by
+*        averaging the power spectra of segments (Welch's method).
 
 *  Copyright:
 *     Copyright (C) 2008-2009,2011 University of British Columbia.
 *     Copyright (C) 2008-2011 Science and Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -148,6 +172,10 @@
 *-
 */
 
+/* System includes */
+#include <math.h>
+#include <string.h>
+
 /* Starlink includes */
 #include "ast.h"
 #include "sae_par.h"
@@ -162,11 +190,32 @@
 
 #define FUNC_NAME "smf_bolonoise"
 
+/* Local data types */
+typedef struct smfBolonoiseData {
+  dim_t b1;                /* Index of first bolometer to process */
+  dim_t b2;                /* Index of last bolometer to process */
+  size_t bstride;          /* bolometer index stride */
+  const double *dat;       /* Pointer to the data */
+  dim_t nbatch;            /* Max. number of segments in one transform */
+  dim_t nf;                /* Number of frequencies in a segment */
+  dim_t ntslice;           /* Number of time slices */
+  double *psd;             /* Returned averaged PSD for each bolometer */
+  const smf_qual_t *qua;   /* Pointer to quality, or NULL */
+  dim_t seglen;            /* Number of samples in a segment */
+  double steptime;         /* Length of a sample in seconds */
+  size_t tstride;          /* time index stride */
+  const double *win;       /* The window function */
+  double wsum;             /* Sum of squared window values */
+} smfBolonoiseData;
+
+/* Prototypes for local static functions. */
+static void smf1_bolonoise( void *job_data_ptr, int *status );
+
 void smf_bolonoise( ThrWorkForce *wf, smfData *data, double gfrac,
                     size_t window, double f_low,
                     double f_white1, double f_white2,
-                    int nep, size_t len, double *whitenoise, double *fratio,
-                    smfData **fftpow,int *status ) {
+                    int nep, size_t len, dim_t seglen, double *whitenoise,
+                    double *fratio, smfData **fftpow, int *status ) {
 
   double *base=NULL;       /* Pointer to base coordinates of array */
   size_t bstride;          /* bolometer index stride */
@@ -175,19 +224,28 @@ void smf_bolonoise( ThrWorkForce *wf, smfData *data, double gfrac,
   size_t i_low;            /* Index in power spectrum to f_low */
   size_t i_w1;             /* Index in power spectrum to f_white1 */
   size_t i_w2;             /* Index in power spectrum to f_white2 */
+  int iw;                  /* Thread index */
   size_t j;                /* Loop counter */
+  smfBolonoiseData *job_data=NULL; /* Array of job descriptions */
   size_t mingood;          /* Min. required no. of good values in bolometer */
   dim_t nbolo;             /* Number of bolometers */
   dim_t ndata;             /* Number of data points */
   dim_t nf=0;              /* Number of frequencies */
   size_t ngood;            /* Number of good samples */
+  dim_t npsd;              /* Number of samples in each transform */
   dim_t ntslice;           /* Number of time slices */
+  int nw;                  /* Number of worker threads */
   double p_low;            /* Power at f_low */
   double p_white;          /* Average power from f_white1 to f_white2 */
   smfData *pow=NULL;       /* Pointer to power spectrum data */
+  double *psd=NULL;        /* Averaged segment PSDs for all bolometers */
+  smfBolonoiseData *pdata; /* Pointer to next job description */
   smf_qual_t *qua=NULL; /* Pointer to quality component */
   double steptime=1;       /* Length of a sample in seconds */
+  size_t step;             /* Number of bolometers per thread */
   size_t tstride;          /* time index stride */
+  double *win=NULL;        /* Window function for segments */
+  double wsum=0;           /* Sum of squared window values */
 
   if (*status != SAI__OK) return;
 
@@ -204,6 +262,16 @@ void smf_bolonoise( ThrWorkForce *wf, smfData *data, double gfrac,
   smf_get_dims( data,  NULL, NULL, &nbolo, &ntslice, &ndata, &bstride, &tstride,
                 status );
 
+  /* Use segments only if they are shorter than the time stream, and
+     the caller does not need a full-length power spectrum. */
+  if( (seglen >= ntslice) || fftpow ) seglen = 0;
+  if( seglen > 0 && seglen < 4 ) {
+    *status = SAI__ERROR;
+    errRepf( "", FUNC_NAME ": segment length (%" DIM_T_FMT
+             " samples) is too short", status, seglen );
+  }
+  npsd = seglen ? seglen : ntslice;
+
   if( *status==SAI__OK ) {
     steptime = data->hdr->steptime;
     if( steptime < VAL__SMLD ) {
@@ -212,7 +280,7 @@ void smf_bolonoise( ThrWorkForce *wf, smfData *data, double gfrac,
              status);
     } else {
       /* Frequency steps in the FFT */
-      df = 1. / (steptime * (double) ntslice );
+      df = 1. / (steptime * (double) npsd );
     }
   }
 
@@ -220,15 +288,75 @@ void smf_bolonoise( ThrWorkForce *wf, smfData *data, double gfrac,
   if( whitenoise ) for(i=0; i<nbolo; i++) whitenoise[i] = VAL__BADD;
   if( fratio ) for(i=0; i<nbolo; i++) fratio[i] = VAL__BADD;
 
-  /* FFT the data and convert to polar power spectral density form */
-  pow = smf_fft_data( wf, data, NULL, 0, len, status );
-  smf_convert_bad( wf, pow, status );
-  smf_fft_cart2pol( wf, pow, 0, 1, status );
+  /* Get the quality pointer from the smfData so that we can mask known
+     bad bolometer. */
+  qua = smf_select_qualpntr( data, NULL, status );
+
+  /* Estimate the power spectral density of each bolometer by averaging
+     the spectra of windowed segments. */
+  if( seglen && *status == SAI__OK ) {
+    nf = seglen/2 + 1;
+
+    /* Hann window, and the sum of its squares (needed to normalise the
+       PSD). */
+    win = astMalloc( seglen*sizeof(*win) );
+    psd = astMalloc( nbolo*nf*sizeof(*psd) );
+    nw = wf ? wf->nworker : 1;
+    job_data = astMalloc( nw*sizeof(*job_data) );
 
-  {
-    dim_t fdims[2];
-    smf_isfft( pow, NULL, NULL, fdims, NULL, NULL, status );
-    if( *status == SAI__OK ) nf=fdims[0];
+    if( *status == SAI__OK ) {
+      for( j=0; j<seglen; j++ ) {
+        win[j] = sin( AST__DPI*(double) j/(double) seglen );
+        win[j] *= win[j];
+        wsum += win[j]*win[j];
+      }
+
+      /* Share the bolometers out between the threads. */
+      step = nbolo/nw;
+      if( step == 0 ) step = 1;
+
+      for( iw = 0; iw < nw; iw++ ) {
+        pdata = job_data + iw;
+        pdata->b1 = iw*step;
+        pdata->b2 = ( iw < nw - 1 ) ? pdata->b1 + step - 1 : nbolo - 1;
+
+        pdata->bstride = bstride;
+        pdata->dat = data->pntr[0];
+        pdata->nf = nf;
+        pdata->ntslice = ntslice;
+        pdata->psd = psd;
+        pdata->qua = qua;
+        pdata->seglen = seglen;
+        pdata->steptime = steptime;
+        pdata->tstride = tstride;
+        pdata->win = win;
+        pdata->wsum = wsum;
+
+        /* Limit the number of segments transformed together so that the
+           work arrays for each thread are not too large. */
+        pdata->nbatch = SMF__FFTBATCH_MAXSIZE/( (seglen + 2*nf)*sizeof(double) );
+        if( pdata->nbatch > SMF__FFTBATCH ) pdata->nbatch = SMF__FFTBATCH;
+        if( pdata->nbatch < 1 ) pdata->nbatch = 1;
+
+        if( pdata->b1 < nbolo ) {
+          thrAddJob( wf, 0, pdata, smf1_bolonoise, 0, NULL, status );
+        }
+      }
+      thrWait( wf, status );
+    }
+
+  /* Otherwise, FFT the data and convert to polar power spectral density
+     form */
+  } else {
+    pow = smf_fft_data( wf, data, NULL, 0, len, status );
+    smf_convert_bad( wf, pow, status );
+    smf_fft_cart2pol( wf, pow, 0, 1, status );
+
+    {
+      dim_t fdims[2];
+      smf_isfft( pow, NULL, NULL, fdims, NULL, NULL, status );
+      if( *status == SAI__OK ) nf=fdims[0];
+    }
   }
 
   /* Check for reasonble frequencies, and integer offsets in the array */
@@ -236,10 +364,6 @@ void smf_bolonoise( ThrWorkForce *wf, smfData *data, double gfrac,
   i_w1 = smf_get_findex( f_white1, df, nf, status );
   i_w2 = smf_get_findex( f_white2, df, nf, status );
 
-  /* Get the quality pointer from the smfData so that we can mask known
-     bad bolometer. */
-  qua = smf_select_qualpntr( data, NULL, status );
-
   /* The minimum required number of good values in a bolometer. */
   mingood = ( gfrac > 0.0 ) ? ntslice*gfrac : 0;
 
@@ -248,7 +372,7 @@ void smf_bolonoise( ThrWorkForce *wf, smfData *data, double gfrac,
     if( !qua || !(qua[i*bstride]&SMF__Q_BADB) ) {
 
     /* Pointer to start of power spectrum */
-    base = pow->pntr[0];
+    base = psd ? psd : pow->pntr[0];
     base += nf*i;
 
     /* Smooth the power spectrum */
@@ -301,7 +425,7 @@ void smf_bolonoise( ThrWorkForce *wf, smfData *data, double gfrac,
            samples for example) assuming this level holds at all
            frequencies. */
 
-        whitenoise[i] = p_white * ntslice * df;
+        whitenoise[i] = p_white * npsd * df;
 
         /* If NEP set, scale this to variance in a 1-second average by
            dividing by the sampling frequency (equivalent to
@@ -322,4 +446,164 @@ void smf_bolonoise( ThrWorkForce *wf, smfData *data, double gfrac,
       smf_close_file( wf, &pow, status );
     }
   }
+
+  psd = astFree( psd );
+  win = astFree( win );
+  job_data = astFree( job_data );
+}
+
+
+
+static void smf1_bolonoise( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_bolonoise
+
+*  Purpose:
+*     Executed in a worker thread to find the averaged power spectra of
+*     segments of a range of bolometers.
+
+*  Invocation:
+*     smf1_bolonoise( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = smfBolonoiseData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*  Description:
+*     The good segments of each bolometer are copied into a work array,
+*     with their means removed and the window applied, and are then
+*     transformed together using a single strided FFTW plan. The
+*     returned PSD of a bolometer with no good segments is filled with
+*     zeros, which later causes the bolometer to be flagged as bad.
+
+*/
+
+/* Local Variables: */
+  smfBolonoiseData *pdata;
+  const double *pd;        /* Pointer to next input data value */
+  const smf_qual_t *pq;    /* Pointer to next input quality value */
+  dim_t ibatch;            /* Number of segments in the current batch */
+  dim_t ibolo;             /* Bolometer index */
+  dim_t iseg;              /* Segment index */
+  dim_t j;                 /* Loop counter */
+  dim_t k;                 /* Loop counter */
+  dim_t nf;                /* Number of frequencies */
+  dim_t nseg;              /* Number of segments in each bolometer */
+  dim_t nsum;              /* Number of segments in the average */
+  dim_t segstep;           /* Samples between the starts of segments */
+  dim_t seglen;            /* Number of samples in a segment */
+  double *fre=NULL;        /* Real parts of the transforms */
+  double *fim=NULL;        /* Imaginary parts of the transforms */
+  double *ppsd;            /* PSD for the current bolometer */
+  double *seg=NULL;        /* Windowed segments */
+  double *ps;              /* Pointer to the current segment */
+  double mean;             /* Mean value in segment */
+  double norm;             /* Normalisation for PSD */
+  fftw_iodim dims;         /* Transform dimension */
+  fftw_iodim howmany;      /* Loop dimension */
+  fftw_plan plan;          /* Plan for the current batch */
+  int good;                /* Are all samples in the segment good? */
+
+/* Check inherited status */
+  if( *status != SAI__OK ) return;
+
+/* Get a pointer that can be used for accessing the required items in the
+   supplied structure. */
+  pdata = (smfBolonoiseData *) job_data_ptr;
+  nf = pdata->nf;
+  seglen = pdata->seglen;
+
+/* Segments overlap by half their length. */
+  segstep = seglen/2;
+  nseg = ( pdata->ntslice - seglen )/segstep + 1;
+
+/* Work arrays for a batch of segments. */
+  seg = astMalloc( pdata->nbatch*seglen*sizeof(*seg) );
+  fre = astMalloc( pdata->nbatch*nf*sizeof(*fre) );
+  fim = astMalloc( pdata->nbatch*nf*sizeof(*fim) );
+
+  dims.n = seglen;
+  dims.is = 1;
+  dims.os = 1;
+  howmany.is = seglen;
+  howmany.os = nf;
+
+/* Normalise so that the PSD has the same units as those produced by
+   smf_fft_data and smf_fft_cart2pol (i.e. the mean PSD of white noise
+   with variance sigma^2 is sigma^2 times the sample length). */
+  norm = pdata->steptime/pdata->wsum;
+
+  for( ibolo=pdata->b1; (*status==SAI__OK) && (ibolo<=pdata->b2); ibolo++ ) {
+    ppsd = pdata->psd + ibolo*nf;
+    memset( ppsd, 0, nf*sizeof(*ppsd) );
+    nsum = 0;
+
+    if( pdata->qua && (pdata->qua[ibolo*pdata->bstride] & SMF__Q_BADB) ) {
+      continue;
+    }
+
+    iseg = 0;
+    while( iseg < nseg && *status == SAI__OK ) {
+
+/* Copy the next batch of good segments into the work array, removing
+   the mean and applying the window. */
+      ibatch = 0;
+      while( iseg < nseg && ibatch < pdata->nbatch ) {
+        pd = pdata->dat + ibolo*pdata->bstride + iseg*segstep*pdata->tstride;
+        pq = pdata->qua ? pdata->qua + ibolo*pdata->bstride +
+                          iseg*segstep*pdata->tstride : NULL;
+        ps = seg + ibatch*seglen;
+
+        good = 1;
+        mean = 0.0;
+        for( j=0; j<seglen; j++ ) {
+          if( *pd == VAL__BADD ||
+              ( pq && ( pq[j*pdata->tstride] & (SMF__Q_GAP|SMF__Q_BOUND) ) ) ) {
+            good = 0;
+            break;
+          }
+          ps[j] = *pd;
+          mean += *pd;
+          pd += pdata->tstride;
+        }
+
+        if( good ) {
+          mean /= seglen;
+          for( j=0; j<seglen; j++ ) ps[j] = ( ps[j] - mean )*pdata->win[j];
+          ibatch++;
+        }
+        iseg++;
+      }
+
+/* Transform the batch and add the power at each frequency into the sum
+   for the bolometer. */
+      if( ibatch > 0 ) {
+        howmany.n = ibatch;
+        plan = smf_fftw_plan( 0, 1, &dims, 1, &howmany, 1, seg, fre, fim,
+                              status );
+        if( plan ) {
+          fftw_execute_split_dft_r2c( plan, seg, fre, fim );
+
+          for( k=0; k<ibatch; k++ ) {
+            for( j=0; j<nf; j++ ) {
+              ppsd[j] += fre[k*nf+j]*fre[k*nf+j] + fim[k*nf+j]*fim[k*nf+j];
+            }
+          }
+          nsum += ibatch;
+        }
+      }
+    }
+
+    if( nsum > 0 ) {
+      for( j=0; j<nf; j++ ) ppsd[j] *= norm/nsum;
+    }
+  }
+
+  seg = astFree( seg );
+  fre = astFree( fre );
+  fim = astFree( fim );
 }
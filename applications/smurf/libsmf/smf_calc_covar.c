@@ -4,7 +4,7 @@
 *     smf_calc_covar
 
 *  Purpose:
-*     Low-level routine to compute covariance using GSL
+*     Low-level routine to compute the covariance of two bolometers
 
 *  Language:
 *     Starlink ANSI C
@@ -31,12 +31,14 @@
 *        Pointer to global status.
 
 *  Description:
-*     This routine returns the covariance of two time streams, using
-*     the GSL routine gsl_stats_covariance. The bolometer indices are
-*     given along with the range of values to include in the
-*     samples. Note that the range lo to hi is INCLUSIVE. If both lo
-*     and hi are zero then the entire range is used. On error a value
-*     of VAL__BADD is returned.
+*     This routine returns the covariance of two time streams. The
+*     bolometer indices are given along with the range of values to
+*     include in the samples. Note that the range lo to hi is
+*     INCLUSIVE. If both lo and hi are zero then the entire range is
+*     used. Time slices at which either bolometer has a bad value are
+*     given zero weight. On error, or if fewer than two time slices
+*     have good values for both bolometers, a value of VAL__BADD is
+*     returned.
 
 *  Notes:
 
@@ -51,6 +53,12 @@
 *        Free allocated resources
 *     2007-12-18 (AGG):
 *        Update to use new smf_free behaviour
+*     14-OCT-2026:
+*        Calculate the covariance directly from the data array rather
+*        than copying both time streams for gsl_stats_covariance. This
+*        also fixes the handling of non-zero "lo", bolometer-ordered data
+*        and bad values, and checks bolometer indices against the
+*        number of bolometers rather than time slices.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -81,9 +89,6 @@
 /* Standard includes */
 #include <stdio.h>
 
-/* GSL includes */
-#include "gsl/gsl_statistics_double.h"
-
 /* Starlink includes */
 #include "sae_par.h"
 #include "ast.h"
@@ -106,11 +111,18 @@ double smf_calc_covar ( const smfData *data, const size_t i, const size_t j,
   double *indata = NULL;      /* Pointer to input data array */
   size_t k;                   /* Loop counter */
   dim_t nframes;              /* Max number of data points*/
-  size_t npts;                   /* Number of points in timeseries */
+  size_t npts;                /* Number of good points in timeseries */
   dim_t nbol;                 /* Number of bolometers */
-  double *idata = NULL;       /* Pointer to array for bolometer 1 data */
-  double *jdata = NULL;       /* Pointer to array for bolometer 2 data */
-  size_t temp;                   /* Temporary variable */
+  double *pi = NULL;          /* Pointer to bolometer 1 data */
+  double *pj = NULL;          /* Pointer to bolometer 2 data */
+  size_t bstride;             /* Bolometer stride */
+  size_t tstride;             /* Time slice stride */
+  size_t temp;                /* Temporary variable */
+  double meani;               /* Mean of bolometer 1 */
+  double meanj;               /* Mean of bolometer 2 */
+  double sum_xy;              /* Sum of products of residuals */
+  double vi;                  /* Bolometer 1 value */
+  double vj;                  /* Bolometer 2 value */
   double covar = VAL__BADD;   /* Covariance, initialuzed to bad */
 
   /* Check status */
@@ -120,23 +132,24 @@ double smf_calc_covar ( const smfData *data, const size_t i, const size_t j,
   if (!smf_dtype_check_fatal( data, NULL, SMF__DOUBLE, status)) return covar;
 
   /* Do we have 2-D image or 3-D timeseries data? */
-  smf_get_dims( data,  NULL, NULL, &nbol, &nframes, NULL, NULL, NULL, status);
+  smf_get_dims( data,  NULL, NULL, &nbol, &nframes, NULL, &bstride, &tstride,
+                status);
   if (*status != SAI__OK) return covar;
 
   /* Check bolometer indices are in range */
-  if ( i > nframes ) {
+  if ( i >= nbol ) {
     if ( *status == SAI__OK) {
       msgSeti("I", i);
-      msgSeti("N", nframes);
+      msgSeti("N", nbol);
       *status = SAI__ERROR;
       errRep(FUNC_NAME, "Requested bolometer index, ^I, is out of range (0 < i < ^N).", status);
       return covar;
     }
   }
-  if ( j > nframes ) {
+  if ( j >= nbol ) {
     if ( *status == SAI__OK) {
       msgSeti("I", j);
-      msgSeti("N", nframes);
+      msgSeti("N", nbol);
       *status = SAI__ERROR;
       errRep(FUNC_NAME, "Requested bolometer index, ^I, is out of range (0 < i < ^N).", status);
       return covar;
@@ -144,7 +157,7 @@ double smf_calc_covar ( const smfData *data, const size_t i, const size_t j,
   }
 
   /* Check requested range is valid */
-  if ( lo > nframes ) {
+  if ( lo >= nframes ) {
     if ( *status == SAI__OK) {
       msgSeti("J", lo);
       msgSeti("N", nframes);
@@ -153,7 +166,7 @@ double smf_calc_covar ( const smfData *data, const size_t i, const size_t j,
       return covar;
     }
   }
-  if ( hi > nframes ) {
+  if ( hi >= nframes ) {
     if ( *status == SAI__OK) {
       msgSeti("J", hi);
       msgSeti("N", nframes);
@@ -176,38 +189,43 @@ double smf_calc_covar ( const smfData *data, const size_t i, const size_t j,
     hi = nframes - 1;
   }
 
-  /* Allocate memory for data */
-  npts = hi - lo + 1;
-  idata = astCalloc( npts, sizeof(double) );
-  if ( idata == NULL ) {
-    msgSeti("N",i);
-    errRep( FUNC_NAME, "Unable to allocate memory for bolometer ^N timeseries", status );
-    return covar;
-  }
-  jdata = astCalloc( npts, sizeof(double) );
-  if ( jdata == NULL ) {
-    msgSeti("N",j);
-    errRep( FUNC_NAME, "Unable to allocate memory for bolometer ^N timeseries", status );
-    return covar;
-  }
-
-  /* Set range of data. Use <= because the range is inclusive. */
+  /* Pointers to the first sample of each bolometer. Use <= below because
+     the range is inclusive. */
   indata = (data->pntr)[0];
-  /* Pick out a bolometer time series */
-  for ( k=lo; k<=hi; k++) {
-    idata[k] = indata[i + k*nbol];
-    jdata[k] = indata[j + k*nbol];
+  pi = indata + i*bstride + lo*tstride;
+  pj = indata + j*bstride + lo*tstride;
+
+  /* Find the mean value of each bolometer, using only time slices at
+     which both bolometers are good. */
+  meani = 0.0;
+  meanj = 0.0;
+  npts = 0;
+  for ( k=lo; k<=hi; k++ ) {
+    vi = pi[ (k-lo)*tstride ];
+    vj = pj[ (k-lo)*tstride ];
+    if ( vi != VAL__BADD && vj != VAL__BADD ) {
+      meani += vi;
+      meanj += vj;
+      npts++;
+    }
   }
 
-  /* Calculate stats */
-  covar = gsl_stats_covariance( idata, 1, jdata, 1, npts );
+  /* Sum the products of the residuals about the means. */
+  if ( npts > 1 ) {
+    meani /= npts;
+    meanj /= npts;
+
+    sum_xy = 0.0;
+    for ( k=lo; k<=hi; k++ ) {
+      vi = pi[ (k-lo)*tstride ];
+      vj = pj[ (k-lo)*tstride ];
+      if ( vi != VAL__BADD && vj != VAL__BADD ) {
+        sum_xy += ( vi - meani )*( vj - meanj );
+      }
+    }
 
-  /* Free resources */
-  if ( idata != NULL)
-    idata = astFree( idata );
-  if ( jdata != NULL)
-    jdata = astFree( jdata );
+    covar = sum_xy / ( (double) npts - 1 );
+  }
 
   return covar;
-
 }
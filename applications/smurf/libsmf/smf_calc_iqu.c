@@ -126,10 +126,14 @@
 *        problems with focal plane distortion.
 *        - Calculate Q/U/I using matrix inversion rather than assuming 
 *        that sums of trig functions can be taken to be zero.
+*     14-OCT-2026:
+*        Find the analyser angle and its cosine and sine at each time
+*        slice once, rather than separately for every bolometer.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2011-2013 Science and Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -164,7 +168,6 @@
 
 /* Local data types: */
 typedef struct smfCalcIQUJobData {
-   const JCMTState *allstates;
    dim_t b1;
    dim_t b2;
    dim_t nbolo;
@@ -177,20 +180,16 @@ typedef struct smfCalcIQUJobData {
    double *ipiv;
    double *ipqv;
    double *ipuv;
-   double angfac;
    double angrot;
-   double paoff;
    int block_end;
    int block_start;
-   int ipolcrd;
    int gotvar;
    int ncol;
-   int old;
-   int pasign;
    size_t bstride;
    size_t tstride;
    smf_qual_t *qua;
    double *mean;
+   const double *trig;
    int action;
 } smfCalcIQUJobData;
 
@@ -246,7 +245,13 @@ void smf_calc_iqu( ThrWorkForce *wf, smfData *data, int block_start,
    double *ipu;               /* Pointer to output U array */
    double *ipuv;              /* Pointer to output U variance array */
    double *mean;
+   double *pt;                /* Pointer to next trig table entry */
+   double *trig;              /* Analyser angle, cos and sin per time slice */
    double ang_data[2];
+   double angle;              /* Analyser angle for current time slice */
+   double angfac;             /* Harmonic scaling factor for analyser angle */
+   double phi;                /* Angle from fixed analyser to effective analyser */
+   double wplate;             /* Angle from fixed analyser to half-wave plate */
    double fox[2];
    double foy[2];
    double fpr0;
@@ -401,6 +406,12 @@ void smf_calc_iqu( ThrWorkForce *wf, smfData *data, int block_start,
    time slice. */
    mean = submean ? astMalloc( ntslice*sizeof( *mean ) ) : NULL;
 
+/* Allocate memory to hold the effective analyser angle, and its cosine
+   and sine, at each time slice in the block. These are the same for all
+   bolometers, so they are found once here rather than separately for
+   each bolometer within the worker threads. */
+   trig = astMalloc( 3*( block_end - block_start + 1 )*sizeof( *trig ) );
+
 /* Create structures used to pass information to the worker threads. */
    nworker = wf ? wf->nworker : 1;
    job_data = astMalloc( nworker*sizeof( *job_data ) );
@@ -465,6 +476,41 @@ void smf_calc_iqu( ThrWorkForce *wf, smfData *data, int block_start,
 
       }
 
+/* Fill the table of analyser angles. The angle is stored as VAL__BADD
+   if POL_ANG is bad for the time slice. See smf1_calc_iqu_job for the
+   meaning of the various angles. */
+      angfac = harmonic/4.0;
+      state = hdr->allState + block_start;
+      pt = trig;
+      for( itime = block_start; (int) itime <= block_end; itime++,state++ ) {
+         angle = state->pol_ang;
+         if( angle != VAL__BADD ) {
+            if( old ) angle = angle*TORADS;
+
+            wplate = 0.0;
+            if( ipolcrd == 0 ) {
+               wplate = ( pasign ? +1 : -1 )*angle + paoff;
+
+            } else if( *status == SAI__OK ) {
+               *status = SAI__ERROR;
+               errRepf( "", "smf_calc_iqu: currently only POL_CRD = "
+                        "FPLANE is supported.", status );
+            }
+
+            phi = 2*wplate;
+            angle = 2*phi;
+            angle *= angfac;
+
+            *(pt++) = angle;
+            *(pt++) = cos( angle );
+            *(pt++) = sin( angle );
+         } else {
+            *(pt++) = VAL__BADD;
+            *(pt++) = VAL__BADD;
+            *(pt++) = VAL__BADD;
+         }
+      }
+
 /* Get the Frame representing absolute sky coords in the output NDF,
    and the Mapping from sky to grid in the output NDF. */
       oskyfrm = astCopy( astGetFrame( wcs, AST__CURRENT ) );
@@ -545,26 +591,21 @@ void smf_calc_iqu( ThrWorkForce *wf, smfData *data, int block_start,
          pdata->nbolo = nbolo;
          pdata->qua = smf_select_qualpntr( data, NULL, status );;
          pdata->tstride = tstride;
-         pdata->allstates = hdr->allState;
          pdata->ipq = ipq;
          pdata->ipu = ipu;
          pdata->ipi = ipi;
          pdata->ipqv = ipqv;
          pdata->ipuv = ipuv;
          pdata->ipiv = ipiv;
-         pdata->ipolcrd = ipolcrd;
          pdata->block_start = block_start;
          pdata->block_end = block_end;
-         pdata->old = old;
          pdata->ncol = ncol;
-         pdata->pasign = pasign ? +1: -1;
-         pdata->paoff = paoff;
          pdata->angrot = angrot;
          pdata->fpr0 = fpr0;
          pdata->fprinc = fprinc;
-         pdata->angfac = harmonic/4.0;
          pdata->action = 0;
          pdata->mean = mean;
+         pdata->trig = trig;
 
 /* Pass the job to the workforce for execution. */
          thrAddJob( wf, THR__REPORT_JOB, pdata, smf1_calc_iqu_job, 0, NULL,
@@ -611,6 +652,7 @@ void smf_calc_iqu( ThrWorkForce *wf, smfData *data, int block_start,
 /* Free other resources. */
    job_data = astFree( job_data );
    mean = astFree( mean );
+   trig = astFree( trig );
 }
 
 
@@ -640,8 +682,6 @@ static void smf1_calc_iqu_job( void *job_data, int *status ) {
 */
 
 /* Local Variables: */
-   const JCMTState *allstates;/* Pointer to array of JCMTState structures */
-   const JCMTState *state;    /* JCMTState info for current time slice */
    dim_t b1;                  /* First bolometer index */
    dim_t b2;                  /* Last bolometer index */
    dim_t ibolo;               /* Bolometer index */
@@ -658,7 +698,6 @@ static void smf1_calc_iqu_job( void *job_data, int *status ) {
    double *ipuv;
    double *pm;                /* Pointer to next time slice mean value */
    double ang;
-   double angfac;
    double angle;              /* Phase angle for FFT */
    double angle_l;
    double angrot;             /* Angle from focal plane X axis to fixed analyser */
@@ -670,8 +709,6 @@ static void smf1_calc_iqu_job( void *job_data, int *status ) {
    double fpr0;
    double fprinc;
    double i;                  /* Output I value */
-   double paoff;              /* WPLATE value corresponding to POL_ANG=0.0 */
-   double phi;                /* Angle from fixed analyser to effective analyser */
    double q0;                 /* Q value with respect to fixed analyser */
    double q;                  /* Output Q value */
    double rot;                /* Rotation angle included in current s1/2/3 values */
@@ -702,10 +739,8 @@ static void smf1_calc_iqu_job( void *job_data, int *status ) {
    double vq;
    double vu0;
    double vu;
-   double wplate;             /* Angle from fixed analyser to have-wave plate */
    int block_end;             /* Last time slice to process */
    int block_start;           /* First time slice to process */
-   int ipolcrd;               /* Reference direction for pol_ang */
    int itime;                 /* Time slice index */
    int itime_start;           /* Time slice index at start of section */
    int limit2;                /* Min no of good i/p values for a good single estimate */
@@ -714,8 +749,6 @@ static void smf1_calc_iqu_job( void *job_data, int *status ) {
    int ncol;                  /* No. of bolometers in one row */
    int nn;                    /* Number of good bolometer values */
    int nrot;
-   int old;                   /* Data has old-style POL_ANG values? */
-   int pasign;                /* +1 or -1 indicating sense of POL_ANG value */
    size_t bstride;            /* Stride between adjacent bolometer values */
    size_t tstride;            /* Stride between adjacent time slice values */
    smfCalcIQUJobData *pdata;  /* Pointer to job data */
@@ -737,22 +770,16 @@ static void smf1_calc_iqu_job( void *job_data, int *status ) {
    nbolo = pdata->nbolo;
    qua = pdata->qua;
    tstride = pdata->tstride;
-   allstates = pdata->allstates;
    ipi = pdata->ipi;
    ipq = pdata->ipq;
    ipu = pdata->ipu;
    ipiv = pdata->ipiv;
    ipqv = pdata->ipqv;
    ipuv = pdata->ipuv;
-   ipolcrd = pdata->ipolcrd;
    block_start = pdata->block_start;
    block_end = pdata->block_end;
-   old = pdata->old;
    ncol = pdata->ncol;
-   pasign = pdata->pasign;
-   paoff = pdata->paoff;
    angrot = pdata->angrot;
-   angfac = pdata->angfac;
    fpr0 = pdata->fpr0;
    fprinc = pdata->fprinc;
 
@@ -823,59 +850,20 @@ static void smf1_calc_iqu_job( void *job_data, int *status ) {
 /* Loop round all time slices. */
                pm = pdata->mean;
                if( pm )  pm += block_start;
-               state = allstates + block_start;
+               pt = pdata->trig;
                itime_start = block_start;
-               for( itime = block_start; itime <= block_end; itime++,state++ ) {
+               for( itime = block_start; itime <= block_end; itime++,pt += 3 ) {
 
-/* Get the POL_ANG value for this time slice. */
-                  angle = state->pol_ang;
+/* Get the effective analyser angle for this time slice, as found by
+   smf_calc_iqu from POL_ANG (scaled by "angfac" to allow the
+   investigation of other harmonics). */
+                  angle = pt[ 0 ];
 
 /* Check the input sample has not been flagged during cleaning and is
    not bad. */
                   if( !( *qin & SMF__Q_FIT ) && *din != VAL__BADD &&
                       angle != VAL__BADD && ( !pm || *pm != VAL__BADD ) ) {
 
-/* If POL_ANG is stored in arbitrary encoder units, convert to radians. */
-                     if( old ) angle = angle*TORADS;
-
-/* Following SUN/223 (section "Single-beam polarimetry"/"The Polarimeter"),
-   get the angle from the fixed analyser to the half-waveplate axis, in radians.
-   Positive rotation is from focal plane axis 1 (x) to focal plane axis 2 (y).
-
-   Not sure about the sign of tcs_az/tr_ang at the moment so do not use them
-   yet. */
-                     wplate = 0.0;
-                     if( ipolcrd == 0 ) {
-                        wplate = pasign*angle + paoff;
-
-                     } else if( *status == SAI__OK ) {
-                        *status = SAI__ERROR;
-                        errRepf( "", "smf_calc_iqu: currently only POL_CRD = "
-                                 "FPLANE is supported.", status );
-                     }
-
-/*
-                  if( ipolcrd == 1 ) {
-                     wplate += state->tcs_az_ang;
-                  } else if( ipolcrd == 2 ) {
-                     wplate += state->tcs_tr_ang;
-                  }
-*/
-
-/* Get the angle from the fixed analyser to the effective analyser
-   position (see SUN/223 again). The effective analyser angle rotates twice
-   as fast as the half-wave plate which is why there is a factor of 2 here. */
-                     phi = 2*wplate;
-
-/* Increment the sums needed to find the Fourier component of the time
-   series corresponding to the frequency introduced by the rotation of
-   the half wave plate. */
-                     angle = 2*phi;
-
-/* Allow the angle to be scaled by some user-specified factor. This is to
-   allow the investigation of other harmonics. */
-                     angle *= angfac;
-
 /* If we have now done the required amount of rotation, calculate new Q and
    U values. */
                      if( rot >= rot_target ) {
@@ -933,8 +921,8 @@ static void smf1_calc_iqu_job( void *job_data, int *status ) {
 /* Increment the sums to include the current time slice. */
                      v = pm ? *din - *pm : *din;
 
-                     ca = cos( angle );
-                     sa = sin( angle );
+                     ca = pt[ 1 ];
+                     sa = pt[ 2 ];
                      s1 += v*ca;
                      s2 += v*sa;
                      s3 += v;
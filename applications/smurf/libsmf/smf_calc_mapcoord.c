@@ -26,7 +26,11 @@
 *        Pointer to a KeyMap holding configuration parameters. May
 *        be NULL, in which case hard-wired defaults are used for any
 *        configuration parameters that are needed (currently just
-*        TSTEP=1 and EXPORTLONLAT=0).
+*        TSTEP=1, TSTEP_TOL=0 and EXPORTLONLAT=0). If TSTEP_TOL is
+*        positive, the bolometer positions between full pointing
+*        calculations are interpolated, with an error of no more than
+*        TSTEP_TOL arc-seconds, and TSTEP gives the maximum number of
+*        time slices between full calculations (see smf_coords_lut).
 *     data = smfData* (Given)
 *        Pointer to smfData struct
 *     outfset = AstFrameSet* (Given)
@@ -53,6 +57,12 @@
 *     exits with clean status the smfData will have the LUT mapped and
 *     the NDF ID of the table stored in the associated smfFile.
 *
+*     If no MAPCOORD extension is used, and the SMURF_LUTCACHE environment
+*     variable names a directory, the LUT is read from a file in that
+*     directory if the same LUT has been calculated before, and any newly
+*     calculated LUT is stored there for later runs (see
+*     smf_lutcache_name). The cache is not used if EXPORTLONLAT is set.
+*
 *
 *  Authors:
 *     EC: Edward Chapin (UBC)
@@ -106,6 +116,9 @@
 *        AST symbols for the skyframe axes.
 *     2018-08-02 (DSB):
 *        Add "onmap" flag to smfData.
+*     14-OCT-2026:
+*        Re-use LUTs stored in the directory given by SMURF_LUTCACHE.
+*        Added the TSTEP_TOL configuration parameter.
 
 *  Notes:
 *     This routines asserts ICD data order.
@@ -177,6 +190,7 @@ typedef struct smfCalcMapcoordData {
   int *ubnd_out;
   double *theta;
   int tstep;
+  double steptol;
   double *lat_ptr;
   double *lon_ptr;
   fts2Port fts_port;
@@ -253,7 +267,7 @@ void smfCalcMapcoordPar( void *job_data_ptr, int *status ) {
      being processed by this thread. A generic algorithm is used for
      moving targets, but a faster algorithm can be used for stationary
      targets. */
-  smf_coords_lut( data, pdata->tstep, pdata->t1, pdata->t2,
+  smf_coords_lut( data, pdata->tstep, pdata->steptol, pdata->t1, pdata->t2,
                   abskyfrm, sky2map, moving, lbnd_out, ubnd_out, fts_port,
                   lut + pdata->t1*nbolo, theta + pdata->t1,
                   pdata->lon_ptr, pdata->lat_ptr, &onmap, status );
@@ -287,6 +301,8 @@ void smf_calc_mapcoord( ThrWorkForce *wf, AstKeyMap *config, smfData *data,
   AstSkyFrame *abskyfrm = NULL;/* Output SkyFrame (always absolute) */
   AstMapping *bolo2map=NULL;   /* Combined mapping bolo->map coordinates */
   int bndndf=NDF__NOID;        /* NDF identifier for map bounds */
+  char cachefile[ SMF_PATH_MAX + 1 ]; /* Name of LUT cache file */
+  int cached_onmap = 0;        /* Overlap flag read from LUT cache */
   void *data_pntr[1];          /* Array of pointers to mapped arrays in ndf */
   int *data_index;             /* Mapped DATA_ARRAY part of NDF */
   int docalc=1;                /* If set calculate the LUT */
@@ -294,6 +310,7 @@ void smf_calc_mapcoord( ThrWorkForce *wf, AstKeyMap *config, smfData *data,
   smfFile *file=NULL;          /* smfFile pointer */
   AstObject *fstemp = NULL;    /* AstObject version of outfset */
   int ii;                      /* loop counter */
+  int incache = 0;             /* Was the LUT read from the LUT cache? */
   int indf_lat = NDF__NOID;    /* Identifier for NDF to receive lat values */
   int indf_lon = NDF__NOID;    /* Identifier for NDF to receive lon values */
   smfCalcMapcoordData *job_data=NULL; /* Array of job */
@@ -324,8 +341,10 @@ void smf_calc_mapcoord( ThrWorkForce *wf, AstKeyMap *config, smfData *data,
   AstMapping *testsimpmap=NULL;/* Simplified testcmpmap */
   int there;                   /* Does component exist? */
   double *theta = NULL;        /* Scan direction at each time slice */
+  int usecache = 0;            /* Store the LUT in the LUT cache? */
   HDSLoc *tloc=NULL;           /* Temporary HDS locator */
   int tstep;                   /* Time slices between full Mapping calculations */
+  double steptol = 0.0;        /* Tolerance for interpolated positions */
   int exportlonlat;            /* Dump longitude and latitude values? */
 
   /* Main routine */
@@ -497,6 +516,10 @@ void smf_calc_mapcoord( ThrWorkForce *wf, AstKeyMap *config, smfData *data,
        dim_t dimval;
        smf_get_nsamp( config, "TSTEP", data, &dimval, status );
        tstep = dimval;
+
+       /* Get the tolerance in arc-seconds for interpolating bolometer
+          positions between full Mapping calculations. */
+       if( !astMapGet0D( config, "TSTEP_TOL", &steptol ) ) steptol = 0.0;
     }
 
     /* Get space for the LUT */
@@ -535,6 +558,18 @@ void smf_calc_mapcoord( ThrWorkForce *wf, AstKeyMap *config, smfData *data,
        }
     }
 
+    /* If the LUT is not being stored in a MAPCOORD extension, and the
+       longitude and latitude values are not needed, try to read it from
+       the LUT cache, if one is in use. */
+    if( !doextension && !lon_ptr && !lat_ptr ) {
+      usecache = smf_lutcache_name( data, outfset, moving, lbnd_out,
+                                    ubnd_out, tstep, steptol, fts_port,
+                                    cachefile, sizeof( cachefile ), status );
+      if( usecache ) incache = smf_read_lutcache( cachefile, nbolo, ntslice,
+                                                  lut, theta, &cached_onmap,
+                                                  status );
+    }
+
     /* Invert the mapping to get Output SKY to output map coordinates */
     astInvert( sky2map );
 
@@ -546,101 +581,113 @@ void smf_calc_mapcoord( ThrWorkForce *wf, AstKeyMap *config, smfData *data,
 
     if( *status == SAI__OK ) {
 
-      /* --- Begin parellelized portion ------------------------------------ */
+      /* If the LUT was found in the cache, just set the overlap flag.
+         Otherwise, calculate the LUT. */
+      if( incache ) {
+        data->onmap = cached_onmap;
 
-      /* Initially assume the smfData does not overlap the map. */
-      onmap = 0;
+      } else {
+        /* --- Begin parellelized portion ------------------------------------ */
 
-      /* Start a new job context. Each call to thrWait within this
-         context will wait until all jobs created within the context have
-         completed. Jobs created in higher contexts are ignored by thrWait. */
-      thrBeginJobContext( wf, status );
+        /* Initially assume the smfData does not overlap the map. */
+        onmap = 0;
 
-      /* Allocate job data for threads */
-      job_data = astCalloc( nw, sizeof(*job_data) );
-      if( *status == SAI__OK ) {
+        /* Start a new job context. Each call to thrWait within this
+           context will wait until all jobs created within the context have
+           completed. Jobs created in higher contexts are ignored by thrWait. */
+        thrBeginJobContext( wf, status );
 
-        /* Set up job data, and start calculating pointing for blocks of
-           time slices in different threads */
+        /* Allocate job data for threads */
+        job_data = astCalloc( nw, sizeof(*job_data) );
+        if( *status == SAI__OK ) {
 
-        if( nw > (int) ntslice ) {
-          step = 1;
-        } else {
-          step = ntslice/nw;
-        }
+          /* Set up job data, and start calculating pointing for blocks of
+             time slices in different threads */
+
+          if( nw > (int) ntslice ) {
+            step = 1;
+          } else {
+            step = ntslice/nw;
+          }
 
-        for( ii=0; (*status==SAI__OK)&&(ii<nw); ii++ ) {
-          pdata = job_data + ii;
+          for( ii=0; (*status==SAI__OK)&&(ii<nw); ii++ ) {
+            pdata = job_data + ii;
 
-          /* Blocks of time slices */
-          pdata->t1 = ii*step;
-          pdata->t2 = (ii+1)*step-1;
+            /* Blocks of time slices */
+            pdata->t1 = ii*step;
+            pdata->t2 = (ii+1)*step-1;
 
-          /* Ensure that the last thread picks up any left-over tslices */
-          if( (ii==(nw-1)) && (pdata->t1<(ntslice-1)) ) {
-            pdata->t2=ntslice-1;
+            /* Ensure that the last thread picks up any left-over tslices */
+            if( (ii==(nw-1)) && (pdata->t1<(ntslice-1)) ) {
+              pdata->t2=ntslice-1;
+            }
+
+            pdata->ijob = -1;
+            pdata->lut = lut;
+            pdata->theta = theta;
+            pdata->lbnd_out = lbnd_out;
+            pdata->moving = moving;
+            pdata->ubnd_out = ubnd_out;
+            pdata->tstep = tstep;
+          pdata->steptol = steptol;
+            pdata->lat_ptr = lat_ptr;
+            pdata->lon_ptr = lon_ptr;
+            pdata->fts_port = fts_port;
+
+            /* Make deep copies of AST objects and unlock them so that each
+               thread can then lock them for their own exclusive use */
+
+            pdata->abskyfrm = astCopy( abskyfrm );
+            astUnlock( pdata->abskyfrm, 1 );
+            pdata->sky2map = astCopy( sky2map );
+            astUnlock( pdata->sky2map, 1 );
+
+            /* Similarly, make a copy of the smfData, including only the header
+               information which each thread will need in order to make calls to
+               smf_rebin_totmap */
+
+            pdata->data = smf_deepcopy_smfData( wf, data, 0, SMF__NOCREATE_FILE |
+                                                SMF__NOCREATE_DA |
+                                                SMF__NOCREATE_FTS |
+                                                SMF__NOCREATE_DATA |
+                                                SMF__NOCREATE_VARIANCE |
+                                                SMF__NOCREATE_QUALITY, 0, 0,
+                                                status );
+            smf_lock_data( pdata->data, 0, status );
           }
 
-          pdata->ijob = -1;
-          pdata->lut = lut;
-          pdata->theta = theta;
-          pdata->lbnd_out = lbnd_out;
-          pdata->moving = moving;
-          pdata->ubnd_out = ubnd_out;
-          pdata->tstep = tstep;
-          pdata->lat_ptr = lat_ptr;
-          pdata->lon_ptr = lon_ptr;
-          pdata->fts_port = fts_port;
-
-          /* Make deep copies of AST objects and unlock them so that each
-             thread can then lock them for their own exclusive use */
-
-          pdata->abskyfrm = astCopy( abskyfrm );
-          astUnlock( pdata->abskyfrm, 1 );
-          pdata->sky2map = astCopy( sky2map );
-          astUnlock( pdata->sky2map, 1 );
-
-          /* Similarly, make a copy of the smfData, including only the header
-             information which each thread will need in order to make calls to
-             smf_rebin_totmap */
-
-          pdata->data = smf_deepcopy_smfData( wf, data, 0, SMF__NOCREATE_FILE |
-                                              SMF__NOCREATE_DA |
-                                              SMF__NOCREATE_FTS |
-                                              SMF__NOCREATE_DATA |
-                                              SMF__NOCREATE_VARIANCE |
-                                              SMF__NOCREATE_QUALITY, 0, 0,
-                                              status );
-          smf_lock_data( pdata->data, 0, status );
-        }
+          for( ii=0; ii<nw; ii++ ) {
+            /* Submit the job */
+            pdata = job_data + ii;
+            pdata->ijob = thrAddJob( wf, THR__REPORT_JOB, pdata,
+                                       smfCalcMapcoordPar, 0, NULL, status );
+          }
 
-        for( ii=0; ii<nw; ii++ ) {
-          /* Submit the job */
-          pdata = job_data + ii;
-          pdata->ijob = thrAddJob( wf, THR__REPORT_JOB, pdata,
-                                     smfCalcMapcoordPar, 0, NULL, status );
-        }
+          /* Wait until all of the jobs submitted within the current job
+             context have completed */
+          thrWait( wf, status );
 
-        /* Wait until all of the jobs submitted within the current job
-           context have completed */
-        thrWait( wf, status );
+          /* Find the total number of samples that fall within the map. */
+          for( ii=0; ii<nw; ii++ ) {
+            pdata = job_data + ii;
+            onmap += pdata->onmap;
+          }
+
+          /* Set a flag that causes the smfData to be ignored if fewer than
+             5% of the samples fall within the map. */
+          data->onmap = ( onmap > 0.05*ndata );
 
-        /* Find the total number of samples that fall within the map. */
-        for( ii=0; ii<nw; ii++ ) {
-          pdata = job_data + ii;
-          onmap += pdata->onmap;
         }
 
-        /* Set a flag that causes the smfData to be ignored if fewer than
-           5% of the samples fall within the map. */
-        data->onmap = ( onmap > 0.05*ndata );
+        /* End the current job context. */
+        thrEndJobContext( wf, status );
 
-      }
+        /* --- End parellelized portion -------------------------------------- */
 
-      /* End the current job context. */
-      thrEndJobContext( wf, status );
-
-      /* --- End parellelized portion -------------------------------------- */
+        /* Store the new LUT in the cache. */
+        if( usecache ) smf_write_lutcache( cachefile, nbolo, ntslice, lut,
+                                           theta, data->onmap, status );
+      }
 
       /* Set the lut pointer in data to the buffer */
       data->lut = lut;
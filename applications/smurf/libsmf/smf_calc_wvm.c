@@ -48,6 +48,11 @@
 *       will free the cache. The cache should be cleared between calls to the
 *       monolith. Each thread has its own cache, stored in thread-specific
 *       data .
+*     - If the SMURF_WVMTABLE environment variable is set to a non-zero
+*       value, the PWV is interpolated from a table of wvmOpt fits held
+*       in the same cache (see smf_wvm_lookup). wvmOpt is only called
+*       directly for readings outside the table, or where the
+*       interpolation is not accurate enough.
 
 *  Authors:
 *     Andy Gibb (UBC)
@@ -95,6 +100,8 @@
 *        you can explicitly disable it.
 *     2013-09-24 (DSB):
 *        Changed so that each thread has its own cache.
+*     2026-10-14:
+*        Optionally interpolate the PWV from a table of wvmOpt fits.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -102,6 +109,7 @@
 *     Copyright (C) 2006 Particle Physics and Astronomy Research
 *     Council.  Copyright (C) 2006-2008 University of British
 *     Columbia.  All Rights Reserved.
+*     Copyright (C) 2026 East Asian Observatory.
 
 *  Licence:
 *     This program is free software; you can redistribute it and/or
@@ -125,6 +133,7 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* Starlink includes */
@@ -272,11 +281,26 @@ double smf_calc_wvm( const smfHead *hdr, double approxam, AstKeyMap * extpars,
 
       } else {
 
-        /* Get the pwv for this airmass */
-        wvmOpt( (float)airmass, (float)tamb, wvm, &pwv, &tau0, &twater, &rms);
+        /* If requested, interpolate the zenith pwv from the table of fits,
+           falling back to a direct fit if the reading is outside the
+           table or the interpolation is not accurate enough. */
+        const char *envval = getenv( SMF__WVMTABLE );
+        double tabpwv = VAL__BADD;
+        if( envval && atoi( envval ) != 0 ) {
+          tabpwv = smf_wvm_lookup( cache, airmass, tamb, wvm, NULL, status );
+        }
 
-        /* Convert to zenith pwv */
-        pwv /= airmass;
+        if( tabpwv != VAL__BADD ) {
+          pwv = tabpwv;
+
+        } else {
+
+          /* Get the pwv for this airmass */
+          wvmOpt( (float)airmass, (float)tamb, wvm, &pwv, &tau0, &twater, &rms);
+
+          /* Convert to zenith pwv */
+          pwv /= airmass;
+        }
 
         /* convert zenith pwv to zenith tau */
         tau225 = pwv2tau_bydate( wvmtime, pwv );
@@ -166,10 +166,13 @@
 *        of iterations or map change.
 *     2018-04-10 (DSB):
 *        Added parameter "chunkfactor".
+*     2026-10-14:
+*        Apply the AST mask and chunk factor to the map once per pixel
+*        rather than once per sample.
 *     {enter_further_changes_here}
 
 *  Copyright:
-*     Copyright (C) 2018 East Asian Observatory.
+*     Copyright (C) 2018, 2026 East Asian Observatory.
 *     Copyright (C) 2006-2011 University of British Columbia.
 *     Copyright (C) 2010-2014 Science and Technology Facilities Council.
 *     All Rights Reserved.
@@ -209,6 +212,8 @@
 
 /* Prototypes for local static functions. */
 static void smf1_calcmodel_ast( void *job_data_ptr, int *status );
+static void smf1_calcmodel_ast_range( void *job_data_ptr, size_t b1,
+                                      size_t b2, int *status );
 
 /* Local data types */
 typedef struct smfCalcModelAstData {
@@ -217,12 +222,10 @@ typedef struct smfCalcModelAstData {
    dim_t ntslice;
    double *map;
    double *res_data;
-   double chunkfactor;
    int *lut_data;
    int oper;
    size_t bstride;
    size_t tstride;
-   smf_qual_t *mapqual;
    smf_qual_t *qua_data;
 } SmfCalcModelAstData;
 
@@ -239,8 +242,7 @@ void smf_calcmodel_ast( ThrWorkForce *wf, smfDIMMData *dat, int chunk,
   int *hitsmap;                 /* Pointer to hitsmap data */
   dim_t i;                      /* Loop counter */
   dim_t idx=0;                  /* Index within subgroup */
-  int iw;                       /* Thread index */
-  SmfCalcModelAstData *job_data = NULL; /* Data describing worker jobs */
+  SmfCalcModelAstData job_data; /* Data describing worker jobs */
   AstKeyMap *kmap=NULL;         /* Local keymap */
   smfArray *lut=NULL;           /* Pointer to LUT at chunk */
   int *lut_data=NULL;           /* Pointer to DATA component of lut */
@@ -251,7 +253,6 @@ void smf_calcmodel_ast( ThrWorkForce *wf, smfDIMMData *dat, int chunk,
   dim_t ndata;                  /* Number of data points */
   smfArray *noi=NULL;           /* Pointer to NOI at chunk */
   dim_t ntslice=0;              /* Number of time slices */
-  int nw;                       /* Number of worker threads */
   SmfCalcModelAstData *pdata = NULL; /* Data describing worker jobs */
   smfArray *qua=NULL;           /* Pointer to QUA at chunk */
   smf_qual_t *qua_data=NULL; /* Pointer to quality data */
@@ -262,6 +263,7 @@ void smf_calcmodel_ast( ThrWorkForce *wf, smfDIMMData *dat, int chunk,
   smf_qual_t *mapqual = NULL;/* Quality map */
   double *mapvar = NULL;        /* Variance map */
   double *mapweight = NULL;     /* Weight map */
+  double *skymap = NULL;        /* Map values to subtract from residuals */
   unsigned char *zmask = NULL;  /* Pointer to map mask */
 
   /* Main routine */
@@ -283,12 +285,6 @@ void smf_calcmodel_ast( ThrWorkForce *wf, smfDIMMData *dat, int chunk,
     noi = dat->noi[chunk];
   }
 
-  /* How many threads do we get to play with */
-  nw = wf ? wf->nworker : 1;
-
-  /* Allocate job data for threads. */
-  job_data = astCalloc( nw, sizeof(*job_data) );
-
   /* See how many iterations are to be skipped by the AST model. */
   astMapGet0I( kmap, "SKIP", &skip );
   if( skip < 0 ) skip = -skip;
@@ -403,6 +399,23 @@ void smf_calcmodel_ast( ThrWorkForce *wf, smfDIMMData *dat, int chunk,
     smf_model_dataOrder( wf, dat, NULL, chunk,SMF__LUT|SMF__RES|SMF__QUA,
                          lut->sdata[0]->isTordered, status );
 
+    /* Form the values to be subtracted from the residuals once for each
+       map pixel, rather than for each sample: bad where the map is
+       constrained to zero by the mask, and otherwise the map value
+       divided by the chunk factor. This leaves a single look-up per
+       sample in the loop below, which dominates the cost of this
+       model. */
+    skymap = astMalloc( dat->msize*sizeof( *skymap ) );
+    if( *status == SAI__OK ) {
+      for( i=0; i<dat->msize; i++ ) {
+        if( ( mapqual[i] & SMF__MAPQ_AST ) || map[i] == VAL__BADD ) {
+          skymap[i] = VAL__BADD;
+        } else {
+          skymap[i] = map[i]/chunkfactor;
+        }
+      }
+    }
+
     /* Loop over index in subgrp (subarray) */
     for( idx=0; idx<res->ndat; idx++ ) {
 
@@ -420,42 +433,28 @@ void smf_calcmodel_ast( ThrWorkForce *wf, smfDIMMData *dat, int chunk,
         smf_get_dims( res->sdata[idx],  NULL, NULL, &nbolo, &ntslice,
                       &ndata, &bstride, &tstride, status);
 
-        /* Find how many bolometers to process in each worker thread. */
-        dim_t bolostep = nbolo/nw;
-        if( bolostep == 0 ) bolostep = 1;
-
-        /* Create jobs to subtract the map values from the corresponding
-           bolometer values. */
-        for( iw = 0; iw < nw; iw++ ) {
-          pdata = job_data + iw;
-          pdata->b1 = iw*bolostep;
-          if( iw < nw - 1 ) {
-             pdata->b2 = pdata->b1 + bolostep - 1;
-          } else {
-             pdata->b2 = nbolo - 1 ;
-          }
-
-          pdata->ntslice = ntslice;
-          pdata->qua_data = qua_data;
-          pdata->res_data = res_data;
-          pdata->lut_data = lut_data;
-          pdata->bstride = bstride;
-          pdata->tstride = tstride;
-          pdata->map = map;
-          pdata->mapqual = mapqual;
-          pdata->chunkfactor = chunkfactor;
-          pdata->oper = 1;
-
-          thrAddJob( wf, 0, pdata, smf1_calcmodel_ast, 0, NULL, status );
-        }
-
-        /* Wait for all jobs to complete. */
-        thrWait( wf, status );
+        /* Subtract the map values from the corresponding bolometer
+           values. Bad bolometers are skipped quickly, so let the
+           workers claim blocks of bolometers dynamically rather than
+           giving each an equal share. */
+        pdata = &job_data;
+        pdata->ntslice = ntslice;
+        pdata->qua_data = qua_data;
+        pdata->res_data = res_data;
+        pdata->lut_data = lut_data;
+        pdata->bstride = bstride;
+        pdata->tstride = tstride;
+        pdata->map = skymap;
+        pdata->oper = 1;
+
+        if( nbolo > 0 ) thrParallelFor( wf, 0, nbolo - 1, 0, pdata,
+                                        smf1_calcmodel_ast_range, status );
       }
     }
+
+    skymap = astFree( skymap );
   }
 
-  job_data = astFree( job_data );
   if( kmap ) kmap = astAnnul( kmap );
 }
 
@@ -490,7 +489,6 @@ static void smf1_calcmodel_ast( void *job_data_ptr, int *status ) {
    dim_t itime;
    dim_t ngood;
    double *pr;
-   double cf;
    double m;
    int *pl;
    size_t ibase;
@@ -505,7 +503,6 @@ static void smf1_calcmodel_ast( void *job_data_ptr, int *status ) {
 
 /* Remove map values from the corresponding bolometer values. */
    if( pdata->oper == 1 ) {
-      cf = pdata->chunkfactor;
 
 /* Loop round all bolos to be processed by this thread, maintaining the
    index of the first time slice for the current bolo. */
@@ -529,19 +526,15 @@ static void smf1_calcmodel_ast( void *job_data_ptr, int *status ) {
                if( *pl != VAL__BADI ) {
 
 /* Update the residual model provided that we have a good map value which
-   is not constrained to zero by the mask. ***NOTE: unlike other model
-   components we do *not* first add the previous realization back in. This
-   is because we've already done this in smf_iteratemap before calling
-   smf_rebinmap1. */
-                  if( pdata->mapqual[ *pl ] & SMF__MAPQ_AST ) {
-                     m = VAL__BADD;
-                  } else {
-                     m = pdata->map[ *pl ];
-                  }
-
+   is not constrained to zero by the mask (the supplied map is bad where
+   it is masked, and has already been divided by the chunk factor).
+   ***NOTE: unlike other model components we do *not* first add the
+   previous realization back in. This is because we've already done this
+   in smf_iteratemap before calling smf_rebinmap1. */
                   if( !( *pq & SMF__Q_MOD ) ) {
                      ngood++;
-                     if( m != VAL__BADD ) *pr -= m/cf;
+                     m = pdata->map[ *pl ];
+                     if( m != VAL__BADD ) *pr -= m;
                   }
                }
 
@@ -574,3 +567,44 @@ static void smf1_calcmodel_ast( void *job_data_ptr, int *status ) {
    }
 }
 
+static void smf1_calcmodel_ast_range( void *job_data_ptr, size_t b1,
+                                      size_t b2, int *status ) {
+/*
+*  Name:
+*     smf1_calcmodel_ast_range
+
+*  Purpose:
+*     Called by thrParallelFor to process a range of bolometers for
+*     smf_calcmodel_ast.
+
+*  Invocation:
+*     smf1_calcmodel_ast_range( void *job_data_ptr, size_t b1, size_t b2,
+*                               int *status )
+
+*  Arguments:
+*     job_data_ptr = SmfCalcModelAstData * (Given)
+*        Data structure describing the operation to be performed. It is
+*        shared by all threads and is not modified.
+*     b1 = size_t (Given)
+*        Index of the first bolometer to process.
+*     b2 = size_t (Given)
+*        Index of the last bolometer to process.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+/* Local Variables: */
+   SmfCalcModelAstData data;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Take a private copy of the shared job description, store the
+   bolometer range in it, and process it. */
+   data = *( (SmfCalcModelAstData *) job_data_ptr );
+   data.b1 = b1;
+   data.b2 = b2;
+   smf1_calcmodel_ast( &data, status );
+}
+
@@ -103,6 +103,9 @@
 *     1-MAR-2017 (DSB):
 *        Fix bug in usage of freeze_flags parameter that caused flags 
 *        always to be frozen on iteration 1 (if freeze_flags was set).
+*     14-OCT-2026:
+*        When forming a new COM estimate, process the time slices in
+*        cache-friendly blocks.
 
 *  Copyright:
 *     Copyright (C) 2016 East Asian Observatory.
@@ -144,6 +147,14 @@ static void smf1_calcmodel_com( void *job_data_ptr, int *status );
 
 #define FILLVAL -1.23456E20
 
+/* The number of time slices in each block processed together when
+   forming a new COM estimate, and the codes used to describe each
+   bolometer sample within a block. */
+#define TBLOCK 16
+#define BLK_BAD 0
+#define BLK_FILL 1
+#define BLK_GOOD 2
+
 /* Local data types */
 typedef struct smfCalcModelComData {
    dim_t b1;
@@ -1002,10 +1013,24 @@ static void smf1_calcmodel_com( void *job_data_ptr, int *status ) {
 /* Form new estimate of the COM model.
    ================================== */
    } else if( pdata->operation == 3 ) {
+      dim_t ibuf;
+      dim_t jt;
+      dim_t nbuf;
+      dim_t nt;
+      dim_t off;
+      dim_t t0;
+      double *blkres;
+      double *blkwgt = NULL;
+      double *noi_data;
+      double *pbr;
+      double *pbw;
+      double nval;
       double sigma;
       double thr_hi;
       double thr_lo;
       int iter;
+      unsigned char *blkcode;
+      unsigned char *pbc;
 
 /* Allocate work space needed for filling holes in each time slices. */
       if( pdata->fill ) fillwork = astMalloc( 2*pdata->ncol*pdata->nrow*sizeof(*fillwork ) );
@@ -1022,128 +1047,147 @@ static void smf1_calcmodel_com( void *job_data_ptr, int *status ) {
       }
       pm += pdata->t1;
 
+/* The residuals are bolo-ordered, so the values for a single time slice
+   are spread through memory with a step of "ntslice" elements. To avoid
+   reading a separate cache line for every bolometer at every time slice,
+   the time slices are processed in blocks of TBLOCK. At the start of each
+   block, the required values for all time slices in the block are copied
+   into buffers in which all the bolometer values for a given time slice
+   are contiguous. Each bolometer value is stored with a code indicating
+   if it is usable (BLK_GOOD), should be replaced by interpolation
+   (BLK_FILL), or is entirely bad (BLK_BAD). */
+      nbuf = pdata->nbolo*( pdata->idx_hi - pdata->idx_lo + 1 );
+      blkres = astMalloc( TBLOCK*nbuf*sizeof( *blkres ) );
+      blkcode = astMalloc( TBLOCK*nbuf*sizeof( *blkcode ) );
+      if( pdata->noi ) blkwgt = astMalloc( TBLOCK*nbuf*sizeof( *blkwgt ) );
+
 /* Buffer to hold all bolometer residuals at a single time slice. */
-      resbuf = astMalloc( pdata->nbolo*( pdata->idx_hi - pdata->idx_lo + 1 )*
-                          sizeof( *resbuf ) );
+      resbuf = astMalloc( nbuf*sizeof( *resbuf ) );
 
 /* Buffer to hold all bolometer weights at a single time slice. */
-      if( pdata->noi ) {
-         wgtbuf = astMalloc( pdata->nbolo*( pdata->idx_hi - pdata->idx_lo + 1 )*
-                             sizeof( *wgtbuf ) );
-      }
+      if( pdata->noi ) wgtbuf = astMalloc( nbuf*sizeof( *wgtbuf ) );
+
+/* Loop over the blocks of time slices to be processed by this thread. */
+      for( t0 = pdata->t1; t0 <= pdata->t2 && *status == SAI__OK;
+           t0 += TBLOCK ) {
+         nt = pdata->t2 - t0 + 1;
+         if( nt > TBLOCK ) nt = TBLOCK;
+
+/* Copy the values for all time slices in the block into the block
+   buffers, looping over all subarrays that contribute to the current
+   common-mode model. */
+         ibuf = 0;
+         for( idx = pdata->idx_lo; idx <= pdata->idx_hi; idx++ ) {
+            res_data = pdata->res->sdata[ idx ]->pntr[ 0 ];
+            qua_data = smf_select_qualpntr( pdata->res->sdata[ idx ], NULL,
+                                            status );
+            noi_data = pdata->noi ? pdata->noi->sdata[ idx ]->pntr[ 0 ] : NULL;
+            lut_data = pdata->lut ? pdata->lut->sdata[ idx ]->pntr[ 0 ] : NULL;
+
+/* Loop over all bolometers, getting pointers to the first time slice in
+   the block. */
+            for( ibolo = 0; ibolo < pdata->nbolo; ibolo++,ibuf++ ) {
+               pr = res_data + ibolo*pdata->ntslice + t0;
+               pq = qua_data + ibolo*pdata->ntslice + t0;
+               pl = lut_data ? lut_data + ibolo*pdata->ntslice + t0 : NULL;
+               pn = noi_data ? noi_data + ibolo*pdata->nointslice : NULL;
+
+/* Loop over the time slices in the block. */
+               for( jt = 0; jt < nt; jt++ ) {
+                  off = jt*nbuf + ibuf;
+                  nval = pn ? pn[ ( t0 + jt ) % pdata->nointslice ] : 0.0;
+
+/* Check the sample has not been flagged as unusable. If a mask and LUT
+   have been supplied, also check that the sample is not masked out. */
+                  if( !(pq[ jt ] & qmask) && pr[ jt ] != VAL__BADD &&
+                      ( !pn || ( nval != VAL__BADD && nval > 0.0 ) ) ) {
+                     if( !pdata->mask || !pl || pl[ jt ] == VAL__BADI ||
+                          pdata->mask[ pl[ jt ] ] ) {
+                        blkcode[ off ] = BLK_GOOD;
+                        blkres[ off ] = pr[ jt ];
+                        if( blkwgt ) blkwgt[ off ] = 1.0/( nval*nval );
+                     } else {
+                        blkcode[ off ] = BLK_FILL;
+                     }
 
-/* Loop over the time slices to be processed by this thread. */
-      for( itime = pdata->t1; itime <= pdata->t2 && *status == SAI__OK;
-           itime++,pm++ ) {
+                  } else if( !(pq[ jt ] & SMF__Q_BADB) ) {
+                     blkcode[ off ] = BLK_FILL;
+                  } else {
+                     blkcode[ off ] = BLK_BAD;
+                  }
+               }
+            }
+         }
+
+/* Now loop over the time slices in the block. */
+         for( jt = 0; jt < nt && *status == SAI__OK; jt++,pm++ ) {
+            pbr = blkres + jt*nbuf;
+            pbc = blkcode + jt*nbuf;
+            pbw = blkwgt ? blkwgt + jt*nbuf : NULL;
 
 /* Initialise the thresholds to include all bolometer values. */
-         thr_lo = VAL__MIND;
-         thr_hi = VAL__MAXD;
+            thr_lo = VAL__MIND;
+            thr_hi = VAL__MAXD;
 
 /* Do any required sigma-clipping iterations. */
-         for( iter = 0; iter < pdata->niter; iter++ ) {
+            for( iter = 0; iter < pdata->niter; iter++ ) {
 
 /* Initialise pointers to the buffers holding the normalised residual,
    and the weights. */
-            pb = resbuf;
-            pw = wgtbuf;
-
-/* Loop over all subarrays that contribute to the current common-mode
-   model. */
-            for( idx = pdata->idx_lo; idx <= pdata->idx_hi; idx++ ) {
-
-/* Get required data pointers. These are known to be bolo-ordered.
-   Increment them to point to the first time slice processed by this thread. */
-               pr = pdata->res->sdata[ idx ]->pntr[ 0 ];
-               pr += itime;
-               pn = ( pdata->noi ) ? pdata->noi->sdata[ idx ]->pntr[ 0 ] : NULL;
-               if( pn ) pn += (itime % pdata->nointslice);
-               pq = itime + smf_select_qualpntr( pdata->res->sdata[ idx ], NULL, status );
-               if( pdata->lut ) {
-                  pl = pdata->lut->sdata[ idx ]->pntr[ 0 ];
-                  pl += itime;
-               } else {
-                  pl = NULL;
-               }
+               pb = resbuf;
+               pw = wgtbuf;
 
-/* Loop over all bolometers. */
-               for( ibolo = 0; ibolo < pdata->nbolo; ibolo++ ) {
-
-/* Check the sample has not been flagged as unusable. */
-                  if( !(*pq & qmask) && *pr != VAL__BADD &&
-                      ( !pn || ( *pn != VAL__BADD && *pn > 0.0 ) ) ) {
-
-/* If a mask and LUT have been supplied, check that the sample is not
-   masked out. */
-                     if( !pdata->mask || !pl || *pl == VAL__BADI ||
-                          pdata->mask[ *pl ] ) {
-
-/* Check that the bolometer value is within the current clipping limits.
-   If so, store it in the sample buffer. */
-                        if( *pr >= thr_lo && *pr <= thr_hi ) {
-                           *(pb++) = *pr;
+/* Loop over all subarrays and bolometers. */
+               ibuf = 0;
+               for( idx = pdata->idx_lo; idx <= pdata->idx_hi; idx++ ) {
+                  for( ibolo = 0; ibolo < pdata->nbolo; ibolo++,ibuf++ ) {
 
-/* Also store the weight if required. */
-                           if( wgtbuf ) *(pw++) = 1.0/( (*pn)*(*pn) );
+/* Check that usable bolometer values are within the current clipping
+   limits. If so, store them in the sample buffer. Also store the weight
+   if required. */
+                     if( pbc[ ibuf ] == BLK_GOOD && pbr[ ibuf ] >= thr_lo &&
+                         pbr[ ibuf ] <= thr_hi ) {
+                        *(pb++) = pbr[ ibuf ];
+                        if( wgtbuf ) *(pw++) = pbw[ ibuf ];
 
 /* If required store a magic value in the buffer that indicates that the
    bolometer value needs to be replaced by interpolation from the
    surrounding spatial neighbours. Entirely bad bolometers are excluded
    from this process. */
-                        } else if( pdata->fill ) {
-                           *(pb++) = FILLVAL;
-                           if( wgtbuf ) *(pw++) = FILLVAL;
-                        }
-
                      } else if( pdata->fill ) {
-                        *(pb++) = FILLVAL;
-                        if( wgtbuf ) *(pw++) = FILLVAL;
-                     }
-
-                  } else if( pdata->fill ){
-                     if( !(*pq & SMF__Q_BADB) ) {
-                        *(pb++) = FILLVAL;
-                        if( wgtbuf ) *(pw++) = FILLVAL;
-                     } else {
-                        *(pb++) = VAL__BADD;
-                        if( wgtbuf ) *(pw++) = VAL__BADD;
+                        v = ( pbc[ ibuf ] == BLK_BAD ) ? VAL__BADD : FILLVAL;
+                        *(pb++) = v;
+                        if( wgtbuf ) *(pw++) = v;
                      }
                   }
 
-/* Increment residual and quality pointers to point to the next
-   bolometer. */
-                  pr += pdata->ntslice;
-                  if( pn ) pn += pdata->nointslice;
-                  if( pl ) pl += pdata->ntslice;
-                  pq += pdata->ntslice;
-               }
-
 /* If required, replace bad values in the buffer by interpolation from their
    spatial neighbours. This avoids bias in the COM value due to the
    spatial distribution of flagged bolometer values. */
-               if( pdata->fill ) {
-                  smf_fill2d( 50, 5, FILLVAL, pdata->ncol, pdata->nrow,
-                              resbuf + ( idx - pdata->idx_lo )*pdata->nbolo,
-                              fillwork, status );
-                  if( wgtbuf ) {
+                  if( pdata->fill ) {
                      smf_fill2d( 50, 5, FILLVAL, pdata->ncol, pdata->nrow,
-                                 wgtbuf + ( idx - pdata->idx_lo )*pdata->nbolo,
+                                 resbuf + ( idx - pdata->idx_lo )*pdata->nbolo,
                                  fillwork, status );
+                     if( wgtbuf ) {
+                        smf_fill2d( 50, 5, FILLVAL, pdata->ncol, pdata->nrow,
+                                    wgtbuf + ( idx - pdata->idx_lo )*pdata->nbolo,
+                                    fillwork, status );
+                     }
                   }
                }
-            }
 
 /* Find the mean and sigma of the samples now in the buffer. */
-            if( pb > resbuf ) {
-               *pm = smf_sigmaclipD( (int)( pb - resbuf ), resbuf, wgtbuf, 0.0,
-                                     1, &sigma, status );
+               if( pb > resbuf ) {
+                  *pm = smf_sigmaclipD( (int)( pb - resbuf ), resbuf, wgtbuf,
+                                        0.0, 1, &sigma, status );
 
 /* Update the thresholds for the next iteration. */
-               thr_lo = *pm - pdata->nsigma*sigma;
-               thr_hi = *pm + pdata->nsigma*sigma;
-            } else {
-                *pm = VAL__BADD;
-                break;
+                  thr_lo = *pm - pdata->nsigma*sigma;
+                  thr_hi = *pm + pdata->nsigma*sigma;
+               } else {
+                   *pm = VAL__BADD;
+                   break;
+               }
             }
          }
       }
@@ -1151,6 +1195,9 @@ static void smf1_calcmodel_com( void *job_data_ptr, int *status ) {
 /* Free resources. */
       resbuf = astFree( resbuf );
       wgtbuf = astFree( wgtbuf );
+      blkres = astFree( blkres );
+      blkwgt = astFree( blkwgt );
+      blkcode = astFree( blkcode );
       fillwork = astFree( fillwork );
 
 /* Combined individual common-mode signals into a single COM model.
@@ -55,10 +55,14 @@
 *     2010-06-14 (EC)
 *        -Switch to smf_tophat1 from smf_boxcar1
 *        -don't need to remove mean since we now have cleandk.order
+*     2026-10-14:
+*        Smooth the dark squids, restore the previous iteration and find
+*        the change in the model for each column in parallel.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2008-2009 University of British Columbia.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -95,31 +99,53 @@
 
 #define FUNC_NAME "smf_calcmodel_dks"
 
-void smf_calcmodel_dks( ThrWorkForce *wf __attribute__((unused)),
+/* Prototypes for local static functions. */
+static void smf1_calcmodel_dks( void *job_data_ptr, int *status );
+
+/* Local data types */
+typedef struct smfCalcModelDksData {
+   dim_t c1;                  /* Index of first column to process */
+   dim_t c2;                  /* Index of last column to process */
+   dim_t boxcar;              /* Size of boxcar smooth window */
+   double dchisq;             /* Returned change in model chi^2 */
+   int firstiter;             /* Is this the first iteration? */
+   size_t jf1;                /* Starting tslice that should be fit */
+   size_t jf2;                /* Final tslice that should be fit */
+   size_t jt1;                /* Starting tslice that should be smoothed */
+   double *model_data;        /* Pointer to DATA component of model */
+   double *model_data_copy;   /* Copy of model_data */
+   dim_t ncol;                /* Number of columns */
+   size_t ndchisq;            /* Returned number of values in dchisq */
+   double *noi_data;          /* Pointer to DATA component of noise */
+   size_t noibstride;         /* bolo stride for noise */
+   dim_t nointslice;          /* number of time slices for noise */
+   size_t noitstride;         /* Time stride for noise */
+   dim_t nrow;                /* Number of rows */
+   size_t ntot;               /* total good excluding padding */
+   dim_t ntslice;             /* Number of time slices */
+   int oper;                  /* Operation to perform */
+   smf_qual_t *qua_data;      /* Pointer to quality data */
+   double *res_data;          /* Pointer to DATA component of res */
+   size_t bstride;            /* bolo stride */
+   size_t tstride;            /* time stride */
+} SmfCalcModelDksData;
+
+void smf_calcmodel_dks( ThrWorkForce *wf,
                         smfDIMMData *dat, int chunk,
                         AstKeyMap *keymap, smfArray **allmodel, int flags,
                         int *status) {
 
   /* Local Variables */
-  size_t bolcounter;            /* bolometer counter */
   dim_t boxcar=0;               /* Size of boxcar smooth window */
   size_t bstride;               /* bolo stride */
-  double *cdksquid=NULL;        /* Pointer to current dark squid (copy) */
-  double *corrbuf=NULL;         /* Array of corr coeffs all bolos in this col */
-  double *cgainbuf=NULL;        /* Array gains for bolos in this col (copy) */
-  double *coffsetbuf=NULL;      /* Array offsets for bolos in this col (copy) */
   double dchisq=0;              /* this - last model residual chi^2 */
-  double *dksquid=NULL;         /* Pointer to current dark squid */
-  double *gainbuf=NULL;         /* Array of gains for all bolos in this col */
-  dim_t i;                      /* Loop counter */
   dim_t idx=0;                  /* Index within subgroup */
-  dim_t index;                  /* index into data buffer */
-  dim_t j;                      /* Loop counter */
+  int iw;                       /* Thread index */
+  SmfCalcModelDksData *job_data=NULL; /* Array of job descriptions */
   size_t jt1;
   size_t jt2;
   size_t jf1;                   /* Starting tslice that should be fit */
   size_t jf2;                   /* Final tslice that should be fit */
-  dim_t k;                      /* Loop counter */
   AstKeyMap *kmap=NULL;         /* Local keymap */
   smfArray *model=NULL;         /* Pointer to model at chunk */
   double *model_data=NULL;      /* Pointer to DATA component of model */
@@ -128,7 +154,6 @@ void smf_calcmodel_dks( ThrWorkForce *wf __attribute__((unused)),
   dim_t ncol;                   /* Number of columns */
   dim_t ndata=0;                /* Total number of data points */
   size_t ndchisq=0;             /* number of elements contributing to dchisq */
-  size_t nfit;                  /* number of samples over good range to fit */
   dim_t nmodel=0;               /* Total number of elements in model buffer */
   smfArray *noi=NULL;           /* Pointer to NOI at chunk */
   double *noi_data=NULL;        /* Pointer to DATA component of model */
@@ -138,11 +163,13 @@ void smf_calcmodel_dks( ThrWorkForce *wf __attribute__((unused)),
   dim_t nrow;                   /* Number of rows */
   size_t ntot;                  /* total good excluding padding */
   dim_t ntslice=0;              /* Number of time slices */
-  double *offsetbuf=NULL;       /* Array of offsets for all bolos in this col */
+  int nw;                       /* Number of worker threads */
+  SmfCalcModelDksData *pdata;   /* Pointer to next job description */
   smfArray *qua=NULL;           /* Pointer to QUA at chunk */
   smf_qual_t *qua_data=NULL; /* Pointer to quality data */
   smfArray *res=NULL;           /* Pointer to RES at chunk */
   double *res_data=NULL;        /* Pointer to DATA component of res */
+  size_t step;                  /* Number of columns per thread */
   size_t tstride;               /* time stride */
 
   /* Main routine */
@@ -172,6 +199,10 @@ void smf_calcmodel_dks( ThrWorkForce *wf __attribute__((unused)),
   /* Check for dark squid smoothing parameter in the CONFIG file */
   if( kmap ) smf_get_nsamp( kmap, "BOXCAR", res->sdata[0], &boxcar, status );
 
+  /* Allocate job data for threads. */
+  nw = wf ? wf->nworker : 1;
+  job_data = astMalloc( nw*sizeof(*job_data) );
+
   /* Loop over index in subgrp (subarray) */
   for( idx=0; (*status==SAI__OK)&&(idx<res->ndat); idx++ ) {
 
@@ -196,7 +227,6 @@ void smf_calcmodel_dks( ThrWorkForce *wf __attribute__((unused)),
       jf1 = 0;
       jf2 = ntslice-1;
     }
-    nfit = jf2-jf1+1;
 
     /* Total total range only using SMF__Q_PAD */
     if( qua ) {
@@ -219,51 +249,40 @@ void smf_calcmodel_dks( ThrWorkForce *wf __attribute__((unused)),
                   status );
       }
 
-      /* Loop over column */
-      for( i=0; (*status==SAI__OK)&&(i<ncol); i++ ) {
-
-        /* get pointer to the dark squid and gain/offset buffers this column */
-        dksquid = model_data;
-        dksquid += i*(ntslice+nrow*3);
-        gainbuf = dksquid + ntslice;
-        offsetbuf = gainbuf + nrow;
-        corrbuf = offsetbuf + nrow;
-
-        /* For the first iteration we need to do some pre-processing */
-        if( (flags&SMF__DIMM_FIRSTITER) ) {
-          /* boxcar smooth */
-          smf_tophat1D( &dksquid[jt1], ntot, (int) boxcar, NULL, 0, 0.0,
-                        status );
-        }
-
-        /* Loop over rows */
-        for( j=0; (*status==SAI__OK)&&(j<nrow); j++ ) {
-
-          /* Index in data array to start of the bolometer */
-          if( SC2STORE__COL_INDEX ) {
-            index = i*nrow + j;
-          } else {
-            index = i + j*ncol;
-          }
-          index *= ntslice;
-
-          /* Continue if the bolo is OK */
-          if( !(qua_data[index]&SMF__Q_BADB) ) {
-
-            /* If this isn't first iteration, put the previous iteration
-               back into the signal */
-
-            if( !(flags&SMF__DIMM_FIRSTITER) && (gainbuf[j]!=VAL__BADD) &&
-                (offsetbuf[j]!=VAL__BADD) ) {
-              for( k=jf1; k<=jf2; k++ ) {
-                if( (res_data[index+k]!=VAL__BADD) && (dksquid[k]!=VAL__BADD)) {
-                  res_data[index+k] += dksquid[k]*gainbuf[j] + offsetbuf[j];
-                }
-              }
-            }
-          }
+      /* The columns are independent, so share them out between the
+         worker threads. Each thread smooths the dark squids on the
+         first iteration, and puts the signal removed on the previous
+         iteration back into the residuals. */
+      step = ncol/nw;
+      if( step == 0 ) step = 1;
+
+      for( iw = 0; iw < nw; iw++ ) {
+        pdata = job_data + iw;
+        pdata->c1 = iw*step;
+        pdata->c2 = ( iw < nw - 1 ) ? pdata->c1 + step - 1 : ncol - 1;
+
+        pdata->boxcar = boxcar;
+        pdata->bstride = bstride;
+        pdata->firstiter = ( flags&SMF__DIMM_FIRSTITER ) ? 1 : 0;
+        pdata->jf1 = jf1;
+        pdata->jf2 = jf2;
+        pdata->jt1 = jt1;
+        pdata->model_data = model_data;
+        pdata->model_data_copy = model_data_copy;
+        pdata->ncol = ncol;
+        pdata->nrow = nrow;
+        pdata->ntot = ntot;
+        pdata->ntslice = ntslice;
+        pdata->qua_data = qua_data;
+        pdata->res_data = res_data;
+        pdata->tstride = tstride;
+        pdata->oper = 1;
+
+        if( pdata->c1 < ncol ) {
+          thrAddJob( wf, 0, pdata, smf1_calcmodel_dks, 0, NULL, status );
         }
       }
+      thrWait( wf, status );
 
       /* Make a copy of the model to check convergence */
       if( noi ) {
@@ -272,7 +291,7 @@ void smf_calcmodel_dks( ThrWorkForce *wf __attribute__((unused)),
 
       /* Then re-fit and remove the dark squid signal */
       msgOutif( MSG__VERB, "", "   cleaning detectors", status );
-      smf_clean_dksquid( res->sdata[idx], SMF__Q_MOD, 0,
+      smf_clean_dksquid( wf, res->sdata[idx], SMF__Q_MOD, 0,
                          model->sdata[idx], 0, 0, 0, status );
 
       /* How has the model changed? */
@@ -282,64 +301,190 @@ void smf_calcmodel_dks( ThrWorkForce *wf __attribute__((unused)),
                       NULL, &noibstride, &noitstride, status);
         noi_data = (double *)(noi->sdata[idx]->pntr)[0];
 
-        /* Loop over column */
-        bolcounter = 0;
-        for( i=0; (*status==SAI__OK)&&(i<ncol); i++ ) {
+        /* Each thread finds the change for a range of columns. */
+        for( iw = 0; iw < nw; iw++ ) {
+          pdata = job_data + iw;
+          pdata->noi_data = noi_data;
+          pdata->noibstride = noibstride;
+          pdata->nointslice = nointslice;
+          pdata->noitstride = noitstride;
+          pdata->oper = 2;
+
+          if( pdata->c1 < ncol ) {
+            thrAddJob( wf, 0, pdata, smf1_calcmodel_dks, 0, NULL, status );
+          }
+        }
+        thrWait( wf, status );
+
+        for( iw = 0; iw < nw; iw++ ) {
+          pdata = job_data + iw;
+          if( pdata->c1 < ncol ) {
+            dchisq += pdata->dchisq;
+            ndchisq += pdata->ndchisq;
+          }
+        }
+      }
+    }
+  }
+
+  /* Print normalized residual chisq for this model */
+  if( (*status==SAI__OK) && noi && (ndchisq>0) ) {
+    dchisq /= (double) ndchisq;
+    msgOutiff( MSG__VERB, "", "    normalized change in model: %lf", status,
+               dchisq );
+  }
+
+  if( kmap ) kmap = astAnnul( kmap );
+  model_data_copy = astFree( model_data_copy );
+  job_data = astFree( job_data );
+}
 
-          /* get pointer to the dark squid and gain/offset buffers this col */
-          dksquid = model_data;
-          dksquid += i*(ntslice+nrow*3);
-          gainbuf = dksquid + ntslice;
-          offsetbuf = gainbuf + nrow;
 
-          cdksquid = model_data_copy;
-          cdksquid += i*(ntslice+nrow*3);
-          cgainbuf = cdksquid + ntslice;
-          coffsetbuf = cgainbuf + nrow;
 
-          /* Loop over rows */
-          for( j=0; (*status==SAI__OK)&&(j<nrow); j++ ) {
+static void smf1_calcmodel_dks( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_calcmodel_dks
 
-            /* Index in data array to start of the bolometer */
+*  Purpose:
+*     Executed in a worker thread to do various calculations for
+*     smf_calcmodel_dks.
+
+*  Invocation:
+*     smf1_calcmodel_dks( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = SmfCalcModelDksData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+/* Local Variables: */
+   SmfCalcModelDksData *pdata;
+   dim_t bolcounter;
+   double *cdksquid;
+   double *cgainbuf;
+   double *coffsetbuf;
+   double *dksquid;
+   double *gainbuf;
+   double *offsetbuf;
+   double delta;
+   dim_t i;
+   dim_t index;
+   dim_t j;
+   dim_t k;
+   dim_t nrow;
+   dim_t ntslice;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Get a pointer that can be used for accessing the required items in the
+   supplied structure. */
+   pdata = (SmfCalcModelDksData *) job_data_ptr;
+   nrow = pdata->nrow;
+   ntslice = pdata->ntslice;
+
+/* Smooth the dark squids and put the previous iteration back into the
+   residuals. */
+   if( pdata->oper == 1 ) {
+      for( i = pdata->c1; ( *status == SAI__OK ) && ( i <= pdata->c2 ); i++ ) {
+
+/* Get pointer to the dark squid and gain/offset buffers this column */
+         dksquid = pdata->model_data + i*( ntslice + nrow*3 );
+         gainbuf = dksquid + ntslice;
+         offsetbuf = gainbuf + nrow;
+
+/* For the first iteration we need to do some pre-processing */
+         if( pdata->firstiter ) {
+            smf_tophat1D( &dksquid[ pdata->jt1 ], pdata->ntot,
+                          (int) pdata->boxcar, NULL, 0, 0.0, status );
+         }
+
+/* Loop over rows */
+         for( j = 0; ( *status == SAI__OK ) && ( j < nrow ); j++ ) {
+
+/* Index in data array to start of the bolometer */
             if( SC2STORE__COL_INDEX ) {
-              index = i*nrow + j;
+               index = i*nrow + j;
             } else {
-              index = i + j*ncol;
+               index = i + j*pdata->ncol;
             }
             index *= ntslice;
 
-            /* Continue if the bolo is OK */
-            if( !(qua_data[index]&SMF__Q_BADB) && (gainbuf[j]!=VAL__BADD) &&
-                (offsetbuf[j]!=VAL__BADD) ) {
+/* If the bolo is OK, and this isn't first iteration, put the previous
+   iteration back into the signal */
+            if( !( pdata->qua_data[ index ] & SMF__Q_BADB ) &&
+                !pdata->firstiter && ( gainbuf[ j ] != VAL__BADD ) &&
+                ( offsetbuf[ j ] != VAL__BADD ) ) {
+               for( k = pdata->jf1; k <= pdata->jf2; k++ ) {
+                  if( ( pdata->res_data[ index + k ] != VAL__BADD ) &&
+                      ( dksquid[ k ] != VAL__BADD ) ) {
+                     pdata->res_data[ index + k ] += dksquid[ k ]*gainbuf[ j ] +
+                                                     offsetbuf[ j ];
+                  }
+               }
+            }
+         }
+      }
+
+/* Find how much the model has changed. */
+   } else if( pdata->oper == 2 ) {
+      pdata->dchisq = 0.0;
+      pdata->ndchisq = 0;
+
+      bolcounter = pdata->c1*nrow;
+      for( i = pdata->c1; ( *status == SAI__OK ) && ( i <= pdata->c2 ); i++ ) {
+
+/* Get pointer to the dark squid and gain/offset buffers this col */
+         dksquid = pdata->model_data + i*( ntslice + nrow*3 );
+         gainbuf = dksquid + ntslice;
+         offsetbuf = gainbuf + nrow;
 
-              for( k=jf1; k<=jf2; k++ ) {
+         cdksquid = pdata->model_data_copy + i*( ntslice + nrow*3 );
+         cgainbuf = cdksquid + ntslice;
+         coffsetbuf = cgainbuf + nrow;
 
-                if( !(qua_data[bolcounter*bstride+k*tstride]&SMF__Q_GOOD) ) {
-                  dchisq += ( (dksquid[k]*gainbuf[j] + offsetbuf[j]) -
-                              (cdksquid[k]*cgainbuf[j] + coffsetbuf[j])) *
-                    ( (dksquid[k]*gainbuf[j] + offsetbuf[j]) -
-                      (cdksquid[k]*cgainbuf[j] + coffsetbuf[j]) ) /
-                    noi_data[bolcounter*noibstride + (k%nointslice)*noitstride];
+/* Loop over rows */
+         for( j = 0; ( *status == SAI__OK ) && ( j < nrow ); j++ ) {
 
-                  ndchisq++;
-                }
-              }
+/* Index in data array to start of the bolometer */
+            if( SC2STORE__COL_INDEX ) {
+               index = i*nrow + j;
+            } else {
+               index = i + j*pdata->ncol;
+            }
+            index *= ntslice;
+
+/* Continue if the bolo is OK */
+            if( !( pdata->qua_data[ index ] & SMF__Q_BADB ) &&
+                ( gainbuf[ j ] != VAL__BADD ) &&
+                ( offsetbuf[ j ] != VAL__BADD ) ) {
+
+               for( k = pdata->jf1; k <= pdata->jf2; k++ ) {
+                  if( !( pdata->qua_data[ bolcounter*pdata->bstride +
+                                          k*pdata->tstride ] & SMF__Q_GOOD ) ) {
+                     delta = ( dksquid[ k ]*gainbuf[ j ] + offsetbuf[ j ] ) -
+                             ( cdksquid[ k ]*cgainbuf[ j ] + coffsetbuf[ j ] );
+                     pdata->dchisq += delta*delta /
+                                      pdata->noi_data[ bolcounter*pdata->noibstride +
+                                                       ( k % pdata->nointslice )*
+                                                       pdata->noitstride ];
+                     pdata->ndchisq++;
+                  }
+               }
             }
 
             bolcounter++;
-          }
-        }
+         }
       }
-    }
-  }
 
-  /* Print normalized residual chisq for this model */
-  if( (*status==SAI__OK) && noi && (ndchisq>0) ) {
-    dchisq /= (double) ndchisq;
-    msgOutiff( MSG__VERB, "", "    normalized change in model: %lf", status,
-               dchisq );
-  }
-
-  if( kmap ) kmap = astAnnul( kmap );
-  model_data_copy = astFree( model_data_copy );
+   } else if( *status == SAI__OK ) {
+      *status = SAI__ERROR;
+      errRepf( "", "smf1_calcmodel_dks: Illegal operation %d requested.",
+               status, pdata->oper );
+   }
 }
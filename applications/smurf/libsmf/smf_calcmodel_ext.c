@@ -102,6 +102,7 @@ static void smf1_calcmodel_ext( void *job_data_ptr, int *status );
 /* Local data types */
 typedef struct smfCalcModelExtData {
    double *model_data;
+   float *fmodel_data;
    double *res_data;
    int flags;
    size_t d1;
@@ -183,7 +184,15 @@ void smf_calcmodel_ext( ThrWorkForce *wf,
           pdata->d2 = ndata - 1 ;
         }
 
-        pdata->model_data = model_data;
+        /* The model may be stored in single precision (see
+           smf_model_dtype). */
+        if( model->sdata[idx]->dtype == SMF__FLOAT ) {
+          pdata->model_data = NULL;
+          pdata->fmodel_data = (float *) model_data;
+        } else {
+          pdata->model_data = model_data;
+          pdata->fmodel_data = NULL;
+        }
         pdata->res_data = res_data;
         pdata->qua_data = qua_data;
         pdata->flags = flags;
@@ -230,6 +239,8 @@ static void smf1_calcmodel_ext( void *job_data_ptr, int *status ) {
    SmfCalcModelExtData *pdata;
    double *pm;
    double *pr;
+   double m;
+   float *pf;
    size_t idata;
    smf_qual_t *pq;
 
@@ -244,36 +255,51 @@ static void smf1_calcmodel_ext( void *job_data_ptr, int *status ) {
    by this thread. */
    pq = pdata->qua_data + pdata->d1;
    pr = pdata->res_data + pdata->d1;
-   pm = pdata->model_data + pdata->d1;
+   pm = pdata->model_data ? pdata->model_data + pdata->d1 : NULL;
+   pf = pdata->fmodel_data ? pdata->fmodel_data + pdata->d1 : NULL;
+
+/* Macro to get the next extinction factor as a double, from whichever
+   of the double or single precision model arrays is in use. */
+#define EXT_VALUE \
+   if( pf ) { \
+      m = ( *pf == VAL__BADR ) ? VAL__BADD : (double) *pf; \
+      pf++; \
+   } else { \
+      m = *(pm++); \
+   }
 
 /* Apply the extinction correction */
    if( !( pdata->flags & SMF__DIMM_INVERT ) ) {
 
 /* Loop over all data samples being processed by this thread. */
-      for( idata = pdata->d1; idata <= pdata->d2; idata++,pq++,pr++,pm++ ) {
+      for( idata = pdata->d1; idata <= pdata->d2; idata++,pq++,pr++ ) {
+         EXT_VALUE;
 
 /* If the sample is not flagged and the extinction is good, apply the
    extinction factor. Otherwise, ensure the sample is flagged. */
          if( !( *pq & SMF__Q_MOD ) ) {
-            if( *pm == VAL__BADD ) {
+            if( m == VAL__BADD ) {
                *pq |= SMF__Q_EXT;
             } else {
-               *pr *= *pm;
+               *pr *= m;
             }
 
-         } else if( *pm == VAL__BADD ) {
+         } else if( m == VAL__BADD ) {
             *pq |= SMF__Q_EXT;
          }
       }
 
 /* Undo the extinction correction */
    } else {
-      for( idata = pdata->d1; idata <= pdata->d2; idata++,pq++,pr++,pm++ ) {
-         if( !(*pq & SMF__Q_MOD) && *pm > 0 ) {
-            if( *pm != VAL__BADD ) *pr /= *pm;
+      for( idata = pdata->d1; idata <= pdata->d2; idata++,pq++,pr++ ) {
+         EXT_VALUE;
+         if( !(*pq & SMF__Q_MOD) && m > 0 ) {
+            if( m != VAL__BADD ) *pr /= m;
          }
       }
    }
 }
 
 
+
+#undef EXT_VALUE
@@ -145,6 +145,7 @@ typedef struct smfCalcModelFltData {
    double *model_data_copy;
    double *noi_data;
    double *res_data;
+   float *fmodel_data;
    double chisquared;
    double dchisq;
    double ring_nsigma;
@@ -185,6 +186,8 @@ void smf_calcmodel_flt( ThrWorkForce *wf, smfDIMMData *dat, int chunk,
   dim_t idx=0;                  /* Index within subgroup */
   int iw;                       /* Thread index */
   SmfCalcModelFltData *job_data = NULL; /* Data describing worker jobs */
+  float *fmodel_data=NULL;      /* Single precision model values */
+  double *fltwork=NULL;         /* Double precision work array for model */
   AstKeyMap *kmap=NULL;         /* Pointer to FLT-specific keys */
   smfArray *lut=NULL;           /* Pointer to LUT at chunk */
   int *lut_data = NULL;         /* Array holding themap index for each sample */
@@ -323,11 +326,17 @@ void smf_calcmodel_flt( ThrWorkForce *wf, smfDIMMData *dat, int chunk,
   smf_get_dims( res->sdata[0],  NULL, NULL, NULL, NULL,
                 &ndata, NULL, NULL, status);
 
+  model = allmodel[chunk];
+
+  /* The model may be stored in single precision (see smf_model_dtype).
+     In this case the previous model values are still available in the
+     model during the final subtraction, and so no copy is needed. */
   if(dat->noi) {
     noi = dat->noi[chunk];
-    model_data_copy = astCalloc( ndata, sizeof(*model_data_copy) );
+    if( model->sdata[0]->dtype != SMF__FLOAT ) {
+      model_data_copy = astCalloc( ndata, sizeof(*model_data_copy) );
+    }
   }
-  model = allmodel[chunk];
 
   /* How many threads do we get to play with */
   nw = wf ? wf->nworker : 1;
@@ -348,6 +357,18 @@ void smf_calcmodel_flt( ThrWorkForce *wf, smfDIMMData *dat, int chunk,
     model_data = (model->sdata[idx]->pntr)[0];
     if (lut) lut_data = (lut->sdata[idx]->pntr)[0];
 
+    /* If the model is stored in single precision, the new model is
+       formed and filtered in a double precision work array, and is
+       only converted to single precision when it is subtracted from the
+       residuals. */
+    if( model->sdata[idx]->dtype == SMF__FLOAT ) {
+      fmodel_data = (float *) model_data;
+      fltwork = astGrow( fltwork, ndata, sizeof(*fltwork) );
+      model_data = fltwork;
+    } else {
+      fmodel_data = NULL;
+    }
+
     if( noi ) {
       smf_get_dims( noi->sdata[idx],  NULL, NULL, NULL, &nointslice,
                     NULL, &noibstride, &noitstride, status);
@@ -379,6 +400,7 @@ void smf_calcmodel_flt( ThrWorkForce *wf, smfDIMMData *dat, int chunk,
         pdata->qua_data = qua_data;
         pdata->model_data = model_data;
         pdata->model_data_copy = model_data_copy;
+        pdata->fmodel_data = fmodel_data;
         pdata->res_data = res_data;
         pdata->noi_data = noi_data;
         pdata->lut_data = lut_data;
@@ -443,7 +465,7 @@ void smf_calcmodel_flt( ThrWorkForce *wf, smfDIMMData *dat, int chunk,
         if( *status == SAI__OK ) {
 
           /* Make a copy of the last model if calculating dchisq */
-          if( noi ) {
+          if( noi && !fmodel_data ) {
             memcpy( model_data_copy, model_data,
                     ndata*smf_dtype_size(res->sdata[idx], status ) );
           }
@@ -490,7 +512,20 @@ void smf_calcmodel_flt( ThrWorkForce *wf, smfDIMMData *dat, int chunk,
            we can then subtract it from the residual).
         */
         if( dofft ) {
+
+          /* Temporarily make the model smfData refer to the double
+             precision work array if necessary. */
+          if( fmodel_data ) {
+            model->sdata[idx]->pntr[0] = model_data;
+            model->sdata[idx]->dtype = SMF__DOUBLE;
+          }
+
           smf_filter_execute( wf, model->sdata[idx], filt, -1, whiten, status );
+
+          if( fmodel_data ) {
+            model->sdata[idx]->pntr[0] = fmodel_data;
+            model->sdata[idx]->dtype = SMF__FLOAT;
+          }
         }
 
         /* Now remove the filtered signals from the residual by subtracting
@@ -554,6 +589,7 @@ void smf_calcmodel_flt( ThrWorkForce *wf, smfDIMMData *dat, int chunk,
   job_data = astFree( job_data );
   if( kmap ) kmap = astAnnul( kmap );
   model_data_copy = astFree( model_data_copy );
+  fltwork = astFree( fltwork );
 }
 
 
@@ -588,6 +624,8 @@ static void smf1_calcmodel_flt( void *job_data_ptr, int *status ) {
    double *pm;
    double *pn;
    double *pr;
+   double mval;
+   float *pf;
    int *pl;
    size_t ibase;
    smf_qual_t *pq;
@@ -615,11 +653,12 @@ static void smf1_calcmodel_flt( void *job_data_ptr, int *status ) {
    and then loop round all time slices. */
             pr = pdata->res_data + ibase;
             pm = pdata->model_data + ibase;
+            pf = pdata->fmodel_data ? pdata->fmodel_data + ibase : NULL;
             for( itime = 0; itime < pdata->ntslice; itime++ ) {
 
 /*  Add the model value on to the residual. BADDA samples will have bad
     values so check for them. */
-               if( *pr != VAL__BADD ) *pr += *pm;
+               if( *pr != VAL__BADD ) *pr += pf ? (double) *pf : *pm;
 
 /* Clear any SMF__Q_RING flags. */
                if( pdata->clear_ring) *pq &= ~SMF__Q_RING;
@@ -628,6 +667,7 @@ static void smf1_calcmodel_flt( void *job_data_ptr, int *status ) {
                pr += pdata->tstride;
                pm += pdata->tstride;
                pq += pdata->tstride;
+               if( pf ) pf += pdata->tstride;
             }
          }
 
@@ -669,8 +709,25 @@ static void smf1_calcmodel_flt( void *job_data_ptr, int *status ) {
             pm = pdata->model_data + ibase;
             pmc = pdata->model_data_copy + ibase;
             pn = pdata->noi_data + ibolo*pdata->noibstride;
+            pf = pdata->fmodel_data ? pdata->fmodel_data + ibase : NULL;
 
             for( itime = 0; itime < pdata->ntslice; itime++ ) {
+
+/* If the model is stored in single precision, the previous model value
+   is still in the model array. Replace it with the new value, and
+   subtract the rounded value from the residual so that adding it back
+   on again later restores the residual exactly. */
+               if( pf ) {
+                  mval = ( *pf == VAL__BADR ) ? VAL__BADD : (double) *pf;
+                  if( *pm == VAL__BADD ) {
+                     *pf = VAL__BADR;
+                  } else {
+                     *pf = (float) *pm;
+                     *pm = (double) *pf;
+                  }
+                  pmc = &mval;
+               }
+
                if( *pr != VAL__BADD ) {
                   *pr -= *pm;
                   if( pdata->noi_data && !( *pq & SMF__Q_GOOD ) ) {
@@ -684,7 +741,22 @@ static void smf1_calcmodel_flt( void *job_data_ptr, int *status ) {
                pr += pdata->tstride;
                pq += pdata->tstride;
                pm += pdata->tstride;
-               pmc += pdata->tstride;
+               if( pf ) {
+                  pf += pdata->tstride;
+               } else {
+                  pmc += pdata->tstride;
+               }
+            }
+
+/* Also store the new model for bad bolometers, so that exported models
+   are the same whatever the storage precision. */
+         } else if( pdata->fmodel_data ) {
+            pm = pdata->model_data + ibase;
+            pf = pdata->fmodel_data + ibase;
+            for( itime = 0; itime < pdata->ntslice; itime++ ) {
+               *pf = ( *pm == VAL__BADD ) ? VAL__BADR : (float) *pm;
+               pm += pdata->tstride;
+               pf += pdata->tstride;
             }
          }
          ibase += pdata->bstride;
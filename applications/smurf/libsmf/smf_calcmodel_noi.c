@@ -429,7 +429,7 @@ void smf_calcmodel_noi( ThrWorkForce *wf, smfDIMMData *dat, int chunk,
             /* Measure the noise from power spectra */
             smf_bolonoise( wf, res->sdata[idx], -1.0, 0, 0.5, SMF__F_WHITELO,
                            SMF__F_WHITEHI, 0, zeropad ? SMF__MAXAPLEN : SMF__BADSZT,
-                           var, NULL, NULL, status );
+                           0, var, NULL, NULL, status );
 
             for( i=0; i<nbolo; i++ ) if( !(qua_data[i*bstride]&SMF__Q_BADB) ) {
                 /* Loop over time and store the variance for each sample */
@@ -541,8 +541,8 @@ void smf_calcmodel_noi( ThrWorkForce *wf, smfDIMMData *dat, int chunk,
 
                  /* Measure the noise from power spectra in the box. */
                  smf_bolonoise( wf, box, 0.1, 0, 0.5, SMF__F_WHITELO, SMF__F_WHITEHI,
-                                0, zeropad ? SMF__MAXAPLEN : SMF__BADSZT, var,
-                                NULL, NULL, status );
+                                0, zeropad ? SMF__MAXAPLEN : SMF__BADSZT, 0,
+                                var, NULL, NULL, status );
 
                  /* Loop over time and store the variance for each sample in
                     the NOI model. On the last box, pick up any left over time
@@ -45,7 +45,9 @@
 *     bolometer can vary with time through an observation. Therefore the
 *     time stream for each bolometer is split into several ection, and a
 *     separate model created for each section (the final model is the
-*     concatenation of these individual section models).
+*     concatenation of these individual section models). The model for
+*     each bolometer is subtracted from its residuals as soon as it has
+*     been found.
 *
 *     For each section of each bolometer, the residuals are binned into an
 *     (el,az) map in whch the X axis is elevation offset from the tracking
@@ -80,9 +82,18 @@
 *  History:
 *     16-DEC-2014 (DSB):
 *        Original version.
+*     2026-10-14:
+*        Subtract the SSN model from the residuals of each bolometer as
+*        soon as it has been found, rather than in a separate pass
+*        through all the data.
+*     2026-10-14:
+*        Find the azimuth and elevation offsets of each time slice once,
+*        in contiguous arrays, rather than reading them from the JCMTState
+*        of every time slice for every bolometer.
 
 *  Copyright:
 *     Copyright (C) 2014 Science and Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -130,6 +141,8 @@ static void smf1_calcmodel_ssn( void *job_data_ptr, int *status );
 
 /* Local data types */
 typedef struct smfCalcModelSSNData {
+   const double *daz;
+   const double *del;
    dim_t b1;
    dim_t b2;
    dim_t nbolo;
@@ -155,7 +168,6 @@ typedef struct smfCalcModelSSNData {
    size_t tstride;
    size_t vbstride;
    size_t vtstride;
-   smfHead *hdr;
    smf_qual_t *qua_data;
    unsigned char *mask;
    dim_t nzero;
@@ -219,6 +231,8 @@ void smf_calcmodel_ssn( ThrWorkForce *wf, smfDIMMData *dat, int chunk,
    smfArray *res;
    smf_qual_t *qua_data;
    unsigned char *mask;
+   double *daz_data = NULL;
+   double *del_data = NULL;
 
 /* Check inherited status. */
    if( *status != SAI__OK ) return;
@@ -458,9 +472,34 @@ feenableexcept(FE_DIVBYZERO| FE_INVALID|FE_OVERFLOW);
                     "splitting.", status );
       }
 
+/* The worker threads need the azimuth and elevation offsets of every
+   time slice for every bolometer, so extract them into contiguous arrays
+   rather than reading them from the much larger JCMTState structures
+   each time. A bad value is stored if the offset is unknown. */
+      daz_data = astMalloc( ntslice*sizeof( *daz_data ) );
+      del_data = astMalloc( ntslice*sizeof( *del_data ) );
+
 /* Determine the SSN for each subarray in turn. */
       for( idx = 0; idx < res->ndat && *status == SAI__OK; idx++ ) {
 
+/* Get the offsets for the time slices in the current subarray. */
+         state = res->sdata[idx]->hdr->allState;
+         for( itime = 0; itime < ntslice; itime++,state++ ) {
+            if( state->tcs_az_ac1 != VAL__BADD &&
+                state->tcs_az_bc1 != VAL__BADD ) {
+               daz_data[ itime ] = state->tcs_az_ac1 - state->tcs_az_bc1;
+            } else {
+               daz_data[ itime ] = VAL__BADD;
+            }
+
+            if( state->tcs_az_ac2 != VAL__BADD &&
+                state->tcs_az_bc2 != VAL__BADD ) {
+               del_data[ itime ] = state->tcs_az_ac2 - state->tcs_az_bc2;
+            } else {
+               del_data[ itime ] = VAL__BADD;
+            }
+         }
+
 /* Get pointers to data/quality/model for the current subarray. */
          model_data = (model->sdata[idx]->pntr)[0];
          res_data = (res->sdata[idx]->pntr)[0];
@@ -468,7 +507,8 @@ feenableexcept(FE_DIVBYZERO| FE_INVALID|FE_OVERFLOW);
          qua_data = smf_select_qualpntr( res->sdata[idx], NULL, status );
          noi_data = noi ? (noi->sdata[idx]->pntr)[0] : NULL;
 
-/* Calculate the SSN model. Each thread handles a group of bolometers. */
+/* Calculate the SSN model and subtract it from the residuals. Each thread
+   handles a group of bolometers. */
          for( iw = 0; iw < nw; iw++ ) {
             pdata = job_data + iw;
             pdata->qua_data = qua_data;
@@ -476,7 +516,8 @@ feenableexcept(FE_DIVBYZERO| FE_INVALID|FE_OVERFLOW);
             pdata->res_data = res_data;
             pdata->noi_data = noi_data;
             pdata->lut_data = lut_data;
-            pdata->hdr = res->sdata[idx]->hdr;
+            pdata->daz = daz_data;
+            pdata->del = del_data;
             pdata->dazlo = dazlo;
             pdata->dazhi  = dazhi;
             pdata->dello = dello;
@@ -505,26 +546,10 @@ feenableexcept(FE_DIVBYZERO| FE_INVALID|FE_OVERFLOW);
                     100.0*(double)nzero/(double)(ntslice*nbolo), idx );
       }
 
-/* Subtract the SSN model from the residuals. */
-      for( idx = 0; idx < res->ndat && *status == SAI__OK; idx++ ) {
-         res_data = (res->sdata[idx]->pntr)[0];
-         model_data = (model->sdata[idx]->pntr)[0];
-         lut_data = (lut->sdata[idx]->pntr)[0];
-         qua_data = smf_select_qualpntr( res->sdata[idx], NULL, status );
-
-         for( iw = 0; iw < nw; iw++ ) {
-           pdata = job_data + iw;
-           pdata->qua_data = qua_data;
-           pdata->res_data = res_data;
-           pdata->model_data = model_data;
-           pdata->oper = 2;
-           thrAddJob( wf, 0, pdata, smf1_calcmodel_ssn, 0, NULL, status );
-         }
-         thrWait( wf, status );
-      }
-
 /* Free resources. */
       kernel = astFree( kernel );
+      daz_data = astFree( daz_data );
+      del_data = astFree( del_data );
    }
    job_data = astFree( job_data );
 
@@ -555,8 +580,9 @@ static void smf1_calcmodel_ssn( void *job_data_ptr, int *status ) {
 */
 
 /* Local Variables: */
-   JCMTState *state;
    SmfCalcModelSSNData *pdata;
+   const double *pdaz;
+   const double *pdel;
    dim_t b1;
    dim_t b2;
    dim_t ibolo;
@@ -635,7 +661,6 @@ static void smf1_calcmodel_ssn( void *job_data_ptr, int *status ) {
    size_t tstride;
    size_t vbstride;
    size_t vtstride;
-   smfHead *hdr;
    smf_qual_t *pq;
    unsigned char *mask;
 
@@ -660,7 +685,6 @@ feenableexcept(FE_DIVBYZERO| FE_INVALID|FE_OVERFLOW);
    b2 = pdata->b2;
    t1 = pdata->t1;
    t2 = pdata->t2;
-   hdr = pdata->hdr;
    binsize = pdata->binsize;
    dazlo = pdata->dazlo;
    dazhi = pdata->dazhi;
@@ -747,34 +771,9 @@ feenableexcept(FE_DIVBYZERO| FE_INVALID|FE_OVERFLOW);
          }
       }
 
-/* Subtract the SSN model from the residuals.
-   ======================================== */
-   } else if( pdata->oper == 2 ) {
-      ibase = b1*bstride;
-      for( ibolo = b1; ibolo <= b2 && *status == SAI__OK; ibolo++ ) {
-
-         if( !( (pdata->qua_data)[ ibase ] & SMF__Q_BADB ) ) {
-            pr = pdata->res_data + ibase;
-            pq = pdata->qua_data + ibase;
-            pm = pdata->model_data + ibase;
-
-            for( itime = 0; itime < ntslice; itime++ ) {
-               if( *pm == VAL__BADD ) {
-                  *pm = 0.0;
-                  *pq |= SMF__Q_SSN;
-               } else if( !(*pq & SMF__Q_MOD) && *pr != VAL__BADD ) {
-                  *pr -= *pm;
-               }
-               pr += tstride;
-               pq += tstride;
-               pm += tstride;
-            }
-         }
-         ibase += bstride;
-      }
-
-/* Form initial estimate of SSN in each bolo.
-   ========================================== */
+/* Form initial estimate of SSN in each bolo, and subtract it from the
+   residuals.
+   ==================================================================== */
    } else if( pdata->oper == 3 ) {
 
 /* Determine the number of time slices in each section, and the number of
@@ -841,16 +840,16 @@ feenableexcept(FE_DIVBYZERO| FE_INVALID|FE_OVERFLOW);
 
                ntotal = 0;
 
-               state = hdr->allState + itime_lo;
-               for( itime = itime_lo; itime <=itime_hi; itime++,state++ ) {
+               pdaz = pdata->daz + itime_lo;
+               pdel = pdata->del + itime_lo;
+               for( itime = itime_lo; itime <=itime_hi; itime++,pdaz++,pdel++ ) {
 
-                  if( state->tcs_az_ac1 != VAL__BADD &&
-                      state->tcs_az_ac2 != VAL__BADD &&
+                  if( *pdaz != VAL__BADD && *pdel != VAL__BADD &&
                       !(*pq & SMF__Q_FIT) && *pr != VAL__BADD &&
                       *pl != VAL__BADI && ( !mask || mask[ *pl ] ) ) {
 
-                     daz = state->tcs_az_ac1 - state->tcs_az_bc1;
-                     del = state->tcs_az_ac2 - state->tcs_az_bc2;
+                     daz = *pdaz;
+                     del = *pdel;
                      ibin_az = daz*c1 + c2;
                      ibin_el = del*c3 + c4;
                      if( ibin_az >= 0 && ibin_az < nbin_az &&
@@ -1180,8 +1179,10 @@ feenableexcept(FE_DIVBYZERO| FE_INVALID|FE_OVERFLOW);
 
             isection = 0;
             pm = pdata->model_data + ibase;
-            state = hdr->allState;
-            for( itime = 0; itime < ntslice; itime++,state++ ) {
+            pr = pdata->res_data + ibase;
+            pq = pdata->qua_data + ibase;
+            pdaz = pdata->daz;
+            for( itime = 0; itime < ntslice; itime++,pdaz++ ) {
 
 /* If it is time to move on to a new pair of neighbouring sections (for
    the purpose of interpolation between sections), update the increments
@@ -1215,12 +1216,10 @@ feenableexcept(FE_DIVBYZERO| FE_INVALID|FE_OVERFLOW);
 
                }
 
-/* Check the pointing info is good. */
-               if( state->tcs_az_ac1 != VAL__BADD &&
-                   state->tcs_az_bc1 != VAL__BADD ) {
-
-/* Get the azimuth offset for this time slice. */
-                  daz = state->tcs_az_ac1 - state->tcs_az_bc1;
+/* Check the pointing info is good, and get the azimuth offset for this
+   time slice. */
+               if( *pdaz != VAL__BADD ) {
+                  daz = *pdaz;
 
 /* Determine the interpolation factors for the required bins of the
   azimuth profile. */
@@ -1268,7 +1267,20 @@ feenableexcept(FE_DIVBYZERO| FE_INVALID|FE_OVERFLOW);
                      *pm = VAL__BADD;
                   }
                }
+
+/* Subtract the SSN value from the residual, while the residuals for the
+   current bolometer are still in cache. Bad SSN values are replaced by
+   zero and the sample is flagged. */
+               if( *pm == VAL__BADD ) {
+                  *pm = 0.0;
+                  *pq |= SMF__Q_SSN;
+               } else if( !(*pq & SMF__Q_MOD) && *pr != VAL__BADD ) {
+                  *pr -= *pm;
+               }
+
                pm += tstride;
+               pr += tstride;
+               pq += tstride;
             }
          }
          ibase += bstride;
@@ -53,6 +53,12 @@
 *     parameters to decide if any extra variable amounts of memory are
 *     needed (e.g. for data pre-processing). If the amount of memory
 *     (necessary) exceeds available, SMF__NOMEM status is set.
+*
+*     If the SMURF_SCRATCHDIR environment variable is set, the full-sized
+*     time-series arrays (RES, LUT, QUA and any dynamic model components
+*     holding one value per sample) are stored in memory-mapped scratch
+*     files (see smf_scratch_malloc), and so are excluded from the
+*     estimate. Temporary work space is still assumed to be in memory.
 
 *  Authors:
 *     Edward Chapin (UBC)
@@ -130,6 +136,7 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
 
 /* Starlink includes */
 #include "ast.h"
@@ -185,6 +192,8 @@ void smf_checkmem_dimm( dim_t maxlen, inst_t instrument, int nrelated,
   size_t ndks;                 /* dksquid samples in a subarray, ncol*maxlen */
   size_t nrow;                 /* Number of rows */
   size_t nsamp;                /* bolo samples in a subarray, ndet*maxlen */
+  size_t nsampmem;             /* nsamp, or zero if using scratch files */
+  const char *scratch=NULL;    /* Scratch file directory */
   const char *tempstr=NULL;    /* Temporary pointer to static char buffer */
   size_t total = 0;            /* Total bytes required */
 
@@ -242,6 +251,11 @@ void smf_checkmem_dimm( dim_t maxlen, inst_t instrument, int nrelated,
   /* Number of samples in a full data cube for one subarray */
   nsamp = ndet*maxlen;
 
+  /* Full-sized time-series arrays do not use memory if they are held in
+     memory-mapped scratch files. */
+  scratch = getenv( SMF__SCRATCHDIR );
+  nsampmem = ( scratch && scratch[0] ) ? 0 : nsamp;
+
   /* Check to see if we need to do filtering as part of
      pre-processing. If so, we need an extra nsamp-sized buffer to
      store the FFT. */
@@ -255,9 +269,9 @@ void smf_checkmem_dimm( dim_t maxlen, inst_t instrument, int nrelated,
   /* Calculate memory usage of static model components: -------------------- */
 
   if( *status == SAI__OK ) {
-    total += nsamp*smf_dtype_sz(SMF__DOUBLE,status)*nrelated;   /* RES */
-    total += nsamp*smf_dtype_sz(SMF__INTEGER,status)*nrelated;  /* LUT */
-    total += nsamp*smf_dtype_sz(SMF__QUALTYPE,status)*nrelated; /* QUA */
+    total += nsampmem*smf_dtype_sz(SMF__DOUBLE,status)*nrelated;   /* RES */
+    total += nsampmem*smf_dtype_sz(SMF__INTEGER,status)*nrelated;  /* LUT */
+    total += nsampmem*smf_dtype_sz(SMF__QUALTYPE,status)*nrelated; /* QUA */
   }
 
   /* Add on memory usage for the JCMTState (one per time slice per array) */
@@ -302,7 +316,7 @@ void smf_checkmem_dimm( dim_t maxlen, inst_t instrument, int nrelated,
              if( dval == 0 ) {
                 total += ndet*smf_dtype_sz(SMF__DOUBLE,status)*nrelated;
              } else {
-                total += nsamp*smf_dtype_sz(SMF__DOUBLE,status)*nrelated;
+                total += nsampmem*smf_dtype_sz(SMF__DOUBLE,status)*nrelated;
              }
              kmap = astAnnul( kmap );
           }
@@ -312,7 +326,8 @@ void smf_checkmem_dimm( dim_t maxlen, inst_t instrument, int nrelated,
 	  total += maxlen*smf_dtype_sz(SMF__DOUBLE,status);
 	  break;
 	case SMF__EXT:
-	  total += nsamp*smf_dtype_sz(SMF__DOUBLE,status)*nrelated;
+	  total += nsampmem*smf_dtype_sz(smf_model_dtype(SMF__EXT,status),
+                                         status)*nrelated;
 	  break;
         case SMF__DKS:
           total += (maxlen + nrow*3)*ncol*smf_dtype_sz(SMF__DOUBLE,status) *
@@ -344,19 +359,26 @@ void smf_checkmem_dimm( dim_t maxlen, inst_t instrument, int nrelated,
              twice. */
           CHECK_MASK("FLT")
           dofft = 1;
-          total += nsamp*smf_dtype_sz(SMF__DOUBLE,status)*nrelated;
+          total += nsampmem*smf_dtype_sz(smf_model_dtype(SMF__FLT,status),
+                                         status)*nrelated;
+
+          /* A single precision FLT model is filtered in a double
+             precision work array that holds one subarray. */
+          if( smf_model_dtype( SMF__FLT, status ) == SMF__FLOAT ) {
+            total += nsampmem*smf_dtype_sz(SMF__DOUBLE,status);
+          }
           break;
         case SMF__PLN:
-          total += nsamp*smf_dtype_sz(SMF__DOUBLE,status)*nrelated;
+          total += nsampmem*smf_dtype_sz(SMF__DOUBLE,status)*nrelated;
           break;
         case SMF__SMO:
-          total += nsamp*smf_dtype_sz(SMF__DOUBLE,status)*nrelated;
+          total += nsampmem*smf_dtype_sz(SMF__DOUBLE,status)*nrelated;
           break;
         case SMF__PCA:
-          total += nsamp*smf_dtype_sz(SMF__DOUBLE,status)*nrelated;
+          total += nsampmem*smf_dtype_sz(SMF__DOUBLE,status)*nrelated;
           break;
         case SMF__SSN:
-          total += nsamp*smf_dtype_sz(SMF__DOUBLE,status)*nrelated;
+          total += nsampmem*smf_dtype_sz(SMF__DOUBLE,status)*nrelated;
           break;
         case SMF__TMP:
           /* An externally supplied template. The model just stores the gain,
@@ -411,7 +433,7 @@ void smf_checkmem_dimm( dim_t maxlen, inst_t instrument, int nrelated,
                              smf_dtype_sz(SMF__DOUBLE,status) )*maxfilelen +
         2*maxfilelen*sizeof(JCMTState);
 
-      temp += nsamp*smf_dtype_sz(SMF__INTEGER,status)*nrelated;
+      temp += nsampmem*smf_dtype_sz(SMF__INTEGER,status)*nrelated;
 
       if( temp > maxtemp ) maxtemp = temp;
 
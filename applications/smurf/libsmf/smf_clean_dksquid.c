@@ -13,10 +13,13 @@
 *     Subroutine
 
 *  Invocation:
-*     smf_clean_dksquid( smfData *indata, smf_qual_t mask, size_t window, smfData *model,
-*                        int calcdk, int nofit, int replacebad, int *status ) {
+*     smf_clean_dksquid( ThrWorkForce *wf, smfData *indata, smf_qual_t mask,
+*                        size_t window, smfData *model, int calcdk, int nofit,
+*                        int replacebad, int *status ) {
 
 *  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        Pointer to a pool of worker threads (can be NULL)
 *     indata = smfData * (Given)
 *        Pointer to the input smfData. Should be raw, un-flatfielded.
 *     mask = smf_qual_t (Given)
@@ -89,10 +92,16 @@
 *        Don't remove the means here since that is handled by smf_clean_smfData
 *     2011-03-28 (DSB):
 *        Check for VAL__BADD when checking if dark squid ever changes.
+*     2026-10-14:
+*        Add "wf" argument and fit the columns in parallel. The sums of
+*        each dark squid are found once and shared by all the bolometers
+*        in its column.
+*     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2009-2011 Science & Technology Facilities Council.
 *     Copyright (C) 2008-2010 University of British Columbia.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -116,6 +125,10 @@
 *-
 */
 
+/* System includes */
+#include <math.h>
+#include <string.h>
+
 /* Starlink includes */
 #include "ast.h"
 #include "sae_par.h"
@@ -130,21 +143,50 @@
 
 #define FUNC_NAME "smf_clean_dksquid"
 
-void smf_clean_dksquid( smfData *indata, smf_qual_t mask, size_t window, smfData *model,
-                        int calcdk, int nofit, int replacebad, int *status ) {
+/* Local data types */
+typedef struct smfCleanDksquidData {
+  dim_t c1;               /* Index of first column to process */
+  dim_t c2;               /* Index of last column to process */
+  int *dkgood;            /* Flag for non-constant dark squid in each column */
+  double *dksquid;        /* Dark squid buffer if there is no model */
+  smfData *indata;        /* The data being cleaned */
+  size_t jf1;             /* Starting tslice that should be fit */
+  size_t jf2;             /* Final tslice that should be fit */
+  size_t jt1;             /* Starting tslice that should be smoothed */
+  smf_qual_t mask;        /* Quality bits to ignore */
+  double *model_data;     /* Dark squids and fit coeffs in model, or NULL */
+  size_t nbad;            /* Returned number of new bad bolos */
+  dim_t ncol;             /* Number of columns */
+  int nofit;              /* Don't fit/remove the dark squids? */
+  dim_t nrow;             /* Number of rows */
+  size_t ntot;            /* Number of tslices to smooth */
+  dim_t ntslice;          /* Number of time slices */
+  smf_qual_t *qua;        /* Pointer to quality array */
+  int smooth;             /* Smooth the dark squids in the model? */
+  size_t window;          /* Width of boxcar smooth */
+} smfCleanDksquidData;
+
+/* Prototypes for local static functions. */
+static void smf1_clean_dksquid( void *job_data_ptr, int *status );
+static int smf1_clean_dksquid_fit( double *data, smf_qual_t *qual,
+                                   smf_qual_t mask, size_t n, size_t stride,
+                                   const double *template, double s_t,
+                                   double s_tsq, double *gain, double *offset,
+                                   double *corr );
+
+void smf_clean_dksquid( ThrWorkForce *wf, smfData *indata, smf_qual_t mask,
+                        size_t window, smfData *model, int calcdk, int nofit,
+                        int replacebad, int *status ) {
 
-  dim_t b;                /* Bolometer index */
   size_t bstride;         /* Bolometer index stride */
-  double corr;            /* Linear correlation coefficient */
-  double *corrbuf=NULL;   /* Array of correlation coeffs all bolos this col */
   int needDA=0;           /* Do we need dksquids from the DA? */
   int *dkgood=NULL;       /* Flag for non-constant dark squid */
   double *dksquid=NULL;   /* Buffer for smoothed dark squid */
   double *dkav=NULL;      /* Buffer for average dark squid */
   double firstdk;         /* First value in dksquid signal */
-  double gain;            /* Gain parameter from template fit */
-  double *gainbuf=NULL;   /* Array of gains for all bolos in this col */
   size_t i;               /* Loop counter */
+  int iw;                 /* Thread index */
+  smfCleanDksquidData *job_data=NULL; /* Array of job descriptions */
   size_t jt1;
   size_t jt2;
   size_t jf1;             /* Starting tslice that should be fit */
@@ -155,15 +197,14 @@ void smf_clean_dksquid( smfData *indata, smf_qual_t mask, size_t window, smfData
   dim_t nbolo;            /* Number of bolometers */
   dim_t ncol;             /* Number of columns */
   dim_t ndata;            /* Number of data points */
-  size_t nfit;            /* number of samples over good range to fit */
   size_t ngood=0;         /* number of good dark squids */
   dim_t nrow;             /* Number of rows */
   size_t ntot;
   dim_t ntslice;          /* Number of time slices */
-  double offset;          /* Offset parameter from template fit */
-  double *offsetbuf=NULL; /* Array of offsets for all bolos in this col */
-  int pass;               /* two passes over data to get estimate of average */
+  int nw;                 /* Number of worker threads */
+  smfCleanDksquidData *pdata; /* Pointer to next job description */
   smf_qual_t *qua=NULL;/* Pointer to quality array */
+  size_t step;            /* Number of columns per thread */
   size_t tstride;         /* Time slice index stride */
 
   if (*status != SAI__OK) return;
@@ -211,8 +252,6 @@ void smf_clean_dksquid( smfData *indata, smf_qual_t mask, size_t window, smfData
     jf1 = 0;
     jf2 = ntslice-1;
   }
-  nfit = jf2-jf1+1;
-
   /* Total total range only using SMF__Q_PAD */
   if( qua ) {
     smf_get_goodrange( qua, ntslice, tstride, SMF__Q_BOUND, &jt1, &jt2,
@@ -255,191 +294,443 @@ void smf_clean_dksquid( smfData *indata, smf_qual_t mask, size_t window, smfData
   dkgood = astCalloc( ncol, sizeof(*dkgood) );
   dkav = astCalloc( ntslice, sizeof(*dkav) );
 
-  for( pass=0; (*status==SAI__OK)&&(pass<2); pass++ ) {
+  /* First pass is just to copy the dark squid over to the model and replace
+     dead dark squids with the average. This is a single cheap pass over
+     each dark squid, so it is done in this thread. */
+  for( i=0; (*status==SAI__OK)&&(i<ncol); i++ ) {
 
-    /* Loop over columns */
-    for( i=0; (*status==SAI__OK)&&(i<ncol); i++ ) {
+    /* Point dksquid to the right place in model if supplied. */
+    if( model ) {
+      dksquid = model->pntr[0];
+      dksquid += i*(ntslice+nrow*3);
+    }
 
-      /* Point dksquid, gainbuf, offsetbuf and corrbuf to the right
-         place in model if supplied. */
-      if( model ) {
-        dksquid = model->pntr[0];
-        dksquid += i*(ntslice+nrow*3);
-        gainbuf = dksquid + ntslice;
-        offsetbuf = gainbuf + nrow;
-        corrbuf = offsetbuf + nrow;
+    /* Copy dark squids from the DA extension into dksquid */
+    if( needDA && calcdk && model ) {
+      double *ptr = indata->da->dksquid->pntr[0];
+      for( j=0; j<ntslice; j++ ) {
+        dksquid[j] = ptr[i+ncol*j];
       }
+    }
 
-      /* First pass is just to copy the dark squid over to the model and replace
-         dead dark squids with the average */
-      if( pass==0 ) {
+    /* Check for a good dark squid by seeing if it ever changes */
+    firstdk = VAL__BADD;
+    for( j=jt1; j<=jt2; j++ ) {
+      if(  dksquid[j] != VAL__BADD ) {
+        if( firstdk == VAL__BADD ) {
+          firstdk = dksquid[j];
+        } else if( dksquid[j] != firstdk ) {
+          dkgood[i] = 1;
+          ngood++;
 
-        /* Copy dark squids from the DA extension into dksquid */
-        if( needDA && calcdk && model ) {
-          double *ptr = indata->da->dksquid->pntr[0];
-          for( j=0; j<ntslice; j++ ) {
-            dksquid[j] = ptr[i+ncol*j];
+          /* Add good squid to average dksquid */
+          for( k=jt1; k<=jt2; k++ ) {
+            dkav[k] += dksquid[k];
           }
+          break;
         }
+      }
+    }
+  }
 
-        /* Check for a good dark squid by seeing if it ever changes */
-        firstdk = VAL__BADD;
-        for( j=jt1; j<=jt2; j++ ) {
-          if(  dksquid[j] != VAL__BADD ) {
-            if( firstdk == VAL__BADD ) {
-              firstdk = dksquid[j];
-            } else if( dksquid[j] != firstdk ) {
-              dkgood[i] = 1;
-              ngood++;
-
-              /* Add good squid to average dksquid */
-              for( k=jt1; k<=jt2; k++ ) {
-                dkav[k] += dksquid[k];
-              }
-              break;
-            }
-          }
+  /* Re-normalize the average dark-squid here at the end of pass 0 */
+  if( (ngood) && (*status==SAI__OK) ) {
+    for( j=jt1; j<=jt2; j++ ) {
+      dkav[j] /= ngood;
+    }
+  }
+
+  /* Replace bad bolos in model with the average? */
+  if( replacebad && calcdk && needDA && model && (*status==SAI__OK) ) {
+    for( i=0; i<ncol; i++ ) {
+      dksquid = model->pntr[0];
+      dksquid += i*(ntslice+nrow*3);
+
+      if( !dkgood[i] ) {
+        memcpy( dksquid, dkav, sizeof(*dksquid)*ntslice );
+        dkgood[i] = 1;
+      }
+    }
+  }
+
+  /* Second pass actually does the fitting. The columns are independent,
+     so share them out between the worker threads. */
+  nw = wf ? wf->nworker : 1;
+  job_data = astMalloc( nw*sizeof(*job_data) );
+
+  if( *status == SAI__OK ) {
+    step = ncol/nw;
+    if( step == 0 ) step = 1;
+
+    for( iw = 0; iw < nw; iw++ ) {
+      pdata = job_data + iw;
+      pdata->c1 = iw*step;
+      pdata->c2 = ( iw < nw - 1 ) ? pdata->c1 + step - 1 : ncol - 1;
+
+      pdata->dkgood = dkgood;
+      pdata->dksquid = model ? NULL : dksquid;
+      pdata->indata = indata;
+      pdata->jf1 = jf1;
+      pdata->jf2 = jf2;
+      pdata->jt1 = jt1;
+      pdata->mask = mask;
+      pdata->model_data = model ? model->pntr[0] : NULL;
+      pdata->nbad = 0;
+      pdata->ncol = ncol;
+      pdata->nofit = nofit;
+      pdata->nrow = nrow;
+      pdata->ntot = ntot;
+      pdata->ntslice = ntslice;
+      pdata->qua = qua;
+      pdata->smooth = ( needDA && calcdk && model );
+      pdata->window = window;
+
+      if( pdata->c1 < ncol ) {
+        thrAddJob( wf, 0, pdata, smf1_clean_dksquid, 0, NULL, status );
+      }
+    }
+    thrWait( wf, status );
+
+    for( iw = 0; iw < nw; iw++ ) nbad += job_data[ iw ].nbad;
+  }
+
+  /* Report number of new bad bolos that were flagged */
+  if( !replacebad && nbad ) {
+    msgOutiff( MSG__VERB, "", FUNC_NAME
+               ": %zu new bolos flagged bad due to dead DKS", status, nbad );
+  }
+
+  /* Free dksquid only if it was a local buffer */
+  if( !model && dksquid ) dksquid = astFree( dksquid );
+
+  dkgood = astFree( dkgood );
+  dkav = astFree( dkav );
+  job_data = astFree( job_data );
+
+}
+
+
+
+static void smf1_clean_dksquid( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_clean_dksquid
+
+*  Purpose:
+*     Executed in a worker thread to fit and remove the dark squids
+*     from a range of columns.
+
+*  Invocation:
+*     smf1_clean_dksquid( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = smfCleanDksquidData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*  Description:
+*     The sums of the dark squid values and their squares over the
+*     fitted range are found once for each column, and re-used by the
+*     fit for every bolometer in the column.
+
+*/
+
+/* Local Variables: */
+  smfCleanDksquidData *pdata;
+  dim_t b;                /* Bolometer index */
+  size_t bstride;         /* Bolometer index stride */
+  double corr;            /* Linear correlation coefficient */
+  double *corrbuf=NULL;   /* Array of correlation coeffs all bolos this col */
+  double *dksquid=NULL;   /* Buffer for smoothed dark squid */
+  double gain;            /* Gain parameter from template fit */
+  double *gainbuf=NULL;   /* Array of gains for all bolos in this col */
+  size_t i;               /* Loop counter */
+  size_t j;               /* Loop counter */
+  size_t k;               /* Loop counter */
+  size_t nfit;            /* number of samples over good range to fit */
+  dim_t nrow;             /* Number of rows */
+  dim_t ntslice;          /* Number of time slices */
+  double offset;          /* Offset parameter from template fit */
+  double *offsetbuf=NULL; /* Array of offsets for all bolos in this col */
+  int result;             /* Status value from the fit */
+  double s_t;             /* Sum of dark squid values for this column */
+  double s_tsq;           /* Sum of squared dark squid values */
+  smf_qual_t *qua=NULL;   /* Pointer to quality array */
+  size_t tstride;         /* Time slice index stride */
+
+/* Check inherited status */
+  if( *status != SAI__OK ) return;
+
+/* Get a pointer that can be used for accessing the required items in the
+   supplied structure. */
+  pdata = (smfCleanDksquidData *) job_data_ptr;
+
+  nrow = pdata->nrow;
+  ntslice = pdata->ntslice;
+  qua = pdata->qua;
+  nfit = pdata->jf2 - pdata->jf1 + 1;
+  smf_get_dims( pdata->indata, NULL, NULL, NULL, NULL, NULL, &bstride,
+                &tstride, status );
+
+  /* Loop over columns */
+  for( i=pdata->c1; (*status==SAI__OK)&&(i<=pdata->c2); i++ ) {
+
+    /* Point dksquid, gainbuf, offsetbuf and corrbuf to the right
+       place in model if supplied. */
+    if( pdata->model_data ) {
+      dksquid = pdata->model_data + i*(ntslice+nrow*3);
+      gainbuf = dksquid + ntslice;
+      offsetbuf = gainbuf + nrow;
+      corrbuf = offsetbuf + nrow;
+    } else {
+      dksquid = pdata->dksquid;
+    }
+
+    /* Do some dksquid initialization if requested  */
+    if( pdata->smooth && pdata->dkgood[i] ) {
+      /* Smooth the dark squid template */
+      smf_boxcar1D( &dksquid[pdata->jt1], pdata->ntot, 1, pdata->window, NULL,
+                    0, 1, NULL, status );
+    }
+
+    /* Initialize fit coeffs to VAL__BADD */
+    if( (*status == SAI__OK) && pdata->model_data ) {
+      for( j=0; j<nrow; j++ ) {
+        gainbuf[j] = VAL__BADD;
+        offsetbuf[j] = VAL__BADD;
+        corrbuf[j] = VAL__BADD;
+      }
+    }
+
+    if( pdata->nofit ) continue;
+
+    /* Sums of the dark squid and its square over the range being fit,
+       shared by all bolometers in the column. */
+    s_t = 0.0;
+    s_tsq = 0.0;
+    if( pdata->dkgood[i] ) {
+      for( k=pdata->jf1; k<=pdata->jf2; k++ ) {
+        if( dksquid[k] != VAL__BADD ) {
+          s_t += dksquid[k];
+          s_tsq += dksquid[k]*dksquid[k];
         }
       }
+    }
 
-      /* Second pass actually do the fitting / replace with average dksquid if
-         dksquid was dead */
-      if( pass==1 ) {
+    /* Loop over rows, removing the fitted dksquid template. */
+    for( j=0; (*status==SAI__OK) && (j<nrow); j++ ) {
+
+      /* Calculate bolometer index from row/col counters */
+      if( SC2STORE__COL_INDEX ) {
+        b = i*nrow + j;
+      } else {
+        b = i + j*pdata->ncol;
+      }
 
-        /* Do some dksquid initialization if requested  */
-        if( (*status==SAI__OK) && needDA && calcdk && model && dkgood[i] ) {
-          /* Smooth the dark squid template */
-          smf_boxcar1D( &dksquid[jt1], ntot, 1, window, NULL, 0, 1, NULL, status );
+      /* If dark squid is bad, flag entire bolo as bad if it isn't already */
+      if( !pdata->dkgood[i] && qua && !(qua[b*bstride]&SMF__Q_BADB) ) {
+        pdata->nbad++;
+        for( k=0; k<ntslice; k++ ) {
+          qua[b*bstride+k*tstride] |= SMF__Q_BADB;
         }
+      }
 
-        /* Initialize fit coeffs to VAL__BADD */
-        if( (*status == SAI__OK) && model ) {
-          for( j=0; j<nrow; j++ ) {
-            gainbuf[j] = VAL__BADD;
-            offsetbuf[j] = VAL__BADD;
-            corrbuf[j] = VAL__BADD;
+      /* Try to fit if we think we have a good dark squid and bolo, and only
+         the goodrange of data (excluding padding etc.) */
+      if((!qua && pdata->dkgood[i]) ||
+         (qua && pdata->dkgood[i] && !(qua[b*bstride]&SMF__Q_BADB))) {
+        double *d_d;
+        int *d_i;
+
+        result = SAI__OK;
+        switch( pdata->indata->dtype ) {
+        case SMF__DOUBLE:
+          d_d = (double *) pdata->indata->pntr[0];
+          result = smf1_clean_dksquid_fit( &d_d[b*bstride+pdata->jf1*tstride],
+                                           qua ? &qua[b*bstride+pdata->jf1*tstride] : NULL,
+                                           pdata->mask, nfit, tstride,
+                                           &dksquid[pdata->jf1], s_t, s_tsq,
+                                           &gain, &offset, &corr );
+          break;
+
+        case SMF__INTEGER:
+          d_i = (int *) pdata->indata->pntr[0];
+          smf_templateFit1I( &d_i[b*bstride+pdata->jf1*tstride],
+                             qua ? &qua[b*bstride+pdata->jf1*tstride] : NULL,
+                             NULL, NULL, pdata->mask, pdata->mask, nfit,
+                             tstride, &dksquid[pdata->jf1], 1, 1,
+                             &gain, &offset, &corr, status );
+          if( *status == SMF__INSMP || *status == SMF__DIVBZ ) {
+            result = *status;
+            errAnnul( status );
           }
+          break;
+
+        default:
+          msgSetc( "DT", smf_dtype_string( pdata->indata, status ));
+          *status = SAI__ERROR;
+          errRep( " ", FUNC_NAME
+                  ": Unsupported data type for dksquid cleaning (^DT)",
+                  status );
         }
 
-        /* Loop over rows, removing the fitted dksquid template. */
-        for( j=0; (!nofit) && (*status==SAI__OK) && (j<nrow); j++ ) {
-
-          /* Calculate bolometer index from row/col counters */
-          if( SC2STORE__COL_INDEX ) {
-            b = i*nrow + j;
-          } else {
-            b = i + j*ncol;
-          }
+        if( result == SMF__INSMP || result == SMF__DIVBZ ) {
+          /* SMF__INSMP was probably due to a bad bolometer */
+          msgOutiff( MSG__DEBUG, "", FUNC_NAME
+                     ": ROW,COL (%zu,%zu) %s", status, j, i,
+                     (result == SMF__INSMP ? "insufficient good samples" :
+                      "division by zero" ));
 
-          /* If dark squid is bad, flag entire bolo as bad if it isn't already */
-          if( !dkgood[i] && qua && !(qua[b*bstride]&SMF__Q_BADB) ) {
-            nbad++;
+          /* Flag entire bolo as bad if it isn't already */
+          if( qua && !(qua[b*bstride]&SMF__Q_BADB) ) {
             for( k=0; k<ntslice; k++ ) {
               qua[b*bstride+k*tstride] |= SMF__Q_BADB;
             }
           }
-
-          /* Try to fit if we think we have a good dark squid and bolo, and only
-             the goodrange of data (excluding padding etc.) */
-          if((!qua && dkgood[i]) ||
-             (qua && dkgood[i] && !(qua[b*bstride]&SMF__Q_BADB))) {
-            double *d_d;
-            int *d_i;
-
-            switch( indata->dtype ) {
-            case SMF__DOUBLE:
-              d_d = (double *) indata->pntr[0];
-              smf_templateFit1D( &d_d[b*bstride+jf1*tstride],
-                                 &qua[b*bstride+jf1*tstride], NULL, NULL,
-                                 mask, mask, nfit, tstride, &dksquid[jf1], 1,
-                                 1, &gain, &offset, &corr, status );
-              break;
-
-            case SMF__INTEGER:
-              d_i = (int *) indata->pntr[0];
-              smf_templateFit1I( &d_i[b*bstride+jf1*tstride],
-                                 &qua[b*bstride+jf1*tstride], NULL, NULL, mask,
-                                 mask, nfit, tstride, &dksquid[jf1], 1, 1,
-                                 &gain, &offset, &corr, status );
-              break;
-
-            default:
-              msgSetc( "DT", smf_dtype_string( indata, status ));
-              *status = SAI__ERROR;
-              errRep( " ", FUNC_NAME
-                      ": Unsupported data type for dksquid cleaning (^DT)",
-                      status );
-            }
-
-            if( *status == SMF__INSMP || *status == SMF__DIVBZ ) {
-              int wasinsmp = (*status == SMF__INSMP ? 1 : 0 );
-              /* Annul SMF__INSMP as it was probably due to a bad bolometer */
-              errAnnul( status );
-              msgOutiff( MSG__DEBUG, "", FUNC_NAME
-                         ": ROW,COL (%zu,%zu) %s", status, j, i,
-                         (wasinsmp ? "insufficient good samples" : "division by zero" ));
-
-              /* Flag entire bolo as bad if it isn't already */
-              if( qua && !(qua[b*bstride]&SMF__Q_BADB) ) {
-                for( k=0; k<ntslice; k++ ) {
-                  qua[b*bstride+k*tstride] |= SMF__Q_BADB;
-                }
-              }
-            } else {
-              /* Store gain and offset in model */
-              if( model ) {
-                gainbuf[j] = gain;
-                offsetbuf[j] = offset;
-                corrbuf[j] = corr;
-              }
-
-              if( msgFlevok( MSG__DEBUG1, status ) ) {
-                msgSeti( "COL", i );
-                msgSeti( "ROW", j );
-                msgSetd( "GAI", gain );
-                msgSetd( "OFF", offset );
-                msgSetd( "CORR", corr );
-                msgOutif( MSG__DEBUG1, "", FUNC_NAME
-                          ": ROW,COL (^ROW,^COL) GAIN,OFFSET,CORR "
-                          "(^GAI,^OFF,^CORR)", status );
-              }
-            }
+        } else if( *status == SAI__OK ) {
+          /* Store gain and offset in model */
+          if( pdata->model_data ) {
+            gainbuf[j] = gain;
+            offsetbuf[j] = offset;
+            corrbuf[j] = corr;
           }
+
+          msgOutiff( MSG__DEBUG1, "", FUNC_NAME
+                     ": ROW,COL (%zu,%zu) GAIN,OFFSET,CORR (%g,%g,%g)",
+                     status, j, i, gain, offset, corr );
         }
       }
     }
+  }
+}
 
-    /* Re-normalize the average dark-squid here at the end of pass 0 */
-    if( (pass==0) && (ngood) && (*status==SAI__OK) ) {
-      for( j=jt1; j<=jt2; j++ ) {
-        dkav[j] /= ngood;
-      }
-    }
 
-    /* Replace bad bolos in model with the average? */
-    if( replacebad && calcdk && needDA && model && (*status==SAI__OK) ) {
-      for( i=0; i<ncol; i++ ) {
-        dksquid = model->pntr[0];
-        dksquid += i*(ntslice+nrow*3);
 
-        if( !dkgood[i] ) {
-          memcpy( dksquid, dkav, sizeof(*dksquid)*ntslice );
-          dkgood[i] = 1;
-        }
+static int smf1_clean_dksquid_fit( double *data, smf_qual_t *qual,
+                                   smf_qual_t mask, size_t n, size_t stride,
+                                   const double *template, double s_t,
+                                   double s_tsq, double *gain, double *offset,
+                                   double *corr ) {
+/*
+*  Name:
+*     smf1_clean_dksquid_fit
+
+*  Purpose:
+*     Fit and remove a scaled dark squid from a single bolometer.
+
+*  Invocation:
+*     int smf1_clean_dksquid_fit( double *data, smf_qual_t *qual,
+*                                 smf_qual_t mask, size_t n, size_t stride,
+*                                 const double *template, double s_t,
+*                                 double s_tsq, double *gain, double *offset,
+*                                 double *corr )
+
+*  Arguments:
+*     data = double * (Given and Returned)
+*        The bolometer data. The fitted template is removed on exit.
+*     qual = smf_qual_t * (Given)
+*        The bolometer quality, or NULL to use bad values instead.
+*     mask = smf_qual_t (Given)
+*        Quality bits that indicate samples to be ignored.
+*     n = size_t (Given)
+*        Number of samples.
+*     stride = size_t (Given)
+*        Stride between adjacent samples in "data" and "qual".
+*     template = const double * (Given)
+*        The dark squid.
+*     s_t = double (Given)
+*        The sum of all good template values.
+*     s_tsq = double (Given)
+*        The sum of the squares of all good template values.
+*     gain = double * (Returned)
+*        The fitted gain.
+*     offset = double * (Returned)
+*        The fitted offset (always zero).
+*     corr = double * (Returned)
+*        The correlation coefficient.
+
+*  Returned Value:
+*     SAI__OK if the fit succeeded, otherwise SMF__INSMP or SMF__DIVBZ.
+*     No error is reported.
+
+*  Description:
+*     This is equivalent to calling smf_templateFit1D with "remove" and
+*     "nooffset" set, except that the template sums for the column are
+*     supplied. Only the contributions of template values at rejected
+*     samples need to be found and removed from them, and if there are
+*     no rejected samples the supplied sums are used unchanged.
+
+*/
+
+/* Local Variables: */
+  double a;               /* Gain coefficient */
+  double c;               /* Correlation coefficient */
+  double d;               /* Data value */
+  size_t i;               /* Loop counter */
+  size_t nbad=0;          /* Number of rejected samples */
+  size_t ngood=0;         /* Number of good samples */
+  size_t off;             /* Offset to current sample */
+  double r_t=0;           /* Sum of template at rejected samples */
+  double r_tsq=0;         /* Sum of squared template at rejected samples */
+  double s_d=0;           /* Sum of the data points */
+  double s_dsq=0;         /* Sum of the squares of the data points */
+  double s_dt=0;          /* Sum of the data * template */
+  double t;               /* Template value */
+
+  *gain = VAL__BADD;
+  *offset = VAL__BADD;
+  *corr = VAL__BADD;
+
+  /* Find the data sums, and the template sums at rejected samples. */
+  off = 0;
+  for( i=0; i<n; i++ ) {
+    t = template[i];
+    if( t != VAL__BADD ) {
+      d = data[off];
+      if( qual ? !(qual[off]&mask) : (d != VAL__BADD) ) {
+        s_d += d;
+        s_dsq += d*d;
+        s_dt += d*t;
+        ngood++;
+      } else {
+        r_t += t;
+        r_tsq += t*t;
+        nbad++;
       }
     }
+    off += stride;
   }
 
-  /* Report number of new bad bolos that were flagged */
-  if( !replacebad && nbad ) {
-    msgOutiff( MSG__VERB, "", FUNC_NAME
-               ": %zu new bolos flagged bad due to dead DKS", status, nbad );
+  if( nbad ) {
+    s_t -= r_t;
+    s_tsq -= r_tsq;
   }
 
-  /* Free dksquid only if it was a local buffer */
-  if( !model && dksquid ) dksquid = astFree( dksquid );
+  /* Check for divide-by-zero */
+  if( ngood < 3 ) return SMF__INSMP;
+  if( (ngood*s_tsq==s_t*s_t) || (ngood*s_dsq==s_d*s_d) || (s_tsq==0) ) {
+    return SMF__DIVBZ;
+  }
 
-  dkgood = astFree( dkgood );
-  dkav = astFree( dkav );
+  /* Calculate gain only, and the correlation coefficient */
+  a = s_dt/s_tsq;
+  c = (ngood*a*s_dt - a*s_d*s_t) / ( ngood*a*sqrt(s_tsq)*sqrt(s_dsq) );
+
+  *gain = a;
+  *offset = 0;
+  *corr = isnormal(c) ? c : 0;
+
+  /* Remove the fitted template */
+  off = 0;
+  for( i=0; i<n; i++ ) {
+    if( template[i] != VAL__BADD &&
+        ( qual ? !(qual[off]&mask) : (data[off] != VAL__BADD) ) ) {
+      data[off] -= a*template[i];
+    }
+    off += stride;
+  }
 
+  return SAI__OK;
 }
@@ -80,6 +80,14 @@
 *     generally assumed to be noise sources, and are identified as
 *     outliers from the general population and removed.
 *
+*     If "thresh" is negative, only the "ncomp" strongest components are
+*     calculated. If this is a small fraction of the number of
+*     bolometers, they are found using a truncated decomposition (see
+*     smf_pca_trunc), the cost of which depends on the number of
+*     components rather than the cube of the number of bolometers.
+*     Setting the SMURF_EXACTPCA environment variable to 1 forces a full
+*     decomposition instead.
+*
 *     In addition, this routine can be used to flag bad bolometers in
 *     the same way that the common-mode routines work. Once the
 *     decomposition into principal components is complete (but prior
@@ -148,6 +156,17 @@
 *        - When determining the principal components, do not include
 *        boloemeters that too few good samples. This because gap-filled
 *        samples seem to upset the calculation of the components.
+*     14-OCT-2026:
+*        If only a few components are to be calculated, find them using
+*        the randomised truncated decomposition in smf_pca_trunc rather
+*        than a full singular value decomposition. If very few components
+*        are required, the covariance matrix is not formed either. The
+*        full decomposition can be forced by setting the SMURF_EXACTPCA
+*        environment variable to 1.
+*     14-OCT-2026:
+*        Accumulate the covariance matrix in cache-sized tiles of time
+*        slices and blocks of bolometers, optionally in single precision
+*        (SMURF_FLOATPCA). Bad values are given zero weight.
 
 *  Copyright:
 *     Copyright (C) 2011 University of British Columbia.
@@ -175,6 +194,9 @@
 *-
 */
 
+/* System includes */
+#include <stdlib.h>
+
 /* Starlink includes */
 #include "ast.h"
 #include "sae_par.h"
@@ -193,6 +215,11 @@
 
 #define CHECK 0
 
+/* The number of time slices in each tile, and the number of bolometers
+   in each block, used when accumulating the covariance matrix. */
+#define COV_TBLOCK 128
+#define COV_BBLOCK 64
+
 /* ------------------------------------------------------------------------ */
 /* Local variables and functions */
 
@@ -208,6 +235,8 @@ typedef struct smfPCAData {
   double *comp;           /* data cube of components */
   gsl_matrix *cov;        /* bolo-bolo covariance matrix */
   double *covwork;        /* work array for covariance calculation */
+  void *covtile;          /* work array holding a tile of time slices */
+  int floatcov;           /* Accumulate covariance in single precision? */
   size_t ccompstride;     /* component stride in comp array */
   size_t ctstride;        /* time stride in comp array */
   smfData *data;          /* Pointer to input data */
@@ -232,6 +261,7 @@ typedef struct smfPCAData {
 } smfPCAData;
 
 void smfPCAParallel( void *job_data_ptr, int *status );
+static void smf1_pca_covtile( smfPCAData *pdata, size_t t1, size_t nt );
 
 void smfPCAParallel( void *job_data_ptr, int *status ) {
   dim_t tlen;             /* number of time slices */
@@ -369,31 +399,23 @@ void smfPCAParallel( void *job_data_ptr, int *status ) {
   } else if( (pdata->operation == 0) && (*status==SAI__OK) ) {
     /* Operation 0: accumulate sums for covariance calculation -------------- */
 
-    check = 0;
-    for( i=0; i<ngoodbolo; i++ ) {
-      double sum_xy;
-
-      /*msgOutiff( MSG__DEBUG, "", "   bolo %zu", status, goodbolo[i] );*/
-
-      for( j=i; j<ngoodbolo; j++ ) {
-        sum_xy = 0;
-
-        for( k=pdata->t1; k<=pdata->t2; k++ ) {
-          v1 = d[goodbolo[i]*bstride + k*tstride];
-          v2 = d[goodbolo[j]*bstride + k*tstride];
-          sum_xy += v1*v2;
-        }
-
-        /* Store sums in work array and normalize once all threads finish */
-        covwork[ i + j*ngoodbolo ] = sum_xy;
-        //printf("(%zu,%zu) %lg\n", i, j, sum_xy);
+    /* The time slices are processed in tiles, each of which is small
+       enough to stay in cache while the products of all pairs of
+       bolometers are summed. */
+    for( k=pdata->t1; k<=pdata->t2; k+=COV_TBLOCK ) {
+      l = pdata->t2 - k + 1;
+      if( l > COV_TBLOCK ) l = COV_TBLOCK;
+      smf1_pca_covtile( pdata, k, l );
+    }
 
-        check += sum_xy;
+    if( CHECK ) {
+      check = 0;
+      for( i=0; i<ngoodbolo; i++ ) {
+        for( j=i; j<ngoodbolo; j++ ) check += covwork[ i + j*ngoodbolo ];
       }
+      printf("--- check %i: %lf\n", pdata->operation, check);
     }
 
-    if( CHECK ) printf("--- check %i: %lf\n", pdata->operation, check);
-
   } else if( (pdata->operation == 1) && (*status == SAI__OK) ) {
     /* Operation 1: normalized eigenvectors --------------------------------- */
 
@@ -488,6 +510,142 @@ void smfPCAParallel( void *job_data_ptr, int *status ) {
              status, pdata->operation, pdata->t1, pdata->t2 );
 }
 
+static void smf1_pca_covtile( smfPCAData *pdata, size_t t1, size_t nt ) {
+/*
+*  Name:
+*     smf1_pca_covtile
+
+*  Purpose:
+*     Add the products of all pairs of bolometers in a tile of time
+*     slices into the covariance sums.
+
+*  Invocation:
+*     smf1_pca_covtile( smfPCAData *pdata, size_t t1, size_t nt )
+
+*  Arguments:
+*     pdata = smfPCAData * (Given)
+*        The job data for the thread.
+*     t1 = size_t (Given)
+*        The index of the first time slice in the tile.
+*     nt = size_t (Given)
+*        The number of time slices in the tile (no more than COV_TBLOCK).
+
+*  Description:
+*     The values in the tile are first copied into a work array that holds
+*     the values for all bolometers at each time slice contiguously, with
+*     any bad values replaced by zero so that they make no contribution to
+*     the sums. The upper triangle of the matrix of sums (i <= j) is then
+*     updated in square blocks of COV_BBLOCK bolometers. For each
+*     bolometer i, the sums for a whole block of bolometers j are held in
+*     a small local array and updated together at each time slice, which
+*     allows the compiler to vectorise the innermost loop.
+*
+*     In double precision, each sum is continued from its current value
+*     in time order, so the results are identical to summing over all time
+*     slices in a single loop. If single precision has been requested,
+*     the products for the tile are summed in single precision and the
+*     tile total is then added into the double precision sums. This is
+*     faster, since twice as many values fit in each vector register and
+*     in the cache, but is less accurate.
+*/
+
+/* Local Variables: */
+  double *covwork = pdata->covwork;
+  double *d = pdata->data->pntr[0];
+  double *dtile = NULL;
+  double dsum[ COV_BBLOCK ];
+  double v;
+  float *ftile = NULL;
+  float fsum[ COV_BBLOCK ];
+  size_t *goodbolo = pdata->goodbolo;
+  size_t bstride = pdata->bstride;
+  size_t i;
+  size_t ib;
+  size_t ie;
+  size_t j;
+  size_t jb;
+  size_t je;
+  size_t k;
+  size_t nj;
+  size_t ngood = pdata->ngoodbolo;
+  size_t tstride = pdata->tstride;
+
+  /* Copy the tile into the work array. */
+  if( pdata->floatcov ) {
+    ftile = pdata->covtile;
+    for( k=0; k<nt; k++ ) {
+      for( i=0; i<ngood; i++ ) {
+        v = d[goodbolo[i]*bstride + (t1+k)*tstride];
+        ftile[k*ngood + i] = ( v != VAL__BADD ) ? (float) v : 0.0f;
+      }
+    }
+  } else {
+    dtile = pdata->covtile;
+    for( k=0; k<nt; k++ ) {
+      for( i=0; i<ngood; i++ ) {
+        v = d[goodbolo[i]*bstride + (t1+k)*tstride];
+        dtile[k*ngood + i] = ( v != VAL__BADD ) ? v : 0.0;
+      }
+    }
+  }
+
+  /* Loop over the blocks in the upper triangle. Blocks on the diagonal
+     are processed in full (so that the innermost loop always has the
+     same length), but only the sums with j >= i are stored. */
+  for( ib=0; ib<ngood; ib+=COV_BBLOCK ) {
+    ie = ib + COV_BBLOCK;
+    if( ie > ngood ) ie = ngood;
+
+    for( jb=ib; jb<ngood; jb+=COV_BBLOCK ) {
+      je = jb + COV_BBLOCK;
+      if( je > ngood ) je = ngood;
+      nj = je - jb;
+
+      for( i=ib; i<ie; i++ ) {
+
+        if( dtile ) {
+          for( j=0; j<nj; j++ ) dsum[j] = covwork[ i + (jb+j)*ngood ];
+
+          if( nj == COV_BBLOCK ) {
+            for( k=0; k<nt; k++ ) {
+              const double *row = dtile + k*ngood;
+              v = row[i];
+              for( j=0; j<COV_BBLOCK; j++ ) dsum[j] += v*row[jb+j];
+            }
+          } else {
+            for( k=0; k<nt; k++ ) {
+              const double *row = dtile + k*ngood;
+              v = row[i];
+              for( j=0; j<nj; j++ ) dsum[j] += v*row[jb+j];
+            }
+          }
+
+          for( j=(jb>i?0:i-jb); j<nj; j++ ) covwork[ i + (jb+j)*ngood ] = dsum[j];
+
+        } else {
+          for( j=0; j<nj; j++ ) fsum[j] = 0.0f;
+
+          if( nj == COV_BBLOCK ) {
+            for( k=0; k<nt; k++ ) {
+              const float *row = ftile + k*ngood;
+              float fv = row[i];
+              for( j=0; j<COV_BBLOCK; j++ ) fsum[j] += fv*row[jb+j];
+            }
+          } else {
+            for( k=0; k<nt; k++ ) {
+              const float *row = ftile + k*ngood;
+              float fv = row[i];
+              for( j=0; j<nj; j++ ) fsum[j] += fv*row[jb+j];
+            }
+          }
+
+          for( j=(jb>i?0:i-jb); j<nj; j++ ) covwork[ i + (jb+j)*ngood ] += fsum[j];
+        }
+      }
+    }
+  }
+}
+
 /* ------------------------------------------------------------------------ */
 
 
@@ -507,6 +665,9 @@ size_t smf_clean_pca( ThrWorkForce *wf, smfData *data, size_t t_first,
   size_t ccompstride;     /* component stride in comp array */
   size_t ctstride;        /* time stride in comp array */
   gsl_matrix *cov=NULL;   /* bolo-bolo covariance matrix */
+  const char *envval;     /* Value of environment variable */
+  int direct;             /* Find components without the covariance? */
+  int floatcov;           /* Accumulate covariance in single precision? */
   size_t i;               /* Loop counter */
   int ii;                 /* Loop counter */
   size_t j;               /* Loop counter */
@@ -528,6 +689,7 @@ size_t smf_clean_pca( ThrWorkForce *wf, smfData *data, size_t t_first,
   size_t step;            /* step size for job division */
   size_t tlen;            /* Length of the time-series used for PCA */
   size_t tstride;         /* time slice stride */
+  int trunc;              /* Use a truncated decomposition? */
   gsl_vector *work=NULL;  /* workspace for SVD */
 
   if (*status != SAI__OK) return 0;
@@ -717,6 +879,25 @@ size_t smf_clean_pca( ThrWorkForce *wf, smfData *data, size_t t_first,
      ncalc = ngoodbolo2;
   }
 
+/* If only a small fraction of the components are needed, find them using
+   a truncated decomposition, which costs much less than a full SVD of
+   the covariance matrix. The full SVD can be forced by setting the
+   SMURF_EXACTPCA environment variable. If very few components are
+   needed, the truncated decomposition works directly from the data,
+   without forming the covariance matrix at all. Each of the four passes
+   through the data made by smf_pca_trunc then costs about
+   4*(ncalc+10)/ngoodbolo2 of the cost of forming the covariance matrix. */
+  envval = getenv( SMF__EXACTPCA );
+  trunc = ( ncalc > 0 ) && ( 2*( ncalc + 10 ) <= ngoodbolo2 ) &&
+          ( !envval || atoi( envval ) == 0 );
+  direct = trunc && ( 16*( ncalc + 10 ) < ngoodbolo2 );
+
+/* The products summed to form the covariance matrix may be formed in
+   single precision, which is faster but less accurate, by setting the
+   SMURF_FLOATPCA environment variable to 1. */
+  envval = getenv( SMF__FLOATPCA );
+  floatcov = ( envval && atoi( envval ) != 0 );
+
   /* Fill bad values and values flagged via "mask" (except entirely bad
      bolometers) with interpolated data values. */
   mask &= ~SMF__Q_BADB;
@@ -725,7 +906,7 @@ size_t smf_clean_pca( ThrWorkForce *wf, smfData *data, size_t t_first,
   /* Allocate arrays */
   amp = astCalloc( nbolo*ncalc, sizeof(*amp) );
   comp = astCalloc( ncalc*tlen, sizeof(*comp) );
-  cov = gsl_matrix_alloc( ngoodbolo2, ngoodbolo2 );
+  cov = gsl_matrix_alloc( direct ? ncalc : ngoodbolo2, ngoodbolo2 );
   s = gsl_vector_alloc( ngoodbolo2 );
   work = gsl_vector_alloc( ngoodbolo2 );
 
@@ -783,6 +964,7 @@ size_t smf_clean_pca( ThrWorkForce *wf, smfData *data, size_t t_first,
     pdata->comp = comp;
     pdata->cov = NULL;
     pdata->covwork = NULL;
+    pdata->covtile = NULL;
     pdata->ccompstride = ccompstride;
     pdata->ctstride = ctstride;
     pdata->data = data;
@@ -803,8 +985,17 @@ size_t smf_clean_pca( ThrWorkForce *wf, smfData *data, size_t t_first,
 
     /* Each thread will accumulate sums of x, y, and x*y for each bolo when
        calculating the covariance matrix */
-    pdata->covwork = astCalloc( ngoodbolo2*ngoodbolo2,
-                                sizeof(*(pdata->covwork)) );
+    if( !direct ) {
+      pdata->covwork = astCalloc( ngoodbolo2*ngoodbolo2,
+                                  sizeof(*(pdata->covwork)) );
+
+      /* Each thread also needs space for a tile of time slices from each
+         high quality bolometer. */
+      pdata->floatcov = floatcov;
+      pdata->covtile = astMalloc( ngoodbolo2*COV_TBLOCK*
+                                  ( floatcov ? sizeof( float ) :
+                                               sizeof( double ) ) );
+    }
   }
 
   if( *status == SAI__OK ) {
@@ -825,58 +1016,76 @@ size_t smf_clean_pca( ThrWorkForce *wf, smfData *data, size_t t_first,
 
 
 
-    /* Measure the covariance matrix using parallel code ---------------------*/
+    /* Measure the covariance matrix using parallel code, unless the
+       components are to be found directly from the data. ---------------*/
 
-    msgOutif( MSG__VERB, "", FUNC_NAME
-              ": measuring bolo-bolo covariance matrix...", status );
+    if( !direct ) {
 
-    /* Set up the jobs to calculate sums for each time block and submit */
-    for( ii=0; ii<nw; ii++ ) {
-      pdata = job_data + ii;
-      pdata->operation = 0;
-      pdata->ijob = thrAddJob( wf, THR__REPORT_JOB, pdata, smfPCAParallel,
-                                 0, NULL, status );
-    }
+      msgOutif( MSG__VERB, "", FUNC_NAME
+                ": measuring bolo-bolo covariance matrix...", status );
 
-    /* Wait until all of the submitted jobs have completed */
-    thrWait( wf, status );
+      /* Set up the jobs to calculate sums for each time block and submit */
+      for( ii=0; ii<nw; ii++ ) {
+        pdata = job_data + ii;
+        pdata->operation = 0;
+        pdata->ijob = thrAddJob( wf, THR__REPORT_JOB, pdata, smfPCAParallel,
+                                   0, NULL, status );
+      }
 
-    /* We now have to add together all of the sums from each thread and
-       normalize */
-    if( *status == SAI__OK ) {
-      for( i=0; i<ngoodbolo2; i++ ) {
-        for( j=i; j<ngoodbolo2; j++ ) {
-          double c;
-          double *covwork=NULL;
-          double sum_xy;
+      /* Wait until all of the submitted jobs have completed */
+      thrWait( wf, status );
 
-          sum_xy = 0;
+      /* We now have to add together all of the sums from each thread and
+         normalize */
+      if( *status == SAI__OK ) {
+        for( i=0; i<ngoodbolo2; i++ ) {
+          for( j=i; j<ngoodbolo2; j++ ) {
+            double c;
+            double *covwork=NULL;
+            double sum_xy;
 
-          for( ii=0; ii<nw; ii++ ) {
-            pdata = job_data + ii;
-            covwork = pdata->covwork;
+            sum_xy = 0;
 
-            sum_xy += covwork[ i + j*ngoodbolo2 ];
-          }
+            for( ii=0; ii<nw; ii++ ) {
+              pdata = job_data + ii;
+              covwork = pdata->covwork;
 
-          c = sum_xy / ((double)tlen-1);
+              sum_xy += covwork[ i + j*ngoodbolo2 ];
+            }
 
-          gsl_matrix_set( cov, i, j, c );
-          gsl_matrix_set( cov, j, i, c );
+            c = sum_xy / ((double)tlen-1);
+
+            gsl_matrix_set( cov, i, j, c );
+            gsl_matrix_set( cov, j, i, c );
+          }
         }
       }
     }
   }
 
   /* Factor cov = u s v^T, noting that the SVD routine calculates v^T in
-     in-place of cov. --------------------------------------------------------*/
+     in-place of cov. If only a few components are needed, the truncated
+     decomposition returns just the first ncalc rows of v^T in cov (found
+     directly from the data if the covariance matrix has not been
+     formed). ----------------------------------------------------------------*/
+
+  if( trunc ) {
+    msgOutiff( MSG__VERB, "", FUNC_NAME
+               ": performing truncated decomposition for %zu components...",
+               status, ncalc );
+
+    smf_pca_trunc( wf, data->pntr[0], goodbolo2, ngoodbolo2, bstride,
+                   tstride, t_first, tlen, direct ? NULL : cov->data, ncalc,
+                   cov->data, s->data, status );
+  } else {
+    msgOutif( MSG__VERB, "", FUNC_NAME
+              ": perfoming singular value decomposition...", status );
 
-  msgOutif( MSG__VERB, "", FUNC_NAME
-            ": perfoming singular value decomposition...", status );
+    smf_svd( wf, ngoodbolo2, cov->data, s->data, NULL, 10*VAL__EPSD,
+             1, status );
+  }
 
-  smf_svd( wf, ngoodbolo2, cov->data, s->data, NULL, 10*VAL__EPSD,
-           1, status );
-  if( CHECK ) {
+  if( CHECK && !trunc ) {
     double check=0;
 
     for( i=0; i<ngoodbolo2; i++ ) {
@@ -1402,6 +1611,7 @@ size_t smf_clean_pca( ThrWorkForce *wf, smfData *data, size_t t_first,
     for( ii=0; ii<nw; ii++ ) {
       pdata = job_data + ii;
       if( pdata->covwork ) pdata->covwork = astFree( pdata->covwork );
+      if( pdata->covtile ) pdata->covtile = astFree( pdata->covtile );
       if( pdata->amp ) pdata->amp = astFree( pdata->amp );
     }
     job_data = astFree(job_data);
@@ -379,7 +379,7 @@ void smf_clean_smfArray( ThrWorkForce *wf, smfArray *array,
     if( dkclean ) {
       msgOutif(MSG__VERB, "", FUNC_NAME
                ": Cleaning dark squid signals from data.", status);
-      smf_clean_dksquid( data, 0, 100, NULL, 0, 0, 0, status );
+      smf_clean_dksquid( wf, data, 0, 100, NULL, 0, 0, 0, status );
 
       /*** TIMER ***/
       msgOutiff( SMF__TIMER_MSG, "", FUNC_NAME ":   ** %f s DKSquid cleaning",
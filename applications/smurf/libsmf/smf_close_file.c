@@ -122,12 +122,21 @@
 *        quality bits that are to be exported to the NDF.
 *     2017-01-10 (GSB):
 *        Pass dtai=VAL__BADD to WCS functions.
+*     14-OCT-2026:
+*        Free any packed quality mask.
+*     14-OCT-2026:
+*        Free any index of good data spans.
+*     2026-10-14:
+*        Free the FITS keyword index.
+*     2026-10-14:
+*        Use smf_state_release to free a JCMTState array that may be
+*        shared with other headers.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2007-2009 Science and Technology Facilities Council.
 *     Copyright (C) 2005-2006 Particle Physics and Astronomy Research Council.
-*     Copyright (C) 2016-2017 East Asian Observatory.
+*     Copyright (C) 2016-2017, 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -298,6 +307,11 @@ void smf_close_file( ThrWorkForce *wf, smfData ** data, int * status ) {
     if (hdr->wcs != NULL) hdr->wcs = astAnnul( hdr->wcs );
     if (hdr->tswcs != NULL) hdr->tswcs = astAnnul( hdr->tswcs );
     if (hdr->fitshdr != NULL) hdr->fitshdr = astAnnul( hdr->fitshdr );
+    if (hdr->fitsidx != NULL) {
+      hdr->fitsidx->names = astFree( hdr->fitsidx->names );
+      hdr->fitsidx->cards = astFree( hdr->fitsidx->cards );
+      hdr->fitsidx = astFree( hdr->fitsidx );
+    }
 
     if( hdr->cache1 ) hdr->cache1 = sc2ast_createwcs2( SC2AST__NULLSUB, NULL, 0.0, VAL__BADD, NULL, NULL, NO_FTS, NULL,
                                                        hdr->cache1, status );
@@ -310,8 +324,8 @@ void smf_close_file( ThrWorkForce *wf, smfData ** data, int * status ) {
       /* We are responsible for this memory - although what happens
          when we are cloned and the original is freed first? Need
          to think carefully about memory management. */
-      if (hdr->allState != NULL) {
-        hdr->allState = astFree( hdr->allState );
+      if (hdr->allState != NULL || hdr->stateshare != NULL) {
+        smf_state_release( hdr, status );
       }
       if (hdr->fplanex) hdr->fplanex = astFree( hdr->fplanex );
       if (hdr->fplaney) hdr->fplaney = astFree( hdr->fplaney );
@@ -357,11 +371,19 @@ void smf_close_file( ThrWorkForce *wf, smfData ** data, int * status ) {
     (*data)->poly = astFree( (*data)->poly );
   }
   if ( (*data)->lut ) {
-    (*data)->lut = astFree( (*data)->lut );
+    (*data)->lut = smf_scratch_free( (*data)->lut, status );
   }
   if( (*data)->theta ) {
     (*data)->theta = astFree( (*data)->theta );
   }
+  if( (*data)->qmask ) {
+    (*data)->qmask = astFree( (*data)->qmask );
+  }
+  if( (*data)->qspans ) {
+    (*data)->qspans->first = astFree( (*data)->qspans->first );
+    (*data)->qspans->spans = astFree( (*data)->qspans->spans );
+    (*data)->qspans = astFree( (*data)->qspans );
+  }
 
   /* Free the data arrays if they are non-null (they should have been
      freed if they were mapped to a file but not if they were stored
@@ -369,10 +391,10 @@ void smf_close_file( ThrWorkForce *wf, smfData ** data, int * status ) {
   if (freedata) {
     for (i = 0; i < 2; i++ ) {
       if ( ((*data)->pntr)[i] != NULL )
-        ((*data)->pntr)[i] = astFree( ((*data)->pntr)[i] );
+        ((*data)->pntr)[i] = smf_scratch_free( ((*data)->pntr)[i], status );
     }
     if ( (*data)->qual ) {
-      (*data)->qual = astFree( (*data)->qual );
+      (*data)->qual = smf_scratch_free( (*data)->qual, status );
     }
   }
 
@@ -256,6 +256,12 @@
  *     2019-04-02 (GSB):
  *        Accumulate onmap flag value in subgroup loop rather than retaining
  *        only the last value.
+ *     2026-10-14:
+ *        The worker thread that opens the next piece now also checks
+ *        whether it is raw and, if it will not be downsampled, converts
+ *        it directly to double precision. Previously the piece was copied
+ *        once in the worker thread and then converted to double precision
+ *        in a second full copy in the main thread.
  *     {enter_further_changes_here}
 
  *  Copyright:
@@ -307,6 +313,7 @@
 
 /* Prototypes for local static functions. */
 static void smf1_concat_smfGroup( void *job_data_ptr, int *status );
+static void smf1_concat_open( void *job_data_ptr, int *status );
 
 /* Local data types */
 typedef struct smfConcatSmfGroupData {
@@ -327,6 +334,15 @@ typedef struct smfConcatSmfGroupData {
    smf_qual_t *outq;
 } SmfConcatSmfGroupData;
 
+typedef struct smfConcatOpenData {
+   const Grp *grp;
+   size_t index;
+   int rawconvert;
+   int israw;
+   int converted;
+   smfData *data;
+} SmfConcatOpenData;
+
 #define FUNC_NAME "smf_concat_smfGroup"
 
 void smf_concat_smfGroup( ThrWorkForce *wf, AstKeyMap *config, const smfGroup *igrp,
@@ -666,10 +682,11 @@ void smf_concat_smfGroup( ThrWorkForce *wf, AstKeyMap *config, const smfGroup *i
          Otherwise proceed with concatenation
          **********************************************************************/
 
+      SmfConcatOpenData opendata;   /* Describes the job opening the next piece */
       smfData *tmpdata = NULL;      /* for the original data before resamp */
-      smfData *tmpdata_next = NULL; /* for the next data before resamp */
+      int converted = 0;
       int doflat;
-      int israw;
+      int israw = 1;
 
       /* Add any padding to the length */
       tlen += padStart + padEnd;
@@ -702,36 +719,46 @@ void smf_concat_smfGroup( ThrWorkForce *wf, AstKeyMap *config, const smfGroup *i
 
           smf_open_file( wf, igrp->grp, igrp->subgroups[j][i], "READ", 0,
                          &tmpdata, status );
+
+          /* See if the data needs to be flat-fielded. If the data has
+             already been flat-fielded, then we clearly do not need to
+             flat-field it again. If the data has not yet been flat-fielded,
+             then we flat-field it below only if requested and otherwise
+             just convert the raw integers to doubles. Later pieces are
+             checked by the job that opens them. */
+          smf_check_flat( tmpdata, status );
+          if( *status == SMF__FLATN ) {
+            israw = 0;
+            errAnnul( status );
+          } else {
+            israw = 1;
+          }
+          converted = 0;
         }
+        doflat = israw ? ensureflat : 0;
 
         /* If any pieces remain to be opened, start a job to open the next
            piece, running the job in a separate thread. Return as soon
            as the job is submitted (i.e. do not wait for the job to
-           complete). */
+           complete). If the next piece is raw and is not to be
+           downsampled, the job also converts it to double precision. */
         if( j < lastpiece ) {
-           smf_open_file_job( wf, 0, igrp->grp, igrp->subgroups[j+1][i],
-                              "READ", 0, &tmpdata_next, status );
+           opendata.grp = igrp->grp;
+           opendata.index = igrp->subgroups[j+1][i];
+           opendata.rawconvert = !( dslen && dslen[j+1-firstpiece] );
+           opendata.israw = 1;
+           opendata.converted = 0;
+           opendata.data = NULL;
+
+           thrBeginJobContext( wf, status );
+           thrAddJob( wf, 0, &opendata, smf1_concat_open, 0, NULL, status );
+           thrEndJobContext( wf, status );
         }
 
         /* Meanwhile, whilst the next piece in being opened in a
            separate thread, we continue to process the already opened
            piece in the main thread... */
 
-        /* See if the data needs to be flat-fielded. If the data has
-           already been flat-fielded, then we clearly do not need to
-           flat-field it again. If the data has not yet been flat-fielded,
-           then we flat-field it below only if requested and otherwise
-           just convert the raw integers to doubles. */
-        smf_check_flat( tmpdata, status );
-        if( *status == SMF__FLATN ) {
-          israw = 0;
-          doflat = 0;
-          errAnnul( status );
-        } else {
-          israw = 1;
-          doflat = ensureflat;
-        }
-
         /* If required, downsample the data and if it is raw, convert it to
            double precision. Then release the original data. */
         if( dslen && dslen[j-firstpiece] ) {
@@ -742,12 +769,13 @@ void smf_concat_smfGroup( ThrWorkForce *wf, AstKeyMap *config, const smfGroup *i
         /* Otherwise, if the data is raw, convert it to double precision
            then release the original. We copy the smfFile so that the
            flatfielding can report a file name associated with any failure. */
-        } else if( israw ) {
+        } else if( israw && !converted ) {
           refdata = smf_deepcopy_smfData( wf, tmpdata, 1,  0, 0, 0,
                                           status );
           smf_close_file( wf, &tmpdata, status );
 
-        /* Otherwise, just continue to use the original data. */
+        /* Otherwise, just continue to use the original (or already
+           converted) data. */
         } else {
            refdata = tmpdata;
         }
@@ -940,13 +968,16 @@ void smf_concat_smfGroup( ThrWorkForce *wf, AstKeyMap *config, const smfGroup *i
               havearray[1] = havearray[1] && !(flags&SMF__NOCREATE_VARIANCE);
               havequal = havequal && !(flags&SMF__NOCREATE_QUALITY);
 
-              /* Allocate space for arrays being propagated from template */
+              /* Allocate space for arrays being propagated from
+                 template. These are placed in memory-mapped scratch
+                 files if SMURF_SCRATCHDIR is set. */
               for( k=0; k<2; k++ ) if( havearray[k] ) {
                   size_t sz = smf_dtype_sz(data->dtype, status );
-                  data->pntr[k] = astCalloc( ndata, sz );
+                  data->pntr[k] = smf_scratch_malloc( wf, ndata*sz, 1, status );
                 }
               if (havequal) {
-                data->qual = astCalloc( ndata, sizeof(*(data->qual)) );
+                data->qual = smf_scratch_malloc( wf, ndata*sizeof(*(data->qual)),
+                                                 1, status );
               }
 
               /* Check to see if havearray for QUALITY is not set,
@@ -954,12 +985,14 @@ void smf_concat_smfGroup( ThrWorkForce *wf, AstKeyMap *config, const smfGroup *i
                  case, allocate a fresh QUALITY component that will
                  not require propagation from the template */
               if( !havequal && !(flags & SMF__NOCREATE_QUALITY) ) {
-                data->qual = astCalloc(ndata, sizeof(*(data->qual)) );
+                data->qual = smf_scratch_malloc( wf, ndata*sizeof(*(data->qual)),
+                                                 1, status );
               }
 
               /* Allocate space for the pointing LUT, and theta if needed */
               if( havelut || importlut ) {
-                data->lut = astCalloc(ndata, sizeof(*(data->lut)) );
+                data->lut = smf_scratch_malloc( wf, ndata*sizeof(*(data->lut)),
+                                                1, status );
                 data->theta = astCalloc(tlen, sizeof(*(data->theta)) );
               }
 
@@ -1122,8 +1155,10 @@ void smf_concat_smfGroup( ThrWorkForce *wf, AstKeyMap *config, const smfGroup *i
            previous smfData pointer. */
         if( j < lastpiece ) {
            thrWait( wf, status );
-           smf_lock_data( tmpdata_next, 1, status );
-           tmpdata = tmpdata_next;
+           smf_lock_data( opendata.data, 1, status );
+           tmpdata = opendata.data;
+           israw = opendata.israw;
+           converted = opendata.converted;
         }
 
       }
@@ -1458,10 +1493,73 @@ static void smf1_concat_smfGroup( void *job_data_ptr, int *status ) {
    }
 }
 
+static void smf1_concat_open( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_concat_open
+
+*  Purpose:
+*     Executed in a worker thread to open the next piece for
+*     smf_concat_smfGroup.
+
+*  Invocation:
+*     smf1_concat_open( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = SmfConcatOpenData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*  Description:
+*     This opens the file and notes if it contains raw data. If the
+*     file is associated with an NDF, or is raw and is to be converted
+*     to double precision, a deep copy is made and the original file is
+*     closed, so that the returned smfData can be closed in any thread.
+*     The AST objects in the returned smfData are unlocked so that the
+*     calling thread can lock them.
 
+*/
 
+/* Local Variables: */
+   SmfConcatOpenData *pdata;
+   int rawconvert;
+   smfData *thisdata = NULL;
+   smfData *tmpdata = NULL;
 
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
 
+/* Get a pointer that can be used for accessing the required items in the
+   supplied structure. */
+   pdata = (SmfConcatOpenData *) job_data_ptr;
 
+/* Open the file, and see if it has already been flat-fielded. */
+   smf_open_file( NULL, pdata->grp, pdata->index, "READ", 0, &thisdata,
+                  status );
+   smf_check_flat( thisdata, status );
+   if( *status == SMF__FLATN ) {
+      pdata->israw = 0;
+      errAnnul( status );
+   } else {
+      pdata->israw = 1;
+   }
 
+/* Make the deep copy if required, converting raw data to double
+   precision in the same pass. */
+   rawconvert = pdata->israw && pdata->rawconvert;
+   if( thisdata && thisdata->file &&
+       ( rawconvert || thisdata->file->ndfid != NDF__NOID ) ) {
+      tmpdata = smf_deepcopy_smfData( NULL, thisdata, rawconvert, 0, 0, 0,
+                                      status );
+      smf_close_file( NULL, &thisdata, status );
+      thisdata = tmpdata;
+      if( thisdata ) pdata->converted = rawconvert;
+   }
 
+/* Unlock all AST objects within the smfData so that the calling thread
+   can lock them. */
+   smf_lock_data( thisdata, 0, status );
+   pdata->data = thisdata;
+}
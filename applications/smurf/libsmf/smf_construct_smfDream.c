@@ -73,11 +73,14 @@
 *        Allow for lower-case SAM_MODE
 *     2008-07-24 (TIMJ):
 *        Use hdr->obsmode instead of SAM_MODE.
+*     2026-10-14:
+*        The inverse matrix is optional in the weights file.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2006-2008 University of British Columbia.
 *     Copyright (C) 2007 Science and Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -150,6 +153,7 @@ smfDream *smf_construct_smfDream( smfData *data, size_t nvert,
   smfData *wtdata = NULL;    /* smfData for weights file */
   smfFile *wtfile = NULL;    /* smfFile for weights file */
   Grp *wtgrp = NULL;         /* Grp containing name of weights file */
+  int there = 0;             /* Is the inverse matrix present? */
 
   if (*status != SAI__OK) return NULL;
 
@@ -224,19 +228,24 @@ smfDream *smf_construct_smfDream( smfData *data, size_t nvert,
 		  smf_close_file( NULL, &griddata, status);
 		}
 
-		/* Then the inverse matrix */
-		ndfid = smf_get_ndfid(drmloc, "INVMATX", "READ", "OLD", "", 0,
-				      NULL, NULL, status);
-		smf_open_ndf( ndfid, "READ", SMF__DOUBLE, &griddata, status);
-		if ( griddata != NULL ) {
-		  nelem = (size_t)((griddata->dims)[0]);
-		  invmatx = astCalloc( nelem, sizeof(double) );
-		  if ( invmatx != NULL ) {
-		    gridptr = (griddata->pntr)[0];
-		    memcpy( invmatx, gridptr, nelem*sizeof(double) );
-		    dream->invmatx = invmatx;
+		/* Then the inverse matrix. This is absent from weights
+		   files made for the iterative solver, in which case
+		   invmatx is left NULL. */
+		datThere( drmloc, "INVMATX", &there, status );
+		if ( there ) {
+		  ndfid = smf_get_ndfid(drmloc, "INVMATX", "READ", "OLD", "", 0,
+					NULL, NULL, status);
+		  smf_open_ndf( ndfid, "READ", SMF__DOUBLE, &griddata, status);
+		  if ( griddata != NULL ) {
+		    nelem = (size_t)((griddata->dims)[0]);
+		    invmatx = astCalloc( nelem, sizeof(double) );
+		    if ( invmatx != NULL ) {
+		      gridptr = (griddata->pntr)[0];
+		      memcpy( invmatx, gridptr, nelem*sizeof(double) );
+		      dream->invmatx = invmatx;
+		    }
+		    smf_close_file( NULL, &griddata, status);
 		  }
-		  smf_close_file( NULL, &griddata, status);
 		}
 
 		/* Now for the gridpts array */
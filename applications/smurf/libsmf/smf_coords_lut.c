@@ -14,8 +14,8 @@
 *     C function
 
 *  Invocation:
-*     void smf_coords_lut( smfData *data, int tstep, dim_t itime_lo,
-*                          dim_t itime_hi, AstSkyFrame *abskyfrm,
+*     void smf_coords_lut( smfData *data, int tstep, double steptol,
+*                          dim_t itime_lo, dim_t itime_hi, AstSkyFrame *abskyfrm,
 *                          AstMapping *oskymap, int moving, int olbnd[ 2 ],
 *                          int oubnd[ 2 ], fts2Port fts_port, int *lut,
 *                          double *angle, double *lon, double *lat,
@@ -27,6 +27,14 @@
 *     tstep = int (Given)
 *        The increment in time slices between full Mapping calculations.
 *        The Mapping for intermediate time slices will be approximated.
+*        If "steptol" is positive, this is the maximum increment.
+*     steptol = double (Given)
+*        If positive, the bolometer positions at intermediate time slices
+*        are interpolated between the full calculations, and the
+*        increment between full calculations is reduced wherever
+*        necessary to keep the interpolation error below "steptol"
+*        arc-seconds (see "Description:"). If zero or negative, the
+*        fixed increment given by "tstep" is used.
 *     itime_lo = dim_t (Given)
 *        The index of the first time slice to be included in the returned
 *        LUT.
@@ -90,6 +98,17 @@
 *
 *     These output GRID coords are converted into 1-dimensional vector index
 *     within the output map, and stored in the returned LUT.
+*
+*     If "steptol" is positive, the intermediate time slices are instead
+*     handled by linearly interpolating the output map GRID coords of
+*     each bolometer between the full calculations either side. This
+*     follows rotation of the array on the sky as well as the motion of
+*     the boresight. The full calculations are no longer regularly
+*     spaced: each interval (at most "tstep" time slices long) is checked
+*     by doing a full calculation at its mid point, and the interval is
+*     halved until the interpolated positions at the mid point are all
+*     within "steptol" arc-seconds of the full calculation. The interval
+*     is allowed to grow again once the telescope motion becomes smooth.
 
 *  Authors:
 *     David S Berry (JAC, Hawaii)
@@ -109,6 +128,8 @@
 *        Add lon and lat to interface.
 *     2-AUG-2018 (DSB):
 *        Add onmap to interface.
+*     14-OCT-2026:
+*        Add steptol to interface.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -137,6 +158,9 @@
 *-
 */
 
+/* System includes */
+#include <string.h>
+
 /* Starlink includes */
 #include "ast.h"
 #include "mers.h"
@@ -147,8 +171,21 @@
 #include "libsmf/smf.h"
 #include "libsmf/smf_typ.h"
 
-void smf_coords_lut( smfData *data, int tstep, dim_t itime_lo,
-                     dim_t itime_hi, AstSkyFrame *abskyfrm,
+/* Prototypes for local functions */
+static int smf1_coords_full( smfData *data, dim_t itime,
+                             AstSkyFrame *abskyfrm, AstMapping *oskymap,
+                             int moving, fts2Port fts_port, int lbnd_in[ 2 ],
+                             int ubnd_in[ 2 ], dim_t nbolo, double *coords,
+                             int *status );
+static int smf1_coords_check( const double *coords0, const double *coords1,
+                              const double *coordsm, double frac,
+                              dim_t nbolo, double tolpix );
+static double smf1_coords_pixsize( AstSkyFrame *abskyfrm,
+                                   AstMapping *oskymap, int olbnd[ 2 ],
+                                   int oubnd[ 2 ], int *status );
+
+void smf_coords_lut( smfData *data, int tstep, double steptol,
+                     dim_t itime_lo, dim_t itime_hi, AstSkyFrame *abskyfrm,
                      AstMapping *oskymap, int moving, int olbnd[ 2 ],
                      int oubnd[ 2 ], fts2Port fts_port, int *lut,
                      double *angle, double *lon, double *lat, dim_t *onmap,
@@ -171,6 +208,22 @@ void smf_coords_lut( smfData *data, int tstep, dim_t itime_lo,
    dim_t itime;          /* Time slice index */
    dim_t nbolo;          /* Total number of bolometers */
    double *outmapcoord;  /* Array holding output map GRID coords */
+   double *anc0 = NULL;  /* GRID coords at start of interpolation interval */
+   double *anc1 = NULL;  /* GRID coords at end of interpolation interval */
+   double *ancm = NULL;  /* GRID coords at mid point of interval */
+   double *pa0;          /* Pointer to next start GRID coord */
+   double *pa1;          /* Pointer to next end GRID coord */
+   double *ptmp;         /* Used to swap pointers */
+   double frac;          /* Fractional position within interval */
+   double pixsize;       /* Output pixel size in arc-seconds */
+   double tolpix;        /* Interpolation tolerance in output pixels */
+   dim_t ianc0;          /* Time slice at start of interpolation interval */
+   dim_t ianc1;          /* Time slice at end of interpolation interval */
+   dim_t imid;           /* Time slice at mid point of interval */
+   dim_t span;           /* Current maximum interval length */
+   int good1;            /* Is there a valid interval end? */
+   int goodm;            /* Is there a valid interval mid point? */
+   int interp;           /* Interpolate bolometer positions? */
    double *px;           /* Pointer to next output map X GRID coord */
    double *py;           /* Pointer to next output map Y GRID coord */
    double *pgx;          /* Pointer to next X output grid coords */
@@ -305,6 +358,28 @@ void smf_coords_lut( smfData *data, int tstep, dim_t itime_lo,
    for a single time slice. */
    outmapcoord = astMalloc( sizeof( *outmapcoord )*2*nbolo );
 
+/* If bolometer positions are to be interpolated, find the tolerance in
+   output pixels, and allocate memory to hold the grid coords at the ends
+   and mid point of each interpolation interval. The interval starts off
+   at its maximum length. */
+   interp = ( steptol > 0.0 && tstep > 1 );
+   tolpix = 0.0;
+   if( interp ) {
+      pixsize = smf1_coords_pixsize( abskyfrm, oskymap, olbnd, oubnd,
+                                     status );
+      if( pixsize != AST__BAD && pixsize > 0.0 ) {
+         tolpix = steptol/pixsize;
+         anc0 = astMalloc( sizeof( *anc0 )*2*nbolo );
+         anc1 = astMalloc( sizeof( *anc1 )*2*nbolo );
+         ancm = astMalloc( sizeof( *ancm )*2*nbolo );
+      } else {
+         interp = 0;
+      }
+   }
+   span = tstep;
+   ianc0 = ianc1 = itime_lo;
+   good1 = 0;
+
 /* Initialise boresight position for the benefit of the tstep == 1 case. */
    bsx = bsy = 0.0;
    bsx0 = bsy0 = AST__BAD;
@@ -372,8 +447,111 @@ void smf_coords_lut( smfData *data, int tstep, dim_t itime_lo,
          astTran2( bsmap, 1, xin, yin, 1, &bsx, &bsy );
       }
 
+/* If interpolating, and we have reached the end of the current
+   interpolation interval, start a new one at the current time slice.
+   Re-use the full calculation at the end of the previous interval if
+   possible. */
+      if( interp && ( itime == ianc1 || itime == itime_lo ) ) {
+         ianc0 = itime;
+         if( good1 && itime == ianc1 ) {
+            ptmp = anc0;
+            anc0 = anc1;
+            anc1 = ptmp;
+         } else {
+            good1 = smf1_coords_full( data, itime, abskyfrm, oskymap, moving,
+                                      fts_port, lbnd_in, ubnd_in, nbolo,
+                                      anc0, status );
+         }
+
+/* If there is no valid mapping for the current time slice, it gets bad
+   LUT values, and we try again at the next time slice. Otherwise, find
+   the end of the interval. Start with the longest allowed interval, and
+   halve it until the bolometer positions at the mid point can be
+   interpolated with the required accuracy. */
+         if( !good1 ) {
+            ianc1 = itime + 1;
+         } else {
+            ianc1 = itime + span;
+            if( ianc1 > itime_hi ) ianc1 = itime_hi;
+            good1 = 0;
+
+            while( ianc1 > itime && *status == SAI__OK ) {
+
+/* Do a full calculation at the end of the interval, unless we already
+   have one. If there is no valid mapping at the end, try a shorter
+   interval. */
+               if( !good1 ) {
+                  good1 = smf1_coords_full( data, ianc1, abskyfrm, oskymap,
+                                            moving, fts_port, lbnd_in,
+                                            ubnd_in, nbolo, anc1, status );
+               }
+               if( !good1 ) {
+                  ianc1 = itime + ( ianc1 - itime )/2;
+                  continue;
+               }
+
+/* An interval with no intermediate time slices is always accepted. So
+   is an interval for which interpolation reproduces the full calculation
+   at its mid point. */
+               if( ianc1 - itime < 2 ) break;
+               imid = ( itime + ianc1 )/2;
+               frac = (double)( imid - itime )/(double)( ianc1 - itime );
+               goodm = smf1_coords_full( data, imid, abskyfrm, oskymap,
+                                         moving, fts_port, lbnd_in, ubnd_in,
+                                         nbolo, ancm, status );
+               if( goodm && smf1_coords_check( anc0, anc1, ancm, frac, nbolo,
+                                               tolpix ) ) break;
+
+/* Otherwise, use the mid point as the end of a shorter interval. If
+   there is no valid mapping at the mid point, halve the interval again. */
+               if( goodm ) {
+                  ianc1 = imid;
+                  ptmp = anc1;
+                  anc1 = ancm;
+                  ancm = ptmp;
+               } else {
+                  ianc1 = itime + ( imid - itime )/2;
+                  good1 = 0;
+               }
+            }
+
+/* If no valid end point was found, just use the start point for the
+   current time slice, and start a new interval at the next one. */
+            if( !good1 ) ianc1 = itime + 1;
+
+/* Let the interval grow again if it was not shortened, or shrink to the
+   accepted length if it was. */
+            if( ianc1 - itime >= span ) {
+               span *= 2;
+               if( span > (dim_t) tstep ) span = tstep;
+            } else if( ianc1 > itime + 1 ) {
+               span = ianc1 - itime;
+            }
+         }
+      }
+
+/* When interpolating, get the GRID coords of every bolometer at the
+   current time slice by linear interpolation between the ends of the
+   interval. Time slices with no valid mapping get bad coords. */
+      if( interp ) {
+         px = outmapcoord;
+         pa0 = anc0;
+         pa1 = anc1;
+         if( itime == ianc0 ) {
+            memcpy( outmapcoord, anc0, sizeof( *outmapcoord )*2*nbolo );
+         } else if( good1 ) {
+            frac = (double)( itime - ianc0 )/(double)( ianc1 - ianc0 );
+            for( ibolo = 0; ibolo < 2*nbolo; ibolo++,px++,pa0++,pa1++ ) {
+               if( *pa0 != AST__BAD && *pa1 != AST__BAD ) {
+                  *px = *pa0 + frac*( *pa1 - *pa0 );
+               } else {
+                  *px = AST__BAD;
+               }
+            }
+         }
+
 /* If we have reached the next full calculation... */
-      if( itime == itime0 ) {
+      } else if( itime == itime0 ) {
 
 /* Calculate the full bolometer to map-pixel transformation for the current
    time slice */
@@ -405,9 +583,13 @@ void smf_coords_lut( smfData *data, int tstep, dim_t itime_lo,
 
 /* Get the offset from the boresight position at the previous full
    calculation and the current boresight position, in output map GRID
-   coords. */
-      dx = ( bsx != AST__BAD && bsx0 != AST__BAD ) ? bsx - bsx0 : AST__BAD;
-      dy = ( bsy != AST__BAD && bsy0 != AST__BAD ) ? bsy - bsy0 : AST__BAD;
+   coords. Interpolated coords are used as they are. */
+      if( interp ) {
+         dx = dy = 0.0;
+      } else {
+         dx = ( bsx != AST__BAD && bsx0 != AST__BAD ) ? bsx - bsx0 : AST__BAD;
+         dy = ( bsy != AST__BAD && bsy0 != AST__BAD ) ? bsy - bsy0 : AST__BAD;
+      }
 
 /* Work out the scan direction based on the GRID offsets between this and
    the previous time slice. Angles are calculated using atan2, with values
@@ -443,7 +625,8 @@ void smf_coords_lut( smfData *data, int tstep, dim_t itime_lo,
       for( ibolo = 0; ibolo < nbolo; ibolo++ ){
 
 /* If good, get the x and y output map GRID coords for this bolometer. */
-         if( dx != AST__BAD && dy != AST__BAD ) {
+         if( dx != AST__BAD && dy != AST__BAD && *px != AST__BAD &&
+             *py != AST__BAD ) {
             x = *(px++) + dx;
             y = *(py++) + dy;
 
@@ -516,6 +699,9 @@ void smf_coords_lut( smfData *data, int tstep, dim_t itime_lo,
 
 /* Free remaining work space. */
    outmapcoord = astFree( outmapcoord );
+   anc0 = astFree( anc0 );
+   anc1 = astFree( anc1 );
+   ancm = astFree( ancm );
    wgx = astFree( wgx );
    wgy = astFree( wgy );
 
@@ -528,4 +714,134 @@ void smf_coords_lut( smfData *data, int tstep, dim_t itime_lo,
    astEnd;
 }
 
+static int smf1_coords_full( smfData *data, dim_t itime,
+                             AstSkyFrame *abskyfrm, AstMapping *oskymap,
+                             int moving, fts2Port fts_port, int lbnd_in[ 2 ],
+                             int ubnd_in[ 2 ], dim_t nbolo, double *coords,
+                             int *status ){
+/*
+*  Name:
+*     smf1_coords_full
+
+*  Purpose:
+*     Do a full calculation of the output GRID coords of every bolometer.
+
+*  Description:
+*     The full bolometer to map-pixel transformation is found for the
+*     given time slice, and used to transform every bolometer position
+*     into output map GRID coords. These are stored in "coords" (all X
+*     values followed by all Y values). If no transformation can be
+*     found for the time slice, all coords are set bad and zero is
+*     returned. Otherwise one is returned.
+*/
+
+/* Local Variables: */
+   AstMapping *fullmap;
+   dim_t i;
+
+   if( *status != SAI__OK ) return 0;
+
+   fullmap = smf_rebin_totmap( data, itime, abskyfrm, oskymap, moving,
+                               fts_port, status );
+   if( fullmap ) {
+      astTranGrid( fullmap, 2, lbnd_in, ubnd_in, 0.1, 1000000, 1,
+                   2, nbolo, coords );
+      fullmap = astAnnul( fullmap );
+      return 1;
+   }
+
+   for( i = 0; i < 2*nbolo; i++ ) coords[ i ] = AST__BAD;
+   return 0;
+}
+
+static int smf1_coords_check( const double *coords0, const double *coords1,
+                              const double *coordsm, double frac,
+                              dim_t nbolo, double tolpix ){
+/*
+*  Name:
+*     smf1_coords_check
+
+*  Purpose:
+*     Check if bolometer positions can be interpolated accurately.
+
+*  Description:
+*     Returns one if interpolating the bolometer GRID coords "coords0"
+*     and "coords1" at fractional position "frac" reproduces the full
+*     calculation "coordsm" to within "tolpix" output pixels for every
+*     bolometer, and zero otherwise. A bolometer that has a bad position
+*     in some, but not all, of the arrays fails the test.
+*/
+
+/* Local Variables: */
+   const double *x0 = coords0;
+   const double *x1 = coords1;
+   const double *xm = coordsm;
+   const double *y0 = coords0 + nbolo;
+   const double *y1 = coords1 + nbolo;
+   const double *ym = coordsm + nbolo;
+   dim_t ibolo;
+   double dx;
+   double dy;
+   double tol2 = tolpix*tolpix;
+   int nbad;
+
+   for( ibolo = 0; ibolo < nbolo; ibolo++ ) {
+      nbad = ( x0[ ibolo ] == AST__BAD || y0[ ibolo ] == AST__BAD ) +
+             ( x1[ ibolo ] == AST__BAD || y1[ ibolo ] == AST__BAD ) +
+             ( xm[ ibolo ] == AST__BAD || ym[ ibolo ] == AST__BAD );
+      if( nbad == 0 ) {
+         dx = x0[ ibolo ] + frac*( x1[ ibolo ] - x0[ ibolo ] ) - xm[ ibolo ];
+         dy = y0[ ibolo ] + frac*( y1[ ibolo ] - y0[ ibolo ] ) - ym[ ibolo ];
+         if( dx*dx + dy*dy > tol2 ) return 0;
+      } else if( nbad < 3 ) {
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+static double smf1_coords_pixsize( AstSkyFrame *abskyfrm,
+                                   AstMapping *oskymap, int olbnd[ 2 ],
+                                   int oubnd[ 2 ], int *status ){
+/*
+*  Name:
+*     smf1_coords_pixsize
+
+*  Purpose:
+*     Find the size of an output map pixel in arc-seconds.
 
+*  Description:
+*     The distance between the centre of the output map and a point one
+*     pixel away along the first pixel axis is returned, or AST__BAD if
+*     it cannot be determined.
+*/
+
+/* Local Variables: */
+   double dist;
+   double p1[ 2 ];
+   double p2[ 2 ];
+   double xin[ 2 ];
+   double xout[ 2 ];
+   double yin[ 2 ];
+   double yout[ 2 ];
+
+   if( *status != SAI__OK ) return AST__BAD;
+
+/* Transform the two points from output PIXEL coords to output sky
+   coords. */
+   xin[ 0 ] = 0.5*( olbnd[ 0 ] + oubnd[ 0 ] ) - 0.5;
+   yin[ 0 ] = 0.5*( olbnd[ 1 ] + oubnd[ 1 ] ) - 0.5;
+   xin[ 1 ] = xin[ 0 ] + 1.0;
+   yin[ 1 ] = yin[ 0 ];
+   astTran2( oskymap, 2, xin, yin, 0, xout, yout );
+
+   p1[ 0 ] = xout[ 0 ];
+   p1[ 1 ] = yout[ 0 ];
+   p2[ 0 ] = xout[ 1 ];
+   p2[ 1 ] = yout[ 1 ];
+   dist = astDistance( abskyfrm, p1, p2 );
+
+   if( *status != SAI__OK || dist == AST__BAD ) return AST__BAD;
+   return dist*AST__DR2D*3600.0;
+}
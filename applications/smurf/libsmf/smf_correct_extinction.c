@@ -41,7 +41,8 @@
 *        tau (on the CSO scale) to the current filter. Must contain
 *        the "taurelation" key which itself will be a keymap
 *        containing the parameters for the specific filter. Currently
-*        only used if we are scaling from CSO or WVM.
+*        only used if we are scaling from CSO or WVM, or for the
+*        optional "GRIDTOL" key (see "Notes:").
 *     tau = double (Given)
 *        Optical depth at 225 GHz or filter wavelength. Only used if thetausrc is
 *        AUTO, TAU or CSOTAU. If the bad value is used a default value will be
@@ -83,6 +84,19 @@
 *     To speed up calculation an external CSO tau scale array may be provided. For example
 *     the tau calculated from the first subarray can be provided to the other 3 related
 *     subarrays.
+*
+*     If extpars contains a positive "GRIDTOL" value, then time slices that
+*     need a per-bolometer correction do not calculate the airmass and
+*     exponential for every bolometer. Instead, the correction factors
+*     are calculated exactly on a coarse grid of bolometers, and
+*     bilinear interpolation is used between the grid points. The grid
+*     starts with a spacing of SMF__EXTGRID bolometers. It is made
+*     finer until, at the centre of every grid cell, the interpolated
+*     correction factor is within a fraction GRIDTOL of the exact
+*     value. If the grid cannot be made fine enough, or any grid point
+*     has bad telescope data, the exact per-bolometer calculation is
+*     used for that time slice. The default (zero) always uses the exact
+*     calculation.
 
 *  Authors:
 *     Andy Gibb (UBC)
@@ -201,6 +215,9 @@
 *        Try WVM fit before CSO fit in AUTO mode.
 *     2019-03-18 (GSB):
 *        Check new ngood_pre_despike parameter from smf_calc_smoothedwvm.
+*     14-OCT-2026:
+*        Add the GRIDTOL option to interpolate per-bolometer corrections
+*        from a coarse grid.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -252,8 +269,15 @@
 
 /* internal prototype */
 static int is_large_delta_atau ( double airmass1, double elevation1, double tau, int *status);
+static int smf1_grid_extcorr( AstFrameSet *wcs, dim_t nx, dim_t ny, double tau,
+                              double tol, double **work, double *corr,
+                              int *status );
 static void smf1_correct_extinction( void *job_data_ptr, int *status );
 
+/* Initial spacing, in bolometers, of the grid of exact corrections used
+   when GRIDTOL is set. */
+#define SMF__EXTGRID 8
+
 /* Local data types */
 typedef struct smfCorrectExtinctionData {
    dim_t f1;
@@ -267,6 +291,7 @@ typedef struct smfCorrectExtinctionData {
    double *wvmtau;
    double amstart;
    double amfirst;
+   double gridtol;
    int *lbnd;
    int *ubnd;
    int isTordered;
@@ -294,6 +319,7 @@ int smf_correct_extinction(ThrWorkForce *wf, smfData *data, smf_tausrc *thetausr
   double amend = VAL__BADD;   /* Airmass at end */
   double elstart = VAL__BADD; /* Elevation at start (radians) */
   double elend = VAL__BADD;/* Elevation at end (radians) */
+  double gridtol = 0.0;    /* Tolerance for interpolated corrections */
   smfHead *hdr = NULL;     /* Pointer to full header struct */
   double *indata = NULL;   /* Pointer to data array */
   int isTordered;          /* data order of input data */
@@ -639,6 +665,10 @@ int smf_correct_extinction(ThrWorkForce *wf, smfData *data, smf_tausrc *thetausr
      since we need to free memory */
   if (*status != SAI__OK) goto CLEANUP;
 
+  /* See if per-bolometer corrections may be interpolated from a coarse
+     grid. */
+  if (extpars) astMapGet0D( extpars, "GRIDTOL", &gridtol );
+
   /* Array bounds for astTranGrid call */
   lbnd[0] = 1;
   lbnd[1] = 1;
@@ -682,6 +712,7 @@ int smf_correct_extinction(ThrWorkForce *wf, smfData *data, smf_tausrc *thetausr
       pdata->wvmtau = wvmtau;
       pdata->amstart = amstart;
       pdata->amfirst = amstart + ( amend - amstart )*pdata->f1/( nframes - 1 );
+      pdata->gridtol = gridtol;
       pdata->lbnd = lbnd;
       pdata->ubnd = ubnd;
       pdata->isTordered = isTordered;
@@ -766,21 +797,132 @@ static int is_large_delta_atau ( double airmass1, double elevation1, double tau,
   }
 }
 
+/* Fill "corr" with extinction corrections for all nx*ny bolometers,
+   interpolated bilinearly from exact corrections on a coarse grid of
+   bolometers (see the "Notes:" section of the prologue). "wcs" must
+   have AZEL as its current Frame. "*work" is work space that is
+   extended as needed and should be freed by the caller. Returns zero,
+   without changing "corr", if the corrections could not be found to the
+   requested tolerance, in which case they should be calculated for
+   every bolometer. */
+static int smf1_grid_extcorr( AstFrameSet *wcs, dim_t nx, dim_t ny, double tau,
+                              double tol, double **work, double *corr,
+                              int *status ) {
+  dim_t gx;                /* Number of grid points along x */
+  dim_t gy;                /* Number of grid points along y */
+  dim_t i;                 /* Loop counter */
+  dim_t ix;                /* Grid x index */
+  dim_t iy;                /* Grid y index */
+  dim_t ncell;             /* Number of grid cells */
+  dim_t nnode;             /* Number of grid points */
+  dim_t npos;              /* Number of positions to transform */
+  dim_t spacing;           /* Grid spacing in bolometers */
+  dim_t x;                 /* Bolometer x index (zero-based) */
+  dim_t y;                 /* Bolometer y index (zero-based) */
+  double *p;               /* Pointer to next corner value */
+  double *val;             /* Exact corrections at grid points and centres */
+  double *xin;             /* GRID x coords */
+  double *xout;            /* Azimuths */
+  double *yin;             /* GRID y coords */
+  double *yout;            /* Elevations */
+  double fx;               /* Fractional position within cell along x */
+  double fy;               /* Fractional position within cell along y */
+  double x0, x1;           /* GRID x coords at cell edges */
+  double y0, y1;           /* GRID y coords at cell edges */
+  int ok;                  /* Are all interpolated values within tol? */
 
+  if (*status != SAI__OK) return 0;
+  if (nx < 2 || ny < 2) return 0;
+
+/* Grid point i along an axis of n bolometers is at zero-based bolometer
+   index "i*spacing", except that the last point is always at "n-1". */
+#define GRIDPOS(i,n) ( ((i)*spacing < (n)-1) ? (i)*spacing : (n)-1 )
+
+  for (spacing = SMF__EXTGRID; spacing > 1; spacing /= 2) {
+    gx = (nx + spacing - 2)/spacing + 1;
+    gy = (ny + spacing - 2)/spacing + 1;
+    nnode = gx*gy;
+    ncell = (gx - 1)*(gy - 1);
+    npos = nnode + ncell;
+
+    /* Not worth it if the grid has nearly as many points as the array */
+    if (2*npos >= nx*ny) break;
+
+    *work = astGrow( *work, 5*npos, sizeof(**work) );
+    if (*status != SAI__OK) return 0;
+    xin = *work;
+    yin = xin + npos;
+    xout = yin + npos;
+    yout = xout + npos;
+    val = yout + npos;
+
+    /* GRID coords of the grid points, followed by the cell centres */
+    i = 0;
+    for (iy = 0; iy < gy; iy++) {
+      for (ix = 0; ix < gx; ix++) {
+        xin[i] = GRIDPOS(ix,nx) + 1.0;
+        yin[i++] = GRIDPOS(iy,ny) + 1.0;
+      }
+    }
+    for (iy = 0; iy < gy - 1; iy++) {
+      for (ix = 0; ix < gx - 1; ix++) {
+        xin[i] = 0.5*( GRIDPOS(ix,nx) + GRIDPOS(ix+1,nx) ) + 1.0;
+        yin[i++] = 0.5*( GRIDPOS(iy,ny) + GRIDPOS(iy+1,ny) ) + 1.0;
+      }
+    }
 
+    /* Exact corrections at all these positions */
+    astTran2( wcs, npos, xin, yin, 1, xout, yout );
+    if (!astOK) return 0;
+    for (i = 0; i < npos; i++) {
+      if (yout[i] == AST__BAD) return 0;
+      val[i] = exp( palAirmas( M_PI_2 - yout[i] )*tau );
+    }
 
+    /* Compare the mean of the four corners of each cell with the exact
+       value at its centre */
+    ok = 1;
+    i = nnode;
+    for (iy = 0; iy < gy - 1 && ok; iy++) {
+      for (ix = 0; ix < gx - 1; ix++, i++) {
+        p = val + iy*gx + ix;
+        if (fabs( 0.25*( p[0] + p[1] + p[gx] + p[gx+1] ) - val[i] ) >
+            tol*val[i]) {
+          ok = 0;
+          break;
+        }
+      }
+    }
 
+    /* Interpolate the corrections for every bolometer */
+    if (ok) {
+      for (y = 0; y < ny; y++) {
+        iy = y/spacing;
+        if (iy > gy - 2) iy = gy - 2;
+        y0 = GRIDPOS(iy,ny);
+        y1 = GRIDPOS(iy+1,ny);
+        fy = (y - y0)/(y1 - y0);
+
+        for (x = 0; x < nx; x++) {
+          ix = x/spacing;
+          if (ix > gx - 2) ix = gx - 2;
+          x0 = GRIDPOS(ix,nx);
+          x1 = GRIDPOS(ix+1,nx);
+          fx = (x - x0)/(x1 - x0);
+
+          p = val + iy*gx + ix;
+          corr[y*nx + x] = (1.0 - fy)*( (1.0 - fx)*p[0] + fx*p[1] ) +
+                           fy*( (1.0 - fx)*p[gx] + fx*p[gx+1] );
+        }
+      }
+      return 1;
+    }
+  }
 
+#undef GRIDPOS
 
-
-
-
-
-
-
-
-
-
+  return 0;
+}
 
 static void smf1_correct_extinction( void *job_data_ptr, int *status ) {
 /*
@@ -810,6 +952,9 @@ static void smf1_correct_extinction( void *job_data_ptr, int *status ) {
   double state_az_ac2;     /* Elevation read from header */
   double amprev;           /* Previous airmass in loop */
   double *azel = NULL;     /* AZEL coordinates */
+  double *corr = NULL;     /* Interpolated corrections for time slice */
+  double *gwork = NULL;    /* Work space for grid of exact corrections */
+  int gridded;             /* Are interpolated corrections in use? */
   size_t base;             /* Offset into 3d data array */
   double extcorr = 1.0;    /* Extinction correction factor */
   dim_t i;                 /* Loop counter */
@@ -829,6 +974,7 @@ static void smf1_correct_extinction( void *job_data_ptr, int *status ) {
   if (pdata->method == SMF__EXTMETH_FULL ||
       pdata->method == SMF__EXTMETH_ADAPT ) {
     azel = astMalloc( (2*pdata->npts)*sizeof(*azel) );
+    if (pdata->gridtol > 0.0) corr = astMalloc( pdata->npts*sizeof(*corr) );
   }
 
   amprev = pdata->amfirst;
@@ -840,6 +986,7 @@ static void smf1_correct_extinction( void *job_data_ptr, int *status ) {
     /* Flags to indicate which mode we are using for this time slice */
     int quick = 0;  /* use single airmass */
     int adaptive = 0; /* switch from quick to full if required */
+    gridded = 0;
     if (pdata->method == SMF__EXTMETH_SINGLE) {
       quick = 1;
     } else if (pdata->method == SMF__EXTMETH_ADAPT) {
@@ -945,9 +1092,17 @@ static void smf1_correct_extinction( void *job_data_ptr, int *status ) {
         if (strcmp(astGetC(wcs,"SYSTEM"), "AZEL") != 0) {
           astSet( wcs, "SYSTEM=AZEL"  );
         }
-        /* Transfrom from pixels to AZEL */
-        astTranGrid( wcs, 2, pdata->lbnd, pdata->ubnd, 0.1, 1000000, 1, 2,
-                     pdata->npts, azel );
+        /* Interpolate the corrections from a coarse grid if allowed,
+           otherwise transfrom from pixels to AZEL */
+        if (corr) {
+          gridded = smf1_grid_extcorr( wcs, pdata->ubnd[0], pdata->ubnd[1],
+                                       pdata->tau, pdata->gridtol, &gwork,
+                                       corr, status );
+        }
+        if (!gridded) {
+          astTranGrid( wcs, 2, pdata->lbnd, pdata->ubnd, 0.1, 1000000, 1, 2,
+                       pdata->npts, azel );
+        }
       } else {
         /* this time slice may have bad telescope data so we trap for this and re-enable
            "quick" with a default value. We'll only get here if airmass was good but
@@ -971,7 +1126,9 @@ static void smf1_correct_extinction( void *job_data_ptr, int *status ) {
         index = k + (pdata->nframes * i);
       }
 
-      if (!quick) {
+      if (gridded) {
+        extcorr = corr[i];
+      } else if (!quick) {
         if (pdata->tau != VAL__BADD) {
           double zd;
           zd = M_PI_2 - azel[pdata->npts+i];
@@ -1009,6 +1166,8 @@ static void smf1_correct_extinction( void *job_data_ptr, int *status ) {
   } /* End loop over timeslice */
 
   azel = astFree( azel );
+  corr = astFree( corr );
+  gwork = astFree( gwork );
 
 }
 
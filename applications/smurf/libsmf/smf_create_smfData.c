@@ -75,6 +75,10 @@
 *        Initialise qfamily element
 *     2010-09-17 (COBA):
 *        Add smfFts
+*     14-OCT-2026:
+*        Initialise the packed quality mask.
+*     14-OCT-2026:
+*        Initialise the index of good data spans.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -185,6 +189,9 @@ smf_create_smfData( int flags, int * status ) {
   }
 
   data->lut = NULL;
+  data->qmask = NULL;
+  data->qmaskbits = 0;
+  data->qspans = NULL;
   data->theta = NULL;
 
   return data;
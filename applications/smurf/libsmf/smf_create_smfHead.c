@@ -75,9 +75,14 @@
 *        Add ocsconfig.
 *     2010-03-15 (TIMJ):
 *        Initialise sequence type
+*     2026-10-14:
+*        Allocate an empty FITS keyword index.
+*     2026-10-14:
+*        Initialise stateshare.
 *     {enter_further_changes_here}
 
 *  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
 *     Copyright (C) 2008-2010 Science and Technology Facilities Council.
 *     Copyright (C) 2006-2007 Particle Physics and Astronomy Research
 *     Council.
@@ -142,6 +147,7 @@ smf_create_smfHead( int * status ) {
   hdr->wcs = NULL;
   hdr->tswcs = NULL;
   hdr->fitshdr = NULL;
+  hdr->fitsidx = astCalloc( 1, sizeof(*(hdr->fitsidx)) );
   hdr->cache1 = NULL;
   hdr->cache2 = NULL;
   hdr->cache3 = NULL;
@@ -149,6 +155,7 @@ smf_create_smfHead( int * status ) {
   hdr->nframes = 0;
   hdr->state = NULL;
   hdr->allState = NULL;
+  hdr->stateshare = NULL;
   hdr->ndet = 0;
   hdr->fplanex = NULL;
   hdr->fplaney = NULL;
@@ -136,6 +136,17 @@
 *     Note, the bounds of the spatial axes represent the union of the spatial
 *     coverage of each input NDF, but the bounds of the spectral axis
 *     represent either the intersection or union, as specified by "specunion".
+*
+*     If the SMURF_FOOTPRINTCACHE environment variable names a directory,
+*     the target is not moving and no spatial reference WCS is supplied,
+*     the sky footprint of each input file (the convex hull of the
+*     positions of all detector samples with good data) is stored in a
+*     file in that directory (see smf_footprint_name). When the same file
+*     is used again, only its headers are read, and its spatial bounds are
+*     found from the footprint vertices rather than from every detector
+*     sample. Since the output uses a tangent plane projection, which maps
+*     great circles onto straight lines, this gives the same bounds as
+*     the full calculation.
 
 *  Authors:
 *     David S Berry (JAC, UCLan)
@@ -234,6 +245,9 @@
 *        Use smf_set_moving to assign attributes for a moving target,
 *        rather than just setting SkyRefIs (smf_set_moving also sets
 *        AlignOffset).
+*     14-OCT-2026:
+*        Use and update the footprint cache specified by environment
+*        variable SMURF_FOOTPRINTCACHE.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -263,6 +277,7 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <math.h>
@@ -283,6 +298,11 @@
 
 #define FUNC_NAME "smf_cubebounds"
 
+/* Prototypes for local static functions. */
+static dim_t smf1_hull( dim_t npt, double *pts, double *hx, double *hy,
+                        int *status );
+static int smf1_cmp_point( const void *a, const void *b );
+
 void smf_cubebounds( Grp *igrp,  int size, AstSkyFrame *oskyframe,
                      int autogrid, int usedetpos, AstFrameSet *spacerefwcs,
                      AstFrameSet *specrefwcs, double par[ 7 ],
@@ -299,6 +319,7 @@ void smf_cubebounds( Grp *igrp,  int size, AstSkyFrame *oskyframe,
    AstFitsChan *fc = NULL;      /* FitsChan used to construct spectral WCS */
    AstFitsChan *fct = NULL;     /* FitsChan used to construct time slice WCS */
    AstFrame *abskyframe = NULL; /* Output SkyFrame (always absolute) */
+   AstSkyFrame *fpframe = NULL; /* SkyFrame used to identify cached footprints */
    AstFrame *ospecframe = NULL; /* Spectral Frame in output FrameSet */
    AstFrame *sf1 = NULL;        /* Pointer to copy of input current Frame */
    AstFrame *skyin = NULL;      /* Pointer to current Frame in input WCS FrameSet */
@@ -313,10 +334,19 @@ void smf_cubebounds( Grp *igrp,  int size, AstSkyFrame *oskyframe,
    AstMapping *ospecmap = NULL; /* Spec <> PIXEL mapping in output FrameSet */
    AstMapping *specmap = NULL;  /* PIXEL -> Spec mapping in input FrameSet */
    AstCmpMap *tmap = NULL;      /* Temporary Mapping */
+   char *pname;          /* Pointer to input file name buffer */
+   char fpname[ SMF_PATH_MAX + 1 ]; /* Footprint cache file name */
+   char ndfname[ GRP__SZNAM + 1 ]; /* Input file name */
    const char *name;     /* Pointer to current detector name */
+   dim_t ivert;          /* Index of current footprint vertex */
+   dim_t npt;            /* Number of good positions in current file */
+   dim_t nvert;          /* Number of footprint vertices */
    dim_t irec;           /* Index of current input detector */
    dim_t ispec;          /* Index of current spectral sample */
    dim_t itime;          /* Index of current time slice */
+   double *fplat = NULL; /* Latitude of each footprint vertex */
+   double *fplon = NULL; /* Longitude of each footprint vertex */
+   double *pts = NULL;   /* Good interim grid positions in current file */
    double *xin = NULL;   /* Workspace for detector input grid positions */
    double *xout = NULL;  /* Workspace for detector output pixel positions */
    double *yin = NULL;   /* Workspace for detector input grid positions */
@@ -335,6 +365,9 @@ void smf_cubebounds( Grp *igrp,  int size, AstSkyFrame *oskyframe,
    double temp;          /* Temporary storage used when swapping values */
    float *pdata;         /* Pointer to next data sample */
    int actval;           /* Number of parameter values supplied */
+   int cacheok;          /* Can footprints be cached? */
+   int fhasoffexp;       /* Any OFF_EXPOSURE values in current file? */
+   int fpolobs;          /* All current file polarisation data? */
    int found;            /* Was the detector name found in the supplied group? */
    int good;             /* Are there any good detector samples? */
    int ibasein;          /* Index of base Frame in input FrameSet */
@@ -344,9 +377,12 @@ void smf_cubebounds( Grp *igrp,  int size, AstSkyFrame *oskyframe,
    int lbnd0[ 2 ];       /* Defaults for LBND parameter */
    int nval;             /* Number of values supplied */
    int pixax[ 3 ];       /* The output fed by each selected mapping input */
+   int retry;            /* Repeat current file without the cache? */
    int specax;           /* Index of spectral axis in input FrameSet */
    int trim;             /* Trim borders of bad pixels from o/p cube? */
    int ubnd0[ 2 ];       /* Defaults for UBND parameter */
+   int usecache;         /* Was the current footprint read from the cache? */
+   int writecache;       /* Should the current footprint be cached? */
    smfBox *box;          /* Pointer to bounding box for next input file */
    smfData *data = NULL; /* Pointer to data struct for current input file */
    smfFile *file = NULL; /* Pointer to file struct for current input file */
@@ -395,6 +431,18 @@ void smf_cubebounds( Grp *igrp,  int size, AstSkyFrame *oskyframe,
 /* Assume for the moment that all data is polarisation data. */
    *polobs = 1;
 
+/* Footprints can be cached if the output uses absolute sky coords in
+   a tangent plane projection. Get a copy of the output SkyFrame that
+   identifies the absolute sky coords in which the footprints are
+   stored. */
+   cacheok = ( !moving && !spacerefwcs && getenv( SMF__FOOTPRINTCACHE ) );
+   if( cacheok ) {
+      fpframe = astCopy( oskyframe );
+      astClear( fpframe, "SkyRefIs" );
+      astClear( fpframe, "AlignOffset" );
+   }
+   retry = 0;
+
 /* Loop round all the input NDFs. */
    for( ifile = 1; ifile <= size && *status == SAI__OK; ifile++, box++ ) {
 
@@ -405,8 +453,28 @@ void smf_cubebounds( Grp *igrp,  int size, AstSkyFrame *oskyframe,
       box->ubnd[ 0 ] = VAL__MIND;
       box->ubnd[ 1 ] = VAL__MIND;
 
+/* See if the footprint of the current input NDF is available in the
+   footprint cache. If so, there is no need to access the data array. */
+      usecache = 0;
+      writecache = 0;
+      if( cacheok ) {
+         pname = ndfname;
+         grpGet( igrp, ifile, 1, &pname, sizeof( ndfname ), status );
+         writecache = smf_footprint_name( ndfname, fpframe, usedetpos,
+                                          detgrp, fpname, sizeof( fpname ),
+                                          status );
+         if( writecache && !retry ) {
+            usecache = smf_read_footprint( fpname, &nvert, &fplon, &fplat,
+                                           &fhasoffexp, &fpolobs, status );
+            if( usecache ) writecache = 0;
+         }
+      }
+      retry = 0;
+      npt = 0;
+
 /* Obtain information about the current input NDF. */
-      smf_open_file( NULL, igrp, ifile, "READ", 0, &data, status );
+      smf_open_file( NULL, igrp, ifile, "READ",
+                     usecache ? SMF__NOCREATE_DATA : 0, &data, status );
 
 /* Issue a suitable message and abort if anything went wrong. */
       if( *status != SAI__OK ) {
@@ -633,8 +701,16 @@ void smf_cubebounds( Grp *igrp,  int size, AstSkyFrame *oskyframe,
    then modify the spatial bounds of the output cube to accomodate it.
    This involves finding the spatial extent of each time slice in the
    input. Loop round all the time slices in the input file. */
+      if( !usecache ) {
+         fhasoffexp = 0;
+         fpolobs = 1;
+      }
       for( itime = 0; itime < (data->dims)[ 2 ] && *status == SAI__OK; itime++ ) {
 
+/* If the footprint was read from the cache, the time slices are only
+   needed to create the output WCS. */
+         if( usecache && *wcsout ) break;
+
 /* Get a FrameSet describing the spatial coordinate systems associated with
    the current time slice of the current input data file. The base frame in
    the FrameSet will be a 2D Frame in which axis 1 is detector number and
@@ -646,10 +722,16 @@ void smf_cubebounds( Grp *igrp,  int size, AstSkyFrame *oskyframe,
 
 /* Update the flag indicating if any OFF_EXPOSURE values are available in
    the input data. */
-         if( hdr->state->acs_offexposure != VAL__BADR ) *hasoffexp = 1;
+         if( hdr->state->acs_offexposure != VAL__BADR ) {
+            *hasoffexp = 1;
+            fhasoffexp = 1;
+         }
 
 /* Update the flag indicating if all input data is polarisation data. */
-         if( hdr->state->pol_ang == VAL__BADD ) *polobs = 0;
+         if( hdr->state->pol_ang == VAL__BADD ) {
+            *polobs = 0;
+            fpolobs = 0;
+         }
 
 /* Create an interim FrameSet describing the WCS to be associated with the
    output cube unless this has already be done. It is described as
@@ -796,6 +878,10 @@ void smf_cubebounds( Grp *igrp,  int size, AstSkyFrame *oskyframe,
             astInvert( ospecmap );
          }
 
+/* The remaining time slices are not needed if the footprint was read
+   from the cache. */
+         if( usecache ) break;
+
 /* Find out how to convert from input GRID coords (i.e. detector index) to
    the output sky frame. Note, we want absolute sky coords here, even if the
    target is moving. Record the original base frame before calling astConvert
@@ -876,6 +962,8 @@ void smf_cubebounds( Grp *igrp,  int size, AstSkyFrame *oskyframe,
    interim GRID coords. Then extend the bounds of the output cube on the
    spatial axes to accomodate the new positions. */
          astTran2( totmap, (data->dims)[ 1 ], xin, yin, 1, xout, yout );
+         if( writecache ) pts = astGrow( pts, 2*( npt + (data->dims)[ 1 ] ),
+                                         sizeof( *pts ) );
          for( irec = 0; irec < (data->dims)[ 1 ]; irec++ ) {
 
 /* If a group of detectors to be used was supplied, search the group for
@@ -915,6 +1003,12 @@ void smf_cubebounds( Grp *igrp,  int size, AstSkyFrame *oskyframe,
                   if( yout[ irec ] > dubnd[ 1 ] ) dubnd[ 1 ] = yout[ irec ];
                   if( yout[ irec ] < dlbnd[ 1 ] ) dlbnd[ 1 ] = yout[ irec ];
                   npos++;
+
+                  if( writecache && pts ) {
+                     pts[ 2*npt ] = xout[ irec ];
+                     pts[ 2*npt + 1 ] = yout[ irec ];
+                     npt++;
+                  }
                }
 
 /* If this detector is not included or does not have a valid position,
@@ -932,6 +1026,65 @@ void smf_cubebounds( Grp *igrp,  int size, AstSkyFrame *oskyframe,
          fsmap = astAnnul( fsmap );
       }
 
+/* If the footprint was read from the cache, transform its vertices into
+   output interim grid coords, and extend the bounding boxes to include
+   them. The footprint vertices include the extreme positions in any
+   tangent plane projection. If any vertex is too far from the tangent
+   point to be projected, repeat this file without using the cache. */
+      if( usecache && *wcsout && *status == SAI__OK ) {
+         if( nvert > 0 ) {
+            xout = astGrow( xout, nvert, sizeof( *xout ) );
+            yout = astGrow( yout, nvert, sizeof( *yout ) );
+            if( *status == SAI__OK ) {
+               astTran2( oskymap2, nvert, fplon, fplat, 1, xout, yout );
+               for( ivert = 0; ivert < nvert; ivert++ ) {
+                  if( xout[ ivert ] == AST__BAD || yout[ ivert ] == AST__BAD ) {
+                     retry = 1;
+                     break;
+                  }
+               }
+            }
+         }
+
+         if( !retry ) {
+            for( ivert = 0; ivert < nvert; ivert++ ) {
+               if( xout[ ivert ] > box->ubnd[ 0 ] ) box->ubnd[ 0 ] = xout[ ivert ];
+               if( xout[ ivert ] < box->lbnd[ 0 ] ) box->lbnd[ 0 ] = xout[ ivert ];
+               if( yout[ ivert ] > box->ubnd[ 1 ] ) box->ubnd[ 1 ] = yout[ ivert ];
+               if( yout[ ivert ] < box->lbnd[ 1 ] ) box->lbnd[ 1 ] = yout[ ivert ];
+
+               if( xout[ ivert ] > dubnd[ 0 ] ) dubnd[ 0 ] = xout[ ivert ];
+               if( xout[ ivert ] < dlbnd[ 0 ] ) dlbnd[ 0 ] = xout[ ivert ];
+               if( yout[ ivert ] > dubnd[ 1 ] ) dubnd[ 1 ] = yout[ ivert ];
+               if( yout[ ivert ] < dlbnd[ 1 ] ) dlbnd[ 1 ] = yout[ ivert ];
+            }
+            if( fhasoffexp ) *hasoffexp = 1;
+            if( !fpolobs ) *polobs = 0;
+         }
+
+/* Otherwise, if required, store the footprint of the current file in
+   the cache. The footprint is found in output interim grid coords, and
+   its vertices are then transformed to absolute sky coords. */
+      } else if( writecache && *wcsout && *status == SAI__OK ) {
+         fplon = astGrow( fplon, npt + 1, sizeof( *fplon ) );
+         fplat = astGrow( fplat, npt + 1, sizeof( *fplat ) );
+         xout = astGrow( xout, npt + 1, sizeof( *xout ) );
+         yout = astGrow( yout, npt + 1, sizeof( *yout ) );
+         nvert = smf1_hull( npt, pts, xout, yout, status );
+         if( *status == SAI__OK ) {
+            astTran2( oskymap2, nvert, xout, yout, 0, fplon, fplat );
+            for( ivert = 0; ivert < nvert; ivert++ ) {
+               if( fplon[ ivert ] == AST__BAD || fplat[ ivert ] == AST__BAD ) break;
+            }
+            if( ivert == nvert ) {
+               smf_write_footprint( fpname, nvert, fplon, fplat, fhasoffexp,
+                                    fpolobs, status );
+            }
+         }
+      }
+      fplon = astFree( fplon );
+      fplat = astFree( fplat );
+
 /* Close the current input data file. */
       smf_close_file( NULL, &data, status);
       data = NULL;
@@ -941,7 +1094,17 @@ void smf_cubebounds( Grp *igrp,  int size, AstSkyFrame *oskyframe,
       yin = astFree( yin );
       xout = astFree( xout );
       yout = astFree( yout );
+
+/* If the cached footprint could not be used, process the same file again
+   (the loop increments these values). */
+      if( retry ) {
+         ifile--;
+         box--;
+      }
    }
+   pts = astFree( pts );
+   fplon = astFree( fplon );
+   fplat = astFree( fplat );
 
 /* Close any data file that was left open due to an early exit from the
    above loop. */
@@ -1194,3 +1357,115 @@ void smf_cubebounds( Grp *igrp,  int size, AstSkyFrame *oskyframe,
    if( *status != SAI__OK ) errRep( FUNC_NAME, "Unable to determine cube "
                                     "bounds", status );
 }
+
+
+static dim_t smf1_hull( dim_t npt, double *pts, double *hx, double *hy,
+                        int *status ){
+/*
+*  Name:
+*     smf1_hull
+
+*  Purpose:
+*     Find the convex hull of a set of 2D positions.
+
+*  Invocation:
+*     dim_t smf1_hull( dim_t npt, double *pts, double *hx, double *hy,
+*                      int *status )
+
+*  Arguments:
+*     npt = dim_t (Given)
+*        The number of positions.
+*     pts = double * (Given and Returned)
+*        The positions, stored as (x,y) pairs. Returned sorted into
+*        increasing x (then y).
+*     hx = double * (Returned)
+*        The X coord at each vertex of the hull. Must have room for at
+*        least "npt" values.
+*     hy = double * (Returned)
+*        The Y coord at each vertex of the hull. Must have room for at
+*        least "npt" values.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*  Returned Value:
+*     The number of vertices in the hull.
+
+*  Description:
+*     The hull is found using the monotone chain algorithm, and its
+*     vertices are returned in anti-clockwise order. Positions that lie
+*     on an edge of the hull are not included as vertices.
+
+*/
+
+/* Local Variables: */
+   dim_t i;
+   dim_t k;
+   dim_t klo;
+   double *hull;
+
+/* Check inherited status */
+   if( *status != SAI__OK || npt == 0 ) return 0;
+
+/* A single position is its own hull. */
+   if( npt == 1 ) {
+      hx[ 0 ] = pts[ 0 ];
+      hy[ 0 ] = pts[ 1 ];
+      return 1;
+   }
+
+/* Sort the positions, and allocate work space for the hull (which may
+   temporarily contain up to twice as many vertices as there are
+   positions). */
+   qsort( pts, npt, 2*sizeof( *pts ), smf1_cmp_point );
+   hull = astMalloc( 4*npt*sizeof( *hull ) );
+   if( *status != SAI__OK ) return 0;
+
+/* Find the lower and then the upper chain, removing any vertex at which
+   the chain does not turn anti-clockwise. */
+#define CROSS(o,a,b) ( ( hull[ 2*(a) ] - hull[ 2*(o) ] )*( pts[ 2*(b) + 1 ] - hull[ 2*(o) + 1 ] ) - \
+                       ( hull[ 2*(a) + 1 ] - hull[ 2*(o) + 1 ] )*( pts[ 2*(b) ] - hull[ 2*(o) ] ) )
+   k = 0;
+   for( i = 0; i < npt; i++ ) {
+      while( k >= 2 && CROSS( k - 2, k - 1, i ) <= 0.0 ) k--;
+      hull[ 2*k ] = pts[ 2*i ];
+      hull[ 2*k + 1 ] = pts[ 2*i + 1 ];
+      k++;
+   }
+   klo = k + 1;
+   for( i = npt - 1; i-- > 0; ) {
+      while( k >= klo && CROSS( k - 2, k - 1, i ) <= 0.0 ) k--;
+      hull[ 2*k ] = pts[ 2*i ];
+      hull[ 2*k + 1 ] = pts[ 2*i + 1 ];
+      k++;
+   }
+#undef CROSS
+
+/* The last vertex is a repeat of the first. */
+   k--;
+   for( i = 0; i < k; i++ ) {
+      hx[ i ] = hull[ 2*i ];
+      hy[ i ] = hull[ 2*i + 1 ];
+   }
+
+   hull = astFree( hull );
+   return k;
+}
+
+static int smf1_cmp_point( const void *a, const void *b ){
+/*
+*  Name:
+*     smf1_cmp_point
+
+*  Purpose:
+*     Compare two (x,y) positions for qsort.
+
+*/
+   const double *pa = (const double *) a;
+   const double *pb = (const double *) b;
+
+   if( pa[ 0 ] < pb[ 0 ] ) return -1;
+   if( pa[ 0 ] > pb[ 0 ] ) return 1;
+   if( pa[ 1 ] < pb[ 1 ] ) return -1;
+   if( pa[ 1 ] > pb[ 1 ] ) return 1;
+   return 0;
+}
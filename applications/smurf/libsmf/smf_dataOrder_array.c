@@ -22,9 +22,7 @@
 
 *  Arguments:
 *     wf = ThrWorkForce * (Given)
-*        Pointer to a pool of worker threads (can be NULL). [Currently
-*        unused since using multiple threads slows down the algorithm
-*        rather than speeding it up.]
+*        Pointer to a pool of worker threads (can be NULL).
 *     oldbuf = void * (Given and Returned)
 *        Pointer to the data buffer to be re-ordered. Also contains the
 *        re-ordered data if inPlace=1
@@ -58,6 +56,19 @@
 *     workspace then either copy everything back into the supplied
 *     array and return it or free the memory (assumed to be malloced
 *     and not mmapped) and return the new workspace.
+*
+*     The re-ordering is done in square tiles of up to 128 time slices
+*     by 128 bolometers, so that both the values read from the old buffer
+*     and the values written to the new buffer stay in cache while each
+*     tile is processed. Large arrays are divided between the
+*     worker threads in "wf" by time slice.
+*
+*     If the data is being re-ordered in place, the old values are first
+*     copied into the workspace and then re-ordered from there directly
+*     into the supplied array. If there is only one time slice or only
+*     one bolometer, re-ordering does not change the positions of any
+*     values, so no workspace is needed and the supplied array is
+*     returned unchanged.
 
 *  Returned Value:
 *     newbuf = void *
@@ -83,6 +94,13 @@
 *        Add ability to typecast while copying (oldtype/newtype)
 *     2014-01-13 (DSB):
 *        Added multi-threading.
+*     14-OCT-2026:
+*        Re-order in cache-sized tiles, and re-enable multi-threading
+*        for large arrays (the tiles mean threads no longer contend for
+*        the same cache lines). Re-order in-place arrays directly from a
+*        copy rather than re-ordering into workspace and copying back, and
+*        skip re-ordering altogether if it would leave every value where
+*        it is.
 
 *  Notes:
 
@@ -145,43 +163,63 @@ typedef struct smfDataOrderArrayData {
 
 #define FUNC_NAME "smf_dataOrder_array"
 
-#define COPY1(Type) { \
-         Type *pout, *qout; \
-         Type *pin, *qin; \
+/* The number of time slices and bolometers in each tile, for data types
+   of more than two bytes. Tiles twice as large are used for smaller
+   types. */
+#define SMF__DOBLOCK 64
+
+/* The minimum number of values for which multiple threads are used. */
+#define SMF__DOMINTHR 262144
+
+/* Loop over all the tiles in the block of time slices assigned to the
+   thread. Within each tile, the inner loop runs over whichever axis is
+   contiguous in the output buffer, so that the writes are sequential.
+   "iin" and "iout" are set to the indices of each value in the input and
+   output buffers before executing the supplied statement. */
+#define TILE_LOOP(Statement) { \
+         size_t iin, iout; \
 \
-         qin = (Type *) pdata->oldbuf + itime1*tstr1; \
-         qout = (Type *) pdata->newbuf + itime1*tstr2; \
+         for( t0=itime1; t0<=itime2; t0+=block ) { \
+            t1 = t0 + block - 1; \
+            if( t1 > itime2 ) t1 = itime2; \
 \
-         for( itime=itime1; itime<=itime2; itime++ ) { \
-            pin = qin; \
-            pout = qout; \
-            for( ibolo=0; ibolo<nbolo; ibolo++ ) { \
-               *pout = *pin; \
-               pin += bstr1; \
-               pout += bstr2; \
+            for( b0=0; b0<nbolo; b0+=block ) { \
+               b1 = b0 + block - 1; \
+               if( b1 >= nbolo ) b1 = nbolo - 1; \
+\
+               if( tstr2 < bstr2 ) { \
+                  for( ibolo=b0; ibolo<=b1; ibolo++ ) { \
+                     iin = ibolo*bstr1 + t0*tstr1; \
+                     iout = ibolo*bstr2 + t0*tstr2; \
+                     for( itime=t0; itime<=t1; itime++ ) { \
+                        Statement; \
+                        iin += tstr1; \
+                        iout += tstr2; \
+                     } \
+                  } \
+               } else { \
+                  for( itime=t0; itime<=t1; itime++ ) { \
+                     iin = b0*bstr1 + itime*tstr1; \
+                     iout = b0*bstr2 + itime*tstr2; \
+                     for( ibolo=b0; ibolo<=b1; ibolo++ ) { \
+                        Statement; \
+                        iin += bstr1; \
+                        iout += bstr2; \
+                     } \
+                  } \
+               } \
             } \
-            qin += tstr1; \
-            qout += tstr2; \
          } }
 
+#define COPY1(Type) { \
+         Type *pout = (Type *) pdata->newbuf; \
+         Type *pin = (Type *) pdata->oldbuf; \
+         TILE_LOOP( pout[ iout ] = pin[ iin ] ) }
+
 #define COPY2(Type_in,Type_out,Bad_in,Bad_out) { \
-         Type_out *pout, *qout; \
-         Type_in *pin, *qin; \
-\
-         qin = (Type_in *) pdata->oldbuf + itime1*tstr1; \
-         qout = (Type_out *) pdata->newbuf + itime1*tstr2; \
-\
-         for( itime=itime1; itime<=itime2; itime++ ) { \
-            pin = qin; \
-            pout = qout; \
-            for( ibolo=0; ibolo<nbolo; ibolo++ ) { \
-               *pout = ( *pin != Bad_in ) ? *pin : Bad_out; \
-               pin += bstr1; \
-               pout += bstr2; \
-            } \
-            qin += tstr1; \
-            qout += tstr2; \
-         } }
+         Type_out *pout = (Type_out *) pdata->newbuf; \
+         Type_in *pin = (Type_in *) pdata->oldbuf; \
+         TILE_LOOP( pout[ iout ] = ( pin[ iin ] != Bad_in ) ? pin[ iin ] : Bad_out ) }
 
 
 void * smf_dataOrder_array( ThrWorkForce *wf, void * oldbuf, smf_dtype oldtype,
@@ -197,6 +235,8 @@ void * smf_dataOrder_array( ThrWorkForce *wf, void * oldbuf, smf_dtype oldtype,
   int nw;
   size_t step;
   int iw;
+  void *dstbuf = NULL;     /* Buffer to receive re-ordered values */
+  void *srcbuf = NULL;     /* Buffer holding values to be re-ordered */
 
   retval = oldbuf;
   if (*status != SAI__OK) return retval;
@@ -227,11 +267,21 @@ void * smf_dataOrder_array( ThrWorkForce *wf, void * oldbuf, smf_dtype oldtype,
     return retval;
   }
 
+  /* With a single time slice or a single bolometer, the re-ordered
+     array holds the values in the same places as the original array, so
+     there is nothing to do if the data is to be re-ordered in place. */
+  if ( inPlace && oldtype == newtype &&
+       ( ( ntslice <= 1 && bstr1 == bstr2 ) ||
+         ( nbolo <= 1 && tstr1 == tstr2 ) ) ) {
+    return retval;
+  }
+
   /* Size of data type */
   sznew = smf_dtype_sz(newtype, status);
 
-  /* Allocate buffer */
-  newbuf = astMalloc( ndata*sznew );
+  /* Allocate buffer. This may be a memory-mapped scratch file if
+     SMURF_SCRATCHDIR is set. */
+  newbuf = smf_scratch_malloc( NULL, ndata*sznew, 0, status );
 
   if( *status == SAI__OK ) {
 
@@ -243,20 +293,27 @@ void * smf_dataOrder_array( ThrWorkForce *wf, void * oldbuf, smf_dtype oldtype,
 
     } else {
 
-      /* We currently ignore any supplied WorkForce, since using multiple
-         threads slows down the re-ordered rather than speeding it up - I
-         presume because of contention issues. I've tried ensuring that
-         the output array is accessed sequenctially but that does not seem
-         to improve anything. Leave the mult-threaded infrastructure
-         here, in case a better solution is found. */
-      wf = NULL;
+      /* To re-order in place, take a copy of the old values and then
+         re-order them from the copy back into the supplied buffer. */
+      if( inPlace ) {
+        memcpy( newbuf, oldbuf, ndata*sznew );
+        srcbuf = newbuf;
+        dstbuf = oldbuf;
+      } else {
+        srcbuf = oldbuf;
+        dstbuf = newbuf;
+      }
 
-      /* How many threads do we get to play with */
-      nw = wf ? wf->nworker : 1;
+      /* How many threads do we get to play with? Small arrays are not
+         worth dividing up. */
+      nw = ( wf && ndata >= SMF__DOMINTHR ) ? wf->nworker : 1;
 
-      /* Find how many time slices to process in each worker thread. */
-      step = ntslice/nw;
-      if( ntslice == 0 ) step = 1;
+      /* Find how many time slices to process in each worker thread.
+         Make it a whole number of tiles so that threads do not write to
+         the same cache lines. */
+      step = ( ntslice/nw + 2*SMF__DOBLOCK - 1 )/( 2*SMF__DOBLOCK );
+      step *= 2*SMF__DOBLOCK;
+      if( step == 0 ) step = 2*SMF__DOBLOCK;
 
       /* Allocate job data for threads, and store common values. Ensure that
          the last thread picks up any left-over time slices.  Store the
@@ -273,6 +330,7 @@ void * smf_dataOrder_array( ThrWorkForce *wf, void * oldbuf, smf_dtype oldtype,
           } else {
             pdata->itime2 = ntslice - 1 ;
           }
+          if( pdata->itime2 >= ntslice ) pdata->itime2 = ntslice - 1;
 
           pdata->nbolo = nbolo;
           pdata->bstr1 = bstr1;
@@ -281,10 +339,12 @@ void * smf_dataOrder_array( ThrWorkForce *wf, void * oldbuf, smf_dtype oldtype,
           pdata->tstr2 = tstr2;
           pdata->newtype = newtype;
           pdata->oldtype = oldtype;
-          pdata->newbuf = newbuf;
-          pdata->oldbuf = oldbuf;
+          pdata->newbuf = dstbuf;
+          pdata->oldbuf = srcbuf;
 
-          thrAddJob( wf, 0, pdata, smf1_dataOrder_array, 0, NULL, status );
+          if( pdata->itime1 < ntslice ) {
+            thrAddJob( wf, 0, pdata, smf1_dataOrder_array, 0, NULL, status );
+          }
         }
 
         /* Wait for the jobs to complete. */
@@ -295,17 +355,15 @@ void * smf_dataOrder_array( ThrWorkForce *wf, void * oldbuf, smf_dtype oldtype,
     }
 
     if( inPlace ) {
-      /* Copy newbuf to oldbuf */
-      memcpy( oldbuf, newbuf, ndata*sznew );
-      /* Free newbuf */
-      newbuf = astFree( newbuf );
+      /* The re-ordered values are already in oldbuf, so free newbuf */
+      newbuf = smf_scratch_free( newbuf, status );
 
       retval = oldbuf;
     } else {
 
       if( freeOld ) {
         /* Free oldbuf */
-        oldbuf = astFree( oldbuf );
+        oldbuf = smf_scratch_free( oldbuf, status );
       }
 
       /* Set pntr to newbuf */
@@ -340,10 +398,15 @@ static void smf1_dataOrder_array( void *job_data_ptr, int *status ) {
 
 /* Local Variables: */
    SmfDataOrderArrayData *pdata;
+   dim_t b0;
+   dim_t b1;
    dim_t itime;
    dim_t ibolo;
    dim_t itime1;
    dim_t itime2;
+   dim_t block;
+   dim_t t0;
+   dim_t t1;
    size_t bstr1;
    size_t tstr1;
    size_t bstr2;
@@ -365,6 +428,10 @@ static void smf1_dataOrder_array( void *job_data_ptr, int *status ) {
    bstr2 = pdata->bstr2;
    tstr2 = pdata->tstr2;
 
+/* The tile size. */
+   block = ( smf_dtype_sz( pdata->oldtype, status ) > 2 ) ?
+           SMF__DOBLOCK : 2*SMF__DOBLOCK;
+
 /* Loop over all of the elements and re-order the data */
    switch( pdata->oldtype ) {
 
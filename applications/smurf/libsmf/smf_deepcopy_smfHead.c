@@ -76,9 +76,13 @@
 *        ocsconfig added to smfHead
 *     2010-03-15 (TIMJ):
 *        Include seqtype and obsidss.
+*     2026-10-14:
+*        Share the JCMTState array with the original header rather
+*        than copying it.
 *     {enter_further_changes_here}
 
 *  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
 *     Copyright (C) 2008-2010 Science and Technology Facilities Council.
 *     Copyright (C) 2006 Particle Physics and Astronomy Research
 *     Council. Copyright (C) 2006-2007 University of British Columbia.
@@ -129,6 +133,7 @@ smf_deepcopy_smfHead( const smfHead *old, int * status ) {
   dim_t nframes = 0;               /* Number of frames/time slices in data */
   dim_t curframe = 0;              /* Index of current time slice */
   JCMTState *allState = NULL;      /* Struct with all JCMTState entries */
+  smfStateShare *stateshare = NULL;/* Record of shared allState */
   AstFitsChan *fitshdr = NULL;     /* FITS header */
   AstFrameSet *tswcs = NULL;       /* Frameset for full time series (if tseries) */
   AstFrameSet *wcs = NULL;         /* Frameset for a particular time slice (frame)*/
@@ -162,16 +167,15 @@ smf_deepcopy_smfHead( const smfHead *old, int * status ) {
     instap[1] = old->instap[1];
   }
 
-  /* Only allocate space for allState if we have a non-NULL input
-     allState */
+  /* Share any allState with the old header rather than copying it. A
+     private copy is only made if one of the headers changes it (see
+     smf_state_own). */
   if ( old->allState != NULL) {
-    allState = astMalloc( nframes*sizeof(*allState) );
+    allState = smf_state_share( old, &stateshare, status );
     if ( allState == NULL) {
-      /* Status should be bad from astCalloc */
+      /* Status should be bad from astMalloc */
       if (*status == SAI__OK) *status = SAI__ERROR;
-      errRep(FUNC_NAME,"Unable to allocate memory for allState", status);
-    } else {
-      memcpy( allState, old->allState, nframes*sizeof(*allState) );
+      errRep(FUNC_NAME,"Unable to share memory for allState", status);
     }
   }
 
@@ -225,8 +229,12 @@ smf_deepcopy_smfHead( const smfHead *old, int * status ) {
                                tsys, old->title, old->dlabel, old->units,
                                old->telpos, ocsconfig, old->obsidss, status );
 
-  /* set isCloned to 0 since we have allocated this memory */
-  if (new) new->isCloned = 0;
+  /* set isCloned to 0 since we have allocated this memory (or hold a
+     reference to it) */
+  if (new) {
+    new->isCloned = 0;
+    new->stateshare = stateshare;
+  }
 
   /* let people know where things are going wrong */
   if (*status != SAI__OK) {
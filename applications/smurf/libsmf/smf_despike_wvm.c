@@ -48,6 +48,9 @@
 *        should not alter the results of this routine, but helps to avoid
 *        unneccesary floating point exceptions when using feenableexcept to
 *        track down other NaNs.
+*     14-OCT-2026:
+*        Use smf_runfilt to update the median as the box moves, instead
+*        of copying and sorting the whole box each time.
 
 *  Copyright:
 *     Copyright (C) 2016 East Asian Observatory.
@@ -78,18 +81,19 @@
 #include "smurf_par.h"
 
 #include <math.h>
-#include <gsl/gsl_sort.h>
 
 int smf_despike_wvm(double* data, int n, int width, double tol, int* status) {
     int i, j;
     int removed = 0;
-    double* box;
+    double* w1;
+    size_t* w2;
+    int* w3;
+    smfRunFilt box;
     int prev_box_start = -1;
     int box_start;
     int box_end;
     int max_box_start;
     int box_slop;
-    int box_n;
     int half_width;
     double median = 0;
 
@@ -105,9 +109,19 @@ int smf_despike_wvm(double* data, int n, int width, double tol, int* status) {
         return 0;
     }
 
-    /* Allocate temporary array for box in which we will calculate median. */
-    box = astMalloc(width * sizeof(*box));
-    if (!box) {
+    /* Allocate work arrays for the box in which we will calculate the
+       median, and initialise it to be empty.  Each data value is stored
+       in the slot given by its index modulo the box width, so moving the
+       box only requires the values that leave and enter it to be
+       removed and added. */
+    w1 = astMalloc(width * sizeof(*w1));
+    w2 = astMalloc(width * sizeof(*w2));
+    w3 = astMalloc(width * sizeof(*w3));
+    smf_runfilt_init(&box, SMF__FILT_MEDIAN, width, w1, w2, w3, status);
+    if (*status != SAI__OK) {
+        w1 = astFree(w1);
+        w2 = astFree(w2);
+        w3 = astFree(w3);
         return 0;
     }
 
@@ -130,21 +144,35 @@ int smf_despike_wvm(double* data, int n, int width, double tol, int* status) {
         /* If the box moved significantly, recalculate the median. */
         if ((prev_box_start == -1)
                 || (abs(box_start - prev_box_start) > box_slop)) {
-            prev_box_start = box_start;
             box_end = box_start + width;
-            box_n = 0;
-            for (j = box_start; j < box_end; j++) {
-                if (data[j] != VAL__BADD) {
-                    box[box_n ++] = data[j];
+
+            /* Remove the values which are no longer in the box (the box
+               only ever moves forwards), and add those which have
+               entered it. */
+            if (prev_box_start == -1) {
+                j = box_start;
+            }
+            else {
+                for (j = prev_box_start;
+                        j < box_start && j < prev_box_start + width; j++) {
+                    smf_runfilt_remove(&box, j % width, status);
                 }
+                j = prev_box_start + width;
+                if (j < box_start) {
+                    j = box_start;
+                }
+            }
+            for (; j < box_end; j++) {
+                smf_runfilt_add(&box, j % width, data[j], status);
             }
+            prev_box_start = box_start;
 
             /* Check we've got a resonable amount of data. */
-            if (box_n > half_width) {
-                /* (If there were an odd number of bad values, box_n may be
-                    even, in which case this isn't the true median.) */
-                gsl_sort(box, 1, box_n);
-                median = box[box_n / 2];
+            if (box.inbox > (dim_t) half_width) {
+                /* (If there were an odd number of bad values, the number
+                    of good values may be even, in which case this isn't
+                    the true median.) */
+                median = smf_runfilt_value(&box, 0, status);
             }
             else {
                 median = 0;
@@ -157,12 +185,21 @@ int smf_despike_wvm(double* data, int n, int width, double tol, int* status) {
             if (fabs(data[i] - median) / median > tol) {
                 data[i] = VAL__BADD;
                 removed ++;
+
+                /* The value is no longer good, so remove it from the box
+                   in case it is still there when the median is next
+                   calculated. */
+                if (i >= prev_box_start && i < prev_box_start + width) {
+                    smf_runfilt_remove(&box, i % width, status);
+                }
             }
         }
     }
 
-    /* Free the temporary array and return the number of points removed. */
-    astFree(box);
+    /* Free the work arrays and return the number of points removed. */
+    astFree(w1);
+    astFree(w2);
+    astFree(w3);
 
     return removed;
 }
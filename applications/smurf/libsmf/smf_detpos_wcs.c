@@ -88,12 +88,16 @@
 *        Add "dtai" argument.
 *     06-APR-2017 (GSB):
 *        Set dtai in skyframe if present.
+*     2026-10-14:
+*        Retain the cached PermMap between calls rather than annulling it
+*        after each use, so that only the time-varying LutMaps are
+*        created for each time slice.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2008, 2009 Science and Technology Facilities Council.
 *     Copyright (C) 2006 Particle Physics and Astronomy Research Council.
-*     Copyright (C) 2015-2017 East Asian Observatory.
+*     Copyright (C) 2015-2017, 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -238,7 +242,6 @@ smfDetposWcsCache *smf_detpos_wcs( smfHead *hdr, int index, double dut1,
          }
          map = (AstMapping *) astCmpMap( cache->pmap, cmap1, 1, " " );
 
-         cache->pmap = astAnnul( cache->pmap );
          cmap1 = astAnnul( cmap1 );
       }
 
@@ -845,7 +845,7 @@ void smf_diag( ThrWorkForce *wf, HDSLoc *loc, int *ibolo, int irow,
 
 /* Rebin the residual + astronomical signal into a map */
             smf_rebinmap1( wf, array->sdata[ idx ], noi, dat->lut[0]->sdata[idx]->pntr[0],
-                           0, 0, 0, NULL, 0, SMF__Q_GOOD, 1, rebinflags,
+                           0, 0, 0, NULL, 0, SMF__Q_GOOD, 1, rebinflags, 0,
                            wf_map, wf_mapwgt, wf_mapwgtsq, wf_hitsmap,
                            wf_mapvar, dat->msize, chunkfactor, &scalevar,
                            status );
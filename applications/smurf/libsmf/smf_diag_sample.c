@@ -0,0 +1,374 @@
+/*
+*+
+*  Name:
+*     smf_diag_sample
+
+*  Purpose:
+*     Record sampled time-stream diagnostics in a compact binary file
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     smf_diag_sample( AstKeyMap *kmap, smfDIMMData *dat, int chunk,
+*                      int where, smf_modeltype type, smfArray *model,
+*                      int res, int isub, int *status )
+
+*  Arguments:
+*     kmap = AstKeyMap * (Given)
+*        The KeyMap holding the DIAG config parameters. If NULL, any
+*        buffered samples are written out and the sample file is closed.
+*        This should be done once the iterative map-maker has finished.
+*     dat = smfDIMMData * (Given)
+*        Struct of pointers to information required by model calculation.
+*     chunk = int (Given)
+*        Index of the contiguous chunk of time-series data being processed.
+*     where = int (Given)
+*        Zero if called before the model is subtracted from the
+*        residuals, one if called afterwards.
+*     type = smf_modeltype (Given)
+*        Indicates which model is being calculated.
+*     model = smfArray * (Given)
+*        The model values. Ignored if "res" is non-zero, or if "type" is
+*        SMF__AST or SMF__RES.
+*     res = int (Given)
+*        If non-zero, sample the residuals rather than the model.
+*     isub = int (Given)
+*        The zero-based index of the subarray to sample.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     This function provides a low-overhead alternative to the full
+*     diagnostics written by smf_diag, intended to be left switched on
+*     in production reductions. It is used by smf_diagnostics if the
+*     config parameter DIAG.SAMPLE gives the name of a file. Each call
+*     copies the values of a few pre-selected bolometers (DIAG.SAMPLEBOLO,
+*     a list of up to SMF__DIAG_MAXBOLO zero-based bolometer indices)
+*     within a window of time slices (DIAG.SAMPLEWIN, a pair of
+*     zero-based time slice indices, defaulting to the whole chunk)
+*     into an in-memory buffer. No extra passes through the data are
+*     made and no HDS files are opened.
+*
+*     Two buffers are used, with a total size given by DIAG.SAMPLEBUF
+*     (in MiB, default 4). When one is full it is written to the file by
+*     a background thread while the other is filled, so the map-maker
+*     does not normally wait for the disk.
+*
+*     The file starts with the eight characters "SMFDIAG1", followed by
+*     one record for each sampled time stream. Each record is an
+*     SmfDiagSampleHead structure (in native byte order) followed by
+*     "nsamp" double precision values, flagged samples being set to
+*     VAL__BADD.
+
+*  Notes:
+*     - The AST model is sampled by looking up the current map at the
+*     position of each sample.
+*     - A model holding a single time stream (e.g. COM) is sampled at
+*     the requested time slices regardless of the requested bolometers.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     2026-10-14:
+*        Original version.
+*     {enter_further_changes_here}
+
+*     - Keyword names are compared without regard to case.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     2026-10-14:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sae_par.h"
+#include "mers.h"
+#include "prm_par.h"
+#include "star/thr.h"
+
+/* SMURF includes */
+#include "smf.h"
+#include "smf_typ.h"
+
+#define FUNC_NAME "smf_diag_sample"
+
+/* The header at the start of each record in the sample file. "where" is
+   0 for the residuals before subtraction of the model, 1 for the model
+   and 2 for the residuals after subtraction of the model. */
+typedef struct SmfDiagSampleHead {
+  char model[ 4 ];           /* Model name, padded with nulls */
+  int chunk;                 /* Continuous chunk index */
+  int iter;                  /* Iteration index */
+  int where;                 /* What the values are */
+  int bolo;                  /* Bolometer index */
+  int t1;                    /* Index of first time slice */
+  int nsamp;                 /* Number of samples that follow */
+} SmfDiagSampleHead;
+
+/* A buffer being written to the sample file by the background thread. */
+typedef struct SmfDiagSampleJob {
+  FILE *fd;
+  char *buf;
+  size_t nbyte;
+  int failed;
+} SmfDiagSampleJob;
+
+/* Prototypes for local static functions. */
+static void smf1_diag_sample_write( void *job_data_ptr, int *status );
+static void smf1_diag_sample_submit( int *status );
+
+/* The state of the sample file. This persists for the whole run. */
+static FILE *fd = NULL;
+static ThrWorkForce *wwf = NULL;
+static SmfDiagSampleJob job;
+static char *bufs[ 2 ] = { NULL, NULL };
+static size_t bufsize = 0;
+static size_t used = 0;
+static int active = 0;
+static int nbolo_samp = 0;
+static int bolos[ SMF__DIAG_MAXBOLO ];
+static int win[ 2 ];
+
+void smf_diag_sample( AstKeyMap *kmap, smfDIMMData *dat, int chunk,
+                      int where, smf_modeltype type, smfArray *model,
+                      int res, int isub, int *status ){
+
+/* Local Variables: */
+  SmfDiagSampleHead head;    /* Header for the current record */
+  const char *fname = NULL;  /* Name of sample file */
+  const char *modname;       /* Model name */
+  dim_t itime;               /* Time slice index */
+  dim_t nbolo;               /* Number of bolometers */
+  dim_t ntslice;             /* Number of time slices */
+  dim_t t1;                  /* First time slice to sample */
+  dim_t t2;                  /* Last time slice to sample */
+  char *pout;                /* Next value to store */
+  double mbuf;               /* Buffer size in MiB */
+  int *lut = NULL;           /* Pointing LUT for AST */
+  int ibolo;                 /* Index of sampled bolometer */
+  int lstatus = SAI__OK;     /* Local status */
+  int nwin;                  /* Number of window limits supplied */
+  size_t bstride;            /* Bolometer stride */
+  size_t reclen;             /* Length of record in bytes */
+  size_t tstride;            /* Time slice stride */
+  smfData *data = NULL;      /* Data to sample */
+  smf_qual_t *qual = NULL;   /* Quality for data */
+
+/* If no KeyMap was supplied, write out the remaining samples and close
+   the file. This is done even if an error has occurred. */
+  if( !kmap ) {
+    if( fd ) {
+      smf1_diag_sample_submit( &lstatus );
+      if( wwf ) thrWait( wwf, &lstatus );
+      if( job.failed && lstatus == SAI__OK ) {
+        lstatus = SAI__ERROR;
+        errRep( "", FUNC_NAME ": Failed to write sampled diagnostics.",
+                &lstatus );
+      }
+      if( fclose( fd ) != 0 && lstatus == SAI__OK ) {
+        lstatus = SAI__ERROR;
+        errRep( "", FUNC_NAME ": Failed to close the sampled diagnostics "
+                "file.", &lstatus );
+      }
+      fd = NULL;
+      wwf = thrDestroyWorkforce( wwf );
+      bufs[ 0 ] = astFree( bufs[ 0 ] );
+      bufs[ 1 ] = astFree( bufs[ 1 ] );
+      bufsize = 0;
+      used = 0;
+    }
+    if( lstatus != SAI__OK ) {
+      if( *status == SAI__OK ) {
+        *status = lstatus;
+      } else {
+        errAnnul( &lstatus );
+      }
+    }
+    return;
+  }
+
+/* Check inherited status, and that sampling is required. */
+  if( *status != SAI__OK ) return;
+  if( !astMapGet0C( kmap, "SAMPLE", &fname ) || !fname[ 0 ] ) return;
+
+/* On the first call, open the file, create the buffers and the writing
+   thread, and get the bolometers and time slices to sample. */
+  if( !fd ) {
+    nbolo_samp = 0;
+    astMapGet1I( kmap, "SAMPLEBOLO", SMF__DIAG_MAXBOLO, &nbolo_samp, bolos );
+    if( nbolo_samp == 0 && *status == SAI__OK ) {
+      *status = SAI__ERROR;
+      errRep( "", FUNC_NAME ": Config parameter DIAG.SAMPLEBOLO must be "
+              "set if DIAG.SAMPLE is set.", status );
+    }
+
+    win[ 0 ] = 0;
+    win[ 1 ] = -1;
+    if( astMapGet1I( kmap, "SAMPLEWIN", 2, &nwin, win ) && nwin != 2 &&
+        *status == SAI__OK ) {
+      *status = SAI__ERROR;
+      errRep( "", FUNC_NAME ": Config parameter DIAG.SAMPLEWIN must "
+              "contain two values.", status );
+    }
+
+    mbuf = 4.0;
+    astMapGet0D( kmap, "SAMPLEBUF", &mbuf );
+    bufsize = ( mbuf > 0.0 ) ? 0.5*mbuf*SMF__MIB : SMF__MIB;
+
+    if( *status != SAI__OK ) return;
+
+    fd = fopen( fname, "wb" );
+    if( !fd ) {
+      *status = SAI__ERROR;
+      errRepf( "", FUNC_NAME ": Failed to create sampled diagnostics file "
+               "'%s'.", status, fname );
+      return;
+    }
+    fwrite( "SMFDIAG1", 1, 8, fd );
+
+    bufs[ 0 ] = astMalloc( bufsize );
+    bufs[ 1 ] = astMalloc( bufsize );
+    wwf = thrCreateWorkforce( 1, status );
+    memset( &job, 0, sizeof( job ) );
+    used = 0;
+    active = 0;
+  }
+
+/* Get the smfData to sample. The AST model is looked up from the map
+   using the residuals' LUT. */
+  if( res || type == SMF__RES || type == SMF__AST ) {
+    data = dat->res[ 0 ]->sdata[ isub ];
+    qual = smf_select_qualpntr( dat->qua[ 0 ]->sdata[ isub ], NULL, status );
+    if( !res && type == SMF__AST ) {
+      if( !dat->mapok || !dat->map ) return;
+      lut = dat->lut[ 0 ]->sdata[ isub ]->pntr[ 0 ];
+    }
+  } else if( model ) {
+    data = model->sdata[ ( model->ndat == 1 ) ? 0 : isub ];
+    if( data ) qual = smf_select_qualpntr( data, NULL, status );
+  }
+  if( !data || *status != SAI__OK ) return;
+
+  smf_get_dims( data, NULL, NULL, &nbolo, &ntslice, NULL, &bstride,
+                &tstride, status );
+
+  t1 = ( win[ 0 ] > 0 ) ? win[ 0 ] : 0;
+  t2 = ( win[ 1 ] >= 0 && (dim_t) win[ 1 ] < ntslice ) ? (dim_t) win[ 1 ] :
+       ntslice - 1;
+  if( t1 > t2 || *status != SAI__OK ) return;
+
+/* Fill in the parts of the record header common to all bolometers. */
+  memset( &head, 0, sizeof( head ) );
+  modname = smf_model_getname( type, status );
+  if( modname ) strncpy( head.model, modname, sizeof( head.model ) );
+  head.chunk = chunk;
+  head.iter = dat->iter;
+  head.where = res ? ( where ? 2 : 0 ) : 1;
+  head.t1 = t1;
+  head.nsamp = t2 - t1 + 1;
+  reclen = sizeof( head ) + head.nsamp*sizeof( double );
+
+/* Add a record for each requested bolometer, passing full buffers to
+   the writing thread. */
+  for( ibolo = 0; ibolo < nbolo_samp && *status == SAI__OK; ibolo++ ) {
+    head.bolo = ( nbolo == 1 ) ? 0 : bolos[ ibolo ];
+    if( head.bolo < 0 || (dim_t) head.bolo >= nbolo ) continue;
+
+    if( used + reclen > bufsize ) smf1_diag_sample_submit( status );
+
+/* Ensure the buffer can hold the record, now that the background
+   thread has finished with it. */
+    if( reclen > bufsize ) {
+      if( wwf ) thrWait( wwf, status );
+      bufsize = reclen;
+      bufs[ 0 ] = astRealloc( bufs[ 0 ], bufsize );
+      bufs[ 1 ] = astRealloc( bufs[ 1 ], bufsize );
+    }
+    if( *status != SAI__OK ) break;
+
+    memcpy( bufs[ active ] + used, &head, sizeof( head ) );
+    pout = bufs[ active ] + used + sizeof( head );
+
+    for( itime = t1; itime <= t2; itime++ ) {
+      size_t i = head.bolo*bstride + itime*tstride;
+      double val;
+
+      if( qual && qual[ i ] != 0 ) {
+        val = VAL__BADD;
+      } else if( lut ) {
+        val = ( lut[ i ] != VAL__BADI ) ? dat->map[ lut[ i ] ] : VAL__BADD;
+      } else if( data->dtype == SMF__FLOAT ) {
+        float fval = ( (float *) data->pntr[ 0 ] )[ i ];
+        val = ( fval != VAL__BADR ) ? fval : VAL__BADD;
+      } else {
+        val = ( (double *) data->pntr[ 0 ] )[ i ];
+      }
+
+/* The record may not be aligned for doubles, so copy each value. */
+      memcpy( pout, &val, sizeof( val ) );
+      pout += sizeof( val );
+    }
+
+    used += reclen;
+  }
+}
+
+/* Wait for the background thread to finish writing the previous buffer
+   and then give it the current buffer to write. */
+static void smf1_diag_sample_submit( int *status ){
+  if( !fd || !wwf ) return;
+
+  thrWait( wwf, status );
+  if( used > 0 && *status == SAI__OK ) {
+    job.fd = fd;
+    job.buf = bufs[ active ];
+    job.nbyte = used;
+    thrAddJob( wwf, 0, &job, smf1_diag_sample_write, 0, NULL, status );
+    active = 1 - active;
+    used = 0;
+  }
+}
+
+/* Write a buffer to the sample file. Runs in the background thread. */
+static void smf1_diag_sample_write( void *job_data_ptr, int *status ){
+  SmfDiagSampleJob *pdata = (SmfDiagSampleJob *) job_data_ptr;
+  if( *status != SAI__OK ) return;
+  if( fwrite( pdata->buf, 1, pdata->nbyte, pdata->fd ) != pdata->nbyte ) {
+    pdata->failed = 1;
+  }
+}
@@ -139,6 +139,14 @@
 *        the last iteration. If zero, then diagnostics are created for
 *        all iterations.
 *
+*        SAMPLE - The name of a binary file in which to record the values
+*        of the bolometers listed by SAMPLEBOLO, within the range of time
+*        slices given by SAMPLEWIN, for the models specified by MODELS
+*        (and the residuals if RES_BEFORE or RES_AFTER is set). This is
+*        much cheaper than the full diagnostics selected by OUT, and
+*        is independent of them. See smf_diag_sample for details of
+*        SAMPLEBOLO, SAMPLEWIN, SAMPLEBUF and the file format.
+*
 *     allmodel = smfArray ** (Returned)
 *        Array of smfArrays holding the model. Only element zero is used.
 *        Should be NULL if the AST model is being dumped.
@@ -167,9 +175,11 @@
 *        Make the inclusion of data for a specific bolometer optional.
 *     10-APR-2018 (DSB):
 *        Added parameter "chunkfactor".
+*     2026-10-14:
+*        Added sampled diagnostics (DIAG.SAMPLE).
 
 *  Copyright:
-*     Copyright (C) 2018 East Asian Observatory.
+*     Copyright (C) 2018, 2026 East Asian Observatory.
 *     Copyright (C) 2013-2014 Science and Technology Facilities Council.
 *     All Rights Reserved.
 
@@ -272,6 +282,55 @@ void smf_diagnostics( ThrWorkForce *wf, int where, smfDIMMData *dat,
 /* See if diagnostics are to be created only for the final iteration. */
    astMapGet0I( kmap, "LASTONLY", &lastonly );
 
+/* If sampled diagnostics are required, record the selected bolometers
+   for each requested model (see smf_diag_sample). */
+   if( astMapGet0C( kmap, "SAMPLE", &cval ) &&
+       ( !lastonly || (flags & SMF__DIMM_LASTITER) ) ) {
+      nmodel = 0;
+      res_before = 0;
+      res_after = 0;
+      astMapGet1C( kmap, "MODELS", MODEL_NAMELEN, SMF_MODEL_MAX, &nmodel,
+                   modelnames );
+      astMapGet0I( kmap, "RES_BEFORE", &res_before );
+      astMapGet0I( kmap, "RES_AFTER", &res_after );
+
+      isub = 0;
+      if( astMapGet0C( kmap, "ARRAY", &cval ) ){
+         for( isub = 0; isub < nsub; isub++ ) {
+            smf_find_subarray( res->sdata[isub]->hdr, subarray,
+                               sizeof(subarray), NULL, status );
+            if( astChrMatch( subarray, cval ) ) break;
+         }
+
+         if( isub == nsub && *status == SAI__OK ) {
+            *status = SAI__ERROR;
+            errRepf( "", "Bad value \"%s\" supplied for config parameter "
+                     "DIAG.ARRAY - no data found for array %s.", status,
+                     cval, cval );
+         }
+      }
+
+      for( imodel = 0; imodel < nmodel && *status == SAI__OK; imodel++ ) {
+         model = smf_model_gettype( modelnames + imodel*MODEL_NAMELEN, status );
+         if( *status == SAI__OK && type == model ) {
+            if( where == 0 ) {
+               if( res_before && type != SMF__RES ) {
+                  smf_diag_sample( kmap, dat, chunk, 0, type, NULL, 1, isub,
+                                   status );
+               }
+            } else if( where == 1 ) {
+               smf_diag_sample( kmap, dat, chunk, 1, type,
+                                allmodel ? allmodel[ 0 ] : NULL, 0, isub,
+                                status );
+               if( res_after && type != SMF__RES ) {
+                  smf_diag_sample( kmap, dat, chunk, 1, type, NULL, 1, isub,
+                                   status );
+               }
+            }
+         }
+      }
+   }
+
 /* Get the name of the HDS container file in which to store the
    diagnostics info. Skip to the end if none is specified, or if
    diagnostics are not needed for this iteration. */
@@ -44,6 +44,11 @@
  *     .GRIDWTS and the inverse matrix as .INVMATX. Other relevant grid
  *     parameters are also stored in the file.
  *
+ *     If the SMURF_DREAMCG environment variable is set to a non-zero
+ *     integer the inverse matrix is not calculated or stored, and
+ *     smf_dreamsolve will then solve for the images iteratively. This
+ *     is much faster for large reconstruction grids.
+ *
  *     The routine currently returns with good status if the data are
  *     not from a DREAM observation, but returns with an error if the
  *     data are not in time series format.
@@ -80,9 +85,12 @@
  *        Use hdr->obsmode instead of SAM_MODE.
  *     2008-07-29 (TIMJ):
  *        Steptime is now in smfHead.
+ *     2026-10-14:
+ *        Omit the inverted matrix if SMURF_DREAMCG is set.
  *     {enter_further_changes_here}
 
  *  Copyright:
+ *     Copyright (C) 2026 East Asian Observatory.
  *     Copyright (C) 2008 Science and Technology Facilities Council.
  *     Copyright (C) 2006-2008 University of British Columbia. All
  *     Rights Reserved.
@@ -110,6 +118,7 @@
 
 /* Standard includes */
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* STARLINK includes */
@@ -146,6 +155,7 @@ void smf_dream_calcweights( smfData *data, const Grp *ogrp, const int index,
                             int *status) {
 
   /* Local Variables */
+  const char *cg = NULL;        /* Value of SMF__DREAMCG variable */
   int conv_shape = CONV__SINCTAP;/* Code for convolution function */
   double conv_sig = 1.0;        /* Convolution function parameter */
   smfDream *dream = NULL;       /* DREAM parameters obtained from input data file */
@@ -170,6 +180,7 @@ void smf_dream_calcweights( smfData *data, const Grp *ogrp, const int index,
   char subarray[SUB__MAXNAM+1]; /* Name of subarray */
   double tsamp;                 /* Sample/step time in seconds */
   int tvert;                    /* Time between vertices in ms (aka leg length) */
+  int usecg;                    /* Omit the inverted matrix? */
   int windext[4];               /* Size of the window for constructing a DREAM image */
 
   if ( *status != SAI__OK) return;
@@ -206,12 +217,23 @@ void smf_dream_calcweights( smfData *data, const Grp *ogrp, const int index,
       qual = astCalloc( qualdim[0]*qualdim[1], sizeof(int) );
 
 
+      /* The inverted matrix is not needed if the images are to be
+         solved iteratively, and its size and the time it takes grow
+         rapidly with the size of the reconstruction grid. */
+      cg = getenv( SMF__DREAMCG );
+      usecg = ( cg && atoi( cg ) );
+      if ( usecg ) {
+        msgOutif( MSG__VERB, " ", "Omitting the inverted matrix from the "
+                  "weights file", status );
+      }
+
       sc2math_calcmapwt( subarray, nbolx, nboly,
                          qual, conv_shape, conv_sig, gridstep,
                          dream->nvert, tvert, tsamp,
                          dream->jigvert, dream->jigscal, dream->jigscal, smu_move,
                          smu_offset, ngrid, gridpts, &(gridwtsdim[0]), &gridwts,
-                         &invmatdim, &invmat, status);
+                         &invmatdim, usecg ? NULL : &invmat,
+                         status);
 
       /* Dummy definition of window - this must be derived somehow TBD */
       windext[0] = 0;
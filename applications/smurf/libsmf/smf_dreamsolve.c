@@ -28,6 +28,15 @@
  *     must have been flatfielded prior to calling this routine. If
  *     called with raw data an error will be issued and the routine
  *     will immediately return to the caller.
+ *
+ *     The images are solved in parallel, each thread of the SMURF
+ *     workforce reconstructing a block of consecutive cycles, and are
+ *     then written out in order. Each image is found with the inverted
+ *     matrix from the weights file, unless the file has no inverted
+ *     matrix or the SMURF_DREAMCG environment variable is set to a
+ *     non-zero integer, in which case the normal equations are solved
+ *     iteratively by sc2math_mapsolvecg. The solution for one cycle is
+ *     used as the starting point for the next.
 
  *  Notes:
  *     - *** No FITS (sub)headers are yet written for the images ***
@@ -54,9 +63,13 @@
  *        Use hdr->obsmode instead of SAM_MODE.
  *     2008-07-25 (AGG):
  *        Partial update to use sc2math routines
+ *     2026-10-14:
+ *        Solve the cycles in parallel, and solve iteratively if requested
+ *        or if the weights file has no inverted matrix.
  *     {enter_further_changes_here}
 
  *  Copyright:
+ *     Copyright (C) 2026 East Asian Observatory.
  *     Copyright (C) 2008 Science and Technology Facilities Council.
  *     Copyright (C) 2006-2008 University of British Columbia. All
  *     Rights Reserved.
@@ -98,6 +111,7 @@
 #include "star/hds.h"
 #include "star/ndg.h"
 #include "star/grp.h"
+#include "star/thr.h"
 
 /* SMURF includes */
 #include "smurf_par.h"
@@ -114,11 +128,45 @@
 
 #define FUNC_NAME "smf_dreamsolve"
 
+/* The number of consecutive cycles solved by each thread at a time */
+#define SMF__DREAMBLOCK 16
+
+/* Structure containing information about the cycles to be solved by
+   each thread. */
+typedef struct smfDreamSolveData {
+  int c1;                          /* Index of first cycle to solve */
+  int c2;                          /* Index of last cycle to solve */
+  int nsampcycle;                  /* Number of samples per DREAM cycle */
+  int ncycles;                     /* Number of DREAM cycles in data stream */
+  int nbolx;                       /* Number of bolometers in X */
+  int nboly;                       /* Number of bolometers in Y */
+  int *gridext;                    /* Grid min/max X/Y extent */
+  double gridstep;                 /* Size of grid step in arcsec */
+  int *jigext;                     /* SMU pattern extents */
+  double jigscal;                  /* Size of SMU step in arcsec */
+  double *interpwt;                /* Interpolation weights */
+  double *invmat;                  /* Inverted matrix, NULL to iterate */
+  int *qual;                       /* Bolometer quality array */
+  double *tstream;                 /* Time series data */
+  int maxmap;                      /* Maximum size of output DREAM image */
+  double *psbuf;                   /* Data for a single cycle */
+  double *sint;                    /* All unknowns of the iterative solution */
+  double *map;                     /* Images for cycles c1 to c2 */
+  double *pbolzero;                /* Bolometer zero points for c1 to c2 */
+  int dims[2];                     /* Dimensions of output image */
+  int niter;                       /* Number of iterations used */
+} smfDreamSolveData;
+
+/* Prototypes for local functions */
+static void smf1_dreamsolve( void *job_data_ptr, int *status );
+
 void smf_dreamsolve( smfData *data, int *status ) {
 
   /* Local variables */
+  int actbol;                      /* Number of working bolometers */
+  char *cg = NULL;                 /* Value of SMF__DREAMCG variable */
   int cycle;                       /* Cycle counter */
-  int dims[2];                     /* Dimensions of output image */
+  int cycle1;                      /* First cycle in current batch */
   smfDream *dream = NULL;          /* DREAM parameters */
   HDSLoc *drmloc;                  /* Locator to DEAM extension */
   char drmwghts[SZFITSTR];         /* Name of DREAM weights file */
@@ -128,26 +176,32 @@ void smf_dreamsolve( smfData *data, int *status ) {
   smfHead *hdr = NULL;             /* Header information for input data */
   double *interpwt = NULL;         /* Interpolation weights */
   double *invmat = NULL;           /* Inverted matrix */
+  int i;                           /* Loop counter */
+  int iworker;                     /* Worker index */
+  smfDreamSolveData *job_data = NULL; /* Per-thread job descriptions */
   int lbnd[2];                     /* Lower bounds */
   int nbol;                        /* Total number of bolometers */
+  int nbatch;                      /* Number of cycles solved at once */
   int ncycles;                     /* Number of DREAM cycles in data stream */
   size_t nelem;                    /* Total number of points */
   int ngrid;                       /* Number of grid points in output map */
   int nimages;                     /* Number of images to write to output file */
   int nframes;                     /* Number of time samples */
   int npts;                        /* Total number of points (int version) */
+  int niter;                       /* Total number of iterations */
   int nsampcycle;                  /* Number of samples per DREAM cycle */
+  int nunkno;                      /* Number of unknowns in solution */
+  int nworker;                     /* Number of worker threads */
   smfFile *ofile;                  /* Output file information */
-  double *pbolzero = NULL;         /* Bolometer zero points */
-  double *psbuf = NULL;            /* */
+  smfDreamSolveData *pdata = NULL; /* Pointer to a single job description */
   HDSLoc *scu2redloc = NULL;       /* Locator to SCU2RED extension */
   double *tstream = NULL;          /* Pointer to time series data */
+  ThrWorkForce *wf = NULL;         /* Pointer to a pool of worker threads */
   int ubnd[2];                     /* Upper bounds */
   int naver;                       /* Temporary value... */
   int jigext[4] = { -1, 1, -1, 1 };/* Table of SMU pattern extents for a
                                       single bolometer */
   int *qual = NULL;                /* True/false `quality' array (not NDF quality) */
-  double *map = NULL;              /* Pointer to output DREAM image */
   int maxmap = 2400;               /* Maximum size of output DREAM image */
 
   if ( *status != SAI__OK ) return;
@@ -195,12 +249,19 @@ void smf_dreamsolve( smfData *data, int *status ) {
     /* HACK - DEFINE!! */
     qual = astCalloc( nbol, sizeof(int) );
 
-    /* Pointers to the weights arrays. If either of these are NULL
-       then it means we were not able to find the weights file */
+    /* Pointers to the weights arrays. If the grid weights are NULL
+       then it means we were not able to find the weights file. The
+       inverted matrix is omitted from files made for the iterative
+       solution. */
     interpwt = dream->gridwts;
     invmat = dream->invmatx;
 
-    if ( interpwt == NULL || invmat == NULL ) {
+    /* The inverted matrix is not needed if the images are solved
+       iteratively */
+    cg = getenv( SMF__DREAMCG );
+    if ( cg && atoi( cg ) ) invmat = NULL;
+
+    if ( interpwt == NULL ) {
       if ( *status == SAI__OK ) {
         smf_fits_getS( data->hdr, "DRMWGHTS", drmwghts, sizeof(drmwghts),
                        status );
@@ -234,21 +295,42 @@ void smf_dreamsolve( smfData *data, int *status ) {
     scu2redloc = smf_get_xloc(data, "SCU2RED", "SCUBA2_MAP_ARR", "WRITE",
                               0, NULL, status);
 
-    /* Allocate memory for resources */
-    psbuf = astCalloc( (size_t)(nsampcycle * nbol), sizeof(double) );
-    if ( *status == SMF__NOMEM ) {
-      *status = SAI__ERROR;
-      errRep(FUNC_NAME, "Unable to allocate memory for psbuf", status);
+    /* Number of unknowns in the solution: the working bolometers and
+       the sky grid, as in sc2math_mapsolve */
+    actbol = 0;
+    for ( i=0; i<nbol && qual; i++ ) {
+      if ( qual[i] == 0 ) actbol++;
     }
-    pbolzero = astCalloc( (size_t)nbol, sizeof(double) );
-    if ( *status == SMF__NOMEM ) {
-      *status = SAI__ERROR;
-      errRep(FUNC_NAME, "Unable to allocate memory for polzero", status);
+    nunkno = actbol;
+    if ( *status == SAI__OK ) {
+      nunkno += ( (data->dims)[0] + gridext[1] - gridext[0] ) *
+        ( (data->dims)[1] + gridext[3] - gridext[2] );
     }
-    map = astCalloc( (size_t)maxmap, sizeof(double) );
-    if ( *status == SMF__NOMEM ) {
-      *status = SAI__ERROR;
-      errRep(FUNC_NAME, "Unable to allocate memory for map", status);
+
+    /* Get a pointer to a pool of worker threads, and allocate the
+       resources needed by each thread */
+    wf = thrGetWorkforce( thrGetNThread( SMF__THREADS, status ), status );
+    nworker = wf ? wf->nworker : 1;
+    nbatch = nworker * SMF__DREAMBLOCK;
+    job_data = astCalloc( nworker, sizeof(*job_data) );
+    if ( *status == SAI__OK ) {
+      for ( iworker=0; iworker<nworker; iworker++ ) {
+        pdata = job_data + iworker;
+        pdata->psbuf = astCalloc( (size_t)(nsampcycle * nbol),
+                                  sizeof(*(pdata->psbuf)) );
+        pdata->map = astCalloc( (size_t)(SMF__DREAMBLOCK * maxmap),
+                                sizeof(*(pdata->map)) );
+        pdata->pbolzero = astCalloc( (size_t)(SMF__DREAMBLOCK * nbol),
+                                     sizeof(*(pdata->pbolzero)) );
+        if ( !invmat ) {
+          pdata->sint = astCalloc( (size_t)nunkno, sizeof(*(pdata->sint)) );
+        }
+      }
+      if ( *status == SMF__NOMEM ) {
+        *status = SAI__ERROR;
+        errRep(FUNC_NAME, "Unable to allocate memory for DREAM solution",
+               status);
+      }
     }
 
     /* Loop over the number of DREAM cycles */
@@ -262,23 +344,74 @@ void smf_dreamsolve( smfData *data, int *status ) {
         smf_average_dataD( data, 0, naver, nsampcycle, &tstream, &nelem, status );
       }
 
-      /* Loop over number of images to solve for and store */
+      if ( !invmat ) {
+        msgOutif(MSG__VERB," ", "Solving DREAM images iteratively", status);
+      }
+
+      /* Loop over the images to solve for and store, a batch at a
+         time. Within a batch each thread solves a block of consecutive
+         cycles. */
       nimages = ncycles/naver;
-      for ( cycle=0; cycle<nimages; cycle++ ) {
-        /* Extract the raw data of a cycle. */
-        sc2math_get_cycle ( cycle, nsampcycle, ncycles, nbol,
-                            tstream, psbuf, status );
-
-        sc2math_mapsolve( nsampcycle, (data->dims)[0], (data->dims)[1], gridext,
-                          dream->gridstep, jigext, dream->jigscal, interpwt,
-                          invmat, qual, psbuf, maxmap, dims, map, pbolzero,
-                          status );
-
-        /* Write the image and bolometer zero offsets */
-        smf_store_image( data, scu2redloc, cycle, 2, dims, nsampcycle,
-                         0, 0, map, pbolzero, status );
+      niter = 0;
+      for ( cycle1=0; cycle1<nimages && *status == SAI__OK;
+            cycle1 += nbatch ) {
+        for ( iworker=0; iworker<nworker; iworker++ ) {
+          pdata = job_data + iworker;
+          pdata->c1 = cycle1 + iworker * SMF__DREAMBLOCK;
+          pdata->c2 = pdata->c1 + SMF__DREAMBLOCK - 1;
+          if ( pdata->c2 >= nimages ) pdata->c2 = nimages - 1;
+          pdata->nsampcycle = nsampcycle;
+          pdata->ncycles = ncycles;
+          pdata->nbolx = (data->dims)[0];
+          pdata->nboly = (data->dims)[1];
+          pdata->gridext = gridext;
+          pdata->gridstep = dream->gridstep;
+          pdata->jigext = jigext;
+          pdata->jigscal = dream->jigscal;
+          pdata->interpwt = interpwt;
+          pdata->invmat = invmat;
+          pdata->qual = qual;
+          pdata->tstream = tstream;
+          pdata->maxmap = maxmap;
+          pdata->niter = 0;
+          if ( pdata->c1 < nimages ) {
+            thrAddJob( wf, 0, pdata, smf1_dreamsolve, 0, NULL, status );
+          }
+        }
+        thrWait( wf, status );
+
+        /* Write the images and bolometer zero offsets in order */
+        for ( iworker=0; iworker<nworker; iworker++ ) {
+          pdata = job_data + iworker;
+          niter += pdata->niter;
+          for ( cycle=pdata->c1; cycle<=pdata->c2; cycle++ ) {
+            smf_store_image( data, scu2redloc, cycle, 2, pdata->dims,
+                             nsampcycle, 0, 0,
+                             pdata->map + (cycle - pdata->c1) * maxmap,
+                             pdata->pbolzero + (cycle - pdata->c1) * nbol,
+                             status );
+          }
+        }
       } /* End loop over cycle */
+
+      if ( !invmat && nimages > 0 ) {
+        msgOutiff(MSG__DEBUG, " ", "Used an average of %.1f iterations "
+                  "per DREAM image", status, (double)niter/(double)nimages );
+      }
     }
+
+    /* Free the thread resources */
+    if ( job_data ) {
+      for ( iworker=0; iworker<nworker; iworker++ ) {
+        pdata = job_data + iworker;
+        pdata->psbuf = astFree( pdata->psbuf );
+        pdata->map = astFree( pdata->map );
+        pdata->pbolzero = astFree( pdata->pbolzero );
+        pdata->sint = astFree( pdata->sint );
+      }
+      job_data = astFree( job_data );
+    }
+    qual = astFree( qual );
     /* Add a history entry if everything's OK */
     smf_history_add(data, "smf_dreamsolve", status);
 
@@ -292,3 +425,46 @@ void smf_dreamsolve( smfData *data, int *status ) {
   }
 }
 
+/* Function to be executed in a worker thread. It reconstructs the images
+   for cycles c1 to c2, either with the inverted matrix or iteratively
+   starting from the previous solution found by this thread. */
+static void smf1_dreamsolve( void *job_data_ptr, int *status ) {
+
+  int cycle;                       /* Cycle counter */
+  int nbol;                        /* Total number of bolometers */
+  int niter;                       /* Number of iterations for one cycle */
+  smfDreamSolveData *pdata;        /* Job description */
+
+  if ( *status != SAI__OK ) return;
+
+  pdata = (smfDreamSolveData *) job_data_ptr;
+  nbol = pdata->nbolx * pdata->nboly;
+
+  for ( cycle=pdata->c1; cycle<=pdata->c2 && *status == SAI__OK; cycle++ ) {
+    /* Extract the raw data of a cycle. */
+    sc2math_get_cycle ( cycle, pdata->nsampcycle, pdata->ncycles, nbol,
+                        pdata->tstream, pdata->psbuf, status );
+
+    if ( pdata->invmat ) {
+      sc2math_mapsolve( pdata->nsampcycle, pdata->nbolx, pdata->nboly,
+                        pdata->gridext, pdata->gridstep, pdata->jigext,
+                        pdata->jigscal, pdata->interpwt, pdata->invmat,
+                        pdata->qual, pdata->psbuf, pdata->maxmap,
+                        pdata->dims,
+                        pdata->map + (cycle - pdata->c1) * pdata->maxmap,
+                        pdata->pbolzero + (cycle - pdata->c1) * nbol,
+                        status );
+    } else {
+      sc2math_mapsolvecg( pdata->nsampcycle, pdata->nbolx, pdata->nboly,
+                          pdata->gridext, pdata->gridstep, pdata->jigext,
+                          pdata->jigscal, pdata->interpwt, pdata->qual,
+                          pdata->psbuf, SMF__DREAMCG_MAXITER,
+                          SMF__DREAMCG_TOL, pdata->sint, pdata->maxmap,
+                          pdata->dims,
+                          pdata->map + (cycle - pdata->c1) * pdata->maxmap,
+                          pdata->pbolzero + (cycle - pdata->c1) * nbol,
+                          &niter, status );
+      pdata->niter += niter;
+    }
+  }
+}
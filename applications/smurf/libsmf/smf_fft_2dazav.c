@@ -13,9 +13,12 @@
 *     Subroutine
 
 *  Invocation:
-*     pntr = smf_fft_2dazav( const smfData *data, double *df, int *status ) {
+*     pntr = smf_fft_2dazav( ThrWorkForce *wf, const smfData *data,
+*                            double *df, int *status ) {
 
 *  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        Pointer to a pool of worker threads (can be NULL)
 *     data = smfData * (Given)
 *        Pointer to a smfData containing the FFT of a 2-d map
 *     df = double * (Returned)
@@ -36,6 +39,11 @@
 *     the first component will contain the real part of the transform
 *     as output by smf_fft_data, and the average will likely come out
 *     to something close to zero...
+*
+*     The rows of the FFT are divided between the worker threads, each
+*     of which forms the sums for its own rows. The sums from each
+*     thread are then added together in a fixed order, so the result
+*     does not depend on the timing of the threads.
 
 *  Notes:
 
@@ -50,10 +58,14 @@
 *        Should only be calculated up to the Nyquist frequency
 *     2011-10-05 (EC):
 *        Optionally return df.
+*     2026-10-14:
+*        Add the ThrWorkForce argument and share the rows between
+*        threads.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2011 University of British Columbia.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -97,21 +109,45 @@
 #include "smf_typ.h"
 #include "smf_err.h"
 
+/* Prototypes for local static functions. */
+static void smf1_fft_2dazav( void *job_data_ptr, int *status );
+
+/* Local data types */
+typedef struct smfFFT2dAzavData {
+  const double *idata;          /* Input 2d data */
+  const double *x2;             /* Squared x frequency for each column */
+  dim_t j1;                     /* First row to process */
+  dim_t j2;                     /* Last row to process */
+  dim_t fdims[2];               /* Frequency space dimensions */
+  dim_t rdims[2];               /* Real space dimensions */
+  double df0[2];                /* Spatial freq. step x/y-axes of map */
+  double df_o;                  /* Spatial freq. step of output */
+  size_t nf_o;                  /* Length of output frequency axis */
+  double *sum;                  /* Sum of data at each radius */
+  size_t *count;                /* Count of data at each radius */
+} SmfFFT2dAzavData;
+
 #define FUNC_NAME "smf_fft_2dazav"
 
-smfData *smf_fft_2dazav( const smfData *data, double *df, int *status ) {
+smfData *smf_fft_2dazav( ThrWorkForce *wf, const smfData *data, double *df,
+                         int *status ) {
 
   size_t *count=NULL;           /* Count of data at this radius */
   double df_o=1;                /* Spatial freq. step of output */
   double df0[2]={1,1};          /* Spatial freq. step x/y-axes of map */
   dim_t fdims[2];               /* Frequency space dimensions */
   size_t i;                     /* Loop counter */
-  double *idata=NULL;           /* Input 2d data pointer */
-  size_t j;                     /* Loop counter */
+  int iw;                       /* Thread index */
+  SmfFFT2dAzavData *job_data=NULL; /* Data for all jobs */
   size_t nf_o=0;                /* Length output frequency axis (to Nyquist) */
+  int nw;                       /* Number of jobs */
   size_t ndims;                 /* Number of real dimensions */
   double *odata=NULL;           /* Output 1d data pointer */
+  SmfFFT2dAzavData *pdata;      /* Data for one job */
   double pixsize;               /* Map pixel size */
+  dim_t rowstep;                /* Number of rows per job */
+  double *sums=NULL;            /* Sums for all jobs */
+  double *x2=NULL;              /* Squared x frequency for each column */
   smfData *retdata=NULL;        /* Returned 1-d smfData */
   dim_t rdims[2];               /* Real space dimensions */
   int whichaxis=0;              /* Which frequency axis for output */
@@ -174,48 +210,62 @@ smfData *smf_fft_2dazav( const smfData *data, double *df, int *status ) {
     retdata->dtype = SMF__DOUBLE;
 
     retdata->pntr[0] = astCalloc( nf_o, smf_dtype_sz(retdata->dtype,status) );
-    count = astCalloc( nf_o, sizeof(*count) );
   }
 
-  /* Loop over elements of the input data and decide which radial bin
-     they belong in */
+  /* Share the rows of the input data between the threads. Each one has
+     its own sums and counts for each radial bin. */
+  nw = wf ? wf->nworker : 1;
   if( *status == SAI__OK ) {
-    double x;
-    double y;
-    size_t d;
-
-    /* Pointers to input and output data*/
-    idata = data->pntr[0];
-    odata = retdata->pntr[0];
-
-    for( i=0; (*status==SAI__OK)&&(i<fdims[0]); i++ ) {
+    if( (dim_t) nw > fdims[1] ) nw = fdims[1];
+    if( nw < 1 ) nw = 1;
+    rowstep = fdims[1]/nw;
+
+    job_data = astCalloc( nw, sizeof(*job_data) );
+    sums = astCalloc( nw*nf_o, sizeof(*sums) );
+    count = astCalloc( nw*nf_o, sizeof(*count) );
+    x2 = astMalloc( fdims[0]*sizeof(*x2) );
+  }
 
-      x = FFT_INDEX_TO_FREQ(i,rdims[0]) * df0[0];
+  if( *status == SAI__OK ) {
 
-      for( j=0; j<fdims[1]; j++ ) {
-        /* Work out cartesian distance from origin (which is at 0,0
-           and wraps-around the edges. x and y give the frequency
-           indices multiplied by the frequency step size along each
-           axis. */
+    /* The squared x frequency is the same for each row */
+    for( i=0; i<fdims[0]; i++ ) {
+      x2[i] = FFT_INDEX_TO_FREQ(i,rdims[0]) * df0[0];
+      x2[i] *= x2[i];
+    }
 
-        y = FFT_INDEX_TO_FREQ(j,rdims[1]) * df0[1];
+    for( iw=0; iw<nw; iw++ ) {
+      pdata = job_data + iw;
+      pdata->j1 = iw*rowstep;
+      pdata->j2 = ( iw < nw - 1 ) ? pdata->j1 + rowstep - 1 : fdims[1] - 1;
+      pdata->idata = data->pntr[0];
+      pdata->x2 = x2;
+      memcpy( pdata->fdims, fdims, sizeof(pdata->fdims) );
+      memcpy( pdata->rdims, rdims, sizeof(pdata->rdims) );
+      memcpy( pdata->df0, df0, sizeof(pdata->df0) );
+      pdata->df_o = df_o;
+      pdata->nf_o = nf_o;
+      pdata->sum = sums + iw*nf_o;
+      pdata->count = count + iw*nf_o;
+
+      thrAddJob( wf, 0, pdata, smf1_fft_2dazav, 0, NULL, status );
+    }
+    thrWait( wf, status );
+  }
 
-        /* The final distance is just truncated to an integer number of
-           steps in the return array */
-        d = (size_t) (sqrt(x*x + y*y) / df_o);
+  /* Add up the sums from each thread in order, and re-normalize */
+  if( *status == SAI__OK ) {
+    odata = retdata->pntr[0];
 
-        /* Only consider frequencies up to Nyquist */
-        if( d < nf_o ) {
-          /* Accumulate values at this radius */
-          odata[d] += idata[i+j*fdims[0]];
-          count[d]++;
-        }
+    for( iw=1; iw<nw; iw++ ) {
+      for( i=0; i<nf_o; i++ ) {
+        sums[i] += sums[i+iw*nf_o];
+        count[i] += count[i+iw*nf_o];
       }
     }
 
-    /* Re-normalize */
     for( i=0; i<nf_o; i++ ) {
-      if( count[i] ) odata[i] /= (double) count[i];
+      if( count[i] ) odata[i] = sums[i] / (double) count[i];
       else odata[i] = VAL__BADD;
     }
   }
@@ -260,7 +310,69 @@ smfData *smf_fft_2dazav( const smfData *data, double *df, int *status ) {
   }
 
   /* Clean up */
-  if( count ) count = astFree( count );
+  count = astFree( count );
+  sums = astFree( sums );
+  x2 = astFree( x2 );
+  job_data = astFree( job_data );
 
   return retdata;
 }
+
+static void smf1_fft_2dazav( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_fft_2dazav
+
+*  Purpose:
+*     Executed in a worker thread to form the sums for a range of rows
+*     for smf_fft_2dazav.
+
+*  Invocation:
+*     smf1_fft_2dazav( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = SmfFFT2dAzavData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+/* Local Variables: */
+  SmfFFT2dAzavData *pdata;
+  const double *idata;
+  double y2;
+  double y;
+  size_t d;
+  dim_t i;
+  dim_t j;
+
+/* Check inherited status */
+  if( *status != SAI__OK ) return;
+
+  pdata = (SmfFFT2dAzavData *) job_data_ptr;
+
+/* Loop over the rows, and then along each row so that the data are
+   accessed in memory order. */
+  for( j = pdata->j1; j <= pdata->j2; j++ ) {
+    idata = pdata->idata + j*pdata->fdims[0];
+
+    y = FFT_INDEX_TO_FREQ(j,pdata->rdims[1]) * pdata->df0[1];
+    y2 = y*y;
+
+    for( i = 0; i < pdata->fdims[0]; i++ ) {
+
+      /* Work out cartesian distance from origin (which is at 0,0
+         and wraps-around the edges. The distance is just truncated to
+         an integer number of steps in the return array */
+      d = (size_t) (sqrt(pdata->x2[i] + y2) / pdata->df_o);
+
+      /* Only consider frequencies up to Nyquist */
+      if( d < pdata->nf_o ) {
+        pdata->sum[d] += idata[i];
+        pdata->count[d]++;
+      }
+    }
+  }
+}
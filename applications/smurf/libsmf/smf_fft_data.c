@@ -124,11 +124,15 @@
 *     2011-03-05 (DSB):
 *        Do not attempt to take the FFT of bad bolometer time streams since
 *        they generate NaNs in FFTW.
+*     2026-10-14:
+*        Use a multi-threaded FFTW plan for transforms of 2-d maps, and
+*        apply the normalisation of forward transforms in parallel.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2008-2011 Science and Technology Facilities Council.
 *     Copyright (C) 2008,2010-2011 University of British Columbia.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -155,7 +159,6 @@
 /* System includes */
 #include <stdlib.h>
 #include <string.h>
-#include <pthread.h>
 
 /* Starlink includes */
 #include "ast.h"
@@ -177,8 +180,6 @@
 /* ------------------------------------------------------------------------ */
 /* Local variables and functions */
 
-pthread_mutex_t smf_fft_data_mutex = PTHREAD_MUTEX_INITIALIZER;
-
 /* Structure containing information about blocks of bolos to be
    FFT'd by each thread. All threads read/write to/from mutually
    exclusive parts of data and retdata so we don't need to make
@@ -201,14 +202,30 @@ typedef struct smfFFTData {
 
 void smfFFTDataParallel( void *job_data_ptr, int *status );
 
+/* Multiply a range of values by the normalisation factor */
+typedef struct smfFFTNorm {
+  double *val;                  /* Values to be normalised */
+  double norm;                  /* Normalisation factor */
+} smfFFTNorm;
+
+static void smf1_fft_norm( void *job_data_ptr, size_t i1, size_t i2,
+                           int *status );
+
+/* Return a plan that transforms a batch of adjacent bolometers */
+static fftw_plan smf1_batch_plan( int inverse, dim_t ntslice, dim_t nf,
+                                  dim_t nb, double *baseD, double *baseR,
+                                  double *baseI, int *status );
+
 void smfFFTDataParallel( void *job_data_ptr, int *status ) {
   double *baseR=NULL;           /* base pointer to real part of fourier data */
   double *baseI=NULL;           /* base pointer to imag part of fourier data */
   double *baseD=NULL;           /* base pointer to real-space data */
   dim_t i;                      /* Loop counter */
+  dim_t nb;                     /* Number of bolometers in current batch */
   dim_t nf=0;
   dim_t ntslice=0;
   smfFFTData *pdata = NULL;     /* Pointer to job data */
+  fftw_plan plan;               /* Plan for current batch */
 
    if( *status != SAI__OK ) return;
 
@@ -252,49 +269,61 @@ void smfFFTDataParallel( void *job_data_ptr, int *status ) {
               status );
   }
 
-   if( pdata->inverse ) {        /* Perform inverse fft */
+   if( pdata->ndims != 1 ) {     /* Transform a single map */
+     baseD = pdata->inverse ? pdata->retdata->pntr[0] : pdata->data->pntr[0];
+     baseR = pdata->inverse ? pdata->data->pntr[0] : pdata->retdata->pntr[0];
+     baseI = baseR + nf;
 
-     for( i=pdata->b1; i<=pdata->b2; i++ ) {
-       /* Transform bolometers one at a time */
+     if( pdata->inverse ) {
+       fftw_execute_split_dft_c2r( pdata->plan, baseR, baseI, baseD );
+     } else {
+       fftw_execute_split_dft_r2c( pdata->plan, baseD, baseR, baseI );
+     }
+
+   } else if( pdata->inverse ) { /* Perform inverse fft */
+
+     /* Transform the bolometers in batches of up to SMF__FFTBATCH
+        adjacent time series, each using a single strided plan. */
+     for( i=pdata->b1; (*status==SAI__OK) && (i<=pdata->b2); i+=nb ) {
        baseR = pdata->data->pntr[0];
+       baseR += i*nf;
+       baseI = baseR + nf*pdata->nbolo;
        baseD = pdata->retdata->pntr[0];
+       baseD += i*ntslice;
 
-       if( pdata->ndims == 1 ) {
-         /* Multiple time-series for different bolometers */
-         baseR += i*nf;
-         baseI = baseR + nf*pdata->nbolo;
-         baseD += i*ntslice;
-       } else {
-         /* Single map */
-         baseI = baseR + nf;
-       }
+       nb = pdata->b2 - i + 1;
+       if( nb > SMF__FFTBATCH ) nb = SMF__FFTBATCH;
 
-       fftw_execute_split_dft_c2r( pdata->plan, baseR, baseI, baseD );
+       plan = smf1_batch_plan( 1, ntslice, nf, nb, baseD, baseR, baseI,
+                               status );
+       if( plan ) fftw_execute_split_dft_c2r( plan, baseR, baseI, baseD );
      }
+
    } else {                      /* Perform forward fft */
-     for( i=pdata->b1; i<=pdata->b2; i++ ) {
-       /* Transform bolometers one at a time */
+     for( i=pdata->b1; (*status==SAI__OK) && (i<=pdata->b2); i+=nb ) {
        baseD = pdata->data->pntr[0];
+       baseD += i*ntslice;
        baseR = pdata->retdata->pntr[0];
+       baseR += i*nf;
+       baseI = baseR + nf*pdata->nbolo;
 
-       if( pdata->ndims == 1 ) {
-         /* Multiple time-series for different bolometers */
-         baseD += i*ntslice;
-         baseR += i*nf;
-         baseI = baseR + nf*pdata->nbolo;
-       } else {
-         /* Single map */
-         baseI = baseR + nf;
-       }
-
-       /* Skip bad bolometers. These will have been filled with bad values. */
-       if( baseD[ 0 ] != VAL__BADD ) {
-         fftw_execute_split_dft_r2c( pdata->plan, baseD, baseR, baseI );
-
-       /* For safety, fill thre returned arrays with zeros for bad bolometers. */
-       } else {
+       /* Skip bad bolometers. These will have been filled with bad
+          values. For safety, fill the returned arrays with zeros. */
+       if( baseD[ 0 ] == VAL__BADD ) {
          memset( baseR, 0, sizeof(*baseR)*nf );
          memset( baseI, 0, sizeof(*baseR)*nf );
+         nb = 1;
+
+       /* Otherwise transform the following run of good bolometers (up to
+          SMF__FFTBATCH of them) using a single strided plan. */
+       } else {
+         nb = 1;
+         while( nb < SMF__FFTBATCH && i + nb <= pdata->b2 &&
+                baseD[ nb*ntslice ] != VAL__BADD ) nb++;
+
+         plan = smf1_batch_plan( 0, ntslice, nf, nb, baseD, baseR, baseI,
+                                 status );
+         if( plan ) fftw_execute_split_dft_r2c( plan, baseD, baseR, baseI );
        }
      }
    }
@@ -310,6 +339,27 @@ void smfFFTDataParallel( void *job_data_ptr, int *status ) {
    }
 }
 
+/* Return a plan that transforms "nb" adjacent bolo-ordered time series
+   of length "ntslice", each with "nf" frequencies. The plan is cached by
+   smf_fftw_plan, so there is at most one plan for each batch size. */
+static fftw_plan smf1_batch_plan( int inverse, dim_t ntslice, dim_t nf,
+                                  dim_t nb, double *baseD, double *baseR,
+                                  double *baseI, int *status ) {
+  fftw_iodim dims;
+  fftw_iodim howmany;
+
+  dims.n = ntslice;
+  dims.is = 1;
+  dims.os = 1;
+
+  howmany.n = nb;
+  howmany.is = inverse ? nf : ntslice;
+  howmany.os = inverse ? ntslice : nf;
+
+  return smf_fftw_plan( inverse, 1, &dims, 1, &howmany, 1, baseD, baseR,
+                        baseI, status );
+}
+
 /* ------------------------------------------------------------------------ */
 
 
@@ -337,17 +387,17 @@ smfData *smf_fft_data( ThrWorkForce *wf, const smfData *indata,
   size_t ndims;                 /* Number of real-space dimensions */
   size_t nf=0;                  /* Number of frequencies in FFT */
   int njobs=0;                  /* Number of jobs to be processed */
-  double norm=1.;               /* Normalization factor for the FFT */
+  smfFFTNorm normdata;          /* Normalization factor for the FFT */
   size_t nr=0;                  /* Number of elements in real space */
   size_t nretdata=0;            /* Number of data points returned data array */
   dim_t nrows=0;                /* Number of rows */
   dim_t ntslice=0;              /* Number of time slices */
+  int nthread=1;                /* Number of FFTW threads for a map */
   int nw;                       /* Number of worker threads */
   smfFFTData *pdata=NULL;       /* Pointer to current job data */
   dim_t rdims[2];               /* real-space dimensions */
   smfData *retdata=NULL;        /* Pointer to new transformed smfData */
   size_t step;                  /* step size for dividing up work */
-  double *val=NULL;             /* Element of data to be normalized */
 
   if (*status != SAI__OK) return NULL;
 
@@ -619,7 +669,11 @@ smfData *smf_fft_data( ThrWorkForce *wf, const smfData *indata,
         }
       }
     } else {
-      /* Otherwise transforms of maps are done in a single thread */
+      /* Otherwise a map is transformed in a single job, using a plan
+         that shares the transform between as many FFTW threads as
+         there are workers (but no more than one per row). */
+      nthread = nw;
+      if( nthread > (int) rdims[ndims-1] ) nthread = rdims[ndims-1];
       nw = 1;
       step = 0;
     }
@@ -670,14 +724,12 @@ smfData *smf_fft_data( ThrWorkForce *wf, const smfData *indata,
         else baseI = baseR + nf;
         baseD = retdata->pntr[0];
 
-        thrMutexLock( &smf_fft_data_mutex, status );
-
-        pdata->plan = fftw_plan_guru_split_dft_c2r( ndims, dims, 0, NULL,
-                                                    baseR, baseI,
-                                                    baseD,
-                                                    FFTW_ESTIMATE |
-                                                    FFTW_UNALIGNED );
-        thrMutexUnlock( &smf_fft_data_mutex, status );
+        /* Time-series are transformed in batches, using plans obtained
+           within smfFFTDataParallel. */
+        if( ndims != 1 ) {
+          pdata->plan = smf_fftw_plan( 1, ndims, dims, 0, NULL, nthread,
+                                       baseD, baseR, baseI, status );
+        }
       } else {               /* Performing forward fft */
         /* Setup forward FFT plan using guru interface */
         baseD = data->pntr[0];
@@ -685,13 +737,10 @@ smfData *smf_fft_data( ThrWorkForce *wf, const smfData *indata,
         if( ndims == 1 ) baseI = baseR + nf*nbolo;
         else baseI = baseR + nf;
 
-        thrMutexLock( &smf_fft_data_mutex, status );
-        pdata->plan = fftw_plan_guru_split_dft_r2c( ndims, dims, 0, NULL,
-                                                    baseD,
-                                                    baseR, baseI,
-                                                    FFTW_ESTIMATE |
-                                                    FFTW_UNALIGNED );
-        thrMutexUnlock( &smf_fft_data_mutex, status );
+        if( ndims != 1 ) {
+          pdata->plan = smf_fftw_plan( 0, ndims, dims, 0, NULL, nthread,
+                                       baseD, baseR, baseI, status );
+        }
 
 
         /* Set up WCS for Fourier Space data */
@@ -850,15 +899,13 @@ smfData *smf_fft_data( ThrWorkForce *wf, const smfData *indata,
   thrWait( wf, status );
   thrEndJobContext( wf, status );
 
-  /* Each sample needs to have a normalization applied if forward FFT */
-  if( (*status==SAI__OK) && !inverse ) {
-    norm = 1. / (double) nr;
-    val = retdata->pntr[0];
-
-    for( j=0; j<nretdata; j++ ) {
-      *val *= norm;
-      val++;
-    }
+  /* Each sample needs to have a normalization applied if forward FFT.
+     The values are shared between the threads in large chunks. */
+  if( (*status==SAI__OK) && !inverse && nretdata > 0 ) {
+    normdata.norm = 1. / (double) nr;
+    normdata.val = retdata->pntr[0];
+    thrParallelFor( wf, 0, nretdata - 1, SMF__MIB/sizeof(double),
+                    &normdata, smf1_fft_norm, status );
   }
 
   /* If we get here with good status, set isFFT to the length of the
@@ -882,18 +929,22 @@ smfData *smf_fft_data( ThrWorkForce *wf, const smfData *indata,
   if( data ) smf_close_file( wf, &data, status );
   if( dims ) dims = astFree( dims );
 
-  /* Clean up the job data array */
-  if( job_data ) {
-    for( i=0; i<njobs; i++ ) {
-      pdata = job_data + i;
-      /* Destroy the plans */
-      thrMutexLock( &smf_fft_data_mutex, status );
-      fftw_destroy_plan( pdata->plan);
-      thrMutexUnlock( &smf_fft_data_mutex, status );
-    }
-    job_data = astFree( job_data );
-  }
+  /* Clean up the job data array. The plans are owned by the
+     smf_fftw_plan cache, so are not destroyed here. */
+  if( job_data ) job_data = astFree( job_data );
 
   return retdata;
 
 }
+
+static void smf1_fft_norm( void *job_data_ptr, size_t i1, size_t i2,
+                           int *status ) {
+  smfFFTNorm *pdata = job_data_ptr;
+  double *val;
+  size_t i;
+
+  if( *status != SAI__OK ) return;
+
+  val = pdata->val;
+  for( i=i1; i<=i2; i++ ) val[i] *= pdata->norm;
+}
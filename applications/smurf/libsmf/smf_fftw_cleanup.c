@@ -0,0 +1,121 @@
+/*
+*+
+*  Name:
+*     smf_fftw_cleanup
+
+*  Purpose:
+*     Free all cached FFTW plans and release FFTW resources.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     smf_fftw_cleanup( int *status )
+
+*  Arguments:
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     This function should be called instead of fftw_cleanup when an
+*     application has finished using FFTW. If the SMURF_FFTW_WISDOM
+*     environment variable names a file, and new plans have been created
+*     by smf_fftw_plan, the accumulated FFTW wisdom is first written to
+*     that file so that later runs can re-use it. All the plans in the
+*     smf_fftw_plan cache are then destroyed, and fftw_cleanup (or
+*     fftw_cleanup_threads if the FFTW threads library has been
+*     initialised) is called.
+*     Calling fftw_cleanup directly would leave the cache holding invalid
+*     plans.
+
+*  Notes:
+*     - This routine attempts to execute even if status is set on entry.
+*     - No other thread should be using FFTW when this function is
+*     called.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdlib.h>
+#include <pthread.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+#include "fftw3.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+#define FUNC_NAME "smf_fftw_cleanup"
+
+void smf_fftw_cleanup( int *status ){
+
+/* Local Variables: */
+   const char *wisdom;
+   int lstatus = SAI__OK;
+   smfFftwPlan *cached;
+
+   thrMutexLock( &smf_fftw_mutex, &lstatus );
+
+/* Save the wisdom if any new plans have been created. */
+   wisdom = getenv( SMF__FFTW_WISDOM );
+   if( smf_fftw_nnew > 0 && wisdom && wisdom[ 0 ] ) {
+      if( !fftw_export_wisdom_to_filename( wisdom ) ) {
+         msgOutf( "", FUNC_NAME ": *** Warning *** failed to save FFTW "
+                  "wisdom to '%s'", &lstatus, wisdom );
+      }
+   }
+
+/* Destroy the cached plans. */
+   while( smf_fftw_plans ) {
+      cached = smf_fftw_plans;
+      smf_fftw_plans = cached->next;
+      fftw_destroy_plan( cached->plan );
+      cached = astFree( cached );
+   }
+
+/* fftw_cleanup also forgets all wisdom, so it will need to be imported
+   again if FFTW is used again in this process. fftw_cleanup_threads
+   calls fftw_cleanup, and means that the threads library must be
+   initialised again before another multi-threaded plan is created. */
+   if( smf_fftw_threads > 0 ) {
+      fftw_cleanup_threads();
+   } else {
+      fftw_cleanup();
+   }
+   smf_fftw_wisdom = 0;
+   smf_fftw_nnew = 0;
+   smf_fftw_threads = 0;
+
+   thrMutexUnlock( &smf_fftw_mutex, &lstatus );
+
+   if( lstatus != SAI__OK && *status == SAI__OK ) *status = lstatus;
+}
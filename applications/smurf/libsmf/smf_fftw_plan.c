@@ -0,0 +1,329 @@
+/*
+*+
+*  Name:
+*     smf_fftw_plan
+
+*  Purpose:
+*     Return a cached FFTW plan for a split real/complex transform.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     plan = smf_fftw_plan( int inverse, int rank, const fftw_iodim *dims,
+*                           int howmany_rank, const fftw_iodim *howmany_dims,
+*                           int nthread, double *real, double *re,
+*                           double *im, int *status )
+
+*  Arguments:
+*     inverse = int (Given)
+*        If zero, a forward (real to complex) plan is returned. Otherwise
+*        an inverse (complex to real) plan is returned.
+*     rank = int (Given)
+*        The number of transform dimensions (1 or 2).
+*     dims = const fftw_iodim * (Given)
+*        The length and the input and output strides of each transform
+*        dimension, as for fftw_plan_guru_split_dft_r2c.
+*     howmany_rank = int (Given)
+*        The number of loop dimensions (0, 1 or 2). Zero means a single
+*        transform is performed.
+*     howmany_dims = const fftw_iodim * (Given)
+*        The loop dimensions. Only accessed if "howmany_rank" is
+*        non-zero.
+*     nthread = int (Given)
+*        The number of threads to be used by FFTW when executing the
+*        plan. Values less than two give a single-threaded plan. This
+*        should only be more than one for large transforms that are
+*        executed one at a time (e.g. those of 2-d maps), since FFTW
+*        adds the overheads of its own threads to every execution.
+*     real = double * (Given)
+*        An example of the real-space array. It is the input for a
+*        forward transform and the output for an inverse transform.
+*     re = double * (Given)
+*        An example of the array holding the real parts of the
+*        frequency-space values.
+*     im = double * (Given)
+*        An example of the array holding the imaginary parts of the
+*        frequency-space values.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     The plan, or NULL if an error occurs. The plan must not be
+*     destroyed by the caller. It remains valid until smf_fftw_cleanup
+*     is called.
+
+*  Description:
+*     Creating an FFTW plan is slow compared to executing it, and the
+*     planner is not thread-safe. Since SMURF applies transforms of the
+*     same shape many times (e.g. on each subarray at each iteration of
+*     makemap), plans are created once and then kept in a process-wide
+*     cache, indexed by the transform geometry. Creating a plan and
+*     searching the cache are serialised by a mutex, but the returned
+*     plan can be executed concurrently by any number of threads using
+*     the new-array execute functions (fftw_execute_split_dft_r2c etc).
+*     Plans are created with FFTW_UNALIGNED, so can be used with any
+*     arrays that have the same geometry as the supplied example arrays.
+*     Plans for different numbers of threads are cached separately. The
+*     FFTW threads library is initialised the first time a
+*     multi-threaded plan is needed.
+*
+*     The first time a plan is needed, FFTW wisdom is imported from the
+*     file named by the SMURF_FFTW_WISDOM environment variable, if set.
+*     The wisdom (including that for any new plans) is written back to
+*     the same file by smf_fftw_cleanup.
+*
+*     Plans are normally created using FFTW_ESTIMATE, which does not
+*     access the example arrays. If the SMURF_FFTW_MEASURE environment
+*     variable is set to a non-zero value, FFTW_MEASURE is used instead,
+*     giving faster plans at the cost of much slower planning unless
+*     suitable wisdom is available. Since FFTW_MEASURE overwrites the
+*     arrays, the plan is then created using temporary arrays rather
+*     than the supplied example arrays, and FFTW_ESTIMATE is still used
+*     if the temporary arrays would be unreasonably large.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+#include "fftw3.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+/* The cache of plans, the mutex that serialises access to it and to the
+   FFTW planner, and flags indicating if wisdom has been imported, if
+   any new plans have been created since, and if the FFTW threads
+   library has been initialised. */
+smfFftwPlan *smf_fftw_plans = NULL;
+pthread_mutex_t smf_fftw_mutex = PTHREAD_MUTEX_INITIALIZER;
+int smf_fftw_wisdom = 0;
+int smf_fftw_nnew = 0;
+int smf_fftw_threads = 0;
+
+/* The largest temporary arrays that will be allocated in order to measure
+   a plan. */
+#define MAXMEASURE (64*SMF__MIB)
+
+#define FUNC_NAME "smf_fftw_plan"
+
+/* Prototypes for local functions */
+static size_t smf1_extent( int rank, const fftw_iodim *dims,
+                           int howmany_rank, const fftw_iodim *howmany_dims,
+                           int output, int complex );
+static int smf1_same_dims( int rank, const fftw_iodim *dims1,
+                           const fftw_iodim *dims2 );
+
+fftw_plan smf_fftw_plan( int inverse, int rank, const fftw_iodim *dims,
+                         int howmany_rank, const fftw_iodim *howmany_dims,
+                         int nthread, double *real, double *re, double *im,
+                         int *status ){
+
+/* Local Variables: */
+   const char *envval;
+   double *treal = NULL;
+   double *tre = NULL;
+   double *tim = NULL;
+   fftw_plan result = NULL;
+   size_t ncomplex;
+   size_t nreal;
+   smfFftwPlan *cached;
+   unsigned flags;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return result;
+
+   if( rank < 1 || rank > SMF__FFTW_MAXRANK || howmany_rank < 0 ||
+       howmany_rank > SMF__FFTW_MAXRANK ) {
+      *status = SAI__ERROR;
+      errRepf( "", FUNC_NAME ": Unsupported FFT rank (%d,%d).", status,
+               rank, howmany_rank );
+      return result;
+   }
+   if( nthread < 1 ) nthread = 1;
+
+   thrMutexLock( &smf_fftw_mutex, status );
+
+/* Look for a plan with the same geometry in the cache. */
+   for( cached = smf_fftw_plans; cached; cached = cached->next ) {
+      if( cached->inverse == ( inverse != 0 ) && cached->rank == rank &&
+          cached->howmany_rank == howmany_rank &&
+          cached->nthread == nthread &&
+          smf1_same_dims( rank, cached->dims, dims ) &&
+          smf1_same_dims( howmany_rank, cached->howmany_dims,
+                          howmany_dims ) ) {
+         result = cached->plan;
+         break;
+      }
+   }
+
+/* If not found, create a new plan. First import any wisdom. */
+   if( !result && *status == SAI__OK ) {
+      if( !smf_fftw_wisdom ) {
+         smf_fftw_wisdom = 1;
+         envval = getenv( SMF__FFTW_WISDOM );
+         if( envval && envval[ 0 ] ) {
+            if( fftw_import_wisdom_from_filename( envval ) ) {
+               msgOutiff( MSG__DEBUG, "", FUNC_NAME ": imported FFTW wisdom "
+                          "from '%s'", status, envval );
+            }
+         }
+      }
+
+/* Set the number of threads to be used by the new plan, initialising
+   the FFTW threads library if this is the first multi-threaded plan. If
+   the library cannot be initialised, a single-threaded plan is
+   created. */
+      if( nthread > 1 && !smf_fftw_threads ) {
+         smf_fftw_threads = fftw_init_threads() ? 1 : -1;
+         if( smf_fftw_threads < 0 ) {
+            msgOutif( MSG__DEBUG, "", FUNC_NAME ": could not initialise "
+                      "the FFTW threads library", status );
+         }
+      }
+      if( smf_fftw_threads > 0 ) {
+         fftw_plan_with_nthreads( ( nthread > 1 ) ? nthread : 1 );
+      }
+
+/* Use FFTW_MEASURE if requested, and if the temporary arrays needed to
+   protect the supplied arrays are not too big. */
+      flags = FFTW_ESTIMATE | FFTW_UNALIGNED;
+      envval = getenv( SMF__FFTW_MEASURE );
+      if( envval && atoi( envval ) != 0 ) {
+         nreal = smf1_extent( rank, dims, howmany_rank, howmany_dims,
+                              inverse, 0 );
+         ncomplex = smf1_extent( rank, dims, howmany_rank, howmany_dims,
+                                 !inverse, 1 );
+         if( ( nreal + 2*ncomplex )*sizeof( double ) <= MAXMEASURE ) {
+            treal = fftw_malloc( nreal*sizeof( *treal ) );
+            tre = fftw_malloc( ncomplex*sizeof( *tre ) );
+            tim = fftw_malloc( ncomplex*sizeof( *tim ) );
+            if( treal && tre && tim ) {
+               flags = FFTW_MEASURE | FFTW_UNALIGNED;
+               real = treal;
+               re = tre;
+               im = tim;
+            }
+         }
+      }
+
+      if( inverse ) {
+         result = fftw_plan_guru_split_dft_c2r( rank, dims, howmany_rank,
+                                                howmany_dims, re, im, real,
+                                                flags );
+      } else {
+         result = fftw_plan_guru_split_dft_r2c( rank, dims, howmany_rank,
+                                                howmany_dims, real, re, im,
+                                                flags );
+      }
+
+      if( treal ) fftw_free( treal );
+      if( tre ) fftw_free( tre );
+      if( tim ) fftw_free( tim );
+
+/* Add it to the cache. */
+      if( !result ) {
+         *status = SAI__ERROR;
+         errRepf( "", FUNC_NAME ": FFTW3 could not create plan for %s "
+                  "transformation", status, inverse ? "inverse" : "forward" );
+      } else {
+         cached = astMalloc( sizeof( *cached ) );
+         if( *status == SAI__OK ) {
+            memset( cached, 0, sizeof( *cached ) );
+            cached->inverse = ( inverse != 0 );
+            cached->rank = rank;
+            cached->howmany_rank = howmany_rank;
+            cached->nthread = nthread;
+            memcpy( cached->dims, dims, rank*sizeof( *dims ) );
+            if( howmany_rank > 0 ) {
+               memcpy( cached->howmany_dims, howmany_dims,
+                       howmany_rank*sizeof( *howmany_dims ) );
+            }
+            cached->plan = result;
+            cached->next = smf_fftw_plans;
+            smf_fftw_plans = cached;
+            smf_fftw_nnew++;
+         } else {
+            fftw_destroy_plan( result );
+            result = NULL;
+         }
+      }
+   }
+
+   thrMutexUnlock( &smf_fftw_mutex, status );
+
+/* Return the plan. */
+   return result;
+}
+
+/* Return the number of elements spanned by an input or output array of a
+   transform. For the frequency-space arrays of a real transform, the
+   last transform dimension has length n/2+1. */
+static size_t smf1_extent( int rank, const fftw_iodim *dims,
+                           int howmany_rank, const fftw_iodim *howmany_dims,
+                           int output, int complex ){
+   int i;
+   int n;
+   int stride;
+   size_t result = 1;
+
+   for( i = 0; i < rank; i++ ) {
+      n = dims[ i ].n;
+      if( complex && i == rank - 1 ) n = n/2 + 1;
+      stride = output ? dims[ i ].os : dims[ i ].is;
+      result += (size_t) ( n - 1 )*(size_t) abs( stride );
+   }
+
+   for( i = 0; i < howmany_rank; i++ ) {
+      n = howmany_dims[ i ].n;
+      stride = output ? howmany_dims[ i ].os : howmany_dims[ i ].is;
+      result += (size_t) ( n - 1 )*(size_t) abs( stride );
+   }
+
+   return result;
+}
+
+/* Return non-zero if two sets of FFTW dimensions are the same. */
+static int smf1_same_dims( int rank, const fftw_iodim *dims1,
+                           const fftw_iodim *dims2 ){
+   int i;
+
+   for( i = 0; i < rank; i++ ) {
+      if( dims1[ i ].n != dims2[ i ].n || dims1[ i ].is != dims2[ i ].is ||
+          dims1[ i ].os != dims2[ i ].os ) return 0;
+   }
+   return 1;
+}
@@ -36,6 +36,10 @@
 *     of data with a constrained realization of noise: smoothly connect the
 *     before/after boundaries of the gap to avoid ringing when filters are
 *     applied.
+*
+*     The noise added to each filled sample depends only on the bolometer
+*     and time slice indices, so the same values are produced on every
+*     call, whatever the number of threads in "wf".
 
 *  Authors:
 *     Edward Chapin (UBC)
@@ -111,6 +115,13 @@
 *        Provide an option to disable the addition of noise to the gaps
 *        (see config param FILLGAPS_NOISE). This can help makemap
 *        convergence.
+*     14-OCT-2026:
+*        Use the index of good data spans if one is available (see
+*        smf_qspans_update).
+*     14-OCT-2026:
+*        Use a counter-based random number generator for the noise, so
+*        that the filled values do not depend on the number of threads,
+*        and let the threads claim blocks of bolometers dynamically.
 
 *  Copyright:
 *     Copyright (C) 2010 Univeristy of British Columbia.
@@ -149,8 +160,8 @@
 #include "libsmf/smf_err.h"
 
 /* System includes */
-#include <gsl/gsl_rng.h>
-#include <gsl/gsl_randist.h>
+#include <math.h>
+#include <stdint.h>
 
 /* Define the function name for error messages. */
 #define FUNC_NAME "smf_fillgaps"
@@ -163,15 +174,21 @@
 /* Define the minimum box size for which noise can be calculated. */
 #define MINBOX 6
 
+/* The key for the counter-based random number generator used to create
+   the noise added to filled gaps. */
+#define NOISE_KEY UINT64_C( 0x9e3779b97f4a7c15 )
+
+/* 2^-53, used to convert the top 53 bits of a 64-bit random value into
+   a double in the range [0,1). */
+#define TWOM53 1.1102230246251565404e-16
+
 /* Structure containing information about blocks of bolos to be
    filled by each thread. */
 typedef struct smfFillGapsData {
   int ntslice;                  /* Number of time slices */
   double *dat;                  /* Pointer to bolo data */
-  gsl_rng *r;                   /* GSL random number generator */
+  int addnoise;                 /* Add noise to the filled values? */
   int fillpad;                  /* Fill PAD samples? */
-  size_t b1;                    /* Index of first bolometer to be filledd */
-  size_t b2;                    /* Index of last bolometer to be filledd */
   size_t bstride;               /* bolo stride */
   size_t tstride;               /* time slice stride */
   int box;
@@ -180,25 +197,26 @@ typedef struct smfFillGapsData {
   int pstart;                   /* First non-PAD sample */
   smf_qual_t *qua;              /* Pointer to quality array */
   smf_qual_t mask;              /* Quality mask for bad samples */
+  const smfQualSpans *qspans;   /* Index of good spans for "mask" */
 } smfFillGapsData;
 
 
 /* Prototype for the function to be executed in each thread. */
-static void smfFillGapsParallel( void *job_data_ptr, int *status );
+static void smfFillGapsParallel( void *job_data_ptr, size_t b1, size_t b2,
+                                 int *status );
 static void smf1_fillgap( double *data, int pstart, int pend, size_t tstride,
-                          int jstart, int jend, gsl_rng *r, int box, int minbox,
-                          int *status );
+                          int jstart, int jend, double *noise, dim_t ibolo,
+                          int box, int minbox, int *status );
+static void smf1_noise( dim_t ibolo, int jlo, int jhi, double *noise );
 
 void  smf_fillgaps( ThrWorkForce *wf, smfData *data,
                     smf_qual_t mask, int *status ) {
 
 /* Local Variables */
-  const gsl_rng_type *type;     /* GSL random number generator type */
-  dim_t bpt;                    /* Number of bolos per thread */
-  dim_t i;                      /* Bolometer index */
   dim_t nbolo;                  /* Number of bolos */
   dim_t ntslice;                /* Number of time slices */
   double *dat=NULL;             /* Pointer to bolo data */
+  int addnoise;                 /* Add noise to the filled values? */
   int box;
   int minbox;
   int fillpad;                  /* Fill PAD samples? */
@@ -206,9 +224,9 @@ void  smf_fillgaps( ThrWorkForce *wf, smfData *data,
   size_t pend;                  /* Last non-PAD sample */
   size_t pstart;                /* First non-PAD sample */
   size_t tstride;               /* time slice stride */
-  smfFillGapsData *job_data;    /* Structures holding data for worker threads */
-  smfFillGapsData *pdata;       /* Pointer to data for next worker thread */
+  smfFillGapsData job_data;     /* Description of the job for the threads */
   smf_qual_t *qua=NULL;         /* Pointer to quality array */
+  const smfQualSpans *qspans;   /* Index of good data spans */
 
 /* Main routine */
   if (*status != SAI__OK) return;
@@ -236,17 +254,6 @@ void  smf_fillgaps( ThrWorkForce *wf, smfData *data,
   smf_get_dims( data,  NULL, NULL, &nbolo, &ntslice, NULL, &bstride, &tstride,
                 status );
 
-  /* Determine how many bolometers to process in each thread, and create
-     the structures used to pass data to the threads. */
-  if( wf ) {
-     bpt = nbolo/wf->nworker;
-     if( wf->nworker*bpt < nbolo ) bpt++;
-     job_data = astMalloc( sizeof( smfFillGapsData )*wf->nworker );
-  } else {
-     bpt = nbolo;
-     job_data = astMalloc( sizeof( smfFillGapsData ) );
-  }
-
   /* Find the indices of the first and last non-PAD sample. */
   if( qua ) {
      smf_get_goodrange( qua, ntslice, tstride, SMF__Q_PAD, &pstart, &pend,
@@ -275,75 +282,59 @@ void  smf_fillgaps( ThrWorkForce *wf, smfData *data,
      fillpad = 0;
   }
 
-  /* Get the default GSL randim number generator type. A separate random
-     number generator is used for each worker thread so that the gap filling
-     process does not depend on the the order in which threads are
-     executed. */
-  type = gsl_rng_default;
+  /* If an index of the spans of good data has been created for the
+     quality bits being filled, use it in place of the quality array. */
+  qspans = qua ? smf_select_qspans( data, mask, status ) : NULL;
+
+  /* The noise added to each filled sample is a function only of the
+     bolometer and time slice indices (see smf1_noise), so the gap filling
+     does not depend on the number of threads or the order in which they
+     are executed, and each iteration fills each gap using the same
+     values. */
+  addnoise = 1;
 
   /* We use smaller boxes for very slow scans (sample rates under 20 Hz).
      For instance, POL-2 Stokes parameter data created by calcqu. Also,
-     we do not add noise for very slow scans, so set the random number
-     generator type NULL. */
+     we do not add noise for very slow scans. */
   if( 1.0/data->hdr->steptime < 20 ) {
     box = BOX/2;
     minbox = MINBOX/2;
-    type = NULL;
+    addnoise = 0;
   } else {
     box = BOX;
     minbox = MINBOX;
   }
 
-  /* Also set the random number generator type NULL if the user's config
-     indicates that no noise should be added to the gaps. This is useful
-     as an aid to convergence in makemap in cases where the source is
-     masked out over many iterations (e.g. FLT or PCA etc). In such cases
-     the different realisations of noise created by this function on each
-     iteration cause differences in the map created at the end of each
-     iteration, preventing confergence. */
-  if( !smf_get_global0I( "FILLGAPS_NOISE", 1, status ) ) type = NULL;
-
-  /* Begin a job context. */
-  thrBeginJobContext( wf, status );
-
-  /* Loop over bolometer in groups of "bpt". */
-  pdata = job_data;
-  for( i = 0; i < nbolo; i += bpt, pdata++ ) {
-
-    /* Store information for this group in the  next smfFillGapsData
-       structure. */
-    pdata->ntslice = ntslice;
-    pdata->dat = dat;
-    pdata->r = type ? gsl_rng_alloc( type ) : NULL;
-    pdata->b1 = i;
-    pdata->b2 = i + bpt - 1;
-    pdata->pend = pend;
-    pdata->fillpad = fillpad;
-    pdata->pstart = pstart;
-    if( pdata->b2 >= nbolo ) pdata->b2 = nbolo - 1;
-    pdata->bstride = bstride;
-    pdata->tstride = tstride;
-    pdata->qua = qua;
-    pdata->mask = mask;
-    pdata->box = box;
-    pdata->minbox = minbox;
-
-    /* Submit a job to the workforce to process this group of bolometers. */
-    (void) thrAddJob( wf, 0, pdata, smfFillGapsParallel, 0, NULL, status );
-  }
-
-  /* Wait until all jobs in the current job context have completed, and
-     then end the job context. */
-  thrWait( wf, status );
-  thrEndJobContext( wf, status );
-
-  /* Free resources. */
-  if( job_data ) {
-    pdata = job_data;
-    for( i = 0; i < nbolo; i += bpt, pdata++ ) {
-      if( pdata->r ) gsl_rng_free( pdata->r );
-    }
-    job_data = astFree( job_data );
+  /* Also add no noise if the user's config indicates that no noise should
+     be added to the gaps. This is useful as an aid to convergence in
+     makemap in cases where the source is masked out over many iterations
+     (e.g. FLT or PCA etc). In such cases the different realisations of
+     noise created by this function on each iteration cause differences
+     in the map created at the end of each iteration, preventing
+     confergence. */
+  if( !smf_get_global0I( "FILLGAPS_NOISE", 1, status ) ) addnoise = 0;
+
+  /* Store the information needed by the threads. */
+  job_data.ntslice = ntslice;
+  job_data.dat = dat;
+  job_data.addnoise = addnoise;
+  job_data.pend = pend;
+  job_data.fillpad = fillpad;
+  job_data.pstart = pstart;
+  job_data.bstride = bstride;
+  job_data.tstride = tstride;
+  job_data.qua = qua;
+  job_data.mask = mask;
+  job_data.qspans = qspans;
+  job_data.box = box;
+  job_data.minbox = minbox;
+
+  /* The time taken to fill a bolometer depends on how many gaps it has,
+     so let the workers claim blocks of bolometers dynamically rather than
+     giving each an equal share. */
+  if( nbolo > 0 && *status == SAI__OK ) {
+    thrParallelFor( wf, 0, nbolo - 1, 0, &job_data, smfFillGapsParallel,
+                    status );
   }
 }
 
@@ -351,9 +342,11 @@ void  smf_fillgaps( ThrWorkForce *wf, smfData *data,
 
 
 
-/* Function to be executed in thread: fill gaps in all bolos from b1 to b2 */
+/* Function called by thrParallelFor: fill gaps in all bolos from b1 to b2.
+   The job data is shared by all threads and is not modified. */
 
-static void smfFillGapsParallel( void *job_data_ptr, int *status ) {
+static void smfFillGapsParallel( void *job_data_ptr, size_t b1, size_t b2,
+                                 int *status ) {
 
 /* Local Variables */
   dim_t i;                      /* Bolometer index */
@@ -381,7 +374,7 @@ static void smfFillGapsParallel( void *job_data_ptr, int *status ) {
   double nx;                    /* Normalised distance into interpolation */
   double x[ 2*BOX ];            /* Array of sample positions */
   double y[ 2*BOX ];            /* Array of sample values */
-  gsl_rng *r;                   /* GSL random number generator */
+  double *noise = NULL;         /* Noise for each time slice, or NULL */
   int fillpad;                  /* Fill PAD samples ? */
   int good;                     /* Were any usable input values found? */
   int box;
@@ -393,8 +386,6 @@ static void smfFillGapsParallel( void *job_data_ptr, int *status ) {
   int leftstart;                /* Index at start of left hand patch */
   int rightend;                 /* Index at end of right hand patch */
   int rightstart;               /* Index at start of right hand patch */
-  size_t b1;                    /* Index of first bolometer to be filledd */
-  size_t b2;                    /* Index of last bolometer to be filledd */
   size_t bstride;               /* bolo stride */
   int pend;                     /* Last non-PAD sample */
   int pstart;                   /* First non-PAD sample */
@@ -403,18 +394,20 @@ static void smfFillGapsParallel( void *job_data_ptr, int *status ) {
   smf_qual_t *pq;
   smf_qual_t *qua = NULL;       /* Pointer to quality array */
   smf_qual_t mask;              /* Quality mask for bad samples */
+  const smfQualSpans *qspans;   /* Index of good data spans */
+  dim_t is;                     /* Span index */
+
+  /* Check inherited status */
+  if( *status != SAI__OK ) return;
 
   /* Pointer to the structure holding information needed by this thread. */
   pdata = (smfFillGapsData *) job_data_ptr;
 
   /* Copy data from the above structure into local variables. */
-  b1 = pdata->b1;
-  b2 = pdata->b2;
   bstride = pdata->bstride;
   dat = pdata->dat;
   ntslice = pdata->ntslice;
   qua = pdata->qua;
-  r = pdata->r;
   tstride = pdata->tstride;
   mask = pdata->mask;
   pend = pdata->pend;
@@ -422,15 +415,48 @@ static void smfFillGapsParallel( void *job_data_ptr, int *status ) {
   fillpad = pdata->fillpad;
   box = pdata->box;
   minbox = pdata->minbox;
+  qspans = pdata->qspans;
 
-
+  /* If noise is to be added, allocate a work array to hold the noise
+     for the samples being filled in the current bolometer. It is indexed
+     by time slice, but only the elements for the samples being filled
+     are assigned values. */
+  if( pdata->addnoise ) noise = astMalloc( ntslice*sizeof( *noise ) );
+  if( *status != SAI__OK ) return;
 
   /* Loop over bolometer */
   for( i = b1; i <= b2; i++ ) if( !qua || !(qua[ i*bstride ] & SMF__Q_BADB) ) {
 
-    /* First, for simplicity, ensure that all flagged samples have bad data
-       values. These are replaced with good values by the filling process. */
-    if( qua ) {
+    /* If an index of good data spans is available, a bolometer with no
+       spans has no usable data and is just set to zero (as it would be
+       below once all its samples had been set bad). Otherwise, set the
+       samples between the spans bad, without needing to look at the
+       quality of the samples within the spans. */
+    if( qspans ) {
+      if( qspans->first[ i ] == qspans->first[ i + 1 ] ) {
+        pd = dat + i*bstride;
+        for( j = 0; j < ntslice; j++ ) {
+          *pd = 0.0;
+          pd += tstride;
+        }
+        continue;
+      }
+
+      jstart = 0;
+      for( is = qspans->first[ i ]; is <= qspans->first[ i + 1 ]; is++ ) {
+        jj = ( is < qspans->first[ i + 1 ] ) ? qspans->spans[ 2*is ] : ntslice;
+        pd = dat + i*bstride + jstart*tstride;
+        for( j = jstart; j < jj; j++ ) {
+          *pd = VAL__BADD;
+          pd += tstride;
+        }
+        if( is < qspans->first[ i + 1 ] ) jstart = qspans->spans[ 2*is + 1 ] + 1;
+      }
+
+    /* Otherwise, for simplicity, ensure that all flagged samples have bad
+       data values. These are replaced with good values by the filling
+       process. */
+    } else if( qua ) {
       pd = dat + i*bstride;
       pq = qua + i*bstride;
       for( j = 0; j < ntslice; j++ ) {
@@ -457,7 +483,7 @@ static void smfFillGapsParallel( void *job_data_ptr, int *status ) {
       if( *pd != VAL__BADD ) {
          if( jstart < j ) {
             smf1_fillgap( dat + i*bstride, pstart, pend, tstride, jstart,
-                          j - 1, r, box, minbox, status );
+                          j - 1, noise, i, box, minbox, status );
          }
 
          /* Indicate the start of any subsequent gap is no sooner than the
@@ -473,8 +499,8 @@ static void smfFillGapsParallel( void *job_data_ptr, int *status ) {
 
     /* If a gap extends to the last sample, fill it. */
     if( good && jstart <= pend )  smf1_fillgap( dat + i*bstride, pstart, pend,
-                                                tstride, jstart, pend, r,
-                                                box, minbox, status );
+                                                tstride, jstart, pend, noise,
+                                                i, box, minbox, status );
 
    /* Replace the padding at the start and end of the bolometer time series
       with a noisey curve that connects the first and last data samples
@@ -493,6 +519,12 @@ static void smfFillGapsParallel( void *job_data_ptr, int *status ) {
 
       kpg1Fit1d( 1, k, y, x, &ml, &cl, &sigmal, status );
 
+      /* Get the noise for all the padding samples at start and end. */
+      if( noise ) {
+         smf1_noise( i, pend + 1, ntslice - 1, noise );
+         smf1_noise( i, 0, pstart - 1, noise );
+      }
+
       /* The main interpolation is performed using a single cubic curve
          that produces continuous values and gradients at the start and
 	 end of the interpolation. However, an unconstrained cubic can
@@ -513,7 +545,7 @@ static void smfFillGapsParallel( void *job_data_ptr, int *status ) {
          dg = ml/(2*box);
          for( jj = leftstart; jj <= leftend; jj++ ) {
             dat[ i*bstride + jj*tstride ] = meanl +
-                                            (r?gsl_ran_gaussian( r,sigmal ):0.0);
+                                            (noise?sigmal*noise[ jj ]:0.0);
             ml -= dg;
             meanl += ml;
          }
@@ -542,7 +574,7 @@ static void smfFillGapsParallel( void *job_data_ptr, int *status ) {
          dg = mr/(2*box);
          for( jj = rightend; jj >= rightstart; jj-- ) {
             dat[ i*bstride + jj*tstride ] = meanr +
-                                            (r?gsl_ran_gaussian( r, sigmar ):0.0);
+                                            (noise?sigmar*noise[ jj ]:0.0);
             mr -= dg;
             meanr -= mr;
          }
@@ -571,7 +603,7 @@ static void smfFillGapsParallel( void *job_data_ptr, int *status ) {
          nx = ( jj - leftend )/dlen;
          nx2 = nx*nx;
          dat[ i*bstride + jj*tstride ] = a*nx2*nx + b*nx2 + c*nx + d +
-                                         (r?gsl_ran_gaussian( r, e + nx*f ):0.0);
+                                         (noise?( e + nx*f )*noise[ jj ]:0.0);
       }
 
       /* Replace the padding at the start of the time stream. */
@@ -579,7 +611,7 @@ static void smfFillGapsParallel( void *job_data_ptr, int *status ) {
          nx = ( jj - leftend + ntslice )/dlen;
          nx2 = nx*nx;
          dat[ i*bstride + jj*tstride ] = a*nx2*nx + b*nx2 + c*nx + d +
-                                         (r?gsl_ran_gaussian( r, e + nx*f ):0.0);
+                                         (noise?( e + nx*f )*noise[ jj ]:0.0);
       }
 
 /* If no good samples were found, replace them all with zero. */
@@ -591,13 +623,15 @@ static void smfFillGapsParallel( void *job_data_ptr, int *status ) {
       }
     }
   }
+
+  noise = astFree( noise );
 }
 
 
 /* Fill a single gap in a single bolometer time-stream. */
 static void smf1_fillgap( double *data, int pstart, int pend, size_t tstride,
-                          int jstart, int jend, gsl_rng *r, int box, int minbox,
-                          int *status ){
+                          int jstart, int jend, double *noise, dim_t ibolo,
+                          int box, int minbox, int *status ){
 
 
 /* Local Variables: */
@@ -792,12 +826,21 @@ static void smf1_fillgap( double *data, int pstart, int pend, size_t tstride,
          grad = ( vr - vl )/ ( jend - jstart );
          offset = vl - grad*jstart;
 
-/* Replace the gap values with the straight line values, plus noise. */
+/* Replace the gap values with the straight line values, plus noise. The
+   noise for the whole gap is created first so that the loop that forms
+   the new values is simple. */
          pd = data + jstart*tstride;
-         if( sigma > 0.0 ) {
-            for( jj = jstart; jj <= jend; jj++ ) {
-               *pd = grad*jj + offset + (r?gsl_ran_gaussian( r, sigma ):0.0);
-               pd += tstride;
+         if( sigma > 0.0 && noise ) {
+            smf1_noise( ibolo, jstart, jend, noise );
+            if( tstride == 1 ) {
+               for( jj = jstart; jj <= jend; jj++ ) {
+                  pd[ jj - jstart ] = grad*jj + offset + sigma*noise[ jj ];
+               }
+            } else {
+               for( jj = jstart; jj <= jend; jj++ ) {
+                  *pd = grad*jj + offset + sigma*noise[ jj ];
+                  pd += tstride;
+               }
             }
          } else {
             for( jj = jstart; jj <= jend; jj++ ) {
@@ -826,3 +869,51 @@ static void smf1_fillgap( double *data, int pstart, int pend, size_t tstride,
 }
 
 
+
+
+/* Store standard Gaussian noise values for time slices "jlo" to "jhi" of
+   bolometer "ibolo" in the corresponding elements of "noise". The values
+   come from a counter-based generator: each pair of time slices {2n,2n+1}
+   is assigned two uniform deviates by hashing the bolometer index and "n"
+   (using the SplitMix64 finaliser), which are then converted into two
+   Gaussian deviates using the Box-Muller transform. So each value depends
+   only on the bolometer and time slice, and not on how the bolometers are
+   divided between threads or on which samples are being filled. */
+static void smf1_noise( dim_t ibolo, int jlo, int jhi, double *noise ){
+
+/* Local Variables: */
+   double rad;
+   double theta;
+   int jj;
+   uint64_t base;
+   uint64_t u1;
+   uint64_t u2;
+   uint64_t z;
+
+   if( jhi < jlo ) return;
+
+   base = NOISE_KEY*( (uint64_t) ibolo + 1 );
+
+/* Start at the even time slice that begins the pair holding "jlo". */
+   for( jj = jlo - ( jlo % 2 ); jj <= jhi; jj += 2 ) {
+
+/* Two uniform 64-bit values for this pair. */
+      z = base + 2*(uint64_t) jj + 1;
+      z = ( z ^ ( z >> 30 ) )*UINT64_C( 0xbf58476d1ce4e5b9 );
+      z = ( z ^ ( z >> 27 ) )*UINT64_C( 0x94d049bb133111eb );
+      u1 = z ^ ( z >> 31 );
+
+      z = base + 2*(uint64_t) jj + 2;
+      z = ( z ^ ( z >> 30 ) )*UINT64_C( 0xbf58476d1ce4e5b9 );
+      z = ( z ^ ( z >> 27 ) )*UINT64_C( 0x94d049bb133111eb );
+      u2 = z ^ ( z >> 31 );
+
+/* Box-Muller. The first uniform deviate is in (0,1] so that its log is
+   finite. */
+      rad = sqrt( -2.0*log( ( ( u1 >> 11 ) + 1 )*TWOM53 ) );
+      theta = 2*AST__DPI*( ( u2 >> 11 )*TWOM53 );
+
+      if( jj >= jlo ) noise[ jj ] = rad*cos( theta );
+      if( jj + 1 <= jhi ) noise[ jj + 1 ] = rad*sin( theta );
+   }
+}
@@ -48,9 +48,14 @@
 *        -Apply filter to the VARIANCE component if it is supplied
 *     2012-01-16 (DSB):
 *        Fix a memory leak (fdata was not closed).
+*     2026-10-14:
+*        Apply the filter in parallel, and complete the multiplication by
+*        a complex filter (previously the products were calculated but
+*        not stored).
 *
 *  Copyright:
 *     Copyright (C) 2011-2012 University of British Columbia.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -92,12 +97,22 @@
 
 #define FUNC_NAME "smf_filter2d_execute"
 
+/* Local data types */
+typedef struct smfFilter2dData {
+  double *data_r;               /* Real part of the transformed data */
+  double *data_i;               /* Imaginary part of the transformed data */
+  const smfFilter *filt;        /* The filter */
+} SmfFilter2dData;
+
+/* Prototypes for local static functions. */
+static void smf1_filter2d_apply( void *job_data_ptr, size_t i1, size_t i2,
+                                 int *status );
+
 void smf_filter2d_execute( ThrWorkForce *wf, smfData *data, smfFilter *filt,
                            int complement, int *status ) {
 
-  double *data_i=NULL;          /* Imaginary part of the transformed data */
-  double *data_r=NULL;          /* Real part of the transformed data */
   smfData *fdata=NULL;          /* Transform of data */
+  SmfFilter2dData job_data;     /* Data shared by the threads */
   dim_t fdims[2]={0,0};         /* Frequency dimensions */
   size_t i;                     /* loop counter */
   size_t ndims=0;               /* Number of real-space dimensions */
@@ -185,26 +200,14 @@ void smf_filter2d_execute( ThrWorkForce *wf, smfData *data, smfFilter *filt,
                                     SMF__NOCREATE_DA, 0, 0, status );
   }
 
-  /* Apply the frequency-domain filter. */
-  if( *status == SAI__OK ) {
-    data_r = fdata->pntr[0];
-    data_i = data_r + nfdata;
-
-    if( filt->isComplex ) {
-      double ac, bd, aPb, cPd;
-      for( i=0; i<nfdata; i++ ) {
-        ac = data_r[i] * filt->real[i];
-        bd = data_i[i] * filt->imag[i];
-
-        aPb = data_r[i] + data_i[i];
-        cPd = filt->real[i] + filt->imag[i];
-      }
-    } else {
-      for( i=0; i<nfdata; i++ ) {
-        data_r[i] *= filt->real[i];
-        data_i[i] *= filt->real[i];
-      }
-    }
+  /* Apply the frequency-domain filter, sharing the frequencies between
+     the threads. */
+  if( *status == SAI__OK && nfdata > 0 ) {
+    job_data.data_r = fdata->pntr[0];
+    job_data.data_i = job_data.data_r + nfdata;
+    job_data.filt = filt;
+    thrParallelFor( wf, 0, nfdata - 1, SMF__MIB/sizeof(double), &job_data,
+                    smf1_filter2d_apply, status );
   }
 
   /* Transform back */
@@ -327,3 +330,43 @@ void smf_filter2d_execute( ThrWorkForce *wf, smfData *data, smfFilter *filt,
   if( fdata ) smf_close_file( wf, &fdata, status );
 
 }
+
+static void smf1_filter2d_apply( void *job_data_ptr, size_t i1, size_t i2,
+                                 int *status ) {
+/*
+*  Name:
+*     smf1_filter2d_apply
+
+*  Purpose:
+*     Called by thrParallelFor to multiply a range of frequencies by the
+*     filter for smf_filter2d_execute.
+
+*/
+
+  SmfFilter2dData *pdata = job_data_ptr;
+  const smfFilter *filt = pdata->filt;
+  double *data_i = pdata->data_i;
+  double *data_r = pdata->data_r;
+  double ac, bd, aPb, cPd;      /* Components for complex multiplication */
+  size_t i;
+
+  if( *status != SAI__OK ) return;
+
+  if( filt->isComplex ) {
+    for( i=i1; i<=i2; i++ ) {
+      ac = data_r[i] * filt->real[i];
+      bd = data_i[i] * filt->imag[i];
+
+      aPb = data_r[i] + data_i[i];
+      cPd = filt->real[i] + filt->imag[i];
+
+      data_r[i] = ac - bd;
+      data_i[i] = aPb*cPd - ac - bd;
+    }
+  } else {
+    for( i=i1; i<=i2; i++ ) {
+      data_r[i] *= filt->real[i];
+      data_i[i] *= filt->real[i];
+    }
+  }
+}
@@ -68,10 +68,13 @@
 *        Add "smooth" option
 *     2012-01-20 (EC):
 *        First place pspec in high-res array, then do the smooth
+*     2026-10-14:
+*        smf_fft_2dazav API change.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2011-2012 University of British Columbia.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -163,7 +166,7 @@ void smf_filter2d_whiten( ThrWorkForce *wf, smfFilter *filt, smfData *map,
   /* Calculate azimuthally-averaged angular power spectrum */
   map_fft = smf_fft_data( wf, map, NULL, 0, 0, status );
   smf_fft_cart2pol( wf, map_fft, 0, 1, status );
-  pspec = smf_fft_2dazav( map_fft, &df, status );
+  pspec = smf_fft_2dazav( wf, map_fft, &df, status );
   if( *status == SAI__OK ) {
     nf = pspec->dims[0];
     pspec_data = pspec->pntr[0];
@@ -103,6 +103,8 @@
 *        COM model).
 *     2014-8-18 (DSB):
 *        Ensure any BADDA samples have a bad data value on exit.
+*     14-OCT-2026:
+*        Create an index of good data spans for use by smf_fillgaps.
 
 *  Copyright:
 *     Copyright (C) 2011-2014 Science & Technology Facilities Council.
@@ -131,7 +133,7 @@
 */
 
 /* System includes */
-#include <pthread.h>
+#include <string.h>
 
 /* Starlink includes */
 #include "mers.h"
@@ -150,8 +152,6 @@
 /* ------------------------------------------------------------------------ */
 /* Local variables and functions */
 
-pthread_mutex_t smf_filter_execute_mutex = PTHREAD_MUTEX_INITIALIZER;
-
 /* Structure containing information about blocks of bolos to be
    filtered by each thread. All threads read/write to/from mutually
    exclusive parts of the master smfData so we don't need to make
@@ -161,12 +161,11 @@ typedef struct smfFilterExecuteData {
   size_t b2;               /* Index of last bolometer to be filtered */
   int complement;          /* Using complementary filter */
   smfData *data;           /* Pointer to master smfData */
-  double *data_fft_r;      /* Real part of the data FFT (1-bolo) */
-  double *data_fft_i;      /* Imaginary part of the data FFT (1-bolo)*/
+  double *data_fft_r;      /* Real part of the data FFT (1 batch) */
+  double *data_fft_i;      /* Imaginary part of the data FFT (1 batch) */
   smfFilter *filt;         /* Pointer to the filter */
   int ijob;                /* Job identifier */
-  fftw_plan plan_forward;  /* for forward transformation */
-  fftw_plan plan_inverse;  /* for inverse transformation */
+  dim_t nbatch;            /* Max. number of bolos transformed together */
   smf_qual_t *qua;         /* quality pointer */
   int whiten;              /* should the data be whitened? */
 } smfFilterExecuteData;
@@ -176,14 +175,23 @@ typedef struct smfFilterExecuteData {
 
 void smfFilterExecuteParallel( void *job_data_ptr, int *status );
 
+/* Return a plan that transforms a batch of bolometers */
+static fftw_plan smf1_batch_plan( int inverse, dim_t ntslice, dim_t nf,
+                                  dim_t nb, double *real, double *re,
+                                  double *im, int *status );
+
 void smfFilterExecuteParallel( void *job_data_ptr, int *status ) {
   double ac, bd, aPb, cPd;      /* Components for complex multiplication */
   double *base=NULL;            /* Pointer to start of current bolo in array */
+  size_t *bolos=NULL;           /* Indices of the bolometers in the batch */
   size_t bstride;               /* Bolometer stride */
   double *data_fft_r=NULL;      /* Real part of the data FFT */
   double *data_fft_i=NULL;      /* Imaginary part of the data FFT */
   smfData *data=NULL;           /* smfData that we're working on */
   double *dmask = NULL;         /* Array holding data values to be filtered */
+  double *dmrow;                /* Data values for one bolometer in batch */
+  double *fft_r;                /* Real part of FFT for one bolo in batch */
+  double *fft_i;                /* Imag part of FFT for one bolo in batch */
   double fac;                   /* Factor for scaling the ral and imag parts */
   double fr;                    /* Real filter value */
   double fi;                    /* Imaginary filter value */
@@ -195,8 +203,13 @@ void smfFilterExecuteParallel( void *job_data_ptr, int *status ) {
   int iloop;                    /* Loop counter */
   int invert;                   /* Invert the filter to produce a low pass filter? */
   size_t j;                     /* Loop counter */
+  dim_t k;                      /* Index of bolometer within batch */
   double *mask = NULL;          /* Array holding mask values to be filtered */
+  double *mrow;                 /* Mask values for one bolometer in batch */
+  dim_t nb;                     /* Number of bolometers in current batch */
   dim_t nbolo;                  /* Number of bolometers */
+  dim_t nf;                     /* Number of frequencies */
+  fftw_plan plan;               /* Plan for current batch */
   int newalg;                   /* Use new algorithm for handling missing data? */
   dim_t ntslice;                /* Number of time slices */
   smf_qual_t *qua=NULL;         /* pointer to quality */
@@ -343,27 +356,35 @@ void smfFilterExecuteParallel( void *job_data_ptr, int *status ) {
     use_filt_i = filt->imag;
   }
 
-  /* Allocate work arrays to hold the mask and the masked data array */
-  if( newalg ) {
-    mask = astMalloc( ntslice*sizeof( *mask ) );
-    dmask = astMalloc( ntslice*sizeof( *dmask ) );
-  }
+  /* Allocate work arrays to hold the mask and the masked data array for
+     a batch of bolometers. The bolometers in a batch are transformed
+     together using a single strided FFTW plan, which has much lower
+     overheads than transforming them one at a time. */
+  nf = filt->fdims[0];
+  bolos = astMalloc( pdata->nbatch*sizeof( *bolos ) );
+  dmask = astMalloc( pdata->nbatch*ntslice*sizeof( *dmask ) );
+  if( newalg ) mask = astMalloc( pdata->nbatch*ntslice*sizeof( *mask ) );
 
   /* Loop round filtering all bolometers. */
-  for( i=pdata->b1; (*status==SAI__OK) && (i<=pdata->b2); i++ ) {
-    qbase = qua ? qua + i*bstride : NULL;
+  i = pdata->b1;
+  while( (*status==SAI__OK) && (i<=pdata->b2) ) {
 
-    if( !qbase || !(qbase[0]&SMF__Q_BADB) ) { /* Check for bad bolo flag */
+    /* Copy the next batch of usable bolometers into the work arrays. */
+    for( nb = 0; (i<=pdata->b2) && (nb<pdata->nbatch); i++ ) {
+      qbase = qua ? qua + i*bstride : NULL;
+      if( qbase && (qbase[0]&SMF__Q_BADB) ) continue; /* Check bad bolo flag */
 
-      /* Obtain pointer to the correct chunk of data */
       base = data->pntr[0];
       base += i*bstride;
+      dmrow = dmask + nb*ntslice;
+      bolos[ nb++ ] = i;
 
       /* Create a mask array that is the same length as the data array,
          with 1.0 at every usable data value and 0.0 at every unusable
          data value. At the same time, create a new data array by
          multiplying the original data array by this mask. */
       if( newalg ) {
+         mrow = mask + ( nb - 1 )*ntslice;
          for( j = 0; j < ntslice; j++ ){
 
             if( base[ j ] == VAL__BADD ){
@@ -375,40 +396,48 @@ void smfFilterExecuteParallel( void *job_data_ptr, int *status ) {
                break;
 
             } else if( !qbase || !( qbase[ j ] & SMF__Q_GOOD ) ) {
-               mask[ j ] = 1.0;
-               dmask[ j ] = base[ j ];
+               mrow[ j ] = 1.0;
+               dmrow[ j ] = base[ j ];
 
             } else {
-               mask[ j ] = 0.0;
-               dmask[ j ] = 0.0;
+               mrow[ j ] = 0.0;
+               dmrow[ j ] = 0.0;
             }
          }
 
       } else {
-         dmask = base;
+         memcpy( dmrow, base, ntslice*sizeof( *dmrow ) );
       }
+    }
+
+    if( nb == 0 || *status != SAI__OK ) break;
 
-      /* Loop to filter first the masked data array, and then the mask,
-         using the same filter. */
-      for( iloop = 0; iloop < ( newalg ? 2 : 1 ); iloop++ ) {
-         base = iloop ? mask : dmask;
+    /* Loop to filter first the masked data arrays, and then the masks,
+       using the same filter. */
+    for( iloop = 0; iloop < ( newalg ? 2 : 1 ); iloop++ ) {
+       base = iloop ? mask : dmask;
 
-         /* Execute forward transformation using the guru interface */
-         fftw_execute_split_dft_r2c( pdata->plan_forward, base,
-                                     data_fft_r, data_fft_i );
+       /* Execute forward transformation of the whole batch using the guru
+          interface */
+       plan = smf1_batch_plan( 0, ntslice, nf, nb, base, data_fft_r,
+                               data_fft_i, status );
+       if( *status != SAI__OK ) break;
+       fftw_execute_split_dft_r2c( plan, base, data_fft_r, data_fft_i );
+
+       for( k = 0; (*status==SAI__OK) && (k<nb); k++ ) {
+         fft_r = data_fft_r + k*nf;
+         fft_i = data_fft_i + k*nf;
 
          /* Apply 1/N normalization */
-         if( *status == SAI__OK ) {
-           double val = 1. / (double) filt->rdims[0];
-           for( j=0; j<filt->fdims[0]; j++ ) {
-             data_fft_r[j] *= val;
-             data_fft_i[j] *= val;
-           }
+         double val = 1. / (double) filt->rdims[0];
+         for( j=0; j<nf; j++ ) {
+           fft_r[j] *= val;
+           fft_i[j] *= val;
          }
 
          /* Whiten the power spectrum if requested. */
          if( (iloop==0) && (pdata->whiten) ) {
-           smf_whiten( data_fft_r, data_fft_i, filt->df[0], filt->fdims[0], 50,
+           smf_whiten( fft_r, fft_i, filt->df[0], nf, 50,
                        pdata->complement, status );
          }
 
@@ -416,31 +445,41 @@ void smfFilterExecuteParallel( void *job_data_ptr, int *status ) {
             filter values are NULL (i.e. if we are only whitening) */
          if( use_filt_r && (*status==SAI__OK) ) {
            if( filt->isComplex ) {
-             for( j=0; j<filt->fdims[0]; j++ ) {
+             for( j=0; j<nf; j++ ) {
                /* Complex times complex, using only 3 multiplies */
-               ac = data_fft_r[j] * use_filt_r[j];
-               bd = data_fft_i[j] * use_filt_i[j];
+               ac = fft_r[j] * use_filt_r[j];
+               bd = fft_i[j] * use_filt_i[j];
 
-               aPb = data_fft_r[j] + data_fft_i[j];
+               aPb = fft_r[j] + fft_i[j];
                cPd = use_filt_r[j] + use_filt_i[j];
 
-               data_fft_r[j] = ac - bd;
-               data_fft_i[j] = aPb*cPd - ac - bd;
+               fft_r[j] = ac - bd;
+               fft_i[j] = aPb*cPd - ac - bd;
              }
            } else {
-             for( j=0; j<filt->fdims[0]; j++ ) {
+             for( j=0; j<nf; j++ ) {
                /* Complex times real */
-               data_fft_r[j] *= use_filt_r[j];
-               data_fft_i[j] *= use_filt_r[j];
+               fft_r[j] *= use_filt_r[j];
+               fft_i[j] *= use_filt_r[j];
              }
            }
          }
+       }
 
-         /* Perform inverse transformation using guru interface */
-         fftw_execute_split_dft_c2r( pdata->plan_inverse, data_fft_r,
-                                     data_fft_i, base );
-      }
+       /* Perform inverse transformation of the batch using guru interface */
+       plan = smf1_batch_plan( 1, ntslice, nf, nb, base, data_fft_r,
+                               data_fft_i, status );
+       if( *status != SAI__OK ) break;
+       fftw_execute_split_dft_c2r( plan, data_fft_r, data_fft_i, base );
+    }
 
+    /* Copy the filtered data for each bolometer in the batch back into the
+       smfData. */
+    for( k = 0; (*status==SAI__OK) && (k<nb); k++ ) {
+      qbase = qua ? qua + bolos[ k ]*bstride : NULL;
+      base = data->pntr[0];
+      base += bolos[ k ]*bstride;
+      dmrow = dmask + k*ntslice;
 
       /* Divide the filtered masked data array by the filtered mask,
          thus normalising the filtered data and removing any ringing
@@ -456,14 +495,13 @@ void smfFilterExecuteParallel( void *job_data_ptr, int *status ) {
 	 subtracting the filtered (and normalised) data from the supplied
 	 data. */
       if( newalg ) {
-        base = data->pntr[0];
-        base += i*bstride;
+        mrow = mask + k*ntslice;
 
         if( invert ) {
 
           for( j = 0; j < ntslice; j++ ){
-            if( mask[ j ] >= filt->wlim && mask[ j ] != 0.0 ) {
-              base[ j ] -= dmask[ j ]/mask[ j ];
+            if( mrow[ j ] >= filt->wlim && mrow[ j ] != 0.0 ) {
+              base[ j ] -= dmrow[ j ]/mrow[ j ];
 
             /* If the current filtered data value has contributions from
                an insufficient faction of good input data values, flag
@@ -476,21 +514,22 @@ void smfFilterExecuteParallel( void *job_data_ptr, int *status ) {
         } else {
 
           for( j = 0; j < ntslice; j++ ){
-            if( mask[ j ] >= filt->wlim && mask[ j ] != 0.0 ) {
-              base[ j ] = dmask[ j ]/mask[ j ];
+            if( mrow[ j ] >= filt->wlim && mrow[ j ] != 0.0 ) {
+              base[ j ] = dmrow[ j ]/mrow[ j ];
             } else if( qbase ) {
               qbase[ j ] |= SMF__Q_FILT;
             }
           }
 
         }
+
+      } else {
+        memcpy( base, dmrow, ntslice*sizeof( *base ) );
       }
 
       /* If a quality array is present ensure any BADDA samples have a
          bad data value on exit. */
       if( qbase ) {
-        base = data->pntr[0];
-        base += i*bstride;
         for( j = 0; j < ntslice; j++ ){
           if( qbase[ j ] & SMF__Q_BADDA ) base[ j ] = VAL__BADD;
         }
@@ -499,12 +538,11 @@ void smfFilterExecuteParallel( void *job_data_ptr, int *status ) {
   }
 
   /* Free work arrays */
-  if( newalg ) {
-     mask = astFree( mask );
-     dmask = astFree( dmask );
-     inv_filt_r = astFree( inv_filt_r );
-     inv_filt_i = astFree( inv_filt_i );
-  }
+  bolos = astFree( bolos );
+  mask = astFree( mask );
+  dmask = astFree( dmask );
+  inv_filt_r = astFree( inv_filt_r );
+  inv_filt_i = astFree( inv_filt_i );
 
   msgOutiff( SMF__TIMER_MSG, "",
              "smfFilterExecuteParallel: thread finishing bolos %zu -- %zu",
@@ -512,6 +550,27 @@ void smfFilterExecuteParallel( void *job_data_ptr, int *status ) {
 
 }
 
+/* Return a plan that transforms "nb" contiguous time series of length
+   "ntslice", each with "nf" frequencies. The plan is cached by
+   smf_fftw_plan, so there is at most one plan for each batch size. */
+static fftw_plan smf1_batch_plan( int inverse, dim_t ntslice, dim_t nf,
+                                  dim_t nb, double *real, double *re,
+                                  double *im, int *status ) {
+  fftw_iodim dims;
+  fftw_iodim howmany;
+
+  dims.n = ntslice;
+  dims.is = 1;
+  dims.os = 1;
+
+  howmany.n = nb;
+  howmany.is = inverse ? nf : ntslice;
+  howmany.os = inverse ? ntslice : nf;
+
+  return smf_fftw_plan( inverse, 1, &dims, 1, &howmany, 1, real, re, im,
+                        status );
+}
+
 /* ------------------------------------------------------------------------ */
 
 #define FUNC_NAME "smf_filter_execute"
@@ -521,11 +580,11 @@ void smf_filter_execute( ThrWorkForce *wf, smfData *data, smfFilter *filt,
 
   /* Local Variables */
   size_t apod_length=0;           /* apodization length */
-  fftw_iodim dims;                /* I/O dimensions for transformations */
   size_t first;                   /* First sample apodization at start */
   int i;                          /* Loop counter */
   smfFilterExecuteData *job_data=NULL;/* Array of job data for each thread */
   size_t last;                    /* Last sample apodization at end */
+  dim_t nbatch;                   /* Max. number of bolos in an FFT batch */
   dim_t nbolo=0;                  /* Number of bolometers */
   dim_t ndata=0;                  /* Total number of data points */
   int nw;                         /* Number of worker threads */
@@ -601,22 +660,28 @@ void smf_filter_execute( ThrWorkForce *wf, smfData *data, smfFilter *filt,
      the artifical data used for padding based on the current contents of
      the smfData. */
   if( apod_length == SMF__BADSZT ) {
+    if( qua ) smf_qspans_update( wf, data, SMF__Q_GAP, status );
     smf_fillgaps( wf, data, SMF__Q_PAD | SMF__Q_GAP, status );
 
   /* If apodising is switched on, fill the data (retaining the zero padding)
      and apodise the data. */
   } else {
+    if( qua ) smf_qspans_update( wf, data, SMF__Q_GAP, status );
     smf_fillgaps( wf, data, SMF__Q_GAP, status );
     if( apod_length > 0 ) smf_apodize( data, apod_length, 1, status );
   }
 
-  /* Describe the input and output array dimensions for FFTW guru interface.
-     - dims describes the length and stepsize of time slices within a bolometer
-  */
+  /* The index of good data spans used by smf_fillgaps is freed straight
+     away, since it is not updated when the quality changes (for
+     instance by smf_apodize). */
+  if( qua ) smf_qspans_update( wf, data, 0, status );
 
-  dims.n = ntslice;
-  dims.is = 1;
-  dims.os = 1;
+  /* Each thread transforms its bolometers in batches of up to
+     SMF__FFTBATCH time series. Limit the batch size so that the work
+     arrays for each thread do not become too large. */
+  nbatch = SMF__FFTBATCH_MAXSIZE/( ntslice*sizeof( double ) );
+  if( nbatch > SMF__FFTBATCH ) nbatch = SMF__FFTBATCH;
+  if( nbatch < 1 ) nbatch = 1;
 
   /* Set up the job data */
 
@@ -640,59 +705,20 @@ void smf_filter_execute( ThrWorkForce *wf, smfData *data, smfFilter *filt,
     pdata->data = data;
     pdata->qua = qua;
 
-    pdata->data_fft_r = astMalloc(filt->fdims[0]*sizeof(*pdata->data_fft_r));
-    pdata->data_fft_i = astMalloc(filt->fdims[0]*sizeof(*pdata->data_fft_i));
+    pdata->nbatch = nbatch;
+    pdata->data_fft_r = astMalloc(nbatch*filt->fdims[0]*
+                                  sizeof(*pdata->data_fft_r));
+    pdata->data_fft_i = astMalloc(nbatch*filt->fdims[0]*
+                                  sizeof(*pdata->data_fft_i));
     pdata->filt = filt;
     pdata->whiten = whiten;
     pdata->complement = complement;
     pdata->ijob = -1;   /* Flag job as ready to start */
 
-    /* Setup forward FFT plan using guru interface. Requires protection
-       with a mutex */
-    thrMutexLock( &smf_filter_execute_mutex, status );
-
-    if( *status == SAI__OK ) {
-      /* Just use the data_fft_* arrays from the first chunk of job data since
-         the guru interface allows you to use the same plans for multiple
-         transforms. */
-      pdata->plan_forward = fftw_plan_guru_split_dft_r2c( 1, &dims, 0, NULL,
-                                                          data->pntr[0],
-                                                          pdata->data_fft_r,
-                                                          pdata->data_fft_i,
-                                                          FFTW_ESTIMATE |
-                                                          FFTW_UNALIGNED );
-    }
-
-    thrMutexUnlock( &smf_filter_execute_mutex, status );
-
-    if( !pdata->plan_forward && (*status == SAI__OK) ) {
-      *status = SAI__ERROR;
-      errRep( "", FUNC_NAME
-              ": FFTW3 could not create plan for forward transformation",
-              status);
-    }
-
-    /* Setup inverse FFT plan using guru interface */
-    thrMutexLock( &smf_filter_execute_mutex, status );
-
-    if( *status == SAI__OK ) {
-      pdata->plan_inverse = fftw_plan_guru_split_dft_c2r( 1, &dims, 0, NULL,
-                                                          pdata->data_fft_r,
-                                                          pdata->data_fft_i,
-                                                          data->pntr[0],
-                                                          FFTW_ESTIMATE |
-                                                          FFTW_UNALIGNED);
-    }
-
-    thrMutexUnlock( &smf_filter_execute_mutex, status );
-
-    if( !pdata->plan_inverse && (*status==SAI__OK) ) {
-      *status = SAI__ERROR;
-      errRep( "", FUNC_NAME
-              ": FFTW3 could not create plan for inverse transformation",
-              status);
-    }
-
+    /* The forward and inverse FFT plans for each batch are obtained
+       from smf_fftw_plan within smfFilterExecuteParallel. They are
+       cached, so are only created the first time a batch of time
+       streams of this length is filtered. */
   }
 
   /* Execute the filter */
@@ -712,12 +738,6 @@ void smf_filter_execute( ThrWorkForce *wf, smfData *data, smfFilter *filt,
       pdata = job_data + i;
       if( pdata->data_fft_r ) pdata->data_fft_r = astFree( pdata->data_fft_r );
       if( pdata->data_fft_i ) pdata->data_fft_i = astFree( pdata->data_fft_i );
-
-      /* Destroy the plans */
-      thrMutexLock( &smf_filter_execute_mutex, status );
-      fftw_destroy_plan( pdata->plan_forward );
-      fftw_destroy_plan( pdata->plan_inverse );
-      thrMutexUnlock( &smf_filter_execute_mutex, status );
     }
     job_data = astFree( job_data );
   }
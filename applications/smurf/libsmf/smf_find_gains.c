@@ -221,11 +221,17 @@
 *        bolo-blocks), then ensure bad bolo blocks are not flagged (i.e.
 *        make sure the behaviour is the same as if the NOFLAG config 
 *        parameter is set).
+*     14-OCT-2026:
+*        Fit all the bolometers handled by each thread together, block by
+*        block, accumulating the sums for the normal equations in a single
+*        pass through the data in memory order, rather than calling
+*        smf_templateFit1D for each bolo-block.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2010-2012 Science & Technology Facilities Council.
 *     Copyright (C) 2011 University of British Columbia.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -249,6 +255,10 @@
 *-
 */
 
+/* System includes */
+#include <math.h>
+#include <string.h>
+
 /* Starlink includes */
 #include "ast.h"
 #include "mers.h"
@@ -290,8 +300,33 @@ typedef struct smfFindGainsJobData {
 } smfFindGainsJobData;
 
 
+/* Macro to accumulate the sums needed to fit the template to every
+   active bolometer in a block, for a single time slice holding template
+   value "t". The bolometers are innermost so that for time-ordered data
+   the loop runs over contiguous memory. Rejected samples contribute zero
+   rather than being skipped, so the loop has no branches and can be
+   vectorised. The sums for each bolometer are still formed in time order,
+   so they are identical to those formed by smf_templateFit1D. */
+#define FIND_SUMS \
+   for( jbolo = 0; jbolo < nb; jbolo++ ) { \
+      off = ibase + jbolo*bstride; \
+      good = ( active[ jbolo ] && GOOD_VAL ); \
+      d = good ? dat[ off ] : 0.0; \
+      w = good ? 1.0 : 0.0; \
+      s_d[ jbolo ] += d; \
+      s_dsq[ jbolo ] += d*d; \
+      s_dt[ jbolo ] += d*t; \
+      s_t[ jbolo ] += w*t; \
+      s_tsq[ jbolo ] += w*tsq; \
+      s_n[ jbolo ] += w; \
+   }
+
 /* Local function prototypes: */
 static void smf1_find_gains_job( void *job_data, int *status );
+static int smf1_find_gains_fit( double s_n, double s_d, double s_dsq,
+                                double s_dt, double s_t, double s_tsq,
+                                int nooffs, double *gain, double *offset,
+                                double *corr );
 
 
 /* Main entry */
@@ -1024,6 +1059,15 @@ static void smf1_find_gains_job( void *job_data, int *status ) {
 *     This routine performs a least squares linear fit between the
 *     data values in each bolo block, and the supplied template. It
 *     runs within a thread instigated by smf_find_gains.
+*
+*     All the bolometers handled by the thread are fitted together, one
+*     block at a time. The sums needed by the normal equations are
+*     accumulated for every bolometer in a single pass through the block,
+*     with the bolometer loop innermost for time-ordered data and the time
+*     loop innermost for bolometer-ordered data, so that the data are
+*     always read in memory order. The gain, offset and correlation
+*     coefficient are then found from the sums for every bolometer
+*     in the same way as smf_templateFit1D.
 
 */
 
@@ -1034,43 +1078,62 @@ static void smf1_find_gains_job( void *job_data, int *status ) {
    dim_t b2;
    dim_t block_cstride;
    dim_t block_size;
-   dim_t block_tstride;
+   dim_t corr_offset;
    dim_t fit_box;
    dim_t gain_box;
    dim_t iblock;
-   dim_t ibolo;
+   dim_t itime;
+   dim_t jbolo;
+   dim_t nb;
    dim_t nblock;
    dim_t nbolo;
    dim_t ntime;
    dim_t ntslice;
    double *dat;
    double *gai;
-   double *m;
    double *m_box;
+   double *s_d;
+   double *s_dsq;
+   double *s_dt;
+   double *s_n;
+   double *s_t;
+   double *s_tsq;
+   double *sums;
    double *template;
+   double d;
+   double sd;
+   double sdsq;
+   double sdt;
+   double sn;
+   double st;
+   double stsq;
+   double t;
+   double tsq;
+   double w;
    int *converged;
    int delta_box;
-   dim_t corr_offset;
    int fit_end;
-   int fit_off;
-   int fit_size;
    int fit_start;
+   int good;
+   int nactive;
    int nogains;
    int nooffs;
+   int usemask;
    size_t box_end;
    size_t box_start;
    size_t bstride;
    size_t gbstride;
    size_t gcstride;
    size_t ibase;
-   size_t ibase_box;
    size_t igbase;
+   size_t off;
    size_t tstride;
    smfFindGainsJobData *pdata;
    smf_qual_t *qua;
    smf_qual_t goodqual;
    struct timeval tv1;
    struct timeval tv2;
+   unsigned char *active;
 
 /* Check inherited status */
    if( *status != SAI__OK ) return;
@@ -1109,48 +1172,72 @@ static void smf1_find_gains_job( void *job_data, int *status ) {
                  " -- %" DIM_T_FMT, status, b1, b2 );
       smf_timerinit( &tv1, &tv2, status);
 
+/* Allocate work arrays holding the sums for each bolometer processed by
+   this thread, and a flag for each bolometer indicating if it is to be
+   fitted in the current block. */
+      nb = b2 - b1 + 1;
+      sums = astMalloc( 6*nb*sizeof( *sums ) );
+      active = astMalloc( nb*sizeof( *active ) );
+      if( *status == SAI__OK ) {
+         s_d = sums;
+         s_dsq = s_d + nb;
+         s_dt = s_dsq + nb;
+         s_t = s_dt + nb;
+         s_tsq = s_t + nb;
+         s_n = s_tsq + nb;
+
+/* The mask is only used if a LUT is also available (as in
+   smf_templateFit1D). */
+         usemask = ( mask && lut_data );
+
 /* Get the number of samples within the fit_box that overhang at each end
    of the gain_box. */
-      delta_box = ( fit_box - gain_box )/2;
+         delta_box = ( fit_box - gain_box )/2;
 
 /* Get the strides between coefficients for adjacent blocks within "gai". */
-      block_cstride = gcstride*nblock;
-
-/* Get the strides between first time slices for adjacent blocks within
-   "dat". */
-      block_tstride = gain_box*tstride;
+         block_cstride = gcstride*nblock;
 
 /* Get the vector offsets within "gai", from a gain value to the
    corresponding correlation coefficient. */
-      corr_offset = 2*block_cstride;
-
-/* Loop round all the bolometers to be processed by this thread. */
-      for( ibolo = b1; ibolo <= b2 && *status == SAI__OK; ibolo++ ) {
-
-/* Get the vector offset within "dat" at the start of the first block in
-   the current bolometer. */
-         ibase = ibolo*bstride;
-
-/* Get the vector offset within "gai" for the gain value for the first block
-   of the current bolometer. */
-         igbase = ibolo*gbstride;
-
-/* Check the bolometer is not entirely bad. */
-         if( !( qua[ ibase ] & SMF__Q_BADB ) ) {
+         corr_offset = 2*block_cstride;
+
+/* Store bad correlation values for every block of any bolometer that is
+   entirely bad, so later code sees it as being equivalent to "rejected
+   on entry". */
+         for( jbolo = 0; jbolo < nb; jbolo++ ) {
+            if( qua[ ( b1 + jbolo )*bstride ] & SMF__Q_BADB ) {
+               igbase = ( b1 + jbolo )*gbstride;
+               for( iblock = 0; iblock < nblock; iblock++ ){
+                  gai[ igbase + corr_offset ] = VAL__BADD;
+                  igbase += gcstride;
+               }
+            }
+         }
 
 /* Initialise the number of time slices still to be processed, and then
    loop round each block of time slices, fitting the template to the
-   bolometer signal and finding a gain, offset and correlation for each
-   block. The final block may contain more than "gain_box" slices. */
-            ntime = ntslice;
-            m = template;
-            for( iblock = 0; iblock < nblock && *status == SAI__OK; iblock++ ){
+   bolometer signals and finding a gain, offset and correlation for each
+   bolo-block. The final block may contain more than "gain_box" slices. */
+         ntime = ntslice;
+         for( iblock = 0; iblock < nblock && *status == SAI__OK; iblock++ ){
 
 /* If the block has converged, then we do not need to re-calculate the
-   gains and offsets since they will not have changed. Also do not
+   gains and offsets since they will not have changed. */
+            if( ! converged[ iblock ] ) {
+
+/* Flag the bolometers that need fitting in this block. Do not
    re-calculate the gain and offset for any bolo-block that has
-   previously been rejected. */
-               if( ! converged[ iblock ] && gai[ igbase + corr_offset ] != VAL__BADD ) {
+   previously been rejected (this includes all blocks of bad
+   bolometers). */
+               nactive = 0;
+               igbase = b1*gbstride + iblock*gcstride;
+               for( jbolo = 0; jbolo < nb; jbolo++ ) {
+                  active[ jbolo ] = ( gai[ igbase + corr_offset ] != VAL__BADD );
+                  if( active[ jbolo ] ) nactive++;
+                  igbase += gbstride;
+               }
+
+               if( nactive > 0 ) {
 
 /* Calculate the number of time slices in this block. The last block (index
    iblock-1 ) contains all remaining time slices, which may not be gain_box
@@ -1169,53 +1256,106 @@ static void smf1_find_gains_job( void *job_data, int *status ) {
                   if( fit_start < 0 ) fit_start = 0;
                   if( fit_end >= (int) ntslice ) fit_end = ntslice - 1;
 
-                  fit_off = box_start - fit_start;
-                  fit_size = fit_end - fit_start + 1;
-
-/* Get the index for the first data value to be included in the fit. Also get
-   a pointer to the first template value. */
-                  ibase_box = ibase - fit_off*tstride;
-                  m_box = m - fit_off;
-
-/* Do the fit. */
-                  smf_templateFit1D( dat + ibase_box, qua + ibase_box, mask,
-                                     lut_data ? lut_data + ibase_box : NULL,
-                                     goodqual, 0, fit_size, tstride, m_box,
-                                     0, nooffs, gai + igbase,
-                                     gai + block_cstride + igbase,
-                                     gai + 2*block_cstride + igbase, status );
-
-/* If no fit could be performed, annul the error and store a gain value
-   of NOFIT. */
-                  if( *status == SMF__DIVBZ || *status == SMF__INSMP ) {
-                     errAnnul( status );
-                     gai[ igbase ] = NOFIT;
-
-/* If we are ignoring gains, force gains to 1.0. Retain the correlation
-   coeffs in order to flag bad blocks. The ignoring of offsets is handled
-   by smf_templateFit1D above. */
-                  } else if( nogains ) {
-                     gai[ igbase ] = 1.0;
+/* Get a pointer to the first template value in the fit. */
+                  m_box = template + fit_start;
+
+/* For time-ordered data, the values for adjacent bolometers are
+   contiguous, so accumulate the sums for all bolometers together, one
+   time slice at a time. Time slices with a bad template value are
+   ignored by every bolometer. */
+                  if( bstride < tstride ) {
+                     memset( sums, 0, 6*nb*sizeof( *sums ) );
+
+                     for( itime = 0; itime <= (dim_t)( fit_end - fit_start ); itime++ ) {
+                        t = m_box[ itime ];
+                        if( t != VAL__BADD ) {
+                           tsq = t*t;
+                           ibase = b1*bstride + ( fit_start + itime )*tstride;
+
+                           if( usemask ) {
+                              #define GOOD_VAL ( !( qua[ off ] & goodqual ) && \
+                                                 lut_data[ off ] != VAL__BADI && \
+                                                 mask[ lut_data[ off ] ] )
+                              FIND_SUMS
+                              #undef GOOD_VAL
+                           } else {
+                              #define GOOD_VAL ( !( qua[ off ] & goodqual ) )
+                              FIND_SUMS
+                              #undef GOOD_VAL
+                           }
+                        }
+                     }
+
+/* For bolometer-ordered data, the values for each bolometer are
+   contiguous, so accumulate the sums for each bolometer in turn. */
+                  } else {
+                     for( jbolo = 0; jbolo < nb; jbolo++ ) {
+                        if( active[ jbolo ] ) {
+                           sd = sdsq = sdt = st = stsq = sn = 0.0;
+                           off = ( b1 + jbolo )*bstride + fit_start*tstride;
+
+                           for( itime = 0; itime <= (dim_t)( fit_end - fit_start ); itime++ ) {
+                              t = m_box[ itime ];
+                              good = ( t != VAL__BADD && !( qua[ off ] & goodqual ) );
+                              if( good && usemask ) {
+                                 good = ( lut_data[ off ] != VAL__BADI &&
+                                          mask[ lut_data[ off ] ] );
+                              }
+                              if( good ) {
+                                 d = dat[ off ];
+                                 sd += d;
+                                 sdsq += d*d;
+                                 sdt += d*t;
+                                 st += t;
+                                 stsq += t*t;
+                                 sn += 1.0;
+                              }
+                              off += tstride;
+                           }
+
+                           s_d[ jbolo ] = sd;
+                           s_dsq[ jbolo ] = sdsq;
+                           s_dt[ jbolo ] = sdt;
+                           s_t[ jbolo ] = st;
+                           s_tsq[ jbolo ] = stsq;
+                           s_n[ jbolo ] = sn;
+                        }
+                     }
                   }
-               }
 
-/* Move on to the next block. */
-               ntime -= gain_box;
-               ibase += block_tstride;
-               m += gain_box;
-               igbase += gcstride;
+/* Solve the normal equations for every active bolometer. If no fit
+   could be performed, store a gain value of NOFIT. If we are ignoring
+   gains, force gains to 1.0. Retain the correlation coeffs in order to
+   flag bad blocks. The ignoring of offsets is handled by
+   smf1_find_gains_fit. */
+                  igbase = b1*gbstride + iblock*gcstride;
+                  for( jbolo = 0; jbolo < nb; jbolo++ ) {
+                     if( active[ jbolo ] ) {
+                        if( !smf1_find_gains_fit( s_n[ jbolo ], s_d[ jbolo ],
+                                                  s_dsq[ jbolo ], s_dt[ jbolo ],
+                                                  s_t[ jbolo ], s_tsq[ jbolo ],
+                                                  nooffs, gai + igbase,
+                                                  gai + block_cstride + igbase,
+                                                  gai + corr_offset + igbase ) ) {
+                           gai[ igbase ] = NOFIT;
+                        } else if( nogains ) {
+                           gai[ igbase ] = 1.0;
+                        }
+                     }
+                     igbase += gbstride;
+                  }
+               }
             }
 
-/* Store bad gain values for every block if the whole bolometer is bad.
-   So later code sees this as being equivalent to "rejected on entry". */
-         } else {
-            for( iblock = 0; iblock < nblock; iblock++ ){
-               gai[ igbase + corr_offset ] = VAL__BADD;
-               igbase += gcstride;
-            }
+/* Move on to the next block. */
+            ntime -= gain_box;
          }
       }
 
+/* Free resources. */
+      sums = astFree( sums );
+      active = astFree( active );
+
 /* Report the time taken in this thread. */
       msgOutiff( SMF__TIMER_MSG, "",
                  "smfFindGains: thread finishing bolos %" DIM_T_FMT
@@ -1226,3 +1366,92 @@ static void smf1_find_gains_job( void *job_data, int *status ) {
 }
 
 
+
+static int smf1_find_gains_fit( double s_n, double s_d, double s_dsq,
+                                double s_dt, double s_t, double s_tsq,
+                                int nooffs, double *gain, double *offset,
+                                double *corr ) {
+/*
+*  Name:
+*     smf1_find_gains_fit
+
+*  Purpose:
+*     Solve the normal equations for the gain and offset of a bolo block.
+
+*  Invocation:
+*     int smf1_find_gains_fit( double s_n, double s_d, double s_dsq,
+*                              double s_dt, double s_t, double s_tsq,
+*                              int nooffs, double *gain, double *offset,
+*                              double *corr )
+
+*  Arguments:
+*     s_n = double (Given)
+*        The number of good samples.
+*     s_d = double (Given)
+*        The sum of the data values.
+*     s_dsq = double (Given)
+*        The sum of the squared data values.
+*     s_dt = double (Given)
+*        The sum of the products of data and template values.
+*     s_t = double (Given)
+*        The sum of the template values.
+*     s_tsq = double (Given)
+*        The sum of the squared template values.
+*     nooffs = int (Given)
+*        If non-zero, fit a gain only, with an offset of zero.
+*     gain = double * (Returned)
+*        The gain.
+*     offset = double * (Returned)
+*        The offset.
+*     corr = double * (Returned)
+*        The correlation coefficient.
+
+*  Returned Value:
+*     Zero if there were too few good samples, or if the fit was
+*     degenerate, in which case all three returned values are VAL__BADD.
+*     One otherwise.
+
+*  Description:
+*     This routine uses the same formulae as smf_templateFit1D, but
+*     reports no error if no fit is possible (the caller would
+*     otherwise annul the error for every bolo-block that could not be
+*     fitted). A correlation coefficient that is not a normal number is
+*     returned as zero.
+
+*/
+
+/* Local Variables: */
+   double a;
+   double b;
+   double c;
+
+/* Initialise the returned values. */
+   *gain = VAL__BADD;
+   *offset = VAL__BADD;
+   *corr = VAL__BADD;
+
+/* Check there are enough samples, and then check for divide-by-zero. */
+   if( s_n < 3 ) return 0;
+   if( ( s_n*s_tsq == s_t*s_t ) || ( s_n*s_dsq == s_d*s_d ) ||
+       ( s_tsq == 0 ) ) return 0;
+
+/* Calculate gain only. */
+   if( nooffs ) {
+      a = s_dt/s_tsq;
+      b = 0;
+      c = ( s_n*a*s_dt - a*s_d*s_t )/( s_n*a*sqrt( s_tsq )*sqrt( s_dsq ) );
+
+/* Calculate gain and offset. */
+   } else {
+      a = ( s_n*s_dt - s_d*s_t )/( s_n*s_tsq - s_t*s_t );
+      b = ( s_d*s_tsq - s_t*s_dt )/( s_n*s_tsq - s_t*s_t );
+      c = ( s_n*s_dt - s_d*s_t )/
+          ( sqrt( s_n*s_tsq - s_t*s_t )*sqrt( s_n*s_dsq - s_d*s_d ) );
+   }
+
+   *gain = a;
+   *offset = b;
+   *corr = isnormal( c ) ? c : 0;
+
+   return 1;
+}
@@ -46,8 +46,16 @@
 *     using astFree when it is no longer needed.
 
 *  Description:
-*     This function find the median in a given array. It uses a histogram
-*     approach rather than a sorting approach for speed.
+*     This function find the median in a given array. The good values are
+*     copied to a work array, and the median is found using smf_select1,
+*     which takes a time proportional to the number of values. If there
+*     are an even number of good values, the mean of the two central
+*     values is returned.
+*
+*     If the SMURF_APPROXMEDIAN environment variable is set to a non-zero
+*     value, and the array contains more than SMF__APPROXMEDIAN_MIN
+*     elements, an approximate median is instead found from a histogram
+*     of the data values. This needs no copy of the data.
 
 *  Authors:
 *     David S Berry (JAC, UCLan)
@@ -68,6 +76,10 @@
 *        Avoid changing the supplied array when sorting is used.
 *     15-JAN-2009 (TIMJ):
 *        Declare const arguments
+*     14-OCT-2026:
+*        Use smf_select1 rather than kpg1Medu, so that the exact median
+*        can be found quickly for arrays of any size. The histogram is
+*        now only used if SMURF_APPROXMEDIAN is set.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -95,6 +107,9 @@
 *-
 */
 
+/* System includes */
+#include <stdlib.h>
+
 /* Starlink includes */
 #include "sae_par.h"
 #include "prm_par.h"
@@ -106,10 +121,11 @@
 int *smf_find_median( const float *farray, const double *darray, size_t nel,
                       int *hist, float *median, int *status ){
 
-  const size_t threshold = 10000;  /* point at which we abandon sorting */
-
 /* Local Variables */
+   const char *envval;
    double *tdarray;
+   double dhi;
+   double dlo;
    double dmean;
    double dmedian;
    double dmode;
@@ -117,9 +133,13 @@ int *smf_find_median( const float *farray, const double *darray, size_t nel,
    double valmax;
    double valmin;
    float *tfarray;
+   float fhi;
+   float flo;
    float fvalmax;
    float fvalmin;
    int *result;
+   size_t i;
+   size_t ngood;
    size_t numbin;
 
 /* pre-fill */
@@ -146,23 +166,56 @@ int *smf_find_median( const float *farray, const double *darray, size_t nel,
      return hist;
    }
 
-/* See if we should use sort to find the median. If so, take a copy of
-   the supplied data first to avoid re-ordering the supplied array */
-   if (nel <= threshold) {
-     int neluse;
+/* Unless an approximate median has been requested, find the exact median.
+   Copy the good values first to avoid re-ordering the supplied array. */
+   envval = getenv( SMF__APPROXMEDIAN );
+   if( nel <= SMF__APPROXMEDIAN_MIN || !envval || atoi( envval ) == 0 ) {
+     ngood = 0;
      if ( farray ) {
-       tfarray = astStore( NULL, farray, nel*sizeof( *tfarray ) );
-       kpg1Medur( 1, nel, tfarray, median, &neluse, status );
+       tfarray = astMalloc( nel*sizeof( *tfarray ) );
+       if( tfarray ) {
+         for( i = 0; i < nel; i++ ) {
+           if( farray[ i ] != VAL__BADR ) tfarray[ ngood++ ] = farray[ i ];
+         }
+         if( ngood > 0 ) {
+           fhi = smf_select1F( tfarray, ngood, ngood/2, status );
+           if( ngood % 2 == 0 ) {
+             flo = tfarray[ 0 ];
+             for( i = 1; i < ngood/2; i++ ) {
+               if( tfarray[ i ] > flo ) flo = tfarray[ i ];
+             }
+             *median = 0.5*( (double) flo + (double) fhi );
+           } else {
+             *median = fhi;
+           }
+         }
+       }
        tfarray = astFree( tfarray );
 
      } else {
-       tdarray = astStore( NULL, darray, nel*sizeof( *tdarray ) );
-       kpg1Medud( 1, nel, tdarray, &dmedian, &neluse, status );
+       tdarray = astMalloc( nel*sizeof( *tdarray ) );
+       if( tdarray ) {
+         for( i = 0; i < nel; i++ ) {
+           if( darray[ i ] != VAL__BADD ) tdarray[ ngood++ ] = darray[ i ];
+         }
+         if( ngood > 0 ) {
+           dhi = smf_select1D( tdarray, ngood, ngood/2, status );
+           if( ngood % 2 == 0 ) {
+             dlo = tdarray[ 0 ];
+             for( i = 1; i < ngood/2; i++ ) {
+               if( tdarray[ i ] > dlo ) dlo = tdarray[ i ];
+             }
+             *median = 0.5*( dlo + dhi );
+           } else {
+             *median = dhi;
+           }
+         }
+       }
        tdarray = astFree( tdarray );
-       *median = ( dmedian != VAL__BADD ) ? dmedian : VAL__BADR;
 
      }
-     return NULL;
+     if( *status != SAI__OK ) *median = VAL__BADR;
+     return hist;
    }
 
 /* Decide on the number of bins in the histogram. This is chosen so that
@@ -175,6 +175,12 @@
 *        All HARP/ACSIS files are now accepted as science files. Previously,
 *        a "no SEQCOUNT header found" error was reported if any HARP/ACSIS
 *        files were supplied.
+*     2026-10-14:
+*        Do not read the WCS of each file when classifying the files,
+*        since it is not needed.
+*     2026-10-14:
+*        Use the header summaries in the observation index, if one is
+*        in use (see smf_obsindex_name), rather than opening each file.
 
 *  Copyright:
 *     Copyright (C) 2008-2013 Science and Technology Facilities Council.
@@ -264,6 +270,7 @@ void smf_find_science(ThrWorkForce *wf, const Grp * ingrp, Grp **outgrp, int rev
   Grp * fgrp = NULL;  /* Fast flat group */
   size_t i;           /* loop counter */
   smfData *infile = NULL; /* input file */
+  char indexfile[SMF_PATH_MAX+1]; /* Name of observation index file */
   size_t insize;     /* number of input files */
   size_t nsteps_dark = 0;    /* Total number of steps for darks */
   size_t nsteps_sci = 0;     /* Total number of steps for science */
@@ -329,10 +336,22 @@ void smf_find_science(ThrWorkForce *wf, const Grp * ingrp, Grp **outgrp, int rev
   /* check each file in turn */
   for (i = 1; i <= insize; i++) {
     int seqcount = 0;
+    int fromindex = 0; /* Was the header read from the index? */
+    int useindex = 0;  /* Is an observation index in use? */
     char keystr[100];  /* Key for scimap entry */
-
-    /* open the file but just to get the header */
-    smf_open_file( NULL, ingrp, i, "READ", SMF__NOCREATE_DATA, &infile, status );
+    char ndfname[GRP__SZNAM+1]; /* Name of input file */
+    char *pname = ndfname;
+
+    /* If an observation index is in use, try to read the header
+       summary from it. Otherwise, open the file but just to get the
+       header */
+    grpGet( ingrp, i, 1, &pname, sizeof(ndfname), status );
+    useindex = smf_obsindex_name( ndfname, indexfile, sizeof(indexfile),
+                                  status );
+    if (useindex) fromindex = smf_read_obsindex( indexfile, ndfname, &infile,
+                                                 status );
+    if (!fromindex) smf_open_file( NULL, ingrp, i, "READ", SMF__NOCREATE_DATA |
+                                   SMF__NOCREATE_WCS, &infile, status );
     if (*status != SAI__OK) break;
 
     /* Fill in the keymap with observation details */
@@ -360,9 +379,16 @@ void smf_find_science(ThrWorkForce *wf, const Grp * ingrp, Grp **outgrp, int rev
                        status );
         if (!astMapHasKey( heatermap, arrayidstr ) ) {
           smfData * heateff = NULL;
+          smfData * flatfile = infile;
           dim_t nbolos = 0;
-          smf_flat_params( infile, "RESIST", NULL, NULL, NULL, NULL, NULL,
+          /* The flatfield parameters are not in the observation index,
+             so open the file itself if necessary */
+          if (fromindex) smf_open_file( NULL, ingrp, i, "READ",
+                                        SMF__NOCREATE_DATA | SMF__NOCREATE_WCS,
+                                        &flatfile, status );
+          smf_flat_params( flatfile, "RESIST", NULL, NULL, NULL, NULL, NULL,
                            NULL, NULL, NULL, NULL, NULL, &heateff, status );
+          if (flatfile != infile) smf_close_file( wf, &flatfile, status );
           smf_get_dims( heateff, NULL, NULL, &nbolos, NULL, NULL, NULL, NULL,
                         status );
           if (heateff) astMapPut0P( heatermap, arrayidstr, heateff, NULL );
@@ -431,6 +457,10 @@ void smf_find_science(ThrWorkForce *wf, const Grp * ingrp, Grp **outgrp, int rev
       }
     }
 
+    /* Store the header summary in the observation index if it was not
+       already there */
+    if (useindex && !fromindex) smf_write_obsindex( indexfile, infile, status );
+
     /* close the file */
     smf_close_file( wf, &infile, status );
   }
@@ -503,7 +533,7 @@ void smf_find_science(ThrWorkForce *wf, const Grp * ingrp, Grp **outgrp, int rev
 
         /* Collapse it */
         if (*status == SAI__OK) {
-          smf_flat_fastflat( infile, &outfile, status );
+          smf_flat_fastflat( wf, infile, &outfile, status );
           if (*status == SMF__BADFLAT) {
             errFlush( status );
 
@@ -33,11 +33,20 @@
 *  Description:
 *     This routine fits a polynomial of arbitrary order to each
 *     bolometer time stream of N timeslices. Execution is halted with
-*     an error if the polynomial order is greater than N-1. Fitting
-*     itself is done with smf_fit_poly1d. If remove is set, the polynomial
-*     will be evaluated and removed from the input data. In this case
-*     poly may also be set to NULL in which case the coefficients are
-*     only stored in a temporary buffer long enough to remove the fit.
+*     an error if the polynomial order is greater than N-1. If remove is
+*     set, the polynomial will be evaluated and removed from the input
+*     data. In this case poly may also be set to NULL in which case the
+*     coefficients are only stored in a temporary buffer long enough to
+*     remove the fit.
+*
+*     All bolometers share the same time axis, so a set of polynomials
+*     that are orthonormal over the time slices is created once. For each
+*     bolometer that has no samples excluded from the fit, the fitted
+*     coefficients are then simply the dot products of the bolometer
+*     data with these polynomials. For time-ordered data, these are
+*     formed for a whole block of bolometers in a single sweep through
+*     the data. Bolometers that have some samples excluded from the fit
+*     are instead fitted individually using smf_fit_poly1d.
 
 *  Notes:
 *     This routine will fail if there is no associated QUALITY component.
@@ -71,9 +80,14 @@
 *        -Parallelize over blocks of bolometers
 *     2010-10-19 (DSB):
 *        Free job_data before returning.
+*     2026-10-14:
+*        Use a shared orthonormal polynomial basis to fit bolometers that
+*        have no excluded samples, rather than solving a separate least
+*        squares problem for each one.
 *     {enter_further_changes_here}
 
 *  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
 *     Copyright (C) 2008-2010 Science and Technology Facilities Council.
 *     Copyright (C) 2006-2008,2010 University of British Columbia.
 *     All Rights Reserved.
@@ -100,6 +114,7 @@
 */
 
 /* Standard includes */
+#include <math.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
@@ -130,6 +145,7 @@
 typedef struct {
   size_t b1;               /* Index of first bolometer of block */
   size_t b2;               /* Index of last bolometer of block */
+  const double *basis;     /* Orthonormal polynomials over the time slices */
   size_t bstride;          /* bolometer stride for res/qua */
   double *indata;          /* pointer to the bolometer data */
   int ijob;                /* Job identifier */
@@ -140,6 +156,7 @@ typedef struct {
   double *poly;            /* pointer to buffer to store poly coeffs */
   const smf_qual_t *qual;  /* pointer to the quality array */
   int remove;              /* set if removing poly fit from data */
+  const double *tmat;      /* Monomial coefficients of each basis polynomial */
   size_t tstride;          /* time stride for res/qua */
 } smfFitPolyData;
 
@@ -147,16 +164,28 @@ typedef struct {
 
 static void smfFitPolyPar( void *job_data_ptr, int *status );
 
+/* Function to create the orthonormal polynomial basis */
+
+static void smf1_fit_poly_basis( dim_t ntslice, size_t ncoeff, double *basis,
+                                 double *tmat, int *status );
+
 static void smfFitPolyPar( void *job_data_ptr, int *status ) {
+  const double *basis=NULL;   /* Orthonormal polynomials */
   size_t bstride;             /* bolo strides */
+  char *clean=NULL;           /* Does each bolo have no excluded samples? */
+  double *coeff=NULL;         /* Basis coefficients for each bolo in block */
+  double *cptr=NULL;          /* Basis coefficients for current bolo */
   double *curbolo=NULL;       /* pointer to current bolo data */
   double *curpoly=NULL;       /* pointer to poly coeffs fit to curbolo */
   double *curpolydata=NULL;   /* evaluated poly for curbolo */
   smf_qual_t *curqual=NULL;   /* pointer to current bolo quality */
+  double fit;                 /* Fitted value */
   size_t i;                   /* Loop counter */
   double *indata=NULL;        /* Pointer to data array */
   size_t j;                   /* Loop counter */
   size_t k;                   /* Loop counter */
+  size_t m;                   /* Loop counter */
+  dim_t nb;                   /* Number of bolometers in block */
   dim_t nbolo;                /* Number of bolometers */
   size_t ncoeff;              /* Number of poly coeffs */
   dim_t ntslice;              /* Number of time slices */
@@ -164,19 +193,24 @@ static void smfFitPolyPar( void *job_data_ptr, int *status ) {
   smfFitPolyData *pdata=NULL; /* Pointer to job data */
   double *poly=NULL;          /* Pointer external poly coeff storage buffer */
   smf_qual_t *qual=NULL;      /* Pointer to QUALITY component */
+  const double *tmat=NULL;    /* Monomial coefficients of basis polynomials */
   size_t tstride;             /* time strides */
+  double val;                 /* Data value */
 
   /* Retrieve job data */
   pdata = job_data_ptr;
+  basis = pdata->basis;
   bstride = pdata->bstride;
   indata = pdata->indata;
   nbolo = pdata->nbolo;
   ntslice = pdata->ntslice;
   poly = pdata->poly;
   qual = (smf_qual_t *) pdata->qual;
+  tmat = pdata->tmat;
   tstride = pdata->tstride;
 
   ncoeff = pdata->order + 1;
+  nb = pdata->b2 - pdata->b1 + 1;
 
   /* Debugging message indicating thread started work */
   msgOutiff( SMF__TIMER_MSG, "",
@@ -200,10 +234,77 @@ static void smfFitPolyPar( void *job_data_ptr, int *status ) {
     curpolydata = astMalloc( ntslice*sizeof(*curpolydata) );
   }
 
+  /* Space for the basis coefficients of every bolometer in the block,
+     and a flag for each bolometer indicating if all its samples can be
+     used in the fit. Bolometers flagged SMF__Q_BADB are not fitted. */
+  coeff = astCalloc( nb*ncoeff, sizeof(*coeff) );
+  clean = astMalloc( nb*sizeof(*clean) );
+  if( *status != SAI__OK ) goto CLEANUP;
+
+  for( j=pdata->b1; j<=pdata->b2; j++ ) {
+    clean[j-pdata->b1] = !(qual[j*bstride] & SMF__Q_BADB);
+  }
+
+  /* Form the dot product of each bolometer with each basis polynomial,
+     noting any bolometers that have samples that cannot be used. For
+     time-ordered data, do the whole block of bolometers in one sweep
+     through the time slices so that the data are accessed in memory
+     order. */
+  if( pdata->isTordered ) {
+    for( i=0; i<ntslice; i++ ) {
+      for( j=pdata->b1; j<=pdata->b2; j++ ) {
+        if( clean[j-pdata->b1] ) {
+          val = indata[i*tstride + j*bstride];
+          if( val == VAL__BADD || (qual[i*tstride + j*bstride]&SMF__Q_FIT) ) {
+            clean[j-pdata->b1] = 0;
+          } else {
+            cptr = coeff + (j-pdata->b1)*ncoeff;
+            for( k=0; k<ncoeff; k++ ) cptr[k] += basis[k*ntslice + i]*val;
+          }
+        }
+      }
+    }
+  } else {
+    for( j=pdata->b1; j<=pdata->b2; j++ ) {
+      cptr = coeff + (j-pdata->b1)*ncoeff;
+      for( i=0; i<ntslice && clean[j-pdata->b1]; i++ ) {
+        val = indata[i*tstride + j*bstride];
+        if( val == VAL__BADD || (qual[i*tstride + j*bstride]&SMF__Q_FIT) ) {
+          clean[j-pdata->b1] = 0;
+        } else {
+          for( k=0; k<ncoeff; k++ ) cptr[k] += basis[k*ntslice + i]*val;
+        }
+      }
+    }
+  }
+
   /* Loop over bolometers. Only fit this bolometer if it is not
      flagged SMF__Q_BADB */
   for ( j=pdata->b1; (j<=pdata->b2) && (*status==SAI__OK); j++) {
-    if( !(qual[j*bstride] & SMF__Q_BADB) ) {
+    if( clean[j-pdata->b1] ) {
+
+      /* Convert the basis coefficients into the coefficients of powers
+         of the time slice index. */
+      cptr = coeff + (j-pdata->b1)*ncoeff;
+      for( m=0; m<ncoeff; m++ ) {
+        curpoly[m] = 0.0;
+        for( k=m; k<ncoeff; k++ ) curpoly[m] += cptr[k]*tmat[k*ncoeff + m];
+      }
+
+      /* For bolo-ordered data remove the fit now, while the bolometer is
+         still in cache. Time-ordered data are done for the whole block
+         below. */
+      if( pdata->remove && !pdata->isTordered ) {
+        for( i=0; i<ntslice; i++ ) {
+          if( !(qual[j*bstride + i*tstride]&SMF__Q_MOD) ) {
+            fit = 0.0;
+            for( k=0; k<ncoeff; k++ ) fit += cptr[k]*basis[k*ntslice + i];
+            indata[i*tstride + j*bstride] -= fit;
+          }
+        }
+      }
+
+    } else if( !(qual[j*bstride] & SMF__Q_BADB) ) {
 
       /* Pointer to current bolometer data */
       if( pdata->isTordered ) {
@@ -219,27 +320,45 @@ static void smfFitPolyPar( void *job_data_ptr, int *status ) {
       smf_fit_poly1d( pdata->order, ntslice, 0, 0, NULL, curbolo, NULL, curqual,
                       curpoly,NULL, curpolydata, &nused, status );
 
-      if( *status == SAI__OK ) {
-        /* Remove fit from data */
-        if( pdata->remove ) {
-          for( i=0; i<ntslice; i++ ) {
-            if( (indata[i*tstride + j*bstride] != VAL__BADD) &&
-                !(qual[j*bstride + i*tstride]&SMF__Q_MOD) ) {
-              indata[i*tstride + j*bstride] -= curpolydata[i];
-            }
+      /* Remove fit from data */
+      if( *status == SAI__OK && pdata->remove ) {
+        for( i=0; i<ntslice; i++ ) {
+          if( (indata[i*tstride + j*bstride] != VAL__BADD) &&
+              !(qual[j*bstride + i*tstride]&SMF__Q_MOD) ) {
+            indata[i*tstride + j*bstride] -= curpolydata[i];
           }
         }
+      }
 
-        /* Copy the poly coefficients for this bolometer into poly */
-        if( poly ) {
-          for ( k=0; k<ncoeff; k++) {
-            poly[j + k*nbolo] = curpoly[k];
-          }
+    } else {
+      continue;
+    }
+
+    /* Copy the poly coefficients for this bolometer into poly */
+    if( *status == SAI__OK && poly ) {
+      for ( k=0; k<ncoeff; k++) {
+        poly[j + k*nbolo] = curpoly[k];
+      }
+    }
+  }
+
+  /* Remove the fits from the time-ordered bolometers that were fitted
+     using the basis, again in a single sweep through the time slices. */
+  if( *status == SAI__OK && pdata->remove && pdata->isTordered ) {
+    for( i=0; i<ntslice; i++ ) {
+      for( j=pdata->b1; j<=pdata->b2; j++ ) {
+        if( clean[j-pdata->b1] &&
+            !(qual[i*tstride + j*bstride]&SMF__Q_MOD) ) {
+          cptr = coeff + (j-pdata->b1)*ncoeff;
+          fit = 0.0;
+          for( k=0; k<ncoeff; k++ ) fit += cptr[k]*basis[k*ntslice + i];
+          indata[i*tstride + j*bstride] -= fit;
         }
       }
     }
   }
 
+ CLEANUP:
   /* Free up temp space */
   if( pdata->isTordered ) {
     curbolo = astFree( curbolo );
@@ -247,6 +366,8 @@ static void smfFitPolyPar( void *job_data_ptr, int *status ) {
   }
   curpoly = astFree( curpoly );
   curpolydata = astFree( curpolydata );
+  coeff = astFree( coeff );
+  clean = astFree( clean );
 
   /* Debugging message indicating thread finished work */
   msgOutiff( SMF__TIMER_MSG, "",
@@ -254,6 +375,118 @@ static void smfFitPolyPar( void *job_data_ptr, int *status ) {
              status, pdata->b1, pdata->b2 );
 }
 
+/* Create "ncoeff" polynomials in the time slice index that are
+   orthonormal over the "ntslice" time slices. They are returned in
+   "basis" (ncoeff*ntslice elements, one polynomial after another). The
+   coefficient of the m'th power of the time slice index in the k'th
+   polynomial is returned in element k*ncoeff+m of "tmat" (zero for
+   m>k). Legendre polynomials of a time scaled into the range [-1,1] are
+   used as a starting point, since they are nearly orthogonal already,
+   and they are then made exactly orthonormal using modified
+   Gram-Schmidt with re-orthogonalisation. */
+
+static void smf1_fit_poly_basis( dim_t ntslice, size_t ncoeff, double *basis,
+                                 double *tmat, int *status ) {
+  double *bk;                 /* Current basis polynomial */
+  double *bl;                 /* Previous basis polynomial */
+  double *coef = NULL;        /* Coefficients of powers of scaled time */
+  double dot;                 /* Dot product of two polynomials */
+  size_t i;                   /* Loop counter */
+  size_t k;                   /* Loop counter */
+  size_t l;                   /* Loop counter */
+  size_t m;                   /* Loop counter */
+  int pass;                   /* Orthogonalisation pass */
+  double *pw = NULL;          /* Powers of the time scale and offset */
+  double scale;               /* Scale from time slice index to time */
+  double term;                /* Binomial term */
+
+  if( *status != SAI__OK ) return;
+
+  coef = astCalloc( ncoeff*ncoeff, sizeof(*coef) );
+  pw = astMalloc( ncoeff*sizeof(*pw) );
+  if( *status != SAI__OK ) goto CLEANUP;
+
+  scale = ( ntslice > 1 ) ? 2.0/( ntslice - 1 ) : 0.0;
+
+  /* Evaluate the Legendre polynomials, and their coefficients, using the
+     usual recurrence relation. */
+  for( k=0; k<ncoeff; k++ ) {
+    bk = basis + k*ntslice;
+    if( k == 0 ) {
+      for( i=0; i<ntslice; i++ ) bk[i] = 1.0;
+      coef[0] = 1.0;
+    } else if( k == 1 ) {
+      for( i=0; i<ntslice; i++ ) bk[i] = scale*i - 1.0;
+      coef[ncoeff + 1] = 1.0;
+    } else {
+      bl = basis + (k-1)*ntslice;
+      for( i=0; i<ntslice; i++ ) {
+        bk[i] = ( (2*k-1)*(scale*i - 1.0)*bl[i] -
+                  (k-1)*basis[(k-2)*ntslice + i] )/k;
+      }
+      for( m=0; m<=k; m++ ) {
+        coef[k*ncoeff + m] = -( (double)(k-1)/k )*coef[(k-2)*ncoeff + m];
+        if( m > 0 ) {
+          coef[k*ncoeff + m] += ( (double)(2*k-1)/k )*
+                                coef[(k-1)*ncoeff + m - 1];
+        }
+      }
+    }
+  }
+
+  /* Orthonormalise them, applying the same operations to the
+     coefficients. */
+  for( k=0; k<ncoeff; k++ ) {
+    bk = basis + k*ntslice;
+    for( pass=0; pass<2; pass++ ) {
+      for( l=0; l<k; l++ ) {
+        bl = basis + l*ntslice;
+        dot = 0.0;
+        for( i=0; i<ntslice; i++ ) dot += bk[i]*bl[i];
+        for( i=0; i<ntslice; i++ ) bk[i] -= dot*bl[i];
+        for( m=0; m<=l; m++ ) coef[k*ncoeff + m] -= dot*coef[l*ncoeff + m];
+      }
+    }
+
+    dot = 0.0;
+    for( i=0; i<ntslice; i++ ) dot += bk[i]*bk[i];
+    if( dot <= 0.0 ) {
+      *status = SAI__ERROR;
+      errRep( "", "smf1_fit_poly_basis: Unable to create orthonormal "
+              "polynomials (possible programming error).", status );
+      goto CLEANUP;
+    }
+    dot = 1.0/sqrt( dot );
+    for( i=0; i<ntslice; i++ ) bk[i] *= dot;
+    for( m=0; m<=k; m++ ) coef[k*ncoeff + m] *= dot;
+  }
+
+  /* The scaled time is "scale*i - 1", so expand each power of it
+     binomially to get the coefficients of powers of the time slice
+     index. */
+  for( k=0; k<ncoeff*ncoeff; k++ ) tmat[k] = 0.0;
+  for( l=0; l<ncoeff; l++ ) {
+
+    /* pw[m] = binomial(l,m) * scale^m * (-1)^(l-m) */
+    term = ( l % 2 ) ? -1.0 : 1.0;
+    pw[0] = term;
+    for( m=1; m<=l; m++ ) {
+      term *= -scale*( l - m + 1 )/m;
+      pw[m] = term;
+    }
+
+    for( k=l; k<ncoeff; k++ ) {
+      for( m=0; m<=l; m++ ) {
+        tmat[k*ncoeff + m] += coef[k*ncoeff + l]*pw[m];
+      }
+    }
+  }
+
+ CLEANUP:
+  coef = astFree( coef );
+  pw = astFree( pw );
+}
+
 /* ------------------------------------------------------------------------ */
 
 /* Simple default string for errRep */
@@ -263,6 +496,7 @@ void smf_fit_poly( ThrWorkForce *wf, smfData *data, const size_t order,
                    int remove, double *poly, int *status) {
 
   /* Local variables */
+  double *basis=NULL;         /* Orthonormal polynomials */
   size_t bstride;             /* bolo strides */
   int i;                      /* Loop counter */
   smfFitPolyData *job_data=NULL;/* Array of job data for each thread */
@@ -273,6 +507,7 @@ void smf_fit_poly( ThrWorkForce *wf, smfData *data, const size_t order,
   smfFitPolyData *pdata=NULL; /* Pointer to job data */
   const smf_qual_t *qual;     /* pointer to the quality array */
   size_t step;                /* step size for dividing up work */
+  double *tmat=NULL;          /* Monomial coefficients of basis polynomials */
   size_t tstride;             /* time strides */
 
   /* Check status */
@@ -319,6 +554,12 @@ void smf_fit_poly( ThrWorkForce *wf, smfData *data, const size_t order,
     return;
   }
 
+  /* Create the polynomials that are orthonormal over the time slices.
+     These are shared by all bolometers. */
+  basis = astMalloc( (order+1)*ntslice*sizeof(*basis) );
+  tmat = astMalloc( (order+1)*(order+1)*sizeof(*tmat) );
+  smf1_fit_poly_basis( ntslice, order + 1, basis, tmat, status );
+
   /* Set up the job data */
 
   if( nw > (int) nbolo ) {
@@ -352,6 +593,7 @@ void smf_fit_poly( ThrWorkForce *wf, smfData *data, const size_t order,
      }
 
      pdata->ijob = -1;   /* Flag job as ready to start */
+     pdata->basis = basis;
      pdata->bstride = bstride;
      pdata->indata = data->pntr[0];
      pdata->isTordered = data->isTordered;
@@ -361,6 +603,7 @@ void smf_fit_poly( ThrWorkForce *wf, smfData *data, const size_t order,
      pdata->poly = poly;
      pdata->qual = qual;
      pdata->remove = remove;
+     pdata->tmat = tmat;
      pdata->tstride = tstride;
    }
 
@@ -378,5 +621,7 @@ void smf_fit_poly( ThrWorkForce *wf, smfData *data, const size_t order,
 
   /* Free local resources. */
   job_data = astFree( job_data );
+  basis = astFree( basis );
+  tmat = astFree( tmat );
 
 }
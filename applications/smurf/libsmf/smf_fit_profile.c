@@ -85,10 +85,14 @@
 *        Starlink version
 *     2012-04-10 (TIMJ):
 *        Use const and stop using unnecessary pointers.
+*     2026-10-14:
+*        When no initial estimates are found for a profile, start the
+*        fit from the parameters fitted to the previous profile.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2010,2012 Science and Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     Copyright (C) Kapteyn Laboratorium Groningen 2001
 *     All Rights Reserved.
 
@@ -580,6 +584,10 @@ static void FitProfileThread ( void *job_data_ptr, int *status ) {
   double          errlist[MAXPAR];   /* Errors fit */
   int             iters = 0;         /* Return status smf_lsqfit */
 
+  /* Fit of the previous (adjacent) profile handled by this thread */
+  double          prevpar[MAXPAR];   /* Its fitted parameters */
+  int             prevfound = 0;     /* Its number of components */
+
   int             estimate_only = 0;
   int             model_only = 0;
 
@@ -862,8 +870,19 @@ static void FitProfileThread ( void *job_data_ptr, int *status ) {
 		      status, ijob, (int) profid, nestim);
 #endif
 
-	    /* No estimates? Try a fit anyway */
-	    if (nestim == 0) {
+	    /* No estimates? Start from the fit of the previous profile
+	       if there was one, since adjacent profiles tend to be alike.
+               Those parameters are already for the function being fitted. */
+            int warmstart = 0;
+	    if (nestim == 0 && prevfound > 0) {
+	      nfound = MYMIN( prevfound, mcomp );
+	      for ( i = 0; (int) i < npar*nfound; i++ ) {
+		parlist[i] = prevpar[i];
+	      }
+	      warmstart = 1;
+
+	    /* Otherwise try a fit anyway */
+	    } else if (nestim == 0) {
 	      parlist[0] = maxval;
 	      parlist[1] = posmax;
               if ( fcntrl->lolimit[2] != VAL__BADD ) {
@@ -877,7 +896,7 @@ static void FitProfileThread ( void *job_data_ptr, int *status ) {
 	    }
 
 	    /* Adjust gaussian estimates for actual function being fitted */
-	    adjustestimates( fid, nfound, parlist, npar );
+	    if ( !warmstart ) adjustestimates( fid, nfound, parlist, npar );
 
 	    /* Replace estimates with values from any external parameter
 	       ndf or with user supplied values */
@@ -960,6 +979,16 @@ static void FitProfileThread ( void *job_data_ptr, int *status ) {
 
       }
 
+      /* Remember a successful fit as a starting point for the next
+         profile */
+      prevfound = 0;
+      if ( iters >= 0 && nfound > 0 && model_only != YES ) {
+	for ( i = 0; (int) i < npar*nfound; i++ ) {
+	  prevpar[i] = parlist[i];
+	}
+	prevfound = nfound;
+      }
+
 #if (MAXDEBUGINFO)
       msgOutiff(MSG__DEBUG, " ",
 	 "(FitProfileThread %d) ...profile %d dolsqfit fitted %d (ier = %d)",
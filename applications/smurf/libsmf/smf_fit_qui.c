@@ -172,10 +172,15 @@
 *        important JCMTState value in the output is calculated within this
 *        function as the average of the input JCMTState values for the time
 *        slices that contibute to each output I, Q or U value.
+*     14-OCT-2026:
+*        Find the half-wave plate trig values, and the sums that depend
+*        only on them, once per fitting box rather than once per
+*        bolometer. Bolometers with no rejected samples in a box also
+*        share a single Cholesky decomposition.
 *     {enter_further_changes_here}
 
 *  Copyright:
-*     Copyright (C) 2015,2016 East Asian Observatory.
+*     Copyright (C) 2015,2016,2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -222,7 +227,6 @@
 /* Local data types: */
 typedef struct smfFitQUIJobData {
    AstFrameSet *wcs;
-   const JCMTState *allstates;
    dim_t *box_starts;
    dim_t b1;
    dim_t b2;
@@ -236,11 +240,12 @@ typedef struct smfFitQUIJobData {
    double *ipu;
    double *ipv;
    double angrot;
-   double paoff;
+   const double *trig;
+   const char *tflag;
+   const double *dsums;
+   dim_t nshared;
    int harmonic;
-   int ipolcrd;
    const char *north;
-   int pasign;
    int setbad;
    smf_qual_t *qua;
 } smfFitQUIJobData;
@@ -256,6 +261,8 @@ typedef struct smfFitQUIJob2Data {
 /* Prototypes for local functions */
 static void smf1_fit_qui_job( void *job_data, int *status );
 static void smf1_fit_qui_job2( void *job_data, int *status );
+static void smf1_fit_qui_sums( const double *trig, dim_t ibox, double din,
+                               double *sums );
 static void smf1_find_boxes( dim_t intslice, const JCMTState *allstates,
                              double ang0, dim_t box, dim_t *ontslice,
                              dim_t **box_starts, dim_t *lolim, dim_t *hilim,
@@ -267,6 +274,9 @@ static void smf1_find_boxes( dim_t intslice, const JCMTState *allstates,
 /* Number of running sums need to calculate the i,q,u fit. */
 #define NSUM ( NPAR*(3+NPAR) )/2
 
+/* Number of trig values stored for each time slice in a fitting box. */
+#define NTRIG 8
+
 /* Macro to simplify resampling of individual JCMTState fields */
 #define RESAMPSTATE(member,isangle) \
          p2data = astMalloc( sizeof( *p2data ) ); \
@@ -291,6 +301,7 @@ void smf_fit_qui( ThrWorkForce *wf, smfData *idata, smfData **odataq,
    AstFrameSet *wcs;        /* WCS FrameSet for current time slice */
    JCMTState *instate=NULL; /* Pointer to input JCMTState */
    JCMTState *outstate=NULL;/* Pointer to output JCMTState */
+   const JCMTState *state;  /* JCMTState info for current time slice */
    const char *usesys;      /* Tracking system */
    dim_t *box_starts;       /* Array holding time slice at start of each box */
    dim_t box_size;          /* First time slice in box */
@@ -306,7 +317,18 @@ void smf_fit_qui( ThrWorkForce *wf, smfData *idata, smfData **odataq,
    dim_t ntime;             /* Time slices to check */
    dim_t ondata;            /* ndata of odata */
    dim_t ontslice;          /* ntslice of odata */
+   double *pt;              /* Pointer to next trig table entry */
+   double *trig;            /* Trig values for each time slice in a box */
+   double angle;            /* POL_ANG value */
+   double dsums[ NSUM ];    /* Sums shared by all bolometers */
+   double phi;              /* Angle from fixed analyser to effective analyser */
    double scale;            /* how much longer new samples are */
+   double twophi;           /* Twice phi */
+   double wplate;           /* Angle from fixed analyser to half-wave plate */
+   char *pf;                /* Pointer to next time slice flag */
+   char *tflag;             /* Usability of each time slice in a box */
+   dim_t ibox;              /* Index of time slice within box */
+   dim_t nshared;           /* No. of time slices included in dsums */
    int bstep;               /* Bolometer step between threads */
    int iworker;             /* Index of a worker thread */
    int nodd;                /* No. of straneg box lengths found and ignored */
@@ -479,6 +501,13 @@ void smf_fit_qui( ThrWorkForce *wf, smfData *idata, smfData **odataq,
       }
    }
 
+/* Allocate the tables that describe the time slices in a fitting box.
+   Every bolometer sees the same half-wave plate angle at a given time
+   slice, so the trig values needed for the fit are found once here for
+   each box, rather than separately for each bolometer. */
+   trig = astMalloc( hilim*NTRIG*sizeof( *trig ) );
+   tflag = astMalloc( hilim*sizeof( *tflag ) );
+
 /* Create structures used to pass information to the worker threads. */
    nworker = wf ? wf->nworker : 1;
    job_data = astMalloc( nworker*sizeof( *job_data ) );
@@ -572,6 +601,67 @@ void smf_fit_qui( ThrWorkForce *wf, smfData *idata, smfData **odataq,
             box_size = 0;
          }
 
+/* Fill the trig table for the box. Each time slice has NTRIG values:
+   sin and cos of 4, 2, 1 and 8 times the half-wave plate angle (in that
+   order). The time slice flag is 0 if POL_ANG is bad, 1 if the sample
+   should be excluded from the fit but included in the residuals (i.e.
+   the DR control flag is set), and 2 otherwise. Also form the sums
+   that do not depend on the bolometer values over all time slices with
+   a flag of 2. The sums that do depend on the bolometer values are left
+   at zero and are formed by each worker thread. */
+         memset( dsums, 0, NSUM*sizeof(*dsums) );
+         nshared = 0;
+         pt = trig;
+         pf = tflag;
+         state = ihdr->allState + istart;
+         for( ibox = 0; ibox < box_size; ibox++,state++,pt += NTRIG,pf++ ) {
+            angle = state->pol_ang;
+            if( angle != VAL__BADD ) {
+
+/* Following SUN/223 (section "Single-beam polarimetry"/"The Polarimeter"),
+   get the angle from the fixed analyser to the half-waveplate axis, in radians.
+   Positive rotation is from focal plane axis 1 (x) to focal plane axis 2 (y).
+
+   Not sure about the sign of tcs_az/tr_ang at the moment so do not use them
+   yet. */
+               wplate = 0.0;
+               if( ipolcrd == 0 ) {
+                  wplate = ( pasign ? +1 : -1 )*angle + paoff;
+
+               } else if( *status == SAI__OK ) {
+                  *status = SAI__ERROR;
+                  errRepf( "", "smf_fit_qui: currently only POL_CRD = "
+                           "FPLANE is supported.", status );
+               }
+
+/* Get the angle from the fixed analyser to the effective analyser
+   position (see SUN/223 again). The effective analyser angle rotates twice
+   as fast as the half-wave plate which is why there is a factor of 2 here. */
+               phi = 2*wplate;
+               twophi = 2*phi;
+
+               pt[ 0 ] = sin( twophi );
+               pt[ 1 ] = cos( twophi );
+               pt[ 2 ] = sin( phi );
+               pt[ 3 ] = cos( phi );
+               pt[ 4 ] = sin( wplate );
+               pt[ 5 ] = cos( wplate );
+               pt[ 6 ] = sin( 2*twophi );
+               pt[ 7 ] = cos( 2*twophi );
+
+               if( state->jos_drcontrol == 0 ) {
+                  *pf = 2;
+                  smf1_fit_qui_sums( pt, ibox, 0.0, dsums );
+                  nshared++;
+               } else {
+                  *pf = 1;
+               }
+
+            } else {
+               *pf = 0;
+            }
+         }
+
 /* If we are using north as the reference direction, get the WCS FrameSet
    for the input time slice that is at the middle of the output time
    slice, and set its current Frame to the requested frame. */
@@ -605,7 +695,10 @@ void smf_fit_qui( ThrWorkForce *wf, smfData *idata, smfData **odataq,
 
             pdata->dat = ((double *) idata->pntr[0] ) + istart*nbolo;
             pdata->qua = qua + istart*nbolo;
-            pdata->allstates = ihdr->allState + istart;
+            pdata->trig = trig;
+            pdata->tflag = tflag;
+            pdata->dsums = dsums;
+            pdata->nshared = nshared;
 
             pdata->ipi = odatai ? ( (double*) (*odatai)->pntr[0] ) + itime*nbolo : NULL;
             pdata->ipf = odataf ? ( (double*) (*odataf)->pntr[0] ) + istart*nbolo : NULL;
@@ -617,9 +710,6 @@ void smf_fit_qui( ThrWorkForce *wf, smfData *idata, smfData **odataq,
             pdata->nbolo = nbolo;
             pdata->ncol = ncol;
             pdata->box_size = box_size;
-            pdata->ipolcrd = ipolcrd;
-            pdata->pasign = pasign ? +1: -1;
-            pdata->paoff = paoff;
             pdata->angrot = angrot;
             pdata->harmonic = harmonic;
             if( wcs ) {
@@ -696,6 +786,8 @@ void smf_fit_qui( ThrWorkForce *wf, smfData *idata, smfData **odataq,
 /* Free resources. */
    job_data = astFree( job_data );
    box_starts = astFree( box_starts );
+   trig = astFree( trig );
+   tflag = astFree( tflag );
 }
 
 static void smf1_fit_qui_job( void *job_data, int *status ) {
@@ -727,8 +819,6 @@ static void smf1_fit_qui_job( void *job_data, int *status ) {
    AstFrameSet *wcs;          /* WCS FrameSet for current time slice */
    AstMapping *g2s;           /* GRID to SKY mapping */
    AstMapping *s2f;           /* SKY to focal plane mapping */
-   const JCMTState *allstates;/* Pointer to array of JCMTState structures */
-   const JCMTState *state;    /* JCMTState info for current time slice */
    dim_t b1;                  /* First bolometer index */
    dim_t b2;                  /* Last bolometer index */
    dim_t box_size;            /* NFirst time slice in box */
@@ -736,6 +826,7 @@ static void smf1_fit_qui_job( void *job_data, int *status ) {
    dim_t ibox;
    dim_t nbolo;               /* Total number of bolometers */
    dim_t ncol;
+   dim_t ngood;               /* No. of usable samples with good data */
    double *dat;               /* Pointer to start of input data values */
    double *din;               /* Pointer to input data array for bolo/time */
    double *ipf;               /* Pointer to output fit array */
@@ -745,8 +836,8 @@ static void smf1_fit_qui_job( void *job_data, int *status ) {
    double *ipv;               /* Pointer to output weights array */
    double *pfit;              /* Pointer to output fit array */
    double *pm;
-   double *ps;
-   double angle;              /* Phase angle for FFT */
+   const char *pf;            /* Pointer to next time slice flag */
+   const double *pt;          /* Pointer to next time slice trig values */
    double angrot;             /* Angle from focal plane X axis to fixed analyser */
    double c1;
    double c2;
@@ -758,9 +849,8 @@ static void smf1_fit_qui_job( void *job_data, int *status ) {
    double fy[2];              /* Focal plane Y coord at bolometer and northern point*/
    double gx;                 /* GRID X coord at bolometer */
    double gy;                 /* GRID Y coord at bolometer */
+   double chol[ NPAR*NPAR ];  /* Decomposition of shared matrix */
    double matrix[ NPAR*NPAR ];
-   double paoff;              /* WPLATE value corresponding to POL_ANG=0.0 */
-   double phi;                /* Angle from fixed analyser to effective analyser */
    double qval;
    double res;
    double s1;                 /* Sum of weighted cosine terms */
@@ -774,17 +864,16 @@ static void smf1_fit_qui_job( void *job_data, int *status ) {
    double sx[2];              /* SKY X coord at bolometer and northern point*/
    double sy[2];              /* SKY Y coord at bolometer and northern point*/
    double tr_angle;
-   double twophi;
    double uval;
    double vector[ NPAR ];
-   double wplate;             /* Angle from fixed analyser to have-wave plate */
    gsl_matrix_view gsl_m;
    gsl_vector_view gsl_b;
    gsl_vector_view gsl_x;
    int harmonic;
-   int ipolcrd;               /* Reference direction for pol_ang */
+   int decomp;                /* Is "matrix" a valid Cholesky decomposition? */
+   int fast;                  /* Use the sums shared by all bolometers? */
+   int gotchol;               /* Has "chol" been set? */
    int nsum1;
-   int pasign;                /* +1 or -1 indicating sense of POL_ANG value */
    smfFitQUIJobData *pdata;   /* Pointer to job data */
    smf_qual_t *qin;           /* Pointer to input quality array for bolo/time */
    smf_qual_t *qua;           /* Pointer to start of input quality values */
@@ -811,7 +900,6 @@ static void smf1_fit_qui_job( void *job_data, int *status ) {
 
    dat = pdata->dat + b1;
    qua = pdata->qua + b1;
-   allstates = pdata->allstates;
    pfit = pdata->ipf ? pdata->ipf + b1 : NULL;
 
    ipi = pdata->ipi ? pdata->ipi + b1 : NULL;
@@ -819,9 +907,6 @@ static void smf1_fit_qui_job( void *job_data, int *status ) {
    ipu = pdata->ipu + b1;
    ipv = pdata->ipv + b1;
 
-   ipolcrd = pdata->ipolcrd;
-   pasign = pdata->pasign;
-   paoff = pdata->paoff;
    angrot = pdata->angrot;
    box_size = pdata->box_size;
    harmonic = pdata->harmonic;
@@ -841,6 +926,10 @@ static void smf1_fit_qui_job( void *job_data, int *status ) {
       g2s = s2f = NULL;
    }
 
+/* The Cholesky decomposition of the matrix formed from the shared sums
+   has not yet been found. */
+   gotchol = 0;
+
 /* Check we have something to do. */
    if( b1 < nbolo && *status == SAI__OK ) {
 
@@ -891,155 +980,66 @@ static void smf1_fit_qui_job( void *job_data, int *status ) {
    values. */
          } else {
 
-/* Initialise pointers to the first input data value, quality value and
-   state info to be used in the current fitting box. */
-            din = dat;
-            qin = qua;
-            state = allstates;
-
 /* Form the sums needed to calculate the best fit Q, U and I. This
    involves looping over all input samples that fall within the fitting box
-   centred on the current output sample. The 44 sums are stored in the
-   "sums" array. Initialise it to hold zeros.  */
-            memset( sums, 0, NSUM*sizeof(*sums) );
-            for( ibox = 0; ibox <  box_size; ibox++,state++ ) {
-
-/* Get the POL_ANG value for this time slice. */
-               angle = state->pol_ang;
+   centred on the current output sample. The 65 sums are stored in the
+   "sums" array. Most of them depend only on the trig values of the
+   samples used, and smf_fit_qui has already formed these over all the
+   samples that have usable JCMTState values ("dsums"). So if all such
+   samples are also usable for the current bolometer, we only need to
+   form the ten sums that involve the bolometer values. These are stored
+   at the same indices they occupy when all the sums are formed
+   together (see smf1_fit_qui_sums). */
+            memcpy( sums, pdata->dsums, NSUM*sizeof(*sums) );
+            sums[ 8 ] = sums[ 16 ] = sums[ 23 ] = sums[ 29 ] = sums[ 34 ] =
+            sums[ 38 ] = sums[ 41 ] = sums[ 43 ] = sums[ 55 ] =
+            sums[ 63 ] = 0.0;
 
-/* Check the input sample has not been flagged during cleaning and is
-   not bad. */
-               if( state->jos_drcontrol == 0 && !( *qin & SMF__Q_FIT ) &&
-                   *din != VAL__BADD && angle != VAL__BADD ) {
+            din = dat;
+            qin = qua;
+            pt = pdata->trig;
+            pf = pdata->tflag;
+            ngood = 0;
+            for( ibox = 0; ibox <  box_size; ibox++,pt += NTRIG,pf++ ) {
+               if( *pf == 2 ) {
+                  if( ( *qin & SMF__Q_FIT ) || *din == VAL__BADD ) break;
+
+                  sums[ 8 ] += pt[ 0 ]*(*din);
+                  sums[ 16 ] += pt[ 2 ]*(*din);
+                  sums[ 23 ] += pt[ 4 ]*(*din);
+                  sums[ 29 ] += pt[ 1 ]*(*din);
+                  sums[ 34 ] += pt[ 3 ]*(*din);
+                  sums[ 38 ] += pt[ 5 ]*(*din);
+                  sums[ 41 ] += ibox*(*din);
+                  sums[ 43 ] += *din;
+                  sums[ 55 ] += pt[ 6 ]*(*din);
+                  sums[ 63 ] += pt[ 7 ]*(*din);
+                  ngood++;
+               }
+               din += nbolo;
+               qin += nbolo;
+            }
+            fast = ( ngood == pdata->nshared );
 
-/* Following SUN/223 (section "Single-beam polarimetry"/"The Polarimeter"),
-   get the angle from the fixed analyser to the half-waveplate axis, in radians.
-   Positive rotation is from focal plane axis 1 (x) to focal plane axis 2 (y).
+/* Otherwise, form all the sums from scratch using only the samples that
+   are usable for the current bolometer. */
+            if( !fast ) {
+               memset( sums, 0, NSUM*sizeof(*sums) );
+               din = dat;
+               qin = qua;
+               pt = pdata->trig;
+               pf = pdata->tflag;
+               for( ibox = 0; ibox <  box_size; ibox++,pt += NTRIG,pf++ ) {
 
-   Not sure about the sign of tcs_az/tr_ang at the moment so do not use them
-   yet. */
-                  wplate = 0.0;
-                  if( ipolcrd == 0 ) {
-                     wplate = pasign*angle + paoff;
-
-                  } else if( *status == SAI__OK ) {
-                     *status = SAI__ERROR;
-                     errRepf( "", "smf_fit_qui: currently only POL_CRD = "
-                              "FPLANE is supported.", status );
+/* Check the input sample has not been flagged during cleaning and is
+   not bad, and that the JCMTState information is usable. */
+                  if( *pf == 2 && !( *qin & SMF__Q_FIT ) && *din != VAL__BADD ) {
+                     smf1_fit_qui_sums( pt, ibox, *din, sums );
                   }
 
-/*
-                     if( ipolcrd == 1 ) {
-                        wplate += state->tcs_az_ang;
-                     } else if( ipolcrd == 2 ) {
-                        wplate += state->tcs_tr_ang;
-                     }
-*/
-
-/* Get the angle from the fixed analyser to the effective analyser
-   position (see SUN/223 again). The effective analyser angle rotates twice
-   as fast as the half-wave plate which is why there is a factor of 2 here. */
-                  phi = 2*wplate;
-                  twophi = 2*phi;
-
-/* Form the trig values needed for the sums. */
-                  s8 = sin( 2*twophi );
-                  c8 = cos( 2*twophi );
-                  s4 = sin( twophi );
-                  c4 = cos( twophi );
-                  s2 = sin( phi );
-                  c2 = cos( phi );
-                  s1 = sin( wplate );
-                  c1 = cos( wplate );
-
-/* Update the sums. The order of the following lines define the index
-   within "sums" at which each sum is stored. */
-                  ps = sums;
-                  *(ps++) += s4*s4;
-                  *(ps++) += s4*c4;
-                  *(ps++) += s4*s2;
-                  *(ps++) += s4*c2;
-                  *(ps++) += s4*s1;
-                  *(ps++) += s4*c1;
-                  *(ps++) += s4*ibox;
-                  *(ps++) += s4;
-                  *(ps++) += s4*(*din);
-
-                  *(ps++) += s2*c4;
-                  *(ps++) += s2*s2;
-                  *(ps++) += s2*c2;
-                  *(ps++) += s2*s1;
-                  *(ps++) += s2*c1;
-                  *(ps++) += s2*ibox;
-                  *(ps++) += s2;
-                  *(ps++) += s2*(*din);
-
-                  *(ps++) += s1*c4;
-                  *(ps++) += s1*c2;
-                  *(ps++) += s1*s1;
-                  *(ps++) += s1*c1;
-                  *(ps++) += s1*ibox;
-                  *(ps++) += s1;
-                  *(ps++) += s1*(*din);
-
-                  *(ps++) += c4*c4;
-                  *(ps++) += c4*c2;
-                  *(ps++) += c4*c1;
-                  *(ps++) += c4*ibox;
-                  *(ps++) += c4;
-                  *(ps++) += c4*(*din);
-
-                  *(ps++) += c2*c2;
-                  *(ps++) += c2*c1;
-                  *(ps++) += c2*ibox;
-                  *(ps++) += c2;
-                  *(ps++) += c2*(*din);
-
-                  *(ps++) += c1*c1;
-                  *(ps++) += c1*ibox;
-                  *(ps++) += c1;
-                  *(ps++) += c1*(*din);
-
-                  *(ps++) += ibox*ibox;
-                  *(ps++) += ibox;
-                  *(ps++) += ibox*(*din);
-
-                  *(ps++) += 1.0;
-                  *(ps++) += *din;
-
-                  *(ps++) += s4*s8;
-                  *(ps++) += s4*c8;
-
-                  *(ps++) += s2*s8;
-                  *(ps++) += s2*c8;
-
-                  *(ps++) += s1*s8;
-                  *(ps++) += s1*c8;
-
-                  *(ps++) += s8*c4;
-                  *(ps++) += s8*c2;
-                  *(ps++) += s8*c1;
-                  *(ps++) += s8*ibox;
-                  *(ps++) += s8;
-                  *(ps++) += s8*(*din);
-                  *(ps++) += s8*s8;
-                  *(ps++) += s8*c8;
-
-                  *(ps++) += c4*c8;
-
-                  *(ps++) += c2*c8;
-
-                  *(ps++) += c1*c8;
-
-                  *(ps++) += c8*ibox;
-                  *(ps++) += c8;
-                  *(ps++) += c8*(*din);
-                  *(ps++) += c8*c8;
+                  din += nbolo;
+                  qin += nbolo;
                }
-
-               din += nbolo;
-               qin += nbolo;
-
             }
 
 /* Now find the parameters of the best fit. First check that there were
@@ -1173,14 +1173,28 @@ static void smf1_fit_qui_job( void *job_data, int *status ) {
                *(pm++) = sums[ 63 ];
 
 /* Find the solution to the 10x10 set of linear equations. The matrix is
-   symmetric and positive-definite so use Cholesky decomposition.  */
+   symmetric and positive-definite so use Cholesky decomposition.
+   The matrix is the same for all bolometers that use the shared sums,
+   so its decomposition is found only once in that case. */
                memset( solution, 0, NPAR*sizeof(*solution) );
                gsl_set_error_handler_off();
-               if( gsl_linalg_cholesky_decomp( &gsl_m.matrix ) != 0 ) {
+               if( fast && gotchol ) {
+                  memcpy( matrix, chol, sizeof( matrix ) );
+                  decomp = 1;
+               } else if( gsl_linalg_cholesky_decomp( &gsl_m.matrix ) != 0 ) {
                   *status = SAI__ERROR;
                   errRepf( "", "smf_fit_qui: Error returned by "
                           "gsl_linalg_cholesky_decomp (bolo %zu)", status, ibolo );
-               } else if( gsl_linalg_cholesky_solve( &gsl_m.matrix, &gsl_b.vector,
+                  decomp = 0;
+               } else {
+                  if( fast ) {
+                     memcpy( chol, matrix, sizeof( matrix ) );
+                     gotchol = 1;
+                  }
+                  decomp = 1;
+               }
+
+               if( decomp && gsl_linalg_cholesky_solve( &gsl_m.matrix, &gsl_b.vector,
                                                      &gsl_x.vector ) != 0 ) {
                   *status = SAI__ERROR;
                   errRepf( "", "smf_fit_qui: Error returned by "
@@ -1227,36 +1241,24 @@ static void smf1_fit_qui_job( void *job_data, int *status ) {
    residuals between the above fit and the supplied data. */
                din = dat;
                qin = qua;
-               state = allstates;
+               pt = pdata->trig;
+               pf = pdata->tflag;
                ipf = pfit;
 
                sum1 = 0.0;
                nsum1 = 0;
 
-               for( ibox = 0; ibox <  box_size; ibox++,state++ ) {
-                  angle = state->pol_ang;
-
+               for( ibox = 0; ibox <  box_size; ibox++,pt += NTRIG,pf++ ) {
                   if( !( *qin & SMF__Q_FIT ) && *din != VAL__BADD &&
-                        angle != VAL__BADD ) {
-                     wplate = pasign*angle + paoff;
-/*
-                        if( ipolcrd == 1 ) {
-                           wplate += state->tcs_az_ang;
-                        } else if( ipolcrd == 2 ) {
-                           wplate += state->tcs_tr_ang;
-                        }
-*/
-                     phi = 2*wplate;
-                     twophi = 2*phi;
-
-                     s8 = sin( 2*twophi );
-                     c8 = cos( 2*twophi );
-                     s4 = sin( twophi );
-                     c4 = cos( twophi );
-                     s2 = sin( phi );
-                     c2 = cos( phi );
-                     s1 = sin( wplate );
-                     c1 = cos( wplate );
+                        *pf != 0 ) {
+                     s4 = pt[ 0 ];
+                     c4 = pt[ 1 ];
+                     s2 = pt[ 2 ];
+                     c2 = pt[ 3 ];
+                     s1 = pt[ 4 ];
+                     c1 = pt[ 5 ];
+                     s8 = pt[ 6 ];
+                     c8 = pt[ 7 ];
 
                      fit = solution[0]*s4 +
                            solution[1]*c4 +
@@ -1306,7 +1308,7 @@ static void smf1_fit_qui_job( void *job_data, int *status ) {
                if( pfit ) {
                   ipf = pfit;
 
-                  for( ibox = 0; ibox <  box_size; ibox++,state++ ) {
+                  for( ibox = 0; ibox <  box_size; ibox++ ) {
                      *ipf = VAL__BADD;
                      ipf += nbolo;
                   }
@@ -1601,4 +1603,134 @@ static void smf1_fit_qui_job2( void *job_data, int *status ) {
    }
 }
 
+static void smf1_fit_qui_sums( const double *trig, dim_t ibox, double din,
+                               double *sums ){
+/*
+*  Name:
+*     smf1_fit_qui_sums
 
+*  Purpose:
+*     Add one input sample into the sums used to fit I, Q and U.
+
+*  Invocation:
+*     void smf1_fit_qui_sums( const double *trig, dim_t ibox, double din,
+*                             double *sums )
+
+*  Arguments:
+*     trig = const double * (Given)
+*        Pointer to the NTRIG trig values for the sample, as stored in
+*        the table created by smf_fit_qui.
+*     ibox = dim_t (Given)
+*        The index of the sample within the fitting box.
+*     din = double (Given)
+*        The bolometer value.
+*     sums = double * (Given and Returned)
+*        The NSUM running sums.
+
+*/
+
+/* Local Variables: */
+   double *ps;
+   double c1;
+   double c2;
+   double c4;
+   double c8;
+   double s1;
+   double s2;
+   double s4;
+   double s8;
+
+/* Get the trig values, stored in the order described in smf_fit_qui. */
+   s4 = trig[ 0 ];
+   c4 = trig[ 1 ];
+   s2 = trig[ 2 ];
+   c2 = trig[ 3 ];
+   s1 = trig[ 4 ];
+   c1 = trig[ 5 ];
+   s8 = trig[ 6 ];
+   c8 = trig[ 7 ];
+
+/* Update the sums. The order of the following lines define the index
+   within "sums" at which each sum is stored. */
+   ps = sums;
+   *(ps++) += s4*s4;
+   *(ps++) += s4*c4;
+   *(ps++) += s4*s2;
+   *(ps++) += s4*c2;
+   *(ps++) += s4*s1;
+   *(ps++) += s4*c1;
+   *(ps++) += s4*ibox;
+   *(ps++) += s4;
+   *(ps++) += s4*din;
+
+   *(ps++) += s2*c4;
+   *(ps++) += s2*s2;
+   *(ps++) += s2*c2;
+   *(ps++) += s2*s1;
+   *(ps++) += s2*c1;
+   *(ps++) += s2*ibox;
+   *(ps++) += s2;
+   *(ps++) += s2*din;
+
+   *(ps++) += s1*c4;
+   *(ps++) += s1*c2;
+   *(ps++) += s1*s1;
+   *(ps++) += s1*c1;
+   *(ps++) += s1*ibox;
+   *(ps++) += s1;
+   *(ps++) += s1*din;
+
+   *(ps++) += c4*c4;
+   *(ps++) += c4*c2;
+   *(ps++) += c4*c1;
+   *(ps++) += c4*ibox;
+   *(ps++) += c4;
+   *(ps++) += c4*din;
+
+   *(ps++) += c2*c2;
+   *(ps++) += c2*c1;
+   *(ps++) += c2*ibox;
+   *(ps++) += c2;
+   *(ps++) += c2*din;
+
+   *(ps++) += c1*c1;
+   *(ps++) += c1*ibox;
+   *(ps++) += c1;
+   *(ps++) += c1*din;
+
+   *(ps++) += ibox*ibox;
+   *(ps++) += ibox;
+   *(ps++) += ibox*din;
+
+   *(ps++) += 1.0;
+   *(ps++) += din;
+
+   *(ps++) += s4*s8;
+   *(ps++) += s4*c8;
+
+   *(ps++) += s2*s8;
+   *(ps++) += s2*c8;
+
+   *(ps++) += s1*s8;
+   *(ps++) += s1*c8;
+
+   *(ps++) += s8*c4;
+   *(ps++) += s8*c2;
+   *(ps++) += s8*c1;
+   *(ps++) += s8*ibox;
+   *(ps++) += s8;
+   *(ps++) += s8*din;
+   *(ps++) += s8*s8;
+   *(ps++) += s8*c8;
+
+   *(ps++) += c4*c8;
+
+   *(ps++) += c2*c8;
+
+   *(ps++) += c1*c8;
+
+   *(ps++) += c8*ibox;
+   *(ps++) += c8;
+   *(ps++) += c8*din;
+   *(ps++) += c8*c8;
+}
@@ -52,6 +52,8 @@
 *        astGetFitsS does not trim trailing space.
 *     2008-12-17 (TIMJ):
 *        use one_strlcpy. Use smf_validate_smfHead.
+*     2026-10-14:
+*        Use smf_fits_seek to locate the keyword.
 *     {enter_further_changes_here}
 
 *  Notes:
@@ -60,6 +62,7 @@
 *     - See also smf_fits_getI and smf_fits_getD
 
 *  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
 *     Copyright (C) 2008 Science and Technology Facilities Council.
 *     Copyright (C) 2005-2006 Particle Physics and Astronomy Research Council.
 *     All Rights Reserved.
@@ -114,6 +117,10 @@ void smf_fits_getS (const smfHead *hdr, const char * name, char * result,
   if (*status != SAI__OK) return;
   if (!smf_validate_smfHead(hdr, 1, 0, status)) return;
 
+  /* Use the keyword index to make the required card current, so that
+     AST does not need to search the whole header for it. */
+  smf_fits_seek( hdr, name, status );
+
   if ( !astGetFitsS( hdr->fitshdr, name, &astres) ) {
     if ( *status == SAI__OK) {
       *status = SMF__NOKWRD;
@@ -82,12 +82,17 @@
 *        Add SEQSTART/SEQEND to the list of START and END FITS headers.
 *     2017-01-10 (GSB):
 *        Add DTAI to begin headers list (for consistency with DUT1).
+*     2026-10-14:
+*        Merge the headers using a KeyMap indexed by keyword, rather
+*        than calling atlMgfts, which searches the second header for
+*        every card in the first. Modify the merged header in place
+*        instead of copying it for every input header.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2007 Particle Physics and Astronomy Research Council.
 *     Copyright (C) 2007-2010 Science & Technology Facilities Council.
-*     Copyright (C) 2016-2017 East Asian Observatory.
+*     Copyright (C) 2016-2017,2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -118,16 +123,20 @@
 #include "star/atl.h"
 #include "smf_err.h"
 
+#include <string.h>
+
 static void
 smf__fits_copy_items( AstFitsChan * fromfits, AstFitsChan * tofits,
                       const char ** items, int * status );
+static void
+smf__fits_overlap( AstFitsChan * fc1, AstFitsChan * fc2, int * status );
+static void
+smf__fits_value( AstFitsChan * fits, char * value, int * status );
 
 void smf_fits_outhdr( AstFitsChan * inhdr, AstFitsChan ** outhdr,
                       int * status ) {
 
 /* Local Variables: */
-   AstFitsChan *temphdr = NULL;  /* FitsChan holding temporary FITS headers */
-
 /* List of BEGIN  headers that are retained even if different */
    const char * begin_items[] = {
      "DATE-OBS",
@@ -213,6 +222,7 @@ void smf_fits_outhdr( AstFitsChan * inhdr, AstFitsChan ** outhdr,
         in smf_find_dateobs */
      if (*status == SAI__OK) {
        hdr.allState = NULL;
+       hdr.fitsidx = NULL;
        hdr.fitshdr = inhdr;
        smf_find_dateobs( &hdr, &mjdnew, NULL, status );
        hdr.fitshdr = *outhdr;
@@ -226,13 +236,15 @@ void smf_fits_outhdr( AstFitsChan * inhdr, AstFitsChan ** outhdr,
 
      }
 
+     /* The merged header is private to this function, so it is modified
+        in place rather than copied. Only the input header is copied. */
      if (mjdnew < mjdref) {
        /* input header is older than merged header:
           Copy beginfits from INPUT to MERGE
           Copy endfits from MERGE to INPUT
        */
        begfits = astCopy( inhdr );
-       endfits = astCopy( *outhdr );
+       endfits = *outhdr;
      } else {
        /* input header is newer than merged header:
           Copy beginfits from MERGE to INPUT
@@ -240,7 +252,7 @@ void smf_fits_outhdr( AstFitsChan * inhdr, AstFitsChan ** outhdr,
 
           Do this even if dates are identical or if we could not read a date.
         */
-       begfits = astCopy( *outhdr );
+       begfits = *outhdr;
        endfits = astCopy( inhdr );
      }
 
@@ -249,12 +261,11 @@ void smf_fits_outhdr( AstFitsChan * inhdr, AstFitsChan ** outhdr,
      smf__fits_copy_items( begfits, endfits, begin_items, status );
      smf__fits_copy_items( endfits, begfits, end_items, status );
 
-     /* now we can merge oldfits and newfits */
-      atlMgfts( 3, begfits, endfits, &temphdr, status );
-      (void) astAnnul( begfits );
-      (void) astAnnul( endfits );
-      (void) astAnnul( *outhdr );
-      *outhdr = temphdr;
+     /* now we can merge oldfits and newfits, leaving the result in
+        begfits */
+     smf__fits_overlap( begfits, endfits, status );
+     (void) astAnnul( endfits );
+     *outhdr = begfits;
    }
 
 /* Remove any ASTWARN cards from the output header, but retain them
@@ -311,3 +322,112 @@ smf__fits_copy_items( AstFitsChan * fromfits, AstFitsChan * tofits,
   }
 
 }
+
+/*
+  Remove from "fc1" every keyword card that does not have the same value
+  in "fc2", in the same way as atlMgfts method 3 (overlap). The keyword
+  values in "fc2" are first stored in a KeyMap so that each card in
+  "fc1" can be checked without searching "fc2". Undefined values are
+  stored as undefined KeyMap entries. If a keyword occurs more than once
+  in "fc2", its first occurrence is used.
+ */
+
+static void
+smf__fits_overlap( AstFitsChan * fc1, AstFitsChan * fc2, int * status ) {
+  AstKeyMap * km = NULL;
+  char card[ 81 ];
+  char key[ 9 ];
+  char value[ 81 ];
+  const char * value2 = NULL;
+  int icard2;
+  int isdef;
+  int match;
+  int there;
+  size_t len;
+
+  if (*status != SAI__OK) return;
+
+  /* Index the keyword cards in fc2. */
+  km = astKeyMap( " " );
+  icard2 = astGetI( fc2, "Card" );
+  astClear( fc2, "Card" );
+  while ( astFindFits( fc2, "%f", card, 0 ) && astOK ) {
+    if ( !strncmp( card + 8, "= ", 2 ) ) {
+      for ( len = 8; len > 0 && card[ len - 1 ] == ' '; len-- );
+      strncpy( key, card, len );
+      key[ len ] = '\0';
+
+      if ( len > 0 && !astMapHasKey( km, key ) ) {
+        isdef = astTestFits( fc2, NULL, &there );
+        if ( isdef ) {
+          smf__fits_value( fc2, value, status );
+          astMapPut0C( km, key, value, NULL );
+        } else {
+          astMapPutU( km, key, NULL );
+        }
+      }
+    }
+    astSetI( fc2, "Card", astGetI( fc2, "Card" ) + 1 );
+  }
+  astSetI( fc2, "Card", icard2 );
+
+  /* Check each keyword card in fc1, deleting it unless fc2 has the same
+     keyword with the same value (or both values are undefined). Deleting
+     a card makes the following card current. */
+  astClear( fc1, "Card" );
+  while ( astFindFits( fc1, "%f", card, 0 ) && astOK ) {
+    match = 1;
+
+    if ( !strncmp( card + 8, "= ", 2 ) ) {
+      for ( len = 8; len > 0 && card[ len - 1 ] == ' '; len-- );
+      strncpy( key, card, len );
+      key[ len ] = '\0';
+
+      match = 0;
+      if ( len > 0 && astMapHasKey( km, key ) ) {
+        isdef = astTestFits( fc1, NULL, &there );
+        if ( astMapDefined( km, key ) ) {
+          if ( isdef && astMapGet0C( km, key, &value2 ) ) {
+            smf__fits_value( fc1, value, status );
+            match = !strcmp( value, value2 );
+          }
+        } else {
+          match = !isdef;
+        }
+      }
+    }
+
+    if ( match ) {
+      astSetI( fc1, "Card", astGetI( fc1, "Card" ) + 1 );
+    } else {
+      astDelFits( fc1 );
+    }
+  }
+
+  km = astAnnul( km );
+
+  /* Remove contiguous blank lines and rewind, as atlMgfts does. */
+  atlRmblft( fc1, status );
+  astClear( fc1, "Card" );
+}
+
+/*
+  Get the value of the current card of "fits" as a string, without
+  trailing spaces. "value" must have room for 81 characters.
+ */
+
+static void
+smf__fits_value( AstFitsChan * fits, char * value, int * status ) {
+  char * cval = NULL;
+  size_t len;
+
+  value[ 0 ] = '\0';
+  if (*status != SAI__OK) return;
+
+  if ( astGetFitsS( fits, NULL, &cval ) && cval ) {
+    strncpy( value, cval, 80 );
+    value[ 80 ] = '\0';
+    for ( len = strlen( value ); len > 0 && value[ len - 1 ] == ' '; len-- );
+    value[ len ] = '\0';
+  }
+}
@@ -0,0 +1,264 @@
+/*
+*+
+*  Name:
+*     smf_fits_seek
+
+*  Purpose:
+*     Make the card holding a FITS keyword the current card
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     found = smf_fits_seek( const smfHead * hdr, const char * name,
+*                            int * status );
+
+*  Arguments:
+*     hdr = const smfHead* (Given)
+*        Header struct. The card pointer of its FitsChan is moved and its
+*        keyword index (if any) is updated.
+*     name = const char * (Given)
+*        Name of the FITS keyword to locate.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     found = int
+*        Non-zero if the keyword was found, in which case the card
+*        containing its first occurrence is the current card of the
+*        FitsChan. Zero if the keyword is not in the header, in which
+*        case the FitsChan is left at end-of-file.
+
+*  Description:
+*     This function locates a keyword in the FITS header of a smfHead.
+*     Rather than searching the FitsChan from the start for every
+*     keyword, it uses a hash table held in the smfHead that maps each
+*     keyword to the number of the card holding it. The table is
+*     built with a single pass through the header the first time it is
+*     needed, so routines that look up large numbers of keywords in
+*     long headers no longer need one complete search per keyword.
+*
+*     The FitsChan may be modified by code that does not know about
+*     the index, so the index is only used as a hint: the card it
+*     names is checked against the keyword and, if it does not match,
+*     the whole FitsChan is searched as before and the entry corrected.
+
+*  Notes:
+*     - A header with a NULL fitsidx component (e.g. one set up on the
+*     stack rather than by smf_create_smfHead) is searched without
+*     using an index.
+*     - Keyword names are compared without regard to case.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     2026-10-14:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+#include <ctype.h>
+#include <string.h>
+
+#include "ast.h"
+#include "sae_par.h"
+#include "mers.h"
+
+/* SMURF includes */
+#include "smf.h"
+#include "smf_typ.h"
+
+/* Prototypes for local static functions. */
+static unsigned int smf1_fits_hash( const char *key );
+static void smf1_fits_keyname( const char *name, char *key );
+static void smf1_fits_build( smfFitsIndex *idx, AstFitsChan *fits,
+                             int *status );
+static int *smf1_fits_entry( smfFitsIndex *idx, const char *key,
+                             int create, int *status );
+
+int smf_fits_seek( const smfHead * hdr, const char * name, int * status ) {
+
+  AstFitsChan *fits;              /* FitsChan to search */
+  char key[ SZFITSCARD + 1 ];     /* Normalised keyword name */
+  int *entry;                     /* Index entry for the keyword */
+  int found = 0;                  /* Was the keyword found? */
+  smfFitsIndex *idx;              /* Keyword index */
+
+  if (*status != SAI__OK) return found;
+  if (!smf_validate_smfHead(hdr, 1, 0, status)) return found;
+
+  fits = hdr->fitshdr;
+  idx = hdr->fitsidx;
+  smf1_fits_keyname( name, key );
+
+  /* If the index does not describe this FitsChan, rebuild it. */
+  if( idx && idx->fitschan != fits ) smf1_fits_build( idx, fits, status );
+
+  /* If the index knows where the keyword is, go straight to that card.
+     astFindFits checks the current card first, so this costs a single
+     comparison when the index is up to date. */
+  if( idx ) {
+    entry = smf1_fits_entry( idx, key, 0, status );
+    if( entry ) {
+      astSetI( fits, "Card", *entry );
+      found = astFindFits( fits, name, NULL, 0 );
+      if( found && astGetI( fits, "Card" ) != *entry ) found = 0;
+    }
+  }
+
+  /* Otherwise, search the whole header and remember where the keyword
+     was found. */
+  if( !found ) {
+    astClear( fits, "Card" );
+    found = astFindFits( fits, name, NULL, 0 );
+    if( found && idx ) {
+      entry = smf1_fits_entry( idx, key, 1, status );
+      if( entry ) *entry = astGetI( fits, "Card" );
+    }
+  }
+
+  if( !astOK ) found = 0;
+  return found;
+}
+
+/* Return the hash of a normalised keyword name (FNV-1a). */
+static unsigned int smf1_fits_hash( const char *key ) {
+  unsigned int hash = 2166136261u;
+  while( *key ) {
+    hash ^= (unsigned char) *(key++);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/* Copy a keyword name, converting it to upper case and removing trailing
+   spaces. */
+static void smf1_fits_keyname( const char *name, char *key ) {
+  size_t i;
+  size_t len = 0;
+
+  for( i = 0; name[ i ] && i < SZFITSCARD; i++ ) {
+    key[ i ] = toupper( (unsigned char) name[ i ] );
+    if( !isspace( (unsigned char) name[ i ] ) ) len = i + 1;
+  }
+  key[ len ] = '\0';
+}
+
+/* Find the index entry for a keyword, returning a pointer to its card
+   number. If "create" is set a new entry is added (with card number
+   zero) when the keyword is not already present, doubling the size of
+   the table if it becomes half full. */
+static int *smf1_fits_entry( smfFitsIndex *idx, const char *key,
+                             int create, int *status ) {
+  char (*oldnames)[ SZFITSCARD + 1 ];
+  dim_t i;
+  dim_t islot;
+  dim_t oldsize;
+  int *oldcards;
+  int *entry;
+
+  if( *status != SAI__OK || !key[ 0 ] ) return NULL;
+
+  /* Keep the table no more than half full so that probe sequences stay
+     short. */
+  if( create && 2*( idx->nused + 1 ) > idx->size ) {
+    oldnames = idx->names;
+    oldcards = idx->cards;
+    oldsize = idx->size;
+
+    idx->size = ( oldsize > 0 ) ? 2*oldsize : 64;
+    idx->names = astCalloc( idx->size, sizeof( *(idx->names) ) );
+    idx->cards = astMalloc( idx->size*sizeof( *(idx->cards) ) );
+    idx->nused = 0;
+
+    if( *status == SAI__OK ) {
+      for( i = 0; i < oldsize; i++ ) {
+        if( oldnames[ i ][ 0 ] ) {
+          entry = smf1_fits_entry( idx, oldnames[ i ], 1, status );
+          if( entry ) *entry = oldcards[ i ];
+        }
+      }
+    } else {
+      idx->size = 0;
+    }
+
+    oldnames = astFree( oldnames );
+    oldcards = astFree( oldcards );
+  }
+
+  if( idx->size == 0 ) return NULL;
+
+  /* Probe linearly from the hashed slot until the keyword or an empty
+     slot is found. */
+  islot = smf1_fits_hash( key ) & ( idx->size - 1 );
+  while( idx->names[ islot ][ 0 ] ) {
+    if( !strcmp( idx->names[ islot ], key ) ) return idx->cards + islot;
+    islot = ( islot + 1 ) & ( idx->size - 1 );
+  }
+
+  if( !create ) return NULL;
+
+  strcpy( idx->names[ islot ], key );
+  idx->cards[ islot ] = 0;
+  idx->nused++;
+  return idx->cards + islot;
+}
+
+/* Empty the index and fill it with the first occurrence of every keyword
+   in the FitsChan. Commentary cards and HIERARCH keywords are left to
+   the full search in smf_fits_seek. */
+static void smf1_fits_build( smfFitsIndex *idx, AstFitsChan *fits,
+                             int *status ) {
+  char card[ SZFITSCARD + 1 ];    /* Formatted header card */
+  char key[ SZFITSCARD + 1 ];     /* Keyword from the card */
+  dim_t i;                        /* Slot index */
+  int *entry;                     /* Index entry for the keyword */
+  int icard;                      /* Current card number */
+
+  if( *status != SAI__OK ) return;
+
+  for( i = 0; i < idx->size; i++ ) idx->names[ i ][ 0 ] = '\0';
+  idx->nused = 0;
+  idx->fitschan = fits;
+
+  astClear( fits, "Card" );
+  icard = 0;
+  while( astFindFits( fits, "%f", card, 1 ) && *status == SAI__OK ) {
+    icard++;
+    card[ 8 ] = '\0';
+    smf1_fits_keyname( card, key );
+    if( strcmp( key, "COMMENT" ) && strcmp( key, "HISTORY" ) &&
+        strcmp( key, "HIERARCH" ) ) {
+      entry = smf1_fits_entry( idx, key, 1, status );
+      if( entry && *entry == 0 ) *entry = icard;
+    }
+  }
+}
@@ -44,8 +44,11 @@
 *  History:
 *     2011-07-09 (EC):
 *        Initial version clones from smf_fits_updateD.c
+*     2026-10-14:
+*        Use smf_fits_seek to locate the keyword.
 
 *  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
 *     Copyright (C) 2011 University of British Columbia
 *     All Rights Reserved.
 
@@ -90,12 +93,9 @@ smf_fits_updateI( smfHead * hdr, const char * name, int value,
 
   fits = hdr->fitshdr;
 
-  /* start from beginning of header since we can not be sure where we are starting
-     from */
-  astClear( fits, "Card" );
-
-  /* Look for the current version of the card */
-  if ( astFindFits( fits, name, NULL, 0 ) ) {
+  /* Look for the current version of the card, using the keyword index to
+     avoid searching the whole header */
+  if ( smf_fits_seek( hdr, name, status ) ) {
     /* found the card - so updating it (no need for comment) */
     retval = -1;
   } else {
@@ -43,8 +43,11 @@
 *  History:
 *     2012-01-04 (TIMJ):
 *        Initial version clones from smf_fits_updateI.c
+*     2026-10-14:
+*        Use smf_fits_seek to locate the keyword.
 
 *  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
 *     Copyright (C) 2011,2012 Science & Technology Facilities Council.
 *     All Rights Reserved.
 
@@ -89,12 +92,9 @@ smf_fits_updateL( smfHead * hdr, const char * name, int value,
 
   fits = hdr->fitshdr;
 
-  /* start from beginning of header since we can not be sure where we are starting
-     from */
-  astClear( fits, "Card" );
-
-  /* Look for the current version of the card */
-  if ( astFindFits( fits, name, NULL, 0 ) ) {
+  /* Look for the current version of the card, using the keyword index to
+     avoid searching the whole header */
+  if ( smf_fits_seek( hdr, name, status ) ) {
     /* found the card - so updating it (no need for comment) */
     retval = -1;
   } else {
@@ -43,8 +43,11 @@
 *        Initial version.
 *     2009-06-26 (TIMJ):
 *        Copy from smf_fits_updateD
+*     2026-10-14:
+*        Use smf_fits_seek to locate the keyword.
 
 *  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
 *     Copyright (C) 2009 Science & Technology Facilities Council.
 *     All Rights Reserved.
 
@@ -89,12 +92,9 @@ smf_fits_updateU( smfHead * hdr, const char * name,
 
   fits = hdr->fitshdr;
 
-  /* start from beginning of header since we can not be sure where we are starting
-     from */
-  astClear( fits, "Card" );
-
-  /* Look for the current version of the card */
-  if ( astFindFits( fits, name, NULL, 0 ) ) {
+  /* Look for the current version of the card, using the keyword index to
+     avoid searching the whole header */
+  if ( smf_fits_seek( hdr, name, status ) ) {
     /* found the card - so updating it (no need for comment) */
     retval = -1;
   } else {
@@ -81,8 +81,11 @@
 *     2019-03-19 (GSB):
 *        Avoid reading beyond end of state array.  Correct sense of rts_end
 *        comparison.
+*     2026-10-14:
+*        Take a private copy of any shared JCMTState array before fixing it.
 
 *  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
 *     Copyright (C) 2009 Science & Technology Facilities Council.
 *     Copyright (C) 2009 University of British Columbia.
 *     All Rights Reserved.
@@ -146,6 +149,7 @@ int smf_fix_metadata ( msglev_t msglev, smfData * data, int * status ) {
   if (*status != SAI__OK) return have_fixed;
 
   fits = hdr->fitshdr;
+  smf_state_own( hdr, status );
   tmpState = hdr->allState;
 
   /* find out where the FITS header currently ends */
@@ -55,10 +55,13 @@
 *        reporting an error. Also set POLANG values bad that occur after the
 *        unexpected feature, so that the data prior to the unexpected
 *        feature can be used.
+*     14-OCT-2026:
+*        Take a private copy of any shared JCMTState array before
+*        shuffling the POL_ANG values.
 
 *  Copyright:
 *     Copyright (C) 2012 Science and Technology Facilities Council.
-*     Copyright (C) 2016 East Asian Observatory
+*     Copyright (C) 2016, 2026 East Asian Observatory
 *     All Rights Reserved.
 
 *  Licence:
@@ -288,6 +291,7 @@ void smf_fix_pol2( ThrWorkForce *wf,  smfArray *array, int *status ){
 
 /* Now shuffle the POL_ANG values down to remove the accepted bonus values. */
       if( njump > 0 || ntgood < hdr->nframes ) {
+         smf_state_own( hdr, status );
          state = wstate = hdr->allState;
          ijump = 0;
          next_jump = jumps ? jumps[ ijump ] : hdr->nframes + 1;
@@ -238,6 +238,22 @@
 *        and not defined locally. The scaling of dcmaxsteps leaves the
 *        value unchanged for a sample rate of 80 Hz (a scan speed of 320
 *        arcsec/sec at 4 arcsec pixels).
+*     14-OCT-2026:
+*        - Skip the search for candidate steps in any bolometer in which
+*        no residual difference can exceed the detection threshold (see
+*        smf1_no_steps). This avoids the second median smoothing for
+*        clean bolometers.
+*        - Sum the per-thread step counts in parallel over blocks of time
+*        slices, and find the blocks of correlated steps once, rather than
+*        once for every bolometer. Bolometers that have no candidate
+*        correlated steps (and the whole correlated step pass, if there
+*        are no correlated steps at all) are now skipped without median
+*        smoothing the data. The correlated step pass no longer updates
+*        the step counts while other threads are reading them, so the
+*        results no longer depend on the number of threads. Also check
+*        for previous jumps using the correct stride for time-ordered
+*        data, and return details of correlated steps found by threads
+*        that fixed no primary steps.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -282,6 +298,8 @@
 typedef struct smfFixStepsJobData {
    dim_t b1;
    dim_t b2;
+   dim_t t1;
+   dim_t t2;
    dim_t dcfitbox;
    dim_t dcsmooth;
    dim_t nbolo;
@@ -293,13 +311,16 @@ typedef struct smfFixStepsJobData {
    double dcthresh3;
    double dcthresh;
    int *bcount;
+   int *bcsum;
    int dcfill;
    int dclimcorr;
    int dcmaxsteps;
    int dcmaxwidth;
    int dcsmooth2;
    int meanshift;
+   int ncstep;
    int nfixed;
+   int njob;
    int nstep;
    size_t bstride;
    size_t nrej;
@@ -307,6 +328,8 @@ typedef struct smfFixStepsJobData {
    smfStepFix *steps;
    smf_qual_t *qua;
    smfData *data;
+   struct Step *csteps;
+   struct smfFixStepsJobData *jobs;
 } smfFixStepsJobData;
 
 
@@ -401,8 +424,12 @@ static int smf1_correct_steps( dim_t ntslice, double *dat, smf_qual_t *qua,
                                double *grad, double *off, int *bcount,
                                int *status );
 
+static int smf1_no_steps( dim_t ntslice, dim_t box, double dcthresh,
+                          const double *sqres, double *work );
+static double smf1_select( double *work, int n, int k );
 static void smf1_fix_steps_job( void *job_data, int *status );
 static void smf1_fix_correlated_steps_job( void *job_data, int *status );
+static void smf1_sum_bcount_job( void *job_data, int *status );
 
 
 
@@ -414,17 +441,23 @@ void smf_fix_steps( ThrWorkForce *wf, smfData *data, double dcthresh,
                     smfStepFix **steps, int *nstep, int *status ) {
 
 /* Local Variables */
+   Step *csteps = NULL;
    dim_t itime;
    dim_t nbolo;
    dim_t ntslice;
+   dim_t tstep;
    double *bolonoise = NULL;
    double *dat = NULL;
    int *bcount;
    int bstep;
    int istep;
    int iworker;
+   int ncstep;
    int nfixed;
    int nworker;
+   int step_end;
+   int step_limit;
+   int step_start;
    size_t bstride;
    size_t tstride;
    smfFixStepsJobData *job_data = NULL;
@@ -645,25 +678,72 @@ void smf_fix_steps( ThrWorkForce *wf, smfData *data, double dcthresh,
          }
 
          pdata->steps = astFree( pdata->steps );
+      }
 
-         if( bcount ) {
-            for( itime = 0; itime < ntslice; itime++ ) {
-               bcount[ itime ] += pdata->bcount[ itime ];
-            }
-            pdata->bcount = astFree( pdata->bcount );
+/* If required, form the total number of bolometers that have a step at
+   each time slice, by summing the counts returned by the threads. Each
+   thread sums a separate block of time slices. */
+      if( bcount ) {
+         tstep = ntslice/nworker;
+         if( tstep < 1 ) tstep = 1;
+
+         for( iworker = 0; iworker < nworker; iworker++ ) {
+            pdata = job_data + iworker;
+            pdata->t1 = iworker*tstep;
+            pdata->t2 = ( iworker < nworker - 1 ) ? pdata->t1 + tstep : ntslice;
+            if( pdata->t2 > ntslice ) pdata->t2 = ntslice;
+            pdata->bcsum = bcount;
+            pdata->jobs = job_data;
+            pdata->njob = nworker;
+            thrAddJob( wf, 0, pdata, smf1_sum_bcount_job, 0, NULL, status );
          }
+         thrWait( wf, status );
 
+         for( iworker = 0; iworker < nworker; iworker++ ) {
+            pdata = job_data + iworker;
+            pdata->bcount = astFree( pdata->bcount );
+         }
       }
 
 /* If required, fix correlated steps. */
-      if( dclimcorr > 0 ) {
+      if( dclimcorr > 0 && *status == SAI__OK ) {
+
+/* Find the start and end of each block of contiguous high bolometer
+   counts in the "bcount" array. These blocks are the same for all
+   bolometers, so find them once here rather than in each worker. A
+   block extends until "dcfill" low counts have been found following the
+   last high count. Blocks that are too wide are ignored. */
+         ncstep = 0;
+         step_start = -1;
+         step_end = 0;
+         step_limit = -1;
+         for( itime = 0; itime < ntslice; itime++ ) {
+            if( bcount[ itime ] > dclimcorr ) {
+               if( step_start == -1 ) step_start = itime;
+               step_end = itime;
+               step_limit = itime + dcfill;
+
+            } else if( (int) itime == step_limit ) {
+               if( step_end - step_start + 1 <= dcmaxwidth ) {
+                  csteps = astGrow( csteps, ++ncstep, sizeof( *csteps ) );
+                  if( *status == SAI__OK ) {
+                     csteps[ ncstep - 1 ].start = step_start;
+                     csteps[ ncstep - 1 ].end = step_end;
+                  }
+               }
+               step_start = -1;
+            }
+         }
 
 /* Update the info needed by the worker threads, and submit the jobs to
    fix the correlated steps in each bolo, and then wait for them to
-   complete. */
-         for( iworker = 0; iworker < nworker; iworker++ ) {
+   complete. There is nothing to do if no blocks were found. */
+         for( iworker = 0; iworker < nworker && ncstep > 0; iworker++ ) {
             pdata = job_data + iworker;
             pdata->bcount = bcount;
+            pdata->csteps = csteps;
+            pdata->ncstep = ncstep;
+            pdata->nstep = ( steps && nstep ) ? 1 : 0;
             thrAddJob( wf, THR__REPORT_JOB, pdata,
                          smf1_fix_correlated_steps_job, 0, NULL, status );
          }
@@ -672,7 +752,7 @@ void smf_fix_steps( ThrWorkForce *wf, smfData *data, double dcthresh,
          thrWait( wf, status );
 
 /* Accumuate the returned values from each thread. */
-         for( iworker = 0; iworker < nworker; iworker++ ) {
+         for( iworker = 0; iworker < nworker && ncstep > 0; iworker++ ) {
             pdata = job_data + iworker;
 
             nfixed += pdata->nfixed;
@@ -710,6 +790,7 @@ void smf_fix_steps( ThrWorkForce *wf, smfData *data, double dcthresh,
    job_data = astFree( job_data );
    bolonoise = astFree( bolonoise );
    bcount = astFree( bcount );
+   csteps = astFree( csteps );
 }
 
 
@@ -1245,6 +1326,15 @@ if( RECORD_BOLO ) {
                }
             }
 
+/* If no residual difference can exceed the detection threshold, there
+   are no candidate steps and so nothing more needs to be done for this
+   bolometer. The check is cheap compared to the median filtering below. */
+#ifndef DEBUG_STEPS
+            if( smf1_no_steps( ntslice, dcsmooth2, dcthresh, w3, w4 ) ) {
+               continue;
+            }
+#endif
+
 /* Smooth the squared residual differences with a median filter. */
             smf_median_smooth( dcsmooth2, SMF__FILT_MEDIAN, 0.0, ntslice,
                                w3, NULL, 1, 0, w4, mw1, mw2, mw3, status );
@@ -2244,6 +2334,7 @@ static void smf1_fix_correlated_steps_job( void *job_data, int *status ) {
 
 /* Local Variables: */
    Step *bsteps = NULL;
+   Step *csteps;
    dim_t b1;
    dim_t b2;
    dim_t dcfitbox;
@@ -2263,22 +2354,17 @@ static void smf1_fix_correlated_steps_job( void *job_data, int *status ) {
    double rms;
    int *bcount;
    int *mw3;
-   int *pbc;
-   int dcfill;
    int dclimcorr;
-   int dcmaxwidth;
    int ibstep;
+   int icstep;
    int mbstep;
    int meanshift;
    int msize;
    int nbstep;
+   int ncstep;
    int nfixed;
    int nstep;
    int old_jump;
-   int step_end;
-   int step_limit;
-   int step_start;
-   int step_width;
    size_t *mw2;
    size_t base;
    size_t bstride;
@@ -2304,16 +2390,16 @@ static void smf1_fix_correlated_steps_job( void *job_data, int *status ) {
    bcount = pdata->bcount;
    bolonoise = pdata->bolonoise;
    bstride = pdata->bstride;
+   csteps = pdata->csteps;
    dat = pdata->dat;
-   dcfill = pdata->dcfill;
    dcfitbox = pdata->dcfitbox;
    dclimcorr = pdata->dclimcorr;
-   dcmaxwidth = pdata->dcmaxwidth;
    dcsmooth = pdata->dcsmooth;
    dcthresh2 = 0.2*pdata->dcthresh2;
    dcthresh3 = 0.2*pdata->dcthresh3;
    meanshift = pdata->meanshift;
    nbolo = pdata->nbolo;
+   ncstep = pdata->ncstep;
    ntslice = pdata->ntslice;
    qua = pdata->qua;
    tstride = pdata->tstride;
@@ -2367,6 +2453,40 @@ static void smf1_fix_correlated_steps_job( void *job_data, int *status ) {
          pq = qua + base;
          if( !(*pq & SMF__Q_BADB) ) {
 
+/* The blocks of correlated steps (i.e. blocks of contiguous time slices
+   at which many bolometers have a step) were found by smf_fix_steps.
+   Use each block as a candidate step in the current bolometer unless it
+   includes a previously corrected jump. Only the time slices with a high
+   bolometer count are checked for previous jumps. */
+            nbstep = 0;
+            for( icstep = 0; icstep < ncstep; icstep++ ) {
+               old_jump = 0;
+               pq = qua + base + csteps[ icstep ].start*tstride;
+               for( itime = csteps[ icstep ].start;
+                    itime <= csteps[ icstep ].end; itime++ ) {
+                  if( bcount[ itime ] > dclimcorr && ( *pq & SMF__Q_JUMP ) ) {
+                     old_jump = 1;
+                     break;
+                  }
+                  pq += tstride;
+               }
+
+               if( ! old_jump ) {
+                  ibstep = nbstep++;
+                  bsteps = astGrow( bsteps, nbstep, sizeof( *bsteps ) );
+                  if( *status == SAI__OK ) {
+                     bsteps[ ibstep ].start = csteps[ icstep ].start;
+                     bsteps[ ibstep ].end = csteps[ icstep ].end;
+                     bsteps[ ibstep ].minjump = dcthresh3*bolonoise[ ibolo ];
+                  }
+               }
+            }
+
+/* If there are no candidate steps in this bolometer, pass on to the next
+   bolometer without smoothing the data. */
+            if( nbstep == 0 ) continue;
+            pq = qua + base;
+
 /* Get a contiguous copy of the quality array. Only needed if doing a
    mean shift filter. */
             if( meanshift ) {
@@ -2457,104 +2577,35 @@ if( RECORD_BOLO ) {
 #endif
 
 
-/* Find the start and end of each block of contiguous high bolometer
-   counts in the supplied "bcount" array. This array holds the number of
-   bolometers found to have a step at each time slice. */
-            nbstep = 0;
-            step_start = -1;
-            step_end = 0;
-            step_limit = -1;
-            old_jump = 0;
-
-            pbc = bcount;
-            pq = qua + base;
-            for( itime = 0; itime < ntslice; itime++,pbc++,pq++ ) {
-
-#ifdef DEBUG_STEPS
-   if( RECORD_BOLO ) {
-      timedata[ itime ].snr = *pbc;
-   }
-#endif
-
-/* If the bcount value at the current time slice is larger than the
-   threshold, it is considered to be in a jump. */
-               if( *pbc > dclimcorr ) {
-
-/* A jump may extend over more than 1 sample, so we group localised clumps
-   of high bcount together. If we are not currently within such a
-   group, record the current time index as the start of a new group. */
-                  if( step_start == -1 ) {
-                     step_start = itime;
-                     old_jump = 0;
-                  }
-
-/* Set a flag if a previous jump is encountered within the new step. */
-                  if( (*pq & SMF__Q_JUMP ) ) old_jump = 1;
-
-/* The group extends at least as far as the current sample. */
-                  step_end = itime;
-
-/* Do not consider the group to be finished until we have found "dcfill"
-   small differences following the last large difference. */
-                  step_limit = itime + dcfill;
-
-/* If the current bcount value is small, and we have had "dcfill" small
-   values since the end of the last group, we now know where the last
-   group ended so we can go on to process the group. */
-               } else if( (int) itime == step_limit ) {
-
-/* Check the group is not too wide, and that it does not include a
-   previously corrected jump. */
-                  step_width = step_end - step_start + 1;
-
 #ifdef DEBUG_STEPS
    if( RECORD_BOLO ) {
       int jtime;
-      for( jtime = step_start; jtime <= step_end; jtime++ ) {
-         timedata[ jtime ].step_width = step_width;
+      for( itime = 0; itime < ntslice; itime++ ) {
+         timedata[ itime ].snr = bcount[ itime ];
       }
-   }
-#endif
-
-                  if( step_width <= dcmaxwidth && ! old_jump ){
-
-/* Create a new structure to describe the group, and add it to the array
-   of such groups. */
-                     ibstep = nbstep++;
-                     bsteps = astGrow( bsteps, nbstep, sizeof( *bsteps ) );
-                     if( *status == SAI__OK ) {
-                        bsteps[ ibstep ].start = step_start;
-                        bsteps[ ibstep ].end = step_end;
-                        bsteps[ ibstep ].minjump = dcthresh3*bolonoise[ ibolo ];
-
-#ifdef DEBUG_STEPS
-   if( RECORD_BOLO ) {
-      int jtime;
-      for( jtime = step_start; jtime <= step_end; jtime++ ) {
-         timedata[ jtime ].instep = 1;
+      for( ibstep = 0; ibstep < nbstep; ibstep++ ) {
+         for( jtime = bsteps[ ibstep ].start; jtime <= (int) bsteps[ ibstep ].end;
+              jtime++ ) {
+            timedata[ jtime ].step_width = bsteps[ ibstep ].end -
+                                           bsteps[ ibstep ].start + 1;
+            timedata[ jtime ].instep = 1;
+         }
       }
    }
 #endif
 
-                     }
-                  }
-
-/* We can now start looking for a new step. */
-                  step_start = -1;
-               }
-            }
-
 /* We now have the starting and ending times for all the candidate
    correlated jumps in the current bolometer. Attempt to measure each
    candidate correlated step, and correct the bolometer data for each
-   succesfully measured step. */
+   succesfully measured step. The bolometer counts are not updated, since
+   they have already been used to find the candidate steps. */
             mbstep = smf1_correct_steps( ntslice, dat + base, qua + base,
                                          tstride, w1, NULL, dcfitbox,
                                          dcthresh2, nbstep, bsteps, ibolo,
                                          meanshift, data->hdr->steptime,
                                          (pdata->nstep)?&steps:NULL,
                                          (pdata->nstep)?&nstep:NULL,
-                                         w4, w5, bcount, status );
+                                         w4, w5, NULL, status );
 
 #ifdef DEBUG_STEPS
    if( RECORD_BOLO2 ) {
@@ -2643,6 +2694,270 @@ if( RECORD_BOLO ) {
 }
 
 
+static void smf1_sum_bcount_job( void *job_data, int *status ) {
+/*
+*  Name:
+*     smf1_sum_bcount_job
+
+*  Purpose:
+*     Sum the step counts returned by each thread for a block of time
+*     slices.
+
+*  Invocation:
+*     void smf1_sum_bcount_job( void *job_data, int *status )
+
+*  Arguments:
+*     job_data = void * (Given)
+*        Pointer to the data needed by the job. Should be a pointer to a
+*        smfFixStepsJobData structure.
+*     status = int * (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     This routine adds the number of bolometers found to have a step at
+*     each time slice in the range "t1" to "t2"-1, by each of the threads
+*     that ran smf1_fix_steps_job, into the "bcsum" array. It runs within
+*     a thread instigated by smf_fix_steps.
+
+*/
+
+/* Local Variables: */
+   dim_t itime;
+   int *pbc;
+   int ijob;
+   smfFixStepsJobData *pdata;
+   smfFixStepsJobData *pjob;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Get a pointer to the job data. */
+   pdata = (smfFixStepsJobData *) job_data;
+
+/* Add the counts from each thread in turn into the total. */
+   for( ijob = 0; ijob < pdata->njob; ijob++ ) {
+      pjob = pdata->jobs + ijob;
+      pbc = pjob->bcount;
+      if( pbc ) {
+         for( itime = pdata->t1; itime < pdata->t2; itime++ ) {
+            pdata->bcsum[ itime ] += pbc[ itime ];
+         }
+      }
+   }
+}
+
+
+static int smf1_no_steps( dim_t ntslice, dim_t box, double dcthresh,
+                          const double *sqres, double *work ) {
+/*
+*  Name:
+*     smf1_no_steps
+
+*  Purpose:
+*     See if a bolometer is free of candidate steps.
+
+*  Invocation:
+*     int smf1_no_steps( dim_t ntslice, dim_t box, double dcthresh,
+*                        const double *sqres, double *work )
+
+*  Arguments:
+*     ntslice = dim_t (Given)
+*        The number of time slices.
+*     box = dim_t (Given)
+*        The size of the median filter that will be used to find the
+*        local noise in the residual differences (i.e. "dcsmooth2").
+*     dcthresh = double (Given)
+*        The detection threshold for a jump, as used by
+*        smf1_fix_steps_job.
+*     sqres = const double * (Given)
+*        The squared residual differences. VAL__BADD values are ignored.
+*     work = double * (Given and Returned)
+*        A work array with at least "ntslice" elements.
+
+*  Returned Value:
+*     Non-zero if no residual difference can exceed "dcthresh" times the
+*     local RMS, in which case smf1_fix_steps_job would find no candidate
+*     steps. Zero if there may be candidate steps.
+
+*  Description:
+*     smf1_fix_steps_job compares the residual difference at each time
+*     slice with the local RMS, found by median filtering the squared
+*     residual differences in a box of "box" samples. This routine avoids
+*     the median filtering by finding a lower limit on the median filtered
+*     values within each block of "box/2" time slices, and comparing it
+*     with the largest squared residual difference in the block.
+*
+*     If the filter box centred on any time slice within a block contains
+*     at least "m" good values, its median is no lower than the
+*     "(m+1)/2"'th smallest value in the union of the filter boxes for
+*     the block. This value is found by partial sorting (it takes about
+*     three times as many values as there are samples), and so provides
+*     the required lower limit. Time slices beyond the end of the
+*     filtered data use the last filtered value, and so are included in
+*     the final block. Time slices before the start of the filtered data
+*     are never tested by smf1_fix_steps_job. A small safety margin is
+*     included in the comparison to guard against rounding errors. If a
+*     filter box contains no good values, or the lower limit is zero,
+*     zero is returned.
+
+*/
+
+/* Local Variables: */
+   dim_t b1;
+   dim_t b2;
+   dim_t bsize;
+   dim_t hbox;
+   dim_t ihi;
+   dim_t iout;
+   dim_t itime;
+   dim_t jhi;
+   dim_t mmin;
+   dim_t ngood;
+   double lim;
+   double maxsq;
+   double v;
+   int n;
+
+/* The median filter is limited to the size of the data array (see
+   smf_median_smooth). */
+   if( box > ntslice ) box = ntslice;
+   if( box == 0 ) return 0;
+
+/* The median filter produces good values for time slices "box/2" to
+   "ihi"-1. If there are none, no residual difference is ever tested. */
+   hbox = box/2;
+   ihi = ntslice - ( box + 1 )/2;
+   if( ihi <= hbox ) return 1;
+
+   bsize = box/2;
+   if( bsize == 0 ) bsize = 1;
+
+/* The threshold for a jump, with a margin for rounding errors. */
+   lim = 0.99*dcthresh*dcthresh;
+
+/* Count the good values in the first filter box. The filter box used
+   for time slice "iout" covers time slices "iout-hbox" to
+   "iout-hbox+box-1". */
+   ngood = 0;
+   for( itime = 0; itime < box; itime++ ) {
+      if( sqres[ itime ] != VAL__BADD ) ngood++;
+   }
+
+/* Loop round each block of time slices. */
+   iout = hbox;
+   while( iout < ihi ) {
+      b1 = iout;
+      b2 = b1 + bsize;
+      if( b2 > ihi ) b2 = ihi;
+
+/* Find the smallest number of good values in any filter box for the
+   block, and the largest squared residual difference in the block,
+   moving the filter box on by one time slice at a time. */
+      mmin = ngood;
+      maxsq = 0.0;
+      for( ; iout < b2; iout++ ) {
+         if( ngood < mmin ) mmin = ngood;
+         v = sqres[ iout ];
+         if( v != VAL__BADD && v > maxsq ) maxsq = v;
+         if( iout + 1 < ihi ) {
+            if( sqres[ iout - hbox ] != VAL__BADD ) ngood--;
+            if( sqres[ iout - hbox + box ] != VAL__BADD ) ngood++;
+         }
+      }
+
+/* The time slices after the end of the filtered data are compared with
+   the last filtered value. */
+      if( b2 == ihi ) {
+         for( itime = ihi; itime < ntslice; itime++ ) {
+            v = sqres[ itime ];
+            if( v != VAL__BADD && v > maxsq ) maxsq = v;
+         }
+      }
+
+/* Nothing more to check if the block contains no non-zero residuals. */
+      if( maxsq > 0.0 ) {
+         if( mmin == 0 ) return 0;
+
+/* Copy the good values in the union of the filter boxes for the block
+   into the work array, and find the lower limit on the filtered values. */
+         n = 0;
+         jhi = b2 - 1 - hbox + box;
+         for( itime = b1 - hbox; itime < jhi; itime++ ) {
+            if( sqres[ itime ] != VAL__BADD ) work[ n++ ] = sqres[ itime ];
+         }
+         v = smf1_select( work, n, ( mmin + 1 )/2 - 1 );
+
+/* Candidate steps are possible if the largest residual is not small
+   enough compared to the lower limit. */
+         if( v <= 0.0 || maxsq > lim*v ) return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+static double smf1_select( double *work, int n, int k ) {
+/*
+*  Name:
+*     smf1_select
+
+*  Purpose:
+*     Find the k'th smallest value in an array.
+
+*  Invocation:
+*     double smf1_select( double *work, int n, int k )
+
+*  Arguments:
+*     work = double * (Given and Returned)
+*        The array of values. Its contents are re-ordered on exit.
+*     n = int (Given)
+*        The number of values in the array.
+*     k = int (Given)
+*        The zero-based rank of the required value (0 to n-1).
+
+*  Returned Value:
+*     The k'th smallest value.
+
+*  Description:
+*     The array is partially sorted using Hoare's selection algorithm,
+*     which takes a time proportional to "n" on average.
+
+*/
+
+/* Local Variables: */
+   double t;
+   double x;
+   int i;
+   int j;
+   int l;
+   int m;
+
+   l = 0;
+   m = n - 1;
+   while( l < m ) {
+      x = work[ k ];
+      i = l;
+      j = m;
+      do {
+         while( work[ i ] < x ) i++;
+         while( x < work[ j ] ) j--;
+         if( i <= j ) {
+            t = work[ i ];
+            work[ i ] = work[ j ];
+            work[ j ] = t;
+            i++;
+            j--;
+         }
+      } while( i <= j );
+      if( j < k ) l = i;
+      if( k < i ) m = j;
+   }
+
+   return work[ k ];
+}
+
+
 #ifdef DEBUG_STEPS
 static int get_debug_bolo( void ) {
    while( debug_bolo < 0 ) {
@@ -54,8 +54,9 @@
 *     omitted from the noise box, thus preventing the spike from upsetting
 *     the local noise estimate.
 *
-*     Some complication is introduced into the coding is an attempt to
-*     speed up the median filtering.
+*     The median is maintained using smf_runfilt_init etc., so that
+*     moving the filter box on by one time slice takes a time proportional
+*     to the log of the box size, rather than re-sorting the box.
 
 *  Notes:
 *     - No spikes are ever flagged in the first and last "box/2" time-slices.
@@ -74,6 +75,10 @@
 *        Five years later, we discover that time-based de-spiking has
 *        been completely broken the whole time because of incorrect
 *        indexing within the parallel code.
+*     14-OCT-2026:
+*        Use smf_runfilt to maintain the median of the filter box, rather
+*        than sorting the first box and then shuffling a sorted copy of
+*        the box for every time slice.
 
 *  Copyright:
 *     Copyright (C) 2010 Science and Technology Facilities Council.
@@ -109,9 +114,6 @@
 /* SMURF includes */
 #include "libsmf/smf.h"
 
-/* Other includes */
-#include <gsl/gsl_sort.h>
-
 /* ------------------------------------------------------------------------ */
 /* Local variables and functions */
 
@@ -142,14 +144,11 @@ static void smfFlagSpikesPar( void *job_data_ptr, int *status ) {
    size_t bstride;             /* Vector stride between bolometer samples */
    double *dat = NULL;         /* Pointer to bolo data */
    double dnew;                /* Data value being added into the filter box */
-   double dold;                /* Data value being removed from the filter box*/
-   int iadd;                   /* Index within box at which to store new value*/
+   double dold;                /* Data value being removed from the noise box*/
    dim_t ibolo;                /* Bolometer index */
    dim_t ibox;                 /* Index within box */
-   dim_t iold;                 /* Index of oldest value in "w2" */
-   dim_t inbox;                /* Number of values in current filter box */
+   dim_t iold;                 /* Slot holding the oldest value in the box */
    int inoise;                 /* Index within noisebox element to be removed */
-   int iremove;                /* Index within box of element to be removed */
    dim_t itime;                /* Time-slice index */
    dim_t lasttime;             /* Last time-slice index to check for spikes */
    double lmedian;             /* Median value in previous filter box */
@@ -173,15 +172,15 @@ static void smfFlagSpikesPar( void *job_data_ptr, int *status ) {
    smf_qual_t *pqua = NULL;    /* Pointer to next quality flag */
    smf_qual_t *pqua0 = NULL;   /* Pointer to first bolo quality value */
    smf_qual_t *pqua1 = NULL;   /* Pointer to last bolo quality value */
-   double *pw1 = NULL;         /* Pointer to next "w1" value */
-   double *pw2 = NULL;         /* Pointer to next "w2" value */
    smf_qual_t *qua = NULL;     /* Pointer to quality flags */
+   smfRunFilt rf;              /* Contents of the filter box */
    int spike;                  /* Is current time slice a spike? */
    double thresh;              /* threshold for spikes */
    size_t tstride;             /* Vector stride between time samples */
    double umedian;             /* Lagged median value */
-   double *w1 = NULL;          /* Array holding sorted data values */
-   double *w2 = NULL;          /* Array holding un-sorted data values */
+   double *w1 = NULL;          /* Work array for the filter box */
+   size_t *w2 = NULL;          /* Work array for the filter box */
+   int *w3 = NULL;             /* Work array for the filter box */
 
 /* Retrieve job data */
    pdata = job_data_ptr;
@@ -214,6 +213,7 @@ static void smfFlagSpikesPar( void *job_data_ptr, int *status ) {
 /* Allocate work arrays. */
    w1 = astMalloc( sizeof( *w1 )*box );
    w2 = astMalloc( sizeof( *w2 )*box );
+   w3 = astMalloc( sizeof( *w3 )*box );
    noisebox = astMalloc( sizeof( *noisebox )*box );
 
 /* Initialise pointers to the first data value and quality value for the
@@ -247,21 +247,25 @@ static void smfFlagSpikesPar( void *job_data_ptr, int *status ) {
          for( ibox = 0; ibox < ( box + 1 )/2; ibox++ ) *(pn++) = VAL__BADD;
 
 /* Initialise the filter box to contain the first "box" values from the
-   current bolometer time-series. Do not store bad or flagged values in
-   the filter box. The good values are stored at the start of the "w1"
-   array, with no gaps. The "w2" array holds all values in the box, good
-   or bad, in the order they occur in the time-series (i.e. un-sorted). */
+   current bolometer time-series. Bad or flagged values occupy a slot in
+   the box but are otherwise ignored. Each value is stored in the slot
+   given by its offset from the start of the time-series, modulo "box",
+   so that each new value can replace the oldest value in the box. The
+   median of the box can then be updated in a time proportional to the
+   log of the box size, rather than sorting the box for each sample. */
+         smf_runfilt_init( &rf, SMF__FILT_MEDIAN, box, w1, w2, w3, status );
+         if( *status != SAI__OK ) break;
+
          pdat = pdat0;
          pqua = pqua0;
-         pw1 = w1;
-         pw2 = w2;
          for( ibox = 0; ibox < box; ibox++ ) {
 
             if( !( *pqua & mask ) && *pdat != VAL__BADD ) {
-               *(pw2++) = *(pw1++) = *pdat;
+               dnew = *pdat;
             } else {
-               *(pw2++) = VAL__BADD;
+               dnew = VAL__BADD;
             }
+            smf_runfilt_add( &rf, ibox, dnew, status );
 
 /* Also store values these data values in the second half of the noise
    box. Check we have not reached the end of the noise box. */
@@ -269,7 +273,7 @@ static void smfFlagSpikesPar( void *job_data_ptr, int *status ) {
 
 /* Store the value in the next element of the noise box, and if the value is
    good, update the running sums used for calculating the noise level. */
-               if( ( *(pn++) = pw2[-1] ) != VAL__BADD ) {
+               if( ( *(pn++) = dnew ) != VAL__BADD ) {
                   nsum += *pdat;
                   nsum2 += (*pdat)*(*pdat);
                   nn++;
@@ -300,21 +304,11 @@ static void smfFlagSpikesPar( void *job_data_ptr, int *status ) {
    i.e. the first element). */
          inoise = 0;
 
-/* Initialise the index at which to store the next bolometer data value in the
-   "w2" array. The first new value added to the box will over-write element
-   zero - the oldest value in the box. */
+/* Initialise the slot at which to store the next bolometer data value in
+   the filter box. The first new value added to the box will over-write
+   slot zero - the oldest value in the box. */
          iold = 0;
 
-/* Note the number of good values stored in the filter box. */
-         inbox = (int)( pw1 - w1 );
-
-/* If there are any bad data values, pad out the w1 array with bad
-   values. */
-         for( ibox = inbox; ibox < box; ibox++ ) w1[ ibox ] = VAL__BADD;
-
-/* If any good values are stored in the filter box, we now sort them. */
-         if( inbox > 0 ) gsl_sort( w1, 1, inbox );
-
 /* Get pointers to the data value and quality value at the centre of the
    first filter box. */
          pdat = pdat0 + (box/2)*tstride;
@@ -331,20 +325,11 @@ static void smfFlagSpikesPar( void *job_data_ptr, int *status ) {
 /*  Assume this time slice is not a spike. */
             spike = 0;
 
-/* If the current sorted filter box contains an odd number of good values,
+/* If the current filter box contains an odd number of good values,
    use the central good value as the median value. If the box contains an
    even number of good values, use the mean of the two central values as
    the median value. If the box is empty use VAL__BADD. */
-            if( inbox == 0 ) {
-               median = VAL__BADD;
-
-            } else if( inbox % 2 == 1 ) {
-               median = w1[ inbox/2 ];
-
-            } else {
-               ibox = inbox/2;
-               median = 0.5*( w1[ ibox ] + w1[ ibox - 1 ] );
-            }
+            median = smf_runfilt_value( &rf, 1, status );
 
 /* If we have all the values we need, we can check for a spike. */
             if( !( *pqua & mask ) && *pdat != VAL__BADD &&
@@ -385,100 +370,12 @@ static void smfFlagSpikesPar( void *job_data_ptr, int *status ) {
                dnew = pdat[ newstride ];
                if( pqua[ newstride ] & mask ) dnew = VAL__BADD;
 
-/* Get the data value for the time slice that is about to leave the filter
-   box. */
-               dold = w2[ iold ];
-
-/* Store the new value in "w2" in place of the old value, and then
-   increment the index of the next "w2" value to be removed, wrapping back
-   to the start when the end of the array is reached. */
-               w2[ iold++ ] = dnew;
-               if( iold == box ) iold = 0;
-
-/* If the new value to be added into the box is good... */
-               if( dnew != VAL__BADD ) {
-
-/* Find the index (iadd) within the w1 box at which to store the new
-   value so as to maintain the ordering of the values in the box. Could do
-   a binary chop here, but the box size is presumably going to be very
-   small and so it's probably not worth it. At the same time, look for
-   the value that is leaving the box (if it is not bad). */
-                  iremove = -1;
-                  iadd = -1;
-
-                  if( dold != VAL__BADD ) {
-                     for( ibox = 0; ibox < inbox; ibox++ ) {
-                        if( iremove == -1 && w1[ ibox ] == dold ) {
-                           iremove = ibox;
-                           if( iadd != -1 ) break;
-                        }
-                        if( iadd == -1 && w1[ ibox ] >= dnew ) {
-                           iadd = ibox;
-                           if( iremove != -1 ) break;
-                        }
-                     }
-
-                  } else {
-                     for( iadd = 0; iadd < (int) inbox; iadd++ ) {
-                        if( w1[ iadd ] >= dnew ) break;
-                     }
-                  }
-
-/* If the new value is larger than any value currently in w1, we add it
-   to the end. */
-                  if( iadd == -1 ) iadd = inbox;
-
-/* If the value being removed is bad, shuffle all the good values greater
-   than the new value up one element, and increment the number of good
-   values for this bolometer box. */
-                  if( iremove == -1 ) {
-                     for( ibox = inbox; (int) ibox > iadd; ibox-- ) {
-                        w1[ ibox ] = w1[ ibox - 1 ];
-                     }
-                     inbox++;
-
-/* If the value being removed is good and the value being added is greater
-   than the value being removed, shuffle all the intermediate values down
-   one element within the box. */
-                  } else if( (int) iadd > iremove ) {
-                     for( ibox = iremove; (int) ibox < iadd - 1; ibox++ ) {
-                        w1[ ibox ] = w1[ ibox + 1 ];
-                     }
-                     iadd--;
-
-/* If the value being removed is good and the value being added is less
-   than or equal to the value being removed, shuffle all the intermediate
-   values up one element within the box. */
-                  } else {
-                     for( ibox = iremove; (int) ibox > iadd; ibox-- ) {
-                        w1[ ibox ] = w1[ ibox - 1 ];
-                     }
-                  }
-
-/* Store the new value in the box. */
-                  w1[ iadd ] = dnew;
-
-/* If the value being added is bad but the value being removed is good... */
-               } else if( dold != VAL__BADD ){
-
-/* Find the index (iremove) within the w1 box at which is stored the value
-   that is leaving the box. */
-                  iremove = -1;
-                  for( iremove = 0; iremove < (int) inbox; iremove++ ) {
-                     if( w1[ iremove ] == dold ) break;
-                  }
-
-/* Move all the larger values down one element in "w1" to fill the gap
-   left by the removal. */
-                  for( iremove++; iremove < (int) inbox; iremove++ ) {
-                     w1[ iremove - 1 ] = w1[ iremove ];
-                  }
-
-/* Over-write the un-used last element with a bad value, and decrement
-   the number of values in "w1". */
-                  w1[ iremove - 1 ] = VAL__BADD;
-                  inbox--;
-               }
+/* Remove the oldest value from the filter box and store the new value
+   in its place. Then increment the slot holding the oldest value,
+   wrapping back to the start when the end of the box is reached. */
+               smf_runfilt_remove( &rf, iold, status );
+               smf_runfilt_add( &rf, iold, dnew, status );
+               if( ++iold == box ) iold = 0;
 
 /* Get the new value (the central value in the filter box) to add to the
    noise box. If the central value was found to be a spike, do not
@@ -551,6 +448,7 @@ static void smfFlagSpikesPar( void *job_data_ptr, int *status ) {
 /* Free resources. */
    w1 = astFree( w1 );
    w2 = astFree( w2 );
+   w3 = astFree( w3 );
    noisebox = astFree( noisebox );
 
 /* Store number of flagged samples */
@@ -180,7 +180,7 @@ smf_flat_calcflat( ThrWorkForce *wf, msglev_t msglev, const char flatname[],
     /* precondition the data prior to fitting */
     smf_flat_precondition(0, powref, bolref, status );
 
-    smf_flat_fitpoly ( powref, bolref, snrmin, order, &coeffs,
+    smf_flat_fitpoly ( wf, powref, bolref, snrmin, order, &coeffs,
                        &flatpoly, status );
 
     /* now coeffs is in fact the new bolval */
@@ -231,7 +231,7 @@ smf_flat_calcflat( ThrWorkForce *wf, msglev_t msglev, const char flatname[],
 
   /* Calculate the responsivity in Amps/Watt (using the supplied
      signal-to-noise ratio minimum */
-  ngood = smf_flat_responsivity( flatmeth, respmap, snrmin, 1, powref, bolref, refohms,
+  ngood = smf_flat_responsivity( wf, flatmeth, respmap, snrmin, 1, powref, bolref, refohms,
                                  (flatmeth == SMF__FLATMETH_TABLE ? &flatpoly : NULL), status );
 
   /* Report the number of good responsivities and allow the caller
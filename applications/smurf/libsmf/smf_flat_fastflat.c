@@ -13,10 +13,12 @@
 *     SMURF subroutine
 
 *  Invocation:
-*     void smf_flat_fastflat( const smfData * fflat,
+*     void smf_flat_fastflat( ThrWorkForce *wf, const smfData * fflat,
 *                smfData **bolvald, int *status );
 
 *  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        Pointer to a pool of worker threads (can be NULL)
 *     fflat = const smfData * (Given)
 *        smfData containing flatfield ramp data.
 *     bolvald = smfData ** (Returned)
@@ -65,9 +67,14 @@
 *        Set status to BADFLAT if we encounter bad values in SC2_HEAT.
 *     2010-12-27 (TIMJ):
 *        Fix off-by-one error when counting backwards.
+*     2026-10-14:
+*        Add "wf" argument and process the bolometers in parallel. The
+*        heater indices are now read from the KeyMap before the bolometer
+*        loop.
 
 *  Copyright:
 *     Copyright (C) 2010 Science and Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -113,12 +120,41 @@
 #include "smf_typ.h"
 #include "smf_err.h"
 
+/* Local data types */
+typedef struct smfFastflatData {
+  size_t b1;                  /* Index of first bolometer to process */
+  size_t b2;                  /* Index of last bolometer to process */
+  const double *after_heat;   /* Heater values at end of ramp, or NULL */
+  const double *before_heat;  /* Heater values at start of ramp, or NULL */
+  double *bolval;             /* Returned mean for each heater setting */
+  double *bolvalvar;          /* Returned variance for each heater setting */
+  size_t bstride;             /* Bolometer stride */
+  size_t extras;              /* Extra points used to anchor sky fit */
+  const int *ffdata;          /* Flatfield ramp data */
+  const int *heatbounds;      /* First and last two heater values */
+  const int *heatind;         /* Time indices for each heater setting */
+  int heatref;                /* Reference heater setting */
+  const int *indices;         /* Time indices for reference heater */
+  size_t maxfound;            /* Max number of indices per heater setting */
+  size_t meas_per_heat;       /* Measurements per heater value per ramp */
+  dim_t nbols;                /* Number of bolometers */
+  dim_t nframes;              /* Number of time slices */
+  size_t nheat;               /* Number of distinct heater settings */
+  const int *nheatind;        /* Number of indices for each heater setting */
+  int nind;                   /* Number of indices for reference heater */
+  size_t skyorder;            /* Order to use for sky correction */
+  size_t szfit;               /* Number of points for extrapolation */
+  size_t tstride;             /* Time stride */
+} smfFastflatData;
+
+static void smf1_flat_fastflat( void *job_data_ptr, int *status );
 static int smf__sort_ints ( const void * a, const void * b );
-static double smf__calc_refheat_meas ( int indata[], size_t boloffset, size_t tstride, size_t nframes,
-                                       double heatdata[], double buffer[], size_t nmeas, int heatref,
+static double smf__calc_refheat_meas ( const int indata[], size_t boloffset, size_t tstride, size_t nframes,
+                                       const double heatdata[], double buffer[], size_t nmeas, int heatref,
                                        int forward, int *status );
 
-void smf_flat_fastflat( const smfData * fflat, smfData **bolvald, int *status ) {
+void smf_flat_fastflat( ThrWorkForce *wf, const smfData * fflat,
+                        smfData **bolvald, int *status ) {
 
   size_t bstride = 0;         /* Bolometer stride */
   smfHead * hdr = NULL;       /* Local header of fflat */
@@ -266,50 +302,35 @@ void smf_flat_fastflat( const smfData * fflat, smfData **bolvald, int *status )
   smf_flat_malloc( nheat, fflat, NULL, bolvald, status );
 
   if (*status == SAI__OK) {
-    double * bolval = (*bolvald)->pntr[0];
-    double * bolvalvar = (*bolvald)->pntr[1];
-    double *coeff = NULL;
-    double *coeffvar = NULL;
+    double * after_heat = NULL;
+    double * before_heat = NULL;
+    size_t extras = 0;    /* extra space required */
+    int * heatind = NULL;
     int * indices = NULL;
-    int * idata = NULL;
-    int * ffdata = (fflat->pntr)[0];
     JCMTState * instate = hdr->allState;
-    JCMTState * outstate = NULL;
-    double * skycoeffs = NULL;
-    double * skycoeffsvar = NULL;
+    int iw;
+    smfFastflatData *job_data = NULL;
     int nind = 0;
-    size_t bol;
+    int * nheatind = NULL;
+    int nw;
+    JCMTState * outstate = NULL;
+    smfFastflatData *pdata;
+    const size_t szfit = 30; /* number of points to use for ref heat extrapolation */
 
-    /* get some memory for the indices */
+    /* get some memory for the indices of the reference heater */
     indices = astCalloc( maxfound, sizeof(*indices) );
 
-    /* and equivalent memory for the readings at each index */
-    idata = astCalloc( maxfound, smf_dtype_sz( fflat->dtype, status ) );
+    /* and for the indices of every heater setting. The KeyMap can not
+       be used from the worker threads so get them all now. */
+    heatind = astCalloc( nheat * maxfound, sizeof(*heatind) );
+    nheatind = astCalloc( nheat, sizeof(*nheatind) );
 
     /* Need some memory for the JCMTSTATE information. */
     outstate = astMalloc( nheat*sizeof(*outstate) );
     (*bolvald)->hdr->allState = outstate;
 
-    /* First need to compensate for any drift in the DC sky level.
-       We do this by looking at the heater measurements for the reference
-       heater as a function of time (index) for each bolometer and then
-       fitting it with a polynomial. */
-    skycoeffs = astCalloc( nbols * (skyorder+1), sizeof(*skycoeffs) );
-    skycoeffsvar = astCalloc( nbols * (skyorder+1), sizeof(*skycoeffs) );
-
-    /* temp memory to hold the coefficients for a single bolometer */
-    coeff = astCalloc( skyorder + 1, sizeof(*coeff) );
-    coeffvar = astCalloc( skyorder + 1, sizeof(*coeffvar) );
-
     /* check status after memory allocation */
     if (*status == SAI__OK) {
-      double * ddata = NULL;
-      double * dindices = NULL;
-      size_t extras = 0;    /* extra space required */
-      const size_t szfit = 30; /* number of points to use for ref heat extrapolation */
-      double * before_heat = NULL;
-      double * after_heat = NULL;
-      double * heatmeas = NULL;
 
       /* get the key based on the reference heater integer */
       sprintf( heatstr, "%d", heatref );
@@ -343,219 +364,70 @@ void smf_flat_fastflat( const smfData * fflat, smfData **bolvald, int *status )
         }
       }
 
-      /* and _DOUBLE versions because smf_fit_poly1d takes doubles */
-      ddata = astCalloc( maxfound + extras, sizeof(*ddata) );
-      dindices = astCalloc( maxfound + extras, sizeof(*dindices) );
-
-      if (before_heat || after_heat) heatmeas = astCalloc( szfit, sizeof(*heatmeas) );
-
-      if (*status == SAI__OK) {
-        for (bol = 0; bol < nbols; bol++) {
-          size_t idx;
-          int64_t nused;
-          size_t ndata = nind;
-
-          /* copy over the relevant data for this bolometer */
-          for (idx = 0; idx < ndata; idx++) {
-            size_t slice = indices[idx];
-            ddata[idx] = ffdata[ bol * bstride + slice*tstride ];
-            dindices[idx] = slice;
-          }
-
-          /* Calculate any extrema for anchoring the fit */
-          if (before_heat) {
-            int nstepsoffset;
-            int stepsize;
-            int deltaheat;
-            double result = smf__calc_refheat_meas( ffdata, bol*bstride,
-                                                    tstride, nframes, before_heat, heatmeas,
-                                                    szfit, heatref, 1, status );
-            /* push the result onto the array for fitting. Making sure we give it
-               equal weight by duplicating it. The coordinate must refer to the start
-               of the time stream in indices and so be negative. */
-            stepsize = heatbounds[1] - heatbounds[0];
-            deltaheat = heatref - before_heat[0];
-            nstepsoffset = (abs(deltaheat / stepsize) -1 ) * (int)meas_per_heat;
-            for (i = 0; i < meas_per_heat; i++) {
-              ddata[ndata] = result;
-              dindices[ndata] = -1.0 - nstepsoffset - i;
-              ndata++;
-            }
-          }
-
-          if (after_heat) {
-            int nstepsoffset;
-            int stepsize;
-            int deltaheat;
-            double result = smf__calc_refheat_meas( ffdata, bol*bstride,
-                                                    tstride, nframes, after_heat, heatmeas,
-                                                    szfit, heatref, 0, status );
-            /* push the result onto the array for fitting.
-               Need to convert the heater ref value to an indices for fitting.
-             */
-            stepsize = heatbounds[1] - heatbounds[0];
-            deltaheat = heatref - after_heat[0];
-            nstepsoffset = (abs(deltaheat / stepsize) -1 ) * (int)meas_per_heat;
-            for (i = 0; i < meas_per_heat; i++) {
-              ddata[ndata] = result;
-              dindices[ndata] = nframes - 1.0 + nstepsoffset + i;
-              ndata++;
-            }
-          }
-
-          msgOutiff( MSG__DEBUG20, "",
-                     "Calculating sky background at reference heater for bolometer %zd",
-                     status, bol);
-          if (ndata > 1) {
-            smf_fit_poly1d( skyorder, ndata, 0, 0, dindices, ddata, NULL, NULL,
-                            coeff, coeffvar, NULL, &nused, status );
-
-          } else {
-            coeff[0] = ddata[0];
-            coeffvar[0] = 0.0;
-            for ( idx = 1; idx <= skyorder; idx++) {
-              coeff[idx] = 0.0;
-              coeffvar[idx] = 0.0;
-            }
-          }
-
-          /* copy coefficients into array */
-          for (idx = 0; idx <= skyorder; idx++) {
-            skycoeffs[ bol + idx*nbols ] = coeff[idx];
-            skycoeffsvar[ bol + idx*nbols ] = coeffvar[idx];
-          }
-        }
-      }
-
-      if (ddata) ddata = astFree( ddata );
-      if (dindices) dindices = astFree( dindices );
-      if (before_heat) before_heat = astFree( before_heat );
-      if (after_heat) after_heat = astFree( after_heat );
-      if (heatmeas) heatmeas = astFree( heatmeas );
-
-      /* for each heater value we now need to calculate the measured signal */
+      /* for each heater value get the relevant indices */
       for ( i = 0; i < nheat; i++) {
 
         /* get the key based on this heater integer */
         sprintf( heatstr, "%d", heatval[i] );
 
         /* and hence we can get all the relevant indices */
-        astMapGet1I( heatmap, heatstr, maxfound, &nind, indices );
+        astMapGet1I( heatmap, heatstr, maxfound, &(nheatind[i]),
+                     heatind + i*maxfound );
 
         /* Copy state from the first entry */
-        if (*status == SAI__OK) memcpy( &(outstate[i]), &(instate[indices[0]]), sizeof(*outstate));
-
-        /* now we need to loop over each bolometer to calculate the statistics. */
-        for ( bol = 0; bol < nbols; bol++) {
-          double mean = VAL__BADD;
-          double sigma = VAL__BADD;
-          size_t ngood = 0;
-          size_t idx;
-          double skyoffset = 0.0;
-
-          /* Get the polynomial data */
-          for (idx = 0; idx <= skyorder; idx++) {
-            coeff[idx] = skycoeffs[ bol + idx*nbols ];
-            coeffvar[idx] = skycoeffsvar[ bol + idx * nbols ];
-          }
-
-          /* Obtain the measurements for that bolometer */
-          for (idx = 0; idx < (size_t)nind; idx++ ) {
-            size_t slice = indices[idx];
-            int thisdata = ffdata[ bol*bstride + slice*tstride ];
-
-            if (thisdata != VAL__BADI) {
-              /* calculate the reference value */
-              double poly = 0.0;
-              EVALPOLY( poly, slice, skyorder, coeff );
-
-              /* This section can be uncommented to help debug any issues with sky removal.
-                 Just pick a bolometer number and grep for VALUES in the output. Then load
-                 into topcat */
-              /*
-              if (bol == 334) {
-                printf( "VALUES %zu %zu %d %d %g %g\n", slice, idx, heatval[i],idata[idx], poly, (double)idata[idx] - poly);
-              }
-              */
-
-              if (poly != VAL__BADD) thisdata -= (int)poly;
-
-              idata[ngood] = thisdata;
-              ngood++;
-            }
-          }
-
-          /* We need to get statistics but smf_stats1I won't give us values
-             if we do not have enough data points. We do an estimate by hand */
-
-          if ( ngood < SMF__MINSTATSAMP ) {
-
-            /* Calculate the mean but for sigma we put in the min/max difference
-               just to have an estimate that is large for down weighting */
-            double minval = VAL__BADD;
-            double maxval = VAL__BADD;
-            double isum = 0.0;
-
-            for (idx=0; idx < (size_t)ngood; idx++) {
-              if (idata[idx] != VAL__BADI) {
-                if (minval == VAL__BADD) {
-                  minval = idata[idx];
-                } else if (minval > idata[idx]) {
-                  minval = idata[idx];
-                }
-                if (maxval == VAL__BADD) {
-                  maxval = idata[idx];
-                } else if (maxval < idata[idx]) {
-                  maxval = idata[idx];
-                }
-                isum += idata[idx];
-              }
-            }
-            if (ngood > 1) {
-              mean = isum / (int)ngood;
-              sigma = (maxval - minval) / 2.0;
-            } else if (ngood == 1) {
-              /* Make up a number for sigma to stop the fit going crazy */
-              mean = isum;
-              sigma = 0.1 * isum;
-            } else {
-              mean = VAL__BADD;
-              sigma = VAL__BADD;
-            }
-
-          } else {
-            /* Calculate properly */
-            smf_stats1I( idata, 1, ngood, NULL, 0, 0, &mean, &sigma, NULL,
-                         &ngood, status );
-
-          }
-
-          /* Need to put the sky signal back into the data to ensure that the
-             sky offset is correctly accounted for. Use the value from the
-             polynomial from the last frame */
-          EVALPOLY(skyoffset, (nframes-1), skyorder, coeff );
-
-          /* store the answer */
-          idx = bol + i*nbols;
-          if (sigma == VAL__BADD || sigma == 0.0) {
-            bolval[ idx ] = VAL__BADD;
-            bolvalvar[ idx ] = VAL__BADD;
-          } else {
+        if (*status == SAI__OK) memcpy( &(outstate[i]),
+                                        &(instate[heatind[i*maxfound]]),
+                                        sizeof(*outstate));
+      }
+    }
 
-            bolval[ idx ] = mean + skyoffset;
-            bolvalvar[ idx ] = sigma * sigma;
-          }
+    /* The sky fit and the statistics for each bolometer are independent
+       of all other bolometers, so share the bolometers out between the
+       worker threads. */
+    nw = wf ? wf->nworker : 1;
+    job_data = astMalloc( nw*sizeof(*job_data) );
+    if (*status == SAI__OK) {
+      size_t step = nbols / nw;
+      if (step == 0) step = 1;
+
+      for (iw = 0; iw < nw; iw++) {
+        pdata = job_data + iw;
+        pdata->b1 = iw*step;
+        pdata->b2 = ( iw < nw - 1 ) ? pdata->b1 + step - 1 : nbols - 1;
+        pdata->after_heat = after_heat;
+        pdata->before_heat = before_heat;
+        pdata->bolval = (*bolvald)->pntr[0];
+        pdata->bolvalvar = (*bolvald)->pntr[1];
+        pdata->bstride = bstride;
+        pdata->extras = extras;
+        pdata->ffdata = (fflat->pntr)[0];
+        pdata->heatbounds = heatbounds;
+        pdata->heatind = heatind;
+        pdata->heatref = heatref;
+        pdata->indices = indices;
+        pdata->maxfound = maxfound;
+        pdata->meas_per_heat = meas_per_heat;
+        pdata->nbols = nbols;
+        pdata->nframes = nframes;
+        pdata->nheat = nheat;
+        pdata->nheatind = nheatind;
+        pdata->nind = nind;
+        pdata->skyorder = skyorder;
+        pdata->szfit = szfit;
+        pdata->tstride = tstride;
+        if (pdata->b1 < (size_t) nbols) {
+          thrAddJob( wf, 0, pdata, smf1_flat_fastflat, 0, NULL, status );
         }
-
       }
+      thrWait( wf, status );
     }
 
-    if (idata) idata = astFree( idata );
+    if (job_data) job_data = astFree( job_data );
+    if (before_heat) before_heat = astFree( before_heat );
+    if (after_heat) after_heat = astFree( after_heat );
+    if (heatind) heatind = astFree( heatind );
+    if (nheatind) nheatind = astFree( nheatind );
     if (indices) indices = astFree( indices );
-    if (coeff) coeff = astFree( coeff );
-    if (coeffvar) coeffvar = astFree( coeffvar );
-    if (skycoeffs) skycoeffs = astFree( skycoeffs );
-    if (skycoeffsvar) skycoeffsvar = astFree( skycoeffsvar );
 
   }
 
@@ -606,8 +478,8 @@ int smf__sort_ints ( const void * a, const void * b ) {
 
 /* Calculate the reference heater value by extrapolation */
 
-double smf__calc_refheat_meas ( int indata[], size_t boloffset, size_t tstride, size_t nframes,
-                                double heatdata[], double buffer[], size_t nmeas, int heatref,
+double smf__calc_refheat_meas ( const int indata[], size_t boloffset, size_t tstride, size_t nframes,
+                                const double heatdata[], double buffer[], size_t nmeas, int heatref,
                                 int forward, int *status ) {
   double result = VAL__BADD;
   int64_t nused;
@@ -634,3 +506,271 @@ double smf__calc_refheat_meas ( int indata[], size_t boloffset, size_t tstride,
     msgOutiff(MSG__DEBUG20, "", "Extrapolated heater value of %g\n",status, result);
   return result;
 }
+
+
+static void smf1_flat_fastflat( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_flat_fastflat
+
+*  Purpose:
+*     Executed in a worker thread to collapse the ramp for a range of
+*     bolometers.
+
+*  Invocation:
+*     smf1_flat_fastflat( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = smfFastflatData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*  Description:
+*     For each bolometer, a polynomial is first fitted to the readings
+*     at the reference heater setting to describe the drift in the sky
+*     level. The mean and standard deviation of the readings at each
+*     heater setting are then found after subtracting the sky drift.
+
+*/
+
+  smfFastflatData *pdata;
+  const double * after_heat;
+  const double * before_heat;
+  size_t bol;
+  double * bolval;
+  double * bolvalvar;
+  size_t bstride;
+  double *coeff = NULL;
+  double *coeffvar = NULL;
+  double * ddata = NULL;
+  double * dindices = NULL;
+  const int * ffdata;
+  const int * heatbounds;
+  double * heatmeas = NULL;
+  int heatref;
+  size_t i;
+  int * idata = NULL;
+  const int * indices;
+  size_t meas_per_heat;
+  dim_t nbols;
+  dim_t nframes;
+  size_t skyorder;
+  size_t szfit;
+  size_t tstride;
+
+  if (*status != SAI__OK) return;
+
+  pdata = (smfFastflatData *) job_data_ptr;
+  after_heat = pdata->after_heat;
+  before_heat = pdata->before_heat;
+  bolval = pdata->bolval;
+  bolvalvar = pdata->bolvalvar;
+  bstride = pdata->bstride;
+  ffdata = pdata->ffdata;
+  heatbounds = pdata->heatbounds;
+  heatref = pdata->heatref;
+  indices = pdata->indices;
+  meas_per_heat = pdata->meas_per_heat;
+  nbols = pdata->nbols;
+  nframes = pdata->nframes;
+  skyorder = pdata->skyorder;
+  szfit = pdata->szfit;
+  tstride = pdata->tstride;
+
+  /* temp memory to hold the coefficients for a single bolometer */
+  coeff = astCalloc( skyorder + 1, sizeof(*coeff) );
+  coeffvar = astCalloc( skyorder + 1, sizeof(*coeffvar) );
+
+  /* and _DOUBLE versions because smf_fit_poly1d takes doubles */
+  ddata = astCalloc( pdata->maxfound + pdata->extras, sizeof(*ddata) );
+  dindices = astCalloc( pdata->maxfound + pdata->extras, sizeof(*dindices) );
+
+  if (before_heat || after_heat) heatmeas = astCalloc( szfit, sizeof(*heatmeas) );
+
+  /* and equivalent memory for the readings at each index */
+  idata = astCalloc( pdata->maxfound, sizeof(*idata) );
+
+  for (bol = pdata->b1; bol <= pdata->b2 && *status == SAI__OK; bol++) {
+
+    /* First need to compensate for any drift in the DC sky level.
+       We do this by looking at the heater measurements for the reference
+       heater as a function of time (index) for this bolometer and then
+       fitting it with a polynomial. */
+    {
+      size_t idx;
+      int64_t nused;
+      size_t ndata = pdata->nind;
+
+      /* copy over the relevant data for this bolometer */
+      for (idx = 0; idx < ndata; idx++) {
+        size_t slice = indices[idx];
+        ddata[idx] = ffdata[ bol * bstride + slice*tstride ];
+        dindices[idx] = slice;
+      }
+
+      /* Calculate any extrema for anchoring the fit */
+      if (before_heat) {
+        int nstepsoffset;
+        int stepsize;
+        int deltaheat;
+        double result = smf__calc_refheat_meas( ffdata, bol*bstride,
+                                                tstride, nframes, before_heat, heatmeas,
+                                                szfit, heatref, 1, status );
+        /* push the result onto the array for fitting. Making sure we give it
+           equal weight by duplicating it. The coordinate must refer to the start
+           of the time stream in indices and so be negative. */
+        stepsize = heatbounds[1] - heatbounds[0];
+        deltaheat = heatref - before_heat[0];
+        nstepsoffset = (abs(deltaheat / stepsize) -1 ) * (int)meas_per_heat;
+        for (i = 0; i < meas_per_heat; i++) {
+          ddata[ndata] = result;
+          dindices[ndata] = -1.0 - nstepsoffset - i;
+          ndata++;
+        }
+      }
+
+      if (after_heat) {
+        int nstepsoffset;
+        int stepsize;
+        int deltaheat;
+        double result = smf__calc_refheat_meas( ffdata, bol*bstride,
+                                                tstride, nframes, after_heat, heatmeas,
+                                                szfit, heatref, 0, status );
+        /* push the result onto the array for fitting.
+           Need to convert the heater ref value to an indices for fitting.
+         */
+        stepsize = heatbounds[1] - heatbounds[0];
+        deltaheat = heatref - after_heat[0];
+        nstepsoffset = (abs(deltaheat / stepsize) -1 ) * (int)meas_per_heat;
+        for (i = 0; i < meas_per_heat; i++) {
+          ddata[ndata] = result;
+          dindices[ndata] = nframes - 1.0 + nstepsoffset + i;
+          ndata++;
+        }
+      }
+
+      msgOutiff( MSG__DEBUG20, "",
+                 "Calculating sky background at reference heater for bolometer %zd",
+                 status, bol);
+      if (ndata > 1) {
+        smf_fit_poly1d( skyorder, ndata, 0, 0, dindices, ddata, NULL, NULL,
+                        coeff, coeffvar, NULL, &nused, status );
+
+      } else {
+        coeff[0] = ddata[0];
+        coeffvar[0] = 0.0;
+        for ( idx = 1; idx <= skyorder; idx++) {
+          coeff[idx] = 0.0;
+          coeffvar[idx] = 0.0;
+        }
+      }
+    }
+
+    /* for each heater value we now need to calculate the measured signal */
+    for ( i = 0; i < pdata->nheat; i++) {
+      const int * heatind = pdata->heatind + i*pdata->maxfound;
+      int nind = pdata->nheatind[i];
+      double mean = VAL__BADD;
+      double sigma = VAL__BADD;
+      size_t ngood = 0;
+      size_t idx;
+      double skyoffset = 0.0;
+
+      /* Obtain the measurements for that bolometer */
+      for (idx = 0; idx < (size_t)nind; idx++ ) {
+        size_t slice = heatind[idx];
+        int thisdata = ffdata[ bol*bstride + slice*tstride ];
+
+        if (thisdata != VAL__BADI) {
+          /* calculate the reference value */
+          double poly = 0.0;
+          EVALPOLY( poly, slice, skyorder, coeff );
+
+          /* This section can be uncommented to help debug any issues with sky removal.
+             Just pick a bolometer number and grep for VALUES in the output. Then load
+             into topcat */
+          /*
+          if (bol == 334) {
+            printf( "VALUES %zu %zu %d %d %g %g\n", slice, idx, heatval[i],idata[idx], poly, (double)idata[idx] - poly);
+          }
+          */
+
+          if (poly != VAL__BADD) thisdata -= (int)poly;
+
+          idata[ngood] = thisdata;
+          ngood++;
+        }
+      }
+
+      /* We need to get statistics but smf_stats1I won't give us values
+         if we do not have enough data points. We do an estimate by hand */
+
+      if ( ngood < SMF__MINSTATSAMP ) {
+
+        /* Calculate the mean but for sigma we put in the min/max difference
+           just to have an estimate that is large for down weighting */
+        double minval = VAL__BADD;
+        double maxval = VAL__BADD;
+        double isum = 0.0;
+
+        for (idx=0; idx < (size_t)ngood; idx++) {
+          if (idata[idx] != VAL__BADI) {
+            if (minval == VAL__BADD) {
+              minval = idata[idx];
+            } else if (minval > idata[idx]) {
+              minval = idata[idx];
+            }
+            if (maxval == VAL__BADD) {
+              maxval = idata[idx];
+            } else if (maxval < idata[idx]) {
+              maxval = idata[idx];
+            }
+            isum += idata[idx];
+          }
+        }
+        if (ngood > 1) {
+          mean = isum / (int)ngood;
+          sigma = (maxval - minval) / 2.0;
+        } else if (ngood == 1) {
+          /* Make up a number for sigma to stop the fit going crazy */
+          mean = isum;
+          sigma = 0.1 * isum;
+        } else {
+          mean = VAL__BADD;
+          sigma = VAL__BADD;
+        }
+
+      } else {
+        /* Calculate properly */
+        smf_stats1I( idata, 1, ngood, NULL, 0, 0, &mean, &sigma, NULL,
+                     &ngood, status );
+
+      }
+
+      /* Need to put the sky signal back into the data to ensure that the
+         sky offset is correctly accounted for. Use the value from the
+         polynomial from the last frame */
+      EVALPOLY(skyoffset, (nframes-1), skyorder, coeff );
+
+      /* store the answer */
+      idx = bol + i*nbols;
+      if (sigma == VAL__BADD || sigma == 0.0) {
+        bolval[ idx ] = VAL__BADD;
+        bolvalvar[ idx ] = VAL__BADD;
+      } else {
+
+        bolval[ idx ] = mean + skyoffset;
+        bolvalvar[ idx ] = sigma * sigma;
+      }
+    }
+  }
+
+  if (coeff) coeff = astFree( coeff );
+  if (coeffvar) coeffvar = astFree( coeffvar );
+  if (ddata) ddata = astFree( ddata );
+  if (dindices) dindices = astFree( dindices );
+  if (heatmeas) heatmeas = astFree( heatmeas );
+  if (idata) idata = astFree( idata );
+}
@@ -13,11 +13,14 @@
 *     Subroutine
 
 *  Invocation:
-*     void smf_flat_fitpoly ( const smfData * powval, const smfData * bolval,
-*                             double snrmin, size_t order, smfData ** coeffs,
+*     void smf_flat_fitpoly ( ThrWorkForce *wf, const smfData * powval,
+*                             const smfData * bolval, double snrmin,
+*                             size_t order, smfData ** coeffs,
 *                             smfData ** polyfit, int *status );
 
 *  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        Pointer to a pool of worker threads (can be NULL)
 *     powval = const smfData * (Given)
 *        Resistance input powers. 1 dimensional.
 *     bolval = const smfData * (Given)
@@ -44,7 +47,8 @@
 *  Description:
 *     For each bolometer calculate the best fit polynomial of bolometer response
 *     versus input heater power in a form suitable for storing as a POLYNOMIAL
-*     flatfield solution.
+*     flatfield solution. The bolometers are fitted in parallel using
+*     the supplied worker threads.
 
 *  Authors:
 *     BDK: Dennis Kelly (UKATC)
@@ -71,11 +75,14 @@
 *     2013-08-16 (DSB):
 *        Use a nearby good value as the reference value if the central value
 *        is bad, rather than rejecting the whole bolometer.
+*     2026-10-14:
+*        Add "wf" argument and fit the bolometers in parallel.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2005 Particle Physics and Astronomy Research Council.
 *     Copyright (C) 2010,2013 Science and Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -112,36 +119,53 @@
 
 #include "gsl/gsl_fit.h"
 
-void smf_flat_fitpoly ( const smfData * powvald, const smfData * bolvald,
-                        double snrmin, size_t order, smfData **coeffs,
-                        smfData **polyfit, int *status ) {
+/* Max number of coefficients per bolometer */
+#define NCOEFF 6
+
+/* Local data types */
+typedef struct smfFlatFitpolyData {
+  size_t b1;                /* Index of first bolometer to fit */
+  size_t b2;                /* Index of last bolometer to fit */
+  const double *bolval;     /* Bolometer measurements */
+  const double *bolvar;     /* Variance of bolometer measurements */
+  double *coptr;            /* Returned coefficients */
+  double *corrs;            /* Returned correlation coefficients */
+  const double *ht;         /* Heater values corrected for reference */
+  size_t nbol;              /* Number of bolometers */
+  size_t nheat;             /* Number of measurements */
+  size_t nsnr;              /* Returned number flagged by SNR limit */
+  size_t order;             /* Order of fit */
+  double *polybol;          /* Returned polynomial expansion, or NULL */
+  double refheat;           /* Reference heater setting */
+  double snrmin;            /* Minimum acceptable SNR of gradient */
+} smfFlatFitpolyData;
+
+/* Prototypes for local static functions. */
+static void smf1_flat_fitpoly( void *job_data_ptr, int *status );
+
+void smf_flat_fitpoly ( ThrWorkForce *wf, const smfData * powvald,
+                        const smfData * bolvald, double snrmin, size_t order,
+                        smfData **coeffs, smfData **polyfit, int *status ) {
 
   size_t bol;               /* bolometer index */
   double * bolval = NULL;   /* Pointer to bolvald smfData */
   double * bolvar = NULL;   /* Pointer to bolvald variance */
-  const double CLIP = 3.0;  /* Sigma clipping for polynomial fit */
   double * coptr = NULL;    /* pointer to coefficients data array */
   double * corrs = NULL;    /* correlation coefficients for each bolometer */
   double corr_thresh = 0.0; /* threshold for correlation coefficient thresholding */
-  double * goodht = NULL;   /* Heater values for good measurements */
-  size_t * goodidx = NULL;  /* Indices of good measurements */
   double * ht = NULL;       /* Heater values corrected for reference */
-  size_t iref;              /* Index of reference measurement */
-  size_t ireflo;            /* Lowest allowed index for reference measurement */
+  int iw;                   /* Thread index */
   size_t j;
-  const size_t NCOEFF = 6;  /* Max number of coefficients per bolometer */
+  smfFlatFitpolyData *job_data = NULL; /* Array of job descriptions */
   size_t nbol = 0;          /* Number of bolometers */
   size_t ncorr = 0;         /* Number of bolometers flagged due to bad correlation coefficient */
   size_t nheat = 0;         /* Number of measurements */
   size_t nsnr = 0;          /* Number of bolometers flagged by SNR limit */
-  double *poly = NULL;      /* polynomial expansion of each fit */
+  int nw;                   /* Number of worker threads */
+  smfFlatFitpolyData *pdata;/* Pointer to next job description */
   double *polybol = NULL;   /* polynomial expansion for all bolometers */
   double * powval = NULL;   /* Pointer to powvald smfData */
   double refheat = 0.0;     /* Reference heater setting */
-  double * scan = NULL;     /* corrected bol values for a single bolometer */
-  double * scanvar = NULL;  /* Variance on corrected bol (if bolvar) */
-  double * scoeff = NULL;   /* Coefficients for a single scan */
-  double * scoeffvar = NULL;/* Error in Coefficients for a single scan */
 
   *coeffs = NULL;
 
@@ -193,13 +217,7 @@ void smf_flat_fitpoly ( const smfData * powvald, const smfData * bolvald,
   }
 
   /* Get some work space for the fits */
-  scan = astCalloc( nheat, sizeof(*scan) );
-  if (bolvar) scanvar = astCalloc( nheat, sizeof(*scanvar) );
   ht = astCalloc( nheat, sizeof(*ht) );
-  goodht = astCalloc( nheat, sizeof(*goodht) );
-  scoeff = astMalloc( (order + 1)*sizeof(*scoeff) );
-  scoeffvar = astMalloc( (order + 1)*sizeof(*scoeffvar) );
-  goodidx = astCalloc( nheat, sizeof(*goodidx) );
   corrs = astMalloc( nbol*sizeof(*corrs) );
 
   /* Assume that we have monotonically increasing heater settings and so
@@ -212,10 +230,195 @@ void smf_flat_fitpoly ( const smfData * powvald, const smfData * bolvald,
 
   /* space for the calculated polynomial */
   if (polyfit && order == 1) polybol = astMalloc( (nheat*nbol)*sizeof(*polybol) );
+
+  /* Now loop over each bolometer and extract the measurements. The
+     bolometers are independent, so share them out between the worker
+     threads. */
+  nw = wf ? wf->nworker : 1;
+  job_data = astMalloc( nw*sizeof(*job_data) );
+  if (*status == SAI__OK) {
+    size_t step = nbol / nw;
+    if (step == 0) step = 1;
+
+    for (iw = 0; iw < nw; iw++) {
+      pdata = job_data + iw;
+      pdata->b1 = iw*step;
+      pdata->b2 = ( iw < nw - 1 ) ? pdata->b1 + step - 1 : nbol - 1;
+      pdata->bolval = bolval;
+      pdata->bolvar = bolvar;
+      pdata->coptr = coptr;
+      pdata->corrs = corrs;
+      pdata->ht = ht;
+      pdata->nbol = nbol;
+      pdata->nheat = nheat;
+      pdata->nsnr = 0;
+      pdata->order = order;
+      pdata->polybol = polybol;
+      pdata->refheat = refheat;
+      pdata->snrmin = snrmin;
+      if (pdata->b1 < nbol) {
+        thrAddJob( wf, 0, pdata, smf1_flat_fitpoly, 0, NULL, status );
+      }
+    }
+    thrWait( wf, status );
+
+    for (iw = 0; iw < nw; iw++) {
+      if (job_data[iw].b1 < nbol) nsnr += job_data[iw].nsnr;
+    }
+  }
+  job_data = astFree( job_data );
+
+  /* Analyze correlation coefficients */
+  if (corrs && *status == SAI__OK) {
+    double csig = VAL__BADD;
+    double cmean = VAL__BADD;
+    size_t ngood = 0;
+    double corr_bigtol = 3.0;
+    double corr_smalltol = 0.75;
+    double delta_mean = 0.0;
+
+    smf_stats1D( corrs, 1, nbol, NULL, 0, 0, &cmean, &csig, NULL, &ngood,
+                 status );
+
+    if (*status == SMF__INSMP) {
+      /* it has all gone horribly wrong. Let someone else report the bad news */
+      errAnnul( status );
+    } else {
+      msgOutiff( MSG__DEBUG20, "", "Fit Correlation coefficients = %g +/- %g (%zd)\n",
+                 status, cmean, csig, ngood);
+
+      /* Now loop over the bolometers and throw out the ones on the lower end of the
+         scale. If the mean is within 0.5 sigma of 1.0 we use a "mean - 1 sigma" threshold,
+         else we use a "mean - 3 sigma" threshold. We do this because the case where the
+         distribution is jammed up against 1.0 is decidedly non-gaussian. */
+      delta_mean = ( 1.0 - cmean ) / csig;
+      if ( delta_mean < 0.5 ) {
+        corr_thresh = corr_smalltol;
+      } else {
+        corr_thresh = corr_bigtol;
+      }
+      corr_thresh = cmean - ( csig * corr_thresh );
+      for ( bol = 0; bol < nbol; bol++ ) {
+        if (corrs[bol] != VAL__BADD && corrs[bol] < corr_thresh ) {
+          size_t i;
+          ncorr++;
+          /* blank that bolometer */
+          for (i=0; i<NCOEFF;i++) {
+            coptr[i*nbol+bol] = VAL__BADD;
+          }
+        }
+      }
+    }
+  }
+
+
+  msgOutiff( MSG__VERB, "", "Flagged %zd bolometers with gradients failing SNR > %g",
+             status, nsnr, snrmin);
+  if (ncorr > 0) {
+    msgOutiff( MSG__VERB, "", "Flagged %zd bolometers with fit correlation coefficients < %g",
+               status, ncorr, corr_thresh );
+  }
+
+
+  if (polybol) {
+    if (polyfit) {
+      void *pntr[2];
+      pntr[0] = polybol;
+      pntr[1] = NULL;
+      *polyfit = smf_construct_smfData( NULL, NULL, NULL, NULL, NULL,
+                                        SMF__DOUBLE, pntr, NULL,
+                                        SMF__QFAM_TSERIES, NULL, 0, 1,
+                                        bolvald->dims, bolvald->lbnd, 3, 0, 0,
+                                        NULL, NULL, status );
+      if (*status != SAI__OK && ! *polyfit) polybol = astFree( polybol );
+    } else {
+      polybol = astFree( polybol );
+    }
+  }
+
+  if (ht) ht = astFree( ht );
+  if (corrs) corrs = astFree( corrs );
+
+  if (*status != SAI__OK) {
+    if (*coeffs) smf_close_file( NULL, coeffs, status );
+    if (*polyfit) smf_close_file( NULL, polyfit, status );
+  }
+
+}
+
+
+
+static void smf1_flat_fitpoly( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_flat_fitpoly
+
+*  Purpose:
+*     Executed in a worker thread to fit the polynomials for a range of
+*     bolometers.
+
+*  Invocation:
+*     smf1_flat_fitpoly( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = smfFlatFitpolyData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+  smfFlatFitpolyData *pdata;
+  size_t bol;               /* bolometer index */
+  const double * bolval;    /* Pointer to bolvald smfData */
+  const double * bolvar;    /* Pointer to bolvald variance */
+  const double CLIP = 3.0;  /* Sigma clipping for polynomial fit */
+  double * coptr;           /* pointer to coefficients data array */
+  double * corrs;           /* correlation coefficients for each bolometer */
+  double * goodht = NULL;   /* Heater values for good measurements */
+  size_t * goodidx = NULL;  /* Indices of good measurements */
+  const double * ht;        /* Heater values corrected for reference */
+  size_t iref;              /* Index of reference measurement */
+  size_t ireflo;            /* Lowest allowed index for reference measurement */
+  size_t nbol;              /* Number of bolometers */
+  size_t nheat;             /* Number of measurements */
+  size_t nsnr = 0;          /* Number of bolometers flagged by SNR limit */
+  size_t order;             /* Order of fit */
+  double *poly = NULL;      /* polynomial expansion of each fit */
+  double *polybol;          /* polynomial expansion for all bolometers */
+  double refheat;           /* Reference heater setting */
+  double * scan = NULL;     /* corrected bol values for a single bolometer */
+  double * scanvar = NULL;  /* Variance on corrected bol (if bolvar) */
+  double * scoeff = NULL;   /* Coefficients for a single scan */
+  double * scoeffvar = NULL;/* Error in Coefficients for a single scan */
+  double snrmin;            /* Minimum acceptable SNR of gradient */
+
+  if (*status != SAI__OK) return;
+
+  pdata = (smfFlatFitpolyData *) job_data_ptr;
+  bolval = pdata->bolval;
+  bolvar = pdata->bolvar;
+  coptr = pdata->coptr;
+  corrs = pdata->corrs;
+  ht = pdata->ht;
+  nbol = pdata->nbol;
+  nheat = pdata->nheat;
+  order = pdata->order;
+  polybol = pdata->polybol;
+  refheat = pdata->refheat;
+  snrmin = pdata->snrmin;
+
+  /* Get some work space for the fits */
+  scan = astCalloc( nheat, sizeof(*scan) );
+  if (bolvar) scanvar = astCalloc( nheat, sizeof(*scanvar) );
+  goodht = astCalloc( nheat, sizeof(*goodht) );
+  scoeff = astMalloc( (order + 1)*sizeof(*scoeff) );
+  scoeffvar = astMalloc( (order + 1)*sizeof(*scoeffvar) );
+  goodidx = astCalloc( nheat, sizeof(*goodidx) );
   poly = astMalloc( nheat*sizeof(*poly) );
 
-  /* Now loop over each bolometer and extract the measurements */
-  for (bol=0; bol<nbol; bol++) {
+  for (bol=pdata->b1; bol<=pdata->b2 && *status == SAI__OK; bol++) {
 
     /* Find a reference value. Use the central value if good, otherwise
        use the previous good value so long as it is not too far away from
@@ -398,87 +601,13 @@ void smf_flat_fitpoly ( const smfData * powvald, const smfData * bolvald,
 
   }
 
-  /* Analyze correlation coefficients */
-  if (corrs && *status == SAI__OK) {
-    double csig = VAL__BADD;
-    double cmean = VAL__BADD;
-    size_t ngood = 0;
-    double corr_bigtol = 3.0;
-    double corr_smalltol = 0.75;
-    double delta_mean = 0.0;
-
-    smf_stats1D( corrs, 1, nbol, NULL, 0, 0, &cmean, &csig, NULL, &ngood,
-                 status );
-
-    if (*status == SMF__INSMP) {
-      /* it has all gone horribly wrong. Let someone else report the bad news */
-      errAnnul( status );
-    } else {
-      msgOutiff( MSG__DEBUG20, "", "Fit Correlation coefficients = %g +/- %g (%zd)\n",
-                 status, cmean, csig, ngood);
-
-      /* Now loop over the bolometers and throw out the ones on the lower end of the
-         scale. If the mean is within 0.5 sigma of 1.0 we use a "mean - 1 sigma" threshold,
-         else we use a "mean - 3 sigma" threshold. We do this because the case where the
-         distribution is jammed up against 1.0 is decidedly non-gaussian. */
-      delta_mean = ( 1.0 - cmean ) / csig;
-      if ( delta_mean < 0.5 ) {
-        corr_thresh = corr_smalltol;
-      } else {
-        corr_thresh = corr_bigtol;
-      }
-      corr_thresh = cmean - ( csig * corr_thresh );
-      for ( bol = 0; bol < nbol; bol++ ) {
-        if (corrs[bol] != VAL__BADD && corrs[bol] < corr_thresh ) {
-          size_t i;
-          ncorr++;
-          /* blank that bolometer */
-          for (i=0; i<NCOEFF;i++) {
-            coptr[i*nbol+bol] = VAL__BADD;
-          }
-        }
-      }
-    }
-  }
-
-
-  msgOutiff( MSG__VERB, "", "Flagged %zd bolometers with gradients failing SNR > %g",
-             status, nsnr, snrmin);
-  if (ncorr > 0) {
-    msgOutiff( MSG__VERB, "", "Flagged %zd bolometers with fit correlation coefficients < %g",
-               status, ncorr, corr_thresh );
-  }
-
-
-  if (polybol) {
-    if (polyfit) {
-      void *pntr[2];
-      pntr[0] = polybol;
-      pntr[1] = NULL;
-      *polyfit = smf_construct_smfData( NULL, NULL, NULL, NULL, NULL,
-                                        SMF__DOUBLE, pntr, NULL,
-                                        SMF__QFAM_TSERIES, NULL, 0, 1,
-                                        bolvald->dims, bolvald->lbnd, 3, 0, 0,
-                                        NULL, NULL, status );
-      if (*status != SAI__OK && ! *polyfit) polybol = astFree( polybol );
-    } else {
-      polybol = astFree( polybol );
-    }
-  }
+  pdata->nsnr = nsnr;
 
   if (poly) poly = astFree( poly );
   if (scan) scan = astFree( scan );
   if (scanvar) scanvar = astFree( scanvar );
   if (scoeff) scoeff = astFree( scoeff );
-  if (scoeffvar) scoeff = astFree( scoeffvar );
-  if (ht) ht = astFree( ht );
+  if (scoeffvar) scoeffvar = astFree( scoeffvar );
   if (goodht) goodht = astFree( goodht );
   if (goodidx) goodidx = astFree( goodidx );
-  if (corrs) corrs = astFree( corrs );
-
-  if (*status != SAI__OK) {
-    if (*coeffs) smf_close_file( NULL, coeffs, status );
-    if (*polyfit) smf_close_file( NULL, polyfit, status );
-  }
-
 }
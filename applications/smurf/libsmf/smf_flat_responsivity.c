@@ -13,11 +13,15 @@
 *     Subroutine
 
 *  Invocation:
-*     size_t smf_flat_responsivity ( smf_flatmeth method, smfData *respmap, double snrmin,
+*     size_t smf_flat_responsivity ( ThrWorkForce *wf, smf_flatmeth method,
+*                                    smfData *respmap, double snrmin,
 *                                    size_t order, const smfData * powval, const smfData * bolval,
 *                                    double refres, smfData ** polyfit, int *status );
 
 *  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        Pointer to a pool of worker threads (can be NULL). Used when
+*        fitting TABLE data.
 *     method = smf_flatmeth (Given)
 *        Type of flatfield being presented in bolval and powval. Can
 *        be SMF__FLATMETH_POLYNOMIAL or SMF__FLATMETH_TABLE.
@@ -115,11 +119,15 @@
 *        calculation in the same place.
 *     2011-09-07 (TIMJ):
 *        Now reads heater efficiency data directly when calculating responsivity.
+*     2026-10-14:
+*        Add "wf" argument for the threaded polynomial fit, and evaluate
+*        the gradient without calling pow().
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2007-2011 Science and Technology Facilities Council.
 *     Copyright (C) 2011 University of British Columbia
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -151,8 +159,8 @@
 #include "prm_par.h"
 #include "sae_par.h"
 
-size_t smf_flat_responsivity ( smf_flatmeth method, smfData *respmap, double snrmin,
-                               size_t order, const smfData * powvald, const smfData * bolvald,
+size_t smf_flat_responsivity ( ThrWorkForce *wf, smf_flatmeth method,
+                               smfData *respmap, double snrmin, size_t order, const smfData * powvald, const smfData * bolvald,
                                double refres, smfData ** polyfit, int *status ) {
 
   size_t bol;                  /* Bolometer offset into array */
@@ -197,7 +205,7 @@ size_t smf_flat_responsivity ( smf_flatmeth method, smfData *respmap, double snr
     /* Generate a polynomial fit of the TABLE data. Note that this
        routine fits current as a function of heater so for order>1
        the polynomial is not inverted. */
-    smf_flat_fitpoly( powvald, bolvald, snrmin, order, &tabbolval,
+    smf_flat_fitpoly( wf, powvald, bolvald, snrmin, order, &tabbolval,
                       polyfit, status );
 
     bolval = (tabbolval->pntr)[0];
@@ -229,14 +237,17 @@ size_t smf_flat_responsivity ( smf_flatmeth method, smfData *respmap, double snr
     if ( bolval[1*nbol+bol] != VAL__BADD ) {
       double refbol  = bolval[1*nbol+bol];
       double resp = 0.0;
+      double xpow = 1.0;
 
       /* need the gradient at x=refbol */
       for (k=1; k<ncoeffs-coffset; k++) {
         /* standard differential of a polynomial:
            grad = c[1] x^0 + 2 c[2] x^1 + 3 c[3] x^3
+           xpow holds x^(k-1), built up a factor at a time.
         */
-        double xterm = k * pow( refbol, k-1 );
+        double xterm = k * xpow;
         resp += bolval[(k+coffset)*nbol+bol] * xterm;
+        xpow *= refbol;
       }
 
       /* Correct by the heater efficiency */
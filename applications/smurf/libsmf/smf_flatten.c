@@ -25,6 +25,8 @@
 
 *  Description:
 *     This subroutine calls the low-level sc2math_flatten subroutine.
+*     Polynomial flatfields are applied directly instead, in the same
+*     pass through the data that sets the SMF__Q_BADDA quality flags.
 
 *  Authors:
 *     Andy Gibb (UBC)
@@ -50,6 +52,12 @@
 *        Apply heater efficiency data after flatfielding.
 *     2012-04-03 (TIMJ):
 *        Report cases where all bolometers are disabled by flatfielding.
+*     14-OCT-2026:
+*        Apply polynomial flatfields and set SMF__Q_BADDA flags in a
+*        single pass through the data, with contiguous access to the
+*        coefficients for each time slice. The separate pass to set
+*        quality flags is now only needed for table flatfields, or if
+*        heater efficiency data has been applied.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -100,6 +108,10 @@
 /* SC2DA includes */
 #include "sc2da/sc2math.h"
 
+/* Prototypes for local static functions. */
+static int smf1_flatten_poly( int nboll, int nframes, const double *fcal,
+                              double *dat, smf_qual_t *qual );
+
 void smf_flatten ( smfData *data, AstKeyMap * heateffmap, int *status ) {
 
   smfDA *da = NULL;            /* Pointer to struct containing flatfield info */
@@ -109,6 +121,7 @@ void smf_flatten ( smfData *data, AstKeyMap * heateffmap, int *status ) {
   int nboll;                   /* Number of bolometers */
   int nframes;                 /* Number of frames (timeslices) */
   int ngood;                   /* Number of good bolometers in flatfield */
+  int qualdone = 0;            /* Have SMF__Q_BADDA flags been set? */
   void *pntr[3];               /* Array of pointers for DATA, QUALITY & VARIANCE */
   smf_qual_t *qual;         /* Pointer to quality array */
 
@@ -141,9 +154,16 @@ void smf_flatten ( smfData *data, AstKeyMap * heateffmap, int *status ) {
   nboll = (data->dims)[0]*(data->dims)[1];
   nframes = (data->dims)[2];
 
-  /* Flatfielder */
-  ngood = sc2math_flatten( nboll, nframes, smf_flat_methstring(da->flatmeth,status), da->nflat, da->flatcal,
-                           da->flatpar, dataArr, status);
+  /* Flatfielder. Polynomial flatfields are applied here so that the
+     quality flags can be set at the same time. */
+  qual = data->qual;
+  if ( da->flatmeth == SMF__FLATMETH_POLY ) {
+    ngood = smf1_flatten_poly( nboll, nframes, da->flatcal, dataArr, qual );
+    qualdone = 1;
+  } else {
+    ngood = sc2math_flatten( nboll, nframes, smf_flat_methstring(da->flatmeth,status), da->nflat, da->flatcal,
+                             da->flatpar, dataArr, status);
+  }
 
   if (ngood == 0) {
     msgOutif( MSG__QUIET, "",
@@ -174,6 +194,7 @@ void smf_flatten ( smfData *data, AstKeyMap * heateffmap, int *status ) {
         if (tmp) {
           smfData * heateff = tmp;
           smf_scale_bols( NULL, data, heateff, NULL, "HEATEFF", 0, status );
+          qualdone = 0;
           msgOutiff(MSG__VERB, "", "Applying heater efficiency data for array '%s'",
                     status, arrayidstr);
         } else {
@@ -193,9 +214,12 @@ void smf_flatten ( smfData *data, AstKeyMap * heateffmap, int *status ) {
     }
   }
 
-  /* Now check for a QUALITY array */
-  qual = data->qual;
-  if ( qual != NULL ) {
+  /* Now check for a QUALITY array (unless the flags have already been
+     set) */
+  if ( qualdone ) {
+    msgOutif(MSG__DEBUG, "", "SMF__Q_BADDA flags set during flatfielding",
+             status);
+  } else if ( qual != NULL ) {
     /* Check for BAD values from flatfield routine and set QUALITY
        accordingly. Any bad values at this point means that those
        samples were flagged as such by the DA system and thus should
@@ -215,3 +239,47 @@ void smf_flatten ( smfData *data, AstKeyMap * heateffmap, int *status ) {
 
 }
 
+/* Apply a polynomial flatfield (see sc2math_flatten) to the data for all
+   bolometers, and set SMF__Q_BADDA for any samples that are bad on exit
+   (if a quality array is supplied). The arithmetic is exactly as in
+   sc2math_flatten. Returns the number of bolometers with a good
+   flatfield. */
+static int smf1_flatten_poly( int nboll, int nframes, const double *fcal,
+                              double *dat, smf_qual_t *qual ) {
+  const double *c0 = fcal;     /* Coefficients for all bolometers */
+  const double *c1 = fcal + nboll;
+  const double *c2 = fcal + 2*nboll;
+  const double *c3 = fcal + 3*nboll;
+  const double *c4 = fcal + 4*nboll;
+  const double *c5 = fcal + 5*nboll;
+  double *pd;                  /* Data for current time slice */
+  double t;                    /* Intermediate result */
+  int i;                       /* Bolometer index */
+  int j;                       /* Time slice index */
+  int ngood = 0;               /* Number of good bolometers */
+  smf_qual_t *pq;              /* Quality for current time slice */
+
+  for ( i=0; i<nboll; i++ ) {
+    if (c0[i] != VAL__BADD) ngood++;
+  }
+
+  for ( j=0; j<nframes; j++ ) {
+    pd = dat + (size_t)j*nboll;
+    pq = qual ? qual + (size_t)j*nboll : NULL;
+
+    for ( i=0; i<nboll; i++ ) {
+      if (pd[i] != VAL__BADD) {
+        if (c0[i] == VAL__BADD) {
+          pd[i] = VAL__BADD;
+        } else {
+          t = pd[i] - c1[i];
+          pd[i] = c0[i] + c2[i] + c3[i] * t + c4[i] * t * t
+            + c5[i] * t * t * t;
+        }
+      }
+      if ( pq && pd[i] == VAL__BADD ) pq[i] |= SMF__Q_BADDA;
+    }
+  }
+
+  return ngood;
+}
@@ -0,0 +1,240 @@
+/*
+*+
+*  Name:
+*     smf_footprint_name
+
+*  Purpose:
+*     Get the name of the file in which the sky footprint of an input
+*     file is cached.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     int smf_footprint_name( const char *ndfname, AstSkyFrame *skyframe,
+*                             int usedetpos, Grp *detgrp, char *filename,
+*                             size_t szfname, int *status )
+
+*  Arguments:
+*     ndfname = const char * (Given)
+*        The name of the input NDF, as stored in the input group.
+*     skyframe = AstSkyFrame * (Given)
+*        The SkyFrame describing the absolute sky coordinates in which the
+*        footprint is stored.
+*     usedetpos = int (Given)
+*        Are detector positions to be taken from the RECEPPOS values
+*        (rather than the FPLANEX/Y values)?
+*     detgrp = Grp * (Given)
+*        The group of detector names to be included. May be NULL.
+*     filename = char * (Returned)
+*        The path of the cache file. Not changed if zero is returned.
+*     szfname = size_t (Given)
+*        The length of the "filename" buffer.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     Non-zero if a cache file name was returned, and zero if no
+*     footprint cache is in use or the input cannot be cached.
+
+*  Description:
+*     If the SMURF_FOOTPRINTCACHE environment variable is set to the name
+*     of a directory, the sky footprint of each ACSIS input file found by
+*     smf_cubebounds is stored in a file within that directory, so that
+*     later runs of MAKECUBE on the same data do not need to read the
+*     spectra and convert the position of every detector at every time
+*     slice. The directory may be shared by several users and processes.
+*
+*     The file name is formed from the name of the input file, followed
+*     by a 64-bit hash of everything that determines the footprint: the
+*     full name, size, modification time and inode of the input file,
+*     the sky coordinate system (including its epoch and equinox), the
+*     "usedetpos" flag and the names in "detgrp". An input file that is
+*     changed in any way therefore gets a new cache file.
+
+*  Notes:
+*     - Zero is returned for NDF sections and for names that do not
+*     correspond to a single file on disk.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+#include "star/grp.h"
+#include "star/one.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+#define FUNC_NAME "smf_footprint_name"
+
+/* Prototypes for local functions */
+static uint64_t smf1_hash( uint64_t hash, const void *pntr, size_t nbytes );
+static uint64_t smf1_hash_string( uint64_t hash, const char *text );
+
+int smf_footprint_name( const char *ndfname, AstSkyFrame *skyframe,
+                        int usedetpos, Grp *detgrp, char *filename,
+                        size_t szfname, int *status ){
+
+/* Local Variables: */
+   AstSkyFrame *sf;
+   char *dump;
+   char *p;
+   char *pname;
+   char base[ SMF_PATH_MAX + 1 ];
+   char detname[ GRP__SZNAM + 1 ];
+   char path[ SMF_PATH_MAX + 1 ];
+   const char *dir;
+   const char *pbase;
+   int result = 0;
+   long long int mtime;
+   long long int size;
+   size_t idet;
+   size_t ndet;
+   struct stat buf;
+   uint64_t hash;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return result;
+
+/* Check a cache directory has been specified. */
+   dir = getenv( SMF__FOOTPRINTCACHE );
+   if( !dir || !dir[ 0 ] || !ndfname ) return result;
+
+/* NDF sections (and foreign formats that use similar syntax) cannot be
+   identified by a single file. */
+   if( strchr( ndfname, '(' ) ) return result;
+
+/* Find the file holding the NDF, with or without the ".sdf" suffix. */
+   one_strlcpy( path, ndfname, sizeof( path ), status );
+   if( *status != SAI__OK ) {
+      errAnnul( status );
+      return result;
+   }
+   if( stat( path, &buf ) != 0 || !S_ISREG( buf.st_mode ) ) {
+      if( snprintf( path, sizeof( path ), "%s.sdf", ndfname ) >=
+          (int) sizeof( path ) || stat( path, &buf ) != 0 ||
+          !S_ISREG( buf.st_mode ) ) return result;
+   }
+
+/* Hash the file identity and the arguments. The string identifying the
+   cache file format is included so that files written in a different
+   format are never matched. */
+   size = buf.st_size;
+   mtime = buf.st_mtime;
+
+   hash = UINT64_C( 14695981039346656037 );
+   hash = smf1_hash_string( hash, SMF__FOOTPRINTCACHE_MAGIC );
+   hash = smf1_hash_string( hash, path );
+   hash = smf1_hash( hash, &size, sizeof( size ) );
+   hash = smf1_hash( hash, &mtime, sizeof( mtime ) );
+   hash = smf1_hash( hash, &buf.st_ino, sizeof( buf.st_ino ) );
+   hash = smf1_hash( hash, &usedetpos, sizeof( usedetpos ) );
+
+/* The sky coordinate system. The reference point and any offset
+   coordinate system are cleared first since they do not affect the
+   absolute coordinates. */
+   sf = astCopy( skyframe );
+   astClear( sf, "SkyRefIs" );
+   astClear( sf, "AlignOffset" );
+   astClear( sf, "SkyRef" );
+   astClear( sf, "SkyRefP" );
+   dump = astToString( sf );
+   hash = smf1_hash_string( hash, dump );
+   dump = astFree( dump );
+   sf = astAnnul( sf );
+
+/* The names of the detectors to be included. */
+   if( detgrp ) {
+      ndet = grpGrpsz( detgrp, status );
+      hash = smf1_hash( hash, &ndet, sizeof( ndet ) );
+      for( idet = 1; idet <= ndet && *status == SAI__OK; idet++ ) {
+         pname = detname;
+         grpGet( detgrp, idet, 1, &pname, sizeof( detname ), status );
+         hash = smf1_hash_string( hash, detname );
+      }
+   }
+
+/* Form the file name from the last component of the input file name,
+   without any ".sdf" suffix. */
+   if( *status == SAI__OK ) {
+      pbase = strrchr( path, '/' );
+      one_strlcpy( base, pbase ? pbase + 1 : path, sizeof( base ), status );
+      p = strstr( base, ".sdf" );
+      if( p && !p[ 4 ] ) *p = 0;
+
+      if( snprintf( filename, szfname, "%s/%s_%016" PRIx64 ".fpt", dir,
+                    base, hash ) >= (int) szfname ) {
+         *status = SAI__ERROR;
+         errRepf( "", FUNC_NAME ": Footprint cache directory name '%s' is "
+                  "too long.", status, dir );
+      } else {
+         result = 1;
+      }
+   }
+
+   return result;
+}
+
+/* Update a 64-bit FNV-1a hash with a block of memory. */
+static uint64_t smf1_hash( uint64_t hash, const void *pntr, size_t nbytes ){
+   const unsigned char *p = pntr;
+   const unsigned char *pend = p + nbytes;
+
+   while( p < pend ) {
+      hash ^= *(p++);
+      hash *= UINT64_C( 1099511628211 );
+   }
+   return hash;
+}
+
+/* Update a hash with a null-terminated string (including the
+   terminator, so that consecutive strings are kept distinct). */
+static uint64_t smf1_hash_string( uint64_t hash, const char *text ){
+   if( !text ) text = "";
+   return smf1_hash( hash, text, strlen( text ) + 1 );
+}
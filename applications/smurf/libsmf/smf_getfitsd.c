@@ -49,9 +49,12 @@
 *        Initial version, based on smf_get_fitsD by TIMJ.
 *     17-DEC-2008 (TIMJ):
 *        Use smf_validate_smfHead.
+*     2026-10-14:
+*        Use smf_fits_seek to locate the keyword.
 *     {enter_further_changes_here}
 
 *  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
 *     Copyright (C) 2008 Science & Technology Facilities Council.
 *     All Rights Reserved.
 
@@ -99,6 +102,10 @@ void smf_getfitsd( const smfHead *hdr, const char *name, double *result,
    if (*status != SAI__OK) return;
    if (!smf_validate_smfHead(hdr, 1, 0, status)) return;
 
+/* Use the keyword index to make the required card current, so that
+   AST does not need to search the whole header for it. */
+   smf_fits_seek( hdr, name, status );
+
 /* If the header contains a defined value for the keyword, put it into
    the returned results buffer. */
    if( astTestFits( hdr->fitshdr, name, &there ) ) {
@@ -51,9 +51,12 @@
 *        Use smf_validate_smfHead.
 *     25-MAY-2009 (TIMJ):
 *        Copy from smf_getfitsd
+*     2026-10-14:
+*        Use smf_fits_seek to locate the keyword.
 *     {enter_further_changes_here}
 
 *  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
 *     Copyright (C) 2008, 2009 Science & Technology Facilities Council.
 *     All Rights Reserved.
 
@@ -101,6 +104,10 @@ void smf_getfitsi( const smfHead *hdr, const char *name, int *result,
    if (*status != SAI__OK) return;
    if (!smf_validate_smfHead(hdr, 1, 0, status)) return;
 
+/* Use the keyword index to make the required card current, so that
+   AST does not need to search the whole header for it. */
+   smf_fits_seek( hdr, name, status );
+
 /* If the header contains a defined value for the keyword, put it into
    the returned results buffer. */
    if( astTestFits( hdr->fitshdr, name, &there ) ) {
@@ -199,6 +199,8 @@
  *     2018-10-02 (DSB):
  *        Handle cases where input does not have a NSUBSCAN value (e.g.
  *        if it is the concatenation of several subscans).
+ *     2026-10-14:
+ *        Do not read the WCS of each file, since it is not needed.
  *     {enter_further_changes_here}
 
  *  Copyright:
@@ -332,7 +334,8 @@ void smf_grp_related( const Grp *igrp, const size_t grpsize,
     AstKeyMap * indexmap = NULL;
 
     /* First step: open file and harvest metadata */
-    smf_open_file( NULL, igrp, i, "READ", SMF__NOCREATE_DATA, &data, status );
+    smf_open_file( NULL, igrp, i, "READ", SMF__NOCREATE_DATA |
+                   SMF__NOCREATE_WCS, &data, status );
     if (*status != SAI__OK) break;
 
     if( i==1 ) {
@@ -541,6 +541,28 @@
 *        If a continuous chunk fails for any reason, flush the error and
 *        proceed to map any remaining chunks. Only flush the error if
 *        there is more than one continuous chunk.
+*     14-OCT-2026:
+*        Create a packed quality mask for use by smf_rebinmap1.
+*     14-OCT-2026:
+*        Share continuous chunks between MPI processes if SMURF_MPI is set.
+*     14-OCT-2026:
+*        Optionally extrapolate the map between iterations (config
+*        parameter MAPACCEL) to reduce the number of iterations needed.
+*     14-OCT-2026:
+*        Report the resources used by each model if SMURF_MODELPROFILE
+*        is set.
+*     14-OCT-2026:
+*        Choose the number of threads used by each model if SMURF_AUTOTUNE
+*        is set.
+*     14-OCT-2026:
+*        Export model components from a background process if
+*        SMURF_WRITEBEHIND is set.
+*     14-OCT-2026:
+*        Close any sampled diagnostics file (config parameter DIAG.SAMPLE).
+*     14-OCT-2026:
+*        Re-use the large arrays freed at the end of each continuous chunk
+*        when allocating the arrays for the next chunk (see
+*        smf_scratch_pool).
 *     {enter_further_changes_here}
 
 *  Notes:
@@ -549,6 +571,7 @@
 *     Copyright (C) 2008-2014 Science and Technology Facilities Council.
 *     Copyright (C) 2006 Particle Physics and Astronomy Research Council.
 *     Copyright (C) 2006-2011 University of British Columbia.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -578,9 +601,23 @@
 /* Some compilers need this to get SA_RESTART */
 #define _BSD_SOURCE
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif
+
 #include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
 #include <signal.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
 
 /* Starlink includes */
 #include "ast.h"
@@ -621,6 +658,15 @@ void _smf_iteratemap_showmem( int *status ) {
 
 /* Prototypes for local static functions. */
 static void smf1_iteratemap( void *job_data_ptr, int *status );
+static void smf1_addchunk( dim_t contchunk, dim_t ncontchunks, dim_t msize,
+                           double chunkweight, double steptime, double *map,
+                           double *mapweights, double *weights,
+                           double *mapweightsq, double *mapvar, int *hitsmap,
+                           smf_qual_t *mapqual, double *exp_time,
+                           double *sumchunkweights, double *thismap,
+                           double *thisweight, double *thisweightsq,
+                           double *thisvar, int *thishits,
+                           smf_qual_t *thisqual, int *status );
 
 /* Local data types */
 typedef struct smfIterateMapData {
@@ -639,6 +685,50 @@ typedef struct smfIterateMapData {
    smf_qual_t *thisqual;
 } SmfIterateMapData;
 
+/* The result of processing one continuous chunk in a child process (see
+   SMURF_CHUNKPROCS). The maps themselves are held in separate arrays
+   following the array of SmfChunkResult structures. */
+typedef struct smfChunkResult {
+   int done;
+   double chunkchange;
+   double chunkweight;
+   double steptime;
+   char data_units[SMF__CHARLABEL];
+   char data_label[SMF__CHARLABEL];
+} SmfChunkResult;
+
+/* Memory shared between smf_iteratemap and the child processes that
+   process continuous chunks concurrently. The mutex serialises the
+   claiming of chunks and the summing of the totals. */
+typedef struct smfChunkShare {
+   pthread_mutex_t mutex;
+   dim_t next;
+   size_t count_mcnvg;
+   size_t count_minsmp;
+   size_t ntgood_tot;
+   size_t nsamples_tot;
+   int abortedat;
+   int iters;
+   int rate_limited;
+   double totexp;
+} SmfChunkShare;
+
+static dim_t smf1_claim_chunk( SmfChunkShare *share, int *status );
+static void smf1_wait_writer( pid_t *pid, int *status );
+
+#if HAVE_MPI
+static void smf1_mpi_collect( int mpirank, int nrank, dim_t ncontchunks,
+                              dim_t msize, SmfChunkResult *chunkres,
+                              double *shmap, double *shweight,
+                              double *shweightsq, double *shvar,
+                              int *shhits, smf_qual_t *shqual,
+                              double *chunkchange, size_t *count_mcnvg,
+                              size_t *count_minsmp, size_t *ntgood_tot,
+                              size_t *nsamples_tot, double *totexp,
+                              int *rate_limited, int *abortedat, int *iters,
+                              int *status );
+#endif
+
 #define FUNC_NAME "smf_iteratemap"
 
 /* A flag used to indicate that an interupt has occurred. */
@@ -660,12 +750,17 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
                      double *totexp, int *status ) {
 
   /* Local Variables */
+  double *accmap=NULL;          /* Un-extrapolated map from the last iter */
+  double accel_change=VAL__MAXD;/* Mean map change when last extrapolated */
   float ast_filt_diff;          /* Size of map-change filter */
   int ast_skip;                 /* Number of iterations with no AST model */
   int bolomap=0;                /* If set, produce single bolo maps */
   size_t bstride;               /* Bolometer stride */
   double *chisquared=NULL;      /* chisquared for each chunk each iter */
   double chitol=VAL__BADD;      /* chisquared change tolerance for stopping */
+  smfCheckpoint ckpt;           /* State saved in checkpoint files */
+  const char *ckptfile=NULL;    /* Name of checkpoint file */
+  int ckptint=1;                /* No. of iterations between checkpoints */
   double *chunkchange;          /* Holds final mapchange value for each chunk */
   int chunking;                 /* Will we be chunking due to low memory? */
   double chunkfactor=1.0;       /* A calibration correction factor for the
@@ -743,6 +838,7 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
   double mapchange_l2;          /* Mean change from previous iteration */
   double mapchange_l3;          /* Mean change from previous iteration */
   double mapchange_max=0;       /* Maximum change in the map */
+  double mapaccel=0.0;          /* Map extrapolation factor */
   double maptol=VAL__BADD;      /* map change tolerance for stopping */
   double maptol_box=0.0;        /* Box size to use when smoothing map change */
   double maptol_hits=0;         /* Fractional hits limit ot use when creating map change */
@@ -755,6 +851,8 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
   dim_t maxconcat2;             /* Better estimate of longest chunk */
   dim_t maxfile;                /* Longest file length in time samples*/
   int maxiter=0;                /* Maximum number of iterations */
+  int nacc=0;                   /* Iterations since extrapolation restarted */
+  int naccel=0;                 /* No. of iterations that extrapolated map */
   double maxlen=0;              /* Max length in seconds of cont. chunk */
   int memcheck=0;               /* Are we just doing a memory check? */
   size_t memneeded;             /* Memory required for map-maker */
@@ -765,12 +863,43 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
   char modelnames[SMF_MODEL_MAX*4]; /* Array of all model components names */
   smf_modeltype *modeltyps=NULL;/* Array of model types */
   smf_calcmodelptr modelptr=NULL; /* Pointer to current model calc function */
+  ThrWorkForce *mwf=NULL;       /* Workforce used by the current model */
+  const char *oldtag;             /* Previous THR job tag */
   dim_t mdims[2];               /* Dimensions of map */
   dim_t msize;                  /* Number of elements in map */
   int mw = 0;                   /* No. of threads to use when rebinning data into a map */
+  int partmap = 0;              /* Divide a single map between rebinning threads? */
+  smfModelProfile prof = { NULL, 0.0, 0.0 }; /* Model profiling state */
+  smfModelTune tune[SMF_MODEL_MAX]; /* Thread tuning state for each model */
+  ThrWorkForce **tunewf=NULL;   /* Workforces used by tuned models */
+  size_t wbcap=0;               /* Max. bytes exported in the background */
+  int inwriter=0;               /* Is this the background export process? */
+  pid_t wbpid=0;                /* Background export process, if any */
   char name[1500];              /* Buffer for storing exported model names */
   dim_t nbolo;                  /* Number of bolometers */
   size_t ncontchunks=0;         /* Number continuous chunks outside iter loop*/
+  size_t prefetchmem=0;         /* Memory available for prefetching input */
+  size_t chunkmem=0;            /* Memory needed to process one chunk */
+  int nproc=1;                  /* No. of chunks to process concurrently */
+  int iproc;                    /* Index of child process */
+  int ischild=0;                /* Is this a chunk-processing child process? */
+  int sepchunks=0;              /* Can chunks use separate processes? */
+  int mpirank=0;                /* Rank of this MPI process */
+  int nrank=1;                  /* Number of MPI processes */
+  int usempi=0;                 /* Are chunks shared between MPI processes? */
+  pid_t *pids=NULL;             /* Process ids of child processes */
+  SmfChunkShare *share=NULL;    /* Memory shared with child processes */
+  SmfChunkResult *chunkres=NULL;/* Results for each chunk in shared memory */
+  size_t sharesize=0;           /* Size of shared memory in bytes */
+  double *shmap=NULL;           /* Maps for each chunk in shared memory */
+  double *shweight=NULL;        /* Weights for each chunk in shared memory */
+  double *shweightsq=NULL;      /* Weights^2 for each chunk in shared memory */
+  double *shvar=NULL;           /* Variances for each chunk in shared memory */
+  int *shhits=NULL;             /* Hits for each chunk in shared memory */
+  smf_qual_t *shqual=NULL;      /* Quality for each chunk in shared memory */
+  dim_t claimed=0;              /* Chunk claimed by this child process */
+  int nunits=0;                 /* No. of chunks checked for data units */
+  ThrWorkForce *iowf=NULL;      /* Workforce for prefetching input files */
   int nhitslim=0;               /* Min number of hits allowed in a map pixel */
   int nm=0;                     /* Signed int version of nmodels */
   dim_t nmodels=0;              /* Number of model components / iteration */
@@ -791,6 +920,7 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
   smf_qual_t *qua_data=NULL;    /* Pointer to DATA component of qua */
   int quit=0;                   /* flag indicates when to quit */
   int rate_limited=0;           /* Was the MAPTOL_RATE limit hit? */
+  int resume=0;                 /* Resume from a checkpoint file? */
   int rebinflags;               /* Flags to control rebinning */
   smfArray **res=NULL;          /* Residual signal */
   double *res_data=NULL;        /* Pointer to DATA component of res */
@@ -848,6 +978,12 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
      this function. */
   astBegin;
 
+  /* The residuals, models, etc, for each continuous chunk are freed at the
+     end of the chunk. Keep them in a pool so that they can be re-used for
+     the next chunk, which usually needs arrays of similar sizes, rather
+     than the kernel supplying fresh pages each time. */
+  smf_scratch_pool( 1, status );
+
   /* If this is an interactive session, establish an interupt handler that
      sets the smf_interupt flag non-zero when an interupt occurs. */
   if( isatty( STDIN_FILENO ) ) {
@@ -1016,6 +1152,22 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
          "MAPTOL_RATE" between iterations. */
       astMapGet0D( keymap, "MAPTOL_RATE", &maptol_rate );
 
+      /* The factor by which to extrapolate the map along the direction in
+         which it changed on the previous iteration. Zero (the default)
+         means no extrapolation. */
+      astMapGet0D( keymap, "MAPACCEL", &mapaccel );
+      if( mapaccel < 0.0 || mapaccel > 1.0 ) {
+         if( *status == SAI__OK ) {
+            *status = SAI__ERROR;
+            errRepf( "", "Bad value %g for config parameter 'MAPACCEL' - "
+                     "must be in the range 0 to 1.", status, mapaccel );
+         }
+      } else if( mapaccel > 0.0 ) {
+         accmap = astMalloc( msize*sizeof(*accmap) );
+         msgOutiff( MSG__VERB," ", FUNC_NAME ": Extrapolating the map "
+                    "between iterations (MAPACCEL=%g).", status, mapaccel );
+      }
+
       /* Get the AST-specific parameters. */
       ast_skip = 0;
       ast_filt_diff = 0.0;
@@ -1445,6 +1597,7 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
      add in the extra length required for padding. */
 
   if( *status == SAI__OK ) {
+    const char *envval; /* environment variable value */
     size_t mapmem;  /* memory needed for map */
     size_t maxdimm; /* maximum memory available just for model components */
 
@@ -1453,10 +1606,19 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
     msgOutiff( MSG__VERB," ", FUNC_NAME ": Each time stream will be padded "
               "with %" DIM_T_FMT "  samples at start and end.", status, pad );
 
+    /* See if a single map divided between the threads should be used
+       when rebinning, rather than a separate map for each thread. */
+    envval = getenv( SMF__PARTMAP );
+    partmap = ( envval && atoi( envval ) != 0 );
+
+    /* See if a report of the resources used by each model is required. */
+    prof.fname = getenv( SMF__MODELPROFILE );
+    if( prof.fname && !prof.fname[ 0 ] ) prof.fname = NULL;
+
     /* First check memory for the map and subtract off total memory to
        see what is available for model components. */
-    smf_checkmem_map( lbnd_out, ubnd_out, 0, nw, maxmem, epsout, &mapmem,
-                      status );
+    smf_checkmem_map( lbnd_out, ubnd_out, 0, partmap ? 1 : nw, maxmem,
+                      epsout, &mapmem, status );
     maxdimm = maxmem-mapmem;
 
     /* Then the iterative components that are proportional to time */
@@ -1465,9 +1627,9 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
                        &memneeded, status );
 
     /* If we need too much memory, generate a warning message and then
-       see if we would have enough memory if we were to not use
-       multi-threading in the function that rebins time-series data into
-       a map. */
+       see if we would have enough memory if the threads in the function
+       that rebins time-series data into a map were to share a single
+       map. */
     if( *status == SMF__NOMEM ) {
       errAnnul( status );
       msgOutf( " ", FUNC_NAME ": *** WARNING ***\n  %zu continuous samples "
@@ -1475,11 +1637,11 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
                status, maxconcat, maxconcat/srate_maxlen,
                memneeded/SMF__MIB, maxdimm/SMF__MIB);
 
-      msgOut( "", "  Will try again without multi-threaded rebinning...",
-              status );
+      msgOut( "", "  Will try again using a single map for all rebinning "
+              "threads...", status );
 
-    /* Check memory for the map again, this time without multi-threading
-       in smf_rebinmap1. */
+    /* Check memory for the map again, this time using a single map in
+       smf_rebinmap1. */
       smf_checkmem_map( lbnd_out, ubnd_out, 0, 1, maxmem, epsout, &mapmem,
                         status );
       maxdimm = maxmem-mapmem;
@@ -1491,23 +1653,24 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
 
     /* Annul the error and use a better message if there was still
        insufficient memory to avoid chunking. In this case we revert to
-       using multi-threading in smf_rebinmap1. */
+       using a separate map for each thread in smf_rebinmap1 (unless a
+       single map was requested explicitly). */
       if( *status == SMF__NOMEM ){
          chunking = 1;
-         mw = nw;
+         mw = partmap ? 1 : nw;
          errAnnul( status );
-         msgOutf( " ", FUNC_NAME ": %zu MiB available with less multi-threading "
+         msgOutf( " ", FUNC_NAME ": %zu MiB available with a single map "
                   "- still too low.", status, maxdimm/SMF__MIB );
       } else {
          chunking = 0;
          mw = 1;
-         msgOutf( " ", FUNC_NAME ": %zu MiB available with less multi-threading "
-                  "- so we can avoid chunking at the expense of slower "
-                  "map-making.", status, maxdimm/SMF__MIB );
+         partmap = 1;
+         msgOutf( " ", FUNC_NAME ": %zu MiB available with a single map "
+                  "- so we can avoid chunking.", status, maxdimm/SMF__MIB );
       }
     } else {
       chunking = 0;
-      mw = nw;
+      mw = partmap ? 1 : nw;
     }
 
     /* Note if there was insufficient memory to avoid chunking. */
@@ -1601,6 +1764,15 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
     msgOutf( "", FUNC_NAME ": map-making requires %zu MiB "
              "(map=%zu MiB model calc=%zu MiB)", status,
              (mapmem+memneeded)/SMF__MIB, mapmem/SMF__MIB, memneeded/SMF__MIB );
+
+    /* Any memory left over after allowing for the models can be used to
+       prefetch the input files for the next continuous chunk whilst the
+       current chunk is being iterated. */
+    if( maxdimm > memneeded ) prefetchmem = maxdimm - memneeded;
+
+    /* Store the total memory needed to process a single chunk, for use
+       when deciding how many chunks can be processed concurrently. */
+    chunkmem = mapmem + memneeded;
   }
 
   /* If we are just checking the available memory, and not actually
@@ -1663,6 +1835,232 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
   /* Create an array to hold the final mapchange value for each chunk. */
   chunkchange = astMalloc( ncontchunks*sizeof( *chunkchange ) );
 
+  /* If the SMURF_CHECKPOINT environment variable gives the name of a
+     checkpoint file, the full state of the map-maker is saved to it
+     every SMURF_CHECKPOINT_INTERVAL iterations (see smf_write_checkpoint).
+     If SMURF_RESUME is also set to a non-zero value, the state is
+     restored from the file instead of starting from scratch. Only the
+     header is read at this stage, to find the continuous chunk to
+     resume. */
+  memset( &ckpt, 0, sizeof(ckpt) );
+  ckptfile = getenv( SMF__CHECKPOINT );
+  if( ckptfile && !ckptfile[0] ) ckptfile = NULL;
+  if( ckptfile && *status == SAI__OK ) {
+    const char *envval;
+
+    envval = getenv( SMF__CHECKPOINT_INTERVAL );
+    if( envval ) ckptint = atoi( envval );
+    if( ckptint < 1 ) ckptint = 1;
+
+    envval = getenv( SMF__RESUME );
+    resume = ( envval && atoi( envval ) != 0 );
+
+    if( resume ) {
+      smf_read_checkpoint( ckptfile, &ckpt, NULL, NULL, 0, status );
+      if( *status == SAI__OK && ckpt.ncontchunks != ncontchunks ) {
+        *status = SAI__ERROR;
+        errRepf( "", FUNC_NAME ": Checkpoint file '%s' has %zu continuous "
+                 "chunks but the current data have %zu.", status, ckptfile,
+                 (size_t) ckpt.ncontchunks, (size_t) ncontchunks );
+      }
+      msgOutf( "", FUNC_NAME ": Resuming from checkpoint file '%s'",
+               status, ckptfile );
+    }
+  }
+
+  /* The size of the memory used to hold the results of every chunk
+     when chunks are processed by separate processes. */
+  sharesize = sizeof( *share ) + ncontchunks*( sizeof( *chunkres ) +
+              msize*( 4*sizeof( *shmap ) + sizeof( *shhits ) +
+                      sizeof( *shqual ) ) );
+
+  /* Outputs that are written into the output NDF, or into a single
+     container file shared by all chunks, cannot be created by
+     separate processes. Nor can the checkpoint file. */
+  if( ncontchunks > 1 && *status == SAI__OK ) {
+    const char *diagout = NULL;
+    double shortval = 0.0;
+
+    if( astMapGet0A( keymap, "DIAG", &kmap ) ) {
+      astMapGet0C( kmap, "OUT", &diagout );
+      if( !diagout ) astMapGet0C( kmap, "SAMPLE", &diagout );
+      kmap = astAnnul( kmap );
+    }
+    astMapGet0D( keymap, "SHORTMAP", &shortval );
+
+    sepchunks = !( itermap || bolomap || sampcube || make_flagmap ||
+                   ckptfile || diagout || shortval != 0.0 ||
+                   ( ast_filt_diff > 0.0 && numiter == 1 ) );
+  }
+
+  /* If SMURF was built with MPI and the SMURF_MPI environment variable
+     is set, MAKEMAP may be run as several MPI processes ("ranks"),
+     possibly on different nodes, all given the same parameters. The
+     continuous chunks are then dealt out to the ranks in turn, and each
+     rank processes its own chunks, using all of its threads, in the
+     same way as a SMURF_CHUNKPROCS child process. At the end, the map
+     from each chunk is sent to rank zero, which combines them in order
+     exactly as if the chunks had been processed one after the other.
+     The other ranks write their output maps to scratch NDFs which are
+     deleted by smurf_makemap. If the chunks cannot be shared out, every
+     rank makes the whole map. */
+  mpirank = smf_mpi_rank( &nrank, status );
+  if( nrank > 1 && *status == SAI__OK ) {
+    if( sepchunks ) {
+      usempi = 1;
+    } else {
+      msgOut( "", FUNC_NAME ": *** Warning *** the continuous chunks "
+              "cannot be shared between MPI processes, so every process "
+              "will make the whole map", status );
+    }
+  }
+
+  /* The continuous chunks are independent of each other until their maps
+     are combined. If the SMURF_CHUNKPROCS environment variable is set to
+     a value larger than one, that many chunks are processed concurrently,
+     each in a child process with its own share of the worker threads and
+     its own private map. Separate processes are used rather than
+     threads since NDF and HDS are not thread-safe. The maps from each
+     chunk are returned in shared memory and combined in order at the
+     end, exactly as they would have been if the chunks had been
+     processed one after the other. */
+  if( ncontchunks > 1 && nw > 1 && !usempi && *status == SAI__OK ) {
+    const char *envval = getenv( SMF__CHUNKPROCS );
+    if( envval ) nproc = atoi( envval );
+    if( nproc > (int) ncontchunks ) nproc = ncontchunks;
+    if( nproc > nw ) nproc = nw;
+
+    /* Chunks are only processed concurrently if enough memory is
+       available, allowing for the maps returned in shared memory. */
+    if( nproc > 1 && chunkmem > 0 ) {
+      int maxproc = ( maxmem > sharesize ) ? ( maxmem - sharesize )/chunkmem : 0;
+      if( nproc > maxproc ) {
+        msgOutiff( MSG__VERB, "", FUNC_NAME ": Only enough memory to process "
+                   "%d continuous chunks concurrently.", status,
+                   ( maxproc > 1 ) ? maxproc : 1 );
+        nproc = maxproc;
+      }
+    }
+
+    if( nproc > 1 && !sepchunks ) {
+      msgOut( "", FUNC_NAME ": *** Warning *** SMURF_CHUNKPROCS is being "
+              "ignored since it cannot be used with the requested "
+              "diagnostic outputs", status );
+      nproc = 1;
+    }
+  }
+
+  /* Create the shared memory and the child processes. The same loop over
+     chunks is then run in each child, each chunk being claimed by the
+     first child that is ready for it. The parent waits for the children
+     to finish. Pending output is flushed first so that it is not
+     duplicated in the children. When sharing chunks between MPI
+     processes, each process uses the same shared memory to hold the
+     results of its own chunks, and takes its chunks in turn rather than
+     claiming them. */
+  if( ( nproc > 1 || usempi ) && *status == SAI__OK ) {
+    pthread_mutexattr_t attr;
+
+    share = mmap( NULL, sharesize, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_ANONYMOUS, -1, 0 );
+    if( share == MAP_FAILED ) {
+      share = NULL;
+      *status = SAI__ERROR;
+      errRep( "", FUNC_NAME ": Unable to create shared memory for "
+              "concurrent chunks.", status );
+    } else {
+      memset( share, 0, sizeof(*share) );
+      pthread_mutexattr_init( &attr );
+      pthread_mutexattr_setpshared( &attr, PTHREAD_PROCESS_SHARED );
+      pthread_mutex_init( &share->mutex, &attr );
+      pthread_mutexattr_destroy( &attr );
+      share->iters = -1;
+
+      chunkres = (SmfChunkResult *) ( share + 1 );
+      memset( chunkres, 0, ncontchunks*sizeof(*chunkres) );
+      shmap = (double *) ( chunkres + ncontchunks );
+      shweight = shmap + ncontchunks*msize;
+      shweightsq = shweight + ncontchunks*msize;
+      shvar = shweightsq + ncontchunks*msize;
+      shhits = (int *) ( shvar + ncontchunks*msize );
+      shqual = (smf_qual_t *) ( shhits + ncontchunks*msize );
+    }
+
+    if( usempi ) {
+      msgOutf( "", FUNC_NAME ": Sharing %zu continuous chunks between %d "
+               "MPI processes", status, ncontchunks, nrank );
+      ischild = 1;
+      claimed = mpirank;
+    } else {
+      pids = astCalloc( nproc, sizeof(*pids) );
+      msgOutf( "", FUNC_NAME ": Processing %d continuous chunks "
+               "concurrently, each using %d threads", status, nproc,
+               nw/nproc );
+      fflush( NULL );
+    }
+
+    for( iproc = 0; iproc < nproc && pids && *status == SAI__OK; iproc++ ) {
+      pids[ iproc ] = fork();
+
+      /* In the child, replace the parent's workforce (whose threads do
+         not exist in the child) with a smaller one of its own. Interupts
+         simply kill the child. */
+      if( pids[ iproc ] == 0 ) {
+        ischild = 1;
+        signal( SIGINT, SIG_DFL );
+        wf = thrCreateWorkforce( nw/nproc, status );
+        claimed = smf1_claim_chunk( share, status );
+        break;
+
+      } else if( pids[ iproc ] == -1 ) {
+        *status = SAI__ERROR;
+        errRepf( "", FUNC_NAME ": Unable to create process for concurrent "
+                 "chunks: %s", status, strerror( errno ) );
+      }
+    }
+  }
+
+  /* If there is more than one continuous chunk, create a single-threaded
+     workforce that reads the input files for the next chunk into the
+     page cache whilst the current chunk is being iterated (see
+     smf_prefetch_chunk). This overlaps the disk I/O for each chunk with
+     the processing of the previous chunk. The files are only read, not
+     opened as NDFs, since NDF is not thread-safe. */
+  if( ncontchunks > 1 && prefetchmem > 0 && nproc == 1 && !usempi ) {
+    iowf = thrCreateWorkforce( 1, status );
+  }
+
+  /* If required, choose the number of threads used by each model from
+     the time it takes to calculate on successive iterations (see
+     smf_model_autotune). This is done separately by each concurrent
+     chunk process, using its own workforce. */
+  if( wf && wf->nworker > 1 && *status == SAI__OK ) {
+    const char *envval = getenv( SMF__AUTOTUNE );
+    if( envval && atoi( envval ) != 0 ) {
+      tunewf = astCalloc( wf->nworker + 1, sizeof(*tunewf) );
+      memset( tune, 0, sizeof(tune) );
+      msgOutif( MSG__VERB, "", FUNC_NAME ": Choosing the number of threads "
+                "used by each model.", status );
+    }
+  }
+
+  /* If required, export the model components of each chunk from a
+     background process, so that the next chunk can be processed while
+     they are being written. The process is forked, so it sees a copy of
+     the models as they were at the end of the chunk, and the memory cost
+     is limited to the pages subsequently modified by this process. The
+     cap (in MiB) limits the size of the models that are exported in this
+     way. This is not done within concurrent chunk processes. */
+  if( exportNDF && !ischild && nproc == 1 && *status == SAI__OK ) {
+    const char *envval = getenv( SMF__WRITEBEHIND );
+    if( envval && atoi( envval ) > 0 ) {
+      wbcap = (size_t) atoi( envval )*SMF__MIB;
+      msgOutiff( MSG__VERB, "", FUNC_NAME ": Model components up to %d MiB "
+                 "will be exported in the background.", status,
+                 atoi( envval ) );
+    }
+  }
+
 
   /* ***************************************************************************
      Start the main outer loop over continuous chunks, or "contchunks".
@@ -1675,14 +2073,16 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
   sumchunkweights = 0.0;
   *totexp = 0.0;
 
-  for( contchunk=0; contchunk<ncontchunks  && !smf_interupt && *status == SAI__OK;
-       contchunk++ ) {
+  for( contchunk=0; contchunk<ncontchunks  && !smf_interupt && *status == SAI__OK
+       && ( nproc == 1 || ischild ); contchunk++ ) {
 
     size_t ntgood = 0;       /* Number of good time slices in this chunk */
     size_t nsamples = 0;     /* Number of good samples in this chunk */
 
     smfArray *noisemaps=NULL;/* Array of noise maps for current chunk */
 
+    /* A child process only processes the chunk it has claimed. */
+    if( ischild && contchunk != claimed ) continue;
 
 #ifdef __ITERATEMAP_SHOW_MEM
     _smf_iteratemap_showmem(status);
@@ -1700,7 +2100,7 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
     if( *status == SAI__OK ) {
 
       /* Setup the map estimate from the current contchunk. */
-      if( contchunk == 0 ) {
+      if( !thismap ) {
         /* For the first continuous chunk, calculate the map
            in-place */
         mapweights = astCalloc( msize, sizeof(*mapweights) );
@@ -1716,6 +2116,15 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
         thisqual = astCalloc( mw*msize, sizeof(*thisqual) );
       }
 
+      /* When resuming from a checkpoint, chunks that had already been
+         completed are not read again. Their contribution to the final
+         map is restored from the checkpoint file. */
+      if( resume && contchunk < ckpt.contchunk ) {
+        msgOut( " ", FUNC_NAME ": Chunk already completed in checkpoint - "
+                "skipping", status );
+        continue;
+      }
+
       /* Concat everything in this contchunk into a single smfArray. Note
          that the pointing LUT gets generated in smf_concat_smfGroup below. */
 
@@ -1727,6 +2136,10 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
       /* Allocate length 1 array of smfArrays. */
       res = astCalloc( 1, sizeof(*res) );
 
+      /* Wait for any prefetching of the files in this chunk to finish,
+         so that it does not compete with the concatenation. */
+      if( iowf ) thrWait( iowf, status );
+
       /* Concatenate */
       smf_concat_smfGroup( wf, keymap, igroup, darks, bbms, flatramps, heateffmap,
                            contchunk, ensureflat, 0, outfset, moving,
@@ -1734,6 +2147,11 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
                            noi_usevar?0:SMF__NOCREATE_VARIANCE, &res[0],
                            NULL, status );
 
+      /* Start reading the files for the next chunk in the background. */
+      if( iowf && contchunk + 1 < ncontchunks ) {
+        smf_prefetch_chunk( iowf, igroup, contchunk + 1, prefetchmem, status );
+      }
+
       /* Assign each time slice to a scan angle bin */
       if (*status == SAI__OK) {
         smf_find_thetabins( res[0]->sdata[0], 1, &thetabins, &thetabincen,
@@ -1778,6 +2196,11 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
     /* Zero the array holding the map created on the previous iteration. */
     memset( lastmap, 0, msize*sizeof(*lastmap) );
 
+    /* Restart any map extrapolation. */
+    accel_change = VAL__MAXD;
+    nacc = 0;
+    naccel = 0;
+
     /* Create containers for time-series model components******************* */
 
     msgOutif(MSG__VERB," ", FUNC_NAME ": Create model containers", status);
@@ -1823,7 +2246,8 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
         smfData *thisqua = qua[0]->sdata[idx];
         res[0]->sdata[idx]->sidequal = thisqua;
         if( res[0]->sdata[idx]->qual ) {
-          res[0]->sdata[idx]->qual = astFree( res[0]->sdata[idx]->qual );
+          res[0]->sdata[idx]->qual = smf_scratch_free( res[0]->sdata[idx]->qual,
+                                                       status );
         }
       }
 
@@ -1876,8 +2300,13 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
                       lbnd_out, ubnd_out, keymap, chunkfactor, contchunk,
                       status );
 
-      /* Do data cleaning */
-      if( doclean ) {
+      /* Do data cleaning. Not needed if resuming, since the cleaned data
+         will be restored from the checkpoint file. */
+      if( resume && contchunk == ckpt.contchunk ) {
+        msgOutif( MSG__VERB, " ", FUNC_NAME ": resuming from checkpoint, "
+                  "so not pre-conditioning data", status );
+
+      } else if( doclean ) {
         smf_clean_smfArray( wf, res[0], &noisemaps, NULL, NULL, keymap,
                             status );
       } else {
@@ -1923,7 +2352,8 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
         smfData *tmpdata = res[0]->sdata[0];
         /* Check units are consistent */
         if (tmpdata && tmpdata->hdr) {
-          smf_check_units( contchunk+1, data_units, tmpdata->hdr, status);
+          smf_check_units( ischild ? ++nunits : (int) contchunk+1,
+                           data_units, tmpdata->hdr, status);
         }
       }
 
@@ -2145,6 +2575,40 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
            any such previous iterations. */
         firstiter = 1;
 
+        /* If resuming from a checkpoint made during this continuous chunk,
+           overwrite the residuals, models, maps and loop counters with
+           those stored in the checkpoint file. */
+        if( resume && contchunk == ckpt.contchunk && *status == SAI__OK ) {
+          ckpt.map = map;
+          ckpt.weights = weights;
+          ckpt.mapweights = mapweights;
+          ckpt.mapweightsq = mapweightsq;
+          ckpt.mapvar = mapvar;
+          ckpt.hitsmap = hitsmap;
+          ckpt.mapqual = mapqual;
+          ckpt.exp_time = exp_time;
+          ckpt.chunkchange = chunkchange;
+          smf_read_checkpoint( ckptfile, &ckpt, &dat, model, nmodels, status );
+
+          if( *status == SAI__OK ) {
+            iter = ckpt.iter;
+            quit = ckpt.quit;
+            converged = ckpt.converged;
+            noidone = ckpt.noidone;
+            rate_limited = ckpt.rate_limited;
+            mapchange_l2 = ckpt.mapchange_l2;
+            mapchange_l3 = ckpt.mapchange_l3;
+            sumchunkweights = ckpt.sumchunkweights;
+            if( lastchisquared ) lastchisquared[0] = ckpt.lastchisquared;
+            firstiter = 0;
+
+            msgOutf( "", FUNC_NAME ": Resuming after iteration %d of "
+                     "continuous chunk %zu", status, iter,
+                     (size_t) contchunk + 1 );
+          }
+          resume = 0;
+        }
+
         while( quit < 1 ) {
           msgSeti("ITER", iter+1);
           msgSeti("MAXITER", maxiter);
@@ -2361,8 +2825,30 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
                 smf_diagnostics( wf, 0, &dat, contchunk, keymap, model[j],
                                  modeltyps[j], dimmflags, chunkfactor, status );
 
-                /* Estimate the new model and subtract it from the residuals. */
-                (*modelptr)( wf, &dat, 0, keymap, model[j], dimmflags, status );
+                /* Estimate the new model and subtract it from the residuals.
+                   Tag the jobs used to do this with the model name, so
+                   that they can be identified in any THR trace. */
+                oldtag = thrSetJobTag( smf_model_getname( modeltyps[j],
+                                                          status ) );
+                mwf = wf;
+                if( tunewf && iter > 0 ) {
+                  mwf = smf_model_autotune( wf, tunewf, tune + j, 1, NULL,
+                                            status );
+                }
+                smf_model_profile( &prof, 1, contchunk, iter, NULL, NULL,
+                                   NULL, 0, status );
+                (*modelptr)( mwf, &dat, 0, keymap, model[j], dimmflags,
+                             status );
+                smf_model_profile( &prof, 0, contchunk, iter,
+                                   smf_model_getname( modeltyps[j], status ),
+                                   model[j][0], res[0], mwf ? mwf->nworker : 1,
+                                   status );
+                if( tunewf && iter > 0 ) {
+                  smf_model_autotune( wf, tunewf, tune + j, 0,
+                                      smf_model_getname( modeltyps[j], status ),
+                                      status );
+                }
+                thrSetJobTag( oldtag );
 
                 /* After subtraction of the model, dump the model itself
                    and the modified residuals. */
@@ -2394,6 +2880,8 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
 
           msgOut(" ", FUNC_NAME ": Rebin residual to estimate MAP",
                  status);
+          smf_model_profile( &prof, 1, contchunk, iter, NULL, NULL, NULL, 0,
+                             status );
 
           if( *status == SAI__OK ) {
 
@@ -2498,13 +2986,25 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
                 rebinflags = rebinflags | AST__REBINEND;
               }
 
+              /* Pack the quality into one bit per sample, so that
+                 smf_rebinmap1 can skip flagged samples (64 at a time
+                 within each bolometer) without reading the full quality
+                 array. The mask is freed again straight away since the
+                 model components that follow modify the quality without
+                 updating it. */
+              smf_qmask_update( wf, res[0]->sdata[idx], SMF__Q_GOOD, status );
+
               /* Rebin the residual + astronomical signal into a map */
-              smf_rebinmap1( ( mw > 1 ) ? wf : NULL, res[0]->sdata[idx],
+              oldtag = thrSetJobTag( "map" );
+              smf_rebinmap1( ( mw > 1 || partmap ) ? wf : NULL, res[0]->sdata[idx],
                              dat.noi ? dat.noi[0]->sdata[idx] : NULL,
                              lut_data, 0, 0, 0, NULL, 0, SMF__Q_GOOD,
-                             varmapmethod, rebinflags, thismap, thisweight,
+                             varmapmethod, rebinflags, partmap, thismap, thisweight,
                              thisweightsq, thishits, reuse_var ? NULL : thisvar,
                              msize, chunkfactor, &scalevar, status );
+              thrSetJobTag( oldtag );
+
+              smf_qmask_update( wf, res[0]->sdata[idx], 0, status );
             }
 
             /* Indicate the map arrays within the supplied smfDIMMData
@@ -2515,6 +3015,8 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
             msgOutiff( SMF__TIMER_MSG, "", FUNC_NAME
                        ": ** %f s rebinning map",
                        status, smf_timerupdate(&tv1,&tv2,status) );
+            smf_model_profile( &prof, 0, contchunk, iter, "MAP", NULL,
+                               res[0], wf ? wf->nworker : 1, status );
 
             /* If required, modify the map to remove low frequencies changes
                between the new map and the old map. We do not do this if
@@ -2572,6 +3074,47 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
                 }
               }
             }
+
+            /* If required, accelerate convergence by extrapolating the map
+               along the direction in which the un-extrapolated map changed
+               since the previous iteration (i.e. Nesterov momentum). The
+               step grows as MAPACCEL*(n-1)/(n+2) with the number of
+               iterations, n, since the extrapolation was (re)started. It is
+               restarted whenever the normalised map change increases, so
+               that it cannot drive oscillations, and while the AST model is
+               being skipped. No extrapolation is done on the final
+               iteration, so the final map is always the one estimated from
+               the data. */
+            if( accmap && *status == SAI__OK ) {
+              double beta = 0.0;
+              double *p1 = thismap;
+              double *p2 = accmap;
+
+              if( dat.ast_skipped || dat.mapchange == VAL__MAXD ||
+                  dat.mapchange > accel_change ) nacc = 0;
+              accel_change = dat.mapchange;
+              if( nacc > 0 && quit == -1 ) {
+                beta = mapaccel*( nacc - 1.0 )/( nacc + 2.0 );
+              }
+
+              for( ipix = 0; ipix < msize; ipix++,p1++,p2++ ) {
+                if( *p1 != VAL__BADD ) {
+                  double x = *p1;
+                  if( beta > 0.0 && *p2 != VAL__BADD ) *p1 += beta*( x - *p2 );
+                  *p2 = x;
+                } else {
+                  *p2 = VAL__BADD;
+                }
+              }
+
+              nacc++;
+              if( beta > 0.0 ) {
+                naccel++;
+                msgOutiff( MSG__VERB, "", FUNC_NAME ": map extrapolated by "
+                           "%g times its change since the previous "
+                           "iteration.", status, beta );
+              }
+            }
           }
 
 
@@ -3035,11 +3578,48 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
      iteration into the "lastmap" array. Otherwise, leave "lastmap" unchanged
      so that it is available later on, if needed. */
           if( quit < 1 ) memcpy( lastmap, thismap, msize*sizeof(*lastmap) );
+
+          /* Save a checkpoint if another iteration is to be done. */
+          if( ckptfile && quit < 1 && iter % ckptint == 0 &&
+              *status == SAI__OK ) {
+            ckpt.contchunk = contchunk;
+            ckpt.ncontchunks = ncontchunks;
+            ckpt.iter = iter;
+            ckpt.quit = quit;
+            ckpt.converged = converged;
+            ckpt.noidone = noidone;
+            ckpt.rate_limited = rate_limited;
+            ckpt.mapchange_l2 = mapchange_l2;
+            ckpt.mapchange_l3 = mapchange_l3;
+            ckpt.lastchisquared = lastchisquared ? lastchisquared[0] : VAL__BADD;
+            ckpt.sumchunkweights = sumchunkweights;
+            ckpt.map = map;
+            ckpt.weights = weights;
+            ckpt.mapweights = mapweights;
+            ckpt.mapweightsq = mapweightsq;
+            ckpt.mapvar = mapvar;
+            ckpt.hitsmap = hitsmap;
+            ckpt.mapqual = mapqual;
+            ckpt.exp_time = exp_time;
+            ckpt.chunkchange = chunkchange;
+            smf_write_checkpoint( ckptfile, &ckpt, &dat, model, nmodels,
+                                  status );
+            msgOutiff( SMF__TIMER_MSG, "", FUNC_NAME
+                       ": ** %f s writing checkpoint",
+                       status, smf_timerupdate(&tv1,&tv2,status) );
+          }
         }
 
         /* Save the final mapchange value */
         chunkchange[ contchunk ] = dat.mapchange;
 
+        /* Report how much use was made of map extrapolation. */
+        if( accmap ) {
+          msgOutf( "", FUNC_NAME ": the map was extrapolated on %d of the %d "
+                   "iterations (MAPACCEL=%g).", status, naccel, iter,
+                   mapaccel );
+        }
+
         /* If we are dumping the final error map, check we have done at
            least 3 iterations. */
         if( epsout && *status == SAI__OK ) {
@@ -3311,6 +3891,55 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
            Also - check that a filename is defined in the smfFile! */
 
         if( exportNDF && ((*status == SAI__OK) || (*status == SMF__INSMP)) ) {
+
+          /* If write-behind is enabled, wait for the previous chunk's
+             export to complete and then, if the models are not too big,
+             fork a process to export this chunk's models. The process
+             needs its own workforce, since the threads of this one do not
+             exist in it. If the fork fails, the models are exported as
+             usual. */
+          if( wbcap > 0 ) {
+            size_t wbsize = 0;
+            smf1_wait_writer( &wbpid, status );
+
+            for( idx = 0; idx < res[0]->ndat && *status == SAI__OK; idx++ ) {
+              smfData *wbdata[ 3 ];
+              wbdata[ 0 ] = res[0]->sdata[idx];
+              wbdata[ 1 ] = qua[0]->sdata[idx];
+              wbdata[ 2 ] = lut[0]->sdata[idx];
+              for( j = 0; j < 3 + nmodels; j++ ) {
+                smfData *wbd = ( j < 3 ) ? wbdata[ j ] :
+                               model[ j - 3 ][0]->sdata[idx];
+                if( wbd ) {
+                  smf_get_dims( wbd, NULL, NULL, NULL, NULL, &dsize, NULL,
+                                NULL, status );
+                  wbsize += dsize*smf_dtype_size( wbd, status );
+                }
+              }
+            }
+
+            if( wbsize <= wbcap && *status == SAI__OK ) {
+              fflush( NULL );
+              wbpid = fork();
+              if( wbpid == 0 ) {
+                inwriter = 1;
+                signal( SIGINT, SIG_DFL );
+                wf = thrCreateWorkforce( 1, status );
+              } else if( wbpid == -1 ) {
+                wbpid = 0;
+                msgOutf( "", FUNC_NAME ": *** Warning *** unable to create "
+                         "background export process: %s", status,
+                         strerror( errno ) );
+              } else {
+                msgOutiff( MSG__VERB, "", FUNC_NAME ": Exporting model "
+                           "components in the background.", status );
+              }
+            }
+          }
+        }
+
+        if( exportNDF && ((*status == SAI__OK) || (*status == SMF__INSMP)) &&
+            ( wbpid == 0 || inwriter ) ) {
           errBegin( status );
           msgOut(" ", FUNC_NAME ": Export model components to NDF files.",
                  status);
@@ -3580,6 +4209,19 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
                      status, smf_timerupdate(&tv1,&tv2,status) );
 
           errEnd( status );
+
+          /* A background export process reports any error and then
+             exits without touching anything inherited from this
+             process (see the chunk-processing children below). Only
+             the standard streams are flushed, since other streams (e.g.
+             the sampled diagnostics file) belong to this process. */
+          if( inwriter ) {
+            int ok = ( *status == SAI__OK );
+            if( !ok ) errFlush( status );
+            fflush( stdout );
+            fflush( stderr );
+            _exit( ok ? 0 : 1 );
+          }
         }
 
   /* Free the zero masks. */
@@ -3627,38 +4269,42 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
            chunk. */
         chunkweight = smf_chunkweight( res[0]->sdata[0], keymap,
                                        contchunk, status );
+        steptime = res[0]->sdata[0]->hdr->steptime;
 
-        /* on first chunk, copy thismap onto map
-           subsquent chunks get added below */
-        if( contchunk == 0 ) {
-          memcpy( map, thismap, msize*sizeof(*map) );
-          memcpy( weights, thisweight, msize*sizeof(*weights) );
-          memcpy( mapweightsq, thisweightsq, msize*sizeof(*mapweightsq) );
-          memcpy( mapvar, thisvar, msize*sizeof(*mapvar) );
-          memcpy( hitsmap, thishits, msize*sizeof(*hitsmap) );
-          memcpy( mapqual, thisqual, msize*sizeof(*mapqual) );
-        }
-
-        if( ncontchunks > 1 ) {
-          msgOut( " ", FUNC_NAME ": Adding map estimated from this continuous"
-                  " chunk to total", status);
-          smf_addmap1( contchunk, map, mapweights, weights, hitsmap, mapvar,
-                       mapqual, thismap, thisweight, thishits, thisvar, thisqual,
-                       msize, chunkweight, status );
-        }
-
-        /* Add this chunk of exposure time to the total. We assume the array was
-           initialised to zero and will not contain bad values. */
-        if( *status == SAI__OK ) {
-          steptime = res[0]->sdata[0]->hdr->steptime;
-          for (ipix = 0; ipix < msize; ipix++ ) {
-            if ( thishits[ipix] != VAL__BADI) {
-              exp_time[ipix] += chunkweight*steptime * (double)thishits[ipix];
-            }
+        /* A child process returns the map from this chunk to the parent
+           in shared memory, to be added to the total later. */
+        if( ischild ) {
+          if( *status == SAI__OK ) {
+            SmfChunkResult *result = chunkres + contchunk;
+            memcpy( shmap + contchunk*msize, thismap,
+                    msize*sizeof(*shmap) );
+            memcpy( shweight + contchunk*msize, thisweight,
+                    msize*sizeof(*shweight) );
+            memcpy( shweightsq + contchunk*msize, thisweightsq,
+                    msize*sizeof(*shweightsq) );
+            memcpy( shvar + contchunk*msize, thisvar,
+                    msize*sizeof(*shvar) );
+            memcpy( shhits + contchunk*msize, thishits,
+                    msize*sizeof(*shhits) );
+            memcpy( shqual + contchunk*msize, thisqual,
+                    msize*sizeof(*shqual) );
+            result->chunkweight = chunkweight;
+            result->steptime = steptime;
+            one_strlcpy( result->data_units, data_units,
+                         sizeof( result->data_units ), status );
+            one_strlcpy( result->data_label, data_label,
+                         sizeof( result->data_label ), status );
+            result->done = 1;
           }
+
+        /* Otherwise add it to the total now. */
+        } else {
+          smf1_addchunk( contchunk, ncontchunks, msize, chunkweight,
+                         steptime, map, mapweights, weights, mapweightsq,
+                         mapvar, hitsmap, mapqual, exp_time,
+                         &sumchunkweights, thismap, thisweight,
+                         thisweightsq, thisvar, thishits, thisqual, status );
         }
-        /* Update the sum of all chunk weights. */
-        sumchunkweights += chunkweight;
       }
 
     } else {
@@ -3740,10 +4386,156 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
        errFlush( status );
     }
 
+    /* A child process now returns the final map change for the chunk and
+       claims the next one. */
+    if( ischild ) {
+      chunkres[ contchunk ].chunkchange = chunkchange[ contchunk ];
+      if( usempi ) {
+        claimed += nrank;
+      } else {
+        claimed = smf1_claim_chunk( share, status );
+      }
+    }
   }
 
-  /* Normalise the returned exposure times to a mean chunk weight of unity. */
-  if( *status == SAI__OK ) {
+  /* Wait for any background export of model components to complete, and
+     write out any remaining sampled diagnostics. */
+  smf1_wait_writer( &wbpid, status );
+  smf_diag_sample( NULL, NULL, 0, 0, SMF__NUL, NULL, 0, 0, status );
+
+  /* Free the spare arrays kept for re-use by later chunks. */
+  smf_scratch_pool( 0, status );
+
+  /* Free any workforces created for tuned models. */
+  if( tunewf ) {
+    for( ii = 0; ii < wf->nworker; ii++ ) {
+      if( tunewf[ ii ] ) thrDestroyWorkforce( tunewf[ ii ] );
+    }
+    tunewf = astFree( tunewf );
+  }
+
+  /* A child process adds its totals to those in shared memory and then
+     exits. _exit is used so that nothing inherited from the parent (open
+     files, HDS buffers, etc) is flushed or closed. */
+  if( ischild && !usempi ) {
+    int tstatus = SAI__OK;
+
+    thrMutexLock( &share->mutex, &tstatus );
+    share->count_mcnvg += count_mcnvg;
+    share->count_minsmp += count_minsmp;
+    share->ntgood_tot += ntgood_tot;
+    share->nsamples_tot += nsamples_tot;
+    share->totexp += *totexp;
+    if( rate_limited ) share->rate_limited = 1;
+    if( abortedat && *abortedat > share->abortedat ) {
+      share->abortedat = *abortedat;
+    }
+    if( *iters != -1 ) share->iters = *iters;
+    thrMutexUnlock( &share->mutex, &tstatus );
+
+    thrDestroyWorkforce( wf );
+    fflush( NULL );
+    _exit( ( *status == SAI__OK && tstatus == SAI__OK ) ? 0 : 1 );
+  }
+
+#if HAVE_MPI
+  /* MPI processes send the results of their chunks to rank zero, and
+     the totals are summed over all ranks. Every rank must take part,
+     even if an error has occurred. */
+  if( usempi ) {
+    smf1_mpi_collect( mpirank, nrank, ncontchunks, msize, chunkres, shmap,
+                      shweight, shweightsq, shvar, shhits, shqual,
+                      chunkchange, &count_mcnvg, &count_minsmp, &ntgood_tot,
+                      &nsamples_tot, totexp, &rate_limited, abortedat, iters,
+                      status );
+  }
+#endif
+
+  /* The parent process waits for all the child processes to finish, and
+     then adds the map from each successful chunk into the total, in the
+     same order as if they had been processed serially. When using MPI,
+     only rank zero makes the total map. */
+  if( ( nproc > 1 && pids ) || usempi ) {
+    int nmerged = 0;
+    int wstatus;
+
+    for( iproc = 0; iproc < nproc && pids; iproc++ ) {
+      if( pids[ iproc ] > 0 ) {
+        if( waitpid( pids[ iproc ], &wstatus, 0 ) == -1 ||
+            !WIFEXITED( wstatus ) || WEXITSTATUS( wstatus ) != 0 ) {
+          msgOutf( "", FUNC_NAME ": *** Warning *** chunk-processing child "
+                   "process %d did not complete successfully.", status,
+                   iproc + 1 );
+        }
+      }
+    }
+    pids = astFree( pids );
+
+    if( smf_interupt && *status == SAI__OK ) {
+      *status = SAI__ERROR;
+      errRep( "", "Application aborted by an interupt.", status );
+    }
+
+    /* The arrays of combined weights are normally allocated when the
+       first chunk is processed, which the parent has not done. */
+    if( !mapweights ) mapweights = astCalloc( msize, sizeof(*mapweights) );
+    if( !mapweightsq ) mapweightsq = astMalloc( msize*sizeof(*mapweightsq) );
+
+    if( share && nproc > 1 && *status == SAI__OK ) {
+      count_mcnvg += share->count_mcnvg;
+      count_minsmp += share->count_minsmp;
+      ntgood_tot += share->ntgood_tot;
+      nsamples_tot += share->nsamples_tot;
+      *totexp += share->totexp;
+      if( share->rate_limited ) rate_limited = 1;
+      if( abortedat ) *abortedat = share->abortedat;
+      *iters = share->iters;
+    }
+
+    if( share && mpirank == 0 && *status == SAI__OK ) {
+      for( contchunk = 0; contchunk < ncontchunks && *status == SAI__OK;
+           contchunk++ ) {
+        SmfChunkResult *result = chunkres + contchunk;
+        chunkchange[ contchunk ] = result->chunkchange;
+        if( !result->done ) continue;
+
+        /* Check units are consistent, as smf_check_units would have done. */
+        if( nmerged == 0 ) {
+          one_strlcpy( data_units, result->data_units, SMF__CHARLABEL,
+                       status );
+        } else if( strcmp( data_units, result->data_units ) ) {
+          *status = SAI__ERROR;
+          errRepf( "", "Data units inconsistency. Previously got '%s' but "
+                   "chunk %zu had units of '%s'", status, data_units,
+                   (size_t) contchunk + 1, result->data_units );
+        }
+        one_strlcpy( data_label, result->data_label, SMF__CHARLABEL, status );
+        nmerged++;
+
+        msgOutiff( MSG__VERB, "", FUNC_NAME ": Adding map from continuous "
+                   "chunk %zu to total", status, (size_t) contchunk + 1 );
+        smf1_addchunk( contchunk, ncontchunks, msize, result->chunkweight,
+                       result->steptime, map, mapweights, weights,
+                       mapweightsq, mapvar, hitsmap, mapqual, exp_time,
+                       &sumchunkweights, shmap + contchunk*msize,
+                       shweight + contchunk*msize,
+                       shweightsq + contchunk*msize,
+                       shvar + contchunk*msize, shhits + contchunk*msize,
+                       shqual + contchunk*msize, status );
+      }
+
+    }
+
+    if( share ) {
+      pthread_mutex_destroy( &share->mutex );
+      munmap( share, sharesize );
+      share = NULL;
+    }
+  }
+
+  /* Normalise the returned exposure times to a mean chunk weight of unity.
+     No chunks are added into the total by MPI ranks other than zero. */
+  if( *status == SAI__OK && sumchunkweights > 0.0 ) {
     double meanw = sumchunkweights/ncontchunks;
     for (ipix = 0; ipix < msize; ipix++ ) {
        exp_time[ipix] /= meanw;
@@ -3804,6 +4596,14 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
   mapweightsq = astFree( mapweightsq );
   mapweights = astFree( mapweights );
 
+  /* Wait for any outstanding prefetch jobs and close the I/O workforce. */
+  if( iowf ) {
+    int tstatus = SAI__OK;
+    thrWait( iowf, &tstatus );
+    thrDestroyWorkforce( iowf );
+    iowf = NULL;
+  }
+
   modeltyps = astFree( modeltyps );
   dumpdir = astFree( dumpdir );
   exportNDF_which = astFree( exportNDF_which );
@@ -3821,11 +4621,13 @@ void smf_iteratemap( ThrWorkForce *wf, const Grp *igrp, const Grp *iterrootgrp,
   if( epsndf != NDF__NOID ) ndfAnnul( &epsndf, status );
 
   lastmap = astFree( lastmap );
+  accmap = astFree( accmap );
   mapchange = astFree( mapchange );
   job_data = astFree( job_data );
 
-  /* Ensure that FFTW doesn't have any used memory kicking around */
-  fftw_cleanup();
+  /* Ensure that FFTW doesn't have any used memory kicking around,
+     including the plans cached by smf_fftw_plan */
+  smf_fftw_cleanup( status );
 
   /* Report count_minsmp, count_mcnvg, as well as reporting back
      continuous chunk counters to caller */
@@ -3944,3 +4746,202 @@ static void smf1_iteratemap( void *job_data_ptr, int *status ) {
 
 }
 
+
+/* Add the map from a single continuous chunk into the total. */
+static void smf1_addchunk( dim_t contchunk, dim_t ncontchunks, dim_t msize,
+                           double chunkweight, double steptime, double *map,
+                           double *mapweights, double *weights,
+                           double *mapweightsq, double *mapvar, int *hitsmap,
+                           smf_qual_t *mapqual, double *exp_time,
+                           double *sumchunkweights, double *thismap,
+                           double *thisweight, double *thisweightsq,
+                           double *thisvar, int *thishits,
+                           smf_qual_t *thisqual, int *status ){
+  dim_t ipix;
+
+  if( *status != SAI__OK ) return;
+
+  /* on first chunk, copy thismap onto map
+     subsquent chunks get added below */
+  if( contchunk == 0 ) {
+    memcpy( map, thismap, msize*sizeof(*map) );
+    memcpy( weights, thisweight, msize*sizeof(*weights) );
+    memcpy( mapweightsq, thisweightsq, msize*sizeof(*mapweightsq) );
+    memcpy( mapvar, thisvar, msize*sizeof(*mapvar) );
+    memcpy( hitsmap, thishits, msize*sizeof(*hitsmap) );
+    memcpy( mapqual, thisqual, msize*sizeof(*mapqual) );
+  }
+
+  if( ncontchunks > 1 ) {
+    msgOut( " ", FUNC_NAME ": Adding map estimated from this continuous"
+            " chunk to total", status);
+    smf_addmap1( contchunk, map, mapweights, weights, hitsmap, mapvar,
+                 mapqual, thismap, thisweight, thishits, thisvar, thisqual,
+                 msize, chunkweight, status );
+  }
+
+  /* Add this chunk of exposure time to the total. We assume the array was
+     initialised to zero and will not contain bad values. */
+  if( *status == SAI__OK ) {
+    for (ipix = 0; ipix < msize; ipix++ ) {
+      if ( thishits[ipix] != VAL__BADI) {
+        exp_time[ipix] += chunkweight*steptime * (double)thishits[ipix];
+      }
+    }
+  }
+
+  /* Update the sum of all chunk weights. */
+  *sumchunkweights += chunkweight;
+}
+
+/* Claim the next continuous chunk to be processed by a child process.
+   Returns a value at least equal to the number of chunks once all chunks
+   have been claimed. */
+static dim_t smf1_claim_chunk( SmfChunkShare *share, int *status ){
+  dim_t result;
+  int lstatus = SAI__OK;
+
+  thrMutexLock( &share->mutex, &lstatus );
+  result = share->next++;
+  thrMutexUnlock( &share->mutex, &lstatus );
+
+  if( lstatus != SAI__OK && *status == SAI__OK ) *status = lstatus;
+  return result;
+}
+
+/* Wait for a background process that is exporting model components (see
+   SMURF_WRITEBEHIND) to exit, and report an error if it failed. This is
+   done even if an error has already occurred, so that the process is not
+   left running. */
+static void smf1_wait_writer( pid_t *pid, int *status ){
+  int wstatus = 0;
+
+  if( *pid <= 0 ) return;
+
+  if( waitpid( *pid, &wstatus, 0 ) == -1 || !WIFEXITED( wstatus ) ||
+      WEXITSTATUS( wstatus ) != 0 ) {
+    if( *status == SAI__OK ) {
+      *status = SAI__ERROR;
+      errRep( "", FUNC_NAME ": The background export of model components "
+              "failed.", status );
+    }
+  }
+  *pid = 0;
+}
+
+#if HAVE_MPI
+/* Collect the results of the continuous chunks processed by each MPI
+   process. Rank zero receives the result and maps for every chunk
+   processed by another rank, in the shared memory slots that a child
+   process would have used. The totals are summed over all ranks and
+   returned to every rank, so that they all report the same statistics.
+   This is done even if an error has occurred, since otherwise the other
+   ranks would wait for ever. */
+static void smf1_mpi_collect( int mpirank, int nrank, dim_t ncontchunks,
+                              dim_t msize, SmfChunkResult *chunkres,
+                              double *shmap, double *shweight,
+                              double *shweightsq, double *shvar,
+                              int *shhits, smf_qual_t *shqual,
+                              double *chunkchange, size_t *count_mcnvg,
+                              size_t *count_minsmp, size_t *ntgood_tot,
+                              size_t *nsamples_tot, double *totexp,
+                              int *rate_limited, int *abortedat, int *iters,
+                              int *status ){
+  SmfChunkResult *result;
+  dim_t contchunk;
+  dim_t offset;
+  double *changes;
+  double dsum[ 5 ];
+  int imax[ 3 ];
+  int owner;
+  int ret = MPI_SUCCESS;
+
+  for( contchunk = 0; contchunk < ncontchunks; contchunk++ ) {
+    owner = contchunk % nrank;
+    if( owner == 0 ) continue;
+
+    result = chunkres + contchunk;
+    offset = contchunk*msize;
+
+    if( mpirank == owner ) {
+      ret |= MPI_Send( result, sizeof( *result ), MPI_BYTE, 0, 0,
+                       MPI_COMM_WORLD );
+      if( result->done ) {
+        ret |= MPI_Send( shmap + offset, msize, MPI_DOUBLE, 0, 0,
+                         MPI_COMM_WORLD );
+        ret |= MPI_Send( shweight + offset, msize, MPI_DOUBLE, 0, 0,
+                         MPI_COMM_WORLD );
+        ret |= MPI_Send( shweightsq + offset, msize, MPI_DOUBLE, 0, 0,
+                         MPI_COMM_WORLD );
+        ret |= MPI_Send( shvar + offset, msize, MPI_DOUBLE, 0, 0,
+                         MPI_COMM_WORLD );
+        ret |= MPI_Send( shhits + offset, msize, MPI_INT, 0, 0,
+                         MPI_COMM_WORLD );
+        ret |= MPI_Send( shqual + offset, msize, MPI_UNSIGNED_SHORT, 0, 0,
+                         MPI_COMM_WORLD );
+      }
+
+    } else if( mpirank == 0 ) {
+      ret |= MPI_Recv( result, sizeof( *result ), MPI_BYTE, owner, 0,
+                       MPI_COMM_WORLD, MPI_STATUS_IGNORE );
+      if( result->done ) {
+        ret |= MPI_Recv( shmap + offset, msize, MPI_DOUBLE, owner, 0,
+                         MPI_COMM_WORLD, MPI_STATUS_IGNORE );
+        ret |= MPI_Recv( shweight + offset, msize, MPI_DOUBLE, owner, 0,
+                         MPI_COMM_WORLD, MPI_STATUS_IGNORE );
+        ret |= MPI_Recv( shweightsq + offset, msize, MPI_DOUBLE, owner, 0,
+                         MPI_COMM_WORLD, MPI_STATUS_IGNORE );
+        ret |= MPI_Recv( shvar + offset, msize, MPI_DOUBLE, owner, 0,
+                         MPI_COMM_WORLD, MPI_STATUS_IGNORE );
+        ret |= MPI_Recv( shhits + offset, msize, MPI_INT, owner, 0,
+                         MPI_COMM_WORLD, MPI_STATUS_IGNORE );
+        ret |= MPI_Recv( shqual + offset, msize, MPI_UNSIGNED_SHORT, owner,
+                         0, MPI_COMM_WORLD, MPI_STATUS_IGNORE );
+      }
+    }
+  }
+
+  /* Each chunk's final map change is non-zero only in the rank that
+     processed it, so summing them gives the full list on every rank. */
+  changes = astMalloc( ncontchunks*sizeof( *changes ) );
+  if( changes ) {
+    for( contchunk = 0; contchunk < ncontchunks; contchunk++ ) {
+      changes[ contchunk ] = chunkres[ contchunk ].chunkchange;
+    }
+    ret |= MPI_Allreduce( MPI_IN_PLACE, changes, ncontchunks, MPI_DOUBLE,
+                          MPI_SUM, MPI_COMM_WORLD );
+    memcpy( chunkchange, changes, ncontchunks*sizeof( *changes ) );
+    changes = astFree( changes );
+  }
+
+  /* Sum the counts, which are small enough to be held exactly as
+     doubles, and find the largest of the flags. */
+  dsum[ 0 ] = *count_mcnvg;
+  dsum[ 1 ] = *count_minsmp;
+  dsum[ 2 ] = *ntgood_tot;
+  dsum[ 3 ] = *nsamples_tot;
+  dsum[ 4 ] = *totexp;
+  ret |= MPI_Allreduce( MPI_IN_PLACE, dsum, 5, MPI_DOUBLE, MPI_SUM,
+                        MPI_COMM_WORLD );
+  *count_mcnvg = dsum[ 0 ];
+  *count_minsmp = dsum[ 1 ];
+  *ntgood_tot = dsum[ 2 ];
+  *nsamples_tot = dsum[ 3 ];
+  *totexp = dsum[ 4 ];
+
+  imax[ 0 ] = *rate_limited;
+  imax[ 1 ] = abortedat ? *abortedat : 0;
+  imax[ 2 ] = *iters;
+  ret |= MPI_Allreduce( MPI_IN_PLACE, imax, 3, MPI_INT, MPI_MAX,
+                        MPI_COMM_WORLD );
+  *rate_limited = imax[ 0 ];
+  if( abortedat ) *abortedat = imax[ 1 ];
+  *iters = imax[ 2 ];
+
+  if( ret != MPI_SUCCESS && *status == SAI__OK ) {
+    *status = SAI__ERROR;
+    errRep( "", FUNC_NAME ": Failed to collect the results of the "
+            "continuous chunks from the MPI processes.", status );
+  }
+}
+#endif
@@ -14,11 +14,14 @@
 *     C function
 
 *  Invocation:
-*     void smf_jsadicer( int indf, const char *base, int trim,
-*                        smf_inst_t instrument, smf_jsaproj_t proj,
-*                        size_t *ntile, Grp *grp, int *status )
+*     void smf_jsadicer( ThrWorkForce *wf, int indf, const char *base,
+*                        int trim, smf_inst_t instrument,
+*                        smf_jsaproj_t proj, size_t *ntile, Grp *grp,
+*                        int *status )
 
 *  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        Pointer to a pool of worker threads (can be NULL).
 *     indf = int (Given)
 *        An identifier for the NDF to be diced. This may be 2D or 3D. The
 *        NDF is assumed to be gridded on one of the supported JSA all-sky
@@ -61,6 +64,11 @@
 *
 *     The zero-based indices of the created tiles are written to an output
 *     paramater called "JSATILELIST".
+*
+*     The search of each tile for good data values is done in a separate
+*     thread for a batch of tiles at a time. All NDF access (including the
+*     creation of the output NDFs) is done in the calling thread, since
+*     the NDF library is not thread-safe.
 
 *  Authors:
 *     DSB: David S Berry (JAC, Hawaii)
@@ -118,6 +126,11 @@
 *     3-NOV-2015 (DSB):
 *        Ensure the alignment of the input NDF and the JSA grid is not
 *        done using offset coordinates (e.g. planet observations).
+*     14-OCT-2026:
+*        - Added argument "wf". Search batches of tiles for good values
+*        in parallel, and only map the Variance and Quality of tiles that
+*        contain good data.
+*        - Ensure the spectral bounds of 2D tiles are initialised.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -165,10 +178,30 @@ static void smf1_jsadicer( int indfo, int *olbnd, int *oubnd,
                            AstMapping *tile_map, AstFrame *tile_frm,
                            AstMapping *p2pmap, void *ipd, void *ipv,
                            unsigned char *ipq, int *status );
+static void smf1_jsadicer_scan( void *job_data_ptr, int *status );
+
+/* Local data types */
+typedef struct smfJsaDicerTile {
+   AstFrame *tile_frm;
+   AstMapping *p2pmap;
+   AstMapping *tile_map;
+   int index;
+   int lbnd[ 3 ];
+   int ubnd[ 3 ];
+} SmfJsaDicerTile;
+
+typedef struct smfJsaDicerData {
+   const void *ipd;
+   int bbox[ 6 ];
+   int isreal;
+   int lbnd[ 3 ];
+   int ubnd[ 3 ];
+} SmfJsaDicerData;
 
 /* Main entry */
-void smf_jsadicer( int indf, const char *base, int trim, smf_inst_t instrument,
-                   smf_jsaproj_t proj, size_t *ntile, Grp *grp, int *status ){
+void smf_jsadicer( ThrWorkForce *wf, int indf, const char *base, int trim,
+                   smf_inst_t instrument, smf_jsaproj_t proj, size_t *ntile,
+                   Grp *grp, int *status ){
 
 /* Local Variables: */
    AstBox *box;
@@ -184,6 +217,10 @@ void smf_jsadicer( int indf, const char *base, int trim, smf_inst_t instrument,
    AstMapping *tile_map = NULL;
    AstRegion *region;
    Grp *grpt = NULL;
+   SmfJsaDicerData *job_data = NULL;
+   SmfJsaDicerData *pdata;
+   SmfJsaDicerTile *tile;
+   SmfJsaDicerTile *tile_info = NULL;
    char *path;
    char dtype[ NDF__SZFTP + 1 ];
    char jsatile_comment[45];
@@ -192,7 +229,6 @@ void smf_jsadicer( int indf, const char *base, int trim, smf_inst_t instrument,
    const char *keyword;
    const char *latsys = NULL;
    const char *lonsys = NULL;
-   double *pd;
    double dlbnd[3];
    double dubnd[3];
    double gcen[3];
@@ -200,14 +236,15 @@ void smf_jsadicer( int indf, const char *base, int trim, smf_inst_t instrument,
    double lbnd_out[3];
    double ubnd_in[3];
    double ubnd_out[3];
-   float *pf;
    int *created_tiles = NULL;
+   int *sections = NULL;
    int *tiles;
    int axlat;
    int axlon;
    int axspec;
    int bbox[ 6 ];
    int i;
+   int ibatch;
    int ifrm;
    int igrid;
    int indfo;
@@ -218,9 +255,8 @@ void smf_jsadicer( int indf, const char *base, int trim, smf_inst_t instrument,
    int ishpx;
    int isxph;
    int itile;
-   int ix;
-   int iy;
-   int iz;
+   int isreal;
+   int iw;
    int junk;
    int latax = -1;
    int lbnd[3];
@@ -228,11 +264,14 @@ void smf_jsadicer( int indf, const char *base, int trim, smf_inst_t instrument,
    int lbndx[ NDF__MXDIM ];
    int lonax = -1;
    int nbase;
+   int nbatch;
    int ndim;
    int ndimx;
    int nfrm;
+   int nover;
    int nsig;
    int ntiles;
+   int nw;
    int olbnd[ 3 ];
    int oubnd[ 3 ];
    int outperm[ 3 ];
@@ -400,7 +439,13 @@ void smf_jsadicer( int indf, const char *base, int trim, smf_inst_t instrument,
    msgOutf( "", "Dicing %s into JSA tiles:", status,
             ( nsig == 2 ) ? "map" : "cube" );
 
-/* Loop round all tiles that overlap the supplied NDF. */
+/* Allocate room for a description of each tile that overlaps the
+   supplied NDF. */
+   tile_info = astMalloc( ntiles*sizeof( *tile_info ) );
+   nover = 0;
+
+/* Loop round all tiles that touch the supplied NDF, finding the Mappings
+   and the section of the supplied NDF for each one. */
    for( itile = 0; itile < ntiles && *status == SAI__OK; itile++ ) {
       tile_index = tiles[ itile ];
 
@@ -513,9 +558,13 @@ void smf_jsadicer( int indf, const char *base, int trim, smf_inst_t instrument,
                  ubnd_out + 0, NULL, NULL );
       astMapBox( p2pmap, lbnd_in, ubnd_in, 0, 2, lbnd_out + 1,
                  ubnd_out + 1, NULL, NULL );
-      if( ndim == 3 ) astMapBox( p2pmap, lbnd_in, ubnd_in, 0, 3,
-                                 lbnd_out + 2, ubnd_out + 2, NULL,
-                                 NULL );
+      if( ndim == 3 ) {
+         astMapBox( p2pmap, lbnd_in, ubnd_in, 0, 3, lbnd_out + 2,
+                    ubnd_out + 2, NULL, NULL );
+      } else {
+         lbnd_out[ 2 ] = lbnd_in[ 2 ];
+         ubnd_out[ 2 ] = lbnd_in[ 2 ];
+      }
 
 
       lbnd_tile[ 0 ] = floor( lbnd_out[ 0 ] ) + 1;
@@ -541,204 +590,228 @@ void smf_jsadicer( int indf, const char *base, int trim, smf_inst_t instrument,
          if( ubnd_tile[ 2 ] > ubnd[ 2 ] ) ubnd_tile[ 2 ] = ubnd[ 2 ];
       }
 
-/* Check there is some overlap. */
+/* If there is some overlap, store the description of the tile. */
       if( lbnd_tile[ 0 ] <= ubnd_tile[ 0 ] &&
           lbnd_tile[ 1 ] <= ubnd_tile[ 1 ] &&
           lbnd_tile[ 2 ] <= ubnd_tile[ 2 ] ){
+         if( *status == SAI__OK ) {
+            tile = tile_info + nover++;
+            tile->index = tile_index;
+            tile->tile_map = tile_map;
+            tile->tile_frm = tile_frm;
+            tile->p2pmap = p2pmap;
+            for( i = 0; i < 3; i++ ) {
+               tile->lbnd[ i ] = lbnd_tile[ i ];
+               tile->ubnd[ i ] = ubnd_tile[ i ];
+            }
+         }
 
-/* Now need to check if this section of the input NDF contains any good
-   values. We also find the bounding box of the good values (within the
-   input pixel coordinate system). So first obtain and map the required
-   section of the input NDF. */
-         ndfSect( indf, ndim, lbnd_tile, ubnd_tile, &indfs, status );
-         ndfMap( indfs, "Data", type, "Read", &ipd, &junk, status );
-         if( var ) ndfMap( indfs, "Variance", type, "Read", &ipv, &junk, status );
-         if( qual ) ndfMap( indfs, "Quality", "_UBYTE", "Read", (void **) &ipq,
-                            &junk, status );
+      } else {
+         msgOutiff( MSG__DEBUG, "", "   Tile %d does not overlap the input "
+                    "NDF after trimming.", status, tile_index );
+      }
+   }
 
-/* Initialise the pixel bounds (within the input NDF) of the box holding
-   good data values for the current tile. */
-         bbox[ 0 ] = INT_MAX;
-         bbox[ 1 ] = INT_MAX;
-         bbox[ 2 ] = INT_MAX;
-         bbox[ 3 ] = -INT_MAX;
-         bbox[ 4 ] = -INT_MAX;
-         bbox[ 5 ] = -INT_MAX;
+/* Now create the output NDFs. Checking each section of the input NDF
+   for good values can be slow, so this is done in separate threads for
+   a batch of tiles at a time. The NDF library is not thread-safe, so the
+   sections are obtained and mapped, and the output NDFs created, in
+   this thread. */
+   nw = wf ? wf->nworker : 1;
+   job_data = astCalloc( nw, sizeof( *job_data ) );
+   sections = astMalloc( nw*sizeof( *sections ) );
+   isreal = !strcmp( type, "_REAL" );
 
-/* Loop round all pixels in the section. */
-         if( *status == SAI__OK ) {
-            if( !strcmp( type, "_REAL" ) ) {
-               pf = (float *) ipd;
-               for( iz = lbnd_tile[ 2 ]; iz <= ubnd_tile[ 2 ]; iz++ ) {
-                  for( iy = lbnd_tile[ 1 ]; iy <= ubnd_tile[ 1 ]; iy++ ) {
-                     for( ix = lbnd_tile[ 0 ]; ix <= ubnd_tile[ 0 ]; ix++ ) {
-                        if( *(pf++) != VAL__BADR ) {
-                           if( ix < bbox[ 0 ] ) bbox[ 0 ] = ix;
-                           if( iy < bbox[ 1 ] ) bbox[ 1 ] = iy;
-                           if( iz < bbox[ 2 ] ) bbox[ 2 ] = iz;
-                           if( ix > bbox[ 3 ] ) bbox[ 3 ] = ix;
-                           if( iy > bbox[ 4 ] ) bbox[ 4 ] = iy;
-                           if( iz > bbox[ 5 ] ) bbox[ 5 ] = iz;
-                        }
-                     }
-                  }
-               }
-            } else {
-               pd = (double *) ipd;
-               for( iz = lbnd_tile[ 2 ]; iz <= ubnd_tile[ 2 ]; iz++ ) {
-                  for( iy = lbnd_tile[ 1 ]; iy <= ubnd_tile[ 1 ]; iy++ ) {
-                     for( ix = lbnd_tile[ 0 ]; ix <= ubnd_tile[ 0 ]; ix++ ) {
-                        if( *(pd++) != VAL__BADD ) {
-                           if( ix < bbox[ 0 ] ) bbox[ 0 ] = ix;
-                           if( iy < bbox[ 1 ] ) bbox[ 1 ] = iy;
-                           if( iz < bbox[ 2 ] ) bbox[ 2 ] = iz;
-                           if( ix > bbox[ 3 ] ) bbox[ 3 ] = ix;
-                           if( iy > bbox[ 4 ] ) bbox[ 4 ] = iy;
-                           if( iz > bbox[ 5 ] ) bbox[ 5 ] = iz;
-                        }
-                     }
-                  }
-               }
-            }
+   for( ibatch = 0; ibatch < nover && *status == SAI__OK; ibatch += nw ) {
+      nbatch = nover - ibatch;
+      if( nbatch > nw ) nbatch = nw;
+
+/* Obtain and map the required section of the input NDF for each tile in
+   the batch. */
+      for( iw = 0; iw < nbatch; iw++ ) sections[ iw ] = NDF__NOID;
+      for( iw = 0; iw < nbatch && *status == SAI__OK; iw++ ) {
+         tile = tile_info + ibatch + iw;
+         pdata = job_data + iw;
+         ndfSect( indf, ndim, tile->lbnd, tile->ubnd, sections + iw, status );
+         ndfMap( sections[ iw ], "Data", type, "Read", &ipd, &junk, status );
+         pdata->ipd = ipd;
+         pdata->isreal = isreal;
+         for( i = 0; i < 3; i++ ) {
+            pdata->lbnd[ i ] = tile->lbnd[ i ];
+            pdata->ubnd[ i ] = tile->ubnd[ i ];
+         }
+      }
+
+/* Find the bounding box of the good values in each section. */
+      if( *status == SAI__OK ) {
+         for( iw = 0; iw < nbatch; iw++ ) {
+            pdata = job_data + iw;
+            thrAddJob( wf, 0, pdata, smf1_jsadicer_scan, 0, NULL, status );
+         }
+         thrWait( wf, status );
+      }
+
+/* Create the output NDF for each non-empty tile in the batch, in the
+   original order. */
+      for( iw = 0; iw < nbatch && *status == SAI__OK; iw++ ) {
+         tile = tile_info + ibatch + iw;
+         pdata = job_data + iw;
+         tile_index = tile->index;
+         tile_map = tile->tile_map;
+         tile_frm = tile->tile_frm;
+         p2pmap = tile->p2pmap;
+         for( i = 0; i < 3; i++ ) {
+            lbnd_tile[ i ] = tile->lbnd[ i ];
+            ubnd_tile[ i ] = tile->ubnd[ i ];
+            bbox[ i ] = pdata->bbox[ i ];
+            bbox[ i + 3 ] = pdata->bbox[ i + 3 ];
+         }
+         indfs = sections[ iw ];
+         ipd = (void *) pdata->ipd;
 
 /* Skip empty tiles. */
-            if( bbox[ 0 ] != INT_MAX ) {
-               msgOutf( "", "   tile %d", status, tile_index );
+         if( bbox[ 0 ] != INT_MAX ) {
+            msgOutf( "", "   tile %d", status, tile_index );
+
+/* Map the Variance and Quality arrays of the input section. */
+            if( var ) ndfMap( indfs, "Variance", type, "Read", &ipv, &junk, status );
+            if( qual ) ndfMap( indfs, "Quality", "_UBYTE", "Read", (void **) &ipq,
+                               &junk, status );
 
 /* If required, trim the bounds to the edges of the bounding box. */
-               if( trim >= 2 ) {
-                  olbnd[ 0 ] = bbox[ 0 ];
-                  olbnd[ 1 ] = bbox[ 1 ];
-                  olbnd[ 2 ] = bbox[ 2 ];
-                  oubnd[ 0 ] = bbox[ 3 ];
-                  oubnd[ 1 ] = bbox[ 4 ];
-                  oubnd[ 2 ] = bbox[ 5 ];
-               } else {
-                  olbnd[ 0 ] = lbnd_tile[ 0 ];
-                  olbnd[ 1 ] = lbnd_tile[ 1 ];
-                  olbnd[ 2 ] = lbnd_tile[ 2 ];
-                  oubnd[ 0 ] = ubnd_tile[ 0 ];
-                  oubnd[ 1 ] = ubnd_tile[ 1 ];
-                  oubnd[ 2 ] = ubnd_tile[ 2 ];
-               }
+            if( trim >= 2 ) {
+               olbnd[ 0 ] = bbox[ 0 ];
+               olbnd[ 1 ] = bbox[ 1 ];
+               olbnd[ 2 ] = bbox[ 2 ];
+               oubnd[ 0 ] = bbox[ 3 ];
+               oubnd[ 1 ] = bbox[ 4 ];
+               oubnd[ 2 ] = bbox[ 5 ];
+            } else {
+               olbnd[ 0 ] = lbnd_tile[ 0 ];
+               olbnd[ 1 ] = lbnd_tile[ 1 ];
+               olbnd[ 2 ] = lbnd_tile[ 2 ];
+               oubnd[ 0 ] = ubnd_tile[ 0 ];
+               oubnd[ 1 ] = ubnd_tile[ 1 ];
+               oubnd[ 2 ] = ubnd_tile[ 2 ];
+            }
 
 /* Modify these pixel bounds so that they refer to the output NDF. */
-               lbnd_in[ 0 ] = olbnd[ 0 ] - 0.5;
-               lbnd_in[ 1 ] = olbnd[ 1 ] - 0.5;
-               lbnd_in[ 2 ] = olbnd[ 2 ] - 0.5;
-               ubnd_in[ 0 ] = oubnd[ 0 ] - 0.5;
-               ubnd_in[ 1 ] = oubnd[ 1 ] - 0.5;
-               ubnd_in[ 2 ] = oubnd[ 2 ] - 0.5;
-
-               astMapBox( p2pmap, lbnd_in, ubnd_in, 1, 1, lbnd_out + 0,
-                          ubnd_out + 0, NULL, NULL );
-               astMapBox( p2pmap, lbnd_in, ubnd_in, 1, 2, lbnd_out + 1,
-                          ubnd_out + 1, NULL, NULL );
-               if( ndim == 3 ) astMapBox( p2pmap, lbnd_in, ubnd_in, 1, 3,
-                                          lbnd_out + 2, ubnd_out + 2, NULL,
-                                          NULL );
-
-               olbnd[ 0 ] = floor( lbnd_out[ 0 ] ) + 1;
-               olbnd[ 1 ] = floor( lbnd_out[ 1 ] ) + 1;
-               olbnd[ 2 ] = floor( lbnd_out[ 2 ] ) + 1;
-               oubnd[ 0 ] = floor( ubnd_out[ 0 ] ) + 1;
-               oubnd[ 1 ] = floor( ubnd_out[ 1 ] ) + 1;
-               oubnd[ 2 ] = floor( ubnd_out[ 2 ] ) + 1;
+            lbnd_in[ 0 ] = olbnd[ 0 ] - 0.5;
+            lbnd_in[ 1 ] = olbnd[ 1 ] - 0.5;
+            lbnd_in[ 2 ] = olbnd[ 2 ] - 0.5;
+            ubnd_in[ 0 ] = oubnd[ 0 ] - 0.5;
+            ubnd_in[ 1 ] = oubnd[ 1 ] - 0.5;
+            ubnd_in[ 2 ] = oubnd[ 2 ] - 0.5;
+
+            astMapBox( p2pmap, lbnd_in, ubnd_in, 1, 1, lbnd_out + 0,
+                       ubnd_out + 0, NULL, NULL );
+            astMapBox( p2pmap, lbnd_in, ubnd_in, 1, 2, lbnd_out + 1,
+                       ubnd_out + 1, NULL, NULL );
+            if( ndim == 3 ) astMapBox( p2pmap, lbnd_in, ubnd_in, 1, 3,
+                                       lbnd_out + 2, ubnd_out + 2, NULL,
+                                       NULL );
+
+            olbnd[ 0 ] = floor( lbnd_out[ 0 ] ) + 1;
+            olbnd[ 1 ] = floor( lbnd_out[ 1 ] ) + 1;
+            olbnd[ 2 ] = floor( lbnd_out[ 2 ] ) + 1;
+            oubnd[ 0 ] = floor( ubnd_out[ 0 ] ) + 1;
+            oubnd[ 1 ] = floor( ubnd_out[ 1 ] ) + 1;
+            oubnd[ 2 ] = floor( ubnd_out[ 2 ] ) + 1;
 
 /* Get the full path to the output NDF for the current tile, and create an
-   NDF placeholder for it. */
-               sprintf( path, "%.*s_%d", nbase, base, tile_index );
-               ndfPlace( NULL, path, &place, status );
+NDF placeholder for it. */
+            sprintf( path, "%.*s_%d", nbase, base, tile_index );
+            ndfPlace( NULL, path, &place, status );
 
 /* Create a new output NDF by copying the meta-data from the input NDF
-   section. */
-               ndfScopy( indfs, "Units", &place, &indfo, status );
+section. */
+            ndfScopy( indfs, "Units", &place, &indfo, status );
 
 /* Set the pixel bounds of the output NDF to the values found above and copy
-   the input data for the current tile into it. */
-               smf1_jsadicer( indfo, olbnd, oubnd, tile_map, tile_frm, p2pmap,
-                              ipd, ipv, ipq, status );
+the input data for the current tile into it. */
+            smf1_jsadicer( indfo, olbnd, oubnd, tile_map, tile_frm, p2pmap,
+                           ipd, ipv, ipq, status );
 
 /* Add the name of this output NDF to the group holding the names of the
-   output NDFs that have actually been created. */
-               if( grp ) grpPut1( grp, path, 0, status );
+output NDFs that have actually been created. */
+            if( grp ) grpPut1( grp, path, 0, status );
 
 /* Add a TILENUM header to the output FITS extension. */
-               kpgGtfts( indfo, &fc, status );
-               if( *status == KPG__NOFTS ) {
-                  errAnnul( status );
-                  fc = astFitsChan( NULL, NULL, " " );
+            kpgGtfts( indfo, &fc, status );
+            if( *status == KPG__NOFTS ) {
+               errAnnul( status );
+               fc = astFitsChan( NULL, NULL, " " );
 
 /* If the last card is "END", remove it. */
-               } else {
-                  astSetI( fc, "Card", astGetI( fc, "NCARD" ) );
-                  keyword = astGetC( fc, "CardName" );
-                  if( keyword && !strcmp( keyword, "END" ) ) astDelFits( fc );
-               }
+            } else {
+               astSetI( fc, "Card", astGetI( fc, "NCARD" ) );
+               keyword = astGetC( fc, "CardName" );
+               if( keyword && !strcmp( keyword, "END" ) ) astDelFits( fc );
+            }
 
-               one_snprintf(jsatile_comment, 45, "JSA all-sky tile index (Nside=%i)",
-                            status, tiling.ntpf);
-               atlPtfti( fc, "TILENUM", tile_index, jsatile_comment, status );
-               kpgPtfts( indfo, fc, status );
-               fc = astAnnul( fc );
+            one_snprintf(jsatile_comment, 45, "JSA all-sky tile index (Nside=%i)",
+                         status, tiling.ntpf);
+            atlPtfti( fc, "TILENUM", tile_index, jsatile_comment, status );
+            kpgPtfts( indfo, fc, status );
+            fc = astAnnul( fc );
 
 /* Now store an STC-S polygon that describes the shortest boundary
-   enclosing the good data in the output NDF, and store it as an NDF extension. */
-               kpgPutOutline( indfo, 0.5, 1, status );
+enclosing the good data in the output NDF, and store it as an NDF extension. */
+            kpgPutOutline( indfo, 0.5, 1, status );
 
 /* We now reshape any extension NDFs contained within the output NDF to
-   have the same spatial bounds as the main NDF (but only for extension
-   NDFs that originally have the same spatial bounds as the supplied NDF).
-   Get a group containing paths to all extension NDFs in the output NDF. */
-               ndgMoreg( indfo, &grpt, &size, status );
+have the same spatial bounds as the main NDF (but only for extension
+NDFs that originally have the same spatial bounds as the supplied NDF).
+Get a group containing paths to all extension NDFs in the output NDF. */
+            ndgMoreg( indfo, &grpt, &size, status );
 
 /* Loop round each output extension NDF. */
-               for( iext = 1; iext <= size && *status == SAI__OK; iext++ ) {
-                  ndgNdfas( grpt, iext, "Update", &indfx, status );
+            for( iext = 1; iext <= size && *status == SAI__OK; iext++ ) {
+               ndgNdfas( grpt, iext, "Update", &indfx, status );
 
 /* Get its bounds. */
-                  ndfBound( indfx, NDF__MXDIM, lbndx, ubndx, &ndimx, status );
+               ndfBound( indfx, NDF__MXDIM, lbndx, ubndx, &ndimx, status );
 
 /* See if this extension NDF has the same bounds on the spatial axes as
-   the supplied NDF. */
-                  if( ndimx > 1 && lbndx[ lonax ] == lbnd[ lonax ] &&
-                                   lbndx[ latax ] == lbnd[ latax ] &&
-                                   ubndx[ lonax ] == ubnd[ lonax ] &&
-                                   ubndx[ latax ] == ubnd[ latax ] ) {
+the supplied NDF. */
+               if( ndimx > 1 && lbndx[ lonax ] == lbnd[ lonax ] &&
+                                lbndx[ latax ] == lbnd[ latax ] &&
+                                ubndx[ lonax ] == ubnd[ lonax ] &&
+                                ubndx[ latax ] == ubnd[ latax ] ) {
 
 /* If so, change the bounds of the output extension NDF so that they are
-   the same as the main NDF on the spatial axes, and map the original
-   contents of the NDF onto the new pixel grid. */
-                     smf1_jsadicer( indfx, olbnd, oubnd, tile_map, tile_frm, p2pmap,
-                                    NULL, NULL, NULL, status );
-                  }
+the same as the main NDF on the spatial axes, and map the original
+contents of the NDF onto the new pixel grid. */
+                  smf1_jsadicer( indfx, olbnd, oubnd, tile_map, tile_frm, p2pmap,
+                                 NULL, NULL, NULL, status );
+               }
 
 /* Annul the extension NDF identifier. */
-                  ndfAnnul( &indfx, status );
-               }
+               ndfAnnul( &indfx, status );
+            }
 
 /* Free resources associated with the current tile. */
-               grpDelet( &grpt, status );
-               ndfAnnul( &indfo, status );
+            grpDelet( &grpt, status );
+            ndfAnnul( &indfo, status );
 
 /* Issue warnings about empty tiles. */
-            } else {
-               msgOutiff( MSG__VERB, "", "   tile %d is empty and so will not be "
-                          "created", status, tile_index );
-            }
+         } else {
+            msgOutiff( MSG__VERB, "", "   tile %d is empty and so will not be "
+                       "created", status, tile_index );
          }
 
 /* Free the section of the input NDF. */
-         ndfAnnul( &indfs, status );
+         ndfAnnul( sections + iw, status );
 
 /* Append the index of this tile in the list of tiles to be created. */
          created_tiles = astGrow( created_tiles, ++(*ntile),
                                   sizeof( *created_tiles ) );
          if( *status == SAI__OK ) created_tiles[ *ntile - 1 ] = tile_index;
+      }
 
-      } else {
-         msgOutiff( MSG__DEBUG, "", "   Tile %d does not overlap the input "
-                    "NDF after trimming.", status, tile_index );
+/* Free any sections left over after an error. */
+      for( iw = 0; iw < nbatch; iw++ ) {
+         if( sections[ iw ] != NDF__NOID ) ndfAnnul( sections + iw, status );
       }
    }
    msgBlank( status );
@@ -748,6 +821,9 @@ void smf_jsadicer( int indf, const char *base, int trim, smf_inst_t instrument,
 
 /* Free resources. */
    created_tiles = astFree( created_tiles );
+   job_data = astFree( job_data );
+   sections = astFree( sections );
+   tile_info = astFree( tile_info );
    tiles = astFree( tiles );
    path = astFree( path );
 
@@ -994,3 +1070,87 @@ static void smf1_jsadicer( int indfo, int *olbnd, int *oubnd,
    astEnd;
 }
 
+
+
+static void smf1_jsadicer_scan( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_jsadicer_scan
+
+*  Purpose:
+*     Executed in a worker thread to find the bounding box of the good
+*     values in one tile for smf_jsadicer.
+
+*  Invocation:
+*     smf1_jsadicer_scan( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = SmfJsaDicerData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+/* Local Variables: */
+   SmfJsaDicerData *pdata;
+   const double *pd;
+   const float *pf;
+   int *bbox;
+   int ix;
+   int iy;
+   int iz;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Get a pointer that can be used for accessing the required items in the
+   supplied structure. */
+   pdata = (SmfJsaDicerData *) job_data_ptr;
+
+/* Initialise the pixel bounds (within the input NDF) of the box holding
+   good data values for the tile. */
+   bbox = pdata->bbox;
+   bbox[ 0 ] = INT_MAX;
+   bbox[ 1 ] = INT_MAX;
+   bbox[ 2 ] = INT_MAX;
+   bbox[ 3 ] = -INT_MAX;
+   bbox[ 4 ] = -INT_MAX;
+   bbox[ 5 ] = -INT_MAX;
+
+/* Loop round all pixels in the section. */
+   if( pdata->isreal ) {
+      pf = (const float *) pdata->ipd;
+      for( iz = pdata->lbnd[ 2 ]; iz <= pdata->ubnd[ 2 ]; iz++ ) {
+         for( iy = pdata->lbnd[ 1 ]; iy <= pdata->ubnd[ 1 ]; iy++ ) {
+            for( ix = pdata->lbnd[ 0 ]; ix <= pdata->ubnd[ 0 ]; ix++ ) {
+               if( *(pf++) != VAL__BADR ) {
+                  if( ix < bbox[ 0 ] ) bbox[ 0 ] = ix;
+                  if( iy < bbox[ 1 ] ) bbox[ 1 ] = iy;
+                  if( iz < bbox[ 2 ] ) bbox[ 2 ] = iz;
+                  if( ix > bbox[ 3 ] ) bbox[ 3 ] = ix;
+                  if( iy > bbox[ 4 ] ) bbox[ 4 ] = iy;
+                  if( iz > bbox[ 5 ] ) bbox[ 5 ] = iz;
+               }
+            }
+         }
+      }
+   } else {
+      pd = (const double *) pdata->ipd;
+      for( iz = pdata->lbnd[ 2 ]; iz <= pdata->ubnd[ 2 ]; iz++ ) {
+         for( iy = pdata->lbnd[ 1 ]; iy <= pdata->ubnd[ 1 ]; iy++ ) {
+            for( ix = pdata->lbnd[ 0 ]; ix <= pdata->ubnd[ 0 ]; ix++ ) {
+               if( *(pd++) != VAL__BADD ) {
+                  if( ix < bbox[ 0 ] ) bbox[ 0 ] = ix;
+                  if( iy < bbox[ 1 ] ) bbox[ 1 ] = iy;
+                  if( iz < bbox[ 2 ] ) bbox[ 2 ] = iz;
+                  if( ix > bbox[ 3 ] ) bbox[ 3 ] = ix;
+                  if( iy > bbox[ 4 ] ) bbox[ 4 ] = iy;
+                  if( iz > bbox[ 5 ] ) bbox[ 5 ] = iz;
+               }
+            }
+         }
+      }
+   }
+}
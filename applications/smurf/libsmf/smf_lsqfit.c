@@ -137,10 +137,14 @@
 *     Adapted for SMURF
 *   2012-04-10 (TIMJ):
 *        Use const and stop using unnecessary pointers.
+*   2026-10-14:
+*        Get the function value and derivatives in a single call in
+*        getmat.
 
 *  Copyright:
 *     Copyright (C) 2010,2012 Science and Technology Facilities Council.
 *     Copyright (c) Kapteyn Laboratorium Groningen 1990
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 
@@ -326,10 +330,17 @@ static void getmat( smf_math_function fid ,
    for (n = 0; n < ndat; n++) {		/* loop trough data points */
       wn = wdat[n];
       if (wn > 0.0) {				/* legal weight ? */
+#if defined (TESTBED)
 	yd = ydat[n] - smf_math_fvalue( fid, xdat[xdim * n], fpar, ncomp,
 				      iopt, dopt );
 	 smf_math_fpderv( fid, xdat[xdim * n], fpar, ncomp, epar,
 			  iopt, dopt );
+#else
+	 double fv;				/* value and derivatives ... */
+	 smf_math_functions( fid, xdat[xdim * n], fpar, ncomp, &fv,
+			     epar, NULL, iopt, dopt );	/* in one pass */
+	 yd = ydat[n] - fv;
+#endif
          lsq->chi2 += yd * yd * wn;		/* add to chi-squared */
          for (j = 0; j < lsq->nfree; j++) {
             wd = epar[lsq->parptr[j]] * wn;	/* weighted derivative */
@@ -0,0 +1,255 @@
+/*
+*+
+*  Name:
+*     smf_lutcache_name
+
+*  Purpose:
+*     Get the name of the file in which a pointing LUT is cached.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     int smf_lutcache_name( smfData *data, AstFrameSet *outfset,
+*                            int moving, int *lbnd_out, int *ubnd_out,
+*                            int tstep, double steptol, fts2Port fts_port,
+*                            char *filename, size_t szfname, int *status )
+
+*  Arguments:
+*     data = smfData * (Given)
+*        The time-series data for which the LUT is required.
+*     outfset = AstFrameSet * (Given)
+*        Frameset containing the sky->output map mapping.
+*     moving = int (Given)
+*        Is coordinate system tracking moving object?
+*     lbnd_out = int * (Given)
+*        2-element array pixel coord. for the lower bounds of the output map.
+*     ubnd_out = int * (Given)
+*        2-element array pixel coord. for the upper bounds of the output map.
+*     tstep = int (Given)
+*        Time slices between full Mapping calculations.
+*     steptol = double (Given)
+*        The tolerance for interpolated bolometer positions, in
+*        arc-seconds (see smf_coords_lut).
+*     fts_port = fts2Port (Given)
+*        FTS-2 port.
+*     filename = char * (Returned)
+*        The path of the cache file. Not changed if zero is returned.
+*     szfname = size_t (Given)
+*        The length of the "filename" buffer.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     Non-zero if a cache file name was returned, and zero if no LUT
+*     cache is in use.
+
+*  Description:
+*     If the SMURF_LUTCACHE environment variable is set to the name of a
+*     directory, pointing LUTs created by smf_calc_mapcoord are stored
+*     in files within that directory, so that they can be re-used when
+*     the same data is mapped onto the same output grid again. The
+*     directory may be shared by several users and processes.
+*
+*     The file name is formed from the observation and subarray, followed
+*     by a 64-bit hash of everything that determines the LUT: the FITS
+*     headers, the pointing values in the JCMTSTATE of every time slice,
+*     the focal plane and tracking positions of the detectors, a dump of
+*     the output WCS (which includes the pixel size and projection), the
+*     output map bounds and the other arguments. A LUT is therefore only
+*     re-used if it would be computed from identical inputs.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+#include "star/one.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+#define FUNC_NAME "smf_lutcache_name"
+
+/* Prototypes for local functions */
+static uint64_t smf1_hash( uint64_t hash, const void *pntr, size_t nbytes );
+static uint64_t smf1_hash_string( uint64_t hash, const char *text );
+
+int smf_lutcache_name( smfData *data, AstFrameSet *outfset, int moving,
+                       int *lbnd_out, int *ubnd_out, int tstep,
+                       double steptol, fts2Port fts_port, char *filename,
+                       size_t szfname, int *status ){
+
+/* Local Variables: */
+   char *dump;
+   char *p;
+   char obsidss[ SZFITSTR ];
+   char subarray[ 9 ];
+   const JCMTState *state;
+   const char *dir;
+   dim_t itime;
+   dim_t nbolo;
+   dim_t ntslice;
+   int fport;
+   int result = 0;
+   smfHead *hdr;
+   uint64_t hash;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return result;
+
+/* Check a cache directory has been specified. */
+   dir = getenv( SMF__LUTCACHE );
+   if( !dir || !dir[ 0 ] ) return result;
+
+   hdr = data->hdr;
+   if( !hdr || !hdr->allState ) return result;
+
+   smf_get_dims( data, NULL, NULL, &nbolo, &ntslice, NULL, NULL, NULL,
+                 status );
+
+/* Hash the arguments and dimensions. The string identifying the cache
+   file format is included so that files written in a different format
+   are never matched. */
+   hash = UINT64_C( 14695981039346656037 );
+   hash = smf1_hash_string( hash, SMF__LUTCACHE_MAGIC );
+   hash = smf1_hash( hash, &nbolo, sizeof( nbolo ) );
+   hash = smf1_hash( hash, &ntslice, sizeof( ntslice ) );
+   hash = smf1_hash( hash, &moving, sizeof( moving ) );
+   hash = smf1_hash( hash, &tstep, sizeof( tstep ) );
+   hash = smf1_hash( hash, &steptol, sizeof( steptol ) );
+   fport = fts_port;
+   hash = smf1_hash( hash, &fport, sizeof( fport ) );
+   hash = smf1_hash( hash, lbnd_out, 2*sizeof( *lbnd_out ) );
+   hash = smf1_hash( hash, ubnd_out, 2*sizeof( *ubnd_out ) );
+
+/* The output WCS. */
+   dump = astToString( outfset );
+   hash = smf1_hash_string( hash, dump );
+   dump = astFree( dump );
+
+/* The FITS headers. */
+   if( hdr->fitshdr ) {
+      dump = astToString( hdr->fitshdr );
+      hash = smf1_hash_string( hash, dump );
+      dump = astFree( dump );
+   }
+
+/* The detector positions. */
+   hash = smf1_hash( hash, &hdr->ndet, sizeof( hdr->ndet ) );
+   hash = smf1_hash( hash, &hdr->dpazel, sizeof( hdr->dpazel ) );
+   hash = smf1_hash( hash, hdr->instap, sizeof( hdr->instap ) );
+   hash = smf1_hash( hash, hdr->telpos, sizeof( hdr->telpos ) );
+   if( hdr->fplanex ) hash = smf1_hash( hash, hdr->fplanex,
+                                        hdr->ndet*sizeof( *hdr->fplanex ) );
+   if( hdr->fplaney ) hash = smf1_hash( hash, hdr->fplaney,
+                                        hdr->ndet*sizeof( *hdr->fplaney ) );
+   if( hdr->detpos ) hash = smf1_hash( hash, hdr->detpos,
+                                       2*nbolo*ntslice*sizeof( *hdr->detpos ) );
+
+/* The pointing values at each time slice. Individual fields are used
+   (rather than the whole struct) to avoid hashing any padding or unused
+   string elements. */
+   for( itime = 0; itime < ntslice; itime++ ) {
+      state = hdr->allState + itime;
+      hash = smf1_hash( hash, &state->rts_end, sizeof( state->rts_end ) );
+      hash = smf1_hash( hash, &state->tcs_tai, sizeof( state->tcs_tai ) );
+      hash = smf1_hash( hash, &state->tcs_az_ac1, sizeof( double ) );
+      hash = smf1_hash( hash, &state->tcs_az_ac2, sizeof( double ) );
+      hash = smf1_hash( hash, &state->tcs_az_bc1, sizeof( double ) );
+      hash = smf1_hash( hash, &state->tcs_az_bc2, sizeof( double ) );
+      hash = smf1_hash( hash, &state->tcs_az_ang, sizeof( double ) );
+      hash = smf1_hash( hash, &state->tcs_tr_ac1, sizeof( double ) );
+      hash = smf1_hash( hash, &state->tcs_tr_ac2, sizeof( double ) );
+      hash = smf1_hash( hash, &state->tcs_tr_bc1, sizeof( double ) );
+      hash = smf1_hash( hash, &state->tcs_tr_bc2, sizeof( double ) );
+      hash = smf1_hash( hash, &state->tcs_tr_ang, sizeof( double ) );
+      hash = smf1_hash( hash, &state->smu_az_jig_x, sizeof( double ) );
+      hash = smf1_hash( hash, &state->smu_az_jig_y, sizeof( double ) );
+      hash = smf1_hash( hash, &state->smu_az_chop_x, sizeof( double ) );
+      hash = smf1_hash( hash, &state->smu_az_chop_y, sizeof( double ) );
+      hash = smf1_hash( hash, &state->jos_drcontrol,
+                        sizeof( state->jos_drcontrol ) );
+      hash = smf1_hash_string( hash, state->tcs_tr_sys );
+   }
+
+/* Form the file name, replacing any characters in the observation
+   identifier that would cause problems in a file name. */
+   if( *status == SAI__OK ) {
+      one_strlcpy( obsidss, hdr->obsidss[ 0 ] ? hdr->obsidss : "unknown",
+                   sizeof( obsidss ), status );
+      for( p = obsidss; *p; p++ ) {
+         if( *p == '/' || *p == ' ' ) *p = '_';
+      }
+
+      smf_find_subarray( hdr, subarray, sizeof( subarray ), NULL, status );
+      if( *status != SAI__OK ) {
+         errAnnul( status );
+         one_strlcpy( subarray, "none", sizeof( subarray ), status );
+      }
+
+      if( snprintf( filename, szfname, "%s/%s_%s_%016" PRIx64 ".lut", dir,
+                    obsidss, subarray, hash ) >= (int) szfname ) {
+         *status = SAI__ERROR;
+         errRepf( "", FUNC_NAME ": LUT cache directory name '%s' is too "
+                  "long.", status, dir );
+      } else {
+         result = 1;
+      }
+   }
+
+   return result;
+}
+
+/* Update a 64-bit FNV-1a hash with a block of memory. */
+static uint64_t smf1_hash( uint64_t hash, const void *pntr, size_t nbytes ){
+   const unsigned char *p = pntr;
+   const unsigned char *pend = p + nbytes;
+
+   while( p < pend ) {
+      hash ^= *(p++);
+      hash *= UINT64_C( 1099511628211 );
+   }
+   return hash;
+}
+
+/* Update a hash with a null-terminated string (including the
+   terminator, so that consecutive strings are kept distinct). */
+static uint64_t smf1_hash_string( uint64_t hash, const char *text ){
+   if( !text ) text = "";
+   return smf1_hash( hash, text, strlen( text ) + 1 );
+}
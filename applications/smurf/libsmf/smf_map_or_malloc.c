@@ -37,7 +37,10 @@
 
 *  Description:
 *     Helper routine that will call ndfMap if supplied with an NDF identifier
-*     or else call astCalloc to get the memory. If ndfMap is used status
+*     or else call smf_scratch_malloc to get the memory (which uses a
+*     memory-mapped scratch file for large arrays if SMURF_SCRATCHDIR
+*     is set). Such memory should be freed using smf_scratch_free. If
+*     ndfMap is used status
 *     will be set to bad if the number of mapped points are fewer than
 *     that requested in the call. The NDF will not be resized, it is assumed
 *     that this routine is being used to obtain a variance or quality
@@ -107,11 +110,8 @@ void * smf_map_or_malloc (size_t nelem, smf_dtype type, int zero, int indf,
 
   /* just malloc if we do not have a file */
   if ( indf == NDF__NOID) {
-     if( zero ) {
-       return astCalloc( nelem, smf_dtype_sz(type, status) );
-     } else {
-       return astMalloc( nelem*smf_dtype_sz(type, status) );
-     }
+     return smf_scratch_malloc( NULL, nelem*smf_dtype_sz(type, status), zero,
+                                status );
   }
 
   ndfMap( indf, comp, smf_dtype_str(type, status),
@@ -155,7 +155,7 @@ void smf_mask_noisy( ThrWorkForce *wf, smfData *data, AstKeyMap *kmap,
   } else {
      smf_bolonoise( wf, data, -1.0, 0, 0.5, SMF__F_WHITELO,
                     SMF__F_WHITEHI, 0, zeropad ? SMF__MAXAPLEN : SMF__BADSZT,
-                    (noisemap->pntr)[0], NULL, NULL, status );
+                    0, (noisemap->pntr)[0], NULL, NULL, status );
   }
 
   /* Now need to convert this to noise by square rooting */
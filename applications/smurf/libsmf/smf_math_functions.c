@@ -183,10 +183,15 @@
 *        Use const and stop using unnecessary pointers.
 *     2012-04-11 (TIMJ):
 *        Use an enum for fid values.
+*     2026-10-14:
+*        Return the function value from the derivative routines of the
+*        peak functions when both are requested, so that the exponentials
+*        are evaluated only once per point.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2010, 2012 Science and Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     Copyright (C) Kapteyn Laboratorium Groningen 2001
 *     All Rights Reserved.
 
@@ -238,22 +243,22 @@
 
 /* Gaussian */
 static double gauss( double  X, const double fpar[], int ncomp, const int iopt[]);
-static void gaussderv( double  X, const double fpar[], double *epar, int ncomp,
+static void gaussderv( double  X, const double fpar[], double *epar, double *value, int ncomp,
 		       const int iopt[]);
 
 /* Gaussian-Hermite "1" */
 static double gausshermiteh3( double  X, const double fpar[], int ncomp, const int iopt[]);
-static void gausshermiteh3derv( double  X, const double fpar[], double *epar,
+static void gausshermiteh3derv( double  X, const double fpar[], double *epar, double *value,
                                 int ncomp, const int iopt[]);
 
 /* Gaussian-Hermite "2" */
 static double gausshermiteh3h4( double  X, const double fpar[], int ncomp,
 				const int iopt[]);
-static void gausshermiteh3h4derv( double  X, const double fpar[], double *epar,
+static void gausshermiteh3h4derv( double  X, const double fpar[], double *epar, double *value,
 				  int ncomp, const int iopt[]);
 /* Voigt */
 static double voigt( double  X, const double fpar[], int ncomp, const int iopt[]);
-static void   voigtderv( double  X, const double fpar[], double *epar, int ncomp,
+static void   voigtderv( double  X, const double fpar[], double *epar, double *value, int ncomp,
 			 const int iopt[]);
 
 /* Polynomial */
@@ -286,6 +291,7 @@ void smf_math_functions( smf_math_function fid,
 {
   double   X;
   int      nopt;
+  int      fused;
 
   if ( xdat != VAL__BADD ) {
     X = xdat;
@@ -320,7 +326,14 @@ void smf_math_functions( smf_math_function fid,
 
   }
 
-  if ( value != NULL ) {
+  /* The derivative routines of the peak functions can return the
+     function value as a by-product, which saves a second evaluation
+     of the exponentials (or complex error function) of every component
+     when both are requested, as they are for each point by smf_lsqfit. */
+  fused = ( value != NULL && pderv != NULL &&
+            fid != SMF__MATH_POLYNOMIAL && fid != SMF__MATH_HISTOGRAM );
+
+  if ( value != NULL && !fused ) {
 
     if (fid == SMF__MATH_GAUSSHERMITE1)
       *value = gausshermiteh3( X, fpar, ncomp, iopt );
@@ -340,19 +353,21 @@ void smf_math_functions( smf_math_function fid,
 
   if ( pderv != NULL ) {
 
+    if ( !fused ) value = NULL;
+
     if (fid == SMF__MATH_GAUSSHERMITE1)
-      gausshermiteh3derv( X, fpar, pderv, ncomp, iopt );
+      gausshermiteh3derv( X, fpar, pderv, value, ncomp, iopt );
     else if (fid == SMF__MATH_GAUSSHERMITE2)
-      gausshermiteh3h4derv( X, fpar, pderv, ncomp, iopt );
+      gausshermiteh3h4derv( X, fpar, pderv, value, ncomp, iopt );
     else if (fid == SMF__MATH_VOIGT)
-      voigtderv( X, fpar, pderv, ncomp, iopt );
+      voigtderv( X, fpar, pderv, value, ncomp, iopt );
     else if (fid == SMF__MATH_POLYNOMIAL)
       polyderv( X, pderv, ncomp );
     else if (fid == SMF__MATH_HISTOGRAM)
       histderv( X, fpar, pderv, ncomp );
     else
       /* default to GAUSS */
-      gaussderv( X, fpar, pderv, ncomp, iopt );
+      gaussderv( X, fpar, pderv, value, ncomp, iopt );
   }
 
 }
@@ -427,6 +442,7 @@ static double gauss( double  X,
 static void gaussderv( double  X,
                        const double fpar[],
                        double *epar,
+                       double *value,
                        int     ncomp,
 		       const int iopt[] )
 /*------------------------------------------------------------*/
@@ -453,10 +469,13 @@ static void gaussderv( double  X,
 /* D[F,z0] =  1                                               */
 /* D[F,z1] =  (x-x0)                                          */
 /* D[F,z2] =  (x-x0)^2                                        */
+/*                                                            */
+/* If value is not NULL, F(x) is returned in it as well.      */
 /*------------------------------------------------------------*/
 {
    int      i;
    double   A, X0, X_X0=0.0, s;
+   double   result = 0.0;
    int      npar = 3;                  /* 3 components for 1 Gauss */
 
    int nfunc = 1;
@@ -488,6 +507,7 @@ static void gaussderv( double  X,
            epar[0+offset] = E;               /* Derivative wrt. Amplitude A */
   	   epar[1+offset] = AEX_X0/s/s;         /* Derv. wrt Center Xc */
 	   epar[2+offset] = AEX_X0*X_X0/s/s/s;  /* Derv. wrt. dispersion */
+	   result += A * E;
 	}
       }
 
@@ -498,8 +518,13 @@ static void gaussderv( double  X,
      epar[nfunc*npar+0] = 1.0;
      epar[nfunc*npar+1] = X_X0;
      epar[nfunc*npar+2] = X_X0*X_X0;
+     result += fpar[nfunc*npar+0] + fpar[nfunc*npar+1]*X_X0 +
+               fpar[nfunc*npar+2]*X_X0*X_X0;
    }
 
+   /* Function value, if requested */
+   if ( value != NULL ) *value = result;
+
 }
 
 
@@ -574,14 +599,17 @@ static double gausshermiteh3( double  X,
 static void gausshermiteh3derv( double  X,
                                 const double fpar[],
                                 double *epar,
+                                double *value,
                                 int     ncomp,
 				const int iopt[] )
 /*------------------------------------------------------------*/
 /* PURPOSE: Calculate the derivatives for a skewed gauss at X */
+/* and, if value is not NULL, the function value.             */
 /*------------------------------------------------------------*/
 {
    int     i;
    int     npar = 4;               /* 4 parameters per component */
+   double  result = 0.0;
    double  c1 = -sqrt(3.0);
    double  c3 = 2.0*sqrt(3.0)/3.0;
    double  X_X0 = 0.0;
@@ -628,6 +656,9 @@ static void gausshermiteh3derv( double  X,
 
 	    /*  Diff h3 */
 	    epar[3+i*npar] = A*E*Q;
+
+	    /* Same expression as gausshermiteh3 */
+	    result += A * ( E * ( 1.0 + h3 * F * (c1 + c3*F*F) ) );
 	 }
       }
 
@@ -637,7 +668,12 @@ static void gausshermiteh3derv( double  X,
      epar[nfunc*npar+0] = 1.0;
      epar[nfunc*npar+1] = X_X0;
      epar[nfunc*npar+2] = X_X0*X_X0;
+     result += fpar[nfunc*npar+0] + fpar[nfunc*npar+1]*X_X0 +
+               fpar[nfunc*npar+2]*X_X0*X_X0;
    }
+
+   /* Function value, if requested */
+   if ( value != NULL ) *value = result;
 }
 
 
@@ -718,14 +754,17 @@ double gausshermiteh3h4( double  X,
 static void gausshermiteh3h4derv( double  X,
                                 const double fpar[],
                                 double   *epar,
+                                double   *value,
 				  int     ncomp,
 				  const int iopt[] )
 /*------------------------------------------------------------*/
 /* PURPOSE: Calculate the derivatives for a skewed gauss at X */
+/* and, if value is not NULL, the function value.             */
 /*------------------------------------------------------------*/
 {
    int     i;
    int     npar = 5;               /* 5 parameters per component */
+   double  result = 0.0;
    double  X_X0 = 0.0;
    double  c0 = sqrt(6.0)/4.0;
    double  c1 = -sqrt(3.0);
@@ -784,6 +823,10 @@ static void gausshermiteh3h4derv( double  X,
 
 	    /*  Diff h4 */
 	    epar[4+i*npar] = A*E*Q4;
+
+	    /* Same expression as gausshermiteh3h4 */
+	    result += A * ( E * ( 1.0 + h3*F*(c3*F*F+c1) +
+                                  h4*(c0+F*F*(c2+c4*F*F)) ) );
 	 }
       }
    }
@@ -793,8 +836,13 @@ static void gausshermiteh3h4derv( double  X,
      epar[nfunc*npar+0] = 1.0;
      epar[nfunc*npar+1] = X_X0;
      epar[nfunc*npar+2] = X_X0*X_X0;
+     result += fpar[nfunc*npar+0] + fpar[nfunc*npar+1]*X_X0 +
+               fpar[nfunc*npar+2]*X_X0*X_X0;
    }
 
+   /* Function value, if requested */
+   if ( value != NULL ) *value = result;
+
 }
 
 static double voigt( double  X,
@@ -872,14 +920,17 @@ static double voigt( double  X,
 static void   voigtderv( double  X,
                          const double fpar[],
                          double *epar,
+                         double *value,
                          int     ncomp,
 			 const int iopt[] )
 /*------------------------------------------------------------*/
-/* PURPOSE: Calculate Voigt derivatives at X.                 */
+/* PURPOSE: Calculate Voigt derivatives at X and, if value   */
+/* is not NULL, the function value.                           */
 /*------------------------------------------------------------*/
 {
    int      npar = 4;                            /* Per component */
    int      i;
+   double   result = 0.0;
    double   x, y;
    double   sqln2 = sqrt( log(2.0) );
    double   X_X0 = 0.0;
@@ -925,6 +976,8 @@ static void   voigtderv( double  X,
          epar[2+offset] = (-ampfct/aD) *
                           (Rew + x*dxVoigt+ y*dyVoigt);      /* Doppler factor    */
          epar[3+offset] = ampfct * (sqln2/aD) * dyVoigt;     /* Lorentz factor    */
+
+         result += ampfct * Rew;
       }
    }
 
@@ -933,8 +986,13 @@ static void   voigtderv( double  X,
      epar[nfunc*npar+0] = 1.0;
      epar[nfunc*npar+1] = X_X0;
      epar[nfunc*npar+2] = X_X0*X_X0;
+     result += fpar[nfunc*npar+0] + fpar[nfunc*npar+1]*X_X0 +
+               fpar[nfunc*npar+2]*X_X0*X_X0;
    }
 
+   /* Function value, if requested */
+   if ( value != NULL ) *value = result;
+
 }
 
 
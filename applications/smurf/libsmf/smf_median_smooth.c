@@ -67,10 +67,11 @@
 *     data values in each filter box.
 *
 *     The method attempts to be efficient in that it avoids sorting the
-*     list of values in the filter box for every output value. Instead, it
-*     modifies the filter box for the previous output value - which is
-*     known already to be sorted - by removing the oldest value in the box
-*     and inserting a new value value at the correct place in the list.
+*     list of values in the filter box for every output value. Instead,
+*     the filter box is maintained using smf_runfilt_init etc., which
+*     allow the oldest value to be removed and a new value added in a
+*     time proportional to the log of the box size (median filters), or
+*     in a constant time on average (minimum and maximum filters).
 
 *  Authors:
 *     David S Berry (JAC, Hawaii)
@@ -94,6 +95,14 @@
 *        needed.
 *     22-NOV-2013 (DSB):
 *        Ensure the box is no larger than the size of the array.
+*     14-OCT-2026:
+*        Replace the sorted box (which needs a sort of the first box and
+*        an O(box) shuffle for every output value) with a double heap for
+*        median filters and a monotonic queue for minimum and maximum
+*        filters.
+*     14-OCT-2026:
+*        Move the filter box code into smf_runfilt.c so that it can be
+*        shared with other routines.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -130,37 +139,25 @@
 /* SMURF includes */
 #include "libsmf/smf.h"
 
-/* Other includes */
-#include <gsl/gsl_sort.h>
-
 void smf_median_smooth( dim_t box, smf_filt_t filter_type, float wlim,
                         dim_t el, const double *dat, const smf_qual_t *qua,
                         size_t stride, smf_qual_t mask, double *out,
                         double *w1, size_t *w2, int *w3, int *status ){
 
 /* Local Variables: */
+   smfRunFilt rf;              /* Contents of the filter box */
    const double *pdat;         /* Pointer to next bolo data value */
    const smf_qual_t *pqua;     /* Pointer to next quality flag */
+   dim_t ibox;                 /* Index within box */
    dim_t ihi;                  /* Upper limit for which median can be found */
-   dim_t inbox;                /* No. of values currently in the box */
-   dim_t iold;                 /* Index of oldest value in "w2" */
+   dim_t iold;                 /* Index of oldest value in the box */
    dim_t iout;                 /* Index within out array */
-   dim_t jhi;                  /* Index of last element in search box */
-   dim_t jlo;                  /* Index of first element in search box */
-   dim_t jtest;                /* Index of element at centre of search box */
    dim_t minin;                /* Min no of valid i/p values for a valid o/p value */
-   dim_t off;                  /* Vector index of ne wvalue */
+   dim_t off;                  /* Vector index of new value */
    double *pout;               /* Pointer to next output median value */
-   double *pw1;                /* Pointer to next sorted data value */
    double dnew;                /* Data value being added into the filter box */
    double outval;              /* Main output filter value */
-   int ibox;                   /* Index within box */
-   int jbox;                   /* Index within box */
-   int newi;                   /* Index within "w1" at which to store new value */
    int offset;                 /* Offset from next new value to central value */
-   int oldi;                   /* Index within "w1" of the old value */
-   size_t *perm;               /* Initial permutation array */
-   size_t *pw2;                /* Pointer to next sorted data index */
 
 /* Check inherited status */
    if( *status != SAI__OK ) return;
@@ -180,6 +177,7 @@ void smf_median_smooth( dim_t box, smf_filt_t filter_type, float wlim,
       *status = SAI__ERROR;
       errRep( " ", "smf_median_smooth: Box is zero.", status );
    }
+   if( *status != SAI__OK ) return;
 
 /* Limit the box to the size of the data array. */
    if( box > el ) box = el;
@@ -197,62 +195,26 @@ void smf_median_smooth( dim_t box, smf_filt_t filter_type, float wlim,
       minin = 0;
    }
 
-/* Initialise the number of good values in the initial filter box. */
-   inbox = 0;
-
-/* Get an index that sorts the first "box" data values into ascending
-   order. This includes bad values, and flagged values. Returned "perm"
-   values are in the range 0 to "box". */
-   perm = astMalloc( box*sizeof( *perm ) );
-   if( *status == SAI__OK ) {
-      gsl_sort_index( perm, dat, stride, (size_t) box );
-
-/* Loop round each element in the first filter box. */
-      for( ibox = 0; ibox < (int) box; ibox++ ) {
-
-/* Get the vector index of the i'th largest value in the filter box
-   (which may be a bad or flagged value since GSL does not recognise
-   these). */
-         jbox = perm[ ibox ];
-         off = stride*jbox;
-
-/* Get the value. Use bad if the element is flagged. */
-         if( !qua || !( qua[ off ] & mask ) ) {
-            dnew = dat[ off ];
-         } else {
-            dnew = VAL__BADD;
-         }
-
-/* If the value is not bad, store at the next free element of the w1 array.
-   Also, store its original index (i.e. its index within the box) in "w2",
-   and store the inverse look-up in "w3". That is, "w2" gives box index
-   as a function of sorted index, and "w3" gives sorted index as a
-   function of box index. */
-         if( dnew != VAL__BADD ) {
-            w1[ inbox ] = dnew;
-            w2[ inbox ] = jbox;
-            w3[ jbox ] = inbox;
-            inbox++;
-         } else {
-            w3[ jbox ] = -1;
-         }
+/* Initialise the description of the filter box, using the supplied work
+   arrays. */
+   smf_runfilt_init( &rf, filter_type, box, w1, w2, w3, status );
+   if( *status != SAI__OK ) return;
 
+/* Add each element of the first filter box into the box. Use bad if the
+   element is flagged. */
+   for( ibox = 0; ibox < box; ibox++ ) {
+      off = stride*ibox;
+      if( !qua || !( qua[ off ] & mask ) ) {
+         dnew = dat[ off ];
+      } else {
+         dnew = VAL__BADD;
       }
-
-/* Free the perm array since we will not be sorting explicitly again. */
-      perm = astFree( perm );
+      smf_runfilt_add( &rf, ibox, dnew, status );
    }
 
 /* Initialise the box index of the oldest value in the filter box. */
    iold = 0;
 
-/* If there are any bad data values, pad out the w1 array with bad
-   values, and w2 array with -1 values. */
-   for( ibox = inbox; ibox < (int) box; ibox++ ) {
-      w1[ ibox ] = VAL__BADD;
-      w2[ ibox ] = -1;
-   }
-
 /* Fill the first half-box of the output array with bad values. */
    ihi = box/2;
    pout = out;
@@ -279,28 +241,18 @@ void smf_median_smooth( dim_t box, smf_filt_t filter_type, float wlim,
    even number of good values, use the mean of the two central values as
    the median value. If the box contains insufficient good values use
    VAL__BADD. If the central input value is bad, use VAL__BADD. */
-      if( inbox == 0 ) {
+      if( rf.inbox == 0 ) {
          outval = VAL__BADD;
 
       } else if( minin == 0 && ( pdat[ offset ] == VAL__BADD ||
                           ( qua && ( pqua[ offset ] & mask ) ) ) ){
          outval = VAL__BADD;
 
-      } else if( inbox < minin ) {
+      } else if( rf.inbox < minin ) {
          outval = VAL__BADD;
 
-      } else if( filter_type == SMF__FILT_MIN ) {
-         outval = w1[ 0 ];
-
-      } else if( filter_type == SMF__FILT_MAX ) {
-         outval = w1[ inbox - 1 ];
-
-      } else if( inbox % 2 == 1 ) {
-         outval = w1[ inbox/2 ];
-
       } else {
-         ibox = inbox/2;
-         outval = 0.5*( w1[ ibox ] + w1[ ibox - 1 ] );
+         outval = smf_runfilt_value( &rf, 1, status );
       }
 
       *(pout++) = outval;
@@ -311,137 +263,13 @@ void smf_median_smooth( dim_t box, smf_filt_t filter_type, float wlim,
       dnew = *pdat;
       if( qua && ( *pqua & mask ) ) dnew = VAL__BADD;
 
-/* Find the index at which the new value should be stored within the
-   sorted filter box (w1). If the new value is bad, we do not put it into
-   the filter box. Just store a new index of -1 to indicate this. */
-      if( dnew == VAL__BADD ) {
-         newi = -1;
+/* Remove the oldest value from the filter box and store the new value
+   in its place. */
+      smf_runfilt_remove( &rf, iold, status );
+      smf_runfilt_add( &rf, iold, dnew, status );
 
-/* If the new value is larger than the largest value currently in the
-   filter box, it goes at the end of w1. */
-      } else if( inbox == 0 || dnew >= w1[ inbox - 1 ] ) {
-         newi = inbox;
-
-/* If the new value is smaller than the smallest value currently in the
-   filter box, it goes at the start of w1. */
-      } else if( dnew <= w1[ 0 ] ) {
-         newi = 0;
-
-/* Otherwise do a binary chop on the values in the "w2" array in order to
-   find the index at which the new value should be stored. */
-      } else {
-
-/* Initialise index of the first element that is still within the search
-   range. */
-         jlo = 0;
-
-/* Initialise index of the last element that is still within the search
-   range. */
-         jhi = inbox - 1;
-
-/* Loop until the search range contains only a single element. */
-         while( jhi - jlo > 1 ) {
-
-/* Get the index of the mid value to test. */
-            jtest = ( jlo + jhi ) /2;
-
-/* If the mid value in the current search range is greater than or equal
-   to the new value, the new value must lie in the lower half (including
-   the test point itself in the upper half). Restrict the search range
-   to the lower half. */
-            if( w1[ jtest ] >= dnew ) {
-               jhi = jtest;
-
-/* If the mid value in the current search range is less than the new
-   value, the new value must lie in the upper half. Restrict the search range
-   to the upper half. */
-            } else {
-               jlo = jtest;
-            }
-         }
-
-/* The new value goes in in front of the "jhi" value. */
-         newi = jhi;
-      }
-
-/* Get the index within w1/w2 of the oldest value in the filter box. */
-      oldi = w3[ iold ];
-
-/* If the new value being added into the box is good... */
-      if( newi >= 0 ) {
-
-/* If the old value being removed from the box is good... */
-         if( oldi >= 0 ) {
-
-/* If the value being removed is larger than the value being added, we
-   need to shunt the intermediate values up, over-writing the old value,
-   to make room for the new value. */
-            if( oldi > newi ) {
-               pw1 = w1 + oldi - 1;
-               pw2 = w2 + oldi - 1;
-               for( ibox = oldi; ibox > newi; ibox--,pw1--,pw2--) {
-                  pw1[ 1 ] = *pw1;
-                  w3[ ( pw2[ 1 ] = *pw2 ) ] = ibox;
-               }
-
-/* If the value being removed is smaller than the value being added, we
-   need to shunt the intermediate values down, over-writing the old value,
-   to make room for the new value. */
-            } else if( newi > oldi ) {
-               newi--;
-               pw1 = w1 + oldi;
-               pw2 = w2 + oldi;
-               for( ibox = oldi; ibox < newi; ibox++,pw1++,pw2++ ) {
-                  *pw1 = pw1[ 1 ];
-                  w3[ ( *pw2 = pw2[ 1 ] ) ] = ibox;
-               }
-            }
-
-/* Then store the new value, and its associated indices. */
-            w1[ newi ] = dnew;
-            w2[ newi ] = iold;
-            w3[ iold ] = newi;
-
-/* If the new value is good but the old value is bad, shunt the higher
-   values up to open up a slot for the new value. */
-         } else {
-            for( ibox = inbox; ibox > newi; ibox-- ) {
-               w1[ ibox ] = w1[ ibox - 1 ];
-               w2[ ibox ] = w2[ ibox - 1 ];
-               w3[ w2[ ibox ] ] = ibox;
-            }
-
-/* Then store the new value, and its associated indices. */
-            w1[ newi ] = dnew;
-            w2[ newi ] = iold;
-            w3[ iold ] = newi;
-
-/* Increment the number of good values in the filter box. */
-            inbox++;
-         }
-
-/* If the new value is bad but the old value is good, shunt the higher
-   values down to over-write the old value. */
-      } else if( oldi >= 0 ) {
-         for( ibox = oldi + 1; ibox < (int) inbox; ibox++ ) {
-            w1[ ibox - 1 ] = w1[ ibox ];
-            w2[ ibox - 1 ] = w2[ ibox ];
-            w3[ w2[ ibox - 1 ] ] = ibox - 1;
-         }
-
-/* Decrement the number of good values in the filter box. */
-         inbox--;
-
-/* Then store the new value, and its associated indices. */
-         w1[ inbox ] = dnew;
-         w2[ inbox ] = -1;
-         w3[ iold ] = -1;
-
-/* If the new value is bad but the old value is also bad, do nothing. */
-      }
-
-/* Increment the index of the oldest element int he filter box. If we hit
-   the end of the "w3" array, start again at the beginning. */
+/* Increment the index of the oldest element in the filter box. If we hit
+   the end of the box, start again at the beginning. */
       if( ++iold == box ) iold = 0;
 
 /* Increment the pointers. */
@@ -453,4 +281,3 @@ void smf_median_smooth( dim_t box, smf_filt_t filter_type, float wlim,
    for( ; iout < el; iout++ ) *(pout++) = VAL__BADD;
 
 }
-
@@ -0,0 +1,188 @@
+/*
+*+
+*  Name:
+*     smf_model_autotune
+
+*  Purpose:
+*     Choose the number of threads used to calculate a DIMM model
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     result = smf_model_autotune( ThrWorkForce *wf, ThrWorkForce **wfs,
+*                                  smfModelTune *tune, int start,
+*                                  const char *name, int *status )
+
+*  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        The full workforce.
+*     wfs = ThrWorkForce ** (Given and Returned)
+*        An array with "wf->nworker + 1" elements, initialised to NULL by
+*        the caller, in which element "n" is used to cache a workforce
+*        with "n" workers. Workforces are created as needed, and should
+*        be destroyed by the caller using thrDestroyWorkforce (except for
+*        element "wf->nworker", which is always "wf" itself).
+*     tune = smfModelTune * (Given and Returned)
+*        The tuning state for the model, initialised to zeros by the
+*        caller before the first call.
+*     start = int (Given)
+*        Non-zero if the model is about to be calculated, in which case
+*        the workforce to use is returned. Zero if the model has just
+*        been calculated, in which case the time taken is used to update
+*        the tuning state and NULL is returned.
+*     name = const char * (Given)
+*        The model name, used in messages.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     result = ThrWorkForce *
+*        The workforce to be used to calculate the model (if "start" is
+*        non-zero). This is "wf" if the model is to use all the threads.
+
+*  Description:
+*     Some DIMM models (for instance those that spend much of their time
+*     in small jobs or in serial code) do not benefit from using all the
+*     available threads. This function is called by smf_iteratemap
+*     before and after each calculation of a model, if the environment
+*     variable SMURF_AUTOTUNE is set to a non-zero value, in order to
+*     find the smallest number of threads with which the model runs
+*     nearly as fast as it does using the full workforce.
+*
+*     The model is first timed using all the threads. The number of
+*     threads is then halved on each subsequent calculation for as long
+*     as the time taken is no more than SMF__AUTOTUNE_TOL times the time
+*     taken using all the threads. As soon as that is exceeded, the
+*     previous number of threads is adopted for the rest of the run.
+*     Since each model divides its work into one block per thread,
+*     this also chooses the block size used by the model. Threads that
+*     are not needed by a model are left free for other work, such as
+*     reading the next chunk in the background.
+
+*  Notes:
+*     - Each model should be timed with similar amounts of work on each
+*     call, so the first iteration (which often includes extra
+*     initialisation) should not be tuned.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     2026-10-14:
+*        Original version.
+*     {enter_further_changes_here}
+
+*     - Keyword names are compared without regard to case.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     2026-10-14:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+#include <sys/time.h>
+
+#include "sae_par.h"
+#include "mers.h"
+#include "star/thr.h"
+
+/* SMURF includes */
+#include "smf.h"
+#include "smf_typ.h"
+
+#define FUNC_NAME "smf_model_autotune"
+
+ThrWorkForce *smf_model_autotune( ThrWorkForce *wf, ThrWorkForce **wfs,
+                                  smfModelTune *tune, int start,
+                                  const char *name, int *status ) {
+
+/* Local Variables */
+  double elapsed;            /* Time taken to calculate the model */
+  int nthread;               /* Number of threads to use */
+  struct timeval tv;         /* Current time */
+
+/* Check inherited status. */
+  if( *status != SAI__OK || !wf ) return start ? wf : NULL;
+
+  gettimeofday( &tv, NULL );
+
+/* If the model is about to be calculated, note the time and return the
+   workforce holding the current number of threads, creating it if
+   necessary. */
+  if( start ) {
+    if( tune->nthread == 0 ) tune->nthread = wf->nworker;
+    tune->start = tv.tv_sec + 1.0E-6*tv.tv_usec;
+
+    nthread = tune->nthread;
+    if( nthread >= wf->nworker ) return wf;
+
+    if( !wfs[ nthread ] ) wfs[ nthread ] = thrCreateWorkforce( nthread,
+                                                                status );
+    return ( *status == SAI__OK ) ? wfs[ nthread ] : wf;
+  }
+
+/* Otherwise, do nothing more once the number of threads has been
+   chosen. */
+  if( tune->done || tune->nthread == 0 ) return NULL;
+  elapsed = tv.tv_sec + 1.0E-6*tv.tv_usec - tune->start;
+
+/* Record the time taken with all threads. */
+  if( tune->fulltime == 0.0 ) {
+    tune->fulltime = elapsed;
+    tune->lastthread = tune->nthread;
+
+/* If the time taken with fewer threads is still acceptable, try fewer
+   still. Otherwise, revert to the previous number. */
+  } else if( elapsed <= SMF__AUTOTUNE_TOL*tune->fulltime ) {
+    tune->lastthread = tune->nthread;
+  } else {
+    tune->nthread = tune->lastthread;
+    tune->done = 1;
+  }
+
+  if( !tune->done ) {
+    if( tune->nthread > 1 ) {
+      tune->nthread /= 2;
+    } else {
+      tune->done = 1;
+    }
+  }
+
+  if( tune->done ) {
+    msgOutiff( MSG__VERB, "", FUNC_NAME ": model %s will use %d of %d "
+               "threads.", status, name, tune->nthread, wf->nworker );
+  }
+
+  return NULL;
+}
@@ -314,6 +314,7 @@ void smf_model_create( ThrWorkForce *wf, const smfGroup *igroup,
   char *ename = NULL;           /* Name of file to import */
   const char *tempstr = NULL;   /* Temporary string pointer */
   smf_extmeth extmeth;          /* method of extinction correction */
+  double *extdata=NULL;         /* Double precision EXT correction factors */
   int flag=0;                   /* Flag */
   char fname_grpex[GRP__SZNAM+1];/* String for holding filename grpex */
   dim_t gain_box=0;             /* No. of time slices in a block */
@@ -719,7 +720,7 @@ void smf_model_create( ThrWorkForce *wf, const smfGroup *igroup,
             break;
 
           case SMF__EXT: /* Extinction correction - gain for each bolo/time */
-            head.data.dtype = SMF__DOUBLE;
+            head.data.dtype = smf_model_dtype( mtype, status );
             head.data.ndims = 3;
             for( k=0; k<3; k++ ) {
               head.data.dims[k] = (idata->dims)[k];
@@ -820,7 +821,7 @@ void smf_model_create( ThrWorkForce *wf, const smfGroup *igroup,
             /* We will use a frequency domain filter to remove noise, but
                store what we removed with a time-domain representation for
                easy visualization. */
-            head.data.dtype = SMF__DOUBLE;
+            head.data.dtype = smf_model_dtype( mtype, status );
             head.data.ndims = 3;
             for( k=0; k<3; k++ ) {
               head.data.dims[k] = (idata->dims)[k];
@@ -1030,12 +1031,14 @@ void smf_model_create( ThrWorkForce *wf, const smfGroup *igroup,
           is_initialised = 0;
 
           /* Use calloc to allocate memory. It's much faster than malloc+memset
-             for very large blocks so we initialise here rather than later. */
-          if( init_mem ) {
-             dataptr = astCalloc( datalen, 1 );
-          } else {
-             dataptr = astMalloc( datalen );
-          }
+             for very large blocks so we initialise here rather than later.
+             If the worker threads are bound to CPUs, thrMallocLocal
+             spreads the pages between the NUMA nodes used by the
+             workers, so do this even if we are about to copy data into
+             the buffer. This is all handled by smf_scratch_malloc,
+             which instead uses a memory-mapped scratch file if
+             SMURF_SCRATCHDIR is set. */
+          dataptr = smf_scratch_malloc( wf, datalen, init_mem, status );
           is_initialised = init_mem;
 
           /* Initialize the data buffer */
@@ -1115,7 +1118,7 @@ void smf_model_create( ThrWorkForce *wf, const smfGroup *igroup,
                   if( idata && idata->pntr[0] ) {
                     smf_bolonoise( wf, idata, -1.0, 0, 0.5, SMF__F_WHITELO,
                                    SMF__F_WHITEHI, 0, zeropad ? SMF__MAXAPLEN : SMF__BADSZT,
-                                   dataptr, NULL, NULL, status );
+                                   0, dataptr, NULL, NULL, status );
                   } else {
                     *status = SAI__ERROR;
                     errRep(FUNC_NAME,
@@ -1153,6 +1156,17 @@ void smf_model_create( ThrWorkForce *wf, const smfGroup *igroup,
               tau = VAL__BADD;
               astMapGet0A( keymap, "EXT", &kmap );
 
+              /* If the model is stored in single precision, calculate the
+                 correction factors in a temporary double precision array
+                 and convert them afterwards. */
+              smf_get_dims( &(head.data), NULL, NULL, NULL, NULL, &ndata,
+                            NULL, NULL, status );
+              if( head.data.dtype == SMF__FLOAT ) {
+                extdata = astMalloc( ndata*sizeof( *extdata ) );
+              } else {
+                extdata = dataptr;
+              }
+
               /* Use sub-keymap containing EXT parameters */
               smf_get_extpar( kmap, &tausrc, &extmeth, &import, status );
 
@@ -1164,8 +1178,8 @@ void smf_model_create( ThrWorkForce *wf, const smfGroup *igroup,
                  ename = astAppendString( ename, &nc, "_ext" );
                  msgOutiff( MSG__VERB, "", FUNC_NAME ": using external EXT "
                            "model imported from '%s'.", status, ename );
-                 smf_import_array( wf, idata, dumpdir, ename, 2, 1, idata->dtype,
-                                   dataptr, status );
+                 smf_import_array( wf, idata, dumpdir, ename, 2, 1, SMF__DOUBLE,
+                                   extdata, status );
                  ename = astFree( ename );
 
               /* If calculating new EXT values here... */
@@ -1198,7 +1212,7 @@ void smf_model_create( ThrWorkForce *wf, const smfGroup *igroup,
 
                  thetausrc = tausrc; /* So we modify a different variable */
                  int allquick = smf_correct_extinction( wf, idata, &thetausrc, extmeth, kmap, tau,
-                                                  (double *) dataptr, &wvmtaucache, status );
+                                                  extdata, &wvmtaucache, status );
 
                  /* Store the tau source that was used in an ADAM parameter. Note that we update the
                     parameter each time the model is created so only the most recent value is
@@ -1222,6 +1236,18 @@ void smf_model_create( ThrWorkForce *wf, const smfGroup *igroup,
               }
               kmap = astAnnul( kmap );
 
+              /* Store single precision correction factors. */
+              if( head.data.dtype == SMF__FLOAT ) {
+                if( *status == SAI__OK ) {
+                  float *pf = dataptr;
+                  for( l=0; l<ndata; l++ ) {
+                    pf[ l ] = ( extdata[ l ] == VAL__BADD ) ? VAL__BADR :
+                                                  (float) extdata[ l ];
+                  }
+                }
+                extdata = astFree( extdata );
+              }
+
             } else if( mtype == SMF__DKS ) {
               int replacebad;
 
@@ -1271,7 +1297,7 @@ void smf_model_create( ThrWorkForce *wf, const smfGroup *igroup,
                  head.data so that its pntr[0] temporarily points to the
                  model data array. */
               head.data.pntr[0] = dataptr;
-              smf_clean_dksquid(idata, 0, 0, &(head.data), 1, 1,
+              smf_clean_dksquid(wf, idata, 0, 0, &(head.data), 1, 1,
                                 replacebad, status);
               head.data.pntr[0] = NULL;
             } else if( mtype == SMF__GAI ) {
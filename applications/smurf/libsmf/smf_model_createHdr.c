@@ -71,9 +71,12 @@
 *        Added SSN.
 *     2015-06-15 (DSB):
 *        Added PCA.
+*     2026-10-14:
+*        Share the JCMTState array of the reference header.
      {enter_further_changes_here}
 
 *  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
 *     Copyright (C) 2010 Science & Technology Facilities Council.
 *     Copyright (C) 2008-2010 University of British Columbia.
 *     All Rights Reserved.
@@ -306,12 +309,10 @@ void smf_model_createHdr( smfData *model, smf_modeltype type,
 
   /* Propagate JCMTState */
   if( (*status==SAI__OK) && (refhdr->allState) ) {
+    if( !model->hdr->isCloned ) smf_state_release( model->hdr, status );
     model->hdr->nframes = refhdr->nframes;
-    model->hdr->allState = astCalloc( refhdr->nframes,
-                                      sizeof(*(model->hdr->allState)));
-    if (model->hdr->allState) {
-      memcpy( model->hdr->allState, refhdr->allState,
-              refhdr->nframes*sizeof(*refhdr->allState) );
-    }
+    model->hdr->allState = smf_state_share( refhdr,
+                                            &(model->hdr->stateshare),
+                                            status );
   }
 }
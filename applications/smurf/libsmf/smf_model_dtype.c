@@ -0,0 +1,117 @@
+/*
+*+
+*  Name:
+*     smf_model_dtype
+
+*  Purpose:
+*     Return the data type used to store a model component.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     smf_dtype smf_model_dtype( smf_modeltype mtype, int *status )
+
+*  Arguments:
+*     mtype = smf_modeltype (Given)
+*        The type of model component.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     SMF__FLOAT if the model is to be stored in single precision, and
+*     SMF__DOUBLE otherwise.
+
+*  Description:
+*     Most model components are stored as double precision values.
+*     However, the time-series models that are only ever added to or
+*     multiplied into the residuals can instead be stored in single
+*     precision, halving the memory they occupy. All arithmetic using
+*     them is still performed in double precision. This is requested by
+*     setting the SMURF_FLOATMODELS environment variable to a comma
+*     separated list of model names (e.g. "EXT,FLT").
+*
+*     Single precision storage is currently supported for the EXT and FLT
+*     models. Other names in the list are ignored, with a warning.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdlib.h>
+#include <string.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+#define FUNC_NAME "smf_model_dtype"
+
+smf_dtype smf_model_dtype( smf_modeltype mtype, int *status ){
+
+/* Local Variables: */
+   char *list;
+   char *name;
+   char *save = NULL;
+   const char *envval;
+   smf_dtype result = SMF__DOUBLE;
+   smf_modeltype type;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return result;
+
+/* Get the list of models to store in single precision. */
+   envval = getenv( SMF__FLOATMODELS );
+   if( !envval || !envval[ 0 ] ) return result;
+
+/* Check each name in the list. */
+   list = astStore( NULL, envval, strlen( envval ) + 1 );
+   name = list ? strtok_r( list, ", ", &save ) : NULL;
+   while( name && *status == SAI__OK ) {
+      type = smf_model_gettype( name, status );
+
+      if( type != SMF__EXT && type != SMF__FLT ) {
+         if( type == mtype ) {
+            msgOutf( "", FUNC_NAME ": *** Warning *** %s is named in %s but "
+                     "cannot be stored in single precision.", status, name,
+                     SMF__FLOATMODELS );
+         }
+      } else if( type == mtype ) {
+         result = SMF__FLOAT;
+      }
+
+      name = strtok_r( NULL, ", ", &save );
+   }
+   list = astFree( list );
+
+   return result;
+}
@@ -0,0 +1,198 @@
+/*
+*+
+*  Name:
+*     smf_model_profile
+
+*  Purpose:
+*     Record the resources used to calculate a DIMM model
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     smf_model_profile( smfModelProfile *prof, int start, dim_t chunk,
+*                        int iter, const char *name, const smfArray *model,
+*                        const smfArray *res, int nthread, int *status )
+
+*  Arguments:
+*     prof = smfModelProfile * (Given and Returned)
+*        The profiling state. Its "fname" component gives the file to
+*        which the report is appended, or is NULL if no report is
+*        required (in which case this function returns without action).
+*     start = int (Given)
+*        If non-zero, the current wall-clock and CPU times are stored in
+*        "prof" and nothing is written. Otherwise, a line describing the
+*        resources used since the previous call with "start" set is
+*        appended to the report.
+*     chunk = dim_t (Given)
+*        Zero-based index of the continuous chunk.
+*     iter = int (Given)
+*        Zero-based index of the iteration.
+*     name = const char * (Given)
+*        Name of the model (or other step) that has been timed.
+*     model = const smfArray * (Given)
+*        The model that has been calculated. May be NULL.
+*     res = const smfArray * (Given)
+*        The residuals from which the model was calculated. May be NULL.
+*     nthread = int (Given)
+*        The number of worker threads available to the model.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     This function is used by smf_iteratemap to write a report of the
+*     resources used by each model component on each iteration of each
+*     continuous chunk, if the environment variable SMURF_MODELPROFILE
+*     is set to the name of a file. One line is appended to the file
+*     (which is in CSV format, with a header line written when the file
+*     is empty) for each model calculation, holding the chunk and
+*     iteration indices, the model name, the elapsed wall-clock and CPU
+*     times in seconds, the size in MiB of the residual and model arrays
+*     accessed by the model, the number of worker threads and the thread
+*     utilisation (CPU time divided by the product of the wall-clock time
+*     and the number of threads).
+
+*  Notes:
+*     - The CPU time is that used by the whole process, so it includes
+*     any work done concurrently by other threads.
+*     - Each line is written with a single call to fprintf on a file
+*     opened for appending, so that concurrent chunk processes (see
+*     SMURF_CHUNKPROCS) can share a report file.
+*     - Failure to write the report is not an error. A warning is
+*     issued and no further report lines are written.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     2026-10-14:
+*        Original version.
+*     {enter_further_changes_here}
+
+*     - Keyword names are compared without regard to case.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     2026-10-14:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+#include <stdio.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include "sae_par.h"
+#include "mers.h"
+
+/* SMURF includes */
+#include "smf.h"
+#include "smf_typ.h"
+
+#define FUNC_NAME "smf_model_profile"
+
+/* Prototypes for local static functions. */
+static double smf1_model_bytes( const smfArray *array, int *status );
+
+void smf_model_profile( smfModelProfile *prof, int start, dim_t chunk,
+                        int iter, const char *name, const smfArray *model,
+                        const smfArray *res, int nthread, int *status ) {
+
+/* Local Variables */
+  FILE *fd;                  /* Report file */
+  double cpu;                /* Process CPU time so far */
+  double mbytes;             /* MiB of data accessed */
+  double util;               /* Thread utilisation */
+  double wall;               /* Wall-clock time */
+  struct rusage usage;       /* Resource usage of this process */
+  struct timeval tv;         /* Current time */
+
+/* Check inherited status, and that a report is required. */
+  if( *status != SAI__OK || !prof || !prof->fname ) return;
+
+/* Get the current times. */
+  gettimeofday( &tv, NULL );
+  wall = tv.tv_sec + 1.0E-6*tv.tv_usec;
+  getrusage( RUSAGE_SELF, &usage );
+  cpu = usage.ru_utime.tv_sec + 1.0E-6*usage.ru_utime.tv_usec +
+        usage.ru_stime.tv_sec + 1.0E-6*usage.ru_stime.tv_usec;
+
+  if( start ) {
+    prof->wall = wall;
+    prof->cpu = cpu;
+    return;
+  }
+
+  wall -= prof->wall;
+  cpu -= prof->cpu;
+  mbytes = ( smf1_model_bytes( res, status ) +
+             smf1_model_bytes( model, status ) )/SMF__MIB;
+  if( nthread < 1 ) nthread = 1;
+  util = ( wall > 0.0 ) ? cpu/( wall*nthread ) : 0.0;
+
+/* Append the report line, writing the column names first if the file is
+   new. */
+  fd = fopen( prof->fname, "a" );
+  if( fd ) {
+    if( ftell( fd ) == 0 ) {
+      fprintf( fd, "chunk,iter,model,wall_s,cpu_s,mbytes,nthread,util\n" );
+    }
+    fprintf( fd, "%zu,%d,%s,%.6f,%.6f,%.3f,%d,%.3f\n", (size_t) chunk,
+             iter, name, wall, cpu, mbytes, nthread, util );
+    fclose( fd );
+
+  } else {
+    msgOutf( "", "WARNING: " FUNC_NAME ": cannot open model profile file "
+             "'%s' - no further profiling will be done.", status,
+             prof->fname );
+    prof->fname = NULL;
+  }
+}
+
+/* Return the number of bytes in the data arrays of an smfArray. */
+static double smf1_model_bytes( const smfArray *array, int *status ) {
+  dim_t idx;
+  dim_t ndata;
+  double result = 0.0;
+
+  if( *status != SAI__OK || !array ) return result;
+
+  for( idx = 0; idx < array->ndat; idx++ ) {
+    if( array->sdata[ idx ] ) {
+      smf_get_dims( array->sdata[ idx ], NULL, NULL, NULL, NULL, &ndata,
+                    NULL, NULL, status );
+      result += (double) ndata*smf_dtype_size( array->sdata[ idx ], status );
+    }
+  }
+
+  return result;
+}
@@ -0,0 +1,141 @@
+/*
+*+
+*  Name:
+*     smf_mpi_rank
+
+*  Purpose:
+*     Return the MPI rank of the current process
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     rank = smf_mpi_rank( int *nrank, int *status );
+
+*  Arguments:
+*     nrank = int * (Returned)
+*        Returned holding the number of MPI processes. One is returned
+*        if MPI is not being used. May be NULL.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     rank = int
+*        The zero-based rank of the current process within
+*        MPI_COMM_WORLD. Zero is returned if MPI is not being used.
+
+*  Description:
+*     MAKEMAP can be run as several MPI processes, possibly on different
+*     nodes of a cluster, that share the continuous chunks between them
+*     (see smf_iteratemap). This is done if SMURF was built with MPI
+*     support and the environment variable SMURF_MPI is set to a non-zero
+*     value. In this case, this function initialises MPI the first time
+*     it is called, arranging for MPI to be finalised when the process
+*     exits, and returns the rank of the current process. Otherwise it
+*     returns zero and indicates that there is a single process.
+
+*  Notes:
+*     - MPI is never initialised unless SMURF_MPI is set, so a SMURF
+*     built with MPI support behaves exactly as before when run in the
+*     usual way.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     2026-10-14:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include "sae_par.h"
+#include "mers.h"
+
+/* SMURF includes */
+#include "smf.h"
+#include "smf_typ.h"
+
+#if HAVE_MPI
+static void smf1_mpi_finalize( void );
+#endif
+
+int smf_mpi_rank( int *nrank, int *status ) {
+
+  int rank = 0;              /* Rank of this process */
+
+  if( nrank ) *nrank = 1;
+  if( *status != SAI__OK ) return rank;
+
+#if HAVE_MPI
+  {
+    const char *envval = getenv( SMF__MPI );
+    int flag = 0;
+    int size = 1;
+
+    if( envval && atoi( envval ) != 0 ) {
+      MPI_Initialized( &flag );
+      if( !flag ) {
+        if( MPI_Init( NULL, NULL ) != MPI_SUCCESS ) {
+          *status = SAI__ERROR;
+          errRep( "", "smf_mpi_rank: Unable to initialise MPI.", status );
+          return rank;
+        }
+        atexit( smf1_mpi_finalize );
+      }
+
+      MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+      MPI_Comm_size( MPI_COMM_WORLD, &size );
+      if( nrank ) *nrank = size;
+    }
+  }
+#endif
+
+  return rank;
+}
+
+#if HAVE_MPI
+/* Finalise MPI when the process exits, unless something else already
+   has done. */
+static void smf1_mpi_finalize( void ) {
+  int flag = 0;
+  MPI_Finalized( &flag );
+  if( !flag ) MPI_Finalize();
+}
+#endif
@@ -0,0 +1,195 @@
+/*
+*+
+*  Name:
+*     smf_obsindex_name
+
+*  Purpose:
+*     Get the name of the file in which the header summary of an input
+*     file is indexed.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     int smf_obsindex_name( const char *ndfname, char *filename,
+*                            size_t szfname, int *status )
+
+*  Arguments:
+*     ndfname = const char * (Given)
+*        The name of the input NDF, as stored in the input group.
+*     filename = char * (Returned)
+*        The path of the index file. Not changed if zero is returned.
+*     szfname = size_t (Given)
+*        The length of the "filename" buffer.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     Non-zero if an index file name was returned, and zero if no
+*     observation index is in use or the input cannot be indexed.
+
+*  Description:
+*     If the SMURF_OBSINDEX environment variable is set to the name of a
+*     directory, the header information that smf_find_science uses to
+*     classify each input file is stored in a file within that directory
+*     (see smf_write_obsindex), so that later runs on the same data do not
+*     need to open each NDF and read its FITS extension and JCMTSTATE
+*     arrays. The directory may be shared by several users and processes.
+*
+*     The file name is formed from the name of the input file, followed
+*     by a 64-bit hash of the full name, size, modification time and
+*     inode of the input file. An input file that is changed in any way
+*     therefore gets a new index file.
+
+*  Notes:
+*     - Zero is returned for NDF sections and for names that do not
+*     correspond to a single file on disk.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "star/one.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+#define FUNC_NAME "smf_obsindex_name"
+
+/* Prototypes for local functions */
+static uint64_t smf1_hash( uint64_t hash, const void *pntr, size_t nbytes );
+static uint64_t smf1_hash_string( uint64_t hash, const char *text );
+
+int smf_obsindex_name( const char *ndfname, char *filename,
+                       size_t szfname, int *status ){
+
+/* Local Variables: */
+   char *p;
+   char base[ SMF_PATH_MAX + 1 ];
+   char path[ SMF_PATH_MAX + 1 ];
+   const char *dir;
+   const char *pbase;
+   int result = 0;
+   long long int mtime;
+   long long int size;
+   struct stat buf;
+   uint64_t hash;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return result;
+
+/* Check an index directory has been specified. */
+   dir = getenv( SMF__OBSINDEX );
+   if( !dir || !dir[ 0 ] || !ndfname ) return result;
+
+/* NDF sections (and foreign formats that use similar syntax) cannot be
+   identified by a single file. */
+   if( strchr( ndfname, '(' ) ) return result;
+
+/* Find the file holding the NDF, with or without the ".sdf" suffix. */
+   one_strlcpy( path, ndfname, sizeof( path ), status );
+   if( *status != SAI__OK ) {
+      errAnnul( status );
+      return result;
+   }
+   if( stat( path, &buf ) != 0 || !S_ISREG( buf.st_mode ) ) {
+      if( snprintf( path, sizeof( path ), "%s.sdf", ndfname ) >=
+          (int) sizeof( path ) || stat( path, &buf ) != 0 ||
+          !S_ISREG( buf.st_mode ) ) return result;
+   }
+
+/* Hash the file identity. The string identifying the index file format
+   is included so that files written in a different format are never
+   matched. */
+   size = buf.st_size;
+   mtime = buf.st_mtime;
+
+   hash = UINT64_C( 14695981039346656037 );
+   hash = smf1_hash_string( hash, SMF__OBSINDEX_MAGIC );
+   hash = smf1_hash_string( hash, path );
+   hash = smf1_hash( hash, &size, sizeof( size ) );
+   hash = smf1_hash( hash, &mtime, sizeof( mtime ) );
+   hash = smf1_hash( hash, &buf.st_ino, sizeof( buf.st_ino ) );
+
+/* Form the file name from the last component of the input file name,
+   without any ".sdf" suffix. */
+   if( *status == SAI__OK ) {
+      pbase = strrchr( path, '/' );
+      one_strlcpy( base, pbase ? pbase + 1 : path, sizeof( base ), status );
+      p = strstr( base, ".sdf" );
+      if( p && !p[ 4 ] ) *p = 0;
+
+      if( snprintf( filename, szfname, "%s/%s_%016" PRIx64 ".obx", dir,
+                    base, hash ) >= (int) szfname ) {
+         *status = SAI__ERROR;
+         errRepf( "", FUNC_NAME ": Observation index directory name '%s' is "
+                  "too long.", status, dir );
+      } else {
+         result = 1;
+      }
+   }
+
+   return result;
+}
+
+/* Update a 64-bit FNV-1a hash with a block of memory. */
+static uint64_t smf1_hash( uint64_t hash, const void *pntr, size_t nbytes ){
+   const unsigned char *p = pntr;
+   const unsigned char *pend = p + nbytes;
+
+   while( p < pend ) {
+      hash ^= *(p++);
+      hash *= UINT64_C( 1099511628211 );
+   }
+   return hash;
+}
+
+/* Update a hash with a null-terminated string (including the
+   terminator, so that consecutive strings are kept distinct). */
+static uint64_t smf1_hash_string( uint64_t hash, const char *text ){
+   if( !text ) text = "";
+   return smf1_hash( hash, text, strlen( text ) + 1 );
+}
@@ -123,6 +123,9 @@
 *        Stop default NDF history being written when the output NDF is closed.
 *     2014-01-10 (DSB):
 *        Added argument wf.
+*     14-OCT-2026:
+*        Do not copy the DATA array when creating an empty output smfData,
+*        since smf_flatfield creates it from the dark-subtracted data.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -270,9 +273,13 @@ int smf_open_and_flatfield ( ThrWorkForce *wf, const Grp *igrp, const Grp *ogrp,
     /* If ffdata is NULL then populate a struct to work with */
     if ( *ffdata == NULL ) {
       /* Note that we don't need to create a smfFile but we ask
-       the new smfData to be a _DOUBLE using the rawconvert flag */
+       the new smfData to be a _DOUBLE using the rawconvert flag. The
+       DATA array is not copied since smf_flatfield will create it by
+       converting the dark-subtracted input data, so copying it here
+       would just be an extra pass through the data. */
       flags |= SMF__NOCREATE_FILE;
-      *ffdata = smf_deepcopy_smfData( wf, data, 1, flags, 0, 0, status );
+      *ffdata = smf_deepcopy_smfData( wf, data, 1, flags | SMF__NOCREATE_DATA,
+                                      0, 0, status );
       if (*status != SAI__OK) {
         errRep( "", FUNC_NAME
                 ": Error, unable to allocate memory for new smfData",
@@ -52,6 +52,9 @@
  *       SMF__NOFIX_METADATA: Do not fix metadata using smf_fix_metadata
  *       SMF__NOTTSERIES: File is not a time series file even if 3d
  *       SMF__ISFLAT: File should not be flat-fielded, even if it is _INTEGER.
+ *       SMF__NOCREATE_WCS: Do not read the WCS FrameSet (hdr->wcs or
+ *       hdr->tswcs), which are left NULL. Intended for callers that only
+ *       scan the headers of many files and never use the WCS.
 
  *  Authors:
  *     Andy Gibb (UBC)
@@ -263,6 +266,8 @@
  *     2018-9-24 (DSB):
  *        Do not over-write potentially good scanvel and steptime values
  *        in the smfHead with bad values read from the SMURF extension.
+ *     2026-10-14:
+ *        Add SMF__NOCREATE_WCS flag.
  *     {enter_further_changes_here}
 
  *  Copyright:
@@ -1188,11 +1193,11 @@ void smf_open_file( ThrWorkForce *wf, const Grp * igrp, size_t index,
 
         /* If not time series, then we can retrieve the stored WCS info. */
         if ( !isTseries ) {
-          ndfGtwcs( indf, &(hdr->wcs), status);
+          if ( !(flags & SMF__NOCREATE_WCS) ) ndfGtwcs( indf, &(hdr->wcs), status);
           if (hdr->nframes == 0) hdr->nframes = 1;
         } else {
           /* Get the time series WCS */
-          ndfGtwcs( indf, &(hdr->tswcs), status );
+          if ( !(flags & SMF__NOCREATE_WCS) ) ndfGtwcs( indf, &(hdr->tswcs), status );
 
           /* Get the obsidss */
           if( hdr->fitshdr ) {
@@ -1260,7 +1265,7 @@ void smf_open_file( ThrWorkForce *wf, const Grp * igrp, size_t index,
       double refres = VAL__BADD;
 
       /* Get the time series WCS if header exists */
-      if( hdr ) {
+      if( hdr && !(flags & SMF__NOCREATE_WCS) ) {
         ndfGtwcs( indf, &(hdr->tswcs), status );
       }
 
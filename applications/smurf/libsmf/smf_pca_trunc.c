@@ -0,0 +1,491 @@
+/*
+*+
+*  Name:
+*     smf_pca_trunc
+
+*  Purpose:
+*     Find the strongest principal components of a set of bolometers.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     void smf_pca_trunc( ThrWorkForce *wf, const double *data,
+*                         const size_t *goodbolo, size_t ngood,
+*                         size_t bstride, size_t tstride, size_t t_first,
+*                         size_t tlen, const double *cov, size_t ncalc,
+*                         double *vt, double *sigma, int *status )
+
+*  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        Pointer to a pool of worker threads (can be NULL).
+*     data = const double * (Given)
+*        The bolometer time-series data. The mean value should have been
+*        removed from each bolometer. Only used if "cov" is NULL.
+*     goodbolo = const size_t * (Given)
+*        An array of "ngood" values holding the indices of the bolometers
+*        to use within "data". Only used if "cov" is NULL.
+*     ngood = size_t (Given)
+*        The number of bolometers to use.
+*     bstride = size_t (Given)
+*        The bolometer stride in "data".
+*     tstride = size_t (Given)
+*        The time slice stride in "data".
+*     t_first = size_t (Given)
+*        The index of the first time slice to use within "data".
+*     tlen = size_t (Given)
+*        The number of time slices to use.
+*     cov = const double * (Given)
+*        The "ngood" x "ngood" bolometer-bolometer covariance matrix,
+*        with all the elements of row 1 first, followed by all the elements
+*        of row 2, etc. If NULL, the covariance matrix is not used and
+*        the required products are instead found directly from "data".
+*     ncalc = size_t (Given)
+*        The number of principal components to find.
+*     vt = double * (Returned)
+*        An array in which to return the "ncalc" principal components,
+*        each of which is a unit vector of "ngood" bolometer weights. All
+*        the elements of the first (strongest) component come first,
+*        followed by all the elements of the second component, etc. This
+*        is the same layout as the first "ncalc" rows of the V' matrix
+*        returned by smf_svd. It may be the same array as "cov", in
+*        which case the first "ncalc" rows of "cov" are overwritten.
+*     sigma = double * (Returned)
+*        An array in which to return the "ncalc" eigenvalues of the
+*        covariance matrix, in descending order.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     This function finds the "ncalc" eigenvectors of the bolometer
+*     covariance matrix that have the largest eigenvalues, without
+*     performing a full decomposition of the matrix. It uses a randomised
+*     range finder with subspace iteration ("Finding structure with
+*     randomness: Probabilistic algorithms for constructing approximate
+*     matrix decompositions", Halko, Martinsson & Tropp, 2011,
+*     DOI: 10.1137/090771806):
+*
+*     - A block of "ncalc" plus a few extra random vectors is formed and
+*       orthonormalised.
+*     - The block is repeatedly multiplied by the covariance matrix and
+*       re-orthonormalised, which rotates it towards the space spanned by
+*       the strongest eigenvectors.
+*     - The covariance matrix is projected onto the final block, and the
+*       resulting small matrix is decomposed using smf_svd.
+*
+*     The cost is proportional to the number of components requested
+*     rather than to the cube of the number of bolometers. If "cov" is
+*     NULL, each product with the covariance matrix is formed as
+*     X.(X'.Q) directly from the data X, so that the covariance matrix
+*     itself need not be formed either. This is cheaper when the number
+*     of components is small compared to the number of bolometers.
+*
+*     The random vectors are generated using a fixed seed, so the results
+*     are repeatable. As with smf_svd, the signs of the returned vectors
+*     are arbitrary.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "prm_par.h"
+#include "star/thr.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+/* Other includes */
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_randist.h>
+
+/* The number of extra vectors included in the block, and the number of
+   subspace iterations. */
+#define OVERSAMPLE 10
+#define NPOWER 3
+
+/* Prototypes for local static functions. */
+static void smf1_pca_trunc( void *job_data_ptr, int *status );
+static void smf1_orthonorm( double *q, size_t n, size_t l );
+
+/* Local data types */
+typedef struct smfPCATruncData {
+   const double *cov;
+   const double *data;
+   const size_t *goodbolo;
+   double *q;
+   double *y;
+   double *z;
+   size_t b1;
+   size_t b2;
+   size_t bstride;
+   size_t l;
+   size_t ngood;
+   size_t t1;
+   size_t t2;
+   size_t tstride;
+} SmfPCATruncData;
+
+void smf_pca_trunc( ThrWorkForce *wf, const double *data,
+                    const size_t *goodbolo, size_t ngood, size_t bstride,
+                    size_t tstride, size_t t_first, size_t tlen,
+                    const double *cov, size_t ncalc, double *vt,
+                    double *sigma, int *status ){
+
+/* Local Variables */
+   SmfPCATruncData *job_data = NULL;
+   SmfPCATruncData *pdata = NULL;
+   double *b = NULL;
+   double *bs = NULL;
+   double *q = NULL;
+   double *y = NULL;
+   double sum;
+   gsl_rng *r;
+   int iter;
+   int iw;
+   int nw;
+   size_t c;
+   size_t c2;
+   size_t i;
+   size_t j;
+   size_t l;
+   size_t step;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* The number of vectors in the block. */
+   l = ncalc + OVERSAMPLE;
+   if( l > ngood ) l = ngood;
+   if( ncalc == 0 || ncalc > l ) {
+      *status = SAI__ERROR;
+      errRepf( "", "smf_pca_trunc: Cannot find %zu components of %zu "
+               "bolometers.", status, ncalc, ngood );
+      return;
+   }
+
+/* The number of threads to use. */
+   nw = wf ? wf->nworker : 1;
+
+/* Allocate work arrays. "q" and "y" hold "l" values for each
+   bolometer. */
+   q = astMalloc( ngood*l*sizeof( *q ) );
+   y = astMalloc( ngood*l*sizeof( *y ) );
+   b = astMalloc( l*l*sizeof( *b ) );
+   bs = astMalloc( l*sizeof( *bs ) );
+   job_data = astCalloc( nw, sizeof( *job_data ) );
+   if( *status == SAI__OK ) {
+
+/* Set up the job data. When using the covariance matrix, each thread
+   finds the product for a block of bolometers. When using the data,
+   each thread finds the product for a block of time slices, using its
+   own copy of the product array. */
+      step = cov ? ngood/nw : tlen/nw;
+      if( step == 0 ) step = 1;
+
+      for( iw = 0; iw < nw; iw++ ) {
+         pdata = job_data + iw;
+         pdata->cov = cov;
+         pdata->data = data;
+         pdata->goodbolo = goodbolo;
+         pdata->q = q;
+         pdata->bstride = bstride;
+         pdata->tstride = tstride;
+         pdata->l = l;
+         pdata->ngood = ngood;
+
+         if( cov ) {
+            pdata->b1 = iw*step;
+            pdata->b2 = ( iw == nw - 1 ) ? ngood - 1 : ( iw + 1 )*step - 1;
+            if( pdata->b2 >= ngood ) pdata->b2 = ngood - 1;
+            pdata->y = y;
+            pdata->z = NULL;
+         } else {
+            pdata->t1 = t_first + iw*step;
+            pdata->t2 = ( iw == nw - 1 ) ? t_first + tlen - 1 :
+                                           t_first + ( iw + 1 )*step - 1;
+            if( pdata->t2 >= t_first + tlen ) pdata->t2 = t_first + tlen - 1;
+            pdata->y = astMalloc( ngood*l*sizeof( *( pdata->y ) ) );
+            pdata->z = astMalloc( l*sizeof( *( pdata->z ) ) );
+         }
+      }
+
+/* Fill the initial block with normally distributed random values. A
+   fixed generator and seed are used so that the results are
+   repeatable. */
+      r = gsl_rng_alloc( gsl_rng_mt19937 );
+      for( i = 0; i < ngood*l; i++ ) q[ i ] = gsl_ran_ugaussian( r );
+      gsl_rng_free( r );
+      smf1_orthonorm( q, ngood, l );
+   }
+
+/* Multiply the block by the covariance matrix. On all but the final pass,
+   the orthonormalised product becomes the new block. */
+   for( iter = 0; iter <= NPOWER && *status == SAI__OK; iter++ ) {
+      for( iw = 0; iw < nw; iw++ ) {
+         pdata = job_data + iw;
+         if( !cov && pdata->t1 > pdata->t2 ) continue;
+         thrAddJob( wf, 0, pdata, smf1_pca_trunc, 0, NULL, status );
+      }
+      thrWait( wf, status );
+
+/* If the products were found from the data, add together the
+   contributions from each thread (in a fixed order, so that the results
+   do not depend on the order in which the threads complete), and
+   normalise to get the product with the covariance matrix. */
+      if( !cov && *status == SAI__OK ) {
+         memset( y, 0, ngood*l*sizeof( *y ) );
+         for( iw = 0; iw < nw; iw++ ) {
+            pdata = job_data + iw;
+            if( pdata->t1 > pdata->t2 ) continue;
+            for( i = 0; i < ngood*l; i++ ) y[ i ] += pdata->y[ i ];
+         }
+         for( i = 0; i < ngood*l; i++ ) y[ i ] /= ( (double) tlen - 1 );
+      }
+
+      if( iter < NPOWER ) {
+         memcpy( q, y, ngood*l*sizeof( *q ) );
+         smf1_orthonorm( q, ngood, l );
+      }
+   }
+
+   if( *status == SAI__OK ) {
+
+/* Form the small matrix B = Q'.C.Q = Q'.Y, and remove any asymmetry
+   caused by rounding. */
+      for( c = 0; c < l; c++ ) {
+         for( c2 = 0; c2 < l; c2++ ) {
+            sum = 0.0;
+            for( j = 0; j < ngood; j++ ) sum += q[ j*l + c ]*y[ j*l + c2 ];
+            b[ c*l + c2 ] = sum;
+         }
+      }
+      for( c = 0; c < l; c++ ) {
+         for( c2 = c + 1; c2 < l; c2++ ) {
+            b[ c*l + c2 ] = 0.5*( b[ c*l + c2 ] + b[ c2*l + c ] );
+            b[ c2*l + c ] = b[ c*l + c2 ];
+         }
+      }
+   }
+
+/* Decompose it. Since B is symmetric and positive semi-definite, its
+   singular vectors are its eigenvectors. On exit, each row of "b" holds
+   an eigenvector, in order of decreasing eigenvalue. */
+   smf_svd( wf, l, b, bs, NULL, 10*VAL__EPSD, 1, status );
+
+/* Rotate the eigenvectors of B back into the full bolometer space to get
+   the eigenvectors of the covariance matrix. */
+   if( *status == SAI__OK ) {
+      for( i = 0; i < ncalc; i++ ) {
+         for( j = 0; j < ngood; j++ ) {
+            sum = 0.0;
+            for( c = 0; c < l; c++ ) sum += b[ i*l + c ]*q[ j*l + c ];
+            vt[ i*ngood + j ] = sum;
+         }
+         sigma[ i ] = bs[ i ];
+      }
+   }
+
+/* Free resources. */
+   if( job_data && !cov ) {
+      for( iw = 0; iw < nw; iw++ ) {
+         pdata = job_data + iw;
+         pdata->y = astFree( pdata->y );
+         pdata->z = astFree( pdata->z );
+      }
+   }
+   job_data = astFree( job_data );
+   bs = astFree( bs );
+   b = astFree( b );
+   y = astFree( y );
+   q = astFree( q );
+}
+
+
+static void smf1_pca_trunc( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_pca_trunc
+
+*  Purpose:
+*     Executed in a worker thread to do various calculations for
+*     smf_pca_trunc.
+
+*  Invocation:
+*     smf1_pca_trunc( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = SmfPCATruncData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+/* Local Variables: */
+   SmfPCATruncData *pdata;
+   const double *pd;
+   const double *pr;
+   double *pq;
+   double *py;
+   double *z;
+   double v;
+   size_t c;
+   size_t i;
+   size_t j;
+   size_t k;
+   size_t l;
+   size_t ngood;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Get a pointer that can be used for accessing the required items in the
+   supplied structure. */
+   pdata = (SmfPCATruncData *) job_data_ptr;
+   l = pdata->l;
+   ngood = pdata->ngood;
+
+/* Product with the covariance matrix for a block of bolometers: Y = C.Q */
+   if( pdata->cov ) {
+      for( i = pdata->b1; i <= pdata->b2; i++ ) {
+         py = pdata->y + i*l;
+         for( c = 0; c < l; c++ ) py[ c ] = 0.0;
+
+         pr = pdata->cov + i*ngood;
+         pq = pdata->q;
+         for( j = 0; j < ngood; j++ ) {
+            v = pr[ j ];
+            for( c = 0; c < l; c++ ) py[ c ] += v*pq[ c ];
+            pq += l;
+         }
+      }
+
+/* Product with the data for a block of time slices: Y = X.(X'.Q), where
+   each column of X' holds the values from all bolometers at one time
+   slice. */
+   } else {
+      z = pdata->z;
+      memset( pdata->y, 0, ngood*l*sizeof( *( pdata->y ) ) );
+
+      for( k = pdata->t1; k <= pdata->t2; k++ ) {
+         pd = pdata->data + k*pdata->tstride;
+
+         for( c = 0; c < l; c++ ) z[ c ] = 0.0;
+         pq = pdata->q;
+         for( j = 0; j < ngood; j++ ) {
+            v = pd[ pdata->goodbolo[ j ]*pdata->bstride ];
+            for( c = 0; c < l; c++ ) z[ c ] += v*pq[ c ];
+            pq += l;
+         }
+
+         py = pdata->y;
+         for( j = 0; j < ngood; j++ ) {
+            v = pd[ pdata->goodbolo[ j ]*pdata->bstride ];
+            for( c = 0; c < l; c++ ) py[ c ] += v*z[ c ];
+            py += l;
+         }
+      }
+   }
+}
+
+static void smf1_orthonorm( double *q, size_t n, size_t l ){
+/*
+*  Name:
+*     smf1_orthonorm
+
+*  Purpose:
+*     Orthonormalise the columns of a matrix.
+
+*  Invocation:
+*     smf1_orthonorm( double *q, size_t n, size_t l )
+
+*  Arguments:
+*     q = double * (Given and Returned)
+*        The n x l matrix, with all the elements of row 1 first, followed
+*        by all the elements of row 2, etc.
+*     n = size_t (Given)
+*        The number of rows.
+*     l = size_t (Given)
+*        The number of columns.
+
+*  Description:
+*     Modified Gram-Schmidt is used, with each column orthogonalised
+*     twice against the preceding columns to keep the result orthogonal
+*     to working precision. Columns that are (numerically) linear
+*     combinations of the preceding columns are set to zero.
+
+*/
+
+/* Local Variables: */
+   double norm0;
+   double norm;
+   double sum;
+   int pass;
+   size_t c;
+   size_t c2;
+   size_t j;
+
+   for( c = 0; c < l; c++ ) {
+
+      norm0 = 0.0;
+      for( j = 0; j < n; j++ ) norm0 += q[ j*l + c ]*q[ j*l + c ];
+
+      for( pass = 0; pass < 2; pass++ ) {
+         for( c2 = 0; c2 < c; c2++ ) {
+            sum = 0.0;
+            for( j = 0; j < n; j++ ) sum += q[ j*l + c2 ]*q[ j*l + c ];
+            if( sum != 0.0 ) {
+               for( j = 0; j < n; j++ ) q[ j*l + c ] -= sum*q[ j*l + c2 ];
+            }
+         }
+      }
+
+      norm = 0.0;
+      for( j = 0; j < n; j++ ) norm += q[ j*l + c ]*q[ j*l + c ];
+
+      if( norm > 0.0 && norm > 1.0E-20*norm0 ) {
+         norm = 1.0/sqrt( norm );
+         for( j = 0; j < n; j++ ) q[ j*l + c ] *= norm;
+      } else {
+         for( j = 0; j < n; j++ ) q[ j*l + c ] = 0.0;
+      }
+   }
+}
@@ -44,10 +44,14 @@
 *        Original version.
 *     2012-01-04 (TIMJ):
 *        Move the SMU correction code to smf_add_smu_pcorr.
+*     2026-10-14:
+*        Take a private copy of any shared JCMTState array before
+*        correcting it.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2012, 2011 Science & Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -190,6 +194,10 @@ static void smf1_pcorr( smfHead *head, const Grp *igrp, const char *name1,
          astUnlock( dlonmap, 1 );
          astUnlock( dlatmap, 1 );
 
+/* The JCMTState array is about to be changed, so make sure it is not
+   shared with any other header. */
+         smf_state_own( head, status );
+
 /* Loop round every time slice */
          for( iframe = 0; iframe < head->nframes ; iframe++ ){
             state = head->allState + iframe;
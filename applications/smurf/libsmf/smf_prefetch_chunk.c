@@ -0,0 +1,210 @@
+/*
+*+
+*  Name:
+*     smf_prefetch_chunk
+
+*  Purpose:
+*     Read the files for a continuous chunk in the background.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     smf_prefetch_chunk( ThrWorkForce *wf, const smfGroup *igroup,
+*                         size_t whichchunk, size_t maxbytes, int *status )
+
+*  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        Pointer to the workforce that will read the files. This should
+*        normally be a small workforce dedicated to I/O, rather than the
+*        workforce used for processing the data.
+*     igroup = const smfGroup * (Given)
+*        The group of input files, as returned by smf_grp_related.
+*     whichchunk = size_t (Given)
+*        The index of the continuous chunk for which the files are to be
+*        read.
+*     maxbytes = size_t (Given)
+*        The maximum number of bytes to read. Files are read in the order
+*        in which they will be concatenated until this limit is reached.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     This function submits a job to the supplied workforce for each file
+*     in the requested continuous chunk, and returns without waiting for
+*     the jobs to complete (use thrWait to wait for them). Each job reads
+*     the entire file and discards the values read, so that the file
+*     contents are in the operating system's page cache by the time the
+*     chunk is opened and concatenated by smf_concat_smfGroup. This allows
+*     the disk I/O for one chunk to proceed whilst the previous chunk is
+*     being processed.
+*
+*     The files are read using the POSIX I/O routines only, so the jobs
+*     can safely run at the same time as NDF or HDS calls in other
+*     threads. The names of the files are obtained from the group before
+*     the jobs are submitted. Prefetching is advisory: any file that
+*     cannot be found or read is simply skipped.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+#include "star/grp.h"
+#include "star/mem.h"
+#include "star/one.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+#define FUNC_NAME "smf_prefetch_chunk"
+
+/* The size of the buffer used to read each file */
+#define SMF__PREFETCH_BUF 1048576
+
+/* Structure containing the data needed by each prefetch job */
+typedef struct smfPrefetchData {
+   char name[ SMF_PATH_MAX + 1 ];      /* Name of file to read */
+} smfPrefetchData;
+
+/* Prototypes for local static functions */
+static void smf1_prefetch_chunk( void *job_data_ptr, int *status );
+
+void smf_prefetch_chunk( ThrWorkForce *wf, const smfGroup *igroup,
+                         size_t whichchunk, size_t maxbytes, int *status ){
+
+/* Local Variables: */
+   char *pname;
+   char *p;
+   size_t i;
+   size_t j;
+   size_t nfile = 0;
+   size_t total = 0;
+   smfPrefetchData *pdata;
+   struct stat sbuf;
+
+/* Check inherited status. */
+   if( *status != SAI__OK || !wf || !igroup || maxbytes == 0 ) return;
+
+/* Loop over all subgroups in the requested chunk, and all related files
+   in each subgroup, in the order in which smf_concat_smfGroup opens
+   them. */
+   for( j = 0; j < igroup->nrelated && total < maxbytes; j++ ) {
+      for( i = 0; i < igroup->ngroups && total < maxbytes; i++ ) {
+         if( igroup->chunk[ i ] != whichchunk ||
+             igroup->subgroups[ i ][ j ] == 0 ) continue;
+
+/* Get the file name from the group. */
+         pdata = astMalloc( sizeof( *pdata ) );
+         if( *status != SAI__OK ) break;
+         pname = pdata->name;
+         grpGet( igroup->grp, igroup->subgroups[ i ][ j ], 1, &pname,
+                 sizeof( pdata->name ), status );
+
+/* Remove any NDF section specifier, and append the ".sdf" file type if
+   the name does not identify a file as it stands. */
+         p = strchr( pdata->name, '(' );
+         if( p ) *p = 0;
+         if( stat( pdata->name, &sbuf ) == -1 ) {
+            one_strlcat( pdata->name, ".sdf", sizeof( pdata->name ),
+                         status );
+            if( stat( pdata->name, &sbuf ) == -1 ) sbuf.st_size = -1;
+         }
+
+/* Submit a job to read the file, telling it to free the job data when
+   it completes. */
+         if( *status == SAI__OK && sbuf.st_size > 0 &&
+             S_ISREG( sbuf.st_mode ) ) {
+            total += sbuf.st_size;
+            nfile++;
+            thrAddJob( wf, THR__FREE_JOBDATA, pdata, smf1_prefetch_chunk,
+                       0, NULL, status );
+         } else {
+            pdata = astFree( pdata );
+         }
+      }
+   }
+
+   msgOutiff( MSG__VERB, "", FUNC_NAME ": prefetching %zu files (%zu MiB) "
+              "for continuous chunk %zu", status, nfile, total/SMF__MIB,
+              whichchunk + 1 );
+}
+
+static void smf1_prefetch_chunk( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_prefetch_chunk
+
+*  Purpose:
+*     Executed in a worker thread to read a single file.
+
+*  Invocation:
+*     smf1_prefetch_chunk( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = smfPrefetchData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+/* Local Variables: */
+   char *buf;
+   int fd;
+   smfPrefetchData *pdata = job_data_ptr;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Open the file. Failures are ignored since the file will be read again
+   (and any error reported) when it is opened properly. */
+   fd = open( pdata->name, O_RDONLY );
+   if( fd == -1 ) return;
+
+/* Tell the kernel we will need the whole file, then read it to ensure
+   it is in the page cache. The buffer belongs to this job's arena. */
+#if defined(POSIX_FADV_WILLNEED)
+   (void) posix_fadvise( fd, 0, 0, POSIX_FADV_WILLNEED );
+#endif
+   buf = starArenaMalloc( SMF__PREFETCH_BUF );
+   if( buf ) {
+      while( read( fd, buf, SMF__PREFETCH_BUF ) > 0 );
+   }
+
+   close( fd );
+}
@@ -0,0 +1,249 @@
+/*
+*+
+*  Name:
+*     smf_qmask_update
+
+*  Purpose:
+*     Create or refresh the packed quality mask associated with a smfData.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     smf_qmask_update( ThrWorkForce *wf, smfData *data, smf_qual_t mask,
+*                       int *status )
+
+*  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        Pointer to a pool of worker threads (can be NULL).
+*     data = smfData * (Given)
+*        The smfData whose quality is to be packed.
+*     mask = smf_qual_t (Given)
+*        The quality bits that make a sample unusable. If this is zero,
+*        any existing packed mask is freed and no new mask is created.
+*     status = int * (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     The packed quality mask holds one bit for each sample in the
+*     quality array, stored in 64-bit words in the same order as the
+*     quality values themselves: bit "i%64" of word "i/64" is set if
+*     quality value "i" has none of the bits in "mask" set. Code that
+*     only needs to know whether a sample is usable can then test the
+*     mask instead of the full quality array, and can skip 64 flagged
+*     samples at a time.
+*
+*     The mask is stored with the smfData that owns the quality array
+*     (i.e. the sidecar quality if there is one, see smf_select_qualpntr),
+*     so that it is shared by all smfDatas that share the quality. Any
+*     existing mask is re-used, and is completely re-calculated from the
+*     current quality values. Use smf_select_qmask to get a pointer to
+*     the mask.
+
+*  Notes:
+*     - The mask is not updated automatically by every routine that
+*     modifies quality. smf_update_quality refreshes any existing mask,
+*     but other routines (for instance the flagging done by the model
+*     components in smf_iteratemap) do not, and nor does smf_dataOrder.
+*     A mask should therefore only be used between the call to this
+*     routine that creates it and the next change to the quality values.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdint.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "star/thr.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+/* Prototypes for local static functions. */
+static void smf1_qmask_update( void *job_data_ptr, int *status );
+
+/* Local data types */
+typedef struct smfQmaskUpdateData {
+   const smf_qual_t *qual;
+   dim_t ndata;
+   size_t w1;
+   size_t w2;
+   smf_qual_t mask;
+   uint64_t *qmask;
+} SmfQmaskUpdateData;
+
+#define FUNC_NAME "smf_qmask_update"
+
+void smf_qmask_update( ThrWorkForce *wf, smfData *data, smf_qual_t mask,
+                       int *status ){
+
+/* Local Variables: */
+   SmfQmaskUpdateData *job_data = NULL;
+   SmfQmaskUpdateData *pdata;
+   dim_t ndata;
+   int iw;
+   int nw;
+   size_t nword;
+   size_t wstep;
+   smfData *owner;
+   smf_qual_t *qual;
+
+/* Check inherited status */
+   if( *status != SAI__OK || !data ) return;
+
+/* Get the quality array, and the smfData that owns it. */
+   qual = smf_select_qualpntr( data, NULL, status );
+   if( !qual ) {
+      if( *status == SAI__OK ) {
+         *status = SAI__ERROR;
+         errRep( "", FUNC_NAME ": smfData does not contain a QUALITY "
+                 "component", status );
+      }
+      return;
+   }
+   if( data->sidequal && ( data->sidequal->qual ||
+                           ( data->sidequal->dtype == SMF__QUALTYPE &&
+                             data->sidequal->pntr[ 0 ] ) ) ) {
+      owner = data->sidequal;
+   } else {
+      owner = data;
+   }
+
+/* A zero mask means any existing packed mask should be freed. */
+   if( !mask ) {
+      owner->qmask = astFree( owner->qmask );
+      owner->qmaskbits = 0;
+      return;
+   }
+
+/* Allocate the mask if required. */
+   smf_get_dims( data, NULL, NULL, NULL, NULL, &ndata, NULL, NULL, status );
+   nword = ( ndata + 63 )/64;
+   if( !owner->qmask ) owner->qmask = astMalloc( nword*sizeof( uint64_t ) );
+   owner->qmaskbits = mask;
+
+/* How many threads do we get to play with */
+   nw = wf ? wf->nworker : 1;
+
+/* Find how many words to process in each worker thread. */
+   wstep = nword/nw;
+   if( wstep == 0 ) wstep = 1;
+
+/* Allocate job data for threads, and submit the jobs. Ensure that the
+   last thread picks up any left-over words. */
+   job_data = astCalloc( nw, sizeof(*job_data) );
+   if( *status == SAI__OK ) {
+      for( iw = 0; iw < nw; iw++ ) {
+         pdata = job_data + iw;
+         pdata->w1 = iw*wstep;
+         pdata->w2 = ( iw < nw - 1 ) ? pdata->w1 + wstep : nword;
+         if( pdata->w2 > nword ) pdata->w2 = nword;
+         pdata->qual = qual;
+         pdata->ndata = ndata;
+         pdata->mask = mask;
+         pdata->qmask = owner->qmask;
+         thrAddJob( wf, 0, pdata, smf1_qmask_update, 0, NULL, status );
+      }
+      thrWait( wf, status );
+   }
+
+/* If anything went wrong, do not leave a partially formed mask. */
+   if( *status != SAI__OK ) {
+      owner->qmask = astFree( owner->qmask );
+      owner->qmaskbits = 0;
+   }
+
+   job_data = astFree( job_data );
+}
+
+
+static void smf1_qmask_update( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_qmask_update
+
+*  Purpose:
+*     Executed in a worker thread to pack a range of quality values for
+*     smf_qmask_update.
+
+*  Invocation:
+*     smf1_qmask_update( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = SmfQmaskUpdateData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+/* Local Variables: */
+   SmfQmaskUpdateData *pdata;
+   const smf_qual_t *pq;
+   dim_t nbit;
+   size_t ibit;
+   size_t iword;
+   smf_qual_t mask;
+   uint64_t word;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Get a pointer that can be used for accessing the required items in the
+   supplied structure. */
+   pdata = (SmfQmaskUpdateData *) job_data_ptr;
+   mask = pdata->mask;
+
+/* Each word is formed from the 64 quality values it describes. Since
+   each thread writes to its own range of whole words, no locking is
+   needed. The final word may be only partially used, in which case its
+   unused bits are left clear. */
+   for( iword = pdata->w1; iword < pdata->w2; iword++ ) {
+      pq = pdata->qual + iword*64;
+      nbit = pdata->ndata - iword*64;
+      if( nbit > 64 ) nbit = 64;
+
+      word = 0;
+      for( ibit = 0; ibit < nbit; ibit++ ) {
+         if( !( pq[ ibit ] & mask ) ) word |= ( (uint64_t) 1 ) << ibit;
+      }
+      pdata->qmask[ iword ] = word;
+   }
+}
@@ -0,0 +1,324 @@
+/*
+*+
+*  Name:
+*     smf_qspans_update
+
+*  Purpose:
+*     Create or refresh the run-length index of good data spans in a
+*     smfData.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     smf_qspans_update( ThrWorkForce *wf, smfData *data, smf_qual_t mask,
+*                        int *status )
+
+*  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        Pointer to a pool of worker threads (can be NULL).
+*     data = smfData * (Given)
+*        The smfData whose quality is to be indexed.
+*     mask = smf_qual_t (Given)
+*        The quality bits that make a sample unusable. If this is zero,
+*        any existing index is freed and no new index is created.
+*     status = int * (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     The index records, for each bolometer, the ranges of time slices
+*     ("spans") in which no sample has any of the bits in "mask" set.
+*     Span "is" of the index covers time slices spans[2*is] to
+*     spans[2*is+1] inclusive, and the spans for bolometer "ibolo" are
+*     numbers first[ibolo] to first[ibolo+1]-1, in increasing order of
+*     time. A bolometer with no spans has no usable samples at all. Code
+*     that needs to find the flagged regions of each bolometer can then
+*     step from span to span instead of testing every quality value.
+*
+*     The index is stored with the smfData that owns the quality array
+*     (i.e. the sidecar quality if there is one, see smf_select_qualpntr),
+*     so that it is shared by all smfDatas that share the quality. Any
+*     existing index is re-used, and is completely re-calculated from the
+*     current quality values. Use smf_select_qspans to get a pointer to
+*     the index.
+
+*  Notes:
+*     - As with the packed quality mask (see smf_qmask_update), the index
+*     is refreshed by smf_update_quality but not by other routines that
+*     modify quality, and nor by smf_dataOrder. An index should therefore
+*     only be used between the call to this routine that creates it and
+*     the next change to the quality values.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "star/thr.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+/* Prototypes for local static functions. */
+static void smf1_qspans_update( void *job_data_ptr, int *status );
+
+/* Local data types */
+typedef struct smfQspansUpdateData {
+   const smf_qual_t *qual;
+   dim_t *first;
+   dim_t *spans;
+   dim_t b1;
+   dim_t b2;
+   dim_t ntslice;
+   int operation;
+   size_t bstride;
+   size_t tstride;
+   smf_qual_t mask;
+} SmfQspansUpdateData;
+
+#define FUNC_NAME "smf_qspans_update"
+
+void smf_qspans_update( ThrWorkForce *wf, smfData *data, smf_qual_t mask,
+                        int *status ){
+
+/* Local Variables: */
+   SmfQspansUpdateData *job_data = NULL;
+   SmfQspansUpdateData *pdata;
+   dim_t bstep;
+   dim_t ibolo;
+   dim_t nbolo;
+   dim_t nspan;
+   dim_t ntslice;
+   int iw;
+   int nw;
+   size_t bstride;
+   size_t tstride;
+   smfData *owner;
+   smfQualSpans *qspans;
+   smf_qual_t *qual;
+
+/* Check inherited status */
+   if( *status != SAI__OK || !data ) return;
+
+/* Get the quality array, and the smfData that owns it. */
+   qual = smf_select_qualpntr( data, NULL, status );
+   if( !qual ) {
+      if( *status == SAI__OK ) {
+         *status = SAI__ERROR;
+         errRep( "", FUNC_NAME ": smfData does not contain a QUALITY "
+                 "component", status );
+      }
+      return;
+   }
+   if( data->sidequal && ( data->sidequal->qual ||
+                           ( data->sidequal->dtype == SMF__QUALTYPE &&
+                             data->sidequal->pntr[ 0 ] ) ) ) {
+      owner = data->sidequal;
+   } else {
+      owner = data;
+   }
+
+/* A zero mask means any existing index should be freed. */
+   if( !mask ) {
+      if( owner->qspans ) {
+         owner->qspans->first = astFree( owner->qspans->first );
+         owner->qspans->spans = astFree( owner->qspans->spans );
+         owner->qspans = astFree( owner->qspans );
+      }
+      return;
+   }
+
+/* Allocate the index if required. The "first" array has an extra
+   element so that the number of spans for every bolometer can be found
+   by differencing. */
+   smf_get_dims( data, NULL, NULL, &nbolo, &ntslice, NULL, &bstride,
+                 &tstride, status );
+
+   if( !owner->qspans ) owner->qspans = astCalloc( 1, sizeof( smfQualSpans ) );
+   qspans = owner->qspans;
+   if( *status != SAI__OK ) return;
+
+   qspans->first = astGrow( qspans->first, nbolo + 1, sizeof( dim_t ) );
+   qspans->nbolo = nbolo;
+   qspans->mask = mask;
+
+/* How many threads do we get to play with */
+   nw = wf ? wf->nworker : 1;
+
+/* Find how many bolometers to process in each worker thread. */
+   bstep = nbolo/nw;
+   if( bstep == 0 ) bstep = 1;
+
+/* Allocate job data for threads, and store common values. Ensure that the
+   last thread picks up any left-over bolometers. */
+   job_data = astCalloc( nw, sizeof(*job_data) );
+   if( *status == SAI__OK ) {
+      for( iw = 0; iw < nw; iw++ ) {
+         pdata = job_data + iw;
+         pdata->b1 = iw*bstep;
+         pdata->b2 = ( iw < nw - 1 ) ? pdata->b1 + bstep : nbolo;
+         if( pdata->b2 > nbolo ) pdata->b2 = nbolo;
+         pdata->qual = qual;
+         pdata->first = qspans->first;
+         pdata->ntslice = ntslice;
+         pdata->bstride = bstride;
+         pdata->tstride = tstride;
+         pdata->mask = mask;
+      }
+
+/* First count the spans in each bolometer, storing the count in the
+   "first" array. */
+      for( iw = 0; iw < nw; iw++ ) {
+         pdata = job_data + iw;
+         pdata->operation = 1;
+         thrAddJob( wf, 0, pdata, smf1_qspans_update, 0, NULL, status );
+      }
+      thrWait( wf, status );
+   }
+
+/* Convert the counts into the index of the first span for each
+   bolometer, and allocate room for all the spans. */
+   if( *status == SAI__OK ) {
+      nspan = 0;
+      for( ibolo = 0; ibolo < nbolo; ibolo++ ) {
+         dim_t count = qspans->first[ ibolo ];
+         qspans->first[ ibolo ] = nspan;
+         nspan += count;
+      }
+      qspans->first[ nbolo ] = nspan;
+
+      qspans->spans = astGrow( qspans->spans, 2*nspan + 1, sizeof( dim_t ) );
+
+/* Now store the spans. */
+      for( iw = 0; iw < nw; iw++ ) {
+         pdata = job_data + iw;
+         pdata->operation = 2;
+         pdata->spans = qspans->spans;
+         thrAddJob( wf, 0, pdata, smf1_qspans_update, 0, NULL, status );
+      }
+      thrWait( wf, status );
+   }
+
+/* If anything went wrong, do not leave a partially formed index. */
+   if( *status != SAI__OK ) {
+      qspans->first = astFree( qspans->first );
+      qspans->spans = astFree( qspans->spans );
+      owner->qspans = astFree( owner->qspans );
+   }
+
+   job_data = astFree( job_data );
+}
+
+
+static void smf1_qspans_update( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_qspans_update
+
+*  Purpose:
+*     Executed in a worker thread to find the good spans in a range of
+*     bolometers for smf_qspans_update.
+
+*  Invocation:
+*     smf1_qspans_update( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = SmfQspansUpdateData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+/* Local Variables: */
+   SmfQspansUpdateData *pdata;
+   const smf_qual_t *pq;
+   dim_t *ps;
+   dim_t ibolo;
+   dim_t itime;
+   dim_t nspan;
+   int ingood;
+   smf_qual_t mask;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Get a pointer that can be used for accessing the required items in the
+   supplied structure. */
+   pdata = (SmfQspansUpdateData *) job_data_ptr;
+   mask = pdata->mask;
+
+/* Both operations use the same scan of each bolometer. Operation 1
+   counts the spans, and operation 2 stores the first and last time slice
+   of each span (starting at the offset found from the counts). */
+   if( pdata->operation == 1 || pdata->operation == 2 ) {
+      for( ibolo = pdata->b1; ibolo < pdata->b2; ibolo++ ) {
+         pq = pdata->qual + ibolo*pdata->bstride;
+         ps = ( pdata->operation == 2 ) ?
+              pdata->spans + 2*pdata->first[ ibolo ] : NULL;
+         nspan = 0;
+         ingood = 0;
+
+/* Bolometers flagged as entirely bad have no spans, so long as the mask
+   includes SMF__Q_BADB. */
+         if( !( ( mask & SMF__Q_BADB ) && ( *pq & SMF__Q_BADB ) ) ) {
+            for( itime = 0; itime < pdata->ntslice; itime++ ) {
+               if( !( *pq & mask ) ) {
+                  if( !ingood ) {
+                     ingood = 1;
+                     nspan++;
+                     if( ps ) *(ps++) = itime;
+                  }
+               } else if( ingood ) {
+                  ingood = 0;
+                  if( ps ) *(ps++) = itime - 1;
+               }
+               pq += pdata->tstride;
+            }
+            if( ingood && ps ) *(ps++) = pdata->ntslice - 1;
+         }
+
+         if( pdata->operation == 1 ) pdata->first[ ibolo ] = nspan;
+      }
+
+   } else {
+      *status = SAI__ERROR;
+      errRepf( "", "smf1_qspans_update: Invalid operation (%d) supplied.",
+               status, pdata->operation );
+   }
+}
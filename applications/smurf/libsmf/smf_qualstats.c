@@ -106,6 +106,9 @@
 *-
 */
 
+/* System includes */
+#include <string.h>
+
 /* Starlink includes */
 #include "mers.h"
 #include "ndf.h"
@@ -118,25 +121,29 @@
 #include "libsmf/smf.h"
 #include "libsmf/smf_err.h"
 
-/* Prototypes for local static functions. */
-static void smf1_qualstats( void *job_data_ptr, int *status );
-
 /* Local data types */
 typedef struct smfQualStatsData {
-   dim_t b1;
-   dim_t b2;
    size_t bstride;
    size_t nqbits;
-   size_t numgoodbolo;
-   size_t nummap;
-   size_t nummax;
-   size_t qcount[SMF__NQBITS];
    size_t slice_end;
    size_t slice_start;
    size_t tstride;
    const smf_qual_t *qual;
 } SmfQualStatsData;
 
+typedef struct smfQualStatsCounts {
+   size_t numgoodbolo;
+   size_t nummap;
+   size_t nummax;
+   size_t qcount[SMF__NQBITS];
+} SmfQualStatsCounts;
+
+/* Prototypes for local static functions. */
+static void smf1_qualstats( void *job_data_ptr, size_t b1, size_t b2,
+                            void *counts_ptr, int *status );
+static void smf1_qualstats_sum( void *job_data_ptr, void *total_ptr,
+                                const void *counts_ptr, int *status );
+
 #define FUNC_NAME "smf_qualstats"
 
 void smf_qualstats( ThrWorkForce *wf, smf_qfam_t qfamily, int nopad,
@@ -146,18 +153,11 @@ void smf_qualstats( ThrWorkForce *wf, smf_qfam_t qfamily, int nopad,
                     size_t *tpad, int *status ) {
 
   /* Local Variables */
-  dim_t bolostep;               /* Number of bolos per thread */
-  size_t k;                     /* Loop counter */
-  size_t numgoodbolo=0;
-  size_t nummap=0;
-  size_t nummax=0;
+  SmfQualStatsCounts counts;    /* Counts accumulated by all threads */
+  SmfQualStatsData job_data;    /* Description of the job */
   size_t nqbits = 0;            /* Number of quality bits in this family */
   size_t slice_start = 0;       /* First time slice to analyse */
   size_t slice_end = 0;         /* last time slice */
-  int nw;                       /* Number of worker threads */
-  int iw;                       /* Thread index */
-  SmfQualStatsData *job_data;
-  SmfQualStatsData *pdata;
 
   /* init */
   if (tpad) *tpad = 0;
@@ -175,16 +175,10 @@ void smf_qualstats( ThrWorkForce *wf, smf_qfam_t qfamily, int nopad,
     return;
   }
 
-  /* How many threads do we get to play with */
-  nw = wf ? wf->nworker : 1;
-
-  /* Find how many bolometers to process in each worker thread. */
-  bolostep = nbolo/nw;
-  if( bolostep == 0 ) bolostep = 1;
-
   /* Initialize the counters */
   nqbits = smf_qfamily_count( qfamily, status );
   memset( qcount, 0, nqbits*sizeof(*qcount) );
+  memset( &counts, 0, sizeof(counts) );
 
   /* Determine start and end time slices */
   if (nopad) {
@@ -195,61 +189,34 @@ void smf_qualstats( ThrWorkForce *wf, smf_qfam_t qfamily, int nopad,
     slice_end = ntslice-1;
   }
 
-  /* Allocate job data for threads, and store the range of bolos to be
-     processed by each one. Ensure that the last thread picks up any
-     left-over bolos. */
-  job_data = astCalloc( nw, sizeof(*job_data) );
-  if( *status == SAI__OK ) {
-    for( iw = 0; iw < nw; iw++ ) {
-      pdata = job_data + iw;
-      pdata->b1 = iw*bolostep;
-      if( iw < nw - 1 ) {
-         pdata->b2 = pdata->b1 + bolostep - 1;
-      } else {
-         pdata->b2 = nbolo - 1 ;
-      }
-
-      /* Store other values common to all jobs. */
-      pdata->bstride = bstride;
-      pdata->tstride = tstride;
-      pdata->slice_start = slice_start;
-      pdata->slice_end = slice_end;
-      pdata->qual = qual;
-      pdata->nqbits = nqbits;
-
-      /* Submit the job to the workforce. */
-      thrAddJob( wf, 0, pdata, smf1_qualstats, 0, NULL, status );
-    }
-
-    /* Wait for all jobs to complete. */
-    thrWait( wf, status );
-
-    /* Accumulate the results from all the worker threads. */
-    for( iw = 0; iw < nw; iw++ ) {
-       pdata = job_data + iw;
-       numgoodbolo += pdata->numgoodbolo;
-       nummap += pdata->nummap;
-       nummax += pdata->nummax;
-       for( k = 0; k < nqbits; k++ ) {
-          qcount[ k ] += pdata->qcount[ k ];
-       }
-    }
-
-    /* Free the job data. */
-    job_data = astFree( job_data );
+  /* Store the values needed by all threads. */
+  job_data.bstride = bstride;
+  job_data.tstride = tstride;
+  job_data.slice_start = slice_start;
+  job_data.slice_end = slice_end;
+  job_data.qual = qual;
+  job_data.nqbits = nqbits;
+
+  /* Count the quality bits, sharing the bolometers out dynamically
+     between the worker threads, and summing the counts from each
+     thread. */
+  if( nbolo > 0 ) {
+    thrParallelReduce( wf, 0, nbolo - 1, 0, &job_data, smf1_qualstats,
+                       sizeof(counts), &counts, smf1_qualstats_sum, status );
   }
+  memcpy( qcount, counts.qcount, nqbits*sizeof(*qcount) );
 
   /* Return extra requested values */
   if( ngoodbolo ) {
-    *ngoodbolo = numgoodbolo;
+    *ngoodbolo = counts.numgoodbolo;
   }
 
   if( nmap ) {
-    *nmap = nummap;
+    *nmap = counts.nummap;
   }
 
   if( nmax ) {
-    *nmax = nummax;
+    *nmax = counts.nummax;
   }
 
   if (tpad) {
@@ -270,7 +237,8 @@ void smf_qualstats( ThrWorkForce *wf, smf_qfam_t qfamily, int nopad,
 
 
 
-static void smf1_qualstats( void *job_data_ptr, int *status ) {
+static void smf1_qualstats( void *job_data_ptr, size_t b1, size_t b2,
+                            void *counts_ptr, int *status ) {
 /*
 *  Name:
 *     smf1_qualstats
@@ -280,18 +248,27 @@ static void smf1_qualstats( void *job_data_ptr, int *status ) {
 *     smf_qualstats.
 
 *  Invocation:
-*     smf1_qualstats( void *job_data_ptr, int *status )
+*     smf1_qualstats( void *job_data_ptr, size_t b1, size_t b2,
+*                     void *counts_ptr, int *status )
 
 *  Arguments:
 *     job_data_ptr = SmfQualStatsData * (Given)
 *        Data structure describing the job to be performed by the worker
-*        thread.
+*        thread. It is shared by all threads.
+*     b1 = size_t (Given)
+*        Index of the first bolometer to process.
+*     b2 = size_t (Given)
+*        Index of the last bolometer to process.
+*     counts_ptr = SmfQualStatsCounts * (Given and Returned)
+*        The counts for the thread. The counts for the supplied range
+*        of bolometers are added onto the supplied values.
 *     status = int * (Given and Returned)
 *        Inherited status.
 
 */
 
 /* Local Variables: */
+   SmfQualStatsCounts *pcounts;
    SmfQualStatsData *pdata;
    dim_t ibolo;
    dim_t itime;
@@ -302,25 +279,20 @@ static void smf1_qualstats( void *job_data_ptr, int *status ) {
 /* Check inherited status */
    if( *status != SAI__OK ) return;
 
-/* Get a pointer that can be used for accessing the required items in the
-   supplied structure. */
+/* Get pointers that can be used for accessing the required items in the
+   supplied structures. */
    pdata = (SmfQualStatsData *) job_data_ptr;
-
-/* Initialise returned values. */
-   pdata->numgoodbolo = 0;
-   pdata->nummap = 0;
-   pdata->nummax = 0;
-   memset( pdata->qcount, 0, pdata->nqbits*sizeof( *pdata->qcount ) );
+   pcounts = (SmfQualStatsCounts *) counts_ptr;
 
 /* Loop round all bolos to be processed by this thread, maintaining the
    index of the first time slice from the current bolo. */
-   ibase = pdata->b1*pdata->bstride;
-   for( ibolo = pdata->b1; ibolo <= pdata->b2; ibolo++ ) {
+   ibase = b1*pdata->bstride;
+   for( ibolo = b1; ibolo <= b2; ibolo++ ) {
 
 /* Get a pointer to the first used quality value for the current bolo, and
    count the number of good bolometers. */
       pq = pdata->qual + ibase;
-      if( !( *pq & SMF__Q_BADB ) ) pdata->numgoodbolo++;
+      if( !( *pq & SMF__Q_BADB ) ) pcounts->numgoodbolo++;
 
 /* Increment the pointer to the first slice to be used from the current
    bolometer. */
@@ -330,8 +302,8 @@ static void smf1_qualstats( void *job_data_ptr, int *status ) {
       for( itime = pdata->slice_start; itime <= pdata->slice_end; itime++ ) {
 
 /* Count samples for nmap and nmax */
-         if( !(*pq & SMF__Q_GOOD) ) pdata->nummap++;
-         if( !(*pq & SMF__Q_BOUND) ) pdata->nummax++;
+         if( !(*pq & SMF__Q_GOOD) ) pcounts->nummap++;
+         if( !(*pq & SMF__Q_BOUND) ) pcounts->nummax++;
 
 /* If the quality is 0 then we already know the answer without looping over
    all the bits */
@@ -343,19 +315,19 @@ static void smf1_qualstats( void *job_data_ptr, int *status ) {
             switch( *pq ) {
 
                case BIT_TO_VAL(0):
-                  pdata->qcount[0]++;
+                  pcounts->qcount[0]++;
                   break;
 
                case BIT_TO_VAL(1):
 
 /* we do not need to worry about exceeding qcount bounds since we will only
    be accessing it if the case statement is true */
-                  pdata->qcount[1]++;
+                  pcounts->qcount[1]++;
                   break;
 
                case (BIT_TO_VAL(0)|BIT_TO_VAL(1)):
-                  pdata->qcount[0]++;
-                  pdata->qcount[1]++;
+                  pcounts->qcount[0]++;
+                  pcounts->qcount[1]++;
                   break;
 
                default:
@@ -363,7 +335,7 @@ static void smf1_qualstats( void *job_data_ptr, int *status ) {
 /* Loop over bits */
                   for( k = 0; k < pdata->nqbits; k++ ) {
                      if( *pq & BIT_TO_VAL(k) ) {
-                        pdata->qcount[k]++;
+                        pcounts->qcount[k]++;
                      }
                   }
             }
@@ -379,3 +351,48 @@ static void smf1_qualstats( void *job_data_ptr, int *status ) {
    }
 }
 
+static void smf1_qualstats_sum( void *job_data_ptr, void *total_ptr,
+                                const void *counts_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_qualstats_sum
+
+*  Purpose:
+*     Add the counts from a single thread onto the total counts.
+
+*  Invocation:
+*     smf1_qualstats_sum( void *job_data_ptr, void *total_ptr,
+*                         const void *counts_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = SmfQualStatsData * (Given)
+*        Data structure describing the job.
+*     total_ptr = SmfQualStatsCounts * (Given and Returned)
+*        The total counts.
+*     counts_ptr = const SmfQualStatsCounts * (Given)
+*        The counts from a single thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+/* Local Variables: */
+   SmfQualStatsCounts *ptotal;
+   const SmfQualStatsCounts *pcounts;
+   size_t k;
+   size_t nqbits;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+   ptotal = (SmfQualStatsCounts *) total_ptr;
+   pcounts = (const SmfQualStatsCounts *) counts_ptr;
+   nqbits = ( (SmfQualStatsData *) job_data_ptr )->nqbits;
+
+   ptotal->numgoodbolo += pcounts->numgoodbolo;
+   ptotal->nummap += pcounts->nummap;
+   ptotal->nummax += pcounts->nummax;
+   for( k = 0; k < nqbits; k++ ) {
+      ptotal->qcount[ k ] += pcounts->qcount[ k ];
+   }
+}
@@ -0,0 +1,312 @@
+/*
+*+
+*  Name:
+*     smf_read_checkpoint
+
+*  Purpose:
+*     Restore the state of the iterative map-maker from a checkpoint file.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     smf_read_checkpoint( const char *filename, smfCheckpoint *ckpt,
+*                          smfDIMMData *dat, smfArray ***model,
+*                          int nmodels, int *status )
+
+*  Arguments:
+*     filename = const char * (Given)
+*        The name of the checkpoint file, as created by
+*        smf_write_checkpoint.
+*     ckpt = smfCheckpoint * (Given and Returned)
+*        Returned holding the iteration counters and convergence history
+*        stored in the file. If the array pointers in "ckpt" are not
+*        NULL, the accumulated maps are also copied into them.
+*     dat = smfDIMMData * (Given and Returned)
+*        If not NULL, the map arrays, residuals, quality and pointing of
+*        the current continuous chunk are restored. If NULL, only the
+*        scalar values in "ckpt" are read.
+*     model = smfArray *** (Given and Returned)
+*        The time-series models to restore. Only used if "dat" is not
+*        NULL.
+*     nmodels = int (Given)
+*        The number of elements in "model".
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     This function reads a checkpoint file written by
+*     smf_write_checkpoint, allowing smf_iteratemap to continue from the
+*     iteration at which the checkpoint was made rather than starting
+*     again from scratch.
+*
+*     The containers for the time-series data and models must already
+*     exist, with the same dimensions as when the checkpoint was made;
+*     only their data arrays are overwritten. In practice this means
+*     that the raw data are concatenated as usual before calling this
+*     function, but there is no need to clean them or to repeat the
+*     iterations that were completed before the checkpoint was made.
+*     An error is reported if the size of any array in the file does
+*     not match the corresponding array in memory, which is what will
+*     normally happen if the input data or configuration have changed.
+
+*  Notes:
+*     - Calling this function with "dat" set to NULL is cheap, and
+*     allows the continuous chunk at which to resume to be determined
+*     before any data are read.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+#include "prm_par.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+#define FUNC_NAME "smf_read_checkpoint"
+
+/* Prototypes for local functions */
+static void smf1_read_record( FILE *fp, void *pntr, size_t nbytes,
+                              const char *desc, int *status );
+static void smf1_read_array( FILE *fp, smfArray *array, const char *desc,
+                             int *status );
+static size_t smf1_data_size( const smfData *data, int *status );
+
+void smf_read_checkpoint( const char *filename, smfCheckpoint *ckpt,
+                          smfDIMMData *dat, smfArray ***model,
+                          int nmodels, int *status ){
+
+/* Local Variables: */
+   FILE *fp = NULL;
+   char magic[ sizeof( SMF__CHECKPOINT_MAGIC ) ];
+   double chisq;
+   int imodel;
+   int nmodels_file;
+   size_t msize;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+   fp = fopen( filename, "rb" );
+   if( !fp ) {
+      *status = SAI__ERROR;
+      errRepf( "", FUNC_NAME ": Unable to open checkpoint file '%s': %s",
+               status, filename, strerror( errno ) );
+      return;
+   }
+
+/* Check the file is a checkpoint. */
+   memset( magic, 0, sizeof( magic ) );
+   smf1_read_record( fp, magic, strlen( SMF__CHECKPOINT_MAGIC ), "header",
+                     status );
+   if( *status == SAI__OK && strcmp( magic, SMF__CHECKPOINT_MAGIC ) ) {
+      *status = SAI__ERROR;
+      errRepf( "", FUNC_NAME ": '%s' is not a SMURF checkpoint file.",
+               status, filename );
+   }
+
+/* The loop counters and convergence history. */
+   smf1_read_record( fp, &ckpt->contchunk, sizeof( ckpt->contchunk ),
+                     "header", status );
+   smf1_read_record( fp, &ckpt->ncontchunks, sizeof( ckpt->ncontchunks ),
+                     "header", status );
+   smf1_read_record( fp, &ckpt->iter, sizeof( ckpt->iter ), "header", status );
+   smf1_read_record( fp, &ckpt->quit, sizeof( ckpt->quit ), "header", status );
+   smf1_read_record( fp, &ckpt->converged, sizeof( ckpt->converged ),
+                     "header", status );
+   smf1_read_record( fp, &ckpt->noidone, sizeof( ckpt->noidone ), "header",
+                     status );
+   smf1_read_record( fp, &ckpt->rate_limited, sizeof( ckpt->rate_limited ),
+                     "header", status );
+   smf1_read_record( fp, &ckpt->mapchange_l2, sizeof( ckpt->mapchange_l2 ),
+                     "header", status );
+   smf1_read_record( fp, &ckpt->mapchange_l3, sizeof( ckpt->mapchange_l3 ),
+                     "header", status );
+   smf1_read_record( fp, &ckpt->lastchisquared,
+                     sizeof( ckpt->lastchisquared ), "header", status );
+   smf1_read_record( fp, &ckpt->sumchunkweights,
+                     sizeof( ckpt->sumchunkweights ), "header", status );
+
+/* Everything else is only needed when restoring the full state. */
+   if( dat ) {
+      smf1_read_record( fp, &msize, sizeof( msize ), "header", status );
+      smf1_read_record( fp, &nmodels_file, sizeof( nmodels_file ), "header",
+                        status );
+      if( *status == SAI__OK && ( msize != dat->msize ||
+                                  nmodels_file != nmodels ) ) {
+         *status = SAI__ERROR;
+         errRepf( "", FUNC_NAME ": Checkpoint file '%s' was created with a "
+                  "different map size or set of models.", status, filename );
+      }
+
+      smf1_read_record( fp, &dat->ast_skipped, sizeof( dat->ast_skipped ),
+                        "header", status );
+      smf1_read_record( fp, &dat->mapok, sizeof( dat->mapok ), "header",
+                        status );
+      smf1_read_record( fp, &dat->mapchange, sizeof( dat->mapchange ),
+                        "header", status );
+      smf1_read_record( fp, &chisq, sizeof( chisq ), "header", status );
+      if( dat->chisquared && *status == SAI__OK ) dat->chisquared[0] = chisq;
+
+/* The maps accumulated from previous continuous chunks. */
+      smf1_read_record( fp, ckpt->map, msize*sizeof(*ckpt->map), "map",
+                        status );
+      smf1_read_record( fp, ckpt->weights, msize*sizeof(*ckpt->weights),
+                        "map", status );
+      smf1_read_record( fp, ckpt->mapweights,
+                        msize*sizeof(*ckpt->mapweights), "map", status );
+      smf1_read_record( fp, ckpt->mapweightsq,
+                        msize*sizeof(*ckpt->mapweightsq), "map", status );
+      smf1_read_record( fp, ckpt->mapvar, msize*sizeof(*ckpt->mapvar), "map",
+                        status );
+      smf1_read_record( fp, ckpt->hitsmap, msize*sizeof(*ckpt->hitsmap),
+                        "map", status );
+      smf1_read_record( fp, ckpt->mapqual, msize*sizeof(*ckpt->mapqual),
+                        "map", status );
+      smf1_read_record( fp, ckpt->exp_time, msize*sizeof(*ckpt->exp_time),
+                        "map", status );
+      smf1_read_record( fp, ckpt->chunkchange,
+                        ckpt->ncontchunks*sizeof(*ckpt->chunkchange), "map",
+                        status );
+
+/* The maps for the current continuous chunk. */
+      smf1_read_record( fp, dat->map, msize*sizeof(*dat->map), "map", status );
+      smf1_read_record( fp, dat->lastmap, msize*sizeof(*dat->lastmap), "map",
+                        status );
+      smf1_read_record( fp, dat->mapweight, msize*sizeof(*dat->mapweight),
+                        "map", status );
+      smf1_read_record( fp, dat->mapweightsq, msize*sizeof(*dat->mapweightsq),
+                        "map", status );
+      smf1_read_record( fp, dat->mapvar, msize*sizeof(*dat->mapvar), "map",
+                        status );
+      smf1_read_record( fp, dat->hitsmap, msize*sizeof(*dat->hitsmap), "map",
+                        status );
+      smf1_read_record( fp, dat->mapqual, msize*sizeof(*dat->mapqual), "map",
+                        status );
+
+/* The time-series arrays. */
+      smf1_read_array( fp, dat->res ? dat->res[0] : NULL, "RES", status );
+      smf1_read_array( fp, dat->qua ? dat->qua[0] : NULL, "QUA", status );
+      smf1_read_array( fp, dat->lut ? dat->lut[0] : NULL, "LUT", status );
+      for( imodel = 0; imodel < nmodels; imodel++ ) {
+         smf1_read_array( fp, model[imodel] ? model[imodel][0] : NULL,
+                          "model", status );
+      }
+      smf1_read_array( fp, dat->pcacom ? dat->pcacom[0] : NULL, "PCA",
+                       status );
+      smf1_read_array( fp, dat->pcagai ? dat->pcagai[0] : NULL, "PCA",
+                       status );
+
+      if( *status != SAI__OK ) {
+         errRepf( "", FUNC_NAME ": Unable to resume from checkpoint file "
+                  "'%s'. Have the input data or configuration changed?",
+                  status, filename );
+      }
+   }
+
+   fclose( fp );
+}
+
+/* Read a record written by smf_write_checkpoint into the supplied
+   memory, checking that its length is as expected. A NULL pointer
+   expects an empty record. */
+static void smf1_read_record( FILE *fp, void *pntr, size_t nbytes,
+                              const char *desc, int *status ){
+   size_t nfile;
+
+   if( *status != SAI__OK ) return;
+   if( !pntr ) nbytes = 0;
+
+   if( fread( &nfile, sizeof( nfile ), 1, fp ) != 1 ) {
+      *status = SAI__ERROR;
+      errRepf( "", FUNC_NAME ": Checkpoint file is truncated (reading %s).",
+               status, desc );
+
+   } else if( nfile != nbytes ) {
+      *status = SAI__ERROR;
+      errRepf( "", FUNC_NAME ": Checkpoint %s array has %zu bytes but %zu "
+               "were expected.", status, desc, nfile, nbytes );
+
+   } else if( nbytes > 0 && fread( pntr, 1, nbytes, fp ) != nbytes ) {
+      *status = SAI__ERROR;
+      errRepf( "", FUNC_NAME ": Checkpoint file is truncated (reading %s).",
+               status, desc );
+   }
+}
+
+/* Restore the data arrays of all the smfDatas in a smfArray. */
+static void smf1_read_array( FILE *fp, smfArray *array, const char *desc,
+                             int *status ){
+   dim_t idx;
+   dim_t ndat;
+   dim_t ndat_file;
+   smfData *data;
+
+   if( *status != SAI__OK ) return;
+
+   ndat = array ? array->ndat : 0;
+   smf1_read_record( fp, &ndat_file, sizeof( ndat_file ), desc, status );
+   if( *status == SAI__OK && ndat_file != ndat ) {
+      *status = SAI__ERROR;
+      errRepf( "", FUNC_NAME ": Checkpoint %s has %zu subarrays but %zu "
+               "were expected.", status, desc, (size_t) ndat_file,
+               (size_t) ndat );
+   }
+
+   for( idx = 0; idx < ndat && *status == SAI__OK; idx++ ) {
+      data = array->sdata[ idx ];
+      if( data ) {
+         smf1_read_record( fp, data->pntr[0], smf1_data_size( data, status ),
+                           desc, status );
+      } else {
+         smf1_read_record( fp, NULL, 0, desc, status );
+      }
+   }
+}
+
+/* Return the number of bytes in the data array of a smfData. This must
+   match the equivalent function in smf_write_checkpoint. */
+static size_t smf1_data_size( const smfData *data, int *status ){
+   dim_t i;
+   size_t nbytes;
+
+   if( *status != SAI__OK || !data->pntr[0] ) return 0;
+
+   nbytes = smf_dtype_size( data, status );
+   for( i = 0; i < data->ndims; i++ ) nbytes *= data->dims[ i ];
+   return nbytes;
+}
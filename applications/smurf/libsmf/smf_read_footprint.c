@@ -0,0 +1,170 @@
+/*
+*+
+*  Name:
+*     smf_read_footprint
+
+*  Purpose:
+*     Read the sky footprint of an input file from the footprint cache.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     int smf_read_footprint( const char *filename, dim_t *nvert,
+*                             double **lon, double **lat, int *hasoffexp,
+*                             int *polobs, int *status )
+
+*  Arguments:
+*     filename = const char * (Given)
+*        The name of the cache file, as returned by smf_footprint_name.
+*     nvert = dim_t * (Returned)
+*        The number of vertices in the footprint. Zero if the input file
+*        contained no usable positions.
+*     lon = double ** (Returned)
+*        Returned holding a pointer to a newly allocated array holding
+*        the sky longitude of each vertex, in radians. Should be freed using
+*        astFree when no longer needed. NULL if "nvert" is zero.
+*     lat = double ** (Returned)
+*        Returned holding a pointer to a newly allocated array holding
+*        the sky latitude of each vertex, in radians. Should be freed using
+*        astFree when no longer needed. NULL if "nvert" is zero.
+*     hasoffexp = int * (Returned)
+*        Returned non-zero if any time slice in the input file has an
+*        OFF_EXPOSURE value.
+*     polobs = int * (Returned)
+*        Returned non-zero if every time slice in the input file has a
+*        polarimeter angle.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     Non-zero if the footprint was read from the cache, and zero
+*     otherwise.
+
+*  Description:
+*     This function reads a footprint written by smf_write_footprint.
+*     If the file does not exist, or does not contain a complete
+*     footprint, zero is returned without error and NULL pointers are
+*     returned for "lon" and "lat". The caller should then find the
+*     footprint itself.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdio.h>
+#include <string.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+#define FUNC_NAME "smf_read_footprint"
+
+int smf_read_footprint( const char *filename, dim_t *nvert, double **lon,
+                        double **lat, int *hasoffexp, int *polobs,
+                        int *status ){
+
+/* Local Variables: */
+   FILE *fp;
+   char magic[ 9 ];
+   dim_t fnvert;
+   int fhasoffexp;
+   int fpolobs;
+   int result = 0;
+   size_t nmagic;
+
+/* Initialise returned values. */
+   *nvert = 0;
+   *lon = NULL;
+   *lat = NULL;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return result;
+
+/* Open the file. It is not an error if it does not exist. */
+   fp = fopen( filename, "rb" );
+   if( !fp ) return result;
+
+/* Check the header, and read the vertices. A footprint has at most one
+   vertex for each sample, so an absurd vertex count indicates a corrupt
+   file. */
+   nmagic = strlen( SMF__FOOTPRINTCACHE_MAGIC );
+   if( nmagic < sizeof( magic ) &&
+       fread( magic, nmagic, 1, fp ) == 1 &&
+       !strncmp( magic, SMF__FOOTPRINTCACHE_MAGIC, nmagic ) &&
+       fread( &fnvert, sizeof( fnvert ), 1, fp ) == 1 &&
+       fnvert < 100000000 &&
+       fread( &fhasoffexp, sizeof( fhasoffexp ), 1, fp ) == 1 &&
+       fread( &fpolobs, sizeof( fpolobs ), 1, fp ) == 1 ) {
+
+      if( fnvert > 0 ) {
+         *lon = astMalloc( fnvert*sizeof( **lon ) );
+         *lat = astMalloc( fnvert*sizeof( **lat ) );
+         if( *status == SAI__OK &&
+             fread( *lon, sizeof( **lon ), fnvert, fp ) == fnvert &&
+             fread( *lat, sizeof( **lat ), fnvert, fp ) == fnvert ) {
+            result = 1;
+         }
+      } else {
+         result = 1;
+      }
+
+      if( result ) {
+         *nvert = fnvert;
+         *hasoffexp = fhasoffexp;
+         *polobs = fpolobs;
+      }
+   }
+
+   fclose( fp );
+
+   if( result ) {
+      msgOutiff( MSG__VERB, "", FUNC_NAME ": Read footprint from '%s'",
+                 status, filename );
+   } else {
+      *lon = astFree( *lon );
+      *lat = astFree( *lat );
+      msgOutiff( MSG__VERB, "", FUNC_NAME ": Ignoring invalid footprint "
+                 "cache file '%s'", status, filename );
+   }
+
+   return result;
+}
@@ -0,0 +1,171 @@
+/*
+*+
+*  Name:
+*     smf_read_lutcache
+
+*  Purpose:
+*     Read a pointing LUT from the LUT cache.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     int smf_read_lutcache( const char *filename, dim_t nbolo,
+*                            dim_t ntslice, int *lut, double *theta,
+*                            int *onmap, int *status )
+
+*  Arguments:
+*     filename = const char * (Given)
+*        The name of the cache file, as returned by smf_lutcache_name.
+*     nbolo = dim_t (Given)
+*        The number of bolometers.
+*     ntslice = dim_t (Given)
+*        The number of time slices.
+*     lut = int * (Returned)
+*        The LUT, in ICD order (nbolo*ntslice elements).
+*     theta = double * (Returned)
+*        The scan direction at each time slice (ntslice elements). May be
+*        NULL.
+*     onmap = int * (Returned)
+*        The flag indicating if the data overlaps the map.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     Non-zero if the LUT was read from the cache, and zero otherwise.
+
+*  Description:
+*     This function reads a LUT written by smf_write_lutcache. If the
+*     file does not exist, or does not contain a complete LUT of the
+*     expected size, zero is returned without error and the contents of
+*     the returned arrays are undefined. The caller should then
+*     calculate the LUT itself.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdio.h>
+#include <string.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+#define FUNC_NAME "smf_read_lutcache"
+
+int smf_read_lutcache( const char *filename, dim_t nbolo, dim_t ntslice,
+                       int *lut, double *theta, int *onmap, int *status ){
+
+/* Local Variables: */
+   FILE *fp;
+   char magic[ 9 ];
+   dim_t fnbolo;
+   dim_t fntslice;
+   dim_t i;
+   dim_t ndata;
+   int fonmap;
+   int result = 0;
+   int shift;
+   long long int delta;
+   size_t nbytes;
+   size_t nmagic;
+   unsigned char *buf = NULL;
+   unsigned char *p;
+   unsigned char *pend;
+   unsigned long long int code;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return result;
+
+/* Open the file. It is not an error if it does not exist. */
+   fp = fopen( filename, "rb" );
+   if( !fp ) return result;
+
+/* Check the header matches the required LUT. */
+   nmagic = strlen( SMF__LUTCACHE_MAGIC );
+   ndata = nbolo*ntslice;
+   if( nmagic < sizeof( magic ) &&
+       fread( magic, nmagic, 1, fp ) == 1 &&
+       !strncmp( magic, SMF__LUTCACHE_MAGIC, nmagic ) &&
+       fread( &fnbolo, sizeof( fnbolo ), 1, fp ) == 1 && fnbolo == nbolo &&
+       fread( &fntslice, sizeof( fntslice ), 1, fp ) == 1 &&
+       fntslice == ntslice &&
+       fread( &fonmap, sizeof( fonmap ), 1, fp ) == 1 &&
+       fread( &nbytes, sizeof( nbytes ), 1, fp ) == 1 &&
+       nbytes >= ndata && nbytes <= 5*ndata ) {
+
+/* Read and decompress the LUT (see smf_write_lutcache). */
+      buf = astMalloc( nbytes );
+      if( buf && fread( buf, 1, nbytes, fp ) == nbytes ) {
+         p = buf;
+         pend = buf + nbytes;
+         for( i = 0; i < ndata && p < pend; i++ ) {
+            code = 0;
+            shift = 0;
+            while( p < pend && ( *p & 0x80 ) && shift < 63 ) {
+               code |= ( (unsigned long long int) ( *(p++) & 0x7f ) ) << shift;
+               shift += 7;
+            }
+            if( p == pend ) break;
+            code |= ( (unsigned long long int) *(p++) ) << shift;
+
+            delta = ( code & 1 ) ? -(long long int) ( ( code + 1 ) >> 1 )
+                                 : (long long int) ( code >> 1 );
+            lut[ i ] = (int) ( delta + ( ( i >= nbolo ) ? lut[ i - nbolo ] : 0 ) );
+         }
+
+/* Check all of the compressed data was used, and read the theta
+   values. */
+         if( i == ndata && p == pend ) {
+            if( !theta ||
+                fread( theta, sizeof( *theta ), ntslice, fp ) == ntslice ) {
+               *onmap = fonmap;
+               result = 1;
+            }
+         }
+      }
+   }
+
+   fclose( fp );
+   buf = astFree( buf );
+
+   if( result ) {
+      msgOutiff( MSG__VERB, "", FUNC_NAME ": Read LUT from '%s'", status,
+                 filename );
+   } else {
+      msgOutiff( MSG__VERB, "", FUNC_NAME ": Ignoring invalid LUT cache "
+                 "file '%s'", status, filename );
+   }
+
+   return result;
+}
@@ -0,0 +1,213 @@
+/*
+*+
+*  Name:
+*     smf_read_obsindex
+
+*  Purpose:
+*     Read the header summary of an input file from the observation index.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     int smf_read_obsindex( const char *filename, const char *ndfname,
+*                            smfData **data, int *status )
+
+*  Arguments:
+*     filename = const char * (Given)
+*        The name of the index file, as returned by smf_obsindex_name.
+*     ndfname = const char * (Given)
+*        The name of the input NDF, as stored in the input group. This is
+*        stored in the smfFile of the returned smfData.
+*     data = smfData ** (Returned)
+*        A new smfData holding the header summary. Returned NULL if zero
+*        is returned. It should be freed using smf_close_file.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     Non-zero if the header summary was read, and zero if the index file
+*     does not exist or is not valid.
+
+*  Description:
+*     This function reads a header summary written by smf_write_obsindex,
+*     and returns it in a smfData that can be used in place of one
+*     returned by smf_open_file with SMF__NOCREATE_DATA and
+*     SMF__NOCREATE_WCS when classifying the input files in
+*     smf_find_science. A missing or invalid file is not an error.
+
+*  Notes:
+*     - The returned smfData has no associated NDF, and no data arrays.
+*     - If the original file had a JCMTSTATE extension, the returned
+*     smfHead has a single element "allState" array in which only the
+*     RTS_NUM and RTS_END values are set, although the "nframes" value
+*     is the number of time slices in the original file.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdio.h>
+#include <string.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+#include "star/one.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+#define FUNC_NAME "smf_read_obsindex"
+
+int smf_read_obsindex( const char *filename, const char *ndfname,
+                       smfData **data, int *status ){
+
+/* Local Variables: */
+   AstFitsChan *fc = NULL;
+   FILE *fp;
+   char card[ 81 ];
+   char magic[ 9 ];
+   char obsidss[ SZFITSTR ];
+   dim_t nframes;
+   double rts_end;
+   double scanvel;
+   double steptime;
+   int icard;
+   int ival[ 8 ];
+   int ncard;
+   int result = 0;
+   size_t nmagic;
+   smfHead *hdr;
+   unsigned int rts_num;
+
+/* Initialise returned values. */
+   *data = NULL;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return result;
+
+/* Open the file. It is not an error if it does not exist. */
+   fp = fopen( filename, "rb" );
+   if( !fp ) return result;
+
+/* Check the header, and read the summary values. A FITS header never has
+   more than a few thousand cards, so an absurd card count indicates a
+   corrupt file. */
+   nmagic = strlen( SMF__OBSINDEX_MAGIC );
+   if( nmagic < sizeof( magic ) &&
+       fread( magic, nmagic, 1, fp ) == 1 &&
+       !strncmp( magic, SMF__OBSINDEX_MAGIC, nmagic ) &&
+       fread( ival, sizeof( *ival ), 8, fp ) == 8 &&
+       fread( &nframes, sizeof( nframes ), 1, fp ) == 1 &&
+       fread( &steptime, sizeof( steptime ), 1, fp ) == 1 &&
+       fread( &scanvel, sizeof( scanvel ), 1, fp ) == 1 &&
+       fread( &rts_num, sizeof( rts_num ), 1, fp ) == 1 &&
+       fread( &rts_end, sizeof( rts_end ), 1, fp ) == 1 &&
+       fread( obsidss, sizeof( obsidss ), 1, fp ) == 1 &&
+       fread( &ncard, sizeof( ncard ), 1, fp ) == 1 &&
+       ncard >= 0 && ncard < 1000000 ) {
+
+/* Read the FITS cards into a new FitsChan. */
+      fc = astFitsChan( NULL, NULL, " " );
+      card[ 80 ] = 0;
+      for( icard = 0; icard < ncard && *status == SAI__OK; icard++ ) {
+         if( fread( card, 80, 1, fp ) != 1 ) break;
+         astPutFits( fc, card, 0 );
+      }
+
+      if( icard == ncard && *status == SAI__OK ) {
+         astClear( fc, "Card" );
+         result = 1;
+      } else {
+         fc = astAnnul( fc );
+      }
+   }
+
+   fclose( fp );
+
+/* Create the returned smfData. It has a smfFile and a smfHead but no
+   data arrays. */
+   if( result ) {
+      *data = smf_create_smfData( SMF__NOCREATE_DA | SMF__NOCREATE_FTS,
+                                  status );
+      if( *status == SAI__OK ) {
+         one_strlcpy( (*data)->file->name, ndfname,
+                      sizeof( (*data)->file->name ), status );
+
+         hdr = (*data)->hdr;
+         hdr->fitshdr = fc;
+         fc = NULL;
+         hdr->instrument = ival[ 0 ];
+         hdr->realinst = ival[ 1 ];
+         hdr->obstype = ival[ 2 ];
+         hdr->obsmode = ival[ 3 ];
+         hdr->swmode = ival[ 4 ];
+         hdr->seqtype = ival[ 5 ];
+         hdr->inbeam = ival[ 6 ];
+         hdr->nframes = nframes;
+         hdr->steptime = steptime;
+         hdr->scanvel = scanvel;
+         obsidss[ sizeof( obsidss ) - 1 ] = 0;
+         one_strlcpy( hdr->obsidss, obsidss, sizeof( hdr->obsidss ), status );
+
+         if( ival[ 7 ] ) {
+            hdr->allState = astCalloc( 1, sizeof( *hdr->allState ) );
+            if( hdr->allState ) {
+               hdr->allState[ 0 ].rts_num = rts_num;
+               hdr->allState[ 0 ].rts_end = rts_end;
+            }
+         }
+      }
+
+      if( *status != SAI__OK ) {
+         if( fc ) fc = astAnnul( fc );
+         smf_close_file( NULL, data, status );
+         result = 0;
+      }
+   }
+
+   if( result ) {
+      msgOutiff( MSG__VERB, "", FUNC_NAME ": Read header summary from '%s'",
+                 status, filename );
+   } else if( *status == SAI__OK ) {
+      msgOutiff( MSG__VERB, "", FUNC_NAME ": Ignoring invalid observation "
+                 "index file '%s'", status, filename );
+   }
+
+   return result;
+}
@@ -178,10 +178,17 @@
 *     14-MAY-2014 (DSB):
 *        Do not attempt to normalise empty cubes, but issue a warning
 *        instead.
+*     14-OCT-2026:
+*        Unless output variances are based on the spread of input values,
+*        divide the output cube into disjoint spectral slabs that are
+*        re-binned at the same time by smf_rebincube_slabf, rather than
+*        using the two-pass scheme of smf_rebincube_seqf. This allows
+*        more threads to be used with wide spreading kernels.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2007-2009 Science & Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -254,7 +261,12 @@ void smf_rebincube_ast( ThrWorkForce *wf, smfData *data, int first, int last,
    double *detlut = NULL;      /* Work space for detector mask */
    double blk_bot[ 2*MAXTHREADS + 1 ]; /* First o/p channel no. in each block */
    double con;                 /* Constant value */
+   double *slab_pos = NULL;    /* Slab boundaries as input channel numbers */
    double dtemp;               /* Temporary value */
+   double ehi;                 /* Upper input bound of extended slab */
+   double elo;                 /* Lower input bound of extended slab */
+   double hi;                  /* Upper input bound of owned channels */
+   double lo;                  /* Lower input bound of owned channels */
    double tcon;                /* Variance factor for whole time slice */
    float *detwork = NULL;      /* Work array for detector values */
    float *tdata = NULL;        /* Pointer to start of input time slice data */
@@ -265,10 +277,14 @@ void smf_rebincube_ast( ThrWorkForce *wf, smfData *data, int first, int last,
    float teff;                 /* Effective integration time */
    float texp;                 /* Total time ( = ton + toff ) */
    int *nexttime;              /* Pointer to next time slice index to use */
+   int *sb;                    /* Pointer to the bounds of one slab */
+   int *slab_bnd = NULL;       /* Output and input bounds of each slab */
    int ast_flags;              /* Basic flags to use with astRebinSeq */
    int blk_size;               /* Number of channels processed by a single thread */
    int found;                  /* Was current detector name found in detgrp? */
    int iblock;                 /* Index of current spectral block */
+   int incpos;                 /* Does ssmap increase monotonically? */
+   int islab;                  /* Index of current spectral slab */
    dim_t ichan;                /* Index of current channel */
    dim_t idet;                 /* detector index */
    int ignore;                 /* Ignore this time slice? */
@@ -277,14 +293,18 @@ void smf_rebincube_ast( ThrWorkForce *wf, smfData *data, int first, int last,
    int64_t junk;               /* Unused parameter */
    int lbnd_in[ 2 ];           /* Lower input bounds on receptor axis */
    int ldim[ 3 ];              /* Output array lower GRID bounds */
+   int margin;                 /* No. of output channels beyond each slab */
    int maxthreads;             /* Max no. of threads to use when re-binning */
    int nblock;                 /* Number of spectral blocks */
+   int nslab;                  /* Number of disjoint spectral slabs */
    int nthreads;               /* Number of threads to use when re-binning */
    int outperm[ 3 ];           /* Output axis permutation array */
+   int slab_size;              /* Number of output channels in each slab */
    int timeslice_size;         /* Number of elements in a time slice */
    int ubnd_in[ 2 ];           /* Upper input bounds on receptor axis */
    int uddim[ 1 ];             /* Detector array upper GRID bounds */
    int udim[ 3 ];              /* Output array upper GRID bounds */
+   int width;                  /* Width of the spreading kernel */
    smfHead *hdr = NULL;        /* Pointer to data header for this time slice */
 
 /* Check the inherited status. */
@@ -414,8 +434,115 @@ void smf_rebincube_ast( ThrWorkForce *wf, smfData *data, int first, int last,
    inperm[ 2 ] = 2;
    pmap = astPermMap( 3, inperm, 3, outperm, NULL, " " );
 
-/* If we are using multiple threads to rebin spectral blocks in parallel,
-   calculate the number of channels that are processed by each thread,
+/* If multiple threads are available, and output variances are not
+   being estimated from the spread of input values, divide the output
+   spectrum into disjoint slabs of channels, each of which is re-binned
+   by a separate thread (see smf_rebincube_slabf). Each slab must be
+   at least as wide as the spreading kernel so that the input channels
+   that spill into it from its neighbours do not dominate the work. The
+   AST__GENVAR flag cannot be used in this way because it requires a
+   second weights array that astRebinSeq locates using the size of the
+   whole output cube. */
+   nslab = 0;
+   maxthreads = wf ? wf->nworker : 1;
+   if( maxthreads > 1 && genvar != 1 ) {
+      width = smf_spreadwidth( spread, params, status );
+      nslab = dim[ 2 ]/width;
+      if( nslab > maxthreads ) nslab = maxthreads;
+
+      if( nslab > 1 ) {
+         slab_size = ( dim[ 2 ] - 1 )/nslab + 1;
+         nslab = ( dim[ 2 ] - 1 )/slab_size + 1;
+         margin = ( width + 1 )/2;
+
+/* Store the output channel boundaries between the slabs, followed by
+   the lower and upper boundaries of each slab extended by the width
+   of the spreading kernel. Then convert them all into input channel
+   numbers. */
+         slab_pos = astMalloc( ( 3*nslab + 1 )*sizeof( *slab_pos ) );
+         slab_bnd = astMalloc( 6*nslab*sizeof( *slab_bnd ) );
+         if( *status == SAI__OK ) {
+            for( islab = 0; islab <= nslab; islab++ ) {
+               slab_pos[ islab ] = islab*slab_size + 0.5;
+            }
+            slab_pos[ nslab ] = dim[ 2 ] + 0.5;
+
+            for( islab = 0; islab < nslab; islab++ ) {
+               slab_pos[ nslab + 1 + islab ] = slab_pos[ islab ] - margin;
+               slab_pos[ 2*nslab + 1 + islab ] = slab_pos[ islab + 1 ] +
+                                                 margin;
+            }
+
+            astTran1( ssmap, 3*nslab + 1, slab_pos, 0, slab_pos );
+
+            for( islab = 0; islab <= 3*nslab; islab++ ) {
+               if( slab_pos[ islab ] == AST__BAD ) nslab = 0;
+            }
+         }
+         if( *status != SAI__OK ) nslab = 0;
+
+/* Each input channel is owned by the slab that contains its output
+   position. The input channels that fall beyond the ends of the output
+   spectrum are owned by the first or last slab, so that every input
+   channel is owned by exactly one slab. */
+         if( nslab > 1 ) {
+            incpos = ( slab_pos[ nslab ] > slab_pos[ 0 ] );
+            slab_pos[ 0 ] = incpos ? 1.0 : nchan + 1.0;
+            slab_pos[ nslab ] = incpos ? nchan + 1.0 : 1.0;
+
+            for( islab = 0; islab < nslab; islab++ ) {
+               sb = slab_bnd + 6*islab;
+
+/* The output channels in the slab. */
+               sb[ 0 ] = islab*slab_size + 1;
+               sb[ 1 ] = sb[ 0 ] + slab_size - 1;
+               if( sb[ 1 ] > (int) dim[ 2 ] ) sb[ 1 ] = dim[ 2 ];
+
+/* The input channels owned by the slab. */
+               lo = incpos ? slab_pos[ islab ] : slab_pos[ islab + 1 ];
+               hi = incpos ? slab_pos[ islab + 1 ] : slab_pos[ islab ];
+               sb[ 2 ] = (int) ceil( lo );
+               sb[ 3 ] = (int) ceil( hi ) - 1;
+               if( sb[ 2 ] < 1 ) sb[ 2 ] = 1;
+               if( sb[ 3 ] > (int) nchan ) sb[ 3 ] = nchan;
+
+/* The input channels that may contribute to the slab. This range always
+   encloses the owned channels. */
+               elo = slab_pos[ nslab + 1 + islab ];
+               ehi = slab_pos[ 2*nslab + 1 + islab ];
+               if( elo > ehi ) {
+                  dtemp = elo;
+                  elo = ehi;
+                  ehi = dtemp;
+               }
+               sb[ 4 ] = (int) floor( elo );
+               sb[ 5 ] = (int) ceil( ehi );
+               if( sb[ 3 ] >= sb[ 2 ] ) {
+                  if( sb[ 4 ] > sb[ 2 ] ) sb[ 4 ] = sb[ 2 ];
+                  if( sb[ 5 ] < sb[ 3 ] ) sb[ 5 ] = sb[ 3 ];
+               }
+               if( sb[ 4 ] < 1 ) sb[ 4 ] = 1;
+               if( sb[ 5 ] > (int) nchan ) sb[ 5 ] = nchan;
+            }
+
+            if( data->file ) {
+               msgOutiff( MSG__DEBUG, " ", "smf_rebincube_ast: Using %d "
+                          "spectral slabs to process data file '%s'.",
+                          status, nslab, data->file->name );
+            }
+         } else {
+            nslab = 0;
+         }
+         slab_pos = astFree( slab_pos );
+
+      } else {
+         nslab = 0;
+      }
+   }
+
+/* Otherwise, if we are using multiple threads to rebin spectral blocks in
+   parallel, calculate the number of channels that are processed by each
+   thread,
    and the number of threads to use. The whole output spectrum is divided
    up into blocks. The number of blocks is two times the number of
    threads, and each thread rebins two adjacent blocks. Alternate blocks
@@ -426,9 +553,8 @@ void smf_rebincube_ast( ThrWorkForce *wf, smfData *data, int first, int last,
    width produced by the requested spreading scheme. This means that no
    pair of simultanously executing threads will ever try to write to the
    same channel of the output spectrum. */
-   maxthreads = wf ? wf->nworker : 1;
    if( maxthreads > MAXTHREADS ) maxthreads = MAXTHREADS;
-   if( maxthreads > 1 ) {
+   if( maxthreads > 1 && nslab == 0 ) {
 
 /* Find the largest number of threads into which each output spectrum can
    be split. The limit is imposes by the requirement that each block is
@@ -475,8 +601,8 @@ void smf_rebincube_ast( ThrWorkForce *wf, smfData *data, int first, int last,
          blk_bot[ 1 ] = (double) ( dim[ 2 ] + 1 );
       }
 
-/* If multiple threads are not available, we process the whole spectrum
-   in a single thread. */
+/* If multiple threads are not available, or disjoint slabs are being
+   used, we process the whole spectrum in a single block. */
    } else {
       nthreads = 1;
       nblock = 1;
@@ -612,15 +738,24 @@ void smf_rebincube_ast( ThrWorkForce *wf, smfData *data, int first, int last,
       }
 
 /* Unless we are ignoring this time slice, paste it into the 3D output
-   cube. The smf_rebincube_seqf function is a wrapper for astRebinSeqF
-   that splits the total job up between "nthreads" threads running in
-   parallel. */
+   cube. The smf_rebincube_slabf and smf_rebincube_seqf functions are
+   wrappers for astRebinSeqF that split the total job up between several
+   threads running in parallel. */
       if( !ignore ) {
-         smf_rebincube_seqf( wf, nthreads, blk_bot, fullmap, 0.0, 2, lbnd_in,
-                             ubnd_in, tdata, varwork, spread, params,
-                             ast_flags, 0.0, 50, VAL__BADR, 3, ldim, udim,
-                             lbnd_in, ubnd_in, data_array, var_array,
-                             wgt_array, nused, status );
+         if( nslab > 1 ) {
+            smf_rebincube_slabf( wf, nslab, slab_bnd, fullmap, 0.0, 2,
+                                 lbnd_in, ubnd_in, tdata, varwork, spread,
+                                 params, ast_flags, 0.0, 50, VAL__BADR, 3,
+                                 ldim, udim, lbnd_in, ubnd_in, data_array,
+                                 genvar ? var_array : NULL, wgt_array,
+                                 nused, status );
+         } else {
+            smf_rebincube_seqf( wf, nthreads, blk_bot, fullmap, 0.0, 2,
+                                lbnd_in, ubnd_in, tdata, varwork, spread,
+                                params, ast_flags, 0.0, 50, VAL__BADR, 3,
+                                ldim, udim, lbnd_in, ubnd_in, data_array,
+                                var_array, wgt_array, nused, status );
+         }
 
 /* Now we update the total exposure time array. Scale the exposure time
    of this time slice in order to reduce its influence on the output
@@ -702,6 +837,7 @@ void smf_rebincube_ast( ThrWorkForce *wf, smfData *data, int first, int last,
 /* Free resources. */
    detlut = astFree( detlut );
    detwork = astFree( detwork );
+   slab_bnd = astFree( slab_bnd );
    varwork = astFree( varwork );
 }
 
@@ -157,6 +157,16 @@
 *     Specialised code is used that only provides Nearest Neighbour
 *     spreading when pasting each input pixel value into the output cube.
 *
+*     If more than one worker thread is available, the output position
+*     and weight of every input spectrum are first found (in time slice
+*     order) and stored. The spectra are then sorted into order of
+*     output spatial pixel, and each thread pastes the spectra for a
+*     separate contiguous range of output pixels. Threads therefore never
+*     write to the same output spectrum, whatever the number of
+*     detectors, and the spectra contributing to each output spectrum are
+*     pasted in the same order as in the single-threaded case, so the
+*     results do not depend on the number of threads.
+*
 *     Note, few checks are performed on the validity of the input data
 *     files in this function, since they have already been checked within
 *     smf_cubebounds.
@@ -190,6 +200,14 @@
 *        Fix bug in initialisation of detector data structures.
 *     11-FEB-2009 (DSB):
 *        Ignore negative or zero input Tsys values.
+*     14-OCT-2026:
+*        When multi-threaded, give each thread a range of output pixels
+*        rather than a single detector, so that the number of threads in
+*        use is not limited to the number of detectors, and the data are
+*        no longer pasted in a single thread if two detectors fall in the
+*        same output pixel.
+*     14-OCT-2026:
+*        Use smf_rebincube_specoff to detect simple channel offsets.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -218,6 +236,7 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include <stdint.h>
 
@@ -233,6 +252,37 @@
 /* SMURF includes */
 #include "libsmf/smf.h"
 
+/* Local data types */
+
+/* An input spectrum to be pasted into the output cube. */
+typedef struct smfRebincubeNNSample {
+   dim_t isamp;
+   double invar;
+   double wgt;
+   float *ddata;
+   float teff;
+   float texp;
+   int iv0;
+} SmfRebincubeNNSample;
+
+/* Data for a worker thread that pastes a range of sorted spectra. */
+typedef struct smfRebincubeNNData {
+   SmfRebincubeNNSample *samples;
+   dim_t s1;
+   dim_t s2;
+   double tfac;
+   float *teff_array;
+   float *texp_array;
+   int64_t nused;
+   int naccept;
+   int nreject;
+   smfRebincubeNNArgs1 *common;
+} SmfRebincubeNNData;
+
+/* Prototypes for local static functions. */
+static int smf1_rebincube_nn_cmp( const void *a, const void *b );
+static void smf1_rebincube_nn( void *job_data_ptr, int *status );
+
 #define FUNC_NAME "smf_rebincube_nn"
 
 void smf_rebincube_nn( ThrWorkForce *wf, smfData *data, int first, int last,
@@ -249,14 +299,23 @@ void smf_rebincube_nn( ThrWorkForce *wf, smfData *data, int first, int last,
 
 /* Local Variables */
    AstMapping *totmap = NULL;  /* WCS->GRID Mapping from input WCS FrameSet */
+   SmfRebincubeNNData *job_data = NULL; /* Data for each worker thread */
+   SmfRebincubeNNData *pdata;  /* Pointer to data for next worker thread */
+   SmfRebincubeNNSample *psamp;/* Pointer to next stored input spectrum */
+   SmfRebincubeNNSample *samples = NULL; /* Stored input spectra */
+   smfRebincubeNNArgs1 common_data; /* Holds data common to all spectra */
    const char *name = NULL;    /* Pointer to current detector name */
    const double *tsys = NULL;  /* Pointer to Tsys value for first detector */
    dim_t gxout;                /* Output X grid index */
    dim_t gyout;                /* Output Y grid index */
    dim_t ichan;                /* Input channel index */
    dim_t idet;                 /* detector index */
+   dim_t ihi;                  /* Last input channel with an output channel */
+   dim_t ilo;                  /* First input channel with an output channel */
    dim_t itime;                /* Index of current time slice */
+   dim_t isamp;                /* Index of stored input spectrum */
    dim_t nchanout;             /* No of spectral channels in the output */
+   dim_t nsamp;                /* No of stored input spectra */
    dim_t timeslice_size;       /* No of detector values in one time slice */
    double *detxin = NULL;      /* Work space for input X grid coords */
    double *detxout = NULL;     /* Work space for output X grid coords */
@@ -274,21 +333,18 @@ void smf_rebincube_nn( ThrWorkForce *wf, smfData *data, int first, int last,
    int *nexttime;              /* Pointer to next time slice index to use */
    int *specpop = NULL;        /* Input channels per output channel */
    int *spectab = NULL;        /* I/p->o/p channel number conversion table */
-   int first_ts;               /* Is this the first time slice? */
    int found;                  /* Was current detector name found in detgrp? */
    int ignore;                 /* Ignore this time slice? */
-   int init_detector_data;     /* Should detector_data be initialised? */
    int iv0;                    /* Offset for pixel in 1st o/p spectral channel */
-   int jdet;                   /* Detector index */
+   int iw;                     /* Thread index */
    int naccept_old;            /* Previous number of accepted spectra */
+   int nw;                     /* Number of worker threads */
    int ochan;                  /* Output channel index */
+   int specoff;                /* Output channel offset, or VAL__BADI */
    int use_threads;            /* Use multiple threads? */
    smfHead *hdr = NULL;        /* Pointer to data header for this time slice */
 
-   static smfRebincubeNNArgs1 *common_data = NULL; /* Holds data common to all detectors */
-   static smfRebincubeNNArgs2 *detector_data = NULL; /* Holds data for each detector */
    static int *pop_array = NULL;/* I/p spectra pasted into each output spectrum */
-   static dim_t ndet_max = 0;  /* Max number of detectors */
 
 /* Check the inherited status. */
    if( *status != SAI__OK ) return;
@@ -304,6 +360,11 @@ void smf_rebincube_nn( ThrWorkForce *wf, smfData *data, int first, int last,
    smf_rebincube_spectab( nchan, dim[ 2 ], ssmap, &spectab, status );
    if( !spectab ) goto L999;
 
+/* See if the input channels map onto a contiguous range of output
+   channels, in which case the spectra can be pasted without using
+   "spectab". */
+   specoff = smf_rebincube_specoff( nchan, spectab, &ilo, &ihi, status );
+
 /* The 2D weighting scheme assumes that each output channel receives
    contributions from one and only one input channel in each input file.
    Create an array with an element for each output channel, holding the
@@ -388,9 +449,52 @@ void smf_rebincube_nn( ThrWorkForce *wf, smfData *data, int first, int last,
 /* Initialise the progress meter. */
    smf_reportprogress( itime, status );
 
+/* If we have more than one thread, the input spectra are stored as they
+   are found, and pasted into the output cube once all time slices have
+   been processed. Allocate room for one spectrum per detector per time
+   slice, and store the information that is common to all spectra. */
+   nw = wf ? wf->nworker : 1;
+   use_threads = ( nw > 1 );
+   nsamp = 0;
+   if( use_threads ) {
+      if( data->file ) {
+         msgOutiff( MSG__DEBUG, " ", "smf_rebincube_nn: Using multiple "
+                    "threads to process data file '%s'.", status,
+                    data->file->name );
+      }
+      samples = astMalloc( itime*ndet*sizeof( *samples ) );
+
+      common_data.badmask = badmask;
+      common_data.nchan = nchan;
+      common_data.nchanout = nchanout;
+      common_data.spectab = spectab;
+      common_data.specpop = specpop;
+      common_data.specoff = specoff;
+      common_data.ilo = ilo;
+      common_data.ihi = ihi;
+      common_data.nxy = nxy;
+      common_data.genvar = genvar;
+      common_data.data_array = data_array;
+      common_data.var_array = var_array;
+      common_data.wgt_array = wgt_array;
+      common_data.pop_array = pop_array;
+      common_data.nout = nout;
+      common_data.is2d = is2d;
+
+/* If we are using a single thread, we need an extra work array for 2D
+   weighting that can hold a single output spectrum. This is used as a
+   staging post for each input spectrum prior to pasting it into the
+   output cube. */
+   } else {
+      if( data->file ) {
+         msgOutiff( MSG__DEBUG, " ", "smf_rebincube_nn: Using a single "
+                    "thread to process data file '%s'.", status,
+                    data->file->name );
+      }
+      work = astMalloc( nchanout*sizeof( float ) );
+   }
+
 /* Loop round all time slices in the input NDF. */
-   use_threads = 0;
-   first_ts = 1;
    for( itime = 0; itime < nslice && *status == SAI__OK; itime++ ) {
 
 /* If this time slice is not being pasted into the output cube, pass on. */
@@ -433,117 +537,9 @@ void smf_rebincube_nn( ThrWorkForce *wf, smfData *data, int first, int last,
    detector. */
       astTran2( totmap, ndet, detxin, detyin, 1, detxout, detyout );
 
-/* If this is the first time slice from the current input file to be pasted
-   into the output, see if any of the spectra will end up being pasted on
-   top of each other in the output. If not we can use a separate thread to
-   paste each spectrum. Otherwise, we cannot use multiple threads since they
-   may end up trying to write to the same output pixel at the same time. */
-      if( first_ts ) {
-         first_ts = 0;
-         use_threads = wf ? 1 : 0;
-         for( idet = 0; idet < ndet - 1 && use_threads; idet++ ) {
-            if( detxout[ idet ] != AST__BAD && detyout[ idet ] != AST__BAD ){
-
-               gxout = floor( detxout[ idet ] + 0.5 );
-               gyout = floor( detyout[ idet ] + 0.5 );
-
-               if( gxout >= 1 && gxout <= dim[ 0 ] &&
-                   gyout >= 1 && gyout <= dim[ 1 ] ) {
-
-                  for( jdet = idet + 1; idet < ndet; idet++ ) {
-                     if( detxout[ jdet ] != AST__BAD &&
-                         detyout[ jdet ] != AST__BAD ){
-
-                        if( floor( detxout[ jdet ] + 0.5 ) == gxout &&
-                            floor( detyout[ jdet ] + 0.5 ) == gyout ) {
-                           use_threads = 0;
-                           break;
-                        }
-                     }
-                  }
-
-               }
-            }
-         }
-
-/* If we will be using mutiple threads, do some preparation. */
-         if( use_threads ) {
-            if( data->file ) {
-               msgOutiff( MSG__DEBUG, " ", "smf_rebincube_nn: Using multiple "
-                          "threads to process data file '%s'.", status,
-                          data->file->name );
-            }
-
-/* Ensure we have a structure holding information which is common to all
-   detectors and time slices. */
-            common_data = astGrow( common_data, sizeof( smfRebincubeNNArgs1 ), 1 );
-            if( astOK ) {
-               common_data->badmask = badmask;
-               common_data->nchan = nchan;
-               common_data->nchanout = nchanout;
-               common_data->spectab = spectab;
-               common_data->specpop = specpop;
-               common_data->nxy = nxy;
-               common_data->genvar = genvar;
-               common_data->data_array = data_array;
-               common_data->var_array = var_array;
-               common_data->wgt_array = wgt_array;
-               common_data->pop_array = pop_array;
-               common_data->nout = nout;
-               common_data->is2d = is2d;
-            }
-
-/* Ensure we have a structure for each detector to hold the detector-specific
-   data, plus a pointer to the common data. */
-            init_detector_data = ( detector_data == NULL );
-            if( init_detector_data ) ndet_max = 0;
-            detector_data = astGrow( detector_data, sizeof( smfRebincubeNNArgs2 ),
-                                     ndet ) ;
-
-/* Initialise pointers stored within any new elements added to the
-   "detector_data" array. */
-            if( ndet > ndet_max && astOK ) {
-               for( idet = ndet_max; idet < ndet; idet++ ) {
-                  detector_data[ idet ].common = NULL;
-                  detector_data[ idet ].work = NULL;
-                  detector_data[ idet ].ddata = NULL;
-               }
-               ndet_max = ndet;
-            }
-
-/* Allocate work space for each detector and store the common data
-   pointer. */
-            if( astOK ) {
-               for( idet = 0; idet < ndet; idet++ ) {
-                  detector_data[ idet ].common = common_data;
-                  detector_data[ idet ].work = astGrow( detector_data[ idet ].work,
-                                                        sizeof( float ), nchanout );
-               }
-            }
-
-/* If we are using a single threads, do some alternative preparation. */
-         } else {
-            if( data->file ) {
-               msgOutiff( MSG__DEBUG, " ", "smf_rebincube_nn: Using a single "
-                          "thread to process data file '%s'.", status,
-                          data->file->name );
-            }
-
-/* We need an extra work array for 2D weighting that can hold a single
-   output spectrum. This is used as a staging post for each input
-   spectrum prior to pasting it into the output cube. */
-            work = astMalloc( nchanout*sizeof( float ) );
-
-         }
-      }
-
 /* Loop round each detector, pasting its spectral values into the output
    cube. */
-      for( idet = 0; idet < ndet; idet++ ) {
-
-/* If multi-threaded, initialise a bad value for the detector's weight
-   to indicate that it is not being used. */
-         if( use_threads ) detector_data[ idet ].wgt = VAL__BADD;
+      for( idet = 0; idet < ndet && *status == SAI__OK; idet++ ) {
 
 /* See if any good tsys values are present. */
          rtsys = tsys ? (float) tsys[ idet ] : VAL__BADR;
@@ -605,13 +601,15 @@ void smf_rebincube_nn( ThrWorkForce *wf, smfData *data, int first, int last,
 
                      if( is2d ) {
                         smf_rebincube_paste2d( badmask, nchan, nchanout, spectab,
-                                               specpop, iv0, nxy, wgt, genvar,
+                                               specpop, specoff, ilo, ihi,
+                                               iv0, nxy, wgt, genvar,
                                                invar, ddata, data_array,
                                                var_array, wgt_array, pop_array,
                                                nused, nreject, naccept, work,
                                                status );
                      } else {
-                        smf_rebincube_paste3d( nchan, nout, spectab, iv0, nxy,
+                        smf_rebincube_paste3d( nchan, nout, spectab, specoff,
+                                               ilo, ihi, iv0, nxy,
                                                wgt, genvar, invar, ddata,
                                                data_array, var_array,
                                                wgt_array, nused, status );
@@ -629,23 +627,17 @@ void smf_rebincube_nn( ThrWorkForce *wf, smfData *data, int first, int last,
                         teff_array[ iv0 ] += teff*tfac;
                      }
 
-/* Now deal with cases where we are using several threads. */
-                  } else {
-
-/* Set up the detector specific data. */
-                     detector_data[ idet ].iv0 = iv0;
-                     detector_data[ idet ].wgt = wgt;
-                     detector_data[ idet ].invar = invar;
-                     detector_data[ idet ].ddata = ddata;
-                     detector_data[ idet ].nused = 0;
-                     detector_data[ idet ].nreject = 0;
-                     detector_data[ idet ].naccept = 0;
-
-/* Add a job to the workforce's job list. This job calls smf_rebincube_paste2d
-   or smf_rebincube_paste3d to paste the detector input spectrum into the
-   output cube. */
-                     thrAddJob( wf, 0, detector_data + idet,
-                                  smf_rebincube_paste_thread, 0, NULL, status );
+/* Now deal with cases where we are using several threads. Just store
+   the spectrum so that it can be pasted later. */
+                  } else if( samples ) {
+                     psamp = samples + nsamp;
+                     psamp->isamp = nsamp++;
+                     psamp->iv0 = iv0;
+                     psamp->wgt = wgt;
+                     psamp->invar = invar;
+                     psamp->ddata = ddata;
+                     psamp->texp = texp;
+                     psamp->teff = teff;
                   }
 
                } else if( data->file ) {
@@ -666,25 +658,6 @@ void smf_rebincube_nn( ThrWorkForce *wf, smfData *data, int first, int last,
          }
       }
 
-/* If using multiple threads, wait until all spectra for this time slice
-   have been pasted into the output cube. Then transfer the output values
-   from the detector data structures to the returned variables. */
-      if( use_threads ) {
-         thrWait( wf, status );
-         for( idet = 0; idet < ndet; idet++ ) {
-            if( detector_data[ idet ].wgt != VAL__BADD ) {
-               (*nused) += detector_data[ idet ].nused;
-               (*nreject) += detector_data[ idet ].nreject;
-               (*naccept) += detector_data[ idet ].naccept;
-
-               if( texp != VAL__BADR && detector_data[ idet ].naccept > 0 ) {
-                  texp_array[ detector_data[ idet ].iv0 ] += texp*tfac;
-                  teff_array[ detector_data[ idet ].iv0 ] += teff*tfac;
-               }
-            }
-         }
-      }
-
 /* Update the progress meter. */
       smf_reportprogress( 0, status );
 
@@ -692,6 +665,55 @@ void smf_rebincube_nn( ThrWorkForce *wf, smfData *data, int first, int last,
       astEnd;
    }
 
+/* If using multiple threads, sort the stored spectra into order of
+   output pixel. Spectra that fall in the same output pixel stay in the
+   order in which they were found. */
+   if( use_threads && nsamp > 0 && *status == SAI__OK ) {
+      qsort( samples, nsamp, sizeof( *samples ), smf1_rebincube_nn_cmp );
+
+/* Divide the sorted spectra into roughly equal ranges, one for each
+   thread, adjusting the end of each range so that all the spectra for
+   an output pixel are handled by the same thread. */
+      job_data = astMalloc( nw*sizeof( *job_data ) );
+      if( *status == SAI__OK ) {
+         isamp = 0;
+         for( iw = 0; iw < nw; iw++ ) {
+            pdata = job_data + iw;
+            pdata->s1 = isamp;
+            if( iw < nw - 1 ) {
+               isamp = ( ( iw + 1 )*nsamp )/nw;
+               if( isamp < pdata->s1 ) isamp = pdata->s1;
+               while( isamp > 0 && isamp < nsamp &&
+                      samples[ isamp ].iv0 == samples[ isamp - 1 ].iv0 ) {
+                  isamp++;
+               }
+            } else {
+               isamp = nsamp;
+            }
+            pdata->s2 = isamp;
+            pdata->samples = samples;
+            pdata->common = &common_data;
+            pdata->tfac = tfac;
+            pdata->texp_array = texp_array;
+            pdata->teff_array = teff_array;
+
+/* Submit a job that pastes this range of spectra into the output cube. */
+            thrAddJob( wf, 0, pdata, smf1_rebincube_nn, 0, NULL, status );
+         }
+
+/* Wait for all the jobs to complete, and then transfer the output values
+   from the job data to the returned variables. */
+         thrWait( wf, status );
+         for( iw = 0; iw < nw; iw++ ) {
+            pdata = job_data + iw;
+            (*nused) += pdata->nused;
+            (*nreject) += pdata->nreject;
+            (*naccept) += pdata->naccept;
+         }
+      }
+      job_data = astFree( job_data );
+   }
+
 /* If this is the final pass through this function, normalise the returned
    data and variance values, and release any static resources allocated
    within this function. */
@@ -705,18 +727,11 @@ void smf_rebincube_nn( ThrWorkForce *wf, smfData *data, int first, int last,
       }
 
       pop_array = astFree( pop_array );
-
-      if( use_threads ) {
-         common_data = astFree( common_data );
-         for( idet = 0; idet < ndet_max; idet++ ) {
-            detector_data[ idet ].work = astFree( detector_data[ idet ].work );
-         }
-         detector_data = astFree( detector_data );
-      }
    }
 
 /* Free non-static resources. */
 L999:;
+   samples = astFree( samples );
    work = astFree( work );
    spectab = astFree( spectab );
    specpop = astFree( specpop );
@@ -726,3 +741,98 @@ L999:;
    detyout = astFree( detyout );
 
 }
+
+
+static int smf1_rebincube_nn_cmp( const void *a, const void *b ) {
+/*
+*  Name:
+*     smf1_rebincube_nn_cmp
+
+*  Purpose:
+*     Comparison function for sorting stored input spectra by output
+*     pixel.
+
+*  Description:
+*     Spectra are sorted into increasing order of output pixel offset,
+*     and spectra with the same output pixel are sorted into the order
+*     in which they were stored.
+*/
+   const SmfRebincubeNNSample *sa = (const SmfRebincubeNNSample *) a;
+   const SmfRebincubeNNSample *sb = (const SmfRebincubeNNSample *) b;
+
+   if( sa->iv0 < sb->iv0 ) return -1;
+   if( sa->iv0 > sb->iv0 ) return 1;
+   if( sa->isamp < sb->isamp ) return -1;
+   if( sa->isamp > sb->isamp ) return 1;
+   return 0;
+}
+
+
+static void smf1_rebincube_nn( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_rebincube_nn
+
+*  Purpose:
+*     Executed in a worker thread to paste a range of sorted input
+*     spectra into the output cube for smf_rebincube_nn.
+
+*  Invocation:
+*     smf1_rebincube_nn( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = SmfRebincubeNNData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+/* Local Variables: */
+   SmfRebincubeNNData *pdata;
+   SmfRebincubeNNSample *psamp;
+   dim_t isamp;
+   smfRebincubeNNArgs2 args;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Get a pointer that can be used for accessing the required items in the
+   supplied structure. */
+   pdata = (SmfRebincubeNNData *) job_data_ptr;
+   pdata->nused = 0;
+   pdata->nreject = 0;
+   pdata->naccept = 0;
+
+/* Each spectrum is pasted using smf_rebincube_paste_thread, with a work
+   array that is private to this thread. */
+   args.common = pdata->common;
+   args.work = astMalloc( pdata->common->nchanout*sizeof( float ) );
+
+   for( isamp = pdata->s1; isamp < pdata->s2 && *status == SAI__OK; isamp++ ) {
+      psamp = pdata->samples + isamp;
+      args.iv0 = psamp->iv0;
+      args.wgt = psamp->wgt;
+      args.invar = psamp->invar;
+      args.ddata = psamp->ddata;
+      args.nused = 0;
+      args.nreject = 0;
+      args.naccept = 0;
+
+      smf_rebincube_paste_thread( &args, status );
+
+      pdata->nused += args.nused;
+      pdata->nreject += args.nreject;
+      pdata->naccept += args.naccept;
+
+/* Update the total and effective exposure time arrays for the output
+   spectrum if the input spectrum was used. */
+      if( psamp->texp != VAL__BADR && args.naccept > 0 ) {
+         pdata->texp_array[ psamp->iv0 ] += psamp->texp*pdata->tfac;
+         pdata->teff_array[ psamp->iv0 ] += psamp->teff*pdata->tfac;
+      }
+   }
+
+   args.work = astFree( args.work );
+}
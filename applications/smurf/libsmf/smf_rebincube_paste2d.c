@@ -15,7 +15,8 @@
 
 *  Invocation:
 *     void smf_rebincube_paste2d( int badmask, dim_t nchan, int nchanout,
-*                                 int *spectab, int *specpop, dim_t iv0,
+*                                 int *spectab, int *specpop, int specoff,
+*                                 dim_t ilo, dim_t ihi, dim_t iv0,
 *                                 dim_t nxy, double wgt, int genvar,
 *                                 double invar, float *ddata,
 *                                 float *data_array, float *var_array,
@@ -51,6 +52,15 @@
 *        into the output channel. If a NULL value is supplied, it is
 *        assumed that every output channel is contributed to by 1 input
 *        channel.
+*     specoff = int (Given)
+*        The value returned by smf_rebincube_specoff for "spectab". If
+*        this is not VAL__BADI, "spectab" is not used, and input channel
+*        "ichan" is pasted into output channel "ichan + specoff" if
+*        "ichan" is in the range "ilo" to "ihi".
+*     ilo = dim_t (Given)
+*        The first input channel to use if "specoff" is not VAL__BADI.
+*     ihi = dim_t (Given)
+*        The last input channel to use if "specoff" is not VAL__BADI.
 *     iv0 = dim_t (Given)
 *        The index within the output cube of the pixel corresponding to
 *        channel zero of the output spectrum into which the input spectrum
@@ -118,6 +128,10 @@
 *        Added parameter naccept.
 *     16-JUL-2007 (DSB):
 *        Ignore input spectra that contain no good data.
+*     14-OCT-2026:
+*        Added arguments specoff, ilo and ihi, and a faster way to fill
+*        the work array for the case where the input channels map onto a
+*        contiguous range of output channels.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -159,7 +173,8 @@
 #define FUNC_NAME "smf_rebincube_paste2d"
 
 void smf_rebincube_paste2d( int badmask, dim_t nchan, int nchanout,
-                            int *spectab, int *specpop, dim_t iv0,
+                            int *spectab, int *specpop, int specoff,
+                            dim_t ilo, dim_t ihi, dim_t iv0,
                             dim_t nxy, double wgt, int genvar,
                             double invar, float *ddata,
                             float *data_array, float *var_array,
@@ -172,6 +187,7 @@ void smf_rebincube_paste2d( int badmask, dim_t nchan, int nchanout,
    float *qdata = NULL;        /* Pointer to next input data value */
    float swdd;                 /* Sum of squared input data value times weight */
    dim_t ichan;                /* Index of input channel */
+   float *qwork = NULL;        /* Pointer to next work value */
    int ochan;                  /* Index of output channel */
    int ignore;                 /* Ignore this time slice? */
    int64_t nspecused;          /* No of input values pasted into output spectrum */
@@ -186,18 +202,33 @@ void smf_rebincube_paste2d( int badmask, dim_t nchan, int nchanout,
    the work array to hold zero at every output channel, except for those
    output channels to which no input channels contribute. Store bad values
    for such channels. */
-   for( ochan = 0; ochan < nchanout; ochan++ ) {
-      if( specpop[ ochan ] == 0 ) {
-         work[ ochan ] = VAL__BADR;
-      } else {
-         work[ ochan ] = 0;
+
+/* If the input channels map onto a contiguous range of output channels,
+   each of those output channels receives exactly one input channel, and
+   all other output channels are bad. So the work array is just a copy of
+   the input channels (adding a good value to zero and dividing it by one
+   does not change it). */
+   if( specoff != VAL__BADI ) {
+      for( ochan = 0; ochan < nchanout; ochan++ ) work[ ochan ] = VAL__BADR;
+      qdata = ddata + ilo;
+      qwork = work + ilo + specoff;
+      for( ichan = ilo; ichan <= ihi; ichan++ ) *(qwork++) = *(qdata++);
+
+/* Otherwise, initialise the work array... */
+   } else {
+      for( ochan = 0; ochan < nchanout; ochan++ ) {
+         if( specpop[ ochan ] == 0 ) {
+            work[ ochan ] = VAL__BADR;
+         } else {
+            work[ ochan ] = 0;
+         }
       }
    }
 
-/* Loop round all channels of the input spectrum, pasting them into the
-   work array. */
+/* ... and loop round all channels of the input spectrum, pasting them into
+   the work array. */
    qdata = ddata;
-   for( ichan = 0; ichan < nchan; ichan++, qdata++ ) {
+   for( ichan = 0; ichan < nchan && specoff == VAL__BADI; ichan++, qdata++ ) {
 
 /* Get the corresponding output channel and check it is within the range
    of the output cube. */
@@ -16,6 +16,7 @@
 
 *  Invocation:
 *     void smf_rebincube_paste3d( dim_t nchan, dim_t nout, int *spectab,
+*                                 int specoff, dim_t ilo, dim_t ihi,
 *                                 dim_t iv0, dim_t nxy, double wgt,
 *                                 int genvar, double invar, float *ddata,
 *                                 float *data_array, float *var_array,
@@ -32,6 +33,15 @@
 *        hold the integer index (zero-based) of the nearest neighbouring
 *        output channel. A value of -1 should flag input channels that do
 *        not have any corresponding output channel.
+*     specoff = int (Given)
+*        The value returned by smf_rebincube_specoff for "spectab". If
+*        this is not VAL__BADI, "spectab" is not used, and input channel
+*        "ichan" is pasted into output channel "ichan + specoff" if
+*        "ichan" is in the range "ilo" to "ihi".
+*     ilo = dim_t (Given)
+*        The first input channel to use if "specoff" is not VAL__BADI.
+*     ihi = dim_t (Given)
+*        The last input channel to use if "specoff" is not VAL__BADI.
 *     iv0 = dim_t (Given)
 *        The index within the output cube of the pixel corresponding to
 *        channel zero of the output spectrum into which the input spectrum
@@ -84,6 +94,10 @@
 *  History:
 *     23-APR-2006 (DSB):
 *        Initial version.
+*     14-OCT-2026:
+*        Added arguments specoff, ilo and ihi, and a faster loop for
+*        the case where the input channels map onto a contiguous range
+*        of output channels.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -124,7 +138,8 @@
 
 #define FUNC_NAME "smf_rebincube_paste3d"
 
-void smf_rebincube_paste3d( dim_t nchan, dim_t nout, int *spectab, dim_t iv0,
+void smf_rebincube_paste3d( dim_t nchan, dim_t nout, int *spectab,
+                            int specoff, dim_t ilo, dim_t ihi, dim_t iv0,
                             dim_t nxy, double wgt, int genvar, double invar,
                             float *ddata, float *data_array,
                             float *var_array, double *wgt_array, int64_t *nused,
@@ -133,10 +148,62 @@ void smf_rebincube_paste3d( dim_t nchan, dim_t nout, int *spectab, dim_t iv0,
 /* Local Variables */
    dim_t iv;                   /* Vector index into output 3D array */
    dim_t ichan;                /* Index of current channel */
+   float *pd;                  /* Pointer to output data value */
+   float *pv;                  /* Pointer to output variance value */
+   double *pw;                 /* Pointer to output weight value */
+   int64_t ngood;              /* Number of good input values */
 
 /* Check the inherited status. */
    if( *status != SAI__OK ) return;
 
+/* If the input channels map onto a contiguous range of output channels,
+   step through the output arrays directly, with a separate loop for
+   each way of calculating variances. The arithmetic is the same as in
+   the general case below. */
+   if( specoff != VAL__BADI ) {
+      iv = iv0 + ( ilo + specoff )*nxy;
+      pd = data_array + iv;
+      pv = var_array ? var_array + iv : NULL;
+      pw = wgt_array + iv;
+      ngood = 0;
+
+      if( genvar == 2 ) {
+         for( ichan = ilo; ichan <= ihi; ichan++, pd += nxy, pv += nxy,
+                                        pw += nxy ) {
+            if( ddata[ ichan ] != VAL__BADR ) {
+               *pd += ddata[ ichan ]*wgt;
+               *pw += wgt;
+               *pv += wgt*wgt*invar;
+               ngood++;
+            }
+         }
+
+      } else if( genvar == 1 ) {
+         for( ichan = ilo; ichan <= ihi; ichan++, pd += nxy, pv += nxy,
+                                        pw += nxy ) {
+            if( ddata[ ichan ] != VAL__BADR ) {
+               *pd += ddata[ ichan ]*wgt;
+               *pw += wgt;
+               *pv += wgt*wgt;
+               pw[ nout ] += ddata[ ichan ]*ddata[ ichan ]*wgt;
+               ngood++;
+            }
+         }
+
+      } else {
+         for( ichan = ilo; ichan <= ihi; ichan++, pd += nxy, pw += nxy ) {
+            if( ddata[ ichan ] != VAL__BADR ) {
+               *pd += ddata[ ichan ]*wgt;
+               *pw += wgt;
+               ngood++;
+            }
+         }
+      }
+
+      (*nused) += ngood;
+      return;
+   }
+
 /* Loop round all spectral channels. */
    for( ichan = 0; ichan < nchan; ichan++, ddata++ ) {
 
@@ -37,6 +37,8 @@
 *  History:
 *     11-JUN-2008 (DSB):
 *        Initial version.
+*     14-OCT-2026:
+*        Pass the channel offset from smf_rebincube_specoff.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -86,7 +88,8 @@ void smf_rebincube_paste_thread( void *data_ptr, int *status ){
 /* 2D algorithm... */
    if( cdata->is2d ) {
       smf_rebincube_paste2d( cdata->badmask, cdata->nchan, cdata->nchanout,
-                             cdata->spectab, cdata->specpop, data->iv0,
+                             cdata->spectab, cdata->specpop, cdata->specoff,
+                             cdata->ilo, cdata->ihi, data->iv0,
                              cdata->nxy, data->wgt, cdata->genvar,
                              data->invar, data->ddata, cdata->data_array,
                              cdata->var_array, cdata->wgt_array,
@@ -97,6 +100,7 @@ void smf_rebincube_paste_thread( void *data_ptr, int *status ){
 /* 3D algorithm... */
    } else {
       smf_rebincube_paste3d( cdata->nchan, cdata->nout, cdata->spectab,
+                             cdata->specoff, cdata->ilo, cdata->ihi,
                              data->iv0, cdata->nxy, data->wgt,
                              cdata->genvar, data->invar, data->ddata,
                              cdata->data_array, cdata->var_array,
@@ -0,0 +1,343 @@
+/*
+*+
+*  Name:
+*     smf_rebincube_slabf
+
+*  Purpose:
+*     Rebin a cube with astRebinSeqF using disjoint spectral slabs.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     void smf_rebincube_slabf( ThrWorkForce *workforce, int nslab,
+*                               const int *slab_bnd, AstMapping *this,
+*                               double wlim, int ndim_in,
+*                               const int lbnd_in[], const int ubnd_in[],
+*                               const float in[], const float in_var[],
+*                               int spread, const double params[],
+*                               int flags, double tol, int maxpix,
+*                               float badval, int ndim_out,
+*                               const int lbnd_out[], const int ubnd_out[],
+*                               const int lbnd[], const int ubnd[],
+*                               float out[], float out_var[],
+*                               double weights[], int64_t *nused,
+*                               int *status );
+
+*  Arguments:
+*     workforce = ThrWorkForce * (Given)
+*        Pointer to a pool of threads, between which the requested rebinning
+*        can be divided.
+*     nslab = int (Given)
+*        The number of spectral slabs into which the output cube is
+*        divided. Each slab is re-binned by a separate job.
+*     slab_bnd = const int * (Given)
+*        An array holding six values for each slab. These are the
+*        first and last output channels in the slab, the first and last
+*        input channels "owned" by the slab, and the first and last input
+*        channels that may contribute to any output channel in the slab.
+*        See "Description" below.
+*
+*     <see docs for astRebinSeq for a description of the other arguments>
+*
+*     status = int * (Given and Returned)
+*        A pointer to the inherited status value.
+
+*  Description:
+*     This function uses several threads to re-bin the supplied cube
+*     using the supplied Mapping. The output cube is divided into
+*     disjoint slabs of spectral channels, and each thread re-bins the
+*     input data into a single slab. Since no two threads write to the
+*     same output pixel, all slabs can be processed at the same time,
+*     rather than in the two passes used by smf_rebincube_seqf.
+*
+*     Each thread calls astRebinSeqF with an output array that describes
+*     just its own slab, so any part of an input spectrum that is spread
+*     beyond the slab is ignored. The input channels are divided between
+*     the slabs so that every input channel is "owned" by exactly one
+*     slab (normally the slab containing its central output position).
+*     The thread first re-bins the input channels it owns, and then the
+*     channels just beyond them that may be spread into its slab by the
+*     spreading kernel. In this way each output pixel receives the same
+*     contributions as it would if the whole cube were re-binned in a
+*     single call. Only the owned input channels are included in the
+*     returned "nused" value, so that each input pixel is counted once.
+*
+*     It is assumed that the spectral axis is axis 1 in the input and
+*     the last axis in the output. This function cannot be used with the
+*     AST__GENVAR flag since astRebinSeq then expects the second half of
+*     the weights array to be at an offset determined by the size of the
+*     output array, which is different for each slab.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Initial version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdio.h>
+#include <stdint.h>
+
+/* Starlink includes */
+#include "ast.h"
+#include "ems.h"
+#include "mers.h"
+#include "sae_par.h"
+#include "star/thr.h"
+
+/* Smurf includes */
+#include "smf.h"
+#include "smf_typ.h"
+
+/* The maximum number of dimensions in the output cube. */
+#define MAXDIM 3
+
+/* Structure holding the data for a single slab. */
+typedef struct SmfRebinSlabData {
+   smfRebinSeqArgs args;       /* Arguments for astRebinSeqF */
+   const int *bnd;             /* Six bounds values for the slab */
+   int lbnd_out[ MAXDIM ];     /* Lower GRID bounds of the slab */
+   int ubnd_out[ MAXDIM ];     /* Upper GRID bounds of the slab */
+   int64_t nused;              /* Number of owned input pixels used */
+} SmfRebinSlabData;
+
+/* Prototypes for local static functions. */
+static void smf1_rebincube_slab( void *job_data_ptr, int *status );
+
+void smf_rebincube_slabf( ThrWorkForce *workforce, int nslab,
+                          const int *slab_bnd, AstMapping *this,
+                          double wlim, int ndim_in,
+                          const int lbnd_in[], const int ubnd_in[],
+                          const float in[], const float in_var[],
+                          int spread, const double params[],
+                          int flags, double tol, int maxpix,
+                          float badval, int ndim_out,
+                          const int lbnd_out[], const int ubnd_out[],
+                          const int lbnd[], const int ubnd[],
+                          float out[], float out_var[],
+                          double weights[], int64_t *nused,
+                          int *status ){
+
+/* Local Variables */
+   SmfRebinSlabData *data = NULL;    /* Pointer to data for a single slab */
+   dim_t offset;                     /* Vector index of first slab pixel */
+   dim_t plane;                      /* Number of pixels per output channel */
+   int i;                            /* Slab index */
+   int j;                            /* Axis index */
+   static SmfRebinSlabData *job_data = NULL; /* Data for all slabs */
+   static int *block_lbnd = NULL;    /* Lower bounds of input block */
+   static int *block_ubnd = NULL;    /* Upper bounds of input block */
+
+/* Check the inherited status. */
+   if( *status != SAI__OK ) return;
+
+/* Check the output cube has a supported number of axes. */
+   if( ndim_out > MAXDIM ) {
+      *status = SAI__ERROR;
+      errRepf( "", "smf_rebincube_slabf: Output cube has %d axes - no "
+               "more than %d are allowed (programming error).", status,
+               ndim_out, MAXDIM );
+      return;
+   }
+
+/* Find the number of output pixels in each plane of constant spectral
+   channel. */
+   plane = 1;
+   for( j = 0; j < ndim_out - 1; j++ ) {
+      plane *= (dim_t) ( ubnd_out[ j ] - lbnd_out[ j ] + 1 );
+   }
+
+/* Begin an AST context. */
+   astBegin;
+
+/* Ensure we have memory to hold the data describing each slab. As in
+   smf_rebincube_seqf, this memory is retained between invocations of
+   this function to avoid the overhead of allocating it for every time
+   slice. */
+   job_data = astGrow( job_data, sizeof( SmfRebinSlabData ), nslab );
+   block_lbnd = astGrow( block_lbnd, sizeof( int ), nslab*ndim_in );
+   block_ubnd = astGrow( block_ubnd, sizeof( int ), nslab*ndim_in );
+
+/* Check pointers can be used safely. */
+   if( astOK ) {
+
+/* Prepare EMS for multi-threaded work. */
+      emsMark();
+
+/* Set up the data for each slab. */
+      for( i = 0; i < nslab; i++ ) {
+         data = job_data + i;
+         data->bnd = slab_bnd + 6*i;
+         data->nused = 0;
+
+/* The output array for the slab covers the full range of the spatial
+   axes, but only the channels within the slab on the spectral axis. */
+         for( j = 0; j < ndim_out - 1; j++ ) {
+            data->lbnd_out[ j ] = lbnd_out[ j ];
+            data->ubnd_out[ j ] = ubnd_out[ j ];
+         }
+         data->lbnd_out[ ndim_out - 1 ] = data->bnd[ 0 ];
+         data->ubnd_out[ ndim_out - 1 ] = data->bnd[ 1 ];
+
+/* Get the offset to the first output pixel in the slab. */
+         offset = (dim_t) ( data->bnd[ 0 ] - lbnd_out[ ndim_out - 1 ] )*plane;
+
+         data->args.is_double = 0;
+         data->args.wlim = wlim;
+         data->args.ndim_in = ndim_in;
+         data->args.lbnd_in = lbnd_in;
+         data->args.ubnd_in = ubnd_in;
+         data->args.in = (void *) in;
+         data->args.in_var = (void *) in_var;
+         data->args.spread = spread;
+         data->args.params = params;
+         data->args.flags = flags;
+         data->args.tol = tol;
+         data->args.maxpix = maxpix;
+         data->args.badval_f = badval;
+         data->args.ndim_out = ndim_out;
+         data->args.lbnd_out = data->lbnd_out;
+         data->args.ubnd_out = data->ubnd_out;
+         data->args.out = out + offset;
+         data->args.out_var = out_var ? out_var + offset : NULL;
+         data->args.weights = weights + offset;
+         data->args.nused = 0;
+
+/* Each thread needs its own copy of the Mapping, unlocked so that the
+   thread can lock it (see smf_rebincube_seqf). */
+         data->args.this = astCopy( this );
+         astUnlock( data->args.this, 1 );
+
+/* The bounds on the spectral axis of the input block are set by the
+   thread. Set the bounds on the other axes so that they cover the whole
+   range of that axis. */
+         data->args.lbnd = block_lbnd + i*ndim_in;
+         data->args.ubnd = block_ubnd + i*ndim_in;
+         for( j = 1; j < ndim_in; j++ ) {
+            (data->args.lbnd)[ j ] = lbnd[ j ];
+            (data->args.ubnd)[ j ] = ubnd[ j ];
+         }
+
+/* Add this job to the workforce. */
+         thrAddJob( workforce, 0, data, smf1_rebincube_slab, 0, NULL,
+                    status );
+      }
+
+/* Wait until the work force has done all the re-binning. */
+      thrWait( workforce, status );
+
+/* Increment the total number of input pixels pasted into the output. */
+      for( i = 0; i < nslab; i++ ) *nused += job_data[ i ].nused;
+
+/* Tell EMS that we have finished multi-threaded work. */
+      emsRlse();
+
+/* Lock the Mappings used in the threads so that they can be annulled by
+   the final astEnd. */
+      for( i = 0; i < nslab; i++ ) astLock( job_data[ i ].args.this, 0 );
+   }
+
+/* End the AST context. */
+   astEnd;
+}
+
+
+static void smf1_rebincube_slab( void *job_data_ptr, int *status ){
+/*
+*  Name:
+*     smf1_rebincube_slab
+
+*  Purpose:
+*     Rebin the input data into a single spectral slab.
+
+*  Invocation:
+*     smf1_rebincube_slab( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = SmfRebinSlabData * (Given)
+*        Data structure describing the slab.
+*     status = int * (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     This function is called by a worker thread to re-bin the input
+*     channels owned by a slab, followed by the input channels below and
+*     above them that may also contribute to the slab.
+*/
+
+/* Local Variables: */
+   SmfRebinSlabData *data = (SmfRebinSlabData *) job_data_ptr;
+   const int *bnd;
+   int64_t nused;
+
+/* Check the inherited status. */
+   if( *status != SAI__OK ) return;
+
+   bnd = data->bnd;
+
+/* If the slab owns no input channels, just re-bin those that may
+   contribute to it. */
+   data->args.nused = 0;
+   if( bnd[ 3 ] < bnd[ 2 ] ) {
+      if( bnd[ 5 ] >= bnd[ 4 ] ) {
+         (data->args.lbnd)[ 0 ] = bnd[ 4 ];
+         (data->args.ubnd)[ 0 ] = bnd[ 5 ];
+         smf_rebinseq_thread( &(data->args), status );
+      }
+      nused = 0;
+
+/* Otherwise, re-bin the owned input channels, recording the number used. */
+   } else {
+      (data->args.lbnd)[ 0 ] = bnd[ 2 ];
+      (data->args.ubnd)[ 0 ] = bnd[ 3 ];
+      smf_rebinseq_thread( &(data->args), status );
+      nused = data->args.nused;
+
+/* Then re-bin the input channels below and above the owned channels.
+   These are owned by a neighbouring slab, which counts them as used. */
+      if( bnd[ 4 ] < bnd[ 2 ] ) {
+         (data->args.lbnd)[ 0 ] = bnd[ 4 ];
+         (data->args.ubnd)[ 0 ] = bnd[ 2 ] - 1;
+         smf_rebinseq_thread( &(data->args), status );
+      }
+
+      if( bnd[ 5 ] > bnd[ 3 ] ) {
+         (data->args.lbnd)[ 0 ] = bnd[ 3 ] + 1;
+         (data->args.ubnd)[ 0 ] = bnd[ 5 ];
+         smf_rebinseq_thread( &(data->args), status );
+      }
+   }
+
+   data->nused = nused;
+}
@@ -0,0 +1,113 @@
+/*
+*+
+*  Name:
+*     smf_rebincube_specoff
+
+*  Purpose:
+*     See if input channels map onto output channels with a simple shift.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     int smf_rebincube_specoff( dim_t nchan, const int *spectab,
+*                                dim_t *ilo, dim_t *ihi, int *status )
+
+*  Arguments:
+*     nchan = dim_t (Given)
+*        The number of spectral channels in the input time series NDF.
+*     spectab = const int * (Given)
+*        The channel conversion table created by smf_rebincube_spectab.
+*     ilo = dim_t * (Returned)
+*        The (zero-based) index of the first input channel that has a
+*        corresponding output channel.
+*     ihi = dim_t * (Returned)
+*        The (zero-based) index of the last input channel that has a
+*        corresponding output channel.
+*     status = int * (Given and Returned)
+*        Pointer to the inherited status.
+
+*  Returned Value:
+*     If input channels "ilo" to "ihi" map onto consecutive output
+*     channels, and all other input channels have no corresponding
+*     output channel, the offset to add to an input channel index to get
+*     the output channel index is returned. Otherwise (including the case
+*     where no input channel has a corresponding output channel) VAL__BADI
+*     is returned, and "ilo" and "ihi" are undefined.
+
+*  Description:
+*     This allows the spectrum pasting functions to use a contiguous
+*     range of channels in place of a look up in "spectab" for each
+*     channel. This is the usual case when the input and output spectral
+*     channels have the same width.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* Starlink includes */
+#include "sae_par.h"
+#include "prm_par.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+int smf_rebincube_specoff( dim_t nchan, const int *spectab, dim_t *ilo,
+                           dim_t *ihi, int *status ){
+
+/* Local Variables */
+   dim_t ichan;                /* Index of current channel */
+   int off;                    /* Output channel offset */
+
+/* Check the inherited status. */
+   if( *status != SAI__OK || !spectab ) return VAL__BADI;
+
+/* Find the first input channel that has an output channel. */
+   for( ichan = 0; ichan < nchan && spectab[ ichan ] == -1; ichan++ );
+   if( ichan == nchan ) return VAL__BADI;
+   *ilo = ichan;
+   off = spectab[ ichan ] - (int) ichan;
+
+/* Find the end of the run of consecutive output channels. */
+   for( ; ichan < nchan && spectab[ ichan ] == (int) ichan + off; ichan++ );
+   *ihi = ichan - 1;
+
+/* Check all remaining input channels have no output channel. */
+   for( ; ichan < nchan; ichan++ ) {
+      if( spectab[ ichan ] != -1 ) return VAL__BADI;
+   }
+
+   return off;
+}
@@ -16,7 +16,7 @@
 *     smf_rebinmap1( ThrWorkForce *wf, smfData *data, smfData *variance, int *lut,
 *                    size_t tslice1, size_t tslice2, int trange, int *whichmap,
 *                    dim_t nmap, smf_qual_t mask, int sampvar, int flags,
-*                    double *map, double *mapweight, double *mapweightsq,
+*                    int partmap, double *map, double *mapweight, double *mapweightsq,
 *                    int *hitsmap, double *mapvar, dim_t msize,
 *                    double chunkfactor, double *scalevariance, int *status )
 
@@ -57,6 +57,12 @@
 *        by propagating the variance on each sample into the pixel.
 *     int flags (Given)
 *        Flags to control the rebinning process (see astRebin flags)
+*     partmap = int (Given)
+*        If non-zero, and a workforce with more than one worker is
+*        supplied, the map is divided spatially between the worker
+*        threads, rather than giving each thread its own copy of the map.
+*        In this case the map-sized buffers need only hold a single copy
+*        of the map (see "Description:").
 *     map = double* (Returned)
 *        The output map array
 *     mapweight = double* (Returned)
@@ -93,6 +99,17 @@
 *     Additionally, all map-sized buffers must contain nw copies of the map so
 *     that each thread can accumulate into its own map.
 *
+*     If "partmap" is set, a single copy of the map is used instead, so
+*     that the memory needed does not grow with the number of threads.
+*     The map buffer is divided into strips of pixels, and the strips are
+*     shared out between the threads. The samples are processed in
+*     chunks of bolometers. For each chunk, the samples are first sorted
+*     into buckets by output strip (using the LUT), and each thread then
+*     accumulates the samples from the buckets for its own strips. No
+*     locking or final summation of thread maps is needed, and the order
+*     in which samples are added into each pixel is the same as if a
+*     single thread were used.
+*
 *  Authors:
 *     EC: Edward Chapin (UBC)
 *     AGM: Gaelen Marsden (UBC)
@@ -148,6 +165,10 @@
 *        few bolometers (smaller than the number of threads).
 *     2018-04-10 (DSB):
 *        Added parameter "chunkfactor".
+*     14-OCT-2026:
+*        Added parameter "partmap".
+*     14-OCT-2026:
+*        Use the packed quality mask if one is available.
 *     {enter_further_changes_here}
 
 *  Notes:
@@ -228,6 +249,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
 
 /* Starlink includes */
 #include "ast.h"
@@ -242,8 +264,17 @@
 
 
 
+/* The maximum number of samples in each chunk of bolometers processed
+   together when "partmap" is set, and the number of map strips used per
+   thread. */
+#define MAXBUCKET 4194304
+#define NSTRIP 8
+
 /* Local data types */
 typedef struct smfRebinMap1Data {
+   dim_t bolo1;
+   dim_t bolo2;
+   dim_t chunk0;
    dim_t mbufsize;
    dim_t msize;
    dim_t nbolo;
@@ -271,11 +302,29 @@ typedef struct smfRebinMap1Data {
    size_t vtstride;
    smf_qual_t *qual;
    smf_qual_t mask;
+   const uint64_t *qmask;
    int nw;
    int iw;
+   int accop;
+   int njob;
+   dim_t nstrip;
+   dim_t stripsize;
+   dim_t ntime;
+   size_t *bucket;
+   size_t *stripstart;
+   size_t *stripend;
 } SmfRebinMap1Data;
 
 static void smf1_rebinmap1( void *job_data_ptr, int *status );
+static void smf1_partition( ThrWorkForce *wf, SmfRebinMap1Data *job_data,
+                            int nw, int accop, dim_t nbolo, size_t t1,
+                            size_t t2, dim_t mbufsize, int *status );
+static size_t smf1_rebin_pixel( SmfRebinMap1Data *pdata, size_t ibolo,
+                                size_t itime, dim_t *di, dim_t *vi );
+static void smf1_rebin_add( SmfRebinMap1Data *pdata, dim_t di, dim_t vi,
+                            size_t tipix );
+static int smf1_qmask_skip( SmfRebinMap1Data *pdata, dim_t di,
+                            size_t *itime );
 
 
 #define FUNC_NAME "smf_rebinmap1"
@@ -283,9 +332,10 @@ static void smf1_rebinmap1( void *job_data_ptr, int *status );
 void smf_rebinmap1( ThrWorkForce *wf, smfData *data, smfData *variance, int *lut,
                     size_t tslice1, size_t tslice2, int trange, int *whichmap,
                     dim_t nmap, smf_qual_t mask, int sampvar, int flags,
-                    double *map, double *mapweight, double *mapweightsq,
-                    int *hitsmap, double *mapvar, dim_t msize,
-                    double chunkfactor, double *scalevariance, int *status ) {
+                    int partmap, double *map, double *mapweight,
+                    double *mapweightsq, int *hitsmap, double *mapvar,
+                    dim_t msize, double chunkfactor, double *scalevariance,
+                    int *status ) {
 
   /* Local Variables */
   SmfRebinMap1Data *job_data = NULL;
@@ -293,13 +343,16 @@ void smf_rebinmap1( ThrWorkForce *wf, smfData *data, smfData *variance, int *lut
   double *dat=NULL;          /* Pointer to data array */
   size_t dbstride;           /* bolo stride of data */
   size_t dtstride;           /* tstride of data */
+  int accop;                 /* Operation used to accumulate the map */
   int iw;                    /* Thread index */
   dim_t mbufsize;            /* Size of full (multi-map) map buffers */
+  int ncopy;                 /* Number of map copies in each buffer */
   dim_t nbolo;               /* number of bolos */
   dim_t ntslice;             /* number of time slices */
   int nw;                    /* Number of worker threads */
   size_t pixstep;            /* Number of map pixels per thread */
   dim_t bolostep;            /* Number of bolos per thread */
+  const uint64_t *qmask = NULL; /* Packed quality mask */
   smf_qual_t * qual = NULL;  /* Quality pointer */
   double scalevar;           /* variance scale factor */
   double scaleweight;        /* weights for calculating scalevar */
@@ -328,6 +381,7 @@ void smf_rebinmap1( ThrWorkForce *wf, smfData *data, smfData *variance, int *lut
 
   dat = data->pntr[0];
   qual = smf_select_qualpntr( data, NULL, status );
+  if( qual ) qmask = smf_select_qmask( data, mask, status );
   smf_get_dims( data, NULL, NULL, &nbolo, &ntslice, NULL, &dbstride,
                 &dtstride, status );
 
@@ -380,13 +434,17 @@ void smf_rebinmap1( ThrWorkForce *wf, smfData *data, smfData *variance, int *lut
   /* How many threads do we get to play with */
   nw = wf ? wf->nworker : 1;
 
+  /* The number of copies of the map in each map buffer. */
+  if( nw == 1 ) partmap = 0;
+  ncopy = partmap ? 1 : nw;
+
   /* If this is the first data to be accumulated zero the arrays */
   if( flags & AST__REBININIT ) {
-    memset( map, 0, nw*mbufsize*sizeof(*map) );
-    memset( mapweight, 0, nw*mbufsize*sizeof(*mapweight) );
-    memset( mapweightsq, 0, nw*mbufsize*sizeof(*mapweightsq) );
-    if( mapvar ) memset( mapvar, 0, nw*mbufsize*sizeof(*mapvar) );
-    memset( hitsmap, 0, nw*mbufsize*sizeof(*hitsmap) );
+    memset( map, 0, ncopy*mbufsize*sizeof(*map) );
+    memset( mapweight, 0, ncopy*mbufsize*sizeof(*mapweight) );
+    memset( mapweightsq, 0, ncopy*mbufsize*sizeof(*mapweightsq) );
+    if( mapvar ) memset( mapvar, 0, ncopy*mbufsize*sizeof(*mapvar) );
+    memset( hitsmap, 0, ncopy*mbufsize*sizeof(*hitsmap) );
   }
 
   /* Find how many bolos to process in each worker thread. */
@@ -431,83 +489,45 @@ void smf_rebinmap1( ThrWorkForce *wf, smfData *data, smfData *variance, int *lut
       pdata->vtstride = vtstride;
       pdata->mask = mask;
       pdata->qual = qual;
+      pdata->qmask = qmask;
       pdata->chunkfactor = chunkfactor;
       pdata->mbufsize = mbufsize;
-      pdata->nw = nw; /* used for final summing/rescaling */
+      pdata->nw = partmap ? 1 : nw; /* used for final summing/rescaling */
       pdata->iw = iw; /* so the thread knows with chunk it's working on */
     }
   }
 
+  /* Choose the operation used to accumulate the data into the map. */
   if( var ) {
-    /* Accumulate data and weights in the case that variances are given*/
-
+    /* Accumulate data and weights in the case that variances are given.
+       Either measure the weighted sample variance for varmap, or use
+       simple error propagation. */
     if( sampvar ) {
-
-      /* Measure weighted sample variance for varmap */
-      if( qual ) {       /* QUALITY checking version */
-
-        /* Set up jobs to add the previous estimate of COM back on to the
-           residuals, and then wait for the jobs to complete. These jobs also
-           clear any SMF__Q_COM flags set by previous iterations. */
-        for( iw = 0; iw < nw; iw++ ) {
-           pdata = job_data + iw;
-           pdata->operation = 1;
-           thrAddJob( wf, 0, pdata, smf1_rebinmap1, 0, NULL, status );
-        }
-        thrWait( wf, status );
-
-      } else {           /* VAL__BADD checking version */
-        for( iw = 0; iw < nw; iw++ ) {
-           pdata = job_data + iw;
-           pdata->operation = 2;
-           thrAddJob( wf, 0, pdata, smf1_rebinmap1, 0, NULL, status );
-        }
-        thrWait( wf, status );
-
-      }
-
+      accop = qual ? 1 : 2;
     } else {
-      /* Otherwise use simple error propagation for varmap */
-
-      if( qual ) {       /* QUALITY checking version */
-        for( iw = 0; iw < nw; iw++ ) {
-           pdata = job_data + iw;
-           pdata->operation = 3;
-           thrAddJob( wf, 0, pdata, smf1_rebinmap1, 0, NULL, status );
-        }
-        thrWait( wf, status );
-
-      } else {           /* VAL__BADD checking version */
-        for( iw = 0; iw < nw; iw++ ) {
-           pdata = job_data + iw;
-           pdata->operation = 4;
-           thrAddJob( wf, 0, pdata, smf1_rebinmap1, 0, NULL, status );
-        }
-        thrWait( wf, status );
-
-      }
+      accop = qual ? 3 : 4;
     }
 
   } else {
     /* Accumulate data and weights when no variances are given. In this case
        the variance map is always estimated from the sample variance */
+    accop = qual ? 5 : 6;
+  }
 
-    if( qual ) {       /* QUALITY checking version */
-      for( iw = 0; iw < nw; iw++ ) {
-        pdata = job_data + iw;
-        pdata->operation = 5;
-        thrAddJob( wf, 0, pdata, smf1_rebinmap1, 0, NULL, status );
-      }
-      thrWait( wf, status );
-
-    } else {           /* VAL__BADD checking version */
-      for( iw = 0; iw < nw; iw++ ) {
-        pdata = job_data + iw;
-        pdata->operation = 6;
-        thrAddJob( wf, 0, pdata, smf1_rebinmap1, 0, NULL, status );
-      }
-      thrWait( wf, status );
+  /* If each thread has its own copy of the map, each thread accumulates
+     the data from its own range of bolometers. */
+  if( !partmap ) {
+    for( iw = 0; iw < nw; iw++ ) {
+      pdata = job_data + iw;
+      pdata->operation = accop;
+      thrAddJob( wf, 0, pdata, smf1_rebinmap1, 0, NULL, status );
     }
+    thrWait( wf, status );
+
+  /* Otherwise, partition the map. */
+  } else {
+    smf1_partition( wf, job_data, nw, accop, nbolo, t1, t2, mbufsize,
+                    status );
   }
 
   /* If this is the last data to be accumulated re-normalize */
@@ -576,6 +596,153 @@ void smf_rebinmap1( ThrWorkForce *wf, smfData *data, smfData *variance, int *lut
 
 
 
+static void smf1_partition( ThrWorkForce *wf, SmfRebinMap1Data *job_data,
+                            int nw, int accop, dim_t nbolo, size_t t1,
+                            size_t t2, dim_t mbufsize, int *status ){
+/*
+*  Name:
+*     smf1_partition
+
+*  Purpose:
+*     Accumulate data into a single map that is divided between threads.
+
+*  Invocation:
+*     smf1_partition( ThrWorkForce *wf, SmfRebinMap1Data *job_data,
+*                     int nw, int accop, dim_t nbolo, size_t t1,
+*                     size_t t2, dim_t mbufsize, int *status )
+
+*  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        Pointer to thread workforce.
+*     job_data = SmfRebinMap1Data * (Given)
+*        The job data for each of the "nw" threads.
+*     nw = int (Given)
+*        The number of threads.
+*     accop = int (Given)
+*        The operation (1 to 6) that defines how each sample is
+*        accumulated into the map.
+*     nbolo = dim_t (Given)
+*        The number of bolometers.
+*     t1 = size_t (Given)
+*        The first time slice to include.
+*     t2 = size_t (Given)
+*        The last time slice to include.
+*     mbufsize = dim_t (Given)
+*        The number of pixels in the map buffers (all maps).
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+/* Local Variables: */
+   SmfRebinMap1Data *pdata;
+   dim_t b0;
+   dim_t nbchunk;
+   dim_t nbuse;
+   dim_t nstrip;
+   dim_t ntime;
+   dim_t stripsize;
+   int iw;
+   int jw;
+   size_t *bucket;
+   size_t *stripend;
+   size_t *stripstart;
+   size_t istrip;
+   size_t total;
+   size_t k;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Divide the map buffer into strips of contiguous pixels. Each thread
+   will handle every nw'th strip, so that a compact source is spread
+   over all threads. */
+   nstrip = NSTRIP*nw;
+   if( nstrip > mbufsize ) nstrip = mbufsize;
+   stripsize = ( mbufsize + nstrip - 1 )/nstrip;
+   nstrip = ( mbufsize + stripsize - 1 )/stripsize;
+
+/* Find the number of bolometers in each chunk, so that the buckets do
+   not hold more than MAXBUCKET samples. */
+   ntime = t2 - t1 + 1;
+   nbchunk = MAXBUCKET/ntime;
+   if( nbchunk == 0 ) nbchunk = 1;
+   if( nbchunk > nbolo ) nbchunk = nbolo;
+
+/* Allocate the buckets, and the index of the start and end of each
+   strip within the buckets for each thread. */
+   bucket = astMalloc( nbchunk*ntime*sizeof( *bucket ) );
+   stripstart = astMalloc( nw*nstrip*sizeof( *stripstart ) );
+   stripend = astMalloc( nw*nstrip*sizeof( *stripend ) );
+
+   for( iw = 0; iw < nw; iw++ ) {
+      pdata = job_data + iw;
+      pdata->accop = accop;
+      pdata->njob = nw;
+      pdata->nstrip = nstrip;
+      pdata->stripsize = stripsize;
+      pdata->ntime = ntime;
+      pdata->bucket = bucket;
+      pdata->stripstart = stripstart;
+      pdata->stripend = stripend;
+   }
+
+/* Loop round each chunk of bolometers. */
+   for( b0 = 0; b0 < nbolo && *status == SAI__OK; b0 += nbchunk ) {
+      nbuse = nbolo - b0;
+      if( nbuse > nbchunk ) nbuse = nbchunk;
+
+/* Share the bolometers in the chunk between the threads, and count the
+   number of usable samples falling in each strip. */
+      memset( stripend, 0, nw*nstrip*sizeof( *stripend ) );
+      for( iw = 0; iw < nw; iw++ ) {
+         pdata = job_data + iw;
+         pdata->chunk0 = b0;
+         pdata->bolo1 = b0 + ( iw*nbuse )/nw;
+         pdata->bolo2 = b0 + ( ( iw + 1 )*nbuse )/nw;
+         pdata->operation = 9;
+         thrAddJob( wf, 0, pdata, smf1_rebinmap1, 0, NULL, status );
+      }
+      thrWait( wf, status );
+
+/* Find where in the buckets the samples for each strip from each
+   thread will go. The samples for a strip are stored together, in the
+   order of the threads that supplied them. Each "stripend" value is
+   then advanced as samples are stored. */
+      total = 0;
+      for( istrip = 0; istrip < nstrip; istrip++ ) {
+         for( jw = 0; jw < nw; jw++ ) {
+            k = jw*nstrip + istrip;
+            stripstart[ k ] = total;
+            total += stripend[ k ];
+            stripend[ k ] = stripstart[ k ];
+         }
+      }
+
+/* Store the samples in the buckets. */
+      for( iw = 0; iw < nw; iw++ ) {
+         pdata = job_data + iw;
+         pdata->operation = 10;
+         thrAddJob( wf, 0, pdata, smf1_rebinmap1, 0, NULL, status );
+      }
+      thrWait( wf, status );
+
+/* Accumulate the samples into the map, each thread handling its own
+   strips. */
+      for( iw = 0; iw < nw; iw++ ) {
+         pdata = job_data + iw;
+         pdata->operation = 11;
+         thrAddJob( wf, 0, pdata, smf1_rebinmap1, 0, NULL, status );
+      }
+      thrWait( wf, status );
+   }
+
+/* Free resources. */
+   bucket = astFree( bucket );
+   stripstart = astFree( stripstart );
+   stripend = astFree( stripend );
+}
+
 static void smf1_rebinmap1( void *job_data_ptr, int *status ) {
 
 /* Local Variables: */
@@ -629,6 +796,13 @@ static void smf1_rebinmap1( void *job_data_ptr, int *status ) {
 /* Get the 1D vector index of the data sample. */
                di = ibolo*pdata->dbstride + itime*pdata->dtstride;
 
+/* If a packed quality mask is available, use it to reject flagged
+   samples (several at a time if possible) without reading the quality
+   array. */
+               if( pdata->qmask && smf1_qmask_skip( pdata, di, &itime ) ) {
+                  continue;
+               }
+
 /* Get the corresponding map pixel index. */
                ipix = pdata->lut[ di ];
 
@@ -650,7 +824,7 @@ static void smf1_rebinmap1( void *job_data_ptr, int *status ) {
                   }
 
 /* Check that the data and variance values are valid */
-                  if( !( pdata->qual[ di ] & pdata->mask ) &&
+                  if( ( pdata->qmask || !( pdata->qual[ di ] & pdata->mask ) ) &&
                        ( pdata->var[ vi ] > 0.0 ) &&
                        ( pdata->var[ vi ] != VAL__BADD ) &&
                        ( ipix != SMF__BADDIMT ) ) {
@@ -736,6 +910,9 @@ static void smf1_rebinmap1( void *job_data_ptr, int *status ) {
          if( !( pdata->qual[ ibolo*pdata->dbstride ] & SMF__Q_BADB ) ) {
             for( itime = pdata->t1; itime <= pdata->t2; itime++ ) {
                di = ibolo*pdata->dbstride + itime*pdata->dtstride;
+               if( pdata->qmask && smf1_qmask_skip( pdata, di, &itime ) ) {
+                  continue;
+               }
                ipix = pdata->lut[ di ];
                if( pdata->lut[ di ] >= 0 && ipix < pdata->msize ) {
                   vi = ibolo*pdata->vbstride +
@@ -748,7 +925,7 @@ static void smf1_rebinmap1( void *job_data_ptr, int *status ) {
                     }
                   }
 
-                  if( !( pdata->qual[ di ] & pdata->mask ) &&
+                  if( ( pdata->qmask || !( pdata->qual[ di ] & pdata->mask ) ) &&
                        ( pdata->var[ vi ] > 0.0 ) &&
                        ( pdata->var[ vi ] != VAL__BADD ) &&
                        ( ipix != SMF__BADDIMT ) ) {
@@ -813,6 +990,9 @@ static void smf1_rebinmap1( void *job_data_ptr, int *status ) {
          if( !( pdata->qual[ ibolo*pdata->dbstride ] & SMF__Q_BADB ) ) {
             for( itime = pdata->t1; itime <= pdata->t2; itime++ ) {
                di = ibolo*pdata->dbstride + itime*pdata->dtstride;
+               if( pdata->qmask && smf1_qmask_skip( pdata, di, &itime ) ) {
+                  continue;
+               }
                ipix = pdata->lut[ di ];
                if( pdata->lut[ di ] >= 0 && ipix < pdata->msize ) {
                   if( pdata->whichmap ) {
@@ -823,7 +1003,7 @@ static void smf1_rebinmap1( void *job_data_ptr, int *status ) {
                     }
                   }
 
-                  if( !( pdata->qual[ di ] & pdata->mask ) &&
+                  if( ( pdata->qmask || !( pdata->qual[ di ] & pdata->mask ) ) &&
                        ( ipix != SMF__BADDIMT ) ) {
                      tipix = tmap0 + ipix;
                      pdata->hitsmap[ tipix ]++;
@@ -1001,6 +1181,55 @@ static void smf1_rebinmap1( void *job_data_ptr, int *status ) {
          }
       }
 
+/* Partitioned map - count the usable samples falling in each strip.
+   ============================================================= */
+   } else if( pdata->operation == 9 || pdata->operation == 10 ) {
+      size_t *pend = pdata->stripend + pdata->iw*pdata->nstrip;
+      int qualop = ( pdata->accop % 2 == 1 );
+
+      for( ibolo = pdata->bolo1; ibolo < pdata->bolo2; ibolo++ ) {
+         if( qualop &&
+             ( pdata->qual[ ibolo*pdata->dbstride ] & SMF__Q_BADB ) ) continue;
+
+         for( itime = pdata->t1; itime <= pdata->t2; itime++ ) {
+            ipix = smf1_rebin_pixel( pdata, ibolo, itime, &di, &vi );
+            if( ipix != SMF__BADDIMT ) {
+
+/* Operation 9 just counts the samples. Operation 10 also stores the
+   offset of each sample from the start of the chunk in the bucket for
+   the strip. */
+               tipix = ipix/pdata->stripsize;
+               if( pdata->operation == 10 ) {
+                  pdata->bucket[ pend[ tipix ] ] =
+                     ( ibolo - pdata->chunk0 )*pdata->ntime + itime - pdata->t1;
+               }
+               pend[ tipix ]++;
+            }
+         }
+      }
+
+/* Partitioned map - accumulate the samples in the buckets for every
+   nw'th strip into the map.
+   ============================================================= */
+   } else if( pdata->operation == 11 ) {
+      size_t istrip;
+      size_t k;
+      size_t samp;
+      int jw;
+
+      for( istrip = pdata->iw; istrip < pdata->nstrip; istrip += pdata->njob ) {
+         for( jw = 0; jw < pdata->njob; jw++ ) {
+            for( k = pdata->stripstart[ jw*pdata->nstrip + istrip ];
+                 k < pdata->stripend[ jw*pdata->nstrip + istrip ]; k++ ) {
+               samp = pdata->bucket[ k ];
+               ibolo = pdata->chunk0 + samp/pdata->ntime;
+               itime = pdata->t1 + samp % pdata->ntime;
+               ipix = smf1_rebin_pixel( pdata, ibolo, itime, &di, &vi );
+               smf1_rebin_add( pdata, di, vi, ipix );
+            }
+         }
+      }
+
 /* Report an error if the worker was to do an unknown job.
    ====================================================== */
    } else {
@@ -1009,3 +1238,177 @@ static void smf1_rebinmap1( void *job_data_ptr, int *status ) {
                status, pdata->operation );
    }
 }
+
+static size_t smf1_rebin_pixel( SmfRebinMap1Data *pdata, size_t ibolo,
+                                size_t itime, dim_t *di, dim_t *vi ){
+/*
+*  Name:
+*     smf1_rebin_pixel
+
+*  Purpose:
+*     Find the map buffer pixel for a sample when partitioning the map.
+
+*  Invocation:
+*     ipix = smf1_rebin_pixel( SmfRebinMap1Data *pdata, size_t ibolo,
+*                              size_t itime, dim_t *di, dim_t *vi )
+
+*  Arguments:
+*     pdata = SmfRebinMap1Data * (Given)
+*        The job data. The "accop" component selects the tests applied to
+*        the sample (as for operations 1 to 6).
+*     ibolo = size_t (Given)
+*        The bolometer index.
+*     itime = size_t (Given)
+*        The time slice index.
+*     di = dim_t * (Returned)
+*        The index of the sample within the data array.
+*     vi = dim_t * (Returned)
+*        The index of the sample within the variance array.
+
+*  Returned Value:
+*     The index of the pixel within the map buffers, or SMF__BADDIMT if
+*     the sample should not be included in the map.
+
+*/
+
+/* Local Variables: */
+   size_t ipix;
+   int op = pdata->accop;
+
+   *di = ibolo*pdata->dbstride + itime*pdata->dtstride;
+   *vi = 0;
+
+/* Test that pixel falls in map range. */
+   if( pdata->lut[ *di ] < 0 ) return SMF__BADDIMT;
+   ipix = pdata->lut[ *di ];
+   if( ipix >= pdata->msize ) return SMF__BADDIMT;
+
+/* Get the offset to the start of the buffer in which to store the pixel
+   value. */
+   if( pdata->whichmap ) {
+      if( pdata->whichmap[ itime ] == VAL__BADI ) return SMF__BADDIMT;
+      ipix += pdata->whichmap[ itime ]*pdata->msize;
+   }
+
+/* Check that the data value is valid. */
+   if( op % 2 == 1 ) {
+      if( pdata->qmask ) {
+         if( !( pdata->qmask[ *di/64 ] & ( (uint64_t) 1 << ( *di % 64 ) ) ) ) {
+            return SMF__BADDIMT;
+         }
+      } else if( pdata->qual[ *di ] & pdata->mask ) {
+         return SMF__BADDIMT;
+      }
+   } else {
+      if( pdata->dat[ *di ] == VAL__BADD ) return SMF__BADDIMT;
+   }
+
+/* Check that the variance value is valid. */
+   if( op <= 4 ) {
+      *vi = ibolo*pdata->vbstride + ( itime % pdata->vntslice )*pdata->vtstride;
+      if( pdata->var[ *vi ] == VAL__BADD || !( pdata->var[ *vi ] > 0.0 ) ) {
+         return SMF__BADDIMT;
+      }
+   }
+
+   return ipix;
+}
+
+static void smf1_rebin_add( SmfRebinMap1Data *pdata, dim_t di, dim_t vi,
+                            size_t tipix ){
+/*
+*  Name:
+*     smf1_rebin_add
+
+*  Purpose:
+*     Add a sample into the map when partitioning the map.
+
+*  Invocation:
+*     smf1_rebin_add( SmfRebinMap1Data *pdata, dim_t di, dim_t vi,
+*                     size_t tipix )
+
+*  Arguments:
+*     pdata = SmfRebinMap1Data * (Given)
+*        The job data. The "accop" component selects how the sample is
+*        accumulated (as for operations 1 to 6).
+*     di = dim_t (Given)
+*        The index of the sample within the data array.
+*     vi = dim_t (Given)
+*        The index of the sample within the variance array.
+*     tipix = size_t (Given)
+*        The index of the pixel within the map buffers.
+
+*/
+
+/* Local Variables: */
+   double R;
+   double cf = pdata->chunkfactor;
+   double cf2 = cf*cf;
+   double delta;
+   double temp;
+   double thisweight;
+
+/* Map variance from error propagation. */
+   if( pdata->accop == 3 || pdata->accop == 4 ) {
+      thisweight = 1/(pdata->var[ vi ]*cf2);
+      pdata->map[ tipix ] += thisweight*pdata->dat[ di ]*cf;
+      pdata->mapweight[ tipix ] += thisweight;
+      pdata->mapweightsq[ tipix ] += thisweight*thisweight;
+      pdata->hitsmap[ tipix ]++;
+
+/* Map variance from spread of input values, using the weighted
+   incremental algorithm. Use unit weights if no variances are
+   available. */
+   } else {
+      thisweight = ( pdata->accop <= 2 ) ? 1/(pdata->var[ vi ]*cf2) : 1.0;
+      pdata->hitsmap[ tipix ]++;
+      temp = pdata->mapweight[ tipix ] + thisweight;
+      delta = pdata->dat[ di ]*cf - pdata->map[ tipix ];
+      R = ( pdata->accop <= 2 ) ? delta * thisweight / temp : delta / temp;
+      pdata->map[ tipix ] += R;
+      if( pdata->mapvar ) pdata->mapvar[ tipix ] +=
+                          pdata->mapweight[ tipix ]*delta*R;
+      pdata->mapweight[ tipix ] = temp;
+      pdata->mapweightsq[ tipix ] += thisweight*thisweight;
+   }
+}
+
+static int smf1_qmask_skip( SmfRebinMap1Data *pdata, dim_t di,
+                            size_t *itime ){
+/*
+*  Name:
+*     smf1_qmask_skip
+
+*  Purpose:
+*     Use the packed quality mask to check if a sample should be skipped.
+
+*  Invocation:
+*     skip = smf1_qmask_skip( SmfRebinMap1Data *pdata, dim_t di,
+*                             size_t *itime )
+
+*  Arguments:
+*     pdata = SmfRebinMap1Data * (Given)
+*        The job data. The "qmask" component must not be NULL.
+*     di = dim_t (Given)
+*        The index of the sample within the data array.
+*     itime = size_t * (Given and Returned)
+*        The time slice index of the sample. If the sample is flagged, the
+*        data are bolometer ordered, and the rest of the 64 samples in the
+*        same word of the mask are also flagged, this is advanced to the
+*        last of those samples so that the caller's loop moves straight on
+*        to the next word.
+
+*  Returned Value:
+*     Non-zero if the sample is flagged in the mask and should be skipped.
+
+*/
+
+/* Local Variables: */
+   uint64_t word;
+
+   word = pdata->qmask[ di/64 ];
+   if( word & ( (uint64_t) 1 << ( di % 64 ) ) ) return 0;
+
+   if( !word && pdata->dtstride == 1 ) *itime += 63 - di % 64;
+   return 1;
+}
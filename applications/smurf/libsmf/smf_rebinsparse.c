@@ -13,14 +13,17 @@
 *     C function
 
 *  Invocation:
-*     smf_rebinsparse( smfData *data, int first, int *ptime, AstFrame *ospecfrm,
-*                      AstMapping *ospecmap, AstSkyFrame *oskyframe,
-*                      Grp *detgrp, int lbnd_out[ 3 ], int ubnd_out[ 3 ],
-*                      int genvar, float *data_array, float *var_array,
-*                      int *ispec, float *texp_array, float *teff_array,
-*                      double *fcon, int *status );
+*     smf_rebinsparse( ThrWorkForce *wf, smfData *data, int first,
+*                      int *ptime, AstFrame *ospecfrm, AstMapping *ospecmap,
+*                      AstSkyFrame *oskyframe, Grp *detgrp,
+*                      int lbnd_out[ 3 ], int ubnd_out[ 3 ], int genvar,
+*                      float *data_array, float *var_array, int *ispec,
+*                      float *texp_array, float *teff_array, double *fcon,
+*                      int *status );
 
 *  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        Pointer to a pool of worker threads that will copy the spectra.
 *     data = smfData * (Given)
 *        Pointer to the input smfData structure.
 *     first = int (Given)
@@ -90,6 +93,12 @@
 *     The data array of the supplied input NDF is added into the existing
 *     contents of the output data array.
 *
+*     This is done in two passes. The first pass finds the input spectra
+*     that have valid output positions and good data values, and reserves
+*     the next output spectrum for each of them. The second pass uses
+*     the worker threads to copy the input spectra into their reserved
+*     output spectra in parallel.
+*
 *     Note, few checks are performed on the validity of the input data
 *     files in this function, since they have already been checked within
 *     smf_sparsebounds.
@@ -122,11 +131,16 @@
 *        input file or ending at the last.
 *     11-FEB-2009 (DSB):
 *        Ignore negative or zero input Tsys values.
+*     14-OCT-2026:
+*        Added argument "wf". Reserve the output spectra first, and then
+*        copy the input spectra in parallel. Use smf_rebincube_spectab
+*        to create the spectral look-up table.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2006 Particle Physics and Astronomy Research Council.
 *     Copyright (C) 2008-2009 Science & Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -159,18 +173,39 @@
 #include "sae_par.h"
 #include "prm_par.h"
 #include "star/ndg.h"
+#include "star/thr.h"
 
 /* SMURF includes */
 #include "libsmf/smf.h"
 
 #define FUNC_NAME "smf_rebinsparse"
 
-void smf_rebinsparse( smfData *data, int first, int *ptime, AstFrame *ospecfrm,
-                      AstMapping *ospecmap, AstSkyFrame *oskyframe,
-                      Grp *detgrp, int lbnd_out[ 3 ], int ubnd_out[ 3 ],
-                      int genvar, float *data_array, float *var_array,
-                      int *ispec, float *texp_array, float *teff_array,
-                      double *fcon, int *status ){
+/* Data shared by the threads that find and copy the good input spectra. */
+typedef struct smfRebinSparseData {
+   const float *in;      /* Input data array */
+   int nchan;            /* Number of input spectral channels */
+   const int *spectab;   /* Output channel for each input channel */
+   const size_t *off;    /* Input offset of each candidate spectrum */
+   char *good;           /* Does each candidate contain good data? */
+   const int *slot;      /* Output spectrum for each candidate */
+   float *out;           /* Output data array */
+   int nspec;            /* Number of output spectra */
+   int nz;               /* Number of output spectral channels */
+} smfRebinSparseData;
+
+/* Prototypes for local static functions. */
+static void smf1_sparse_copy( void *job_data_ptr, size_t i1, size_t i2,
+                              int *status );
+static void smf1_sparse_good( void *job_data_ptr, size_t i1, size_t i2,
+                              int *status );
+
+void smf_rebinsparse( ThrWorkForce *wf, smfData *data, int first,
+                      int *ptime, AstFrame *ospecfrm, AstMapping *ospecmap,
+                      AstSkyFrame *oskyframe, Grp *detgrp,
+                      int lbnd_out[ 3 ], int ubnd_out[ 3 ], int genvar,
+                      float *data_array, float *var_array, int *ispec,
+                      float *texp_array, float *teff_array, double *fcon,
+                      int *status ){
 
 /* Local Variables */
    AstCmpMap *fmap = NULL;      /* Mapping from spectral grid to topo freq Hz */
@@ -184,11 +219,12 @@ void smf_rebinsparse( smfData *data, int first, int *ptime, AstFrame *ospecfrm,
    AstMapping *smap = NULL;     /* Simplified Mapping */
    AstMapping *tmap = NULL;     /* Temporary Mapping */
    AstMapping *specmap = NULL;  /* PIXEL -> Spec mapping in input FrameSet */
+   char *cand_good = NULL;/* Does each candidate contain good data? */
    char *fftwin = NULL;  /* Name of FFT windowing function */
    const char *name = NULL; /* Pointer to current detector name */
    const double *tsys=NULL; /* Pointer to Tsys value for first detector */
    dim_t timeslice_size; /* No of detector values in one time slice */
-   double *spectab = NULL;/* Workspace for spectral output grid positions */
+   double *slice_tcon = NULL;/* Variance factor for each time slice */
    double *xin = NULL;   /* Workspace for detector input grid positions */
    double *xout = NULL;  /* Workspace for detector output pixel positions */
    double *yin = NULL;   /* Workspace for detector input grid positions */
@@ -198,27 +234,30 @@ void smf_rebinsparse( smfData *data, int first, int *ptime, AstFrame *ospecfrm,
    double fcon2;         /* Variance factor for whole file */
    double k;             /* Back-end degradation factor */
    double tcon;          /* Variance factor for whole time slice */
-   float *pdata = NULL;  /* Pointer to next data sample */
-   float *qdata = NULL;  /* Pointer to next data sample */
+   float *slice_teff = NULL; /* Effective integration time per time slice */
+   float *slice_texp = NULL; /* Total exposure time per time slice */
    float rtsys;          /* Tsys value */
    float teff;           /* Effective integration time, times 4 */
    float texp;           /* Total time ( = ton + toff ) */
    float toff;           /* Off time */
    float ton;            /* On time */
+   int *cand_slot = NULL;/* Output spectrum for each candidate spectrum */
    int *nexttime = NULL; /* Pointer to next time slice index to use */
+   int *spectab = NULL;  /* Output channel for each input channel */
    int dim[ 3 ];         /* Output array dimensions */
    int found;            /* Was current detector name found in detgrp? */
-   int good;             /* Are there any good detector samples? */
    int ibasein;          /* Index of base Frame in input FrameSet */
-   int ichan;            /* Index of current channel */
-   int iv;               /* Offset to next element */
-   int iz;               /* Output grid index on axis 3 */
    int nchan;            /* Number of input spectral channels */
    int pixax[ 3 ];       /* The output fed by each selected mapping input */
    int specax;           /* Index of spectral axis in input FrameSet */
+   size_t *cand_off = NULL;/* Input offset of each candidate spectrum */
+   size_t icand;         /* Index of current candidate spectrum */
    size_t irec;          /* Index of current input detector */
    size_t itime;         /* Index of current time slice */
+   size_t maxcand;       /* Maximum number of candidate spectra */
+   size_t ncand;         /* Number of candidate spectra */
    smfHead *hdr = NULL;  /* Pointer to data header for this time slice */
+   smfRebinSparseData sparsedata; /* Data shared by the worker threads */
 
 /* Check inherited status */
    if( *status != SAI__OK ) return;
@@ -295,25 +334,12 @@ void smf_rebinsparse( smfData *data, int first, int *ptime, AstFrame *ospecfrm,
    ssmap = astSimplify( ssmap );
 
 /* Create a table with one element for each channel in the input array,
-   holding the index of the nearest corresponding output channel. */
+   holding the zero-based index of the nearest corresponding output
+   channel. All detectors in the file share the same spectral axis, so
+   this one table is used for every spectrum. */
    nchan = (data->dims)[ 0 ];
-   spectab = astMalloc( sizeof( *spectab )*nchan );
-   if( spectab ) {
-      for( ichan = 0; ichan < nchan; ichan++ ) spectab[ ichan ] = ichan + 1;
-      astTran1( ssmap, nchan, spectab, 1, spectab );
-      for( ichan = 0; ichan < nchan; ichan++ ) {
-         if( spectab[ ichan ] != AST__BAD ) {
-            iz = floor( spectab[ ichan ] + 0.5 );
-            if( iz >= 1 && iz <= dim[ 2 ] ) {
-               spectab[ ichan ] = iz;
-            } else {
-               spectab[ ichan ] = 0;
-            }
-         } else {
-            spectab[ ichan ] = 0;
-         }
-      }
-   }
+   smf_rebincube_spectab( nchan, dim[ 2 ], (AstMapping *) ssmap, &spectab,
+                          status );
 
 /* Allocate work arrays big enough to hold the coords of all the
    detectors in the current input file.*/
@@ -410,10 +436,31 @@ void smf_rebinsparse( smfData *data, int first, int *ptime, AstFrame *ospecfrm,
       *fcon = VAL__BADD;
    }
 
+/* Allocate work arrays to hold the offset within the input data array of
+   each spectrum that has a valid output position (a "candidate"
+   spectrum), a flag indicating if it contains any good data values, and
+   the index of the output spectrum it is copied to. Also allocate arrays
+   holding the exposure times and variance factor for each time slice. */
+   maxcand = (data->dims)[ 1 ]*(data->dims)[ 2 ];
+   cand_off = astMalloc( maxcand*sizeof( *cand_off ) );
+   cand_good = astMalloc( maxcand*sizeof( *cand_good ) );
+   cand_slot = astMalloc( maxcand*sizeof( *cand_slot ) );
+   slice_texp = astMalloc( (data->dims)[ 2 ]*sizeof( *slice_texp ) );
+   slice_teff = astMalloc( (data->dims)[ 2 ]*sizeof( *slice_teff ) );
+   slice_tcon = astMalloc( (data->dims)[ 2 ]*sizeof( *slice_tcon ) );
+   ncand = 0;
+
 /* Initialise a pointer to the next time slice index to be used. */
    nexttime = ptime;
 
-/* Loop round all the time slices in the input file. */
+/* The output spectra are formed in two passes. The first pass finds
+   the spectra that have valid output positions and reserves an output
+   spectrum for each of them that contains any good data. The second pass
+   copies the data values into the reserved output spectra. Since each
+   output spectrum is filled by a single input spectrum, the spectra can
+   be copied in parallel. Loop round all the time slices in the input
+   file, finding the candidate spectra. This uses AST, and so is done in
+   this thread. */
    for( itime = 0; itime < (data->dims)[ 2 ] && *status == SAI__OK; itime++ ) {
 
 /* If this time slice is not being pasted into the output cube, pass on. */
@@ -422,9 +469,6 @@ void smf_rebinsparse( smfData *data, int first, int *ptime, AstFrame *ospecfrm,
          nexttime++;
       }
 
-/* Store a pointer to the first input data value in this time slice. */
-      pdata = ( (float *) (data->pntr)[ 0 ] ) + itime*timeslice_size;
-
 /* Get a FrameSet describing the spatial coordinate systems associated with
    the current time slice of the current input data file. The base frame in
    the FrameSet will be a 2D Frame in which axis 1 is detector number and
@@ -456,11 +500,12 @@ void smf_rebinsparse( smfData *data, int first, int *ptime, AstFrame *ospecfrm,
       tcon = AST__BAD;
       if( genvar == 2 && fcon2 != AST__BAD && texp != VAL__BADR ) {
          tcon = fcon2*( 1.0/ton + 1.0/toff );
-
-/* Get a pointer to the start of the Tsys values for this time slice. */
-         tsys = hdr->tsys + hdr->ndet*itime;
       }
 
+      slice_texp[ itime ] = texp;
+      slice_teff[ itime ] = teff;
+      slice_tcon[ itime ] = tcon;
+
 /* We now create a Mapping from detector index to position in oskyframe. */
       astInvert( swcsin );
       ibasein = astGetI( swcsin, "Base" );
@@ -491,67 +536,13 @@ void smf_rebinsparse( smfData *data, int first, int *ptime, AstFrame *ospecfrm,
    coords. */
       astTran2( smap, (data->dims)[ 1 ], xin, yin, 1, xout, yout );
 
-/* Loop round all detectors. */
-      for( irec = 0; irec < (data->dims)[ 1 ]; irec++ ) {
-
-/* If the detector has a valid position, see if it produced any good
-   data values. */
-         if( xout[ irec ] != AST__BAD && yout[ irec ] != AST__BAD ) {
-            qdata = pdata;
-            good = 0;
-            for( ichan = 0; ichan < nchan; ichan++ ){
-               if( *(qdata++) != VAL__BADR ) {
-                  good = 1;
-                  break;
-               }
+/* Record the offset to the first data value of each detector that has a
+   valid position. */
+      if( *status == SAI__OK ) {
+         for( irec = 0; irec < (data->dims)[ 1 ]; irec++ ) {
+            if( xout[ irec ] != AST__BAD && yout[ irec ] != AST__BAD ) {
+               cand_off[ ncand++ ] = itime*timeslice_size + irec*nchan;
             }
-
-/* If it did, calculate the variance associated with each detector
-   sample (if required), based on the input Tsys values, and copy the
-   spectrum to the output NDF. */
-            if( good ) {
-               if( *ispec < dim[ 0 ] ){
-                  rtsys = tsys ? (float) tsys[ irec ] : VAL__BADR;
-                  if( rtsys <= 0.0 ) rtsys = VAL__BADR;
-                  if( tcon != AST__BAD && genvar == 2 && rtsys != VAL__BADR ) {
-                     var_array[ *ispec ] = tcon*rtsys*rtsys;
-                  } else if( var_array ) {
-                     var_array[ *ispec ] = VAL__BADR;
-                  }
-
-                  if( texp != VAL__BADR ) {
-                     texp_array[ *ispec ] = texp;
-                     teff_array[ *ispec ] = teff;
-                  }
-
-                  for( ichan = 0; ichan < nchan; ichan++, pdata++ ) {
-                     iz = spectab[ ichan ] - 1;
-                     if( iz >= 0 && iz < dim[ 2 ] ) {
-                        iv = *ispec + dim[ 0 ]*iz;
-                        data_array[ iv ] = *pdata;
-                     }
-                  }
-
-                  (*ispec)++;
-
-               } else if( *status == SAI__OK ){
-                  *status = SAI__ERROR;
-                  msgSeti( "DIM", dim[ 0 ] );
-                  errRep( " ", "Too many spectra (more than ^DIM) for "
-                          "the output NDF (programming error).", status );
-                  break;
-               }
-
-/* If this detector does not have any valid data values, increment the data
-   pointer to point at the first sample for the next detector. */
-            } else {
-               pdata += nchan;
-            }
-
-/* If this detector does not have a valid position, increment the data
-   pointer to point at the first sample for the next detector. */
-         } else {
-            pdata += nchan;
          }
       }
 
@@ -562,8 +553,72 @@ void smf_rebinsparse( smfData *data, int first, int *ptime, AstFrame *ospecfrm,
       tmap = astAnnul( tmap );
    }
 
+/* Find the candidate spectra that contain any good data values. */
+   sparsedata.in = (data->pntr)[ 0 ];
+   sparsedata.nchan = nchan;
+   sparsedata.spectab = spectab;
+   sparsedata.off = cand_off;
+   sparsedata.good = cand_good;
+   sparsedata.slot = cand_slot;
+   sparsedata.out = data_array;
+   sparsedata.nspec = dim[ 0 ];
+   sparsedata.nz = dim[ 2 ];
+
+   if( ncand > 0 && *status == SAI__OK ) {
+      thrParallelFor( wf, 0, ncand - 1, 1, &sparsedata, smf1_sparse_good,
+                      status );
+   }
+
+/* Reserve an output spectrum for each good candidate, in the order in
+   which they occur in the input, and store the associated variance and
+   exposure times. */
+   for( icand = 0; icand < ncand && *status == SAI__OK; icand++ ) {
+      cand_slot[ icand ] = -1;
+      if( !cand_good[ icand ] ) continue;
+
+      if( *ispec < dim[ 0 ] ){
+         itime = cand_off[ icand ]/timeslice_size;
+         irec = ( cand_off[ icand ] % timeslice_size )/nchan;
+
+         tcon = slice_tcon[ itime ];
+         tsys = ( tcon != AST__BAD ) ? hdr->tsys + hdr->ndet*itime : NULL;
+         rtsys = tsys ? (float) tsys[ irec ] : VAL__BADR;
+         if( rtsys <= 0.0 ) rtsys = VAL__BADR;
+         if( tcon != AST__BAD && genvar == 2 && rtsys != VAL__BADR ) {
+            var_array[ *ispec ] = tcon*rtsys*rtsys;
+         } else if( var_array ) {
+            var_array[ *ispec ] = VAL__BADR;
+         }
+
+         if( slice_texp[ itime ] != VAL__BADR ) {
+            texp_array[ *ispec ] = slice_texp[ itime ];
+            teff_array[ *ispec ] = slice_teff[ itime ];
+         }
+
+         cand_slot[ icand ] = (*ispec)++;
+
+      } else {
+         *status = SAI__ERROR;
+         msgSeti( "DIM", dim[ 0 ] );
+         errRep( " ", "Too many spectra (more than ^DIM) for "
+                 "the output NDF (programming error).", status );
+      }
+   }
+
+/* Copy the good spectra into the reserved output spectra. */
+   if( ncand > 0 && *status == SAI__OK ) {
+      thrParallelFor( wf, 0, ncand - 1, 1, &sparsedata, smf1_sparse_copy,
+                      status );
+   }
+
 /* Free resources */
    spectab = astFree( spectab );
+   cand_off = astFree( cand_off );
+   cand_good = astFree( cand_good );
+   cand_slot = astFree( cand_slot );
+   slice_texp = astFree( slice_texp );
+   slice_teff = astFree( slice_teff );
+   slice_tcon = astFree( slice_tcon );
    xin = astFree( xin );
    yin = astFree( yin );
    xout = astFree( xout );
@@ -573,3 +628,53 @@ void smf_rebinsparse( smfData *data, int first, int *ptime, AstFrame *ospecfrm,
    context (except for those that have been exported from the context). */
    astEnd;
 }
+
+/* Set the flag for each candidate spectrum in the range "i1" to "i2"
+   that indicates if it contains any good data values. */
+static void smf1_sparse_good( void *job_data_ptr, size_t i1, size_t i2,
+                              int *status ) {
+   smfRebinSparseData *pdata = (smfRebinSparseData *) job_data_ptr;
+   const float *pin;
+   int ichan;
+   size_t icand;
+
+   if( *status != SAI__OK ) return;
+
+   for( icand = i1; icand <= i2; icand++ ) {
+      pin = pdata->in + pdata->off[ icand ];
+      pdata->good[ icand ] = 0;
+      for( ichan = 0; ichan < pdata->nchan; ichan++ ) {
+         if( pin[ ichan ] != VAL__BADR ) {
+            pdata->good[ icand ] = 1;
+            break;
+         }
+      }
+   }
+}
+
+/* Copy each candidate spectrum in the range "i1" to "i2" into the
+   output spectrum reserved for it. Different candidates are copied to
+   different output spectra, so no two threads write to the same output
+   element. */
+static void smf1_sparse_copy( void *job_data_ptr, size_t i1, size_t i2,
+                              int *status ) {
+   smfRebinSparseData *pdata = (smfRebinSparseData *) job_data_ptr;
+   const float *pin;
+   int ichan;
+   int iz;
+   size_t icand;
+
+   if( *status != SAI__OK ) return;
+
+   for( icand = i1; icand <= i2; icand++ ) {
+      if( pdata->slot[ icand ] < 0 ) continue;
+      pin = pdata->in + pdata->off[ icand ];
+      for( ichan = 0; ichan < pdata->nchan; ichan++ ) {
+         iz = pdata->spectab[ ichan ];
+         if( iz >= 0 ) {
+            pdata->out[ pdata->slot[ icand ] + (size_t) pdata->nspec*iz ] =
+                                                                pin[ ichan ];
+         }
+      }
+   }
+}
@@ -13,7 +13,7 @@
 *     C function
 
 *  Invocation:
-*     smf_resampcube( smfData *data, AstSkyFrame *abskyfrm,
+*     smf_resampcube( ThrWorkForce *wf, smfData *data, AstSkyFrame *abskyfrm,
 *                     AstMapping *iskymap, AstFrame *ispecfrm,
 *                     AstMapping *ispecmap, Grp *detgrp, int moving,
 *                     int slbnd[ 3 ], int subnd[ 3 ], int interp,
@@ -21,6 +21,8 @@
 *                     float *out_data, int *overlap, int *status );
 
 *  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        Pointer to a pool of worker threads (can be NULL).
 *     data = smfData * (Given)
 *        Pointer to the smfData structure describing the template time
 *        series file.
@@ -87,6 +89,8 @@
 *        Initial version.
 *     7-JAN-2009 (DSB):
 *        Remove unsused parameters index and size.
+*     14-OCT-2026:
+*        Added argument "wf".
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -130,8 +134,9 @@
 
 #define FUNC_NAME "smf_resampcube"
 
-void smf_resampcube( smfData *data, AstSkyFrame *abskyfrm, AstMapping *iskymap,
-                     AstFrame *ispecfrm, AstMapping *ispecmap,
+void smf_resampcube( ThrWorkForce *wf, smfData *data, AstSkyFrame *abskyfrm,
+                     AstMapping *iskymap, AstFrame *ispecfrm,
+                     AstMapping *ispecmap,
                      Grp *detgrp, int moving, int slbnd[ 3 ],
                      int subnd[ 3 ], int interp, const double params[],
                      float *in_data, float *out_data, int *overlap,
@@ -250,13 +255,13 @@ void smf_resampcube( smfData *data, AstSkyFrame *abskyfrm, AstMapping *iskymap,
    code that is faster than AST. We also use this code if we are just
    checking if the time series and sky cube have any overlap. */
    if( interp == AST__NEAREST || ! in_data ) {
-      smf_resampcube_nn( data, nchan, ndet, nslice, nxy,
+      smf_resampcube_nn( wf, data, nchan, ndet, nslice, nxy,
                          dim, (AstMapping *) ssmap, abskyfrm, iskymap,
                          detgrp, moving, in_data, out_data, overlap, status );
 
 /* For all other interpolation schemes, we use AST. */
    } else {
-      smf_resampcube_ast( data, nchan, ndet, nslice, nel, dim,
+      smf_resampcube_ast( wf, data, nchan, ndet, nslice, nel, dim,
                           (AstMapping *) ssmap, abskyfrm, iskymap,
                           detgrp, moving, interp, params, in_data, out_data,
                           status );
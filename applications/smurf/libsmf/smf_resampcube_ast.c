@@ -13,7 +13,7 @@
 *     C function
 
 *  Invocation:
-*     void smf_resampcube_ast( smfData *data, dim_t nchan,
+*     void smf_resampcube_ast( ThrWorkForce *wf, smfData *data, dim_t nchan,
 *                              dim_t ndet, dim_t nslice, dim_t nel,
 *                              dim_t dim[3], AstMapping *ssmap,
 *                              AstSkyFrame *abskyfrm, AstMapping *iskymap,
@@ -22,6 +22,8 @@
 *                              float *out_data, int *status );
 
 *  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        Pointer to a pool of worker threads (can be NULL).
 *     data = smfData * (Given)
 *        Pointer to the template smfData structure.
 *     index = int (Given)
@@ -82,6 +84,9 @@
 *     The data array of the supplied sky cube is resampled at the
 *     detector sample positions specified by the input template. The
 *     resampled values are stored in the output time series cube.
+*
+*     The time slices are divided into contiguous blocks, each of which
+*     is processed by a separate worker thread.
 
 *  Authors:
 *     David S Berry (JAC, UClan)
@@ -90,6 +95,8 @@
 *  History:
 *     25-JAN-2008 (DSB):
 *        Initial version.
+*     14-OCT-2026:
+*        Process blocks of time slices in separate worker threads.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -127,13 +134,41 @@
 #include "prm_par.h"
 #include "star/ndg.h"
 #include "star/atl.h"
+#include "star/thr.h"
 
 /* SMURF includes */
 #include "libsmf/smf.h"
 
+/* Local data types */
+typedef struct smfResampCubeAstData {
+   AstCmpMap *detmap;
+   AstMapping *iskymap;
+   AstMapping *sslut;
+   AstPermMap *pmap;
+   AstSkyFrame *abskyfrm;
+   const double *params;
+   dim_t ndet;
+   dim_t t1;
+   dim_t t2;
+   float *in_data;
+   float *out_data;
+   int ast_flags;
+   int interp;
+   int lbnd_out[ 2 ];
+   int ldim[ 3 ];
+   int moving;
+   int timeslice_size;
+   int ubnd_out[ 2 ];
+   int udim[ 3 ];
+   smfData *data;
+} SmfResampCubeAstData;
+
+/* Prototypes for local static functions. */
+static void smf1_resampcube_ast( void *job_data_ptr, int *status );
+
 #define FUNC_NAME "smf_resampcube_ast"
 
-void smf_resampcube_ast( smfData *data, dim_t nchan,
+void smf_resampcube_ast( ThrWorkForce *wf, smfData *data, dim_t nchan,
                          dim_t ndet, dim_t nslice, dim_t nel,
                          dim_t dim[3], AstMapping *ssmap,
                          AstSkyFrame *abskyfrm, AstMapping *iskymap,
@@ -143,22 +178,21 @@ void smf_resampcube_ast( smfData *data, dim_t nchan,
 
 /* Local Variables */
    AstCmpMap *detmap = NULL;   /* Mapping from 1D det. index to 2D "grid" coords */
-   AstMapping *dtotmap = NULL; /* 1D det index-> GRID Mapping */
-   AstMapping *fullmap = NULL; /* Mapping between in and out GRID coords */
    AstMapping *lutmap = NULL;  /* Mapping that identifies detectors to be used */
-   AstMapping *splut = NULL;   /* Spatial LutMap */
    AstMapping *sslut = NULL;   /* Spectral LutMap */
-   AstMapping *totmap = NULL;  /* Mapping between in and out spatial GRID coords */
    AstPermMap *pmap;           /* Mapping to rearrange sky cube axes */
+   SmfResampCubeAstData *job_data = NULL; /* Data for each worker thread */
+   SmfResampCubeAstData *pdata = NULL; /* Data for current worker thread */
    const char *name = NULL;    /* Pointer to current detector name */
+   dim_t idet;                 /* Detector index */
+   dim_t step;                 /* No. of time slices per thread */
    double *detlut = NULL;      /* Work space for detector mask */
    double con;                 /* Constant value */
-   float *tdata = NULL;        /* Pointer to start of output time slice data */
    int ast_flags;              /* Basic flags to use with astResample */
    int found;                  /* Was current detector name found in detgrp? */
-   dim_t idet;                 /* Detector index */
-   dim_t itime;                /* Index of current time slice */
+   int iw;                     /* Index of worker thread */
    int lbnd_out[ 2 ];          /* Lower bounds on receptor axis */
+   int nw;                     /* Number of worker threads */
    int ldim[ 3 ];              /* Sky cube array lower GRID bounds */
    int skyperm[ 3 ];           /* Sky cube axis permutation array */
    int timeslice_size;         /* Number of elements in a time slice */
@@ -276,11 +310,148 @@ void smf_resampcube_ast( smfData *data, dim_t nchan,
    tsperm[ 2 ] = 2;
    pmap = astPermMap( 3, tsperm, 3, skyperm, NULL, " " );
 
-/* Loop round all time slices in the input NDF. */
-   for( itime = 0; itime < nslice && *status == SAI__OK; itime++ ) {
+/* How many threads do we get to play with? There is no point using more
+   threads than there are time slices. */
+   nw = wf ? wf->nworker : 1;
+   if( nw > (int) nslice ) nw = nslice;
+
+/* Find how many time slices to process in each worker thread. */
+   step = ( nw > 0 ) ? nslice/nw : 0;
+
+/* Allocate job data for threads, and store the values needed by each
+   thread. Ensure that the last thread picks up any left-over time slices. */
+   job_data = astCalloc( nw, sizeof(*job_data) );
+   if( *status == SAI__OK ) {
+      for( iw = 0; iw < nw; iw++ ) {
+         pdata = job_data + iw;
+         pdata->t1 = iw*step;
+         pdata->t2 = ( iw < nw - 1 ) ? ( iw + 1 )*step - 1 : nslice - 1;
+         pdata->params = params;
+         pdata->ndet = ndet;
+         pdata->in_data = in_data;
+         pdata->out_data = out_data;
+         pdata->ast_flags = ast_flags;
+         pdata->interp = interp;
+         pdata->lbnd_out[ 0 ] = lbnd_out[ 0 ];
+         pdata->lbnd_out[ 1 ] = lbnd_out[ 1 ];
+         pdata->ubnd_out[ 0 ] = ubnd_out[ 0 ];
+         pdata->ubnd_out[ 1 ] = ubnd_out[ 1 ];
+         pdata->ldim[ 0 ] = ldim[ 0 ];
+         pdata->ldim[ 1 ] = ldim[ 1 ];
+         pdata->ldim[ 2 ] = ldim[ 2 ];
+         pdata->udim[ 0 ] = udim[ 0 ];
+         pdata->udim[ 1 ] = udim[ 1 ];
+         pdata->udim[ 2 ] = udim[ 2 ];
+         pdata->moving = moving;
+         pdata->timeslice_size = timeslice_size;
+
+/* Each thread needs its own copies of the AST objects, and of the header
+   information used by smf_rebin_totmap (which stores details of the
+   current time slice in the header). Unlock them so that the worker can
+   lock them for its own use. */
+         pdata->abskyfrm = astCopy( abskyfrm );
+         astUnlock( pdata->abskyfrm, 1 );
+         pdata->iskymap = astCopy( iskymap );
+         astUnlock( pdata->iskymap, 1 );
+         pdata->sslut = astCopy( sslut );
+         astUnlock( pdata->sslut, 1 );
+         pdata->detmap = astCopy( detmap );
+         astUnlock( pdata->detmap, 1 );
+         pdata->pmap = astCopy( pmap );
+         astUnlock( pdata->pmap, 1 );
+         pdata->data = smf_deepcopy_smfData( wf, data, 0, SMF__NOCREATE_FILE |
+                                             SMF__NOCREATE_DA |
+                                             SMF__NOCREATE_FTS |
+                                             SMF__NOCREATE_DATA |
+                                             SMF__NOCREATE_VARIANCE |
+                                             SMF__NOCREATE_QUALITY, 0, 0,
+                                             status );
+         smf_lock_data( pdata->data, 0, status );
+      }
+
+/* Submit the jobs and wait for them all to complete. */
+      for( iw = 0; iw < nw; iw++ ) {
+         pdata = job_data + iw;
+         thrAddJob( wf, 0, pdata, smf1_resampcube_ast, 0, NULL, status );
+      }
+      thrWait( wf, status );
+
+/* Free the resources used by each thread. */
+      for( iw = 0; iw < nw; iw++ ) {
+         pdata = job_data + iw;
+         if( pdata->data ) {
+            smf_lock_data( pdata->data, 1, status );
+            smf_close_file( wf, &(pdata->data), status );
+         }
+         astLock( pdata->abskyfrm, 0 );
+         pdata->abskyfrm = astAnnul( pdata->abskyfrm );
+         astLock( pdata->iskymap, 0 );
+         pdata->iskymap = astAnnul( pdata->iskymap );
+         astLock( pdata->sslut, 0 );
+         pdata->sslut = astAnnul( pdata->sslut );
+         astLock( pdata->detmap, 0 );
+         pdata->detmap = astAnnul( pdata->detmap );
+         astLock( pdata->pmap, 0 );
+         pdata->pmap = astAnnul( pdata->pmap );
+      }
+   }
+
+/* Free resources. */
+   job_data = astFree( job_data );
+   detlut = astFree( detlut );
+}
+
+
+static void smf1_resampcube_ast( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_resampcube_ast
+
+*  Purpose:
+*     Executed in a worker thread to resample the sky cube at the detector
+*     positions in a block of time slices for smf_resampcube_ast.
+
+*  Invocation:
+*     smf1_resampcube_ast( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = SmfResampCubeAstData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+/* Local Variables: */
+   AstMapping *dtotmap = NULL; /* 1D det index-> GRID Mapping */
+   AstMapping *fullmap = NULL; /* Mapping between in and out GRID coords */
+   AstMapping *splut = NULL;   /* Spatial LutMap */
+   AstMapping *totmap = NULL;  /* Mapping between in and out spatial GRID coords */
+   SmfResampCubeAstData *pdata;/* Data describing the job */
+   dim_t itime;                /* Index of current time slice */
+   float *tdata = NULL;        /* Pointer to start of output time slice data */
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Get a pointer that can be used for accessing the required items in the
+   supplied structure. */
+   pdata = (SmfResampCubeAstData *) job_data_ptr;
+
+/* Lock the AST objects and smfData for exclusive use by this thread. */
+   astLock( pdata->abskyfrm, 0 );
+   astLock( pdata->iskymap, 0 );
+   astLock( pdata->sslut, 0 );
+   astLock( pdata->detmap, 0 );
+   astLock( pdata->pmap, 0 );
+   smf_lock_data( pdata->data, 1, status );
+
+/* Loop round all time slices in the block. */
+   for( itime = pdata->t1; itime <= pdata->t2 && *status == SAI__OK; itime++ ) {
 
 /* Store a pointer to the first output data value in this time slice. */
-      tdata = out_data + itime*timeslice_size;
+      tdata = pdata->out_data + itime*pdata->timeslice_size;
 
 /* Begin an AST context. Having this context within the time slice loop
    helps keep the number of AST objects in use to a minimum. */
@@ -291,9 +462,13 @@ void smf_resampcube_ast( smfData *data, dim_t nchan,
    to be done first since it stores details of the current time slice
    in the "smfHead" structure inside "data", and this is needed by
    subsequent functions. */
-      totmap = smf_rebin_totmap( data, itime, abskyfrm, iskymap, moving,
-				 NO_FTS, status );
-      if( !totmap ) break;
+      totmap = smf_rebin_totmap( pdata->data, itime, pdata->abskyfrm,
+                                 pdata->iskymap, pdata->moving, NO_FTS,
+                                 status );
+      if( !totmap ) {
+         astEnd;
+         break;
+      }
 
 /* So "totmap" is a 2-input, 2-output Mapping that transforms the template
    spatial GRID coords into sky cube spatial GRID coords. In order to speed
@@ -305,31 +480,39 @@ void smf_resampcube_ast( smfData *data, dim_t nchan,
    detector index) and 3-output (output grid coords) Mapping. We finally
    add a PermMap to re-arrange the output axes so that channel number is
    axis 3 in the output. */
-      dtotmap = (AstMapping *) astCmpMap( detmap, totmap, 1, " " );
-      if( ndet > 1 ) {
-         atlTolut( dtotmap, 1.0, (double) ndet, 1.0, "LutInterp=1", &splut,
-                   status );
+      dtotmap = (AstMapping *) astCmpMap( pdata->detmap, totmap, 1, " " );
+      if( pdata->ndet > 1 ) {
+         atlTolut( dtotmap, 1.0, (double) pdata->ndet, 1.0, "LutInterp=1",
+                   &splut, status );
       } else {
          splut = astClone( dtotmap );
       }
 
-      fullmap = astSimplify( astCmpMap( astCmpMap( sslut, splut, 0, " " ),
-                                        pmap, 1, " " ) );
+      fullmap = astSimplify( astCmpMap( astCmpMap( pdata->sslut, splut, 0,
+                                                   " " ),
+                                        pdata->pmap, 1, " " ) );
 
 /* Invert this Mapping to get the mapping from sky cube grid coords to time
    series grid coords. */
       astInvert( fullmap );
 
 /* Resample the sky cube to get data for this time slice. */
-      astResampleF( fullmap, 3, ldim, udim, in_data, NULL, interp, NULL,
-                    params, ast_flags, 0.0, 50, VAL__BADR, 2, lbnd_out,
-                    ubnd_out, lbnd_out, ubnd_out, tdata, NULL );
+      astResampleF( fullmap, 3, pdata->ldim, pdata->udim, pdata->in_data,
+                    NULL, pdata->interp, NULL, pdata->params,
+                    pdata->ast_flags, 0.0, 50, VAL__BADR, 2, pdata->lbnd_out,
+                    pdata->ubnd_out, pdata->lbnd_out, pdata->ubnd_out, tdata,
+                    NULL );
 
 /* End the AST context. */
       astEnd;
    }
 
-/* Free resources. */
-   detlut = astFree( detlut );
+/* Unlock the AST objects and smfData so that the main thread can annul
+   them. */
+   smf_lock_data( pdata->data, 0, status );
+   astUnlock( pdata->abskyfrm, 1 );
+   astUnlock( pdata->iskymap, 1 );
+   astUnlock( pdata->sslut, 1 );
+   astUnlock( pdata->detmap, 1 );
+   astUnlock( pdata->pmap, 1 );
 }
-
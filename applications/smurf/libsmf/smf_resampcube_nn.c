@@ -14,7 +14,7 @@
 *     C function
 
 *  Invocation:
-*     void smf_resampcube_nn( smfData *data, dim_t nchan,
+*     void smf_resampcube_nn( ThrWorkForce *wf, smfData *data, dim_t nchan,
 *                             dim_t ndet, dim_t nslice, dim_t nxy,
 *                             dim_t dim[3], AstMapping *ssmap,
 *                             AstSkyFrame *abskyfrm, AstMapping *iskymap,
@@ -22,6 +22,8 @@
 *                             float *out_data, int overlap, int *status );
 
 *  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        Pointer to a pool of worker threads (can be NULL).
 *     data = smfData * (Given)
 *        Pointer to the template smfData structure.
 *     nchan = dim_t (Given)
@@ -73,6 +75,9 @@
 *
 *     Specialised code is used that only provides Nearest Neighbour
 *     spreading when pasting each input pixel value into the output cube.
+*
+*     The time slices are divided into contiguous blocks, each of which
+*     is processed by a separate worker thread.
 
 *  Authors:
 *     David S Berry (JAC, UClan)
@@ -83,6 +88,8 @@
 *        Initial version.
 *     5-MAR-2008 (DSB):
 *        Added overlap argument.
+*     14-OCT-2026:
+*        Process blocks of time slices in separate worker threads.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -120,13 +127,37 @@
 #include "prm_par.h"
 #include "star/ndg.h"
 #include "star/atl.h"
+#include "star/thr.h"
 
 /* SMURF includes */
 #include "libsmf/smf.h"
 
+/* Local data types */
+typedef struct smfResampCubeNNData {
+   AstMapping *iskymap;
+   AstSkyFrame *abskyfrm;
+   const double *detxtemplt;
+   const double *detytemplt;
+   dim_t dim[ 3 ];
+   dim_t nchan;
+   dim_t ndet;
+   dim_t nxy;
+   dim_t t1;
+   dim_t t2;
+   float *in_data;
+   float *out_data;
+   int *spectab;
+   int moving;
+   int overlap;
+   smfData *data;
+} SmfResampCubeNNData;
+
+/* Prototypes for local static functions. */
+static void smf1_resampcube_nn( void *job_data_ptr, int *status );
+
 #define FUNC_NAME "smf_resampcube_nn"
 
-void smf_resampcube_nn( smfData *data, dim_t nchan,
+void smf_resampcube_nn( ThrWorkForce *wf, smfData *data, dim_t nchan,
                         dim_t ndet, dim_t nslice, dim_t nxy,
                         dim_t dim[3], AstMapping *ssmap,
                         AstSkyFrame *abskyfrm, AstMapping *iskymap,
@@ -134,22 +165,17 @@ void smf_resampcube_nn( smfData *data, dim_t nchan,
                         float *out_data, int *overlap, int *status ){
 
 /* Local Variables */
-   AstMapping *totmap = NULL;  /* WCS->GRID Mapping from template WCS FrameSet */
+   SmfResampCubeNNData *job_data = NULL; /* Data for each worker thread */
+   SmfResampCubeNNData *pdata = NULL; /* Data for current worker thread */
    const char *name = NULL;    /* Pointer to current detector name */
-   dim_t timeslice_size;       /* No of detector values in one time slice */
+   dim_t idet;                 /* Detector index */
+   dim_t step;                 /* No. of time slices per thread */
    double *detxtemplt = NULL;  /* Work space for template X grid coords */
-   double *detxskycube = NULL; /* Work space for sky cube X grid coords */
    double *detytemplt = NULL;  /* Work space for template Y grid coords */
-   double *detyskycube = NULL; /* Work space for sky cube Y grid coords */
-   float *ddata = NULL;        /* Pointer to start of output detector data */
-   float *tdata = NULL;        /* Pointer to start of sky cube time slice data */
    int *spectab = NULL;        /* Template->sky cube channel number conversion table */
    int found;                  /* Was current detector name found in detgrp? */
-   dim_t gxsky;                /* Sky cube X grid index */
-   dim_t gysky;                /* Sky cube Y grid index */
-   dim_t idet;                 /* Detector index */
-   dim_t itime;                /* Index of current time slice */
-   int iv0;                    /* Offset for pixel in 1st sky cube spectral channel */
+   int iw;                     /* Index of worker thread */
+   int nw;                     /* Number of worker threads */
    smfHead *hdr = NULL;        /* Pointer to data header for this time slice */
 
 /* Initialise */
@@ -161,20 +187,16 @@ void smf_resampcube_nn( smfData *data, dim_t nchan,
 /* Store a pointer to the template NDFs smfHead structure. */
    hdr = data->hdr;
 
-/* Store the number of pixels in one time slice */
-   timeslice_size = ndet*nchan;
-
 /* Use the supplied mapping to get the zero-based sky cube channel number
    corresponding to each template channel number. */
    smf_rebincube_spectab( nchan, dim[ 2 ], ssmap, &spectab, status );
    if( !spectab ) goto L999;
 
-/* Allocate work arrays to hold the template and sky cube grid coords for each
+/* Allocate work arrays to hold the template grid coords for each
    detector. */
    detxtemplt = astMalloc( ndet*sizeof( double ) );
    detytemplt = astMalloc( ndet*sizeof( double ) );
-   detxskycube = astMalloc( ndet*sizeof( double ) );
-   detyskycube = astMalloc( ndet*sizeof( double ) );
+   if( *status != SAI__OK ) goto L999;
 
 /* Initialise a string to point to the name of the first detector for which
    data is to be created. */
@@ -200,11 +222,149 @@ void smf_resampcube_nn( smfData *data, dim_t nchan,
       name += strlen( name ) + 1;
    }
 
-/* Loop round all time slices in the template NDF. */
-   for( itime = 0; itime < nslice && *status == SAI__OK; itime++ ) {
+/* How many threads do we get to play with? There is no point using more
+   threads than there are time slices. */
+   nw = wf ? wf->nworker : 1;
+   if( nw > (int) nslice ) nw = nslice;
+   if( nw < 1 ) goto L999;
+
+/* Find how many time slices to process in each worker thread. */
+   step = nslice/nw;
+
+/* Allocate job data for threads, and store the values needed by each
+   thread. Ensure that the last thread picks up any left-over time slices. */
+   job_data = astCalloc( nw, sizeof(*job_data) );
+   if( *status == SAI__OK ) {
+      for( iw = 0; iw < nw; iw++ ) {
+         pdata = job_data + iw;
+         pdata->t1 = iw*step;
+         pdata->t2 = ( iw < nw - 1 ) ? ( iw + 1 )*step - 1 : nslice - 1;
+         pdata->detxtemplt = detxtemplt;
+         pdata->detytemplt = detytemplt;
+         pdata->dim[ 0 ] = dim[ 0 ];
+         pdata->dim[ 1 ] = dim[ 1 ];
+         pdata->dim[ 2 ] = dim[ 2 ];
+         pdata->nchan = nchan;
+         pdata->ndet = ndet;
+         pdata->nxy = nxy;
+         pdata->in_data = in_data;
+         pdata->out_data = out_data;
+         pdata->spectab = spectab;
+         pdata->moving = moving;
+         pdata->overlap = 0;
+
+/* Each thread needs its own copies of the AST objects, and of the header
+   information used by smf_rebin_totmap (which stores details of the
+   current time slice in the header). Unlock them so that the worker can
+   lock them for its own use. */
+         pdata->abskyfrm = astCopy( abskyfrm );
+         astUnlock( pdata->abskyfrm, 1 );
+         pdata->iskymap = astCopy( iskymap );
+         astUnlock( pdata->iskymap, 1 );
+         pdata->data = smf_deepcopy_smfData( wf, data, 0, SMF__NOCREATE_FILE |
+                                             SMF__NOCREATE_DA |
+                                             SMF__NOCREATE_FTS |
+                                             SMF__NOCREATE_DATA |
+                                             SMF__NOCREATE_VARIANCE |
+                                             SMF__NOCREATE_QUALITY, 0, 0,
+                                             status );
+         smf_lock_data( pdata->data, 0, status );
+      }
+
+/* Submit the jobs and wait for them all to complete. */
+      for( iw = 0; iw < nw; iw++ ) {
+         pdata = job_data + iw;
+         thrAddJob( wf, 0, pdata, smf1_resampcube_nn, 0, NULL, status );
+      }
+      thrWait( wf, status );
+
+/* Combine the overlap flags, and free the resources used by each
+   thread. */
+      for( iw = 0; iw < nw; iw++ ) {
+         pdata = job_data + iw;
+         if( pdata->overlap ) *overlap = 1;
+
+         if( pdata->data ) {
+            smf_lock_data( pdata->data, 1, status );
+            smf_close_file( wf, &(pdata->data), status );
+         }
+         astLock( pdata->abskyfrm, 0 );
+         pdata->abskyfrm = astAnnul( pdata->abskyfrm );
+         astLock( pdata->iskymap, 0 );
+         pdata->iskymap = astAnnul( pdata->iskymap );
+      }
+   }
+
+/* Free non-static resources. */
+L999:;
+   job_data = astFree( job_data );
+   spectab = astFree( spectab );
+   detxtemplt = astFree( detxtemplt );
+   detytemplt = astFree( detytemplt );
+
+}
+
+
+static void smf1_resampcube_nn( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_resampcube_nn
+
+*  Purpose:
+*     Executed in a worker thread to resample the sky cube at the detector
+*     positions in a block of time slices for smf_resampcube_nn.
+
+*  Invocation:
+*     smf1_resampcube_nn( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = SmfResampCubeNNData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+/* Local Variables: */
+   AstMapping *totmap = NULL;  /* WCS->GRID Mapping from template WCS FrameSet */
+   SmfResampCubeNNData *pdata; /* Data describing the job */
+   dim_t gxsky;                /* Sky cube X grid index */
+   dim_t gysky;                /* Sky cube Y grid index */
+   dim_t idet;                 /* Detector index */
+   dim_t itime;                /* Index of current time slice */
+   dim_t timeslice_size;       /* No of detector values in one time slice */
+   double *detxskycube = NULL; /* Work space for sky cube X grid coords */
+   double *detyskycube = NULL; /* Work space for sky cube Y grid coords */
+   float *ddata = NULL;        /* Pointer to start of output detector data */
+   float *tdata = NULL;        /* Pointer to start of sky cube time slice data */
+   int iv0;                    /* Offset for pixel in 1st sky cube spectral channel */
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Get a pointer that can be used for accessing the required items in the
+   supplied structure. */
+   pdata = (SmfResampCubeNNData *) job_data_ptr;
+
+/* Lock the AST objects and smfData for exclusive use by this thread. */
+   astLock( pdata->abskyfrm, 0 );
+   astLock( pdata->iskymap, 0 );
+   smf_lock_data( pdata->data, 1, status );
+
+/* Store the number of pixels in one time slice */
+   timeslice_size = pdata->ndet*pdata->nchan;
+
+/* Allocate work arrays to hold the sky cube grid coords for each
+   detector. */
+   detxskycube = astMalloc( pdata->ndet*sizeof( double ) );
+   detyskycube = astMalloc( pdata->ndet*sizeof( double ) );
+
+/* Loop round all time slices in the block. */
+   for( itime = pdata->t1; itime <= pdata->t2 && *status == SAI__OK; itime++ ) {
 
 /* Store a pointer to the first output data value in this time slice. */
-      tdata = in_data ? ( out_data + itime*timeslice_size ) : NULL;
+      tdata = pdata->in_data ? ( pdata->out_data + itime*timeslice_size ) : NULL;
 
 /* Begin an AST context. Having this context within the time slice loop
    helps keep the number of AST objects in use to a minimum. */
@@ -215,8 +375,9 @@ void smf_resampcube_nn( smfData *data, dim_t nchan,
    to be done first since it stores details of the current time slice
    in the "smfHead" structure inside "data", and this is needed by
    subsequent functions. */
-      totmap = smf_rebin_totmap( data, itime, abskyfrm, iskymap, moving,
-				 NO_FTS, status );
+      totmap = smf_rebin_totmap( pdata->data, itime, pdata->abskyfrm,
+                                 pdata->iskymap, pdata->moving, NO_FTS,
+                                 status );
       if( !totmap ) {
          astEnd;
          break;
@@ -224,14 +385,14 @@ void smf_resampcube_nn( smfData *data, dim_t nchan,
 
 /* Use this Mapping to get the sky cube spatial grid coords for each
    template detector. */
-      astTran2( totmap, ndet, detxtemplt, detytemplt, 1, detxskycube,
-                detyskycube );
+      astTran2( totmap, pdata->ndet, pdata->detxtemplt, pdata->detytemplt,
+                1, detxskycube, detyskycube );
 
 /* Loop round each detector, obtaining its output value from the sky cube. */
-      for( idet = 0; idet < ndet; idet++ ) {
+      for( idet = 0; idet < pdata->ndet; idet++ ) {
 
 /* Get a pointer to the start of the output spectrum data. */
-         ddata = tdata + idet*nchan;
+         ddata = tdata + idet*pdata->nchan;
 
 /* Check the detector has a valid position in sky cube grid coords */
          if( detxskycube[ idet ] != AST__BAD && detyskycube[ idet ] != AST__BAD ){
@@ -240,18 +401,19 @@ void smf_resampcube_nn( smfData *data, dim_t nchan,
    sky cube. */
             gxsky = floor( detxskycube[ idet ] + 0.5 );
             gysky = floor( detyskycube[ idet ] + 0.5 );
-            if( gxsky >= 1 && gxsky <= dim[ 0 ] &&
-                gysky >= 1 && gysky <= dim[ 1 ] ) {
+            if( gxsky >= 1 && gxsky <= pdata->dim[ 0 ] &&
+                gysky >= 1 && gysky <= pdata->dim[ 1 ] ) {
 
 /* Get the offset of the sky cube array element that corresponds to this
    pixel in the first spectral channel. */
-               iv0 = ( gysky - 1 )*dim[ 0 ] + ( gxsky - 1 );
+               iv0 = ( gysky - 1 )*pdata->dim[ 0 ] + ( gxsky - 1 );
 
 /* Copy the sky cube spectrum into the output time series cube. */
-               *overlap = 1;
-               if( in_data ) {
-                  smf_resampcube_copy( nchan, spectab, iv0, nxy,
-                                       ddata, in_data, status );
+               pdata->overlap = 1;
+               if( pdata->in_data ) {
+                  smf_resampcube_copy( pdata->nchan, pdata->spectab, iv0,
+                                       pdata->nxy, ddata, pdata->in_data,
+                                       status );
                } else {
                   break;
                }
@@ -264,15 +426,16 @@ void smf_resampcube_nn( smfData *data, dim_t nchan,
 
 /* If no input data was supplied, and we have found at least one input
    spectrum that overlaps the sky cube, we can finish early. */
-      if( !in_data && *overlap ) break;
+      if( !pdata->in_data && pdata->overlap ) break;
    }
 
-/* Free non-static resources. */
-L999:;
-   spectab = astFree( spectab );
-   detxtemplt = astFree( detxtemplt );
-   detytemplt = astFree( detytemplt );
+/* Free resources. */
    detxskycube = astFree( detxskycube );
    detyskycube = astFree( detyskycube );
 
+/* Unlock the AST objects and smfData so that the main thread can annul
+   them. */
+   smf_lock_data( pdata->data, 0, status );
+   astUnlock( pdata->abskyfrm, 1 );
+   astUnlock( pdata->iskymap, 1 );
 }
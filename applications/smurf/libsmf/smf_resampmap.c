@@ -78,6 +78,12 @@
 *     The data array of the supplied sky map is resampled at the
 *     bolometer sample positions specified by the input template. The
 *     resampled values are stored in the output time series cube.
+*
+*     The time slices are divided into contiguous blocks, each of which
+*     is processed by a separate worker thread. If noise or pointing
+*     errors are to be added, each thread uses its own random number
+*     generator, seeded from a single default generator, so the added
+*     values depend on the number of threads in use.
 
 *  Authors:
 *     David S Berry (JAC, UClan)
@@ -88,6 +94,11 @@
 *        Initial version.
 *     7-JAN-2013 (DSB):
 *        Added argument ang_data.
+*     14-OCT-2026:
+*        Give each thread its own random number generator (seeded from a
+*        single default generator) since GSL generators cannot be shared
+*        between threads. Also, "ngood" is now summed over all time slices
+*        rather than being set from the last time slice in each thread.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -274,7 +285,12 @@ void smf_resampmap( ThrWorkForce *wf, smfData *data, AstSkyFrame *abskyfrm,
          pdata->params = params;
          pdata->sky_dim[ 0 ] = subnd[ 0 ] - slbnd[ 0 ] + 1;
          pdata->sky_dim[ 1 ] = subnd[ 1 ] - slbnd[ 1 ] + 1;
-         pdata->r = r;
+         if( r ) {
+            pdata->r = gsl_rng_alloc( type );
+            gsl_rng_set( pdata->r, gsl_rng_get( r ) );
+         } else {
+            pdata->r = NULL;
+         }
          pdata->sigma = sigma;
          pdata->perror = perror;
          pdata->ngood = 0;
@@ -310,6 +326,8 @@ void smf_resampmap( ThrWorkForce *wf, smfData *data, AstSkyFrame *abskyfrm,
             astLock( pdata->fpmap, 0 );
             pdata->fpmap = astAnnul( pdata->fpmap );
          }
+
+         if( pdata->r ) gsl_rng_free( pdata->r );
       }
 
       job_data = astFree( job_data );
@@ -478,8 +496,8 @@ static void smf1ResampMap( void *job_data_ptr, int *status ) {
         tmap = astAnnul( tmap );
      }
 
-/* Return the number of good output sample values. */
-      pdata->ngood = nbolo - nbad;
+/* Increment the number of good output sample values. */
+      pdata->ngood += nbolo - nbad;
 
 /* Add Gaussian noise to the output values. */
       if( r && sigma > 0.0 ) {
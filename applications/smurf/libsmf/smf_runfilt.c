@@ -0,0 +1,362 @@
+/*
+*+
+*  Name:
+*     smf_runfilt
+
+*  Purpose:
+*     Maintain a running median, minimum or maximum filter box.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routines
+
+*  Invocation:
+*     void smf_runfilt_init( smfRunFilt *rf, smf_filt_t type, dim_t box,
+*                            double *w1, size_t *w2, int *w3, int *status )
+*     void smf_runfilt_add( smfRunFilt *rf, dim_t slot, double value,
+*                           int *status )
+*     void smf_runfilt_remove( smfRunFilt *rf, dim_t slot, int *status )
+*     double smf_runfilt_value( const smfRunFilt *rf, int mean,
+*                               int *status )
+
+*  Arguments:
+*     rf = smfRunFilt * (Given and Returned)
+*        The filter box.
+*     type = smf_filt_t (Given)
+*        The type of filter: SMF__FILT_MEDIAN, SMF__FILT_MIN or
+*        SMF__FILT_MAX.
+*     box = dim_t (Given)
+*        The number of slots in the filter box.
+*     w1 = double * (Given and Returned)
+*        A work array of length "box".
+*     w2 = size_t * (Given and Returned)
+*        A work array of length "box".
+*     w3 = int * (Given and Returned)
+*        A work array of length "box".
+*     slot = dim_t (Given)
+*        The slot (in the range 0 to "box"-1) holding the value to add or
+*        remove. Callers moving a box along a time-series will normally
+*        use the index of each sample modulo "box".
+*     value = double (Given)
+*        The value to add. VAL__BADD values occupy their slot but are
+*        otherwise ignored.
+*     mean = int (Given)
+*        Only used by median filters when the box contains an even number
+*        of good values. If non-zero the mean of the two central values is
+*        returned. Otherwise the larger of the two central values is
+*        returned.
+*     status = int * (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     smf_runfilt_value returns the median, minimum or maximum of the good
+*     values currently in the filter box, or VAL__BADD if the box contains
+*     no good values.
+
+*  Description:
+*     These routines implement a filter box that can be moved along a
+*     data stream one sample at a time without re-sorting the values in
+*     the box. smf_runfilt_init initialises an empty box using the
+*     supplied work arrays, smf_runfilt_add stores a value in an empty
+*     slot, smf_runfilt_remove empties a slot, and smf_runfilt_value
+*     returns the current filtered value.
+*
+*     For a median filter, the good values are held in a pair of heaps -
+*     a max-heap holding the lower half of the values and a min-heap
+*     holding the upper half - so that the median is available at the top
+*     of the heaps, and a value can be added or removed in a time
+*     proportional to the log of the box size. Minimum and maximum
+*     filters use a double-ended queue holding only the values that may
+*     still become the extreme value, which takes a constant time per
+*     sample on average. Minimum and maximum filters require values to
+*     be removed in the order in which they were added.
+
+*  Authors:
+*     David S Berry (JAC, Hawaii)
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version, extracted from smf_median_smooth so that it can
+*        be shared by other routines that need a running median.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "prm_par.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+/* The values in the filter box are stored in "val", indexed by slot.
+   For a median filter, "list" holds the slots of the good values,
+   arranged as two heaps: a max-heap holding the lower half of the
+   values, stored from the start of "list", and a min-heap holding the
+   upper half, stored from the end of "list" backwards. "pos" gives the
+   position of each slot within the heaps: "k" for element "k" of the
+   lower heap, "-2-k" for element "k" of the upper heap, and -1 for a bad
+   or empty slot. For a minimum or maximum filter, "list" is a circular
+   queue of slots, in time order, holding the values that can still
+   become the extreme value, and "pos" is -1 for bad or empty slots and 0
+   otherwise. */
+
+/* The slot stored at element "k" of the lower (upper=0) or upper
+   (upper=1) heap. */
+#define HEAP(rf,upper,k) ((rf)->list[ (upper) ? (rf)->box - 1 - (k) : (k) ])
+
+/* Prototypes for local functions */
+static void smf1_put( smfRunFilt *rf, int upper, dim_t k, size_t slot );
+static dim_t smf1_siftup( smfRunFilt *rf, int upper, dim_t k );
+static void smf1_siftdown( smfRunFilt *rf, int upper, dim_t k );
+static void smf1_balance( smfRunFilt *rf );
+
+void smf_runfilt_init( smfRunFilt *rf, smf_filt_t type, dim_t box,
+                       double *w1, size_t *w2, int *w3, int *status ){
+   dim_t ibox;
+
+   if( *status != SAI__OK ) return;
+
+   if( type != SMF__FILT_MEDIAN && type != SMF__FILT_MIN &&
+       type != SMF__FILT_MAX ) {
+      *status = SAI__ERROR;
+      errRepf( " ", "smf_runfilt_init: Illegal filter type value %d "
+               "(internal SMURF programming error).", status, (int) type );
+      return;
+   }
+
+   if( box == 0 ) {
+      *status = SAI__ERROR;
+      errRep( " ", "smf_runfilt_init: Box is zero.", status );
+      return;
+   }
+
+   rf->type = type;
+   rf->box = box;
+   rf->inbox = 0;
+   rf->nlo = 0;
+   rf->nhi = 0;
+   rf->head = 0;
+   rf->nqueue = 0;
+   rf->val = w1;
+   rf->list = w2;
+   rf->pos = w3;
+
+/* Mark every slot as empty. */
+   for( ibox = 0; ibox < box; ibox++ ) {
+      w1[ ibox ] = VAL__BADD;
+      w3[ ibox ] = -1;
+   }
+}
+
+/* Add a value into the filter box at a given slot, which should be
+   empty. Bad values are recorded but not stored in the heaps or queue. */
+void smf_runfilt_add( smfRunFilt *rf, dim_t slot, double value,
+                      int *status ){
+   dim_t back;
+   dim_t k;
+   size_t last;
+
+   if( *status != SAI__OK ) return;
+
+   rf->val[ slot ] = value;
+   if( value == VAL__BADD ) {
+      rf->pos[ slot ] = -1;
+      return;
+   }
+   rf->inbox++;
+
+/* For a median filter, add the value to the lower heap if it is no larger
+   than the largest value in the lower heap, and to the upper heap
+   otherwise. Then ensure the two heaps still contain the lower and upper
+   halves of the values. */
+   if( rf->type == SMF__FILT_MEDIAN ) {
+      if( rf->nlo == 0 || value <= rf->val[ HEAP( rf, 0, 0 ) ] ) {
+         k = rf->nlo++;
+         smf1_put( rf, 0, k, slot );
+         smf1_siftup( rf, 0, k );
+      } else {
+         k = rf->nhi++;
+         smf1_put( rf, 1, k, slot );
+         smf1_siftup( rf, 1, k );
+      }
+      smf1_balance( rf );
+
+/* For a minimum (maximum) filter, values at the back of the queue that
+   are not smaller (larger) than the new value can never again be the
+   extreme value, since the new value will remain in the box for longer.
+   Remove them, and then add the new value to the back of the queue. */
+   } else {
+      while( rf->nqueue > 0 ) {
+         back = ( rf->head + rf->nqueue - 1 ) % rf->box;
+         last = rf->list[ back ];
+         if( rf->type == SMF__FILT_MIN ? rf->val[ last ] >= value :
+                                         rf->val[ last ] <= value ) {
+            rf->pos[ last ] = -1;
+            rf->nqueue--;
+         } else {
+            break;
+         }
+      }
+      rf->list[ ( rf->head + rf->nqueue ) % rf->box ] = slot;
+      rf->nqueue++;
+      rf->pos[ slot ] = 0;
+   }
+}
+
+/* Remove the value at a given slot from the filter box, leaving the slot
+   empty. */
+void smf_runfilt_remove( smfRunFilt *rf, dim_t slot, int *status ){
+   dim_t k;
+   dim_t n;
+   int p;
+   int upper;
+
+   if( *status != SAI__OK ) return;
+
+   if( rf->val[ slot ] == VAL__BADD ) return;
+   rf->val[ slot ] = VAL__BADD;
+   rf->inbox--;
+
+   p = rf->pos[ slot ];
+   if( p == -1 ) return;
+   rf->pos[ slot ] = -1;
+
+/* For a median filter, replace the value with the last value in the same
+   heap, and then move that value up or down the heap as required. */
+   if( rf->type == SMF__FILT_MEDIAN ) {
+      upper = ( p < -1 );
+      k = upper ? -2 - p : p;
+      n = upper ? --rf->nhi : --rf->nlo;
+      if( k < n ) {
+         smf1_put( rf, upper, k, HEAP( rf, upper, n ) );
+         if( smf1_siftup( rf, upper, k ) == k ) smf1_siftdown( rf, upper, k );
+      }
+      smf1_balance( rf );
+
+/* For a minimum or maximum filter, the oldest value in the box can only
+   be in the queue if it is at the front. */
+   } else if( rf->nqueue > 0 && rf->list[ rf->head ] == (size_t) slot ) {
+      if( ++rf->head == rf->box ) rf->head = 0;
+      rf->nqueue--;
+   }
+}
+
+/* Return the median, minimum or maximum of the good values in the filter
+   box. */
+double smf_runfilt_value( const smfRunFilt *rf, int mean, int *status ){
+   if( *status != SAI__OK || rf->inbox == 0 ) return VAL__BADD;
+
+   if( rf->type != SMF__FILT_MEDIAN ) {
+      return rf->val[ rf->list[ rf->head ] ];
+   } else if( rf->inbox % 2 == 1 ) {
+      return rf->val[ HEAP( rf, 0, 0 ) ];
+   } else if( mean ) {
+      return 0.5*( rf->val[ HEAP( rf, 0, 0 ) ] + rf->val[ HEAP( rf, 1, 0 ) ] );
+   } else {
+      return rf->val[ HEAP( rf, 1, 0 ) ];
+   }
+}
+
+/* Store a slot at element "k" of a heap, and record its position. */
+static void smf1_put( smfRunFilt *rf, int upper, dim_t k, size_t slot ){
+   HEAP( rf, upper, k ) = slot;
+   rf->pos[ slot ] = upper ? -2 - (int) k : (int) k;
+}
+
+/* Move element "k" of a heap up towards the top of the heap until its
+   parent is no smaller (lower heap) or no larger (upper heap) than it.
+   The new index of the element is returned. */
+static dim_t smf1_siftup( smfRunFilt *rf, int upper, dim_t k ){
+   dim_t parent;
+   size_t pslot;
+   size_t slot = HEAP( rf, upper, k );
+   double value = rf->val[ slot ];
+
+   while( k > 0 ) {
+      parent = ( k - 1 )/2;
+      pslot = HEAP( rf, upper, parent );
+      if( upper ? rf->val[ pslot ] <= value : rf->val[ pslot ] >= value ) break;
+      smf1_put( rf, upper, k, pslot );
+      k = parent;
+   }
+   smf1_put( rf, upper, k, slot );
+   return k;
+}
+
+/* Move element "k" of a heap down away from the top of the heap until
+   neither of its children is larger (lower heap) or smaller (upper heap)
+   than it. */
+static void smf1_siftdown( smfRunFilt *rf, int upper, dim_t k ){
+   dim_t child;
+   dim_t n = upper ? rf->nhi : rf->nlo;
+   size_t cslot;
+   size_t slot = HEAP( rf, upper, k );
+   double value = rf->val[ slot ];
+
+   while( ( child = 2*k + 1 ) < n ) {
+      if( child + 1 < n ) {
+         if( upper ? rf->val[ HEAP( rf, upper, child + 1 ) ] <
+                     rf->val[ HEAP( rf, upper, child ) ] :
+                     rf->val[ HEAP( rf, upper, child + 1 ) ] >
+                     rf->val[ HEAP( rf, upper, child ) ] ) child++;
+      }
+      cslot = HEAP( rf, upper, child );
+      if( upper ? rf->val[ cslot ] >= value : rf->val[ cslot ] <= value ) break;
+      smf1_put( rf, upper, k, cslot );
+      k = child;
+   }
+   smf1_put( rf, upper, k, slot );
+}
+
+/* Move values between the heaps so that the lower heap contains either
+   the same number of values as the upper heap, or one more. */
+static void smf1_balance( smfRunFilt *rf ){
+   int from;
+   dim_t k;
+   size_t slot;
+
+   while( rf->nlo > rf->nhi + 1 || rf->nhi > rf->nlo ) {
+      from = ( rf->nhi > rf->nlo );
+
+/* Remove the top element from the larger heap. */
+      slot = HEAP( rf, from, 0 );
+      k = from ? --rf->nhi : --rf->nlo;
+      if( k > 0 ) {
+         smf1_put( rf, from, 0, HEAP( rf, from, k ) );
+         smf1_siftdown( rf, from, 0 );
+      }
+
+/* Add it to the other heap. */
+      k = from ? rf->nlo++ : rf->nhi++;
+      smf1_put( rf, !from, k, slot );
+      smf1_siftup( rf, !from, k );
+   }
+}
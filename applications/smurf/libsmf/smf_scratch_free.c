@@ -0,0 +1,147 @@
+/*
+*+
+*  Name:
+*     smf_scratch_free
+
+*  Purpose:
+*     Free an array allocated by smf_scratch_malloc.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     pntr = smf_scratch_free( void *pntr, int *status )
+
+*  Arguments:
+*     pntr = void * (Given)
+*        Pointer to the array to free. May be NULL.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     A NULL pointer.
+
+*  Description:
+*     If the supplied array is held in a memory-mapped scratch file
+*     created by smf_scratch_malloc, the file is unmapped (which deletes
+*     it). Otherwise, the array is assumed to be on the heap and is
+*     freed using astFree. This means it is safe to use this function to
+*     free any array that could have been allocated by either
+*     smf_scratch_malloc or astMalloc.
+*
+*     Heap arrays that were obtained from the pool of recycled arrays
+*     (see smf_scratch_pool) are returned to the pool as spare arrays if
+*     pooling is still enabled, rather than being freed.
+
+*  Notes:
+*     - This routine attempts to execute even if status is set on entry,
+*     although no further error report will be made if it subsequently
+*     fails under these circumstances.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <sys/mman.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+void *smf_scratch_free( void *pntr, int *status ){
+
+/* Local Variables: */
+   int lstatus = SAI__OK;
+   int spared = 0;
+   smfScratchBlock **link;
+   smfScratchBlock *block = NULL;
+   smfScratchBlock *pooled = NULL;
+
+   if( !pntr ) return NULL;
+
+/* Look for the array in the list of scratch arrays, removing it from the
+   list if found. The list is empty unless SMURF_SCRATCHDIR is set, so
+   this costs nothing in the usual case. A local status is used so that
+   the array is freed even if an error has already occurred. */
+   if( smf_scratch_blocks ) {
+      thrMutexLock( &smf_scratch_mutex, &lstatus );
+      for( link = &smf_scratch_blocks; *link; link = &(*link)->next ) {
+         if( (*link)->pntr == pntr ) {
+            block = *link;
+            *link = block->next;
+            break;
+         }
+      }
+      thrMutexUnlock( &smf_scratch_mutex, &lstatus );
+   }
+
+/* If a heap array was allocated through the pool, keep it as a spare for
+   re-use if pooling is still enabled. Otherwise free it. */
+   if( !block && smf_scratch_pooled ) {
+      thrMutexLock( &smf_scratch_mutex, &lstatus );
+      for( link = &smf_scratch_pooled; *link; link = &(*link)->next ) {
+         if( (*link)->pntr == pntr ) {
+            pooled = *link;
+            *link = pooled->next;
+            if( smf_scratch_npool > 0 ) {
+               pooled->next = smf_scratch_spare;
+               smf_scratch_spare = pooled;
+               spared = 1;
+            }
+            break;
+         }
+      }
+      thrMutexUnlock( &smf_scratch_mutex, &lstatus );
+
+      if( spared ) return NULL;
+      if( pooled ) {
+         pooled = astFree( pooled );
+         pntr = astFree( pntr );
+         return NULL;
+      }
+   }
+
+/* Unmap scratch arrays, and free any others. */
+   if( block ) {
+      if( munmap( block->pntr, block->nbytes ) == -1 &&
+          *status == SAI__OK ) {
+         *status = SAI__ERROR;
+         errRep( "", "smf_scratch_free: Unable to unmap scratch array.",
+                 status );
+      }
+      block = astFree( block );
+   } else {
+      pntr = astFree( pntr );
+   }
+
+   return NULL;
+}
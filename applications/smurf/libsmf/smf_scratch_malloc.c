@@ -0,0 +1,331 @@
+/*
+*+
+*  Name:
+*     smf_scratch_malloc
+
+*  Purpose:
+*     Allocate a large array, using a memory-mapped scratch file if
+*     required.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     pntr = smf_scratch_malloc( ThrWorkForce *wf, size_t nbytes, int zero,
+*                                int *status )
+
+*  Arguments:
+*     wf = ThrWorkForce * (Given)
+*        Pointer to the workforce that will process the array. Only used
+*        if the array is allocated on the heap. May be NULL.
+*     nbytes = size_t (Given)
+*        The number of bytes to allocate.
+*     zero = int (Given)
+*        If non-zero, the returned array is initialised to zero. Arrays
+*        created within scratch files are always initialised to zero.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     A pointer to the allocated memory, or NULL if an error occurs. It
+*     should be freed using smf_scratch_free.
+
+*  Description:
+*     If the environment variable SMURF_SCRATCHDIR is set to the name of
+*     a directory, and "nbytes" is at least SMF__SCRATCH_MIN, the array
+*     is placed within a new memory-mapped file created in that directory.
+*     The file is deleted immediately, so that it disappears when the
+*     array is freed, or when the process exits. The kernel is advised
+*     that the array will be accessed sequentially, so that pages are
+*     read ahead of, and released behind, the streaming access patterns
+*     used by the iterative map-maker. This allows arrays that are much
+*     larger than the available memory to be used, at the cost of disk
+*     I/O.
+*
+*     Otherwise, the array is allocated on the heap using thrMallocLocal
+*     (if "zero" is non-zero, or the workers in "wf" are bound to CPUs)
+*     or astMalloc. If pooling has been enabled by smf_scratch_pool and
+*     "nbytes" is at least SMF__POOL_MIN, a spare array of a similar
+*     size that was previously freed by smf_scratch_free is re-used
+*     instead, if one is available. Such arrays have already been paged
+*     in, so re-using them avoids the cost of the kernel supplying and
+*     zeroing fresh pages. The requested size is rounded up to one of
+*     eight sizes in each factor of two, so that arrays of slightly
+*     different sizes (e.g. the models for successive continuous chunks)
+*     can share spare arrays. The extra memory at the end of such an
+*     array is never accessed and so is not paged in.
+
+*  Notes:
+*     - Memory allocated by this function must be freed using
+*     smf_scratch_free rather than astFree.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+#include "star/one.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+/* The list of arrays currently held in scratch files, and a mutex that
+   serialises access to it and to the pool. */
+smfScratchBlock *smf_scratch_blocks = NULL;
+pthread_mutex_t smf_scratch_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* The heap arrays allocated through the pool that are in use, the spare
+   arrays available for re-use, and the number of active requests for
+   pooling (see smf_scratch_pool). */
+smfScratchBlock *smf_scratch_pooled = NULL;
+smfScratchBlock *smf_scratch_spare = NULL;
+int smf_scratch_npool = 0;
+
+/* Prototypes for local static functions. */
+static void *smf1_scratch_pooled( ThrWorkForce *wf, size_t nbytes, int zero,
+                                  int *status );
+static void smf1_scratch_zero( void *data, size_t first, size_t last,
+                               int *status );
+
+#define FUNC_NAME "smf_scratch_malloc"
+
+void *smf_scratch_malloc( ThrWorkForce *wf, size_t nbytes, int zero,
+                          int *status ){
+
+/* Local Variables: */
+   char path[ SMF_PATH_MAX + 1 ];
+   const char *dir;
+   int fd;
+   smfScratchBlock *block;
+   void *result = NULL;
+
+/* Check inherited status. */
+   if( *status != SAI__OK ) return result;
+
+/* If no scratch directory is in use, or the array is small, allocate it
+   on the heap. */
+   dir = getenv( SMF__SCRATCHDIR );
+   if( !dir || !dir[ 0 ] || nbytes < SMF__SCRATCH_MIN ) {
+      if( smf_scratch_npool > 0 && nbytes >= SMF__POOL_MIN ) {
+         result = smf1_scratch_pooled( wf, nbytes, zero, status );
+      } else if( zero || ( wf && wf->cpus ) ) {
+         result = thrMallocLocal( wf, nbytes, status );
+      } else {
+         result = astMalloc( nbytes );
+      }
+      return result;
+   }
+
+/* Create a uniquely named file in the scratch directory, and delete it
+   straight away. The file continues to exist until it is unmapped. */
+   one_strlcpy( path, dir, sizeof( path ), status );
+   one_strlcat( path, "/smurf_scratch_XXXXXX", sizeof( path ), status );
+   if( *status != SAI__OK ) return result;
+
+   fd = mkstemp( path );
+   if( fd == -1 ) {
+      *status = SAI__ERROR;
+      errRepf( "", FUNC_NAME ": Unable to create scratch file in '%s' (%s).",
+               status, dir, strerror( errno ) );
+      return result;
+   }
+   unlink( path );
+
+/* Extend the file to the required size (the new bytes read as zero) and
+   map it. The mapping remains valid after the file descriptor is
+   closed. */
+   if( ftruncate( fd, nbytes ) == -1 ) {
+      *status = SAI__ERROR;
+      errRepf( "", FUNC_NAME ": Unable to extend scratch file in '%s' to "
+               "%zu MiB (%s).", status, dir, nbytes/SMF__MIB,
+               strerror( errno ) );
+   } else {
+      result = mmap( NULL, nbytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                     0 );
+      if( result == MAP_FAILED ) {
+         result = NULL;
+         *status = SAI__ERROR;
+         errRepf( "", FUNC_NAME ": Unable to map scratch file in '%s' (%s).",
+                  status, dir, strerror( errno ) );
+      }
+   }
+   close( fd );
+   if( !result ) return result;
+
+/* The map-maker mostly streams through each array from start to end. */
+   (void) madvise( result, nbytes, MADV_SEQUENTIAL );
+
+/* Record the array so that smf_scratch_free knows to unmap it. */
+   block = astMalloc( sizeof( *block ) );
+   if( *status == SAI__OK ) {
+      block->pntr = result;
+      block->nbytes = nbytes;
+      thrMutexLock( &smf_scratch_mutex, status );
+      block->next = smf_scratch_blocks;
+      smf_scratch_blocks = block;
+      thrMutexUnlock( &smf_scratch_mutex, status );
+
+      msgOutiff( MSG__DEBUG, "", FUNC_NAME ": mapped %zu MiB scratch "
+                 "array in '%s'", status, nbytes/SMF__MIB, dir );
+   } else {
+      munmap( result, nbytes );
+      result = NULL;
+   }
+
+/* Return the array. */
+   return result;
+}
+
+/* Allocate a heap array through the pool. */
+static void *smf1_scratch_pooled( ThrWorkForce *wf, size_t nbytes, int zero,
+                                  int *status ){
+
+/* Local Variables: */
+   size_t freed;
+   size_t shift;
+   size_t size;
+   smfScratchBlock **best;
+   smfScratchBlock **link;
+   smfScratchBlock **smallest;
+   smfScratchBlock *block = NULL;
+   smfScratchBlock *discard = NULL;
+   void *result = NULL;
+
+   if( *status != SAI__OK ) return result;
+
+/* Round the size up to the next multiple of one eighth of the largest
+   power of two that does not exceed it. */
+   for( shift = 0; ( nbytes >> shift ) >= 16; shift++ );
+   size = ( ( nbytes + ( (size_t) 1 << shift ) - 1 ) >> shift ) << shift;
+
+/* Look for the smallest spare array that is big enough, and no more than
+   a quarter bigger than needed. */
+   thrMutexLock( &smf_scratch_mutex, status );
+   best = NULL;
+   for( link = &smf_scratch_spare; *link; link = &(*link)->next ) {
+      if( (*link)->nbytes >= size && (*link)->nbytes <= size + size/4 &&
+          ( !best || (*link)->nbytes < (*best)->nbytes ) ) best = link;
+   }
+
+   if( best ) {
+      block = *best;
+      *best = block->next;
+
+/* If none is suitable, a new array is needed. So that the pool does not
+   increase the total amount of memory in use, discard spare arrays,
+   smallest first, until at least as much memory as the new array needs
+   has been released. */
+   } else {
+      freed = 0;
+      while( smf_scratch_spare && freed < size ) {
+         smallest = &smf_scratch_spare;
+         for( link = &smf_scratch_spare; *link; link = &(*link)->next ) {
+            if( (*link)->nbytes < (*smallest)->nbytes ) smallest = link;
+         }
+         block = *smallest;
+         *smallest = block->next;
+         block->next = discard;
+         discard = block;
+         freed += block->nbytes;
+      }
+      block = NULL;
+   }
+   thrMutexUnlock( &smf_scratch_mutex, status );
+
+   while( discard ) {
+      block = discard;
+      discard = block->next;
+      block->pntr = astFree( block->pntr );
+      block = astFree( block );
+   }
+
+/* Re-use the spare array, zeroing it if required. Use the workforce to
+   zero large arrays, so that the pages are written by the same threads
+   as when the array was first allocated. */
+   if( block ) {
+      result = block->pntr;
+      if( zero ) {
+         if( wf && wf->nworker > 1 ) {
+            thrParallelFor( wf, 0, nbytes/SMF__MIB - 1, 0, result,
+                            smf1_scratch_zero, status );
+            memset( (char *) result + nbytes - nbytes % SMF__MIB, 0,
+                    nbytes % SMF__MIB );
+         } else {
+            memset( result, 0, nbytes );
+         }
+      }
+
+      msgOutiff( MSG__DEBUG, "", FUNC_NAME ": re-using %zu MiB spare "
+                 "array", status, block->nbytes/SMF__MIB );
+
+/* Otherwise allocate a new array of the rounded size. */
+   } else {
+      if( zero || ( wf && wf->cpus ) ) {
+         result = thrMallocLocal( wf, size, status );
+      } else {
+         result = astMalloc( size );
+      }
+
+      block = astMalloc( sizeof( *block ) );
+      if( *status == SAI__OK ) {
+         block->pntr = result;
+         block->nbytes = size;
+      } else {
+         result = astFree( result );
+         block = astFree( block );
+      }
+   }
+
+/* Record the array so that smf_scratch_free returns it to the pool. */
+   if( block ) {
+      thrMutexLock( &smf_scratch_mutex, status );
+      block->next = smf_scratch_pooled;
+      smf_scratch_pooled = block;
+      thrMutexUnlock( &smf_scratch_mutex, status );
+   }
+
+   return result;
+}
+
+/* Called by thrParallelFor to zero a range of whole MiB blocks within a
+   re-used array. Any final partial block is zeroed by the caller. */
+static void smf1_scratch_zero( void *data, size_t first, size_t last,
+                               int *status ){
+   if( *status != SAI__OK ) return;
+   memset( (char *) data + first*SMF__MIB, 0, ( last - first + 1 )*SMF__MIB );
+}
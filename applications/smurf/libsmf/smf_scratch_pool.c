@@ -0,0 +1,109 @@
+/*
+*+
+*  Name:
+*     smf_scratch_pool
+
+*  Purpose:
+*     Enable or disable the re-use of large arrays by smf_scratch_malloc.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     smf_scratch_pool( int enable, int *status )
+
+*  Arguments:
+*     enable = int (Given)
+*        If non-zero, a request for pooling is started. Otherwise, a
+*        previous request is ended.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     While at least one request for pooling is active, heap arrays of at
+*     least SMF__POOL_MIN bytes that are allocated by smf_scratch_malloc
+*     are kept as spare arrays when they are freed by smf_scratch_free,
+*     and are re-used by later calls to smf_scratch_malloc that need an
+*     array of a similar size. This is intended for code such as
+*     smf_iteratemap that frees and re-creates many large arrays of
+*     similar sizes (e.g. the models for each continuous chunk).
+*
+*     Requests may be nested. When the last active request ends, all
+*     spare arrays are freed. Arrays that are still in use are freed
+*     normally by smf_scratch_free.
+
+*  Notes:
+*     - This routine attempts to execute even if status is set on entry,
+*     so that calls to start and end a request always balance.
+*     - This routine should only be called from the main thread.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+void smf_scratch_pool( int enable, int *status ){
+
+/* Local Variables: */
+   int lstatus = SAI__OK;
+   size_t nbytes = 0;
+   smfScratchBlock *block;
+   smfScratchBlock *spare = NULL;
+
+/* Start a new request, or end a request. If it was the last one, take the
+   list of spare arrays. A local status is used so that each request is
+   ended, and its arrays freed, even if an error has already occurred. */
+   thrMutexLock( &smf_scratch_mutex, &lstatus );
+   if( enable ) {
+      smf_scratch_npool++;
+   } else if( smf_scratch_npool > 0 && --smf_scratch_npool == 0 ) {
+      spare = smf_scratch_spare;
+      smf_scratch_spare = NULL;
+   }
+   thrMutexUnlock( &smf_scratch_mutex, &lstatus );
+
+/* Free them. */
+   while( spare ) {
+      block = spare;
+      spare = block->next;
+      nbytes += block->nbytes;
+      block->pntr = astFree( block->pntr );
+      block = astFree( block );
+   }
+
+   if( nbytes > 0 ) {
+      msgOutiff( MSG__DEBUG, "", "smf_scratch_pool: freed %zu MiB of spare "
+                 "arrays", status, nbytes/SMF__MIB );
+   }
+}
@@ -0,0 +1,100 @@
+/*
+*+
+*  Name:
+*     smf_select_qmask
+
+*  Purpose:
+*     Return a pointer to the packed quality mask for a smfData.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     const uint64_t *smf_select_qmask( const smfData *data,
+*                                       smf_qual_t mask, int *status )
+
+*  Arguments:
+*     data = const smfData * (Given)
+*        The smfData.
+*     mask = smf_qual_t (Given)
+*        The quality bits that the caller will be testing.
+*     status = int * (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     A pointer to the packed quality mask created by smf_qmask_update,
+*     or NULL if no mask is available for the supplied quality bits.
+
+*  Description:
+*     Looks for a packed quality mask (see smf_qmask_update) using the
+*     same rules as smf_select_qualpntr: the sidecar quality is checked
+*     first, followed by the smfData itself. A mask is only returned if
+*     it was created using exactly the bits given by "mask", since only
+*     then does a set bit mean that a sample passes the caller's test and
+*     a clear bit mean that it fails.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdint.h>
+
+/* Starlink includes */
+#include "sae_par.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+const uint64_t *smf_select_qmask( const smfData *data, smf_qual_t mask,
+                                  int *status ){
+   const smfData *owner = NULL;
+
+   if( *status != SAI__OK || !data || !mask ) return NULL;
+
+/* Find the smfData that owns the quality, in the same way as
+   smf_select_qualpntr. */
+   if( data->sidequal && ( data->sidequal->qual ||
+                           ( data->sidequal->dtype == SMF__QUALTYPE &&
+                             data->sidequal->pntr[ 0 ] ) ) ) {
+      owner = data->sidequal;
+      if( owner->isTordered != data->isTordered ) return NULL;
+   } else {
+      owner = data;
+   }
+
+   if( owner->qmask && owner->qmaskbits == mask ) return owner->qmask;
+   return NULL;
+}
@@ -0,0 +1,96 @@
+/*
+*+
+*  Name:
+*     smf_select_qspans
+
+*  Purpose:
+*     Return a pointer to the run-length index of good data spans for a
+*     smfData.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     const smfQualSpans *smf_select_qspans( const smfData *data,
+*                                            smf_qual_t mask, int *status )
+
+*  Arguments:
+*     data = const smfData * (Given)
+*        The smfData.
+*     mask = smf_qual_t (Given)
+*        The quality bits that the caller will be testing.
+*     status = int * (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     A pointer to the index created by smf_qspans_update, or NULL if no
+*     index is available for the supplied quality bits.
+
+*  Description:
+*     Looks for an index of good data spans (see smf_qspans_update) using
+*     the same rules as smf_select_qualpntr: the sidecar quality is
+*     checked first, followed by the smfData itself. An index is only
+*     returned if it was created using exactly the bits given by "mask".
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* Starlink includes */
+#include "sae_par.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+const smfQualSpans *smf_select_qspans( const smfData *data, smf_qual_t mask,
+                                       int *status ){
+   const smfData *owner = NULL;
+
+   if( *status != SAI__OK || !data || !mask ) return NULL;
+
+/* Find the smfData that owns the quality, in the same way as
+   smf_select_qualpntr. */
+   if( data->sidequal && ( data->sidequal->qual ||
+                           ( data->sidequal->dtype == SMF__QUALTYPE &&
+                             data->sidequal->pntr[ 0 ] ) ) ) {
+      owner = data->sidequal;
+      if( owner->isTordered != data->isTordered ) return NULL;
+   } else {
+      owner = data;
+   }
+
+   if( owner->qspans && owner->qspans->mask == mask ) return owner->qspans;
+   return NULL;
+}
@@ -0,0 +1,130 @@
+/*
+*+
+*  Name:
+*     smf_state_own
+
+*  Purpose:
+*     Ensure a smfHead has a private JCMTState array before changing it
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     smf_state_own( smfHead *hdr, int *status )
+
+*  Arguments:
+*     hdr = smfHead * (Given and Returned)
+*        The header. Its allState and state components may be changed.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     The JCMTState array of a header may be shared with deep copies of
+*     the header (see smf_state_share). This function must be called
+*     before the values in the array are changed, or the array is
+*     reallocated. If any other header uses the array, the header is
+*     given its own copy of it. On exit, the header owns its JCMTState
+*     array and has no share record, and its state component points at
+*     the current frame of the (possibly new) array.
+
+*  Notes:
+*     - Nothing is done if the header does not own its JCMTState array
+*     (i.e. isCloned is set).
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     2026-10-14:
+*        Original version.
+*     {enter_further_changes_here}
+
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <string.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+void smf_state_own( smfHead *hdr, int *status ){
+
+/* Local Variables: */
+   JCMTState *copy = NULL;
+   smfStateShare *share;
+   smfStateShare *unused = NULL;
+
+   if( *status != SAI__OK || !hdr || !hdr->stateshare ) return;
+   if( hdr->isCloned ) return;
+
+/* Take a copy of the array first, since it is not known whether it will
+   be needed until the mutex is locked. The array is not changed by any
+   header while it is shared, so this can be done without the mutex. */
+   share = hdr->stateshare;
+   if( share->state == hdr->allState && hdr->allState ) {
+      copy = astMalloc( share->nframes*sizeof( *copy ) );
+      if( copy ) memcpy( copy, share->state, share->nframes*sizeof( *copy ) );
+   }
+   if( *status != SAI__OK ) {
+      copy = astFree( copy );
+      return;
+   }
+
+/* Drop the header's reference to the shared array. If no other header
+   uses the array and the header is still using it, the header simply
+   becomes its owner. If the header has replaced its array, the shared
+   array is freed when the last header using it has gone. */
+   thrMutexLock( &smf_state_mutex, status );
+   if( --(share->refcount) == 0 ) {
+      unused = share;
+      if( share->state == hdr->allState ) {
+         share->state = NULL;
+      }
+   } else if( copy ) {
+      hdr->allState = copy;
+      copy = NULL;
+   }
+   hdr->stateshare = NULL;
+   thrMutexUnlock( &smf_state_mutex, status );
+
+   copy = astFree( copy );
+   if( unused ) {
+      unused->state = astFree( unused->state );
+      unused = astFree( unused );
+   }
+
+/* Re-point the current state at the header's own array. */
+   if( hdr->allState ) hdr->state = hdr->allState + hdr->curframe;
+}
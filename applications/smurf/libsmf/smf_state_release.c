@@ -0,0 +1,110 @@
+/*
+*+
+*  Name:
+*     smf_state_release
+
+*  Purpose:
+*     Free the JCMTState array of a smfHead, allowing for sharing
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     smf_state_release( smfHead *hdr, int *status )
+
+*  Arguments:
+*     hdr = smfHead * (Given and Returned)
+*        The header. Its allState, state and stateshare components are
+*        returned NULL.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     This function is called when a header that owns its JCMTState
+*     array is closed. If the array is shared with other headers (see
+*     smf_state_share), the header's reference to it is dropped and the
+*     array is only freed if no other header still uses it. Otherwise,
+*     the array is freed immediately.
+
+*  Notes:
+*     - This routine attempts to execute even if status is set on entry.
+*     - It should not be called for a header that does not own its
+*     JCMTState array (i.e. if isCloned is set).
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     2026-10-14:
+*        Original version.
+*     {enter_further_changes_here}
+
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+void smf_state_release( smfHead *hdr, int *status ){
+
+/* Local Variables: */
+   int lstatus = SAI__OK;
+   smfStateShare *share;
+   smfStateShare *unused = NULL;
+
+   if( !hdr ) return;
+
+/* Drop the header's reference to any shared array. A local status is
+   used so that the reference is dropped, and the array freed, even if
+   an error has already occurred. If the header has replaced the shared
+   array with one of its own, its own array is freed below. */
+   share = hdr->stateshare;
+   if( share ) {
+      thrMutexLock( &smf_state_mutex, &lstatus );
+      if( share->state == hdr->allState ) hdr->allState = NULL;
+      if( --(share->refcount) == 0 ) unused = share;
+      thrMutexUnlock( &smf_state_mutex, &lstatus );
+      hdr->stateshare = NULL;
+   }
+
+   if( hdr->allState ) hdr->allState = astFree( hdr->allState );
+   hdr->state = NULL;
+
+   if( unused ) {
+      unused->state = astFree( unused->state );
+      unused = astFree( unused );
+   }
+
+   if( lstatus != SAI__OK && *status == SAI__OK ) *status = lstatus;
+}
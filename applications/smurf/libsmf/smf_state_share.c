@@ -0,0 +1,162 @@
+/*
+*+
+*  Name:
+*     smf_state_share
+
+*  Purpose:
+*     Share the JCMTState array of a smfHead with a copy of the header
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     allState = smf_state_share( const smfHead *hdr, smfStateShare **share,
+*                                 int *status )
+
+*  Arguments:
+*     hdr = const smfHead * (Given)
+*        The header being copied. Its stateshare component is created
+*        (if necessary) on the first call, so it is modified even though
+*        it is marked as const.
+*     share = smfStateShare ** (Returned)
+*        Returned holding the share record to be stored in the
+*        stateshare component of the new header, or NULL if the returned
+*        array is a private copy.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     allState = JCMTState *
+*        The array to be used as the allState component of the new
+*        header, or NULL if the header has no JCMTState array or an
+*        error occurs.
+
+*  Description:
+*     Headers are deep copied far more often than their JCMTState arrays
+*     are changed, and the array can be large (one element per time
+*     slice). Rather than copying it, this function returns the
+*     existing array and records that one more header refers to it.
+*     A header that needs to change its JCMTState values must call
+*     smf_state_own first, which gives it a private copy if the array is
+*     shared. The array is freed by smf_state_release (called from
+*     smf_close_file) when the last header using it is closed.
+*
+*     If the header does not own its JCMTState array (i.e. isCloned is
+*     set), the array may be freed by its owner at any time, so a
+*     private copy is returned instead.
+
+*  Notes:
+*     - The returned array has hdr->nframes elements.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     2026-10-14:
+*        Original version.
+*     {enter_further_changes_here}
+
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <string.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+/* The mutex that serialises access to the share records of all headers.
+   Declared in smf.h. */
+pthread_mutex_t smf_state_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+JCMTState *smf_state_share( const smfHead *hdr, smfStateShare **share,
+                            int *status ){
+
+/* Local Variables: */
+   JCMTState *result = NULL;
+   smfHead *shdr;
+   smfStateShare *stale = NULL;
+
+   *share = NULL;
+   if( *status != SAI__OK || !hdr || !hdr->allState ) return result;
+
+/* A header that does not own its array cannot share it, so return a
+   private copy. */
+   if( hdr->isCloned ) {
+      result = astMalloc( hdr->nframes*sizeof( *result ) );
+      if( result ) memcpy( result, hdr->allState,
+                           hdr->nframes*sizeof( *result ) );
+      return result;
+   }
+
+/* The share record lives in the header being copied. */
+   shdr = (smfHead *) hdr;
+
+   thrMutexLock( &smf_state_mutex, status );
+
+/* If the header's array has been replaced since its share record was
+   created, the header no longer uses the shared array, so drop its
+   reference. */
+   if( shdr->stateshare && shdr->stateshare->state != shdr->allState ) {
+      if( --(shdr->stateshare->refcount) == 0 ) stale = shdr->stateshare;
+      shdr->stateshare = NULL;
+   }
+
+/* Create a share record for the header if it does not already have one,
+   and add a reference for the new header. */
+   if( !shdr->stateshare ) {
+      shdr->stateshare = astMalloc( sizeof( *(shdr->stateshare) ) );
+      if( shdr->stateshare ) {
+         shdr->stateshare->state = shdr->allState;
+         shdr->stateshare->nframes = shdr->nframes;
+         shdr->stateshare->refcount = 1;
+      }
+   }
+
+   if( shdr->stateshare ) {
+      shdr->stateshare->refcount++;
+      *share = shdr->stateshare;
+      result = shdr->allState;
+   }
+
+   thrMutexUnlock( &smf_state_mutex, status );
+
+/* Free an array that nothing uses any more. */
+   if( stale ) {
+      stale->state = astFree( stale->state );
+      stale = astFree( stale );
+   }
+
+   return result;
+}
@@ -118,10 +118,15 @@
 *     18-APR-2019 (DSB):
 *        Implement Pierre's two component IP model ("APR2019"), and add
 *        "ipmodel" config parameter.
+*     2026-10-14:
+*        The IP model depends only on the elevation, so evaluate the
+*        instrumental Q and U once per time slice before starting the
+*        worker threads, rather than once per bolometer sample. The worker
+*        threads now only rotate the tabulated values and subtract them.
 *     {enter_further_changes_here}
 
 *  Copyright:
-*     Copyright (C) 2015-2017 East Asian Observatory.
+*     Copyright (C) 2015-2017,2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -168,6 +173,9 @@
 static void smf1_subip( void *job_data_ptr, int *status );
 static double *smf1_calcang( ThrWorkForce *wf, smfData *data, const char *trsys,
                              int *status );
+static void smf1_ipmodel( JCMTState *allstate, dim_t ntslice, int ipmodel,
+                          const double *ippars, double ipoffset, double *ipq,
+                          double *ipu, int *status );
 
 /* Local data types */
 typedef struct smfSubIPData {
@@ -187,10 +195,11 @@ typedef struct smfSubIPData {
    double *imapdata;
    double *ipang;
    double *ippars;
+   double *ipq;
+   double *ipu;
    double *res_data;
    double *result;
    double degfac;
-   double ipoffset;
    int *lut_data;
    int ipmodel;
    int oper;
@@ -221,6 +230,8 @@ void smf_subip(  ThrWorkForce *wf, smfDIMMData *dat, AstKeyMap *keymap,
    double *imapdata;
    double *ipang;
    double *ippars;
+   double *ipq = NULL;
+   double *ipu = NULL;
    double degfac;
    double ipangoff;
    double ipoffset;
@@ -499,6 +510,15 @@ void smf_subip(  ThrWorkForce *wf, smfDIMMData *dat, AstKeyMap *keymap,
 /* Get a pointer to the quality array for the residuals. */
          qua_data = smf_select_qualpntr( data, NULL, status );
 
+/* The IP model depends only on the elevation, which is the same for all
+   bolometers in a time slice. So evaluate the normalised instrumental Q
+   and U (w.r.t. focal plane Y) once for each time slice, rather than
+   once for every bolometer sample within the worker threads. */
+         ipq = astGrow( ipq, ntslice, sizeof( *ipq ) );
+         ipu = astGrow( ipu, ntslice, sizeof( *ipu ) );
+         if( ippars ) smf1_ipmodel( data->hdr->allState, ntslice, ipmodel,
+                                    ippars, ipoffset, ipq, ipu, status );
+
 /* See how many bolometers to process in each thread. */
          bolostep = nbolo/nw;
          if( bolostep == 0 ) bolostep = 1;
@@ -528,11 +548,12 @@ void smf_subip(  ThrWorkForce *wf, smfDIMMData *dat, AstKeyMap *keymap,
             pdata->imapdata = imapdata;
             pdata->qu = qu;
             pdata->ippars = ippars;
+            pdata->ipq = ipq;
+            pdata->ipu = ipu;
             pdata->ipmodel = ipmodel;
             pdata->allstate = data->hdr->allState;
             pdata->oper = 1;
             pdata->degfac = degfac;
-            pdata->ipoffset = ipoffset;
 
 /* Submit the job for execution by the next available thread. */
             thrAddJob( wf, 0, pdata, smf1_subip, 0, NULL, status );
@@ -550,6 +571,8 @@ void smf_subip(  ThrWorkForce *wf, smfDIMMData *dat, AstKeyMap *keymap,
                                         SMF__DIMM_INVERT, status);
 /* Free resources. */
       imapdata = astFree( imapdata );
+      ipq = astFree( ipq );
+      ipu = astFree( ipu );
       job_data = astFree( job_data );
       trsys = astFree( (void *) trsys );
    }
@@ -578,7 +601,6 @@ static void smf1_subip( void *job_data_ptr, int *status ) {
 */
 
 /* Local Variables: */
-   JCMTState *state;
    SmfSubIPData *pdata;
    const char *qu;
    const char *trsys;
@@ -586,6 +608,8 @@ static void smf1_subip( void *job_data_ptr, int *status ) {
    const double *fy;
    const double *gy;
    const double *gx;
+   const double *ipq;
+   const double *ipu;
    dim_t ibolo;
    dim_t itime;
    dim_t nbolo;
@@ -593,25 +617,13 @@ static void smf1_subip( void *job_data_ptr, int *status ) {
    double *imapdata;
    double *pa;
    double *pr;
-   double angle;
-   double ca;
-   double cb;
-   double cc;
-   double cd;
-   double ce;
-   double cf;
    double cosval;
-   double degfac;
-   double ipoffset;
    double ival;
-   double p1;
-   double qfp;
-   double qtr;
+   double rdegfac;
    double sinval;
-   double ufp;
-   double utr;
    int *pl;
    int bad;
+   int isq;
    size_t bstride;
    size_t tstride;
    smfData *data;
@@ -637,8 +649,13 @@ static void smf1_subip( void *job_data_ptr, int *status ) {
    gy = pdata->gy;
    fx = pdata->fx;
    fy = pdata->fy;
-   degfac = pdata->degfac;
-   ipoffset = pdata->ipoffset;
+   ipq = pdata->ipq;
+   ipu = pdata->ipu;
+   isq = ( *qu == 'Q' );
+
+/* If the total intensity was derived from a non-POL2 observation we need
+   to correct it for the POL2 degradation factor. */
+   rdegfac = 1.0/pdata->degfac;
 
 /* Subtract the IP from a range of bolometers. */
    if( pdata->oper == 1 ) {
@@ -652,24 +669,14 @@ static void smf1_subip( void *job_data_ptr, int *status ) {
 /* Check that the whole bolometer has not been flagged as bad. */
          if( !( *pq & SMF__Q_BADB ) ) {
 
-/* Get the IP model parameters for this bolometer. */
-            if( pdata->ipmodel == JAN2018 ) {
-               ca = pdata->ippars[0];
-               cb = pdata->ippars[1];
-               cc = pdata->ippars[2];
-               cd = pdata->ippars[3];
-               bad = ( ca == VAL__BADD || cb == VAL__BADD ||
-                       cc == VAL__BADD || cd == VAL__BADD );
-            } else {
-               ca = pdata->ippars[0];
-               cb = pdata->ippars[1];
-               cc = pdata->ippars[2];
-               cd = pdata->ippars[3];
-               ce = pdata->ippars[4];
-               cf = pdata->ippars[5];
-               bad = ( ca == VAL__BADD || cb == VAL__BADD ||
-                       cc == VAL__BADD || cd == VAL__BADD ||
-                       ce == VAL__BADD || cf == VAL__BADD );
+/* Check the IP model parameters are all good. */
+            bad = ( pdata->ippars[0] == VAL__BADD ||
+                    pdata->ippars[1] == VAL__BADD ||
+                    pdata->ippars[2] == VAL__BADD ||
+                    pdata->ippars[3] == VAL__BADD );
+            if( pdata->ipmodel != JAN2018 ) {
+               bad = bad || ( pdata->ippars[4] == VAL__BADD ||
+                              pdata->ippars[5] == VAL__BADD );
             }
 
 /* If any parameter is bad, flag the whole bolometer as unusable. */
@@ -689,10 +696,9 @@ static void smf1_subip( void *job_data_ptr, int *status ) {
                pl = pdata->lut_data + ibolo*bstride;
                pa = pdata->ipang ? pdata->ipang + ibolo*bstride : NULL;
 
-/* Loop round each time slice, maintaining a pointer to the JCMTState
-   info for the slice (we need this to get the elevation for each slice). */
-               state = pdata->allstate;
-               for( itime = 0; itime < ntslice; itime++,state++ ) {
+/* Loop round each time slice. The instrumental Q and U for each slice
+   have already been found from the elevation by smf1_ipmodel. */
+               for( itime = 0; itime < ntslice; itime++ ) {
 
 /* If there is no total intensity value for the sample, flag the sample. */
                   if( *pl == VAL__BADI ) {
@@ -709,45 +715,26 @@ static void smf1_subip( void *job_data_ptr, int *status ) {
    unknown. */
                      } else if( *pr != VAL__BADD && !( *pq & SMF__Q_MOD ) &&
                                 ( !pa || *pa != VAL__BADD ) &&
-                                state->tcs_az_ac2 != VAL__BADD) {
-
-/* Find the normalised instrumental Q and U. These are with respect to the
-   focal plane Y axis. */
-                        if( pdata->ipmodel == JAN2018 ) {
-                           p1 = ca + cb*state->tcs_az_ac2 + cc*state->tcs_az_ac2*state->tcs_az_ac2;
-                           p1 += ipoffset;
-                           angle = -2*( state->tcs_az_ac2 - cd );
-                           qfp = p1*cos( angle );
-                           ufp = p1*sin( angle );
-                        } else {
-                           angle = -2*( state->tcs_az_ac2 - cc );
-                           qfp = ca + cb*cos( angle );
-                           ufp = cf + cb*sin( angle );
-                           angle = -2*( state->tcs_az_ac2 - ce );
-                           qfp += cd*cos( angle );
-                           ufp += cd*sin( angle );
-                        }
-
-/* Rotate them to match the reference frame of the supplied Q and U
-   values (unless the supplied Q and U values are w.r.t focal plane Y,
-   in which case they already use the required reference direction). */
+                                ipq[ itime ] != VAL__BADD ) {
+
+/* Correct the residual Q or U value, first rotating the instrumental Q
+   and U to match the reference frame of the supplied Q and U values
+   (unless the supplied Q and U values are w.r.t focal plane Y, in which
+   case they already use the required reference direction). Only the
+   component being corrected is needed. */
+                        ival *= rdegfac;
                         if( pa ) {
                            cosval = cos( 2*( *pa ) );
                            sinval = sin( 2*( *pa ) );
-                           qtr = qfp*cosval + ufp*sinval;
-                           utr = -qfp*sinval + ufp*cosval;
+                           if( isq ) {
+                              *pr -= ival*( ipq[ itime ]*cosval +
+                                            ipu[ itime ]*sinval );
+                           } else {
+                              *pr -= ival*( ipu[ itime ]*cosval -
+                                            ipq[ itime ]*sinval );
+                           }
                         } else {
-                           qtr = qfp;
-                           utr = ufp;
-                        }
-
-/* Correct the residual Q or U value. If the total intensity was derived from
-   a non-POL2 observation we need to correct the total intensity for the
-   POL2 degradation factor. */
-                        if( *qu == 'Q' ) {
-                           *pr -= ival*qtr/degfac;
-                        } else {
-                           *pr -= ival*utr/degfac;
+                           *pr -= ival*( isq ? ipq[ itime ] : ipu[ itime ] );
                         }
                      }
                   }
@@ -995,13 +982,76 @@ static double *smf1_calcang( ThrWorkForce *wf, smfData *data, const char *trsys,
 
 }
 
+static void smf1_ipmodel( JCMTState *allstate, dim_t ntslice, int ipmodel,
+                          const double *ippars, double ipoffset, double *ipq,
+                          double *ipu, int *status ){
+/*
+*  Name:
+*     smf1_ipmodel
 
+*  Purpose:
+*     Evaluate the IP model at the elevation of each time slice.
 
+*  Invocation:
+*     smf1_ipmodel( JCMTState *allstate, dim_t ntslice, int ipmodel,
+*                   const double *ippars, double ipoffset, double *ipq,
+*                   double *ipu, int *status )
 
+*  Arguments:
+*     allstate = JCMTState * (Given)
+*        The JCMTState information for every time slice.
+*     ntslice = dim_t (Given)
+*        The number of time slices.
+*     ipmodel = int (Given)
+*        The IP model to use - JAN2018 or APR2019.
+*     ippars = const double * (Given)
+*        The parameters of the IP model.
+*     ipoffset = double (Given)
+*        An offset to add to the fractional polarisation given by the
+*        JAN2018 model.
+*     ipq = double * (Returned)
+*        The normalised instrumental Q for each time slice, with respect
+*        to focal plane Y. VAL__BADD if the elevation is unknown.
+*     ipu = double * (Returned)
+*        The normalised instrumental U for each time slice, with respect
+*        to focal plane Y. VAL__BADD if the elevation is unknown.
+*     status = int * (Given and Returned)
+*        Inherited status.
 
+*/
 
+/* Local Variables: */
+   JCMTState *state;
+   dim_t itime;
+   double angle;
+   double el;
+   double p1;
 
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
 
+   state = allstate;
+   for( itime = 0; itime < ntslice; itime++,state++ ) {
+      el = state->tcs_az_ac2;
 
+      if( el == VAL__BADD ) {
+         ipq[ itime ] = VAL__BADD;
+         ipu[ itime ] = VAL__BADD;
 
+      } else if( ipmodel == JAN2018 ) {
+         p1 = ippars[0] + ippars[1]*el + ippars[2]*el*el;
+         p1 += ipoffset;
+         angle = -2*( el - ippars[3] );
+         ipq[ itime ] = p1*cos( angle );
+         ipu[ itime ] = p1*sin( angle );
 
+      } else {
+         angle = -2*( el - ippars[2] );
+         ipq[ itime ] = ippars[0] + ippars[1]*cos( angle );
+         ipu[ itime ] = ippars[5] + ippars[1]*sin( angle );
+         angle = -2*( el - ippars[4] );
+         ipq[ itime ] += ippars[3]*cos( angle );
+         ipu[ itime ] += ippars[3]*sin( angle );
+      }
+   }
+}
@@ -65,9 +65,12 @@
 *        - handle both time- and bolo-ordered data
 *     2008-04-03 (EC):
 *        - Added quality to interface
+*     2026-10-14:
+*        Evaluate the polynomials using Horner's scheme.
 *     {enter_further_changes_here}
 
 *  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
 *     Copyright (C) 2006-2008 University of British Columbia. All
 *     Rights Reserved.
 
@@ -187,25 +190,17 @@ void smf_subtract_poly(smfData *data, int rel, int *status) {
       /* Loop over the number of bolometers */
       for (i=0; i<nbol; i++) if ( !(qual[i] & SMF__Q_BADB) ) {
 
-	/* Construct the polynomial for this bolometer - the first two
-	   terms are trivial and are determined manually. This is
-	   quicker than calling pow() unnecessarily. */
+	/* Evaluate the polynomial for this bolometer using Horner's
+	   scheme, which avoids calling pow() for each term. */
 
 	if ( (outdata[i + nbol*j] != VAL__BADD) &&
 	     !(qual[i + nbol*j] & SMF__Q_MOD) ) {
 
-	  baseline = -firstframe[i];
-
-	  for (k=0; k<ncoeff; k++) {
-	    if ( k==0 ) {
-	      baseline += poly[i];
-	    } else if ( k==1 ) {
-	      baseline +=  jay*poly[i+nbol];
-	    } else {
-	      baseline += poly[i + nbol*k] * pow(jay, (double)k);
-	    }
+	  baseline = 0.0;
+	  for (k=ncoeff; k>0; k--) {
+	    baseline = baseline*jay + poly[i + nbol*(k-1)];
 	  }
-	  outdata[i + nbol*j] -= baseline;
+	  outdata[i + nbol*j] -= baseline - firstframe[i];
 	}
       }
     }
@@ -218,25 +213,17 @@ void smf_subtract_poly(smfData *data, int rel, int *status) {
       /* Loop over the number of bolometers */
       for (i=0; i<nbol; i++)  if ( !(qual[i*nframes] & SMF__Q_BADB) ) {
 
-	/* Construct the polynomial for this bolometer - the first two
-	   terms are trivial and are determined manually. This is
-	   quicker than calling pow() unnecessarily. */
+	/* Evaluate the polynomial for this bolometer using Horner's
+	   scheme, which avoids calling pow() for each term. */
 
 	if ( (outdata[i*nframes + j] != VAL__BADD) &&
 	     !(qual[i*nframes + j] & SMF__Q_MOD) ) {
 
-	  baseline = -firstframe[i];
-
-	  for (k=0; k<ncoeff; k++) {
-	    if ( k==0 ) {
-	      baseline += poly[i];
-	    } else if ( k==1 ) {
-	      baseline +=  jay*poly[i+nbol];
-	    } else {
-	      baseline += poly[i + nbol*k] * pow(jay, (double)k);
-	    }
+	  baseline = 0.0;
+	  for (k=ncoeff; k>0; k--) {
+	    baseline = baseline*jay + poly[i + nbol*(k-1)];
 	  }
-	  outdata[i*nframes + j] -= baseline;
+	  outdata[i*nframes + j] -= baseline - firstframe[i];
 	}
       }
     }
@@ -195,10 +195,16 @@
 *        Added new smfFts fields for quality statistics
 *     2015-11-19 (GSB):
 *        Add WVMFIT option to smf_tausrc.
+*     2026-10-14:
+*        Add smfFitsIndex and the fitsidx component of smfHead.
+*     2026-10-14:
+*        Add smfModelProfile.
+*     2026-10-14:
+*        Add smfModelTune.
 *     {enter_further_changes_here}
 
  *  Copyright:
- *     Copyright (C) 2015 East Asian Observatory.
+ *     Copyright (C) 2015, 2026 East Asian Observatory.
  *     Copyright (C) 2008-2010 Science and Technology Facilities Council.
  *     Copyright (C) 2005-2006 Particle Physics and Astronomy Research Council.
  *     Copyright (C) 2005-2011 University of British Columbia.
@@ -274,6 +280,136 @@
 threads to use. */
 #define SMF__THREADS "SMURF_THREADS"
 
+/* The name of the environment variable giving the directory in which
+   large arrays should be stored as memory-mapped scratch files (see
+   smf_scratch_malloc), and the size in bytes below which arrays are
+   always stored in memory. */
+#define SMF__SCRATCHDIR "SMURF_SCRATCHDIR"
+#define SMF__SCRATCH_MIN (16*SMF__MIB)
+
+/* The size in bytes below which heap arrays allocated by
+   smf_scratch_malloc are never recycled through the pool of spare
+   arrays (see smf_scratch_pool). */
+#define SMF__POOL_MIN (SMF__MIB)
+
+/* The names of the environment variables that control checkpointing of
+   the iterative map-maker (see smf_write_checkpoint): the checkpoint
+   file, the number of iterations between checkpoints, and a flag
+   requesting that makemap resumes from an existing checkpoint. The
+   magic string identifies checkpoint files. */
+#define SMF__CHECKPOINT "SMURF_CHECKPOINT"
+#define SMF__CHECKPOINT_INTERVAL "SMURF_CHECKPOINT_INTERVAL"
+#define SMF__RESUME "SMURF_RESUME"
+#define SMF__CHECKPOINT_MAGIC "SMFCKPT1"
+
+/* The name of the environment variable giving the maximum number of
+   continuous chunks that smf_iteratemap may process concurrently. */
+#define SMF__CHUNKPROCS "SMURF_CHUNKPROCS"
+
+/* The name of the environment variable that causes MAKEMAP to share the
+   continuous chunks between MPI processes (see smf_mpi_rank). */
+#define SMF__MPI "SMURF_MPI"
+
+/* The name of the environment variable giving a file to which
+   smf_iteratemap appends a report of the resources used by each model
+   on each iteration (see smf_model_profile). */
+#define SMF__MODELPROFILE "SMURF_MODELPROFILE"
+
+/* The name of the environment variable that causes smf_iteratemap to
+   choose the number of threads used by each model (see
+   smf_model_autotune), and the factor by which a model may be slowed
+   down relative to using all the threads. */
+#define SMF__AUTOTUNE "SMURF_AUTOTUNE"
+#define SMF__AUTOTUNE_TOL 1.1
+
+/* The name of the environment variable giving the largest size in MiB
+   of the model components that smf_iteratemap exports from a
+   background process while the next chunk is processed. */
+#define SMF__WRITEBEHIND "SMURF_WRITEBEHIND"
+
+/* The maximum number of bolometers for which smf_diag_sample records
+   sampled diagnostics (config parameter DIAG.SAMPLEBOLO). */
+#define SMF__DIAG_MAXBOLO 32
+
+/* The name of the environment variable that causes smf_iteratemap to
+   rebin data into a single map that is divided spatially between the
+   threads, rather than giving each thread its own copy of the map. */
+#define SMF__PARTMAP "SMURF_PARTMAP"
+
+/* The name of the environment variable giving a directory in which
+   pointing LUTs are cached between runs (see smf_lutcache_name), and
+   the magic string identifying LUT cache files. */
+#define SMF__LUTCACHE "SMURF_LUTCACHE"
+#define SMF__LUTCACHE_MAGIC "SMFLUT01"
+
+/* The name of the environment variable giving a directory in which the
+   sky footprints of ACSIS input files are cached between runs of
+   MAKECUBE (see smf_footprint_name), and the magic string identifying
+   footprint cache files. */
+#define SMF__FOOTPRINTCACHE "SMURF_FOOTPRINTCACHE"
+#define SMF__FOOTPRINTCACHE_MAGIC "SMFFPT01"
+
+/* The name of the environment variable giving a directory in which the
+   header summaries used by smf_find_science to classify input files are
+   stored between runs (see smf_obsindex_name), and the magic string
+   identifying observation index files. */
+#define SMF__OBSINDEX "SMURF_OBSINDEX"
+#define SMF__OBSINDEX_MAGIC "SMFOBX01"
+
+/* The name of the environment variable that forces smf_clean_pca to
+   use a full singular value decomposition, rather than the truncated
+   decomposition in smf_pca_trunc, when only a few components are
+   needed. */
+#define SMF__EXACTPCA "SMURF_EXACTPCA"
+
+/* The name of the environment variable that causes smf_clean_pca to
+   form the products summed into the covariance matrix in single
+   precision. */
+#define SMF__FLOATPCA "SMURF_FLOATPCA"
+
+/* The names of the environment variables giving a file in which FFTW
+   wisdom is kept between runs, and requesting that FFTW plans are
+   measured rather than estimated (see smf_fftw_plan). */
+#define SMF__FFTW_WISDOM "SMURF_FFTW_WISDOM"
+#define SMF__FFTW_MEASURE "SMURF_FFTW_MEASURE"
+
+/* The maximum number of bolometer time streams that are transformed
+   together using a single batched FFTW plan, and the maximum size in
+   bytes of each work array used to hold a batch. */
+#define SMF__FFTBATCH 32
+#define SMF__FFTBATCH_MAXSIZE (4*SMF__MIB)
+
+/* The name of the environment variable giving a list of the models that
+   should be stored in single precision (see smf_model_dtype). */
+#define SMF__FLOATMODELS "SMURF_FLOATMODELS"
+
+/* The name of the environment variable that requests approximate
+   (histogram-based) medians from smf_stats1 and smf_find_median, and the
+   smallest number of good values for which they are used. */
+#define SMF__APPROXMEDIAN "SMURF_APPROXMEDIAN"
+#define SMF__APPROXMEDIAN_MIN 10000
+
+/* The name of the environment variable that requests WVM opacities to be
+   interpolated from a table of wvmOpt fits (see smf_wvm_lookup), the
+   grid spacing of the table in airmass, sky temperature and ambient
+   temperature (K), the range of airmass covered, and the largest
+   estimated interpolation error (mm of zenith PWV) that is accepted. */
+#define SMF__WVMTABLE "SMURF_WVMTABLE"
+#define SMF__WVMTABLE_DAM 0.05
+#define SMF__WVMTABLE_DT 1.0
+#define SMF__WVMTABLE_DTAMB 5.0
+#define SMF__WVMTABLE_AMMIN 1.0
+#define SMF__WVMTABLE_AMMAX 5.0
+#define SMF__WVMTABLE_TOL 0.003
+
+/* The name of the environment variable that requests DREAM images to be
+   reconstructed iteratively (sc2math_mapsolvecg) rather than with the
+   inverted normal equation matrix, the fractional residual at which the
+   iterations stop, and the maximum number of iterations per image. */
+#define SMF__DREAMCG "SMURF_DREAMCG"
+#define SMF__DREAMCG_TOL 1.0e-6
+#define SMF__DREAMCG_MAXITER 500
+
 /* Different data types supported by SMURF */
 typedef enum smf_dtype {
   SMF__NULL,
@@ -474,7 +610,8 @@ typedef enum {
   SMF__NOTTSERIES        = BIT_TO_VAL(8),  /* File is not time series data */
   SMF__NOCREATE_FTS      = BIT_TO_VAL(9),  /* Don't open FTS data */
   SMF__NOFIX_DATA        = BIT_TO_VAL(10), /* Do not fix up data */
-  SMF__ISFLAT            = BIT_TO_VAL(11)  /* Do not do any flat fielding */
+  SMF__ISFLAT            = BIT_TO_VAL(11), /* Do not do any flat fielding */
+  SMF__NOCREATE_WCS      = BIT_TO_VAL(12)  /* Don't read WCS FrameSets */
 } smf_open_file_flags;
 
 /* Flags for smf_open_newfile
@@ -623,6 +760,16 @@ typedef struct smfDetposWcsCache {
   AstSkyFrame *sky;
 } smfDetposWcsCache;
 
+/* Define a structure used to hold the FITS keyword index maintained by
+   smf_fits_seek. */
+typedef struct smfFitsIndex {
+  const AstFitsChan *fitschan;   /* FitsChan described by the index */
+  dim_t size;                    /* Number of slots in the hash table */
+  dim_t nused;                   /* Number of slots in use */
+  char (*names)[SZFITSCARD+1];   /* Keyword held in each slot */
+  int *cards;                    /* Card number of each keyword */
+} smfFitsIndex;
+
 /* Global information about the data file itself */
 
 typedef struct smfFile {
@@ -634,6 +781,15 @@ typedef struct smfFile {
   int mapcoordid;            /* NDF identifier for SMURF.MAPCOORD */
 } smfFile;
 
+/* Records a JCMTState array that is shared by several smfHeads (see
+   smf_state_share) */
+
+typedef struct smfStateShare {
+  JCMTState *state;         /* The shared array */
+  dim_t nframes;            /* Number of elements in the array */
+  int refcount;             /* Number of headers using the array */
+} smfStateShare;
+
 /* Contains header general header information obtained from the file */
 
 typedef struct smfHead {
@@ -642,6 +798,7 @@ typedef struct smfHead {
   AstFrameSet * wcs;        /* Frameset for a particular time slice (frame) */
   AstFrameSet * tswcs;      /* Frameset for full time series (if tseries) */
   AstFitsChan * fitshdr;    /* FITS header from the file */
+  smfFitsIndex * fitsidx;   /* Keyword index for fitshdr */
   sc2astCache * cache1;     /* Cached info used by sc2ast_createwcs. */
   smfCreateLutwcsCache * cache2; /* Cached info used by smf_create_lutwcs. */
   smfDetposWcsCache * cache3; /* Cached info used by smf_detpow_wcs. */
@@ -656,6 +813,7 @@ typedef struct smfHead {
   int isCloned;             /* If false, allState is owned by this
                                struct, if true it should not be freed */
   JCMTState *allState;     /* Array of STATE for every time slice */
+  smfStateShare *stateshare; /* Non-NULL if allState may be shared */
   unsigned int ndet;       /* Number of focal plane detectors */
   double * fplanex;   /* X coords (radians) of focal plane detectors */
   double * fplaney;   /* Y coords (radians) of focal plane detectors */
@@ -729,6 +887,15 @@ typedef struct smfDream {
   double *invmatx;           /* Pointer to inverse matrix */
 } smfDream;
 
+/* Run-length index of the good samples in each bolometer (see
+   smf_qspans_update). */
+typedef struct smfQualSpans {
+  smf_qual_t mask;           /* Quality bits that make a sample unusable */
+  dim_t nbolo;               /* Number of bolometers */
+  dim_t *first;              /* Index of first span for each bolo (nbolo+1) */
+  dim_t *spans;              /* First and last time slice of each span */
+} smfQualSpans;
+
 /* This struct is used to contain all information related to a particular
    data file (where possible since sc2store does not return a handle).
 */
@@ -756,6 +923,9 @@ typedef struct smfData {
   double *poly;              /* Polynomial scan fits */
   size_t ncoeff;             /* Number of coefficients in polynomial */
   int * lut;                 /* Pointing lookup table */
+  uint64_t * qmask;          /* Packed usable-sample bits (smf_qmask_update) */
+  smf_qual_t qmaskbits;      /* Quality bits used to form "qmask" */
+  smfQualSpans * qspans;     /* Good data spans (smf_qspans_update) */
   int onmap;                 /* Non-zero if the smfData overlaps the map */
   double * theta;            /* Scan direction each time slice */
   AstKeyMap *history;        /* History entries */
@@ -876,6 +1046,20 @@ typedef struct smfFilter {
   double wlim;          /* Minimum weight for valid filtered values */
 } smfFilter;
 
+/* An FFTW plan cached by smf_fftw_plan, together with the transform
+   geometry that it was created for. */
+#define SMF__FFTW_MAXRANK 2
+typedef struct smfFftwPlan {
+  int inverse;                          /* Non-zero for complex to real */
+  int rank;                             /* Number of transform dimensions */
+  int howmany_rank;                     /* Number of loop dimensions */
+  int nthread;                          /* Number of FFTW threads */
+  fftw_iodim dims[SMF__FFTW_MAXRANK];   /* Transform dimensions */
+  fftw_iodim howmany_dims[SMF__FFTW_MAXRANK]; /* Loop dimensions */
+  fftw_plan plan;                       /* The plan */
+  struct smfFftwPlan *next;             /* Next cached plan */
+} smfFftwPlan;
+
 /* Structure for static headers of DIMM files. Only some of the entries
    are used, such as the data dimension fields in data, and steptime
    in hdr. */
@@ -884,6 +1068,41 @@ typedef struct smfDIMMHead {
   smfHead hdr;
 } smfDIMMHead;
 
+/* Describes an array held in a memory-mapped scratch file created by
+   smf_scratch_malloc. */
+typedef struct smfScratchBlock {
+  void *pntr;                     /* Start of the mapped array */
+  size_t nbytes;                  /* Length of the mapping in bytes */
+  struct smfScratchBlock *next;   /* Next scratch array */
+} smfScratchBlock;
+
+/* The state of smf_iteratemap that is saved in a checkpoint file, in
+   addition to the contents of the smfDIMMData and the models. The
+   pointers refer to the maps accumulated from previous continuous
+   chunks. */
+typedef struct smfCheckpoint {
+  dim_t contchunk;                /* Continuous chunk being iterated */
+  dim_t ncontchunks;              /* Total number of continuous chunks */
+  int iter;                       /* Number of iterations completed */
+  int quit;                       /* Value of the iteration quit flag */
+  int converged;                  /* Has the stopping criterion been met? */
+  int noidone;                    /* Has the NOI model been calculated? */
+  int rate_limited;               /* Was the MAPTOL_RATE limit hit? */
+  double mapchange_l2;            /* Mean map change two iterations ago */
+  double mapchange_l3;            /* Mean map change three iterations ago */
+  double lastchisquared;          /* chi-squared from the last iteration */
+  double sumchunkweights;         /* Sum of previous chunk weights */
+  double *map;                    /* Accumulated map */
+  double *weights;                /* Accumulated weights */
+  double *mapweights;             /* Accumulated weights inc. chunk weight */
+  double *mapweightsq;            /* Accumulated weights squared */
+  double *mapvar;                 /* Accumulated variance */
+  int *hitsmap;                   /* Accumulated hits */
+  smf_qual_t *mapqual;            /* Accumulated quality */
+  double *exp_time;               /* Accumulated exposure time */
+  double *chunkchange;            /* Final map change for each chunk */
+} smfCheckpoint;
+
 /* Structure used to pass argument values to astRebinSeqF/D running in a
    different thread. */
 typedef struct smfRebinSeqArgs {
@@ -922,6 +1141,9 @@ typedef struct smfRebincubeNNArgs1 {
   dim_t nchanout;
   int *spectab;
   int *specpop;
+  int specoff;
+  dim_t ilo;
+  dim_t ihi;
   dim_t nxy;
   int genvar;
   float *data_array;
@@ -1048,6 +1270,42 @@ typedef enum {
   SMF__FILT_MIN       /* min of the local values */
 } smf_filt_t;
 
+/* State of a running median, minimum or maximum filter box (see
+   smf_runfilt_init). The work arrays are supplied by the caller. */
+
+typedef struct smfRunFilt {
+  smf_filt_t type;        /* Type of filter */
+  dim_t box;              /* Size of filter box */
+  dim_t inbox;            /* No. of good values in the filter box */
+  dim_t nlo;              /* No. of values in the lower heap */
+  dim_t nhi;              /* No. of values in the upper heap */
+  dim_t head;             /* Index in "list" of the front of the queue */
+  dim_t nqueue;           /* No. of values in the queue */
+  double *val;            /* Data value for each slot */
+  size_t *list;           /* Heaps or queue of slots */
+  int *pos;               /* Position of each slot in the heaps */
+} smfRunFilt;
+
+/* State used when recording the resources used by each DIMM model (see
+   smf_model_profile). */
+
+typedef struct smfModelProfile {
+  const char *fname;      /* Report file, NULL if no report is required */
+  double wall;            /* Wall-clock time at start of timed step (s) */
+  double cpu;             /* Process CPU time at start of timed step (s) */
+} smfModelProfile;
+
+/* State used when choosing the number of threads for a DIMM model (see
+   smf_model_autotune). */
+
+typedef struct smfModelTune {
+  int nthread;            /* No. of threads currently used */
+  int lastthread;         /* Last acceptable no. of threads */
+  int done;               /* Has the number of threads been chosen? */
+  double fulltime;        /* Time taken with all threads (s) */
+  double start;           /* Start time of current calculation (s) */
+} smfModelTune;
+
 /* Math functions for fitting */
 
 typedef enum {
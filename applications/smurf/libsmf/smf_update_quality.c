@@ -48,7 +48,9 @@
 *     the routine will ensure that QUALITY has SMF__Q_BADDA set for
 *     each bad data point (VAL__BADD). If no DATA or QUALITY
 *     arrays are associated with the smfData bad
-*     status is set (SAI__ERROR) and the function returns.
+*     status is set (SAI__ERROR) and the function returns. Any packed
+*     quality mask created by smf_qmask_update, and any index of good data
+*     spans created by smf_qspans_update, are re-calculated.
 
 *  Notes:
 *     - If badfrac is true but syncbad is false, the data array will be checked
@@ -89,9 +91,17 @@
 *        Multi-thread.
 *     2014-08-21 (DSB):
 *        If syncbad is non-zero, assign bad data values to all BADDA samples.
+*     14-OCT-2026:
+*        Refresh any packed quality mask (see smf_qmask_update).
+*     14-OCT-2026:
+*        Refresh any index of good data spans (see smf_qspans_update).
+*     14-OCT-2026:
+*        When synchronising bad values and flagging bad bolometers, do
+*        both in a single pass through the data and quality arrays.
 *     {enter_further_changes_here}
 
 *  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
 *     Copyright (C) 2008,2014 Science and Technology Faciltiies Council.
 *     Copyright (C) 2008,2010 University of British Columbia.
 *     All Rights Reserved.
@@ -230,6 +240,10 @@ void smf_update_quality( ThrWorkForce *wf, smfData *data, int syncbad,
         pdata->i2 = ndata - 1;
         pdata->b2 = nbolo - 1;
       }
+
+      /* If there are more threads than bolometers, the spare threads are
+         given an empty range of bolometers. */
+      if( pdata->b2 >= nbolo ) pdata->b2 = pdata->b1 - 1;
       pdata->qual = qual;
     }
   }
@@ -246,8 +260,20 @@ void smf_update_quality( ThrWorkForce *wf, smfData *data, int syncbad,
                        &idata, NULL, status);
     }
 
-    /* Synchronize SMF__Q_BADDA quality and VAL__BADD in data array */
-    if( syncbad ) {
+    /* Synchronize SMF__Q_BADDA quality and VAL__BADD in data array. If
+       bad bolometers are also to be flagged, this is done below at the
+       same time, to avoid an extra pass through the arrays. */
+    if( syncbad && ( badmask || badfrac ) ) {
+      if( data->dtype != SMF__DOUBLE && data->dtype != SMF__INTEGER ) {
+        msgSetc( "TYP", smf_dtype_string( data, status ));
+        *status = SAI__ERROR;
+        errRep( "",FUNC_NAME " data is of unsupported type (^TYP)",
+                status);
+        job_data = astFree( job_data );
+        return;
+      }
+
+    } else if( syncbad ) {
       if (data->dtype == SMF__DOUBLE) {
         for( iw = 0; iw < nw; iw++ ) {
             pdata = job_data + iw;
@@ -285,10 +311,11 @@ void smf_update_quality( ThrWorkForce *wf, smfData *data, int syncbad,
       /* special case 0 */
       if (badfrac) badthresh = badfrac * (double)ntslice;
 
-      /* Submit the jobs and wait for them all to finish. */
+      /* Submit the jobs and wait for them all to finish. Operation 4
+         also synchronizes the bad values. */
       for( iw = 0; iw < nw; iw++ ) {
           pdata = job_data + iw;
-          pdata->operation = 3;
+          pdata->operation = syncbad ? 4 : 3;
           pdata->badthresh = badthresh;
           pdata->addqual = addqual;
           pdata->ntslice = ntslice;
@@ -302,6 +329,21 @@ void smf_update_quality( ThrWorkForce *wf, smfData *data, int syncbad,
       }
       thrWait( wf, status );
     }
+
+    /* If a packed quality mask is in use, refresh it so that it reflects
+       the new quality values. */
+    if( data->sidequal && data->sidequal->qmask ) {
+      smf_qmask_update( wf, data, data->sidequal->qmaskbits, status );
+    } else if( data->qmask ) {
+      smf_qmask_update( wf, data, data->qmaskbits, status );
+    }
+
+    /* Likewise for any index of good data spans. */
+    if( data->sidequal && data->sidequal->qspans ) {
+      smf_qspans_update( wf, data, data->sidequal->qspans->mask, status );
+    } else if( data->qspans ) {
+      smf_qspans_update( wf, data, data->qspans->mask, status );
+    }
   }
 
   job_data = astFree( job_data );
@@ -429,6 +471,85 @@ static void smf1_update_quality( void *job_data_ptr, int *status ) {
          }
       }
 
+   } else if( pdata->operation == 4 ){
+      dim_t *nbad;
+      dim_t badthresh = pdata->badthresh;
+      dim_t j;
+      dim_t ntslice = pdata->ntslice;
+      size_t bstride = pdata->bstride;
+      size_t ind;
+      size_t tstride = pdata->tstride;
+      smf_qual_t outqual = SMF__Q_BADB | pdata->addqual;
+
+/* Synchronize the bad values and count the number of bad samples in
+   each detector in a single pass. The arrays are accessed in memory
+   order, so for time-ordered data all the detectors in the block are
+   processed together, one time slice at a time. */
+      if( b2 < b1 ) return;
+      nbad = astCalloc( b2 - b1 + 1, sizeof( *nbad ) );
+      if( *status != SAI__OK ) return;
+
+      p1 = pdata->ddata;
+      p2 = pdata->qual;
+      p3 = pdata->idata;
+      p4 = pdata->badmask;
+
+      if( tstride == 1 ) {
+         for( i = b1; i <= b2; i++ ) {
+            ind = bstride*i;
+            for( j = 0; j < ntslice; j++,ind++ ) {
+               if( p1 ) {
+                  if( p1[ ind ] == VAL__BADD ) {
+                     p2[ ind ] |= SMF__Q_BADDA;
+                  } else if( p2[ ind ] & SMF__Q_BADDA ) {
+                     p1[ ind ] = VAL__BADD;
+                  }
+               } else {
+                  if( p3[ ind ] == VAL__BADI ) {
+                     p2[ ind ] |= SMF__Q_BADDA;
+                  } else if( p2[ ind ] & SMF__Q_BADDA ) {
+                     p3[ ind ] = VAL__BADI;
+                  }
+               }
+               if( p2[ ind ] & SMF__Q_BADDA ) nbad[ i - b1 ]++;
+            }
+         }
+
+      } else {
+         for( j = 0; j < ntslice; j++ ) {
+            for( i = b1; i <= b2; i++ ) {
+               ind = tstride*j + bstride*i;
+               if( p1 ) {
+                  if( p1[ ind ] == VAL__BADD ) {
+                     p2[ ind ] |= SMF__Q_BADDA;
+                  } else if( p2[ ind ] & SMF__Q_BADDA ) {
+                     p1[ ind ] = VAL__BADD;
+                  }
+               } else {
+                  if( p3[ ind ] == VAL__BADI ) {
+                     p2[ ind ] |= SMF__Q_BADDA;
+                  } else if( p2[ ind ] & SMF__Q_BADDA ) {
+                     p3[ ind ] = VAL__BADI;
+                  }
+               }
+               if( p2[ ind ] & SMF__Q_BADDA ) nbad[ i - b1 ]++;
+            }
+         }
+      }
+
+/* Flag the detectors that are bad in the mask, or have too many bad
+   samples. */
+      for( i = b1; i <= b2; i++ ) {
+         if( ( p4 && p4[ i ] == VAL__BADI ) ||
+             ( badthresh < ntslice && nbad[ i - b1 ] > badthresh ) ) {
+            for( j = 0; j < ntslice; j++ ) {
+               p2[ tstride*j + bstride*i ] |= outqual;
+            }
+         }
+      }
+
+      nbad = astFree( nbad );
+
    } else {
       *status = SAI__ERROR;
       errRepf( "", "smf1_update_quality: Invalid operation (%d) supplied.",
@@ -291,7 +291,7 @@ void smf_write_bolomap( ThrWorkForce *wf, smfArray *res, smfArray *lut,
                          dat->noi ? dat->noi[0]->sdata[idx] : NULL,
                          lut_data, 0, 0, 0, NULL, 0,
                          SMF__Q_GOOD, varmapmethod,
-                         AST__REBININIT | AST__REBINEND,
+                         AST__REBININIT | AST__REBINEND, 0,
                          curmap, bmapweight, bmapweightsq, bhitsmap,
                          curvar, msize, chunkfactor, NULL, status );
 
@@ -0,0 +1,268 @@
+/*
+*+
+*  Name:
+*     smf_write_checkpoint
+
+*  Purpose:
+*     Save the state of the iterative map-maker to a checkpoint file.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     smf_write_checkpoint( const char *filename, const smfCheckpoint *ckpt,
+*                           const smfDIMMData *dat, smfArray ***model,
+*                           int nmodels, int *status )
+
+*  Arguments:
+*     filename = const char * (Given)
+*        The name of the checkpoint file to create.
+*     ckpt = const smfCheckpoint * (Given)
+*        The iteration counters, convergence history and accumulated
+*        maps of the current invocation of smf_iteratemap.
+*     dat = const smfDIMMData * (Given)
+*        The residuals, quality, pointing, maps and other state of the
+*        current continuous chunk.
+*     model = smfArray *** (Given)
+*        The time-series models for the current continuous chunk.
+*     nmodels = int (Given)
+*        The number of elements in "model".
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     This function writes a binary snapshot of everything that
+*     smf_iteratemap needs in order to continue iterating from the end
+*     of the current iteration: the loop counters and convergence
+*     history in "ckpt", the maps accumulated from earlier continuous
+*     chunks, the map arrays and residuals of the current continuous
+*     chunk, and the data arrays of all time-series models. The file can
+*     be read back using smf_read_checkpoint.
+*
+*     The snapshot is first written to a temporary file that is then
+*     renamed, so an existing checkpoint is only replaced once the new
+*     one is complete. An interupted run therefore always leaves a usable
+*     checkpoint behind.
+
+*  Notes:
+*     - The file is in the native byte order and type sizes of the
+*     machine that wrote it, and is only intended to be read back by the
+*     same build of SMURF.
+*     - Headers, WCS and other metadata are not saved. They are
+*     re-created from the raw data when resuming.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+#include "prm_par.h"
+#include "star/one.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+#define FUNC_NAME "smf_write_checkpoint"
+
+/* Prototypes for local functions */
+static void smf1_write_record( FILE *fp, const void *pntr, size_t nbytes,
+                               int *status );
+static void smf1_write_array( FILE *fp, smfArray *array, int *status );
+static size_t smf1_data_size( const smfData *data, int *status );
+
+void smf_write_checkpoint( const char *filename, const smfCheckpoint *ckpt,
+                           const smfDIMMData *dat, smfArray ***model,
+                           int nmodels, int *status ){
+
+/* Local Variables: */
+   FILE *fp = NULL;
+   char tmpname[ SMF_PATH_MAX + 1 ];
+   double chisq;
+   int imodel;
+   size_t msize;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Open a temporary file next to the final checkpoint. */
+   one_strlcpy( tmpname, filename, sizeof(tmpname), status );
+   one_strlcat( tmpname, ".tmp", sizeof(tmpname), status );
+   if( *status != SAI__OK ) return;
+
+   fp = fopen( tmpname, "wb" );
+   if( !fp ) {
+      *status = SAI__ERROR;
+      errRepf( "", FUNC_NAME ": Unable to create checkpoint file '%s': %s",
+               status, tmpname, strerror( errno ) );
+      return;
+   }
+
+/* The header. The number of models, and the map and chunk sizes are
+   included so that smf_read_checkpoint can check the file matches the
+   current run. */
+   msize = dat->msize;
+   chisq = dat->chisquared ? dat->chisquared[0] : VAL__BADD;
+   smf1_write_record( fp, SMF__CHECKPOINT_MAGIC, strlen( SMF__CHECKPOINT_MAGIC ),
+                      status );
+   smf1_write_record( fp, &ckpt->contchunk, sizeof( ckpt->contchunk ), status );
+   smf1_write_record( fp, &ckpt->ncontchunks, sizeof( ckpt->ncontchunks ),
+                      status );
+   smf1_write_record( fp, &ckpt->iter, sizeof( ckpt->iter ), status );
+   smf1_write_record( fp, &ckpt->quit, sizeof( ckpt->quit ), status );
+   smf1_write_record( fp, &ckpt->converged, sizeof( ckpt->converged ), status );
+   smf1_write_record( fp, &ckpt->noidone, sizeof( ckpt->noidone ), status );
+   smf1_write_record( fp, &ckpt->rate_limited, sizeof( ckpt->rate_limited ),
+                      status );
+   smf1_write_record( fp, &ckpt->mapchange_l2, sizeof( ckpt->mapchange_l2 ),
+                      status );
+   smf1_write_record( fp, &ckpt->mapchange_l3, sizeof( ckpt->mapchange_l3 ),
+                      status );
+   smf1_write_record( fp, &ckpt->lastchisquared,
+                      sizeof( ckpt->lastchisquared ), status );
+   smf1_write_record( fp, &ckpt->sumchunkweights,
+                      sizeof( ckpt->sumchunkweights ), status );
+   smf1_write_record( fp, &msize, sizeof( msize ), status );
+   smf1_write_record( fp, &nmodels, sizeof( nmodels ), status );
+   smf1_write_record( fp, &dat->ast_skipped, sizeof( dat->ast_skipped ), status );
+   smf1_write_record( fp, &dat->mapok, sizeof( dat->mapok ), status );
+   smf1_write_record( fp, &dat->mapchange, sizeof( dat->mapchange ), status );
+   smf1_write_record( fp, &chisq, sizeof( chisq ), status );
+
+/* The maps accumulated from previous continuous chunks. */
+   smf1_write_record( fp, ckpt->map, msize*sizeof(*ckpt->map), status );
+   smf1_write_record( fp, ckpt->weights, msize*sizeof(*ckpt->weights), status );
+   smf1_write_record( fp, ckpt->mapweights, msize*sizeof(*ckpt->mapweights),
+                      status );
+   smf1_write_record( fp, ckpt->mapweightsq, msize*sizeof(*ckpt->mapweightsq),
+                      status );
+   smf1_write_record( fp, ckpt->mapvar, msize*sizeof(*ckpt->mapvar), status );
+   smf1_write_record( fp, ckpt->hitsmap, msize*sizeof(*ckpt->hitsmap), status );
+   smf1_write_record( fp, ckpt->mapqual, msize*sizeof(*ckpt->mapqual), status );
+   smf1_write_record( fp, ckpt->exp_time, msize*sizeof(*ckpt->exp_time), status );
+   smf1_write_record( fp, ckpt->chunkchange,
+                      ckpt->ncontchunks*sizeof(*ckpt->chunkchange), status );
+
+/* The maps for the current continuous chunk. */
+   smf1_write_record( fp, dat->map, msize*sizeof(*dat->map), status );
+   smf1_write_record( fp, dat->lastmap, msize*sizeof(*dat->lastmap), status );
+   smf1_write_record( fp, dat->mapweight, msize*sizeof(*dat->mapweight), status );
+   smf1_write_record( fp, dat->mapweightsq, msize*sizeof(*dat->mapweightsq),
+                      status );
+   smf1_write_record( fp, dat->mapvar, msize*sizeof(*dat->mapvar), status );
+   smf1_write_record( fp, dat->hitsmap, msize*sizeof(*dat->hitsmap), status );
+   smf1_write_record( fp, dat->mapqual, msize*sizeof(*dat->mapqual), status );
+
+/* The time-series arrays. */
+   smf1_write_array( fp, dat->res ? dat->res[0] : NULL, status );
+   smf1_write_array( fp, dat->qua ? dat->qua[0] : NULL, status );
+   smf1_write_array( fp, dat->lut ? dat->lut[0] : NULL, status );
+   for( imodel = 0; imodel < nmodels; imodel++ ) {
+      smf1_write_array( fp, model[imodel] ? model[imodel][0] : NULL, status );
+   }
+   smf1_write_array( fp, dat->pcacom ? dat->pcacom[0] : NULL, status );
+   smf1_write_array( fp, dat->pcagai ? dat->pcagai[0] : NULL, status );
+
+/* Close the file, and replace any previous checkpoint with it. If anything
+   went wrong, remove the partial file instead. */
+   if( fclose( fp ) != 0 && *status == SAI__OK ) {
+      *status = SAI__ERROR;
+      errRepf( "", FUNC_NAME ": Error closing checkpoint file '%s': %s",
+               status, tmpname, strerror( errno ) );
+   }
+
+   if( *status == SAI__OK ) {
+      if( rename( tmpname, filename ) != 0 ) {
+         *status = SAI__ERROR;
+         errRepf( "", FUNC_NAME ": Unable to rename '%s' to '%s': %s",
+                  status, tmpname, filename, strerror( errno ) );
+      }
+   } else {
+      remove( tmpname );
+   }
+}
+
+/* Write a block of memory as a record consisting of its length in bytes
+   followed by its contents. A NULL pointer is written as an empty
+   record. */
+static void smf1_write_record( FILE *fp, const void *pntr, size_t nbytes,
+                               int *status ){
+   if( *status != SAI__OK ) return;
+   if( !pntr ) nbytes = 0;
+
+   if( fwrite( &nbytes, sizeof( nbytes ), 1, fp ) != 1 ||
+       ( nbytes > 0 && fwrite( pntr, 1, nbytes, fp ) != nbytes ) ) {
+      *status = SAI__ERROR;
+      errRepf( "", FUNC_NAME ": Error writing checkpoint file: %s", status,
+               strerror( errno ) );
+   }
+}
+
+/* Write the number of smfDatas in a smfArray, followed by the data array
+   of each one. A NULL smfArray is written as an array with no
+   smfDatas. */
+static void smf1_write_array( FILE *fp, smfArray *array, int *status ){
+   dim_t idx;
+   dim_t ndat;
+   smfData *data;
+
+   if( *status != SAI__OK ) return;
+
+   ndat = array ? array->ndat : 0;
+   smf1_write_record( fp, &ndat, sizeof( ndat ), status );
+
+   for( idx = 0; idx < ndat; idx++ ) {
+      data = array->sdata[ idx ];
+      if( data ) {
+         smf1_write_record( fp, data->pntr[0], smf1_data_size( data, status ),
+                            status );
+      } else {
+         smf1_write_record( fp, NULL, 0, status );
+      }
+   }
+}
+
+/* Return the number of bytes in the data array of a smfData. The
+   product of the dimensions is used rather than smf_get_dims since some
+   models (e.g. COM) are not 3-dimensional. */
+static size_t smf1_data_size( const smfData *data, int *status ){
+   dim_t i;
+   size_t nbytes;
+
+   if( *status != SAI__OK || !data->pntr[0] ) return 0;
+
+   nbytes = smf_dtype_size( data, status );
+   for( i = 0; i < data->ndims; i++ ) nbytes *= data->dims[ i ];
+   return nbytes;
+}
@@ -0,0 +1,160 @@
+/*
+*+
+*  Name:
+*     smf_write_footprint
+
+*  Purpose:
+*     Store the sky footprint of an input file in the footprint cache.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     smf_write_footprint( const char *filename, dim_t nvert,
+*                          const double *lon, const double *lat,
+*                          int hasoffexp, int polobs, int *status )
+
+*  Arguments:
+*     filename = const char * (Given)
+*        The name of the cache file, as returned by smf_footprint_name.
+*     nvert = dim_t (Given)
+*        The number of vertices in the footprint. May be zero.
+*     lon = const double * (Given)
+*        The sky longitude of each vertex, in radians.
+*     lat = const double * (Given)
+*        The sky latitude of each vertex, in radians.
+*     hasoffexp = int (Given)
+*        Non-zero if any time slice in the input file has an
+*        OFF_EXPOSURE value.
+*     polobs = int (Given)
+*        Non-zero if every time slice in the input file has a
+*        polarimeter angle.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     This function writes a footprint found by smf_cubebounds to a file
+*     in the footprint cache directory, from where it can be read back
+*     by smf_read_footprint. The footprint is the convex hull of the sky
+*     positions of all detector samples that contain good data, in the
+*     sky coordinate system used to form the cache file name.
+*
+*     The file is first written under a unique temporary name in the
+*     same directory and then renamed, so that other processes sharing
+*     the cache never see a partial file. Failure to write the cache is
+*     not an error - a warning is issued and the status is left
+*     unchanged.
+
+*  Notes:
+*     - The file is in the native byte order and type sizes of the
+*     machine that wrote it.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "star/one.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+#define FUNC_NAME "smf_write_footprint"
+
+void smf_write_footprint( const char *filename, dim_t nvert,
+                          const double *lon, const double *lat,
+                          int hasoffexp, int polobs, int *status ){
+
+/* Local Variables: */
+   FILE *fp = NULL;
+   char tmpname[ SMF_PATH_MAX + 1 ];
+   int fd;
+   int ok;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Create a uniquely named temporary file in the cache directory, readable
+   by other users of the cache. */
+   one_strlcpy( tmpname, filename, sizeof( tmpname ), status );
+   one_strlcat( tmpname, ".XXXXXX", sizeof( tmpname ), status );
+   if( *status != SAI__OK ) return;
+
+   fd = mkstemp( tmpname );
+   if( fd != -1 ) {
+      (void) fchmod( fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH );
+      fp = fdopen( fd, "wb" );
+      if( !fp ) close( fd );
+   }
+
+/* Write the header and the vertices. */
+   ok = ( fp != NULL );
+   if( ok ) {
+      ok = fwrite( SMF__FOOTPRINTCACHE_MAGIC,
+                   strlen( SMF__FOOTPRINTCACHE_MAGIC ), 1, fp ) == 1 &&
+           fwrite( &nvert, sizeof( nvert ), 1, fp ) == 1 &&
+           fwrite( &hasoffexp, sizeof( hasoffexp ), 1, fp ) == 1 &&
+           fwrite( &polobs, sizeof( polobs ), 1, fp ) == 1;
+      if( ok && nvert > 0 ) {
+         ok = fwrite( lon, sizeof( *lon ), nvert, fp ) == nvert &&
+              fwrite( lat, sizeof( *lat ), nvert, fp ) == nvert;
+      }
+      if( fclose( fp ) != 0 ) ok = 0;
+
+/* Replace any existing file with the new one. */
+      if( ok ) {
+         ok = ( rename( tmpname, filename ) == 0 );
+      }
+      if( !ok ) remove( tmpname );
+   }
+
+   if( ok ) {
+      msgOutiff( MSG__VERB, "", FUNC_NAME ": Stored footprint (%zu "
+                 "vertices) in '%s'", status, (size_t) nvert, filename );
+   } else {
+      msgOutf( "", FUNC_NAME ": *** Warning *** Unable to store footprint "
+               "in cache file '%s': %s", status, filename, strerror( errno ) );
+   }
+}
@@ -0,0 +1,185 @@
+/*
+*+
+*  Name:
+*     smf_write_lutcache
+
+*  Purpose:
+*     Store a pointing LUT in the LUT cache.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     smf_write_lutcache( const char *filename, dim_t nbolo, dim_t ntslice,
+*                         const int *lut, const double *theta, int onmap,
+*                         int *status )
+
+*  Arguments:
+*     filename = const char * (Given)
+*        The name of the cache file, as returned by smf_lutcache_name.
+*     nbolo = dim_t (Given)
+*        The number of bolometers.
+*     ntslice = dim_t (Given)
+*        The number of time slices.
+*     lut = const int * (Given)
+*        The LUT, in ICD order (nbolo*ntslice elements).
+*     theta = const double * (Given)
+*        The scan direction at each time slice (ntslice elements). May be
+*        NULL.
+*     onmap = int (Given)
+*        The flag indicating if the data overlaps the map.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     This function writes a LUT created by smf_calc_mapcoord to a file
+*     in the LUT cache directory, from where it can be read back by
+*     smf_read_lutcache. The LUT is compressed by storing the difference
+*     between the pixel index for each sample and for the same bolometer
+*     at the previous time slice, encoded as a variable-length integer.
+*     Since the telescope moves smoothly, most differences need only one
+*     or two bytes.
+*
+*     The file is first written under a unique temporary name in the
+*     same directory and then renamed, so that other processes sharing
+*     the cache never see a partial file. Failure to write the cache is
+*     not an error - a warning is issued and the status is left
+*     unchanged.
+
+*  Notes:
+*     - The file is in the native byte order and type sizes of the
+*     machine that wrote it.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+#include "star/one.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+#define FUNC_NAME "smf_write_lutcache"
+
+void smf_write_lutcache( const char *filename, dim_t nbolo, dim_t ntslice,
+                         const int *lut, const double *theta, int onmap,
+                         int *status ){
+
+/* Local Variables: */
+   FILE *fp = NULL;
+   char tmpname[ SMF_PATH_MAX + 1 ];
+   dim_t i;
+   dim_t ndata;
+   int fd;
+   int ok;
+   long long int delta;
+   size_t nbytes;
+   unsigned char *buf;
+   unsigned char *p;
+   unsigned long long int code;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Compress the LUT. Each difference is zig-zag encoded, so that small
+   negative values also give small codes, and then written seven bits
+   at a time, with the top bit of each byte set if more bytes follow. */
+   ndata = nbolo*ntslice;
+   buf = astMalloc( 5*ndata );
+   if( *status != SAI__OK ) return;
+
+   p = buf;
+   for( i = 0; i < ndata; i++ ) {
+      delta = (long long int) lut[ i ] -
+              (long long int) ( ( i >= nbolo ) ? lut[ i - nbolo ] : 0 );
+      code = ( delta < 0 ) ? ( ( (unsigned long long int) -delta ) << 1 ) - 1
+                           : ( (unsigned long long int) delta ) << 1;
+      while( code >= 0x80 ) {
+         *(p++) = (unsigned char) ( code | 0x80 );
+         code >>= 7;
+      }
+      *(p++) = (unsigned char) code;
+   }
+   nbytes = p - buf;
+
+/* Create a uniquely named temporary file in the cache directory, readable
+   by other users of the cache. */
+   one_strlcpy( tmpname, filename, sizeof( tmpname ), status );
+   one_strlcat( tmpname, ".XXXXXX", sizeof( tmpname ), status );
+   if( *status == SAI__OK ) {
+      fd = mkstemp( tmpname );
+      if( fd != -1 ) {
+         (void) fchmod( fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH );
+         fp = fdopen( fd, "wb" );
+         if( !fp ) close( fd );
+      }
+
+/* Write the header, the compressed LUT and the theta values. */
+      ok = ( fp != NULL );
+      if( ok ) {
+         ok = fwrite( SMF__LUTCACHE_MAGIC, strlen( SMF__LUTCACHE_MAGIC ), 1,
+                      fp ) == 1 &&
+              fwrite( &nbolo, sizeof( nbolo ), 1, fp ) == 1 &&
+              fwrite( &ntslice, sizeof( ntslice ), 1, fp ) == 1 &&
+              fwrite( &onmap, sizeof( onmap ), 1, fp ) == 1 &&
+              fwrite( &nbytes, sizeof( nbytes ), 1, fp ) == 1 &&
+              fwrite( buf, 1, nbytes, fp ) == nbytes;
+         if( ok && theta ) {
+            ok = fwrite( theta, sizeof( *theta ), ntslice, fp ) == ntslice;
+         }
+         if( fclose( fp ) != 0 ) ok = 0;
+
+/* Replace any existing file with the new one. */
+         if( ok ) {
+            ok = ( rename( tmpname, filename ) == 0 );
+         }
+         if( !ok ) remove( tmpname );
+      }
+
+      if( ok ) {
+         msgOutiff( MSG__VERB, "", FUNC_NAME ": Stored LUT in '%s' (%zu "
+                    "bytes)", status, filename, nbytes );
+      } else {
+         msgOutf( "", FUNC_NAME ": *** Warning *** Unable to store LUT in "
+                  "cache file '%s': %s", status, filename, strerror( errno ) );
+      }
+   }
+
+   buf = astFree( buf );
+}
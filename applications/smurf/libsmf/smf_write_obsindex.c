@@ -0,0 +1,198 @@
+/*
+*+
+*  Name:
+*     smf_write_obsindex
+
+*  Purpose:
+*     Store the header summary of an input file in the observation index.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     Library routine
+
+*  Invocation:
+*     smf_write_obsindex( const char *filename, const smfData *data,
+*                         int *status )
+
+*  Arguments:
+*     filename = const char * (Given)
+*        The name of the index file, as returned by smf_obsindex_name.
+*     data = const smfData * (Given)
+*        The input file, opened by smf_open_file. Only the header is used.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Description:
+*     This function writes the parts of the header of an input file that
+*     are needed to classify the file in smf_find_science to a file in
+*     the observation index directory, from where they can be read back
+*     by smf_read_obsindex. This is the complete FITS header, the
+*     observation and sequence type, observing and switching modes, the
+*     instrument, the contents of the beam, the number of time slices,
+*     the step time, the scan velocity, the OBSIDSS value, and the
+*     RTS_NUM and RTS_END values for the first time slice.
+*
+*     The file is first written under a unique temporary name in the
+*     same directory and then renamed, so that other processes sharing
+*     the index never see a partial file. Failure to write the index is
+*     not an error - a warning is issued and the status is left
+*     unchanged.
+
+*  Notes:
+*     - The file is in the native byte order and type sizes of the
+*     machine that wrote it.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+/* System includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/* Starlink includes */
+#include "mers.h"
+#include "sae_par.h"
+#include "ast.h"
+#include "prm_par.h"
+#include "star/one.h"
+
+/* SMURF includes */
+#include "libsmf/smf.h"
+
+#define FUNC_NAME "smf_write_obsindex"
+
+void smf_write_obsindex( const char *filename, const smfData *data,
+                         int *status ){
+
+/* Local Variables: */
+   FILE *fp = NULL;
+   char card[ 81 ];
+   char tmpname[ SMF_PATH_MAX + 1 ];
+   const smfHead *hdr;
+   double rts_end = VAL__BADD;
+   int fd;
+   int icard;
+   int ival[ 8 ];
+   int ncard;
+   int ok;
+   size_t ncopy;
+   unsigned int rts_num = 0;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Check there is a header to store. */
+   hdr = data ? data->hdr : NULL;
+   if( !hdr || !hdr->fitshdr ) return;
+
+/* Gather the integer values into a single array. The last element
+   indicates if the values from the first time slice are valid. */
+   ival[ 0 ] = hdr->instrument;
+   ival[ 1 ] = hdr->realinst;
+   ival[ 2 ] = hdr->obstype;
+   ival[ 3 ] = hdr->obsmode;
+   ival[ 4 ] = hdr->swmode;
+   ival[ 5 ] = hdr->seqtype;
+   ival[ 6 ] = hdr->inbeam;
+   ival[ 7 ] = ( hdr->allState != NULL );
+   if( hdr->allState ) {
+      rts_num = hdr->allState[ 0 ].rts_num;
+      rts_end = hdr->allState[ 0 ].rts_end;
+   }
+   ncard = astGetI( hdr->fitshdr, "NCard" );
+
+/* Create a uniquely named temporary file in the index directory, readable
+   by other users of the index. */
+   one_strlcpy( tmpname, filename, sizeof( tmpname ), status );
+   one_strlcat( tmpname, ".XXXXXX", sizeof( tmpname ), status );
+   if( *status != SAI__OK ) return;
+
+   fd = mkstemp( tmpname );
+   if( fd != -1 ) {
+      (void) fchmod( fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH );
+      fp = fdopen( fd, "wb" );
+      if( !fp ) close( fd );
+   }
+
+/* Write the summary values, followed by the FITS cards. Each card is
+   padded with spaces and stored as exactly 80 characters. */
+   ok = ( fp != NULL );
+   if( ok ) {
+      ok = fwrite( SMF__OBSINDEX_MAGIC, strlen( SMF__OBSINDEX_MAGIC ), 1,
+                   fp ) == 1 &&
+           fwrite( ival, sizeof( *ival ), 8, fp ) == 8 &&
+           fwrite( &hdr->nframes, sizeof( hdr->nframes ), 1, fp ) == 1 &&
+           fwrite( &hdr->steptime, sizeof( hdr->steptime ), 1, fp ) == 1 &&
+           fwrite( &hdr->scanvel, sizeof( hdr->scanvel ), 1, fp ) == 1 &&
+           fwrite( &rts_num, sizeof( rts_num ), 1, fp ) == 1 &&
+           fwrite( &rts_end, sizeof( rts_end ), 1, fp ) == 1 &&
+           fwrite( hdr->obsidss, sizeof( hdr->obsidss ), 1, fp ) == 1 &&
+           fwrite( &ncard, sizeof( ncard ), 1, fp ) == 1;
+
+      astClear( hdr->fitshdr, "Card" );
+      for( icard = 0; icard < ncard && ok; icard++ ) {
+         if( astFindFits( hdr->fitshdr, "%f", card, 1 ) ) {
+            ncopy = strlen( card );
+            if( ncopy < 80 ) memset( card + ncopy, ' ', 80 - ncopy );
+            ok = fwrite( card, 80, 1, fp ) == 1;
+         } else {
+            ok = 0;
+         }
+      }
+      astClear( hdr->fitshdr, "Card" );
+      if( *status != SAI__OK ) ok = 0;
+
+      if( fclose( fp ) != 0 ) ok = 0;
+
+/* Replace any existing file with the new one. */
+      if( ok ) {
+         ok = ( rename( tmpname, filename ) == 0 );
+      }
+      if( !ok ) remove( tmpname );
+   }
+
+   if( ok ) {
+      msgOutiff( MSG__VERB, "", FUNC_NAME ": Stored header summary (%d "
+                 "FITS cards) in '%s'", status, ncard, filename );
+   } else if( *status == SAI__OK ) {
+      msgOutf( "", FUNC_NAME ": *** Warning *** Unable to store header "
+               "summary in observation index file '%s': %s", status,
+               filename, strerror( errno ) );
+   }
+}
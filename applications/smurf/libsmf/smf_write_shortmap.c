@@ -309,7 +309,7 @@ void smf_write_shortmap( ThrWorkForce *wf, int shortmap, smfArray *res,
                      dat->noi ? dat->noi[0]->sdata[idx] : NULL,
                      lut_data, shortstart, shortend, 1, NULL, 0,
                      SMF__Q_GOOD, varmapmethod,
-                     rebinflag,
+                     rebinflag, 0,
                      mapdata->pntr[0],
                      shortmapweight, shortmapweightsq, shorthitsmap,
                      mapdata->pntr[1], msize, chunkfactor, NULL,
@@ -192,6 +192,7 @@ void smf_write_smfData ( ThrWorkForce *wf, const smfData *data, const smfData *v
                          void *info, int * status ){
 
   double *pd=NULL;              /* Pointer to DATA buffer */
+  float *pf=NULL;               /* Pointer to single precision DATA buffer */
   size_t dbstride;              /* bolo stride of data */
   size_t dtstride;              /* tstride of data */
   size_t i;                     /* Loop counter */
@@ -308,9 +309,12 @@ void smf_write_smfData ( ThrWorkForce *wf, const smfData *data, const smfData *v
        /* Find a bolometer with a good value */
        for( ibolo = 0; ibolo < nbolo && singlebolo == -1; ibolo++ ) {
           pd = ((double *) (data->pntr)[0] ) + ibolo*dbstride;
+          pf = ((float *) (data->pntr)[0] ) + ibolo*dbstride;
           pq = qual ? qual + ibolo*dbstride : NULL;
           for( itime = 0; itime < ntslice; itime++ ) {
-             if( *pd != VAL__BADD && ( !pq || *pq == 0 ) ) {
+             if( ( data->dtype == SMF__FLOAT ? pf[ itime*dtstride ] != VAL__BADR :
+                                       *pd != VAL__BADD ) &&
+                 ( !pq || *pq == 0 ) ) {
                 singlebolo = ibolo;
                 break;
              }
@@ -401,10 +405,15 @@ void smf_write_smfData ( ThrWorkForce *wf, const smfData *data, const smfData *v
     from a 3D smfData. */
     } else {
        pd = ((double *) (data->pntr)[0]) + singlebolo*dbstride;
+       pf = ((float *) (data->pntr)[0]) + singlebolo*dbstride;
        pq = qual ? qual + singlebolo*dbstride : NULL;
        pv = var ? var + singlebolo*vbstride : NULL;
        for( itime = 0; itime < ntslice; itime++ ) {
-          ((double *)(outdata->pntr)[0])[itime] = *pd;
+          if( data->dtype == SMF__FLOAT ) {
+             ((float *)(outdata->pntr)[0])[itime] = pf[ itime*dtstride ];
+          } else {
+             ((double *)(outdata->pntr)[0])[itime] = *pd;
+          }
           if( pq ) ((smf_qual_t *)(outdata->qual))[itime] = *pq;
           if( var ) {
              ((double *)(outdata->pntr)[1])[itime] = pv[(itime%vntslice)*vtstride];
@@ -0,0 +1,233 @@
+/*
+*+
+*  Name:
+*     smf_wvm_lookup
+
+*  Purpose:
+*     Interpolate the zenith PWV from a table of WVM fits.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     double smf_wvm_lookup( AstKeyMap *cache, double airmass, double tamb,
+*                            const float wvm[3], double *err, int *status )
+
+*  Arguments:
+*     cache = AstKeyMap * (Given)
+*        The KeyMap holding the table nodes. This is the per-thread cache
+*        used by smf_calc_wvm, and is cleared by smf_calc_wvm_clear.
+*     airmass = double (Given)
+*        The airmass of the WVM reading.
+*     tamb = double (Given)
+*        The ambient temperature, in kelvin.
+*     wvm = const float[3] (Given)
+*        The sky temperatures measured in the three WVM channels.
+*     err = double * (Returned)
+*        An estimate of the error in the returned value, in mm. May be
+*        NULL.
+*     status = int* (Given and Returned)
+*        Pointer to global status.
+
+*  Returned Value:
+*     The zenith precipitable water vapour, in mm, or VAL__BADD if the
+*     reading is outside the domain of the table or the interpolation is
+*     not accurate enough. In that case the caller should use wvmOpt
+*     directly.
+
+*  Description:
+*     Finds the zenith PWV for a WVM reading by multilinear interpolation
+*     on a regular grid in airmass and the three sky temperatures. The
+*     PWV at each grid node comes from a full wvmOpt fit. Nodes are
+*     calculated when first needed and kept in the supplied cache, so
+*     the table only covers the conditions actually seen. Since the WVM
+*     readings change slowly, most nodes are used by many readings, and
+*     most readings need no fit at all.
+*
+*     The ambient temperature is only used by wvmOpt to form its initial
+*     guess. It is therefore not interpolated, but rounded to the nearest
+*     multiple of SMF__WVMTABLE_DTAMB to select the set of nodes to use.
+*
+*     The error estimate is the largest deviation of the 16 corner values
+*     of the grid cell from the best-fitting linear function across the
+*     cell. If it is more than SMF__WVMTABLE_TOL, or any corner lies
+*     where wvmOpt cannot give a sensible fit, VAL__BADD is returned.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 3 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+*-
+*/
+
+#include <stdio.h>
+#include <math.h>
+
+/* Starlink includes */
+#include "sae_par.h"
+#include "ast.h"
+#include "prm_par.h"
+
+/* SMURF includes */
+#include "smf.h"
+#include "smf_typ.h"
+
+/* WVM includes */
+#include "wvm/wvmCal.h"
+
+/* Number of interpolation dimensions, and of corners in each cell */
+#define NDIM 4
+#define NCORNER 16
+
+double smf_wvm_lookup( AstKeyMap *cache, double airmass, double tamb,
+                       const float wvm[3], double *err, int *status ) {
+
+/* Local Variables */
+   char key[ 80 ];           /* Cache key for a table node */
+   const double step[ NDIM ] = { SMF__WVMTABLE_DAM, SMF__WVMTABLE_DT,
+                                 SMF__WVMTABLE_DT, SMF__WVMTABLE_DT };
+   double corner[ NCORNER ]; /* Zenith PWV at each cell corner */
+   double frac[ NDIM ];      /* Fractional position within the cell */
+   double grad[ NDIM ];      /* Mean gradient across the cell */
+   double lin;               /* Linear estimate at a corner */
+   double maxdev;            /* Largest deviation from linear estimate */
+   double mean;              /* Mean of the corner values */
+   double pos[ NDIM ];       /* Interpolation position */
+   double result;            /* Returned value */
+   double v;                 /* Corner value */
+   double w;                 /* Interpolation weight */
+   float fpwv;               /* PWV returned by wvmOpt */
+   float rms;                /* RMS of fit */
+   float tau0;               /* Line of sight opacity */
+   float tnode[ 3 ];         /* Sky temperatures at a node */
+   float twater;             /* Effective water temperature */
+   int ic;                   /* Corner index */
+   int id;                   /* Dimension index */
+   int itamb;                /* Ambient temperature bin */
+   int node[ NDIM ];         /* Grid indices of a corner */
+   int lo[ NDIM ];           /* Grid indices of the lowest corner */
+
+/* Initialise */
+   result = VAL__BADD;
+   if( err ) *err = VAL__BADD;
+
+/* Check inherited status */
+   if( *status != SAI__OK || !cache ) return result;
+
+/* Check the reading is within the domain of the table. wvmOpt rejects
+   readings with the third channel above 240 K or brighter than the
+   second channel. */
+   if( airmass < SMF__WVMTABLE_AMMIN || airmass > SMF__WVMTABLE_AMMAX ||
+       wvm[ 2 ] < 0.0 || wvm[ 2 ] > 240.0 - SMF__WVMTABLE_DT ||
+       wvm[ 1 ] < wvm[ 2 ] + SMF__WVMTABLE_DT ||
+       wvm[ 0 ] < 0.0 ) return result;
+
+/* Locate the grid cell containing the reading. */
+   pos[ 0 ] = airmass;
+   pos[ 1 ] = wvm[ 0 ];
+   pos[ 2 ] = wvm[ 1 ];
+   pos[ 3 ] = wvm[ 2 ];
+   for( id = 0; id < NDIM; id++ ) {
+      lo[ id ] = (int) floor( pos[ id ]/step[ id ] );
+      frac[ id ] = pos[ id ]/step[ id ] - lo[ id ];
+   }
+   itamb = (int) floor( tamb/SMF__WVMTABLE_DTAMB + 0.5 );
+
+/* Get the zenith PWV at each corner of the cell, fitting any that have
+   not been calculated before. */
+   for( ic = 0; ic < NCORNER; ic++ ) {
+      for( id = 0; id < NDIM; id++ ) {
+         node[ id ] = lo[ id ] + ( ( ic >> id ) & 1 );
+      }
+
+      sprintf( key, "WVMTAB%d_%d_%d_%d_%d", itamb, node[ 0 ], node[ 1 ],
+               node[ 2 ], node[ 3 ] );
+
+      if( !astMapGet0D( cache, key, &v ) ) {
+         tnode[ 0 ] = node[ 1 ]*step[ 1 ];
+         tnode[ 1 ] = node[ 2 ]*step[ 2 ];
+         tnode[ 2 ] = node[ 3 ]*step[ 3 ];
+
+         if( tnode[ 2 ] > 240.0 || tnode[ 1 ] < tnode[ 2 ] ) {
+            v = VAL__BADD;
+         } else {
+            wvmOpt( (float)( node[ 0 ]*step[ 0 ] ),
+                    (float)( itamb*SMF__WVMTABLE_DTAMB ), tnode, &fpwv,
+                    &tau0, &twater, &rms );
+            v = fpwv/( node[ 0 ]*step[ 0 ] );
+         }
+
+         astBeginPM;
+         astMapPut0D( cache, key, v, "" );
+         astEndPM;
+      }
+
+      if( v == VAL__BADD ) return result;
+      corner[ ic ] = v;
+   }
+
+/* Estimate the interpolation error from the departure of the corners
+   from a linear function across the cell. */
+   mean = 0.0;
+   for( id = 0; id < NDIM; id++ ) grad[ id ] = 0.0;
+   for( ic = 0; ic < NCORNER; ic++ ) {
+      mean += corner[ ic ];
+      for( id = 0; id < NDIM; id++ ) {
+         grad[ id ] += ( ( ic >> id ) & 1 ) ? corner[ ic ] : -corner[ ic ];
+      }
+   }
+   mean /= NCORNER;
+   for( id = 0; id < NDIM; id++ ) grad[ id ] /= NCORNER/2;
+
+   maxdev = 0.0;
+   for( ic = 0; ic < NCORNER; ic++ ) {
+      lin = mean;
+      for( id = 0; id < NDIM; id++ ) {
+         lin += grad[ id ]*( ( ( ic >> id ) & 1 ) - 0.5 );
+      }
+      if( fabs( corner[ ic ] - lin ) > maxdev ) maxdev = fabs( corner[ ic ] - lin );
+   }
+   if( err ) *err = maxdev;
+   if( maxdev > SMF__WVMTABLE_TOL ) return result;
+
+/* Form the interpolated value. */
+   result = 0.0;
+   for( ic = 0; ic < NCORNER; ic++ ) {
+      w = 1.0;
+      for( id = 0; id < NDIM; id++ ) {
+         w *= ( ( ic >> id ) & 1 ) ? frac[ id ] : 1.0 - frac[ id ];
+      }
+      result += w*corner[ ic ];
+   }
+
+   return result;
+}
@@ -117,11 +117,14 @@
 *        Use smf_flat_mergedata and new smf_flat_standardpow API
 *     2010-03-10 (TIMJ):
 *        Process fast flatfield ramps.
+*     2026-10-14:
+*        Use a pool of worker threads for the flatfield fits.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2008-2010 Science and Technology Facilities Council.
 *     Copyright (C) 2009 University of British Columbia.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -204,15 +207,20 @@ void smurf_calcflat( int *status ) {
   char subarray[9];          /* subarray name */
   sc2ast_subarray_t subnum;  /* subarray number */
   int utdate;                /* UTdate of observation */
+  ThrWorkForce *wf = NULL;   /* Pointer to a pool of worker threads */
 
   /* Main routine */
   ndfBegin();
 
+  /* Find the number of cores/processors available and create a pool of
+     threads of the same size. */
+  wf = thrGetWorkforce( thrGetNThread( SMF__THREADS, status ), status );
+
   /* Get input file(s)  MINFLAT needed for non-fast ramp */
   kpg1Rgndf( "IN", 0, 1, "", &igrp, &size, status );
 
   /* Find darks (might be all) */
-  smf_find_science( NULL, igrp, &fgrp, 0, &dkgrp, &ffgrp, 1, 0, SMF__DOUBLE, &darks,
+  smf_find_science( wf, igrp, &fgrp, 0, &dkgrp, &ffgrp, 1, 0, SMF__DOUBLE, &darks,
                     &fflats, NULL, NULL, status );
 
   /* input group is now the filtered group so we can use that and
@@ -436,7 +444,7 @@ void smurf_calcflat( int *status ) {
        expected measurement from each bolometer at each power setting.
      */
 
-    ngood = smf_flat_calcflat( NULL, MSG__NORM, flatname, "RESIST", "METHOD", "ORDER",
+    ngood = smf_flat_calcflat( wf, MSG__NORM, flatname, "RESIST", "METHOD", "ORDER",
                                "RESP", "RESPMASK", "SNRMIN", igrp, bolval, NULL, status );
     parPut0i( "NGOOD", ngood, status );
 
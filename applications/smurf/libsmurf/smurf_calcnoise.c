@@ -153,6 +153,16 @@
 *     RESPMASK = _LOGICAL (Read)
 *          If true, responsivity data will be used to mask bolometer data
 *          when calculating the flatfield. [TRUE]
+*     SEGLEN = _DOUBLE (Read)
+*          If non-zero, the power spectrum of each bolometer is estimated
+*          by averaging the power spectra of Hann-windowed segments of this
+*          many seconds, overlapping by half a segment (Welch's method),
+*          rather than from a single FFT of the whole time stream. Segments
+*          containing gaps or padding are ignored. This needs less memory,
+*          and gives less noisy estimates of the white noise and noise
+*          ratio for long observations. The segments must be long enough to
+*          resolve FLOW. SEGLEN is ignored if power spectra are requested
+*          using the POWER parameter. [0]
 *     TSERIES = NDF (Write)
 *          Output files to contain the cleaned time-series for each processed
 *          chunk. There will be the same number of output files as
@@ -241,11 +251,14 @@
 *     2011-08-23 (DSB):
 *        Do not call grpList if no output files are generated. This
 *        avoids a GRP__INVID error in such cases.
+*     2026-10-14:
+*        Add SEGLEN parameter.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2009-2011 Science and Technology Facilities Council.
 *     Copyright (C) 2011 University of British Columbia
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -359,6 +372,7 @@ void smurf_calcnoise( int *status ) {
   double freqdef[] = { SMF__F_WHITELO,
                        SMF__F_WHITEHI };/* Default values for frequency range */
   double freqs[2];          /* Frequencies to use for white noise */
+  double seglen = 0.0;      /* Length of segments for noise estimate (s) */
 
   if (*status != SAI__OK) return;
 
@@ -373,6 +387,8 @@ void smurf_calcnoise( int *status ) {
   parGdr1d( "FREQ", 2, freqdef, 0.0, 50.0, 1, freqs, status );
   /* Get the low frequency to use for the noise ratio */
   parGdr0d( "FLOW", f_low, 0.0, 50.0, 1, &f_low, status );
+  /* Get the length of the segments used to estimate the noise */
+  parGdr0d( "SEGLEN", seglen, 0.0, VAL__MAXD, 1, &seglen, status );
 
   msgOutf( "",
            "Calculating noise between %g and %g Hz and noise ratio for %g Hz",
@@ -661,7 +677,7 @@ void smurf_calcnoise( int *status ) {
           double * od = (outdata->pntr)[0];
           smf_bolonoise( wf, thedata, -1.0, 0, f_low, freqs[0], freqs[1],
                          1, zeropad ? SMF__MAXAPLEN : SMF__BADSZT,
-                         od, (ratdata->pntr)[0],
+                         (dim_t)( seglen/thedata->hdr->steptime + 0.5 ), od, (ratdata->pntr)[0],
                          (powgrp ? &powdata : NULL), status );
 
           noisebolo = (outdata->dims)[0]*(outdata->dims)[1];
@@ -724,7 +740,7 @@ void smurf_calcnoise( int *status ) {
               smf_flat_override( flatramps, thedata, status );
               smf_flat_smfData( thedata, &flatmethod, &refres, &powval, &bolval,
                                 status );
-              ngood = smf_flat_responsivity( flatmethod, respmap, 5.0, 1,
+              ngood = smf_flat_responsivity( wf, flatmethod, respmap, 5.0, 1,
                                              powval, bolval, refres,
                                              NULL, status);
               if (powval) smf_close_file( wf, &powval, status );
@@ -930,7 +946,7 @@ void smurf_calcnoise( int *status ) {
   ndfEnd( status );
 
   /* Ensure that FFTW doesn't have any used memory kicking around */
-  fftw_cleanup();
+  smf_fftw_cleanup( status );
 }
 
 static smfData *
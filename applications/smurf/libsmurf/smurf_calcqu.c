@@ -303,11 +303,14 @@
 *        "exportclean", as for makemap.
 *     1-FEB-2018 (DSB):
 *        Added config parameter ANG0.
+*     14-OCT-2026:
+*        Do not read WCS FrameSets from the input files when merging
+*        their FITS headers.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2011-2013 Science and Technology Facilities Council.
-*     Copyright (C) 2015-2018 East Asian Observatory
+*     Copyright (C) 2015-2018,2026 East Asian Observatory
 *     All Rights Reserved.
 
 *  Licence:
@@ -722,8 +725,9 @@ void smurf_calcqu( int *status ) {
    smf_grp_related stores arrays within the sgroup->subgroups. */
                   inidx = sgroup->subgroups[ igroup ][ idx ];
 
-/* Open the file. */
-                  smf_open_file( wf, sgrp, inidx, "READ", SMF__NOCREATE_DATA,
+/* Open the file. Only the FITS header is needed. */
+                  smf_open_file( wf, sgrp, inidx, "READ",
+                                 SMF__NOCREATE_DATA | SMF__NOCREATE_WCS,
                                  &indata, status );
 
 /* Add this input NDF as an ancestor into the output provenance structure. */
@@ -187,7 +187,7 @@ void smurf_calcresp( int *status ) {
       smf_flatmeth flatmethod;
       double refres;
       smf_flat_smfData( idata, &flatmethod, &refres, &powval, &bolval, status );
-      ngood[i-1] = smf_flat_responsivity( flatmethod, respmap, snrmin, 1, powval, bolval,
+      ngood[i-1] = smf_flat_responsivity( NULL, flatmethod, respmap, snrmin, 1, powval, bolval,
                                           refres, NULL, status );
       if (powval) smf_close_file( NULL, &powval, status );
       if (bolval) smf_close_file( NULL, &bolval, status );
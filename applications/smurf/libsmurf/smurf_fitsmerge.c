@@ -43,9 +43,12 @@
 *        Original version.
 *     12-MAY-2014 (GSB):
 *        Remove smf_open_file dependency.
+*     14-OCT-2026:
+*        Annul each input header once it has been merged.
 
 *  Copyright:
 *     Copyright (C) 2014 Science and Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -140,6 +143,7 @@ void smurf_fitsmerge(int* status) {
       }
 
       smf_fits_outhdr(ifc, &fc, status);
+      ifc = astAnnul(ifc);
 
       ndfAnnul(&indf, status);
 
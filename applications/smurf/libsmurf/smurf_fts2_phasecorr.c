@@ -58,10 +58,14 @@
 *         Include RTS timing values.
 *     2015-02-20 (MS):
 *        Added new smfFts fields for quality statistics
+*     2026-10-14
+*        Reuse the FFTW plans while the double-sided length is unchanged,
+*        rather than creating (and leaking) two plans for every pixel.
 
 *  Copyright:
 *     Copyright (C) 2010 Science and Technology Facilities Council.
 *     Copyright (C) 2010 University of Lethbridge. All Rights Reserved.
+*     Copyright (C) 2026 East Asian Observatory.
 
 *  Licence:
 *     This program is free software; you can redistribute it and/or
@@ -166,6 +170,7 @@ void smurf_fts2_phasecorr(int* status)
     double*   WINDOW        = NULL; // Apodization function
   fftw_plan planA               = NULL; // fftw plan
   fftw_plan planB               = NULL; // fftw plan
+  int       planLength    = 0;    // Transform length of planA and planB
   fftw_complex* DSIN      = NULL; // Double-Sided interferogram, FFT input
   fftw_complex* DSOUT     = NULL; // Double-Sided interferogram, FFT output
   fftw_complex* PCFIN     = NULL; // Phase Correction Function, FFT input
@@ -393,8 +398,15 @@ void smurf_fts2_phasecorr(int* status)
         for(k = 0; k < dsLength; k++) { DSIN[k][0] = DS[k]; DSIN[k][1] = 0.0; }
 
         // ### FORWARD FFT DOUBLE-SIDED INTERFEROGRAM
-          planA = fftw_plan_dft_1d(dsLength, DSIN, DSOUT, FFTW_FORWARD, FFTW_ESTIMATE);
-          fftw_execute(planA);
+          // THE PLANS ONLY DEPEND ON THE LENGTH, SO ARE REUSED UNTIL IT CHANGES
+          if(!planA || planLength != dsLength) {
+            if(planA) { fftw_destroy_plan(planA); }
+            if(planB) { fftw_destroy_plan(planB); }
+            planA = fftw_plan_dft_1d(dsLength, DSIN, DSOUT, FFTW_FORWARD, FFTW_ESTIMATE);
+            planB = fftw_plan_dft_1d(dsLength, PCFIN, PCFOUT, FFTW_BACKWARD, FFTW_ESTIMATE);
+            planLength = dsLength;
+          }
+          fftw_execute_dft(planA, DSIN, DSOUT);
 
         // ### PHASE
           for(k = 0; k < dsLength; k++) { PHASE[k] = atan2(DSOUT[k][1], DSOUT[k][0]); }
@@ -446,8 +458,7 @@ void smurf_fts2_phasecorr(int* status)
             PCFIN[k][1] = -sin(PHASE[k]);
           }
           // COMPUTE PCF, INVERSE FFT OF EXP(-iPHASE)
-          planB = fftw_plan_dft_1d(dsLength, PCFIN, PCFOUT, FFTW_BACKWARD, FFTW_ESTIMATE);
-          fftw_execute(planB);
+          fftw_execute_dft(planB, PCFIN, PCFOUT);
           // NORMALIZE PCF - REAL COMPONENT
           for(k = 0; k < dsLength; k++) { PCFOUT[k][0] /= dsLength; }
         // SHIFT PCF - REAL COMPONENT BY HALF
@@ -539,7 +550,7 @@ void smurf_fts2_phasecorr(int* status)
       if(PCFOUT)   { fftw_free(PCFOUT);         PCFOUT    = NULL; }
       if(planA)    { fftw_destroy_plan(planA);  planA     = NULL; }
       if(planB)    { fftw_destroy_plan(planB);  planB     = NULL; }
-      fftw_cleanup();
+      smf_fftw_cleanup( status );
 
     // CLOSE FILE
     if(inputData)  { smf_close_file( NULL,&inputData, status); }
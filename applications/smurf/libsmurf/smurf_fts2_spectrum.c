@@ -108,10 +108,15 @@
 *        - NOTE: When dealing with non-existent SFP calibration files, ORAC-DR specifies sfp=!
 *     2015-02-24 (MS)
 *        Fixed SFP default ranges
+*     2026-10-14
+*        Transform the pixels in parallel using the SMURF workforce, sharing
+*        a single FFTW plan per file instead of planning every pixel.
+*        Bad pixels now fill all N2+1 output planes.
 
 *  Copyright:
 *     Copyright (C) 2010 Science and Technology Facilities Council.
 *     Copyright (C) 2010 University of Lethbridge. All Rights Reserved.
+*     Copyright (C) 2026 East Asian Observatory.
 
 *  Licence:
 *     This program is free software; you can redistribute it and/or
@@ -164,6 +169,35 @@
 #define FUNC_NAME "smurf_fts2_spectrum"
 #define TASK_NAME "FTS2SPECTRUM"
 
+/* Structure containing information about blocks of pixels to be
+   transformed by each thread. */
+typedef struct smfFts2SpectrumData {
+    size_t b1;                  /* Index of first pixel to process */
+    size_t b2;                  /* Index of last pixel to process */
+    size_t nPixels;             /* Number of pixels in each plane */
+    int zeropad;                /* Zero pad the interferograms? */
+    int N;                      /* Transform length */
+    int N2;                     /* Index of the last output plane */
+    int Nin;                    /* Input interferogram length */
+    int Nzp;                    /* Zero padded interferogram length */
+    int indexZPD;               /* ZPD index */
+    int indexZPDin;             /* ZPD index of the input interferogram */
+    double resolution;          /* Spectral resolution */
+    double dSigma;              /* Spectral sampling interval */
+    int doSFP;                  /* Apply the SFP calibration? */
+    size_t nSfp;                /* Number of SFP values per pixel */
+    const double *SFP;          /* SFP calibration cube */
+    const double *WN;           /* SFP wave numbers */
+    double wnSfpF;              /* Starting SFP wave number */
+    double wnSfpL;              /* Ending SFP wave number */
+    const double *in;           /* Input interferogram cube */
+    double *out;                /* Output spectrum cube */
+    fftw_plan plan;             /* Shared forward FFT plan */
+} smfFts2SpectrumData;
+
+/* Prototypes for local functions */
+static void smf1_fts2_spectrum( void *job_data_ptr, int *status );
+
 void smurf_fts2_spectrum(int* status)
 {
     if( *status != SAI__OK ) { return; }
@@ -185,16 +219,13 @@ void smurf_fts2_spectrum(int* status)
     int i                     = 0;              /* Counter */
     int j                     = 0;              /* Counter */
     int k                     = 0;              /* Counter */
-    int l                     = 0;              /* Counter */
     double fNyquist           = 0.0;            /* Nyquist frequency */
     double fNyquistin         = 0.0;            /* Nyquist frequency input */
     double fNyquistzp         = 0.0;            /* Nyquist frequency zero padded */
     double dSigma             = 0.0;            /* Spectral Sampling Interval */
     double dSigmain           = 0.0;            /* Spectral Sampling Interval zero padded */
     double dSigmazp           = 0.0;            /* Spectral Sampling Interval zero padded */
-    double* IFG               = NULL;           /* Interferogram */
     double* SFP               = NULL;           /* Spectral Filter Profile for all pixels */
-    double* SFPij             = NULL;           /* Spectral Filter Profile for a single pixel */
     double wavelen            = 0.0;            /* The central wave length of the subarray filter (m) */
     double wnSfpFirst         = 10.600;         /* Starting 850 band SFP wave number */
     double wnSfpLast          = 12.800;         /* Ending 850 band SFP wave number */
@@ -214,8 +245,12 @@ void smurf_fts2_spectrum(int* status)
     fftw_complex* DSIN        = NULL;           /* Double-Sided interferogram, FFT input */
     fftw_complex* SPEC        = NULL;           /* Spectrum */
     fftw_plan plan            = NULL;           /* fftw plan */
-    gsl_interp_accel* ACC     = NULL;           /* SFP interpolator */
-    gsl_spline* SPLINE        = NULL;           /* SFP interpolation spline */
+    ThrWorkForce* wf          = NULL;           /* Pointer to a pool of worker threads */
+    smfFts2SpectrumData* job_data = NULL;       /* Per-thread job descriptions */
+    smfFts2SpectrumData* pdata    = NULL;       /* Pointer to a single job description */
+    int nworker               = 0;              /* Number of worker threads */
+    int iworker               = 0;              /* Worker index */
+    size_t pstep              = 0;              /* Number of pixels per worker */
 
     size_t nFiles             = 0;              /* Size of the input group */
     size_t nOutFiles          = 0;              /* Size of the output group */
@@ -227,7 +262,6 @@ void smurf_fts2_spectrum(int* status)
     size_t nFrames            = 0;              /* Data cube depth */
     size_t nPixels            = nWidth*nHeight; /* Number of bolometers in the subarray */
 
-    double dIntensity         = 0;
     int N                     = 0;
     int Nin                   = 0;                /* N input */
     int Nzp                   = 0;                /* N zero padded */
@@ -236,20 +270,15 @@ void smurf_fts2_spectrum(int* status)
     int N2zp                  = 0;                /* N/2 zero padded */
     int bolIndex              = 0;
     int cubeIndex             = 0;
-    int badPixel              = 0;
     int indexZPD              = 0;
     int indexZPDin            = 0;
     int indexZPDzp            = 0;
-    int pad                   = 0;               /* zero padding (difference between input and zero padded interferogram length) */
-    int pad2                  = 0;               /* zero padding / 2 */
     double dx                 = 0.0;             /* Delta x */
     double dxin               = 0.0;             /* Delta x input */
     double dxzp               = 0.0;             /* Delta x zero padded */
     double OPDMax             = 0.0;             /* OPD max in cm */
     double OPDMaxin           = 0.0;             /* OPD max in cm input */
     double OPDMaxzp           = 0.0;             /* OPD max in cm zero padded */
-    double s                  = 0.0;             /* spectrum value */
-    double f                  = 0.0;             /* filter value */
 
 #define DEBUG 0
 
@@ -289,6 +318,9 @@ void smurf_fts2_spectrum(int* status)
     /* BEGIN NDF */
     ndfBegin();
 
+    /* Get a pointer to a pool of worker threads */
+    wf = thrGetWorkforce(thrGetNThread(SMF__THREADS, status), status);
+
 
     /* Loop through each input file */
     for(fIndex = 1; fIndex <= nFiles; fIndex++) {
@@ -465,13 +497,12 @@ void smurf_fts2_spectrum(int* status)
         if (dataLabel) { one_strlcpy(outData->hdr->dlabel, dataLabel, sizeof(outData->hdr->dlabel), status ); }
 
         /* Allocate memory for arrays */
-        IFG  = astCalloc(N,  sizeof(*IFG));
         DS   = astCalloc(N, sizeof(*DS));
         DSIN = fftw_malloc(N * sizeof(*DSIN));
         SPEC = fftw_malloc(N * sizeof(*SPEC));
 
         /* Initialize arrays */
-        for(k = 0; k < N; k++) { SPEC[k][0] = SPEC[k][1] = DSIN[k][0] = DSIN[k][1] = DS[k] = IFG[k] = 0.0; }
+        for(k = 0; k < N; k++) { SPEC[k][0] = SPEC[k][1] = DSIN[k][0] = DSIN[k][1] = DS[k] = 0.0; }
 
         /* Open the SFP calibration file, if given */
         if(doSFP) {
@@ -486,7 +517,6 @@ void smurf_fts2_spectrum(int* status)
             nSfp = sfpData->dims[1] / nPixels;
             /* Allocate memory for arrays */
             SFP = astCalloc(nSfp*nPixels, sizeof(*SFP));
-            SFPij = astCalloc(nSfp, sizeof(*SFP));
             WN  = astCalloc(nSfp, sizeof(*WN));
 
             /* DEBUG: Dispay SFP data */
@@ -529,150 +559,65 @@ void smurf_fts2_spectrum(int* status)
                     *((int*) (sfp->pntr[0]) + bolIndex) = VAL__BADI;
                 }
             } */
-
-            /* Prepare GSL interpolator to convert SFP data to this spectrum's resolution */
-            ACC    = gsl_interp_accel_alloc();
-            SPLINE = gsl_spline_alloc(gsl_interp_cspline, nSfp);
         }
 
-        for(i = 0; i < nWidth; i++) {
-            for(j = 0; j < nHeight; j++) {
-                bolIndex = i + j * nWidth;
-
-                badPixel = 0;
-                for(k = 0; k < Nin; k++) {
-                    dIntensity = *((double*)(inData->pntr[0]) + (bolIndex + k * nPixels));
-                    if(dIntensity == VAL__BADD) {
-                        badPixel = 1;
-                        break;
-                    }
-                }
-                /* If this is a bad pixel, go to next */
-                if(badPixel) {
-                    for(k = 0; k <= N2in; k++) {
-                        *((double*)(outData->pntr[0]) + (bolIndex + k * nPixels)) = VAL__BADD;
-                    }
-                    continue;
-                }
-
-                /* Double-Sided interferogram */
-                if(zeropad) {
-                    pad = Nzp - Nin;
-                    pad2 = pad / 2;
-                    /* Copy the right half of the input into the left half of this IFG, zero padded in the middle */
-                    for(k=indexZPDin; k<Nin; k++) {
-                        /*printf("%s: IFG: indexZPDin=%d, indexZPDzp=%d, Nin=%d, Nzp=%d, k=%d, l=%d\n", TASK_NAME, indexZPDin, indexZPDzp, Nin, Nzp, k, l);*/
-                        IFG[k - indexZPDin] = *((double*)(inData->pntr[0]) + (bolIndex + k * nPixels));
-                      /*if(i==16 && j==25) {
-                            printf("%s: Pixel[%d,%d]: (L<-R) IFG[k(%d)-indexZPDin(%d)=%d] = inData->pntr[bolIndex(%d)+k(%d)*nPixels(%d)=%d] = %g\n",
-                                   TASK_NAME, i, j, k, indexZPDin, (k - indexZPDin), bolIndex, k, nPixels, (bolIndex + k * nPixels), IFG[k - indexZPDin]);
-                        }*/
-                    }
-                    /* Copy the left half of the input into the right half of this IFG, zero padded in the middle */
-                    for(k=0,l=0; k<indexZPDin; k++) {
-                        IFG[Nzp - indexZPDin + k] =  *((double*)(inData->pntr[0]) + (bolIndex + k * nPixels));
-                      /*if(i==16 && j==25) {
-                            printf("%s: Pixel[%d,%d]: (L->R) IFG[Nzp(%d)-indexZPDin(%d)+k(%d)=%d] = inData->pntr[bolIndex(%d)+k(%d)*nPixels(%d)=%d] = %g\n",
-                                   TASK_NAME, i, j, Nzp, indexZPDin, k, (Nzp-indexZPDin+k), bolIndex, k, nPixels, (bolIndex+k*nPixels), IFG[Nzp-indexZPDin+k]);
-                        }*/
-                    }
-                } else {
-                    /* Copy the right half of the input into the left half of this IFG */
-                    for(k=indexZPD; k<N; k++) {
-                        IFG[k - indexZPD] = *((double*)(inData->pntr[0]) + (bolIndex + k * nPixels));
-                      /*if(i==16 && j==25) {
-                            printf("%s: Pixel[%d,%d]: (L<-R) IFG[k(%d)-indexZPD(%d)=%d] = inData->pntr[bolIndex(%d)+k(%d)*nPixels(%d)=%d] = %f\n",
-                                     TASK_NAME, i, j, k, indexZPD, (k - indexZPD), bolIndex, k, nPixels, (bolIndex + k * nPixels), IFG[k - indexZPD]);
-                        }*/
-                    }
-                    /* Copy the left half of the input into the right half of this IFG */
-                    for(k=0; k<indexZPD; k++) {
-                        IFG[N - indexZPD + k] =  *((double*)(inData->pntr[0]) + (bolIndex + k * nPixels));
-                      /*if(i==16 && j==25) {
-                              printf("%s: Pixel[%d,%d]: (L->R) IFG[N(%d)-indexZPD(%d)+k(%d)=%d] = inData->pntr[bolIndex(%d)+k(%d)*nPixels(%d)=%d] = %f\n",
-                                     TASK_NAME, i, j, N, indexZPD, k, (N - indexZPD + k), bolIndex, k, nPixels, (bolIndex + k * nPixels), IFG[N - indexZPD + k]);
-                        }*/
-                    }
-                }
-
-                /* DEBUG: Write out input data
-                for(k = 0; k < Nin; k++) {
-                    *((double*)(outData->pntr[0]) + (bolIndex + nPixels * k)) =
-                    *((double*)( inData->pntr[0]) + (bolIndex + nPixels * k));
-                    if(i==16 && j==25) {
-                        printf("%s: inData[%d,%d,%d]=%g\n",TASK_NAME, i, j, k, *((double*)( inData->pntr[0]) + (bolIndex + nPixels * k)));
-                    }
-                } */
-
-                /* DEBUG: Write out the shifted IFG
-                for(k = 0; k < N; k++) {
-                    *((double*)(outData->pntr[0]) + (bolIndex + k* nPixels)) = IFG[k];
-                    if(i==16 && j==25) {
-                        printf("%s: IFG[%d,%d,%d]=%g\n",TASK_NAME, i, j, k, IFG[k]);
-                    }
-                } */
-
-                /* Convert real-valued interferogram to complex-valued interferogram */
-                for(k = 0; k < N; k++) { DSIN[k][0] = IFG[k]; DSIN[k][1] = 0.0; }
-
-                /* DEBUG: Write out DSIN
-                for(k = 0; k < N; k++) {
-                    *((double*)(outData->pntr[0]) + (bolIndex + k * nPixels)) = DSIN[k][0];
-                    if(i==16 && j==25) {
-                        printf("%s: DSIN[%d,%d,%d]=%g\n",TASK_NAME, i, j, k, DSIN[k][0]);
-                    }
-                } */
-
-                /* FFT Double-sided complex-valued interferogram */
-                plan = fftw_plan_dft_1d(N, DSIN, SPEC, FFTW_FORWARD, FFTW_ESTIMATE);
-                fftw_execute(plan);
-
-                /* Normalize spectrum */
-                for(k=0;k<N;k++) { SPEC[k][0] = SPEC[k][0] / (double)(N * resolution); }
-
-                /* Apply SFP calibration, if given */
-                if(doSFP){
-                    /* Get the SFP for this pixel */
-                    for(k=0;k<nSfp;k++) { SFPij[k] = SFP[i + j*nWidth + k*nPixels]; }
-                    /* Interpolate the SFP values from its original WN scale to the current spectrum scale */
-                    gsl_spline_init(SPLINE, WN, SFPij, nSfp);
-
-                    /* Divide the spectrum in the band pass region by the interpolated SFP value at each position */
-                    for(k = 0; k < N; k++) {
-                      /*if(k*dSigma >= WN[0] && k*dSigma <= WN[nSfp-1]) {*/
-                        if(k*dSigma >= wnSfpF && k*dSigma <= wnSfpL) {
-                            f = gsl_spline_eval(SPLINE, k*dSigma, ACC);
-                            /*index = bolIndex + nPixels * k;*/
-                            s = SPEC[k][0];
-                            SPEC[k][0] = s / f;
-                          /*if(i==10 && j==20) { printf("SFP i=%d, j=%d, k=%d, dSigma=%f, k*dSigma=%f, s=%f, f=%f, s/f=%f, \n", i, j, k, dSigma, k*dSigma, s, f, s/f); }*/
-                        }
-                    }
-                }
-
-                /* Write out the positive real component of the spectrum */
-                for(k = 0; k <= N2; k++) {
-                    *((double*)(outData->pntr[0]) + (bolIndex + k * nPixels)) = SPEC[k][0];
-                  /*if(i==16 && j==25) {
-                        printf("%s: SPEC[%d,%d,%d]=%E\n",TASK_NAME, i, j, k, SPEC[k][0] / (double)(N * resolution));
-                    }*/
-                }
+        /* Create a single FFT plan for this file. The FFTW planner is not
+           thread-safe, but the plan can be executed by any number of
+           threads at once on other arrays allocated by fftw_malloc */
+        plan = fftw_plan_dft_1d(N, DSIN, SPEC, FFTW_FORWARD, FFTW_ESTIMATE);
+        if(!plan) {
+            *status = SAI__ERROR;
+            errRep(FUNC_NAME, "Unable to create the FFT plan!", status);
+            goto CLEANUP;
+        }
 
-                /* Destroy each allocated plan */
-                if(plan) { fftw_destroy_plan(plan); }
+        /* Divide the pixels between the worker threads, each of which
+           transforms the interferograms of a contiguous block of pixels */
+        nworker = wf ? wf->nworker : 1;
+        job_data = astMalloc(nworker * sizeof(*job_data));
+        if(*status == SAI__OK) {
+            pstep = nPixels / nworker;
+            if(pstep < 1) { pstep = 1; }
+            for(iworker = 0; iworker < nworker; iworker++) {
+                pdata = job_data + iworker;
+                pdata->b1 = iworker * pstep;
+                pdata->b2 = pdata->b1 + pstep - 1;
+                if(iworker == nworker - 1 || pdata->b2 >= nPixels) { pdata->b2 = nPixels - 1; }
+                pdata->nPixels = nPixels;
+                pdata->zeropad = zeropad;
+                pdata->N = N;
+                pdata->N2 = N2;
+                pdata->Nin = Nin;
+                pdata->Nzp = Nzp;
+                pdata->indexZPD = indexZPD;
+                pdata->indexZPDin = indexZPDin;
+                pdata->resolution = resolution;
+                pdata->dSigma = dSigma;
+                pdata->doSFP = doSFP;
+                pdata->nSfp = nSfp;
+                pdata->SFP = SFP;
+                pdata->WN = WN;
+                pdata->wnSfpF = wnSfpF;
+                pdata->wnSfpL = wnSfpL;
+                pdata->in = (double*) inData->pntr[0];
+                pdata->out = (double*) outData->pntr[0];
+                pdata->plan = plan;
+                thrAddJob(wf, 0, pdata, smf1_fts2_spectrum, 0, NULL, status);
             }
+            thrWait(wf, status);
         }
+        job_data = astFree(job_data);
+
+        /* Destroy the plan */
+        fftw_destroy_plan(plan);
+        plan = NULL;
 
         /* Deallocate memory used by arrays */
-        if(IFG)  { IFG = astFree(IFG); }
         if(DS)   { DS = astFree(DS); }
         if(SFP)  { SFP = astFree(SFP); }
-        if(SFPij)  { SFPij = astFree(SFPij); }
         if(WN)   { WN = astFree(WN); }
         if(DSIN) { fftw_free(DSIN); DSIN = NULL; }
         if(SPEC) { fftw_free(SPEC); SPEC = NULL; }
-        if(ACC)     { gsl_interp_accel_free(ACC);   ACC     = NULL; }
-        if(SPLINE)  { gsl_spline_free(SPLINE);      SPLINE  = NULL; }
 
         /* Close the file */
         if(inData) {
@@ -702,15 +647,13 @@ void smurf_fts2_spectrum(int* status)
     }
 
 CLEANUP:
-    if(IFG)  { IFG = astFree(IFG); }
+    if(plan) { fftw_destroy_plan(plan); plan = NULL; }
+    job_data = astFree(job_data);
     if(DS)   { DS = astFree(DS); }
     if(SFP)  { SFP = astFree(SFP); }
-    if(SFPij)  { SFPij = astFree(SFPij); }
     if(WN)   { WN = astFree(WN); }
     if(DSIN) { fftw_free(DSIN); DSIN = NULL; }
     if(SPEC) { fftw_free(SPEC); SPEC = NULL; }
-    if(ACC)     { gsl_interp_accel_free(ACC);   ACC     = NULL; }
-    if(SPLINE)  { gsl_spline_free(SPLINE);      SPLINE  = NULL; }
 
     /* Close files if still open */
     if(inData) {
@@ -743,3 +686,130 @@ CLEANUP:
     if(gOut) grpDelet(&gOut, status);
     if(gSfp) grpDelet(&gSfp, status);
 }
+
+/* Function to be executed in a worker thread. It transforms the
+   interferograms of the pixels in the range b1 to b2, using
+   thread-private buffers and the shared FFT plan. */
+static void smf1_fts2_spectrum( void *job_data_ptr, int *status ) {
+
+    smfFts2SpectrumData* pdata = (smfFts2SpectrumData*) job_data_ptr;
+    const double* in          = pdata->in;
+    double* out               = pdata->out;
+    size_t nPixels            = pdata->nPixels;
+    size_t bolIndex           = 0;
+    int N                     = pdata->N;
+    int Nin                   = pdata->Nin;
+    int Nzp                   = pdata->Nzp;
+    int indexZPD              = pdata->indexZPD;
+    int indexZPDin            = pdata->indexZPDin;
+    int k                     = 0;
+    size_t m                  = 0;
+    int badPixel              = 0;
+    double* IFG               = NULL;           /* Interferogram */
+    double* SFPij             = NULL;           /* Spectral Filter Profile for a single pixel */
+    fftw_complex* DSIN        = NULL;           /* Double-Sided interferogram, FFT input */
+    fftw_complex* SPEC        = NULL;           /* Spectrum */
+    gsl_interp_accel* ACC     = NULL;           /* SFP interpolator */
+    gsl_spline* SPLINE        = NULL;           /* SFP interpolation spline */
+    double s                  = 0.0;            /* spectrum value */
+    double f                  = 0.0;            /* filter value */
+
+    if( *status != SAI__OK ) { return; }
+
+    /* Allocate the thread-private buffers. The zero padded region of the
+       interferogram is never written and so stays zero for every pixel. */
+    IFG  = astCalloc(N, sizeof(*IFG));
+    DSIN = fftw_malloc(N * sizeof(*DSIN));
+    SPEC = fftw_malloc(N * sizeof(*SPEC));
+    if(!DSIN || !SPEC) {
+        if(*status == SAI__OK) {
+            *status = SAI__ERROR;
+            errRep(FUNC_NAME, "Unable to allocate memory for the FFT!", status);
+        }
+    }
+
+    /* The GSL interpolator and spline hold per-pixel state, so each thread
+       needs its own */
+    if(pdata->doSFP && *status == SAI__OK) {
+        SFPij  = astCalloc(pdata->nSfp, sizeof(*SFPij));
+        ACC    = gsl_interp_accel_alloc();
+        SPLINE = gsl_spline_alloc(gsl_interp_cspline, pdata->nSfp);
+    }
+
+    for(bolIndex = pdata->b1; bolIndex <= pdata->b2 && *status == SAI__OK; bolIndex++) {
+        badPixel = 0;
+        for(k = 0; k < Nin; k++) {
+            if(in[bolIndex + k * nPixels] == VAL__BADD) {
+                badPixel = 1;
+                break;
+            }
+        }
+        /* If this is a bad pixel, go to next */
+        if(badPixel) {
+            for(k = 0; k <= pdata->N2; k++) {
+                out[bolIndex + k * nPixels] = VAL__BADD;
+            }
+            continue;
+        }
+
+        /* Double-Sided interferogram */
+        if(pdata->zeropad) {
+            /* Copy the right half of the input into the left half of this IFG, zero padded in the middle */
+            for(k=indexZPDin; k<Nin; k++) {
+                IFG[k - indexZPDin] = in[bolIndex + k * nPixels];
+            }
+            /* Copy the left half of the input into the right half of this IFG, zero padded in the middle */
+            for(k=0; k<indexZPDin; k++) {
+                IFG[Nzp - indexZPDin + k] = in[bolIndex + k * nPixels];
+            }
+        } else {
+            /* Copy the right half of the input into the left half of this IFG */
+            for(k=indexZPD; k<N; k++) {
+                IFG[k - indexZPD] = in[bolIndex + k * nPixels];
+            }
+            /* Copy the left half of the input into the right half of this IFG */
+            for(k=0; k<indexZPD; k++) {
+                IFG[N - indexZPD + k] = in[bolIndex + k * nPixels];
+            }
+        }
+
+        /* Convert real-valued interferogram to complex-valued interferogram */
+        for(k = 0; k < N; k++) { DSIN[k][0] = IFG[k]; DSIN[k][1] = 0.0; }
+
+        /* FFT Double-sided complex-valued interferogram */
+        fftw_execute_dft(pdata->plan, DSIN, SPEC);
+
+        /* Normalize spectrum */
+        for(k=0;k<N;k++) { SPEC[k][0] = SPEC[k][0] / (double)(N * pdata->resolution); }
+
+        /* Apply SFP calibration, if given */
+        if(pdata->doSFP){
+            /* Get the SFP for this pixel */
+            for(m=0;m<pdata->nSfp;m++) { SFPij[m] = pdata->SFP[bolIndex + m*nPixels]; }
+            /* Interpolate the SFP values from its original WN scale to the current spectrum scale */
+            gsl_spline_init(SPLINE, pdata->WN, SFPij, pdata->nSfp);
+
+            /* Divide the spectrum in the band pass region by the interpolated SFP value at each position */
+            for(k = 0; k < N; k++) {
+                if(k*pdata->dSigma >= pdata->wnSfpF && k*pdata->dSigma <= pdata->wnSfpL) {
+                    f = gsl_spline_eval(SPLINE, k*pdata->dSigma, ACC);
+                    s = SPEC[k][0];
+                    SPEC[k][0] = s / f;
+                }
+            }
+        }
+
+        /* Write out the positive real component of the spectrum */
+        for(k = 0; k <= pdata->N2; k++) {
+            out[bolIndex + k * nPixels] = SPEC[k][0];
+        }
+    }
+
+    /* Deallocate memory used by arrays */
+    IFG = astFree(IFG);
+    SFPij = astFree(SFPij);
+    if(DSIN) { fftw_free(DSIN); }
+    if(SPEC) { fftw_free(SPEC); }
+    if(ACC)     { gsl_interp_accel_free(ACC); }
+    if(SPLINE)  { gsl_spline_free(SPLINE); }
+}
@@ -65,12 +65,16 @@
 *        Add mirror times treatment
 *     2014-04-30 (MS)
 *        Prevent extra iteration when any remaining scan data is too short to be useful
+*     2026-10-14:
+*        Take a private copy of the JCMTState array before reallocating it,
+*        since it may be shared with the input header.
 *
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2013 University of Lethbridge. All Rights Reserved.
 *     Copyright (C) 2013 University of British Columbia.
+*     Copyright (C) 2026 East Asian Observatory.
 
 *  Licence:
 *     This program is free software; you can redistribute it and/or
@@ -359,6 +363,7 @@ void smurf_fts2_split(int* status)
 
             /* Update the JCMTSTATE header */
             /* Reallocate outData header array memory to reduced size */
+            smf_state_own(outData->hdr, status);
             allState = (JCMTState*) astRealloc(outData->hdr->allState, nFramesOut * sizeof(*(outData->hdr->allState)));
             if(*status == SAI__OK && allState) {
                 outData->hdr->allState = allState;
@@ -24,14 +24,22 @@
 *     only supports GSD Version 5.3). The data are converted to ACSIS
 *     format and written to disk.  Metadata are converted to appropriate
 *     FITS headers.
+*
+*     Several GSD files may be converted in one invocation. While each
+*     file is converted, the next one is opened and its headers are
+*     read by a separate thread. The spectra are copied from the GSD
+*     file a scan at a time as they are written, rather than all at
+*     once.
 
 *  ADAM Parameters:
 *     DIRECTORY = _CHAR (Read)
 *          Directory for output ACSIS files. A NULL value will use the
 *          current working directory. This command will create a subdir
 *          in this directory named after the observation number.
-*     IN = CHAR (Read)
-*          Name of the input GSD file to be converted.
+*     IN = LITERAL (Read)
+*          Names of the input GSD files to be converted. This may be a
+*          comma-separated list, or an indirection file (prefixed by
+*          "^") listing one file per line.
 *     MSG_FILTER = _CHAR (Read)
 *          Control the verbosity of the application. Values can be
 *          NONE (no messages), QUIET (minimal messages), NORMAL,
@@ -43,6 +51,8 @@
 *          to Feb 03 this number was the number within the project
 *          rather than the number from the night and may lead to name
 *          clashes since ACSIS data are numbered for a UT date.
+*          When several files are converted this parameter is obtained
+*          afresh for each one.
 
 *  Related Applications:
 *     SMURF: MAKECUBE, GSDSHOW;
@@ -97,9 +107,14 @@
 *        Use gsdac_flagBad.
 *     2013 May 28 (MJC):
 *        Add DR recipe notes.
+*     14-OCT-2026:
+*        Convert a group of files, reading the next file in a separate
+*        thread while the current one is written, and copy the spectra
+*        a scan at a time.
 
 *  Copyright:
 *     Copyright (C) 2008, 2013 Science and Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -138,10 +153,14 @@
 #include "gsd.h"
 #include "sae_par.h"
 #include "par.h"
+#include "star/grp.h"
+#include "star/kaplibs.h"
 #include "star/one.h"
+#include "star/thr.h"
 
 /* SMURF includes */
 #include "smurflib.h"
+#include "libsmf/smf_typ.h"
 #include "libgsd/gsdac_struct.h"
 #include "libgsd/gsdac.h"
 #include "jcmt/state.h"
@@ -152,27 +171,44 @@
 #define MAXNAME 80
 #define NRECEP 2
 
-void smurf_gsd2acsis( int *status ) {
-
-  /* Local variables */
+/* Structure containing an open GSD file and its headers. */
+typedef struct smfGsd2acsisData {
+  char filename[GRP__SZNAM+1]; /* name of the GSD file */
   dasFlag dasFlag;            /* file structure type */
-  char directory[MAXNAME];    /* directory to write the file */
-  char filename[MAXNAME];     /* name of the GSD file */
   FILE *fptr;                 /* pointer to GSD file */
   struct gsdac_gsd_struct gsd; /* GSD file access parameters */
   gsdVars gsdVars;            /* GSD headers and arrays */
-  char label[41];             /* GSD label */
-  int nitem;                  /* number of items in GSD file */
+  int isopen;                 /* has the GSD file been opened? */
+  int gotvars;                /* have the headers and arrays been read? */
+} smfGsd2acsisData;
+
+/* Prototypes for local functions */
+static void smurf1_gsd2acsis( void *job_data_ptr, int *status );
+static void smurf1_gsd2acsis_close( smfGsd2acsisData *pdata, int *status );
+
+void smurf_gsd2acsis( int *status ) {
+
+  /* Local variables */
+  smfGsd2acsisData *cur = NULL; /* file being converted */
+  char directory[MAXNAME];    /* directory to write the file */
+  Grp *igrp = NULL;           /* group of input GSD files */
+  size_t i;                   /* loop counter */
+  smfGsd2acsisData job_data[2]; /* files being converted and read */
+  smfGsd2acsisData *next = NULL; /* file being read ahead */
   unsigned int nSteps;        /* number of time steps */
-  float version;              /* GSD file version */
+  char *pname = NULL;         /* pointer to file name */
+  size_t size;                /* number of input files */
+  ThrWorkForce *wf = NULL;    /* pool of worker threads */
 
   /* Check inherited status */
   if ( *status != SAI__OK ) return;
 
+  memset( job_data, 0, sizeof(job_data) );
+
   /* Get the user defined input and output file names */
-  parGet0c ( "IN", filename, MAXNAME, status );
+  kpg1Gtgrp( "IN", &igrp, &size, status );
 
-  if ( *status != SAI__OK ) return;
+  if ( *status != SAI__OK ) goto CLEANUP;
 
   parGet0c ( "DIRECTORY", directory, MAXNAME, status );
 
@@ -181,104 +217,194 @@ void smurf_gsd2acsis( int *status ) {
     one_strlcpy ( directory, ".", sizeof(directory), status );
   }
 
-  msgOutif(MSG__VERB," ",
-	     "Opening GSD file for reading", status);
+  /* Each file is read by a worker thread while the previous one is
+     converted and written by this thread. */
+  wf = thrGetWorkforce( thrGetNThread( SMF__THREADS, status ), status );
+
+  if ( *status == SAI__OK && size > 0 ) {
+    pname = job_data[0].filename;
+    grpGet( igrp, 1, 1, &pname, sizeof(job_data[0].filename), status );
+    thrAddJob( wf, 0, job_data, smurf1_gsd2acsis, 0, NULL, status );
+  }
+
+  for ( i = 1; i <= size && *status == SAI__OK; i++ ) {
+
+    /* Wait for this file to be read. */
+    thrWait( wf, status );
+    if ( *status != SAI__OK ) break;
+
+    cur = job_data + ( i - 1 ) % 2;
+
+    /* Start reading the next file. */
+    if ( i < size ) {
+      next = job_data + i % 2;
+      memset( next, 0, sizeof(*next) );
+      pname = next->filename;
+      grpGet( igrp, i + 1, 1, &pname, sizeof(next->filename), status );
+      thrAddJob( wf, 0, next, smurf1_gsd2acsis, 0, NULL, status );
+    }
+
+    msgSetc( "FILE", cur->filename );
+    msgOutif( MSG__VERB, " ", "Converting ^FILE", status );
+
+    if ( cur->dasFlag == DAS_NONE )
+      msgOutif(MSG__VERB," ",
+	       "DAS file type is DAS_NONE", status);
+    else if ( cur->dasFlag == DAS_TP )
+      msgOutif(MSG__VERB," ",
+	       "DAS file type is DAS_TP", status);
+    else if ( cur->dasFlag == DAS_CONT_CAL )
+      msgOutif(MSG__VERB," ",
+	       "DAS file type is DAS_CONT_CAL", status);
+    else if ( cur->dasFlag == DAS_CROSS_CORR )
+      msgOutif(MSG__VERB," ",
+	       "DAS file type is DAS_CROSS_CORR", status);
+
+    /* Get the number of time steps in the observation. */
+    nSteps = cur->gsdVars.nScan * cur->gsdVars.nScanPts;
+    if ( nSteps <= 0 ) {
+      *status = SAI__WARN;
+      msgSetc( "FILE", cur->filename );
+      errRep ( FUNC_NAME, "^FILE: Nr. steps 0: observation terminated "
+               "without data", status );
+
+      /* Carry on with the remaining files. */
+      if ( i < size ) errFlush( status );
+    } else {
+
+      /* Convert and write out the new file. The spectra are read from
+         the GSD file as they are needed. */
+      gsdac_wrtData ( &(cur->gsdVars), &(cur->gsd), directory, nSteps,
+                      cur->dasFlag, status );
+
+      if ( *status == SAI__OK ) {
+        msgOutif(MSG__VERB," ",
+                 "Conversion completed successfully", status);
+      }
+    }
+
+    smurf1_gsd2acsis_close( cur, status );
+
+    /* Get a new observation number for the next file. */
+    if ( i < size ) parCancl( "OBSNUM", status );
+  }
+
+ CLEANUP:
+
+  /* Wait for any file still being read, and close any open files. */
+  errBegin( status );
+  thrWait( wf, status );
+  errEnd( status );
+  smurf1_gsd2acsis_close( job_data, status );
+  smurf1_gsd2acsis_close( job_data + 1, status );
+
+  if ( igrp ) grpDelet( &igrp, status );
+
+}
+
+/* Function to be executed in a worker thread. It opens a GSD file,
+   checks that it can be converted and reads all the headers and
+   arrays other than the spectra. */
+static void smurf1_gsd2acsis( void *job_data_ptr, int *status ) {
+
+  /* Local variables */
+  smfGsd2acsisData *pdata;    /* file description */
+  char label[41];             /* GSD label */
+  int nitem;                  /* number of items in GSD file */
+  float version;              /* GSD file version */
+
+  /* Check inherited status */
+  if ( *status != SAI__OK ) return;
+
+  pdata = (smfGsd2acsisData *) job_data_ptr;
 
   /* Open the GSD file. */
-  CALLGSD( gsdOpenRead ( filename, &version, label, &nitem,
-                            &fptr, &(gsd.fileDsc), &(gsd.itemDsc),
-			   &(gsd.dataPtr) ),
+  CALLGSD( gsdOpenRead ( pdata->filename, &version, label, &nitem,
+                         &(pdata->fptr), &(pdata->gsd.fileDsc),
+                         &(pdata->gsd.itemDsc), &(pdata->gsd.dataPtr) ),
            status,
-           errRep ( FUNC_NAME, "gsdOpenRead : Could not find input GSD file.", status ); );
+           msgSetc ( "FILE", pdata->filename ); errRep ( FUNC_NAME, "gsdOpenRead : Could not find input GSD file ^FILE.", status ); );
 
   if ( *status != SAI__OK ) return;
-
-  msgOutif(MSG__VERB," ",
-	     "Checking backend name", status);
+  pdata->isopen = 1;
 
   /* Check to see if this is DAS or AOSC data. */
-  gsdac_get0c ( &gsd, "C1BKE", gsdVars.backend, status );
+  gsdac_get0c ( &(pdata->gsd), "C1BKE", pdata->gsdVars.backend, status );
 
   if ( *status != SAI__OK ) return;
 
-  if ( strncmp ( gsdVars.backend, "DAS", 3 ) != 0
-       && strncmp ( gsdVars.backend, "AOSC", 4 ) != 0 ) {
+  if ( strncmp ( pdata->gsdVars.backend, "DAS", 3 ) != 0
+       && strncmp ( pdata->gsdVars.backend, "AOSC", 4 ) != 0 ) {
     *status = SAI__ERROR;
-    errRep ( FUNC_NAME, "File does not contain DAS or AOSC data", status );
+    msgSetc ( "FILE", pdata->filename );
+    errRep ( FUNC_NAME, "File ^FILE does not contain DAS or AOSC data",
+             status );
     return;
   }
 
-  msgOutif(MSG__VERB," ",
-	     "Checking version of GSD file", status);
-
   /* Check the version of the opened file. */
   if ( fabs(version - 5.300 ) > 0.0001 ) {
     *status = SAI__ERROR;
-    errRep ( FUNC_NAME, "GSD version is not 5.300.", status );
+    msgSetc ( "FILE", pdata->filename );
+    errRep ( FUNC_NAME, "GSD version of ^FILE is not 5.300.", status );
     return;
   }
 
   /* Get the file structure flag. */
-  gsdac_getDASFlag ( &gsd, &dasFlag, status );
+  gsdac_getDASFlag ( &(pdata->gsd), &(pdata->dasFlag), status );
 
   if ( *status != SAI__OK ) return;
 
-  if ( dasFlag == DAS_NONE )
-    msgOutif(MSG__VERB," ",
-	     "DAS file type is DAS_NONE", status);
-  else if ( dasFlag == DAS_TP )
-    msgOutif(MSG__VERB," ",
-	     "DAS file type is DAS_TP", status);
-  else if ( dasFlag == DAS_CONT_CAL )
-    msgOutif(MSG__VERB," ",
-	     "DAS file type is DAS_CONT_CAL", status);
-  else if ( dasFlag == DAS_CROSS_CORR )
-    msgOutif(MSG__VERB," ",
-	     "DAS file type is DAS_CROSS_CORR", status);
-  else {
+  if ( pdata->dasFlag != DAS_NONE && pdata->dasFlag != DAS_TP &&
+       pdata->dasFlag != DAS_CONT_CAL && pdata->dasFlag != DAS_CROSS_CORR ) {
     *status = SAI__ERROR;
-    errRep ( FUNC_NAME, "Could not identify DAS file type.", status );
+    msgSetc ( "FILE", pdata->filename );
+    errRep ( FUNC_NAME, "Could not identify DAS file type of ^FILE.",
+             status );
     return;
   }
 
-  /* Get the GSD file headers and data arrays. */
-  gsdac_getGSDVars ( &gsd, dasFlag, &gsdVars, status );
+  /* Get the GSD file headers and arrays, leaving the spectra to be
+     read a scan at a time by gsdac_wrtData. */
+  gsdac_getGSDVars ( &(pdata->gsd), pdata->dasFlag, 0, &(pdata->gsdVars),
+                     status );
+  pdata->gotvars = 1;
 
   /* Flag the bad values with STARLINK VAL__BAD. */
-  gsdac_flagBad ( dasFlag, &gsdVars, status );
+  gsdac_flagBad ( pdata->dasFlag, &(pdata->gsdVars), status );
 
   if ( *status != SAI__OK ) {
-    errRep ( FUNC_NAME, "Couldn't get GSD headers and arrays.", status );
-    return;
+    msgSetc ( "FILE", pdata->filename );
+    errRep ( FUNC_NAME, "Couldn't get GSD headers and arrays from ^FILE.",
+             status );
   }
 
-  /* Close the GSD file. */
-  msgOutif(MSG__VERB," ",
-	     "Closing GSD file", status);
+}
 
-  /* Close the GSD file. */
-  CALLGSD( gsdClose ( fptr, gsd.fileDsc, gsd.itemDsc, gsd.dataPtr ),
-           status,
-           errRep ( FUNC_NAME, "gsdClose : Error closing GSD file.", status ); );
+/* Free the arrays and close the GSD file described by pdata, if this
+   has not already been done. This is attempted even if status is bad. */
+static void smurf1_gsd2acsis_close( smfGsd2acsisData *pdata, int *status ) {
 
+  /* Begin a new error reporting context */
+  errBegin( status );
 
-  /* Get the number of time steps in the observation. */
-  nSteps = gsdVars.nScan * gsdVars.nScanPts;
-  if ( nSteps <= 0 ) {
-    *status = SAI__WARN;
-    errRep ( FUNC_NAME, "Nr. steps 0: observation terminated without data", status );
+  if ( pdata->gotvars ) {
+    gsdac_freeArrays ( pdata->dasFlag, &(pdata->gsdVars), status );
+    pdata->gotvars = 0;
   }
 
-  if ( *status != SAI__OK ) return;
-
-  /* Convert and write out the new file. */
-  gsdac_wrtData ( &gsdVars, directory, nSteps, dasFlag, status );
-
-  gsdac_freeArrays ( dasFlag, &gsdVars, status );
-
-  if ( *status == SAI__OK ) {
+  if ( pdata->isopen ) {
     msgOutif(MSG__VERB," ",
-	     "Conversion completed successfully", status);
+             "Closing GSD file", status);
+
+    CALLGSD( gsdClose ( pdata->fptr, pdata->gsd.fileDsc, pdata->gsd.itemDsc,
+                        pdata->gsd.dataPtr ),
+             status,
+             errRep ( FUNC_NAME, "gsdClose : Error closing GSD file.", status ); );
+    pdata->isopen = 0;
   }
 
+  /* End the error reporting context */
+  errEnd( status );
+
 }
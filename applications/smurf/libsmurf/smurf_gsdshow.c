@@ -51,9 +51,12 @@
 *        Original version.
 *     22-APR-2008 (JB):
 *        Use T/F for logical values.
+*     14-OCT-2026:
+*        Update call to gsdac_getGSDVars due to API change.
 
 *  Copyright:
 *     Copyright (C) 2008 Science and Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -207,7 +210,7 @@ void smurf_gsdshow ( int *status ) {
   }
 
   /* Get the GSD file headers and data arrays. */
-  gsdac_getGSDVars ( &gsd, dasFlag, &gsdVars, status );
+  gsdac_getGSDVars ( &gsd, dasFlag, 1, &gsdVars, status );
 
   if ( *status != SAI__OK ) {
     errRep ( FUNC_NAME, "Couldn't get GSD headers and arrays.", status );
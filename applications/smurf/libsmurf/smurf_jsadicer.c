@@ -86,6 +86,8 @@
 *        -1 and 0.
 *     1-OCT-2014 (DSB):
 *        Change USEXPH to PROJ.
+*     14-OCT-2026:
+*        Use a pool of worker threads when dicing the input NDF.
 
 *  Copyright:
 *     Copyright (C) 2013-2014 Science and Technology Facilities Council.
@@ -131,10 +133,12 @@
 #include "star/grp.h"
 #include "star/kaplibs.h"
 #include "star/ndg.h"
+#include "star/thr.h"
 
 /* SMURF includes */
 #include "smurf_typ.h"
 #include "smurflib.h"
+#include "libsmf/smf.h"
 #include "libsmf/jsatiles.h"
 
 
@@ -148,6 +152,7 @@ void smurf_jsadicer( int *status ) {
    AstFitsChan *fc;
    Grp *igrp = NULL;
    Grp *ogrp = NULL;
+   ThrWorkForce *wf = NULL;
    char *pname;
    char basename[ 255 ];
    char text[ 255 ];
@@ -208,7 +213,8 @@ void smurf_jsadicer( int *status ) {
    ogrp = grpNew( "", status );
 
 /* Dice the map into output NDFs. */
-   smf_jsadicer( indf, basename, trim, tiling.instrument, proj, &ntile,
+   wf = thrGetWorkforce( thrGetNThread( SMF__THREADS, status ), status );
+   smf_jsadicer( wf, indf, basename, trim, tiling.instrument, proj, &ntile,
                  ogrp, status );
 
 /* Write out the list of output NDF names, annulling the error if a null
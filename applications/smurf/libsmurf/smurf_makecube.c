@@ -1847,7 +1847,7 @@ void smurf_makecube( int *status ) {
                                  &nused, &nreject, &naccept, status );
 
                } else {
-                  smf_rebinsparse( data, first, pt, ospecfrm, ospecmap,
+                  smf_rebinsparse( wf, data, first, pt, ospecfrm, ospecmap,
                                    abskyfrm, detgrp, tile->elbnd, tile->eubnd,
                                    genvar, data_array, var_array, &ispec,
                                    exp_array, eff_array, &fcon, status );
@@ -2179,7 +2179,7 @@ void smurf_makecube( int *status ) {
          if( jsatiles ) {
             parGet0l( "TRIMTILES", &trimtiles, status );
             grpSetsz( igrp4, 0, status );
-            smf_jsadicer( tndf, oname, trimtiles, SMF__INST_NONE,
+            smf_jsadicer( wf, tndf, oname, trimtiles, SMF__INST_NONE,
                           SMF__JSA_HPX, &njsatile, igrp4, status );
             delete = -1;
          }
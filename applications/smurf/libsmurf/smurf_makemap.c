@@ -50,6 +50,23 @@
 *          configuration parameter MAPTOL) will not be reached within
 *          the number of iterations allowed by configuration parameter
 *          NUMITER.  [FALSE]
+*     ADDTO = NDF (Read)
+*          An existing map, previously created by MAKEMAP using
+*          METHOD=REBIN, to which the new input data are to be added.
+*          This allows a quick-look map of an observation that is still
+*          in progress to be brought up to date as each new sub-scan is
+*          written, by supplying just the new files for IN and the
+*          previous map for ADDTO, rather than re-making the whole map.
+*          The output map uses the pixel grid of ADDTO (REF is not used)
+*          and covers both ADDTO and the new data. The two maps are
+*          combined using their exposure times as weights, which gives
+*          the same data values as rebinning all of the data together.
+*          The output variances are those of the weighted mean of the two
+*          maps, and the exposure times and weights are summed. The FITS
+*          headers of the output are derived from the new data only.
+*          ADDTO is only used with METHOD=REBIN, and cannot be used
+*          with JSATILES. TILEDIMS is ignored if ADDTO is supplied.
+*          ADDTO should not be the same NDF as OUT. [!]
 *     ALIGNSYS = _LOGICAL (Read)
 *          If TRUE, then the spatial positions of the input data are
 *          aligned in the co-ordinate system specified by parameter
@@ -546,6 +563,56 @@
 *     For example, 850.flt.edgelow will copy the edgelow value into the flt
 *     section only for 850 micron data. Similarly for 450.flt.edgelow.
 *     - Default values can be read from the $SMURF_DIR/smurf_makemap.def file.
+*     - If the environment variable SMURF_SCRATCHDIR is set to the name of
+*     a directory, the large time-series arrays used by the iterative
+*     algorithm (the residuals, quality, pointing and model components)
+*     are stored in memory-mapped scratch files within that directory,
+*     and are excluded when deciding whether the data need to be split
+*     into chunks (see parameter MAXMEM). This allows long observations
+*     to be processed as a single chunk, at the cost of disk I/O. A fast
+*     local disk should be used. The scratch files are deleted
+*     automatically.
+*     - If the environment variable SMURF_CHECKPOINT is set to a file
+*     name, the full state of the iterative algorithm (the cleaned
+*     residuals, all model components, the maps and the convergence
+*     history) is saved in that file every SMURF_CHECKPOINT_INTERVAL
+*     iterations (default 1). If makemap is then interupted or killed, it
+*     can be re-run with the same parameters and with SMURF_RESUME set to
+*     1, in which case it continues from the last checkpoint. The raw data
+*     for the interupted chunk are still read, in order to re-create the
+*     headers and pointing, but they are not cleaned again and the
+*     iterations already completed are not repeated. Previously completed
+*     chunks are not read at all. The checkpoint file is as large as the
+*     time-series data and is not deleted automatically.
+*     - If the data are split into several continuous chunks and the
+*     environment variable SMURF_CHUNKPROCS is set to a value greater than
+*     one, up to that many chunks are processed at the same time, each in
+*     a separate process using an equal share of the available threads
+*     (see SMURF_THREADS). This is faster when there are many short chunks,
+*     since many of the steps in processing a chunk do not make efficient
+*     use of more than a few threads. The number of concurrent chunks is
+*     reduced if there is not enough memory (see parameter MAXMEM). The
+*     final map is identical to that produced when the chunks are
+*     processed one after the other. SMURF_CHUNKPROCS is ignored if any of
+*     the BOLOMAP, SHORTMAP, ITERMAP, SAMPCUBE, FLAGMAP or DIAG.OUT config
+*     parameters are set, or if checkpoints are being written.
+*     - If SMURF was built with MPI support (configure --with-mpi) and the
+*     environment variable SMURF_MPI is set to a non-zero value, MAKEMAP
+*     may be run as several MPI processes, possibly on different nodes
+*     (e.g. "mpirun -np 4 makemap ..."), all given the same parameters.
+*     When the data are split into several continuous chunks, each
+*     process then handles a share of the chunks using all of its own
+*     threads, and the first process combines the maps from all chunks
+*     into the output map. The final map is identical to that produced
+*     when the chunks are processed one after the other. The other
+*     processes create no output NDFs. The same restrictions apply as for
+*     SMURF_CHUNKPROCS, in which case every process makes the whole map.
+*     - The memory used by the EXT and FLT models can be halved by
+*     storing them in single precision. This is requested by setting the
+*     environment variable SMURF_FLOATMODELS to a comma-separated list of
+*     the models concerned (e.g. "EXT,FLT"). All arithmetic involving the
+*     models is still done in double precision, and the residuals are
+*     always stored in double precision.
 
 *  Authors:
 *     Tim Jenness (JAC, Hawaii)
@@ -807,13 +874,20 @@
 *        contiguous chunks that failed to converge.
 *     2019-07-9 (DSB):
 *        Ensure no output NDF is created if an error occurs.
+*     2026-10-14:
+*        Allow continuous chunks to be shared between MPI processes.
+*     2026-10-14:
+*        Add parameter ADDTO.
+*     2026-10-14:
+*        Read only the headers of the input files when recording
+*        provenance and merging FITS headers after an iterative map.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2005-2007 Particle Physics and Astronomy Research Council.
 *     Copyright (C) 2005-2010,2013 University of British Columbia.
 *     Copyright (C) 2007-2012 Science and Technology Facilities Council.
-*     Copyright (C) 2017-2019 East Asian Observatory.
+*     Copyright (C) 2017-2019, 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -928,6 +1002,7 @@ void smurf_makemap( int *status ) {
   AstKeyMap *keymap=NULL;    /* Pointer to keymap of config settings */
   int lbnd_out[2];           /* Lower pixel bounds for output map */
   double *map=NULL;          /* Pointer to the rebinned map data */
+  int mpirank = 0;           /* Rank of this MPI process */
   size_t mapmem=0;           /* Memory needed for output map */
   smf_qual_t *mapqual=NULL;  /* Map quality */
   size_t maxmem=0;           /* Max memory usage in bytes */
@@ -980,6 +1055,7 @@ void smurf_makemap( int *status ) {
   double *weights3d = NULL;  /* Pointer to 3-D weights array */
   AstFrameSet *wcstile2d = NULL;/* WCS Frameset describing 2D spatial axes */
   int wndf = NDF__NOID;      /* NDF identifier for WEIGHTS */
+  int addndf = NDF__NOID;    /* NDF identifier for the ADDTO map */
   ThrWorkForce *wf = NULL;   /* Pointer to a pool of worker threads */
 
   if (*status != SAI__OK) return;
@@ -1169,7 +1245,25 @@ void smurf_makemap( int *status ) {
 
   /* Calculate the map bounds */
 
-  smf_getrefwcs( "REF", igrp, &specrefwcs, &spacerefwcs, &isjsa, status );
+  /* If a map made by a previous REBIN run is to be brought up to date,
+     it defines the output grid in place of REF. */
+  if( rebin && *status == SAI__OK ) {
+    ndfAssoc( "ADDTO", "READ", &addndf, status );
+    if( *status == PAR__NULL ) {
+      errAnnul( status );
+      addndf = NDF__NOID;
+    } else {
+      parGet0l( "JSATILES", &jsatiles, status );
+      if( jsatiles && *status == SAI__OK ) {
+        *status = SAI__ERROR;
+        errRep( "", "ADDTO cannot be used when creating JSA tiles.",
+                status );
+      }
+    }
+  }
+
+  smf_getrefwcs( ( addndf != NDF__NOID ) ? "ADDTO" : "REF", igrp,
+                 &specrefwcs, &spacerefwcs, &isjsa, status );
   if( specrefwcs ) specrefwcs = astAnnul( specrefwcs );
 
   /* See if the input data is to be aligned in the output coordinate system
@@ -1182,6 +1276,36 @@ void smurf_makemap( int *status ) {
                  lbnd_out, ubnd_out, &outfset, &moving, &boxes, fts_port,
                  keymap, status );
 
+  /* Extend the output map to cover the whole of any ADDTO map, shifting
+     the GRID Frame of the output WCS to match the new lower bounds. */
+  if( addndf != NDF__NOID && *status == SAI__OK ) {
+    double shift[ 2 ];
+    int addlbnd[ NDF__MXDIM ];
+    int addubnd[ NDF__MXDIM ];
+    int addndim;
+
+    ndfBound( addndf, NDF__MXDIM, addlbnd, addubnd, &addndim, status );
+    for( i = 0; i < 2; i++ ) {
+      shift[ i ] = 0.0;
+      if( addlbnd[ i ] < lbnd_out[ i ] ) {
+        shift[ i ] = lbnd_out[ i ] - addlbnd[ i ];
+        lbnd_out[ i ] = addlbnd[ i ];
+      }
+      if( addubnd[ i ] > ubnd_out[ i ] ) ubnd_out[ i ] = addubnd[ i ];
+    }
+
+    if( shift[ 0 ] != 0.0 || shift[ 1 ] != 0.0 ) {
+      astRemapFrame( outfset, AST__BASE, astShiftMap( 2, shift, " " ) );
+    }
+
+    msgSeti( "XL", lbnd_out[ 0 ] );
+    msgSeti( "YL", lbnd_out[ 1 ] );
+    msgSeti( "XU", ubnd_out[ 0 ] );
+    msgSeti( "YU", ubnd_out[ 1 ] );
+    msgOutif( MSG__NORM, " ", "   Including ADDTO map, output map pixel "
+              "bounds: ( ^XL:^XU, ^YL:^YU )", status );
+  }
+
   msgBlank( status );
 
   /*** TIMER ***/
@@ -1201,7 +1325,7 @@ void smurf_makemap( int *status ) {
      we are producing JSA tiles, do not access the parameters for
      user-defined tiles. */
   parGet0l( "JSATILES", &jsatiles, status );
-  if( !jsatiles && *status == SAI__OK ) {
+  if( !jsatiles && addndf == NDF__NOID && *status == SAI__OK ) {
     parGet1i( "TILEDIMS", 2, tiledims, &nval, status );
     if( *status == PAR__NULL ) {
       errAnnul( status );
@@ -1561,6 +1685,15 @@ void smurf_makemap( int *status ) {
       }
       weights3d = astFree( weights3d );
 
+      /* If an existing map is being brought up to date, add it into the
+         new map, and record it as an ancestor of the new map. */
+      if( addndf != NDF__NOID ) {
+        smf_addrebinmap( addndf, tile->elbnd, tile->eubnd, map, variance,
+                         weights, exp_time, status );
+        smf_updateprov( ondf, NULL, addndf, "SMURF:MAKEMAP(REBIN)", NULL,
+                        status );
+      }
+
       /* Write WCS */
       if (wcstile2d) {
 	smf_set_moving( (AstFrame *) wcstile2d, fchan, status );
@@ -1675,6 +1808,19 @@ void smurf_makemap( int *status ) {
 
     /************************* I T E R A T E *************************************/
 
+    /* If the chunks are being shared between MPI processes, only rank
+       zero writes the output map. The others write to a scratch NDF
+       alongside it, which is deleted at the end. */
+    mpirank = smf_mpi_rank( NULL, status );
+    if( mpirank > 0 && *status == SAI__OK ) {
+      char suffix[20];
+      pname = tempfile;
+      grpGet( ogrp, 1, 1, &pname, sizeof(tempfile), status );
+      sprintf( suffix, "_mpi%d", mpirank );
+      one_strlcat( tempfile, suffix, sizeof(tempfile), status );
+      grpPut1( ogrp, tempfile, 1, status );
+    }
+
     smfflags = SMF__MAP_VAR | SMF__MAP_QUAL;
     smf_open_newfile ( wf, ogrp, 1, SMF__DOUBLE, 2, lbnd_out, ubnd_out, smfflags,
                        &odata, status );
@@ -1848,9 +1994,12 @@ void smurf_makemap( int *status ) {
 
     /* Now that the map is created and all parameters have been accessed,
        history information and provenance can now be stored in the output.
-       Loop over all input data files to setup provenance handling */
+       Loop over all input data files to setup provenance handling. Only
+       the headers are needed, so neither the data arrays nor the WCS
+       FrameSets are read. */
     for(i=1; (i<=size) && ( *status == SAI__OK ); i++ ) {
-      smf_open_file( wf, igrp, i, "READ", SMF__NOCREATE_DATA, &data, status );
+      smf_open_file( wf, igrp, i, "READ",
+                     SMF__NOCREATE_DATA | SMF__NOCREATE_WCS, &data, status );
       if( *status != SAI__OK) {
         msgSeti("I",i);
         msgSeti("S",size);
@@ -2021,11 +2170,15 @@ void smurf_makemap( int *status ) {
 
     /* If required, split the output map up into JSA tiles. Delete the
        original output NDF afterwards. Always delete the output NDF if 
-       an error has occurred. */
-    if( jsatiles ) {
+       an error has occurred, or if it is the scratch NDF created by an
+       MPI process other than rank zero. */
+    if( mpirank > 0 ) {
+       ndfDelet( &tndf, status );
+
+    } else if( jsatiles ) {
        parGet0l( "TRIMTILES", &trimtiles, status );
        grpSetsz( igrp4, 0, status );
-       smf_jsadicer( tndf, oname, trimtiles, SMF__INST_NONE, SMF__JSA_HPX,
+       smf_jsadicer( wf, tndf, oname, trimtiles, SMF__INST_NONE, SMF__JSA_HPX,
                      &njsatile, igrp4, status );
        ndfDelet( &tndf, status );
 
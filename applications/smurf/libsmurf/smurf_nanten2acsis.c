@@ -389,6 +389,7 @@ void smurf_nanten2acsis( int *status ) {
       if (*status == SAI__OK) {
         smfHead ihdr;
         ihdr.fitshdr = outhdr;
+        ihdr.fitsidx = NULL;
         smf_fits_getD( &ihdr, "CDELT2", &cdelt2, status );
         smf_fits_getD( &ihdr, "CDELT3", &cdelt3, status );
       }
@@ -548,6 +548,6 @@ void smurf_sc2clean( int *status ) {
   if( ogrp ) grpDelet( &ogrp, status);
   if( basegrp ) grpDelet( &basegrp, status );
   if( igroup ) smf_close_smfGroup( &igroup, status );
-  fftw_cleanup();
+  smf_fftw_cleanup( status );
   ndfEnd( status );
 }
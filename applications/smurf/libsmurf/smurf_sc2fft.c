@@ -394,7 +394,7 @@ void smurf_sc2fft( int *status ) {
 	    freqlo = 1. / (idata->hdr->steptime * idata->hdr->nframes);
 
             smf_bolonoise( wf, idata, -1.0, 1, freqlo, SMF__F_WHITELO,
-                           SMF__F_WHITEHI, 1, 0, whitenoise, NULL, &odata,
+                           SMF__F_WHITEHI, 1, 0, 0, whitenoise, NULL, &odata,
                            status );
 
             /* Initialize quality */
@@ -525,5 +525,5 @@ void smurf_sc2fft( int *status ) {
   ndfEnd( status );
 
   /* Ensure that FFTW doesn't have any used memory kicking around */
-  fftw_cleanup();
+  smf_fftw_cleanup( status );
 }
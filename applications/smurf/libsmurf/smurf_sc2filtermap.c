@@ -340,5 +340,5 @@ void smurf_sc2filtermap( int *status ) {
   ndfEnd( status );
 
   /* Ensure that FFTW doesn't have any used memory kicking around */
-  fftw_cleanup();
+  smf_fftw_cleanup( status );
 }
@@ -68,9 +68,12 @@
 *        Initial version - based on sc2fft task
 *     2011-09-26 (EC):
 *        Add AZAVPSPEC option
+*     2026-10-14:
+*        smf_fft_2dazav API change.
 
 *  Copyright:
 *     Copyright (C) 2011 University of British Columbia.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -243,7 +246,7 @@ void smurf_sc2mapfft( int *status ) {
       if( azavpspec ) {
         smfData *tempdata=NULL;
 
-        tempdata = smf_fft_2dazav( odata, NULL, status );
+        tempdata = smf_fft_2dazav( wf, odata, NULL, status );
         smf_close_file( wf, &odata, status );
         odata = tempdata;
       }
@@ -268,5 +271,5 @@ void smurf_sc2mapfft( int *status ) {
   ndfEnd( status );
 
   /* Ensure that FFTW doesn't have any used memory kicking around */
-  fftw_cleanup();
+  smf_fftw_cleanup( status );
 }
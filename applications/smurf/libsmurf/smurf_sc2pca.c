@@ -74,6 +74,10 @@
 *          Control the verbosity of the application. Values can be
 *          NONE (no messages), QUIET (minimal messages), NORMAL,
 *          VERBOSE, DEBUG or ALL. [NORMAL]
+*     NCOMP = _INTEGER (Read)
+*          The number of principal components to calculate. If zero, all
+*          components are calculated. Calculating only the strongest few
+*          components is much faster than calculating them all. [0]
 *     OUTAMP = NDF (Write)
 *          Amplitude data cube. The first two coordinates are bolometer
 *          location, and the third enumerates component.
@@ -114,6 +118,8 @@
 *     2013-08-21 (AGG):
 *        Do not call grpList if no output files are generated. This
 *        avoids a GRP__INVID error in such cases.
+*     14-OCT-2026:
+*        Add parameter NCOMP.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -180,6 +186,7 @@ void smurf_sc2pca( int *status ) {
   AstKeyMap *heateffmap = NULL;    /* Heater efficiency data */
   size_t i=0;                /* Counter, index */
   Grp *igrp=NULL;            /* Input group of files */
+  int ncomp;                 /* Number of components to calculate */
   Grp *outampgrp=NULL;       /* Output amplitude group of files */
   Grp *outcompgrp=NULL;      /* Output component group of files */
   size_t outampsize;         /* Total number of NDF names in ocompgrp */
@@ -200,6 +207,9 @@ void smurf_sc2pca( int *status ) {
   /* Are we flatfielding? */
   parGet0l( "FLAT", &ensureflat, status );
 
+  /* How many components are required? Zero means all of them. */
+  parGdr0i( "NCOMP", 0, 0, VAL__MAXI, 1, &ncomp, status );
+
   /* Filter out useful data (revert to darks if no science data) */
   smf_find_science( wf, igrp, &fgrp, 1, NULL, NULL, 1, 1, SMF__NULL, &darks,
                     &flatramps, &heateffmap, NULL, status );
@@ -239,8 +249,10 @@ void smurf_sc2pca( int *status ) {
     /* Sync quality with bad values */
     smf_update_quality( wf, data, 1, NULL, 0, 0.05, status );
 
-    /* Calculate the PCA */
-    smf_clean_pca( wf, data, 0, 0, 0, 0, 0.0, &components, &amplitudes,
+    /* Calculate the PCA. A negative threshold tells smf_clean_pca to
+       calculate only the first "ncomp" components. */
+    smf_clean_pca( wf, data, 0, 0, ( ncomp > 0 ) ? -1.0 : 0.0,
+                   (size_t) ncomp, 0.0, &components, &amplitudes,
                    0, 1, NULL, ~SMF__Q_BADB, status );
 
     /* Write out to the new files */
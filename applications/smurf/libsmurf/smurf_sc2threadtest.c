@@ -23,8 +23,31 @@
 *  Description:
 *     This routine tests schemes for visiting large quantities of
 *     SCUBA-2 data using multiple threads. This is a developer tool.
+*
+*     If parameter BENCH is TRUE, a reproducible benchmark of the core
+*     map-making kernels is run instead of the tests described above.
+*     Synthetic data containing 1/f noise (generated by libsc2sim), a
+*     common-mode signal and flagged gaps are processed by each of the
+*     kernels selected by parameter KERNELS, once for each of the thread
+*     counts given by parameter THREADS. The throughput of each kernel is
+*     reported in samples per second, and in samples per second per
+*     thread, both on the screen and optionally in a text file
+*     (parameter RESULTS) suitable for comparing the results of regular
+*     (e.g. nightly) runs in order to spot scaling regressions. The
+*     random number generator is seeded with a fixed value so that each
+*     run processes the same data.
 
 *  ADAM Parameters:
+*     BENCH = _LOGICAL (Read)
+*          If TRUE, run the kernel benchmarks, rather than the original
+*          threading tests. [FALSE]
+*     KERNELS = LITERAL (Read)
+*          A comma-separated list of the kernels to benchmark when BENCH
+*          is TRUE. Any combination of "REBIN" (smf_rebinmap1), "FILTER"
+*          (a low-pass FFT filter), "COM" (estimating and removing the
+*          common-mode signal), "PCA" (smf_clean_pca), "MEDIAN"
+*          (smf_median_smooth applied to each bolometer) and "FILLGAPS"
+*          (smf_fillgaps) may be given, or "ALL" to run them all. ["ALL"]
 *     MSG_FILTER = _CHAR (Read)
 *          Control the verbosity of the application. Values can be
 *          NONE (no messages), QUIET (minimal messages), NORMAL,
@@ -34,7 +57,21 @@
 *     NSUB = _INTEGER (Read)
 *          Number of subarrays. [4]
 *     NTHREAD = _INTEGER (Read)
-*          Number of threads to use. [2]
+*          Number of threads to use. Only used if BENCH is FALSE. [2]
+*     RESULTS = _CHAR (Write)
+*          The name of a text file in which to store the benchmark
+*          results when BENCH is TRUE. Each line describes a single
+*          kernel run, and contains space-separated columns giving the
+*          kernel name, the number of threads, the number of bolometers,
+*          the number of time slices, the number of chunks, the elapsed
+*          time in seconds, the number of samples processed per second,
+*          and the number of samples processed per second per thread.
+*          The first line is a comment (starting with "#") naming the
+*          columns. No file is created if a null (!) value is supplied. [!]
+*     THREADS = _INTEGER (Read)
+*          A vector holding the numbers of threads with which each kernel
+*          should be benchmarked when BENCH is TRUE. A new pool of threads
+*          is created for each value. [1,2,4]
 *     TSTEPS = _INTEGER (Read)
 *          Number of time samples in simulated data chunk. [6000]
 
@@ -82,6 +119,7 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <sys/time.h>
 #include <time.h>
 #include <math.h>
@@ -91,6 +129,7 @@
 #include "mers.h"
 #include "par.h"
 #include "par_par.h"
+#include "par_err.h"
 #include "prm_par.h"
 #include "ndf.h"
 #include "sae_par.h"
@@ -120,6 +159,15 @@
 #define FUNC_NAME "smurf_sc2threadtest"
 #define TASK_NAME "SC2THREADTEST"
 
+/* Benchmark set-up */
+#define SMF__BENCH_MAXTHR 64    /* Max. number of THREADS values */
+#define SMF__BENCH_MAPDIM 200   /* Dimension of square map used by REBIN */
+#define SMF__BENCH_MEDBOX 50    /* Box size used by MEDIAN */
+#define SMF__BENCH_NPCA 5       /* No. of components removed by PCA */
+#define SMF__BENCH_GAP 20       /* Length of each flagged gap */
+#define SMF__BENCH_GAPSEP 1000  /* Time slices between gaps */
+#define SMF__BENCH_SEED 1234567 /* Fixed seed for synthetic data */
+
 /* --------------------------------------------------------------------------*/
 
 /* Structure used to pass data divided into time-chunks to different threads */
@@ -238,6 +286,419 @@ void smfParallelTime( void *job_data_ptr, int *status ) {
 
 /* --------------------------------------------------------------------------*/
 
+/* Structure used to pass data to the benchmark kernels that are
+   parallelised using thrParallelFor. */
+typedef struct smfBenchData {
+  double *dat;              /* Pointer to data array */
+  smf_qual_t *qua;          /* Pointer to quality array */
+  dim_t nbolo;              /* Number of bolometers */
+  dim_t ntslice;            /* Number of time slices */
+  size_t bstride;           /* Bolometer stride */
+  size_t tstride;           /* Time slice stride */
+} smfBenchData;
+
+static void smf1_bench_com( void *job_data, size_t t1, size_t t2,
+                            int *status );
+static void smf1_bench_median( void *job_data, size_t b1, size_t b2,
+                               int *status );
+static void smf1_bench_run( ThrWorkForce *wf, const char *kernel,
+                            smfArray **res, size_t nchunks, int **luts,
+                            int *status );
+
+/* Estimate the common-mode signal in a range of time slices as the mean
+   of all good bolometer values, and subtract it from the bolometers. */
+static void smf1_bench_com( void *job_data, size_t t1, size_t t2,
+                            int *status ) {
+  smfBenchData *pdata = job_data;
+  double sum;
+  dim_t ibolo;
+  dim_t ngood;
+  size_t i;
+  size_t itime;
+
+  if( *status != SAI__OK ) return;
+
+  for( itime = t1; itime <= t2; itime++ ) {
+    sum = 0.0;
+    ngood = 0;
+    for( ibolo = 0; ibolo < pdata->nbolo; ibolo++ ) {
+      i = ibolo*pdata->bstride + itime*pdata->tstride;
+      if( !( pdata->qua[ i ] & SMF__Q_GOOD ) ) {
+        sum += pdata->dat[ i ];
+        ngood++;
+      }
+    }
+
+    if( ngood > 0 ) {
+      sum /= ngood;
+      for( ibolo = 0; ibolo < pdata->nbolo; ibolo++ ) {
+        i = ibolo*pdata->bstride + itime*pdata->tstride;
+        if( !( pdata->qua[ i ] & SMF__Q_GOOD ) ) pdata->dat[ i ] -= sum;
+      }
+    }
+  }
+}
+
+/* Median smooth a range of bolometers, replacing each bolometer time
+   stream with its smoothed version. */
+static void smf1_bench_median( void *job_data, size_t b1, size_t b2,
+                               int *status ) {
+  smfBenchData *pdata = job_data;
+  double *out;
+  double *pdat;
+  double *w1;
+  int *w3;
+  size_t *w2;
+  size_t ibolo;
+  dim_t itime;
+
+  if( *status != SAI__OK ) return;
+
+  out = astMalloc( pdata->ntslice*sizeof( *out ) );
+  w1 = astMalloc( SMF__BENCH_MEDBOX*sizeof( *w1 ) );
+  w2 = astMalloc( SMF__BENCH_MEDBOX*sizeof( *w2 ) );
+  w3 = astMalloc( SMF__BENCH_MEDBOX*sizeof( *w3 ) );
+
+  for( ibolo = b1; ibolo <= b2 && *status == SAI__OK; ibolo++ ) {
+    pdat = pdata->dat + ibolo*pdata->bstride;
+    smf_median_smooth( SMF__BENCH_MEDBOX, SMF__FILT_MEDIAN, 0.5,
+                       pdata->ntslice, pdat,
+                       pdata->qua + ibolo*pdata->bstride, pdata->tstride,
+                       SMF__Q_GOOD, out, w1, w2, w3, status );
+    if( *status == SAI__OK ) {
+      for( itime = 0; itime < pdata->ntslice; itime++ ) {
+        pdat[ itime*pdata->tstride ] = out[ itime ];
+      }
+    }
+  }
+
+  w3 = astFree( w3 );
+  w2 = astFree( w2 );
+  w1 = astFree( w1 );
+  out = astFree( out );
+}
+
+/* Run a single benchmark kernel on every subarray of every chunk. */
+static void smf1_bench_run( ThrWorkForce *wf, const char *kernel,
+                            smfArray **res, size_t nchunks, int **luts,
+                            int *status ) {
+  smfBenchData bdata;
+  smfData *data;
+  smfFilter *filt = NULL;
+  double *map = NULL;
+  double *mapvar = NULL;
+  double *mapweight = NULL;
+  double *mapweightsq = NULL;
+  double scalevar;
+  dim_t msize;
+  int *hitsmap = NULL;
+  int rebinflags;
+  size_t i;
+  size_t j;
+  size_t nsub;
+
+  if( *status != SAI__OK ) return;
+
+/* Allocate the map arrays used by REBIN. */
+  msize = SMF__BENCH_MAPDIM*SMF__BENCH_MAPDIM;
+  if( !strcmp( kernel, "REBIN" ) ) {
+    map = astCalloc( msize, sizeof( *map ) );
+    mapvar = astCalloc( msize, sizeof( *mapvar ) );
+    mapweight = astCalloc( msize, sizeof( *mapweight ) );
+    mapweightsq = astCalloc( msize, sizeof( *mapweightsq ) );
+    hitsmap = astCalloc( msize, sizeof( *hitsmap ) );
+  }
+
+  for( i = 0; i < nchunks && *status == SAI__OK; i++ ) {
+    nsub = res[ i ]->ndat;
+
+/* The FILTER kernel uses a single low-pass filter for all subarrays. */
+    if( !strcmp( kernel, "FILTER" ) ) {
+      filt = smf_create_smfFilter( res[ i ]->sdata[ 0 ], status );
+      smf_filter_ident( filt, 1, status );
+      smf_filter_edge( filt, 10.0, 0, 1, status );
+    }
+
+    for( j = 0; j < nsub && *status == SAI__OK; j++ ) {
+      data = res[ i ]->sdata[ j ];
+      bdata.dat = data->pntr[ 0 ];
+      bdata.qua = data->qual;
+      smf_get_dims( data, NULL, NULL, &bdata.nbolo, &bdata.ntslice, NULL,
+                    &bdata.bstride, &bdata.tstride, status );
+      if( *status != SAI__OK ) break;
+
+      if( !strcmp( kernel, "REBIN" ) ) {
+        rebinflags = 0;
+        if( i == 0 && j == 0 ) rebinflags |= AST__REBININIT;
+        if( i == nchunks - 1 && j == nsub - 1 ) rebinflags |= AST__REBINEND;
+        smf_rebinmap1( wf, data, NULL, luts[ i*nsub + j ], 0, 0, 0, NULL, 0,
+                       SMF__Q_GOOD, 1, rebinflags, 0, map, mapweight,
+                       mapweightsq, hitsmap, mapvar, msize, 1.0, &scalevar,
+                       status );
+
+      } else if( !strcmp( kernel, "FILTER" ) ) {
+        smf_filter_execute( wf, data, filt, 0, 0, status );
+
+      } else if( !strcmp( kernel, "COM" ) ) {
+        thrParallelFor( wf, 0, bdata.ntslice - 1, 0, &bdata,
+                        smf1_bench_com, status );
+
+      } else if( !strcmp( kernel, "PCA" ) ) {
+        smf_clean_pca( wf, data, 0, 0, -1.0, SMF__BENCH_NPCA, 0.5, NULL,
+                       NULL, 0, 1, NULL, SMF__Q_GAP, status );
+
+      } else if( !strcmp( kernel, "MEDIAN" ) ) {
+        thrParallelFor( wf, 0, bdata.nbolo - 1, 0, &bdata,
+                        smf1_bench_median, status );
+
+      } else if( !strcmp( kernel, "FILLGAPS" ) ) {
+        smf_fillgaps( wf, data, SMF__Q_GAP, status );
+      }
+    }
+
+    if( filt ) filt = smf_free_smfFilter( filt, status );
+  }
+
+  hitsmap = astFree( hitsmap );
+  mapweightsq = astFree( mapweightsq );
+  mapweight = astFree( mapweight );
+  mapvar = astFree( mapvar );
+  map = astFree( map );
+}
+
+/* Create the synthetic data and run the benchmarks. */
+static void smf1_bench( size_t nchunks, size_t nsub, size_t tsteps,
+                        int *status );
+
+static void smf1_bench( size_t nchunks, size_t nsub, size_t tsteps,
+                        int *status ) {
+
+  /* Local Variables */
+  FILE *fd = NULL;           /* File descriptor for results file */
+  ThrWorkForce *wf = NULL;   /* Pointer to a pool of worker threads */
+  char **kernel_list = NULL; /* Kernels to run */
+  char kernels[ 200 ];       /* Value of KERNELS parameter */
+  char results[ GRP__SZNAM + 1 ]; /* Name of results file */
+  const char *all[] = { "REBIN", "FILTER", "COM", "PCA", "MEDIAN",
+                        "FILLGAPS" }; /* Names of all the kernels */
+  dim_t col;                 /* Bolometer column */
+  dim_t ibolo;               /* Bolometer index */
+  dim_t itime;               /* Time slice index */
+  dim_t nbolo;               /* Number of bolometers per subarray */
+  dim_t row;                 /* Bolometer row */
+  double *comsig = NULL;     /* Common-mode signal */
+  double *dat;               /* Pointer to data values */
+  double *noise = NULL;      /* 1/f noise time stream */
+  double nsamp;              /* Total number of samples processed */
+  double rate;               /* Samples per second */
+  double secs;               /* Elapsed time for a kernel */
+  int **luts = NULL;         /* Pointing look-up tables for REBIN */
+  int ithr;                  /* Index into thread counts */
+  int nkernel;               /* Number of kernels to run */
+  int nthr;                  /* Number of thread counts */
+  int threads[ SMF__BENCH_MAXTHR ]; /* Thread counts to test */
+  int ik;                    /* Kernel index */
+  int *lut;                  /* Pointer to a single LUT */
+  smfArray **res = NULL;     /* Array of smfArrays of test data */
+  smfData *data = NULL;      /* Pointer to SCUBA2 data struct */
+  smf_qual_t *qua;           /* Pointer to quality values */
+  size_t i;                  /* Loop counter */
+  size_t j;                  /* Loop counter */
+  struct timeval tv1, tv2;   /* Timers */
+
+  if( *status != SAI__OK ) return;
+
+  /* Get the benchmark parameters */
+  parGet0c( "KERNELS", kernels, sizeof( kernels ), status );
+  parGet1i( "THREADS", SMF__BENCH_MAXTHR, threads, &nthr, status );
+  for( ithr = 0; ithr < nthr && *status == SAI__OK; ithr++ ) {
+    if( threads[ ithr ] < 1 ) {
+      *status = SAI__ERROR;
+      errRepf( "", TASK_NAME ": Illegal thread count %d in THREADS.",
+               status, threads[ ithr ] );
+    }
+  }
+
+  /* Split the list of kernels, replacing "ALL" with the full list, and
+     check each one is known. */
+  if( *status == SAI__OK ) {
+    astChrCase( NULL, kernels, 1, 0 );
+    if( astChrMatch( kernels, "ALL" ) ) {
+      nkernel = sizeof( all )/sizeof( all[ 0 ] );
+      kernel_list = astMalloc( nkernel*sizeof( *kernel_list ) );
+      for( ik = 0; ik < nkernel && *status == SAI__OK; ik++ ) {
+        kernel_list[ ik ] = astStore( NULL, all[ ik ],
+                                      strlen( all[ ik ] ) + 1 );
+      }
+    } else {
+      kernel_list = astChrSplitC( kernels, ',', &nkernel );
+    }
+
+    for( ik = 0; ik < nkernel && *status == SAI__OK; ik++ ) {
+      astRemoveLeadingBlanks( kernel_list[ ik ] );
+      astChrTrunc( kernel_list[ ik ] );
+      for( i = 0; i < sizeof( all )/sizeof( all[ 0 ] ); i++ ) {
+        if( !strcmp( kernel_list[ ik ], all[ i ] ) ) break;
+      }
+      if( i == sizeof( all )/sizeof( all[ 0 ] ) ) {
+        *status = SAI__ERROR;
+        errRepf( "", TASK_NAME ": Unknown kernel '%s' in KERNELS.",
+                 status, kernel_list[ ik ] );
+      }
+    }
+  }
+
+  /* Open the results file, if required. */
+  parGet0c( "RESULTS", results, sizeof( results ), status );
+  if( *status == PAR__NULL ) {
+    errAnnul( status );
+  } else if( *status == SAI__OK ) {
+    fd = fopen( results, "w" );
+    if( !fd ) {
+      *status = SAI__ERROR;
+      errRepf( "", TASK_NAME ": Failed to open results file '%s'.",
+               status, results );
+    } else {
+      fprintf( fd, "# kernel nthread nbolo ntslice nchunk seconds "
+               "samples_per_sec samples_per_sec_per_thread\n" );
+    }
+  }
+
+  /* Create the synthetic data. Each bolometer contains an independent
+     realisation of 1/f noise plus a common-mode signal, with a short
+     flagged gap every SMF__BENCH_GAPSEP time slices. The data are
+     bolometer ordered, as used by most of the map-maker. Also create a
+     look-up table that scans each subarray across the map. */
+  if( tsteps <= SMF__BENCH_MEDBOX && *status == SAI__OK ) {
+    *status = SAI__ERROR;
+    errRepf( "", TASK_NAME ": TSTEPS must be greater than %d when BENCH "
+             "is TRUE.", status, SMF__BENCH_MEDBOX );
+  }
+
+  msgOutf( "", TASK_NAME ": Creating %zu subarrays of synthetic data "
+           "with %zu chunks * %zu samples", status, nsub, nchunks, tsteps );
+  srand( SMF__BENCH_SEED );
+
+  nbolo = 40*32;
+  res = astCalloc( nchunks, sizeof( *res ) );
+  luts = astCalloc( nchunks*nsub, sizeof( *luts ) );
+  noise = astMalloc( tsteps*sizeof( *noise ) );
+  comsig = astMalloc( tsteps*sizeof( *comsig ) );
+
+  if( *status == SAI__OK ) {
+    for( itime = 0; itime < tsteps; itime++ ) {
+      comsig[ itime ] = 10.0*sin( 2.0*AST__DPI*itime/500.0 );
+    }
+  }
+
+  for( i = 0; i < nchunks && *status == SAI__OK; i++ ) {
+    res[ i ] = smf_create_smfArray( status );
+
+    for( j = 0; j < nsub && *status == SAI__OK; j++ ) {
+      data = smf_create_smfData( SMF__NOCREATE_FILE | SMF__NOCREATE_DA |
+                                 SMF__NOCREATE_FTS, status );
+      if( *status == SAI__OK ) {
+        data->dtype = SMF__DOUBLE;
+        data->ndims = 3;
+        data->dims[ 0 ] = (dim_t) tsteps;
+        data->dims[ 1 ] = 40;
+        data->dims[ 2 ] = 32;
+        data->isFFT = -1;
+        data->isTordered = 0;
+        data->hdr->steptime = 0.005;
+        data->pntr[ 0 ] = astMalloc( nbolo*tsteps*sizeof( double ) );
+        data->qual = astCalloc( nbolo*tsteps, sizeof( *data->qual ) );
+        luts[ i*nsub + j ] = astMalloc( nbolo*tsteps*sizeof( int ) );
+      }
+
+      dat = data ? data->pntr[ 0 ] : NULL;
+      qua = data ? data->qual : NULL;
+      lut = luts[ i*nsub + j ];
+
+      for( ibolo = 0; ibolo < nbolo && *status == SAI__OK; ibolo++ ) {
+        sc2sim_invf( 1.0, 1.0, 0.005, (int) tsteps, noise, status );
+        row = ibolo/40;
+        col = ibolo % 40;
+
+        for( itime = 0; itime < tsteps; itime++ ) {
+          dat[ ibolo*tsteps + itime ] = noise[ itime ] + comsig[ itime ];
+          if( ( itime % SMF__BENCH_GAPSEP ) < SMF__BENCH_GAP &&
+              itime > SMF__BENCH_GAP ) {
+            qua[ ibolo*tsteps + itime ] = SMF__Q_SPIKE;
+          }
+          lut[ ibolo*tsteps + itime ] =
+                    ( ( row + 20*j ) % SMF__BENCH_MAPDIM )*SMF__BENCH_MAPDIM +
+                    ( col + itime/10 ) % SMF__BENCH_MAPDIM;
+        }
+      }
+
+      smf_addto_smfArray( res[ i ], data, status );
+    }
+  }
+
+  /* Run each kernel with each thread count. Each kernel is run once
+     before timing starts, to initialise any plans or caches it uses
+     (e.g. FFTW plans). */
+  nsamp = (double) nchunks*nsub*nbolo*tsteps;
+  for( ithr = 0; ithr < nthr && *status == SAI__OK; ithr++ ) {
+    wf = thrCreateWorkforce( threads[ ithr ], status );
+
+    for( ik = 0; ik < nkernel && *status == SAI__OK; ik++ ) {
+      smf1_bench_run( wf, kernel_list[ ik ], res, nchunks, luts, status );
+
+      smf_timerinit( &tv1, &tv2, status );
+      smf1_bench_run( wf, kernel_list[ ik ], res, nchunks, luts, status );
+      secs = smf_timerupdate( &tv1, &tv2, status );
+
+      if( *status == SAI__OK ) {
+        rate = ( secs > 0.0 ) ? nsamp/secs : 0.0;
+        msgOutf( "", TASK_NAME ": %-8s %3d threads: %10.4f s  %12.4g "
+                 "samples/s  %12.4g samples/s/thread", status,
+                 kernel_list[ ik ], threads[ ithr ], secs, rate,
+                 rate/threads[ ithr ] );
+        if( fd ) {
+          fprintf( fd, "%s %d %" DIM_T_FMT " %zu %zu %.6f %.6g %.6g\n",
+                   kernel_list[ ik ], threads[ ithr ], nbolo, tsteps,
+                   nchunks, secs, rate, rate/threads[ ithr ] );
+          fflush( fd );
+        }
+      }
+    }
+
+    thrDestroyWorkforce( wf );
+    wf = NULL;
+  }
+
+  /* Clean up */
+  if( fd ) fclose( fd );
+
+  if( kernel_list ) {
+    for( ik = 0; ik < nkernel; ik++ ) {
+      kernel_list[ ik ] = astFree( kernel_list[ ik ] );
+    }
+    kernel_list = astFree( kernel_list );
+  }
+
+  if( luts ) {
+    for( i = 0; i < nchunks*nsub; i++ ) luts[ i ] = astFree( luts[ i ] );
+    luts = astFree( luts );
+  }
+
+  if( res ) {
+    for( i = 0; i < nchunks; i++ ) {
+      if( res[ i ] ) smf_close_related( NULL, &res[ i ], status );
+    }
+    res = astFree( res );
+  }
+
+  comsig = astFree( comsig );
+  noise = astFree( noise );
+
+  smf_fftw_cleanup( status );
+}
+
+/* --------------------------------------------------------------------------*/
+
 void smurf_sc2threadtest( int *status ) {
 
   /* Local Variables */
@@ -258,6 +719,7 @@ void smurf_sc2threadtest( int *status ) {
   size_t tsteps;             /* How many time steps in chunk */
   struct timeval tv1, tv2;   /* Timers */
   ThrWorkForce *wf = NULL;   /* Pointer to a pool of worker threads */
+  int bench;                 /* Run the kernel benchmarks? */
 
   double *dat=NULL;
   dim_t nbolo;
@@ -270,7 +732,6 @@ void smurf_sc2threadtest( int *status ) {
   if (*status != SAI__OK) return;
 
   /* Get input parameters */
-  parGdr0i( "NTHREAD", 1, 1, NUM__MAXI, 1, &nthread, status );
   parGdr0i( "TSTEPS", 6000, 0, NUM__MAXI, 1, &temp, status );
   tsteps = (size_t) temp;
   parGdr0i( "NCHUNKS", 1, 1, NUM__MAXI, 1, &temp, status );
@@ -278,6 +739,15 @@ void smurf_sc2threadtest( int *status ) {
   parGdr0i( "NSUB", 1, 1, 4, 1, &temp, status );
   nsub = (size_t) temp;
 
+  /* If requested, run the kernel benchmarks instead of the tests. */
+  parGet0l( "BENCH", &bench, status );
+  if( bench ) {
+    smf1_bench( nchunks, nsub, tsteps, status );
+    return;
+  }
+
+  parGdr0i( "NTHREAD", 1, 1, NUM__MAXI, 1, &nthread, status );
+
   msgSeti("N",nthread);
   msgOut( "", TASK_NAME ": Running test with ^N threads", status );
 
@@ -547,6 +1017,6 @@ void smurf_sc2threadtest( int *status ) {
   job_data = astFree( job_data );
 
   /* Ensure that FFTW doesn't have any used memory kicking around */
-  fftw_cleanup();
+  smf_fftw_cleanup( status );
 
 }
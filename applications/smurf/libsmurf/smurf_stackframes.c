@@ -91,10 +91,16 @@
 *     2011-09-21 (TIMJ):
 *        Force output type to be _DOUBLE because, currently, smf_open_file
 *        forces the 2D input files to be _DOUBLE regardless of type.
+*     2026-10-14:
+*        Map the input arrays directly with NDF rather than opening each
+*        file with smf_open_file, and copy a batch of planes into the
+*        output cube at a time using multiple threads. Accumulate the
+*        provenance in memory and write it out once.
 *     {enter_further_changes_here}
 
 *  Copyright:
 *     Copyright (C) 2009-2011 Science and Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -144,6 +150,21 @@
 #define FUNC_NAME "smurf_stackframes"
 #define TASK_NAME "STACKFRAMES"
 
+/* Local data types */
+typedef struct smfStackframesData {
+  const char *din;        /* Input data plane */
+  char *dout;             /* Output data plane */
+  const smf_qual_t *qin;  /* Input quality plane, or NULL */
+  smf_qual_t *qout;       /* Output quality plane */
+  size_t szplane;         /* Number of elements in a plane */
+  size_t szplaneb;        /* Number of bytes in a data plane */
+  const char *vin;        /* Input variance plane, or NULL */
+  char *vout;             /* Output variance plane */
+} smfStackframesData;
+
+/* Prototypes for local static functions. */
+static void smf1_stackframes( void *job_data_ptr, int *status );
+
 void smurf_stackframes( int *status ) {
 
   smf_qual_t badbit = 0;         /* Default bad bits mask */
@@ -154,8 +175,12 @@ void smurf_stackframes( int *status ) {
   Grp *igrp = NULL;              /* Input files */
   int indf;                      /* Input NDF identifer */
   int itemp;                     /* Temporary int */
+  size_t iw;                     /* Index into batch of files */
+  smfStackframesData *job_data = NULL; /* Array of job descriptions */
+  int *jndf = NULL;              /* Input NDF identifiers for a batch */
   int lbnd[NDF__MXDIM];          /* Lower bounds of output */
   char ndftype[NDF__SZTYP+1];    /* type of data array */
+  size_t nw;                     /* Number of files in a batch */
   Grp *ogrp = NULL;              /* Output group */
   char * odatad = NULL;          /* Output data array as bytes */
   smf_qual_t * odataq = NULL;    /* Output quality array */
@@ -164,6 +189,8 @@ void smurf_stackframes( int *status ) {
   int outndf;                    /* Output NDF file */
   size_t outsize;                /* Size of output group */
   AstFrameSet *outwcs;           /* Output frameset */
+  NdgProvenance *oprov = NULL;   /* Provenance for the output NDF */
+  smfStackframesData *pdata;     /* Pointer to next job description */
   void * pntr[3];                /* for ndfMap */
   dim_t refdims[NDF__MXDIM];     /* Reference dimensions */
   size_t refndims = 0;           /* Number of dims in first image */
@@ -179,12 +206,17 @@ void smurf_stackframes( int *status ) {
   AstLutMap *timemap = NULL;     /* Output time mapping */
   double * times = NULL;         /* Array of MJDs for each input file */
   int ubnd[NDF__MXDIM];          /* Upper bounds of output */
+  ThrWorkForce *wf = NULL;       /* Pointer to a pool of worker threads */
 
   if (*status != SAI__OK) return;
 
   /* Main routine */
   ndfBegin();
 
+  /* Find the number of cores/processors available and create a pool of
+     threads of the same size. */
+  wf = thrGetWorkforce( thrGetNThread( SMF__THREADS, status ), status );
+
   /* Read the input files (at least 2) */
   kpg1Rgndf( "IN", 0, 2, "Must provide at least 2 frames for stacking",
 	     &igrp, &size, status );
@@ -405,40 +437,85 @@ void smurf_stackframes( int *status ) {
   odatav = (outdata->pntr)[1];
   odataq = outdata->qual;
 
-  /* Read each file again to get the data but do not bother getting a
-     header this time around */
-  for (i = 1; i <= size; i++ ) {
-    smfData * data = NULL;
-    smf_open_file( NULL, igrp, sortinfo[i-1].index, "READ", SMF__NOCREATE_HEAD|SMF__NOTTSERIES, &data, status );
-    if (*status == SAI__OK && !smf_dtype_check( data, NULL, outdata->dtype, status ) ) {
-      *status = SAI__ERROR;
-      errRep("", "Input data type differs from output data type. Possible programming error.",
-             status );
-    }
-
-    if (*status != SAI__OK) break;
-    if (dosort) times[i-1] = sortinfo[i-1].sortval;
+  /* Read each file again to get the data. The input arrays are mapped
+     directly with the type of the output cube, so NDF does no conversion
+     when the input is already of that type. NDF can only be used from
+     this thread, so map a batch of files (one per worker thread), copy
+     their planes into the output cube in parallel, and then annul them. */
+  nw = wf ? wf->nworker : 1;
+  if (nw > size) nw = size;
+  job_data = astCalloc( nw, sizeof(*job_data) );
+  jndf = astMalloc( nw*sizeof(*jndf) );
+  one_strlcpy( ndftype, smf_dtype_string( outdata, status ), sizeof(ndftype),
+               status );
+
+  for (i = 1; i <= size && *status == SAI__OK; i += nw ) {
+    size_t nbatch = nw;
+    if ( i + nbatch - 1 > size ) nbatch = size - i + 1;
+    for (iw = 0; iw < nbatch; iw++ ) jndf[iw] = NDF__NOID;
+
+    for (iw = 0; iw < nbatch && *status == SAI__OK; iw++ ) {
+      size_t ifile = i + iw;
+      int there = 0;
+      pdata = job_data + iw;
+
+      ndgNdfas( igrp, sortinfo[ifile-1].index, "READ", &(jndf[iw]), status );
+      if (dosort) times[ifile-1] = sortinfo[ifile-1].sortval;
+
+      ndfMap( jndf[iw], "DATA", ndftype, "READ", pntr, &itemp, status );
+      pdata->din = pntr[0];
+
+      ndfState( jndf[iw], "VARIANCE", &there, status );
+      pdata->vin = NULL;
+      if (there) {
+        ndfMap( jndf[iw], "VARIANCE", ndftype, "READ", pntr, &itemp, status );
+        pdata->vin = pntr[0];
+      }
 
-    /* copy data to slice */
-    if ( odatad && (data->pntr)[0] ) {
-      memcpy( odatad, (data->pntr)[0], szplaneb );
-      odatad += szplaneb;
+      ndfState( jndf[iw], "QUALITY", &there, status );
+      pdata->qin = NULL;
+      if (there) pdata->qin = smf_qual_map( NULL, jndf[iw], "READ", NULL, NULL,
+                                            status );
+
+      /* Output planes for this file */
+      pdata->dout = odatad ? odatad + (ifile-1)*szplaneb : NULL;
+      pdata->vout = odatav ? odatav + (ifile-1)*szplaneb : NULL;
+      pdata->qout = odataq ? odataq + (ifile-1)*szplane : NULL;
+      pdata->szplane = szplane;
+      pdata->szplaneb = szplaneb;
+
+      /* output metadata */
+      smf_updateprov( outdata->file->ndfid, NULL, jndf[iw], "SMURF:" TASK_NAME,
+                      &oprov, status );
     }
-    if ( odatav && (data->pntr)[1] ) {
-      memcpy( odatav, (data->pntr)[1], szplaneb );
-      odatav += szplaneb;
+
+    /* Copy the planes into the output cube */
+    if (*status == SAI__OK) {
+      for (iw = 0; iw < nbatch; iw++ ) {
+        thrAddJob( wf, 0, job_data + iw, smf1_stackframes, 0, NULL, status );
+      }
+      thrWait( wf, status );
     }
-    if ( odataq && data->qual ) {
-      memcpy( odataq, data->qual, szplane * sizeof(*odataq) );
-      odataq += szplane; /* increment by number of elements */
+
+    /* Release the input files */
+    for (iw = 0; iw < nbatch; iw++ ) {
+      pdata = job_data + iw;
+      if (pdata->qin) pdata->qin = astFree( (smf_qual_t *) pdata->qin );
+      pdata->din = NULL;
+      pdata->vin = NULL;
+      if (jndf[iw] != NDF__NOID) ndfAnnul( &(jndf[iw]), status );
     }
-    /* output metadata */
-    smf_accumulate_prov( data, igrp, sortinfo[i-1].index, outdata->file->ndfid,
-                         "SMURF:" TASK_NAME, NULL, status );
+  }
 
-    smf_close_file( NULL, &data, status );
+  /* Flush the provenance */
+  if (oprov) {
+    ndgWriteProv( oprov, outdata->file->ndfid, 1, status );
+    oprov = ndgFreeProv( oprov, status );
   }
 
+  job_data = astFree( job_data );
+  jndf = astFree( jndf );
+
   /* Now need to sort out the WCS */
 
   if (dosort) {
@@ -492,3 +569,41 @@ void smurf_stackframes( int *status ) {
   ndfEnd(status);
 
 }
+
+static void smf1_stackframes( void *job_data_ptr, int *status ) {
+/*
+*  Name:
+*     smf1_stackframes
+
+*  Purpose:
+*     Executed in a worker thread to copy one input image into the
+*     output cube.
+
+*  Invocation:
+*     smf1_stackframes( void *job_data_ptr, int *status )
+
+*  Arguments:
+*     job_data_ptr = smfStackframesData * (Given)
+*        Data structure describing the job to be performed by the worker
+*        thread.
+*     status = int * (Given and Returned)
+*        Inherited status.
+
+*/
+
+  smfStackframesData *pdata;
+
+  if (*status != SAI__OK) return;
+
+  pdata = (smfStackframesData *) job_data_ptr;
+
+  if ( pdata->dout && pdata->din ) {
+    memcpy( pdata->dout, pdata->din, pdata->szplaneb );
+  }
+  if ( pdata->vout && pdata->vin ) {
+    memcpy( pdata->vout, pdata->vin, pdata->szplaneb );
+  }
+  if ( pdata->qout && pdata->qin ) {
+    memcpy( pdata->qout, pdata->qin, pdata->szplane * sizeof(*(pdata->qout)) );
+  }
+}
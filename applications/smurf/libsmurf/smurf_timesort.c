@@ -49,6 +49,14 @@
 *
 *     MERGE = TRUE should be used to sort the time slices contained in a
 *     set of sub-scans from a sub-system.
+*
+*     The data arrays are not held in memory in full. Instead, the
+*     output time slices are written out in blocks, and the input time
+*     slices are read through a window of consecutive time slices in
+*     each input NDF, so that the memory used is limited by parameter
+*     MAXMEM regardless of the length of the observation. If MERGE is
+*     FALSE and an input NDF is already in time order, its arrays are
+*     propagated to the output without being re-ordered.
 
 *  ADAM Parameters:
 *     DETECTORS = LITERAL (Read)
@@ -95,6 +103,13 @@
 *          the NDF. Consequently, the actual file size may be a little
 *          larger than the requested size because of the extra
 *          information held in NDF extensions. ["FILESIZE"]
+*     MAXMEM = _INTEGER (Read)
+*          The maximum amount of memory, in megabytes, to use for holding
+*          input and output time slices. Half is used for the block of
+*          output time slices currently being written, and half is shared
+*          between the windows of time slices read from the input NDFs.
+*          Smaller values reduce the memory used when sorting long
+*          observations, at the cost of more NDF section accesses. [512]
 *     MERGE = _LOGICAL (Read)
 *          If FALSE, then each input NDF is sorted independently of the
 *          other input NDFs, and the sorted data for each input NDF is
@@ -238,10 +253,16 @@
 *        avoids a GRP__INVID error in such cases.
 *     12-JAN-2015 (DSB):
 *        Added parameter SPECBND.
+*     14-OCT-2026:
+*        Added parameter MAXMEM. Copy the data arrays in blocks of time
+*        slices, reading the input through a window of time slices,
+*        rather than mapping one section of each NDF for every time slice
+*        (MERGE = TRUE) or mapping the whole of each array (MERGE = FALSE).
 
 *  Copyright:
 *     Copyright (C) 2007-2009,2012,2015 Science and Technology Facilities Council.
 *     Copyright (C) 2013 University of British Columbia.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -295,6 +316,26 @@
 /* Number of ACSIS extension components that need to be re-ordered. */
 #define NACSIS 3
 
+/* A window of consecutive time slices mapped from an input NDF. */
+typedef struct smfTimesortWindow {
+   int indf;           /* Identifier for the mapped section, or NDF__NOID */
+   int lo;             /* Zero-based index of first mapped time slice */
+   int hi;             /* Zero-based index of last mapped time slice */
+   float *data;        /* Mapped Data values */
+   float *var;         /* Mapped Variance values, or NULL */
+   char *qual;         /* Mapped Quality values, or NULL */
+} smfTimesortWindow;
+
+/* Prototypes for local static functions. */
+static void smf__timesort_read( int indf, int islice, int nslice, int nwin,
+                                const int lbnd[ 3 ], const int ubnd[ 3 ],
+                                const char *comps, int hasqual,
+                                smfTimesortWindow *win, int *status );
+static void smf__timesort_stream( int indf1, int indf2, const char *comp,
+                                  const int idims[ 3 ], const int index[],
+                                  const int mask[], double maxbytes,
+                                  int *status );
+
 void smurf_timesort( int *status ) {
 
 /* Local Variables */
@@ -324,6 +365,7 @@ void smurf_timesort( int *status ) {
    HDSLoc *loc2c = NULL;
    char *match = NULL;
    char *pname = NULL;
+   char *qblk_out = NULL;
    char *qts_in;
    char *qts_out;
    char basename[ GRP__SZNAM + 1 ];
@@ -348,15 +390,20 @@ void smurf_timesort( int *status ) {
    double *tai_ptr = NULL;
    double *taiout = NULL;
    double *vp;
+   double dslice;
    double fcon;
+   double maxbytes;
+   double slicebytes;
    double ina;
    double inb;
    double invar;
    double outa;
    double outb;
    double tcon;
+   float *dblk_out = NULL;
    float *dts_in;
    float *dts_out;
+   float *vblk_out = NULL;
    float *vts_in;
    float *vts_out;
    float teff;
@@ -385,6 +432,7 @@ void smurf_timesort( int *status ) {
    int hasqual;
    int hasvar;
    int i;
+   int islice;
    int ichan;
    int idet;
    int iel;
@@ -394,6 +442,7 @@ void smurf_timesort( int *status ) {
    int indf2;
    int indf2s;
    int init;
+   int inslice;
    int iobs;
    int iout;
    int ioutname;
@@ -407,9 +456,11 @@ void smurf_timesort( int *status ) {
    int lbnd[ 3 ];
    int lchan;
    int ldet;
+   int maxmem;
    int maxsyspop;
    int merge;
    int nbaddet;
+   int nblk;
    int nchan;
    int ncomp;
    int ndet;
@@ -424,6 +475,8 @@ void smurf_timesort( int *status ) {
    int nts_in;
    int nts_out;
    int nullsizelimit;
+   int nwin;
+   int oel;
    int ok;
    int place;
    int rts_num0;
@@ -439,12 +492,15 @@ void smurf_timesort( int *status ) {
    int ubnd[ 3 ];
    int uchan;
    int udet;
+   int wlbnd[ 3 ];
+   int wubnd[ 3 ];
    size_t len;
    size_t ndetgrp;
    size_t ntai;
    size_t outsize;
    size_t size;
    smfData *data = NULL;
+   smfTimesortWindow *win = NULL;
    void *ipin;
    void *ipout;
    void *ptr[2];
@@ -574,6 +630,11 @@ void smurf_timesort( int *status ) {
    merged input data. */
    parGet0l( "MERGE", &merge, status );
 
+/* Get the maximum amount of memory to use for holding time slices, and
+   convert from megabytes to bytes. */
+   parGdr0i( "MAXMEM", 512, 1, VAL__MAXI, 1, &maxmem, status );
+   maxbytes = maxmem*1.0E6;
+
 /* First handle cases where we are sorting individual input files. */
 /* =============================================================== */
    if( !merge ) {
@@ -644,14 +705,21 @@ void smurf_timesort( int *status ) {
                ndfSbnd( 3, lbnd, ubnd, indf2, status );
             }
 
-/* Re-order the Data and Variance arrays (if they exist). */
+/* Re-order the Data and Variance arrays (if they exist). If the input
+   and output arrays both fit within the memory limit, map them in full
+   and re-order them in one go. Otherwise, copy them a block of time
+   slices at a time. */
+            slicebytes = 2.0*VAL__NBR*idims[ 0 ]*idims[ 1 ];
             for( i = 0; i < 2 && *status == SAI__OK; i++ ) {
                ndfState( indf1, comp[ i ], &there, status );
-               if( there ) {
+               if( there && slicebytes*idims[ 2 ] <= maxbytes ) {
                   ndfMap( indf1, comp[ i ], "_REAL", "READ", &ipin, &el, status );
                   ndfMap( indf2, comp[ i ], "_REAL", "WRITE", &ipout, &el, status );
                   smf_reorderF( (float *) ipin, 1, ndim, idims, 2, index, 1,
                                 mask, (float *) ipout, status );
+               } else if( there ) {
+                  smf__timesort_stream( indf1, indf2, comp[ i ], idims,
+                                        index, mask, maxbytes, status );
                }
             }
 
@@ -1335,6 +1403,45 @@ void smurf_timesort( int *status ) {
             subnd[ 0 ] = uchan;
             subnd[ 1 ] = ndet_out;
 
+/* Find the number of output time slices to map at once, using half the
+   memory limit. */
+            slicebytes = (double) ndet_out*nchan*( VAL__NBR*( hasvar ? 2 : 1 ) +
+                                                  ( hasqual ? VAL__NBUB : 0 ) );
+            dslice = ( slicebytes > 0.0 ) ? 0.5*maxbytes/slicebytes : 1.0;
+            nblk = ( dslice < tslimit ) ? (int) dslice : tslimit;
+            if( nblk < 1 ) nblk = 1;
+
+/* The other half is shared between windows of time slices read from
+   each input NDF. Keeping a window for each input NDF means that time
+   slices merged from different sub-scans do not cause the windows to be
+   re-mapped repeatedly. */
+            slicebytes = (double) ndet*nchan*( VAL__NBR*( hasvar ? 2 : 1 ) +
+                                              ( hasqual ? VAL__NBUB : 0 ) );
+            dslice = ( slicebytes > 0.0 ) ?
+                     0.5*maxbytes/( nsubscan*slicebytes ) : 1.0;
+            nwin = ( dslice < nts_in ) ? (int) dslice : nts_in;
+            if( nwin < 1 ) nwin = 1;
+
+            win = astMalloc( sizeof( *win )*nsubscan );
+            if( win ) {
+               for( isubscan = 0; isubscan < nsubscan; isubscan++ ) {
+                  win[ isubscan ].indf = NDF__NOID;
+               }
+            }
+
+/* The bounds of the input time slices on the spectral and detector
+   axes. */
+            wlbnd[ 0 ] = lchan;
+            wlbnd[ 1 ] = 1;
+            wlbnd[ 2 ] = 1;
+            wubnd[ 0 ] = uchan;
+            wubnd[ 1 ] = ndet;
+            wubnd[ 2 ] = 1;
+
+            msgOutiff( MSG__DEBUG, "", "Writing blocks of %d time slices and "
+                       "reading windows of %d time slices.", status, nblk,
+                       nwin );
+
 /* The number of time slices remaining to be written out. */
             nrem = nts_out;
 
@@ -1408,27 +1515,44 @@ void smurf_timesort( int *status ) {
                j0 = j;
 
 /* Loop round each output time slice. */
+               indf2s = NDF__NOID;
                for( k = 0; k < ubnd[ 2 ]  && *status == SAI__OK; k++ ) {
 
-/* Get a section of the output NDF covering this time slice. */
-                  slbnd[ 2 ] = k + 1;
-                  subnd[ 2 ] = k + 1;
-                  ndfSect( indf2, 3, slbnd, subnd, &indf2s, status );
+/* At the start of each block of output time slices, annul the section
+   holding the previous block, and get a section of the output NDF
+   covering the new block. */
+                  if( k % nblk == 0 ) {
+                     if( indf2s != NDF__NOID ) ndfAnnul( &indf2s, status );
+
+                     slbnd[ 1 ] = 1;
+                     subnd[ 1 ] = ndet_out;
+                     slbnd[ 2 ] = k + 1;
+                     subnd[ 2 ] = k + nblk;
+                     if( subnd[ 2 ] > ubnd[ 2 ] ) subnd[ 2 ] = ubnd[ 2 ];
+                     ndfSect( indf2, 3, slbnd, subnd, &indf2s, status );
 
 /* Map the required output NDF section array components. */
-                  ndfMap( indf2s, comps, "_REAL", "WRITE", ptr, &el,
-                          status );
-                  dts_out = ptr[ 0 ];
-                  vts_out = hasvar ? ptr[ 1 ] : NULL;
-
-                  if( hasqual ) {
-                     ndfMap( indf2s, "Quality", "_UBYTE", "WRITE", ptr,
-                             &el, status );
-                     qts_out = ptr[ 0 ];
-                  } else {
-                     qts_out = NULL;
+                     ndfMap( indf2s, comps, "_REAL", "WRITE", ptr, &el,
+                             status );
+                     dblk_out = ptr[ 0 ];
+                     vblk_out = hasvar ? ptr[ 1 ] : NULL;
+
+                     if( hasqual ) {
+                        ndfMap( indf2s, "Quality", "_UBYTE", "WRITE", ptr,
+                                &el, status );
+                        qblk_out = ptr[ 0 ];
+                     } else {
+                        qblk_out = NULL;
+                     }
+                     if( *status != SAI__OK ) break;
                   }
 
+/* Get pointers to the first output value for this time slice. */
+                  oel = ( k % nblk )*ndet_out*nchan;
+                  dts_out = dblk_out + oel;
+                  vts_out = vblk_out ? vblk_out + oel : NULL;
+                  qts_out = qblk_out ? qblk_out + oel : NULL;
+
 /* Store the input time slice index for this output time slice. */
                   itimeout[ k ] = i;
 
@@ -1447,26 +1571,21 @@ void smurf_timesort( int *status ) {
    value was read. */
                      isubscan = file_index[ i ];
 
-/* Get a section of the input NDF covering this time slice. */
-                     slbnd[ 1 ] = 1;
-                     subnd[ 1 ] = ndet;
-                     slbnd[ 2 ] = i  - first[ isubscan ] + 1;
-                     subnd[ 2 ] = slbnd[ 2 ];
-                     ndfSect( ndfid[ isubscan ], 3, slbnd, subnd, &indf1s,
-                              status );
-
-/* Map the required input NDF section array components. */
-                     ndfMap( indf1s, comps, "_REAL", "READ",  ptr, &el, status );
-                     dts_in = ptr[ 0 ];
-                     vts_in = hasvar ? ptr[ 1 ] : NULL;
-
-                     if( hasqual ) {
-                        ndfMap( indf1s, "Quality", "_UBYTE", "READ", ptr,
-                                &el, status );
-                        qts_in = ptr[ 0 ];
-                     } else {
-                        qts_in = NULL;
-                     }
+/* Ensure this time slice is within the window of time slices mapped
+   from the input NDF, and get pointers to its first values. */
+                     islice = i - first[ isubscan ];
+                     inslice = ( isubscan < nsubscan - 1 ) ?
+                               first[ isubscan + 1 ] : nts_in;
+                     inslice -= first[ isubscan ];
+                     smf__timesort_read( ndfid[ isubscan ], islice, inslice,
+                                         nwin, wlbnd, wubnd, comps, hasqual,
+                                         win + isubscan, status );
+                     if( *status != SAI__OK ) break;
+
+                     iel = ( islice - win[ isubscan ].lo )*ndet*nchan;
+                     dts_in = win[ isubscan ].data + iel;
+                     vts_in = hasvar ? win[ isubscan ].var + iel : NULL;
+                     qts_in = hasqual ? win[ isubscan ].qual + iel : NULL;
 
 /* Initialise the vector index of the next output element */
                      jel = 0;
@@ -1534,9 +1653,6 @@ void smurf_timesort( int *status ) {
                         detbit <<= 1;
                      }
 
-/* Annul the identifier for the current time slice in the input NDF. */
-                     ndfAnnul( &indf1s, status );
-
 /* Move on to the next input time slice. */
                      if( ++j < nts_in ) {
                         i = index[ j ];
@@ -1548,10 +1664,11 @@ void smurf_timesort( int *status ) {
                      }
                   }
 
-/* Annul the identifier for the current time slice in the output NDF. */
-                  ndfAnnul( &indf2s, status );
                }
 
+/* Annul the identifier for the last block of output time slices. */
+               if( indf2s != NDF__NOID ) ndfAnnul( &indf2s, status );
+
 /* Merge the extension values stored for each input time slice with the
    extension values for the first time slice that referred to the same
    RTS_NUM value. For most items the extension values should be the same
@@ -1638,6 +1755,16 @@ void smurf_timesort( int *status ) {
 /* Record the number of output time slices created for this sub-system. */
             nsysrts[ isubsys ] = l;
 
+/* Annul the windows of input time slices. */
+            if( win ) {
+               for( isubscan = 0; isubscan < nsubscan; isubscan++ ) {
+                  if( win[ isubscan ].indf != NDF__NOID ) {
+                     ndfAnnul( &(win[ isubscan ].indf), status );
+                  }
+               }
+               win = astFree( win );
+            }
+
 /* Free resources. */
             ndfid = astFree( ndfid );
             taiout = astFree( taiout );
@@ -1787,3 +1914,218 @@ void smurf_timesort( int *status ) {
    }
 }
 
+
+static void smf__timesort_read( int indf, int islice, int nslice, int nwin,
+                                const int lbnd[ 3 ], const int ubnd[ 3 ],
+                                const char *comps, int hasqual,
+                                smfTimesortWindow *win, int *status ){
+/*
+*  Name:
+*     smf__timesort_read
+
+*  Purpose:
+*     Ensure a time slice is mapped within a window of input time slices.
+
+*  Description:
+*     If the requested time slice is not within the window of time slices
+*     that is currently mapped from the supplied NDF, the window is
+*     annulled, and the aligned block of "nwin" time slices that contains
+*     the requested time slice is mapped instead. Aligned blocks are used
+*     so that inputs that are in forward or reverse time order are each
+*     read one window at a time.
+
+*  Arguments:
+*     indf = int (Given)
+*        Identifier for the input NDF.
+*     islice = int (Given)
+*        Zero-based index of the required time slice.
+*     nslice = int (Given)
+*        The number of time slices in the input NDF.
+*     nwin = int (Given)
+*        The maximum number of time slices in a window.
+*     lbnd = const int[ 3 ] (Given)
+*        The lower pixel bounds of the window on the spectral and detector
+*        axes, followed by the pixel index of the first time slice.
+*     ubnd = const int[ 3 ] (Given)
+*        The upper pixel bounds of the window on the spectral and detector
+*        axes. The third element is ignored.
+*     comps = const char * (Given)
+*        The array components to map as _REAL: "Data", "Variance" or
+*        "Data,Variance". The first is returned in the "data" component
+*        of "win", and the second (if any) in the "var" component.
+*     hasqual = int (Given)
+*        Should the Quality array be mapped?
+*     win = smfTimesortWindow * (Given and Returned)
+*        The window. The "indf" component should be NDF__NOID on the first
+*        call.
+*     status = int * (Given and Returned)
+*        Inherited status.
+*/
+
+/* Local Variables: */
+   int el;
+   int slbnd[ 3 ];
+   int subnd[ 3 ];
+   void *ptr[ 2 ];
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Do nothing if the time slice is already mapped. */
+   if( win->indf != NDF__NOID && islice >= win->lo &&
+       islice <= win->hi ) return;
+
+/* Annul any previous window. */
+   if( win->indf != NDF__NOID ) ndfAnnul( &(win->indf), status );
+
+/* Find the block of time slices to map. */
+   win->lo = ( islice/nwin )*nwin;
+   win->hi = win->lo + nwin - 1;
+   if( win->hi >= nslice ) win->hi = nslice - 1;
+
+/* Get a section of the input NDF covering the window, and map it. */
+   slbnd[ 0 ] = lbnd[ 0 ];
+   slbnd[ 1 ] = lbnd[ 1 ];
+   slbnd[ 2 ] = lbnd[ 2 ] + win->lo;
+   subnd[ 0 ] = ubnd[ 0 ];
+   subnd[ 1 ] = ubnd[ 1 ];
+   subnd[ 2 ] = lbnd[ 2 ] + win->hi;
+   ndfSect( indf, 3, slbnd, subnd, &(win->indf), status );
+
+   ndfMap( win->indf, comps, "_REAL", "READ", ptr, &el, status );
+   win->data = ptr[ 0 ];
+   win->var = strchr( comps, ',' ) ? ptr[ 1 ] : NULL;
+
+   if( hasqual ) {
+      ndfMap( win->indf, "Quality", "_UBYTE", "READ", ptr, &el, status );
+      win->qual = ptr[ 0 ];
+   } else {
+      win->qual = NULL;
+   }
+
+/* Annul the window if anything went wrong. */
+   if( *status != SAI__OK && win->indf != NDF__NOID ) {
+      ndfAnnul( &(win->indf), status );
+   }
+}
+
+static void smf__timesort_stream( int indf1, int indf2, const char *comp,
+                                  const int idims[ 3 ], const int index[],
+                                  const int mask[], double maxbytes,
+                                  int *status ){
+/*
+*  Name:
+*     smf__timesort_stream
+
+*  Purpose:
+*     Re-order an array component a block of time slices at a time.
+
+*  Description:
+*     Each block of output time slices is mapped in turn, and filled
+*     by copying the spectra of the corresponding input time slices,
+*     which are read through a window of time slices. Half of "maxbytes"
+*     is used for each.
+
+*  Arguments:
+*     indf1 = int (Given)
+*        Identifier for the input NDF.
+*     indf2 = int (Given)
+*        Identifier for the output NDF.
+*     comp = const char * (Given)
+*        The array component to re-order ("DATA" or "VARIANCE").
+*     idims = const int[ 3 ] (Given)
+*        The dimensions of the input NDF.
+*     index = const int[] (Given)
+*        The zero-based input time slice for each output time slice.
+*     mask = const int[] (Given)
+*        Flags indicating which detectors to copy. May be NULL, in which
+*        case all detectors are copied.
+*     maxbytes = double (Given)
+*        The maximum number of bytes to map at once.
+*     status = int * (Given and Returned)
+*        Inherited status.
+*/
+
+/* Local Variables: */
+   const float *pin;
+   double nslices;
+   float *dout;
+   int el;
+   int idet;
+   int indf2s;
+   int k;
+   int lbnd[ 3 ];
+   int nblk;
+   int ndim;
+   int nwin;
+   int olbnd[ 3 ];
+   int oubnd[ 3 ];
+   int slbnd[ 3 ];
+   int subnd[ 3 ];
+   int ubnd[ 3 ];
+   size_t ivol;
+   smfTimesortWindow win;
+   void *ptr[ 1 ];
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Get the bounds of the input and output NDFs. */
+   ndfBound( indf1, 3, lbnd, ubnd, &ndim, status );
+   ndfBound( indf2, 3, olbnd, oubnd, &ndim, status );
+
+/* The number of values in each input time slice. */
+   ivol = (size_t) idims[ 0 ]*idims[ 1 ];
+
+/* The number of time slices in each output block and in the input
+   window. */
+   nslices = ( ivol > 0 ) ? 0.5*maxbytes/( VAL__NBR*ivol ) : 1.0;
+   nblk = ( nslices < idims[ 2 ] ) ? (int) nslices : idims[ 2 ];
+   if( nblk < 1 ) nblk = 1;
+   nwin = nblk;
+
+/* The input window covers all channels and detectors. */
+   win.indf = NDF__NOID;
+
+   slbnd[ 0 ] = olbnd[ 0 ];
+   slbnd[ 1 ] = olbnd[ 1 ];
+   subnd[ 0 ] = oubnd[ 0 ];
+   subnd[ 1 ] = oubnd[ 1 ];
+
+/* Loop round each output time slice. */
+   indf2s = NDF__NOID;
+   dout = NULL;
+   for( k = 0; k < idims[ 2 ] && *status == SAI__OK; k++ ) {
+
+/* At the start of each block, write out the previous block and map the
+   next one. */
+      if( k % nblk == 0 ) {
+         if( indf2s != NDF__NOID ) ndfAnnul( &indf2s, status );
+         slbnd[ 2 ] = olbnd[ 2 ] + k;
+         subnd[ 2 ] = olbnd[ 2 ] + k + nblk - 1;
+         if( subnd[ 2 ] > oubnd[ 2 ] ) subnd[ 2 ] = oubnd[ 2 ];
+         ndfSect( indf2, 3, slbnd, subnd, &indf2s, status );
+         ndfMap( indf2s, comp, "_REAL", "WRITE", ptr, &el, status );
+         dout = ptr[ 0 ];
+      }
+
+/* Get the input time slice, reading a new window if required. */
+      smf__timesort_read( indf1, index[ k ], idims[ 2 ], nwin, lbnd, ubnd,
+                          comp, 0, &win, status );
+      if( *status != SAI__OK ) break;
+      pin = win.data + ( index[ k ] - win.lo )*ivol;
+
+/* Copy the spectrum of each required detector. */
+      for( idet = 0; idet < idims[ 1 ]; idet++ ) {
+         if( !mask || mask[ idet ] ) {
+            memcpy( dout, pin, idims[ 0 ]*sizeof( *dout ) );
+            dout += idims[ 0 ];
+         }
+         pin += idims[ 0 ];
+      }
+   }
+
+/* Free resources. */
+   if( indf2s != NDF__NOID ) ndfAnnul( &indf2s, status );
+   if( win.indf != NDF__NOID ) ndfAnnul( &(win.indf), status );
+}
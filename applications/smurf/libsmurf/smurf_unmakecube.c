@@ -150,6 +150,8 @@
 *        Use new NDG provenance API.
 *     2-SEP-2009 (DSB):
 *        Always initialise the output to hold bad values.
+*     14-OCT-2026:
+*        Resample each template in multiple threads.
 
 *  Copyright:
 *     Copyright (C) 2008-2009 Science and Technology Facilities Council.
@@ -197,6 +199,7 @@
 #include "star/grp.h"
 #include "star/atl.h"
 #include "star/kaplibs.h"
+#include "star/thr.h"
 
 
 /* SMURF includes */
@@ -236,6 +239,7 @@ void smurf_unmakecube( int *status ) {
    NdgProvenance *oprov = NULL;/* Provenance for the output NDF */
    SkyCube *sky_cubes = NULL; /* Pointer to array of sky cube descriptions */
    SkyCube *skycube = NULL;   /* Pointer to next sky cube description */
+   ThrWorkForce *wf = NULL;   /* Pointer to a pool of worker threads */
    char pabuf[ 10 ];          /* Text buffer for parameter value */
    double params[ 4 ];        /* astResample parameters */
    int axes[ 2 ];             /* Indices of selected axes */
@@ -275,6 +279,10 @@ void smurf_unmakecube( int *status ) {
 /* Begin an NDF context. */
    ndfBegin();
 
+/* Find the number of cores/processors available and create a pool of
+   threads of the same size. */
+   wf = thrGetWorkforce( thrGetNThread( SMF__THREADS, status ), status );
+
 /* Get a group holding the input sky cubes. */
    kpg1Rgndf( "IN", 0, 1, "", &igrp1, &nskycube, status );
 
@@ -491,7 +499,7 @@ void smurf_unmakecube( int *status ) {
          ndgPutProv( oprov, skycube->indf, NULL, 0, status );
 
 /* See if the current time series overlaps the current sky cube. */
-         smf_resampcube( data, skycube->abskyfrm,
+         smf_resampcube( wf, data, skycube->abskyfrm,
                          skycube->iskymap, skycube->ispecfrm,
                          skycube->ispecmap, detgrp, skycube->moving,
                          skycube->slbnd, skycube->subnd, interp,
@@ -509,7 +517,7 @@ void smurf_unmakecube( int *status ) {
                     status );
 
 /* Resample the cube data into the output time series. */
-            smf_resampcube( data, skycube->abskyfrm,
+            smf_resampcube( wf, data, skycube->abskyfrm,
                             skycube->iskymap, skycube->ispecfrm,
                             skycube->ispecmap, detgrp, skycube->moving,
                             skycube->slbnd, skycube->subnd, interp,
@@ -80,7 +80,8 @@ int gridpts[][2],       /* relative grid coordinates (given) */
 int gridwtsdim[],       /* dimensions of gridwts array (returned) */
 double **gridwts,       /* Pointer to array of sky grid weights (returned) */
 int *invmatdim,         /* dimension of inverted matrix (returned) */
-double **invmat,        /* pointer to inverted matrix (returned) */
+double **invmat,        /* pointer to inverted matrix, or NULL if not
+                           required (returned) */
 int *status             /* global status (given and returned) */
 )
 
@@ -117,6 +118,11 @@ int *status             /* global status (given and returned) */
      The ngrid pixel points are defined relative to the centre bolometer
      position.
 
+     If invmat is NULL only the grid weights are calculated and invmatdim
+     is returned as zero. The inversion takes a time which grows as the
+     cube of the number of unknowns, and is not needed if the images are
+     to be reconstructed with sc2math_mapsolvecg.
+
    Authors :
     H.W. van Someren Greve (greve@astron.nl)
 
@@ -130,6 +136,7 @@ int *status             /* global status (given and returned) */
      01May2008 : put into sc2math library (bdk)
      21May2008 : remove unnecessary variables, free par space and add ngrid to
                  the argument list (bdk)
+     14Oct2026 : allow the inverted matrix to be omitted
 */
 
 
@@ -228,6 +235,15 @@ int *status             /* global status (given and returned) */
    skywid = nbolx + xmax - xmin;
    skyheight = nboly + ymax - ymin;
 
+/* The iterative solution (sc2math_mapsolvecg) does not need the inverted
+   matrix, so only form it if it has been requested */
+
+   if ( invmat == NULL )
+   {
+      *invmatdim = 0;
+      return;
+   }
+
 /* Create the parameters of the problem equation for each measurement for
    each working bolometer and initialise the arrays to zero */
 
@@ -1322,14 +1338,17 @@ int *status               /* global status (given and returned) */
     26Aug2008 : trap for bad value in input data (timj)
     14Nov2008 : rearrange TABLE processing to make it a bit faster (timj)
     04Feb2010 : trap for bad values in polynomial coefficients (timj)
+    14Oct2026 : determine the TABLE calibration for all bolometers with
+                sc2math_setcalall and apply it frame by frame, rather
+                than copying out the time series of each bolometer
 */
 
 {
   int i;              /* loop counter */
   int j;              /* loop counter */
-  double lincal[2];   /* interpolation coeffs for a bolometer */
+  double *lincal;     /* interpolation coeffs for all bolometers */
+  double *pd;         /* pointer to data for current frame */
   double t;           /* intermediate result */
-  double *temp;       /* pointer to storage for a single bolometer */
   int ngood = 0;   /* number of bolometers flatfielded */
 
   if ( !StatusOkP(status) ) return 0;
@@ -1369,62 +1388,66 @@ int *status               /* global status (given and returned) */
     }
   else if ( strcmp ( "TABLE", flatname ) == 0 )
     {
-      /* do not need to use calloc since we immediately fill the array */
-      temp = malloc ( nframes * sizeof(*temp) );
+      /* Tailor the flatfield calibration coefficients for every
+         bolometer in a single pass through the data */
 
-      for ( i=0; i<nboll; i++ )
+      lincal = malloc ( 2 * nboll * sizeof(*lincal) );
+      if ( lincal == NULL )
         {
-
-          /* Get the time series for this bolometer and determine the interpolation
-             formula for its intensity conversion */
-
-          for ( j=0; j<nframes; j++ )
+          if ( StatusOkP(status) )
             {
-              temp[j] = inptr[j*nboll+i];
+              *status = DITS__APP_ERROR;
+              sprintf ( errmess, "sc2math_flatten: failed to allocate memory" );
+              ErsRep ( 0, status, errmess );
             }
+        }
+      else
+        {
+          sc2math_setcalall ( nboll, nframes, inptr, nflat, fpar, fcal,
+                              lincal, status );
+        }
 
-          /* Tailor the flatfield calibration coefficients */
-
-          sc2math_setcal ( nboll, i, nframes, temp, nflat, fpar, fcal,
-                           lincal, status );
+      if ( StatusOkP(status) )
+        {
 
-          /* Note that we are going to flatfield the temp[] array and
-             then copy it back into the raw data. This is more
-             efficient than examining and then modifying inptr[] since
-             you don't have to keep jumping around in memory (temp[]
-             is contiguous). */
+          /* Mark the bolometers with a bad calibration by setting both
+             coefficients bad, so that the frame loop need only test
+             one of them */
 
-          /* if the calibration is bad then we can set the output array to bad directly */
-          if ( (lincal[0] == VAL__BADD) ||
-               (lincal[1] == VAL__BADD) )
+          for ( i=0; i<nboll; i++ )
             {
-              for ( j=0; j<nframes; j++ )
+              if ( (lincal[2*i] == VAL__BADD) ||
+                   (lincal[2*i+1] == VAL__BADD) )
                 {
-                  temp[j] = VAL__BADD;
+                  lincal[2*i] = VAL__BADD;
+                }
+              else
+                {
+                  ngood++;
                 }
             }
-          else
-            {
 
-              /* apply flatfield for this bolometer in each frame */
-              ngood++;
-              for ( j=0; j<nframes; j++ )
+          /* apply the flatfield to each bolometer in each frame. The
+             whole time series of a bolometer with a bad calibration is
+             set bad. */
+
+          for ( j=0; j<nframes; j++ )
+            {
+              pd = inptr + (size_t)j*nboll;
+              for ( i=0; i<nboll; i++ )
                 {
-                  if (temp[j] != VAL__BADD)
+                  if ( lincal[2*i] == VAL__BADD )
+                    {
+                      pd[i] = VAL__BADD;
+                    }
+                  else if ( pd[i] != VAL__BADD )
                     {
-                      temp[j] = temp[j] * lincal[1]
-                        + lincal[0];
+                      pd[i] = pd[i] * lincal[2*i+1] + lincal[2*i];
                     }
                 }
             }
-          /* now copy the answer back into the raw data cube */
-          for ( j = 0; j<nframes; j++)
-            {
-              inptr[j*nboll+i] = temp[j];
-            }
-
         }
-      free ( temp );
+      free ( lincal );
     }
   else if ( strcmp ( "NULL", flatname ) == 0 )
     {
@@ -2066,6 +2089,140 @@ int *status           /* global status (given and returned) */
 }
 
 
+/*+ sc2math_mapmult - Apply the DREAM normal equations to a vector */
+
+void sc2math_mapmult
+(
+int nframes,              /* no of data frames (given) */
+int nbolx,                /* number of bolometers in X (given) */
+int nboly,                /* number of bolometers in Y (given) */
+int gridext[],            /* Table of grid extents for a single
+                             bolometer (given) */
+double *interpwt,         /* interpolation weights (given) */
+int *qual,                /* bolometer quality array (given) */
+double *vec,              /* bolometer zero points followed by sky grid
+                             values (given) */
+double *result            /* normal equations applied to vec (returned) */
+)
+/* Method :
+    The unknowns of the DREAM solution are the zero points of the working
+    bolometers followed by the values of the sky grid, in the same order as
+    used by sc2math_calcmapwt. Each measurement is modelled as the zero
+    point of its bolometer plus the interpolation-weighted sum of the sky
+    grid points seen by that bolometer at that path position, so only
+    ngrid+1 unknowns contribute to any one measurement.
+
+    Multiply the given vector by the normal equation matrix (including the
+    constraint that the sum of the bolometer zero points is zero) without
+    forming the matrix, by evaluating the model for every measurement and
+    accumulating its transpose. This is the operator needed by the
+    iterative solution in sc2math_mapsolvecg.
+
+   Authors :
+    East Asian Observatory
+
+   History :
+    14Oct2026 : original
+*/
+
+{
+   int actbol;               /* number of operational bolometers */
+   int bolnum;               /* bolometer counter */
+   int i;                    /* loop counter */
+   int j;                    /* loop counter */
+   int jgrid;                /* count through reconstructed map */
+   int k;                    /* loop counter */
+   int l;                    /* loop counter */
+   int m;                    /* loop counter */
+   int n;                    /* loop counter */
+   int ngrid;                /* number of points in grid for a bolometer */
+   int nunkno;               /* number of unknowns in solution */
+   double *pwt;              /* interpolation weights for a path point */
+   int skyheight;            /* height of reconstructed map */
+   int skywid;               /* width of reconstructed map */
+   double value;             /* model value of a measurement */
+   double zsum;              /* sum of bolometer zero points */
+
+
+   skywid = nbolx + gridext[1] - gridext[0];
+   skyheight = nboly + gridext[3] - gridext[2];
+   ngrid = ( 1 + gridext[1] - gridext[0] ) * ( 1 + gridext[3] - gridext[2] );
+
+   actbol = 0;
+   for ( j=0; j<nbolx*nboly; j++ )
+   {
+      if ( qual[j] == 0 )
+      {
+         actbol++;
+      }
+   }
+   nunkno = skywid * skyheight + actbol;
+
+   zsum = 0.0;
+   for ( j=0; j<actbol; j++ )
+   {
+      zsum += vec[j];
+   }
+
+/* The zero point constraint contributes the same term to every zero
+   point */
+
+   for ( j=0; j<nunkno; j++ )
+   {
+      result[j] = ( j < actbol ) ? zsum : 0.0;
+   }
+
+   bolnum = -1;
+
+   for ( j=0; j<nboly; j++ )
+   {
+      for ( i=0; i<nbolx; i++ )
+      {
+         if ( qual[nbolx*j + i] == 0 )
+         {
+            bolnum++;
+
+            for ( k=0; k<nframes; k++ )
+            {
+
+/* Evaluate the model for this path point of this bolometer */
+
+               pwt = interpwt + ngrid * k;
+               value = vec[bolnum];
+               l = 0;
+               for ( n=gridext[2]; n<=gridext[3]; n++ )
+               {
+                  jgrid = actbol + ( j - gridext[2] + n ) * skywid
+                    + i - gridext[0];
+                  for ( m=gridext[0]; m<=gridext[1]; m++ )
+                  {
+                     value += pwt[l] * vec[jgrid+m];
+                     l++;
+                  }
+               }
+
+/* Accumulate it into the unknowns which contributed to it */
+
+               result[bolnum] += value;
+               l = 0;
+               for ( n=gridext[2]; n<=gridext[3]; n++ )
+               {
+                  jgrid = actbol + ( j - gridext[2] + n ) * skywid
+                    + i - gridext[0];
+                  for ( m=gridext[0]; m<=gridext[1]; m++ )
+                  {
+                     result[jgrid+m] += pwt[l] * value;
+                     l++;
+                  }
+               }
+            }
+         }
+      }
+   }
+}
+
+
+
 /*+ sc2math_mapsolve - Reconstruct SCUBA-2 DREAM data in a single step */
 
 void sc2math_mapsolve
@@ -2313,6 +2470,305 @@ if ( bolnum==660 )
 
 
 
+/*+ sc2math_mapsolvecg - Reconstruct SCUBA-2 DREAM data iteratively */
+
+void sc2math_mapsolvecg
+(
+int nframes,              /* no of data frames (given) */
+int nbolx,                /* number of bolometers in X (given) */
+int nboly,                /* number of bolometers in Y (given) */
+int gridext[],            /* Table of grid extents for a single
+                             bolometer (given) */
+double gridsize,          /* size in arcsec of grid step (given) */
+int jigext[],             /* Table of SMU pattern extents for a single
+                             bolometer (given) */
+double jigsize,           /* size in arcsec of SMU step (given) */
+double *interpwt,         /* interpolation weights (given) */
+int *qual,                /* bolometer quality array (given) */
+double *psbuf,            /* flatfielded data set [nbolx.nboly.nframes](given) */
+int maxiter,              /* maximum number of iterations (given) */
+double tol,               /* required fractional residual (given) */
+double *sint,             /* all the unknowns, starting estimate or NULL
+                             (given and returned) */
+int maxmap,               /* maximum size of reconstructed map (given) */
+int dims[],               /* actual dimensions of map (returned) */
+double *map,              /* Solved intensities (returned) */
+double *pbolzero,         /* bolometer zero points (returned) */
+int *niter,               /* number of iterations used (returned) */
+int *status
+)
+/* Method :
+    Given a set of flatfielded frames corresponding to a set of samples around
+    the DREAM pattern, reconstruct an image.
+
+    This solves the same normal equations as sc2math_mapsolve, but by
+    preconditioned conjugate gradients using sc2math_mapmult rather than
+    by multiplying by the inverted matrix from sc2math_calcmapwt. Each
+    measurement involves only the grid points around one bolometer, so
+    the cost of an iteration grows linearly with the number of
+    bolometers and grid points, and the (quadratically growing) inverted
+    matrix is never needed. The matrix diagonal is used as the
+    preconditioner.
+
+    If sint is not NULL it must have room for all the unknowns, that is
+    the working bolometers plus the sky grid points of sc2math_mapsolve.
+    On entry it holds the starting estimate (for instance the solution
+    for the previous cycle) and on exit the full solution. Iteration
+    stops when the residual has fallen below tol times its value for a
+    zero estimate, or after maxiter iterations.
+
+   Authors :
+    East Asian Observatory
+
+   History :
+    14Oct2026 : original, based on sc2math_mapsolve
+*/
+
+
+{
+
+   int actbol;               /* number of operational bolometers */
+   double alpha;             /* step length along search direction */
+   double beta;              /* weight of previous search direction */
+   double bnorm;             /* squared norm of known vector */
+   int bolnum;               /* bolometer counter */
+   double *diag;             /* diagonal of the normal equations */
+   int i;                    /* loop counter */
+   int iter;                 /* iteration counter */
+   int j;                    /* loop counter */
+   int jgrid;                /* count through reconstructed map */
+   int jig2grid;             /* conversion from SMU steps to grid steps */
+   int k;                    /* loop counter */
+   double *kvec;             /* Pointer to known vector of values */
+   int l;                    /* loop counter */
+   int m;                    /* loop counter */
+   int n;                    /* loop counter */
+   int ngrid;                /* number of points in grid for a bolometer */
+   int nunkno;               /* number of unknowns in solution */
+   int outheight;            /* height of output map */
+   int outwid;               /* width of output map */
+   double *pdir;             /* search direction */
+   double pq;                /* product of search direction and its image */
+   double *pwt;              /* interpolation weights for a path point */
+   double *qvec;             /* normal equations applied to pdir */
+   double *rvec;             /* residual vector */
+   double rnorm;             /* squared norm of residual */
+   double rz;                /* product of residual and preconditioned
+                                residual */
+   double rznew;             /* rz for the updated residual */
+   double *sol;              /* solved parameters */
+   int skyheight;            /* height of reconstructed map */
+   int skywid;               /* width of reconstructed map */
+   double value;             /* data value */
+   int zx;                   /* x offset of output map in solution */
+   int zy;                   /* y offset of output map in solution */
+
+
+
+   if ( !StatusOkP(status) ) return;
+
+   *niter = 0;
+
+/* Count the working bolometers */
+
+   actbol = 0;
+   for ( j=0; j<nbolx*nboly; j++ )
+   {
+      if ( qual[j] == 0 )
+      {
+         actbol++;
+      }
+   }
+
+/* Calculate the sizes of the sky map and output map as in
+   sc2math_mapsolve */
+
+   skywid = nbolx + gridext[1] - gridext[0];
+   skyheight = nboly + gridext[3] - gridext[2];
+   ngrid = ( 1 + gridext[1] - gridext[0] ) * ( 1 + gridext[3] - gridext[2] );
+
+   nunkno = skywid * skyheight + actbol;
+
+   jig2grid = (int) ( 0.5 + jigsize / gridsize );
+   outwid = nbolx + jig2grid * ( jigext[1] - jigext[0] );
+   outheight = nboly + jig2grid * ( jigext[3] - jigext[2] );
+   zx = jig2grid * jigext[0] - gridext[0];
+   zy = jig2grid * jigext[2] - gridext[2];
+
+/* Proceed if enough space has been provided for the output map */
+
+   if ( maxmap >= outwid*outheight )
+   {
+
+      dims[0] = outwid;
+      dims[1] = outheight;
+
+      kvec = (double *)calloc ( nunkno, sizeof(double) );
+      diag = (double *)calloc ( nunkno, sizeof(double) );
+      rvec = (double *)calloc ( nunkno, sizeof(double) );
+      pdir = (double *)calloc ( nunkno, sizeof(double) );
+      qvec = (double *)calloc ( nunkno, sizeof(double) );
+      if ( sint == NULL )
+      {
+         sol = (double *)calloc ( nunkno, sizeof(double) );
+      }
+      else
+      {
+         sol = sint;
+      }
+
+/* Form the known vector and the diagonal of the normal equations. The
+   zero point constraint adds one to the diagonal for each bolometer. */
+
+      bolnum = -1;
+
+      for ( j=0; j<nboly; j++ )
+      {
+         for ( i=0; i<nbolx; i++ )
+         {
+            if ( qual[nbolx*j + i] == 0 )
+            {
+               bolnum++;
+               diag[bolnum] = (double) ( nframes + 1 );
+
+               for ( k=0; k<nframes; k++ )
+               {
+                  pwt = interpwt + ngrid * k;
+                  value = psbuf[k*nbolx*nboly+j*nbolx+i];
+                  kvec[bolnum] += value;
+                  l = 0;
+                  for ( n=gridext[2]; n<=gridext[3]; n++ )
+                  {
+                     jgrid = actbol + ( j - gridext[2] + n ) * skywid
+                       + i - gridext[0];
+                     for ( m=gridext[0]; m<=gridext[1]; m++ )
+                     {
+                        kvec[jgrid+m] += pwt[l] * value;
+                        diag[jgrid+m] += pwt[l] * pwt[l];
+                        l++;
+                     }
+                  }
+               }
+            }
+         }
+      }
+
+/* Sky points seen by no bolometer are left at zero */
+
+      bnorm = 0.0;
+      for ( j=0; j<nunkno; j++ )
+      {
+         bnorm += kvec[j] * kvec[j];
+         if ( diag[j] < EPS )
+         {
+            diag[j] = 0.0;
+            sol[j] = 0.0;
+         }
+         else
+         {
+            diag[j] = 1.0 / diag[j];
+         }
+      }
+
+/* Initial residual and search direction */
+
+      sc2math_mapmult ( nframes, nbolx, nboly, gridext, interpwt, qual,
+        sol, qvec );
+
+      rz = 0.0;
+      rnorm = 0.0;
+      for ( j=0; j<nunkno; j++ )
+      {
+         rvec[j] = kvec[j] - qvec[j];
+         pdir[j] = diag[j] * rvec[j];
+         rz += rvec[j] * pdir[j];
+         rnorm += rvec[j] * rvec[j];
+      }
+
+/* Iterate */
+
+      for ( iter=0; iter<maxiter && rnorm > tol * tol * bnorm; iter++ )
+      {
+         sc2math_mapmult ( nframes, nbolx, nboly, gridext, interpwt, qual,
+           pdir, qvec );
+
+         pq = 0.0;
+         for ( j=0; j<nunkno; j++ )
+         {
+            pq += pdir[j] * qvec[j];
+         }
+         if ( pq < EPS ) break;
+
+         alpha = rz / pq;
+         rznew = 0.0;
+         rnorm = 0.0;
+         for ( j=0; j<nunkno; j++ )
+         {
+            sol[j] += alpha * pdir[j];
+            rvec[j] -= alpha * qvec[j];
+            rznew += diag[j] * rvec[j] * rvec[j];
+            rnorm += rvec[j] * rvec[j];
+         }
+
+         beta = rznew / rz;
+         rz = rznew;
+         for ( j=0; j<nunkno; j++ )
+         {
+            pdir[j] = diag[j] * rvec[j] + beta * pdir[j];
+         }
+         (*niter)++;
+      }
+
+/* Extract the intensities - sol contains both the solved intensity data
+   and the bolometer offsets  */
+
+      for ( j=0; j<outheight; j++ )
+      {
+         for ( i=0; i<outwid; i++ )
+         {
+            map[j*outwid+i] = sol[actbol+(j+zy)*skywid+zx+i];
+         }
+      }
+
+      bolnum = -1;
+      for ( j=0; j<nboly; j++ )
+      {
+         for ( i=0; i<nbolx; i++ )
+         {
+            if ( qual[nbolx*j + i] == 0 )
+            {
+               bolnum++;
+               pbolzero[nbolx*j + i] = sol[bolnum];
+            }
+            else
+            {
+               pbolzero[nbolx*j + i] = VAL__BADD;
+            }
+         }
+      }
+
+      if ( sint == NULL )
+      {
+         free ( sol );
+      }
+      free ( kvec );
+      free ( diag );
+      free ( rvec );
+      free ( pdir );
+      free ( qvec );
+   }
+   else
+   {
+      *status = DITS__APP_ERROR;
+      sprintf ( errmess,
+        "%d elements in provided reconstruction array, but %d points needed",
+        maxmap, outwid*outheight );
+      ErsRep ( 0, status, errmess );
+   }
+}
+
+
+
 /*+  sc2math_martin - spike removal from chop-scan data */
 
 void sc2math_martin
@@ -3293,6 +3749,107 @@ int *status              /* global status (given and returned) */
 }
 
 
+/*+ sc2math_setcalall - set flatfield calibration for all bolometers */
+
+void sc2math_setcalall
+(
+int nboll,               /* total number of bolometers (given) */
+int numsamples,          /* number of data samples (given) */
+const double inptr[],    /* measurements for all bolometers, time ordered
+                            (given) */
+int ncal,                /* number of calibration measurements (given) */
+const double heat[],     /* calibration heater settings (given) */
+const double calval[],   /* calibration measurements for all bolometers (given) */
+double lincal[],         /* calibration parameters, two per bolometer
+                            (returned) */
+int *status              /* global status (given and returned) */
+)
+
+/*  Description :
+     As sc2math_setcal, but for every bolometer at once. The means of
+     the measurements of all the bolometers are accumulated in a single
+     pass through the time-ordered data, rather than by extracting the
+     time series of each bolometer in turn. The parameters for bolometer
+     i are returned in lincal[2*i] and lincal[2*i+1], and are identical
+     to those given by sc2math_setcal.
+
+    History :
+     14Oct2026:  original
+*/
+
+{
+   int *count;         /* number of good measurements per bolometer */
+   int i;              /* bolometer index */
+   int j;              /* sample index */
+   double *mean;       /* mean measurement per bolometer */
+   const double *pd;   /* pointer to measurements for current sample */
+
+   if ( !StatusOkP(status) ) return;
+
+   mean = calloc ( nboll, sizeof(*mean) );
+   count = calloc ( nboll, sizeof(*count) );
+
+   if ( mean != NULL && count != NULL )
+   {
+
+/* accumulate the sums of the current measurements */
+
+      for ( j=0; j<numsamples; j++ )
+      {
+         pd = inptr + (size_t)j*nboll;
+         for ( i=0; i<nboll; i++ )
+         {
+            if ( pd[i] != VAL__BADD )
+            {
+               mean[i] += pd[i];
+               count[i]++;
+            }
+         }
+      }
+
+/* Choose interpolation point from calibration tables for each bolometer */
+
+      for ( i=0; i<nboll; i++ )
+      {
+         if ( count[i] > 0 )
+         {
+            mean[i] /= (double)count[i];
+         }
+         else
+         {
+            mean[i] = VAL__BADD;
+         }
+
+         if ( calval[i+nboll] > calval[i] )
+         {
+            sc2math_setcalinc ( nboll, i, mean[i], ncal, heat, calval,
+              lincal+2*i, status );
+         }
+         else if ( calval[i+nboll] < calval[i] )
+         {
+            sc2math_setcaldec ( nboll, i, mean[i], ncal, heat, calval,
+              lincal+2*i, status );
+         }
+         else
+         {
+            lincal[2*i] = VAL__BADD;
+            lincal[2*i+1] = VAL__BADD;
+         }
+      }
+   }
+   else
+   {
+      *status = DITS__APP_ERROR;
+      sprintf ( errmess, "sc2math_setcalall: failed to allocate memory" );
+      ErsRep ( 0, status, errmess );
+   }
+
+   free ( mean );
+   free ( count );
+}
+
+
+
 /*+ sc2math_setcaldec - set decreasing flatfield calibration */
 
 void sc2math_setcaldec
@@ -30,7 +30,8 @@ int gridpts[][2],       /* relative grid coordinates (given) */
 int gridwtsdim[],       /* dimensions of gridwts array (returned) */
 double **gridwts,       /* Pointer to array of sky grid weights (returned) */
 int *invmatdim,         /* dimension of inverted matrix (returned) */
-double **invmat,        /* pointer to inverted matrix (returned) */
+double **invmat,        /* pointer to inverted matrix, or NULL if not
+                           required (returned) */
 int *status             /* global status (given and returned) */
 );
 
@@ -268,6 +269,22 @@ double *cons,         /* offset (returned) */
 int *status           /* global status (given and returned) */
 );
 
+/*+ sc2math_mapmult - Apply the DREAM normal equations to a vector */
+
+void sc2math_mapmult
+(
+int nframes,              /* no of data frames (given) */
+int nbolx,                /* number of bolometers in X (given) */
+int nboly,                /* number of bolometers in Y (given) */
+int gridext[],            /* Table of grid extents for a single
+                             bolometer (given) */
+double *interpwt,         /* interpolation weights (given) */
+int *qual,                /* bolometer quality array (given) */
+double *vec,              /* bolometer zero points followed by sky grid
+                             values (given) */
+double *result            /* normal equations applied to vec (returned) */
+);
+
 /*+ sc2math_mapsolve - Reconstruct SCUBA-2 DREAM data in a single step */
 
 void sc2math_mapsolve
@@ -292,6 +309,34 @@ double *pbolzero,         /* bolometer zero points (returned) */
 int *status
 );
 
+/*+ sc2math_mapsolvecg - Reconstruct SCUBA-2 DREAM data iteratively */
+
+void sc2math_mapsolvecg
+(
+int nframes,              /* no of data frames (given) */
+int nbolx,                /* number of bolometers in X (given) */
+int nboly,                /* number of bolometers in Y (given) */
+int gridext[],            /* Table of grid extents for a single
+                             bolometer (given) */
+double gridsize,          /* size in arcsec of grid step (given) */
+int jigext[],             /* Table of SMU pattern extents for a single
+                             bolometer (given) */
+double jigsize,           /* size in arcsec of SMU step (given) */
+double *interpwt,         /* interpolation weights (given) */
+int *qual,                /* bolometer quality array (given) */
+double *psbuf,            /* flatfielded data set [nbolx.nboly.nframes](given) */
+int maxiter,              /* maximum number of iterations (given) */
+double tol,               /* required fractional residual (given) */
+double *sint,             /* all the unknowns, starting estimate or NULL
+                             (given and returned) */
+int maxmap,               /* maximum size of reconstructed map (given) */
+int dims[],               /* actual dimensions of map (returned) */
+double *map,              /* Solved intensities (returned) */
+double *pbolzero,         /* bolometer zero points (returned) */
+int *niter,               /* number of iterations used (returned) */
+int *status
+);
+
 /*+  sc2math_martin - spike removal from chop-scan data */
 
 void sc2math_martin
@@ -433,7 +478,22 @@ double lincal[2],        /* calibration parameters (returned) */
 int *status              /* global status (given and returned) */
 );
 
-/*+ sc2math_setcaldec - set decreasing flatfield calibration */
+/*+ sc2math_setcalall - set flatfield calibration for all bolometers */
+
+void sc2math_setcalall
+(
+int nboll,               /* total number of bolometers (given) */
+int numsamples,          /* number of data samples (given) */
+const double inptr[],    /* measurements for all bolometers, time ordered
+                            (given) */
+int ncal,                /* number of calibration measurements (given) */
+const double heat[],     /* calibration heater settings (given) */
+const double calval[],   /* calibration measurements for all bolometers (given) */
+double lincal[],         /* calibration parameters, two per bolometer
+                            (returned) */
+int *status              /* global status (given and returned) */
+);
+
 
 void sc2math_setcaldec
 (
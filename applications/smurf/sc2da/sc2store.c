@@ -245,7 +245,7 @@ const int gridwtsdim[],          /* dimensions of grid interpolation weights
                               (given) */
 const double *gridwts,           /* grid interpolation weights (given) */
 int invmatdim,             /* dimension of inverted matrix (given) */
-const double *invmat,            /* inverted matrix (given) */
+const double *invmat,            /* inverted matrix, or NULL (given) */
 const int qualdim[],             /* dimensions of quality mask (given) */
 const int *qual,                 /* bolometer quality mask (given) */
 int *status                /* global status (given and returned) */
@@ -256,6 +256,7 @@ int *status                /* global status (given and returned) */
    History :
     15Apr2008 : original (bdk)
     09May2008 : add windext argument (bdk)
+    14Oct2026 : omit the inverted matrix if invmat is NULL
 */
 {
    int *data;                  /* pointer to top-level NDF data */
@@ -325,18 +326,22 @@ int *status                /* global status (given and returned) */
      (void *)&tinterpwt, &el, status );
    memcpy ( tinterpwt, gridwts, el*sizeof(*gridwts) );
 
-/* Map inverse matrix array and copy data */
+/* Map inverse matrix array and copy data. It is omitted if the images
+   are to be solved iteratively. */
 
-   ndim = 1;
-   lbnd[0] = 1;
-   ubnd[0] = invmatdim;
-   ndfPlace ( sc2store_dreamwtloc, "INVMATX", &place, status );
-   ndfNew ( "_DOUBLE", ndim, lbnd, ubnd, &place, &sc2store_indfinvmatx,
-     status );
+   if ( invmat != NULL && invmatdim > 0 )
+   {
+      ndim = 1;
+      lbnd[0] = 1;
+      ubnd[0] = invmatdim;
+      ndfPlace ( sc2store_dreamwtloc, "INVMATX", &place, status );
+      ndfNew ( "_DOUBLE", ndim, lbnd, ubnd, &place, &sc2store_indfinvmatx,
+        status );
 
-   ndfMap ( sc2store_indfinvmatx, "DATA", "_DOUBLE", "WRITE", (void *)&tinvmat,
-     &el, status );
-   memcpy ( tinvmat, invmat, el*sizeof(*invmat) );
+      ndfMap ( sc2store_indfinvmatx, "DATA", "_DOUBLE", "WRITE",
+        (void *)&tinvmat, &el, status );
+      memcpy ( tinvmat, invmat, el*sizeof(*invmat) );
+   }
 
 /* Map window extent array */
 
@@ -441,45 +446,59 @@ int *status                   /* global status (given and returned) */
     20Mar2007 : Use const in signature (TIMJ)
     11Nov2007 : make compressed values short instead of unsigned short (bdk)
     13Nov2007 : multiply by sc2store_rdbscale (bdk)
+    14Oct2026 : decompress and scale in a single pass, and skip the
+                scaling when the scale factor is unity
 */
 {
+   int digit;           /* integer value */
    int j;               /* loop counter */
+   double scale;        /* data scale factor */
 
    if ( !StatusOkP(status) ) return;
 
+   scale = sc2store_rdbscale;
+
 /* Insert the stackzero frame (ie approximate zero points for each
-   bolometer) and bzero */
+   bolometer) and bzero, and multiply by the scale factor. A unit scale
+   factor leaves every value unchanged, so the multiplication is only done
+   if needed. This keeps the common case a simple loop that the compiler
+   can vectorise. */
 
-   for ( j=0; j<nval; j++ )
+   if ( scale == 1.0 )
    {
-      if ( data[j] != VAL__BADW )
-      {
-         digits[j] = stackz[j] + bzero + (int)data[j];
-      }
-      else
+      for ( j=0; j<nval; j++ )
       {
-         digits[j] = VAL__BADI;
+         digits[j] = ( data[j] != VAL__BADW ) ?
+                     stackz[j] + bzero + (int)data[j] : VAL__BADI;
       }
    }
-
-/* Insert any incompressible values */
-
-   if ( npix > 0 )
+   else
    {
-      for ( j=0; j<npix; j++ )
+      for ( j=0; j<nval; j++ )
       {
-         digits[pixnum[j]] = pixval[j] + stackz[pixnum[j]];
+         if ( data[j] != VAL__BADW )
+         {
+            digit = stackz[j] + bzero + (int)data[j];
+            digits[j] = ( digit != VAL__BADI ) ?
+                        (int)( (double)digit * scale ) : VAL__BADI;
+         }
+         else
+         {
+            digits[j] = VAL__BADI;
+         }
       }
    }
 
-/* Multiply by the scale factor */
+/* Insert any incompressible values, scaling them in the same way */
 
-   for ( j=0; j<nval; j++ )
+   for ( j=0; j<npix; j++ )
    {
-      if ( digits[j] != VAL__BADI )
+      digit = pixval[j] + stackz[pixnum[j]];
+      if ( scale != 1.0 && digit != VAL__BADI )
       {
-         digits[j] = (int)( (double)digits[j] * sc2store_rdbscale );
+         digit = (int)( (double)digit * scale );
       }
+      digits[pixnum[j]] = digit;
    }
 
 }
@@ -1246,7 +1265,7 @@ int gridwtsdim[],          /* dimensions of grid interpolation weights
                               (returned) */
 double **gridwts,          /* grid interpolation weights (returned) */
 int *invmatdim,            /* dimension of inverted matrix (returned) */
-double **invmat,           /* inverted matrix (returned) */
+double **invmat,           /* inverted matrix, or NULL (returned) */
 int qualdim[],             /* dimensions of quality mask (returned) */
 int **qual,                /* bolometer quality mask (returned) */
 int *status                /* global status (given and returned) */
@@ -1260,6 +1279,7 @@ int *status                /* global status (given and returned) */
     02May2008 : add arguments for qual and qualdim (bdk)
     09May2008 : add windext argument (bdk)
     16Sep2009 : handle column/row flip (timj)
+    14Oct2026 : return a NULL inverted matrix if the file has none
 */
 {
    HDSLoc *gridszloc = NULL;   /* HDS locator to grid step size */
@@ -1301,15 +1321,25 @@ int *status                /* global status (given and returned) */
    ndimx = 2;
    ndfDim ( sc2store_indfgridwts, ndimx, gridwtsdim, &ndim, status );
 
-/* Map inverse matrix array */
+/* Map inverse matrix array, if present */
 
-   ndfOpen ( sc2store_dreamwtloc, "INVMATX", "READ", "OLD",
-     &sc2store_indfinvmatx, &place, status );
+   datThere ( sc2store_dreamwtloc, "INVMATX", &there, status );
 
-   ndfMap ( sc2store_indfinvmatx, "DATA", "_DOUBLE", "READ", (void **)invmat,
-     &el, status );
-   ndimx = 1;
-   ndfDim ( sc2store_indfinvmatx, ndimx, invmatdim, &ndim, status );
+   if ( there != 0 )
+   {
+      ndfOpen ( sc2store_dreamwtloc, "INVMATX", "READ", "OLD",
+        &sc2store_indfinvmatx, &place, status );
+
+      ndfMap ( sc2store_indfinvmatx, "DATA", "_DOUBLE", "READ",
+        (void **)invmat, &el, status );
+      ndimx = 1;
+      ndfDim ( sc2store_indfinvmatx, ndimx, invmatdim, &ndim, status );
+   }
+   else
+   {
+      *invmat = NULL;
+      *invmatdim = 0;
+   }
 
 /* Get step intervals */
 
@@ -41,7 +41,7 @@ const int gridwtsdim[],          /* dimensions of grid interpolation weights
                               (given) */
 const double *gridwts,           /* grid interpolation weights (given) */
 int invmatdim,             /* dimension of inverted matrix (given) */
-const double *invmat,            /* inverted matrix (given) */
+const double *invmat,            /* inverted matrix, or NULL (given) */
 const int qualdim[],             /* dimensions of quality mask (given) */
 const int *qual,                 /* bolometer quality mask (given) */
 int *status                /* global status (given and returned) */
@@ -149,7 +149,7 @@ int gridwtsdim[],          /* dimensions of grid interpolation weights
                               (returned) */
 double **gridwts,          /* grid interpolation weights (returned) */
 int *invmatdim,            /* dimension of inverted matrix (returned) */
-double **invmat,           /* inverted matrix (returned) */
+double **invmat,           /* inverted matrix, or NULL (returned) */
 int qualdim[],             /* dimensions of quality mask (returned) */
 int **qual,                /* bolometer quality mask (returned) */
 int *status                /* global status (given and returned) */
@@ -27,6 +27,14 @@
 *     from the shell or ICL.  Given the command, the requested A-task
 *     is called after a successful matching of the input string with a
 *     valid task name.  If there is no match, an error report is made.
+*
+*     Normally the sc2ast_createwcs and WVM caches are cleared at the
+*     end of every command. If the environment variable SMURF_PERSIST
+*     is set to a non-zero integer, these caches are instead retained
+*     so that later commands run by the same monolith process (for
+*     instance when the monolith is loaded as a persistent task by
+*     ICL or the ADAM message system, as ORAC-DR does) can re-use
+*     them. Thread workforces are always retained.
 
 *  Authors:
 *     Tim Jenness (JAC, Hawaii)
@@ -173,6 +181,9 @@
 *        Call SUPERCAM2ACSIS
 *     2014-04-01 (TIMJ):
 *        Call NANTEN2ACSIS
+*     2026-10-14:
+*        Retain the sc2ast and WVM caches between commands if
+*        SMURF_PERSIST is set.
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -180,6 +191,7 @@
 *     Copyright (C) 2005-2007 Particle Physics and Astronomy Research Council.
 *     Copyright (C) 2005-2008,2010-2011 University of British Columbia.
 *     Copyright (C) 2014 Cornell University.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -251,6 +263,8 @@ void smurf_mon( int * status ) {
   int memory_caching;          /* Is AST current caching unused memory? */
   int emslev1;                 /* EMS level on entry */
   int emslev2;                 /* EMS level on exit */
+  int persist;                 /* Retain caches between commands? */
+  const char *envval;          /* Value of SMURF_PERSIST */
 
   if ( *status != SAI__OK ) return;
 
@@ -451,11 +465,20 @@ void smurf_mon( int * status ) {
   /* End the GRP NDF history block. */
   ndgEndgh( status );
 
-  /* Clear cached info from sc2ast_createwcs. */
-  sc2ast_createwcs(SC2AST__NULLSUB, NULL, NULL, NULL, NO_FTS, NULL, status);
+  /* See if the caches are to be retained for use by later commands
+     run by this process. The cached AST objects are exempted from AST
+     context handling so they survive the astEnd below. */
+  envval = getenv( "SMURF_PERSIST" );
+  persist = ( envval && atoi( envval ) != 0 );
+
+  if( !persist ) {
 
-  /* Clear WVM caches (one for each thread). */
-  smf_calc_wvm_clear( status );
+    /* Clear cached info from sc2ast_createwcs. */
+    sc2ast_createwcs(SC2AST__NULLSUB, NULL, NULL, NULL, NO_FTS, NULL, status);
+
+    /* Clear WVM caches (one for each thread). */
+    smf_calc_wvm_clear( status );
+  }
 
   /* Free AST resources */
   astTune( "MemoryCaching", memory_caching );
@@ -51,9 +51,10 @@ typedef struct timer_struct {
                  Tcl_TimerToken timertoken;     /* identifier for tcl timer */
                  int timer_set;                 /* timer set flag */
                  int milliseconds;              /* timer interval */
+                 int running;                   /* monitoring started flag */
                             } timer_struct;
 
-static void tclnbs_monitor(char*, char*, Tcl_Interp*, int*);
+static void tclnbs_monitor(char*, char*, Tcl_Interp*, timer_struct*, int*);
 static void tclnbs_moninfo(Tcl_Interp*, int*);
 static void tclnbs_clear(Tcl_Interp*);
 static void tclnbs_scan(ClientData);
@@ -79,6 +80,7 @@ Tcl_Interp *interp
      History :
       22June1994: original (BDK)
       13September1999: Set dims to null to remove compiler warning (DLT)
+      14October2026: Initialise the timer structure
 */
 
 {
@@ -86,6 +88,16 @@ Tcl_Interp *interp
 
 /*  Allocate a timer structure */
    timer = (timer_struct*)malloc(sizeof (timer_struct));
+   if ( timer == 0 )
+   {
+      Tcl_AppendResult(interp,
+               "nbs can't allocate space for timer", (char *) NULL);
+      return TCL_ERROR;
+   }
+   timer->interp = interp;
+   timer->timer_set = 0;
+   timer->milliseconds = 0;
+   timer->running = 0;
 
    Tcl_CreateCommand ( interp, "nbs", (Tcl_CmdProc *)tclnbs_cmd,
                        (ClientData)timer, (Tcl_CmdDeleteProc *)tclnbs_stop );
@@ -196,7 +208,8 @@ char *argv[]
          }
          else if ( argc == 4 )
          {
-            tclnbs_monitor ( argv[2], argv[3], interp, &tcl_status );
+            tclnbs_monitor ( argv[2], argv[3], interp,
+               (timer_struct*)clientData, &tcl_status );
          }
          else
          {
@@ -1055,16 +1068,19 @@ static void tclnbs_monitor
 char *nbs_name,           /* name of noticeboard entry (given) */
 char *tcl_name,           /* name of tcl variable (given) */
 Tcl_Interp *interp,       /* interpreter structure (given and returned) */
+timer_struct *timer,      /* timer structure */
 int *tcl_status           /* tcl status (returned) */
 )
 
 /*   Method :
       Create space for new entry, put it at the front of the entry list
-      and initialise it.
+      and initialise it. If monitoring has been started but the timer is
+      idle because the list was empty, restart the timer.
      Author :
       B.D.Kelly (ROE)
      History :
       22June1994: original (BDK)
+      14October2026: Restart an idle timer
 */
 
 {
@@ -1087,6 +1103,14 @@ int *tcl_status           /* tcl status (returned) */
       ptr->nbs_mapped = 0;
       ptr->nbs_found = 0;
       ptr->interp = interp;
+
+      if ( timer->running == 1 && timer->timer_set == 0 &&
+           timer->interp == interp )
+      {
+         timer->timertoken = Tcl_CreateTimerHandler ( timer->milliseconds,
+           tclnbs_scan, (ClientData)timer );
+         timer->timer_set = 1;
+      }
    }
    else
    {
@@ -1133,11 +1157,17 @@ ClientData clientData   /* tcl clienta data (given) */
 
 /*   Method :
       Copy data from NBS, convert to ascii and put into tcl variables.
-      Restart the tcl timer.
+      Only items that have been updated since they were last read are
+      copied. Restart the tcl timer, unless there are no items left to
+      monitor, in which case the timer is left idle until an item is added.
      Author :
       B.D.Kelly (ROE)
      History :
       22June1994: original (BDK)
+      14October2026: Check each item for updates separately, move on to
+                     the next item if a noticeboard cannot be mapped yet
+                     and leave the timer idle when nothing is being
+                     monitored
 */
 
 {
@@ -1148,6 +1178,7 @@ ClientData clientData   /* tcl clienta data (given) */
    mon_entry_type *next_ptr;  /* pointer to next entry */
    Tcl_DString tempval;    /* value got from NBS */
    int updated = 0;
+   int nentry = 0;         /* number of items being monitored */
    int istat;
    int prim;
    char *c;
@@ -1166,6 +1197,7 @@ ClientData clientData   /* tcl clienta data (given) */
          ptr = &((*ptr)->next);
          continue;
       }
+      updated = 0;
 
       if ( (*ptr)->nbs_mapped == 0 )
       {
@@ -1235,13 +1267,29 @@ ClientData clientData   /* tcl clienta data (given) */
          else
          {
             ptr = &((*ptr)->next);
+            nentry++;
          }
       }
+      else
+      {
+
+/*   The noticeboard does not exist yet. Try again on the next scan. */
+
+         ptr = &((*ptr)->next);
+         nentry++;
+      }
    }
 
-   timer->timertoken = Tcl_CreateTimerHandler ( timer->milliseconds, tclnbs_scan,
-     clientData );
-   timer->timer_set = 1;
+   if ( nentry > 0 )
+   {
+      timer->timertoken = Tcl_CreateTimerHandler ( timer->milliseconds,
+        tclnbs_scan, clientData );
+      timer->timer_set = 1;
+   }
+   else
+   {
+      timer->timer_set = 0;
+   }
 
    emsAnnul(&istat);
    emsRlse();
@@ -1293,6 +1341,7 @@ int *tcl_status           /* tcl status (returned) */
          }
          timer->milliseconds = msec;
          timer->interp = interp;
+         timer->running = 1;
          timer->timertoken = Tcl_CreateTimerHandler ( timer->milliseconds,
            tclnbs_scan, (ClientData)timer );
          timer->timer_set = 1;
@@ -1327,6 +1376,7 @@ ClientData clientData
       B.D.Kelly (ROE)
      History :
       22June1994: original (BDK)
+      14October2026: Reset the timer flags
 */
 
 {
@@ -1336,5 +1386,7 @@ ClientData clientData
    {
       Tcl_DeleteTimerHandler ( timer->timertoken );
    }
+   timer->timer_set = 0;
+   timer->running = 0;
 
 }
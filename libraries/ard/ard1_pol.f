@@ -68,6 +68,7 @@
 *  Copyright:
 *     Copyright (C) 1994 Science & Engineering Research Council.
 *     Copyright (C) 2001 Central Laboratory of the Research Councils.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -95,6 +96,10 @@
 *        Original version.
 *     26-JUN-2001 (DSB):
 *        Modified for ARD version 2.0.
+*     14-OCT-2026:
+*        Fill the polygon using ARD1_POLFL, which only tests each mask
+*        line against the edges that span it. This also removes the
+*        limit of 100 crossings per mask line.
 *     {enter_changes_here}
 
 *  Bugs:
@@ -110,6 +115,7 @@
       INCLUDE 'PRM_PAR'          ! VAL_ constants
       INCLUDE 'ARD_CONST'        ! ARD_ private constants
       INCLUDE 'ARD_ERR'          ! ARD_ error constants
+      INCLUDE 'CNF_PAR'          ! For CNF_PVAL function
 
 *  Arguments Given:
       INTEGER RINDEX
@@ -131,40 +137,30 @@
 *  Status:
       INTEGER STATUS             ! Global status
 
-*  Local Constants:
-      INTEGER MXCRS            ! Max. allowable no. of line crossings
-      PARAMETER ( MXCRS = 100 )
-
 *  Local Variables:
       DOUBLE PRECISION
-     :  DY,                    ! Gap in y between adjacent vertices
-     :  PERT,                  ! Perturbation
-     :  TEST,                  ! Line-polygon intersection test
-     :  XCROSS( MXCRS ),       ! Line crossings
      :  XMIN,                  ! Minimum x in the polygon
      :  XMAX,                  ! Maximum x in the polygon
-     :  XT,                    ! Dummy for sorting
-     :  YL,                    ! Y pixel coordinate
      :  YMIN,                  ! Minimum y in the polygon
      :  YMAX                   ! Maximum y in the polygon
 
       INTEGER
-     :  I, J, N,               ! Loop counters
+     :  IPACT,                 ! Pointer to active edge list
+     :  IPEHI,                 ! Pointer to last line for each edge
+     :  IPHEAD,                ! Pointer to first edge on each line
+     :  IPNEXT,                ! Pointer to next edge on each line
+     :  IPX,                   ! Pointer to line crossings
      :  LBND( 2 ),             ! Mask lower bounds
      :  MINX,                  ! Min. x in polygon to nearest element
      :  MAXX,                  ! Max. x in polygon to nearest element
      :  MAXY,                  ! Max. y in polygon to nearest element
      :  MINY,                  ! Min. y in polygon to nearest element
      :  MSKSIZ,                ! No. of elements in mask
-     :  N1, N2,                ! Vertex numbers
-     :  NCROSS,                ! Number of intersections
-     :  NTOP,                  ! Sorting index
+     :  N,                     ! Loop counter
+     :  NROW,                  ! No. of mask lines crossing the polygon
      :  NVERT,                 ! No. of polygon vertices
      :  UBND( 2 )              ! Mask upper bounds
 
-      LOGICAL                  ! True if:
-     :  EXIT                   ! Sorting complete
-
 *.
 
 *  Check inherited global status.
@@ -231,127 +227,31 @@
       MAXY = NINT( MIN( MAX( -1.0D8, YMAX + 0.5 ), 1.0D8 ) )
       UBINTB( 2 ) = MIN( MAX( MAXY, LBND2 ), UBND2 )
 
-*  Scan the range of mask lines which cross the polygon.
-      DO J = LBINTB( 2 ), UBINTB( 2 )
-
-*  Store the Y pixel coordinate at the vertical centre of the mask
-*  line.
-         YL = DBLE( J ) - 0.5
-
-*  Problems occur in counting the number of intersections if any array
-*  line passes exactly through a polygon vertex. Therefore, the line
-*  positions are shifted by a negligible amount PERT to ensure this
-*  does not happen.
-         PERT = 1.0D-4
-
-*  Loop back to here with a new value for PERT if the current value
-*  causes a vertex to fall exactly on the current line. Initialise the
-*  number of times the current line intersects the polygon.
-  20     CONTINUE
-         NCROSS = 0
-
-*  Scan through the x-y positions, testing if each polygon side
-*  intersects the array line.
-         DO N1 = 1, NVERT
-            N2 = N1 + 1
-
-*  Polygon vertices cycle back to the start.
-            IF( N2 .GT. NVERT ) N2 = 1
-
-*  Form the intersection test.
-            TEST = ( ( PAR( 2*N1 ) - YL ) - PERT ) *
-     :             ( ( YL - PAR( 2*N2 ) ) + PERT )
-
-*  If TEST is zero, the line passes through a vertex. Therefore, change
-*  PERT and start again ( "the line" refers to a line through the
-*  middle of the pixel. The act of increasing PERT effectively moves the
-*  line a small amount in the +ve Y direction).
-            IF( ABS( TEST ) .LT. VAL__SMLD ) THEN
-               PERT = PERT + 1.0D-4
-               GO TO 20
-
-*  If TEST is positive, adjacent vertices lie on opposite sides of the
-*  array line. Calculate the point of intersection (as a pixel
-*  coordinate) and store it.
-            ELSE IF( TEST .GT. 0.0 ) THEN
-               NCROSS = NCROSS + 1
-
-               IF( NCROSS .LE. MXCRS ) THEN
-                  DY = PAR( 2*N2 ) - PAR( 2*N1 )
-
-                  IF( ABS( DY ) .LT. VAL__SMLD ) DY = SIGN( VAL__SMLD,
-     :                                                      DY )
-                  XCROSS( NCROSS ) = PAR( 2*N1 - 1 ) +
-     :                         ( YL - PAR( 2*N1 ) ) *
-     :                         ( PAR( 2*N2 - 1 ) - PAR( 2*N1 -1 ) ) / DY
-
-*  If the storage for intersections is exceeded, return with a bad
-*  status and report an error.
-               ELSE
-                  STATUS = ARD__BADAR
-                  CALL ERR_REP ( 'ARD1_POL_ERR2', 'There were too '//
-     :                           'many intersections of an ARD '//
-     :                           'polygon region with array lines.',
-     :                           STATUS )
-                  GO TO 999
-               END IF
-
-*  End of the check for line-polygon intersections.
-            END IF
-
-*  End of the loop through the polygon vertices.
-         END DO
-
-*  If the line intersects the polygon, sort intersections into x order.
-         IF( NCROSS .GT. 1 ) THEN
-            EXIT = .FALSE.
-            NTOP = NCROSS
-
-*  Loop when an interchange was necessary.
-            DO WHILE ( .NOT. EXIT )
-               EXIT = .TRUE.
-               NTOP = NTOP - 1
-
-               DO N = 1, NTOP
-
-*  Swap adjacent values if they are in the wrong order.
-                  IF( XCROSS( N ) .GT. XCROSS( N + 1 ) ) THEN
-                     XT = XCROSS( N + 1 )
-                     XCROSS( N + 1 ) = XCROSS( N )
-                     XCROSS( N ) = XT
-                     EXIT = .FALSE.
-                  END IF
-               END DO
-            END DO
-
-*  Scan through the ordered intersections in pairs.
-            DO N = 2, NCROSS, 2
-
-*  Find the pixel index bounds corresponding to the current section of
-*  the current mask line. The bounds are limited to the bounds of the
-*  smallest rectangle enclosing the polygon. The end pixels are included
-*  if their centres fall within the intersection.
-               MINX = NINT( MIN( MAX( -1.0D8, XCROSS( N - 1 )  ),
-     :                           1.0D8 ) ) + 1
-               MINX = MAX( MINX, LBINTB( 1 ) )
-
-               MAXX = NINT( MIN( MAX( -1.0D8, XCROSS( N ) ), 1.0D8 ) )
-               MAXX = MIN( MAXX, UBINTB( 1 ) )
-
-*  Set mask pixels lying between each pair of intersections to the
-*  supplied value.
-               DO I = MINX, MAXX
-                  B( I, J ) = RINDEX
-               END DO
-
-*  Do the next pair of interesections of the polygon with the current
-*  mask line.
-            END DO
-
-         END IF
-
-*  Do the next mask line.
-      END DO
+*  Scan the range of mask lines which cross the polygon, filling the
+*  polygon. Work space is needed to hold the edge table and the
+*  crossings of each line.
+      NROW = UBINTB( 2 ) - LBINTB( 2 ) + 1
+      IF( NROW .GT. 0 .AND. LBINTB( 1 ) .LE. UBINTB( 1 ) ) THEN
+         CALL PSX_CALLOC( NROW, '_INTEGER', IPHEAD, STATUS )
+         CALL PSX_CALLOC( NVERT, '_INTEGER', IPNEXT, STATUS )
+         CALL PSX_CALLOC( NVERT, '_INTEGER', IPEHI, STATUS )
+         CALL PSX_CALLOC( NVERT, '_INTEGER', IPACT, STATUS )
+         CALL PSX_CALLOC( NVERT, '_DOUBLE', IPX, STATUS )
+
+         CALL ARD1_POLFL( RINDEX, LBND1, UBND1, LBND2, UBND2, NVERT,
+     :                    PAR, LBINTB, UBINTB, NROW,
+     :                    %VAL( CNF_PVAL( IPHEAD ) ),
+     :                    %VAL( CNF_PVAL( IPNEXT ) ),
+     :                    %VAL( CNF_PVAL( IPEHI ) ),
+     :                    %VAL( CNF_PVAL( IPACT ) ),
+     :                    %VAL( CNF_PVAL( IPX ) ), B, STATUS )
+
+         CALL PSX_FREE( IPHEAD, STATUS )
+         CALL PSX_FREE( IPNEXT, STATUS )
+         CALL PSX_FREE( IPEHI, STATUS )
+         CALL PSX_FREE( IPACT, STATUS )
+         CALL PSX_FREE( IPX, STATUS )
+      END IF
 
 *  If the interior bounding box is null, return the usual value
 *  (VAL__MINI for LBINTB( 1 ) ).
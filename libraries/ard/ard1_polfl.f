@@ -0,0 +1,333 @@
+      SUBROUTINE ARD1_POLFL( RINDEX, LBND1, UBND1, LBND2, UBND2, NVERT,
+     :                       XY, LBINTB, UBINTB, NROW, HEAD, NEXT, EHI,
+     :                       ACT, XCROSS, B, STATUS )
+*+
+*  Name:
+*     ARD1_POLFL
+
+*  Purpose:
+*     Fill a polygon within a 2-dimensional mask.
+
+*  Language:
+*     Starlink Fortran 77
+
+*  Invocation:
+*     CALL ARD1_POLFL( RINDEX, LBND1, UBND1, LBND2, UBND2, NVERT, XY,
+*                      LBINTB, UBINTB, NROW, HEAD, NEXT, EHI, ACT,
+*                      XCROSS, B, STATUS )
+
+*  Description:
+*     The supplied value is assigned to all pixels within the supplied
+*     bounding box that have centres inside the polygon. Other pixels
+*     are left unchanged.
+*
+*     The mask lines are scanned in order of increasing pixel index.
+*     Before scanning starts, each polygon edge is added to a list
+*     for the first mask line that it may cross. A list of the edges
+*     that may cross the current line is then kept while the lines are
+*     scanned, adding edges when their first line is reached and
+*     removing them after their last line. This means each line is only
+*     tested against the edges that span it, rather than against every
+*     edge of the polygon. The edge crossings of each line are sorted
+*     into increasing x order as they are found. Mask pixels that lie
+*     between alternate pairs of crossings are set to the supplied
+*     value.
+
+*  Arguments:
+*     RINDEX = INTEGER (Given)
+*        The value to use to represent interior points.
+*     LBND1 = INTEGER (Given)
+*        The lower pixel index bounds of the B array on the first axis.
+*     UBND1 = INTEGER (Given)
+*        The upper pixel index bounds of the B array on the first axis.
+*     LBND2 = INTEGER (Given)
+*        The lower pixel index bounds of the B array on the second axis.
+*     UBND2 = INTEGER (Given)
+*        The upper pixel index bounds of the B array on the second axis.
+*     NVERT = INTEGER (Given)
+*        The number of polygon vertices.
+*     XY( 2, NVERT ) = DOUBLE PRECISION (Given)
+*        The pixel co-ordinates of the polygon vertices.
+*     LBINTB( 2 ) = INTEGER (Given)
+*        The lower pixel bounds of a box that contains the polygon and
+*        lies within the B array.
+*     UBINTB( 2 ) = INTEGER (Given)
+*        The upper pixel bounds of a box that contains the polygon and
+*        lies within the B array.
+*     NROW = INTEGER (Given)
+*        The number of mask lines in the box given by LBINTB and UBINTB.
+*     HEAD( NROW ) = INTEGER (Returned)
+*        Work space to hold the first edge that starts on each mask line.
+*     NEXT( NVERT ) = INTEGER (Returned)
+*        Work space to hold the next edge that starts on the same mask
+*        line as each edge.
+*     EHI( NVERT ) = INTEGER (Returned)
+*        Work space to hold the last mask line that each edge may cross.
+*     ACT( NVERT ) = INTEGER (Returned)
+*        Work space to hold the edges that may cross the current line.
+*     XCROSS( NVERT ) = DOUBLE PRECISION (Returned)
+*        Work space to hold the crossings of the current line.
+*     B( LBND1:UBND1, LBND2:UBND2 ) = INTEGER (Given and Returned)
+*        The array.
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Notes:
+*     - Edge N joins vertex N to vertex N + 1, and edge NVERT joins the
+*     last vertex to the first.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful,but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version, based on the line scanning code previously
+*        in ARD1_POL.
+*     {enter_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+
+*  Type Definitions:
+      IMPLICIT NONE              ! No implicit typing
+
+*  Global Constants:
+      INCLUDE 'SAE_PAR'          ! Standard SAE constants
+      INCLUDE 'PRM_PAR'          ! VAL_ constants
+
+*  Arguments Given:
+      INTEGER RINDEX
+      INTEGER LBND1
+      INTEGER UBND1
+      INTEGER LBND2
+      INTEGER UBND2
+      INTEGER NVERT
+      DOUBLE PRECISION XY( 2, NVERT )
+      INTEGER LBINTB( 2 )
+      INTEGER UBINTB( 2 )
+      INTEGER NROW
+
+*  Arguments Returned:
+      INTEGER HEAD( NROW )
+      INTEGER NEXT( NVERT )
+      INTEGER EHI( NVERT )
+      INTEGER ACT( NVERT )
+      DOUBLE PRECISION XCROSS( NVERT )
+
+*  Arguments Given and Returned:
+      INTEGER B( LBND1:UBND1, LBND2:UBND2 )
+
+*  Status:
+      INTEGER STATUS             ! Global status
+
+*  Local Variables:
+      DOUBLE PRECISION
+     :  DY,                    ! Gap in y between adjacent vertices
+     :  PERT,                  ! Perturbation
+     :  TEST,                  ! Line-polygon intersection test
+     :  X,                     ! X pixel coordinate of a crossing
+     :  YHI,                   ! Maximum y on an edge
+     :  YL,                    ! Y pixel coordinate
+     :  YLO                    ! Minimum y on an edge
+
+      INTEGER
+     :  I, J, K, N,            ! Loop counters
+     :  JHI,                   ! Last mask line an edge may cross
+     :  JLO,                   ! First mask line an edge may cross
+     :  M,                     ! Number of edges still active
+     :  MAXX,                  ! Max. x in polygon to nearest element
+     :  MINX,                  ! Min. x in polygon to nearest element
+     :  N1, N2,                ! Vertex numbers
+     :  NACT,                  ! Number of active edges
+     :  NCROSS,                ! Number of intersections
+     :  NTEST                  ! Number of edges to test
+
+      LOGICAL                  ! True if:
+     :  ALL,                   ! All edges are to be tested
+     :  MORE                   ! Crossing not yet in place
+
+*.
+
+*  Check inherited global status.
+      IF ( STATUS .NE. SAI__OK ) RETURN
+
+*  Build the edge table. Each edge is added to the list for the first
+*  mask line that it may cross. The range of lines allows a margin of
+*  one line at each end, so that the perturbation applied to the line
+*  position below (which is always much less than one pixel) cannot
+*  cause a crossing to be missed.
+      DO K = 1, NROW
+         HEAD( K ) = 0
+      END DO
+
+      DO N1 = 1, NVERT
+         N2 = N1 + 1
+         IF( N2 .GT. NVERT ) N2 = 1
+
+         YLO = MIN( XY( 2, N1 ), XY( 2, N2 ) )
+         YHI = MAX( XY( 2, N1 ), XY( 2, N2 ) )
+         JLO = NINT( MIN( MAX( -1.0D8, YLO ), 1.0D8 ) ) - 1
+         JHI = NINT( MIN( MAX( -1.0D8, YHI ), 1.0D8 ) ) + 1
+
+*  Edges that cannot cross any of the lines in the box are ignored.
+         IF( JHI .GE. LBINTB( 2 ) .AND. JLO .LE. UBINTB( 2 ) ) THEN
+            K = MAX( JLO, LBINTB( 2 ) ) - LBINTB( 2 ) + 1
+            EHI( N1 ) = MIN( JHI, UBINTB( 2 ) )
+            NEXT( N1 ) = HEAD( K )
+            HEAD( K ) = N1
+         END IF
+
+      END DO
+
+*  Scan the range of mask lines which cross the polygon.
+      NACT = 0
+      DO J = LBINTB( 2 ), UBINTB( 2 )
+
+*  Add the edges that start on this line to the active list.
+         N1 = HEAD( J - LBINTB( 2 ) + 1 )
+         DO WHILE( N1 .GT. 0 )
+            NACT = NACT + 1
+            ACT( NACT ) = N1
+            N1 = NEXT( N1 )
+         END DO
+
+*  Remove the edges that ended on an earlier line.
+         M = 0
+         DO N = 1, NACT
+            IF( EHI( ACT( N ) ) .GE. J ) THEN
+               M = M + 1
+               ACT( M ) = ACT( N )
+            END IF
+         END DO
+         NACT = M
+
+*  Store the Y pixel coordinate at the vertical centre of the mask
+*  line.
+         YL = DBLE( J ) - 0.5
+
+*  Problems occur in counting the number of intersections if any array
+*  line passes exactly through a polygon vertex. Therefore, the line
+*  positions are shifted by a negligible amount PERT to ensure this
+*  does not happen.
+         PERT = 1.0D-4
+
+*  Loop back to here with a new value for PERT if the current value
+*  causes a vertex to fall exactly on the current line. Initialise the
+*  number of times the current line intersects the polygon. In the
+*  unlikely event that the line has been moved so far that it could
+*  cross edges outside the active list, test every edge.
+  20     CONTINUE
+         NCROSS = 0
+         ALL = ( PERT .GT. 0.5D0 )
+         IF( ALL ) THEN
+            NTEST = NVERT
+         ELSE
+            NTEST = NACT
+         END IF
+
+*  Test each edge to see if it intersects the array line.
+         DO N = 1, NTEST
+            IF( ALL ) THEN
+               N1 = N
+            ELSE
+               N1 = ACT( N )
+            END IF
+            N2 = N1 + 1
+
+*  Polygon vertices cycle back to the start.
+            IF( N2 .GT. NVERT ) N2 = 1
+
+*  Form the intersection test.
+            TEST = ( ( XY( 2, N1 ) - YL ) - PERT ) *
+     :             ( ( YL - XY( 2, N2 ) ) + PERT )
+
+*  If TEST is zero, the line passes through a vertex. Therefore, change
+*  PERT and start again ( "the line" refers to a line through the
+*  middle of the pixel. The act of increasing PERT effectively moves the
+*  line a small amount in the +ve Y direction).
+            IF( ABS( TEST ) .LT. VAL__SMLD ) THEN
+               PERT = PERT + 1.0D-4
+               GO TO 20
+
+*  If TEST is positive, adjacent vertices lie on opposite sides of the
+*  array line. Calculate the point of intersection (as a pixel
+*  coordinate).
+            ELSE IF( TEST .GT. 0.0 ) THEN
+               DY = XY( 2, N2 ) - XY( 2, N1 )
+               IF( ABS( DY ) .LT. VAL__SMLD ) DY = SIGN( VAL__SMLD, DY )
+               X = XY( 1, N1 ) + ( YL - XY( 2, N1 ) ) *
+     :                           ( XY( 1, N2 ) - XY( 1, N1 ) ) / DY
+
+*  Insert it into the list of crossings, keeping the list in increasing
+*  x order. There are usually only a few crossings on each line.
+               NCROSS = NCROSS + 1
+               I = NCROSS
+               MORE = .TRUE.
+               DO WHILE( MORE )
+                  IF( I .EQ. 1 ) THEN
+                     MORE = .FALSE.
+                  ELSE IF( XCROSS( I - 1 ) .LE. X ) THEN
+                     MORE = .FALSE.
+                  ELSE
+                     XCROSS( I ) = XCROSS( I - 1 )
+                     I = I - 1
+                  END IF
+               END DO
+               XCROSS( I ) = X
+
+*  End of the check for line-polygon intersections.
+            END IF
+
+*  End of the loop through the polygon edges.
+         END DO
+
+*  Scan through the ordered intersections in pairs.
+         DO N = 2, NCROSS, 2
+
+*  Find the pixel index bounds corresponding to the current section of
+*  the current mask line. The bounds are limited to the bounds of the
+*  smallest rectangle enclosing the polygon. The end pixels are included
+*  if their centres fall within the intersection.
+            MINX = NINT( MIN( MAX( -1.0D8, XCROSS( N - 1 )  ),
+     :                        1.0D8 ) ) + 1
+            MINX = MAX( MINX, LBINTB( 1 ) )
+
+            MAXX = NINT( MIN( MAX( -1.0D8, XCROSS( N ) ), 1.0D8 ) )
+            MAXX = MIN( MAXX, UBINTB( 1 ) )
+
+*  Set mask pixels lying between each pair of intersections to the
+*  supplied value.
+            DO I = MINX, MAXX
+               B( I, J ) = RINDEX
+            END DO
+
+*  Do the next pair of interesections of the polygon with the current
+*  mask line.
+         END DO
+
+*  Do the next mask line.
+      END DO
+
+      END
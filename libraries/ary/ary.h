@@ -104,6 +104,7 @@ void aryNewp( const char *ftype, int ndim, const hdsdim *ubnd, AryPlace **place,
 void aryNoacc( const char *access, Ary *ary, int *status );
 void aryOffs( Ary *ary1, Ary *ary2, int mxoffs, hdsdim *offs, int *status );
 void aryPlace( HDSLoc *loc, const char *name, AryPlace **place, int *status );
+void aryPrefetch( Ary *ary, int *status );
 void aryReset( Ary *ary, int *status );
 void arySame( Ary *ary1, Ary *ary2, int *same, int *isect, int *status );
 void arySbad( int bad, Ary *ary, int *status );
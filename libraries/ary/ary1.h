@@ -82,6 +82,7 @@ void ary1Cpy( AryACB *acb1, int temp, HDSLoc **loc, int expand, AryACB **acb2, i
 void ary1Cpync( HDSLoc *loc1, const char *name, HDSLoc *loc2, int *status );
 void ary1Crnba( AryDCB *dcb, AryACB **acb, int *status );
 void ary1Cut( AryACB *acb1, int ndim, const hdsdim *lbnd, const hdsdim *ubnd, AryACB **acb2, int *status );
+int ary1Cvfast( int bad, size_t n, const char *intype, const void *in, const char *outtype, void *out, size_t *nerr, int *status );
 void ary1Danl( int dispos, AryDCB **dcb, int *status );
 void ary1Dbad( AryDCB *dcb, int *status );
 void ary1Dbnd( AryDCB *dcb, int *status );
@@ -118,6 +119,7 @@ void ary1Mpsr( AryACB *acb, HDSLoc *loc, const char *type, const char *mode, int
 void ary1Mpsw( AryACB *acb, HDSLoc *loc, const char *type, const char *inopt, HDSLoc **mloc, int *copy, void **pntr, int *status );
 void ary1Nel( int ndim, const hdsdim *lbnd, const hdsdim *ubnd, size_t *el, int *status );
 void ary1NewOr( HDSLoc *loc, int ndim, HDSLoc **locor, int *status );
+int ary1Nthrd( size_t nel, size_t nrow );
 void ary1Pbnd( AryACB *acb, int *prim, int *status );
 void ary1Ptn( int bad, int ndim, const hdsdim *lbnda, const hdsdim *ubnda, const char *type, const void *pntr, const hdsdim *lsub, const hdsdim *usub, const hdsdim *lbndd, const hdsdim *ubndd, const char *htype, HDSLoc *loc, int *dce, int *status );
 void ary1Rebnd( int defer, HDSLoc *paren, const char *name, const char *type, int state, int ndim, const hdsdim *lbnd, const hdsdim *ubnd, int nndim, const hdsdim *nlbnd, const hdsdim *nubnd, HDSLoc **loc, int *same, int *drx, hdsdim *lx, hdsdim *ux, int *status );
@@ -75,6 +75,9 @@ void ary1Chbpp( AryACB *acb, int *bad, int *status ) {
 *  History:
 *     03-JUL-2017 (DSB):
 *        Original version, based on equivalent Fortran routine by RFWS.
+*     14-OCT-2026:
+*        Remember the result of checking the whole of an unmapped data
+*        object in the DCB, and use it for later checks.
 
 *-
 */
@@ -82,6 +85,13 @@ void ary1Chbpp( AryACB *acb, int *bad, int *status ) {
 /* Local variables: */
    AryDCB *dcb;               /* Data object (DCB) */
    AryMCB *mcb;               /* Mapping Control Block (MCB) */
+   hdsdim lmrb[ARY__MXDIM];   /* Lower mapping region bounds */
+   hdsdim lmtr[ARY__MXDIM];   /* Lower mapping transfer region bounds */
+   hdsdim umrb[ARY__MXDIM];   /* Upper mapping region bounds */
+   hdsdim umtr[ARY__MXDIM];   /* Upper mapping transfer region bounds */
+   int mrfull;                /* Mapping region full of data? */
+   int mtrex;                 /* Mapping transfer region exists? */
+   int whole;                 /* Mapping region is whole object? */
    size_t el;                 /* Number of data elements in the array */
    void *dpntr;               /* Pointer to mapped non-imaginary data */
    void *ipntr;               /* Pointer to mapped imaginary data */
@@ -126,32 +136,50 @@ void ary1Chbpp( AryACB *acb, int *bad, int *status ) {
          if( !dcb->state ){
             *bad = 1;
 
-/* Otherwise, map the array for read access. */
+/* Otherwise, see if the result of a previous check of the whole data
+   object can be used. It can if the array is the whole object, or if no
+   bad values were found and the array lies entirely within the object. */
          } else {
-            ary1Maps( acb, dcb->type, dcb->complex, "READ", NULL, &dpntr,
-                      &ipntr, status );
+            ary1Gmrb( acb, &mtrex, &mrfull, &whole, lmrb, umrb, lmtr, umtr,
+                      status );
+            if( *status == SAI__OK && dcb->kchk &&
+                ( whole || ( !dcb->chkbad && mrfull ) ) ){
+               *bad = dcb->chkbad;
+
+/* Otherwise, map the array for read access. */
+            } else {
+               ary1Maps( acb, dcb->type, dcb->complex, "READ", NULL, &dpntr,
+                         &ipntr, status );
 
 /* If access could not be obtained, then add context information to the
    error report. */
-            if( *status != SAI__OK ){
-               errRep( " ", "Unable to access array values to check for bad "
-                       "pixels.", status );
-            }
+               if( *status != SAI__OK ){
+                  errRep( " ", "Unable to access array values to check for "
+                          "bad pixels.", status );
+               }
 
 /* Examine the non-imaginary mapped data for bad pixels. */
-            ary1Bpp( dcb->type, el, dpntr, bad, status );
-            if( *status == SAI__OK ){
+               ary1Bpp( dcb->type, el, dpntr, bad, status );
+               if( *status == SAI__OK ){
 
 /* If the array is complex, and no bad pixels have yet been found, then the
    imaginary component of the mapped data must be examined in the same
    way. */
-               if( dcb->complex && ( !bad ) ){
-                  ary1Bpp( dcb->type, el, ipntr, bad, status );
+                  if( dcb->complex && ( !*bad ) ){
+                     ary1Bpp( dcb->type, el, ipntr, bad, status );
+                  }
                }
-            }
 
 /* Unmap the array. */
-            ary1Umps( acb, status );
+               ary1Umps( acb, status );
+
+/* If the whole data object was checked, and no other access is currently
+   writing to it, remember the result in the DCB. */
+               if( *status == SAI__OK && whole && dcb->nwrite == 0 ){
+                  dcb->chkbad = *bad;
+                  dcb->kchk = 1;
+               }
+            }
          }
       }
    }
@@ -0,0 +1,168 @@
+#include "sae_par.h"
+#include "ary1.h"
+#include "prm_par.h"
+#include <math.h>
+#include <string.h>
+
+/* Macro to define a loop that converts a vector of values from type
+   "Tin" to type "Tout", when every value of type "Tin" can be represented
+   exactly in type "Tout". The loop has no early exits and no function
+   calls, so that the compiler can vectorise it. */
+#define WIDEN(Tin,Tout,BadIn,BadOut) { \
+   const Tin *pin = (const Tin *) in; \
+   Tout *pout = (Tout *) out; \
+   if( bad ) { \
+      for( i = 0; i < n; i++ ) { \
+         pout[ i ] = ( pin[ i ] == BadIn ) ? BadOut : (Tout) pin[ i ]; \
+      } \
+   } else { \
+      for( i = 0; i < n; i++ ) pout[ i ] = (Tout) pin[ i ]; \
+   } \
+}
+
+int ary1Cvfast( int bad, size_t n, const char *intype, const void *in,
+                const char *outtype, void *out, size_t *nerr,
+                int *status ) {
+/*
+*+
+*  Name:
+*     ary1Cvfast
+
+*  Purpose:
+*     Convert a vectorised array between common data types quickly.
+
+*  Synopsis:
+*     int ary1Cvfast( int bad, size_t n, const char *intype,
+*                     const void *in, const char *outtype, void *out,
+*                     size_t *nerr, int *status )
+
+*  Description:
+*     This function converts a vectorised array for the commonest pairs
+*     of data types used when mapping arrays (_WORD or _UWORD to _INTEGER,
+*     _REAL or _DOUBLE, _INTEGER to _DOUBLE, _REAL to _DOUBLE and
+*     _DOUBLE to _REAL). Except for _DOUBLE to _REAL, every input value
+*     can be represented exactly in the output type, and so the
+*     conversion is done by simple loops that the compiler can vectorise,
+*     in place of the general VEC routines, which check every element for
+*     overflow. The results are the same as those produced by the VEC
+*     routines.
+*
+*     For any other pair of data types, nothing is done and zero is
+*     returned, in which case the caller should use the VEC routines.
+
+*  Parameters:
+*     bad
+*        Whether to check for bad pixel values.
+*     n
+*        Number of array elements to convert.
+*     intype
+*        The data type of the input array, in upper case.
+*     in
+*        Pointer to the input vectorised array.
+*     outtype
+*        The data type of the output array, in upper case.
+*     out
+*        Pointer to the output vectorised array.
+*     nerr
+*        Returned holding the number of data conversion errors that
+*        occurred. A bad value is stored in each affected element. Only
+*        _DOUBLE to _REAL conversions can give errors. No error is
+*        reported.
+*     status
+*        The global status.
+
+*  Returned Value:
+*     Non-zero if the conversion was done, and zero if the pair of data
+*     types is not handled by this function.
+
+*  Copyright:
+*      Copyright (C) 2026 East Asian Observatory
+*      All rights reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful,but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+
+*-
+*/
+
+/* Local variables: */
+   size_t i;                  /* Element index */
+   size_t nbad;               /* Number of out of range values */
+
+   *nerr = 0;
+
+/* Check inherited global status. */
+   if( *status != SAI__OK ) return 0;
+
+/* Test for each handled pair of data types. */
+   if( !strcmp( intype, "_WORD" ) ) {
+      if( !strcmp( outtype, "_INTEGER" ) ) {
+         WIDEN(short int,int,VAL__BADW,VAL__BADI)
+      } else if( !strcmp( outtype, "_REAL" ) ) {
+         WIDEN(short int,float,VAL__BADW,VAL__BADR)
+      } else if( !strcmp( outtype, "_DOUBLE" ) ) {
+         WIDEN(short int,double,VAL__BADW,VAL__BADD)
+      } else {
+         return 0;
+      }
+
+   } else if( !strcmp( intype, "_UWORD" ) ) {
+      if( !strcmp( outtype, "_INTEGER" ) ) {
+         WIDEN(unsigned short int,int,VAL__BADUW,VAL__BADI)
+      } else if( !strcmp( outtype, "_REAL" ) ) {
+         WIDEN(unsigned short int,float,VAL__BADUW,VAL__BADR)
+      } else if( !strcmp( outtype, "_DOUBLE" ) ) {
+         WIDEN(unsigned short int,double,VAL__BADUW,VAL__BADD)
+      } else {
+         return 0;
+      }
+
+   } else if( !strcmp( intype, "_INTEGER" ) &&
+              !strcmp( outtype, "_DOUBLE" ) ) {
+      WIDEN(int,double,VAL__BADI,VAL__BADD)
+
+   } else if( !strcmp( intype, "_REAL" ) &&
+              !strcmp( outtype, "_DOUBLE" ) ) {
+      WIDEN(float,double,VAL__BADR,VAL__BADD)
+
+/* _DOUBLE to _REAL can overflow. Out of range values (including NaNs)
+   are set bad and counted, as the VEC routines do. */
+   } else if( !strcmp( intype, "_DOUBLE" ) &&
+              !strcmp( outtype, "_REAL" ) ) {
+      const double *pin = (const double *) in;
+      float *pout = (float *) out;
+      nbad = 0;
+      for( i = 0; i < n; i++ ) {
+         if( bad && pin[ i ] == VAL__BADD ) {
+            pout[ i ] = VAL__BADR;
+         } else {
+            int ok = ( fabs( pin[ i ] ) <= VAL__MAXR );
+            pout[ i ] = ok ? (float) pin[ i ] : VAL__BADR;
+            nbad += !ok;
+         }
+      }
+      *nerr = nbad;
+
+   } else {
+      return 0;
+   }
+
+   return 1;
+}
@@ -58,6 +58,9 @@ void ary1Dbad( AryDCB *dcb, int *status ) {
 *  History:
 *     03-JUL-2017 (DSB):
 *        Original version, based on equivalent Fortran routine by RFWS.
+*     14-OCT-2026:
+*        Lock the DCB state mutex so that several threads can use the DCB
+*        at once.
 
 *-
 */
@@ -72,6 +75,10 @@ void ary1Dbad( AryDCB *dcb, int *status ) {
 /* Check inherited global status. */
    if( *status != SAI__OK ) return;
 
+/* Prevent other threads changing the DCB while the information is
+   obtained. */
+   ARY__DCB_LOCK_STATE(dcb)
+
 /* Do nothing if bad pixel information is already available. */
    if( !dcb->kbad ){
 
@@ -150,6 +157,9 @@ L999:
       dcb->kbad = ( *status == SAI__OK );
    }
 
+/* Allow other threads to access the DCB. */
+   ARY__DCB_UNLOCK_STATE(dcb)
+
 /* Call error tracing routine and exit. */
    if( *status != SAI__OK ) ary1Trace( "ary1Dbad", status );
 
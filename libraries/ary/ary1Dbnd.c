@@ -66,6 +66,9 @@ void ary1Dbnd( AryDCB *dcb, int *status ) {
 *        we want such people to be able to read new NDFs (relying on the
 *        automatic type conversion provided by HDS to convert _INT64 to
 *        _INTEGER when the ORIGIN values are accessed).
+*     14-OCT-2026:
+*        Lock the DCB state mutex so that several threads can use the DCB
+*        at once.
 
 *-
 */
@@ -87,6 +90,10 @@ void ary1Dbnd( AryDCB *dcb, int *status ) {
 /* Check inherited global status. */
    if( *status != SAI__OK ) return;
 
+/* Prevent other threads changing the DCB while the information is
+   obtained. */
+   ARY__DCB_LOCK_STATE(dcb)
+
 /* Do nothing if bounds information is ready available in the DCB. */
    if( !dcb->kbnd ){
 
@@ -290,6 +297,9 @@ L999:
       dcb->kbnd = ( *status == SAI__OK );
    }
 
+/* Allow other threads to access the DCB. */
+   ARY__DCB_UNLOCK_STATE(dcb)
+
 /* Call error tracing routine and exit. */
    if( *status != SAI__OK ) ary1Trace( "ary1Dbnd", status );
 
@@ -249,6 +249,8 @@ void ary1Dcpy( AryDCB *dcb1, int temp, HDSLoc **loc, AryDCB **dcb2, int *status
 /* Copy the bad pixel flag and data type information. */
          (*dcb2)->bad = dcb1->bad;
          (*dcb2)->kbad = dcb1->kbad;
+         (*dcb2)->chkbad = dcb1->chkbad;
+         (*dcb2)->kchk = dcb1->kchk;
          strcpy( (*dcb2)->type, dcb1->type );
          (*dcb2)->complex = dcb1->complex;
          (*dcb2)->ktype = dcb1->ktype;
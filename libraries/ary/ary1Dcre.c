@@ -186,6 +186,7 @@ void ary1Dcre( int defer, const char *type, int cmplx, int ndim,
 /* The array is created with a bad pixel flag value of 1. */
          (*dcb)->bad = 1;
          (*dcb)->kbad = 1;
+         (*dcb)->kchk = 0;
 
 /* Store the data type (and complexity) information in upper case. */
          strncpy( (*dcb)->type, type, DAT__SZTYP + 1 ) ;
@@ -186,6 +186,7 @@ void ary1Dcrep( int defer, const char *type, int ndim, const hdsdim *ubnd,
 /* Set the bad pixel flag to 1. */
          (*dcb)->bad = 1;
          (*dcb)->kbad = 1;
+         (*dcb)->kchk = 0;
 
 /* Store the data type (and complexity) information in upper case. */
          strncpy( (*dcb)->type, type, DAT__SZTYP + 1 ) ;
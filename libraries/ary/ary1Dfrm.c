@@ -59,6 +59,9 @@ void ary1Dfrm( AryDCB *dcb, int *status ) {
 *  History:
 *     03-JUL-2017 (DSB):
 *        Original version, based on equivalent Fortran routine by RFWS.
+*     14-OCT-2026:
+*        Lock the DCB state mutex so that several threads can use the DCB
+*        at once.
 
 *-
 */
@@ -75,6 +78,10 @@ void ary1Dfrm( AryDCB *dcb, int *status ) {
 /* Check inherited global status. */
    if( *status != SAI__OK ) return;
 
+/* Prevent other threads changing the DCB while the information is
+   obtained. */
+   ARY__DCB_LOCK_STATE(dcb)
+
 /* If the form information is unknown, then inspect the data object. */
    if( !dcb->kform ){
 
@@ -209,6 +216,9 @@ void ary1Dfrm( AryDCB *dcb, int *status ) {
       dcb->kform = ( *status == SAI__OK );
    }
 
+/* Allow other threads to access the DCB. */
+   ARY__DCB_UNLOCK_STATE(dcb)
+
 /* Call error tracing routine and exit. */
    if( *status != SAI__OK ) ary1Trace( "ary1Dfrm", status );
 
@@ -117,6 +117,7 @@ void ary1Dimp( HDSLoc *loc, AryDCB **dcb, int *status ) {
       (*dcb)->kmode = 0;
       (*dcb)->kstate = 0;
       (*dcb)->kbad = 0;
+      (*dcb)->kchk = 0;
       (*dcb)->kscl = 0;
 
 /* Initialise the reference and mapping counts and set the disposal mode to
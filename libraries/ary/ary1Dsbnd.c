@@ -302,8 +302,10 @@ void ary1Dsbnd( int ndim, const hdsdim *lbnd, const hdsdim *ubnd, AryDCB *dcb,
       dcb->ndim = ndim;
    }
 
-/* Note if bounds information is now available in the DCB. */
+/* Note if bounds information is now available in the DCB. Any previous
+   check for bad values no longer applies. */
    dcb->kbnd = ( *status == SAI__OK );
+   dcb->kchk = 0;
 
 /* Call error tracing routine and exit. */
    if( *status != SAI__OK ) ary1Trace( "ary1Dsbnd", status );
@@ -58,6 +58,9 @@ void ary1Dscl( AryDCB *dcb, int *status ) {
 *  History:
 *     03-JUL-2017 (DSB):
 *        Original version, based on equivalent Fortran routine.
+*     14-OCT-2026:
+*        Lock the DCB state mutex so that several threads can use the DCB
+*        at once.
 
 *-
 */
@@ -69,6 +72,10 @@ void ary1Dscl( AryDCB *dcb, int *status ) {
 /* Check inherited global status. */
    if( *status != SAI__OK ) return;
 
+/* Prevent other threads changing the DCB while the information is
+   obtained. */
+   ARY__DCB_LOCK_STATE(dcb)
+
 /* Do nothing if scaling information is already available in the DCB. */
    if( !dcb->kscl ){
 
@@ -145,6 +152,9 @@ void ary1Dscl( AryDCB *dcb, int *status ) {
       }
    }
 
+/* Allow other threads to access the DCB. */
+   ARY__DCB_UNLOCK_STATE(dcb)
+
 /* Call error tracing routine and exit. */
    if( *status != SAI__OK ) ary1Trace( "ary1Dscl", status );
 
@@ -59,6 +59,9 @@ void ary1Dsta( AryDCB *dcb, int *status ) {
 *  History:
 *     03-JUL-2017 (DSB):
 *        Original version, based on equivalent Fortran routine by RFWS.
+*     14-OCT-2026:
+*        Lock the DCB state mutex so that several threads can use the DCB
+*        at once.
 
 *-
 */
@@ -66,6 +69,10 @@ void ary1Dsta( AryDCB *dcb, int *status ) {
 /* Check inherited global status. */
    if( *status != SAI__OK ) return;
 
+/* Prevent other threads changing the DCB while the information is
+   obtained. */
+   ARY__DCB_LOCK_STATE(dcb)
+
 /* Do nothing if state information is already available in the DCB. */
    if( !dcb->kstate ){
 
@@ -122,6 +129,9 @@ L999:
       if( *status == SAI__OK ) dcb->init = dcb->state;
    }
 
+/* Allow other threads to access the DCB. */
+   ARY__DCB_UNLOCK_STATE(dcb)
+
 /* Call error tracing routine and exit. */
    if( *status != SAI__OK ) ary1Trace( "ary1Dsta", status );
 
@@ -325,8 +325,11 @@ void ary1Dstp( const char *type, int cmplx, AryDCB *dcb, int *dce,
          dcb->complex = cmplx;
       }
 
-/* Note whether the information is up to date. */
+/* Note whether the information is up to date. The type conversion may
+   have introduced bad values, so any previous check for them no longer
+   applies. */
       dcb->ktype = ( *status == SAI__OK );
+      dcb->kchk = 0;
    }
 
 /* Call error tracing routine and exit. */
@@ -94,6 +94,8 @@ void *ary1Ffs( AryBlockType type, int *status ) {
 *  History:
 *     28-JUL-2017 (DSB):
 *        Original version.
+*     14-OCT-2026:
+*        Create a recursive state mutex for each new DCB.
 
 *-
 */
@@ -107,6 +109,7 @@ void *ary1Ffs( AryBlockType type, int *status ) {
    int i;                     /* Loop counter for slots */
    int oldsize;               /* Original size of array */
    pthread_mutex_t *mutex;    /* Pointer to mutex for selected array */
+   pthread_mutexattr_t attr;  /* Attributes for DCB state mutexes */
    size_t size;               /* Size of each structure in array */
 
 /* Set an initial value for the returned pointer. */
@@ -227,6 +230,17 @@ void *ary1Ffs( AryBlockType type, int *status ) {
                   result->used = 0;
                   result->slot = i;
                   result->type = type;
+
+/* Each DCB has its own recursive mutex, used to serialise changes to the
+   state information it holds. */
+                  if( type == ARY__DCBTYPE ) {
+                     pthread_mutexattr_init( &attr );
+                     pthread_mutexattr_settype( &attr,
+                                                PTHREAD_MUTEX_RECURSIVE );
+                     pthread_mutex_init( &( (AryDCB *) result )->mutex,
+                                         &attr );
+                     pthread_mutexattr_destroy( &attr );
+                  }
                } else {
                   break;
                }
@@ -81,6 +81,8 @@ void ary1Maps( AryACB *acb, const char *type, int cmplx, const char *mmod,
 *  History:
 *     03-JUL-2017 (DSB):
 *        Original version, based on equivalent Fortran routine by RFWS.
+*     14-OCT-2026:
+*        Lock the DCB state mutex while changing the mapping counts.
 
 *-
 */
@@ -303,13 +305,20 @@ void ary1Maps( AryACB *acb, const char *type, int cmplx, const char *mmod,
             if( cmplx ) *ipntr = mcb->ipntr;
 
 /* Increment the counts of current READ and WRITE mapped access to the data
-   object. */
+   object. Another thread may be mapping a different section of the same
+   data object at the same time, so lock the DCB state mutex first. */
+            ARY__DCB_LOCK_STATE(dcb)
             if( !strcmp( mode, "READ" ) || !strcmp( mode, "UPDATE" ) ){
                (dcb->nread)++;
             }
             if( !strcmp( mode, "WRITE" ) || !strcmp( mode, "UPDATE" ) ){
                (dcb->nwrite)++;
+
+/* The data values may now change, so forget the result of any previous
+   check for bad values. */
+               dcb->kchk = 0;
             }
+            ARY__DCB_UNLOCK_STATE(dcb)
 
 /* Store the mapping access type and mode information in the MCB. */
             ary1Ccpy( vtype, sizeof(mcb->type), mcb->type, status );
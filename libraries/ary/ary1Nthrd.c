@@ -0,0 +1,91 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include "ary1.h"
+#include "ary_dlt.h"
+
+int ary1Nthrd( size_t nel, size_t nrow ) {
+/*
+*+
+*  Name:
+*     ary1Nthrd
+
+*  Purpose:
+*     Choose the number of threads to use to process a DELTA array.
+
+*  Synopsis:
+*     int ary1Nthrd( size_t nel, size_t nrow )
+
+*  Description:
+*     This function returns the number of threads that should be used to
+*     compress or uncompress the whole of a DELTA array, sharing its
+*     hyper-rows between the threads. Small arrays are processed in a
+*     single thread, since the cost of starting threads would exceed the
+*     saving. The number of threads may be limited by setting environment
+*     variable ARY_THREADS; a value of 1 or 0 causes all arrays to be
+*     processed in a single thread. Otherwise, the number of processor
+*     cores is used as the limit.
+
+*  Parameters:
+*     nel
+*        The number of values in the uncompressed array.
+*     nrow
+*        The number of hyper-rows in the uncompressed array.
+
+*  Returned Value:
+*     The number of threads to use. This is never more than
+*     ARY1__DLT_MXTHR or "nrow".
+
+*  Copyright:
+*      Copyright (C) 2026 East Asian Observatory
+*      All rights reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful,but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version, moved out of ary1Undlt so that it can also be
+*        used by ary1S2dlt.
+
+*-
+*/
+
+/* Local Variables: */
+   const char *env;
+   long int result;
+
+/* Get the upper limit on the number of threads. */
+   env = getenv( "ARY_THREADS" );
+   if( env ) {
+      result = strtol( env, NULL, 10 );
+   } else {
+#ifdef _SC_NPROCESSORS_ONLN
+      result = sysconf( _SC_NPROCESSORS_ONLN );
+#else
+      result = 1;
+#endif
+   }
+
+/* Ensure each thread gets enough values to make threading worthwhile. */
+   if( result > (long int)( nel/ARY1__DLT_MINEL ) ) {
+      result = nel/ARY1__DLT_MINEL;
+   }
+   if( result > ARY1__DLT_MXTHR ) result = ARY1__DLT_MXTHR;
+   if( result > (long int) nrow ) result = nrow;
+   if( result < 1 ) result = 1;
+
+   return (int) result;
+}
@@ -1,3 +1,4 @@
+#include <pthread.h>
 #include "sae_par.h"
 #include "mers.h"
 #include "star/hds.h"
@@ -6,6 +7,7 @@
 #include "ary.h"
 #include "ary_err.h"
 #include "ary_dlt.h"
+#include "ary1.h"
 
 /* Macros */
 /* ------ */
@@ -35,6 +37,42 @@ typedef  void (*delt_fun_type)( void *, size_t, size_t, void *, void *, hdsdim *
 typedef  void (*check_fun_type)( void *, size_t, size_t, size_t *, hdsdim *,
                                  hdsdim *, size_t *, int * );
 
+/* Structure used to pass information to a thread that checks or
+   compresses a range of hyper-rows of the input array. */
+typedef struct Ary1S2dltData {
+   int oper;                  /* 1 = check rows, 2 = compress rows */
+   check_fun_type check_fun;  /* Function that checks a hyper-row */
+   delt_fun_type delt_fun;    /* Function that compresses a hyper-row */
+   char *ptr_indata;          /* Pointer to the mapped input array */
+   char *ptr_data;            /* Pointer to the mapped DATA array */
+   char *ptr_value;           /* Pointer to the mapped VALUE array */
+   hdsdim *ptr_repeat;        /* Pointer to the mapped REPEAT array */
+   hdsdim *ptr_firstd;        /* Pointer to the mapped FIRST_DATA array */
+   hdsdim *ptr_firstv;        /* Pointer to the mapped FIRST_VALUE array */
+   hdsdim *ptr_firstr;        /* Pointer to the mapped FIRST_REPEAT array */
+   size_t size_intype;        /* Bytes per input value */
+   size_t size_outtype;       /* Bytes per DATA value */
+   int ndim;                  /* Number of axes */
+   const hdsdim *dims;        /* Input array dimensions */
+   const size_t *strides;     /* Input array strides, in bytes */
+   int zaxis;                 /* Zero-based compression axis */
+   size_t zdim;               /* Length of the compression axis */
+   size_t zstride;            /* Input stride along the compression axis */
+   size_t row1;               /* Index of first hyper-row to process */
+   size_t row2;               /* Index of last hyper-row to process, +1 */
+   hdsdim idata;              /* Index of the row1 values within DATA */
+   hdsdim ivalue;             /* Index of the row1 values within VALUE */
+   hdsdim irepeat;            /* Index of the row1 values within REPEAT */
+   size_t ndata;              /* Number of DATA values for the rows */
+   hdsdim nvalue;             /* Number of VALUE values for the rows */
+   hdsdim nrepeat;            /* Number of REPEAT values for the rows */
+   size_t max_repeat;         /* Largest repeat count in the rows */
+   int status;                /* Status for the thread */
+} Ary1S2dltData;
+
+static void *ary1S2dltRows( void *data );
+static void ary1S2dltRun( Ary1S2dltData *tdata, int nthread, int *status );
+
 
 /* Prototypes for private functions defined within this file. */
 /* ---------------------------------------------------------- */
@@ -130,7 +168,7 @@ void ary1S2dlt( HDSLoc *loc1, int zaxis, const char *type, HDSLoc *loc2,
 *        The global status.
 
 *  Copyright:
-*     Copyright (C) 2017 East Asian Observatory
+*     Copyright (C) 2017,2026 East Asian Observatory
 *     All rights reserved.
 
 *  Licence:
@@ -156,6 +194,9 @@ void ary1S2dlt( HDSLoc *loc1, int zaxis, const char *type, HDSLoc *loc2,
 *  History:
 *     03-JUL-2017 (DSB):
 *        Original version, based on equivalent ARY routine.
+*     14-OCT-2026:
+*        Share the hyper-rows of large arrays between several threads
+*        when creating a compressed array.
 *     {enter_changes_here}
 
 *  Bugs:
@@ -192,10 +233,12 @@ void ary1S2dlt( HDSLoc *loc1, int zaxis, const char *type, HDSLoc *loc2,
    int idim;
    hdsdim irepeat;
    int isprim;
+   int ithread;
    hdsdim ivalue;
    size_t max_repeat;
    size_t ndata;
    int ndim;
+   int nthread;
    hdsdim nrepeat;
    hdsdim nvalue;
    int row_inc;
@@ -220,6 +263,7 @@ void ary1S2dlt( HDSLoc *loc1, int zaxis, const char *type, HDSLoc *loc2,
    size_t size_outtype;
    size_t stride_indata[ ARY__MXDIM ];
    size_t zstride;
+   Ary1S2dltData tdata[ ARY1__DLT_MXTHR ];
 
 /* Initialise */
    *zratio = 1.0;
@@ -497,10 +541,61 @@ void ary1S2dlt( HDSLoc *loc1, int zaxis, const char *type, HDSLoc *loc2,
 /* Abort if an error has occurred. */
    if( *status != SAI__OK ) goto L999;
 
+/* The hyper-rows are compressed independently of each other, so if an
+   output array is being created from a large input array the hyper-rows
+   are shared between several threads. See how many threads to use. */
+   nthread = loc2 ? ary1Nthrd( nel_indata, nel_first ) : 1;
+
+/* If required, give each thread a contiguous range of hyper-rows and
+   get each thread to count the DATA, VALUE and REPEAT values needed to
+   describe its rows. */
+   if( nthread > 1 ) {
+      for( ithread = 0; ithread < nthread; ithread++ ) {
+         tdata[ ithread ].oper = 1;
+         tdata[ ithread ].check_fun = check_fun;
+         tdata[ ithread ].delt_fun = delt_fun;
+         tdata[ ithread ].ptr_indata = ptr_indata;
+         tdata[ ithread ].size_intype = size_intype;
+         tdata[ ithread ].size_outtype = size_outtype;
+         tdata[ ithread ].ndim = ndim;
+         tdata[ ithread ].dims = dims_indata;
+         tdata[ ithread ].strides = stride_indata;
+         tdata[ ithread ].zaxis = zaxis;
+         tdata[ ithread ].zdim = zdim;
+         tdata[ ithread ].zstride = zstride;
+         tdata[ ithread ].row1 = ( ithread*nel_first )/nthread;
+         tdata[ ithread ].row2 = ( ( ithread + 1 )*nel_first )/nthread;
+         tdata[ ithread ].idata = 0;
+         tdata[ ithread ].ivalue = 0;
+         tdata[ ithread ].irepeat = 0;
+         tdata[ ithread ].max_repeat = 0;
+      }
+      ary1S2dltRun( tdata, nthread, status );
+
+/* Combine the counts from all threads, recording where the values for
+   each range of rows will start within the output arrays. Every row
+   has been checked. */
+      for( ithread = 0; ithread < nthread; ithread++ ) {
+         tdata[ ithread ].idata = idata;
+         tdata[ ithread ].ivalue = ivalue;
+         tdata[ ithread ].irepeat = irepeat;
+         idata += tdata[ ithread ].ndata;
+         ivalue += tdata[ ithread ].nvalue;
+         irepeat += tdata[ ithread ].nrepeat;
+         if( tdata[ ithread ].max_repeat > max_repeat ) {
+            max_repeat = tdata[ ithread ].max_repeat;
+         }
+      }
+      ntest_row = nel_first;
+      if( *status != SAI__OK ) goto L999;
+
+/* Otherwise, check the rows in the current thread. */
+   } else {
+
 /* Check the first row to see how many elements are required to
    describe it within the DATA, VALUE and REPEAT arrays. */
-   (*check_fun)( ptr_indata + iv_indata, zdim, zstride, &ndata, &nvalue,
-                 &nrepeat, &max_repeat, status );
+      (*check_fun)( ptr_indata + iv_indata, zdim, zstride, &ndata, &nvalue,
+                    &nrepeat, &max_repeat, status );
 
 /* If we are not creating an output array, we can base the returned
    compression estimate on a subset of the data, on the assumption that
@@ -508,55 +603,56 @@ void ary1S2dlt( HDSLoc *loc1, int zaxis, const char *type, HDSLoc *loc2,
    across the data set. This speeds things up. Find the increment in row
    number that will mean about 20% of the data is tested, and find the
    resulting number of test rows. */
-   if( !loc2 && nel_first > 5 ) {
-      row_inc = 5;
-   } else {
-      row_inc = 1;
-   }
+      if( !loc2 && nel_first > 5 ) {
+         row_inc = 5;
+      } else {
+         row_inc = 1;
+      }
 
 /* Get the index of the next row to be checked. */
-   next_row = row_inc;
-   ntest_row = 1;
+      next_row = row_inc;
+      ntest_row = 1;
 
 /* Loop round all remaining rows of pixels that are parallel to the
    compression axis. */
-   for( irow = 1; irow < nel_first; irow++ ) {
+      for( irow = 1; irow < nel_first; irow++ ) {
 
 /* Increment the number of DATA, VALUE and REPEAT values required so far. */
-      idata += ndata;
-      ivalue += nvalue;
-      irepeat += nrepeat;
+         idata += ndata;
+         ivalue += nvalue;
+         irepeat += nrepeat;
 
 /* Update the pixel indices at the start of the row so that they refer
    to the next row of the input array. Also update the vector index into
    the input array at which the row starts. */
-      idim = 0;
-      iv_indata += stride_indata[ idim ];
-      while( ++start[ idim ] > dims_cindata[ idim ] ) {
-         iv_indata += div_indata[ idim ];
-         start[ idim ] = 1;
-         idim++;
-      }
+         idim = 0;
+         iv_indata += stride_indata[ idim ];
+         while( ++start[ idim ] > dims_cindata[ idim ] ) {
+            iv_indata += div_indata[ idim ];
+            start[ idim ] = 1;
+            idim++;
+         }
 
 /* Check the next row to see how many elements are required to describe it
    within the DATA, VALUE and REPEAT arrays. */
-      if( irow == next_row ) {
-         (*check_fun)( ptr_indata + iv_indata, zdim, zstride, &ndata,
-                       &nvalue, &nrepeat, &max_repeat, status );
-         next_row += row_inc;
-         ntest_row++;
-      } else {
-         ndata = 0;
-         nvalue = 0;
-         nrepeat = 0;
+         if( irow == next_row ) {
+            (*check_fun)( ptr_indata + iv_indata, zdim, zstride, &ndata,
+                          &nvalue, &nrepeat, &max_repeat, status );
+            next_row += row_inc;
+            ntest_row++;
+         } else {
+            ndata = 0;
+            nvalue = 0;
+            nrepeat = 0;
+         }
       }
-   }
 
 
 /* Finalise the number of DATA, VALUE and REPEAT values required. */
-   idata += ndata;
-   ivalue += nvalue;
-   irepeat += nrepeat;
+      idata += ndata;
+      ivalue += nvalue;
+      irepeat += nrepeat;
+   }
 
 
 
@@ -660,7 +756,23 @@ void ary1S2dlt( HDSLoc *loc1, int zaxis, const char *type, HDSLoc *loc2,
 
 /* We can skip this section if we are not actually creating an output
    compressed array. */
-   if( loc2 && *status == SAI__OK ) {
+   if( loc2 && *status == SAI__OK && nthread > 1 ) {
+
+/* If the rows were counted in several threads, get the same threads to
+   compress them, each starting at the position within the DATA, VALUE
+   and REPEAT arrays found above. */
+      for( ithread = 0; ithread < nthread; ithread++ ) {
+         tdata[ ithread ].oper = 2;
+         tdata[ ithread ].ptr_data = ptr_data;
+         tdata[ ithread ].ptr_value = ptr_value;
+         tdata[ ithread ].ptr_repeat = ptr_repeat;
+         tdata[ ithread ].ptr_firstd = ptr_firstd;
+         tdata[ ithread ].ptr_firstv = ptr_firstv;
+         tdata[ ithread ].ptr_firstr = ptr_firstr;
+      }
+      ary1S2dltRun( tdata, nthread, status );
+
+   } else if( loc2 && *status == SAI__OK ) {
 
 /* Initialise the vector index (into the input array) at the start of the
    current row of pixels parallel to the compression axis. */
@@ -718,8 +830,10 @@ void ary1S2dlt( HDSLoc *loc1, int zaxis, const char *type, HDSLoc *loc2,
                       ptr_value, ptr_repeat, &ndata, &nvalue, &nrepeat,
                       status );
       }
+   }
 
 /* Store the compressed ratio in the DELTA array. */
+   if( loc2 && *status == SAI__OK ) {
       datNew0R( loc2, "ZRATIO", status );
       datFind( loc2, "ZRATIO", &loc_temp, status );
       datPut0R( loc_temp, *zratio, status );
@@ -1463,3 +1577,182 @@ MAKE_FUNB(B,char)
 
 
 
+
+
+
+
+
+
+
+static void *ary1S2dltRows( void *data ) {
+/*
+*  Name:
+*     ary1S2dltRows
+
+*  Purpose:
+*     Check or compress a range of hyper-rows of an array.
+
+*  Invocation:
+*     void *ary1S2dltRows( void *data )
+
+*  Description:
+*     This function checks or compresses a contiguous range of hyper-rows
+*     of an array that is being delta compressed in several threads. It
+*     is used as the start routine for each worker thread, and is also
+*     called directly by ary1S2dltRun. Errors are indicated by the
+*     "status" value within the supplied structure.
+*
+*     If "oper" is 1, the numbers of DATA, VALUE and REPEAT values needed
+*     to describe the rows, and the largest repeat count, are returned in
+*     the structure. If "oper" is 2, the rows are compressed, storing the
+*     values in the output arrays starting at the indices given by
+*     "idata", "ivalue" and "irepeat", and storing the index of the first
+*     value for each row in the FIRST_xxx arrays.
+
+*  Arguments:
+*     data
+*        Pointer to an Ary1S2dltData structure describing the arrays and
+*        the range of hyper-rows to process.
+
+*  Returned Value:
+*     NULL.
+
+*/
+
+/* Local Variables: */
+   Ary1S2dltData *pdata = (Ary1S2dltData *) data;
+   hdsdim *prepeat;
+   hdsdim idata;
+   hdsdim irepeat;
+   hdsdim ivalue;
+   hdsdim nrepeat;
+   hdsdim nvalue;
+   int idim;
+   size_t ndata;
+   size_t offset;
+   size_t rem;
+   size_t row;
+
+/* Initialise the indices into the DATA, VALUE and REPEAT arrays. */
+   idata = pdata->idata;
+   ivalue = pdata->ivalue;
+   irepeat = pdata->irepeat;
+   if( pdata->oper == 1 ) {
+      pdata->ndata = 0;
+      pdata->nvalue = 0;
+      pdata->nrepeat = 0;
+   }
+
+/* Loop round each hyper-row. */
+   for( row = pdata->row1; row < pdata->row2 && pdata->status == SAI__OK;
+        row++ ) {
+
+/* Find the offset in bytes from the start of the input array to the
+   first element in the hyper-row. The hyper-row index is a vector index
+   into the array of rows, which has the same axes as the input array
+   except for the compression axis. */
+      rem = row;
+      offset = 0;
+      for( idim = 0; idim < pdata->ndim; idim++ ) {
+         if( idim != pdata->zaxis ) {
+            offset += ( rem % pdata->dims[ idim ] )*pdata->strides[ idim ];
+            rem /= pdata->dims[ idim ];
+         }
+      }
+
+/* Either count the values needed for the hyper-row... */
+      if( pdata->oper == 1 ) {
+         (*pdata->check_fun)( pdata->ptr_indata + offset, pdata->zdim,
+                              pdata->zstride, &ndata, &nvalue, &nrepeat,
+                              &pdata->max_repeat, &pdata->status );
+         pdata->ndata += ndata;
+         pdata->nvalue += nvalue;
+         pdata->nrepeat += nrepeat;
+
+/* ...or compress it, noting where its values start. */
+      } else {
+         pdata->ptr_firstd[ row ] = idata;
+         pdata->ptr_firstv[ row ] = ivalue;
+         if( pdata->ptr_firstr ) pdata->ptr_firstr[ row ] = irepeat;
+
+         prepeat = pdata->ptr_repeat ? pdata->ptr_repeat + irepeat : NULL;
+         (*pdata->delt_fun)( pdata->ptr_indata + offset, pdata->zdim,
+                             pdata->zstride,
+                             pdata->ptr_data + idata*pdata->size_outtype,
+                             pdata->ptr_value + ivalue*pdata->size_intype,
+                             prepeat, &ndata, &nvalue, &nrepeat,
+                             &pdata->status );
+         idata += ndata;
+         ivalue += nvalue;
+         irepeat += nrepeat;
+      }
+   }
+
+   return NULL;
+}
+
+static void ary1S2dltRun( Ary1S2dltData *tdata, int nthread, int *status ) {
+/*
+*  Name:
+*     ary1S2dltRun
+
+*  Purpose:
+*     Process ranges of hyper-rows in several threads.
+
+*  Invocation:
+*     void ary1S2dltRun( Ary1S2dltData *tdata, int nthread, int *status )
+
+*  Description:
+*     This function calls ary1S2dltRows for each of the supplied
+*     structures, each in a separate thread, and waits for them all to
+*     complete. The first range is processed in the current thread. If a
+*     thread cannot be started, its range is also processed in the
+*     current thread.
+
+*  Arguments:
+*     tdata
+*        Array of "nthread" structures describing the work to be done by
+*        each thread.
+*     nthread
+*        The number of threads to use.
+*     status
+*        The global status.
+
+*/
+
+/* Local Variables: */
+   int ithread;
+   int started[ ARY1__DLT_MXTHR ];
+   pthread_t threads[ ARY1__DLT_MXTHR ];
+
+/* Check inherited status. */
+   if( *status != SAI__OK ) return;
+
+/* Start the threads. */
+   for( ithread = 0; ithread < nthread; ithread++ ) {
+      tdata[ ithread ].status = SAI__OK;
+      started[ ithread ] = ( ithread > 0 &&
+                             !pthread_create( threads + ithread, NULL,
+                                              ary1S2dltRows,
+                                              tdata + ithread ) );
+   }
+
+/* Wait for them to finish, processing any ranges that were not given to
+   a thread in the current thread. */
+   for( ithread = 0; ithread < nthread; ithread++ ) {
+      if( started[ ithread ] ) {
+         pthread_join( threads[ ithread ], NULL );
+      } else {
+         ary1S2dltRows( tdata + ithread );
+      }
+   }
+
+/* Report any errors. */
+   for( ithread = 0; ithread < nthread; ithread++ ) {
+      if( tdata[ ithread ].status != SAI__OK && *status == SAI__OK ) {
+         *status = tdata[ ithread ].status;
+         errRep( "", "ary1S2dlt: Failed to compress a range of hyper-rows "
+                 "in a worker thread.", status );
+      }
+   }
+}
@@ -81,6 +81,8 @@ void ary1Umps( AryACB *acb, int *status ) {
 *  History:
 *     03-JUL-2017 (DSB):
 *        Original version, based on equivalent Fortran routine by RFWS.
+*     14-OCT-2026:
+*        Lock the DCB state mutex while changing the read mapping count.
 
 *-
 */
@@ -125,9 +127,12 @@ void ary1Umps( AryACB *acb, int *status ) {
             ary1Upsr( mcb->icopy, &mcb->iloc, status );
          }
 
-/* Decrement the data object mapping count. */
+/* Decrement the data object mapping count, locking the DCB state mutex
+   since other threads may be accessing the same data object. */
          if( *status == SAI__OK ){
+            ARY__DCB_LOCK_STATE(dcb)
             dcb->nread--;
+            ARY__DCB_UNLOCK_STATE(dcb)
          }
 
 /* If the array is mapped for WRITE or UPDATE access, then unmap the
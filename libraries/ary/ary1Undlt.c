@@ -1,3 +1,4 @@
+#include <pthread.h>
 #include "sae_par.h"
 #include "mers.h"
 #include "star/hds.h"
@@ -6,6 +7,7 @@
 #include "ary.h"
 #include "ary_err.h"
 #include "ary_dlt.h"
+#include "ary1.h"
 
 
 /* Macros */
@@ -32,6 +34,39 @@ typedef  void (*undelt_fun_type)( void *, size_t, size_t, void *, void *,
                                   void *, hdsdim *, void *, size_t, int *,
                                   size_t *, size_t *, size_t *, int * );
 
+/* Structure used to pass information to a thread that uncompresses a
+   range of hyper-rows of a DELTA array. */
+typedef struct Ary1UndltData {
+   undelt_fun_type undelt_fun; /* Function that uncompresses a hyper-row */
+   char *ptr_data;            /* Pointer to the mapped DATA array */
+   char *ptr_value;           /* Pointer to the mapped VALUE array */
+   hdsdim *ptr_repeat;        /* Pointer to the mapped REPEAT array */
+   hdsdim *ptr_firstd;        /* Pointer to the mapped FIRST_DATA array */
+   hdsdim *ptr_firstv;        /* Pointer to the mapped FIRST_VALUE array */
+   hdsdim *ptr_firstr;        /* Pointer to the mapped FIRST_REPEAT array */
+   size_t nel_data;           /* Length of DATA array */
+   size_t nel_value;          /* Length of VALUE array */
+   size_t nel_repeat;         /* Length of REPEAT array */
+   size_t nel_first;          /* Length of the FIRST_XXX arrays */
+   size_t size_intype;        /* Bytes per DATA value */
+   size_t size_vtype;         /* Bytes per VALUE value */
+   size_t size_outtype;       /* Bytes per uncompressed value */
+   char *scale_buf;           /* Buffer holding SCALE value */
+   char *zero_buf;            /* Buffer holding ZERO value */
+   char *pntr;                /* Pointer to the uncompressed array */
+   int ndim;                  /* Number of axes */
+   const hdsdim *dims;        /* Uncompressed array dimensions */
+   int zaxis;                 /* Zero-based compression axis */
+   size_t zstride;            /* Output stride along the compression axis */
+   size_t row1;               /* Index of first hyper-row to uncompress */
+   size_t row2;               /* Index of last hyper-row to uncompress, +1 */
+   int bad;                   /* Were any bad values stored? */
+   int is_invalid;            /* 1, 2 or 3 if DATA, VALUE or REPEAT is bad */
+   int status;                /* Status for the thread */
+} Ary1UndltData;
+
+static void *ary1UndltRows( void *data );
+
 
 /* Prototypes for private functions defined within this file. */
 /* ---------------------------------------------------------- */
@@ -328,6 +363,9 @@ void ary1Undlt( HDSLoc *loc1, int ndim_in, const hdsdim *lbnd,
 *     12-NOV-2017 (DSB):
 *        Original version, derived from the ary_undlt.c file in the
 *        original Fortran version of the ARY library.
+*     14-OCT-2026:
+*        Share the hyper-rows of large arrays that are uncompressed in
+*        full between several threads.
 *     {enter_changes_here}
 
 *  Bugs:
@@ -347,6 +385,7 @@ void ary1Undlt( HDSLoc *loc1, int ndim_in, const hdsdim *lbnd,
    HDSLoc *loc_zaxis = NULL;
    HDSLoc *loc_zdim = NULL;
    HDSLoc *loc_zero = NULL;
+   Ary1UndltData tdata[ ARY1__DLT_MXTHR ];
    char *pdata;
    char *ptr_data = NULL;
    char *ptr_value = NULL;
@@ -378,9 +417,12 @@ void ary1Undlt( HDSLoc *loc1, int ndim_in, const hdsdim *lbnd,
    int bad;
    int idim;
    int is_invalid;
+   int ithread;
    int ndim;
    int ndim_firstr;
    int ndim_firstv;
+   int nthread;
+   int started[ ARY1__DLT_MXTHR ];
    int there;
    int whole;
    int zaxis;
@@ -403,6 +445,7 @@ void ary1Undlt( HDSLoc *loc1, int ndim_in, const hdsdim *lbnd,
    size_t nel_value;
    size_t nprovided;
    size_t nrepeat_used;
+   size_t nrow;
    size_t nvalue_used;
    size_t offset;
    size_t size_intype;
@@ -411,6 +454,7 @@ void ary1Undlt( HDSLoc *loc1, int ndim_in, const hdsdim *lbnd,
    size_t stride_cwhole[ ARY__MXDIM ];
    size_t stride_section[ ARY__MXDIM ];
    size_t zstride;
+   pthread_t threads[ ARY1__DLT_MXTHR ];
    undelt_fun_type undelt_fun;
 
 /* Initialise */
@@ -685,12 +729,17 @@ void ary1Undlt( HDSLoc *loc1, int ndim_in, const hdsdim *lbnd,
 #undef CHOOSE_FUNB
 #undef CHOOSE_FUNC
 
-/* If the whole array is being uncompressed, and the compression axis
-   is the first axis (so that no jumping around is required within the
-   output array), we can disregard the three FIRST_xxx arrays. Uncompress all
-   pixels, from first to last, in a single call, placing the uncompressed
-   values in the output DATA array. */
-   if( whole && zaxis == 0 ) {
+/* The hyper-rows can be uncompressed independently of each other, so a
+   large array that is being uncompressed in full is shared between
+   several threads. See how many threads to use. */
+   nthread = whole ? ary1Nthrd( nel_out, nel_out/zdim ) : 1;
+
+/* If the whole array is being uncompressed in a single thread, and the
+   compression axis is the first axis (so that no jumping around is
+   required within the output array), we can disregard the three FIRST_xxx
+   arrays. Uncompress all pixels, from first to last, in a single call,
+   placing the uncompressed values in the output DATA array. */
+   if( whole && zaxis == 0 && nthread == 1 ) {
       (*undelt_fun)( ptr_data, 0, nel_out - 1, scale_buf, zero_buf, ptr_value,
                      ptr_repeat, pntr, 1, &bad, &ndata_used, &nvalue_used,
                      &nrepeat_used, status );
@@ -731,7 +780,8 @@ void ary1Undlt( HDSLoc *loc1, int ndim_in, const hdsdim *lbnd,
 
 /* If only part of the array is being uncompressed, we decompress just
    those hyper-rows that pass through the required section of the
-   uncompressed array. */
+   uncompressed array. The FIRST_xxx arrays are also needed if the
+   hyper-rows are to be shared between threads. */
    } else {
 
 /* So far we have no evidence that the file is invalid. */
@@ -812,11 +862,97 @@ void ary1Undlt( HDSLoc *loc1, int ndim_in, const hdsdim *lbnd,
          }
       }
 
-/* We will loop round, uncompressing the required section of the whole
-   array row-by-row (where each row is parallel to the compression axis),
-   and copying the required part of each uncompressed row into the output
-   array. We only uncompress rows that intersect the required section specified
-   by lbnd and ubnd. */
+/* If required, share the hyper-rows between threads. Each thread
+   uncompresses a contiguous range of hyper-rows directly into the output
+   array. */
+      if( nthread > 1 ) {
+         nrow = nel_firstd;
+         for( ithread = 0; ithread < nthread; ithread++ ) {
+            tdata[ ithread ].undelt_fun = undelt_fun;
+            tdata[ ithread ].ptr_data = ptr_data;
+            tdata[ ithread ].ptr_value = ptr_value;
+            tdata[ ithread ].ptr_repeat = ptr_repeat;
+            tdata[ ithread ].ptr_firstd = ptr_firstd;
+            tdata[ ithread ].ptr_firstv = ptr_firstv;
+            tdata[ ithread ].ptr_firstr = ptr_firstr;
+            tdata[ ithread ].nel_data = nel_data;
+            tdata[ ithread ].nel_value = nel_value;
+            tdata[ ithread ].nel_repeat = nel_repeat;
+            tdata[ ithread ].nel_first = nel_firstd;
+            tdata[ ithread ].size_intype = size_intype;
+            tdata[ ithread ].size_vtype = size_vtype;
+            tdata[ ithread ].size_outtype = size_outtype;
+            tdata[ ithread ].scale_buf = scale_buf;
+            tdata[ ithread ].zero_buf = zero_buf;
+            tdata[ ithread ].pntr = pntr;
+            tdata[ ithread ].ndim = ndim;
+            tdata[ ithread ].dims = dims;
+            tdata[ ithread ].zaxis = zaxis;
+            tdata[ ithread ].zstride = 1;
+            for( idim = 0; idim < zaxis; idim++ ) {
+               tdata[ ithread ].zstride *= dims[ idim ];
+            }
+            tdata[ ithread ].row1 = ( ithread*nrow )/nthread;
+            tdata[ ithread ].row2 = ( ( ithread + 1 )*nrow )/nthread;
+            tdata[ ithread ].bad = 0;
+            tdata[ ithread ].is_invalid = 0;
+            tdata[ ithread ].status = SAI__OK;
+
+/* The first range is uncompressed in the current thread, once the other
+   threads have been started. If a thread cannot be started, its range is
+   also uncompressed in the current thread. */
+            started[ ithread ] = ( ithread > 0 &&
+                                   !pthread_create( threads + ithread, NULL,
+                                                    ary1UndltRows,
+                                                    tdata + ithread ) );
+         }
+
+         for( ithread = 0; ithread < nthread; ithread++ ) {
+            if( started[ ithread ] ) {
+               pthread_join( threads[ ithread ], NULL );
+            } else {
+               ary1UndltRows( tdata + ithread );
+            }
+         }
+
+/* Combine the results from all threads. */
+         for( ithread = 0; ithread < nthread; ithread++ ) {
+            if( tdata[ ithread ].bad ) bad = 1;
+            if( !is_invalid ) is_invalid = tdata[ ithread ].is_invalid;
+            if( tdata[ ithread ].status != SAI__OK && *status == SAI__OK ) {
+               *status = tdata[ ithread ].status;
+               errRep( "", "ary1Undlt: Failed to uncompress a range of "
+                       "hyper-rows in a worker thread.", status );
+            }
+         }
+
+/* Issue a warning if the numbers of values supplied in the DATA, VALUE
+   or REPEAT arrays are different to the numbers required to uncompress
+   the data array. */
+         if( is_invalid == 1 ) {
+            datMsg( "A", loc1 );
+            msgOut( "", "Warning: The compressed array '^A' appears to be "
+                    "invalid - the number of compressed values does not "
+                    "equal the number referenced in the array.", status );
+         } else if( is_invalid == 2 ) {
+            datMsg( "A", loc1 );
+            msgOut( "", "Warning: The compressed array '^A' appears to be "
+                    "invalid - the number of explicitly supplied uncompressed "
+                    "values does not equal the number referenced in the array.",
+                    status );
+         } else if( is_invalid == 3 ) {
+            datMsg( "A", loc1 );
+            msgOut( "", "Warning: The compressed array '^A' appears to be "
+                    "invalid - the number of stored repeat counts does "
+                    "not equal the number referenced in the array.", status );
+         }
+
+/* Otherwise, we will loop round in the current thread, uncompressing the
+   required section of the whole array row-by-row (where each row is
+   parallel to the compression axis), and copying the required part of
+   each uncompressed row into the output array. We only uncompress rows
+   that intersect the required section specified by lbnd and ubnd. */
+      } else {
 
 /* Collapse the section bounds to its lower bound on the compression
    axis. Also get the dimensions of the whole uncompressed array, collapsed
@@ -827,49 +963,49 @@ void ary1Undlt( HDSLoc *loc1, int ndim_in, const hdsdim *lbnd,
    and initialise the pixel indices of the current pixel (the "current
    pixel" is the pixel at the start of the row which is currently being
    uncompressed). */
-      nel_csection = 1;
-      for( idim = 0; idim < ndim; idim++ ) {
-         start[ idim ] = lbnd_csection[ idim ] = lbnd[ idim ];
-         dims_section[ idim ] = ubnd[ idim ] - lbnd[ idim ] + 1;
-         if( idim != zaxis ) {
-            ubnd_csection[ idim ] = ubnd[ idim ];
-            lbnd_cwhole[ idim ] = lbnd[ idim ];
-            nel_csection *= dims_section[ idim ];
-            dims_cwhole[ idim ] = dims[ idim ];
-            dims_csection[ idim ] = dims_section[ idim ];
-         } else {
-            ubnd_csection[ idim ] = lbnd[ idim ];
-            lbnd_cwhole[ idim ] = 1;
-            dims_cwhole[ zaxis ] = 1;
-            dims_csection[ idim ] = 1;
+         nel_csection = 1;
+         for( idim = 0; idim < ndim; idim++ ) {
+            start[ idim ] = lbnd_csection[ idim ] = lbnd[ idim ];
+            dims_section[ idim ] = ubnd[ idim ] - lbnd[ idim ] + 1;
+            if( idim != zaxis ) {
+               ubnd_csection[ idim ] = ubnd[ idim ];
+               lbnd_cwhole[ idim ] = lbnd[ idim ];
+               nel_csection *= dims_section[ idim ];
+               dims_cwhole[ idim ] = dims[ idim ];
+               dims_csection[ idim ] = dims_section[ idim ];
+            } else {
+               ubnd_csection[ idim ] = lbnd[ idim ];
+               lbnd_cwhole[ idim ] = 1;
+               dims_cwhole[ zaxis ] = 1;
+               dims_csection[ idim ] = 1;
+            }
          }
-      }
 
 /* To avoid valgrind warnings caused by the fact that the loop over
    rows advances to read one step beyond the last row (but doesn't write
    anything because the loop then terminates). */
-      start[ idim ] = -1;
-      ubnd_csection[ idim ] = 1;
+         start[ idim ] = -1;
+         ubnd_csection[ idim ] = 1;
 
 /* Initialise the zero-based vector index of the current pixel into the
    collapsed whole array. Also find the strides between adjacent elements
    on each axis of the collapsed whole array and the uncollapsed section. */
-      stride_cwhole[ 0 ] = 1;               /* Units of array elements */
-      stride_section[ 0 ] = size_outtype;   /* Units of bytes (actually "chars") */
-      iv_cwhole = lbnd_cwhole[ 0 ] - 1;
-      for( idim = 1; idim < ndim; idim++ ) {
-         stride_cwhole[ idim ] = stride_cwhole[ idim - 1 ]*dims_cwhole[ idim - 1 ];
-         stride_section[ idim ] = stride_section[ idim - 1 ]*dims_section[ idim - 1 ];
-         iv_cwhole += ( lbnd_cwhole[ idim ] - 1 )*stride_cwhole[ idim ];
-      }
+         stride_cwhole[ 0 ] = 1;               /* Units of array elements */
+         stride_section[ 0 ] = size_outtype;   /* Units of bytes (actually "chars") */
+         iv_cwhole = lbnd_cwhole[ 0 ] - 1;
+         for( idim = 1; idim < ndim; idim++ ) {
+            stride_cwhole[ idim ] = stride_cwhole[ idim - 1 ]*dims_cwhole[ idim - 1 ];
+            stride_section[ idim ] = stride_section[ idim - 1 ]*dims_section[ idim - 1 ];
+            iv_cwhole += ( lbnd_cwhole[ idim ] - 1 )*stride_cwhole[ idim ];
+         }
 
 /* Note the compression axis stride in units of elements rather than bytes. */
-      zstride = stride_section[ zaxis ]/size_outtype;
+         zstride = stride_section[ zaxis ]/size_outtype;
 
 /* Initialise the vector index into the full (i.e. not collapsed) required
    section, at the point where the current row intersects the lower
    bounds of the section. This is an index into the returned output array. */
-      iv_section = 0;
+         iv_section = 0;
 
 /* Evaluate constants to avoid repeated calculation of them in the
    following loop. First, the change in vector index into the uncollapsed
@@ -879,130 +1015,131 @@ void ary1Undlt( HDSLoc *loc1, int ndim_in, const hdsdim *lbnd,
    parts; a negative one that moves the vector back to the start of the
    old axis, plus a positive one that steps up to the start of the next
    axis. */
-      for( idim = 0; idim < ndim - 1; idim++ ) {
-         div_section[ idim ] = stride_section[ idim + 1 ]
-                                - stride_section[ idim ]*dims_csection[ idim ];
-         div_cwhole[ idim ] = stride_cwhole[ idim + 1 ]
-                               - stride_cwhole[ idim ]*dims_csection[ idim ];
-      }
-      div_section[ idim ] = 1;
-      div_cwhole[ idim ] = 1;
+         for( idim = 0; idim < ndim - 1; idim++ ) {
+            div_section[ idim ] = stride_section[ idim + 1 ]
+                                   - stride_section[ idim ]*dims_csection[ idim ];
+            div_cwhole[ idim ] = stride_cwhole[ idim + 1 ]
+                                  - stride_cwhole[ idim ]*dims_csection[ idim ];
+         }
+         div_section[ idim ] = 1;
+         div_cwhole[ idim ] = 1;
 
 /* Abort if an error has occurred. */
-      if( *status != SAI__OK ) goto L999;
+         if( *status != SAI__OK ) goto L999;
 
 /*  Loop round all pixels in the collapsed section. The "start" array
     holds the pixel indices of the pixel where the row that is currently
     being uncompressed intersects the lower bounds of the required section. */
-      last_csection = nel_csection - 1;
-      for( iv_csection = 0; iv_csection < nel_csection; iv_csection++ ) {
+         last_csection = nel_csection - 1;
+         for( iv_csection = 0; iv_csection < nel_csection; iv_csection++ ) {
 
 /* If we are copying the whole data array, we will already have mapped
    the DATA array, so just get a pointer into it that points to the first
    element needed for the current row. */
-         if( whole ) {
-            offset = ptr_firstd[ iv_cwhole ];
-            pdata = ptr_data + offset*size_intype;
+            if( whole ) {
+               offset = ptr_firstd[ iv_cwhole ];
+               pdata = ptr_data + offset*size_intype;
 
 /* Otherwise, we do not need to map the whole of the input DATA array, so
    we map each slice as needed. */
-         } else {
+            } else {
 
 /* Get the one-based indices of the first and last required element of the
    DATA array. */
-            dlb = ptr_firstd[ iv_cwhole ] + 1;
-            if( iv_csection < last_csection ) {
-               dub = ptr_firstd[ iv_cwhole + 1 ];
-            } else {
-               dub = nel_data;
-            }
+               dlb = ptr_firstd[ iv_cwhole ] + 1;
+               if( iv_csection < last_csection ) {
+                  dub = ptr_firstd[ iv_cwhole + 1 ];
+               } else {
+                  dub = nel_data;
+               }
 
 /* Get the required slice of the input DATA array and map it. */
-            datSlice( loc_data, 1, &dlb, &dub, &loc_slice, status );
-            datMapV( loc_slice, type_data, "READ", (void **) &pdata, &ndata,
-                     status );
-         }
+               datSlice( loc_data, 1, &dlb, &dub, &loc_slice, status );
+               datMapV( loc_slice, type_data, "READ", (void **) &pdata, &ndata,
+                        status );
+            }
 
 /* Get a pointer to the first element of the VALUE array that holds data
    for the current row. */
-         offset = ptr_firstv[ iv_cwhole ];
-         pvalue = ptr_value + offset*size_vtype;
+            offset = ptr_firstv[ iv_cwhole ];
+            pvalue = ptr_value + offset*size_vtype;
 
 /* Get pointers to the first element of the REPEAT array that holds data for
    the current row. */
-         if( ptr_repeat ) {
-            offset = ptr_firstr[ iv_cwhole ];
-            prepeat = ptr_repeat + offset;
-         } else {
-            prepeat = NULL;
-         }
+            if( ptr_repeat ) {
+               offset = ptr_firstr[ iv_cwhole ];
+               prepeat = ptr_repeat + offset;
+            } else {
+               prepeat = NULL;
+            }
 
 /* Uncompress the required part of the current row, putting the
    uncompressed values into the required bit of the output array. */
-         (*undelt_fun)( pdata, (size_t) lbnd[ zaxis ] - 1,
-                        (size_t) ubnd[ zaxis ] - 1, scale_buf, zero_buf,
-                        pvalue, prepeat, pntr + iv_section, zstride,
-                        &bad, &ndata_used, &nvalue_used, &nrepeat_used,
-                        status );
+            (*undelt_fun)( pdata, (size_t) lbnd[ zaxis ] - 1,
+                           (size_t) ubnd[ zaxis ] - 1, scale_buf, zero_buf,
+                           pvalue, prepeat, pntr + iv_section, zstride,
+                           &bad, &ndata_used, &nvalue_used, &nrepeat_used,
+                           status );
 
 /* Annul any DATA slice locator. */
-         if( loc_slice ) datAnnul( &loc_slice, status );
+            if( loc_slice ) datAnnul( &loc_slice, status );
 
 /* Issue a warning if the number of values supplied in the DATA array is
    different to the number required to uncompress the data array. */
-         if( !is_invalid ) {
-            nprovided = ( iv_cwhole + 1 < nel_firstd ) ? ptr_firstd[ iv_cwhole + 1 ] : nel_data;
-            nprovided -= ptr_firstd[ iv_cwhole ];
-            if( ndata_used != nprovided ) {
-               is_invalid = 1;  /* Prevents multiple warning messages */
-               datMsg( "A", loc1 );
-               msgOut( "", "Warning: The compressed array '^A' appears to be "
-                       "invalid - the number of compressed values does not "
-                       "equal the number referenced in the array.", status );
+            if( !is_invalid ) {
+               nprovided = ( iv_cwhole + 1 < nel_firstd ) ? ptr_firstd[ iv_cwhole + 1 ] : nel_data;
+               nprovided -= ptr_firstd[ iv_cwhole ];
+               if( ndata_used != nprovided ) {
+                  is_invalid = 1;  /* Prevents multiple warning messages */
+                  datMsg( "A", loc1 );
+                  msgOut( "", "Warning: The compressed array '^A' appears to be "
+                          "invalid - the number of compressed values does not "
+                          "equal the number referenced in the array.", status );
+               }
             }
-         }
 
 /* Issue a warning if the number of values supplied in the VALUE array is
    different to the number required to uncompress the data array. */
-         if( !is_invalid ) {
-            nprovided = ( iv_cwhole + 1 < nel_firstv ) ? ptr_firstv[ iv_cwhole + 1 ] : nel_value;
-            nprovided -= ptr_firstv[ iv_cwhole ];
-            if( nvalue_used != nprovided ) {
-               is_invalid = 1;  /* Prevents multiple warning messages */
-               datMsg( "A", loc1 );
-               msgOut( "", "Warning: The compressed array '^A' appears to be "
-                       "invalid - the number of explicitly supplied uncompressed "
-                       "values does not equal the number referenced in the array.",
-                       status );
+            if( !is_invalid ) {
+               nprovided = ( iv_cwhole + 1 < nel_firstv ) ? ptr_firstv[ iv_cwhole + 1 ] : nel_value;
+               nprovided -= ptr_firstv[ iv_cwhole ];
+               if( nvalue_used != nprovided ) {
+                  is_invalid = 1;  /* Prevents multiple warning messages */
+                  datMsg( "A", loc1 );
+                  msgOut( "", "Warning: The compressed array '^A' appears to be "
+                          "invalid - the number of explicitly supplied uncompressed "
+                          "values does not equal the number referenced in the array.",
+                          status );
+               }
             }
-         }
 
 /* Issue a warning if the number of values supplied in the REPEAT array is
    different to the number required to uncompress the data array. */
-         if( !is_invalid && ptr_repeat ) {
-            nprovided = ( iv_cwhole + 1 < nel_firstr ) ? ptr_firstr[ iv_cwhole + 1 ] : nel_repeat;
-            nprovided -= ptr_firstr[ iv_cwhole ];
-            if( nrepeat_used != nprovided ) {
-                  is_invalid = 1;  /* Prevents multiple warning messages */
-               datMsg( "A", loc1 );
-               msgOut( "", "Warning: The compressed array '^A' appears to be "
-                       "invalid - the number of stored repeat counts does "
-                       "not equal the number referenced in the array.", status );
+            if( !is_invalid && ptr_repeat ) {
+               nprovided = ( iv_cwhole + 1 < nel_firstr ) ? ptr_firstr[ iv_cwhole + 1 ] : nel_repeat;
+               nprovided -= ptr_firstr[ iv_cwhole ];
+               if( nrepeat_used != nprovided ) {
+                     is_invalid = 1;  /* Prevents multiple warning messages */
+                  datMsg( "A", loc1 );
+                  msgOut( "", "Warning: The compressed array '^A' appears to be "
+                          "invalid - the number of stored repeat counts does "
+                          "not equal the number referenced in the array.", status );
+               }
             }
-         }
 
 /* Update the pixel indices at the start of the row so that they refer
    to the next row. Also update the vector indices into the full (i.e. not
    collapsed) section, and into the compressed whole array, at the start
    of the next row. */
-         idim = 0;
-         iv_section += stride_section[ idim ];
-         iv_cwhole += stride_cwhole[ idim ];
-         while( ++start[ idim ] > ubnd_csection[ idim ] ) {
-            iv_section += div_section[ idim ];
-            iv_cwhole += div_cwhole[ idim ];
-            start[ idim ] = lbnd_csection[ idim ];
-            idim++;
+            idim = 0;
+            iv_section += stride_section[ idim ];
+            iv_cwhole += stride_cwhole[ idim ];
+            while( ++start[ idim ] > ubnd_csection[ idim ] ) {
+               iv_section += div_section[ idim ];
+               iv_cwhole += div_cwhole[ idim ];
+               start[ idim ] = lbnd_csection[ idim ];
+               idim++;
+            }
          }
       }
    }
@@ -1429,3 +1566,113 @@ MAKE_FUND(UB,unsigned char)
 #undef PUSH
 #undef PUSHBAD
 
+
+
+
+
+
+
+static void *ary1UndltRows( void *data ) {
+/*
+*  Name:
+*     ary1UndltRows
+
+*  Purpose:
+*     Uncompress a range of hyper-rows of a whole DELTA array.
+
+*  Invocation:
+*     void *ary1UndltRows( void *data )
+
+*  Description:
+*     This function uncompresses a contiguous range of hyper-rows of a
+*     DELTA array that is being uncompressed in full, storing the values
+*     directly in the output array. It is used as the start routine for
+*     each worker thread, and is also called directly by ary1Undlt.
+*     Errors are indicated by the "status" value within the supplied
+*     structure.
+
+*  Arguments:
+*     data
+*        Pointer to an Ary1UndltData structure describing the arrays and
+*        the range of hyper-rows to uncompress.
+
+*  Returned Value:
+*     NULL.
+
+*/
+
+/* Local Variables: */
+   Ary1UndltData *pdata = (Ary1UndltData *) data;
+   hdsdim *prepeat;
+   int idim;
+   size_t ndata_used;
+   size_t nprovided;
+   size_t nrepeat_used;
+   size_t nvalue_used;
+   size_t offset;
+   size_t rem;
+   size_t row;
+   size_t rstride;
+
+/* Loop round each hyper-row. */
+   for( row = pdata->row1; row < pdata->row2 && pdata->status == SAI__OK;
+        row++ ) {
+
+/* Find the zero-based vector index within the output array of the first
+   element in the hyper-row. The hyper-row index is a vector index into
+   the array of rows, which has the same axes as the output array except
+   for the compression axis. */
+      rem = row;
+      offset = 0;
+      rstride = 1;
+      for( idim = 0; idim < pdata->ndim; idim++ ) {
+         if( idim != pdata->zaxis ) {
+            offset += ( rem % pdata->dims[ idim ] )*rstride;
+            rem /= pdata->dims[ idim ];
+         }
+         rstride *= pdata->dims[ idim ];
+      }
+
+/* Uncompress the hyper-row. */
+      prepeat = pdata->ptr_repeat ? pdata->ptr_repeat +
+                                    pdata->ptr_firstr[ row ] : NULL;
+      (*pdata->undelt_fun)( pdata->ptr_data + pdata->ptr_firstd[ row ]*
+                                              pdata->size_intype,
+                            0, (size_t) pdata->dims[ pdata->zaxis ] - 1,
+                            pdata->scale_buf, pdata->zero_buf,
+                            pdata->ptr_value + pdata->ptr_firstv[ row ]*
+                                               pdata->size_vtype,
+                            prepeat,
+                            pdata->pntr + offset*pdata->size_outtype,
+                            pdata->zstride, &pdata->bad, &ndata_used,
+                            &nvalue_used, &nrepeat_used, &pdata->status );
+
+/* Check that the number of values used from the DATA, VALUE and REPEAT
+   arrays equals the number provided for the hyper-row. */
+      if( !pdata->is_invalid ) {
+         nprovided = ( row + 1 < pdata->nel_first ) ?
+                     pdata->ptr_firstd[ row + 1 ] : pdata->nel_data;
+         if( ndata_used != nprovided - pdata->ptr_firstd[ row ] ) {
+            pdata->is_invalid = 1;
+         }
+      }
+
+      if( !pdata->is_invalid ) {
+         nprovided = ( row + 1 < pdata->nel_first ) ?
+                     pdata->ptr_firstv[ row + 1 ] : pdata->nel_value;
+         if( nvalue_used != nprovided - pdata->ptr_firstv[ row ] ) {
+            pdata->is_invalid = 2;
+         }
+      }
+
+      if( !pdata->is_invalid && pdata->ptr_repeat ) {
+         nprovided = ( row + 1 < pdata->nel_first ) ?
+                     pdata->ptr_firstr[ row + 1 ] : pdata->nel_repeat;
+         if( nrepeat_used != nprovided - pdata->ptr_firstr[ row ] ) {
+            pdata->is_invalid = 3;
+         }
+      }
+   }
+
+   return NULL;
+}
@@ -67,6 +67,11 @@ extern pthread_mutex_t Ary_MCB_mutex;
 #define ARY__MCB_LOCK_MUTEX pthread_mutex_lock( &Ary_MCB_mutex );
 #define ARY__MCB_UNLOCK_MUTEX pthread_mutex_unlock( &Ary_MCB_mutex );
 
+/* Macros to lock and unlock the mutex that serialises changes to the
+   state information held in a single DCB. */
+#define ARY__DCB_LOCK_STATE(dcb) pthread_mutex_lock( &(dcb)->mutex );
+#define ARY__DCB_UNLOCK_STATE(dcb) pthread_mutex_unlock( &(dcb)->mutex );
+
 
 /* Maximum number of dimensions for which the data system (HDS) is
    capable of "slicing" a primitive object. */
@@ -260,6 +265,14 @@ typedef struct AryDCB {
    int kbad;
    int bad;
 
+/* Bad pixel check: If the DCB is in use and the "kchk" value is non-zero,
+   then "chkbad" holds the result of the last explicit check of every
+   value in the data object for "bad" values (non-zero if any were
+   found). This allows repeated checks to be skipped. "kchk" is reset to
+   zero whenever the data values may change. */
+   int kchk;
+   int chkbad;
+
 /* Dimensionality and bounds information: If the DCB is in use and the
    "kbnd" value is non-zero, then the "ndim" value holds the number of
    dimensions of the data object and "lbnd" and "ubnd" hold its lower and
@@ -300,6 +313,13 @@ typedef struct AryDCB {
    char file[ ARY__SZFIL + 1 ];
    char path[ ARY__SZPTH + 1 ];
 
+/* State mutex: A recursive mutex that serialises changes made to the
+   lazily evaluated information and the mapping counts in the DCB. This
+   allows several threads, each holding a read-only lock on the data
+   object, to access sections of the same array at the same time. It is
+   created when the DCB is first allocated and is never destroyed. */
+   pthread_mutex_t mutex;
+
 } AryDCB;
 
 
@@ -0,0 +1,82 @@
+#include "sae_par.h"
+#include "ary1.h"
+#include "star/hds.h"
+#include "mers.h"
+
+void aryPrefetch( Ary *ary, int *status ) {
+/*
+*+
+*  Name:
+*     aryPrefetch
+
+*  Purpose:
+*     Start reading an array from disk in the background.
+
+*  Synopsis:
+*     void aryPrefetch( Ary *ary, int *status )
+
+*  Description:
+*     This function advises the operating system that the container file
+*     holding the supplied array will soon be read, and returns
+*     immediately (see datPrefetch). A later call to aryMap need not then
+*     wait for the disk, so that opening and mapping one array can be
+*     overlapped with processing another.
+
+*  Parameters:
+*     ary
+*        Array identifier.
+*     status
+*        The global status.
+
+*  Notes:
+*     - Prefetching is advisory. No error is reported if the container
+*     file cannot be read ahead.
+
+*  Copyright:
+*      Copyright (C) 2026 East Asian Observatory
+*      All rights reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful,but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+
+*-
+*/
+
+/* Local variables: */
+   AryACB *acb;
+
+/* Check inherited global status. */
+   if( *status != SAI__OK ) return;
+
+/* Import the array identifier, and prefetch the data object. */
+   acb = (AryACB *) ary1Impid( ary, 1, 1, 1, status );
+   if( *status == SAI__OK ) datPrefetch( acb->dcb->loc, status );
+
+/* If an error occurred, then report context information and call the error
+   tracing routine. */
+   if( *status != SAI__OK ){
+      errRep( " ", "aryPrefetch: Error prefetching an array.", status );
+      ary1Trace( "aryPrefetch", status );
+   }
+
+}
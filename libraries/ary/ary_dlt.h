@@ -8,6 +8,7 @@
 
 *  Copyright:
 *     Copyright (C) 2010 Science & Technology Facilities Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -33,6 +34,8 @@
 *  History:
 *     19-OCT-2010 (DSB):
 *        Original version.
+*     14-OCT-2026:
+*        Add constants controlling the use of threads.
 *     {enter_changes_here}
 */
 
@@ -97,5 +100,9 @@
 #define MIN_DELTAB NUM__MINB
 #define MAX_DELTAB (NUM__MAXB-5)
 
-
-
+/* The smallest number of uncompressed values that each thread should
+   handle when the whole of an array is compressed or uncompressed in
+   several threads, and the maximum number of threads to use (see
+   ary1Nthrd). */
+#define ARY1__DLT_MINEL 262144
+#define ARY1__DLT_MXTHR 16
@@ -2,11 +2,16 @@
 #include "mers.h"
 #include "sae_par.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <ctype.h>
+#include <limits.h>
 #include <string.h>
 
 static AstTable *ReadNextTable( FILE *fd, const char *fname, int *iline,
                                 int *status );
+static int ParseDouble( const char *text, double *value );
+static int ParseInt( const char *text, int *value );
+static int SplitWords( char *text, char ***words, int *maxword, int *status );
 
 AstTable *atlReadTable( const char *fname, int *status ) {
 /*
@@ -55,7 +60,7 @@ AstTable *atlReadTable( const char *fname, int *status ) {
 *     - All columns in the returned Table will hold scalar values.
 
 *  Copyright:
-*     Copyright (C) 2016 East Asian Observatory.
+*     Copyright (C) 2016, 2026 East Asian Observatory.
 *     Copyright (C) 2011 Science & Technology Facilities Council.
 *     All Rights Reserved.
 
@@ -87,6 +92,11 @@ AstTable *atlReadTable( const char *fname, int *status ) {
 *     22-NOV-2016 (DSB):
 *        Report error if file has no column headers. Previously this 
 *        caused a seg fault.
+*     14-OCT-2026:
+*        Speed up reading of large files. Lines are read with fgets,
+*        data rows are split into words in place, and each cell is stored
+*        in the Table once with its final data type, rather than first
+*        as a string in an interim column.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -154,6 +164,10 @@ static AstTable *ReadNextTable( FILE *fd, const char *fname, int *iline,
 *     reaches the end of file or encounters an end-of-table marker (a line
 *     consisting just of two or more minus signs with no leading spaces).
 *     It creates an AstTable from the text and returns a pointer to it.
+*
+*     The text of each row is retained until the whole table has been
+*     read and the data type of each column is known. Each cell is then
+*     stored in the Table once, using the final column data type.
 
 *  Arguments:
 *     fd
@@ -175,20 +189,19 @@ static AstTable *ReadNextTable( FILE *fd, const char *fname, int *iline,
 /* Local Variables: */
    AstTable *result;
    AstTable *subtable;
+   char **cells;
    char **cols;
+   char **rows;
    char **words;
    char *last_com;
    char *line;
    char *p;
-   char *tname;
+   char *row;
    char key[ 200 ];
    const char *cval;
-   const char *oldname;
-   const char *newname;
    double dval;
    int *types;
    int blank;
-   int c;
    int com;
    int eot;
    int first;
@@ -198,6 +211,8 @@ static AstTable *ReadNextTable( FILE *fd, const char *fname, int *iline,
    int iword;
    int line_len;
    int max_line_len;
+   int maxrow;
+   int maxword;
    int more;
    int nc;
    int ncol;
@@ -227,66 +242,67 @@ static AstTable *ReadNextTable( FILE *fd, const char *fname, int *iline,
    more = 1;
    last_com = NULL;
    cols = NULL;
+   ncol = 0;
    first = 1;
-   irow = 0;
+   nrow = 0;
+   maxrow = 0;
+   rows = NULL;
+   cells = NULL;
    types = NULL;
+   words = NULL;
+   maxword = 0;
 
    while( more && *status == SAI__OK ) {
       (*iline)++;
-      line_len = 0;
 
-/* Loop reading characters from the file until a newline or the end of file is
-   reached. */
-      while( ( c = fgetc( fd ) ) != EOF && c != '\n' ) {
-
-/* Increment the current line length, and double the size of the line buffer
-   if it is full. */
-         if( ++line_len >= max_line_len ) {
+/* Read the next line into the line buffer, doubling the size of the buffer
+   whenever it is filled before the end of the line is reached. Remove the
+   newline. */
+      line_len = 0;
+      line[ 0 ] = 0;
+      while( fgets( line + line_len, max_line_len - line_len, fd ) ) {
+         line_len += strlen( line + line_len );
+         if( line_len > 0 && line[ line_len - 1 ] == '\n' ) {
+            line[ --line_len ] = 0;
+            break;
+         }
+         if( line_len == max_line_len - 1 ) {
             max_line_len *= 2;
             line = astRealloc( line, max_line_len*sizeof( *line ) );
             if( *status != SAI__OK ) break;
          }
-
-/* Store the character. Ignore leading white space. */
-         if( skip ) {
-            if( ! isspace( c ) ) {
-               line[ line_len - 1 ] = c;
-               skip = 0;
-            } else {
-               line_len--;
-            }
-         } else {
-            line[ line_len - 1 ] = c;
-         }
-
       }
+      if( *status != SAI__OK ) break;
 
 /* If the end-of-file was reached indicate that we should leave the main
    loop after processing the current line. */
-      if( c == EOF ) more = 0;
+      if( feof( fd ) ) more = 0;
 
-/* Terminate the line. */
-      line[ line_len ] = 0;
+/* Ignore leading white space until the first non-blank character in the
+   file has been found. */
+      p = line;
+      if( skip ) {
+         while( isspace( (unsigned char) *p ) ) p++;
+         if( *p ) skip = 0;
+      }
 
 /* Terminate it again to exclude trailing white space. */
-      line[ astChrLen( line ) ] = 0;
+      p[ astChrLen( p ) ] = 0;
 
-/* Assume the line is a blank non-comment, and store a pointer to the first
-   character to use. */
+/* Assume the line is a blank non-comment. */
       blank = 1;
       com = 0;
-      p = line;
 
 /* Skip blank lines. */
-      if( line[ 0 ] ) {
+      if( p[ 0 ] ) {
 
 /* If the line starts with a comment character... */
-         if( line[ 0 ] == '#' || line[ 0 ] == '!' ) {
+         if( p[ 0 ] == '#' || p[ 0 ] == '!' ) {
             com = 1;
 
 /* Get a pointer to the first non-space/tab character after the comment
    character. */
-            p = line + 1;
+            p++;
             while( *p == ' ' || *p == '\t' ) p++;
 
 /* Note if it is blank. */
@@ -298,7 +314,7 @@ static AstTable *ReadNextTable( FILE *fd, const char *fname, int *iline,
 
 /* See if it is the end-of-table marker - a line containing just two or
    more minus signs with no leading spaces. */
-            eot = ( strspn( line, "-" ) > 1 );
+            eot = ( strspn( p, "-" ) > 1 );
          }
       }
 
@@ -353,9 +369,6 @@ static AstTable *ReadNextTable( FILE *fd, const char *fname, int *iline,
 /* If the line is not a comment or an end of table marker ... */
          } else {
 
-/* Get the words from the row. */
-            words = astChrSplit( p, &nword );
-
 /* If this is the first non-blank non-comment line, get the column names from
    the previous non-blank comment line. */
             if( first ) {
@@ -366,25 +379,8 @@ static AstTable *ReadNextTable( FILE *fd, const char *fname, int *iline,
 /* Create an array to hold the data type for each colum, and initialise
    them to "integer". */
                   types = astMalloc( ncol*sizeof( int ) ) ;
-                  for( iword = 0; iword < nword && astOK; iword++ ) {
-                     if( iword < ncol ) {
-                        types[ iword ] = AST__INTTYPE;
-
-/* The columns are stored initially using interim names which have "T_"
-   prepended to the names given in the file. */
-                        tname = NULL;
-                        nc = 0;
-                        tname = astAppendString( tname, &nc, "T_" );
-                        tname = astAppendString( tname, &nc, cols[ iword ] );
-                        astFree( cols[ iword ] );
-                        cols[ iword ] = tname;
-
-/* Create the column definition within the returned Table. We store them
-   initially as strings and then convert to the appropriate column data type
-   later (once all rows have been read and the the data types are known). */
-                        astAddColumn( result, cols[ iword ], AST__STRINGTYPE,
-                                      0, NULL, " " );
-                     }
+                  for( icol = 0; icol < ncol && astOK; icol++ ) {
+                     types[ icol ] = AST__INTTYPE;
                   }
 
                } else if( *status == SAI__OK ) {
@@ -394,6 +390,11 @@ static AstTable *ReadNextTable( FILE *fd, const char *fname, int *iline,
                }
             }
 
+/* Take a copy of the row, and split the copy into words in place, so
+   that the words can be retained until the whole table has been read. */
+            row = astStore( NULL, p, strlen( p ) + 1 );
+            nword = SplitWords( row, &words, &maxword, status );
+
 /* Report an error if the line has the wrong number of values. */
             if( nword != ncol ) {
                if( *status == SAI__OK ) {
@@ -405,113 +406,89 @@ static AstTable *ReadNextTable( FILE *fd, const char *fname, int *iline,
                   errRep( " ", "Wrong number of values (^N) at line ^I in "
                           "file ^F (should be ^M).", status );
                }
+               row = astFree( row );
+
+/* Otherwise, extend the arrays of rows and cells if necessary, and
+   store the row. */
+            } else if( *status == SAI__OK ) {
+               if( nrow == maxrow ) {
+                  maxrow = maxrow ? 2*maxrow : 256;
+                  rows = astGrow( rows, maxrow, sizeof( *rows ) );
+                  cells = astGrow( cells, maxrow*ncol, sizeof( *cells ) );
+               }
 
-/* Otherwise increment the number of rows read. */
-            } else {
-               irow++;
-
-/* Store each string value in the table, excluding "null" strings. Also check
-   the data type of each string an dupdate the column data types if necessary. */
-               for( iword = 0; iword < nword && *status == SAI__OK; iword++ ) {
-                  if( strcmp( words[ iword ], "null" ) ) {
-                     sprintf( key, "%s(%d)", cols[ iword ], irow );
-                     astMapPut0C( result, key, words[ iword ], NULL );
-
-/* If the column is currently thought to hold integers, check that the
-   current word looks like an integer. If not, down-grade the column type
-   to double. */
-                     len = strlen( words[ iword ] );
-                     if( types[ iword ] == AST__INTTYPE ) {
-                        if( nc = 0, ( 1 != astSscanf( words[ iword ], "%d%n",
-                                                      &ival, &nc ) ) ||
-                                    ( nc < len ) ) {
+               if( *status == SAI__OK ) {
+                  rows[ nrow ] = row;
+
+/* Store a pointer to each cell value, using NULL for "null" strings. Also
+   check the data type of each string and update the column data types if
+   necessary: down-grade a column from integer to double if the current
+   word does not look like an integer, and from double to string if it
+   does not look like a double.  */
+                  for( iword = 0; iword < nword; iword++ ) {
+                     if( strcmp( words[ iword ], "null" ) ) {
+                        cells[ nrow*ncol + iword ] = words[ iword ];
+
+                        if( types[ iword ] == AST__INTTYPE &&
+                            !ParseInt( words[ iword ], &ival ) ) {
                            types[ iword ] = AST__DOUBLETYPE;
                         }
-                     }
 
-/* If the column is currently thought to hold doubles, check that the
-   current word looks like an doubler. If not, down-grade the column type
-   to string. */
-                     if( types[ iword ] == AST__DOUBLETYPE ) {
-                        if( nc = 0, ( 1 != astSscanf( words[ iword ], "%lg%n",
-                                                      &dval, &nc ) ) ||
-                                    ( nc < len ) ) {
+                        if( types[ iword ] == AST__DOUBLETYPE &&
+                            !ParseDouble( words[ iword ], &dval ) ) {
                            types[ iword ] = AST__STRINGTYPE;
                         }
+
+                     } else {
+                        cells[ nrow*ncol + iword ] = NULL;
                      }
                   }
-               }
-            }
+                  nrow++;
 
-/* Free the words returned by astChrSplit. */
-            for( iword = 0; iword < nword; iword++ ) {
-               words[ iword ] = astFree( words[ iword ] );
+               } else {
+                  row = astFree( row );
+               }
             }
-            words = astFree( words );
-
          }
       }
    }
 
-/* The entire file has now been read, and a Table created in which every
-   column holds strings. We also have flags indicating whether the values
-   in each column are all integers or doubles. Modify the type of the
-   column within the Table to match these flags. */
-   nrow = astGetI( result, "Nrow" );
+/* The entire file has now been read, and the data types of each column
+   are known. Create each column with the appropriate type and store the
+   non-null values in it. */
    for( icol = 0; icol < ncol && *status == SAI__OK; icol++ ) {
+      astAddColumn( result, cols[ icol ], types[ icol ], 0, NULL, " " );
 
-/* The column will be re-named from "T_<name>" to "<name>". */
-      oldname = cols[ icol ];
-      newname = oldname + 2;
-
-/* First convert string columns to integer columns if all the values in
-   the column look like integers. */
-      if( types[ icol ] == AST__INTTYPE ) {
-
-/* Create the new column */
-         astAddColumn( result, newname, AST__INTTYPE, 0, NULL, " " );
+      for( irow = 0; irow < nrow; irow++ ) {
+         cval = cells[ irow*ncol + icol ];
+         if( cval ) {
+            sprintf( key, "%s(%d)", cols[ icol ], irow + 1 );
 
-/* Copy each cell of the current column, converting from string to integer. */
-         for( irow = 1; irow <= nrow; irow++ ) {
-            sprintf( key, "%s(%d)", oldname, irow );
-            if( astMapGet0I( result, key, &ival ) ) {
-               sprintf( key, "%s(%d)", newname, irow );
+            if( types[ icol ] == AST__INTTYPE ) {
+               ParseInt( cval, &ival );
                astMapPut0I( result, key, ival, NULL );
-            }
-         }
 
-/* Now do double columns in the same way. */
-      } else if( types[ icol ] == AST__DOUBLETYPE ) {
-         astAddColumn( result, newname, AST__DOUBLETYPE, 0, NULL, " " );
-         for( irow = 1; irow <= nrow; irow++ ) {
-            sprintf( key, "%s(%d)", oldname, irow );
-            if( astMapGet0D( result, key, &dval ) ) {
-               sprintf( key, "%s(%d)", newname, irow );
+            } else if( types[ icol ] == AST__DOUBLETYPE ) {
+               ParseDouble( cval, &dval );
                astMapPut0D( result, key, dval, NULL );
-            }
-         }
 
-/* Copy string values without change. */
-      } else {
-         astAddColumn( result, newname, AST__STRINGTYPE, 0, NULL, " " );
-         for( irow = 1; irow <= nrow; irow++ ) {
-            sprintf( key, "%s(%d)", oldname, irow );
-            if( astMapGet0C( result, key, &cval ) ) {
-               sprintf( key, "%s(%d)", newname, irow );
+            } else {
                astMapPut0C( result, key, cval, NULL );
             }
          }
       }
-
-/* Remove the old column. */
-      astRemoveColumn( result, oldname );
-
    }
 
 /* Free resources. */
    line = astFree( line );
    last_com = astFree( last_com );
    types = astFree( types );
+   words = astFree( words );
+   cells = astFree( cells );
+   for( irow = 0; irow < nrow; irow++ ) {
+      rows[ irow ] = astFree( rows[ irow ] );
+   }
+   rows = astFree( rows );
    if( cols ) {
       for( icol = 0; icol < ncol; icol++ ) {
          cols[ icol ] = astFree( cols[ icol ] );
@@ -538,3 +515,152 @@ static AstTable *ReadNextTable( FILE *fd, const char *fname, int *iline,
    return result;
 }
 
+static int ParseDouble( const char *text, double *value ) {
+/*
+*  Name:
+*     ParseDouble
+
+*  Purpose:
+*     Convert a word to a double precision value.
+
+*  Description:
+*     This function checks that the whole of the supplied word is a
+*     floating point value, and returns the value if it is.
+
+*  Arguments:
+*     text
+*        The null-terminated word.
+*     value
+*        Pointer to the double in which to return the value.
+
+*  Returned Value:
+*     Non-zero if the word is a floating point value, zero otherwise.
+
+*/
+
+/* Local Variables: */
+   char *end;
+
+   *value = strtod( text, &end );
+   return ( end != text && *end == 0 );
+}
+
+static int ParseInt( const char *text, int *value ) {
+/*
+*  Name:
+*     ParseInt
+
+*  Purpose:
+*     Convert a word to an integer value.
+
+*  Description:
+*     This function checks that the whole of the supplied word is an
+*     optionally signed decimal integer that can be held in an int, and
+*     returns the value if it is. The digits are accumulated directly
+*     since most integer columns hold short values.
+
+*  Arguments:
+*     text
+*        The null-terminated word.
+*     value
+*        Pointer to the int in which to return the value.
+
+*  Returned Value:
+*     Non-zero if the word is an integer value, zero otherwise.
+
+*/
+
+/* Local Variables: */
+   const char *c;
+   int neg;
+   unsigned int digit;
+   unsigned int limit;
+   unsigned int result;
+
+   c = text;
+   neg = 0;
+   if( *c == '-' || *c == '+' ) neg = ( *(c++) == '-' );
+   if( !isdigit( (unsigned char) *c ) ) return 0;
+
+/* Accumulate the digits, checking that the value does not exceed the
+   largest magnitude an int can hold with the given sign. */
+   limit = neg ? (unsigned int) INT_MAX + 1u : (unsigned int) INT_MAX;
+   result = 0;
+   while( isdigit( (unsigned char) *c ) ) {
+      digit = (unsigned int)( *(c++) - '0' );
+      if( result > ( limit - digit )/10 ) return 0;
+      result = 10*result + digit;
+   }
+   if( *c ) return 0;
+
+   if( neg ) {
+      *value = ( result == (unsigned int) INT_MAX + 1u ) ? INT_MIN :
+                                                          -(int) result;
+   } else {
+      *value = (int) result;
+   }
+   return 1;
+}
+
+static int SplitWords( char *text, char ***words, int *maxword, int *status ) {
+/*
+*  Name:
+*     SplitWords
+
+*  Purpose:
+*     Split a string into words in place.
+
+*  Description:
+*     This function splits the supplied string into words delimited by
+*     white space, as astChrSplit does, but without copying them. Each
+*     word is terminated in place by writing a null over the white space
+*     that follows it, and a pointer to its first character is stored in
+*     the supplied array, which is extended as necessary.
+
+*  Arguments:
+*     text
+*        The string to split. It is modified on exit.
+*     words
+*        Address of a pointer to the array in which to store pointers to
+*        the words. The array is re-allocated if it is too small.
+*     maxword
+*        Address of an int holding the number of elements in the array.
+*        Updated if the array is re-allocated.
+*     status
+*        Pointer to the global status variable.
+
+*  Returned Value:
+*     The number of words found.
+
+*/
+
+/* Local Variables: */
+   char *c;
+   int nword;
+
+   nword = 0;
+   if( *status != SAI__OK ) return nword;
+
+   c = text;
+   while( 1 ) {
+
+/* Skip white space before the next word. */
+      while( isspace( (unsigned char) *c ) ) c++;
+      if( !*c ) break;
+
+/* Store a pointer to the start of the word. */
+      if( nword == *maxword ) {
+         *maxword = *maxword ? 2*( *maxword ) : 32;
+         *words = astGrow( *words, *maxword, sizeof( **words ) );
+         if( *status != SAI__OK ) break;
+      }
+      (*words)[ nword++ ] = c;
+
+/* Find the end of the word and terminate it. */
+      while( *c && !isspace( (unsigned char) *c ) ) c++;
+      if( !*c ) break;
+      *(c++) = 0;
+   }
+
+   return nword;
+}
@@ -50,11 +50,14 @@ Logical ems1Gepnd ( void );
 Logical ems1Gtok( const char *namstr, char *tokval, int *tkvlen );
 char *ems1Gthreadbuf( void );
 ems_msgtab_t *ems1Gmsgtab( void );
+ems_msgtab_t *ems1Gmsgtab1( void );
 ems_msgtab_t *ems1Gmsgtab2( void );
 ems_thread_data_t *ems1Ithreaddata( void );
 ems_toktab_t *ems1Gtoktab( void );
 
 void ems1Emark( void );
+void ems1Emark1( ems_msgtab_t *msgtab );
+void ems1Epend( ems_msgtab_t *msgtab, ems_toktab_t *toktab );
 void ems1Erlse( void );
 void ems1Estor( const char *param, int plen, const char *msg, int mlen,int *status);
 void ems1Estor1( ems_msgtab_t *msgtab, const char *param, int plen, const char *msg, int mlen,int *status);
@@ -70,6 +73,7 @@ void ems1Ktok (void);
 void ems1Mform( const char *text, int iposn, char *string, int strlength  );
 void ems1Mpop( void );
 void ems1Mpush( void );
+void ems1Mpush1( ems_toktab_t *toktab );
 void ems1Mrerr( const char *text, int *status );
 void ems1Mutc( const char *cvalue, char *string, int iposn, int *status );
 void ems1Prerr( const char *text, int *status );
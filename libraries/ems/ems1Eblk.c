@@ -55,6 +55,8 @@
  *     13-MAY-2008 (PWD):
  *        Use struct for message table, add spare table for emsEload
  *        to keep context.
+ *     14-OCT-2026:
+ *        Initialise msgpnd.
  *     {enter_further_changes_here}
 
  *-
@@ -74,6 +76,7 @@ static ems_msgtab_t ems_msgtab_base = {
     EMS__BASE,       /* msglev, error context level */
     SAI__OK,         /* msglst, last reported status (level 1 only) */
     EMS__BASE,       /* msgmrk, number of markers */
+    0,               /* msgpnd, number of pending contexts */
     {0},             /* msgcnt, number of messages in table by level */
     {0},             /* msgpln, error parameter string lengths  */
     {0},             /* msglen, error message string lengths */
@@ -96,6 +99,7 @@ static ems_msgtab_t ems_msgtab_base_spare = {
     EMS__BASE,       /* msglev, error context level */
     SAI__OK,         /* msglst, last reported status (level 1 only) */
     EMS__BASE,       /* msgmrk, number of markers */
+    0,               /* msgpnd, number of pending contexts */
     {0},             /* msgcnt, number of messages in table by level */
     {0},             /* msgpln, error parameter string lengths  */
     {0},             /* msglen, error message string lengths */
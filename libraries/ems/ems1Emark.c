@@ -58,6 +58,8 @@
  *     13-MAY-2008 (PWD):
  *        Use struct to access message table. Initialise thread context
  *        variables.
+ *     14-OCT-2026:
+ *        Moved the table update into ems1Emark1.
  *     {enter_further_changes_here}
 
  *  Bugs:
@@ -101,39 +103,10 @@ static pthread_mutex_t foo_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 void ems1Emark( void )
 {
-    int istat;                   /* Local status */
-    int mlen;                    /* Length of MSTR */
-    int plen;                    /* Length of PSTR */
-    char mstr[] = "Context stack overflow (EMS fault).";
-                                      /* Local error message text */
-    char pstr[] = "EMS_EMARK_CXOVF";  /* Local message name text */
-
-    ems_msgtab_t *msgtab = ems1Gmsgtab();  /* Current message table */
-
     TRACE( "ems1Emark" );
-    DEBUG( "ems1Emark", "BEFORE msglev = %d", msgtab->msglev );
-
-    /*  Check for maximum number of error context levels. */
-    if ( msgtab->msglev < EMS__MXLEV ) {
-
-        /*  Open a new error message context and set it to contain no
-         *  messages. */
-        msgtab->msglev++;
-        msgtab->msgmrk++;
-        msgtab->msgcnt[ msgtab->msgmrk ] = msgtab->msgcnt[ msgtab->msgmrk -1 ];
-    } else {
 
-        /*  Context stack full, so increment MSGLEV and stack an error
-         *  message. */
-        msgtab->msglev++;
-
-        mlen = strlen( mstr );
-        plen = strlen( pstr );
-        istat = EMS__CXOVF;
-
-        /*  Call EMS1ESTOR to stack the error message. */
-        ems1Estor( pstr, plen, mstr, mlen, &istat );
-    }
+    /*  Open the new context in the current message table. */
+    ems1Emark1( ems1Gmsgtab() );
 
 #if USE_PTHREADS
     /*  Record the ID of the initial thread, if not already done and generate
@@ -151,6 +124,5 @@ void ems1Emark( void )
 
 #endif
 
-    DEBUG( "ems1Emark", "AFTER msglev = %d", msgtab->msglev );
     return;
 }
@@ -0,0 +1,100 @@
+/*
+ *+
+ *  Name:
+ *     ems1Emark1
+
+ *  Purpose:
+ *     Mark a new context in a given error message table.
+
+ *  Language:
+ *     Starlink ANSI C
+
+ *  Invocation:
+ *     ems1Emark1( msgtab )
+
+ *  Description:
+ *     This sets a new context in the given error table so that
+ *     subsequent EMSFLUSH or EMSANNUL calls only flush or annul table
+ *     entries in this context. If the context stack is full, an error
+ *     is stored in the table and only the context level is incremented.
+
+ *  Arguments:
+ *     msgtab = ems_msgtab_t* (Given and Returned)
+ *        A message table struct.
+
+ *  Copyright:
+ *     Copyright (C) 2026 East Asian Observatory
+ *     All Rights Reserved.
+
+ *  Licence:
+ *     This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of
+ *     the License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be
+ *     useful,but WITHOUT ANY WARRANTY; without even the implied
+ *     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *     PURPOSE. See the GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program; if not, write to the Free Software
+ *     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+ *     02110-1301, USA
+
+ *  History:
+ *     14-OCT-2026:
+ *        Original version, split from ems1Emark.
+ *     {enter_further_changes_here}
+
+ *  Bugs:
+ *     {note_any_bugs_here}
+
+ *-
+ */
+
+#include <string.h>
+
+#include "ems_err.h"                 /* EMS_ error codes */
+#include "ems_par.h"                 /* EMS_ public constants */
+#include "ems_sys.h"                 /* EMS_ private constants */
+#include "ems1.h"                    /* EMS_ private functions prototypes */
+#include "ems_defs.h"                /* EMS_ message table */
+
+void ems1Emark1( ems_msgtab_t *msgtab )
+{
+    int istat;                   /* Local status */
+    int mlen;                    /* Length of MSTR */
+    int plen;                    /* Length of PSTR */
+    char mstr[] = "Context stack overflow (EMS fault).";
+                                      /* Local error message text */
+    char pstr[] = "EMS_EMARK_CXOVF";  /* Local message name text */
+
+    TRACE( "ems1Emark1" );
+    DEBUG( "ems1Emark1", "BEFORE msglev = %d", msgtab->msglev );
+
+    /*  Check for maximum number of error context levels. */
+    if ( msgtab->msglev < EMS__MXLEV ) {
+
+        /*  Open a new error message context and set it to contain no
+         *  messages. */
+        msgtab->msglev++;
+        msgtab->msgmrk++;
+        msgtab->msgcnt[ msgtab->msgmrk ] = msgtab->msgcnt[ msgtab->msgmrk -1 ];
+    } else {
+
+        /*  Context stack full, so increment MSGLEV and stack an error
+         *  message. */
+        msgtab->msglev++;
+
+        mlen = strlen( mstr );
+        plen = strlen( pstr );
+        istat = EMS__CXOVF;
+
+        /*  Call EMS1ESTOR1 to stack the error message. */
+        ems1Estor1( msgtab, pstr, plen, mstr, mlen, &istat );
+    }
+
+    DEBUG( "ems1Emark1", "AFTER msglev = %d", msgtab->msglev );
+    return;
+}
@@ -0,0 +1,82 @@
+/*
+ *+
+ *  Name:
+ *     ems1Epend
+
+ *  Purpose:
+ *     Record pending error contexts in the message and token tables.
+
+ *  Language:
+ *     Starlink ANSI C
+
+ *  Invocation:
+ *     ems1Epend( msgtab, toktab )
+
+ *  Description:
+ *     emsMark does not normally change the error message or token
+ *     tables. Instead it increments a count of pending contexts, which
+ *     emsRlse decrements again, so that marking and releasing a context
+ *     in which nothing is reported costs very little. This routine
+ *     records the pending contexts in the given tables, exactly as if
+ *     emsMark had done so, and resets the count. It is called by
+ *     ems1Gtoktab (and so by ems1Gmsgtab) so that all other routines see
+ *     the tables as they would be if every context had been recorded
+ *     immediately, and before messages are transferred to the global
+ *     table when a thread exits.
+
+ *  Arguments:
+ *     msgtab = ems_msgtab_t * (Given and Returned)
+ *        The message table.
+ *     toktab = ems_toktab_t * (Given and Returned)
+ *        The token table that belongs with the message table.
+
+ *  Copyright:
+ *     Copyright (C) 2026 East Asian Observatory
+ *     All Rights Reserved.
+
+ *  Licence:
+ *     This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of
+ *     the License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be
+ *     useful,but WITHOUT ANY WARRANTY; without even the implied
+ *     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *     PURPOSE. See the GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program; if not, write to the Free Software
+ *     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+ *     02110-1301, USA
+
+ *  History:
+ *     14-OCT-2026:
+ *        Original version.
+ *     {enter_further_changes_here}
+
+ *  Bugs:
+ *     {note_any_bugs_here}
+
+ *-
+ */
+
+#include "ems_par.h"                 /* EMS_ public constants */
+#include "ems_sys.h"                 /* EMS_ private constants */
+#include "ems1.h"                    /* EMS_ private functions prototypes */
+#include "ems_defs.h"                /* EMS_ message table */
+
+void ems1Epend( ems_msgtab_t *msgtab, ems_toktab_t *toktab )
+{
+    int npend = msgtab->msgpnd;    /* Number of pending contexts */
+
+    TRACE( "ems1Epend" );
+
+    /*  Record each context in the error message and token tables. */
+    msgtab->msgpnd = 0;
+    while ( npend-- > 0 ) {
+        ems1Emark1( msgtab );
+        ems1Mpush1( toktab );
+    }
+    return;
+}
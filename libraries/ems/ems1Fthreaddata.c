@@ -45,6 +45,9 @@
  *  History:
  *     15-MAY-2008 (PWD):
  *        Original version.
+ *     14-OCT-2026:
+ *        Record pending contexts in the global table before transferring
+ *        messages.
  *     {enter_further_changes_here}
 
  *  Bugs:
@@ -71,8 +74,9 @@
 /* Mutex for protecting transfer to global table. */
 static pthread_mutex_t foo_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-/* The global error table. */
+/* The global error and token tables. */
 extern ems_msgtab_t *ems_msgtab;
+extern ems_toktab_t *ems_toktab;
 
 void ems1Fthreaddata( void *ptr )
 {
@@ -96,6 +100,12 @@ void ems1Fthreaddata( void *ptr )
         /*  Enable mutex. */
         pthread_mutex_lock( &foo_mutex );
 
+        /*  Record any contexts the initial thread has left pending, so
+         *  that the messages go into its current context. */
+        if ( ems_msgtab->msgpnd > 0 ) {
+            ems1Epend( ems_msgtab, ems_toktab );
+        }
+
         /*  Transfer all messages, one by one */
         for ( i = istart; i <= iend; i++ ) {
             ems1Estor1( ems_msgtab, msgtab.msgpar[ i ], msgtab.msgpln[ i ],
@@ -22,6 +22,10 @@
  *     When working in a threaded application it is mandated that
  *     a pair of emsMark and emsRlse calls are made around any threaded
  *     sections.
+ *
+ *     Any error contexts that have been opened by emsMark but not yet
+ *     recorded in the table (see ems1Epend) are recorded before the
+ *     table is returned.
 
  *  Copyright:
  *     Copyright (C) 2008 Science and Technology Facilities Council.
@@ -50,6 +54,9 @@
  *  History:
  *     15-MAY-2008 (PWD):
  *        Original version.
+ *     14-OCT-2026:
+ *        Moved the table look up into ems1Gmsgtab1 and apply any pending
+ *        error contexts.
  *     {enter_further_changes_here}
 
  *  Bugs:
@@ -58,73 +65,21 @@
  *-
  */
 
-#if HAVE_CONFIG_H
-#include "config.h"
-#endif
-
-#if USE_PTHREADS
-#include <pthread.h>
-#endif
-
-#include <star/mem.h>
-
 #include "ems_par.h"                 /* EMS_ public constants */
 #include "ems_sys.h"                 /* EMS_ private constants */
 #include "ems1.h"                    /* EMS1 function prototypes */
 #include "ems_defs.h"                /* Thread and table data structs */
 
-
-/* The global error message table. */
-extern ems_msgtab_t *ems_msgtab;
-
-#if USE_PTHREADS
-
-/*  Id of the initial thread, should be established prior to any thread
- *  creation. */
-extern pthread_t ems_thread_initial_id;
-
-/*  The thread specific data key, this should also be established prior to any
- *  thread creation. */
-extern pthread_key_t ems_thread_data_key;
-
-/*  True when the above have been set. */
-extern int ems_thread_initial_set;
-
 ems_msgtab_t *ems1Gmsgtab( void )
 {
-    ems_thread_data_t *dataPtr;
+    ems_msgtab_t *msgtab = ems1Gmsgtab1();  /* Current message table */
 
     TRACE( "ems1Gmsgtab" );
 
-    /*  If the thread ID doesn't match that of the initial thread then then
-     *  look for a local table. If not found create one and associate it as
-     *  thread-specific data. */
-    if ( ems_thread_initial_set == 0 ||
-         pthread_equal( pthread_self(), ems_thread_initial_id ) ) {
-
-        /* This is the initial thread, so we use the global table. */
-        return ems_msgtab;
+    /*  Record any pending error contexts. ems1Gtoktab does this for
+     *  both tables. */
+    if ( msgtab->msgpnd > 0 ) {
+        (void) ems1Gtoktab();
     }
-
-    /*  In a thread. Look for an existing thread specific value. */
-    dataPtr = (ems_thread_data_t *)pthread_getspecific( ems_thread_data_key );
-    if ( dataPtr == NULL ) {
-
-        dataPtr = ems1Ithreaddata();
-
-        /*  And set as thread specific data. */
-        pthread_setspecific( ems_thread_data_key, dataPtr );
-    }
-
-    /*  Return the table. */
-    return &dataPtr->msgtab;
-}
-#else
-
-ems_msgtab_t *ems1Gmsgtab( void )
-{
-    TRACE( "ems1Gmsgtab" );
-    /* No threads, so always return global table. */
-    return ems_msgtab;
+    return msgtab;
 }
-#endif
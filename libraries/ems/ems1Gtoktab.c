@@ -50,6 +50,8 @@
  *  History:
  *     15-MAY-2008 (PWD):
  *        Original version.
+ *     14-OCT-2026:
+ *        Record any pending error contexts before returning the table.
  *     {enter_further_changes_here}
 
  *  Bugs:
@@ -76,6 +78,9 @@
 /* The global token table. */
 extern ems_toktab_t *ems_toktab;
 
+/* The global error message table. */
+extern ems_msgtab_t *ems_msgtab;
+
 #if USE_PTHREADS
 
 /*  Id of the initial thread, should be established prior to any thread
@@ -101,7 +106,11 @@ ems_toktab_t *ems1Gtoktab( void )
     if ( ems_thread_initial_set == 0 ||
          pthread_equal( pthread_self(), ems_thread_initial_id ) ) {
 
-        /* This is the initial thread, so we use the global table. */
+        /* This is the initial thread, so we use the global table. Record
+         * any pending error contexts first. */
+        if ( ems_msgtab->msgpnd > 0 ) {
+            ems1Epend( ems_msgtab, ems_toktab );
+        }
         return ems_toktab;
     }
 
@@ -115,7 +124,10 @@ ems_toktab_t *ems1Gtoktab( void )
         pthread_setspecific( ems_thread_data_key, dataPtr );
     }
 
-    /*  Return the table. */
+    /*  Record any pending error contexts, and return the table. */
+    if ( dataPtr->msgtab.msgpnd > 0 ) {
+        ems1Epend( &dataPtr->msgtab, &dataPtr->toktab );
+    }
     return &dataPtr->toktab;
 }
 #else
@@ -124,6 +136,9 @@ ems_toktab_t *ems1Gtoktab( void )
 {
     TRACE( "ems1Gtoktab" );
     /* No threads, so always return global table. */
+    if ( ems_msgtab->msgpnd > 0 ) {
+        ems1Epend( ems_msgtab, ems_toktab );
+    }
     return ems_toktab;
 }
 #endif
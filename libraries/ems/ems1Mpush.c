@@ -51,6 +51,8 @@
  *        Rewritten in C based on the Fortran routine EMS1_MPUSH
  *     14-MAY-2008 (PWD):
  *        Use struct to access token table.
+ *     14-OCT-2026:
+ *        Moved the table update into ems1Mpush1.
  *     {enter_further_changes_here}
 
  *  Bugs:
@@ -67,22 +69,9 @@
 
 void ems1Mpush( void )
 {
-    ems_toktab_t *toktab = ems1Gtoktab();  /* Current token table */
-
     TRACE( "ems1Mpush" );
 
-    /*  Check for maximum number of message context levels. */
-    if ( toktab->toklev < EMS__MXLEV ) {
-
-        /*  OK to push context. */
-        toktab->toklev++;
-        toktab->tokmrk++;
-        toktab->tokcnt[ toktab->tokmrk ] = toktab->tokhiw[ toktab->tokmrk-1 ];
-        toktab->tokhiw[ toktab->tokmrk ] = toktab->tokhiw[ toktab->tokmrk-1 ];
-    } else {
-
-        /*  Context stack full, so increment TOKLEV only. */
-        toktab->toklev++;
-    }
+    /*  Push a context in the current token table. */
+    ems1Mpush1( ems1Gtoktab() );
     return;
 }
@@ -0,0 +1,77 @@
+/*
+ *+
+ *  Name:
+ *     ems1Mpush1
+
+ *  Purpose:
+ *     Push a new context for a given token table.
+
+ *  Language:
+ *     Starlink ANSI C
+
+ *  Invocation:
+ *     ems1Mpush1( toktab )
+
+ *  Description:
+ *     Set the indices of the given token table for a new context.
+
+ *  Arguments:
+ *     toktab = ems_toktab_t* (Given and Returned)
+ *        A token table struct.
+
+ *  Copyright:
+ *     Copyright (C) 2026 East Asian Observatory
+ *     All Rights Reserved.
+
+ *  Licence:
+ *     This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of
+ *     the License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be
+ *     useful,but WITHOUT ANY WARRANTY; without even the implied
+ *     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *     PURPOSE. See the GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program; if not, write to the Free Software
+ *     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+ *     02110-1301, USA
+
+ *  History:
+ *     14-OCT-2026:
+ *        Original version, split from ems1Mpush.
+ *     {enter_further_changes_here}
+
+ *  Bugs:
+ *     {note_any_bugs_here}
+
+ *-
+ */
+
+/*  Global Constants: */
+#include "ems_par.h"                 /* EMS_ public constants */
+#include "ems_sys.h"                 /* EMS_ private constants */
+#include "ems1.h"                    /* EMS_ private function prototypes */
+#include "ems_defs.h"                /* EMS_ token table */
+
+void ems1Mpush1( ems_toktab_t *toktab )
+{
+    TRACE( "ems1Mpush1" );
+
+    /*  Check for maximum number of message context levels. */
+    if ( toktab->toklev < EMS__MXLEV ) {
+
+        /*  OK to push context. */
+        toktab->toklev++;
+        toktab->tokmrk++;
+        toktab->tokcnt[ toktab->tokmrk ] = toktab->tokhiw[ toktab->tokmrk-1 ];
+        toktab->tokhiw[ toktab->tokmrk ] = toktab->tokhiw[ toktab->tokmrk-1 ];
+    } else {
+
+        /*  Context stack full, so increment TOKLEV only. */
+        toktab->toklev++;
+    }
+    return;
+}
@@ -51,6 +51,9 @@
  *        Renamed from ems_mark_c
  *     14-FEB-2001 (RTP):
  *        Rewritten in C from Fortran routine EMS_MARK
+ *     14-OCT-2026:
+ *        Only record a pending context, which is applied to the tables
+ *        when they are next used.
  *     {enter_further_changes_here}
 
  *  Bugs:
@@ -60,21 +63,48 @@
  */
 
 /* Include Statements: */
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include "ems_par.h"                   /* ems_ public constant definitions */
 #include "ems_sys.h"                   /* ems_ private macro definitions */
 #include "ems.h"                       /* ems_ function prototypes */
 #include "ems1.h"                      /* ems_ internal function prototypes */
+#include "ems_defs.h"                  /* ems_ message table */
+
+#if USE_PTHREADS
+/*  True when the initial thread has been recorded by ems1Emark. */
+extern int ems_thread_initial_set;
+#endif
 
 /* Function Definitons: */
 void emsMark( void ){
+   int pending = 1;                    /* Leave the new context pending? */
 
    TRACE ( "emsMark" );
 
+#if USE_PTHREADS
+/*  The first context must be opened by ems1Emark, which records the
+ *  initial thread. */
+   pending = ems_thread_initial_set;
+#endif
+
+/*  Normally, just count the new context. It is only recorded in the
+ *  error message and token tables when they are next used (see
+ *  ems1Epend), so a mark and release with nothing reported in between
+ *  costs very little. */
+   if ( pending ) {
+      ems1Gmsgtab1()->msgpnd++;
+
+   } else {
+
 /*  Get a new error message context. */
-   ems1Emark();
+      ems1Emark();
 
 /*  Get a new message token context. */
-   ems1Mpush();
+      ems1Mpush();
+   }
 
    return;
 }
@@ -51,6 +51,8 @@
  *        Renamed from ems_rlse_c
  *     14-FEB-2001 (RTP):
  *        Rewritten in C from Fortran routine EMS_RLSE
+ *     14-OCT-2026:
+ *        Just remove a pending context if there is one.
  *     {enter_further_changes_here}
 
  *  Bugs:
@@ -64,17 +66,27 @@
 #include "ems_sys.h"                   /* ems_ private macro definitions */
 #include "ems.h"                       /* ems_ function prototypes */
 #include "ems1.h"                      /* ems_ internal function prototypes */
+#include "ems_defs.h"                  /* ems_ message table */
 
 /* Function Definitons: */
 void emsRlse( void ){
+   ems_msgtab_t *msgtab = ems1Gmsgtab1(); /* Current message table */
 
    TRACE( "emsRlse" );
 
+/*  If the top context is still pending, nothing has been recorded in
+ *  it, so just remove it. */
+   if ( msgtab->msgpnd > 0 ) {
+      msgtab->msgpnd--;
+
+   } else {
+
 /*  Release the top mark in the error table. */
-   ems1Erlse();
+      ems1Erlse();
 
 /*  Pop the message token context. */
-   ems1Mpop();
+      ems1Mpop();
+   }
 
    return;
 }
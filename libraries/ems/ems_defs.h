@@ -35,6 +35,8 @@
  *  History:
  *     15-MAY-2008 (PWD):
  *        Original version.
+ *     14-OCT-2026:
+ *        Add msgpnd to the message table.
  *     {enter_further_changes_here}
 
  *-
@@ -49,6 +51,7 @@ typedef struct {
     int msglev;                  /* Error context level */
     int msglst;                  /* Last reported status (level 1 only) */
     int msgmrk;                  /* Number of markers */
+    int msgpnd;                  /* Number of pending contexts */
     int msgcnt[EMS__MXLEV+1];    /* Number of messages in table by level */
     int msgpln[EMS__MXMSG+1];    /* Error parameter string lengths */
     int msglen[EMS__MXMSG+1];    /* Error message string lengths */
@@ -76,6 +76,8 @@
 *        structure if a previously allocated structure was re-used.
 *     29-MAY-2012 (DSB):
 *        Add grpGetcc
+*     14-OCT-2026:
+*        Add grpPut
 *     {enter_further_changes_here}
 
 *  Copyright:
@@ -448,6 +450,53 @@ void grpPut1( Grp *grp, const char *name, size_t index, int *status ){
 }
 
 
+F77_SUBROUTINE(grp_put)( INTEGER(IGRP),
+                         INTEGER(SIZE),
+                         CHARACTER_ARRAY(NAMES),
+                         INTEGER(INDEX),
+                         INTEGER(STATUS)
+                         TRAIL(NAMES) );
+
+/* Store many names in a group with a single call. This is much faster
+   than calling grpPut1 for each name, since the group is extended only
+   once. */
+
+void grpPut( Grp *grp, size_t size, char *const *names, size_t index,
+             int *status ){
+   DECLARE_INTEGER(IGRP);
+   DECLARE_INTEGER(SIZE);
+   DECLARE_CHARACTER_ARRAY_DYN(NAMES);
+   DECLARE_INTEGER(INDEX);
+   DECLARE_INTEGER(STATUS);
+   size_t i;
+   size_t l;
+   size_t len;
+
+   IGRP = grpC2F( grp, status );
+
+   for( len = 1, i = 0; i < size; i++ ) {
+      l = strlen( names[ i ] );
+      if( l > len ) len = l;
+   }
+
+   F77_EXPORT_INTEGER( size, SIZE );
+   F77_CREATE_CHARACTER_ARRAY( NAMES, len, size );
+   F77_EXPORT_CHARACTER_ARRAY_P( names, NAMES, len, size );
+   F77_EXPORT_INTEGER( index, INDEX );
+   F77_EXPORT_INTEGER( *status, STATUS );
+
+   F77_LOCK( F77_CALL(grp_put)( INTEGER_ARG(&IGRP),
+                      INTEGER_ARG(&SIZE),
+                      CHARACTER_ARRAY_ARG(NAMES),
+                      INTEGER_ARG(&INDEX),
+                      INTEGER_ARG(&STATUS)
+                      TRAIL_ARG(NAMES) ); )
+
+   F77_FREE_CHARACTER( NAMES );
+   F77_IMPORT_INTEGER( STATUS, *status );
+}
+
+
 F77_SUBROUTINE(grp_infoi)(INTEGER(IGRP),
 			  INTEGER(INDEX),
 			  CHARACTER(ITEM),
@@ -63,6 +63,8 @@
 *        - grpGrpex now passes in a size_t*
 *     29-MAY-2012 (DSB):
 *        Add grpGetcc.
+*     14-OCT-2026:
+*        Add grpPut.
 
 *  Copyright:
 *     Copyright (C) 2005-2006 Particle Physics and Astronomy Research Council.
@@ -139,6 +141,7 @@ void grpGetcc( const Grp *, const char *, char *, size_t, int * );
 void grpInfoc( const Grp *, size_t, const char *, char *, size_t, int * );
 void grpInfoi( const Grp *, size_t, const char *, int *, int * );
 Grp *grpNew( const char *, int * );
+void grpPut( Grp *, size_t, char *const *, size_t, int * );
 void grpPut1( Grp *, const char *, size_t, int * );
 int grpValid( const Grp *, int * );
 size_t grpIndex( const char *, const Grp *, size_t, int * );
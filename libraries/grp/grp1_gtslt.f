@@ -103,6 +103,8 @@
 *  History:
 *     18-AUG-1992 (DSB):
 *        Original version
+*     14-OCT-2026:
+*        Call GRP1_HCUT.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -281,6 +283,10 @@
 *  entries. Initialise the group size to zero.
       CMN_GSIZE( SLOT ) = 0
 
+*  Ensure there is no hash table left over from a previous use of the
+*  slot.
+      CALL GRP1_HCUT( SLOT, 0, STATUS )
+
 *  If all is OK, indicate that the group is in use.
       IF ( STATUS .EQ. SAI__OK ) CMN_USED( SLOT ) = .TRUE.
 
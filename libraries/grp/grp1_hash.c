@@ -0,0 +1,466 @@
+/*
+*  Name:
+*     grp1_hash.c
+
+*  Purpose:
+*     Maintain a hash table of the names in each group.
+
+*  Description:
+*     This module implements Fortran-callable routines that maintain an
+*     internal hash table for the NAMES array of each group, allowing
+*     GRP_INDEX to find a name without searching the whole group. The
+*     tables are held in memory allocated by this module, and are
+*     indexed by the slot number of the group (see GRP_COM).
+*
+*     A table is only created for a group when GRP_INDEX is first used to
+*     search the group, and only if the group contains at least
+*     GRP1__HMIN names. Names appended to the group after the table was
+*     created are added to it by the next call to GRP1_HFIND. Names that
+*     are changed are re-hashed by GRP1_HPUT, and the table is deleted by
+*     GRP1_HCUT if the group is truncated or deleted. The table is also
+*     re-created if the case sensitivity of the group changes.
+*
+*     The routines are:
+*
+*     - GRP1_HFIND: Find the lowest index at which a name occurs.
+*     - GRP1_HPUT: Re-hash a name that has been stored in a group.
+*     - GRP1_HCUT: Discard hashed names beyond a given group size.
+
+*  Notes:
+*     - Like the rest of GRP, these routines are not thread-safe.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+
+*/
+
+/* Header files. */
+/* ============= */
+#include "f77.h"
+#include "grp1.h"
+#include "sae_par.h"
+#include "star/mem.h"
+#include <ctype.h>
+#include <string.h>
+
+/* Constants. */
+/* ========== */
+/* The smallest group for which a hash table is used. Smaller groups are
+   searched linearly. */
+#define GRP1__HMIN 64
+
+/* Constants for the Fowler/Noll/Vo hash function. */
+#define FNV1_32_INIT ( (unsigned int) 0x811c9dc5 )
+#define FNV_32_PRIME ( (unsigned int) 0x01000193 )
+
+/* Type definitions. */
+/* ================= */
+/* The hash table for a single group. Element indices are one-based, as
+   in Fortran, and zero is used to mark the end of a chain. */
+typedef struct Grp1Hash {
+   int *head;             /* Index of first element in each bucket */
+   int *next;             /* Index of next element in the same bucket */
+   unsigned int *hval;    /* Hash value for each element */
+   int nbucket;           /* Number of buckets (a power of two) */
+   int nalloc;            /* Number of elements allocated in next/hval */
+   int nent;              /* Elements 1 to nent have been hashed */
+   int upper;             /* Were names hashed without regard to case? */
+} Grp1Hash;
+
+/* Module variables. */
+/* ================= */
+/* A pointer to the hash table for each group slot (NULL if no table has
+   been created). */
+static Grp1Hash *Grp1_Hash[ GRP__MAXG ];
+
+/* Prototypes for local static functions. */
+/* ====================================== */
+static Grp1Hash *grp1Hfree( Grp1Hash * );
+static int grp1Hsame( const char *, const char *, size_t, size_t, int );
+static int grp1Hsize( Grp1Hash *, int );
+static int grp1Linear( int, int, int, const char *, size_t, const char *,
+                       size_t );
+static size_t grp1Hlen( const char *, size_t );
+static unsigned int grp1Hval( const char *, size_t, int );
+static void grp1Hlink( Grp1Hash *, int );
+static void grp1Hunlink( Grp1Hash *, int );
+
+
+/* Fortran-callable routines. */
+/* ========================== */
+
+F77_SUBROUTINE(grp1_hfind)( INTEGER(SLOT), LOGICAL(UPPER), INTEGER(SIZE),
+                            INTEGER(START), CHARACTER_ARRAY(ARRAY),
+                            CHARACTER(TEXT), INTEGER(INDEX),
+                            INTEGER(STATUS) TRAIL(ARRAY) TRAIL(TEXT) ){
+/*
+*+
+*  Name:
+*     GRP1_HFIND
+
+*  Purpose:
+*     Find the lowest index at which a name occurs within a group.
+
+*  Language:
+*     ANSI C
+
+*  Invocation:
+*     CALL GRP1_HFIND( SLOT, UPPER, SIZE, START, ARRAY, TEXT, INDEX,
+*                      STATUS )
+
+*  Description:
+*     This routine returns the lowest index greater than or equal to
+*     START at which the supplied text occurs within the supplied NAMES
+*     array, giving the same result as GRP1_FIND. The search uses the
+*     hash table for the group, which is created or brought up to date
+*     as necessary. Small groups are searched linearly.
+
+*  Arguments:
+*     SLOT = INTEGER (Given)
+*        The slot number for the group.
+*     UPPER = LOGICAL (Given)
+*        If true, then the search is case insensitive.
+*     SIZE = INTEGER (Given)
+*        The number of names in the group.
+*     START = INTEGER (Given)
+*        The lowest index to be checked.
+*     ARRAY( SIZE ) = CHARACTER * ( * ) (Given)
+*        The NAMES array for the group.
+*     TEXT = CHARACTER * ( * ) (Given)
+*        The text to search for.
+*     INDEX = INTEGER (Returned)
+*        The index at which the text was found, or zero if it was not
+*        found.
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+*-
+*/
+   GENPTR_INTEGER(SLOT)
+   GENPTR_LOGICAL(UPPER)
+   GENPTR_INTEGER(SIZE)
+   GENPTR_INTEGER(START)
+   GENPTR_CHARACTER_ARRAY(ARRAY)
+   GENPTR_CHARACTER(TEXT)
+   GENPTR_INTEGER(INDEX)
+   GENPTR_INTEGER(STATUS)
+
+   Grp1Hash *hash;
+   int i;
+   int start;
+   int upper;
+   size_t tlen;
+   unsigned int hval;
+
+   if( *STATUS != SAI__OK ) return;
+
+   *INDEX = 0;
+   upper = F77_ISTRUE( *UPPER ) ? 1 : 0;
+   start = ( *START > 1 ) ? *START : 1;
+   tlen = grp1Hlen( TEXT, TEXT_length );
+
+/* Search small groups linearly, without creating a hash table. */
+   if( *SIZE < GRP1__HMIN || *SLOT < 1 || *SLOT > GRP__MAXG ) {
+      *INDEX = grp1Linear( upper, *SIZE, start, ARRAY, ARRAY_length, TEXT,
+                           tlen );
+      return;
+   }
+
+/* Discard any existing table that was created with a different case
+   sensitivity, or that contains more names than the group. */
+   hash = Grp1_Hash[ *SLOT - 1 ];
+   if( hash && ( hash->upper != upper || hash->nent > *SIZE ) ) {
+      hash = grp1Hfree( hash );
+   }
+
+/* Create a new table if required. */
+   if( !hash ) {
+      hash = starCalloc( 1, sizeof( *hash ) );
+      if( hash ) hash->upper = upper;
+   }
+   Grp1_Hash[ *SLOT - 1 ] = hash;
+
+/* Ensure the table has room for all names in the group. If memory could
+   not be allocated, discard the table and search the group linearly. */
+   if( !hash || !grp1Hsize( hash, *SIZE ) ) {
+      Grp1_Hash[ *SLOT - 1 ] = grp1Hfree( hash );
+      *INDEX = grp1Linear( upper, *SIZE, start, ARRAY, ARRAY_length, TEXT,
+                           tlen );
+      return;
+   }
+
+/* Add any names that have been appended to the group since the table
+   was last used. */
+   for( i = hash->nent + 1; i <= *SIZE; i++ ) {
+      hash->hval[ i - 1 ] = grp1Hval( ARRAY + ( i - 1 )*ARRAY_length,
+                                      ARRAY_length, upper );
+      grp1Hlink( hash, i );
+   }
+   hash->nent = *SIZE;
+
+/* Check every name in the bucket for the supplied text, and return the
+   lowest matching index that is no less than "start". Names that share
+   the same hash value are compared in full. */
+   hval = grp1Hval( TEXT, TEXT_length, upper );
+   for( i = hash->head[ hval & ( hash->nbucket - 1 ) ]; i;
+        i = hash->next[ i - 1 ] ) {
+      if( i >= start && ( !*INDEX || i < *INDEX ) &&
+          hash->hval[ i - 1 ] == hval &&
+          grp1Hsame( ARRAY + ( i - 1 )*ARRAY_length, TEXT,
+                     grp1Hlen( ARRAY + ( i - 1 )*ARRAY_length,
+                               ARRAY_length ), tlen, upper ) ) {
+         *INDEX = i;
+      }
+   }
+}
+
+F77_SUBROUTINE(grp1_hput)( INTEGER(SLOT), INTEGER(INDEX), CHARACTER(NAME),
+                           INTEGER(STATUS) TRAIL(NAME) ){
+/*
+*+
+*  Name:
+*     GRP1_HPUT
+
+*  Purpose:
+*     Update the hash table after a name has been stored in a group.
+
+*  Language:
+*     ANSI C
+
+*  Invocation:
+*     CALL GRP1_HPUT( SLOT, INDEX, NAME, STATUS )
+
+*  Description:
+*     This routine should be called whenever a name is stored in a
+*     group. If the element has already been hashed, it is moved to the
+*     bucket for the new name. Otherwise nothing is done, since the name
+*     will be hashed when the table is next used.
+
+*  Arguments:
+*     SLOT = INTEGER (Given)
+*        The slot number for the group.
+*     INDEX = INTEGER (Given)
+*        The index at which the name was stored.
+*     NAME = CHARACTER * ( * ) (Given)
+*        The new name.
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+*-
+*/
+   GENPTR_INTEGER(SLOT)
+   GENPTR_INTEGER(INDEX)
+   GENPTR_CHARACTER(NAME)
+   GENPTR_INTEGER(STATUS)
+
+   Grp1Hash *hash;
+
+   if( *STATUS != SAI__OK ) return;
+   if( *SLOT < 1 || *SLOT > GRP__MAXG ) return;
+
+   hash = Grp1_Hash[ *SLOT - 1 ];
+   if( hash && *INDEX >= 1 && *INDEX <= hash->nent ) {
+      grp1Hunlink( hash, *INDEX );
+      hash->hval[ *INDEX - 1 ] = grp1Hval( NAME, NAME_length, hash->upper );
+      grp1Hlink( hash, *INDEX );
+   }
+}
+
+F77_SUBROUTINE(grp1_hcut)( INTEGER(SLOT), INTEGER(SIZE), INTEGER(STATUS) ){
+/*
+*+
+*  Name:
+*     GRP1_HCUT
+
+*  Purpose:
+*     Update the hash table after a group has been truncated.
+
+*  Language:
+*     ANSI C
+
+*  Invocation:
+*     CALL GRP1_HCUT( SLOT, SIZE, STATUS )
+
+*  Description:
+*     This routine should be called whenever the size of a group is
+*     reduced, or the group is deleted or created. If any names beyond
+*     the new group size have been hashed, the hash table for the group
+*     is deleted. It will be re-created when it is next needed.
+*
+*     This routine attempts to execute even if STATUS is set on entry.
+
+*  Arguments:
+*     SLOT = INTEGER (Given)
+*        The slot number for the group.
+*     SIZE = INTEGER (Given)
+*        The new group size. Supply zero if the group is being deleted
+*        or created.
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+*-
+*/
+   GENPTR_INTEGER(SLOT)
+   GENPTR_INTEGER(SIZE)
+   GENPTR_INTEGER(STATUS)
+
+   Grp1Hash *hash;
+
+   if( *SLOT < 1 || *SLOT > GRP__MAXG ) return;
+
+   hash = Grp1_Hash[ *SLOT - 1 ];
+   if( hash && ( *SIZE <= 0 || *SIZE < hash->nent ) ) {
+      Grp1_Hash[ *SLOT - 1 ] = grp1Hfree( hash );
+   }
+}
+
+
+/* Local static functions. */
+/* ======================= */
+
+/* Free a hash table and return NULL. */
+static Grp1Hash *grp1Hfree( Grp1Hash *hash ){
+   if( hash ) {
+      starFree( hash->head );
+      starFree( hash->next );
+      starFree( hash->hval );
+      starFree( hash );
+   }
+   return NULL;
+}
+
+/* Return the length of a blank padded Fortran string, excluding
+   trailing blanks. */
+static size_t grp1Hlen( const char *text, size_t len ){
+   while( len > 0 && text[ len - 1 ] == ' ' ) len--;
+   return len;
+}
+
+/* Return the hash value for a blank padded Fortran string, ignoring
+   trailing blanks, and ignoring case if "upper" is non-zero. */
+static unsigned int grp1Hval( const char *text, size_t len, int upper ){
+   unsigned int result = FNV1_32_INIT;
+   size_t i;
+
+   len = grp1Hlen( text, len );
+   for( i = 0; i < len; i++ ) {
+      result ^= (unsigned char)( upper ? toupper( (unsigned char) text[ i ] )
+                                       : text[ i ] );
+      result *= FNV_32_PRIME;
+   }
+   return result;
+}
+
+/* Return non-zero if two strings (excluding trailing blanks) are the
+   same, ignoring case if "upper" is non-zero. This is equivalent to the
+   comparisons made by GRP1_FIND. */
+static int grp1Hsame( const char *a, const char *b, size_t alen,
+                      size_t blen, int upper ){
+   size_t i;
+
+   if( alen != blen ) return 0;
+   if( !upper ) return !strncmp( a, b, alen );
+   for( i = 0; i < alen; i++ ) {
+      if( toupper( (unsigned char) a[ i ] ) !=
+          toupper( (unsigned char) b[ i ] ) ) return 0;
+   }
+   return 1;
+}
+
+/* Search a NAMES array linearly, returning the lowest matching index
+   that is no less than "start", or zero. */
+static int grp1Linear( int upper, int size, int start, const char *array,
+                       size_t array_length, const char *text, size_t tlen ){
+   int i;
+
+   for( i = start; i <= size; i++ ) {
+      if( grp1Hsame( array + ( i - 1 )*array_length, text,
+                     grp1Hlen( array + ( i - 1 )*array_length,
+                               array_length ), tlen, upper ) ) return i;
+   }
+   return 0;
+}
+
+/* Ensure a hash table has room for "size" elements, and at least twice
+   as many buckets. The per-element arrays are extended geometrically,
+   and the buckets are re-built if their number changes. Returns zero if
+   memory could not be allocated. */
+static int grp1Hsize( Grp1Hash *hash, int size ){
+   int *head;
+   int i;
+   int nalloc;
+   int nbucket;
+   void *ptr;
+
+   if( size > hash->nalloc ) {
+      nalloc = 2*hash->nalloc;
+      if( nalloc < size ) nalloc = size;
+
+      ptr = starRealloc( hash->next, nalloc*sizeof( *hash->next ) );
+      if( !ptr ) return 0;
+      hash->next = ptr;
+
+      ptr = starRealloc( hash->hval, nalloc*sizeof( *hash->hval ) );
+      if( !ptr ) return 0;
+      hash->hval = ptr;
+
+      hash->nalloc = nalloc;
+   }
+
+   if( hash->nbucket < 2*size ) {
+      nbucket = 64;
+      while( nbucket < 2*size ) nbucket *= 2;
+
+      head = starCalloc( nbucket, sizeof( *head ) );
+      if( !head ) return 0;
+      starFree( hash->head );
+      hash->head = head;
+      hash->nbucket = nbucket;
+
+      for( i = 1; i <= hash->nent; i++ ) grp1Hlink( hash, i );
+   }
+
+   return 1;
+}
+
+/* Add an element, with a known hash value, to the start of the chain for
+   its bucket. */
+static void grp1Hlink( Grp1Hash *hash, int index ){
+   int *head;
+
+   head = hash->head + ( hash->hval[ index - 1 ] & ( hash->nbucket - 1 ) );
+   hash->next[ index - 1 ] = *head;
+   *head = index;
+}
+
+/* Remove an element from the chain for its bucket. */
+static void grp1Hunlink( Grp1Hash *hash, int index ){
+   int *link;
+
+   link = hash->head + ( hash->hval[ index - 1 ] & ( hash->nbucket - 1 ) );
+   while( *link ) {
+      if( *link == index ) {
+         *link = hash->next[ index - 1 ];
+         break;
+      }
+      link = hash->next + *link - 1;
+   }
+}
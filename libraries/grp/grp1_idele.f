@@ -52,6 +52,8 @@
 *  History:
 *     18-AUG-1992 (DSB):
 *        Original version
+*     14-OCT-2026:
+*        Call GRP1_HCUT.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -130,6 +132,9 @@
       CALL PSX_FREE( CMN_LVPNT( SLOT ), STATUS )
       CALL PSX_FREE( CMN_INPNT( SLOT ), STATUS )
 
+*  Delete the hash table used by GRP_INDEX.
+      CALL GRP1_HCUT( SLOT, 0, STATUS )
+
 *  Indicate that the group is no longer in use.
       CMN_USED( SLOT ) = .FALSE.
 
@@ -86,6 +86,8 @@
 *  History:
 *     18-AUG-1992 (DSB):
 *        Original version
+*     14-OCT-2026:
+*        Extend the arrays geometrically, and call GRP1_HPUT.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -156,11 +158,12 @@
 
 *  If necessary, extend the NAMES array to make room for the new value.
 *  To cut down on the number of times this needs to be done, the arrays
-*  are extended by more than necessary. The new elements are then
-*  initialised.
+*  are extended by more than necessary (at least doubling their size, so
+*  that appending many names one at a time does not involve copying the
+*  arrays repeatedly). The new elements are then initialised.
       IF( INDX .GT. CMN_SIZE( SLOT ) ) THEN
          FSTNEW = CMN_SIZE( SLOT ) + 1
-         NEWSIZ = INDX + GRP__INCN
+         NEWSIZ = MAX( INDX + GRP__INCN, 2*CMN_SIZE( SLOT ) )
 
 *  NAMES...
 *  Convert the pointer to the character descriptor into a pointer to
@@ -233,6 +236,9 @@
      :             %VAL( CNF_PVAL( CMN_MIPNT( SLOT ) ) ),
      :             NAME, LEVEL, IFILE, MODGP, MODIN, STATUS,
      :             %VAL( CNF_CVAL( GRP__SZNAM ) ) )
+
+*  Update the hash table used by GRP_INDEX.
+            CALL GRP1_HPUT( SLOT, INDX, NAME, STATUS )
          END IF
 
       END IF
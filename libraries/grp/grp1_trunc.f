@@ -51,6 +51,8 @@
 *  History:
 *     18-AUG-1992 (DSB):
 *        Original version
+*     14-OCT-2026:
+*        Call GRP1_HCUT.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -100,6 +102,9 @@
 *  Check inherited global status.
       IF ( STATUS .NE. SAI__OK ) RETURN
 
+*  Discard any hashed names beyond the end of the group.
+      CALL GRP1_HCUT( SLOT, CMN_GSIZE( SLOT ), STATUS )
+
 *  Limit the minimum size to 1.
       SIZE = MAX( 1, CMN_GSIZE( SLOT ) )
 
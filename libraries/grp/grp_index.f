@@ -66,6 +66,8 @@
 *        Original version
 *     9-FEB-2001 (DSB):
 *        Corrected use of CMN_SIZE to CMN_GSIZE (DSB).
+*     14-OCT-2026:
+*        Use GRP1_HFIND in place of GRP1_FIND.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -129,14 +131,15 @@
 *  Abort if an error has occurred.
       IF ( STATUS .NE. SAI__OK ) GO TO 999
 
-*  Call GRP1_FIND to do the work.  NB, the final argument specifies the
-*  length of each character string in the mapped NAMES array, and is
-*  required by UNIX. There is no corresponding dummy argument in the
-*  code for GRP1_FIND.
-      CALL GRP1_FIND( CMN_UPPER( SLOT ), CMN_GSIZE( SLOT ), START,
-     :                %VAL( CNF_PVAL( CMN_NMPNT( SLOT ) ) ),
-     :                NAME, INDEX, STATUS,
-     :                %VAL( CNF_CVAL( GRP__SZNAM ) ) )
+*  Call GRP1_HFIND to do the work. This uses a hash table for large
+*  groups, so that the whole group need not be searched.  NB, the final
+*  argument specifies the length of each character string in the mapped
+*  NAMES array, and is required by UNIX. There is no corresponding dummy
+*  argument in the code for GRP1_HFIND.
+      CALL GRP1_HFIND( SLOT, CMN_UPPER( SLOT ), CMN_GSIZE( SLOT ), START,
+     :                 %VAL( CNF_PVAL( CMN_NMPNT( SLOT ) ) ),
+     :                 NAME, INDEX, STATUS,
+     :                 %VAL( CNF_CVAL( GRP__SZNAM ) ) )
 
 *  If an error occurred, give a context message and ensure that the
 *  returned index is 1.
@@ -0,0 +1,103 @@
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <fcntl.h>
+#include <unistd.h>
+#include "sae_par.h"
+#include "hds.h"
+#include "ems.h"
+#include "dat_par.h"
+
+int datPrefetch( const HDSLoc *locator, int *status ){
+/*
+*+
+*  Name:
+*     datPrefetch
+
+*  Purpose:
+*     Start reading the container file of an object in the background.
+
+*  Synopsis:
+*     int datPrefetch( const HDSLoc *locator, int *status )
+
+*  Description:
+*     This function advises the operating system that the container file
+*     holding the object identified by the supplied locator will soon be
+*     read, and returns immediately. The operating system then starts
+*     reading the file into its page cache in the background, so that a
+*     later call to datMap (or datGet, etc) for an object in the file
+*     need not wait for the disk. This allows an application to overlap
+*     the reading of one file with the processing of another.
+
+*  Parameters:
+*     locator
+*        Locator to the HDS object. Both V4 and V5 objects may be supplied.
+*     *status
+*        The global status.
+
+*  Notes:
+*     - The whole container file is read, since the location of the
+*     object within the file is not known.
+*     - Prefetching is advisory. No error is reported if the container
+*     file cannot be opened, or if the operating system does not support
+*     read-ahead advice.
+*     - No HDS data structures are changed, and so the file may be read
+*     whilst other threads use HDS.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All rights reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or modify
+*     it under the terms of the GNU General Public License as published by
+*     the Free Software Foundation; either version 2 of the License, or (at
+*     your option) any later version.
+*
+*     This program is distributed in the hope that it will be useful, but
+*     WITHOUT ANY WARRANTY; without even the implied warranty of
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*     General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+
+*-
+*/
+
+/* Local Variables: */
+   char file[ 512 ];     /* Container file name */
+   char path[ 512 ];     /* Object path name */
+   int fd;               /* File descriptor */
+   int nlev;             /* Number of levels in the path */
+
+/* Check inherited global status. */
+   if( *status != SAI__OK ) return *status;
+
+/* Get the name of the container file. */
+   hdsTrace( locator, &nlev, path, file, status, sizeof( path ),
+             sizeof( file ) );
+   if( *status != SAI__OK ) return *status;
+
+/* Open the file and advise the kernel that all of it will be needed.
+   This starts the reads and returns without waiting for them. */
+   fd = open( file, O_RDONLY );
+   if( fd != -1 ) {
+#if defined(POSIX_FADV_WILLNEED)
+      (void) posix_fadvise( fd, 0, 0, POSIX_FADV_WILLNEED );
+#endif
+      close( fd );
+   }
+
+   return *status;
+}
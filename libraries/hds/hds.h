@@ -638,6 +638,13 @@ datParen(const HDSLoc *locator1, HDSLoc **locator2, int *status);
 int
 datPrec(const HDSLoc *locator, size_t *nbytes, int *status);
 
+/*===================================================================*/
+/* datPrefetch - Start reading the container file in the background  */
+/*===================================================================*/
+
+int
+datPrefetch(const HDSLoc *locator, int *status);
+
 /*====================================*/
 /* datPrim - Enquire object primitive */
 /*====================================*/
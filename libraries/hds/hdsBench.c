@@ -0,0 +1,357 @@
+/*
+*+
+*  Name:
+*     hdsBench
+
+*  Purpose:
+*     Measure the speed of HDS I/O operations
+
+*  Language:
+*     Starlink ANSI C
+
+*  Invocation:
+*     hdsBench [ncol nrow ntime [ncomp nrep]]
+
+*  Description:
+*     This program times a set of typical HDS operations for both the
+*     V4 and V5 data formats, and writes the results to standard output
+*     as one JSON object per line, so that they can be compared between
+*     releases or between different tuning settings. The array and
+*     structure sizes may be given on the command line. The default
+*     array looks like a SCUBA-2 subarray time stream (32 x 40 x 4000).
+*
+*     The following operations are timed, in this order:
+*
+*     - "create": create a new container file holding a 3-D _REAL array,
+*     map it for write access, fill it and unmap it.
+*     - "map": open the file and map the whole array for read access.
+*     - "section_axis1", "section_axis2", "section_axis3": map every
+*     1-D section that spans the full range of the given axis and a
+*     single pixel on the other axes. Sections along axis 3 are the
+*     time streams of single bolometers.
+*     - "struct_read": create a structure holding "ncomp" _DOUBLE
+*     vectors of length "ntime" (like a JCMTSTATE extension), and then
+*     "nrep" times locate each component by name and read its values.
+*     - "copy": copy the array into a new file of the same format.
+*     - "copy_convert": copy the array into a new file of the other
+*     format.
+*
+*     Each output record contains the name of the operation, the HDS
+*     format version, the number of elements and bytes transferred (or
+*     the number of component reads for "struct_read"), and the elapsed
+*     wall clock time in seconds. The temporary files are deleted before
+*     the program exits.
+
+*  Notes:
+*     - This program is not run by "make check". Build it with
+*     "make hdsBench" and run it in a directory on the file system to
+*     be measured. The operating system page cache is not flushed
+*     between operations, so the times for operations that read data
+*     written by an earlier operation are usually those of a warm cache.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sae_par.h"
+#include "hds.h"
+#include "ems.h"
+#include "dat_err.h"
+
+static double benchNow( void );
+static void benchReport( const char *test, int version, size_t nel,
+                         size_t nbytes, double secs );
+static void benchArray( int version, const hdsdim dims[3], int *status );
+static void benchStruct( int version, hdsdim ntime, int ncomp, int nrep,
+                         int *status );
+static void benchCopy( int version, int outversion, int *status );
+
+/* Names of the temporary container files. */
+#define BENCH_FILE "hds_bench"
+#define BENCH_COPY "hds_bench_copy"
+#define BENCH_STRUC "hds_bench_struc"
+
+int main( int argc, char *argv[] ) {
+
+  /*  Local Variables: */
+  hdsdim dims[3] = { 32, 40, 4000 };
+  int ncomp = 100;
+  int nrep = 10;
+  int status = SAI__OK;
+  int version;
+
+  if( argc != 1 && argc != 4 && argc != 6 ) {
+    fprintf( stderr, "Usage: %s [ncol nrow ntime [ncomp nrep]]\n", argv[0] );
+    return EXIT_FAILURE;
+  }
+  if( argc >= 4 ) {
+    dims[0] = atol( argv[1] );
+    dims[1] = atol( argv[2] );
+    dims[2] = atol( argv[3] );
+  }
+  if( argc == 6 ) {
+    ncomp = atoi( argv[4] );
+    nrep = atoi( argv[5] );
+  }
+  if( dims[0] < 1 || dims[1] < 1 || dims[2] < 1 || ncomp < 1 || nrep < 1 ) {
+    fprintf( stderr, "%s: all sizes must be positive\n", argv[0] );
+    return EXIT_FAILURE;
+  }
+
+  emsBegin( &status );
+
+  for( version = 4; version <= 5 && status == SAI__OK; version++ ) {
+    hdsTune( "VERSION", version, &status );
+    benchArray( version, dims, &status );
+    benchStruct( version, dims[2], ncomp, nrep, &status );
+    benchCopy( version, version, &status );
+    benchCopy( version, ( version == 4 ) ? 5 : 4, &status );
+
+    /* Delete the array file created by benchArray. */
+    if( status == SAI__OK ) {
+      HDSLoc *loc = NULL;
+      hdsOpen( BENCH_FILE, "UPDATE", &loc, &status );
+      hdsErase( &loc, &status );
+    }
+  }
+
+  emsEnd( &status );
+
+  return ( status == SAI__OK ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* Return the current wall clock time in seconds. */
+static double benchNow( void ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return ts.tv_sec + 1.0E-9*ts.tv_nsec;
+}
+
+/* Write a single result as a line of JSON. */
+static void benchReport( const char *test, int version, size_t nel,
+                         size_t nbytes, double secs ) {
+  printf( "{\"test\": \"%s\", \"version\": %d, \"elements\": %zu, "
+          "\"bytes\": %zu, \"seconds\": %.6f, \"mb_per_s\": %.3f}\n",
+          test, version, nel, nbytes, secs,
+          ( secs > 0.0 ) ? nbytes/( 1.0E6*secs ) : 0.0 );
+  fflush( stdout );
+}
+
+/* Time the creation, mapping and section reads of a 3-D array. The file
+   is left in place for use by benchCopy. */
+static void benchArray( int version, const hdsdim dims[3], int *status ) {
+  HDSLoc *aloc = NULL;
+  HDSLoc *loc = NULL;
+  HDSLoc *sloc = NULL;
+  char test[ 20 ];
+  double sum = 0.0;
+  double t0;
+  float *pntr = NULL;
+  hdsdim lower[3];
+  hdsdim upper[3];
+  hdsdim i0;
+  hdsdim i1;
+  int axis;
+  int ax0;
+  int ax1;
+  size_t i;
+  size_t nel;
+  size_t nread;
+  size_t total;
+
+  if( *status != SAI__OK ) return;
+  nel = dims[0]*dims[1]*dims[2];
+
+  /* Create, fill and close the file. */
+  t0 = benchNow();
+  hdsNew( BENCH_FILE, "HDS_BENCH", "NDF", 0, dims, &loc, status );
+  datNew( loc, "DATA_ARRAY", "_REAL", 3, dims, status );
+  datFind( loc, "DATA_ARRAY", &aloc, status );
+  datMapV( aloc, "_REAL", "WRITE", (void **) &pntr, &nread, status );
+  if( *status == SAI__OK ) {
+    for( i = 0; i < nel; i++ ) pntr[ i ] = (float) i;
+  }
+  datUnmap( aloc, status );
+  datAnnul( &aloc, status );
+  datAnnul( &loc, status );
+  if( *status == SAI__OK ) benchReport( "create", version, nel,
+                                        nel*sizeof( float ),
+                                        benchNow() - t0 );
+
+  /* Re-open the file and map the whole array. */
+  t0 = benchNow();
+  hdsOpen( BENCH_FILE, "READ", &loc, status );
+  datFind( loc, "DATA_ARRAY", &aloc, status );
+  datMapV( aloc, "_REAL", "READ", (void **) &pntr, &nread, status );
+  if( *status == SAI__OK ) {
+    for( i = 0; i < nread; i++ ) sum += pntr[ i ];
+  }
+  datUnmap( aloc, status );
+  if( *status == SAI__OK ) benchReport( "map", version, nread,
+                                        nread*sizeof( float ),
+                                        benchNow() - t0 );
+
+  /* Map every 1-D section along each axis in turn. */
+  for( axis = 0; axis < 3 && *status == SAI__OK; axis++ ) {
+    ax0 = ( axis + 1 ) % 3;
+    ax1 = ( axis + 2 ) % 3;
+    lower[ axis ] = 1;
+    upper[ axis ] = dims[ axis ];
+    total = 0;
+
+    t0 = benchNow();
+    for( i1 = 1; i1 <= dims[ ax1 ] && *status == SAI__OK; i1++ ) {
+      for( i0 = 1; i0 <= dims[ ax0 ] && *status == SAI__OK; i0++ ) {
+        lower[ ax0 ] = upper[ ax0 ] = i0;
+        lower[ ax1 ] = upper[ ax1 ] = i1;
+        datSlice( aloc, 3, lower, upper, &sloc, status );
+        datMapV( sloc, "_REAL", "READ", (void **) &pntr, &nread, status );
+        if( *status == SAI__OK ) {
+          for( i = 0; i < nread; i++ ) sum += pntr[ i ];
+          total += nread;
+        }
+        datUnmap( sloc, status );
+        datAnnul( &sloc, status );
+      }
+    }
+
+    sprintf( test, "section_axis%d", axis + 1 );
+    if( *status == SAI__OK ) benchReport( test, version, total,
+                                          total*sizeof( float ),
+                                          benchNow() - t0 );
+  }
+
+  datAnnul( &aloc, status );
+  datAnnul( &loc, status );
+
+  /* Use the sum so that the reads cannot be optimised away. */
+  if( sum == -1.0 ) printf( "# %g\n", sum );
+}
+
+/* Time repeated reads of the components of a structure holding many
+   small vectors. */
+static void benchStruct( int version, hdsdim ntime, int ncomp, int nrep,
+                         int *status ) {
+  HDSLoc *cloc = NULL;
+  HDSLoc *loc = NULL;
+  HDSLoc *sloc = NULL;
+  char name[ DAT__SZNAM + 1 ];
+  double *values = NULL;
+  double t0;
+  hdsdim dims[1];
+  int icomp;
+  int irep;
+  size_t i;
+  size_t nread;
+  size_t nops = 0;
+
+  if( *status != SAI__OK ) return;
+
+  values = malloc( ntime*sizeof( *values ) );
+  if( !values ) {
+    *status = DAT__NOMEM;
+    emsRep( " ", "hdsBench: Failed to allocate memory.", status );
+    return;
+  }
+  for( i = 0; i < (size_t) ntime; i++ ) values[ i ] = (double) i;
+
+  /* Create the structure. */
+  dims[0] = 0;
+  hdsNew( BENCH_STRUC, "HDS_BENCH", "NDF", 0, dims, &loc, status );
+  datNew( loc, "JCMTSTATE", "EXT", 0, dims, status );
+  datFind( loc, "JCMTSTATE", &sloc, status );
+  for( icomp = 0; icomp < ncomp && *status == SAI__OK; icomp++ ) {
+    sprintf( name, "COMP_%d", icomp );
+    datNew1D( sloc, name, ntime, status );
+    datFind( sloc, name, &cloc, status );
+    datPutVD( cloc, ntime, values, status );
+    datAnnul( &cloc, status );
+  }
+
+  /* Locate each component by name and read its values. */
+  t0 = benchNow();
+  for( irep = 0; irep < nrep && *status == SAI__OK; irep++ ) {
+    for( icomp = 0; icomp < ncomp && *status == SAI__OK; icomp++ ) {
+      sprintf( name, "COMP_%d", icomp );
+      datFind( sloc, name, &cloc, status );
+      datGetVD( cloc, ntime, values, &nread, status );
+      datAnnul( &cloc, status );
+      nops++;
+    }
+  }
+  if( *status == SAI__OK ) benchReport( "struct_read", version, nops,
+                                        nops*ntime*sizeof( double ),
+                                        benchNow() - t0 );
+
+  datAnnul( &sloc, status );
+  hdsErase( &loc, status );
+  free( values );
+}
+
+/* Time the copy of the array created by benchArray into a new file in
+   format "outversion". */
+static void benchCopy( int version, int outversion, int *status ) {
+  HDSLoc *aloc = NULL;
+  HDSLoc *loc = NULL;
+  HDSLoc *oloc = NULL;
+  double t0;
+  hdsdim dims[1] = { 0 };
+  size_t nel = 0;
+
+  if( *status != SAI__OK ) return;
+
+  hdsOpen( BENCH_FILE, "READ", &loc, status );
+  datFind( loc, "DATA_ARRAY", &aloc, status );
+  datSize( aloc, &nel, status );
+
+  t0 = benchNow();
+  hdsTune( "VERSION", outversion, status );
+  hdsNew( BENCH_COPY, "HDS_BENCH", "NDF", 0, dims, &oloc, status );
+  hdsTune( "VERSION", version, status );
+  datCopy( aloc, oloc, "DATA_ARRAY", status );
+  datAnnul( &aloc, status );
+  datAnnul( &loc, status );
+  hdsErase( &oloc, status );
+  if( *status == SAI__OK ) benchReport( ( outversion == version ) ?
+                                        "copy" : "copy_convert", version,
+                                        nel, nel*sizeof( float ),
+                                        benchNow() - t0 );
+}
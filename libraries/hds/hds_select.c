@@ -3273,12 +3273,24 @@ hdsCopy(const HDSLoc *locator, const char *file_str, const char name_str[DAT__SZ
   hdsbool_t struc = 0;
   EnterCheck("hdsCopy",*status);
   if (*status != SAI__OK) return *status;
-  /* We always want to end up with output files that match
+  /* If the object already uses the format in which new files are
+     created, the native routine can copy the whole tree in one
+     operation rather than component by component. */
+  if (ISHDSv5(locator) && hds1UseVersion5()) {
+    hdsCopy_v5(locator, file_str, name_str, status);
+    HDS_CHECK_STATUS("hdsCopy", "(v5)");
+    return *status;
+  } else if (!ISHDSv5(locator) && !hds1UseVersion5()) {
+    LOCK_MUTEX;
+    hdsCopy_v4(locator, file_str, name_str, status);
+    UNLOCK_MUTEX;
+    HDS_CHECK_STATUS("hdsCopy", "(v4)");
+    return *status;
+  }
+  /* Otherwise we want to end up with an output file that matches
      the format currently in use for hdsNew (which may depend
-     on an environment variable). We can not simply call hdsCopy_v5.
-     so we have to do some manual leg work. Would be a bit easier if
-     we had a function in this file that returned the default output
-     format version so we could call the native version.
+     on an environment variable), and so we have to do some manual
+     leg work.
    */
   datType( locator, type_str, status );
   datShape( locator, DAT__MXDIM, dims, &ndim, status );
@@ -3287,6 +3299,7 @@ hdsCopy(const HDSLoc *locator, const char *file_str, const char name_str[DAT__SZ
   /* So we need to walk through and can not simply use datCopy
     - we can use two routines used by dat1CopyXtoY though. */
   datStruc(locator, &struc, status);
+  /* One of the two objects is now always V4. */
   LOCK_MUTEX;
   if (struc) {
     dat1CopyStrucXtoY( locator, outloc, status );
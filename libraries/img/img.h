@@ -392,6 +392,54 @@ void imgInS( char *param,
              short int **ip,
              int *status );
 
+void imgInSec( char *param,
+               int lbnd[],
+               int ubnd[],
+               float **ip,
+               int *status );
+
+void imgInSecB( char *param,
+                int lbnd[],
+                int ubnd[],
+                signed char **ip,
+                int *status );
+
+void imgInSecD( char *param,
+                int lbnd[],
+                int ubnd[],
+                double **ip,
+                int *status );
+
+void imgInSecF( char *param,
+                int lbnd[],
+                int ubnd[],
+                float **ip,
+                int *status );
+
+void imgInSecI( char *param,
+                int lbnd[],
+                int ubnd[],
+                int **ip,
+                int *status );
+
+void imgInSecS( char *param,
+                int lbnd[],
+                int ubnd[],
+                short int **ip,
+                int *status );
+
+void imgInSecUB( char *param,
+                 int lbnd[],
+                 int ubnd[],
+                 unsigned char **ip,
+                 int *status );
+
+void imgInSecUS( char *param,
+                 int lbnd[],
+                 int ubnd[],
+                 unsigned short **ip,
+                 int *status );
+
 void imgMod( char *param,
              int *nx,
              int *ny,
@@ -37,6 +37,7 @@
 
 *  Copyright:
 *     Copyright (C) 1991, 1992, 1993, 1994 Science & Engineering Research Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -71,6 +72,8 @@
 *     13-JUL-1994 (PDRAPER):
 *        Now checks that NDFs may be deleted before making the attempt.
 *        An error is issued if the NDF may not be deleted.
+*     14-OCT-2026:
+*        Annul any section mapped by IMG1_INSEC.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -91,6 +94,8 @@
       INCLUDE 'IMG_PCB'          ! IMG_ Parameter Control Block
 *        PCB_INDF( IMG__MXPAR ) = INTEGER (Read and Write)
 *           NDF identifier.
+*        PCB_ISECT( IMG__MXPAR ) = INTEGER (Read and Write)
+*           Mapped section identifier.
 *        PCB_PARAM( IMG__MXPAR ) = CHARACTER * ( IMG__SZPAR ) (Write)
 *           Parameter name.
 *        PCB_PNTR( IMG__MXPAR ) = INTEGER (Write)
@@ -131,6 +136,16 @@
 *  Check if the NDF identifier associated with the slot is valid. If
 *  not, then there is nothing to do.
       ELSE
+
+*  If a section of the NDF has been mapped, then annul it first, which
+*  unmaps its data.
+         CALL NDF_VALID( PCB_ISECT( SLOT ), VALID, STATUS )
+         IF ( ( STATUS .EQ. SAI__OK ) .AND. VALID ) THEN
+            CALL NDF_ANNUL( PCB_ISECT( SLOT ), STATUS )
+         END IF
+         PCB_ISECT( SLOT ) = NDF__NOID
+
+*  Check the NDF identifier itself.
          CALL NDF_VALID( PCB_INDF( SLOT ), VALID, STATUS )
          IF ( STATUS .EQ. SAI__OK ) THEN
 
@@ -48,6 +48,8 @@
 
 *  Copyright:
 *     Copyright (C) 1993 Science & Engineering Research Council
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
 
 *  Licence:
 *     This program is free software; you can redistribute it and/or
@@ -106,6 +108,9 @@
 *        Changed to add NDF to INDF array indexed by NPAR, rather
 *        than SLOT. The upshot of this was that all images, from previous
 *        calls as well as this one, where trimmed to the same dimensions.
+*     14-OCT-2026:
+*        Report an error if the image has been mapped as a section by
+*        IMG_INSEC.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -128,6 +133,8 @@
       INCLUDE 'IMG_PCB'          ! IMG_ Parameter Control Block
 *        PCB_INDF( IMG__MXPCB ) = INTEGER (Read and Write)
 *           NDF identifier.
+*        PCB_ISECT( IMG__MXPCB ) = INTEGER (Read)
+*           Mapped section identifier.
 *        PCB_PNTR( IMG__MXPCB ) = INTEGER (Read and Write)
 *           Pointer to mapped data.
 *        PCB_TYPE( IMG__MXPAR ) = CHARACTER *( * ) (Write)
@@ -231,8 +238,20 @@
 *  NDF.
                      IF ( .NOT. WASNEW ) THEN
 
+*  An image that is mapped a section at a time cannot also be mapped
+*  in full.
+                        IF ( PCB_ISECT( SLOT ) .NE. NDF__NOID ) THEN
+                           STATUS = IMG__SECT
+                           CALL MSG_SETC( 'VPAR', VPAR )
+                           CALL ERR_REP( 'IMG1_GTNDF_SECT',
+     :                          'The image associated with the ' //
+     :                          'parameter ^VPAR is already mapped ' //
+     :                          'as a section and cannot also be ' //
+     :                          'accessed in full (possible ' //
+     :                          'programming error).', STATUS )
+
 *  Is the NDF data array mapped?
-                        IF ( PCB_PNTR( SLOT ) .EQ. IMG__NOPTR ) THEN
+                        ELSE IF ( PCB_PNTR( SLOT ) .EQ. IMG__NOPTR ) THEN
 
 *  Data not mapped treat this as a new NDF (probably initialised by
 *  another routine which didn't require the data array).
@@ -39,6 +39,7 @@
 
 *  Copyright:
 *     Copyright (C) 1991, 1992 Science & Engineering Research Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -71,6 +72,8 @@
 *        common blocks are initialised.
 *     20-FEB-1992 (RFWS):
 *        Improved error message and test for first free slot.
+*     14-OCT-2026:
+*        Initialise the PCB_ISECT entry of new slots.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -91,6 +94,8 @@
       INCLUDE 'IMG_PCB'          ! IMG_ Parameter Control Block
 *        PCB_INDF( IMG__MXPAR ) = INTEGER (Write)
 *           NDF identifier.
+*        PCB_ISECT( IMG__MXPAR ) = INTEGER (Write)
+*           Mapped section identifier.
 *        PCB_PARAM( IMG__MXPAR ) = CHARACTER * ( IMG__SZPAR ) (Read and
 *        Write)
 *           Parameter name.
@@ -153,6 +158,7 @@
                WASNEW = .TRUE.
                SLOT = NEWSLT
                PCB_INDF( SLOT ) = NDF__NOID
+               PCB_ISECT( SLOT ) = NDF__NOID
                PCB_PARAM( SLOT ) = VPAR
                PCB_PNTR( SLOT ) = IMG__NOPTR
 
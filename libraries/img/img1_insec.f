@@ -0,0 +1,224 @@
+      SUBROUTINE IMG1_INSEC( PARAM, TYPE, LBND, UBND, PNTR, STATUS )
+*+
+*  Name:
+*     IMG1_INSEC
+
+*  Purpose:
+*     Map a section of an input image.
+
+*  Language:
+*     Starlink Fortran 77
+
+*  Invocation:
+*     CALL IMG1_INSEC( PARAM, TYPE, LBND, UBND, PNTR, STATUS )
+
+*  Description:
+*     This routine maps, for reading, the data of a 2-dimensional
+*     section of the input image associated with a parameter. Only the
+*     elements of the section are mapped (and converted to the
+*     requested type), so large images may be processed a block at a
+*     time without mapping the whole array.
+*
+*     If the parameter is not already in use, then a new NDF is
+*     associated with it. Any section previously mapped through the
+*     same parameter is released before the new one is mapped, so
+*     calling this routine repeatedly with different bounds steps
+*     through the image. The last section remains mapped until the
+*     parameter is released by IMG1_FRSLT.
+
+*  Arguments:
+*     PARAM = CHARACTER * ( * ) (Given)
+*        Parameter name (case insensitive). A comma-separated list of
+*        names is not allowed.
+*     TYPE = CHARACTER * ( * ) (Given)
+*        Numeric type to be used to access the section's data.
+*     LBND( 2 ) = INTEGER (Given)
+*        Lower bounds of the section, in pixels. These are counted
+*        from 1 at the first pixel of the image, whatever the NDF's
+*        own pixel origin.
+*     UBND( 2 ) = INTEGER (Given)
+*        Upper bounds of the section, in the same coordinates as LBND.
+*     PNTR = INTEGER (Returned)
+*        Pointer to the mapped section data.
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Notes:
+*     - The bounds must lie within the image or an error is reported.
+*     - An image mapped in full by IMG1_GTNDF cannot also be mapped as
+*     a section.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful,but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+
+*  Type Definitions:
+      IMPLICIT NONE              ! No implicit typing
+
+*  Global Constants:
+      INCLUDE 'SAE_PAR'          ! Standard SAE constants
+      INCLUDE 'IMG_CONST'        ! IMG_ private constants
+      INCLUDE 'IMG_ERR'          ! IMG_ error codes
+      INCLUDE 'NDF_PAR'          ! NDF_ public constants
+
+*  Global Variables:
+      INCLUDE 'IMG_PCB'          ! IMG_ Parameter Control Block
+*        PCB_INDF( IMG__MXPAR ) = INTEGER (Read)
+*           NDF identifier.
+*        PCB_ISECT( IMG__MXPAR ) = INTEGER (Read and Write)
+*           Mapped section identifier.
+*        PCB_PNTR( IMG__MXPAR ) = INTEGER (Read and Write)
+*           Pointer to mapped data.
+*        PCB_TYPE( IMG__MXPAR ) = CHARACTER * ( NDF__SZTYP ) (Write)
+*           Record of data type used for mapping.
+
+*  Arguments Given:
+      CHARACTER * ( * ) PARAM
+      CHARACTER * ( * ) TYPE
+      INTEGER LBND( 2 )
+      INTEGER UBND( 2 )
+
+*  Arguments Returned:
+      INTEGER PNTR
+
+*  Status:
+      INTEGER STATUS             ! Global status
+
+*  External References:
+      EXTERNAL IMG1_INIT         ! Initialise common blocks
+
+*  Local Constants:
+      INTEGER MXDIM              ! Maximum number of image dimensions
+      PARAMETER ( MXDIM = 2 )
+
+*  Local Variables:
+      CHARACTER * ( IMG__SZPAR ) VPAR ! Validated parameter name
+      INTEGER EL                 ! Number of elements mapped
+      INTEGER I                  ! Loop counter for dimensions
+      INTEGER NDIM               ! Number of NDF dimensions
+      INTEGER NLBND( MXDIM )     ! NDF lower bounds
+      INTEGER NUBND( MXDIM )     ! NDF upper bounds
+      INTEGER SLBND( MXDIM )     ! Section lower pixel bounds
+      INTEGER SLOT               ! PCB slot number
+      INTEGER SUBND( MXDIM )     ! Section upper pixel bounds
+      LOGICAL WASNEW             ! New PCB slot allocated?
+*.
+
+*  Set an initial null value for the returned pointer.
+      PNTR = IMG__NOPTR
+
+*  Check inherited global status.
+      IF ( STATUS .NE. SAI__OK ) RETURN
+
+*  Sections can only be obtained one parameter at a time.
+      IF ( INDEX( PARAM, ',' ) .NE. 0 ) THEN
+         STATUS = IMG__PARIN
+         CALL MSG_SETC( 'PARAM', PARAM )
+         CALL ERR_REP( 'IMG1_INSEC_LIST',
+     :                 'Image sections cannot be mapped for a list ' //
+     :                 'of parameters (''^PARAM'').', STATUS )
+         GO TO 99
+      END IF
+
+*  Validate the parameter name and obtain a PCB slot for it. If a new
+*  slot was allocated, then associate an NDF with the parameter.
+      CALL IMG1_VPAR( PARAM, VPAR, STATUS )
+      CALL IMG1_GTSLT( VPAR, .TRUE., SLOT, WASNEW, STATUS )
+      IF ( WASNEW ) CALL IMG1_ASSOC( VPAR, 'READ', SLOT, STATUS )
+      IF ( STATUS .NE. SAI__OK ) GO TO 99
+
+*  If the whole image is already mapped, then it cannot be mapped
+*  again as a section.
+      IF ( ( PCB_PNTR( SLOT ) .NE. IMG__NOPTR ) .AND.
+     :     ( PCB_ISECT( SLOT ) .EQ. NDF__NOID ) ) THEN
+         STATUS = IMG__SECT
+         CALL MSG_SETC( 'VPAR', VPAR )
+         CALL ERR_REP( 'IMG1_INSEC_MAP',
+     :                 'The image associated with the parameter ' //
+     :                 '^VPAR is already mapped in full and cannot ' //
+     :                 'also be accessed as a section (possible ' //
+     :                 'programming error).', STATUS )
+         GO TO 99
+      END IF
+
+*  Release any section from a previous call, which unmaps its data.
+      IF ( PCB_ISECT( SLOT ) .NE. NDF__NOID ) THEN
+         CALL NDF_ANNUL( PCB_ISECT( SLOT ), STATUS )
+         PCB_PNTR( SLOT ) = IMG__NOPTR
+      END IF
+
+*  Obtain the NDF bounds and convert the requested bounds into pixel
+*  indices, checking that they lie within the image.
+      CALL NDF_BOUND( PCB_INDF( SLOT ), MXDIM, NLBND, NUBND, NDIM,
+     :                STATUS )
+      IF ( STATUS .NE. SAI__OK ) GO TO 99
+      DO 1 I = 1, MXDIM
+         SLBND( I ) = LBND( I ) + NLBND( I ) - 1
+         SUBND( I ) = UBND( I ) + NLBND( I ) - 1
+         IF ( ( SLBND( I ) .LT. NLBND( I ) ) .OR.
+     :        ( SUBND( I ) .GT. NUBND( I ) ) .OR.
+     :        ( SLBND( I ) .GT. SUBND( I ) ) ) THEN
+            STATUS = IMG__BDBND
+            CALL MSG_SETI( 'L1', LBND( 1 ) )
+            CALL MSG_SETI( 'U1', UBND( 1 ) )
+            CALL MSG_SETI( 'L2', LBND( 2 ) )
+            CALL MSG_SETI( 'U2', UBND( 2 ) )
+            CALL MSG_SETI( 'NX', NUBND( 1 ) - NLBND( 1 ) + 1 )
+            CALL MSG_SETI( 'NY', NUBND( 2 ) - NLBND( 2 ) + 1 )
+            CALL NDF_MSG( 'NDF', PCB_INDF( SLOT ) )
+            CALL ERR_REP( 'IMG1_INSEC_BND',
+     :                    'The section (^L1:^U1,^L2:^U2) does not ' //
+     :                    'lie within the ^NX x ^NY image ^NDF.',
+     :                    STATUS )
+            GO TO 99
+         END IF
+ 1    CONTINUE
+
+*  Create the section and map its data.
+      CALL NDF_SECT( PCB_INDF( SLOT ), MXDIM, SLBND, SUBND,
+     :               PCB_ISECT( SLOT ), STATUS )
+      CALL NDF_MAP( PCB_ISECT( SLOT ), 'Data', TYPE, 'READ',
+     :              PCB_PNTR( SLOT ), EL, STATUS )
+      IF ( STATUS .EQ. SAI__OK ) THEN
+         PCB_TYPE( SLOT ) = TYPE
+         PNTR = PCB_PNTR( SLOT )
+
+*  If the section could not be mapped, then release it.
+      ELSE
+         CALL NDF_ANNUL( PCB_ISECT( SLOT ), STATUS )
+         PCB_ISECT( SLOT ) = NDF__NOID
+         PCB_PNTR( SLOT ) = IMG__NOPTR
+      END IF
+
+ 99   CONTINUE
+      END
+* $Id$
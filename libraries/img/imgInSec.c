@@ -0,0 +1,162 @@
+/*
+ *+
+ *  Name:
+ *     imgInSec
+
+ *  Purpose:
+ *     Defines routines that obtain access to a section of an input
+ *     image.
+
+ *  Language:
+ *     ANSI C
+
+ *  Invocation:
+ *     imgInSec"IMG_F77_TYPE"( param, lbnd, ubnd, ip, status )
+
+ *  Description:
+ *     This routine creates all the imgInSec[x] routines from the
+ *     generic stubs.
+
+ *  Arguments:
+ *     param = char * (Given)
+ *        Parameter name. (case insensitive).
+ *     lbnd = int[ 2 ] (Given)
+ *        Lower bounds of the section (in pixels).
+ *     ubnd = int[ 2 ] (Given)
+ *        Upper bounds of the section (in pixels).
+ *     ip = ? ** (Returned)
+ *        Pointer to the section data.
+ *     status = int * (Given and Returned)
+ *        The global status.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful,but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+ *  Authors:
+ *     {enter_new_authors_here}
+
+ *  History:
+ *     14-OCT-2026:
+ *        Original version.
+ *     {enter_changes_here}
+
+ *-
+ */
+#include <string.h>
+#include <stdlib.h>
+#include "cnf.h"
+#include "f77.h"
+#include "img1.h"
+
+/*  Define the various names of the subroutines. Note we use two
+    macros that join the parts to the type because of use of ##
+    needs to be deferred a while!
+    */
+
+#define XIMG_INSEC(type)  F77_SUBROUTINE(img_insec ## type)
+#define IMG_INSEC(type)   XIMG_INSEC(type)
+
+#define XIMGINSEC(type)  void imgInSec ## type
+#define IMGINSEC(type)   XIMGINSEC(type)
+
+#define XIMGINSEC_CALL(type)  F77_CALL(img_insec ## type)
+#define IMGINSEC_CALL(type)   XIMGINSEC_CALL(type)
+
+/*  Define the macros for each of the data types for each of the
+    modules, then include the generic code to create the actual
+    modules. */
+
+/*  Default type information */
+#define IMG_F77_TYPE
+#define IMG_SHORT_C_TYPE
+#define IMG_FULL_C_TYPE float
+#include "imgInSecGen.h"
+
+/*  Byte */
+#undef IMG_F77_TYPE
+#undef IMG_SHORT_C_TYPE
+#undef IMG_FULL_C_TYPE
+
+#define IMG_F77_TYPE b
+#define IMG_SHORT_C_TYPE B
+#define IMG_FULL_C_TYPE signed char
+#include "imgInSecGen.h"
+
+/*  Unsigned Byte */
+#undef IMG_F77_TYPE
+#undef IMG_SHORT_C_TYPE
+#undef IMG_FULL_C_TYPE
+
+#define IMG_F77_TYPE ub
+#define IMG_SHORT_C_TYPE UB
+#define IMG_FULL_C_TYPE unsigned char
+#include "imgInSecGen.h"
+
+/*  Word */
+#undef IMG_F77_TYPE
+#undef IMG_SHORT_C_TYPE
+#undef IMG_FULL_C_TYPE
+
+#define IMG_F77_TYPE w
+#define IMG_SHORT_C_TYPE S
+#define IMG_FULL_C_TYPE short int
+#include "imgInSecGen.h"
+
+/*  Unsigned word */
+#undef IMG_F77_TYPE
+#undef IMG_SHORT_C_TYPE
+#undef IMG_FULL_C_TYPE
+
+#define IMG_F77_TYPE uw
+#define IMG_SHORT_C_TYPE US
+#define IMG_FULL_C_TYPE unsigned short
+#include "imgInSecGen.h"
+
+/*  Integer */
+#undef IMG_F77_TYPE
+#undef IMG_SHORT_C_TYPE
+#undef IMG_FULL_C_TYPE
+
+#define IMG_F77_TYPE i
+#define IMG_SHORT_C_TYPE I
+#define IMG_FULL_C_TYPE int
+#include "imgInSecGen.h"
+
+/*  Real */
+#undef IMG_F77_TYPE
+#undef IMG_SHORT_C_TYPE
+#undef IMG_FULL_C_TYPE
+
+#define IMG_F77_TYPE r
+#define IMG_SHORT_C_TYPE F
+#define IMG_FULL_C_TYPE float
+#include "imgInSecGen.h"
+
+/*  Double precision */
+#undef IMG_F77_TYPE
+#undef IMG_SHORT_C_TYPE
+#undef IMG_FULL_C_TYPE
+
+#define IMG_F77_TYPE d
+#define IMG_SHORT_C_TYPE D
+#define IMG_FULL_C_TYPE double
+#include "imgInSecGen.h"
+
+/* $Id$ */
@@ -0,0 +1,115 @@
+/*
+ *+
+ *  Name:
+ *     imgInSecGen
+
+ *  Purpose:
+ *     Obtains access to a section of an input image using a specific
+ *     type.
+
+ *  Language:
+ *     ANSI C
+
+ *  Invocation:
+ *     imgInSec?( param, lbnd, ubnd, ip, status )
+
+ *  Description:
+ *     This C function sets up the required arguments and calls the
+ *     Fortran subroutine img_insec[x].
+ *     On return, values are converted back to C form if necessary.
+ *
+ *     This version is the generic form for the float, double, int,
+ *     short, unsigned short, char and unsigned char versions. Just
+ *     include this in the appropriate stub after setting the
+ *     values of the macros:
+ *
+ *        IMG_F77_TYPE   = (r|d|l|i|w|uw|b|ub)
+ *        IMG_FULL_C_TYPE   = (float|double|short etc.)
+ *        IMG_SHORT_C_TYPE   = (F|D|I|S|US|B|UB)
+ *
+ *     The IMG_F77_TYPE essentially names the fortran version of this
+ *     routine to invoke.
+
+ *  Arguments:
+ *     param = char * (Given)
+ *        Parameter name (case insensitive).
+ *     lbnd = int[ 2 ] (Given)
+ *        Lower bounds of the section (in pixels). The first pixel of
+ *        the image is (1,1).
+ *     ubnd = int[ 2 ] (Given)
+ *        Upper bounds of the section (in pixels).
+ *     ip = ? ** (Returned)
+ *        Pointer to the section data.
+ *     status = int * (Given and Returned)
+ *        The global status.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful,but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+ *  Authors:
+ *     {enter_new_authors_here}
+
+ *  History:
+ *     14-OCT-2026:
+ *        Original version.
+ *     {enter_changes_here}
+
+ *-
+ */
+
+
+IMG_INSEC( IMG_F77_TYPE ) ( CHARACTER(param),
+                            INTEGER_ARRAY(lbnd),
+                            INTEGER_ARRAY(ubnd),
+                            POINTER(ip),
+                            INTEGER(status)
+                            TRAIL(param) );
+
+IMGINSEC( IMG_SHORT_C_TYPE ) ( char *param,
+                               int lbnd[],
+                               int ubnd[],
+                               IMG_FULL_C_TYPE **ip,
+                               int *status )
+{
+  DECLARE_CHARACTER_DYN( fparam );
+  DECLARE_INTEGER_ARRAY( flbnd, 2 );
+  DECLARE_INTEGER_ARRAY( fubnd, 2 );
+  DECLARE_POINTER( fip );
+
+  F77_CREATE_CHARACTER( fparam, strlen( param ) );
+  F77_EXPORT_CHARACTER( param, fparam, fparam_length );
+  F77_EXPORT_INTEGER_ARRAY( lbnd, flbnd, 2 );
+  F77_EXPORT_INTEGER_ARRAY( ubnd, fubnd, 2 );
+
+  IMGINSEC_CALL( IMG_F77_TYPE ) ( CHARACTER_ARG(fparam),
+                                  INTEGER_ARRAY_ARG(flbnd),
+                                  INTEGER_ARRAY_ARG(fubnd),
+                                  POINTER_ARG(&fip),
+                                  INTEGER_ARG(status)
+                                  TRAIL_ARG(fparam) );
+
+  /*  Now convert the address back to a C pointer */
+  F77_IMPORT_POINTER( fip, *ip );
+
+  F77_FREE_CHARACTER( fparam );
+
+  return;
+}
+/* $Id$ */
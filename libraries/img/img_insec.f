@@ -0,0 +1,125 @@
+      SUBROUTINE IMG_INSEC( PARAM, LBND, UBND, IP, STATUS )
+*+
+*  Name:
+*     IMG_INSEC
+
+*  Purpose:
+*     Obtains access to a section of an input image.
+
+*  Language:
+*     Starlink Fortran 77
+
+*  Invocation:
+*     CALL IMG_INSEC( PARAM, LBND, UBND, IP, STATUS )
+
+*  Description:
+*     This routine provides access to a rectangular section of a
+*     2-dimensional input image. It returns a pointer to the data of
+*     the section only, mapped as floating point (REAL) values. Large images can be
+*     processed in blocks by calling this routine repeatedly with
+*     the bounds of each block in turn: each call releases the section
+*     mapped by the previous one, so only one block is ever mapped.
+
+*  Arguments:
+*     PARAM = CHARACTER * ( * ) (Given)
+*        Parameter name (case insensitive).
+*     LBND( 2 ) = INTEGER (Given)
+*        Lower bounds of the section (in pixels). The first pixel of
+*        the image is (1,1).
+*     UBND( 2 ) = INTEGER (Given)
+*        Upper bounds of the section (in pixels).
+*     IP = INTEGER (Returned)
+*        Pointer to the section data. The section is
+*        UBND( 1 ) - LBND( 1 ) + 1 pixels wide and
+*        UBND( 2 ) - LBND( 2 ) + 1 pixels high.
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Notes:
+*     - The size of the image can be found first using IMG_INDF and
+*     NDF_DIM.
+*
+*     - The section bounds must lie within the image.
+*
+*     - Only a single parameter name may be given, and an image
+*     accessed using this routine cannot also be mapped in full using
+*     IMG_IN (or vice versa) through the same parameter.
+*
+*     - The final section remains mapped until the image is released
+*     using IMG_FREE.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful,but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+
+*  Type Definitions:
+      IMPLICIT NONE             ! No implicit typing
+
+*  Global Constants:
+      INCLUDE 'SAE_PAR'         ! Standard SAE constants
+      INCLUDE 'IMG_CONST'       ! IMG_ private constants
+
+*  Arguments Given:
+      CHARACTER * ( * ) PARAM
+      INTEGER LBND( 2 )
+      INTEGER UBND( 2 )
+
+*  Arguments Returned:
+      INTEGER IP
+
+*  Status:
+      INTEGER STATUS            ! Global status
+
+*  External References:
+      EXTERNAL IMG1_OK
+      LOGICAL IMG1_OK           ! Test if error status is OK
+
+*.
+
+*  Set an initial null value for the returned pointer.
+      IP = IMG__NOPTR
+
+*  Check inherited global status.
+      IF ( STATUS .NE. SAI__OK ) RETURN
+
+*  Map the section.
+      CALL IMG1_INSEC( PARAM, '_REAL', LBND, UBND, IP, STATUS )
+
+*  If an error occurred, then report a contextual message.
+      IF ( .NOT. IMG1_OK( STATUS ) ) THEN
+         CALL ERR_REP( 'IMG_INSEC_ERR',
+     :        'IMG_INSEC: Error obtaining access to a section of ' //
+     :        'an input image.', STATUS )
+      END IF
+
+      END
+* $Id$
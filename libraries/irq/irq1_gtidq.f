@@ -91,6 +91,7 @@
 *  Copyright:
 *     Copyright (C) 1991 Science & Engineering Research Council.
 *     Copyright (C) 2004 Central Laboratory of the Research Councils.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -119,6 +120,8 @@
 *        Original version.
 *     2004 September 1 (TIMJ):
 *        Use CNF_PVAL
+*     14-OCT-2026:
+*        Tabulate the expression's value for each QUALITY value.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -160,6 +163,8 @@
 *           No. of operations needed to evaluate the quality expression.
 *        QCM_OPPNT( IRQ__MAXQ ) = INTEGER (Write)
 *           Pointer to mapped array holding op. codes.
+*        QCM_TABLE( 0 : 255, IRQ__MAXQ ) = LOGICAL (Write)
+*           Value of the quality expression for each QUALITY value.
 *        QCM_VALID( IRQ__MAXQ ) = LOGICAL (Read and Write)
 *           True if the corresponding compiled quality expression identifier is
 *           use).
@@ -253,6 +258,13 @@
      :               %VAL( CNF_PVAL( QCM_OPPNT( IDQ ) ) ),
      :                IERR, NERR, STATUS )
 
+*  Evaluate the expression for every possible QUALITY value, so that
+*  IRQ_SBAD can use a table look-up rather than the op. codes.
+      IF( STATUS .EQ. SAI__OK ) THEN
+         CALL IRQ1_QTAB( NMASKS, MASKS, NOPC, OPCODE, MXSTK,
+     :                   QCM_TABLE( 0, IDQ ), STATUS )
+      END IF
+
 *  If all is OK, indicate that the identifier is in use.
       IF ( STATUS .EQ. SAI__OK ) QCM_VALID( IDQ ) = .TRUE.
 
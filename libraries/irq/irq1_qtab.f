@@ -0,0 +1,149 @@
+      SUBROUTINE IRQ1_QTAB( NMASK, MASK, NOPC, OPCODE, MXSTK, TABLE,
+     :                      STATUS )
+*+
+*  Name:
+*     IRQ1_QTAB
+
+*  Purpose:
+*     Tabulate the value of a quality expression for every QUALITY
+*     value.
+
+*  Language:
+*     Starlink Fortran 77
+
+*  Invocation:
+*     CALL IRQ1_QTAB( NMASK, MASK, NOPC, OPCODE, MXSTK, TABLE, STATUS )
+
+*  Description:
+*     The value of a compiled quality expression depends only on the
+*     8 bits of the QUALITY value to which it is applied. This routine
+*     evaluates the expression once for each of the 256 possible
+*     QUALITY values and returns the results in a table, so that the
+*     expression can afterwards be evaluated for each pixel of a
+*     QUALITY array with a single table look-up.
+*
+*     The expression is evaluated using IRQ1_SBAD1R, so the table
+*     agrees exactly with a full evaluation of the op. codes.
+
+*  Arguments:
+*     NMASK = INTEGER (Given)
+*        No. of different masks used in the quality expression.
+*     MASK( * ) = INTEGER (Given)
+*        Masks defining each quality name.
+*     NOPC = INTEGER (Given)
+*        The number of op. codes in OPCODE.
+*     OPCODE( NOPC ) = INTEGER (Given)
+*        The codes which define the operations which must be performed
+*        in order to evaluate the quality expression.
+*     MXSTK = INTEGER (Given)
+*        The maximum stack size needed to evaluate the quality
+*        expression.
+*     TABLE( 0 : 255 ) = LOGICAL (Returned)
+*        TABLE( Q ) is returned true if a pixel with QUALITY value Q
+*        satisfies the quality expression.
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful,but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+
+*  Type Definitions:
+      IMPLICIT NONE              ! No implicit typing
+
+*  Global Constants:
+      INCLUDE 'SAE_PAR'          ! Standard SAE constants
+      INCLUDE 'DAT_PAR'          ! DAT__ constants
+      INCLUDE 'PRM_PAR'          ! Starlink data constants
+      INCLUDE 'CNF_PAR'          ! For CNF_PVAL function
+
+*  Arguments Given:
+      INTEGER NMASK
+      INTEGER MASK( * )
+      INTEGER NOPC
+      INTEGER OPCODE( NOPC )
+      INTEGER MXSTK
+
+*  Arguments Returned:
+      LOGICAL TABLE( 0 : 255 )
+
+*  Status:
+      INTEGER STATUS             ! Global status
+
+*  Local Constants:
+      INTEGER NQVAL              ! No. of possible QUALITY values
+      PARAMETER ( NQVAL = 256 )
+
+*  Local Variables:
+      BYTE QUAL( NQVAL )         ! Each possible QUALITY value
+      CHARACTER WLOC*(DAT__SZLOC)! Locator for temporary workspace.
+      INTEGER I                  ! QUALITY value
+      INTEGER NEL                ! No. of elements in workspace
+      INTEGER WPNT               ! Pointer to mapped workspace.
+      LOGICAL ALLBAD             ! All pixels bad?
+      LOGICAL NOBAD              ! No pixels bad?
+      REAL VEC( NQVAL )          ! Set bad where expression is true
+*.
+
+*  Check inherited global status.
+      IF ( STATUS .NE. SAI__OK ) RETURN
+
+*  Set up a "QUALITY array" holding every possible value, and a vector
+*  of good values to be set bad by the expression. BYTE values above
+*  127 are stored as negative numbers.
+      DO I = 0, NQVAL - 1
+         IF( I .LE. 127 ) THEN
+            QUAL( I + 1 ) = I
+         ELSE
+            QUAL( I + 1 ) = I - NQVAL
+         END IF
+         VEC( I + 1 ) = 0.0
+      END DO
+
+*  Evaluate the expression for each value, using temporary workspace
+*  for the evaluation stack.
+      CALL IRQ1_TEMP( '_LOGICAL', 1, MAX( 1, MXSTK )*NQVAL, WLOC,
+     :                STATUS )
+      CALL DAT_MAPV( WLOC, '_LOGICAL', 'WRITE', WPNT, NEL, STATUS )
+      IF( STATUS .EQ. SAI__OK ) THEN
+         CALL IRQ1_SBAD1R( .TRUE., NMASK, MASK, NOPC, OPCODE, MXSTK,
+     :                     NQVAL, QUAL, %VAL( CNF_PVAL( WPNT ) ), VEC,
+     :                     ALLBAD, NOBAD, STATUS )
+      END IF
+      CALL IRQ1_ANTMP( WLOC, STATUS )
+
+*  Those values which were set bad satisfy the expression.
+      DO I = 0, NQVAL - 1
+         TABLE( I ) = ( VEC( I + 1 ) .EQ. VAL__BADR )
+      END DO
+
+      END
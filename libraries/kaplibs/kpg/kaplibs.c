@@ -82,6 +82,8 @@
 *        Add kpg1_filli.
 *     2011-08-22 (TIMJ):
 *        kpg1GhstX has a new API
+*     14-OCT-2026:
+*        kpgStatd and kpgStati now use the kpg1Msta statistics kernel.
 *     {enter_further_changes_here}
 
 *-
@@ -370,192 +372,62 @@ void kpg1Pseed( int *status ){
 
 /* ------------------------------- */
 
-F77_SUBROUTINE(kpg1_statd)( LOGICAL(BAD), INTEGER(EL), DOUBLE_ARRAY(DATA),
-			    INTEGER(NCLIP), REAL_ARRAY(CLIP), INTEGER(NGOOD),
-			    INTEGER(IMIN), DOUBLE(DMIN), INTEGER(IMAX),
-			    DOUBLE(DMAX), DOUBLE(SUM), DOUBLE(MEAN), DOUBLE(STDEV),
-			    INTEGER(NGOODC), INTEGER(IMINC), DOUBLE(DMINC),
-			    INTEGER(IMAXC), DOUBLE(DMAXC), DOUBLE(SUMC), DOUBLE(MEANC),
-			    DOUBLE(STDEVC), INTEGER(STATUS) );
+/* kpgStatd and kpgStati call the C statistics kernel directly, in the
+   calling thread, since they may themselves be called from within a
+   thread. */
+static void kpgStat( const char *type, int bad, int el, const void *data,
+                     int nclip, const float clip[], int *ngood, int *imin,
+                     double *dmin, int *imax, double *dmax, double *sum,
+                     double *mean, double *stdev, int *ngoodc, int *iminc,
+                     double *dminc, int *imaxc, double *dmaxc, double *sumc,
+                     double *meanc, double *stdevc, int *status ) {
+  int istat[ 3 ];
+  int istatc[ 3 ];
+  double dstat[ 7 ];
+  double dstatc[ 7 ];
+
+  kpg1Msta( NULL, type, bad, 1, ( el > 0 ) ? (size_t) el : 0, data,
+            nclip, clip, istat, dstat, istatc, dstatc, status );
+  if( *status != SAI__OK ) return;
+
+  *ngood = istat[ 0 ];
+  *imin = istat[ 1 ];
+  *imax = istat[ 2 ];
+  *dmin = dstat[ 0 ];
+  *dmax = dstat[ 1 ];
+  *sum = dstat[ 2 ];
+  *mean = dstat[ 3 ];
+  *stdev = dstat[ 4 ];
+  *ngoodc = istatc[ 0 ];
+  *iminc = istatc[ 1 ];
+  *imaxc = istatc[ 2 ];
+  *dminc = dstatc[ 0 ];
+  *dmaxc = dstatc[ 1 ];
+  *sumc = dstatc[ 2 ];
+  *meanc = dstatc[ 3 ];
+  *stdevc = dstatc[ 4 ];
+}
 
 void kpgStatd( int bad, int el, const double data[], int nclip, const float clip[],
 	       int * ngood, int *imin, double * dmin, int * imax,
 	       double * dmax, double * sum, double * mean, double * stdev,
 	       int * ngoodc, int * iminc, double * dminc, int * imaxc, double * dmaxc,
 	       double * sumc, double * meanc, double * stdevc, int * status ) {
-
-  DECLARE_LOGICAL(BAD);
-  DECLARE_INTEGER(EL);
-  DECLARE_DOUBLE_ARRAY_DYN(DATA);
-  DECLARE_INTEGER(NCLIP);
-  DECLARE_REAL_ARRAY_DYN(CLIP);
-  DECLARE_INTEGER(NGOOD);
-  DECLARE_INTEGER(IMIN);
-  DECLARE_DOUBLE(DMIN);
-  DECLARE_INTEGER(IMAX);
-  DECLARE_DOUBLE(DMAX);
-  DECLARE_DOUBLE(SUM);
-  DECLARE_DOUBLE(MEAN);
-  DECLARE_DOUBLE(STDEV);
-  DECLARE_INTEGER(NGOODC);
-  DECLARE_INTEGER(IMINC);
-  DECLARE_DOUBLE(DMINC);
-  DECLARE_INTEGER(IMAXC);
-  DECLARE_DOUBLE(DMAXC);
-  DECLARE_DOUBLE(SUMC);
-  DECLARE_DOUBLE(MEANC);
-  DECLARE_DOUBLE(STDEVC);
-  DECLARE_INTEGER(STATUS);
-
-  F77_CREATE_DOUBLE_ARRAY( DATA, el );
-  F77_CREATE_REAL_ARRAY( CLIP, nclip );
-
-  F77_EXPORT_LOGICAL( bad, BAD );
-  F77_EXPORT_INTEGER( el, EL );
-  F77_EXPORT_DOUBLE_ARRAY( data, DATA, el );
-  F77_EXPORT_INTEGER( nclip, NCLIP );
-  F77_EXPORT_REAL_ARRAY( clip, CLIP, nclip );
-  F77_EXPORT_INTEGER( *status, STATUS );
-
-  F77_LOCK( F77_CALL(kpg1_statd)( LOGICAL_ARG(&BAD),
-			INTEGER_ARG(&EL),
-			DOUBLE_ARRAY_ARG(DATA),
-			INTEGER_ARG(&NCLIP),
-			REAL_ARRAY_ARG(CLIP),
-			INTEGER_ARG(&NGOOD),
-			INTEGER_ARG(&IMIN),
-			DOUBLE_ARG(&DMIN),
-			INTEGER_ARG(&IMAX),
-			DOUBLE_ARG(&DMAX),
-			DOUBLE_ARG(&SUM),
-			DOUBLE_ARG(&MEAN),
-			DOUBLE_ARG(&STDEV),
-			INTEGER_ARG(&NGOODC),
-			INTEGER_ARG(&IMINC),
-			DOUBLE_ARG(&DMINC),
-			INTEGER_ARG(&IMAXC),
-			DOUBLE_ARG(&DMAXC),
-			DOUBLE_ARG(&SUMC),
-			DOUBLE_ARG(&MEANC),
-			DOUBLE_ARG(&STDEVC),
-			INTEGER_ARG(&STATUS) ); )
-
-  F77_IMPORT_INTEGER( STATUS, *status );
-  F77_IMPORT_INTEGER( NGOOD, *ngood );
-  F77_IMPORT_INTEGER( IMIN, *imin );
-  F77_IMPORT_DOUBLE( DMIN, *dmin );
-  F77_IMPORT_INTEGER( IMAX, *imax );
-  F77_IMPORT_DOUBLE( DMAX, *dmax );
-  F77_IMPORT_DOUBLE( SUM, *sum );
-  F77_IMPORT_DOUBLE( MEAN, *mean );
-  F77_IMPORT_DOUBLE( STDEV, *stdev );
-  F77_IMPORT_INTEGER( NGOODC, *ngoodc );
-  F77_IMPORT_INTEGER( IMINC, *iminc );
-  F77_IMPORT_DOUBLE( DMINC, *dminc );
-  F77_IMPORT_INTEGER( IMAXC, *imaxc );
-  F77_IMPORT_DOUBLE( DMAXC, *dmaxc );
-  F77_IMPORT_DOUBLE( SUMC, *sumc );
-  F77_IMPORT_DOUBLE( MEANC, *meanc );
-  F77_IMPORT_DOUBLE( STDEVC, *stdevc );
-
-  F77_FREE_DOUBLE( DATA );
-  F77_FREE_REAL( CLIP );
-
+  kpgStat( "_DOUBLE", bad, el, data, nclip, clip, ngood, imin, dmin, imax,
+           dmax, sum, mean, stdev, ngoodc, iminc, dminc, imaxc, dmaxc, sumc,
+           meanc, stdevc, status );
 }
 
 /* ------------------------------- */
 
-F77_SUBROUTINE(kpg1_stati)( LOGICAL(BAD), INTEGER(EL), INTEGER_ARRAY(DATA),
-			    INTEGER(NCLIP), REAL_ARRAY(CLIP), INTEGER(NGOOD),
-			    INTEGER(IMIN), DOUBLE(DMIN), INTEGER(IMAX),
-			    DOUBLE(DMAX), DOUBLE(SUM), DOUBLE(MEAN), DOUBLE(STDEV),
-			    INTEGER(NGOODC), INTEGER(IMINC), DOUBLE(DMINC),
-			    INTEGER(IMAXC), DOUBLE(DMAXC), DOUBLE(SUMC), DOUBLE(MEANC),
-			    DOUBLE(STDEVC), INTEGER(STATUS) );
-
 void kpgStati( int bad, int el, const int data[], int nclip, const float clip[],
 	       int * ngood, int *imin, double * dmin, int * imax,
 	       double * dmax, double * sum, double * mean, double * stdev,
 	       int * ngoodc, int * iminc, double * dminc, int * imaxc, double * dmaxc,
 	       double * sumc, double * meanc, double * stdevc, int * status ) {
-
-  DECLARE_LOGICAL(BAD);
-  DECLARE_INTEGER(EL);
-  DECLARE_INTEGER_ARRAY_DYN(DATA);
-  DECLARE_INTEGER(NCLIP);
-  DECLARE_REAL_ARRAY_DYN(CLIP);
-  DECLARE_INTEGER(NGOOD);
-  DECLARE_INTEGER(IMIN);
-  DECLARE_DOUBLE(DMIN);
-  DECLARE_INTEGER(IMAX);
-  DECLARE_DOUBLE(DMAX);
-  DECLARE_DOUBLE(SUM);
-  DECLARE_DOUBLE(MEAN);
-  DECLARE_DOUBLE(STDEV);
-  DECLARE_INTEGER(NGOODC);
-  DECLARE_INTEGER(IMINC);
-  DECLARE_DOUBLE(DMINC);
-  DECLARE_INTEGER(IMAXC);
-  DECLARE_DOUBLE(DMAXC);
-  DECLARE_DOUBLE(SUMC);
-  DECLARE_DOUBLE(MEANC);
-  DECLARE_DOUBLE(STDEVC);
-  DECLARE_INTEGER(STATUS);
-
-  F77_CREATE_INTEGER_ARRAY( DATA, el );
-  F77_CREATE_REAL_ARRAY( CLIP, nclip );
-
-  F77_EXPORT_LOGICAL( bad, BAD );
-  F77_EXPORT_INTEGER( el, EL );
-  F77_EXPORT_INTEGER_ARRAY( data, DATA, el );
-  F77_EXPORT_INTEGER( nclip, NCLIP );
-  F77_EXPORT_REAL_ARRAY( clip, CLIP, nclip );
-  F77_EXPORT_INTEGER( *status, STATUS );
-
-  F77_LOCK( F77_CALL(kpg1_stati)( LOGICAL_ARG(&BAD),
-			INTEGER_ARG(&EL),
-			INTEGER_ARRAY_ARG(DATA),
-			INTEGER_ARG(&NCLIP),
-			REAL_ARRAY_ARG(CLIP),
-			INTEGER_ARG(&NGOOD),
-			INTEGER_ARG(&IMIN),
-			DOUBLE_ARG(&DMIN),
-			INTEGER_ARG(&IMAX),
-			DOUBLE_ARG(&DMAX),
-			DOUBLE_ARG(&SUM),
-			DOUBLE_ARG(&MEAN),
-			DOUBLE_ARG(&STDEV),
-			INTEGER_ARG(&NGOODC),
-			INTEGER_ARG(&IMINC),
-			DOUBLE_ARG(&DMINC),
-			INTEGER_ARG(&IMAXC),
-			DOUBLE_ARG(&DMAXC),
-			DOUBLE_ARG(&SUMC),
-			DOUBLE_ARG(&MEANC),
-			DOUBLE_ARG(&STDEVC),
-			INTEGER_ARG(&STATUS) ); )
-
-  F77_IMPORT_INTEGER( STATUS, *status );
-  F77_IMPORT_INTEGER( NGOOD, *ngood );
-  F77_IMPORT_INTEGER( IMIN, *imin );
-  F77_IMPORT_DOUBLE( DMIN, *dmin );
-  F77_IMPORT_INTEGER( IMAX, *imax );
-  F77_IMPORT_DOUBLE( DMAX, *dmax );
-  F77_IMPORT_DOUBLE( SUM, *sum );
-  F77_IMPORT_DOUBLE( MEAN, *mean );
-  F77_IMPORT_DOUBLE( STDEV, *stdev );
-  F77_IMPORT_INTEGER( NGOODC, *ngoodc );
-  F77_IMPORT_INTEGER( IMINC, *iminc );
-  F77_IMPORT_DOUBLE( DMINC, *dminc );
-  F77_IMPORT_INTEGER( IMAXC, *imaxc );
-  F77_IMPORT_DOUBLE( DMAXC, *dmaxc );
-  F77_IMPORT_DOUBLE( SUMC, *sumc );
-  F77_IMPORT_DOUBLE( MEANC, *meanc );
-  F77_IMPORT_DOUBLE( STDEVC, *stdevc );
-
-  F77_FREE_DOUBLE( DATA );
-  F77_FREE_REAL( CLIP );
-
+  kpgStat( "_INTEGER", bad, el, data, nclip, clip, ngood, imin, dmin, imax,
+           dmax, sum, mean, stdev, ngoodc, iminc, dminc, imaxc, dmaxc, sumc,
+           meanc, stdevc, status );
 }
 
 /* ------------------------------- */
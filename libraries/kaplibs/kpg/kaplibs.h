@@ -90,6 +90,8 @@
 *        kpg1GhstX has a new API
 *     2013 December 12 (MJC):
 *        Sort so it's easier to see what is available or missing.
+*     14-OCT-2026:
+*        Added kpg1Msta.
 *     {enter_further_changes_here}
 
 *-
@@ -99,6 +101,7 @@
 #include "star/grp.h"
 #include "star/hds.h"
 #include "star/hds_fortran.h"
+#include "star/thr.h"
 
 /* Macros */
 /* ====== */
@@ -204,5 +207,7 @@ void kpgStati( int, int, const int[], int, const float[], int *, int *,
 
 void kpg1CrMapD( int, int, const double x[], const double y[], int, double *, int * );
 
+void kpg1Msta( ThrWorkForce *, const char *, int, int, size_t, const void *, int, const float[], int[3], double[7], int[3], double[7], int * );
+
 
 #endif
@@ -5,7 +5,17 @@
 #include "sae_par.h"
 #include "par_err.h"
 #include "mers.h"
-
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/* The KeyMap holding the previously read defaults files. Each key is the
+   "def" string supplied to kpg1Config, and each value is a KeyMap holding
+   the modification time and size of the file, and a KeyMap holding the
+   values read from it. */
+static AstKeyMap *kpg1Config_Cache = NULL;
 
 /* Prototypes for internal helper routines */
 static AstKeyMap *kpg1Config_ProcessNesting( AstKeyMap *keymap, AstKeyMap *nested,
@@ -13,6 +23,8 @@ static AstKeyMap *kpg1Config_ProcessNesting( AstKeyMap *keymap, AstKeyMap *neste
 static void kpg1Config_CheckNames( AstKeyMap *map1, AstKeyMap *map2, Grp *grp,
                                    const char *param, const char *prefix,
                                    int *status );
+static AstKeyMap *kpg1Config_ReadDefs( const char *def, int *status );
+static int kpg1Config_DefInfo( const char *def, double *mtime, double *fsize );
 
 
 
@@ -115,6 +127,11 @@ AstKeyMap *kpg1Config( const char *param, const char *def,
 *  Notes:
 *     - The KeyError attribute is set non-zero in the returned KeyMap so that an error
 *     will be reported by astMapGet<X> if the requested key does not exist in the KeyMap.
+*     - The values read from each defaults file are retained, and re-used
+*     by later calls that supply the same "def" string, so long as the
+*     modification time and size of the file have not changed. Files that
+*     include other files (using "^") are read every time. This function
+*     should only be called from the main thread.
 
 *  Returned Value:
 *     A pointer to the AST KeyMap, or NULL if an error occurrs.
@@ -175,6 +192,9 @@ AstKeyMap *kpg1Config( const char *param, const char *def,
 *     1-SEP-2014 (DSB):
 *        Correct the error message issued when the user config contains a 
 *        parameter that is not in the defaults config.
+*     14-OCT-2026:
+*        Keep the KeyMap read from each defaults file, so that the file
+*        is only parsed again if it has been modified.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -189,24 +209,14 @@ AstKeyMap *kpg1Config( const char *param, const char *def,
    Grp *grp = NULL;             /* Group to hold config values */
    char *value;                 /* Pointer to GRP element buffer */
    char buffer[ GRP__SZNAM ];   /* Buffer for GRP element */
-   int added;                   /* Number of names added to group */
-   int flag;                    /* Flag */
    size_t size;                 /* Size of group */
 
 /* Check inherited status */
    if( *status != SAI__OK ) return result;
 
-/* Attempt to read the specified defaults file into a GRP group. */
+/* Get a KeyMap holding the values in the specified defaults file. */
    if( def ) {
-      grp = grpNew( "GRP", status );
-      sprintf( buffer, "^%s", def );
-      grpGrpex( buffer, NULL, grp, &size, &added, &flag, status );
-
-/* Create a KeyMap from this group. */
-      kpg1Kymap( grp, &result, status );
-
-/* Delete the group. */
-      grpDelet( &grp, status );
+      result = kpg1Config_ReadDefs( def, status );
 
 /* Handle nested entries */
       result = kpg1Config_ProcessNesting( result, nested, status );
@@ -579,4 +589,134 @@ static void kpg1Config_CheckNames( AstKeyMap *map1, AstKeyMap *map2, Grp *grp,
    }
 }
 
+/*
+ * This function returns a new KeyMap holding the values read from the
+ * supplied defaults file. If the file has previously been read, and has
+ * not been modified since, the returned KeyMap is a deep copy of the
+ * KeyMap read previously. Otherwise the file is read into a GRP group
+ * and converted to a KeyMap, which is retained for use by later calls.
+ */
+
+static AstKeyMap *kpg1Config_ReadDefs( const char *def, int *status ){
+   AstKeyMap *entry;
+   AstKeyMap *result = NULL;
+   AstObject *obj;
+   Grp *grp;
+   char buffer[ GRP__SZNAM ];
+   double fsize;
+   double mtime;
+   double oldsize;
+   double oldtime;
+   int added;
+   int cache;
+   int flag;
+   size_t size;
+
+   if( *status != SAI__OK ) return result;
+
+/* See if the file can be cached, and get its modification time and size. */
+   cache = kpg1Config_DefInfo( def, &mtime, &fsize );
+
+/* If the file has been read before and has not changed, return a copy
+   of the KeyMap read previously. */
+   if( cache && kpg1Config_Cache &&
+       astMapGet0A( kpg1Config_Cache, def, &obj ) ) {
+      entry = (AstKeyMap *) obj;
+      if( astMapGet0D( entry, "MTIME", &oldtime ) &&
+          astMapGet0D( entry, "SIZE", &oldsize ) &&
+          oldtime == mtime && oldsize == fsize &&
+          astMapGet0A( entry, "VALUES", &obj ) ) {
+         result = astCopy( obj );
+         obj = astAnnul( obj );
+      }
+      entry = astAnnul( entry );
+      if( result ) return result;
+   }
+
+/* Otherwise, read the file into a GRP group, and create a KeyMap from it. */
+   grp = grpNew( "GRP", status );
+   sprintf( buffer, "^%s", def );
+   grpGrpex( buffer, NULL, grp, &size, &added, &flag, status );
+   kpg1Kymap( grp, &result, status );
+   grpDelet( &grp, status );
+
+/* Store a copy of the KeyMap in the cache. The cache is exempted from
+   AST context handling so that it persists between calls. */
+   if( cache && result && *status == SAI__OK ) {
+      if( ! kpg1Config_Cache ) {
+         kpg1Config_Cache = astKeyMap( " " );
+         astExempt( kpg1Config_Cache );
+      }
+      entry = astKeyMap( " " );
+      astMapPut0D( entry, "MTIME", mtime, NULL );
+      astMapPut0D( entry, "SIZE", fsize, NULL );
+      obj = astCopy( result );
+      astMapPut0A( entry, "VALUES", obj, NULL );
+      obj = astAnnul( obj );
+      astMapPut0A( kpg1Config_Cache, def, entry, NULL );
+      entry = astAnnul( entry );
+   }
 
+   return result;
+}
+
+/*
+ * This function returns non-zero if the values read from the supplied
+ * defaults file can be cached, in which case the modification time and
+ * size of the file are returned. A leading environment variable in the
+ * file path (e.g. "$SMURF_DIR/...") is expanded. Zero is returned if the
+ * file cannot be found, or if it includes any other files, since a
+ * change to an included file would not be noticed.
+ */
+
+static int kpg1Config_DefInfo( const char *def, double *mtime, double *fsize ){
+   FILE *fd;
+   char line[ GRP__SZNAM + 1 ];
+   char name[ GRP__SZNAM + 1 ];
+   char path[ 2*GRP__SZNAM + 1 ];
+   const char *env;
+   const char *p;
+   size_t nc;
+   struct stat buf;
+
+/* The path is used as a KeyMap key, so check it is not too long. */
+   if( strlen( def ) > AST__MXKEYLEN ) return 0;
+
+/* Expand any leading environment variable. */
+   if( def[ 0 ] == '$' ) {
+      p = strchr( def, '/' );
+      nc = p ? (size_t)( p - def - 1 ) : strlen( def + 1 );
+      if( nc == 0 || nc > GRP__SZNAM ) return 0;
+      memcpy( name, def + 1, nc );
+      name[ nc ] = 0;
+      env = getenv( name );
+      if( ! env || strlen( env ) + strlen( def + nc + 1 ) > 2*GRP__SZNAM ) {
+         return 0;
+      }
+      sprintf( path, "%s%s", env, def + nc + 1 );
+   } else if( strlen( def ) <= 2*GRP__SZNAM ) {
+      strcpy( path, def );
+   } else {
+      return 0;
+   }
+
+/* Get the modification time and size of the file. */
+   if( stat( path, &buf ) != 0 ) return 0;
+   *mtime = (double) buf.st_mtime;
+   *fsize = (double) buf.st_size;
+
+/* Check that the file does not include any other files. */
+   fd = fopen( path, "r" );
+   if( ! fd ) return 0;
+   while( fgets( line, sizeof( line ), fd ) ) {
+      p = line;
+      while( isspace( (unsigned char) *p ) ) p++;
+      if( *p == '^' ) {
+         fclose( fd );
+         return 0;
+      }
+   }
+   fclose( fd );
+
+   return 1;
+}
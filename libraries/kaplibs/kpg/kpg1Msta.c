@@ -0,0 +1,509 @@
+#include "mers.h"
+#include "sae_par.h"
+#include "prm_par.h"
+#include "star/thr.h"
+#include "kaplibs.h"
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Codes for the supported data types. */
+#define KPG1_MSTA_B 1
+#define KPG1_MSTA_UB 2
+#define KPG1_MSTA_W 3
+#define KPG1_MSTA_UW 4
+#define KPG1_MSTA_I 5
+#define KPG1_MSTA_K 6
+#define KPG1_MSTA_R 7
+#define KPG1_MSTA_D 8
+
+/* The statistics of a set of values. These can be formed independently
+   for separate parts of the array and then merged. */
+typedef struct {
+   size_t n;             /* Number of values */
+   size_t imin;          /* Zero-based index of the (first) minimum */
+   size_t imax;          /* Zero-based index of the (first) maximum */
+   double dmin;          /* Minimum value */
+   double dmax;          /* Maximum value */
+   double sum;           /* Sum of the values */
+   double mom[ 4 ];      /* Mean, and sums of powers 2-4 of deviations */
+} Kpg1MstaAcc;
+
+/* Describes a single pass through the array. */
+typedef struct {
+   const void *data;     /* The array */
+   int type;             /* Data type code */
+   int bad;              /* Check for bad values? */
+   int clip;             /* Use only values within the limits? */
+   double llim;          /* Lower limit */
+   double ulim;          /* Upper limit */
+} Kpg1MstaPass;
+
+/* Prototypes for private functions defined in this file. */
+static void kpg1MstaAdd( Kpg1MstaAcc *acc, double value, size_t i );
+static void kpg1MstaChunk( void *data, size_t first, size_t last,
+                           void *result, int *status );
+static void kpg1MstaInit( Kpg1MstaAcc *acc );
+static void kpg1MstaMerge( void *data, void *result, const void *part,
+                           int *status );
+static void kpg1MstaStore( const Kpg1MstaAcc *acc, int sample, int istat[3],
+                           double dstat[7], double *stdev );
+
+void kpg1Msta( ThrWorkForce *wf, const char *type, int bad, int sample,
+               size_t el, const void *data, int nclip, const float clip[],
+               int istat[3], double dstat[7], int istatc[3], double dstatc[7],
+               int *status ){
+/*
+*+
+*  Name:
+*     kpg1Msta
+
+*  Purpose:
+*     Computes simple statistics for an array, using multiple threads.
+
+*  Language:
+*     C.
+
+*  Invocation:
+*     void kpg1Msta( ThrWorkForce *wf, const char *type, int bad,
+*                    int sample, size_t el, const void *data, int nclip,
+*                    const float clip[], int istat[3], double dstat[7],
+*                    int istatc[3], double dstatc[7], int *status )
+
+*  Description:
+*     This function computes simple statistics for an array, namely: the
+*     number of valid pixels; the minimum and maximum pixel values (and
+*     their positions); the pixel sum; the mean; and the standard
+*     deviation, skewness, and excess kurtosis. Iterative K-sigma
+*     clipping may also be optionally applied.
+*
+*     Each pass through the array is divided between the threads in the
+*     supplied workforce. Each thread forms the moments of its part of
+*     the array in a single pass using the formulae of Terriberry (2007),
+*     and the moments of the separate parts are then merged using the
+*     formulae of Pebay (2008). One pass is needed for the unclipped
+*     statistics and one more for each clipping iteration.
+
+*  Arguments:
+*     wf
+*        The workforce to use. If NULL, the calling thread is used.
+*     type
+*        The HDS data type of the array (e.g. "_REAL").
+*     bad
+*        Should checks for bad pixels be performed?
+*     sample
+*        If non-zero, the sample standard deviation is returned (i.e.
+*        using a divisor of N-1). Otherwise the population standard
+*        deviation is returned. The choice also affects the clipping
+*        limits.
+*     el
+*        Number of pixels in the array.
+*     data
+*        The array to be analysed.
+*     nclip
+*        Number of K-sigma clipping iterations to apply (may be zero).
+*     clip
+*        Array of clipping limits for successive iterations, expressed
+*        as standard deviations.
+*     istat
+*        Returned holding the integer statistics before clipping. These
+*        are the number of valid pixels, and the one-based indices at
+*        which the pixels with the lowest and highest values were
+*        (first) found.
+*     dstat
+*        Returned holding the floating-point statistics before clipping.
+*        These are the minimum, the maximum, the sum, the mean, the
+*        standard deviation, the population skewness and the population
+*        excess kurtosis.
+*     istatc
+*        Returned holding the integer statistics after clipping, in the
+*        same order as "istat".
+*     dstatc
+*        Returned holding the floating-point statistics after clipping,
+*        in the same order as "dstat".
+*     status
+*        The inherited status.
+
+*  Notes:
+*     - These are the same statistics as are returned by KPG_OSTAx.
+*     - If no clipping is performed (i.e. if "nclip" is zero) then the
+*     statistics returned after clipping will be the same as those
+*     before clipping.
+*     - If istat[0] or istatc[0] is zero, then the values of all the
+*     derived statistics will be set to the "bad" value appropriate to
+*     their data type (except for the pixel sum, which will be zero).
+*     The skewness and kurtosis are also bad if all the values are
+*     equal.
+*     - Parts of the array are assigned to threads dynamically, and so
+*     the floating-point statistics may differ in the least significant
+*     bits between runs when more than one thread is used.
+
+*  References:
+*     Terriberry, T.B., 2007, Computing Higher-order Moments Online,
+*     http://people.xiph.org/~tterribe/notes/homs.html.
+*     Pebay, P., 2008, Formulas for Robust, One-Pass Parallel
+*     Computation of Covariances and Arbitrary-Order Statistical
+*     Moments, Sandia Report SAND2008-6212.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful,but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+/* Local Variables: */
+   Kpg1MstaAcc acc;
+   Kpg1MstaPass pass;
+   double mean = 0.0;
+   double stdev = 0.0;
+   int iclip;
+   int nclp;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Identify the data type. */
+   if( !strcmp( type, "_BYTE" ) ) {
+      pass.type = KPG1_MSTA_B;
+   } else if( !strcmp( type, "_UBYTE" ) ) {
+      pass.type = KPG1_MSTA_UB;
+   } else if( !strcmp( type, "_WORD" ) ) {
+      pass.type = KPG1_MSTA_W;
+   } else if( !strcmp( type, "_UWORD" ) ) {
+      pass.type = KPG1_MSTA_UW;
+   } else if( !strcmp( type, "_INTEGER" ) ) {
+      pass.type = KPG1_MSTA_I;
+   } else if( !strcmp( type, "_INT64" ) ) {
+      pass.type = KPG1_MSTA_K;
+   } else if( !strcmp( type, "_REAL" ) ) {
+      pass.type = KPG1_MSTA_R;
+   } else if( !strcmp( type, "_DOUBLE" ) ) {
+      pass.type = KPG1_MSTA_D;
+   } else {
+      *status = SAI__ERROR;
+      errRepf( "", "kpg1Msta: Unsupported data type '%s' (programming "
+               "error).", status, type );
+      return;
+   }
+
+   pass.data = data;
+   pass.bad = bad;
+
+/* Loop through each clipping iteration, plus an initial iteration
+   where no clipping is applied. */
+   nclp = ( nclip > 0 ) ? nclip : 0;
+   for( iclip = 0; iclip <= nclp; iclip++ ) {
+
+/* Set the clipping limits. */
+      pass.clip = ( iclip > 0 );
+      if( pass.clip ) {
+         pass.llim = mean - stdev*clip[ iclip - 1 ];
+         pass.ulim = mean + stdev*clip[ iclip - 1 ];
+      }
+
+/* Form the statistics of the selected values, dividing the array up
+   between the threads. */
+      kpg1MstaInit( &acc );
+      if( el > 0 ) {
+         thrParallelReduce( wf, 0, el - 1, 0, &pass, kpg1MstaChunk,
+                            sizeof( acc ), &acc, kpg1MstaMerge, status );
+      }
+      if( *status != SAI__OK ) return;
+
+/* Store them in the returned arrays. */
+      if( iclip == 0 ) kpg1MstaStore( &acc, sample, istat, dstat, &stdev );
+      kpg1MstaStore( &acc, sample, istatc, dstatc, &stdev );
+      mean = acc.mom[ 0 ];
+
+/* Quit performing clipping iterations if there are no valid pixels
+   left. */
+      if( acc.n == 0 ) break;
+   }
+}
+
+static void kpg1MstaAdd( Kpg1MstaAcc *acc, double value, size_t i ){
+/*
+*  Name:
+*     kpg1MstaAdd
+
+*  Purpose:
+*     Adds a value into a set of statistics.
+
+*  Description:
+*     The moments are updated incrementally using the deviations about
+*     the current mean. These are the formulae of Terriberry.
+*/
+
+/* Local Variables: */
+   double dev;
+   double devn;
+   double devsq;
+   double devsqn;
+   double n;
+
+   acc->n++;
+   acc->sum += value;
+
+   n = (double) acc->n;
+   dev = value - acc->mom[ 0 ];
+   devn = dev/n;
+   devsq = devn*devn;
+   devsqn = dev*devn*( n - 1.0 );
+   acc->mom[ 0 ] += devn;
+   acc->mom[ 3 ] += devsqn*devsq*( n*n - 3.0*n + 3.0 ) +
+                    6.0*devsq*acc->mom[ 1 ] - 4.0*devn*acc->mom[ 2 ];
+   acc->mom[ 2 ] += devsqn*devn*( n - 2.0 ) - 3.0*devn*acc->mom[ 1 ];
+   acc->mom[ 1 ] += devsqn;
+
+/* Note the minimum and maximum pixel values and where they occur. */
+   if( value < acc->dmin ) {
+      acc->dmin = value;
+      acc->imin = i;
+   }
+   if( value > acc->dmax ) {
+      acc->dmax = value;
+      acc->imax = i;
+   }
+}
+
+static void kpg1MstaChunk( void *data, size_t first, size_t last,
+                           void *result, int *status ){
+/*
+*  Name:
+*     kpg1MstaChunk
+
+*  Purpose:
+*     Adds the selected values in a range of the array into a set of
+*     statistics.
+
+*  Description:
+*     This is called by thrParallelReduce. The statistics of the range
+*     are formed in a local structure and then merged into the supplied
+*     partial result.
+*/
+
+/* Local Variables: */
+   Kpg1MstaAcc acc;
+   Kpg1MstaPass *pass = (Kpg1MstaPass *) data;
+   double value;
+   size_t i;
+
+   if( *status != SAI__OK ) return;
+
+   kpg1MstaInit( &acc );
+
+/* Loop over the range, converting each value that is not bad to double
+   precision, and including it if it is within the clipping limits. */
+#define KPG1_MSTA_LOOP(CType,BadVal) { \
+   const CType *p = (const CType *) pass->data; \
+   for( i = first; i <= last; i++ ) { \
+      if( !pass->bad || p[ i ] != BadVal ) { \
+         value = (double) p[ i ]; \
+         if( !pass->clip || ( value >= pass->llim && \
+                              value <= pass->ulim ) ) { \
+            kpg1MstaAdd( &acc, value, i ); \
+         } \
+      } \
+   } \
+}
+
+   switch( pass->type ) {
+   case KPG1_MSTA_B:
+      KPG1_MSTA_LOOP( signed char, VAL__BADB )
+      break;
+   case KPG1_MSTA_UB:
+      KPG1_MSTA_LOOP( unsigned char, VAL__BADUB )
+      break;
+   case KPG1_MSTA_W:
+      KPG1_MSTA_LOOP( short int, VAL__BADW )
+      break;
+   case KPG1_MSTA_UW:
+      KPG1_MSTA_LOOP( unsigned short int, VAL__BADUW )
+      break;
+   case KPG1_MSTA_I:
+      KPG1_MSTA_LOOP( int, VAL__BADI )
+      break;
+   case KPG1_MSTA_K:
+      KPG1_MSTA_LOOP( int64_t, VAL__BADK )
+      break;
+   case KPG1_MSTA_R:
+      KPG1_MSTA_LOOP( float, VAL__BADR )
+      break;
+   default:
+      KPG1_MSTA_LOOP( double, VAL__BADD )
+   }
+
+#undef KPG1_MSTA_LOOP
+
+   kpg1MstaMerge( NULL, result, &acc, status );
+}
+
+static void kpg1MstaInit( Kpg1MstaAcc *acc ){
+/*
+*  Name:
+*     kpg1MstaInit
+
+*  Purpose:
+*     Initialises an empty set of statistics.
+*/
+
+   memset( acc, 0, sizeof( *acc ) );
+   acc->dmin = DBL_MAX;
+   acc->dmax = -DBL_MAX;
+}
+
+static void kpg1MstaMerge( void *data, void *result, const void *part,
+                           int *status ){
+/*
+*  Name:
+*     kpg1MstaMerge
+
+*  Purpose:
+*     Merges one set of statistics into another.
+
+*  Description:
+*     The moments of the combined set are formed from those of the two
+*     separate sets using the pairwise update formulae of Pebay. The
+*     first of any equal extreme values is retained, so that the indices
+*     of the minimum and maximum are independent of how the array was
+*     divided up.
+*/
+
+/* Local Variables: */
+   Kpg1MstaAcc *a = (Kpg1MstaAcc *) result;
+   const Kpg1MstaAcc *b = (const Kpg1MstaAcc *) part;
+   double delta;
+   double delta2;
+   double na;
+   double nb;
+   double n;
+
+   if( *status != SAI__OK || b->n == 0 ) return;
+
+   if( a->n == 0 ) {
+      *a = *b;
+      return;
+   }
+
+   na = (double) a->n;
+   nb = (double) b->n;
+   n = na + nb;
+   delta = b->mom[ 0 ] - a->mom[ 0 ];
+   delta2 = delta*delta;
+
+   a->mom[ 3 ] += b->mom[ 3 ] +
+                  delta2*delta2*na*nb*( na*na - na*nb + nb*nb )/( n*n*n ) +
+                  6.0*delta2*( na*na*b->mom[ 1 ] + nb*nb*a->mom[ 1 ] )/( n*n ) +
+                  4.0*delta*( na*b->mom[ 2 ] - nb*a->mom[ 2 ] )/n;
+   a->mom[ 2 ] += b->mom[ 2 ] +
+                  delta2*delta*na*nb*( na - nb )/( n*n ) +
+                  3.0*delta*( na*b->mom[ 1 ] - nb*a->mom[ 1 ] )/n;
+   a->mom[ 1 ] += b->mom[ 1 ] + delta2*na*nb/n;
+   a->mom[ 0 ] += delta*nb/n;
+
+   a->n += b->n;
+   a->sum += b->sum;
+
+   if( b->dmin < a->dmin || ( b->dmin == a->dmin && b->imin < a->imin ) ) {
+      a->dmin = b->dmin;
+      a->imin = b->imin;
+   }
+   if( b->dmax > a->dmax || ( b->dmax == a->dmax && b->imax < a->imax ) ) {
+      a->dmax = b->dmax;
+      a->imax = b->imax;
+   }
+}
+
+static void kpg1MstaStore( const Kpg1MstaAcc *acc, int sample, int istat[3],
+                           double dstat[7], double *stdev ){
+/*
+*  Name:
+*     kpg1MstaStore
+
+*  Purpose:
+*     Stores a set of statistics in the returned arrays.
+
+*  Description:
+*     The standard deviation is also returned in "*stdev", for use in
+*     setting the clipping limits.
+*/
+
+/* Local Variables: */
+   double n;
+   double varnce;
+
+/* If there were no valid pixels, then use null result values. */
+   if( acc->n == 0 ) {
+      istat[ 0 ] = 0;
+      istat[ 1 ] = VAL__BADI;
+      istat[ 2 ] = VAL__BADI;
+      dstat[ 0 ] = VAL__BADD;
+      dstat[ 1 ] = VAL__BADD;
+      dstat[ 2 ] = 0.0;
+      dstat[ 3 ] = VAL__BADD;
+      dstat[ 4 ] = VAL__BADD;
+      dstat[ 5 ] = VAL__BADD;
+      dstat[ 6 ] = VAL__BADD;
+      *stdev = VAL__BADD;
+      return;
+   }
+
+   n = (double) acc->n;
+   istat[ 0 ] = (int) acc->n;
+   istat[ 1 ] = (int) acc->imin + 1;
+   istat[ 2 ] = (int) acc->imax + 1;
+   dstat[ 0 ] = acc->dmin;
+   dstat[ 1 ] = acc->dmax;
+   dstat[ 2 ] = acc->sum;
+   dstat[ 3 ] = acc->mom[ 0 ];
+
+/* Before calculating the standard deviation, check for (a) only one
+   contributing pixel, (b) all pixels having the same value and (c)
+   rounding errors producing a negative variance value. In all these
+   cases, calculate a standard deviation value of zero. */
+   varnce = acc->mom[ 1 ]/( sample ? n - 1.0 : n );
+   if( acc->n == 1 || acc->dmin == acc->dmax || varnce < 0.0 ) {
+      *stdev = 0.0;
+   } else {
+      *stdev = sqrt( varnce );
+   }
+   dstat[ 4 ] = *stdev;
+
+/* Evaluate the skewness and kurtosis from the moments. Note the kurtosis
+   is not the pure kurtosis, but the excess kurtosis. This evaluates to
+   zero for a Gaussian. Protect against a zero second moment with some
+   tolerance for rounding. */
+   if( fabs( acc->mom[ 1 ] ) > 10.0*VAL__EPSD ) {
+      dstat[ 5 ] = sqrt( n/acc->mom[ 1 ] )*acc->mom[ 2 ]/acc->mom[ 1 ];
+      dstat[ 6 ] = n*acc->mom[ 3 ]/( acc->mom[ 1 ]*acc->mom[ 1 ] ) - 3.0;
+   } else {
+      dstat[ 5 ] = VAL__BADD;
+      dstat[ 6 ] = VAL__BADD;
+   }
+}
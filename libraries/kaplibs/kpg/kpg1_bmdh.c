@@ -0,0 +1,519 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "f77.h"
+#include "sae_par.h"
+#include "prm_par.h"
+
+/* The largest range of integer data values that can be histogrammed. */
+#define KPG1_BMDH_MXRANGE 65536
+
+/* The maximum number of bytes to use for the column histograms of each
+   stripe of the image. Wider images are processed in several stripes. */
+#define KPG1_BMDH_MXMEM 67108864
+
+/* A structure holding the histograms used to filter one stripe. */
+typedef struct {
+   const float *inr;    /* Single precision input array */
+   const double *ind;   /* Double precision input array */
+   int *colc;           /* Coarse histogram for each column */
+   int *colf;           /* Fine histogram for each column */
+   int *coln;           /* Number of good values in each column */
+   int *kerc;           /* Coarse histogram for the box */
+   int *kerf;           /* Fine histogram for the box */
+   int *stamp;          /* Column at which each box fine segment is valid */
+   int bad;             /* Check for bad input values? */
+   int c0;              /* First column in the column histograms */
+   int c1;              /* Last column in the column histograms */
+   int hx;              /* Half-width of the box along the rows */
+   int nc;              /* Number of coarse bins */
+   int nx;              /* Number of columns in the image */
+   int shift;           /* Bit shift from fine to coarse bins */
+   int vmin;            /* Data value corresponding to bin zero */
+} Kpg1BmdhData;
+
+/* Prototypes for private functions defined in this file. */
+static int kpg1Bmdh( int bad, int sambad, int ndim, const int *dims,
+                     const float *inr, const double *ind, const int *hb,
+                     int nlim, float *outr, double *outd, int *badout );
+static int kpg1BmdhBin( Kpg1BmdhData *data, size_t i, int *bin );
+static int kpg1BmdhRank( Kpg1BmdhData *data, int x, int k );
+static void kpg1BmdhFine( Kpg1BmdhData *data, int x, int b );
+static void kpg1BmdhSeg( Kpg1BmdhData *data, int c, int b, int sign );
+
+F77_SUBROUTINE(kpg1_bmdhr)( LOGICAL(BAD), LOGICAL(SAMBAD), INTEGER(NDIM),
+                            INTEGER_ARRAY(DIMS), REAL_ARRAY(IN),
+                            INTEGER_ARRAY(HB), INTEGER(NLIM),
+                            REAL_ARRAY(OUT), LOGICAL(BADOUT),
+                            LOGICAL(DONE), INTEGER(STATUS) ) {
+/*
+*+
+*  Name:
+*     KPG1_BMDHx
+
+*  Purpose:
+*     Smooths an array of integer values using a histogram-based block
+*     median filter.
+
+*  Language:
+*     C, designed to be called from Fortran.
+
+*  Invocation:
+*     CALL KPG1_BMDHx( BAD, SAMBAD, NDIM, DIMS, IN, HB, NLIM, OUT,
+*                      BADOUT, DONE, STATUS )
+
+*  Description:
+*     This routine finds the same block median filter as KPG_BMDNx, but
+*     uses the algorithm of Perreault & Hebert (2007, IEEE Trans. Image
+*     Processing, 16, 2389), in which the cost per output pixel does not
+*     depend on the size of the box. It can only be used if all the good
+*     input values are integers spanning a range no larger than 65536
+*     (as is the case, for instance, for data originally stored as
+*     _UBYTE, _WORD or _UWORD), and if the box extends along no more
+*     than the first two axes. If these conditions are not met, or the
+*     box is too wide for the histograms to fit in memory, DONE is
+*     returned .FALSE. and the output array is left unchanged.
+*
+*     A histogram of the values in the box is maintained for each column
+*     of the image. Moving down by a row updates each column histogram
+*     by removing one value and adding one value, and moving along a
+*     row updates the box histogram by adding and removing one column
+*     histogram. The histograms have two levels (coarse and fine), and
+*     the fine levels of the box histogram are only updated when they
+*     are needed to locate a median.
+
+*  Arguments:
+*     BAD = LOGICAL (Given)
+*        Whether or not it is necessary to check for bad pixels in the
+*        input array.
+*     SAMBAD = LOGICAL (Given)
+*        If .TRUE., bad input pixels are propagated to the output array
+*        unchanged.  If .FALSE., the NLIM argument determines whether an
+*        output pixel is good or bad.
+*     NDIM = INTEGER (Given)
+*        The number of dimensions of the array to be smoothed.
+*     DIMS( NDIM ) = INTEGER (Given)
+*        The dimensions of the input and output arrays.
+*     IN( * ) = ? (Given)
+*        The input array.
+*     HB( NDIM ) = INTEGER (Given)
+*        The half-width of the filter block along each dimension, in
+*        pixels.
+*     NLIM = INTEGER (Given)
+*        Minimum number of good pixels which must be present in the
+*        smoothing box in order to calculate a smoothed output pixel.
+*     OUT( * ) = ? (Returned)
+*        The output array.
+*     BADOUT = LOGICAL (Returned)
+*        Whether bad pixels are present in the output array.
+*     DONE = LOGICAL (Returned)
+*        Returned .TRUE. if the filtered array was found, and .FALSE. if
+*        this routine cannot be used for the supplied array.
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Notes:
+*     -  There is a routine for processing single- and double-precision
+*     arrays; replace "x" in the routine name by R or D as appropriate.
+*     The data type of the IN and OUT arguments must match the routine
+*     used.
+*     -  The median of an even number of values is the mean of the two
+*     central values, as returned by KPG1_QNTLx.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful,but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+   GENPTR_LOGICAL(BAD)
+   GENPTR_LOGICAL(SAMBAD)
+   GENPTR_INTEGER(NDIM)
+   GENPTR_INTEGER_ARRAY(DIMS)
+   GENPTR_REAL_ARRAY(IN)
+   GENPTR_INTEGER_ARRAY(HB)
+   GENPTR_INTEGER(NLIM)
+   GENPTR_REAL_ARRAY(OUT)
+   GENPTR_LOGICAL(BADOUT)
+   GENPTR_LOGICAL(DONE)
+   GENPTR_INTEGER(STATUS)
+
+   int badout = 0;
+   int done = 0;
+
+   if( *STATUS == SAI__OK ) {
+      done = kpg1Bmdh( F77_ISTRUE( *BAD ), F77_ISTRUE( *SAMBAD ), *NDIM,
+                       DIMS, IN, NULL, HB, *NLIM, OUT, NULL, &badout );
+   }
+   *BADOUT = badout ? F77_TRUE : F77_FALSE;
+   *DONE = done ? F77_TRUE : F77_FALSE;
+}
+
+F77_SUBROUTINE(kpg1_bmdhd)( LOGICAL(BAD), LOGICAL(SAMBAD), INTEGER(NDIM),
+                            INTEGER_ARRAY(DIMS), DOUBLE_ARRAY(IN),
+                            INTEGER_ARRAY(HB), INTEGER(NLIM),
+                            DOUBLE_ARRAY(OUT), LOGICAL(BADOUT),
+                            LOGICAL(DONE), INTEGER(STATUS) ) {
+/* See KPG1_BMDHR. */
+   GENPTR_LOGICAL(BAD)
+   GENPTR_LOGICAL(SAMBAD)
+   GENPTR_INTEGER(NDIM)
+   GENPTR_INTEGER_ARRAY(DIMS)
+   GENPTR_DOUBLE_ARRAY(IN)
+   GENPTR_INTEGER_ARRAY(HB)
+   GENPTR_INTEGER(NLIM)
+   GENPTR_DOUBLE_ARRAY(OUT)
+   GENPTR_LOGICAL(BADOUT)
+   GENPTR_LOGICAL(DONE)
+   GENPTR_INTEGER(STATUS)
+
+   int badout = 0;
+   int done = 0;
+
+   if( *STATUS == SAI__OK ) {
+      done = kpg1Bmdh( F77_ISTRUE( *BAD ), F77_ISTRUE( *SAMBAD ), *NDIM,
+                       DIMS, NULL, IN, HB, *NLIM, NULL, OUT, &badout );
+   }
+   *BADOUT = badout ? F77_TRUE : F77_FALSE;
+   *DONE = done ? F77_TRUE : F77_FALSE;
+}
+
+/* Filter the array, returning zero if it cannot be done. Exactly one of
+   "inr" and "ind" should be non-NULL, and likewise for "outr" and "outd". */
+static int kpg1Bmdh( int bad, int sambad, int ndim, const int *dims,
+                     const float *inr, const double *ind, const int *hb,
+                     int nlim, float *outr, double *outd, int *badout ){
+   Kpg1BmdhData data;
+   double v2;
+   double v;
+   double vmax;
+   double vmin;
+   int *colbuf;
+   int b;
+   int c;
+   int hx;
+   int hy;
+   int idim;
+   int k;
+   int nbin;
+   int ncmax;
+   int ngood;
+   int nx;
+   int ny;
+   int range;
+   int w;
+   int x0;
+   int x1;
+   int x;
+   int y;
+   size_t base;
+   size_t el;
+   size_t i;
+   size_t iplane;
+   size_t nplane;
+   size_t ntot;
+   size_t p;
+
+/* The box must not extend beyond the first two axes. */
+   nx = ( ndim > 0 ) ? dims[ 0 ] : 1;
+   ny = ( ndim > 1 ) ? dims[ 1 ] : 1;
+   hx = ( ndim > 0 ) ? hb[ 0 ] : 0;
+   hy = ( ndim > 1 ) ? hb[ 1 ] : 0;
+   nplane = 1;
+   for( idim = 2; idim < ndim; idim++ ) {
+      if( hb[ idim ] != 0 ) return 0;
+      nplane *= dims[ idim ];
+   }
+   if( nx < 1 || ny < 1 || hx < 0 || hy < 0 ) return 0;
+   hx = ( hx < nx ) ? hx : nx - 1;
+   hy = ( hy < ny ) ? hy : ny - 1;
+   el = (size_t) nx * (size_t) ny * nplane;
+
+/* Check that all the good values are integers, and find their range. */
+   vmin = 0.0;
+   vmax = 0.0;
+   ngood = 0;
+   for( p = 0; p < el; p++ ) {
+      if( inr ) {
+         if( bad && inr[ p ] == VAL__BADR ) continue;
+         v = inr[ p ];
+      } else {
+         if( bad && ind[ p ] == VAL__BADD ) continue;
+         v = ind[ p ];
+      }
+      if( v != floor( v ) ) return 0;
+      if( !ngood || v < vmin ) vmin = v;
+      if( !ngood || v > vmax ) vmax = v;
+      if( vmax - vmin >= KPG1_BMDH_MXRANGE ) return 0;
+      ngood = 1;
+   }
+   if( !ngood ) return 0;
+   range = (int)( vmax - vmin ) + 1;
+
+/* Choose the coarse bin size so that there are about as many coarse
+   bins as fine bins within each coarse bin. */
+   data.shift = 0;
+   while( ( 1 << ( 2*data.shift ) ) < range ) data.shift++;
+   data.nc = ( ( range - 1 ) >> data.shift ) + 1;
+   nbin = data.nc << data.shift;
+
+/* Find the widest stripe whose column histograms fit in the memory
+   limit. The stripe must include the box half-width on each side. */
+   ncmax = KPG1_BMDH_MXMEM/( ( nbin + data.nc + 1 )*(int) sizeof( int ) );
+   w = ncmax - 2*hx;
+   if( w < 1 ) return 0;
+   if( w > nx ) w = nx;
+   ncmax = ( w + 2*hx < nx ) ? w + 2*hx : nx;
+
+/* Allocate the histograms. */
+   ntot = (size_t) ncmax*( nbin + data.nc + 1 ) + nbin + 2*data.nc;
+   colbuf = malloc( ntot*sizeof( int ) );
+   if( !colbuf ) return 0;
+   data.colf = colbuf;
+   data.colc = data.colf + (size_t) ncmax*nbin;
+   data.coln = data.colc + (size_t) ncmax*data.nc;
+   data.kerf = data.coln + ncmax;
+   data.kerc = data.kerf + nbin;
+   data.stamp = data.kerc + data.nc;
+
+   data.bad = bad;
+   data.inr = inr;
+   data.ind = ind;
+   data.hx = hx;
+   data.nx = nx;
+   data.vmin = (int) vmin;
+
+/* Process each plane, and each stripe within each plane. */
+   for( iplane = 0; iplane < nplane; iplane++ ) {
+      base = iplane*(size_t) nx*(size_t) ny;
+      for( x0 = 0; x0 < nx; x0 += w ) {
+         x1 = ( x0 + w < nx ) ? x0 + w - 1 : nx - 1;
+         data.c0 = ( x0 - hx > 0 ) ? x0 - hx : 0;
+         data.c1 = ( x1 + hx < nx - 1 ) ? x1 + hx : nx - 1;
+
+/* Initialise the column histograms to hold the first rows of the box
+   centred on the first row. */
+         memset( colbuf, 0, (size_t) ncmax*( nbin + data.nc + 1 )*
+                            sizeof( int ) );
+         for( y = 0; y <= hy; y++ ) {
+            for( c = data.c0; c <= data.c1; c++ ) {
+               i = base + (size_t) y*nx + c;
+               if( kpg1BmdhBin( &data, i, &b ) ) {
+                  k = c - data.c0;
+                  data.colf[ (size_t) k*nbin + b ]++;
+                  data.colc[ (size_t) k*data.nc + ( b >> data.shift ) ]++;
+                  data.coln[ k ]++;
+               }
+            }
+         }
+
+         for( y = 0; y < ny; y++ ) {
+
+/* Move the column histograms down to the current row. */
+            if( y > 0 ) {
+               for( c = data.c0; c <= data.c1; c++ ) {
+                  k = c - data.c0;
+                  if( y - hy - 1 >= 0 ) {
+                     i = base + (size_t)( y - hy - 1 )*nx + c;
+                     if( kpg1BmdhBin( &data, i, &b ) ) {
+                        data.colf[ (size_t) k*nbin + b ]--;
+                        data.colc[ (size_t) k*data.nc +
+                                   ( b >> data.shift ) ]--;
+                        data.coln[ k ]--;
+                     }
+                  }
+                  if( y + hy < ny ) {
+                     i = base + (size_t)( y + hy )*nx + c;
+                     if( kpg1BmdhBin( &data, i, &b ) ) {
+                        data.colf[ (size_t) k*nbin + b ]++;
+                        data.colc[ (size_t) k*data.nc +
+                                   ( b >> data.shift ) ]++;
+                        data.coln[ k ]++;
+                     }
+                  }
+               }
+            }
+
+/* Form the coarse box histogram for the first column of the stripe.
+   None of the fine segments are yet valid. */
+            memset( data.kerc, 0, data.nc*sizeof( int ) );
+            ngood = 0;
+            for( c = x0 - hx; c <= x0 + hx; c++ ) {
+               if( c < 0 || c >= nx ) continue;
+               k = c - data.c0;
+               for( b = 0; b < data.nc; b++ ) {
+                  data.kerc[ b ] += data.colc[ (size_t) k*data.nc + b ];
+               }
+               ngood += data.coln[ k ];
+            }
+            for( b = 0; b < data.nc; b++ ) data.stamp[ b ] = -1;
+
+            for( x = x0; x <= x1; x++ ) {
+
+/* Move the coarse box histogram along to the current column. */
+               if( x > x0 ) {
+                  c = x + hx;
+                  if( c < nx ) {
+                     k = c - data.c0;
+                     for( b = 0; b < data.nc; b++ ) {
+                        data.kerc[ b ] += data.colc[ (size_t) k*data.nc + b ];
+                     }
+                     ngood += data.coln[ k ];
+                  }
+                  c = x - hx - 1;
+                  if( c >= 0 ) {
+                     k = c - data.c0;
+                     for( b = 0; b < data.nc; b++ ) {
+                        data.kerc[ b ] -= data.colc[ (size_t) k*data.nc + b ];
+                     }
+                     ngood -= data.coln[ k ];
+                  }
+               }
+
+/* Store the output value, applying the same rules as KPG_BMDNx. */
+               p = base + (size_t) y*nx + x;
+               if( ngood == 0 ||
+                   ( bad && sambad && !kpg1BmdhBin( &data, p, &b ) ) ||
+                   ( bad && !sambad && ngood < nlim ) ) {
+                  if( outr ) {
+                     outr[ p ] = VAL__BADR;
+                  } else {
+                     outd[ p ] = VAL__BADD;
+                  }
+                  *badout = 1;
+
+/* The median of an odd number of values is the central value, and of
+   an even number is the mean of the two central values. */
+               } else if( ngood % 2 ) {
+                  v = data.vmin + kpg1BmdhRank( &data, x, ( ngood + 1 )/2 );
+                  if( outr ) {
+                     outr[ p ] = (float) v;
+                  } else {
+                     outd[ p ] = v;
+                  }
+               } else {
+                  v = data.vmin + kpg1BmdhRank( &data, x, ngood/2 );
+                  v2 = data.vmin + kpg1BmdhRank( &data, x, ngood/2 + 1 );
+                  if( outr ) {
+                     outr[ p ] = 0.5f*(float) v + 0.5f*(float) v2;
+                  } else {
+                     outd[ p ] = 0.5*v + 0.5*v2;
+                  }
+               }
+            }
+         }
+      }
+   }
+
+   free( colbuf );
+   return 1;
+}
+
+/* Return non-zero if element "i" of the input array is good, and if so
+   return its histogram bin. */
+static int kpg1BmdhBin( Kpg1BmdhData *data, size_t i, int *bin ){
+   if( data->inr ) {
+      if( data->bad && data->inr[ i ] == VAL__BADR ) return 0;
+      *bin = (int) data->inr[ i ] - data->vmin;
+   } else {
+      if( data->bad && data->ind[ i ] == VAL__BADD ) return 0;
+      *bin = (int) data->ind[ i ] - data->vmin;
+   }
+   return 1;
+}
+
+/* Return the bin holding the "k"th smallest value (counting from 1) in
+   the box centred on column "x". */
+static int kpg1BmdhRank( Kpg1BmdhData *data, int x, int k ){
+   int *f;
+   int b;
+   int j;
+   int n;
+
+/* Find the coarse bin holding the required value. */
+   n = 0;
+   for( b = 0; b < data->nc - 1; b++ ) {
+      if( n + data->kerc[ b ] >= k ) break;
+      n += data->kerc[ b ];
+   }
+
+/* Bring the fine segment for this coarse bin up to date, and find the
+   fine bin holding the required value. */
+   kpg1BmdhFine( data, x, b );
+   f = data->kerf + ( b << data->shift );
+   for( j = 0; j < ( 1 << data->shift ) - 1; j++ ) {
+      n += f[ j ];
+      if( n >= k ) break;
+   }
+   return ( b << data->shift ) + j;
+}
+
+/* Update fine segment "b" of the box histogram so that it describes the
+   box centred on column "x". If the segment was last valid for a nearby
+   column it is moved along, otherwise it is formed from scratch. */
+static void kpg1BmdhFine( Kpg1BmdhData *data, int x, int b ){
+   int c;
+   int xs;
+
+   xs = data->stamp[ b ];
+   if( xs == x ) return;
+
+   if( xs >= 0 && xs < x && x - xs <= 2*data->hx + 1 ) {
+      for( xs++; xs <= x; xs++ ) {
+         c = xs + data->hx;
+         if( c < data->nx ) kpg1BmdhSeg( data, c, b, 1 );
+         c = xs - data->hx - 1;
+         if( c >= 0 ) kpg1BmdhSeg( data, c, b, -1 );
+      }
+   } else {
+      memset( data->kerf + ( b << data->shift ), 0,
+              ( (size_t) 1 << data->shift )*sizeof( int ) );
+      for( c = x - data->hx; c <= x + data->hx; c++ ) {
+         if( c >= 0 && c < data->nx ) kpg1BmdhSeg( data, c, b, 1 );
+      }
+   }
+   data->stamp[ b ] = x;
+}
+
+/* Add ("sign" = 1) or subtract ("sign" = -1) fine segment "b" of the
+   histogram for column "c" to or from the box histogram. */
+static void kpg1BmdhSeg( Kpg1BmdhData *data, int c, int b, int sign ){
+   const int *src;
+   int *dst;
+   int j;
+   int nf;
+
+   nf = 1 << data->shift;
+   src = data->colf + (size_t)( c - data->c0 )*( data->nc << data->shift ) +
+         ( b << data->shift );
+   dst = data->kerf + ( b << data->shift );
+   if( sign > 0 ) {
+      for( j = 0; j < nf; j++ ) dst[ j ] += src[ j ];
+   } else {
+      for( j = 0; j < nf; j++ ) dst[ j ] -= src[ j ];
+   }
+}
@@ -28,7 +28,8 @@
 *        Hermitian format).
 *     WORK( * ) = DOUBLE PRECISION (Given)
 *        Work space.  This must be at least ( 3*MAX( M, N ) + 15 )
-*        elements long.
+*        elements long.  It is no longer used, and is retained for
+*        compatibility.
 *     OUT( M, N ) = DOUBLE PRECISION (Returned)
 *        The inverse FFT of the input array (a purely real image).
 *        Note, the same array can be specified for both input and
@@ -80,6 +81,8 @@
 *        workspace to achieve greater speed.
 *     2004 September 1 (TIMJ):
 *        Use CNF_PVAL.
+*     14-OCT-2026:
+*        Use FFTW (via KPG1_FFTW) in place of FFTPACK.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -92,7 +95,6 @@
 
 *  Global Constants:
       INCLUDE 'SAE_PAR'          ! Standard SAE constants
-      INCLUDE 'CNF_PAR'          ! For CNF_PVAL function
 
 *  Arguments Given:
       INTEGER M
@@ -106,67 +108,13 @@
 *  Status:
       INTEGER STATUS             ! Global status
 
-*  Local Variables:
-      INTEGER I                  ! Column counter
-      INTEGER IPW                ! Pointer to work space
-      INTEGER IW                 ! Index into work array
-      INTEGER J                  ! Row counter
-
 *.
 
 *  Check the inherited global status.
       IF ( STATUS .NE. SAI__OK ) RETURN
 
-*  Allocate work space for use in KPG1_R2NAG. Abort if failure.
-      CALL PSX_CALLOC( MAX( M, N ), '_DOUBLE', IPW, STATUS )
-      IF ( STATUS .NE. SAI__OK ) RETURN
-
-*  Copy the input array to the output array.
-      DO J = 1, N
-         DO I = 1, M
-            OUT( I, J ) = IN( I, J )
-         END DO
-      END DO
-
-*  Initialise an array holding trig. functions used to form the inverse
-*  FFT of the input image columns.
-      CALL PDA_DRFFTI( N, WORK )
-
-*  Store the index of the last-used element in the work array.
-      IW = 2 * N + 15
-
-*  Transform each column of the current output array.
-      DO I = 1, M
-
-*  Copy this column to the end of the work array, beyond the part used
-*  to store trig. functions.
-         DO  J = 1, N
-            WORK( IW + J ) = OUT( I, J )
-         END DO
-
-*  Convert this column from NAG's Hermitian format to FFTPACK format,
-*  and then transform the copy of this column using an FFTPACK routine.
-         CALL KPG1_DNAG2R( N, WORK( IW + 1 ), %VAL( CNF_PVAL( IPW ) ) )
-         CALL PDA_DRFFTB( N, WORK( IW + 1 ), WORK )
-
-*  Copy the transformed column back to the output array.
-         DO  J = 1, N
-            OUT( I, J ) = WORK( IW + J )
-         END DO
-
-      END DO
-
-*  Initialise an array holding trig. functions used to form the inverse
-*  FFT of the input image rows.
-      CALL PDA_DRFFTI( M, WORK )
-
-*  Transform each row of the output array.
-      DO J = 1, N
-         CALL KPG1_DNAG2R( M, OUT( 1, J ), %VAL( CNF_PVAL( IPW ) ) )
-         CALL PDA_DRFFTB( M, OUT( 1, J ), WORK )
-      END DO
-
-*  Free work space
-      CALL PSX_FREE( IPW, STATUS )
+*  Find the transform using FFTW, which is faster than FFTPACK and can
+*  use multiple threads.
+      CALL KPG1_FFTW( .FALSE., M, N, IN, OUT, STATUS )
 
       END
@@ -0,0 +1,211 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "fftw3.h"
+#include "f77.h"
+#include "sae_par.h"
+#include "mers.h"
+
+/* Arrays with fewer elements than this are transformed in a single
+   thread, since the overheads of starting the threads would outweigh
+   any gain. */
+#define KPG1_FFTW_MINTHR 65536
+
+/* A cached FFTW plan. */
+typedef struct {
+   fftw_plan plan;       /* The plan, or NULL if not yet created */
+   int m;                /* Number of columns */
+   int n;                /* Number of rows */
+   int align;            /* FFTW alignment of the arrays */
+   int nthread;          /* Number of threads used by the plan */
+} Kpg1FftwPlan;
+
+/* The most recently used plans for forward and backward transforms. */
+static Kpg1FftwPlan kpg1Fftw_Plans[ 2 ];
+
+/* Prototypes for private functions defined in this file. */
+static int kpg1Fftw_NThread( size_t nel );
+
+F77_SUBROUTINE(kpg1_fftw)( LOGICAL(FORWRD), INTEGER(M), INTEGER(N),
+                           DOUBLE_ARRAY(IN), DOUBLE_ARRAY(OUT),
+                           INTEGER(STATUS) ) {
+/*
+*+
+*  Name:
+*     KPG1_FFTW
+
+*  Purpose:
+*     Takes the forward or inverse FFT of an image in Hermitian form
+*     using FFTW.
+
+*  Language:
+*     C, designed to be called from Fortran.
+
+*  Invocation:
+*     CALL KPG1_FFTW( FORWRD, M, N, IN, OUT, STATUS )
+
+*  Description:
+*     This routine uses FFTW to find the same transforms as KPG1_FFTFD
+*     and KPG1_FFTBD. The forward transform takes a purely real image
+*     and returns its FT in Hermitian form, and the inverse transform
+*     returns the real image corresponding to a supplied Hermitian FT.
+*     The Hermitian form used by KAPPA (that of the NAG routine C06FAF,
+*     in which the real terms are stored in increasing order followed by
+*     the imaginary terms in decreasing order along each axis) is the
+*     same as the FFTW "halfcomplex" format, and so the two-dimensional
+*     real-to-real FFTW transforms can be used directly. Both directions
+*     are normalised by 1/SQRT( M*N ).
+*
+*     FFTW can transform arrays of any size efficiently. Large arrays
+*     are transformed using multiple threads. The number of threads is
+*     given by the KAPPA_THREADS environment variable, and defaults to
+*     the number of processors. The most recently used plan for each
+*     direction is retained, so that repeated transforms of the same
+*     size (for instance, of each plane of a cube) do not need to be
+*     planned again.
+
+*  Arguments:
+*     FORWRD = LOGICAL (Given)
+*        If .TRUE., the forward transform is found. Otherwise the
+*        inverse transform is found.
+*     M = INTEGER (Given)
+*        Number of columns in the image.
+*     N = INTEGER (Given)
+*        Number of rows in the image.
+*     IN( M, N ) = DOUBLE PRECISION (Given)
+*        The input image or Hermitian FT.
+*     OUT( M, N ) = DOUBLE PRECISION (Returned)
+*        The output Hermitian FT or image. The same array can be used
+*        for both input and output, in which case the supplied values
+*        will be over-written.
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Notes:
+*     - This routine should only be called from the main thread, since
+*     the FFTW planner is not thread-safe.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either Version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+*     02110-1301, USA.
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+   GENPTR_LOGICAL(FORWRD)
+   GENPTR_INTEGER(M)
+   GENPTR_INTEGER(N)
+   GENPTR_DOUBLE_ARRAY(IN)
+   GENPTR_DOUBLE_ARRAY(OUT)
+   GENPTR_INTEGER(STATUS)
+
+   static int init = 0;
+   Kpg1FftwPlan *p;
+   double fac;
+   double *in;
+   double *out;
+   fftw_r2r_kind kind;
+   int align;
+   int cstatus;
+   int nthread;
+   size_t i;
+   size_t nel;
+
+   F77_IMPORT_INTEGER( *STATUS, cstatus );
+   if( cstatus != SAI__OK ) return;
+
+   in = (double *) IN;
+   out = (double *) OUT;
+   nel = (size_t) *M * (size_t) *N;
+   if( nel == 0 ) return;
+
+/* Initialise the FFTW threads library. */
+   if( ! init ) {
+      init = fftw_init_threads() ? 1 : -1;
+   }
+
+/* Decide how many threads to use. */
+   nthread = ( init > 0 ) ? kpg1Fftw_NThread( nel ) : 1;
+
+/* The transform is done in place in the output array, since the
+   out-of-place inverse transform would over-write the input array. */
+   if( out != in ) memcpy( out, in, nel*sizeof( *out ) );
+
+/* See if the plan used previously in this direction can be used again.
+   It can if it has the same size, the same number of threads, and was
+   created for an array with the same alignment. */
+   p = kpg1Fftw_Plans + ( F77_ISTRUE( *FORWRD ) ? 0 : 1 );
+   align = fftw_alignment_of( out );
+
+   if( ! p->plan || p->m != *M || p->n != *N || p->align != align ||
+       p->nthread != nthread ) {
+      if( p->plan ) fftw_destroy_plan( p->plan );
+
+/* FFTW arrays are in row-major order, so the first FFTW dimension is
+   the number of rows. With FFTW_ESTIMATE the arrays are not accessed
+   while planning. */
+      kind = F77_ISTRUE( *FORWRD ) ? FFTW_R2HC : FFTW_HC2R;
+      if( init > 0 ) fftw_plan_with_nthreads( nthread );
+      p->plan = fftw_plan_r2r_2d( *N, *M, out, out, kind, kind,
+                                  FFTW_ESTIMATE );
+      p->m = *M;
+      p->n = *N;
+      p->align = align;
+      p->nthread = nthread;
+
+      if( ! p->plan ) {
+         cstatus = SAI__ERROR;
+         errRep( "KPG1_FFTW_ERR1", "KPG1_FFTW: Unable to create an FFTW "
+                 "plan.", &cstatus );
+         F77_EXPORT_INTEGER( cstatus, *STATUS );
+         return;
+      }
+   }
+
+/* Do the transform, and normalise the result. */
+   fftw_execute_r2r( p->plan, out, out );
+
+   fac = 1.0/sqrt( (double) nel );
+   for( i = 0; i < nel; i++ ) out[ i ] *= fac;
+}
+
+/* Return the number of threads to use for an array with "nel" elements. */
+static int kpg1Fftw_NThread( size_t nel ) {
+   const char *env;
+   int result;
+
+   if( nel < KPG1_FFTW_MINTHR ) return 1;
+
+   env = getenv( "KAPPA_THREADS" );
+   if( env && *env ) {
+      result = atoi( env );
+   } else {
+      result = (int) sysconf( _SC_NPROCESSORS_ONLN );
+   }
+   return ( result > 1 ) ? result : 1;
+}
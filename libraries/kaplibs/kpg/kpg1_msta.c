@@ -0,0 +1,168 @@
+#include "f77.h"
+#include "star/thr.h"
+#include "kaplibs.h"
+#include "sae_par.h"
+
+/* Arrays with fewer elements than this are processed in a single
+   thread, since the overheads of using the workforce would outweigh
+   any gain. */
+#define KPG1_MSTA_MINTHR 100000
+
+/* Prototypes for private functions defined in this file. */
+static void kpg1MstaF( const char *type, F77_LOGICAL_TYPE *BAD,
+                       F77_LOGICAL_TYPE *SAMPLE, F77_INTEGER_TYPE *EL,
+                       const void *DATA, F77_INTEGER_TYPE *NCLIP,
+                       F77_REAL_TYPE *CLIP, F77_INTEGER_TYPE *ISTAT,
+                       F77_DOUBLE_TYPE *DSTAT, F77_INTEGER_TYPE *ISTATC,
+                       F77_DOUBLE_TYPE *DSTATC, F77_INTEGER_TYPE *STATUS );
+
+/*
+*+
+*  Name:
+*     KPG1_MSTAx
+
+*  Purpose:
+*     Computes simple statistics for an array, using multiple threads.
+
+*  Language:
+*     C, designed to be called from Fortran.
+
+*  Invocation:
+*     CALL KPG1_MSTAx( BAD, SAMPLE, EL, DATA, NCLIP, CLIP, ISTAT, DSTAT,
+*                      ISTATC, DSTATC, STATUS )
+
+*  Description:
+*     This routine calls kpg1Msta to compute simple statistics for an
+*     array, namely: the number of valid pixels; the minimum and maximum
+*     pixel values (and their positions); the pixel sum; the mean; and
+*     the standard deviation, skewness, and excess kurtosis. Iterative
+*     K-sigma clipping may also be optionally applied.
+*
+*     Large arrays are divided between the threads of the singleton
+*     workforce. The number of threads is given by the KAPPA_THREADS
+*     environment variable, and defaults to the number of processors.
+
+*  Arguments:
+*     BAD = LOGICAL (Given)
+*        Whether checks for bad pixels should be performed on the array
+*        being analysed.
+*     SAMPLE = LOGICAL (Given)
+*        If .TRUE., the sample standard deviation is returned.
+*        Otherwise the population standard deviation is returned.
+*     EL = INTEGER (Given)
+*        Number of pixels in the array.
+*     DATA( EL ) = ? (Given)
+*        Array to be analysed.
+*     NCLIP = INTEGER (Given)
+*        Number of K-sigma clipping iterations to apply (may be zero).
+*     CLIP( NCLIP ) = REAL (Given)
+*        Array of clipping limits for successive iterations, expressed
+*        as standard deviations.
+*     ISTAT( 3 ) = INTEGER (Returned)
+*        The integer statistics before clipping, as returned by
+*        KPG_OSTAx.
+*     DSTAT( 7 ) = DOUBLE PRECISION (Returned)
+*        The floating-point statistics before clipping, as returned by
+*        KPG_OSTAx.
+*     ISTATC( 3 ) = INTEGER (Returned)
+*        The integer statistics after clipping.
+*     DSTATC( 7 ) = DOUBLE PRECISION (Returned)
+*        The floating-point statistics after clipping.
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Notes:
+*     -  There is a routine for each of the standard numeric types.
+*     Replace "x" in the routine name by B, UB, W, UW, I, K, R or D as
+*     appropriate. The data type of the array being analysed must match
+*     the particular routine used.
+*     -  These routines should only be called from the main thread.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either Version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+*     02110-1301, USA.
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+#define MAKE_KPG1_MSTA(x,Ftype,HDStype) \
+F77_SUBROUTINE(kpg1_msta##x)( LOGICAL(BAD), LOGICAL(SAMPLE), INTEGER(EL), \
+                              Ftype##_ARRAY(DATA), INTEGER(NCLIP), \
+                              REAL_ARRAY(CLIP), INTEGER_ARRAY(ISTAT), \
+                              DOUBLE_ARRAY(DSTAT), INTEGER_ARRAY(ISTATC), \
+                              DOUBLE_ARRAY(DSTATC), INTEGER(STATUS) ) { \
+   GENPTR_LOGICAL(BAD) \
+   GENPTR_LOGICAL(SAMPLE) \
+   GENPTR_INTEGER(EL) \
+   GENPTR_##Ftype##_ARRAY(DATA) \
+   GENPTR_INTEGER(NCLIP) \
+   GENPTR_REAL_ARRAY(CLIP) \
+   GENPTR_INTEGER_ARRAY(ISTAT) \
+   GENPTR_DOUBLE_ARRAY(DSTAT) \
+   GENPTR_INTEGER_ARRAY(ISTATC) \
+   GENPTR_DOUBLE_ARRAY(DSTATC) \
+   GENPTR_INTEGER(STATUS) \
+\
+   kpg1MstaF( HDStype, BAD, SAMPLE, EL, DATA, NCLIP, CLIP, ISTAT, DSTAT, \
+              ISTATC, DSTATC, STATUS ); \
+}
+
+MAKE_KPG1_MSTA(b,BYTE,"_BYTE")
+MAKE_KPG1_MSTA(ub,UBYTE,"_UBYTE")
+MAKE_KPG1_MSTA(w,WORD,"_WORD")
+MAKE_KPG1_MSTA(uw,UWORD,"_UWORD")
+MAKE_KPG1_MSTA(i,INTEGER,"_INTEGER")
+MAKE_KPG1_MSTA(k,INTEGER8,"_INT64")
+MAKE_KPG1_MSTA(r,REAL,"_REAL")
+MAKE_KPG1_MSTA(d,DOUBLE,"_DOUBLE")
+
+#undef MAKE_KPG1_MSTA
+
+/* Do the work for all the above routines. */
+static void kpg1MstaF( const char *type, F77_LOGICAL_TYPE *BAD,
+                       F77_LOGICAL_TYPE *SAMPLE, F77_INTEGER_TYPE *EL,
+                       const void *DATA, F77_INTEGER_TYPE *NCLIP,
+                       F77_REAL_TYPE *CLIP, F77_INTEGER_TYPE *ISTAT,
+                       F77_DOUBLE_TYPE *DSTAT, F77_INTEGER_TYPE *ISTATC,
+                       F77_DOUBLE_TYPE *DSTATC, F77_INTEGER_TYPE *STATUS ){
+   ThrWorkForce *wf = NULL;
+   int cstatus;
+
+   F77_IMPORT_INTEGER( *STATUS, cstatus );
+
+/* Only use the workforce for large arrays. */
+   if( *EL >= KPG1_MSTA_MINTHR ) {
+      wf = thrGetWorkforce( thrGetNThread( "KAPPA_THREADS", &cstatus ),
+                            &cstatus );
+   }
+
+   kpg1Msta( wf, type, F77_ISTRUE( *BAD ), F77_ISTRUE( *SAMPLE ),
+             ( *EL > 0 ) ? (size_t) *EL : 0, DATA, *NCLIP, CLIP, ISTAT,
+             DSTAT, ISTATC, DSTATC, &cstatus );
+
+   F77_EXPORT_INTEGER( cstatus, *STATUS );
+}
@@ -88,17 +88,21 @@ void msg1Ifget( const char * levstr, int * status );
 int msg1Gref( const char * param, char *refstr, size_t reflen );
 int msg1Gkey( const char * param, char *keystr, size_t keylen );
 
+void msg1Flbuf( int * status );
 void msg1Ktok ( void );
 const char * msg1Levstr( msglev_t filter );
 void msg1Outif( msglev_t prior, const char * param, const char * text,
                 int useformat, va_list args, int *status );
+void msg1Outln( const char * text, int * status );
 void msg1Prtln( const char * text, int * status );
 void msg1Print( const char * text, const char * prefix, int * status );
 
+int msg1Gtbuf ( void );
 msglev_t msg1Gtinf ( void );
 int msg1Gtstm ( void );
 int msg1Gtwsz ( void );
 
+void msg1Ptbuf( int buffer );
 void msg1Ptwsz( int msgwsz );
 void msg1Ptstm( int msgstm );
 void msg1Ptinf( msglev_t msginf );
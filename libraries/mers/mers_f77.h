@@ -78,6 +78,7 @@ F77_SUBROUTINE(msg_blankif)( INTEGER(PRIOR), INTEGER(status) );
 
 F77_LOGICAL_FUNCTION(msg_flevok)( INTEGER(FILTER), INTEGER(STATUS) );
 
+F77_SUBROUTINE(msg_flush)( INTEGER(status) );
 F77_SUBROUTINE(msg_flusherr)( INTEGER(status) );
 
 F77_SUBROUTINE(msg_fmtc)( CHARACTER(token),
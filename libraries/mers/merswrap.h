@@ -116,6 +116,8 @@ void msgBlankif( msglev_t prior, int *status );
 
 int msgFlevok( msglev_t  filter, int *status );
 
+void msgFlush( int * status );
+
 void msgFlusherr( int * status );
 
 /* Gnu compiler can check for format consistency at compile time */
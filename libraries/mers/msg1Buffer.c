@@ -0,0 +1,309 @@
+/*
+*+
+*  Name:
+*     msg1Buffer
+
+*  Purpose:
+*     Per-thread buffering of MSG output
+
+*  Language:
+*     Starlink ANSI C
+
+*  Description:
+*     This file contains the functions used to implement the MSG "BUFFER"
+*     tuning parameter (see msgTune). When buffering is enabled, lines
+*     of message output generated by any thread other than the one that
+*     enabled buffering are appended to a buffer owned by the generating
+*     thread, rather than being delivered immediately. This means that
+*     worker threads do not wait for output to be delivered, and that
+*     the output from each thread is not interleaved with the output
+*     from other threads.
+*
+*     Buffered output is delivered by msg1Flbuf, which is called by
+*     msgFlush, whenever the enabling thread itself delivers a line of
+*     output, when buffering is disabled and when the program exits.
+*     The buffers are delivered one at a time, in the order in which
+*     each thread first buffered a line since the previous flush, so
+*     that all the lines from one thread appear together.
+
+*  Notes:
+*     - Buffering is only available if POSIX threads are available.
+*     Otherwise all output is delivered immediately.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful,but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "sae_par.h"
+#include "mers1.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if HAVE_PTHREAD_H
+#  include <pthread.h>
+
+/* The buffered output of one thread. The text holds each buffered line
+   followed by a nul character. */
+typedef struct Msg1Buffer {
+  char * text;                   /* Buffered lines */
+  size_t len;                    /* Number of characters used in text */
+  size_t size;                   /* Number of characters allocated */
+  unsigned long seq;             /* Order in which buffer was first used */
+  int done;                      /* Has the owning thread exited? */
+  pthread_mutex_t mutex;         /* Protects the text */
+  struct Msg1Buffer * next;      /* Next buffer in list */
+} Msg1Buffer;
+
+/* Initial number of characters allocated for a buffer */
+#define MSG1__SZBUF 4096
+
+static pthread_mutex_t msg1_buffer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t msg1_buffer_seqmutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t msg1_buffer_once = PTHREAD_ONCE_INIT;
+static pthread_key_t msg1_buffer_key;
+static int msg1_buffer_key_ok = 0;
+
+/* The list of all buffers and the thread that enabled buffering, both
+   protected by msg1_buffer_mutex, and the next sequence number, which is
+   protected by msg1_buffer_seqmutex. The mutex of a buffer may be locked
+   whilst msg1_buffer_mutex is locked, but not the other way round. */
+static Msg1Buffer * msg1_buffer_head = NULL;
+static pthread_t msg1_buffer_owner;
+static unsigned long msg1_buffer_seq = 0;
+
+static int msg1_buffer_on = 0;
+
+/* Called when a thread exits. The buffer is left in the list so that
+   its contents can still be delivered, and is freed by msg1Flbuf. */
+static void msg1Bufdone( void * ptr ) {
+  Msg1Buffer * buf = ptr;
+  pthread_mutex_lock( &(buf->mutex) );
+  buf->done = 1;
+  pthread_mutex_unlock( &(buf->mutex) );
+}
+
+static void msg1Bufkey( void ) {
+  if ( pthread_key_create( &msg1_buffer_key, msg1Bufdone ) == 0 ) {
+    msg1_buffer_key_ok = 1;
+  }
+}
+
+/* Deliver any buffered output when the program exits */
+static void msg1Bufexit( void ) {
+  int status = SAI__OK;
+  msg1Flbuf( &status );
+}
+
+/* Append a line to the buffer of the calling thread. Returns zero if
+   the line could not be buffered. */
+static int msg1Bufadd( const char * text ) {
+  Msg1Buffer * buf;
+  char * newtext;
+  size_t len;
+  size_t newsize;
+
+  pthread_once( &msg1_buffer_once, msg1Bufkey );
+  if ( !msg1_buffer_key_ok ) return 0;
+
+  buf = pthread_getspecific( msg1_buffer_key );
+  if ( !buf ) {
+    buf = calloc( 1, sizeof(*buf) );
+    if ( !buf ) return 0;
+    pthread_mutex_init( &(buf->mutex), NULL );
+    if ( pthread_setspecific( msg1_buffer_key, buf ) ) {
+      pthread_mutex_destroy( &(buf->mutex) );
+      free( buf );
+      return 0;
+    }
+    pthread_mutex_lock( &msg1_buffer_mutex );
+    buf->next = msg1_buffer_head;
+    msg1_buffer_head = buf;
+    pthread_mutex_unlock( &msg1_buffer_mutex );
+  }
+
+  /* Note the order in which the buffer was first used since it was
+     last emptied */
+  pthread_mutex_lock( &(buf->mutex) );
+  if ( buf->len == 0 ) {
+    pthread_mutex_lock( &msg1_buffer_seqmutex );
+    buf->seq = msg1_buffer_seq++;
+    pthread_mutex_unlock( &msg1_buffer_seqmutex );
+  }
+
+  len = strlen( text ) + 1;
+  if ( buf->len + len > buf->size ) {
+    newsize = ( buf->size ? 2 * buf->size : MSG1__SZBUF );
+    while ( newsize < buf->len + len ) newsize *= 2;
+    newtext = realloc( buf->text, newsize );
+    if ( !newtext ) {
+      pthread_mutex_unlock( &(buf->mutex) );
+      return 0;
+    }
+    buf->text = newtext;
+    buf->size = newsize;
+  }
+  memcpy( buf->text + buf->len, text, len );
+  buf->len += len;
+  pthread_mutex_unlock( &(buf->mutex) );
+
+  return 1;
+}
+
+#endif
+
+/* Enable or disable buffering. Any output buffered so far is delivered
+   when buffering is disabled. */
+void msg1Ptbuf( int buffer ) {
+#if HAVE_PTHREAD_H
+  static int registered = 0;
+  int status = SAI__OK;
+
+  pthread_mutex_lock( &msg1_buffer_mutex );
+  if ( buffer ) {
+    msg1_buffer_owner = pthread_self();
+    if ( !registered ) registered = !atexit( msg1Bufexit );
+  }
+  msg1_buffer_on = ( buffer ? 1 : 0 );
+  pthread_mutex_unlock( &msg1_buffer_mutex );
+
+  if ( !buffer ) msg1Flbuf( &status );
+#else
+  (void) buffer;
+#endif
+}
+
+/* Is buffering enabled? */
+int msg1Gtbuf( void ) {
+#if HAVE_PTHREAD_H
+  return msg1_buffer_on;
+#else
+  return 0;
+#endif
+}
+
+/* Deliver a line of output, or buffer it if buffering is enabled and
+   the calling thread is not the thread that enabled it. Buffered output
+   is delivered before any output from the enabling thread. */
+void msg1Outln( const char * text, int * status ) {
+  if (*status != SAI__OK) return;
+
+#if HAVE_PTHREAD_H
+  if ( msg1_buffer_on ) {
+    if ( !pthread_equal( pthread_self(), msg1_buffer_owner ) &&
+         msg1Bufadd( text ) ) return;
+    msg1Flbuf( status );
+  }
+#endif
+
+  msg1Prtln( text, status );
+}
+
+/* Deliver all buffered output, one thread at a time */
+void msg1Flbuf( int * status ) {
+#if HAVE_PTHREAD_H
+  Msg1Buffer ** prev;
+  Msg1Buffer ** pnext;
+  Msg1Buffer * buf;
+  Msg1Buffer * next;
+  char * text;
+  size_t len;
+  size_t pos;
+  unsigned long seq;
+  int done;
+  int istat = SAI__OK;
+
+  /* Hold the list mutex throughout so that concurrent flushes do not
+     interleave their output */
+  pthread_mutex_lock( &msg1_buffer_mutex );
+
+  while ( 1 ) {
+
+    /* Find the non-empty buffer that was first used earliest */
+    pnext = NULL;
+    seq = 0;
+    for ( prev = &msg1_buffer_head; *prev; prev = &((*prev)->next) ) {
+      buf = *prev;
+      pthread_mutex_lock( &(buf->mutex) );
+      if ( buf->len > 0 && ( !pnext || buf->seq < seq ) ) {
+        pnext = prev;
+        seq = buf->seq;
+      }
+      pthread_mutex_unlock( &(buf->mutex) );
+    }
+    if ( !pnext ) break;
+
+    /* Take its text, so that the owning thread can continue to buffer
+       output whilst this text is delivered */
+    buf = *pnext;
+    pthread_mutex_lock( &(buf->mutex) );
+    text = buf->text;
+    len = buf->len;
+    buf->text = NULL;
+    buf->len = 0;
+    buf->size = 0;
+    pthread_mutex_unlock( &(buf->mutex) );
+
+    for ( pos = 0; pos < len; pos += strlen( text + pos ) + 1 ) {
+      msg1Prtln( text + pos, &istat );
+    }
+    free( text );
+  }
+
+  /* Free the buffers of threads that have exited */
+  prev = &msg1_buffer_head;
+  while ( *prev ) {
+    buf = *prev;
+    next = buf->next;
+    pthread_mutex_lock( &(buf->mutex) );
+    done = ( buf->done && buf->len == 0 );
+    pthread_mutex_unlock( &(buf->mutex) );
+    if ( done ) {
+      *prev = next;
+      free( buf->text );
+      pthread_mutex_destroy( &(buf->mutex) );
+      free( buf );
+    } else {
+      prev = &(buf->next);
+    }
+  }
+
+  pthread_mutex_unlock( &msg1_buffer_mutex );
+
+  if ( istat != SAI__OK && *status == SAI__OK ) *status = istat;
+#else
+  /* Nothing is ever buffered */
+  (void) status;
+#endif
+}
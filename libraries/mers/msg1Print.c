@@ -116,6 +116,8 @@
 *        Add prefix option. See err1Print and err1Flush.
 *     9-FEB-2009 (TIMJ):
 *        Error reporting used wrong message token
+*     14-OCT-2026:
+*        Deliver lines via msg1Outln so that they can be buffered.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -165,7 +167,7 @@ void msg1Print( const char * text, const char * prefix, int * status ) {
       /*     Output with no messing */
       star_strlcpy( line, prefix, sizeof(line) );
       star_strlcat( line, text, sizeof(line) );
-      msg1Prtln( line, &istat );
+      msg1Outln( line, &istat );
     } else {
 
       /* Precalculate continuation string */
@@ -185,18 +187,18 @@ void msg1Print( const char * text, const char * prefix, int * status ) {
 
       /*     Loop to deliver the message in line-sized chunks. */
       ems1Rform( text, msg1Gtwsz() - lstart, &iposn, &(line[lstart]), &oplen );
-      msg1Prtln( line, &istat );
+      msg1Outln( line, &istat );
 
       while ( iposn != 0 && istat == SAI__OK) {
         star_strlcpy( line, constr, sizeof(line) );
         ems1Rform( text, msg1Gtwsz() - contab, &iposn, &(line[contab]), &oplen );
-        msg1Prtln( line, &istat );
+        msg1Outln( line, &istat );
       }
     }
   } else {
 
     /*     If there is no text, then send a blank message. */
-    msg1Prtln( "", &istat );
+    msg1Outln( "", &istat );
   }
 
   /*  If the message cannot be delivered, then annul the current error
@@ -0,0 +1,79 @@
+/*
+*+
+*  Name:
+*     msgFlush
+
+*  Purpose:
+*     Deliver any buffered message output
+
+*  Language:
+*     Starlink ANSI C
+
+*  Invocation:
+*     msgFlush( int * status );
+
+*  Description:
+*     If the BUFFER tuning parameter has been set (see msgTune), any
+*     message output that has been buffered by threads other than the
+*     thread that enabled buffering is delivered to the user. The lines
+*     from each thread are delivered together, with the threads in the
+*     order in which they first buffered a line. If buffering is not
+*     enabled, no action is taken.
+
+*  Arguments:
+*     status = int * (Given and Returned)
+*        The global status. If an output error occurs, the status
+*        argument is returned set to MSG__OPTER.
+
+*  Notes:
+*     - This routine attempts to execute even if status is set on
+*     entry, so that buffered output is not lost.
+*     - The THR library calls this routine at the end of thrWait, so
+*     that output from the jobs that have completed is delivered before
+*     the calling thread continues.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful,but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+#include "sae_par.h"
+#include "mers1.h"
+#include "merswrap.h"
+
+void msgFlush( int * status ) {
+  int istat = SAI__OK;        /* Local status */
+
+  if ( !msg1Gtbuf() ) return;
+
+  /*  Deliver the buffers using a local status, and only return an
+   *  output error if no error had already occurred. */
+  msg1Flbuf( &istat );
+  if ( *status == SAI__OK ) *status = istat;
+}
@@ -51,6 +51,16 @@
 *            replaced by blanks, and line wrapping occurs (subject to SZOUT).
 *            If VALUE is set to 1, no cleaning or line wrapping occurs.
 *
+*        'BUFFER' Specifies whether or not output generated by other
+*            threads should be buffered. If VALUE is set to 0 (the default)
+*            all output is delivered immediately. If VALUE is set to 1,
+*            output from any thread other than the calling thread is held
+*            in a separate buffer for each thread, and is delivered when
+*            msgFlush is called, when the calling thread next delivers
+*            output, when BUFFER is reset to 0, or when the program exits.
+*            The lines from each thread are delivered together. This avoids
+*            worker threads having to wait for their output to be delivered.
+*
 *        'ENVIRONMENT' This is not a true tuning parameter name but causes
 *            the environment variables associated with all the true tuning
 *            parameters to be used if set. If the environment variable is
@@ -117,6 +127,8 @@
 *        that routine is much more flexible and can handle a string.
 *     2012-05-21 (TIMJ):
 *        We are allowed to get 0 from the environment!
+*     14-OCT-2026:
+*        Add BUFFER tuning parameter.
 *     {enter_changes_here}
 
 *  Bugs:
@@ -138,7 +150,7 @@
 
 void msgTune( const char * param, int value, int * status ) {
 
-  const char * parnames[] = { "SZOUT", "STREAM", NULL };
+  const char * parnames[] = { "SZOUT", "STREAM", "BUFFER", NULL };
   const char * thispar = NULL;   /* Selected parameter */
 
   int i;
@@ -235,6 +247,17 @@ void msgTune( const char * param, int value, int * status ) {
         }
         if (ltune != -1) msg1Ptstm( ltune );
 
+      } else if (strcasecmp( "BUFFER", thispar ) == 0 ) {
+
+        if (useval == 0) {
+          ltune = 0;
+        } else if (useval == 1) {
+          ltune = 1;
+        } else {
+          *status = MSG__BTUNE;
+        }
+        if (ltune != -1) msg1Ptbuf( ltune );
+
       } else if (strcasecmp( "FILTER", thispar ) == 0 ) {
         /* This should really allow a string QUIET, VERBOSE etc
            but that would have to be a different API */
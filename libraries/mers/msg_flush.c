@@ -0,0 +1,67 @@
+/*
+*+
+*  Name:
+*     MSG_FLUSH
+
+*  Purpose:
+*     Deliver any buffered message output
+
+*  Language:
+*    Starlink ANSI C (Callable from Fortran)
+
+*  Invocation:
+*     CALL MSG_FLUSH( STATUS )
+
+*  Description:
+*     If the BUFFER tuning parameter has been set (see MSG_TUNE), any
+*     message output that has been buffered by other threads is
+*     delivered to the user.
+
+*  Arguments:
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Algorithm:
+*     -  Calls msgFlush
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful,but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+#include "f77.h"
+#include "mers_f77.h"
+#include "merswrap.h"
+
+F77_SUBROUTINE(msg_flush)( INTEGER(STATUS) ) {
+  int status;
+  F77_IMPORT_INTEGER( *STATUS, status );
+  msgFlush( &status );
+  F77_EXPORT_INTEGER( status, *STATUS );
+}
@@ -127,7 +127,8 @@
 *     Copyright (C) 1986-1990, 1993-1994 Science & Engineering Research
 *     Council. Copyright (C) 1999, 2004 Central Laboratory of the
 *     Research Councils. Copyright (C) 2005 Particle Physics &
-*     Astronomy Research Council. All Rights Reserved.
+*     Astronomy Research Council. Copyright (C) 2026 East Asian
+*     Observatory. All Rights Reserved.
 
 *  Licence:
 *     This program is free software; you can redistribute it and/or
@@ -311,6 +312,12 @@
 *        Comment out void arglist function prototypes. GCC4 doesn't allow those.
 *     15-SEP-2008 (TIMJ):
 *        3-arg emsSetc is deprecated.
+*     14-Oct-2026:
+*        New routines NBS_GET_VALUES and NBS_PUT_VALUES to get and put
+*        several items of a noticeboard as one consistent snapshot. Add
+*        memory barriers around the data copies in NBS_GET_VALUE and
+*        NBS_PUT_VALUE so that the modified counts are not reordered
+*        with the data on weakly ordered processors.
 *     {enter_changes_here}
 
 *  Bugs:
@@ -349,6 +356,7 @@
 #define NBS_LOSE_NOTICEBOARD	nbc_lose_noticeboard
 #define NBS_LOSE_ITEM		nbc_lose_item
 #define NBS_PUT_VALUE		nbc_put_value
+#define NBS_PUT_VALUES		nbc_put_values
 #define NBS_PUT_CVALUE		nbc_put_cvalue
 #define NBS_PUT_SHAPE		nbc_put_shape
 #define NBS_INC_MODIFIED	nbc_inc_modified
@@ -356,6 +364,7 @@
 #define NBS_PUT_TRIGGER		nbc_put_trigger
 #define NBS_GET_CVALUE		nbc_get_cvalue
 #define NBS_GET_VALUE		nbc_get_value
+#define NBS_GET_VALUES		nbc_get_values
 #define NBS_GET_SHAPE		nbc_get_shape
 #define NBS_GET_MODIFIED	nbc_get_modified
 #define NBS_GET_MODIFIED_POINTER nbc_get_modified_pointer
@@ -400,6 +409,7 @@
 #define NBS_LOSE_NOTICEBOARD	F77_EXTERNAL_NAME(nbs_lose_noticeboard)
 #define NBS_LOSE_ITEM		F77_EXTERNAL_NAME(nbs_lose_item)
 #define NBS_PUT_VALUE		F77_EXTERNAL_NAME(nbs_put_value)
+#define NBS_PUT_VALUES		F77_EXTERNAL_NAME(nbs_put_values)
 #define NBS_PUT_CVALUE		F77_EXTERNAL_NAME(nbs_put_cvalue)
 #define NBS_PUT_SHAPE		F77_EXTERNAL_NAME(nbs_put_shape)
 #define NBS_INC_MODIFIED	F77_EXTERNAL_NAME(nbs_inc_modified)
@@ -407,6 +417,7 @@
 #define NBS_PUT_TRIGGER		F77_EXTERNAL_NAME(nbs_put_trigger)
 #define NBS_GET_CVALUE		F77_EXTERNAL_NAME(nbs_get_cvalue)
 #define NBS_GET_VALUE		F77_EXTERNAL_NAME(nbs_get_value)
+#define NBS_GET_VALUES		F77_EXTERNAL_NAME(nbs_get_values)
 #define NBS_GET_SHAPE		F77_EXTERNAL_NAME(nbs_get_shape)
 #define NBS_GET_MODIFIED	F77_EXTERNAL_NAME(nbs_get_modified)
 #define NBS_GET_MODIFIED_POINTER F77_EXTERNAL_NAME(nbs_get_modified_pointer)
@@ -522,6 +533,10 @@ static int world_write = NO; /* Whether the world can write to noticeboards */
 static int increment_modify = YES; /* Whether to increment MODIFIED on PUT */
 static int check_modify = YES; /* Whether to check MODIFIED on GET */
 
+/* Not tunable */
+
+static int spin_count = 10; /* Number of immediate tries on GET_VALUES */
+
 /*
 *  Section name:
 *     NBS_TUNE
@@ -3608,10 +3623,13 @@ int NBS_PUT_VALUE ( R_INTEGER(id), R_INTEGER(offset), R_INTEGER(nbytes),
 
       else if (increment_modify || tid->board->increment_modify) {
 	 _add_interlocked (&tid->fixed->modified);
+	 _mem_barrier ();
        	 tid->fixed->actbytes = MAX (tid->fixed->actbytes,
 					   toffset + tnbytes);
 	 _chmove (tnbytes,byte_array,(char *)tid->da.data + toffset);
+	 _mem_barrier ();
 	 _add_interlocked (&tid->fixed->modified);
+	 _mem_barrier ();
          _add_interlocked (&tid->board->modified);
          if (tid->trigger)
             (*tid->trigger) (id,status);
@@ -3631,6 +3649,243 @@ int NBS_PUT_VALUE ( R_INTEGER(id), R_INTEGER(offset), R_INTEGER(nbytes),
    return (*status);
 }
 
+/*
+*+
+*  Name:
+*     NBS_PUT_VALUES
+
+*  Purpose:
+*     Put byte arrays into several primitive items as a single update
+
+*  Language:
+*     ANSI C
+
+*  Invocation:
+*     (Int) = NBS_PUT_VALUES (NITEM,IDS,NBYTES,BYTE_ARRAY,STATUS)
+
+*  Description:
+*     \begin {tabbing}
+*     Check that each ID is not NIL, pertains to a primitive item in the
+*     same noticeboard as the first, that the caller \\
+*     owns the noticeboard (or WORLD\_WRITE is TRUE), that the item does
+*     not appear twice and that the number of bytes is not greater \\
+*     than the allocated space. \\
+*     If INCREMENT\_MODIFY is TRUE, increment every item's modified count. \\
+*     Copy the bytes into each item and adjust its size if needed. \\
+*     If INCREMENT\_MODIFY is TRUE, increment every item's modified count
+*     again and then the noticeboard modified count. \\
+*     Call the trigger routine of each item that has one.
+*     \end {tabbing}
+*
+*     Because every item's modified count is odd for the whole update, and
+*     the noticeboard modified count is only incremented once all the items
+*     have been updated, NBS_GET_VALUES will see either all or none of the
+*     new values.
+*
+*     The data of each item is put at its start (ie with zero offset). The
+*     user's buffer holds the items one after another, item I starting at
+*     the sum of NBYTES for the preceding items.
+
+*  Arguments:
+*     NITEM = INTEGER (Given)
+*        Number of items.
+*     IDS = INTEGER(NITEM) (Given)
+*        Identifiers of the items into which values are to be put. All
+*        items must belong to the same noticeboard.
+*     NBYTES = INTEGER(NITEM) (Given)
+*        Number of bytes to put into each item.
+*     BYTE_ARRAY = BYTE(*) (Given)
+*        User's buffer containing the bytes for all the items.
+*     STATUS = INTEGER (Given and returned)
+*        The global status. Possible return values are,
+*        	NBS__NILID	  => NIL ID
+*         	NBS__NOTPRIMITIVE => Item is not primitive
+*        	NBS__NOTSAMEBOARD => Items are not all in the same noticeboard
+*        	NBS__NOTOWNER	  => Not owner of noticeboard
+*        	NBS__DUPLICATEITEM => Item appears more than once
+*        	NBS__TOOMANYBYTES => More bytes than maximum allowed
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 59 Temple Place,Suite 330, Boston, MA
+*     02111-1307, USA
+
+*  Authors:
+*     {original_author_entry}
+
+*  History:
+*     14-Oct-2026:
+*        Original version.
+*     {enter_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*  External Routines Used:
+*     None.
+
+*  Prior Requirements:
+*     NBS_FIND_NOTICEBOARD must have been called.
+
+*-
+*/
+int NBS_PUT_VALUES ( R_INTEGER(nitem), RW_INTEGER_ARRAY(ids),
+                     RW_INTEGER_ARRAY(nbytes), RW_BYTE_ARRAY(byte_array),
+                     W_INTEGER(status) )
+{
+  GENPTR_INTEGER(nitem)
+  GENPTR_INTEGER_ARRAY(ids)
+  GENPTR_INTEGER_ARRAY(nbytes)
+  GENPTR_BYTE_ARRAY(byte_array)
+  GENPTR_INTEGER(status)
+
+/* Local variable declarations */
+
+   item_id	tid;
+   board_id	board = NIL;
+   int		tnitem;
+   int		i;
+   int		j;
+   int		modify;
+   char		*sptr;
+
+/* Start of code */
+
+/* Check that status is good. */
+
+   IF_OK {
+
+/* Import the number of items. */
+
+      NBS_INTIMP (&tnitem,nitem);
+
+/* Check that each item ID is not NIL, that the item is primitive and in the
+   same noticeboard as the first, that the caller owns the noticeboard (or
+   WORLD_WRITE is TRUE), that the item does not appear twice (its modified
+   count would then be incremented twice, so readers would not see the
+   update in progress) and that the number of bytes to copy is not greater
+   than the allocated space. */
+
+      for (i = 0; i < tnitem && *status == SAI__OK; i++) {
+         tid = NIL;
+         *((int *) &tid) = ids[i];
+         if (tid == NIL)
+            {
+            *status = NBS__NILID;
+            emsRep( "NBS_PUT_VALUES_NILID", "NIL item ID", status );
+            }
+         else if (!tid->fixed->primitive)
+            {
+	    *status = NBS__NOTPRIMITIVE;
+            emsRep( "NBS_PUT_VALUES_NOTPRIM", "Item is not primitive",
+                    status );
+            }
+         else if (i > 0 && tid->board != board)
+            {
+	    *status = NBS__NOTSAMEBOARD;
+            emsRep( "NBS_PUT_VALUES_NOTSAME",
+                    "Items are not all in the same noticeboard", status );
+            }
+         else if (!world_write && !tid->board->world_write &&
+						nbs_gl_pid != tid->board->pid)
+            {
+            *status = NBS__NOTOWNER;
+            emsRep( "NBS_PUT_VALUES_NOTOWN",
+                 "Non-owner attempted to alter noticeboard", status );
+            }
+         else if (nbytes[i] > tid->fixed->maxbytes)
+            {
+            *status = NBS__TOOMANYBYTES;
+            emsRep( "NBS_PUT_VALUES_TOOMANYBYTES",
+                    "More bytes than maximum allowed", status );
+            }
+         else {
+            board = tid->board;
+            for (j = 0; j < i; j++) {
+               if (ids[j] == ids[i])
+                  {
+                  *status = NBS__DUPLICATEITEM;
+                  emsRep( "NBS_PUT_VALUES_DUPLICATE",
+                          "Item appears more than once", status );
+                  break;
+                  }
+            }
+         }
+      }
+
+      if (*status == SAI__OK && tnitem > 0) {
+
+/* If INCREMENT_MODIFY is TRUE: increment every item's modified count
+   (which should make them odd) before any data is changed. */
+
+         modify = increment_modify || board->increment_modify;
+         if (modify) {
+            for (i = 0; i < tnitem; i++) {
+               tid = NIL;
+               *((int *) &tid) = ids[i];
+	       _add_interlocked (&tid->fixed->modified);
+            }
+	    _mem_barrier ();
+         }
+
+/* Adjust the item sizes and copy the data. */
+
+         sptr = byte_array;
+         for (i = 0; i < tnitem; i++) {
+            tid = NIL;
+            *((int *) &tid) = ids[i];
+       	    tid->fixed->actbytes = MAX (tid->fixed->actbytes,nbytes[i]);
+	    _chmove (MAX (0,nbytes[i]),sptr,(char *)tid->da.data);
+	    sptr += MAX (0,nbytes[i]);
+         }
+
+/* If INCREMENT_MODIFY is TRUE: increment every item's modified count again
+   (which should make them even again) and then the noticeboard's modified
+   count. */
+
+         if (modify) {
+	    _mem_barrier ();
+            for (i = 0; i < tnitem; i++) {
+               tid = NIL;
+               *((int *) &tid) = ids[i];
+	       _add_interlocked (&tid->fixed->modified);
+            }
+	    _mem_barrier ();
+            _add_interlocked (&board->modified);
+         }
+
+/* Call the trigger routines. */
+
+         for (i = 0; i < tnitem; i++) {
+            tid = NIL;
+            *((int *) &tid) = ids[i];
+            if (tid->trigger)
+#ifdef c_string
+               (*tid->trigger) (ids[i],status);
+#else
+               (*tid->trigger) (&ids[i],status);
+#endif
+         }
+      }
+   }
+   return (*status);
+}
+
 /*
 *+
 *  Name:
@@ -4539,9 +4794,11 @@ int NBS_GET_VALUE ( R_INTEGER(id), R_INTEGER(offset), R_INTEGER(maxbytes),
 	    if (count > 0)
 	       NBS_SLEEPMS ( timeout_interval );
 	    before = tid->fixed->modified;
+	    _mem_barrier ();
 	    *actbytes = tid->fixed->actbytes;
 	    _chmove (MIN (tmaxbytes,MAX (0,*actbytes - toffset)),
 	    	       (char *)tid->da.data + toffset,byte_array);
+	    _mem_barrier ();
 	    after = tid->fixed->modified;
             count++;
 	    } while (count < timeout_count && (before != after || ODD (after)));
@@ -4565,6 +4822,231 @@ int NBS_GET_VALUE ( R_INTEGER(id), R_INTEGER(offset), R_INTEGER(maxbytes),
    return (*status);
 }
 
+/*
+*+
+*  Name:
+*     NBS_GET_VALUES
+
+*  Purpose:
+*     Get a consistent snapshot of the values of several primitive items
+
+*  Language:
+*     ANSI C
+
+*  Invocation:
+*     (Int) = NBS_GET_VALUES (NITEM,IDS,MAXBYTES,BYTE_ARRAY,ACTBYTES,
+*                             MODIFIED,STATUS)
+
+*  Description:
+*     \begin {tabbing}
+*     Check that each ID is not NIL, pertains to a primitive item and
+*     belongs to the same noticeboard as the first. \\
+*     Repeat \= \{ \\
+*            \> Read the noticeboard modified count. \\
+*            \> For each item, read its modified count, copy as many bytes
+*               as there is room for in its part of the user's buffer and
+*               read its modified count \\
+*            \> once more. \\
+*            \> Read the noticeboard modified count once more. \\
+*            \> \} \= Until time out or every item's modified counts were
+*                     equal and even and the two noticeboard modified \\
+*            \>    \> counts are equal (which means that no item was updated
+*                     whilst the items were being read).
+*     \end {tabbing}
+*
+*     The values returned are therefore a consistent snapshot of the
+*     items, as if they had all been got at the same instant. The
+*     noticeboard modified count of the snapshot is returned so that a
+*     caller polling the same group of items can check whether anything
+*     has changed since the previous snapshot. Items updated together by
+*     NBS_PUT_VALUES are always seen either all before or all after the
+*     update. The first few retries are made immediately, since updates by
+*     the owner are brief, and only then does the routine wait
+*     TIMEOUT_INTERVAL milliseconds between tries.
+*
+*     If CHECK_MODIFY is FALSE, the modified counts are not checked at all,
+*     a timeout cannot occur and the values need not be consistent.
+*
+*     The data of each item is got from its start (ie with zero offset).
+*     The user's buffer holds the items one after another, item I starting
+*     at the sum of MAXBYTES for the preceding items.
+
+*  Arguments:
+*     NITEM = INTEGER (Given)
+*        Number of items.
+*     IDS = INTEGER(NITEM) (Given)
+*        Identifiers of the items from which values are to be got. All
+*        items must belong to the same noticeboard.
+*     MAXBYTES = INTEGER(NITEM) (Given)
+*        Size in bytes of the part of the user's buffer for each item.
+*     BYTE_ARRAY = BYTE(*) (Returned)
+*        User's buffer into which bytes will be got. Must be at least
+*        the sum of MAXBYTES long.
+*     ACTBYTES = INTEGER(NITEM) (Returned)
+*        Actual number of bytes associated with each item. This may be
+*        greater than MAXBYTES but no more than MAXBYTES bytes will be
+*        copied into the user's buffer.
+*     MODIFIED = INTEGER (Returned)
+*        The noticeboard modified count at the time of the snapshot.
+*     STATUS = INTEGER (Given and returned)
+*        The global status. Possible return values are,
+*        	NBS__NILID	  => NIL ID
+*         	NBS__NOTPRIMITIVE => Item is not primitive
+*        	NBS__NOTSAMEBOARD => Items are not all in the same noticeboard
+*        	NBS__TIMEOUT	  => Timeout awaiting valid data
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 59 Temple Place,Suite 330, Boston, MA
+*     02111-1307, USA
+
+*  Authors:
+*     {original_author_entry}
+
+*  History:
+*     14-Oct-2026:
+*        Original version.
+*     {enter_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*  External Routines Used:
+*     None.
+
+*  Prior Requirements:
+*     NBS_FIND_NOTICEBOARD must have been called.
+
+*-
+*/
+int NBS_GET_VALUES ( R_INTEGER(nitem), RW_INTEGER_ARRAY(ids),
+                     RW_INTEGER_ARRAY(maxbytes), RW_BYTE_ARRAY(byte_array),
+                     RW_INTEGER_ARRAY(actbytes), W_INTEGER(modified),
+                     W_INTEGER(status) )
+{
+  GENPTR_INTEGER(nitem)
+  GENPTR_INTEGER_ARRAY(ids)
+  GENPTR_INTEGER_ARRAY(maxbytes)
+  GENPTR_BYTE_ARRAY(byte_array)
+  GENPTR_INTEGER_ARRAY(actbytes)
+  GENPTR_INTEGER(modified)
+  GENPTR_INTEGER(status)
+
+/* Local variable declarations.	*/
+
+   item_id	tid;
+   board_id	board = NIL;
+   int		tnitem;
+   int		i;
+   int		count;
+   int		after;
+   int		before;
+   int		bafter;
+   int		bbefore;
+   int		consistent;
+   char		*dptr;
+
+/* Start of code */
+
+/* Check that status is good. */
+
+   IF_OK {
+
+/* Import the number of items. */
+
+      NBS_INTIMP (&tnitem,nitem);
+
+/* Check that each item ID is not NIL, that the item is primitive and that
+   all the items are in the same noticeboard. */
+
+      for (i = 0; i < tnitem && *status == SAI__OK; i++) {
+         tid = NIL;
+         *((int *) &tid) = ids[i];
+         if (tid == NIL)
+            {
+            *status = NBS__NILID;
+            emsRep( "NBS_GET_VALUES_NILID", "NIL item ID", status );
+            }
+         else if (!tid->fixed->primitive)
+            {
+	    *status = NBS__NOTPRIMITIVE;
+            emsRep( "NBS_GET_VALUES_NOTPRIM", "Item is not primitive",
+                    status );
+            }
+         else if (i == 0)
+            board = tid->board;
+         else if (tid->board != board)
+            {
+	    *status = NBS__NOTSAMEBOARD;
+            emsRep( "NBS_GET_VALUES_NOTSAME",
+                    "Items are not all in the same noticeboard", status );
+            }
+      }
+
+      if (*status == SAI__OK && tnitem > 0) {
+
+/* Repeat: read the noticeboard modified count, get each item checking its
+   modified count, read the noticeboard modified count; until time out or a
+   consistent snapshot was got. If CHECK_MODIFY is FALSE, just get each
+   item once. */
+
+         count = 0;
+         do {
+	    if (count >= spin_count)
+	       NBS_SLEEPMS ( timeout_interval );
+	    consistent = YES;
+	    bbefore = board->modified;
+	    _mem_barrier ();
+	    dptr = byte_array;
+	    for (i = 0; i < tnitem && consistent; i++) {
+	       tid = NIL;
+	       *((int *) &tid) = ids[i];
+	       before = tid->fixed->modified;
+	       _mem_barrier ();
+	       actbytes[i] = tid->fixed->actbytes;
+	       _chmove (MIN (maxbytes[i],MAX (0,actbytes[i])),
+	    	          (char *)tid->da.data,dptr);
+	       _mem_barrier ();
+	       after = tid->fixed->modified;
+	       if (before != after || ODD (after))
+	          consistent = NO;
+	       dptr += maxbytes[i];
+	    }
+	    _mem_barrier ();
+	    bafter = board->modified;
+	    if (bbefore != bafter)
+	       consistent = NO;
+            count++;
+	    } while (!consistent && count < timeout_count &&
+	             (check_modify || board->check_modify));
+
+         *modified = bafter;
+         if (!consistent && (check_modify || board->check_modify))
+            {
+	    *status = NBS__TIMEOUT;
+            emsRep( "NBS_GET_VALUES_TIMEOUT",
+              "Time out getting item values", status );
+            }
+      }
+   }
+   return (*status);
+}
+
 /*
 *+
 *  Name:
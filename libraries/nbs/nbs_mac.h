@@ -16,7 +16,8 @@
 *  Copyright:
 *     Copyright (C) 1986-1990, 1993-1994 Science & Engineering Research
 *     Council. Copyright (C) 1995, 2004 Central Laboratory of the
-*     Research Councils. All Rights Reserved.
+*     Research Councils. Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
 
 *  Licence:
 *     This program is free software; you can redistribute it and/or
@@ -78,6 +79,8 @@
 *        Changed NBS__OK to SAI__OK
 *     27-Jun-2004 (AA):
 *        Changed ifdef logic for building under Mac OSX
+*     14-Oct-2026:
+*        Add _mem_barrier macro.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -199,6 +202,16 @@ if (!_ADAWI(1,(unsigned short *)(dptr))) (*(dptr))+=0x10000
 #endif
 
 
+/* Full memory barrier. Stops the compiler and processor from moving loads
+   and stores of a modified count past those of the data that it protects. */
+
+#if defined(__GNUC__)
+#define _mem_barrier() __sync_synchronize()
+#else
+#define _mem_barrier()
+#endif
+
+
 /* Argument declaration macros. R_ stands for input, W_ for output */
 
 #ifdef c_string
@@ -56,6 +56,8 @@
 *       Use HDSLoc* rather than char [DAT__SZLOC]
 *     23-JAN-2009 (DSB):
 *        Added ndfHsdat.
+*     14-OCT-2026:
+*        Added ndfIterBegin, ndfIterNext and ndfIterEnd.
 *    <{enter_further_changes_here}>
 
 *-
@@ -148,6 +150,12 @@
 #include "ndf_err.h"             /* NDF_ error codes                        */
 #endif
 
+/* Types.                                                                   */
+/* ======                                                                   */
+/* Iterator that steps through an NDF in blocks (see ndfIterBegin). The     */
+/* structure is private to the NDF_ library.                                */
+typedef struct NdfIter NdfIter;
+
 /* Function prototypes.                                                     */
 /* ====================                                                     */
 void ndfAcget( int indf,
@@ -468,6 +476,25 @@ void ndfIstmp( int indf,
                int *istmp,
                int *status );
 
+NdfIter *ndfIterBegin( int indf,
+                       const char *comp,
+                       const char *type,
+                       const char *mmod,
+                       int axis,
+                       size_t maxmem,
+                       int prefetch,
+                       int *status );
+
+void ndfIterEnd( NdfIter **iter,
+                 int *status );
+
+int ndfIterNext( NdfIter *iter,
+                 void *pntr[],
+                 int *el,
+                 int lbnd[],
+                 int ubnd[],
+                 int *status );
+
 void ndfLoc( int indf,
              const char *mode,
              HDSLoc ** loc,
@@ -19,6 +19,11 @@
 *     extended. The DCB current history record count is incremented to
 *     identify the new record. This routine does not create any
 *     components within the new record structure.
+*
+*     The array is extended by half its current size, or by the
+*     history extension increment if that is larger. This means that
+*     the cost of extending the array, averaged over all the records,
+*     does not grow as the history grows.
 
 *  Arguments:
 *     IDCB = INTEGER (Given)
@@ -34,6 +39,7 @@
 
 *  Copyright:
 *     Copyright (C) 1993 Science & Engineering Research Council
+*     Copyright (C) 2026 East Asian Observatory.
 
 *  Licence:
 *     This program is free software; you can redistribute it and/or
@@ -60,6 +66,9 @@
 *        Original version.
 *     11-MAY-1993 (RFWS):
 *        Removed history structure creation.
+*     14-OCT-2026:
+*        Extend the history record array geometrically rather than by
+*        a fixed increment.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -79,6 +88,9 @@
 
 *  Global Variables:
       INCLUDE 'NDF_DCB'          ! NDF_ Data Control Block
+*        DCB_HEXT( NDF__MXDCB ) = INTEGER (Read)
+*           Minimum number of records by which to extend the history
+*           record array.
 *        DCB_HLOC( NDF__MXDCB ) = CHARACTER * ( DAT__SZLOC ) (Read)
 *           Locator for NDF history component.
 *        DCB_HNREC( NDF__MXDCB ) = INTEGER (Read and Write)
@@ -114,9 +126,12 @@
       IF ( STATUS .EQ. SAI__OK ) THEN
 
 *  If there is insufficient room for another record, then extend the
-*  array.
+*  array. Extending it by a fixed number of records would make the
+*  total cost of the extensions grow as the square of the number of
+*  records, so extend it by a fraction of its current size.
          IF ( MXREC .LT. ( DCB_HNREC( IDCB ) + 1 ) ) THEN
-            DIM( 1 ) = MXREC + DCB_HEXT( IDCB )
+            INC = MAX( DCB_HEXT( IDCB ), MXREC / 2 )
+            DIM( 1 ) = MXREC + INC
             CALL DAT_ALTER( DCB_HRLOC( IDCB ), 1, DIM, STATUS )
          END IF
 
@@ -60,6 +60,8 @@ int main( int argc, char *argv[] ) {
 * History:
 *    30-SEP-1998 (RFWS):
 *       Original version, derived from the equivalent Fortran program.
+*    14-OCT-2026:
+*       Test the block iterator.
 *    <{enter_further_changes_here}>
 
 * Bugs:
@@ -77,12 +79,17 @@ int main( int argc, char *argv[] ) {
 
 /* Local Variables:                                                         */
    HDSLoc * xloc = NULL;         /* Locator of extension                    */
+   NdfIter *iter = NULL;         /* Block iterator                          */
    char form[30];                /* Storage form                            */
    char type[ 30 ];              /* Buffer for array data type              */
    int dim[ 2 ] = { 10, 20 };    /* NDF dimensions                          */
    int el;                       /* Number of mapped elements               */
    int i;                        /* Loop counter for array elements         */
    int indf;                     /* NDF identifier                          */
+   int bsum = 0;                 /* Sum of array elements over all blocks   */
+   int bel;                      /* Number of elements in a block           */
+   int blbnd[ 2 ];               /* Lower bounds of a block                 */
+   int bubnd[ 2 ];               /* Upper bounds of a block                 */
    int isum = 0;                 /* Sum of array elements                   */
    int itemp;                    /* Temporary integer                       */
    int lbnd[ 3 ] = { 1, 1, 1 };
@@ -178,6 +185,27 @@ int main( int argc, char *argv[] ) {
    if ( status == SAI__OK ) {
        for ( isum = 0, i = 0; i < el; i++ ) isum += ( (int *) pntr )[ i ];
    }
+   ndfUnmap( indf, "Data", &status );
+
+/* Sum the data elements again, stepping through the NDF in blocks of at    */
+/* most three rows.                                                         */
+   iter = ndfIterBegin( indf, "Data", "_integer", "read", 2,
+                        3*dim[ 0 ]*sizeof( int ), 1, &status );
+   while ( ndfIterNext( iter, &pntr, &bel, blbnd, bubnd, &status ) ) {
+      if ( bubnd[ 1 ] - blbnd[ 1 ] > 2 ) {
+         status = SAI__ERROR;
+         emsRep( "NDF_TEST_ERR2", "NDF_TEST_C: Block iterator returned a "
+                 "block that is too large.", &status );
+      } else {
+         for ( i = 0; i < bel; i++ ) bsum += ( (int *) pntr )[ i ];
+      }
+   }
+   ndfIterEnd( &iter, &status );
+   if ( status == SAI__OK && bsum != isum ) {
+      status = SAI__ERROR;
+      emsRep( "NDF_TEST_ERR2", "NDF_TEST_C: Block iterator sum is "
+              "incorrect.", &status );
+   }
 
 /* Get the value from the extension                                         */
    ndfXgt0i( indf, "TEST", "INT", &itemp, &status);
@@ -0,0 +1,395 @@
+#include <ctype.h>               /* Character class tests */
+#include <stdlib.h>              /* Utility functions */
+#include <string.h>              /* String handling */
+#include "sae_par.h"             /* Standard SAE constants */
+#include "ems.h"                 /* EMS_ error reporting routines */
+#include "star/hds.h"            /* HDS locators and datPrefetch */
+#include "ndf.h"                 /* NDF_ library public interface */
+
+/* Size of the buffers that hold the component list, type and mode. */
+#define NDF__SZITR 80
+
+/* The structure that describes the progress of a block iterator. The
+   type is declared (but not defined) in ndf.h. */
+struct NdfIter {
+   int indf;                     /* NDF being iterated over */
+   int isect;                    /* Section for the current block */
+   int ndim;                     /* Number of NDF dimensions */
+   int lbnd[ NDF__MXDIM ];       /* Lower bounds of the NDF */
+   int ubnd[ NDF__MXDIM ];       /* Upper bounds of the NDF */
+   int axis;                     /* Zero-based index of the blocking axis */
+   int step;                     /* Block thickness along the axis */
+   int next;                     /* Lower bound on "axis" of next block */
+   char comp[ NDF__SZITR + 1 ];  /* Components to map */
+   char type[ NDF__SZITR + 1 ];  /* Data type for access */
+   char mmod[ NDF__SZITR + 1 ];  /* Mapping mode */
+};
+
+/* Prototypes for local functions. */
+static size_t ndf1IterNbyte( const char *type, int *status );
+
+
+
+
+
+
+NdfIter *ndfIterBegin( int indf, const char *comp, const char *type,
+                       const char *mmod, int axis, size_t maxmem,
+                       int prefetch, int *status ) {
+/*
+*+
+*  Name:
+*     ndfIterBegin
+
+*  Purpose:
+*     Start iterating over an NDF in memory-bounded blocks.
+
+*  Language:
+*     ANSI C
+
+*  Invocation:
+*     iter = ndfIterBegin( indf, comp, type, mmod, axis, maxmem, prefetch,
+*                          status )
+
+*  Description:
+*     This function creates an iterator that steps through an NDF in
+*     contiguous slabs along a nominated pixel axis. Each slab covers
+*     the full extent of the NDF on all other axes, and is as thick as
+*     possible along the nominated axis without the mapped arrays for
+*     the slab exceeding "maxmem" bytes (but is always at least one pixel
+*     thick). Blocks are obtained and mapped in turn by calling
+*     ndfIterNext, and the iterator is released, unmapping the last
+*     block, by calling ndfIterEnd.
+*
+*     This allows an application to process NDFs that are too large to
+*     be mapped in full, without having to manage the sections itself.
+*     Choosing the last pixel axis gives blocks that are contiguous
+*     within the container file.
+
+*  Arguments:
+*     indf
+*        The NDF identifier. It must remain valid until ndfIterEnd is
+*        called.
+*     comp
+*        Name of the NDF array component(s) to be mapped for each block,
+*        as accepted by ndfMap (e.g. "Data" or "Data,Variance").
+*     type
+*        Numeric type to be used for access (e.g. "_REAL").
+*     mmod
+*        Mapping mode for access to each block: "READ", "UPDATE" or
+*        "WRITE", with an optional initialisation option as accepted by
+*        ndfMap.
+*     axis
+*        The one-based index of the pixel axis along which the NDF is to
+*        be divided into blocks.
+*     maxmem
+*        The maximum number of bytes to be mapped at once for all the
+*        mapped components of a block.
+*     prefetch
+*        If non-zero, and the mapping mode reads existing values, ask the
+*        operating system to start reading the NDF's container file in the
+*        background (see datPrefetch), so that later blocks are already in
+*        memory when they are mapped. This is best used for files that fit
+*        in the page cache.
+*     *status
+*        The global status.
+
+*  Returned Value:
+*     A pointer to the new iterator, which should be freed with ndfIterEnd.
+*     NULL is returned if an error occurs.
+
+*  Notes:
+*     - Values written to a block mapped for WRITE or UPDATE access are
+*     written back to the NDF when the next block is obtained, or when
+*     ndfIterEnd is called. The operating system then writes them to disk
+*     in the background while the next block is processed.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+
+*-
+*/
+
+/* Local Variables: */
+   HDSLoc *loc = NULL;           /* Locator for the NDF */
+   NdfIter *result = NULL;       /* Returned iterator */
+   const char *c;                /* Pointer to next character */
+   int i;                        /* Axis index */
+   int ncomp;                    /* Number of mapped components */
+   size_t nbyte;                 /* Bytes per mapped element */
+   size_t slab;                  /* Bytes in a single-pixel slab */
+
+/* Check inherited global status. */
+   if( *status != SAI__OK ) return result;
+
+/* Check that the supplied strings will fit in the iterator. */
+   if( strlen( comp ) > NDF__SZITR || strlen( type ) > NDF__SZITR ||
+       strlen( mmod ) > NDF__SZITR ) {
+      *status = NDF__FATIN;
+      emsRep( "NDF_ITERBEGIN_STR", "ndfIterBegin: Component list, type or "
+              "mapping mode is too long (possible programming error).",
+              status );
+      return result;
+   }
+
+/* Get the number of bytes per mapped element, and the number of
+   components to be mapped. */
+   nbyte = ndf1IterNbyte( type, status );
+   ncomp = 1;
+   for( c = comp; *c; c++ ) {
+      if( *c == ',' ) ncomp++;
+   }
+
+/* Allocate the iterator and get the NDF bounds. */
+   result = malloc( sizeof( *result ) );
+   if( !result ) {
+      if( *status == SAI__OK ) {
+         *status = NDF__NOMEM;
+         emsRep( "NDF_ITERBEGIN_MEM", "ndfIterBegin: Unable to allocate "
+                 "memory for an NDF block iterator.", status );
+      }
+      return result;
+   }
+   result->indf = indf;
+   result->isect = NDF__NOID;
+   strcpy( result->comp, comp );
+   strcpy( result->type, type );
+   strcpy( result->mmod, mmod );
+   ndfBound( indf, NDF__MXDIM, result->lbnd, result->ubnd, &result->ndim,
+             status );
+
+/* Check the axis index. */
+   if( *status == SAI__OK && ( axis < 1 || axis > result->ndim ) ) {
+      *status = NDF__AXNIN;
+      emsSeti( "AXIS", axis );
+      emsSeti( "NDIM", result->ndim );
+      emsRep( "NDF_ITERBEGIN_AXIS", "ndfIterBegin: Axis ^AXIS is invalid "
+              "for an NDF with ^NDIM dimensions (possible programming "
+              "error).", status );
+   }
+
+/* Find the block thickness. */
+   if( *status == SAI__OK ) {
+      result->axis = axis - 1;
+      slab = nbyte*ncomp;
+      for( i = 0; i < result->ndim; i++ ) {
+         if( i != result->axis ) {
+            slab *= result->ubnd[ i ] - result->lbnd[ i ] + 1;
+         }
+      }
+      result->step = ( slab > 0 ) ? maxmem/slab : 1;
+      if( result->step < 1 ) result->step = 1;
+      if( result->step > result->ubnd[ result->axis ] -
+                         result->lbnd[ result->axis ] + 1 ) {
+         result->step = result->ubnd[ result->axis ] -
+                        result->lbnd[ result->axis ] + 1;
+      }
+      result->next = result->lbnd[ result->axis ];
+
+/* If required, start reading the container file in the background. A
+   failure to do so does not matter, so any error is annulled. */
+      if( prefetch && toupper( mmod[ 0 ] ) != 'W' ) {
+         emsMark();
+         ndfLoc( indf, "READ", &loc, status );
+         datPrefetch( loc, status );
+         datAnnul( &loc, status );
+         if( *status != SAI__OK ) emsAnnul( status );
+         emsRlse();
+      }
+   }
+
+/* Free the iterator if an error occurred. */
+   if( *status != SAI__OK ) {
+      free( result );
+      result = NULL;
+   }
+
+   return result;
+}
+
+int ndfIterNext( NdfIter *iter, void *pntr[], int *el, int lbnd[],
+                 int ubnd[], int *status ) {
+/*
+*+
+*  Name:
+*     ndfIterNext
+
+*  Purpose:
+*     Map the next block of an NDF.
+
+*  Language:
+*     ANSI C
+
+*  Invocation:
+*     more = ndfIterNext( iter, pntr, el, lbnd, ubnd, status )
+
+*  Description:
+*     This function unmaps and releases the block returned by the
+*     previous call (if any), writing back any modified values, and then
+*     creates and maps a section of the NDF for the next block described
+*     by an iterator created by ndfIterBegin.
+
+*  Arguments:
+*     iter
+*        The iterator.
+*     pntr
+*        Returned holding pointers to the mapped values for each of the
+*        components listed when the iterator was created. The values are
+*        stored in Fortran order within the block.
+*     el
+*        Returned holding the number of elements mapped for each
+*        component.
+*     lbnd
+*        An array with at least as many elements as the NDF has
+*        dimensions, which is returned holding the lower pixel bounds of
+*        the block.
+*     ubnd
+*        An array which is returned holding the upper pixel bounds of the
+*        block.
+*     *status
+*        The global status.
+
+*  Returned Value:
+*     Non-zero if a new block was mapped, and zero if there are no more
+*     blocks or an error occurs.
+
+*-
+*/
+
+/* Local Variables: */
+   int i;                        /* Axis index */
+
+/* Release the previous block. This is done even if an error has already
+   occurred. */
+   if( iter && iter->isect != NDF__NOID ) ndfAnnul( &iter->isect, status );
+
+/* Check inherited global status. */
+   if( *status != SAI__OK || !iter ) return 0;
+
+/* Return zero if all blocks have been processed. */
+   if( iter->next > iter->ubnd[ iter->axis ] ) return 0;
+
+/* Get the bounds of the next block. */
+   for( i = 0; i < iter->ndim; i++ ) {
+      lbnd[ i ] = iter->lbnd[ i ];
+      ubnd[ i ] = iter->ubnd[ i ];
+   }
+   lbnd[ iter->axis ] = iter->next;
+   ubnd[ iter->axis ] = iter->next + iter->step - 1;
+   if( ubnd[ iter->axis ] > iter->ubnd[ iter->axis ] ) {
+      ubnd[ iter->axis ] = iter->ubnd[ iter->axis ];
+   }
+   iter->next = ubnd[ iter->axis ] + 1;
+
+/* Create and map a section for the block. */
+   ndfSect( iter->indf, iter->ndim, lbnd, ubnd, &iter->isect, status );
+   ndfMap( iter->isect, iter->comp, iter->type, iter->mmod, pntr, el,
+           status );
+
+   return ( *status == SAI__OK );
+}
+
+void ndfIterEnd( NdfIter **iter, int *status ) {
+/*
+*+
+*  Name:
+*     ndfIterEnd
+
+*  Purpose:
+*     Release an NDF block iterator.
+
+*  Language:
+*     ANSI C
+
+*  Invocation:
+*     ndfIterEnd( iter, status )
+
+*  Description:
+*     This function unmaps and releases any block that is still mapped,
+*     writing back any modified values, and frees an iterator created by
+*     ndfIterBegin. The NDF itself is not annulled. The function
+*     attempts to execute even if "status" is set on entry.
+
+*  Arguments:
+*     iter
+*        Address of the iterator pointer, which is returned set to NULL.
+*     *status
+*        The global status.
+
+*-
+*/
+
+   if( !iter || !*iter ) return;
+   if( (*iter)->isect != NDF__NOID ) ndfAnnul( &(*iter)->isect, status );
+   free( *iter );
+   *iter = NULL;
+}
+
+static size_t ndf1IterNbyte( const char *type, int *status ) {
+/*
+*  Name:
+*     ndf1IterNbyte
+
+*  Purpose:
+*     Get the number of bytes per element for a mapped NDF data type.
+
+*  Description:
+*     Complex types ("COMPLEX_<T>") count both the real and imaginary
+*     parts. An error is reported if the type is not recognised.
+*/
+
+/* Local Variables: */
+   char utype[ NDF__SZITR + 1 ];
+   int cmplx;
+   int i;
+   size_t result = 0;
+
+   if( *status != SAI__OK ) return result;
+
+   for( i = 0; type[ i ] && i < NDF__SZITR; i++ ) {
+      utype[ i ] = toupper( type[ i ] );
+   }
+   utype[ i ] = 0;
+
+   cmplx = !strncmp( utype, "COMPLEX", 7 );
+   if( cmplx ) memmove( utype, utype + 7, strlen( utype + 7 ) + 1 );
+
+   if( !strcmp( utype, "_DOUBLE" ) || !strcmp( utype, "_INT64" ) ) {
+      result = 8;
+   } else if( !strcmp( utype, "_REAL" ) || !strcmp( utype, "_INTEGER" ) ) {
+      result = 4;
+   } else if( !strcmp( utype, "_WORD" ) || !strcmp( utype, "_UWORD" ) ) {
+      result = 2;
+   } else if( !strcmp( utype, "_BYTE" ) || !strcmp( utype, "_UBYTE" ) ) {
+      result = 1;
+   } else {
+      *status = NDF__TYPIN;
+      emsSetc( "TYPE", type );
+      emsRep( "NDF_ITERBEGIN_TYPE", "ndfIterBegin: Invalid numeric type "
+              "'^TYPE' specified (possible programming error).", status );
+   }
+
+   if( cmplx ) result *= 2;
+   return result;
+}
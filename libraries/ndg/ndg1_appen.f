@@ -76,6 +76,9 @@
 *        If the template contains characters that are illegal within 
 *        a file name (as defined by thw wordexp function), then annul 
 *        the error and treat it like a simple case of "no matching NDFs".
+*     14-OCT-2026:
+*        Use NDG1_GLOB to expand simple templates within this process,
+*        only using ONE_WORDEXP_FILE for other templates.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -103,6 +106,7 @@
 *  Local Variables:
       CHARACTER FILE*(GRP__SZFNM) ! The file spec of the matching file
       INTEGER ICONTX             ! Context for psx_wordexp
+      LOGICAL DONE               ! Template expanded by NDG1_GLOB?
       LOGICAL FIRST              ! First time through if true
 *.
 
@@ -112,38 +116,47 @@
 *  Ignore blank templates.
       IF( TEMPLT .NE. ' ' ) THEN
 
+*  If the template contains only file names and simple wild-cards, find
+*  the matching files within this process.
+         CALL NDG1_GLOB( IGRP1, IGRP2, TEMPLT, REST, DONE, STATUS )
+
+*  Otherwise, use wordexp.
+         IF( .NOT. DONE ) THEN
+
 *  Initialise the context value used by PSX_WORDEXP so that a new file
 *  searching context will be started.
-         ICONTX = 0
-         FIRST = .TRUE.
+            ICONTX = 0
+            FIRST = .TRUE.
 
 *  Loop round looking for matching files until we get bad status
-         DO WHILE( STATUS .EQ. SAI__OK .AND.
-     :        ( FIRST .OR. ICONTX .NE. 0 ) )
+            DO WHILE( STATUS .EQ. SAI__OK .AND.
+     :           ( FIRST .OR. ICONTX .NE. 0 ) )
 
-            FIRST = .FALSE.
+               FIRST = .FALSE.
 
 *  Attempt to find the next matching file.
-            FILE = ' '
-            CALL ONE_WORDEXP_FILE( TEMPLT, ICONTX, FILE, STATUS )
+               FILE = ' '
+               CALL ONE_WORDEXP_FILE( TEMPLT, ICONTX, FILE, STATUS )
 
-            IF( FILE .NE. ' ' .AND. STATUS .EQ. SAI__OK ) THEN
+               IF( FILE .NE. ' ' .AND. STATUS .EQ. SAI__OK ) THEN
 
 *  Append it to the group.
-               CALL GRP_PUT( IGRP1, 1, FILE, 0, STATUS )
+                  CALL GRP_PUT( IGRP1, 1, FILE, 0, STATUS )
 
 *  Append a copy of REST to the second group.
-               CALL GRP_PUT( IGRP2, 1, REST, 0, STATUS )
+                  CALL GRP_PUT( IGRP2, 1, REST, 0, STATUS )
 
 *  If the error status indicates that the name contained some illegal
 *  characters, we probably have an HDS cell index. So annul the error and
 *  treat it like a simple case of "no matching NDFs".
-            ELSE IF( STATUS .EQ. PSX__BDCHR ) THEN
-               CALL ERR_ANNUL( STATUS )
-               ICONTX = 0
-            END IF
+               ELSE IF( STATUS .EQ. PSX__BDCHR ) THEN
+                  CALL ERR_ANNUL( STATUS )
+                  ICONTX = 0
+               END IF
+
+            END DO
 
-         END DO
+         END IF
 
       END IF
 
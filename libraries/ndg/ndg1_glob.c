@@ -0,0 +1,276 @@
+#include <glob.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "f77.h"
+#include "cnf.h"
+#include "mers.h"
+#include "sae_par.h"
+#include "star/grp.h"
+
+/* The smallest number of files for which the files are checked in
+   several threads. */
+#define NDG1__GLMIN 64
+
+/* The maximum number of threads used to check files. */
+#define NDG1__GLMXT 16
+
+/* Characters that are interpreted by wordexp in ways that are not
+   supported here. Templates containing any of these are expanded by
+   ONE_WORDEXP_FILE instead. */
+#define NDG1__GLSPC "$`'\"\\~{}()<>|&;#\n"
+
+/* Data passed to each thread that checks the matching files. */
+typedef struct Ndg1GlobData {
+   char **names;              /* The file names to check */
+   size_t lo;                 /* Index of first file to check */
+   size_t hi;                 /* Index of last file to check */
+   char *exists;              /* Returned flags: does each file exist? */
+} Ndg1GlobData;
+
+static void *ndg1GlobStat( void *data );
+
+F77_SUBROUTINE(ndg1_glob)( INTEGER(IGRP1), INTEGER(IGRP2),
+                           CHARACTER(TEMPLT), CHARACTER(REST),
+                           LOGICAL(DONE), INTEGER(STATUS)
+                           TRAIL(TEMPLT) TRAIL(REST) ){
+/*
+*+
+*  Name:
+*     NDG1_GLOB
+
+*  Purpose:
+*     Append matching files to a group without using wordexp.
+
+*  Language:
+*     ANSI C
+
+*  Invocation:
+*     CALL NDG1_GLOB( IGRP1, IGRP2, TEMPLT, REST, DONE, STATUS )
+
+*  Description:
+*     If the supplied template consists only of space separated file
+*     names and simple wild-card patterns ("*", "?" and "[...]"), then
+*     all existing files that match the template are appended to IGRP1,
+*     and DONE is returned .TRUE.. For each such file, a copy of REST is
+*     appended to IGRP2. The files are found in the same order as
+*     NDG1_APPEN would find them using ONE_WORDEXP_FILE, but the
+*     template is expanded within this process using glob, and the
+*     existence of the matching files is checked using several threads
+*     if there are many of them. This is much faster on file systems on
+*     which each file status request is slow.
+*
+*     If the template contains anything else that would be interpreted
+*     by wordexp (for instance shell variables, quotes, escaped spaces
+*     or command substitution), nothing is done and DONE is returned
+*     .FALSE.. The caller should then use ONE_WORDEXP_FILE instead.
+
+*  Arguments:
+*     IGRP1 = INTEGER (Given)
+*        The group to which the matching file names are appended.
+*     IGRP2 = INTEGER (Given)
+*        The group to which copies of REST are appended.
+*     TEMPLT = CHARACTER * ( * ) (Given)
+*        The file template.
+*     REST = CHARACTER * ( * ) (Given)
+*        The text to store in IGRP2 for each matching file.
+*     DONE = LOGICAL (Returned)
+*        Was the template expanded?
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful,but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+*/
+
+   GENPTR_INTEGER(IGRP1)
+   GENPTR_INTEGER(IGRP2)
+   GENPTR_CHARACTER(TEMPLT)
+   GENPTR_CHARACTER(REST)
+   GENPTR_LOGICAL(DONE)
+   GENPTR_INTEGER(STATUS)
+
+   Grp *igrp1;
+   Grp *igrp2;
+   Ndg1GlobData data[ NDG1__GLMXT ];
+   char **files;
+   char **rests;
+   char *exists;
+   char *rest;
+   char *templt;
+   char *word;
+   glob_t pglob;
+   int flags;
+   int gotglob;
+   int i;
+   int nthread;
+   int started[ NDG1__GLMXT ];
+   long ncpu;
+   pthread_t threads[ NDG1__GLMXT ];
+   size_t j;
+   size_t n;
+   size_t nfile;
+   size_t step;
+
+   *DONE = F77_FALSE;
+
+/* Check the global status. */
+   if( *STATUS != SAI__OK ) return;
+
+/* Get a null-terminated copy of the template, and return without action
+   if it contains anything other than file names and simple wild-cards. */
+   templt = malloc( TEMPLT_length + 1 );
+   if( !templt ) return;
+   cnfImprt( TEMPLT, TEMPLT_length, templt );
+   if( strpbrk( templt, NDG1__GLSPC ) ) {
+      free( templt );
+      return;
+   }
+
+/* Expand each space separated word in the template, appending the
+   results to a single list. An unmatched word is returned as supplied,
+   as is done by wordexp, and will be rejected below unless a file with
+   that name exists. Each list of matches is sorted. */
+   gotglob = 0;
+   flags = GLOB_NOCHECK;
+   for( word = strtok( templt, " \t" ); word; word = strtok( NULL, " \t" ) ) {
+      if( glob( word, flags, NULL, &pglob ) != 0 ) {
+         if( gotglob ) globfree( &pglob );
+         free( templt );
+         return;
+      }
+      gotglob = 1;
+      flags |= GLOB_APPEND;
+   }
+   free( templt );
+
+/* We now know the template will be expanded here. */
+   *DONE = F77_TRUE;
+   if( !gotglob ) return;
+   nfile = pglob.gl_pathc;
+
+/* Check which of the names refer to existing files. Divide the names
+   between several threads if there are many of them. The first block
+   of names is checked in the current thread. */
+   exists = calloc( nfile ? nfile : 1, 1 );
+   if( !exists ) {
+      *STATUS = SAI__ERROR;
+      errRep( " ", "NDG1_GLOB: Failed to allocate memory.", STATUS );
+      globfree( &pglob );
+      return;
+   }
+
+   nthread = 1;
+   if( nfile >= NDG1__GLMIN ) {
+      ncpu = sysconf( _SC_NPROCESSORS_ONLN );
+      nthread = ( ncpu > 1 ) ? (int) ncpu : 1;
+      if( nthread > NDG1__GLMXT ) nthread = NDG1__GLMXT;
+      if( (size_t) nthread > nfile/( NDG1__GLMIN/4 ) ) {
+         nthread = (int)( nfile/( NDG1__GLMIN/4 ) );
+      }
+   }
+
+   step = ( nfile + nthread - 1 )/nthread;
+   for( i = 0; i < nthread; i++ ) {
+      data[ i ].names = pglob.gl_pathv;
+      data[ i ].lo = i*step;
+      data[ i ].hi = ( i + 1 )*step;
+      if( data[ i ].hi > nfile ) data[ i ].hi = nfile;
+      data[ i ].exists = exists;
+      started[ i ] = 0;
+      if( i > 0 && data[ i ].lo < data[ i ].hi ) {
+         started[ i ] = !pthread_create( threads + i, NULL, ndg1GlobStat,
+                                         data + i );
+      }
+   }
+
+/* Check the first block, and any blocks for which a thread could not
+   be started, in this thread. Then wait for the other threads. */
+   for( i = 0; i < nthread; i++ ) {
+      if( !started[ i ] && data[ i ].lo < data[ i ].hi ) {
+         ndg1GlobStat( data + i );
+      }
+   }
+   for( i = 1; i < nthread; i++ ) {
+      if( started[ i ] ) pthread_join( threads[ i ], NULL );
+   }
+
+/* Count the names that refer to existing files. */
+   n = 0;
+   for( j = 0; j < nfile; j++ ) if( exists[ j ] ) n++;
+
+/* Append the existing files to IGRP1, retaining their order, and the
+   same number of copies of REST to IGRP2. */
+   if( n > 0 ) {
+      rest = malloc( REST_length + 1 );
+      files = malloc( n*sizeof( *files ) );
+      rests = malloc( n*sizeof( *rests ) );
+      if( rest && files && rests ) {
+         cnfImprt( REST, REST_length, rest );
+         n = 0;
+         for( j = 0; j < nfile; j++ ) {
+            if( exists[ j ] ) {
+               files[ n ] = pglob.gl_pathv[ j ];
+               rests[ n++ ] = rest;
+            }
+         }
+
+         igrp1 = grpF2C( *IGRP1, STATUS );
+         igrp2 = grpF2C( *IGRP2, STATUS );
+         grpPut( igrp1, n, files, 0, STATUS );
+         grpPut( igrp2, n, rests, 0, STATUS );
+
+      } else {
+         *STATUS = SAI__ERROR;
+         errRep( " ", "NDG1_GLOB: Failed to allocate memory.", STATUS );
+      }
+      free( rest );
+      free( files );
+      free( rests );
+   }
+
+   free( exists );
+   globfree( &pglob );
+}
+
+/* Set a flag for each of a range of names, indicating if a file with the
+   name exists. */
+static void *ndg1GlobStat( void *data ){
+   Ndg1GlobData *gdata = (Ndg1GlobData *) data;
+   struct stat buf;
+   size_t j;
+
+   for( j = gdata->lo; j < gdata->hi; j++ ) {
+      gdata->exists[ j ] = ( stat( gdata->names[ j ], &buf ) == 0 );
+   }
+   return NULL;
+}
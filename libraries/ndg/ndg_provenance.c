@@ -288,6 +288,10 @@
 *         special magic string to represent NULL pointers so that they
 *         can be distinguished from zero-length strings when being read
 *         back in again.
+*      14-OCT-2026:
+*         Modify ndgAddProv so that duplicated ancestors are purged once,
+*         after all the input NDFs have been added, rather than after
+*         each input NDF.
 */
 
 
@@ -504,6 +508,7 @@ static void ndg1Hout1( int, char *const[], int * );
 static void ndg1ParentChild( Prov *, Prov *, int, int * );
 static void ndg1ParentChildIndex( Provenance *, int, int, int, int * );
 static void ndg1PurgeProvenance( Provenance *, int * );
+static void ndg1PutProv( Provenance *, int, AstKeyMap *, int, int, int * );
 static void ndg1ReadHistRec( Prov *, int, int, int *, int * );
 static void ndg1ResetIndices( Provenance *, int * );
 static void ndg1Rmprv( Provenance *, int, int * );
@@ -1502,7 +1507,9 @@ void ndgAddProv( int indf, const char *creator, int nndf, int *ndfs,
 
 /* Local Variables: */
    NdgProvenance *prov;
+   Provenance *provenance;
    const char *autopv;
+   int *old_status;
    int i;
    int store;
 
@@ -1528,14 +1535,22 @@ void ndgAddProv( int indf, const char *creator, int nndf, int *ndfs,
       store = ( autopv != NULL );
 
 /* Loop round, adding each input NDF as an ancestor into the output
-   provenance info. */
-      for( i = 0; i < nndf; i++ ) {
-         ndgPutProv( prov, ndfs[ i ], NULL, 0, status );
+   provenance info. Duplicated ancestors are purged once, after all the
+   input NDFs have been added, rather than after each one, since each
+   purge involves sorting the entire list of ancestors. */
+      old_status = astWatch( status );
+      provenance = ndg1Decode( prov, "ndgAddProv", status );
+      if( provenance ) {
+         for( i = 0; i < nndf; i++ ) {
+            ndg1PutProv( provenance, ndfs[ i ], NULL, 0, 0, status );
 
 /* If any of the input NDFs contained explicit Provenance info then we
    must always store the output provenance. */
-         if( !store ) ndfXstat( ndfs[ i ], EXT_NAME, &store, status );
+            if( !store ) ndfXstat( ndfs[ i ], EXT_NAME, &store, status );
+         }
+         ndg1PurgeProvenance( provenance, status );
       }
+      astWatch( old_status );
 
 /* If autopv is set, or if any of the input NDFs had provenance info, write
    the provenance info back out to the output NDF. Ensure default NDF history
@@ -2439,16 +2454,8 @@ void ndgPutProv( NdgProvenance *prov, int indf, AstKeyMap *more, int isroot,
 */
 
 /* Local variables: */
-   Provenance *prov2 = NULL;
    Provenance *provenance = NULL;
    int *old_status;
-   int *ph;
-   int free_provs;
-   int hash;
-   int hhash;
-   int i;
-   int irec;
-   int there;
 
 /* Check the inherited status. */
    if( *status != SAI__OK ) return;
@@ -2457,83 +2464,10 @@ void ndgPutProv( NdgProvenance *prov, int indf, AstKeyMap *more, int isroot,
    old_status = astWatch( status );
 
 /* Decode the supplied identifier to obtain a pointer to a Provenance
-   structure. */
+   structure, and add the new ancestor into it, purging any duplicated
+   ancestors. */
    provenance = ndg1Decode( prov, "ndgPutProv", status );
-   if( provenance ) {
-
-/* Get the provenance information from the new ancestor NDF. */
-      prov2 = ndg1ReadProvenanceNDF( indf, more, NULL, isroot, status );
-
-/* Indicate that the "Prov" structures referred to by prov2 should be
-   freed when ndgFreeProvenance is called. */
-      free_provs = 1;
-
-/* Extend the "provs" list in "provenance" so that we can add pointers to
-   all the Prov structures in "prov2. */
-      if( provenance && prov2 ) {
-         provenance->provs = astGrow( provenance->provs,
-                                      provenance->nprov + prov2->nprov,
-                                      sizeof( Prov *) );
-      }
-      if( astOK ) {
-
-/* Copy history records from the NDF HISTORY component into the main
-   Prov structure in "prov2". We do not copy records that were
-   propagated to the NDF from input NDFs since such records will already
-   be present in the other Prov structures in "prov2". Thus, the only
-   records copied are those that describe modifications that have been
-   made to the NDF since it was created (e.g. changing a WCS attribute,
-   changing a value in the FITS extension, etc), plus the record that
-   describes the creation of the NDF. So we work backwards through the
-   HISTORY component, from youngest to oldest history record, until the
-   record is reached that describes the creation of the NDF (as
-   indicated by the fact that its hash code matches the hash code
-   stored when provenance information was added to the NDF, i.e. at
-   its creation). Each such record (including the final one) is coped
-   into the Prov structure. We copy *all* history records if the NDF is
-   to be treated as a root ndf. We copy *no* records if the main ndf has
-   no hash code. */
-         ndfState( indf, "History", &there, status );
-         hhash = prov2->main->hhash;
-         if( there && ( hhash || isroot ) ) {
-            ndfHnrec( indf, &irec, status );
-            ph = isroot ? NULL : &hash;
-            prov2->main->hhash = 0;
-
-            for( ; irec > 0; irec-- ) {
-               ndg1ReadHistRec( prov2->main, indf, irec, ph, status );
-               if( ph && *ph == hhash ) break;
-            }
-         }
-
-/* Copy the Prov pointers from "prov2" to "provenance". */
-         for( i = 0; i < prov2->nprov; i++ ) {
-            provenance->provs[ i + provenance->nprov ] = prov2->provs[ i ];
-         }
-
-/* Update the length of the "provs" array in "provenance". */
-         provenance->nprov += prov2->nprov;
-
-/* Indicate that the "Prov" structures referred to by "prov2" should not
-   be freed when ndgFreeProvenance is called. This is because they are
-   now the responsibility of "provenance", having been copied into the
-   provenance->provs list above. */
-         free_provs = 0;
-
-/* Indicate that the indices of the parents of each prov structure needs
-   to be re-calculated to take account of the addition of the new ancestors. */
-         ndg1ResetIndices( provenance, status );
-
-/* Record the new ancestor NDF as a parent of the main NDF. */
-         ndg1ParentChild( prov2->main, provenance->main, 1, status );
-
-/* Purge any duplicate entries in the extended provenance information. */
-         ndg1PurgeProvenance( provenance, status );
-      }
-
-/* Free the provenance structure for the new ancestor NDF. */
-      ndg1FreeProvenance( prov2, free_provs, status );
-   }
+   if( provenance ) ndg1PutProv( provenance, indf, more, isroot, 1, status );
 
 /* Re-instate the original AST status variable. */
    astWatch( old_status );
@@ -6176,6 +6110,139 @@ static void ndg1PurgeProvenance( Provenance *provenance,
 
 }
 
+static void ndg1PutProv( Provenance *provenance, int indf, AstKeyMap *more,
+                         int isroot, int purge, int *status ){
+/*
+*  Name:
+*     ndg1PutProv
+
+*  Purpose:
+*     Add an NDF to the list of ancestors in a Provenance structure.
+
+*  Invocation:
+*     void ndg1PutProv( Provenance *provenance, int indf, AstKeyMap *more,
+*                       int isroot, int purge, int *status )
+
+*  Description:
+*     This function does the work for ndgPutProv. It reads the provenance
+*     information from the supplied NDF and adds it into the supplied
+*     Provenance structure, recording the NDF as a parent of the main NDF.
+*
+*     Purging duplicated ancestors involves sorting the whole list of
+*     ancestors, and so can take a significant time if there are many
+*     ancestors. When adding many NDFs at once, the purge can instead be
+*     performed once, by calling ndg1PurgeProvenance after all NDFs have
+*     been added.
+
+*  Arguments:
+*     provenance
+*        Pointer to the structure holding the provenance information to
+*        be extended.
+*     indf
+*        An identifier for an NDF that is to be added into the list of
+*        ancestor NDFs.
+*     more
+*        A pointer to an AstKeyMap holding arbitrary additional information
+*        about the new ancestor NDF. May be NULL.
+*     isroot
+*        If non-zero, then the new ancestor NDF will be treated as a root
+*        NDF (see ndgPutProv).
+*     purge
+*        If non-zero, duplicated ancestors are purged from "provenance"
+*        before returning. Otherwise, the caller should call
+*        ndg1PurgeProvenance before the Provenance is used.
+*     status
+*        The global status.
+*/
+
+/* Local variables: */
+   Provenance *prov2 = NULL;
+   int *ph;
+   int free_provs;
+   int hash;
+   int hhash;
+   int i;
+   int irec;
+   int there;
+
+/* Check the inherited status. */
+   if( *status != SAI__OK ) return;
+
+/* Get the provenance information from the new ancestor NDF. */
+   prov2 = ndg1ReadProvenanceNDF( indf, more, NULL, isroot, status );
+
+/* Indicate that the "Prov" structures referred to by prov2 should be
+   freed when ndgFreeProvenance is called. */
+   free_provs = 1;
+
+/* Extend the "provs" list in "provenance" so that we can add pointers to
+   all the Prov structures in "prov2. */
+   if( provenance && prov2 ) {
+      provenance->provs = astGrow( provenance->provs,
+                                   provenance->nprov + prov2->nprov,
+                                   sizeof( Prov *) );
+   }
+   if( astOK ) {
+
+/* Copy history records from the NDF HISTORY component into the main
+   Prov structure in "prov2". We do not copy records that were
+   propagated to the NDF from input NDFs since such records will already
+   be present in the other Prov structures in "prov2". Thus, the only
+   records copied are those that describe modifications that have been
+   made to the NDF since it was created (e.g. changing a WCS attribute,
+   changing a value in the FITS extension, etc), plus the record that
+   describes the creation of the NDF. So we work backwards through the
+   HISTORY component, from youngest to oldest history record, until the
+   record is reached that describes the creation of the NDF (as
+   indicated by the fact that its hash code matches the hash code
+   stored when provenance information was added to the NDF, i.e. at
+   its creation). Each such record (including the final one) is coped
+   into the Prov structure. We copy *all* history records if the NDF is
+   to be treated as a root ndf. We copy *no* records if the main ndf has
+   no hash code. */
+      ndfState( indf, "History", &there, status );
+      hhash = prov2->main->hhash;
+      if( there && ( hhash || isroot ) ) {
+         ndfHnrec( indf, &irec, status );
+         ph = isroot ? NULL : &hash;
+         prov2->main->hhash = 0;
+
+         for( ; irec > 0; irec-- ) {
+            ndg1ReadHistRec( prov2->main, indf, irec, ph, status );
+            if( ph && *ph == hhash ) break;
+         }
+      }
+
+/* Copy the Prov pointers from "prov2" to "provenance". */
+      for( i = 0; i < prov2->nprov; i++ ) {
+         provenance->provs[ i + provenance->nprov ] = prov2->provs[ i ];
+      }
+
+/* Update the length of the "provs" array in "provenance". */
+      provenance->nprov += prov2->nprov;
+
+/* Indicate that the "Prov" structures referred to by "prov2" should not
+   be freed when ndgFreeProvenance is called. This is because they are
+   now the responsibility of "provenance", having been copied into the
+   provenance->provs list above. */
+      free_provs = 0;
+
+/* Indicate that the indices of the parents of each prov structure needs
+   to be re-calculated to take account of the addition of the new ancestors. */
+      ndg1ResetIndices( provenance, status );
+
+/* Record the new ancestor NDF as a parent of the main NDF. */
+      ndg1ParentChild( prov2->main, provenance->main, 1, status );
+
+/* Purge any duplicate entries in the extended provenance information,
+   if required. */
+      if( purge ) ndg1PurgeProvenance( provenance, status );
+   }
+
+/* Free the provenance structure for the new ancestor NDF. */
+   ndg1FreeProvenance( prov2, free_provs, status );
+}
+
 static void ndg1ReadHistRec( Prov *prov, int indf, int irec, int *hash,
                              int *status ){
 /*
@@ -54,8 +54,6 @@
 *        -  SAI__OK for success
 *        -  ONE__NOFILES - No more files found
 *        -  ONE__LENGTHERR - Bad parameter length
-*        -  ONE__PIPEERR  - Pipe error
-*        -  ONE__EXECERROR - Error in fork/exec
 *        -  ONE__MALLOCERR - Malloc error
 *
 *  Returned Value:
@@ -67,6 +65,7 @@
 *     Copyright (C) 1992, 1993 Science & Engineering Research Council.
 *     Copyright (C) 1995, 2000, 2004 Central Laboratory of the Research Councils.
 *     Copyright (C) 2005, 2006 Particle Physics & Astronomy Research Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -103,31 +102,23 @@
 *      is no way of specifying recursion; '/usr/user/ks/...' for example
 *      is meaningless. Nevertheless, it is hoped that it is close enough in
 *      functionality to the VMS original to act as a useable substitute in
-*      most cases. It cannot handle specifications that the standard shell
-*      (sh) cannot handle in an 'ls' command - there are some variations of
-*      the 'ls' command involving complex wildcarding that will cause sh
-*      on a SUN to hang, and they will also hang this routine.
-*
-*      It is not at all clear that the method used here is  in any way
-*      the best solution to the problem, and there are a number of possible
-*      alternatives that could be tried, including using 'find' rather than
-*      'ls', or using routines such as readdir() to search the file system
-*      and do any pattern matching in this routine itself. The program as it
-*      stands should be regarded (tolerantly!) as an initial attempt and
-*      the author would be glad to be sent a better version.
+*      most cases. Specifications containing characters that wordexp(3)
+*      rejects (such as unquoted '|', ';' or '{') match no files.
 *
 *  Algorithm:
-*      The routine works by forking off a process that runs an 'ls Filespec'
-*      command and reads the output from that process through a pipe. Each
-*      line read will normally contain a file name and that is returned.
-*      The main complication comes from file specifications such as '*'
-*      for which 'ls' will list both normal files and the contents of all
-*      directories, including in its output both blank lines and the names
-*      of the directories.  The routine traps such directory names and
-*      remembers them and prefixes them to the subsequent filenames.
-*      Context is used as the address of a structure containing things that
-*      need to be remembered across calls, such as file descriptors and
-*      the last directory specification.
+*      On the first call the file specification is expanded in-process
+*      using wordexp(3), which performs the same tilde, variable and
+*      wildcard expansion as the shell. The resulting words are then
+*      arranged in the order that the command 'ls Filespec' (or
+*      'ls -d Filespec') would list them: first any words that are not
+*      directories, sorted, and then, if LisDir is true, the sorted
+*      contents (excluding names starting with '.') of each directory,
+*      each prefixed with the directory name unless it was the only
+*      word. Directories are read with readdir(3). The complete list is
+*      held in a structure whose address is returned in Context, and
+*      successive calls step through it. Earlier versions forked a
+*      shell to run 'ls' and read its output through a pipe, which was
+*      expensive for processes with large address spaces.
 *
 *
 *  Notes:
@@ -195,10 +186,14 @@
 *         Use cnfExprt rather than hand-rolled padding of strings
 *      19-APR-2006 (TIMJ):
 *         Use starmem
+*      14-OCT-2026:
+*         Expand the file specification in-process using wordexp and
+*         readdir rather than forking a shell to run 'ls'.
 
 *-
  */
 
+
 /* Note that return codes used to be chosen as much as possible to duplicate
    the effect of the VMS routine that this is based on. This is no longer
    the case since it now seems more sensible for people to use MSG generated
@@ -210,57 +205,17 @@
 
 #define TRUE 1                /* Standard truth value */
 #define FALSE 0               /* Standard false value */
-#define DIRECTORY_LEN 256     /* Number of characters allowed for directory */
-#define LINE_LEN 512          /* Length of returned line */
-
-/*  Structures used:
- *
- *  A ContextStruct is used to maintain the context of a given series of
- *  calls to this routine.  It contains the two file descriptors used
- *  for the pipe that reads from the 'ls' process, and the string used
- *  to remember any directory specification output by the 'ls' process,
- *  when a number of directories are being listed.  One of these is
- *  allocated when Context is passed as zero, and its address is then
- *  the quantity returned in Context.
- */
-
-typedef struct ContextStruct {
-    int Fds[2];                 /* Input and output file descriptors
-                                   for the pipe */
-    char Directory[DIRECTORY_LEN];
-                                /* Last directory spec output by 'ls'
-                                   process */
-    int ls_pid;                 /* pid of child process */
-} ContextStruct;
 
 #if HAVE_CONFIG_H
 #  include <config.h>
 #endif
 
-#include <fcntl.h>
 #include <stdio.h>
-
-#if HAVE_UNISTD_H
-#include <unistd.h>
-#endif
-
-/* The following should be defined by unistd.h, but be defensive */
-#ifndef STDIN_FILENO
-#define STDIN_FILENO 0
-#endif
-#ifndef STDOUT_FILENO
-#define STDOUT_FILENO 1
-#endif
-#ifndef STDERR_FILENO
-#define STDERR_FILENO 2
-#endif
-
-#if HAVE_SYS_WAIT_H
-#include <sys/wait.h>
-#endif
-#ifndef WIFEXITED
-#define WIFEXITED(stat_val) (((stat_val) & 255) == 0)
-#endif
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <wordexp.h>
 
 #if STDC_HEADERS
 #  include <string.h>
@@ -274,6 +229,36 @@ typedef struct ContextStruct {
 #include "sae_par.h"
 #include "star/mem.h"
 
+/*  Structures used:
+ *
+ *  A ContextStruct is used to maintain the context of a given series of
+ *  calls to this routine.  It contains the full list of matching file
+ *  names, in the order in which 'ls' would list them, and the index of
+ *  the next one to be returned. It also records whether any part of the
+ *  specification could not be expanded or listed, which is the case in
+ *  which 'ls' would have exited with bad status. One of these is
+ *  allocated when Context is passed as zero, and its address is then
+ *  the quantity returned in Context.
+ */
+
+typedef struct ContextStruct {
+    char **Names;               /* Matching file names */
+    size_t NNames;              /* Number of names in Names */
+    size_t NAlloc;              /* Number of elements allocated for Names */
+    size_t Next;                /* Index of the next name to return */
+    int Failed;                 /* Did any part of the expansion fail? */
+} ContextStruct;
+
+/*  Prototypes for internal functions. */
+
+static int one1_addname( ContextStruct *ContextPtr, const char *Prefix,
+                         const char *Name );
+static int one1_compare( const void *a, const void *b );
+static int one1_expand( ContextStruct *ContextPtr, const char *Spec,
+                        int LisDir );
+static int one1_listdir( ContextStruct *ContextPtr, const char *Dir,
+                         const char *Prefix );
+
 F77_INTEGER_FUNCTION(one_find_file)( CHARACTER(FileSpec), LOGICAL(LisDir),
                         CHARACTER(FileName), POINTER(Context), INTEGER(Status)
                          TRAIL(FileSpec) TRAIL(FileName) )
@@ -288,178 +273,65 @@ F77_INTEGER_FUNCTION(one_find_file)( CHARACTER(FileSpec), LOGICAL(LisDir),
 
    /*  Local variables  */
 
-   int SpecLength;                /* Number of bytes in FileSpec - FileSpec_length*/
    int NameLength;                /* Number of bytes in FileName - FileName_length*/
 
-   int Bytes;            /* Number of bytes read from pipe */
-   char Char;            /* Byte read from pipe */
-   int ColonIndex;       /* Index in Line of last colon */
    ContextStruct *ContextPtr; /* Pointer to current context information */
-   char *Command;        /* 'ls' command executed */
-   int *Fdptr;           /* Pointer to array of two integer file descriptors */
-   int GotFileName;      /* Used to control loop reading lines from 'ls' */
-   int Ichar;            /* Index into FileName for next character */
-   char LastChar;        /* Last non-blank char read in line */
-   char Line[LINE_LEN];  /* String into which line is read */
-   int Nchars;           /* Maximum number of chars that can be copied */
-   int NullFd;           /* File descriptor for the null device */
-   char *PointFSpec;     /* Local copy of FileSpec          */
-   int STATUS;           /* Local fork STATUS */
+   int GotFileName;      /* Was a file name returned? */
+   char *Spec;           /* Null terminated copy of FileSpec */
 
    /*  Start off by checking for good status  */
 
    if ( *Status != SAI__OK ) return FALSE;
 
-   ColonIndex = 0;
-
    /*  No file specification so nothing to do */
    if ( FileSpec == NULL ) return FALSE;
 
-   /*
-      Set input string lengths to those returned by CNF.
-   */
-
-   SpecLength = FileSpec_length;
    NameLength = FileName_length;
-   PointFSpec = FileSpec;
+
    /*
       Set return value to File not found.
    */
    GotFileName = FALSE;
 
    /*  The first time through for a new file specification, Context will
-    *  be zero.  In this case we allocate ourselves enough space for the
-    *  context structure we will use and use Context to hold its address.
-    *  We initialise the directory specification in the context to null.
+    *  be zero.  In this case we allocate ourselves the context structure
+    *  we will use and use Context to hold its address. We then expand
+    *  the file specification into the complete list of matching names.
     */
 
    if (*Context == 0) {
 
-       /* FIXME: explain why malloc 2*sizeof()? */
-      ContextPtr = (ContextStruct *) cnfMalloc(2 * sizeof(ContextStruct));
+      ContextPtr = (ContextStruct *) cnfMalloc(sizeof(ContextStruct));
       if ( ContextPtr == NULL ) {
          *Status = ONE__MALLOCERR;
 	 emsRep("one_find_file","Unable to allocate memory for context struct",
 		Status);
       } else {
-         Fdptr = ContextPtr->Fds;
-         ContextPtr->Directory[0] = '\0';
-         ContextPtr->ls_pid = 0; /* safe value, tested for in find_file_end */
-
-         /*  Fdptr now points to an array of two ints, which we will use
-          *  as the two file descriptors of a pipe which we now create.
-          */
-
-         if (pipe(Fdptr) < 0) {
-            *Status = ONE__PIPEERR;
-	    emsRep("one_find_file","Error from pipe",Status);
-         } else {
-
-            /* Allocate enough room for the eventual ls command string */
-            Command = (char *) starMalloc( SpecLength + 10 );
-
-            /*  Fdptr[0] can now be used as the reading end of the pipe,
-             *  and Fdptr[1] as the writing end.  Having that, we now
-             *  fork off a new process to do the 'ls' command that we
-             *  will use to give us the filenames we want.
-             */
-
-            STATUS = fork();
-            if (STATUS < 0) {
-
-                /* error: unable to fork */
-                *Status = ONE__EXECERROR;
-		emsRep("one_find_file","Unable to fork", Status);
-
-            } else if (STATUS == 0) {
-
-                /*  This is the child process in which we will exec
-                 *  `ls'.  Copy the filespec from the PointFSpec
-                 *  pointer that we have been passed, remembering that
-                 *  this is a string from a Fortran program, and so is
-                 *  blank padded rather than null terminated.
-                 */
-
-                /* SpecLength is the total length of FileSpec,
-                   including trailing blanks */
-                /* Add -d to ls if we are not listing directory contents */
-
-	        (void) strcpy( Command, "ls " );
-		if ( F77_ISFALSE( *LisDir ) ) {
-		  strcat( Command, "-d " );
-		}
-	        (void) strncat( Command, FileSpec, SpecLength );
-
-               /*  Now we arrange things so that the 'ls' command will
-                *  send its output back down our pipe.  We want to redirect
-                *  our current standard output to the writing end of the
-                *  pipe.  This is a standard UNIX technique.
-                */
-
-               (void) close(Fdptr[0]);  /* Don't need to read from pipe */
-               if (Fdptr[1] != STDOUT_FILENO) {
-                   /* Close stdout (not generally necessary, but
-                      required by Single Unix spec) */
-                   close(STDOUT_FILENO);
-                   dup2(Fdptr[1], STDOUT_FILENO);
-                   close(Fdptr[1]);  /* Pipe write fd no longer needed */
-               }
-
-               /*  We're going to ignore any error messages from 'ls', so
-                *  we do the same trick for standard error, this time using
-                *  a file descriptor opened on the null device. This has the
-                *  effect of nulling any error messages.
-                */
-
-	       NullFd = open("/dev/null",O_WRONLY,0);
-               (void) close(STDERR_FILENO);
-               (void) dup2(NullFd, STDERR_FILENO);
-               (void) close(NullFd);
-
-               /*  And now we exec the "ls filespec" command.  This
-                *  will write the set of files to our pipe, and the process
-                *  will close down when all the files are listed.
-		*  Note that we do not call ls directly since we require
-		*  the shell to expand our wildcard string.
-                */
-
-	       execl( "/bin/sh", "sh", "-c", Command, NULL);
-
-               /* We shouldn't get here -- exit without calling exit
-                  handlers or flushing and closing output */
-               _exit (errno);
-
-            } else {
-                /* Save the pid of the child */
-                ContextPtr->ls_pid = STATUS;
-
-               /*  This is the parent process, continuing after forking off
-                *  the 'ls' command. Here we set Context to be the address
-                *  of the pair of file descriptors being used for the pipe.
-                *  and carry on. We don't need the output fd for the pipe,
-                *  so we close that.
-                */
-
-               (void) close (Fdptr[1]);
-	       *Context = cnfFptr( ContextPtr );
-	       starFree( Command );
-            }
+         ContextPtr->Names = NULL;
+         ContextPtr->NNames = 0;
+         ContextPtr->NAlloc = 0;
+         ContextPtr->Next = 0;
+         ContextPtr->Failed = FALSE;
+	 *Context = cnfFptr( ContextPtr );
+
+         /*  Import the Fortran string, removing trailing blanks. */
+
+         Spec = cnfCreim( FileSpec, FileSpec_length );
+         if ( Spec == NULL || !one1_expand( ContextPtr, Spec,
+                                            F77_ISTRUE( *LisDir ) ) ) {
+            *Status = ONE__MALLOCERR;
+            emsRep("one_find_file","Unable to allocate memory for file names",
+                   Status);
          }
+         if ( Spec ) cnfFree( Spec );
       }
    }
 
    /*  At this point, if status still indicates OK, Context points to
-    *  a context structure containing a directory specification and two
-    *  file descriptors, the first of which is that of the reading end of
-    *  the pipe to which our forked 'ls' process is writing a set of file
-    *  names. Each name will be terminated by a newline, so we just read
-    *  a character at a time from the pipe until such a newline indicates
-    *  that we have a complete filename. A read of zero bytes indicates
-    *  that all the filenames have been listed.
+    *  a context structure containing the list of matching names. Return
+    *  the next one, or report that there are no more.
     */
 
-   ContextPtr = (ContextStruct *) cnfCptr( *Context );
-   Fdptr = ContextPtr->Fds;
    if (*Status != SAI__OK) {
        /* Do nothing */
    } else if (NameLength < 1) {
@@ -467,93 +339,192 @@ F77_INTEGER_FUNCTION(one_find_file)( CHARACTER(FileSpec), LOGICAL(LisDir),
       emsRep("one_find_file","Length of name less than 1",
 	     Status);
    } else {
+      ContextPtr = (ContextStruct *) cnfCptr( *Context );
+      if (ContextPtr->Next >= ContextPtr->NNames) {
+         *Status = ONE__NOFILES;
+         emsRep("one_find_file","No more files found for this search",
+                Status);
+      } else {
 
-      /*  The following loop continues until we have a filename read from the
-       *  pipe or until the pipe is empty.  'ls' can produce lines that are not
-       *  simple filenames; if multiple directories are being listed, it will
-       *  separate them with blank lines and will precede each with the
-       *  directory name, ending with a colon.  These have to be trapped.
-       */
-
-      GotFileName = FALSE;
-      while (!GotFileName) {
-
-         /*  This loop reads a line of characters from the pipe. */
-
-         Ichar = 0;
-         LastChar = ' ';
-         for (;;) {
-            Bytes = read (Fdptr[0],&Char,1);
-            if (Bytes <= 0) {
-               *Status = ONE__NOFILES;
-	       emsRep("one_find_file","No more files found for this search",
-		      Status);
-               break;
-            }
-            if (Char == '\n') {
-               if (Ichar < sizeof(Line)) Line[Ichar] = '\0';
-               else Line[sizeof(Line) - 1] = '\0';
-               break;
-            } else {
-               if (Char != ' ') LastChar = Char;
-               if (Char == ':') ColonIndex = Ichar;
-               if (Ichar < sizeof(Line)) Line[Ichar++] = Char;
-            }
-         }
-
-         /*  At the end of the loop, LastChar contains the last non-blank
-          *  character in the line.  If this is blank, we have a blank line
-          *  which we ignore.  If it was ':' we have a directory name that
-          *  we should remember, but we still need a filename.  If status is
-          *  bad, we have reached the end of the 'ls' output.
+         /*  Return the name in FileName, making sure it's properly
+          *  terminated and being very careful not to exceed its length,
+          *  and then, remembering that this is a Fortran character
+          *  string, blank pad it properly, overwriting the last NULL.
           */
 
-         if (*Status != SAI__OK) break;
-         if (LastChar != ' ') {
-            if (LastChar == ':') {
-
-               /*  It was a directory spec, so save it in the currrent
-                *  context -  replacing the ':' with a '/' and terminating
-                *  it at that point with a null. ColonIndex will tell us
-                *  where the last colon was.
-                */
-
-               if (ColonIndex < (sizeof(Line) - 1)) {
-                  Line[ColonIndex] = '/';
-                  Line[ColonIndex + 1] = '\0';
-               }
-               (void) strncpy(ContextPtr->Directory,Line,DIRECTORY_LEN);
-               ContextPtr->Directory[DIRECTORY_LEN - 1] = '\0';
-
-            } else {
-
-               /*  It was an ordinary file name, so combine it with any
-                *  directory spec we may have in the context, and return it
-                *  in FileName, making sure it's properly terminated and being
-                *  very careful not to excede its length.
-                */
-
-               GotFileName = TRUE;
-               (void) strncpy(FileName,ContextPtr->Directory,NameLength);
-               FileName[NameLength - 1] = '\0';
-               Nchars = NameLength - strlen(FileName);
-               (void) strncat(FileName,Line,Nchars); /* remove NameLength   */
-						     /*	as third argument   */
-						     /*	in this list	    */
-               FileName[NameLength - 1] = '\0';
-
-               /*  And, remembering that this is a Fortran character string,
-                *  blank pad it properly. Overwriting the last NULL.
-                */
-
-	       cnfExprt( FileName, FileName, NameLength );
-            }
+         GotFileName = TRUE;
+         (void) strncpy(FileName,ContextPtr->Names[ContextPtr->Next++],
+                        NameLength);
+         FileName[NameLength - 1] = '\0';
+	 cnfExprt( FileName, FileName, NameLength );
+      }
+   }
+
+   return (GotFileName);
+}
+
+/*  Append Prefix followed by Name to the list of names in the context.
+ *  Returns FALSE if memory could not be allocated.
+ */
+
+static int one1_addname( ContextStruct *ContextPtr, const char *Prefix,
+                         const char *Name ) {
+   char **Names;           /* Extended list of names */
+   char *NewName;          /* Copy of the name */
+   size_t Length;          /* Length of Prefix */
+
+   if (ContextPtr->NNames == ContextPtr->NAlloc) {
+      ContextPtr->NAlloc = ContextPtr->NAlloc ? 2*ContextPtr->NAlloc : 32;
+      Names = (char **) starRealloc( ContextPtr->Names,
+                                     ContextPtr->NAlloc * sizeof(char *) );
+      if (Names == NULL) return FALSE;
+      ContextPtr->Names = Names;
+   }
+
+   Length = strlen( Prefix );
+   NewName = (char *) starMallocAtomic( Length + strlen( Name ) + 1 );
+   if (NewName == NULL) return FALSE;
+   (void) strcpy( NewName, Prefix );
+   (void) strcpy( NewName + Length, Name );
+   ContextPtr->Names[ContextPtr->NNames++] = NewName;
+   return TRUE;
+}
+
+/*  qsort comparison function that orders names in the same way as 'ls'. */
+
+static int one1_compare( const void *a, const void *b ) {
+   return strcoll( *(char * const *) a, *(char * const *) b );
+}
+
+/*  Expand the file specification Spec into the list of names held in the
+ *  context, in the order in which 'ls Spec' (or 'ls -d Spec' if LisDir
+ *  is false) would list them. Returns FALSE if memory could not be
+ *  allocated, and sets the Failed flag in the context if any word could
+ *  not be expanded or does not exist.
+ */
+
+static int one1_expand( ContextStruct *ContextPtr, const char *Spec,
+                        int LisDir ) {
+   wordexp_t WordExp;      /* Results from wordexp */
+   struct stat Stat;       /* File information for each word */
+   char **Dirs = NULL;     /* Words that are directories to be listed */
+   char **Files = NULL;    /* Words that are to be listed themselves */
+   char *Prefix;           /* Prefix for names within a directory */
+   size_t NDirs = 0;       /* Number of directories */
+   size_t NFiles = 0;      /* Number of files */
+   size_t Iword;           /* Index of current word */
+   int Ok = TRUE;          /* Returned value */
+   int Retval;             /* Value returned by wordexp */
+
+   Retval = wordexp( Spec, &WordExp, 0 );
+   if (Retval != 0) {
+      if (Retval == WRDE_NOSPACE) {
+         wordfree( &WordExp );
+         return FALSE;
+      }
+      ContextPtr->Failed = TRUE;
+      return TRUE;
+   }
+
+   /*  With no words, 'ls' lists the current directory. */
+
+   if (WordExp.we_wordc == 0) {
+      if (LisDir) {
+         Ok = one1_listdir( ContextPtr, ".", "" );
+      } else {
+         Ok = one1_addname( ContextPtr, "", "." );
+      }
+      wordfree( &WordExp );
+      return Ok;
+   }
+
+   /*  Separate the words into those that are listed directly and the
+    *  directories whose contents are listed. Words that do not exist are
+    *  not listed, but cause 'ls' to fail.
+    */
+
+   Files = (char **) starMalloc( WordExp.we_wordc * sizeof(char *) );
+   Dirs = (char **) starMalloc( WordExp.we_wordc * sizeof(char *) );
+   if (Files == NULL || Dirs == NULL) Ok = FALSE;
+
+   for (Iword = 0; Ok && Iword < WordExp.we_wordc; Iword++) {
+      if (stat( WordExp.we_wordv[Iword], &Stat ) != 0) {
+         ContextPtr->Failed = TRUE;
+      } else if (LisDir && S_ISDIR( Stat.st_mode )) {
+         Dirs[NDirs++] = WordExp.we_wordv[Iword];
+      } else {
+         Files[NFiles++] = WordExp.we_wordv[Iword];
+      }
+   }
+
+   /*  List the files first, then the contents of each directory. The
+    *  directory name is output by 'ls' as a header (and so used as a
+    *  prefix here) unless the specification expanded to a single word.
+    */
+
+   if (Ok) {
+      qsort( Files, NFiles, sizeof(char *), one1_compare );
+      qsort( Dirs, NDirs, sizeof(char *), one1_compare );
+   }
+
+   for (Iword = 0; Ok && Iword < NFiles; Iword++) {
+      Ok = one1_addname( ContextPtr, "", Files[Iword] );
+   }
+
+   for (Iword = 0; Ok && Iword < NDirs; Iword++) {
+      if (WordExp.we_wordc > 1) {
+         Prefix = (char *) starMallocAtomic( strlen( Dirs[Iword] ) + 2 );
+         if (Prefix == NULL) {
+            Ok = FALSE;
+         } else {
+            (void) strcpy( Prefix, Dirs[Iword] );
+            (void) strcat( Prefix, "/" );
+            Ok = one1_listdir( ContextPtr, Dirs[Iword], Prefix );
+            starFree( Prefix );
          }
+      } else {
+         Ok = one1_listdir( ContextPtr, Dirs[Iword], "" );
       }
+   }
+
+   if (Files) starFree( Files );
+   if (Dirs) starFree( Dirs );
+   wordfree( &WordExp );
+   return Ok;
+}
+
+/*  Append the sorted contents of directory Dir, excluding names that
+ *  start with '.', each prefixed by Prefix, to the list of names held in
+ *  the context. Returns FALSE if memory could not be allocated, and sets
+ *  the Failed flag in the context if the directory cannot be read.
+ */
 
+static int one1_listdir( ContextStruct *ContextPtr, const char *Dir,
+                         const char *Prefix ) {
+   DIR *DirPtr;            /* Open directory stream */
+   struct dirent *Entry;   /* Current directory entry */
+   size_t First;           /* Index of the first name from this directory */
+   int Ok = TRUE;          /* Returned value */
+
+   DirPtr = opendir( Dir );
+   if (DirPtr == NULL) {
+      ContextPtr->Failed = TRUE;
+      return TRUE;
    }
 
-   return (GotFileName);
+   First = ContextPtr->NNames;
+   while (Ok && (Entry = readdir( DirPtr )) != NULL) {
+      if (Entry->d_name[0] != '.') {
+         Ok = one1_addname( ContextPtr, Prefix, Entry->d_name );
+      }
+   }
+   (void) closedir( DirPtr );
+
+   if (Ok) {
+      qsort( ContextPtr->Names + First, ContextPtr->NNames - First,
+             sizeof(char *), one1_compare );
+   }
+   return Ok;
 }
 
 
@@ -571,7 +542,9 @@ F77_INTEGER_FUNCTION(one_find_file)( CHARACTER(FileSpec), LOGICAL(LisDir),
 *     in order to release any resources used by ONE_FIND_FILE.  It should be
 *     passed in its Context argument the value of the Context argument
 *     as returned by the ONE_FIND_FILE in the last call in the sequence that
-*     is to be closed down.
+*     is to be closed down. If any part of the file specification could
+*     not be expanded or listed, ONE__PIPEERR is reported (unless status
+*     is already bad), as it was when an 'ls' child process failed.
 *
 *  Language:
 *     C   (Intended to be called from Fortran)
@@ -610,6 +583,8 @@ F77_INTEGER_FUNCTION(one_find_file)( CHARACTER(FileSpec), LOGICAL(LisDir),
 *       Always try to free regardless of status
 *    2011-03-08 (TIMJ):
 *       Check exit status from waitpid and set EMS status accordingly.
+*    14-OCT-2026:
+*       Free the in-process list of names rather than closing a pipe.
 *-
  */
 
@@ -617,37 +592,25 @@ F77_SUBROUTINE(one_find_file_end)( POINTER(Context), INTEGER(Status) )
 {
    GENPTR_POINTER(Context)
    GENPTR_INTEGER(Status)
-   char Char;                        /* Character read from pipe */
    ContextStruct *ContextPtr;        /* Pointer to context structure */
+   size_t Iname;                     /* Index of current name */
 
-   /*  If the Context passed to us is a non-null pointer, attempt to
-    *  close the input fd for the pipe it should contain, and to release
-    *  the memory used for it. Also empty the pipe so that the writing
-    *  process is closed down neatly.
+   /*  If the Context passed to us is a non-null pointer, release the
+    *  memory used for it and for the list of names it contains.
     */
 
    if (*Context != 0) {
       ContextPtr = (ContextStruct *) cnfCptr( *Context );
       if (ContextPtr != NULL) {
-	while (read(ContextPtr->Fds[0],&Char,1) > 0);
-	(void) close (ContextPtr->Fds[0]);
-	if (ContextPtr->ls_pid > 0) {
-          /* Wait for the child process, and reap its status.  The pid
-             should be positive, but we test this just out of
-             paranoia. */
-          int process_status;
-          waitpid (ContextPtr->ls_pid, &process_status, 0);
-          if (! WIFEXITED(process_status) || /* Did not exit using _exit */
-              WEXITSTATUS(process_status)    /* Exited with bad status */
-              ) {
-	    /* non-normal exit */
-	    if (*Status == SAI__OK) {
-	      *Status = ONE__PIPEERR;
-	      emsRep( "ONE_FIND_FILE_END","Error from child",
-		      Status);
-	    }
-          }
-	}
+        if (ContextPtr->Failed && *Status == SAI__OK) {
+	  *Status = ONE__PIPEERR;
+	  emsRep( "ONE_FIND_FILE_END","Error expanding file specification",
+		  Status);
+        }
+        for (Iname = 0; Iname < ContextPtr->NNames; Iname++) {
+          starFree( ContextPtr->Names[Iname] );
+        }
+        if (ContextPtr->Names) starFree( ContextPtr->Names );
 	(void) cnfFree ((char *) ContextPtr);
       }
    }
@@ -655,4 +618,3 @@ F77_SUBROUTINE(one_find_file_end)( POINTER(Context), INTEGER(Status) )
    return;
 }
 /* $Id$ */
-
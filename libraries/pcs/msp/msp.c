@@ -14,7 +14,8 @@
 *     Copyright (C) 1991, 1994 Science & Engineering Research Council.
 *     Copyright (C) 1995-1996, 1999, 2004 Central Laboratory of the
 *     Research Councils. Copyright (C) 2005 Particle Physics &
-*     Astronomy Research Council. All Rights Reserved.
+*     Astronomy Research Council. Copyright (C) 2026 East Asian
+*     Observatory. All Rights Reserved.
 
 *  Licence:
 *     This program is free software; you can redistribute it and/or
@@ -58,6 +59,9 @@
 *     29-DEC-2005 (TIMJ):
 *        Fix compiler warnings
 *                 Remove code that sets exit handler (TIMJ)
+*     14-OCT-2026:
+*        Also listen on a Unix domain socket and use it in preference
+*        to TCP when connecting to another task.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -149,6 +153,11 @@ static int socket_used[MSP__MXSOCKETS];     /* flags for currently-active
 
 static char rendezvous[MAXPATH+1+32+1+5];   /* name of rendezvous file (ADAM_USER+/+<task>_<PORT>) */
 
+static char unixrvous[MAXPATH+2+32+1+5];    /* name of Unix domain socket
+                                               (ADAM_USER+/.+<task>_<PORT>) */
+static int unixslot = -1;                   /* socket slot listening on
+                                               unixrvous, or -1 */
+
 static char adam_user[MAXPATH];             /* directory for creating msp
                                                files */
 
@@ -485,6 +494,7 @@ static int msp1_mkrvous( const char *fname )
 
 static void msp_accept
 (
+int listener,        /* listening socket (given) */
 int *status          /* global status (given and returned) */
 )
 
@@ -501,7 +511,8 @@ int *status          /* global status (given and returned) */
 
 *  Algorithm:
 *     Find an unused sockets slot the use the accept() call to bind it to
-*     a connection to the other task.
+*     a connection to the other task. The request may have arrived on
+*     either the TCP or the Unix domain listening socket.
 
 *  Copyright:
 *     Copyright (C) 1994 Science & Engineering Research Council. All
@@ -532,6 +543,8 @@ int *status          /* global status (given and returned) */
 *        Original
 *     12-APR-1994 (BDK):
 *        Make the function static
+*     14-OCT-2026:
+*        Add listener argument.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -544,7 +557,7 @@ int *status          /* global status (given and returned) */
    int j;                              /* loop counter */
    int found;                          /* loop controller */
    socklen_t namelen;                  /* length of client address */
-   struct sockaddr_in client_address;  /* incoming connection details */
+   struct sockaddr_storage client_address; /* incoming connection details */
 
 
    if ( *status != SAI__OK ) return;
@@ -568,7 +581,7 @@ int *status          /* global status (given and returned) */
 /*   accept the call */
 
       namelen = sizeof ( client_address );
-      mysockets[j] = accept ( mysockets[0], (struct sockaddr*)
+      mysockets[j] = accept ( listener, (struct sockaddr*)
         &client_address, &namelen );
       if ( mysockets[j] == -1 )
       {
@@ -1121,6 +1134,12 @@ int *status              /* global status (given and returned) */
 *     file in the $ADAM_USER directory with a filename constructed from
 *     this task name and the port number. If environment variable ADAM_USER
 *     is not defined, directory adam in the user's home directory is used.
+*
+*     The task also listens on a Unix domain socket named after the
+*     rendezvous file but with a leading '.', which other tasks use in
+*     preference to the internet port as it avoids the overheads of the
+*     TCP/IP stack. If this socket cannot be created (for instance because
+*     its name would be too long) only the internet port is used.
 
 *  Copyright:
 *     Copyright (C) 1991, 1994 Science & Engineering Research Council.
@@ -1156,6 +1175,8 @@ int *status              /* global status (given and returned) */
 *        Changed to use STREAM sockets
 *     2014-02-21 (TIMJ):
 *        Ask OS for free port rather than trying lots ourselves
+*     14-OCT-2026:
+*        Also listen on a Unix domain socket.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -1173,6 +1194,8 @@ int *status              /* global status (given and returned) */
    int portno;                       /* this task's port number */
    struct sockaddr_in query_addr;    /* To retrieve port number */
    socklen_t len;                    /* length of query_addr */
+   struct sockaddr_un unix_addr;     /* description of Unix domain socket
+                                        for incoming connection requests */
 
    if ( *status != SAI__OK ) return;
 
@@ -1298,6 +1321,37 @@ int *status              /* global status (given and returned) */
       exit(1);
    }
 
+/*   Create the Unix domain socket for connection requests from tasks
+     that look for it. This is optional, so failure just means that
+     connections arrive through the internet port. */
+
+   istat = snprintf ( unixrvous, sizeof(unixrvous), "%s/.%s_%d", adam_user,
+                      task_name, portno );
+   memset ( &unix_addr, 0, sizeof(unix_addr) );
+   unix_addr.sun_family = AF_UNIX;
+   if ( istat < sizeof(unixrvous) && istat < sizeof(unix_addr.sun_path) )
+   {
+      strcpy ( unix_addr.sun_path, unixrvous );
+      (void) unlink ( unixrvous );
+      mysockets[1] = socket ( AF_UNIX, SOCK_STREAM, 0 );
+      if ( mysockets[1] >= 0 )
+      {
+         if ( ( bind ( mysockets[1], (struct sockaddr *) &unix_addr,
+                       sizeof(unix_addr) ) == 0 ) &&
+              ( listen ( mysockets[1], 5 ) == 0 ) )
+         {
+            socket_used[1] = 1;
+            unixslot = 1;
+         }
+         else
+         {
+            close ( mysockets[1] );
+            (void) unlink ( unixrvous );
+         }
+      }
+   }
+   if ( unixslot < 0 ) unixrvous[0] = '\0';
+
 /*   Create the command queue */
 
    queues[0] = 0;
@@ -1355,6 +1409,8 @@ void
 *     08-MAR-1994 (BDK):
 *        Original
 *     05-DEC-1994: Make global - intended for error processing only
+*     14-OCT-2026:
+*        Remove the Unix domain socket.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -1366,9 +1422,10 @@ void
 {
    int j;         /* loop counter */
 
-/*   Remove the rendezvous file */
+/*   Remove the rendezvous file and Unix domain socket */
 
    (void) unlink ( rendezvous);
+   if ( unixrvous[0] != '\0' ) (void) unlink ( unixrvous );
 
    for ( j=0; j<MSP__MXSOCKETS; j++ )
    {
@@ -1503,8 +1560,10 @@ int *status            /* global status (given and returned) */
 *     Starlink C
 
 *  Algorithm:
-*     Get the internet port number of the named task and connect to it.
-*     Add the connected socket to the list to be watched for messages.
+*     Get the internet port number of the named task and connect to it,
+*     through its Unix domain socket if it has one and otherwise through
+*     the internet port. Add the connected socket to the list to be
+*     watched for messages.
 
 *  Copyright:
 *     Copyright (C) 1991, 1994 Science & Engineering Research Council.
@@ -1538,6 +1597,9 @@ int *status            /* global status (given and returned) */
 *        Revised version
 *     14-MAR-1994 (BDK):
 *        Changed to use STREAM sockets
+*     14-OCT-2026:
+*        Try the task's Unix domain socket first, and only look up the
+*        address of this machine once.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -1552,11 +1614,13 @@ int *status            /* global status (given and returned) */
    int istat;                        /* local status */
    int j;                            /* loop counter */
    int taskport = 0;                 /* port number of task */
-   struct hostent hostentstruct;     /* network data structure for this
-                                        machine */
    struct hostent *hostentptr;       /* pointer to network data structure
                                         */
+   static struct in_addr localaddr;  /* address of this machine */
+   static int gotlocal = 0;          /* localaddr has been set? */
    struct sockaddr_in connect_addr;  /* structure for connection request */
+   struct sockaddr_un unix_addr;     /* structure for Unix domain connection
+                                        request */
 
 
    if ( *status != SAI__OK ) return;
@@ -1583,20 +1647,59 @@ int *status            /* global status (given and returned) */
 
       msp_get_taskport ( filedir, task_name, &taskport, status );
 
+/*   Try the task's Unix domain socket first */
+
+      istat = -1;
       if ( *status == SAI__OK )
       {
+         memset ( &unix_addr, 0, sizeof(unix_addr) );
+         unix_addr.sun_family = AF_UNIX;
+         if ( snprintf ( unix_addr.sun_path, sizeof(unix_addr.sun_path),
+                         "%s/.%s_%d", filedir, task_name, taskport ) <
+              sizeof(unix_addr.sun_path) )
+         {
+            mysockets[j] = socket ( AF_UNIX, SOCK_STREAM, 0 );
+            if ( mysockets[j] != -1 )
+            {
+               istat = connect ( mysockets[j],
+                 (struct sockaddr *) &unix_addr, sizeof(unix_addr) );
+               if ( istat != 0 ) close ( mysockets[j] );
+            }
+         }
+      }
+
+      if ( ( *status == SAI__OK ) && ( istat == 0 ) )
+      {
+         socket_used[j] = 1;
+         qid->connection = mysockets[j];
+         qid->ack_queue = 0;
+      }
+      else if ( *status == SAI__OK )
+      {
 
-/*   Get network data structure for this machine */
+/*   Get network data structure for this machine. This does not change
+     so only look it up once. */
 
-         hostentptr = gethostbyname ( "localhost" );
-         hostentstruct = *hostentptr;
+         if ( !gotlocal )
+         {
+            hostentptr = gethostbyname ( "localhost" );
+            if ( hostentptr != NULL )
+            {
+               localaddr = *((struct in_addr *) hostentptr->h_addr);
+            }
+            else
+            {
+               localaddr.s_addr = htonl ( INADDR_LOOPBACK );
+            }
+            gotlocal = 1;
+         }
 
 /*   Construct the data structure for the connection request to the given
      port number on THIS machine */
 
          memset ( &connect_addr, 0, sizeof(connect_addr) );
          connect_addr.sin_family = AF_INET;
-         connect_addr.sin_addr = *((struct in_addr *) hostentstruct.h_addr);
+         connect_addr.sin_addr = localaddr;
          connect_addr.sin_port = htons ( taskport );
 
          mysockets[j] = socket ( AF_INET, SOCK_STREAM, 0 );
@@ -1723,12 +1826,12 @@ int *status           /* global status (given and returned) */
 
 /*   at least one message present, get it and return */
 
-      if ( q==0 )
+      if ( ( q==0 ) || ( q==unixslot ) )
       {
 
 /*   Incoming connection call */
 
-         msp_accept ( status );
+         msp_accept ( mysockets[q], status );
       }
       else
       {
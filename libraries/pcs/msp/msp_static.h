@@ -2,6 +2,7 @@
 
 static void msp_accept
 (
+int listener,        /* listening socket (given) */
 int *status          /* global status (given and returned) */
 );
 
@@ -0,0 +1,114 @@
+      SUBROUTINE SUBPAR_CACHENM ( IFNAM, CACHE, STATUS )
+*+
+*  Name:
+*     SUBPAR_CACHENM
+
+*  Purpose:
+*     Get the name of the compiled copy of a text interface module.
+
+*  Language:
+*     Starlink Fortran 77
+
+*  Invocation:
+*     CALL SUBPAR_CACHENM ( IFNAM, CACHE, STATUS )
+
+*  Description:
+*     Returns the name of the file in the ADAM_USER directory used to
+*     hold a compiled copy of the given text form interface module.
+*     The name is formed from the name of the interface module with
+*     its directory and any .ifl file type removed, followed by the
+*     file type .ifcache. A distinct file type is used so that the
+*     copy is never found by the search for interface modules along
+*     ADAM_IFL, which does not check that it is up to date.
+
+*  Arguments:
+*     IFNAM = CHARACTER*(*) (Given)
+*        The file specification of the text interface module
+*     CACHE = CHARACTER*(*) (Returned)
+*        The file specification of the compiled copy
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+
+*  Type Definitions:
+      IMPLICIT NONE              ! No implicit typing
+
+*  Global Constants:
+      INCLUDE 'SAE_PAR'          ! Standard SAE constants
+
+*  Arguments Given:
+      CHARACTER*(*) IFNAM
+
+*  Arguments Returned:
+      CHARACTER*(*) CACHE
+
+*  Status:
+      INTEGER STATUS             ! Global status
+
+*  External References:
+      EXTERNAL CHR_LEN
+      INTEGER CHR_LEN            ! Used length of string
+      EXTERNAL STRING_IANYR
+      INTEGER STRING_IANYR       ! Index search backwards
+
+*  Local Variables:
+      CHARACTER*(256) ADMUSR     ! ADAM_USER directory
+      INTEGER AULEN              ! Length of ADAM_USER directory name
+      INTEGER IFLEN              ! Used length of IFNAM
+      INTEGER STNM               ! Start of file name in IFNAM
+      INTEGER ENDNM              ! End of file name in IFNAM
+*.
+
+*  Check inherited global status.
+      IF ( STATUS .NE. SAI__OK ) RETURN
+
+*  Get the ADAM_USER directory (including a terminating /)
+      CALL SUBPAR_ADMUS ( ADMUSR, AULEN, STATUS )
+
+      IF ( STATUS .EQ. SAI__OK ) THEN
+
+*     Find the file name without directory or .ifl file type
+         IFLEN = CHR_LEN( IFNAM )
+         STNM = STRING_IANYR( IFNAM(1:IFLEN), '/' ) + 1
+         ENDNM = IFLEN
+         IF ( IFLEN - STNM .GE. 4 ) THEN
+            IF ( IFNAM(IFLEN-3:IFLEN) .EQ. '.ifl' ) ENDNM = IFLEN - 4
+         ENDIF
+
+         CACHE = ADMUSR(1:AULEN) // IFNAM(STNM:ENDNM) // '.ifcache'
+
+      ENDIF
+
+      END
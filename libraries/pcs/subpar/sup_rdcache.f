@@ -0,0 +1,129 @@
+      SUBROUTINE SUBPAR_RDCACHE ( IFNAM, FOUND, STATUS )
+*+
+*  Name:
+*     SUBPAR_RDCACHE
+
+*  Purpose:
+*     Load the compiled copy of a text interface module if up to date.
+
+*  Language:
+*     Starlink Fortran 77
+
+*  Invocation:
+*     CALL SUBPAR_RDCACHE ( IFNAM, FOUND, STATUS )
+
+*  Description:
+*     Looks in the ADAM_USER directory for a compiled copy of the given
+*     text form interface module, as written by SUBPAR_WRCACHE. If the
+*     copy was made from the same interface module and was modified
+*     more recently than it, the parameter system common blocks are
+*     set up from the copy using SUBPAR_LOADIFC and FOUND is returned
+*     .TRUE.. Otherwise FOUND is returned .FALSE. and the caller should
+*     parse the interface module itself. Any error encountered while
+*     looking for or reading the copy is annulled, since it just means
+*     that the copy cannot be used.
+
+*  Arguments:
+*     IFNAM = CHARACTER*(*) (Given)
+*        The file specification of the text interface module
+*     FOUND = LOGICAL (Returned)
+*        .TRUE. if the common blocks were set up from the compiled copy
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+
+*  Type Definitions:
+      IMPLICIT NONE              ! No implicit typing
+
+*  Global Constants:
+      INCLUDE 'SAE_PAR'          ! Standard SAE constants
+
+*  Arguments Given:
+      CHARACTER*(*) IFNAM
+
+*  Arguments Returned:
+      LOGICAL FOUND
+
+*  Status:
+      INTEGER STATUS             ! Global status
+
+*  Local Variables:
+      CHARACTER*(256) CACHE      ! Name of the compiled copy
+      CHARACTER*(256) SOURCE     ! Interface module the copy was made from
+      INTEGER CTIME              ! Modification time of the copy
+      INTEGER ITIME              ! Modification time of IFNAM
+      INTEGER ISTAT              ! Local status
+      INTEGER LUCON              ! Unit number of the copy
+      INTEGER REASON             ! Reason for ACCESS failure
+      LOGICAL ACCCAC             ! Compiled copy accessible
+*.
+
+      FOUND = .FALSE.
+
+*  Check inherited global status.
+      IF ( STATUS .NE. SAI__OK ) RETURN
+
+      CALL EMS_MARK
+
+*  See if there is a readable copy newer than the interface module
+      CALL SUBPAR_CACHENM( IFNAM, CACHE, STATUS )
+      CALL PSX_ACCESS( CACHE, 'R', ACCCAC, REASON, STATUS )
+      IF ( ACCCAC .AND. ( STATUS .EQ. SAI__OK ) ) THEN
+         CALL PSX_STAT( CACHE, 'MTIME', CTIME, STATUS )
+         CALL PSX_STAT( IFNAM, 'MTIME', ITIME, STATUS )
+
+         IF ( ( STATUS .EQ. SAI__OK ) .AND. ( CTIME .GT. ITIME ) ) THEN
+
+*        Check it was made from this interface module and load it
+            CALL SUBPAR_OPENIFC( CACHE, LUCON, STATUS )
+            IF ( STATUS .EQ. SAI__OK ) THEN
+               READ ( LUCON, IOSTAT = ISTAT ) SOURCE
+               IF ( ( ISTAT .EQ. 0 ) .AND. ( SOURCE .EQ. IFNAM ) ) THEN
+                  CALL SUBPAR_LOADIFC( LUCON, STATUS )
+                  IF ( STATUS .EQ. SAI__OK ) FOUND = .TRUE.
+               ENDIF
+               CLOSE ( LUCON, IOSTAT = ISTAT )
+            ENDIF
+
+         ENDIF
+
+      ENDIF
+
+*  Failure to use the copy is not an error
+      IF ( STATUS .NE. SAI__OK ) CALL EMS_ANNUL( STATUS )
+
+      CALL EMS_RLSE
+
+      END
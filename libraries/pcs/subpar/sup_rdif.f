@@ -19,6 +19,11 @@
 *      The common blocks are set up
 *      using either SUBPAR_LOADIFC (if the filetype is .IFC) or
 *      PARSECON_READIFL (if the filetype is .IFL).
+*      A text form interface module is only parsed if there is no
+*      up-to-date compiled copy of it in the ADAM_USER directory (see
+*      SUBPAR_RDCACHE). After a parse without errors, such a copy is
+*      written (see SUBPAR_WRCACHE) so that later activations of the
+*      task can load it with SUBPAR_LOADIFC instead.
 *      If the routine is unsuccessful, a message is reported and an
 *      appropriate STATUS value is returned.
 
@@ -32,6 +37,7 @@
 
 *  Copyright:
 *     Copyright (C) 1991, 1992, 1993, 1994 Science & Engineering Research Council.
+*     Copyright (C) 2026 East Asian Observatory.
 *     All Rights Reserved.
 
 *  Licence:
@@ -65,6 +71,9 @@
 *        Add INCLUDE DAT_PAR
 *     24-FEB-1994 (AJC):
 *        Initialize all PARVALIDs
+*     14-OCT-2026:
+*        Use and update a compiled copy of a text form interface module
+*        in the ADAM_USER directory.
 *     {enter_further_changes_here}
 
 *  Bugs:
@@ -95,6 +104,7 @@
 
 *  Local Variables:
       INTEGER ISTAT              ! Local status
+      LOGICAL CACHED             ! Was a compiled copy loaded?
       INTEGER LUCON              ! Interface module unit number
       INTEGER NUMERR             ! Number of IFL compilation errors
       INTEGER I                  ! Parameter counter
@@ -112,10 +122,13 @@
             CLOSE ( LUCON, IOSTAT = ISTAT )
          ENDIF
 
-*  Otherwise the interface module is text form - try to compile it
+*  Otherwise the interface module is text form - use an up-to-date
+*  compiled copy of it if one exists, and otherwise try to compile it
       ELSE
-         CALL PARSECON_OPENIFL ( IFNAM, LUCON, STATUS )
-         IF ( STATUS .EQ. SAI__OK ) THEN
+         CALL SUBPAR_RDCACHE( IFNAM, CACHED, STATUS )
+         IF ( .NOT. CACHED ) CALL PARSECON_OPENIFL ( IFNAM, LUCON,
+     :                                               STATUS )
+         IF ( ( .NOT. CACHED ) .AND. ( STATUS .EQ. SAI__OK ) ) THEN
             CALL PARSECON_READIFL ( LUCON, NUMERR, STATUS )
             CLOSE ( LUCON, IOSTAT = ISTAT )
 
@@ -135,6 +148,10 @@
      :          ISTAT )
                IF ( ISTAT .NE. SAI__WARN ) STATUS = ISTAT
 
+*  Save a compiled copy if there were no errors
+            ELSE
+               CALL SUBPAR_WRCACHE( IFNAM, STATUS )
+
             ENDIF
 
          ENDIF
@@ -0,0 +1,149 @@
+      SUBROUTINE SUBPAR_WRCACHE ( IFNAM, STATUS )
+*+
+*  Name:
+*     SUBPAR_WRCACHE
+
+*  Purpose:
+*     Save a compiled copy of a text interface module.
+
+*  Language:
+*     Starlink Fortran 77
+
+*  Invocation:
+*     CALL SUBPAR_WRCACHE ( IFNAM, STATUS )
+
+*  Description:
+*     Writes the interface just set up in the parameter system common
+*     blocks by PARSECON_READIFL to a compiled copy in the ADAM_USER
+*     directory, for use by SUBPAR_RDCACHE when the task is next
+*     activated. The copy has the same form as a compiled interface
+*     module (.ifc) file, preceded by a record holding the name of the
+*     interface module it was made from. It is written to a temporary
+*     file which is then renamed, so that other processes activating
+*     the same task never see a partially written copy. Any error is
+*     annulled, since failing to save the copy only means that the
+*     interface module will be parsed again next time.
+
+*  Arguments:
+*     IFNAM = CHARACTER*(*) (Given)
+*        The file specification of the text interface module
+*     STATUS = INTEGER (Given and Returned)
+*        The global status.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public License
+*     along with this program; if not, write to the Free Software
+*     Foundation, Inc., 51 Franklin Street,Fifth Floor, Boston, MA
+*     02110-1301, USA
+
+*  Authors:
+*     {enter_new_authors_here}
+
+*  History:
+*     14-OCT-2026:
+*        Original version.
+*     {enter_further_changes_here}
+
+*  Bugs:
+*     {note_any_bugs_here}
+
+*-
+
+*  Type Definitions:
+      IMPLICIT NONE              ! No implicit typing
+
+*  Global Constants:
+      INCLUDE 'SAE_PAR'          ! Standard SAE constants
+
+*  Arguments Given:
+      CHARACTER*(*) IFNAM
+
+*  Status:
+      INTEGER STATUS             ! Global status
+
+*  External References:
+      EXTERNAL CHR_LEN
+      INTEGER CHR_LEN            ! Used length of string
+
+*  Local Variables:
+      CHARACTER*(256) CACHE      ! Name of the compiled copy
+      CHARACTER*(256) SOURCE     ! Interface module the copy is made from
+      CHARACTER*(280) TMPNAM     ! Name of the temporary file
+      CHARACTER*(20) PIDSTR      ! Process ID as a string
+      INTEGER ISTAT              ! Local status
+      INTEGER JSTAT              ! Local status
+      INTEGER LUCON              ! Unit number of the temporary file
+      INTEGER NCHAR              ! Used length of PIDSTR
+      INTEGER PID                ! Process ID
+      LOGICAL OPEN               ! Whether chosen unit in use
+*.
+
+*  Check inherited global status.
+      IF ( STATUS .NE. SAI__OK ) RETURN
+
+      CALL EMS_MARK
+
+*  Construct the name of a temporary file unique to this process
+      CALL SUBPAR_CACHENM( IFNAM, CACHE, STATUS )
+      CALL PSX_GETPID( PID, STATUS )
+      CALL CHR_ITOC( PID, PIDSTR, NCHAR )
+      TMPNAM = CACHE(1:CHR_LEN(CACHE)) // '_' // PIDSTR(1:NCHAR)
+
+      IF ( STATUS .EQ. SAI__OK ) THEN
+
+*     Obtain an unused unit number
+         DO LUCON = 1,99
+            INQUIRE (UNIT=LUCON, OPENED=OPEN )
+            IF ( .NOT. OPEN ) GOTO 10
+         ENDDO
+         GOTO 100
+10       CONTINUE
+
+*     Write the name of the interface module followed by the compiled
+*     form of the interface
+         ISTAT = 0
+         OPEN ( UNIT = LUCON, FILE = TMPNAM, STATUS = 'UNKNOWN',
+     :          FORM = 'UNFORMATTED', IOSTAT = ISTAT )
+         IF ( ISTAT .EQ. 0 ) THEN
+            SOURCE = IFNAM
+            WRITE ( LUCON, IOSTAT = ISTAT ) SOURCE
+            IF ( ISTAT .EQ. 0 ) CALL PARSECON_DUMPIFC( LUCON, STATUS )
+
+*        On success rename the temporary file to its final name,
+*        otherwise delete it
+            IF ( ( ISTAT .EQ. 0 ) .AND. ( STATUS .EQ. SAI__OK ) ) THEN
+               CLOSE ( LUCON, IOSTAT = JSTAT )
+               IF ( JSTAT .EQ. 0 ) THEN
+                  CALL PSX_RENAME( TMPNAM, CACHE, STATUS )
+               ELSE
+                  CALL PSX_REMOVE( TMPNAM, STATUS )
+               ENDIF
+            ELSE
+               CLOSE ( LUCON, STATUS = 'DELETE', IOSTAT = JSTAT )
+            ENDIF
+         ENDIF
+
+      ENDIF
+
+100   CONTINUE
+
+*  Failure to save the copy is not an error
+      IF ( STATUS .NE. SAI__OK ) CALL EMS_ANNUL( STATUS )
+
+      CALL EMS_RLSE
+
+      END
@@ -66,8 +66,97 @@ typedef enum STARMEM_MALLOCS {
   STARMEM__AST,
   STARMEM__DL,
   STARMEM__GC,
+  STARMEM__TC,
 } STARMEM_MALLOCS;
 
+/* Per-thread arenas (see starArenaMalloc). Each arena is a list of
+   blocks. Memory is allocated by advancing the "used" count of the
+   current block, and released by restoring a mark saved by
+   starArenaBegin. */
+
+/* Default size of each arena block, and the alignment of arena memory */
+#define STARMEM__ARENA_BLOCK ((size_t) 256 * 1024)
+#define STARMEM__ARENA_ALIGN 16
+
+typedef struct starMemArenaBlock {
+  struct starMemArenaBlock * next;   /* Next block in the arena */
+  size_t size;                       /* Usable bytes in this block */
+  size_t used;                       /* Bytes allocated from this block */
+} starMemArenaBlock;
+
+/* Size of the block header, rounded up to preserve alignment */
+#define STARMEM__ARENA_HEADER                                            \
+  ( ( sizeof(starMemArenaBlock) + STARMEM__ARENA_ALIGN - 1 ) &           \
+    ~( (size_t) STARMEM__ARENA_ALIGN - 1 ) )
+
+typedef struct starMemArenaMark {
+  starMemArenaBlock * block;         /* Current block, or NULL */
+  size_t used;                       /* Bytes used in current block */
+} starMemArenaMark;
+
+typedef struct starMemArena {
+  starMemArenaBlock * first;         /* First block in the arena */
+  starMemArenaBlock * current;       /* Block in use, or NULL if none */
+  starMemArenaMark * marks;          /* Stack of marks */
+  int nmark;                         /* Number of marks on the stack */
+  int maxmark;                       /* Allocated size of the stack */
+  int nlost;                         /* Unmatched starArenaBegin calls */
+} starMemArena;
+
+starMemArena * starMemArenaGet( void );
+
+/* Per-thread caching allocator on top of dlmalloc (see mem1_tcache.c) */
+void * starMemTcMalloc( size_t size );
+void * starMemTcCalloc( size_t nmemb, size_t size );
+void * starMemTcRealloc( void * ptr, size_t size );
+void starMemTcFree( void * ptr, int force );
+
+/* Large arrays (see starMallocLarge). Each array is preceded by a
+   header of STARMEM_LARGE_ALIGN bytes, so that the alignment of the
+   array is preserved. Arrays larger than STARMEM__LARGE_MIN bytes are
+   mapped from the operating system, aligned to STARMEM__HUGE_PAGE. */
+#define STARMEM__LARGE_HDR ((size_t) STARMEM_LARGE_ALIGN)
+#define STARMEM__LARGE_MIN ((size_t) 4 * 1024 * 1024)
+#define STARMEM__HUGE_PAGE ((size_t) 2 * 1024 * 1024)
+
+typedef struct starMemLargeHeader {
+  void * base;                       /* Start of the underlying block */
+  size_t maplen;                     /* Mapped length, or 0 if malloced */
+} starMemLargeHeader;
+
+/* Memory accounting (see mem1_stats.c). Statistics are kept for at
+   most STARMEM__MAXTAG tags, including the default tag. */
+#define STARMEM__MAXTAG 128
+#define STARMEM__SZTAG 32
+
+typedef struct starMemStats {
+  char name[STARMEM__SZTAG];         /* Tag name */
+  size_t current;                    /* Bytes currently allocated */
+  size_t peak;                       /* Largest value of "current" */
+  size_t count;                      /* Number of allocations */
+} starMemStats;
+
+/* Header preceding each block when accounting is enabled. It is a
+   union so that the memory following it is suitably aligned. */
+typedef union starMemStatsHeader {
+  struct {
+    size_t size;                     /* Bytes requested by the caller */
+    int tag;                         /* Index of the allocation tag */
+  } info;
+  double align1;
+  void * align2;
+  char pad[16];
+} starMemStatsHeader;
+
+#define STARMEM__STATS_HDR sizeof(starMemStatsHeader)
+
+void starMemStatsLock( int lock );
+starMemStats * starMemStatsTag( int itag );
+int starMemStatsFind( const char * tag, int create );
+int starMemStatsCurrent( int itag );
+void * starMemStatsAdd( void * base, size_t size, int itag );
+void * starMemStatsRemove( void * ptr, size_t * size, int * itag );
+
 /* State variables - set in mem1_globals.c */
 extern STARMEM_MALLOCS STARMEM_MALLOC;
 extern int STARMEM_INITIALISED;
@@ -80,6 +169,12 @@ extern int STARMEM_PRINT_MALLOC;
 /* Display scarce information messages */
 extern int STARMEM_PRINT_INFO;
 
+/* Is memory accounting enabled? */
+extern int STARMEM_STATS;
+
+/* Should large arrays use explicit huge pages? */
+extern int STARMEM_HUGETLB;
+
 /* Macro to simplify fatal abort */
 #define starMemFatal( text ) fprintf(stderr, "starMem: Fatal error in " __FILE__ ": " text "\n"); abort();
 
@@ -0,0 +1,132 @@
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+/*
+*  Name:
+*     mem1_arena.c
+
+*  Purpose:
+*     Private per-thread arena management for starmem
+
+*  Description:
+*     This file provides access to the memory arena owned by each
+*     thread (see starArenaMalloc), creating it when first needed and
+*     freeing it when the thread exits.
+
+*  Copyright:
+*     Copyright (C) 2026 Science and Technology Facilities Council.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*/
+
+/* System includes */
+#include <stdlib.h>
+#if HAVE_PTHREAD_H
+#  include <pthread.h>
+#endif
+
+/* Private includes */
+#include "mem1.h"
+
+#if HAVE_PTHREAD_H
+
+static pthread_once_t starmem_arena_once = PTHREAD_ONCE_INIT;
+static pthread_key_t starmem_arena_key;
+static int starmem_arena_key_ok = 0;
+
+/* Free an arena. Called automatically when a thread exits. */
+static void starMemArenaFree( void * ptr ) {
+  starMemArena * arena = ptr;
+  starMemArenaBlock * block;
+  starMemArenaBlock * next;
+
+  if ( !arena ) return;
+  block = arena->first;
+  while ( block ) {
+    next = block->next;
+    free( block );
+    block = next;
+  }
+  free( arena->marks );
+  free( arena );
+}
+
+/* Create the key used to locate each thread's arena */
+static void starMemArenaCreateKey( void ) {
+  if ( pthread_key_create( &starmem_arena_key, starMemArenaFree ) == 0 ) {
+    starmem_arena_key_ok = 1;
+  } else {
+    fprintf( stderr, "starMem: Failed to create arena Thread-Specific Data key\n" );
+  }
+}
+
+#else
+
+/* Without threads there is a single arena */
+static starMemArena * starmem_arena = NULL;
+
+#endif
+
+/*
+*  Name:
+*     starMemArenaGet
+
+*  Purpose:
+*     Get the arena belonging to the calling thread
+
+*  Invocation:
+*     starMemArena * starMemArenaGet( void );
+
+*  Description:
+*     Returns the arena belonging to the calling thread, creating an
+*     empty arena if the thread has none.
+
+*  Returned Value:
+*     starMemArenaGet = starMemArena * (Returned)
+*        Pointer to the arena, or NULL if it could not be created.
+
+*/
+
+starMemArena * starMemArenaGet( void ) {
+  starMemArena * arena;
+
+#if HAVE_PTHREAD_H
+  pthread_once( &starmem_arena_once, starMemArenaCreateKey );
+  if ( !starmem_arena_key_ok ) return NULL;
+  arena = pthread_getspecific( starmem_arena_key );
+#else
+  arena = starmem_arena;
+#endif
+
+  if ( !arena ) {
+    arena = calloc( 1, sizeof(*arena) );
+    if ( !arena ) return NULL;
+#if HAVE_PTHREAD_H
+    if ( pthread_setspecific( starmem_arena_key, arena ) ) {
+      free( arena );
+      return NULL;
+    }
+#else
+    starmem_arena = arena;
+#endif
+  }
+
+  return arena;
+}
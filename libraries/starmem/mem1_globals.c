@@ -56,3 +56,9 @@ int STARMEM_PRINT_MALLOC = 0;
 
 /* Display scarc informational messages */
 int STARMEM_PRINT_INFO = 0;
+
+/* Is memory accounting enabled? */
+int STARMEM_STATS = 0;
+
+/* Should large arrays use explicit huge pages? */
+int STARMEM_HUGETLB = 0;
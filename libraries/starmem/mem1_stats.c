@@ -0,0 +1,281 @@
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+/*
+*  Name:
+*     mem1_stats.c
+
+*  Purpose:
+*     Private memory accounting for starmem
+
+*  Description:
+*     When the STARMEM_STATS environment variable is defined, every
+*     block allocated by starMalloc and related routines is preceded by
+*     a small header recording its size and the allocation tag that
+*     was current in the allocating thread (see starMemSetTag). The
+*     routines in this file maintain the current and peak number of
+*     bytes, and the number of allocations, for each tag and in total.
+*     The statistics are protected by a single mutex, so accounting is
+*     intended for diagnosis rather than production use.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*/
+
+/* System includes */
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#if HAVE_PTHREAD_H
+#  include <pthread.h>
+#endif
+
+/* Private includes */
+#include "mem1.h"
+
+/* The statistics for each tag. Tag zero is used for allocations made
+   when no tag is current, and when the table is full. Element
+   STARMEM__MAXTAG holds the totals for all tags. */
+static starMemStats starmem_stats[STARMEM__MAXTAG + 1] = {
+  [0] = { "(untagged)", 0, 0, 0 },
+  [STARMEM__MAXTAG] = { "(total)", 0, 0, 0 }
+};
+static int starmem_ntag = 1;
+
+#if HAVE_PTHREAD_H
+
+static pthread_mutex_t starmem_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t starmem_stats_once = PTHREAD_ONCE_INIT;
+static pthread_key_t starmem_stats_key;
+static int starmem_stats_key_ok = 0;
+
+/* Create the key used to hold each thread's current tag */
+static void starMemStatsCreateKey( void ) {
+  if ( pthread_key_create( &starmem_stats_key, NULL ) == 0 ) {
+    starmem_stats_key_ok = 1;
+  } else {
+    fprintf( stderr, "starMem: Failed to create tag Thread-Specific Data key\n" );
+  }
+}
+
+#else
+
+/* Without threads there is a single current tag */
+static int starmem_stats_tag = 0;
+
+#endif
+
+/*
+*  Name:
+*     starMemStatsLock
+
+*  Purpose:
+*     Lock or unlock the memory statistics
+
+*  Invocation:
+*     void starMemStatsLock( int lock );
+
+*  Description:
+*     Locks the statistics if "lock" is true, and unlocks them
+*     otherwise. The statistics should be locked whilst they are read
+*     using starMemStatsTag.
+
+*/
+
+void starMemStatsLock( int lock ) {
+#if HAVE_PTHREAD_H
+  if ( lock ) {
+    pthread_mutex_lock( &starmem_stats_mutex );
+  } else {
+    pthread_mutex_unlock( &starmem_stats_mutex );
+  }
+#endif
+}
+
+/*
+*  Name:
+*     starMemStatsTag
+
+*  Purpose:
+*     Return the statistics for a tag
+
+*  Invocation:
+*     starMemStats * starMemStatsTag( int itag );
+
+*  Description:
+*     Returns a pointer to the statistics for the tag with index "itag",
+*     or for all tags if "itag" is negative. NULL is returned if "itag"
+*     is not the index of a known tag. The statistics should be locked
+*     by the caller.
+
+*/
+
+starMemStats * starMemStatsTag( int itag ) {
+  if ( itag < 0 ) return starmem_stats + STARMEM__MAXTAG;
+  if ( itag >= starmem_ntag ) return NULL;
+  return starmem_stats + itag;
+}
+
+/*
+*  Name:
+*     starMemStatsFind
+
+*  Purpose:
+*     Find the index of a named tag
+
+*  Invocation:
+*     int starMemStatsFind( const char * tag, int create );
+
+*  Description:
+*     Returns the index of the tag with the given name. If no such tag
+*     exists, a new one is created if "create" is true and there is
+*     room for it, and -1 is returned otherwise. Names are truncated to
+*     STARMEM__SZTAG - 1 characters. The statistics should be locked by
+*     the caller.
+
+*/
+
+int starMemStatsFind( const char * tag, int create ) {
+  int itag;
+
+  for ( itag = 0; itag < starmem_ntag; itag++ ) {
+    if ( strncmp( starmem_stats[itag].name, tag, STARMEM__SZTAG - 1 ) == 0 ) {
+      return itag;
+    }
+  }
+
+  if ( !create || starmem_ntag == STARMEM__MAXTAG ) return -1;
+  itag = starmem_ntag++;
+  strncpy( starmem_stats[itag].name, tag, STARMEM__SZTAG - 1 );
+  starmem_stats[itag].name[STARMEM__SZTAG - 1] = '\0';
+  return itag;
+}
+
+/*
+*  Name:
+*     starMemStatsCurrent
+
+*  Purpose:
+*     Get or set the current tag for the calling thread
+
+*  Invocation:
+*     int starMemStatsCurrent( int itag );
+
+*  Description:
+*     Returns the index of the calling thread's current tag. If "itag"
+*     is not negative, it then becomes the current tag.
+
+*/
+
+int starMemStatsCurrent( int itag ) {
+  int old;
+
+#if HAVE_PTHREAD_H
+  pthread_once( &starmem_stats_once, starMemStatsCreateKey );
+  if ( !starmem_stats_key_ok ) return 0;
+  old = (int) (intptr_t) pthread_getspecific( starmem_stats_key );
+  if ( itag >= 0 ) pthread_setspecific( starmem_stats_key,
+                                        (void *) (intptr_t) itag );
+#else
+  old = starmem_stats_tag;
+  if ( itag >= 0 ) starmem_stats_tag = itag;
+#endif
+
+  return old;
+}
+
+/*
+*  Name:
+*     starMemStatsAdd
+
+*  Purpose:
+*     Record a new allocation
+
+*  Invocation:
+*     void * starMemStatsAdd( void * base, size_t size, int itag );
+
+*  Description:
+*     Records that "size" bytes have been allocated under the tag with
+*     index "itag", or under the calling thread's current tag if "itag"
+*     is negative, using a block of at least size + STARMEM__STATS_HDR
+*     bytes starting at "base". The pointer to be returned to the caller of
+*     the allocation routine is returned. NULL is returned without
+*     action if "base" is NULL.
+
+*/
+
+void * starMemStatsAdd( void * base, size_t size, int itag ) {
+  starMemStatsHeader * hdr = base;
+  starMemStats * stats;
+  int i;
+
+  if ( !hdr ) return NULL;
+  hdr->info.size = size;
+  hdr->info.tag = ( itag < 0 ) ? starMemStatsCurrent( -1 ) : itag;
+
+  starMemStatsLock( 1 );
+  for ( i = 0; i < 2; i++ ) {
+    stats = ( i ? starmem_stats + STARMEM__MAXTAG :
+                  starmem_stats + hdr->info.tag );
+    stats->current += size;
+    if ( stats->current > stats->peak ) stats->peak = stats->current;
+    stats->count++;
+  }
+  starMemStatsLock( 0 );
+
+  return hdr + 1;
+}
+
+/*
+*  Name:
+*     starMemStatsRemove
+
+*  Purpose:
+*     Record that an allocation is being freed
+
+*  Invocation:
+*     void * starMemStatsRemove( void * ptr, size_t * size, int * itag );
+
+*  Description:
+*     Records that the block at "ptr", which must have been returned by
+*     starMemStatsAdd, is being freed. The start of the underlying
+*     block is returned. The recorded size and tag index are returned
+*     in "size" and "itag" if they are not NULL. NULL is returned without action if "ptr"
+*     is NULL.
+
+*/
+
+void * starMemStatsRemove( void * ptr, size_t * size, int * itag ) {
+  starMemStatsHeader * hdr;
+
+  if ( !ptr ) return NULL;
+  hdr = (starMemStatsHeader *) ptr - 1;
+  if ( size ) *size = hdr->info.size;
+  if ( itag ) *itag = hdr->info.tag;
+
+  starMemStatsLock( 1 );
+  starmem_stats[hdr->info.tag].current -= hdr->info.size;
+  starmem_stats[STARMEM__MAXTAG].current -= hdr->info.size;
+  starMemStatsLock( 0 );
+
+  return hdr;
+}
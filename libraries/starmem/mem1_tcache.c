@@ -0,0 +1,368 @@
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+/*
+*  Name:
+*     mem1_tcache.c
+
+*  Purpose:
+*     Private per-thread caching allocator for starmem
+
+*  Description:
+*     This file implements the "TC" malloc scheme. Small blocks are
+*     rounded up to one of a set of power-of-two size classes, and
+*     blocks that are freed are kept on a free list owned by the
+*     calling thread, from which later requests for the same size
+*     class are satisfied without taking any lock. Underneath, memory
+*     is obtained from dlmalloc. Since dlmalloc is not built with
+*     locking, all calls to it are serialised with a single mutex, but
+*     lists are refilled and trimmed in batches so that the mutex is
+*     rarely needed when many threads allocate and free small blocks.
+*     Large blocks are passed directly to dlmalloc.
+*
+*     Each block is preceded by a small header recording its size
+*     class, so a block may be freed by a thread other than the one
+*     that allocated it, in which case it joins the cache of the freeing
+*     thread. The cache of each thread is returned to dlmalloc when the
+*     thread exits.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*/
+
+/* System includes */
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#if HAVE_PTHREAD_H
+#  include <pthread.h>
+#endif
+
+/* Private includes */
+#include "mem1.h"
+
+/* Size classes are STARMEM__TC_MIN * 2^i bytes for i = 0 to
+   STARMEM__TC_NCLASS - 1. Larger requests are not cached. */
+#define STARMEM__TC_MIN 16
+#define STARMEM__TC_NCLASS 9
+#define STARMEM__TC_LARGE STARMEM__TC_NCLASS
+
+/* Maximum number of free blocks kept in each list, and the number of
+   blocks moved between a list and dlmalloc in one go */
+#define STARMEM__TC_MAXFREE 64
+#define STARMEM__TC_BATCH 16
+
+/* Block header. It is a union so that the memory following it has the
+   same alignment as memory returned by dlmalloc. */
+typedef union starMemTcHeader {
+  size_t sclass;                     /* Size class, or STARMEM__TC_LARGE */
+  void * next;                       /* Next free block (when cached) */
+  double align1;
+  void * align2;
+  char pad[16];
+} starMemTcHeader;
+
+#define STARMEM__TC_HDR sizeof(starMemTcHeader)
+
+/* The cache of one thread: a free list and its length for each class */
+typedef struct starMemTcache {
+  starMemTcHeader * head[STARMEM__TC_NCLASS];
+  int nfree[STARMEM__TC_NCLASS];
+} starMemTcache;
+
+#if HAVE_PTHREAD_H
+
+static pthread_mutex_t starmem_tc_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t starmem_tc_once = PTHREAD_ONCE_INIT;
+static pthread_key_t starmem_tc_key;
+static int starmem_tc_key_ok = 0;
+
+#define STARMEM__TC_LOCK pthread_mutex_lock( &starmem_tc_mutex )
+#define STARMEM__TC_UNLOCK pthread_mutex_unlock( &starmem_tc_mutex )
+
+#else
+
+/* Without threads there is a single cache and no locking */
+static starMemTcache * starmem_tcache = NULL;
+
+#define STARMEM__TC_LOCK
+#define STARMEM__TC_UNLOCK
+
+#endif
+
+/* Return the size class for a request of "size" bytes */
+static size_t starMemTcClass( size_t size ) {
+  size_t sclass = 0;
+  size_t csize = STARMEM__TC_MIN;
+  while ( csize < size && sclass < STARMEM__TC_LARGE ) {
+    csize *= 2;
+    sclass++;
+  }
+  return sclass;
+}
+
+/* Return "count" blocks from the list of class "sclass" to dlmalloc */
+static void starMemTcTrim( starMemTcache * tc, size_t sclass, int count ) {
+  starMemTcHeader * hdr;
+
+  STARMEM__TC_LOCK;
+  while ( count-- > 0 && tc->head[sclass] ) {
+    hdr = tc->head[sclass];
+    tc->head[sclass] = hdr->next;
+    tc->nfree[sclass]--;
+    dlfree( hdr );
+  }
+  STARMEM__TC_UNLOCK;
+}
+
+#if HAVE_PTHREAD_H
+
+/* Empty and free a cache. Called automatically when a thread exits. */
+static void starMemTcacheFree( void * ptr ) {
+  starMemTcache * tc = ptr;
+  size_t sclass;
+
+  if ( !tc ) return;
+  for ( sclass = 0; sclass < STARMEM__TC_NCLASS; sclass++ ) {
+    starMemTcTrim( tc, sclass, tc->nfree[sclass] );
+  }
+  free( tc );
+}
+
+/* Create the key used to locate each thread's cache */
+static void starMemTcCreateKey( void ) {
+  if ( pthread_key_create( &starmem_tc_key, starMemTcacheFree ) == 0 ) {
+    starmem_tc_key_ok = 1;
+  } else {
+    fprintf( stderr, "starMem: Failed to create cache Thread-Specific Data key\n" );
+  }
+}
+
+#endif
+
+/* Get the cache of the calling thread, creating it if necessary. NULL
+   is returned if no cache is available, in which case all blocks are
+   passed directly to dlmalloc. */
+static starMemTcache * starMemTcGet( void ) {
+  starMemTcache * tc;
+
+#if HAVE_PTHREAD_H
+  pthread_once( &starmem_tc_once, starMemTcCreateKey );
+  if ( !starmem_tc_key_ok ) return NULL;
+  tc = pthread_getspecific( starmem_tc_key );
+#else
+  tc = starmem_tcache;
+#endif
+
+  if ( !tc ) {
+    tc = calloc( 1, sizeof(*tc) );
+    if ( !tc ) return NULL;
+#if HAVE_PTHREAD_H
+    if ( pthread_setspecific( starmem_tc_key, tc ) ) {
+      free( tc );
+      return NULL;
+    }
+#else
+    starmem_tcache = tc;
+#endif
+  }
+
+  return tc;
+}
+
+/*
+*  Name:
+*     starMemTcMalloc
+
+*  Purpose:
+*     Allocate memory using the per-thread caching allocator
+
+*  Invocation:
+*     void * starMemTcMalloc( size_t size );
+
+*  Description:
+*     Allocates "size" bytes, re-using a block from the calling thread's
+*     cache if one of the right size class is available.
+
+*  Returned Value:
+*     starMemTcMalloc = void * (Returned)
+*        Pointer to the memory, or NULL if it could not be allocated.
+
+*/
+
+void * starMemTcMalloc( size_t size ) {
+  starMemTcHeader * hdr = NULL;
+  starMemTcache * tc;
+  size_t csize;
+  size_t sclass;
+  int i;
+
+  if ( size > SIZE_MAX - STARMEM__TC_HDR ) return NULL;
+  sclass = starMemTcClass( size );
+  tc = ( sclass < STARMEM__TC_LARGE ) ? starMemTcGet() : NULL;
+
+  if ( !tc ) {
+    /* Large block, or no cache: allocate exactly what is needed and
+       mark it as uncached */
+    STARMEM__TC_LOCK;
+    hdr = dlmalloc( size + STARMEM__TC_HDR );
+    STARMEM__TC_UNLOCK;
+    if ( !hdr ) return NULL;
+    hdr->sclass = STARMEM__TC_LARGE;
+    return hdr + 1;
+  }
+
+  /* Refill an empty list with a batch of blocks */
+  if ( !tc->head[sclass] ) {
+    csize = ( (size_t) STARMEM__TC_MIN << sclass ) + STARMEM__TC_HDR;
+    STARMEM__TC_LOCK;
+    for ( i = 0; i < STARMEM__TC_BATCH; i++ ) {
+      hdr = dlmalloc( csize );
+      if ( !hdr ) break;
+      hdr->next = tc->head[sclass];
+      tc->head[sclass] = hdr;
+      tc->nfree[sclass]++;
+    }
+    STARMEM__TC_UNLOCK;
+    if ( !tc->head[sclass] ) return NULL;
+  }
+
+  hdr = tc->head[sclass];
+  tc->head[sclass] = hdr->next;
+  tc->nfree[sclass]--;
+  hdr->sclass = sclass;
+  return hdr + 1;
+}
+
+/*
+*  Name:
+*     starMemTcCalloc
+
+*  Purpose:
+*     Allocate zeroed memory using the per-thread caching allocator
+
+*  Invocation:
+*     void * starMemTcCalloc( size_t nmemb, size_t size );
+
+*  Description:
+*     Allocates "nmemb" elements of "size" bytes each, initialised to
+*     zero. NULL is returned if the total size overflows.
+
+*/
+
+void * starMemTcCalloc( size_t nmemb, size_t size ) {
+  void * tmp;
+
+  if ( size != 0 && nmemb > SIZE_MAX / size ) return NULL;
+  tmp = starMemTcMalloc( nmemb * size );
+  if ( tmp ) memset( tmp, 0, nmemb * size );
+  return tmp;
+}
+
+/*
+*  Name:
+*     starMemTcFree
+
+*  Purpose:
+*     Free memory allocated by the per-thread caching allocator
+
+*  Invocation:
+*     void starMemTcFree( void * ptr, int force );
+
+*  Description:
+*     Frees memory allocated by starMemTcMalloc, starMemTcCalloc or
+*     starMemTcRealloc. Unless "force" is true, a small block is added
+*     to the calling thread's cache, and half of the cache for that
+*     size class is returned to dlmalloc if it has become full. If
+*     "force" is true, the block is returned to dlmalloc immediately.
+*     No action is taken if "ptr" is NULL.
+
+*/
+
+void starMemTcFree( void * ptr, int force ) {
+  starMemTcHeader * hdr;
+  starMemTcache * tc;
+  size_t sclass;
+
+  if ( !ptr ) return;
+  hdr = (starMemTcHeader *) ptr - 1;
+  sclass = hdr->sclass;
+
+  tc = ( !force && sclass < STARMEM__TC_LARGE ) ? starMemTcGet() : NULL;
+  if ( !tc ) {
+    STARMEM__TC_LOCK;
+    dlfree( hdr );
+    STARMEM__TC_UNLOCK;
+    return;
+  }
+
+  hdr->next = tc->head[sclass];
+  tc->head[sclass] = hdr;
+  if ( ++tc->nfree[sclass] > STARMEM__TC_MAXFREE ) {
+    starMemTcTrim( tc, sclass, STARMEM__TC_MAXFREE / 2 );
+  }
+}
+
+/*
+*  Name:
+*     starMemTcRealloc
+
+*  Purpose:
+*     Resize memory allocated by the per-thread caching allocator
+
+*  Invocation:
+*     void * starMemTcRealloc( void * ptr, size_t size );
+
+*  Description:
+*     Behaves like realloc. A small block is returned unchanged if the
+*     new size fits in its size class. Otherwise a new block is
+*     allocated and the contents copied, except for large blocks, which
+*     are resized by dlrealloc.
+
+*/
+
+void * starMemTcRealloc( void * ptr, size_t size ) {
+  starMemTcHeader * hdr;
+  size_t csize;
+  void * tmp;
+
+  if ( !ptr ) return starMemTcMalloc( size );
+  if ( size > SIZE_MAX - STARMEM__TC_HDR ) return NULL;
+  hdr = (starMemTcHeader *) ptr - 1;
+
+  if ( hdr->sclass == STARMEM__TC_LARGE ) {
+    STARMEM__TC_LOCK;
+    hdr = dlrealloc( hdr, size + STARMEM__TC_HDR );
+    STARMEM__TC_UNLOCK;
+    return hdr ? hdr + 1 : NULL;
+  }
+
+  csize = (size_t) STARMEM__TC_MIN << hdr->sclass;
+  if ( size <= csize && size > csize / 4 ) return ptr;
+
+  tmp = starMemTcMalloc( size );
+  if ( tmp ) {
+    memcpy( tmp, ptr, ( size < csize ) ? size : csize );
+    starMemTcFree( ptr, 0 );
+  }
+  return tmp;
+}
@@ -69,6 +69,27 @@ int main( void )
      assert(d[i] == 0.0);
    }
   starFree( d );
+
+  /* Nested arena scopes. Memory released by starArenaReset is re-used,
+     including after a request larger than an arena block. */
+  starArenaBegin();
+  d = starArenaMalloc( 100 * sizeof(double) );
+  assert( ((size_t) d % 16) == 0 );
+  for ( i = 0; i < 100; i++ ) d[i] = i;
+  for ( i = 0; i < 1000; ++i )
+   {
+     starArenaBegin();
+     q = starArenaMalloc( 10 * sizeof(int) );
+     assert( q != NULL );
+     q[9] = i;
+     assert( starArenaMalloc( 1024 * 1024 ) != NULL );
+     starArenaReset();
+     starArenaBegin();
+     assert( starArenaMalloc( sizeof(int) ) == q );
+     starArenaReset();
+   }
+  for ( i = 0; i < 100; i++ ) assert( d[i] == i );
+  starArenaReset();
   return 0;
 }
 
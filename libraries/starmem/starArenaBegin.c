@@ -0,0 +1,84 @@
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+/* System includes */
+#include <stdlib.h>
+
+/* Private includes */
+#include "mem.h"
+#include "mem1.h"
+
+
+/*
+*  Name:
+*     starArenaBegin
+
+*  Purpose:
+*     Begin a new scope for per-thread arena allocations
+
+*  Invocation:
+*     void starArenaBegin( void );
+
+*  Description:
+*     Each thread has its own memory arena from which short-lived
+*     scratch memory can be obtained quickly using starArenaMalloc,
+*     without taking any lock. This function records the current extent
+*     of the calling thread's arena. A subsequent call to starArenaReset
+*     from the same thread releases all arena memory allocated since
+*     this call, in a single operation. Calls may be nested.
+
+*  Notes:
+*     - Every call to starArenaBegin should be matched by a call to
+*       starArenaReset in the same thread.
+*     - The THR library calls this function before starting each job,
+*       and calls starArenaReset when the job completes.
+
+*  Copyright:
+*     Copyright (C) 2026 Science and Technology Facilities Council.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*/
+
+void starArenaBegin( void ) {
+  starMemArena * arena;
+  starMemArenaMark * mark;
+
+  arena = starMemArenaGet();
+  if ( !arena ) return;
+
+  /* Extend the stack of marks if required */
+  if ( arena->nmark == arena->maxmark ) {
+    int newmax = ( arena->maxmark ? 2 * arena->maxmark : 8 );
+    mark = realloc( arena->marks, newmax * sizeof(*mark) );
+    if ( !mark ) {
+      /* Note that the mark could not be stored, so that the matching
+         starArenaReset does not remove an earlier mark */
+      arena->nlost++;
+      return;
+    }
+    arena->marks = mark;
+    arena->maxmark = newmax;
+  }
+
+  /* Record the current position in the arena */
+  mark = arena->marks + (arena->nmark)++;
+  mark->block = arena->current;
+  mark->used = ( arena->current ? arena->current->used : 0 );
+}
@@ -0,0 +1,127 @@
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+/* System includes */
+#include <stdlib.h>
+
+/* Private includes */
+#include "mem.h"
+#include "mem1.h"
+
+
+/*
+*  Name:
+*     starArenaMalloc
+
+*  Purpose:
+*     Allocate scratch memory from the calling thread's arena
+
+*  Invocation:
+*     void * starArenaMalloc( size_t size );
+
+*  Description:
+*     This function allocates memory from a private arena belonging to
+*     the calling thread. No lock is required, and in most cases the
+*     allocation simply advances a pointer within a block of memory that
+*     is already owned by the arena. The memory is not initialised.
+*
+*     Arena memory must not be passed to starFree or to the system free.
+*     Instead, all memory allocated since the most recent call to
+*     starArenaBegin is released by the matching call to starArenaReset.
+
+*  Parameters:
+*     size = size_t (Given)
+*        Number of bytes to allocate.
+
+*  Returned Value:
+*     starArenaMalloc = void * (Returned)
+*        Pointer to allocated memory, aligned suitably for any type.
+*        NULL if the memory could not be obtained.
+
+*  Notes:
+*     - Arena memory is obtained directly from the system malloc,
+*       regardless of the scheme selected using STARMEM_MALLOC. It is not
+*       scanned by the garbage collector, so must not be used to hold the
+*       only reference to memory allocated by starMalloc when GC is in
+*       use.
+*     - Arena memory may only be used by other threads for as long as
+*       the allocating thread does not reset its arena.
+
+*  Copyright:
+*     Copyright (C) 2026 Science and Technology Facilities Council.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*/
+
+void * starArenaMalloc( size_t size ) {
+  starMemArena * arena;
+  starMemArenaBlock * block;
+  starMemArenaBlock * next;
+  size_t bsize;
+  void * tmp;
+
+  arena = starMemArenaGet();
+  if ( !arena ) return NULL;
+
+  /* Round the request up to preserve alignment */
+  if ( size == 0 ) size = 1;
+  size = ( size + STARMEM__ARENA_ALIGN - 1 ) & ~( (size_t) STARMEM__ARENA_ALIGN - 1 );
+
+  /* Use the current block if there is room */
+  block = arena->current;
+  if ( !block || block->used + size > block->size ) {
+
+    /* Otherwise, move on to the next block if it is big enough */
+    next = ( block ? block->next : arena->first );
+    if ( next && next->size >= size ) {
+      next->used = 0;
+      block = next;
+
+    /* Otherwise, create a new block and link it in after the current one */
+    } else {
+      bsize = ( size > STARMEM__ARENA_BLOCK ? size : STARMEM__ARENA_BLOCK );
+      next = malloc( STARMEM__ARENA_HEADER + bsize );
+      if ( !next ) return NULL;
+      next->size = bsize;
+      next->used = 0;
+      if ( block ) {
+        next->next = block->next;
+        block->next = next;
+      } else {
+        next->next = arena->first;
+        arena->first = next;
+      }
+      block = next;
+    }
+    arena->current = block;
+  }
+
+  /* Advance the pointer within the block */
+  tmp = (char *) block + STARMEM__ARENA_HEADER + block->used;
+  block->used += size;
+
+#if STARMEM_DEBUG
+  if (STARMEM_PRINT_MALLOC)
+    printf(__FILE__": Allocated %lu arena bytes into pointer %p\n",
+	   (unsigned long)size, tmp );
+#endif
+
+  return tmp;
+}
@@ -0,0 +1,96 @@
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+/* System includes */
+#include <stdlib.h>
+
+/* Private includes */
+#include "mem.h"
+#include "mem1.h"
+
+
+/*
+*  Name:
+*     starArenaReset
+
+*  Purpose:
+*     Release all arena memory allocated in the current scope
+
+*  Invocation:
+*     void starArenaReset( void );
+
+*  Description:
+*     This function releases all memory allocated by the calling thread
+*     using starArenaMalloc since the matching call to starArenaBegin.
+*     The time taken does not depend on the number of allocations being
+*     released. If there is no matching starArenaBegin, all arena memory
+*     allocated by the calling thread is released.
+*
+*     Released memory is retained by the arena for re-use by later
+*     calls to starArenaMalloc, except for any blocks that were created
+*     to satisfy unusually large requests, which are returned to the
+*     system.
+
+*  Copyright:
+*     Copyright (C) 2026 Science and Technology Facilities Council.
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*/
+
+void starArenaReset( void ) {
+  starMemArena * arena;
+  starMemArenaBlock * block;
+  starMemArenaBlock * next;
+  starMemArenaBlock ** prev;
+
+  arena = starMemArenaGet();
+  if ( !arena ) return;
+
+  /* If the matching starArenaBegin could not store its mark, there is
+     nothing we can safely release. */
+  if ( arena->nlost > 0 ) {
+    arena->nlost--;
+    return;
+  }
+
+  /* Return to the position recorded by the matching starArenaBegin, or
+     to the start of the arena if there is no such call */
+  if ( arena->nmark > 0 ) {
+    arena->nmark--;
+    arena->current = arena->marks[ arena->nmark ].block;
+    if ( arena->current ) arena->current->used = arena->marks[ arena->nmark ].used;
+  } else {
+    arena->current = NULL;
+  }
+
+  /* Free any oversized blocks that are no longer in use */
+  prev = ( arena->current ? &(arena->current->next) : &(arena->first) );
+  block = *prev;
+  while ( block ) {
+    next = block->next;
+    if ( block->size > STARMEM__ARENA_BLOCK ) {
+      *prev = next;
+      free( block );
+    } else {
+      prev = &(block->next);
+    }
+    block = next;
+  }
+}
@@ -79,6 +79,7 @@
 
 void * starCalloc( size_t nmemb, size_t size ) {
   void * tmp = NULL;
+  size_t rsize = 0;
 #if USE_AST_MALLOC
   int ast_status = 0;
   int *old_ast_status = NULL;
@@ -91,6 +92,16 @@ void * starCalloc( size_t nmemb, size_t size ) {
      starMemInit */
   if ( ! STARMEM_INITIALISED ) starMemInitPrivate(0);
 
+  /* Make room for the accounting header, allocating a single element */
+  if ( STARMEM_STATS ) {
+    if ( size != 0 && nmemb > ( (size_t) -1 - STARMEM__STATS_HDR ) / size ) {
+      return NULL;
+    }
+    rsize = nmemb * size;
+    nmemb = 1;
+    size = rsize + STARMEM__STATS_HDR;
+  }
+
   /* Decide which malloc to use */
   switch (STARMEM_MALLOC) {
 
@@ -112,6 +123,10 @@ void * starCalloc( size_t nmemb, size_t size ) {
     tmp = dlcalloc( nmemb, size );
     break;
 
+  case STARMEM__TC:
+    tmp = starMemTcCalloc( nmemb, size );
+    break;
+
   case STARMEM__GC:
 #if HAVE_LIBGC && HAVE_GC_H
     /* Call normal malloc since we know the GC initialises memory */
@@ -126,6 +141,8 @@ void * starCalloc( size_t nmemb, size_t size ) {
 
   }
 
+  if ( STARMEM_STATS ) tmp = starMemStatsAdd( tmp, rsize, -1 );
+
 #if STARMEM_DEBUG
   if (STARMEM_PRINT_MALLOC)
     printf(__FILE__": Allocated %lu elements of size %lu bytes into pointer %p\n",
@@ -77,6 +77,9 @@ void starFree( void * ptr ) {
     printf(__FILE__": Free pointer %p\n", ptr );
 #endif
 
+  /* Remove the block from the statistics */
+  if ( STARMEM_STATS ) ptr = starMemStatsRemove( ptr, NULL, NULL );
+
   switch ( STARMEM_MALLOC ) {
 
   case STARMEM__SYSTEM:
@@ -97,6 +100,10 @@ void starFree( void * ptr ) {
     dlfree( ptr );
     break;
 
+  case STARMEM__TC:
+    starMemTcFree( ptr, 0 );
+    break;
+
   case STARMEM__GC:
     /* Nothing to do if garbage collector selected */
     break;
@@ -80,6 +80,9 @@ void starFreeForce( void * ptr ) {
     printf(__FILE__": Free pointer %p\n", ptr );
 #endif
 
+  /* Remove the block from the statistics */
+  if ( STARMEM_STATS ) ptr = starMemStatsRemove( ptr, NULL, NULL );
+
   switch ( STARMEM_MALLOC ) {
 
   case STARMEM__SYSTEM:
@@ -100,6 +103,10 @@ void starFreeForce( void * ptr ) {
     dlfree( ptr );
     break;
 
+  case STARMEM__TC:
+    starMemTcFree( ptr, 1 );
+    break;
+
   case STARMEM__GC:
 #if HAVE_LIBGC && HAVE_GC_H
     GC_FREE( ptr );
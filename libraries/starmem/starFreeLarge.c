@@ -0,0 +1,76 @@
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+/* System includes */
+#include <stdlib.h>
+#include <stdint.h>
+#if HAVE_SYS_MMAN_H
+#  include <sys/mman.h>
+#endif
+
+/* Private includes */
+#include "mem.h"
+#include "mem1.h"
+
+
+/*
+*  Name:
+*     starFreeLarge
+
+*  Purpose:
+*     Free an array allocated by starMallocLarge
+
+*  Invocation:
+*     void starFreeLarge( void * ptr );
+
+*  Description:
+*     This function frees memory allocated by starMallocLarge. Mapped
+*     memory is returned to the operating system immediately.
+
+*  Parameters:
+*     ptr = void * (Given)
+*        Pointer to memory to be freed. No action is taken if this is
+*        NULL.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*/
+
+void starFreeLarge( void * ptr ) {
+  starMemLargeHeader * hdr;
+
+  if ( !ptr ) return;
+
+  /* Remove the array from the statistics */
+  if ( STARMEM_STATS ) (void) starMemStatsRemove( ptr, NULL, NULL );
+
+  hdr = (starMemLargeHeader *) ( (char *) ptr - STARMEM__LARGE_HDR );
+
+#if HAVE_SYS_MMAN_H && HAVE_MMAP
+  if ( hdr->maplen > 0 ) {
+    munmap( hdr->base, hdr->maplen );
+    return;
+  }
+#endif
+
+  free( hdr->base );
+}
@@ -83,6 +83,7 @@
 
 void * starMalloc( size_t size ) {
   void * tmp = NULL;
+  size_t rsize = 0;
   static const size_t THRESHOLD = 1024 * 100; /* Bytes */
 #if USE_AST_MALLOC
   int ast_status = 0;
@@ -96,6 +97,13 @@ void * starMalloc( size_t size ) {
      starMemInit */
   if ( ! STARMEM_INITIALISED ) starMemInitPrivate(0);
 
+  /* Make room for the accounting header */
+  if ( STARMEM_STATS ) {
+    if ( size + STARMEM__STATS_HDR < size ) return NULL;
+    rsize = size;
+    size += STARMEM__STATS_HDR;
+  }
+
   /* Decide which to use */
   switch ( STARMEM_MALLOC ) {
 
@@ -117,6 +125,10 @@ void * starMalloc( size_t size ) {
     tmp = dlmalloc( size );
     break;
 
+  case STARMEM__TC:
+    tmp = starMemTcMalloc( size );
+    break;
+
   case STARMEM__GC:
 #if HAVE_LIBGC && HAVE_GC_H
     if ( size < THRESHOLD ) {
@@ -133,6 +145,8 @@ void * starMalloc( size_t size ) {
     starMemFatalNone;
   }
 
+  if ( STARMEM_STATS ) tmp = starMemStatsAdd( tmp, rsize, -1 );
+
 #if STARMEM_DEBUG
   if (STARMEM_PRINT_MALLOC)
     printf(__FILE__": Allocated %lu bytes into pointer %p\n",
@@ -0,0 +1,158 @@
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+/* System includes */
+#include <stdlib.h>
+#include <stdint.h>
+#if HAVE_SYS_MMAN_H
+#  include <sys/mman.h>
+#endif
+
+/* Private includes */
+#include "mem.h"
+#include "mem1.h"
+
+#if HAVE_SYS_MMAN_H && !defined( MAP_ANONYMOUS ) && defined( MAP_ANON )
+#  define MAP_ANONYMOUS MAP_ANON
+#endif
+
+/*
+*  Name:
+*     starMallocLarge
+
+*  Purpose:
+*     Allocate a large, aligned array
+
+*  Invocation:
+*     void * starMallocLarge( size_t size );
+
+*  Description:
+*     This function allocates memory for a large array. The returned
+*     pointer is always aligned to a multiple of STARMEM_LARGE_ALIGN
+*     bytes, so that vectorised loops may rely on the alignment of the
+*     first element. Arrays of at least STARMEM__LARGE_MIN bytes are
+*     mapped directly from the operating system, and are aligned to a
+*     huge page boundary and marked (using madvise) as candidates for
+*     transparent huge pages, which reduces TLB misses when the array
+*     is accessed. If the STARMEM_HUGETLB environment variable is
+*     defined, explicit huge pages (MAP_HUGETLB) are tried first.
+*     Smaller arrays are obtained from the system malloc.
+
+*  Parameters:
+*     size = size_t (Given)
+*        Number of bytes to allocate.
+
+*  Returned Value:
+*     starMallocLarge = void * (Returned)
+*        Pointer to allocated memory. NULL if the memory could not be
+*        obtained. The memory is not initialised, except that mapped
+*        memory is initially zero.
+
+*  Notes:
+*     - This memory must be freed using starFreeLarge, and never
+*       starFree or the system free.
+*     - The memory is not obtained using the scheme selected by
+*       STARMEM_MALLOC. It is not scanned by the garbage collector, so
+*       must not be used to hold the only reference to memory allocated
+*       by starMalloc when GC is in use.
+*     - The memory is included in the statistics recorded when
+*       STARMEM_STATS is defined.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*/
+
+void * starMallocLarge( size_t size ) {
+  starMemLargeHeader * hdr;
+  char * base = NULL;
+  char * raw;
+  size_t total;
+  void * tmp;
+#if HAVE_SYS_MMAN_H && HAVE_MMAP
+  size_t lead;
+  size_t maplen;
+#endif
+
+  if ( ! STARMEM_INITIALISED ) starMemInitPrivate(0);
+
+  /* Room is needed for the header, which keeps the array aligned, and
+     for aligning the start of the memory */
+  if ( size > (size_t) -1 - STARMEM__LARGE_HDR - STARMEM__HUGE_PAGE ) {
+    return NULL;
+  }
+  total = size + STARMEM__LARGE_HDR;
+
+#if HAVE_SYS_MMAN_H && HAVE_MMAP
+  if ( total >= STARMEM__LARGE_MIN ) {
+    maplen = ( total + STARMEM__HUGE_PAGE - 1 ) & ~( STARMEM__HUGE_PAGE - 1 );
+
+#if defined( MAP_HUGETLB )
+    /* Explicit huge pages, which are always suitably aligned */
+    if ( STARMEM_HUGETLB ) {
+      base = mmap( NULL, maplen, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+      if ( base == MAP_FAILED ) base = NULL;
+    }
+#endif
+
+    /* Otherwise map an extra huge page and unmap the unused parts at
+       each end, so that the array starts on a huge page boundary */
+    if ( !base ) {
+      raw = mmap( NULL, maplen + STARMEM__HUGE_PAGE, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+      if ( raw == MAP_FAILED ) return NULL;
+      lead = ( STARMEM__HUGE_PAGE - (uintptr_t) raw % STARMEM__HUGE_PAGE ) %
+             STARMEM__HUGE_PAGE;
+      if ( lead > 0 ) munmap( raw, lead );
+      munmap( raw + lead + maplen, STARMEM__HUGE_PAGE - lead );
+      base = raw + lead;
+#if HAVE_MADVISE && defined( MADV_HUGEPAGE )
+      madvise( base, maplen, MADV_HUGEPAGE );
+#endif
+    }
+
+    hdr = (starMemLargeHeader *) base;
+    hdr->base = base;
+    hdr->maplen = maplen;
+
+  } else
+#endif
+  {
+    /* Over-allocate from malloc and align the array within the block */
+    raw = malloc( total + STARMEM_LARGE_ALIGN );
+    if ( !raw ) return NULL;
+    base = raw + ( STARMEM_LARGE_ALIGN - (uintptr_t) raw % STARMEM_LARGE_ALIGN ) %
+                 STARMEM_LARGE_ALIGN;
+    hdr = (starMemLargeHeader *) base;
+    hdr->base = raw;
+    hdr->maplen = 0;
+  }
+
+  /* The array follows the header. Any accounting header occupies the
+     end of the large-block header. */
+  tmp = base + STARMEM__LARGE_HDR;
+  if ( STARMEM_STATS ) {
+    tmp = starMemStatsAdd( (char *) tmp - STARMEM__STATS_HDR, size, -1 );
+  }
+
+  return tmp;
+}
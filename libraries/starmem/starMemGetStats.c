@@ -0,0 +1,103 @@
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+/* System includes */
+#include <stdlib.h>
+
+/* Private includes */
+#include "mem.h"
+#include "mem1.h"
+
+
+/*
+*  Name:
+*     starMemGetStats
+
+*  Purpose:
+*     Get the memory statistics for a tag
+
+*  Invocation:
+*     int starMemGetStats( const char * tag, size_t * current,
+*                          size_t * peak, size_t * count );
+
+*  Description:
+*     Returns the statistics recorded for the named tag (see
+*     starMemSetTag), or for all tags together, when memory accounting
+*     has been enabled by defining the STARMEM_STATS environment
+*     variable.
+
+*  Parameters:
+*     tag = const char * (Given)
+*        The name of the tag, or NULL to get the totals for all tags.
+*     current = size_t * (Returned)
+*        The number of bytes currently allocated. May be NULL.
+*     peak = size_t * (Returned)
+*        The largest number of bytes allocated at any one time. May be
+*        NULL.
+*     count = size_t * (Returned)
+*        The number of allocations made, including reallocations. May
+*        be NULL.
+
+*  Returned Value:
+*     starMemGetStats = int (Returned)
+*        Non-zero if statistics were returned. Zero if memory
+*        accounting is not enabled or the tag has not been used, in which
+*        case all the returned values are set to zero.
+
+*  Notes:
+*     - Only the bytes requested by callers are counted, not the
+*       overheads of the allocator.
+*     - Memory obtained using starArenaMalloc is not included.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*/
+
+int starMemGetStats( const char * tag, size_t * current, size_t * peak,
+                     size_t * count ) {
+  starMemStats * stats = NULL;
+  int itag;
+  int result = 0;
+
+  if ( current ) *current = 0;
+  if ( peak ) *peak = 0;
+  if ( count ) *count = 0;
+  if ( ! STARMEM_STATS ) return 0;
+
+  starMemStatsLock( 1 );
+  if ( tag ) {
+    itag = starMemStatsFind( tag, 0 );
+    if ( itag >= 0 ) stats = starMemStatsTag( itag );
+  } else {
+    stats = starMemStatsTag( -1 );
+  }
+
+  if ( stats ) {
+    if ( current ) *current = stats->current;
+    if ( peak ) *peak = stats->peak;
+    if ( count ) *count = stats->count;
+    result = 1;
+  }
+  starMemStatsLock( 0 );
+
+  return result;
+}
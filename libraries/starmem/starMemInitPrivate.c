@@ -51,6 +51,10 @@
 *        Add STARMEM_PRINT_INFO
 *     26-APR-2006 (TIMJ):
 *        Check for libgc *and* gc.h
+*     14-OCT-2026:
+*        Add TC
+*     14-OCT-2026:
+*        Add STARMEM_STATS and STARMEM_HUGETLB
 
 *  Notes:
 *     - This function is private and should only be called from the
@@ -64,6 +68,9 @@
 *       GC: Garbage Collection must be used. An error occurs if that is
 *           not available. Since EMS is unavailable, the error will
 *           be printed to stderr and the system will fallback to SYSTEM.
+*       TC: Use dlmalloc with a cache of small blocks for each thread.
+*           This scales better than DL when many threads allocate and
+*           free small blocks, since most requests need no lock.
 *       SYSTEM: Use normal system malloc/free. This is useful for valgrind
 *           usage (valgrind does not work with GC).
 *       If the variable is unset, GC is used if available else SYSTEM is
@@ -78,6 +85,12 @@
 *       environment variable is not defined.
 *     - If the STARMEM_PRINT_INFO environment variable is defined
 *       the selected malloc will be printed to stdout.
+*     - If the STARMEM_STATS environment variable is defined, the memory
+*       allocated under each tag (see starMemSetTag) is recorded, and
+*       the statistics are displayed on exit (see starMemPrintStats).
+*     - If the STARMEM_HUGETLB environment variable is defined, explicit
+*       huge pages are used for large arrays if possible (see
+*       starMallocLarge).
 
 *  Copyright:
 *     Copyright (C) 2006 Particle Physics and Astronomy Research Council.
@@ -120,6 +133,18 @@ starMemInitPrivate( int gc_initialised ) {
     STARMEM_PRINT_INFO = 1;
   }
 
+  /* See if STARMEM_STATS is defined. If so, enable accounting and
+     display the statistics on exit */
+  if ( getenv( "STARMEM_STATS" ) ) {
+    STARMEM_STATS = 1;
+    atexit( starMemPrintStats );
+  }
+
+  /* See if STARMEM_HUGETLB is defined */
+  if ( getenv( "STARMEM_HUGETLB" ) ) {
+    STARMEM_HUGETLB = 1;
+  }
+
   /* Read the STARMEM_MALLOC environment variable */
   starenv = getenv( "STARMEM_MALLOC" );
 
@@ -148,6 +173,10 @@ starMemInitPrivate( int gc_initialised ) {
     /* use system version */
     STARMEM_MALLOC = STARMEM__DL;
 
+  } else if (strncmp(starenv, "TC", 2) == 0) {
+    /* use per-thread caches on top of dlmalloc */
+    STARMEM_MALLOC = STARMEM__TC;
+
   } else if (strncmp(starenv, "GC", 2) == 0 ) {
     /* Garbage Collector mandatory */
 #if HAVE_LIBGC && HAVE_GC_H
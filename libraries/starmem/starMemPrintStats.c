@@ -0,0 +1,84 @@
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+/* System includes */
+#include <stdlib.h>
+#include <stdio.h>
+
+/* Private includes */
+#include "mem.h"
+#include "mem1.h"
+
+static void starMemPrintOne( starMemStats * stats );
+
+/*
+*  Name:
+*     starMemPrintStats
+
+*  Purpose:
+*     Display the memory statistics
+
+*  Invocation:
+*     void starMemPrintStats( void );
+
+*  Description:
+*     Writes a table of the memory statistics recorded for each tag
+*     (see starMemSetTag), and the totals for all tags, to standard
+*     error. For each tag, the number of bytes currently allocated, the
+*     peak number of bytes allocated at any one time, and the number of
+*     allocations are shown. No action is taken if memory accounting
+*     has not been enabled by defining the STARMEM_STATS environment
+*     variable.
+
+*  Notes:
+*     - This function is called automatically on exit if STARMEM_STATS
+*       is defined.
+*     - The peak for all tags together may be less than the sum of the
+*       peaks for the individual tags.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*/
+
+void starMemPrintStats( void ) {
+  starMemStats * stats;
+  int itag;
+
+  if ( ! STARMEM_STATS ) return;
+
+  starMemStatsLock( 1 );
+  fprintf( stderr, "starMem: %-31s %15s %15s %12s\n", "Tag",
+           "Current bytes", "Peak bytes", "Allocations" );
+
+  /* Each tag that has been used, followed by the totals */
+  for ( itag = 0; ( stats = starMemStatsTag( itag ) ); itag++ ) {
+    if ( stats->count > 0 ) starMemPrintOne( stats );
+  }
+  starMemPrintOne( starMemStatsTag( -1 ) );
+  starMemStatsLock( 0 );
+}
+
+static void starMemPrintOne( starMemStats * stats ) {
+  fprintf( stderr, "starMem: %-31s %15lu %15lu %12lu\n", stats->name,
+           (unsigned long) stats->current, (unsigned long) stats->peak,
+           (unsigned long) stats->count );
+}
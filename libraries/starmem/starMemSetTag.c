@@ -0,0 +1,90 @@
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+/* System includes */
+#include <stdlib.h>
+
+/* Private includes */
+#include "mem.h"
+#include "mem1.h"
+
+
+/*
+*  Name:
+*     starMemSetTag
+
+*  Purpose:
+*     Set the tag under which memory allocations are recorded
+
+*  Invocation:
+*     const char * starMemSetTag( const char * tag );
+
+*  Description:
+*     When memory accounting is enabled by defining the STARMEM_STATS
+*     environment variable, the number of bytes allocated by starMalloc
+*     and related routines is recorded separately for each of a set of
+*     named tags. This function sets the tag used for subsequent
+*     allocations made by the calling thread. Memory that is freed or
+*     reallocated is always recorded under the tag that was current
+*     when it was first allocated, whichever thread frees it.
+
+*  Parameters:
+*     tag = const char * (Given)
+*        The name of the tag. Names longer than 31 characters are
+*        truncated. A NULL pointer selects the default "(untagged)" tag.
+
+*  Returned Value:
+*     starMemSetTag = const char * (Returned)
+*        The name of the previous tag for the calling thread, which can
+*        be passed to a later call to restore it. NULL is returned if
+*        memory accounting is not enabled.
+
+*  Notes:
+*     - At most 127 different tags can be used, in addition to the
+*       default tag. Further tags are recorded as "(untagged)".
+*     - Each thread starts with the default tag.
+
+*  Copyright:
+*     Copyright (C) 2026 East Asian Observatory
+*     All Rights Reserved.
+
+*  Licence:
+*     This program is free software; you can redistribute it and/or
+*     modify it under the terms of the GNU General Public License as
+*     published by the Free Software Foundation; either version 2 of
+*     the License, or (at your option) any later version.
+*
+*     This program is distributed in the hope that it will be
+*     useful, but WITHOUT ANY WARRANTY; without even the implied
+*     warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*     PURPOSE. See the GNU General Public License for more details.
+*
+*     You should have received a copy of the GNU General Public
+*     License along with this program; if not, write to the Free
+*     Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+*     MA 02110-1301, USA
+
+*/
+
+const char * starMemSetTag( const char * tag ) {
+  starMemStats * stats;
+  int itag = 0;
+
+  /* Accounting is selected on initialisation */
+  if ( ! STARMEM_INITIALISED ) starMemInitPrivate(0);
+  if ( ! STARMEM_STATS ) return NULL;
+
+  /* Find or create the tag */
+  starMemStatsLock( 1 );
+  if ( tag ) {
+    itag = starMemStatsFind( tag, 1 );
+    if ( itag < 0 ) itag = 0;
+  }
+
+  /* Make it current, and get the name of the previous tag */
+  stats = starMemStatsTag( starMemStatsCurrent( itag ) );
+  starMemStatsLock( 0 );
+
+  return stats ? stats->name : NULL;
+}
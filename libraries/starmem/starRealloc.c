@@ -85,6 +85,9 @@
 
 void * starRealloc( void * ptr, size_t size ) {
   void * tmp = NULL;
+  size_t oldsize = 0;
+  size_t rsize = 0;
+  int itag = 0;
 #if USE_AST_MALLOC
   int ast_status = 0;
   int *old_ast_status = NULL;
@@ -97,6 +100,16 @@ void * starRealloc( void * ptr, size_t size ) {
      starMemInit */
   if ( ! STARMEM_INITIALISED ) starMemInitPrivate(0);
 
+  /* Make room for the accounting header, and remove the old block
+     from the statistics */
+  if ( STARMEM_STATS ) {
+    if ( !ptr ) return starMalloc( size );
+    if ( size + STARMEM__STATS_HDR < size ) return NULL;
+    rsize = size;
+    size += STARMEM__STATS_HDR;
+    ptr = starMemStatsRemove( ptr, &oldsize, &itag );
+  }
+
   /* Decide which malloc to use */
   switch ( STARMEM_MALLOC ) {
 
@@ -118,6 +131,10 @@ void * starRealloc( void * ptr, size_t size ) {
     tmp = dlrealloc( ptr, size );
     break;
 
+  case STARMEM__TC:
+    tmp = starMemTcRealloc( ptr, size );
+    break;
+
   case STARMEM__GC:
 #if HAVE_LIBGC && HAVE_GC_H
     if (ptr == NULL) {
@@ -134,6 +151,16 @@ void * starRealloc( void * ptr, size_t size ) {
     starMemFatalNone;
   }
 
+  /* Record the new block, retaining the original tag. If the block
+     could not be resized, the original block is still allocated. */
+  if ( STARMEM_STATS ) {
+    if ( tmp ) {
+      tmp = starMemStatsAdd( tmp, rsize, itag );
+    } else {
+      (void) starMemStatsAdd( ptr, oldsize, itag );
+    }
+  }
+
 #if STARMEM_DEBUG
   if (STARMEM_PRINT_MALLOC)
     printf(__FILE__": Realloc %lu bytes from pointer %p to pointer %p\n", size, ptr, tmp );
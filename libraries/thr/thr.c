@@ -35,8 +35,22 @@
 *     - thrDestroyWorkforce: Free all resources used by a workforce.
 *     - thrGetWorkforce: Get a pointer to an existing workforce, or
 *       create a new one if no workforce currently exists.
+*     - thrGraphAdd: Add a job to a job dependency graph.
+*     - thrGraphDepend: Record that one job in a graph depends on another.
+*     - thrGraphFree: Free a job dependency graph.
+*     - thrGraphNew: Create a new job dependency graph.
+*     - thrGraphRun: Run all the jobs in a graph, starting each one as
+*       soon as the jobs on which it depends have completed.
 *     - thrJobWait: Block the calling thread until the next job has
 *       been completed.
+*     - thrMallocLocal: Allocate zeroed memory, distributing the pages
+*       between the NUMA nodes used by a workforce.
+*     - thrParallelFor: Execute a function for every index in a range,
+*       splitting the range dynamically between the workers.
+*     - thrParallelReduce: As thrParallelFor, but also combine a result
+*       returned by each worker into a single value.
+*     - thrSetJobTag: Set the tag used to identify subsequent jobs in a
+*       trace of workforce activity.
 *     - thrThreadData: Returns an AST KeyMap associated with the running
 *       thread that can be used to store thread-speicific global data.
 *       workforce currently knows about have been completed.
@@ -129,16 +143,33 @@
 
 /* Include files */
 /* ------------- */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+/* This gives us the CPU affinity functions and macros. */
+#if !defined( _GNU_SOURCE )
+#  define _GNU_SOURCE
+#endif
+
 /* System include files */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <pthread.h>
 #include <sys/time.h>
 #include <unistd.h>
+#if HAVE_SCHED_H
+#  include <sched.h>
+#endif
+#if HAVE_DLFCN_H && HAVE_DLADDR
+#  include <dlfcn.h>
+#endif
 
 /* Starlink include files */
 #include "ast.h"
+#include "star/mem.h"
 #include "sae_par.h"
 #include "mers.h"
 #include "ems.h"
@@ -154,6 +185,31 @@
 #define ACTIVE "GREEN"
 #define thr1ThreadLog(text,col,job) {if( fd ) thr1ThreadLog_(text,col,job);}
 
+/* The maximum number of completed jobs a worker using the work-stealing
+   scheduler will hold before reporting them at the job desk. */
+#define MAX_DONE 32
+
+/* When thrParallelFor or thrParallelReduce choose a default grain size,
+   it is chosen so that each worker claims at least this many chunks
+   from a uniform range of indices. */
+#define RANGE_CHUNKS 16
+
+/* CPU affinity policies that may be selected using environment variable
+   THR_AFFINITY. */
+#define AFFINITY_NONE 0
+#define AFFINITY_COMPACT 1
+#define AFFINITY_SCATTER 2
+
+/* The largest NUMA node index that will be looked for. */
+#define MAX_NODE 256
+
+/* Use CPU affinity only if the system supports it. */
+#if HAVE_PTHREAD_SETAFFINITY_NP && HAVE_SCHED_GETAFFINITY && defined( CPU_SETSIZE )
+#  define USE_AFFINITY 1
+#else
+#  define USE_AFFINITY 0
+#endif
+
 /* Module types */
 /* ------------ */
 typedef struct JobError {
@@ -162,6 +218,50 @@ typedef struct JobError {
    char **messages;
 } JobError;
 
+/* Describes one event recorded when tracing is enabled (see environment
+   variable THR_TRACE). Times are in microseconds from the creation of
+   the workforce. */
+struct ThrTraceEvent {
+   const char *tag;         /* Tag in force when the job was submitted */
+   void (*func)( void *, int * ); /* Job function, or NULL for a wait */
+   int ijob;                /* Job identifier, or zero for a wait */
+   int worker;              /* Index of worker, or -1 for other threads */
+   double submit;           /* Time at which the job was submitted */
+   double start;            /* Time at which the job or wait started */
+   double end;              /* Time at which the job or wait ended */
+};
+
+/* Describes a range of indices being processed by thrParallelFor or
+   thrParallelReduce. */
+typedef struct ThrRange {
+   pthread_mutex_t mutex;   /* Controls access to "next" and "abort" */
+   size_t next;             /* The next index to be claimed */
+   size_t last;             /* The last index to be processed */
+   size_t grain;            /* The minimum number of indices in a chunk */
+   size_t divisor;          /* Remaining range is divided by this */
+   int abort;               /* Set non-zero when any job fails */
+   void *data;              /* The caller-supplied data pointer */
+   void (*ffunc)( void *, size_t, size_t, int * );
+   void (*rfunc)( void *, size_t, size_t, void *, int * );
+} ThrRange;
+
+/* Describes a single job created by thrParallelFor or thrParallelReduce. */
+typedef struct ThrRangeJob {
+   ThrRange *range;         /* The range being processed */
+   void *result;            /* The partial result for this job, or NULL */
+} ThrRangeJob;
+
+/* Describes a block of memory being initialised by thrMallocLocal. */
+typedef struct ThrTouch {
+   pthread_mutex_t mutex;   /* Controls access to "narrived" */
+   pthread_cond_t cond;     /* Signals "all jobs have arrived" */
+   int narrived;            /* Number of jobs that have started */
+   ThrWorkForce *workforce; /* The workforce doing the initialisation */
+   char *mem;               /* The memory being initialised */
+   size_t size;             /* The number of bytes in "mem" */
+   size_t bsize;            /* The number of bytes touched by each worker */
+} ThrTouch;
+
 /* Module variables */
 /* ---------------- */
 static FILE *fd = NULL;
@@ -170,11 +270,34 @@ pthread_mutex_t fd_mutex = PTHREAD_MUTEX_INITIALIZER;
 static ThrWorkForce *singleton = NULL;
 pthread_once_t starlink_thr_globals_initialised = PTHREAD_ONCE_INIT;
 pthread_key_t starlink_thr_globals_key;
+static pthread_once_t thr_worker_key_created = PTHREAD_ONCE_INIT;
+static pthread_key_t thr_worker_key;
+static pthread_once_t thr_tag_key_created = PTHREAD_ONCE_INIT;
+static pthread_key_t thr_tag_key;
 
 
 /* Module Prototypes */
 /* ----------------- */
 static int thr1GetJobContext( ThrWorkForce *workforce, int *status );
+static int thr1ClaimRange( ThrRange *range, size_t *first, size_t *last );
+static int *thr1CpuList( int policy, int *ncpu, int *status );
+static int thr1WorkerIndex( ThrWorkForce *workforce );
+static double thr1TraceTime( ThrWorkForce *workforce );
+static void thr1TagCreateKey( void );
+static void thr1TraceAdd( ThrWorkForce *workforce, const char *tag,
+                          void (*func)( void *, int * ), int ijob, int worker,
+                          double submit, double start, double end,
+                          int *status );
+static void thr1TraceWrite( ThrWorkForce *workforce );
+static void thr1TouchJob( void *job_data, int *status );
+static void thr1DoRange( ThrWorkForce *wf, size_t first, size_t last,
+                         size_t grain, void *data,
+                         void (*ffunc)( void *, size_t, size_t, int * ),
+                         void (*rfunc)( void *, size_t, size_t, void *, int * ),
+                         size_t size, void *result,
+                         void (*reduce)( void *, void *, const void *, int * ),
+                         int *status );
+static void thr1RangeJob( void *job_data, int *status );
 static int thr1ListIsEmpty( int conid, ThrJob *head, int *status );
 static ThrJob *thr1FindJob( ThrJob *head, int ijob, int conid, int *status );
 static ThrJob *thr1FreeJob( ThrJob *job );
@@ -185,7 +308,16 @@ static ThrJobStatus *thr1FreeStatus( ThrJobStatus *status );
 static ThrJobStatus *thr1GetStatus( int *ems_status );
 static ThrJobStatus *thr1MakeStatus( void );
 static ThrJobStatus *thr1ReportStatus( ThrJobStatus *status, int *ems_status );
+static ThrJob *thr1GetQueuedJob( ThrWorker *worker, int *status );
+static int thr1QueuedJobs( ThrWorkForce *workforce, int *status );
+static void *thr1RunStealWorker( void *worker_ptr );
 static void *thr1RunWorker( void *worker_ptr );
+static void thr1FlushDone( ThrWorker *worker, int *status );
+static void thr1JobDone( ThrWorkForce *wf, ThrJob *job, ThrWorker *worker, int *status );
+static void thr1QueueJob( ThrWorkForce *wf, ThrJob *job, ThrWorker *worker, int *status );
+static void thr1QueuePush( ThrJob *job, ThrJob **head, int foot );
+static void thr1QueueRemove( ThrJob *job, ThrJob **head );
+static void thr1WorkerCreateKey( void );
 static void thr1ClearStatus( ThrJobStatus *status );
 static void thr1ExportJobs( ThrJob *head, int old, int new, int *status );
 static void thr1InitJobs( ThrJob *job, int *status );
@@ -247,6 +379,10 @@ int thrAddJob( ThrWorkForce *workforce, int flags, void *data,
 *        A pointer to a function that the worker will invoke to do the
 *        job. This function takes two arguments; 1) the supplied "data"
 *        pointer, and 2) an inherited status pointer. It returns void.
+*        Each job is run within its own starmem arena scope, so any
+*        scratch memory allocated by the job using starArenaMalloc is
+*        released automatically when the job completes (see
+*        starArenaBegin).
 *     nwait_on
 *        The number of values supplied in the "wait_on" array. If zero,
 *        the "wait_on" pointer will be ignored.
@@ -278,16 +414,21 @@ int thrAddJob( ThrWorkForce *workforce, int flags, void *data,
 /* Local Variables: */
    ThrJob *job;
    ThrJob *job2;
+   ThrWorker *worker;
    int i;
    int ijob2;
+   int result;
 
 /* Check inherited status */
    if( *status != SAI__OK ) return 0;
 
 /* If no work force was supplied, execute the job immediately in the
-   current thread, and then return. */
+   current thread, and then return. Any scratch memory allocated by the
+   job using starArenaMalloc is released when the job completes. */
    if( !workforce ) {
+      starArenaBegin();
       (*func)( data, status );
+      starArenaReset();
       return 0;
    }
 
@@ -324,6 +465,13 @@ int thrAddJob( ThrWorkForce *workforce, int flags, void *data,
 /* Store the current job context identifier. */
       job->conid = thr1GetJobContext( workforce, status );
 
+/* If tracing, record the submission time and the tag currently in force
+   in the calling thread. */
+      if( workforce->trace_file ) {
+         job->t_submit = thr1TraceTime( workforce );
+         job->tag = pthread_getspecific( thr_tag_key );
+      }
+
 /* If a list was supplied of earlier jobs that must complete prior to the
    start of the new job, then check each one and only include jobs that have
    not yet completed. */
@@ -369,6 +517,20 @@ int thrAddJob( ThrWorkForce *workforce, int flags, void *data,
          thr1PushListFoot( job, &(workforce->waiting_jobs), status );
          thr1ThreadLog( "add_job: Pushed job onto waiting jobs list",
                          DESK, job->ijob );
+
+/* If the workforce uses the work-stealing scheduler, put the job into
+   the queue of a specific worker instead. If the job is being added by
+   one of the workers in the workforce (i.e. from within another job),
+   use the queue belonging to that worker, since the new job is likely
+   to use data that is still in that worker's cache. Otherwise, share the
+   jobs out between the workers in turn. */
+      } else if( workforce->steal ) {
+         worker = pthread_getspecific( thr_worker_key );
+         if( worker && worker->workforce != workforce ) worker = NULL;
+         thr1QueueJob( workforce, job, worker, status );
+         thr1ThreadLog( "add_job: Pushed job onto worker queue",
+                         DESK, job->ijob );
+
       } else {
          thr1PushListFoot( job, &(workforce->available_jobs), status );
          thr1ThreadLog( "add_job: Pushed job onto available jobs list",
@@ -380,13 +542,17 @@ int thrAddJob( ThrWorkForce *workforce, int flags, void *data,
       }
    }
 
+/* Note the job identifier before leaving the job desk, since the job may
+   be completed and its structure re-used as soon as we leave. */
+   result = job ? job->ijob : 0;
+
 /* We can now leave the job desk, allowing the next thread in the job desk
    queue to access the workforce data. */
    thrMutexUnlock( &(workforce->jd_mutex), status );
-   thr1ThreadLog( "add_job: Job added", ACTIVE, job->ijob );
+   thr1ThreadLog( "add_job: Job added", ACTIVE, result );
 
 /* Return the job identifier. */
-   return job->ijob;
+   return result;
 }
 
 void thrBeginJobContext( ThrWorkForce *workforce, int *status ){
@@ -495,6 +661,20 @@ ThrWorkForce *thrCreateWorkforce( int nworker, int *status ) {
 *     (thread) who added the jobs to the table will respond to this
 *     signal by waking up and continuing with whetever else it has to
 *     do (which may include submitting more jobs to the job desk).
+*
+*     When large numbers of small jobs are submitted, the job desk queue
+*     can itself become the bottleneck. An alternative "work-stealing"
+*     scheduler can therefore be selected using environment variable
+*     THR_SCHEDULER (see "Environment Variables:" below). In this model,
+*     every available job is placed in a queue belonging to an individual
+*     worker, which is protected by its own mutex. Workers take jobs from
+*     the head of their own queue, and only when their own queue is empty
+*     do they "steal" jobs from the foot of the queues belonging to other
+*     workers. Workers also accumulate the descriptions of several
+*     completed jobs before reporting them all in a single visit to the
+*     job desk. Jobs that have the THR__REPORT_JOB flag set, or which
+*     fail, are reported immediately. Job contexts, job dependencies and
+*     error handling behave exactly as for the default scheduler.
 
 *  Arguments:
 *     nworker
@@ -508,14 +688,52 @@ ThrWorkForce *thrCreateWorkforce( int nworker, int *status ) {
 *     returned pool should be freed using thrDestroyWorkforce when
 *     no longer needed.
 
+*  Environment Variables:
+*     THR_AFFINITY
+*        Selects the CPU affinity policy for the worker threads. If set to
+*        "COMPACT" (case insensitive), each worker is bound to a single
+*        CPU, filling all the CPUs on one NUMA node before moving on to
+*        the next node. If set to "SCATTER", each worker is bound to a
+*        single CPU, with consecutive workers placed on different NUMA
+*        nodes in turn. Only CPUs that the process is allowed to use are
+*        considered, and workers are bound to CPUs cyclically if there
+*        are more workers than CPUs. Any other value, or no value, leaves
+*        the operating system free to move workers between CPUs. This
+*        variable is ignored on systems that do not support CPU affinity.
+*        See also thrMallocLocal.
+*     THR_SCHEDULER
+*        Selects the scheduler used by the new workforce. If set to
+*        "STEAL" (case insensitive) each worker has its own queue of jobs
+*        and idle workers steal jobs from the queues of busy workers. Any
+*        other value, or no value, causes all jobs to be distributed from
+*        a single shared job desk.
+*     THR_THREAD_LOG
+*        If set, a log of the activity of all threads is written to the
+*        named file (or to standard output if the value is "<stdout>").
+*     THR_TRACE
+*        If set, the submission, start and end times of every job run by
+*        the new workforce are recorded, together with the index of the
+*        worker that ran the job and the job's tag (see thrSetJobTag) or
+*        function name. The time spent in each call to thrWait is also
+*        recorded. When the workforce is destroyed, these are written to
+*        the named file in the Chrome trace event JSON format, which can
+*        be displayed using "chrome://tracing" or the Perfetto UI. If the
+*        name contains the string "%d", it is replaced by the process ID.
+
 *-
 */
 
 /* Local Variables: */
    ThrWorkForce *result = NULL;
+   ThrWorker *worker;
    int i;
-   pthread_t thread_id;
    char *logfile;
+   const char *affinity;
+   const char *sched;
+   const char *trace;
+   int *cpus;
+   int ncpu;
+   int policy;
 
 /* Check the inherited status and number of threads. */
    if( *status != SAI__OK || nworker == 0 ) return result;
@@ -552,12 +770,120 @@ ThrWorkForce *thrCreateWorkforce( int nworker, int *status ) {
       thrCondInit( &( result->page ), status );
       thrMutexInit( &( result->jd_mutex ), status );
       result->status = NULL;
+      result->workers = NULL;
+      result->next_worker = 0;
+      result->cpus = NULL;
+      result->threads = astMalloc( nworker*sizeof( *(result->threads) ) );
+      result->trace_file = NULL;
+      result->trace = NULL;
+      result->ntrace = 0;
+
+/* If required, prepare to record a trace of the jobs run by the
+   workforce. This includes ensuring the thread-specific data key used
+   to store job tags has been created. */
+      trace = getenv( "THR_TRACE" );
+      if( trace && trace[ 0 ] ) {
+         if( pthread_once( &thr_tag_key_created, thr1TagCreateKey ) &&
+             *status == SAI__OK ) {
+            *status = SAI__ERROR;
+            emsRep( "", "Failed to create the THR job tag key.", status );
+         }
+         result->trace_file = astMalloc( strlen( trace ) + 30 );
+         if( result->trace_file ) {
+            if( strstr( trace, "%d" ) ) {
+               sprintf( result->trace_file, trace, (int) getpid() );
+            } else {
+               strcpy( result->trace_file, trace );
+            }
+         }
+         gettimeofday( &(result->trace_t0), NULL );
+      }
+
+/* See if the workers are to be bound to specific CPUs. If so, get a list
+   of the available CPUs, in the order in which they are to be used, and
+   store the CPU to be used by each worker. */
+      policy = AFFINITY_NONE;
+      affinity = getenv( "THR_AFFINITY" );
+      if( affinity && USE_AFFINITY ) {
+         if( !strcasecmp( affinity, "COMPACT" ) ) {
+            policy = AFFINITY_COMPACT;
+         } else if( !strcasecmp( affinity, "SCATTER" ) ) {
+            policy = AFFINITY_SCATTER;
+         }
+      }
+
+      if( policy != AFFINITY_NONE ) {
+         cpus = thr1CpuList( policy, &ncpu, status );
+         if( cpus && ncpu > 0 ) {
+            result->cpus = astMalloc( nworker*sizeof( *(result->cpus) ) );
+            if( *status == SAI__OK ) {
+               for( i = 0; i < nworker; i++ ) {
+                  result->cpus[ i ] = cpus[ i % ncpu ];
+               }
+            }
+         }
+         cpus = astFree( cpus );
+      }
+
+/* See if the work-stealing scheduler is to be used. */
+      sched = getenv( "THR_SCHEDULER" );
+      result->steal = ( sched && !strcasecmp( sched, "STEAL" ) );
+
+/* If so, create and initialise a structure for each worker. Ensure the
+   thread-specific data key used to identify the worker running in each
+   thread has been created. */
+      if( result->steal ) {
+         if( pthread_once( &thr_worker_key_created, thr1WorkerCreateKey ) &&
+             *status == SAI__OK ) {
+            *status = SAI__ERROR;
+            emsRep( "", "Failed to create the THR worker data key.", status );
+         }
+
+         result->workers = astMalloc( nworker*sizeof( *(result->workers) ) );
+         if( *status == SAI__OK ) {
+            for( i = 0; i < nworker; i++ ) {
+               worker = result->workers + i;
+               worker->iworker = i;
+               worker->workforce = result;
+               worker->queue = NULL;
+               worker->done = NULL;
+               worker->ndone = 0;
+               thrMutexInit( &( worker->q_mutex ), status );
+            }
+         }
+      }
 
 /* Create the threads to host the workers. Each thread remains alive
    until the workforce is destroyed. During its life, the thread
-   loops round executing jobs off the workforce's available job list. */
-      for( i = 0; i < nworker; i++ ) {
-         thrThreadCreate( &thread_id, thr1RunWorker, result, status );
+   loops round executing jobs off the workforce's available job list,
+   or off its own job queue if the work-stealing scheduler is in use.
+   The identifier for each thread is stored, and is used to identify the
+   worker that is running a given job. */
+      for( i = 0; i < nworker && *status == SAI__OK; i++ ) {
+         if( result->steal ) {
+            thrThreadCreate( result->threads + i, thr1RunStealWorker,
+                             result->workers + i, status );
+         } else {
+            thrThreadCreate( result->threads + i, thr1RunWorker, result,
+                             status );
+         }
+
+/* If required, bind the new thread to its CPU. */
+#if USE_AFFINITY
+         if( result->cpus && *status == SAI__OK ) {
+            cpu_set_t mask;
+            CPU_ZERO( &mask );
+            CPU_SET( result->cpus[ i ], &mask );
+            if( pthread_setaffinity_np( result->threads[ i ], sizeof( mask ),
+                                        &mask ) ) {
+               *status = SAI__ERROR;
+               emsSeti( "I", i );
+               emsSeti( "C", result->cpus[ i ] );
+               emsRep( "", "Failed to bind THR worker ^I to CPU ^C.",
+                       status );
+            }
+         }
+#endif
       }
    }
 
@@ -607,6 +933,7 @@ ThrWorkForce *thrDestroyWorkforce( ThrWorkForce *workforce ) {
 /* Local Variables: */
    ThrJob *job;
    int status = SAI__OK;
+   int i;
    int nloop;
 
 /* Check a workforce was supplied. */
@@ -633,6 +960,14 @@ ThrWorkForce *thrDestroyWorkforce( ThrWorkForce *workforce ) {
                             &( workforce->jd_mutex ) );
       }
 
+/* If a trace of the jobs run by the workforce has been recorded, write
+   it out. */
+      if( workforce->trace_file ) {
+         thr1TraceWrite( workforce );
+         workforce->trace_file = astFree( workforce->trace_file );
+         workforce->trace = astFree( workforce->trace );
+      }
+
 /* Free the job description structures. */
       job = thr1PopListHead( &(workforce->active_jobs), &status );
       while( job ) {
@@ -667,6 +1002,20 @@ ThrWorkForce *thrDestroyWorkforce( ThrWorkForce *workforce ) {
 /* Unlock the job desk mutex prior to dstroying it. */
       pthread_mutex_unlock( &( workforce->jd_mutex ) );
 
+/* Free the structures describing the individual workers, if the
+   work-stealing scheduler was used. Any jobs still in their queues will
+   also have been on the active jobs list, and so have been freed above. */
+      if( workforce->workers ) {
+         for( i = 0; i < workforce->nworker; i++ ) {
+            pthread_mutex_destroy( &( workforce->workers[ i ].q_mutex ) );
+         }
+         workforce->workers = astFree( workforce->workers );
+      }
+
+/* Free the lists of thread identifiers and CPUs. */
+      workforce->threads = astFree( workforce->threads );
+      workforce->cpus = astFree( workforce->cpus );
+
 /* Free the mutex and condition variables used by the workforce. */
       pthread_mutex_destroy( &( workforce->jd_mutex ) );
       pthread_cond_destroy( &( workforce->all_done ) );
@@ -998,6 +1347,376 @@ ThrWorkForce *thrGetWorkforce( int nworker, int *status ) {
    return singleton;
 }
 
+int thrGraphAdd( ThrGraph *graph, int flags, void *data,
+                 void (*func)( void *, int * ), int *status ){
+/*
+*+
+*  Name:
+*     thrGraphAdd
+
+*  Purpose:
+*     Add a job to a job dependency graph.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     int thrGraphAdd( ThrGraph *graph, int flags, void *data,
+*                      void (*func)( void *, int * ), int *status )
+
+*  Description:
+*     This function adds a description of a job to a graph created by
+*     thrGraphNew. The job is not run until the graph is passed to
+*     thrGraphRun. Dependencies between the jobs in the graph can be
+*     described using thrGraphDepend, in any order.
+
+*  Arguments:
+*     graph
+*        Pointer to the graph.
+*     flags
+*        Flags controlling how the job behaves. These are passed on to
+*        thrAddJob each time the graph is run (see thrAddJob).
+*     data
+*        An arbitrary data pointer that will be passed to "func".
+*     func
+*        A pointer to the function that performs the job (see thrAddJob).
+*     status
+*        Pointer to the inherited status value.
+
+*  Returned Value:
+*     A positive integer identifier for the job within the graph. Zero if
+*     an error occurs.
+
+*-
+*/
+
+/* Local Variables: */
+   ThrGraphNode *node;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return 0;
+
+/* Extend the array of nodes. */
+   graph->nodes = astGrow( graph->nodes, graph->nnode + 1,
+                           sizeof( *(graph->nodes) ) );
+   if( *status != SAI__OK ) return 0;
+
+/* Initialise the new node. */
+   node = graph->nodes + (graph->nnode)++;
+   node->flags = flags;
+   node->data = data;
+   node->func = func;
+   node->nafter = 0;
+   node->after = NULL;
+   node->ijob = 0;
+
+/* Return the one-based node index. */
+   return graph->nnode;
+}
+
+void thrGraphDepend( ThrGraph *graph, int job, int after, int *status ){
+/*
+*+
+*  Name:
+*     thrGraphDepend
+
+*  Purpose:
+*     Record a dependency between two jobs in a job dependency graph.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     void thrGraphDepend( ThrGraph *graph, int job, int after,
+*                          int *status )
+
+*  Description:
+*     This function records that one job in a graph must not be started
+*     until another job in the same graph has completed. Dependencies
+*     may be recorded in any order, regardless of the order in which the
+*     jobs were added to the graph.
+
+*  Arguments:
+*     graph
+*        Pointer to the graph.
+*     job
+*        The identifier, returned by thrGraphAdd, for the job that is to
+*        wait.
+*     after
+*        The identifier, returned by thrGraphAdd, for the job that must
+*        complete before "job" can start.
+*     status
+*        Pointer to the inherited status value.
+
+*-
+*/
+
+/* Local Variables: */
+   ThrGraphNode *node;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Check the job identifiers. */
+   if( job < 1 || job > graph->nnode || after < 1 || after > graph->nnode ||
+       job == after ) {
+      *status = SAI__ERROR;
+      emsSeti( "J", job );
+      emsSeti( "A", after );
+      emsRep( "", "thrGraphDepend: Invalid job identifiers (^J and ^A) "
+              "supplied (programming error).", status );
+      return;
+   }
+
+/* Add "after" to the list of jobs on which "job" depends. */
+   node = graph->nodes + job - 1;
+   node->after = astGrow( node->after, node->nafter + 1,
+                          sizeof( *(node->after) ) );
+   if( *status == SAI__OK ) node->after[ (node->nafter)++ ] = after - 1;
+}
+
+ThrGraph *thrGraphFree( ThrGraph *graph ){
+/*
+*+
+*  Name:
+*     thrGraphFree
+
+*  Purpose:
+*     Free a job dependency graph.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     ThrGraph *thrGraphFree( ThrGraph *graph )
+
+*  Description:
+*     This function frees all resources used by a graph created by
+*     thrGraphNew. The job data pointers stored in the graph are not
+*     freed.
+
+*  Arguments:
+*     graph
+*        Pointer to the graph. If NULL is supplied, this function returns
+*        without action.
+
+*  Returned Value:
+*     A NULL pointer is returned.
+
+*  Notes:
+*     - This function attempts to execute even if an error has already
+*     occurred.
+
+*-
+*/
+
+/* Local Variables: */
+   int i;
+
+   if( graph ) {
+      for( i = 0; i < graph->nnode; i++ ) {
+         graph->nodes[ i ].after = astFree( graph->nodes[ i ].after );
+      }
+      graph->nodes = astFree( graph->nodes );
+      graph = astFree( graph );
+   }
+   return NULL;
+}
+
+ThrGraph *thrGraphNew( int *status ){
+/*
+*+
+*  Name:
+*     thrGraphNew
+
+*  Purpose:
+*     Create an empty job dependency graph.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     ThrGraph *thrGraphNew( int *status )
+
+*  Description:
+*     This function creates a new, empty, graph of jobs. Jobs are added
+*     to the graph using thrGraphAdd, and the dependencies between them
+*     are described using thrGraphDepend. The whole graph is then run
+*     using thrGraphRun, which submits each job to a workforce and starts
+*     each job as soon as all the jobs on which it depends have
+*     completed. Unlike a sequence of thrAddJob and thrWait calls, no
+*     job needs to wait for any unrelated jobs to complete. A graph may
+*     be run any number of times.
+
+*  Arguments:
+*     status
+*        Pointer to the inherited status value.
+
+*  Returned Value:
+*     A pointer to the new graph. It should be freed using thrGraphFree
+*     when no longer needed.
+
+*-
+*/
+
+/* Local Variables: */
+   ThrGraph *result;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return NULL;
+
+/* Allocate and initialise the graph. */
+   result = astMalloc( sizeof( *result ) );
+   if( result ) {
+      result->nnode = 0;
+      result->nodes = NULL;
+   }
+   return result;
+}
+
+void thrGraphRun( ThrWorkForce *workforce, ThrGraph *graph, int *status ){
+/*
+*+
+*  Name:
+*     thrGraphRun
+
+*  Purpose:
+*     Run all the jobs in a job dependency graph.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     void thrGraphRun( ThrWorkForce *workforce, ThrGraph *graph,
+*                       int *status )
+
+*  Description:
+*     This function submits all the jobs in the supplied graph to a
+*     workforce and waits until they have all completed. The jobs are
+*     sorted so that every job is submitted after the jobs on which it
+*     depends, and each job is started as soon as all such jobs have
+*     completed. Jobs are run within a new job context (see
+*     thrBeginJobContext), so this function does not wait for any other
+*     jobs that the workforce may be running.
+*
+*     An error is reported if the dependencies in the graph contain a
+*     cycle, in which case none of the jobs are run.
+
+*  Arguments:
+*     workforce
+*        Pointer to the workforce. If NULL is supplied, each job is
+*        performed in turn in the current thread, in an order that
+*        satisfies the dependencies.
+*     graph
+*        Pointer to the graph.
+*     status
+*        Pointer to the inherited status value.
+
+*  Notes:
+*     - This function should not be called from within a job that is
+*     being run by the supplied workforce.
+
+*-
+*/
+
+/* Local Variables: */
+   ThrGraphNode *node;
+   int *ndep;
+   int *order;
+   int *wait_on;
+   int i;
+   int ihead;
+   int inode;
+   int j;
+   int maxafter;
+   int nsorted;
+
+/* Check inherited status */
+   if( *status != SAI__OK || graph->nnode == 0 ) return;
+
+/* Allocate work arrays. */
+   ndep = astCalloc( graph->nnode, sizeof( *ndep ) );
+   order = astMalloc( graph->nnode*sizeof( *order ) );
+
+/* Sort the nodes into topological order using Kahn's algorithm. First
+   count the number of dependencies of each node that have not yet been
+   placed in the sorted list, and put the nodes that have no
+   dependencies in the sorted list. */
+   maxafter = 0;
+   nsorted = 0;
+   if( *status == SAI__OK ) {
+      for( inode = 0; inode < graph->nnode; inode++ ) {
+         node = graph->nodes + inode;
+         ndep[ inode ] = node->nafter;
+         if( node->nafter > maxafter ) maxafter = node->nafter;
+         if( node->nafter == 0 ) order[ nsorted++ ] = inode;
+      }
+
+/* Take each node in the sorted list in turn, and decrement the count for
+   every node that depends on it, appending any node whose count reaches
+   zero to the sorted list. The graphs used in practice are small, so a
+   search of all dependency lists is acceptable. */
+      for( ihead = 0; ihead < nsorted; ihead++ ) {
+         inode = order[ ihead ];
+         for( i = 0; i < graph->nnode; i++ ) {
+            node = graph->nodes + i;
+            for( j = 0; j < node->nafter; j++ ) {
+               if( node->after[ j ] == inode && --ndep[ i ] == 0 ) {
+                  order[ nsorted++ ] = i;
+               }
+            }
+         }
+      }
+
+/* If any nodes could not be sorted, the graph contains a cycle. */
+      if( nsorted < graph->nnode ) {
+         *status = SAI__ERROR;
+         emsRep( "", "thrGraphRun: The job dependencies contain a cycle "
+                 "(programming error).", status );
+      }
+   }
+
+/* Submit the jobs in sorted order, within a new job context. Each job
+   waits for the jobs on which it depends, which will already have been
+   submitted. */
+   wait_on = astMalloc( ( maxafter ? maxafter : 1 )*sizeof( *wait_on ) );
+   if( *status == SAI__OK ) {
+      thrBeginJobContext( workforce, status );
+      for( i = 0; i < graph->nnode; i++ ) {
+         node = graph->nodes + order[ i ];
+         for( j = 0; j < node->nafter; j++ ) {
+            wait_on[ j ] = graph->nodes[ node->after[ j ] ].ijob;
+         }
+         node->ijob = thrAddJob( workforce, node->flags, node->data,
+                                 node->func, node->nafter, wait_on, status );
+      }
+
+/* Wait for them all to complete. */
+      thrWait( workforce, status );
+      thrEndJobContext( workforce, status );
+   }
+
+/* Free resources. */
+   wait_on = astFree( wait_on );
+   order = astFree( order );
+   ndep = astFree( ndep );
+}
+
 int thrJobWait( ThrWorkForce *workforce, int *status ) {
 /*
 *+
@@ -1117,14 +1836,14 @@ int thrJobWait( ThrWorkForce *workforce, int *status ) {
    return result;
 }
 
-AstKeyMap *thrThreadData( int *status ) {
+void *thrMallocLocal( ThrWorkForce *workforce, size_t size, int *status ){
 /*
 *+
 *  Name:
-*     thrThreadData
+*     thrMallocLocal
 
 *  Purpose:
-*     Returns a KeyMap that can be used to hold thread-specific global data.
+*     Allocate zeroed memory that is distributed between NUMA nodes.
 
 *  Language:
 *     Starlink ANSI C
@@ -1133,14 +1852,366 @@ AstKeyMap *thrThreadData( int *status ) {
 *     C function
 
 *  Invocation:
-*     AstKeyMap *thrThreadData( int *status );
+*     void *thrMallocLocal( ThrWorkForce *workforce, size_t size,
+*                           int *status )
 
 *  Description:
-*     This function returns a pointer to an AST KeyMap that is associated
-*     with the running thread (each thread has a separate KeyMap). The
-*     KeyMap can be used to store values that need to be passed between
-*     functions within a thread, or that need to be retained between
-*     invocations.
+*     This function allocates memory using astMalloc and fills it with
+*     zeros. On most systems, each page of memory is placed on the NUMA
+*     node of the CPU that first writes to it, so the zeros are written
+*     by the workers in the supplied workforce rather than by the calling
+*     thread. The memory is divided into "nworker" contiguous blocks of
+*     (nearly) equal size, and block "i" is written by worker "i". If the
+*     workers have been bound to CPUs (see environment variable
+*     THR_AFFINITY in thrCreateWorkforce), each block is therefore local
+*     to the NUMA node of the corresponding worker. This suits arrays
+*     that are subsequently processed by jobs that each handle one of
+*     "nworker" contiguous blocks of the array.
+*
+*     If the workers in the workforce are not bound to CPUs, the memory
+*     is simply allocated using astCalloc.
+*
+*     This function should not be called from within a job that is being
+*     run by the supplied workforce.
+
+*  Arguments:
+*     workforce
+*        Pointer to the workforce that will be used to process the
+*        memory. If NULL, the memory is allocated using astCalloc.
+*     size
+*        The number of bytes to allocate.
+*     status
+*        Pointer to the inherited status value.
+
+*  Returned Value:
+*     A pointer to the allocated memory, or NULL if an error occurs. It
+*     should be freed using astFree when no longer needed.
+
+*-
+*/
+
+/* Local Variables: */
+   ThrTouch touch;
+   long page;
+   int i;
+   void *result;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return NULL;
+
+/* Use astCalloc unless the workforce has more than one worker, each bound
+   to a CPU. Also use astCalloc if this function has been called from one
+   of the workers, since the other jobs could then never all start. */
+   if( !workforce || !workforce->cpus || workforce->nworker < 2 ||
+       thr1WorkerIndex( workforce ) >= 0 ) {
+      return astCalloc( size, 1 );
+   }
+
+/* Allocate the memory. */
+   result = astMalloc( size );
+   if( *status == SAI__OK && size > 0 ) {
+
+/* Find the number of bytes to be written by each worker, rounding up to
+   a whole number of pages so that no page is shared between workers. */
+      page = sysconf( _SC_PAGESIZE );
+      if( page <= 0 ) page = 4096;
+      touch.bsize = ( size + workforce->nworker - 1 )/workforce->nworker;
+      touch.bsize = ( ( touch.bsize + page - 1 )/page )*page;
+
+/* Initialise the rest of the structure shared by the jobs. */
+      thrMutexInit( &(touch.mutex), status );
+      thrCondInit( &(touch.cond), status );
+      touch.narrived = 0;
+      touch.workforce = workforce;
+      touch.mem = result;
+      touch.size = size;
+
+/* Submit one job for each worker within a new job context, so that we
+   only wait for our own jobs. Each job waits until all jobs have started
+   so that each job is run by a different worker. */
+      thrBeginJobContext( workforce, status );
+      for( i = 0; i < workforce->nworker; i++ ) {
+         thrAddJob( workforce, 0, &touch, thr1TouchJob, 0, NULL, status );
+      }
+      thrWait( workforce, status );
+      thrEndJobContext( workforce, status );
+
+/* Free resources. */
+      pthread_mutex_destroy( &(touch.mutex) );
+      pthread_cond_destroy( &(touch.cond) );
+   }
+
+/* Free the memory if anything went wrong. */
+   if( *status != SAI__OK ) result = astFree( result );
+
+/* Return the pointer. */
+   return result;
+}
+
+void thrParallelFor( ThrWorkForce *workforce, size_t first, size_t last,
+                     size_t grain, void *data,
+                     void (*func)( void *, size_t, size_t, int * ),
+                     int *status ){
+/*
+*+
+*  Name:
+*     thrParallelFor
+
+*  Purpose:
+*     Process a range of indices in parallel.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     void thrParallelFor( ThrWorkForce *workforce, size_t first,
+*                          size_t last, size_t grain, void *data,
+*                          void (*func)( void *, size_t, size_t, int * ),
+*                          int *status )
+
+*  Description:
+*     This function calls the supplied function "func" for every index in
+*     the range "first" to "last" (inclusive), and returns when all indices
+*     have been processed. Each call to "func" processes a contiguous chunk
+*     of indices. The chunks are claimed dynamically by the workers in the
+*     workforce - a worker claims a new chunk each time it finishes the
+*     previous one, so workers that are given cheap chunks (e.g. chunks
+*     containing many bad bolometers) simply process more chunks. The size
+*     of each chunk is a fraction of the number of indices still to be
+*     claimed, so chunks start large (keeping the scheduling overheads low)
+*     and become smaller towards the end of the range (so that all workers
+*     finish at about the same time), but are never smaller than "grain".
+*
+*     The jobs are performed within a new job context (see
+*     thrBeginJobContext), so any other jobs that have already been
+*     submitted to the workforce are not waited for.
+
+*  Arguments:
+*     workforce
+*        Pointer to the workforce. If NULL is supplied, "func" is called
+*        once in the current thread to process the whole range.
+*     first
+*        The first index to be processed.
+*     last
+*        The last index to be processed. If this is less than "first",
+*        the function returns without action.
+*     grain
+*        The minimum number of indices to be processed in a single call to
+*        "func", except perhaps for the final chunk. If zero is supplied,
+*        a value is chosen that divides the range into several chunks
+*        for each worker.
+*     data
+*        An arbitrary data pointer that will be passed to "func". All
+*        invocations of "func" receive the same pointer. The data it
+*        points to should not normally be modified by "func" since it may
+*        be accessed by several threads at once.
+*     func
+*        A pointer to the function that processes a chunk of indices. It
+*        takes four arguments; 1) the supplied "data" pointer, 2) the first
+*        index in the chunk, 3) the last index in the chunk (inclusive),
+*        and 4) an inherited status pointer. It returns void.
+*     status
+*        Pointer to the inherited status value.
+
+*  Notes:
+*     - This function should only be called from the thread that manages
+*     the workforce, not from within a job.
+*     - If an error is reported by "func", no further chunks are started
+*     and the error is reported when all current chunks have finished.
+
+*-
+*/
+   thr1DoRange( workforce, first, last, grain, data, func, NULL, 0, NULL,
+                NULL, status );
+}
+
+void thrParallelReduce( ThrWorkForce *workforce, size_t first, size_t last,
+                        size_t grain, void *data,
+                        void (*func)( void *, size_t, size_t, void *, int * ),
+                        size_t size, void *result,
+                        void (*reduce)( void *, void *, const void *, int * ),
+                        int *status ){
+/*
+*+
+*  Name:
+*     thrParallelReduce
+
+*  Purpose:
+*     Process a range of indices in parallel and combine the results.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     void thrParallelReduce( ThrWorkForce *workforce, size_t first,
+*                             size_t last, size_t grain, void *data,
+*                             void (*func)( void *, size_t, size_t, void *,
+*                                           int * ),
+*                             size_t size, void *result,
+*                             void (*reduce)( void *, void *, const void *,
+*                                             int * ),
+*                             int *status )
+
+*  Description:
+*     This function is like thrParallelFor, except that each job also
+*     accumulates a partial result (for instance, a sum or a set of
+*     counts) in a private buffer. When all indices have been processed
+*     the partial results are combined into a single returned result
+*     using the supplied "reduce" function.
+*
+*     Each partial result buffer is initialised on entry by copying the
+*     supplied "result" buffer, which should therefore hold the identity
+*     value for the reduction (e.g. zero for a sum). Each call to "func"
+*     should add the contribution from its chunk of indices into the
+*     supplied buffer without first clearing it. Finally, "reduce" is
+*     called once for each partial result to merge it into "result".
+
+*  Arguments:
+*     workforce
+*        Pointer to the workforce. If NULL is supplied, "func" is called
+*        once in the current thread to process the whole range, using
+*        "result" itself as the partial result buffer.
+*     first
+*        The first index to be processed.
+*     last
+*        The last index to be processed. If this is less than "first",
+*        the function returns without action.
+*     grain
+*        The minimum number of indices to be processed in a single call to
+*        "func", except perhaps for the final chunk. If zero is supplied,
+*        a value is chosen that divides the range into several chunks
+*        for each worker.
+*     data
+*        An arbitrary data pointer that will be passed to "func" and
+*        "reduce".
+*     func
+*        A pointer to the function that processes a chunk of indices. It
+*        takes five arguments; 1) the supplied "data" pointer, 2) the first
+*        index in the chunk, 3) the last index in the chunk (inclusive),
+*        4) a pointer to the partial result buffer to be updated, and 5) an
+*        inherited status pointer. It returns void.
+*     size
+*        The size in bytes of the result.
+*     result
+*        Pointer to the result buffer. On entry it should hold the identity
+*        value of the reduction. On exit it holds the final result.
+*     reduce
+*        A pointer to the function that merges a partial result into the
+*        final result. It takes four arguments; 1) the supplied "data"
+*        pointer, 2) a pointer to the final result buffer to be updated,
+*        3) a pointer to the partial result buffer, and 4) an inherited
+*        status pointer. It returns void. It is always called from the
+*        calling thread, once for each job, in a fixed order.
+*     status
+*        Pointer to the inherited status value.
+
+*  Notes:
+*     - This function should only be called from the thread that manages
+*     the workforce, not from within a job.
+*     - Since chunks are claimed dynamically, the indices contributing to
+*     each partial result will differ from run to run. Floating point
+*     reductions may therefore differ in the least significant bits
+*     between runs. Integer counts will always be the same.
+
+*-
+*/
+   thr1DoRange( workforce, first, last, grain, data, NULL, func, size,
+                result, reduce, status );
+}
+
+const char *thrSetJobTag( const char *tag ){
+/*
+*+
+*  Name:
+*     thrSetJobTag
+
+*  Purpose:
+*     Set the tag used to identify subsequent jobs in a trace.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     const char *thrSetJobTag( const char *tag )
+
+*  Description:
+*     This function stores a tag that will be associated with all jobs
+*     subsequently submitted by the calling thread (using thrAddJob),
+*     until a new tag is set. The tag is included in any trace of
+*     workforce activity (see environment variable THR_TRACE in
+*     thrCreateWorkforce), in place of the name of the job function. It
+*     is also associated with any calls to thrWait made by the calling
+*     thread. Jobs submitted from within other jobs inherit the tag of
+*     the job that submitted them, unless a new tag is set within the
+*     submitting job.
+*
+*     Tags have no effect on the way in which jobs are run.
+
+*  Arguments:
+*     tag
+*        Pointer to a null-terminated string holding the new tag, or NULL
+*        to clear the tag. Only the pointer is stored, so the string
+*        must not be changed or freed whilst any job submitted with the tag
+*        is still running, or before any workforce that may have run such
+*        a job has been destroyed. A string literal is usually
+*        appropriate.
+
+*  Returned Value:
+*     The previous tag for the calling thread, or NULL if no tag was set.
+*     This can be passed to a subsequent call to this function to
+*     re-instate the previous tag.
+
+*-
+*/
+
+/* Local Variables: */
+   const char *result;
+
+/* Ensure the thread-specific data key used to store tags has been
+   created. */
+   if( pthread_once( &thr_tag_key_created, thr1TagCreateKey ) ) return NULL;
+
+/* Get the old tag and store the new one. */
+   result = pthread_getspecific( thr_tag_key );
+   pthread_setspecific( thr_tag_key, tag );
+
+/* Return the old tag. */
+   return result;
+}
+
+AstKeyMap *thrThreadData( int *status ) {
+/*
+*+
+*  Name:
+*     thrThreadData
+
+*  Purpose:
+*     Returns a KeyMap that can be used to hold thread-specific global data.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     AstKeyMap *thrThreadData( int *status );
+
+*  Description:
+*     This function returns a pointer to an AST KeyMap that is associated
+*     with the running thread (each thread has a separate KeyMap). The
+*     KeyMap can be used to store values that need to be passed between
+*     functions within a thread, or that need to be retained between
+*     invocations.
 
 *  Arguments:
 *     status
@@ -1216,6 +2287,10 @@ void thrWait( ThrWorkForce *workforce, int *status ) {
 *     jobs waiting to be reported via thrJobWait will be considered to
 *     have been reported (again, this only affects jobs within the current
 *     job context).
+*
+*     Any message output buffered by the worker threads is delivered
+*     before this function returns (see the MSG "BUFFER" tuning
+*     parameter).
 
 *  Arguments:
 *     workforce
@@ -1232,6 +2307,7 @@ void thrWait( ThrWorkForce *workforce, int *status ) {
 */
 
 /* Local Variables: */
+   double t_wait = 0.0;
    int conid;
    ThrJob *job;
    ThrJob *new_finished_head;
@@ -1240,6 +2316,9 @@ void thrWait( ThrWorkForce *workforce, int *status ) {
 /* Check we have a non-NULL workforce pointer. */
    if( !workforce ) return;
 
+/* If tracing, note the time at which the wait started. */
+   if( workforce->trace_file ) t_wait = thr1TraceTime( workforce );
+
 /* Start a new error reporting context. */
    emsBegin( status );
 
@@ -1269,6 +2348,13 @@ void thrWait( ThrWorkForce *workforce, int *status ) {
 
    thr1ThreadLog( "wait: all done", DESK, njob );
 
+/* If tracing, record the wait. */
+   if( workforce->trace_file ) {
+      thr1TraceAdd( workforce, pthread_getspecific( thr_tag_key ), NULL, 0,
+                    thr1WorkerIndex( workforce ), t_wait, t_wait,
+                    thr1TraceTime( workforce ), status );
+   }
+
 /* Remove jobs for the current job context from the finished job list,
    re-initialising their contents and moving them onto the free list. */
    new_finished_head = NULL;
@@ -1308,12 +2394,78 @@ void thrWait( ThrWorkForce *workforce, int *status ) {
 /* Report errors using EMS if any jobs failed. */
    wf_status = thr1ReportStatus( wf_status, status );
 
+/* Deliver any message output that the jobs have buffered (see the MSG
+   "BUFFER" tuning parameter). */
+   msgFlush( status );
+
 /* End the outer error reporting context. */
    emsEnd( status );
 }
 
 /* Private workforce-related functions */
 /* ----------------------------------- */
+static int thr1ClaimRange( ThrRange *range, size_t *first, size_t *last ){
+/*
+*  Name:
+*     thr1ClaimRange
+
+*  Purpose:
+*     Claim the next chunk of indices from a range.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     int thr1ClaimRange( ThrRange *range, size_t *first, size_t *last )
+
+*  Description:
+*     This function returns the first and last index in the next chunk to
+*     be processed from a range being processed by thrParallelFor or
+*     thrParallelReduce. The size of the chunk is the number of unclaimed
+*     indices divided by the "divisor" value in the range, but is not
+*     allowed to be less than the "grain" value.
+
+*  Arguments:
+*     range
+*        Pointer to the range.
+*     first
+*        Returned holding the first index in the chunk.
+*     last
+*        Returned holding the last index in the chunk.
+
+*  Returned Value:
+*     Zero if there are no more indices to be claimed, or if any job has
+*     failed. One otherwise.
+
+*/
+
+/* Local Variables: */
+   int result;
+   size_t nleft;
+   size_t nchunk;
+
+   result = 0;
+   pthread_mutex_lock( &(range->mutex) );
+
+   if( !range->abort && range->next <= range->last ) {
+      nleft = range->last - range->next + 1;
+      nchunk = nleft/range->divisor;
+      if( nchunk < range->grain ) nchunk = range->grain;
+      if( nchunk > nleft ) nchunk = nleft;
+
+      *first = range->next;
+      *last = range->next + nchunk - 1;
+      range->next += nchunk;
+      result = 1;
+   }
+
+   pthread_mutex_unlock( &(range->mutex) );
+   return result;
+}
+
 static void thr1ClearStatus( ThrJobStatus *status ){
 /*
 *  Name:
@@ -1414,6 +2566,303 @@ static ThrJobStatus *thr1CopyStatus( ThrJobStatus *status ){
    return result;
 }
 
+static int *thr1CpuList( int policy, int *ncpu, int *status ){
+/*
+*  Name:
+*     thr1CpuList
+
+*  Purpose:
+*     Get an ordered list of the CPUs available for worker threads.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     int *thr1CpuList( int policy, int *ncpu, int *status )
+
+*  Description:
+*     This function returns a list of the CPUs that the current process
+*     is allowed to use, in the order in which they should be assigned
+*     to workers. The NUMA node containing each CPU is determined from
+*     the "cpulist" files within the /sys/devices/system/node directory.
+*     If these are not available, all CPUs are assumed to be in a single
+*     node.
+
+*  Arguments:
+*     policy
+*        The affinity policy. If AFFINITY_COMPACT, all CPUs in the first
+*        node are returned first, followed by those in the next node,
+*        etc. If AFFINITY_SCATTER, the first CPU in each node is returned
+*        first, followed by the second CPU in each node, etc.
+*     ncpu
+*        Returned holding the number of CPUs in the returned list.
+*     status
+*        Pointer to the inherited status value.
+
+*  Returned Value:
+*     Pointer to a newly allocated list of CPU indices, or NULL if no list
+*     is available. It should be freed using astFree when no longer
+*     needed.
+
+*/
+
+/* Local Variables: */
+   int *result = NULL;
+#if USE_AFFINITY
+   FILE *fp;
+   char path[ 60 ];
+   cpu_set_t mask;
+   int *node;
+   int *used;
+   int cpu;
+   int hi;
+   int inode;
+   int lo;
+   int nfound;
+   int nleft;
+   int nnode;
+   int sep;
+#endif
+
+/* Initialise. */
+   *ncpu = 0;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return result;
+
+#if USE_AFFINITY
+
+/* Get the set of CPUs that the current process is allowed to use. */
+   CPU_ZERO( &mask );
+   if( sched_getaffinity( 0, sizeof( mask ), &mask ) ) return result;
+
+/* Allocate work arrays holding the NUMA node index for each CPU, and a
+   flag for each CPU indicating if it has been included in the returned
+   list. */
+   node = astMalloc( CPU_SETSIZE*sizeof( *node ) );
+   used = astCalloc( CPU_SETSIZE, sizeof( *used ) );
+   result = astMalloc( CPU_SETSIZE*sizeof( *result ) );
+   if( *status == SAI__OK ) {
+      for( cpu = 0; cpu < CPU_SETSIZE; cpu++ ) node[ cpu ] = -1;
+
+/* Read the list of CPUs in each NUMA node. Each list is a comma-separated
+   set of CPU indices or ranges of CPU indices (e.g. "0-7,16-23"). Node
+   indices need not be contiguous. */
+      nnode = 0;
+      for( inode = 0; inode < MAX_NODE; inode++ ) {
+         sprintf( path, "/sys/devices/system/node/node%d/cpulist", inode );
+         fp = fopen( path, "r" );
+         if( fp ) {
+            while( fscanf( fp, "%d", &lo ) == 1 ) {
+               hi = lo;
+               sep = fgetc( fp );
+               if( sep == '-' ) {
+                  if( fscanf( fp, "%d", &hi ) != 1 ) break;
+                  sep = fgetc( fp );
+               }
+               for( cpu = lo; cpu <= hi && cpu < CPU_SETSIZE; cpu++ ) {
+                  if( cpu >= 0 ) node[ cpu ] = nnode;
+               }
+               if( sep != ',' ) break;
+            }
+            fclose( fp );
+            nnode++;
+         }
+      }
+
+/* Any allowed CPUs that were not found in any node are assumed to be in
+   an extra node of their own. */
+      nfound = 0;
+      for( cpu = 0; cpu < CPU_SETSIZE; cpu++ ) {
+         if( CPU_ISSET( cpu, &mask ) && node[ cpu ] == -1 ) {
+            node[ cpu ] = nnode;
+            nfound++;
+         }
+      }
+      if( nfound ) nnode++;
+
+/* Count the allowed CPUs. */
+      nleft = 0;
+      for( cpu = 0; cpu < CPU_SETSIZE; cpu++ ) {
+         if( CPU_ISSET( cpu, &mask ) ) nleft++;
+      }
+
+/* For a compact policy, list the allowed CPUs in each node in turn. */
+      if( policy == AFFINITY_COMPACT ) {
+         for( inode = 0; inode < nnode; inode++ ) {
+            for( cpu = 0; cpu < CPU_SETSIZE; cpu++ ) {
+               if( CPU_ISSET( cpu, &mask ) && node[ cpu ] == inode ) {
+                  result[ (*ncpu)++ ] = cpu;
+               }
+            }
+         }
+
+/* For a scatter policy, repeatedly take the lowest unused CPU from each
+   node in turn, until all allowed CPUs have been listed. */
+      } else {
+         while( *ncpu < nleft ) {
+            for( inode = 0; inode < nnode; inode++ ) {
+               for( cpu = 0; cpu < CPU_SETSIZE; cpu++ ) {
+                  if( CPU_ISSET( cpu, &mask ) && node[ cpu ] == inode &&
+                      !used[ cpu ] ) {
+                     used[ cpu ] = 1;
+                     result[ (*ncpu)++ ] = cpu;
+                     break;
+                  }
+               }
+            }
+         }
+      }
+   }
+
+/* Free resources. */
+   node = astFree( node );
+   used = astFree( used );
+   if( *status != SAI__OK || *ncpu == 0 ) {
+      result = astFree( result );
+      *ncpu = 0;
+   }
+#endif
+
+/* Return the list. */
+   return result;
+}
+
+static void thr1DoRange( ThrWorkForce *wf, size_t first, size_t last,
+                         size_t grain, void *data,
+                         void (*ffunc)( void *, size_t, size_t, int * ),
+                         void (*rfunc)( void *, size_t, size_t, void *, int * ),
+                         size_t size, void *result,
+                         void (*reduce)( void *, void *, const void *, int * ),
+                         int *status ){
+/*
+*  Name:
+*     thr1DoRange
+
+*  Purpose:
+*     Implement thrParallelFor and thrParallelReduce.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     void thr1DoRange( ThrWorkForce *wf, size_t first, size_t last,
+*                       size_t grain, void *data,
+*                       void (*ffunc)( void *, size_t, size_t, int * ),
+*                       void (*rfunc)( void *, size_t, size_t, void *, int * ),
+*                       size_t size, void *result,
+*                       void (*reduce)( void *, void *, const void *, int * ),
+*                       int *status )
+
+*  Description:
+*     This function does the work for thrParallelFor (if "ffunc" is not
+*     NULL) or thrParallelReduce (if "rfunc" is not NULL). It creates one
+*     job for each worker (or fewer if the range is small), each of which
+*     repeatedly claims and processes chunks of the range until no
+*     indices remain.
+
+*  Arguments:
+*     See thrParallelFor and thrParallelReduce.
+
+*/
+
+/* Local Variables: */
+   ThrRange range;
+   ThrRangeJob *jobs;
+   char *partials;
+   int ijob;
+   int njob;
+   size_t nindex;
+
+/* Check inherited status and the range. */
+   if( *status != SAI__OK || last < first ) return;
+
+/* If no workforce was supplied, process the whole range in the current
+   thread. */
+   if( !wf ) {
+      if( ffunc ) {
+         (*ffunc)( data, first, last, status );
+      } else {
+         (*rfunc)( data, first, last, result, status );
+      }
+      return;
+   }
+
+/* Choose the grain size if required, so that each worker would claim
+   about RANGE_CHUNKS chunks if all indices took equal time to process. */
+   nindex = last - first + 1;
+   if( grain == 0 ) {
+      grain = nindex/( wf->nworker*RANGE_CHUNKS );
+      if( grain == 0 ) grain = 1;
+   }
+
+/* There is no point in using more jobs than there are chunks. If only a
+   single job is needed, do it in the current thread. */
+   njob = wf->nworker;
+   if( nindex/grain < (size_t) njob ) njob = nindex/grain;
+   if( njob <= 1 ) {
+      thr1DoRange( NULL, first, last, grain, data, ffunc, rfunc, size,
+                   result, reduce, status );
+      return;
+   }
+
+/* Initialise the structure describing the range. Each claimed chunk is
+   a fraction 1/(2*njob) of the unclaimed indices. */
+   thrMutexInit( &(range.mutex), status );
+   range.next = first;
+   range.last = last;
+   range.grain = grain;
+   range.divisor = 2*njob;
+   range.abort = 0;
+   range.data = data;
+   range.ffunc = ffunc;
+   range.rfunc = rfunc;
+
+/* Allocate the job structures, and if required the partial result
+   buffers, initialising each partial result to the supplied identity
+   value. */
+   jobs = astMalloc( njob*sizeof( *jobs ) );
+   partials = rfunc ? astMalloc( njob*size ) : NULL;
+   if( *status == SAI__OK ) {
+      for( ijob = 0; ijob < njob; ijob++ ) {
+         jobs[ ijob ].range = &range;
+         if( partials ) {
+            jobs[ ijob ].result = partials + ijob*size;
+            memcpy( jobs[ ijob ].result, result, size );
+         } else {
+            jobs[ ijob ].result = NULL;
+         }
+      }
+
+/* Submit the jobs within a new job context so that we only wait for our
+   own jobs, and then wait for them to complete. */
+      thrBeginJobContext( wf, status );
+      for( ijob = 0; ijob < njob; ijob++ ) {
+         thrAddJob( wf, 0, jobs + ijob, thr1RangeJob, 0, NULL, status );
+      }
+      thrWait( wf, status );
+      thrEndJobContext( wf, status );
+
+/* Merge the partial results into the final result, in job order. */
+      if( partials ) {
+         for( ijob = 0; ijob < njob && *status == SAI__OK; ijob++ ) {
+            (*reduce)( data, result, jobs[ ijob ].result, status );
+         }
+      }
+   }
+
+/* Free resources. */
+   partials = astFree( partials );
+   jobs = astFree( jobs );
+   pthread_mutex_destroy( &(range.mutex) );
+}
+
 static void thr1ExportJobs( ThrJob *head, int old, int new, int *status ){
 /*
 *  Name:
@@ -1543,6 +2992,55 @@ static ThrJob *thr1FindJob( ThrJob *head, int ijob, int conid, int *status ){
    return result;
 }
 
+static void thr1FlushDone( ThrWorker *worker, int *status ){
+/*
+*  Name:
+*     thr1FlushDone
+
+*  Purpose:
+*     Report all jobs completed by a work-stealing worker.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     void thr1FlushDone( ThrWorker *worker, int *status )
+
+*  Description:
+*     When the work-stealing scheduler is in use, each worker holds a
+*     list of the jobs it has completed but not yet reported at the job
+*     desk. This function reports the completion of all such jobs, and
+*     empties the list. It should only be called by the worker itself,
+*     whilst it has exclusive access to the job desk.
+
+*  Arguments:
+*     worker
+*        Pointer to the worker.
+*     status
+*        Pointer to the inherited status value.
+
+*/
+
+/* Local Variables: */
+   ThrJob *job;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Remove each job in turn from the head of the list of completed jobs,
+   and report its completion. */
+   job = worker->done;
+   while( job ) {
+      thr1QueueRemove( job, &(worker->done) );
+      thr1JobDone( worker->workforce, job, worker, status );
+      job = worker->done;
+   }
+   worker->ndone = 0;
+}
+
 static ThrJob *thr1FreeJob( ThrJob *job ) {
 /*
 *  Name:
@@ -1651,6 +3149,77 @@ static int thr1GetJobContext( ThrWorkForce *workforce, int *status ){
    return result;
 }
 
+static ThrJob *thr1GetQueuedJob( ThrWorker *worker, int *status ){
+/*
+*  Name:
+*     thr1GetQueuedJob
+
+*  Purpose:
+*     Get the next job to be run by a work-stealing worker.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     ThrJob *thr1GetQueuedJob( ThrWorker *worker, int *status )
+
+*  Description:
+*     This function returns the job at the head of the supplied worker's
+*     own queue. If the worker's queue is empty, the queues of the other
+*     workers in the workforce are searched in turn, and the job at the
+*     foot of the first non-empty queue is "stolen" and returned instead.
+*     The job desk mutex is not required.
+
+*  Arguments:
+*     worker
+*        Pointer to the worker.
+*     status
+*        Pointer to the inherited status value.
+
+*  Returned Value:
+*     Pointer to the job to be run, or NULL if all queues are empty.
+
+*/
+
+/* Local Variables: */
+   ThrJob *result;
+   ThrWorkForce *wf;
+   ThrWorker *victim;
+   int i;
+
+/* Initialise. */
+   result = NULL;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return result;
+
+/* First try the worker's own queue. */
+   thrMutexLock( &(worker->q_mutex), status );
+   result = worker->queue;
+   if( result ) thr1QueueRemove( result, &(worker->queue) );
+   thrMutexUnlock( &(worker->q_mutex), status );
+
+/* If the worker's own queue was empty, try to steal a job from the foot
+   of another worker's queue, starting with the next worker. */
+   if( !result ) {
+      wf = worker->workforce;
+      for( i = 1; i < wf->nworker && !result && *status == SAI__OK; i++ ) {
+         victim = wf->workers + ( worker->iworker + i ) % wf->nworker;
+         thrMutexLock( &(victim->q_mutex), status );
+         if( victim->queue ) {
+            result = victim->queue->qnext;
+            thr1QueueRemove( result, &(victim->queue) );
+         }
+         thrMutexUnlock( &(victim->q_mutex), status );
+      }
+   }
+
+   return result;
+}
+
 static ThrJobStatus *thr1GetStatus( int *ems_status ){
 /*
 *  Name:
@@ -1780,6 +3349,132 @@ static void thr1InitJobs( ThrJob *job, int *status ){
    job->nwaiting_on = 0;
    job->nheld_up = 0;
    job->status = thr1FreeStatus( job->status );
+   job->tag = NULL;
+   job->worker = -1;
+   job->t_submit = 0.0;
+   job->t_start = 0.0;
+   job->t_end = 0.0;
+}
+
+static void thr1JobDone( ThrWorkForce *wf, ThrJob *job, ThrWorker *worker,
+                         int *status ){
+/*
+*  Name:
+*     thr1JobDone
+
+*  Purpose:
+*     Update the job desk to record the completion of a job.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     void thr1JobDone( ThrWorkForce *wf, ThrJob *job, ThrWorker *worker,
+*                       int *status )
+
+*  Description:
+*     This function removes a completed job from the list of active jobs,
+*     releases any jobs that were waiting for it to complete, and then
+*     either places it on the list of finished jobs (if it is to be
+*     reported by thrJobWait) or on the list of free job structures. It
+*     should only be called whilst the caller has exclusive access to the
+*     job desk.
+
+*  Arguments:
+*     wf
+*        Pointer to the workforce.
+*     job
+*        Pointer to the completed job.
+*     worker
+*        Pointer to the worker that ran the job if the work-stealing
+*        scheduler is in use, or NULL otherwise. Any jobs that become
+*        ready to run as a result of the completion of the job are put
+*        into the queue belonging to this worker. If NULL, they are put
+*        onto the list of available jobs.
+*     status
+*        Pointer to the inherited status value.
+
+*/
+
+/* Local Variables: */
+   ThrJob *job2;
+   int i;
+   int j;
+   int ready;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* If tracing, record the job. */
+   if( wf->trace_file ) {
+      thr1TraceAdd( wf, job->tag, job->func, job->ijob, job->worker,
+                    job->t_submit, job->t_start, job->t_end, status );
+   }
+
+/* If the job failed, copy information about the error into the workforce
+   so long as this is the first failed job. */
+   if( !wf->status ) wf->status = thr1CopyStatus( job->status );
+
+/* Remove the job from the list of currently active jobs. */
+   thr1RemoveFromList( job, &(wf->active_jobs), status );
+
+/* If any jobs are held up by the job that has just completed, see if any
+   of them can now be moveed from the list of waiting jobs and put onto
+   the list of available jobs. */
+   for( i = 0; i < job->nheld_up; i++ ) {
+      job2 = job->held_up[ i ];
+      job->held_up[ i ] = NULL;
+
+/* First remove the job that has just completed from the list of jobs
+   which job2 is waiting for. Set a flag indicating if job2 is now ready
+   to run (i.e. there are no other active or available jobs for which it is
+   waiting). */
+      ready = 1;
+      for( j = 0; j < job2->nwaiting_on; j++ ) {
+         if( job2->waiting_on[ j ] == job ) {
+            job2->waiting_on[ j ] = NULL;
+         } else if( job2->waiting_on[ j ] != NULL ) {
+            ready = 0;
+         }
+      }
+
+/* If job2 is now ready to run, move it off the waiting list onto the
+   available list (or into the queue of the current worker if the
+   work-stealing scheduler is in use). */
+      if( ready ) {
+         thr1RemoveFromList( job2, &(wf->waiting_jobs), status );
+         if( worker ) {
+            thr1QueueJob( wf, job2, worker, status );
+         } else {
+            thr1PushListHead( job2, &(wf->available_jobs), status );
+         }
+      }
+   }
+
+/* If required, free the job data pointer. */
+   if( job->flags & THR__FREE_JOBDATA ) job->data = astFree( job->data );
+
+/* If required, add the completed job onto the end of the "finished" list, and
+   issue the job_done signal. */
+   if( job->flags & THR__REPORT_JOB ) {
+      thr1PushListFoot( job, &(wf->finished_jobs), status );
+      thrCondSignal( &(wf->job_done), status );
+
+/* Otherwise, clear the job data and put the job structure back onto the
+   list of free job structures. */
+   } else {
+      job->ijob = 0;
+      job->flags = 0;
+      job->func = NULL;
+      job->data = NULL;
+      job->nwaiting_on = 0;
+      job->nheld_up = 0;
+      job->status = thr1FreeStatus( job->status );
+      thr1PushListHead( job, &(wf->free_jobs), status );
+   }
 }
 
 static int thr1ListIsEmpty( int conid, ThrJob *head, int *status ){
@@ -2140,6 +3835,298 @@ static void thr1PushListHead( ThrJob *job, ThrJob **head, int *status ){
    *head = job;
 }
 
+static void thr1QueueJob( ThrWorkForce *wf, ThrJob *job, ThrWorker *worker,
+                          int *status ){
+/*
+*  Name:
+*     thr1QueueJob
+
+*  Purpose:
+*     Put a job that is ready to run into the queue of a worker.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     void thr1QueueJob( ThrWorkForce *wf, ThrJob *job, ThrWorker *worker,
+*                        int *status )
+
+*  Description:
+*     This function is used by the work-stealing scheduler in place of
+*     adding a job to the list of available jobs. The job is added to the
+*     list of active jobs (so that functions such as thrWait know that
+*     it has not yet completed), and is then put into the queue of a
+*     worker. Any idle worker is then paged so that it can steal the job
+*     if the owner of the queue is busy. It should only be called whilst
+*     the caller has exclusive access to the job desk.
+
+*  Arguments:
+*     wf
+*        Pointer to the workforce.
+*     job
+*        Pointer to the job.
+*     worker
+*        Pointer to the worker into whose queue the job should be put.
+*        The job is put at the head of the queue, so that it will be the
+*        next job run by the worker. If NULL, the job is put at the foot
+*        of the queue of the next worker in turn.
+*     status
+*        Pointer to the inherited status value.
+
+*/
+
+/* Local Variables: */
+   int foot;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* If no worker was specified, choose the next worker in turn. */
+   foot = ( worker == NULL );
+   if( foot ) {
+      worker = wf->workers + wf->next_worker;
+      wf->next_worker = ( wf->next_worker + 1 ) % wf->nworker;
+   }
+
+/* The job is considered active as soon as it is queued. */
+   thr1PushListHead( job, &(wf->active_jobs), status );
+
+/* Put the job into the worker's queue. */
+   thrMutexLock( &(worker->q_mutex), status );
+   thr1QueuePush( job, &(worker->queue), foot );
+   thrMutexUnlock( &(worker->q_mutex), status );
+
+/* Tell any idle workers that a new job is available. */
+   thrCondSignal( &(wf->page), status );
+}
+
+static int thr1QueuedJobs( ThrWorkForce *wf, int *status ){
+/*
+*  Name:
+*     thr1QueuedJobs
+
+*  Purpose:
+*     See if any worker has any queued jobs.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     int thr1QueuedJobs( ThrWorkForce *wf, int *status )
+
+*  Description:
+*     This function returns a flag indicating if the queue of any worker
+*     in a workforce that uses the work-stealing scheduler contains any
+*     jobs. Since jobs are only ever added to a queue by a thread that has
+*     exclusive access to the job desk, the returned value will remain
+*     valid for as long as the caller retains exclusive access to the job
+*     desk.
+
+*  Arguments:
+*     wf
+*        Pointer to the workforce.
+*     status
+*        Pointer to the inherited status value.
+
+*  Returned Value:
+*     Non-zero if any queue contains any jobs.
+
+*/
+
+/* Local Variables: */
+   int i;
+   int result;
+
+/* Initialise. */
+   result = 0;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return result;
+
+/* Check each worker's queue in turn. */
+   for( i = 0; i < wf->nworker && !result; i++ ) {
+      thrMutexLock( &(wf->workers[ i ].q_mutex), status );
+      result = ( wf->workers[ i ].queue != NULL );
+      thrMutexUnlock( &(wf->workers[ i ].q_mutex), status );
+   }
+
+   return result;
+}
+
+static void thr1QueuePush( ThrJob *job, ThrJob **head, int foot ){
+/*
+*  Name:
+*     thr1QueuePush
+
+*  Purpose:
+*     Push a job onto the head or foot of a worker queue.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     void thr1QueuePush( ThrJob *job, ThrJob **head, int foot )
+
+*  Description:
+*     This function adds a job to a list that is linked using the "qprev"
+*     and "qnext" links of the ThrJob structure, rather than the "prev"
+*     and "next" links. This allows a job to be in a worker queue at the
+*     same time as being in the list of active jobs.
+
+*  Arguments:
+*     job
+*        Pointer to the ThrJob to be added.
+*     head
+*        Address of a location at which is stored a pointer to the ThrJob at
+*        the head of the list.
+*     foot
+*        If non-zero the job is added to the foot of the list. Otherwise
+*        it is added to the head of the list.
+
+*  Notes:
+*     - The "qprev" link in a ThrJob structure points towards the list
+*     foot, and the "qnext" link points towards the list head.
+*     - The head's qnext link points to the foot.
+*     - The foot's qprev link points to the head.
+*/
+
+/* Local Variables: */
+   ThrJob *oldfoot;
+
+   if( *head ) {
+      oldfoot = (*head)->qnext;
+      oldfoot->qprev = job;
+      job->qnext = oldfoot;
+      (*head)->qnext = job;
+      job->qprev = *head;
+      if( !foot ) *head = job;
+
+   } else {
+      job->qnext = job;
+      job->qprev = job;
+      *head = job;
+   }
+}
+
+static void thr1QueueRemove( ThrJob *job, ThrJob **head ){
+/*
+*  Name:
+*     thr1QueueRemove
+
+*  Purpose:
+*     Remove a job from a worker queue.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     void thr1QueueRemove( ThrJob *job, ThrJob **head )
+
+*  Description:
+*     This function removes the supplied ThrJob from a list that is
+*     linked using the "qprev" and "qnext" links of the ThrJob structure
+*     (see thr1QueuePush).
+
+*  Arguments:
+*     job
+*        Pointer to the ThrJob to be removed.
+*     head
+*        Address of a location at which is stored a pointer to the ThrJob at
+*        the head of the list.
+
+*/
+
+/* Local Variables: */
+   ThrJob *next;
+   ThrJob *prev;
+
+   prev = job->qprev;
+   next = job->qnext;
+
+   if( prev == job ) {
+      *head = NULL;
+   } else {
+      prev->qnext = next;
+      next->qprev = prev;
+      if( job == *head ) *head = prev;
+   }
+
+   job->qnext = NULL;
+   job->qprev = NULL;
+}
+
+static void thr1RangeJob( void *job_data, int *status ){
+/*
+*  Name:
+*     thr1RangeJob
+
+*  Purpose:
+*     A job run by a worker for thrParallelFor or thrParallelReduce.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     void thr1RangeJob( void *job_data, int *status )
+
+*  Description:
+*     This function repeatedly claims the next chunk of indices from a
+*     range and calls the user-supplied function to process it, until
+*     no indices remain or an error occurs. If an error occurs, the range
+*     is marked as aborted so that no other job claims any further chunks.
+
+*  Arguments:
+*     job_data
+*        Pointer to a ThrRangeJob structure.
+*     status
+*        Pointer to the inherited status value.
+
+*/
+
+/* Local Variables: */
+   ThrRange *range;
+   ThrRangeJob *job;
+   size_t first;
+   size_t last;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+   job = (ThrRangeJob *) job_data;
+   range = job->range;
+
+/* Process chunks until none are left. */
+   while( *status == SAI__OK && thr1ClaimRange( range, &first, &last ) ) {
+      if( range->ffunc ) {
+         (*range->ffunc)( range->data, first, last, status );
+      } else {
+         (*range->rfunc)( range->data, first, last, job->result, status );
+      }
+   }
+
+/* If an error occurred, prevent other jobs claiming any more chunks. */
+   if( *status != SAI__OK ) {
+      pthread_mutex_lock( &(range->mutex) );
+      range->abort = 1;
+      pthread_mutex_unlock( &(range->mutex) );
+   }
+}
+
 static void thr1RemoveFromList( ThrJob *job, ThrJob **head, int *status ){
 /*
 *  Name:
@@ -2232,33 +4219,203 @@ static ThrJobStatus *thr1ReportStatus( ThrJobStatus *status, int *ems_status ){
 *  Returned Value:
 *     A NULL pointer.
 
-*/
+*/
+
+/* Local Variables: */
+   int i;                        /* Loop count */
+
+/* Check the current EMS error status, and check we have a usable pointer. */
+   if( *ems_status == SAI__OK && status ) {
+
+/* Do nothing if the supplied ThrJobStatus does not describe an error. */
+      if( status->ems_status != SAI__OK ) {
+
+/* Set the EMS status value. */
+         *ems_status = status->ems_status;
+
+/* Loop round the error messagesstored in the ThrJobSTatus, reporting
+   each one in turn. */
+         for( i = 0; i < status->nmessage; i++ ) {
+            emsRep( " ", (status->messages)[ i ], ems_status );
+         }
+
+/* Clear the supplied structure. */
+         thr1ClearStatus( status );
+      }
+   }
+
+/* Free the status structure and return a NULL pointer. */
+   return thr1FreeStatus( status );
+}
+
+static void *thr1RunStealWorker( void *worker_ptr ) {
+/*
+*  Name:
+*     thr1RunStealWorker
+
+*  Purpose:
+*     Manages the activity of a worker thread using the work-stealing
+*     scheduler.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     void *thr1RunStealWorker( void *worker_ptr )
+
+*  Description:
+*     This is the main function executed within each worker thread when
+*     the work-stealing scheduler is in use. Each worker takes jobs from
+*     its own queue (or steals them from the queues of other workers)
+*     without visiting the job desk. Completed jobs are accumulated and
+*     reported together to reduce the number of visits to the job desk.
+*     The job desk is visited immediately if a completed job is to be
+*     reported via thrJobWait or has failed, if the number of unreported
+*     jobs reaches MAX_DONE, or if no more jobs can be found in any
+*     queue. In the last case the worker then waits at the job desk until
+*     new jobs become available.
+
+*  Arguments:
+*     worker_ptr
+*        Pointer to a ThrWorker structure describing the worker.
+
+*/
+
+/* Local Variables: */
+   int locked;
+   int status;
+   ThrJob *job = NULL;
+   ThrWorkForce *wf;
+   ThrWorker *worker;
+
+/* Initialise the local status value. */
+   status = SAI__OK;
+
+/* Get a pointer to the worker and workforce descriptions. */
+   worker = (ThrWorker *) worker_ptr;
+   wf = worker->workforce;
+
+/* Record the worker in thread-specific data, so that any jobs created by
+   the jobs run by this worker are put into this worker's queue. */
+   pthread_setspecific( thr_worker_key, worker );
+
+/* Initialise AST's thread specific data by calling astBegin before any
+   other AST functions. */
+   astBegin;
+
+/* Switch on AST memory caching for this thread. */
+   (void) astTune( "MemoryCaching", 1 );
+
+/* Tell AST to watch the local status variable. */
+   astWatch( &status );
+
+/* Loop until an error occurs (errors that occur within jobs do not
+   affect "status"). */
+   locked = 0;
+   while( status == SAI__OK ) {
+
+/* Get a job from our own queue, or steal one from another worker. */
+      job = thr1GetQueuedJob( worker, &status );
+
+/* If we have a job, do it in a new AST context and a new arena scope, so
+   that any scratch memory allocated by the job using starArenaMalloc is
+   released when the job completes. */
+      if( job ) {
+         thr1ThreadLog( "run_worker: left queue to do job", ACTIVE,
+                         job->ijob );
 
-/* Local Variables: */
-   int i;                        /* Loop count */
+/* If tracing, record when the job starts and ends. Also make the job's
+   tag the current tag for this thread, so that it is inherited by any
+   jobs submitted by the job. */
+         if( wf->trace_file ) {
+            job->worker = worker->iworker;
+            pthread_setspecific( thr_tag_key, job->tag );
+            job->t_start = thr1TraceTime( wf );
+         }
+         astBegin;
+         starArenaBegin();
+         (*job->func)( job->data, &status );
+         starArenaReset();
+         astEnd;
+         if( wf->trace_file ) job->t_end = thr1TraceTime( wf );
 
-/* Check the current EMS error status, and check we have a usable pointer. */
-   if( *ems_status == SAI__OK && status ) {
+/* If the job failed, errors will have been reported using EMS. Copy
+   details of these errors into the job structure, and annull the EMS error
+   condition. */
+         job->status = thr1GetStatus( &status );
+
+/* Add the job to the list of completed jobs that have not yet been
+   reported. If the completion of the job needs to be reported quickly,
+   or if many completed jobs have accumulated, visit the job desk to
+   report them all. */
+         thr1QueuePush( job, &(worker->done), 1 );
+         if( job->status || ( job->flags & THR__REPORT_JOB ) ||
+             ++(worker->ndone) >= MAX_DONE ) {
+            thr1ThreadLog( "run_worker: completed job - joining queue",
+                            WAIT, job->ijob );
+            thrMutexLock( &(wf->jd_mutex), &status );
+            thr1FlushDone( worker, &status );
+            thrMutexUnlock( &(wf->jd_mutex), &status );
+         }
 
-/* Do nothing if the supplied ThrJobStatus does not describe an error. */
-      if( status->ems_status != SAI__OK ) {
+/* If no job could be found, join the job desk queue. Then report all
+   completed jobs and see if the workforce is being killed. */
+      } else {
+         thrMutexLock( &(wf->jd_mutex), &status );
+         locked = 1;
+         thr1ThreadLog( "run_worker: no job", DESK, -1 );
+         thr1FlushDone( worker, &status );
 
-/* Set the EMS status value. */
-         *ems_status = status->ems_status;
+         if( wf->kill ) {
+            if( --(wf->kill) == 0 ) thrCondSignal( &(wf->all_done), &status );
+            break;
+         }
 
-/* Loop round the error messagesstored in the ThrJobSTatus, reporting
-   each one in turn. */
-         for( i = 0; i < status->nmessage; i++ ) {
-            emsRep( " ", (status->messages)[ i ], ems_status );
+/* New jobs are only added to a queue by a thread that is at the job desk,
+   so check again now that we are at the job desk. If there are still no
+   queued jobs, signal the manager if all jobs have been completed, and
+   then wait until a new job becomes available. */
+         if( !thr1QueuedJobs( wf, &status ) ) {
+            if( !wf->active_jobs ) {
+               if( !wf->waiting_jobs ) {
+                  thr1ThreadLog( "run_worker: announcing all done", DESK, -1 );
+                  thrCondSignal( &(wf->all_done), &status );
+               } else if( status == SAI__OK ) {
+                  status = SAI__ERROR;
+                  emsRep( "", "thrWait: waiting jobs gave no indication "
+                          "of when they are to be run.", &status );
+               }
+            }
+
+            thr1ThreadLog( "run_worker: waiting for new jobs", WAIT, -1 );
+            thrCondWait( &(wf->page), &(wf->jd_mutex), &status );
+            thr1ThreadLog( "run_worker: new jobs!", DESK, -1 );
          }
 
-/* Clear the supplied structure. */
-         thr1ClearStatus( status );
+         thrMutexUnlock( &(wf->jd_mutex), &status );
+         locked = 0;
       }
    }
 
-/* Free the status structure and return a NULL pointer. */
-   return thr1FreeStatus( status );
+   thr1ThreadLog( "run_worker: worker has died", DESK, -1 );
+
+/* If something goes wrong in the threads infrastructure, abort the current
+   job by signalling "all done". */
+   if( !locked ) pthread_mutex_lock( &(wf->jd_mutex) );
+   pthread_cond_signal( &(wf->all_done) );
+   pthread_mutex_unlock( &(wf->jd_mutex) );
+
+/* Switch off AST memory caching for this thread. */
+   (void) astTune( "MemoryCaching", 0 );
+
+/* End the AST context for this thread. */
+   astEnd;
+
+/* The pthreads library requires us to return a pointer. */
+   return NULL;
 }
 
 static void *thr1RunWorker( void *wf_ptr ) {
@@ -2291,13 +4448,9 @@ static void *thr1RunWorker( void *wf_ptr ) {
 */
 
 /* Local Variables: */
-   int i;
-   int j;
    int jobs_available;
-   int ready;
    int status;
    ThrJob *job = NULL;
-   ThrJob *job2 = NULL;
    ThrWorkForce *wf;
 
 /* Initialise the local status value. */
@@ -2334,62 +4487,8 @@ static void *thr1RunWorker( void *wf_ptr ) {
          thr1ThreadLog( "run_worker: Worker at desk to report job done",
                          DESK, job->ijob );
 
-/* If the job failed, copy information about the error into the workforce
-   so long as this is the first failed job. */
-         if( !wf->status ) wf->status = thr1CopyStatus( job->status );
-
-/* Remove the job from the list of currently active jobs. */
-         thr1RemoveFromList( job, &(wf->active_jobs), &status );
-
-/* If any jobs are held up by the job that has just completed, see if any
-   of them can now be moveed from the list of waiting jobs and put onto
-   the list of available jobs. */
-         for( i = 0; i < job->nheld_up; i++ ) {
-            job2 = job->held_up[ i ];
-            job->held_up[ i ] = NULL;
-
-/* First remove the job that has just completed from the list of jobs
-   which job2 is waiting for. Set a flag indicating if job2 is now ready
-   to run (i.e. there are no other active or available jobs for which it is
-   waiting). */
-            ready = 1;
-            for( j = 0; j < job2->nwaiting_on; j++ ) {
-               if( job2->waiting_on[ j ] == job ) {
-                  job2->waiting_on[ j ] = NULL;
-               } else if( job2->waiting_on[ j ] != NULL ) {
-                  ready = 0;
-               }
-            }
-
-/* If job2 is now ready to run, move it off the waiting list onto the
-   available list. */
-            if( ready ) {
-               thr1RemoveFromList( job2, &(wf->waiting_jobs), &status );
-               thr1PushListHead( job2, &(wf->available_jobs), &status );
-            }
-         }
-
-/* If required, free the job data pointer. */
-         if( job->flags & THR__FREE_JOBDATA ) job->data = astFree( job->data );
-
-/* If required, add the completed job onto the end of the "finished" list, and
-   issue the job_done signal. */
-         if( job->flags & THR__REPORT_JOB ) {
-            thr1PushListFoot( job, &(wf->finished_jobs), &status );
-            thrCondSignal( &(wf->job_done), &status );
-
-/* Otherwise, clear the job data and put the job structure back onto the
-   list of free job structures. */
-         } else {
-            job->ijob = 0;
-            job->flags = 0;
-            job->func = NULL;
-            job->data = NULL;
-            job->nwaiting_on = 0;
-            job->nheld_up = 0;
-            job->status = thr1FreeStatus( job->status );
-            thr1PushListHead( job, &(wf->free_jobs), &status );
-         }
+/* Update the job desk to indicate that the job has finished. */
+         thr1JobDone( wf, job, NULL, &status );
 
 /* Indicate you now have no associated job. */
          job = NULL;
@@ -2428,11 +4527,24 @@ static void *thr1RunWorker( void *wf_ptr ) {
          thr1ThreadLog( "run_worker: left desk to do job", ACTIVE,
                          job->ijob );
 
-/* If no error has occurred, do the job in a new AST context. */
+/* If no error has occurred, do the job in a new AST context and a new
+   arena scope, so that any scratch memory allocated by the job using
+   starArenaMalloc is released when the job completes. If tracing,
+   record when the job starts and ends, and make the job's tag the
+   current tag for this thread so that it is inherited by any jobs
+   submitted by the job. */
          if( status == SAI__OK ) {
+            if( wf->trace_file ) {
+               job->worker = thr1WorkerIndex( wf );
+               pthread_setspecific( thr_tag_key, job->tag );
+               job->t_start = thr1TraceTime( wf );
+            }
             astBegin;
+            starArenaBegin();
             (*job->func)( job->data, &status );
+            starArenaReset();
             astEnd;
+            if( wf->trace_file ) job->t_end = thr1TraceTime( wf );
             thr1ThreadLog( "run_worker: completed job - joining queue",
                             WAIT, job->ijob );
 
@@ -2502,6 +4614,289 @@ static void *thr1RunWorker( void *wf_ptr ) {
 
 
 
+static void thr1TouchJob( void *job_data, int *status ){
+/*
+*  Name:
+*     thr1TouchJob
+
+*  Purpose:
+*     Initialise one worker's block of memory for thrMallocLocal.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     void thr1TouchJob( void *job_data, int *status )
+
+*  Description:
+*     This function is run as a job by thrMallocLocal. One such job is
+*     submitted for each worker in the workforce. Each job first waits
+*     until all the jobs have started, ensuring that every worker is
+*     running one of the jobs. It then fills the block of memory
+*     associated with the worker running the job with zeros.
+
+*  Arguments:
+*     job_data
+*        Pointer to the ThrTouch structure describing the memory.
+*     status
+*        Pointer to the inherited status value.
+
+*/
+
+/* Local Variables: */
+   ThrTouch *touch;
+   int iworker;
+   size_t first;
+   size_t nbyte;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Get a pointer to the structure describing the memory. */
+   touch = (ThrTouch *) job_data;
+
+/* Wait until all jobs have started. */
+   thrMutexLock( &(touch->mutex), status );
+   if( *status == SAI__OK ) {
+      if( ++(touch->narrived) == touch->workforce->nworker ) {
+         thrCondBroadcast( &(touch->cond), status );
+      } else {
+         while( touch->narrived < touch->workforce->nworker &&
+                *status == SAI__OK ) {
+            thrCondWait( &(touch->cond), &(touch->mutex), status );
+         }
+      }
+      thrMutexUnlock( &(touch->mutex), status );
+   }
+
+/* Identify the worker running this job, and zero its block of memory. */
+   iworker = thr1WorkerIndex( touch->workforce );
+   if( iworker < 0 ) {
+      if( *status == SAI__OK ) {
+         *status = SAI__ERROR;
+         emsRep( "", "thr1TouchJob: Cannot identify the current worker "
+                 "(internal programming error).", status );
+      }
+
+   } else if( *status == SAI__OK ) {
+      first = iworker*touch->bsize;
+      if( first < touch->size ) {
+         nbyte = touch->size - first;
+         if( nbyte > touch->bsize ) nbyte = touch->bsize;
+         memset( touch->mem + first, 0, nbyte );
+      }
+   }
+}
+
+
+
+static void thr1TraceAdd( ThrWorkForce *workforce, const char *tag,
+                          void (*func)( void *, int * ), int ijob, int worker,
+                          double submit, double start, double end,
+                          int *status ){
+/*
+*  Name:
+*     thr1TraceAdd
+
+*  Purpose:
+*     Record an event in the trace of workforce activity.
+
+*  Language:
+*     Starlink ANSI C
+
+*  Type of Module:
+*     C function
+
+*  Invocation:
+*     void thr1TraceAdd( ThrWorkForce *workforce, const char *tag,
+*                        void (*func)( void *, int * ), int ijob, int worker,
+*                        double submit, double start, double end,
+*                        int *status )
+
+*  Description:
+*     This function appends a description of a completed job, or of a
+*     call to thrWait, to the list of events held in the workforce. It
+*     should only be called whilst the caller has exclusive access to the
+*     job desk.
+
+*  Arguments:
+*     workforce
+*        Pointer to the workforce.
+*     tag
+*        The tag associated with the event, or NULL.
+*     func
+*        The job function, or NULL if the event describes a wait.
+*     ijob
+*        The job identifier, or zero if the event describes a wait.
+*     worker
+*        The index of the worker that ran the job or waited, or -1 if
+*        the thread was not one of the workers in the workforce.
+*     submit
+*        The time at which the job was submitted.
+*     start
+*        The time at which the job or wait started.
+*     end
+*        The time at which the job or wait ended.
+*     status
+*        Pointer to the inherited status value.
+
+*/
+
+/* Local Variables: */
+   ThrTraceEvent *event;
+
+/* Check inherited status */
+   if( *status != SAI__OK ) return;
+
+/* Extend the array of events. If the events are being stored for the
+   singleton workforce, do this in an AST "permanent memory" context so
+   that the memory is not reported as a memory leak. */
+   if( workforce == singleton ) astBeginPM;
+   workforce->trace = astGrow( workforce->trace, workforce->ntrace + 1,
+                               sizeof( *(workforce->trace) ) );
+   if( workforce == singleton ) astEndPM;
+
+/* Store the event. */
+   if( *status == SAI__OK ) {
+      event = workforce->trace + (workforce->ntrace)++;
+      event->tag = tag;
+      event->func = func;
+      event->ijob = ijob;
+      event->worker = worker;
+      event->submit = submit;
+      event->start = start;
+      event->end = end;
+   }
+}
+
+static double thr1TraceTime( ThrWorkForce *workforce ){
+/*
+*  Name:
+*     thr1TraceTime
+
+*  Purpose:
+*     Get the current time for use in a trace of workforce activity.
+
+*  Description:
+*     This function returns the time since the workforce was created.
+
+*  Arguments:
+*     workforce
+*        Pointer to the workforce.
+
+*  Returned Value:
+*     The number of microseconds since the workforce was created.
+
+*/
+
+/* Local Variables: */
+   struct timeval tv;
+
+   gettimeofday( &tv, NULL );
+   return 1.0E6*( tv.tv_sec - workforce->trace_t0.tv_sec ) +
+          ( tv.tv_usec - workforce->trace_t0.tv_usec );
+}
+
+static void thr1TraceWrite( ThrWorkForce *workforce ){
+/*
+*  Name:
+*     thr1TraceWrite
+
+*  Purpose:
+*     Write out the trace of workforce activity.
+
+*  Description:
+*     This function writes the events recorded for a workforce to the
+*     file specified by environment variable THR_TRACE, using the Chrome
+*     trace event JSON format. Each job is written as a "complete" event
+*     on the timeline of the worker that ran it. Calls to thrWait are
+*     written on the timeline of the worker that made the call, or on a
+*     separate timeline if it was made by any other thread. No error is
+*     reported if the file cannot be written, but a message is written
+*     to standard error.
+
+*  Arguments:
+*     workforce
+*        Pointer to the workforce.
+
+*/
+
+/* Local Variables: */
+   FILE *fp;
+   ThrTraceEvent *event;
+   char fname[ 200 ];
+   const char *name;
+   const char *sep;
+   int i;
+#if HAVE_DLFCN_H && HAVE_DLADDR
+   Dl_info info;
+#endif
+
+/* Open the output file. */
+   fp = fopen( workforce->trace_file, "w" );
+   if( !fp ) {
+      fprintf( stderr, "thr: Failed to open THR_TRACE file '%s'\n",
+               workforce->trace_file );
+      return;
+   }
+
+/* Write a name for each timeline. */
+   fprintf( fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+   fprintf( fp, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+            "\"args\":{\"name\":\"manager\"}}" );
+   for( i = 0; i < workforce->nworker; i++ ) {
+      fprintf( fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+               "\"tid\":%d,\"args\":{\"name\":\"worker %d\"}}", i + 1, i );
+   }
+
+/* Write each event. Jobs are named using their tag if available, and
+   otherwise the name of the job function. If the function name cannot
+   be determined exactly (e.g. because it is a static function), give
+   its offset within the shared object containing it, which can be
+   converted to a source location using addr2line. */
+   for( i = 0; i < workforce->ntrace; i++ ) {
+      event = workforce->trace + i;
+
+      if( event->func ) {
+         sprintf( fname, "%p", (void *) event->func );
+#if HAVE_DLFCN_H && HAVE_DLADDR
+         if( dladdr( (void *) event->func, &info ) ) {
+            if( info.dli_sname && info.dli_saddr == (void *) event->func ) {
+               sprintf( fname, "%.190s", info.dli_sname );
+            } else if( info.dli_fname ) {
+               sep = strrchr( info.dli_fname, '/' );
+               sprintf( fname, "%.170s+0x%lx", sep ? sep + 1 : info.dli_fname,
+                        (unsigned long)( (char *) event->func -
+                                         (char *) info.dli_fbase ) );
+            }
+         }
+#endif
+         name = event->tag ? event->tag : fname;
+         fprintf( fp, ",\n{\"name\":\"%s\",\"cat\":\"job\",\"ph\":\"X\","
+                  "\"pid\":1,\"tid\":%d,\"ts\":%.1f,\"dur\":%.1f,"
+                  "\"args\":{\"job\":%d,\"func\":\"%s\",\"queued_us\":%.1f}}",
+                  name, event->worker + 1, event->start,
+                  event->end - event->start, event->ijob, fname,
+                  event->start - event->submit );
+
+      } else {
+         fprintf( fp, ",\n{\"name\":\"thrWait\",\"cat\":\"wait\",\"ph\":\"X\","
+                  "\"pid\":1,\"tid\":%d,\"ts\":%.1f,\"dur\":%.1f,"
+                  "\"args\":{\"tag\":\"%s\"}}", event->worker + 1,
+                  event->start, event->end - event->start,
+                  event->tag ? event->tag : "" );
+      }
+   }
+
+/* Close the file. */
+   fprintf( fp, "\n]}\n" );
+   fclose( fp );
+}
+
+
 /* Public pthreads wrapper functions */
 /* --------------------------------- */
 
@@ -2930,6 +5325,85 @@ static void thr1GlobalsDestroyKey( void *kmap ) {
 }
 
 
+static void thr1WorkerCreateKey( void ) {
+/*
+*  Name:
+*     thr1WorkerCreateKey
+
+*  Purpose:
+*     Create the thread specific data key used for identifying workers.
+
+*  Description:
+*     This function creates the thread-specific data key used to store
+*     a pointer to the ThrWorker structure describing the worker running
+*     in each thread, when the work-stealing scheduler is in use. It is
+*     called once only by the pthread_once function, which is invoked from
+*     the thrCreateWorkforce function.
+
+*/
+
+/* Create the key. No destructor is needed since the ThrWorker structures
+   are owned by the workforce. */
+   if( pthread_key_create( &thr_worker_key, NULL ) ) {
+      fprintf( stderr, "thr: Failed to create Thread-Specific Data key" );
+   }
+}
+
+static void thr1TagCreateKey( void ) {
+/*
+*  Name:
+*     thr1TagCreateKey
+
+*  Purpose:
+*     Create the thread specific data key used for storing job tags.
+
+*  Description:
+*     This function creates the thread-specific data key used to store
+*     the tag to be associated with jobs submitted by each thread (see
+*     thrSetJobTag). It is called once only by the pthread_once function.
+
+*/
+
+/* Create the key. No destructor is needed since the tags are not owned
+   by this module. */
+   if( pthread_key_create( &thr_tag_key, NULL ) ) {
+      fprintf( stderr, "thr: Failed to create Thread-Specific Data key" );
+   }
+}
+
+static int thr1WorkerIndex( ThrWorkForce *workforce ) {
+/*
+*  Name:
+*     thr1WorkerIndex
+
+*  Purpose:
+*     Identify the worker running in the current thread.
+
+*  Description:
+*     This function returns the index of the worker running in the
+*     current thread, by comparing the current thread identifier with
+*     those stored in the workforce.
+
+*  Arguments:
+*     workforce
+*        Pointer to the workforce.
+
+*  Returned Value:
+*     The zero-based index of the worker, or -1 if the current thread is
+*     not one of the workers in the supplied workforce.
 
+*/
 
+/* Local Variables: */
+   int i;
+   pthread_t self;
 
+/* Compare the current thread with each worker's thread. */
+   if( workforce && workforce->threads ) {
+      self = pthread_self();
+      for( i = 0; i < workforce->nworker; i++ ) {
+         if( pthread_equal( self, workforce->threads[ i ] ) ) return i;
+      }
+   }
+   return -1;
+}
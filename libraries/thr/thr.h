@@ -38,6 +38,8 @@
  */
 
 #include <pthread.h>
+#include <stddef.h>
+#include <sys/time.h>
 #include "ast.h"
 
 /* Macros */
@@ -57,7 +59,11 @@ typedef struct ThrJobStatus {
 
 /* Describes a single job in a linked list of jobs. */
 typedef struct ThrJob ThrJob;
+typedef struct ThrWorker ThrWorker;
 typedef struct ThrWorkForce ThrWorkForce;
+typedef struct ThrTraceEvent ThrTraceEvent;
+typedef struct ThrGraph ThrGraph;
+typedef struct ThrGraphNode ThrGraphNode;
 
 struct ThrJob {
   int ijob;                   /* Job identifier */
@@ -70,8 +76,41 @@ struct ThrJob {
   ThrJob **waiting_on;        /* Jobs that must finish before this one can run */
   ThrJob *next;               /* Next job in list */
   ThrJob *prev;               /* Previous job in list */
+  ThrJob *qnext;              /* Next job in worker queue (work-stealing) */
+  ThrJob *qprev;              /* Previous job in worker queue (work-stealing) */
   int conid;                  /* Context idenrifier for job */
   ThrJobStatus *status;       /* The error status upon completion of the job */
+  const char *tag;            /* Tag identifying the job in traces */
+  int worker;                 /* Index of worker that ran the job (traces) */
+  double t_submit;            /* Time job was submitted (traces) */
+  double t_start;             /* Time job started (traces) */
+  double t_end;               /* Time job ended (traces) */
+};
+
+/* Describes a single worker when the work-stealing scheduler is used. */
+struct ThrWorker {
+  int iworker;                /* Index of worker within the work force */
+  ThrWorkForce *workforce;    /* The work force to which the worker belongs */
+  ThrJob *queue;              /* Jobs queued for this worker */
+  ThrJob *done;               /* Completed jobs not yet reported at the desk */
+  int ndone;                  /* Number of jobs in the "done" list */
+  pthread_mutex_t q_mutex;    /* Mutex controlling access to "queue" */
+};
+
+/* Describes a single job in a job dependency graph. */
+struct ThrGraphNode {
+  int flags;                  /* Job control flags */
+  void *data;                 /* Structure holding data for the worker */
+  void (*func)(void *, int *);/* The function to be run by the worker */
+  int nafter;                 /* Length of "after" array */
+  int *after;                 /* Zero-based indices of jobs to wait for */
+  int ijob;                   /* Job identifier when last run */
+};
+
+/* Describes a graph of jobs and the dependencies between them. */
+struct ThrGraph {
+  int nnode;                  /* Number of jobs in the graph */
+  ThrGraphNode *nodes;        /* Array of "nnode" job descriptions */
 };
 
 /* Structure describing the whole work force. */
@@ -91,6 +130,15 @@ struct ThrWorkForce {
   int *contexts;              /* List of job context identifiers. */
   int condepth;               /* Depth of job context nesting */
   ThrJobStatus *status;       /* First bad error status reported by a worker */
+  int steal;                  /* Use per-worker queues with work stealing? */
+  ThrWorker *workers;         /* Array of "nworker" workers (work-stealing only) */
+  int next_worker;            /* Worker to receive the next job from a manager */
+  int *cpus;                  /* CPU to which each worker is bound, or NULL */
+  pthread_t *threads;         /* Thread in which each worker is running */
+  char *trace_file;           /* File to receive trace, or NULL if not tracing */
+  ThrTraceEvent *trace;       /* Array of recorded trace events */
+  int ntrace;                 /* Number of recorded trace events */
+  struct timeval trace_t0;    /* Time at which tracing started */
 };
 
 
@@ -116,9 +164,27 @@ int thrJobWait( ThrWorkForce *workforce, int *status );
 void *thrGetJobData( int ijob, ThrWorkForce *workforce, int *status );
 void thrBeginJobContext( ThrWorkForce *workforce, int *status );
 void thrEndJobContext( ThrWorkForce *workforce, int *status );
+void *thrMallocLocal( ThrWorkForce *workforce, size_t size, int *status );
+ThrGraph *thrGraphNew( int *status );
+ThrGraph *thrGraphFree( ThrGraph *graph );
+int thrGraphAdd( ThrGraph *graph, int flags, void *data,
+                 void (*func)( void *, int * ), int *status );
+void thrGraphDepend( ThrGraph *graph, int job, int after, int *status );
+void thrGraphRun( ThrWorkForce *workforce, ThrGraph *graph, int *status );
+void thrParallelFor( ThrWorkForce *workforce, size_t first, size_t last,
+                     size_t grain, void *data,
+                     void (*func)( void *, size_t, size_t, int * ),
+                     int *status );
+void thrParallelReduce( ThrWorkForce *workforce, size_t first, size_t last,
+                        size_t grain, void *data,
+                        void (*func)( void *, size_t, size_t, void *, int * ),
+                        size_t size, void *result,
+                        void (*reduce)( void *, void *, const void *, int * ),
+                        int *status );
 
 /* Prototypes for other public functions */
 int thrGetNThread( const char *env, int *status );
 AstKeyMap *thrThreadData( int *status );
+const char *thrSetJobTag( const char *tag );
 
 #endif
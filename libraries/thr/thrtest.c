@@ -1,33 +1,76 @@
 #include "thr.h"
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 typedef struct JobData {
    int start;
 } JobData;
 
+typedef struct NodeData {
+   int value;
+   int scale;
+   struct NodeData *in1;
+   struct NodeData *in2;
+} NodeData;
+
 void worker( void *data, int *status );
+void node( void *data, int *status );
 
 #define NW 2
 
 int main( void ){
    int i;
+   int imode;
+   int ia, ib, ic, id;
    JobData data[ NW ];
+   NodeData nodes[ 4 ];
    int status = 0;
-   ThrWorkForce *wf = thrCreateWorkforce( NW, &status );
+   ThrGraph *graph;
+   ThrWorkForce *wf;
 
-   for( i = 0; i < NW; i++ ) {
-      data[ i ].start = i;
-      thrAddJob( wf, 0, data + i, worker,  0, NULL, &status );
-   }
+/* Run the test using both the default and the work-stealing scheduler. */
+   for( imode = 0; imode < 2; imode++ ) {
+      if( imode == 1 ) setenv( "THR_SCHEDULER", "STEAL", 1 );
+      wf = thrCreateWorkforce( NW, &status );
+
+      for( i = 0; i < NW; i++ ) {
+         data[ i ].start = i;
+         thrAddJob( wf, 0, data + i, worker,  0, NULL, &status );
+      }
+
+      thrWait( wf, &status );
 
-   thrWait( wf, &status );
+      assert( data[ 0 ].start == 45 );
+      assert( data[ 1 ].start == 56 );
 
-   assert( data[ 0 ].start == 45 );
-   assert( data[ 1 ].start == 56 );
+/* Run a diamond-shaped job graph (A before B and C, both before D), with
+   the jobs and dependencies added in reverse order. */
+      for( i = 0; i < 4; i++ ) {
+         nodes[ i ].value = 0;
+         nodes[ i ].scale = i + 1;
+         nodes[ i ].in1 = ( i == 0 ) ? NULL : nodes + ( ( i == 3 ) ? 1 : 0 );
+         nodes[ i ].in2 = ( i == 3 ) ? nodes + 2 : NULL;
+      }
+      graph = thrGraphNew( &status );
+      id = thrGraphAdd( graph, 0, nodes + 3, node, &status );
+      ic = thrGraphAdd( graph, 0, nodes + 2, node, &status );
+      ib = thrGraphAdd( graph, 0, nodes + 1, node, &status );
+      ia = thrGraphAdd( graph, 0, nodes + 0, node, &status );
+      thrGraphDepend( graph, id, ic, &status );
+      thrGraphDepend( graph, id, ib, &status );
+      thrGraphDepend( graph, ic, ia, &status );
+      thrGraphDepend( graph, ib, ia, &status );
+      thrGraphRun( wf, graph, &status );
+      graph = thrGraphFree( graph );
 
-   wf = thrDestroyWorkforce( wf );
+      assert( nodes[ 0 ].value == 1 );
+      assert( nodes[ 3 ].value == 4*( 2 + 3 ) );
 
+      wf = thrDestroyWorkforce( wf );
+   }
+
+   return status;
 }
 
 void worker( void *data, int *status ){
@@ -39,4 +82,10 @@ void worker( void *data, int *status ){
    }
 }
 
-
+void node( void *data, int *status ){
+   NodeData *nodedata = (NodeData *) data;
+   int sum = 1;
+   if( nodedata->in1 ) sum = nodedata->in1->value;
+   if( nodedata->in2 ) sum += nodedata->in2->value;
+   nodedata->value = nodedata->scale*sum;
+}
@@ -33,6 +33,8 @@
  *     27 Apr 2001 Undo the change to pixels/inch above.
  *     29 May 2003 Correct bug for 24-bit displays when image buffer size
  *                 calculation was incorrect for 32-bits/pixel
+ *     14 Oct 2026 Send lines of image pixels through an MIT-SHM shared
+ *                 memory image when the X server supports it.
  */
 
 /*
@@ -75,6 +77,12 @@
 #include <X11/Xatom.h>
 #include <X11/cursorfont.h>
 
+#ifdef HAVE_MITSHM
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/extensions/XShm.h>
+#endif
+
 /* GWM include files */
 
 #include "gwm.h"
@@ -88,6 +96,7 @@ extern F77_SUBROUTINE(grwarn)( CHARACTER(text) TRAIL(text) );
 
 #define NCOLORS 16            /* Number of pre-defined PGPLOT colors */
 #define GWM_IMAGE_LEN 1280    /* Length of the line-of-pixels buffer */
+#define GWM_SHM_ROWS 64       /* Lines of pixels in a shared memory image */
 #define COLORMULT 65535       /* Normalized color intensity multiplier */
 #define GWM_DEF_WIDTH 780     /* Default width (pixels) */
 #define GWM_DEF_HEIGHT 512    /* Deafult height (pixels) */
@@ -151,12 +160,20 @@ typedef struct {
 
 /*
  * Declare a container to encapsulate the buffers needed to
- * draw a line of pixels.
+ * draw a line of pixels. When the MIT-SHM extension is available xi[]
+ * is a shared memory image holding nrow lines, which are used in turn
+ * so that the server need only be waited for once every nrow lines.
  */
 typedef struct {
   int npix;            /* The max number of pixels in buff[] */
+  int nrow;            /* The number of lines of pixels in xi[] */
+  int row;             /* The next unused line of xi[] */
   unsigned char *buff; /* The image buffer registered to xi[] */
   XImage *xi;          /* Line of pixels Xlib image object */
+#ifdef HAVE_MITSHM
+  int shm;             /* True if xi[] is a shared memory image */
+  XShmSegmentInfo shminfo; /* The shared memory segment of xi[] */
+#endif
 } GWMimage;
 
 /*
@@ -218,6 +235,9 @@ static int gwm_ok(GWMdev *gwm);
 static int gwm_set_rgb(GWMdev *gwm, int ci, float red, float green, float blue);
 static int gwm_init_colors(GWMdev *gwm);
 static int gwm_get_image(GWMdev *gwm, int npix);
+#ifdef HAVE_MITSHM
+static int gwm_get_shm_image(GWMdev *gwm, int npix);
+#endif
 static int gwm_new_cursors(GWMdev *gwm);
 static int gwm_clear(GWMdev *gwm);
 static int gwm_set_ci(GWMdev *gwm, int ci);
@@ -1561,6 +1581,14 @@ static GWMdev *del_GWMdev(GWMdev *gwm, int partial)
  * Delete the image buffers.
  */
     gwm->image.npix = 0;
+#ifdef HAVE_MITSHM
+    if(gwm->image.shm) {
+      XShmDetach(gwm->display, &gwm->image.shminfo);
+      shmdt(gwm->image.shminfo.shmaddr);
+      gwm->image.shm = 0;
+      gwm->image.buff = NULL;
+    }
+#endif
     if(gwm->image.buff)
       free(gwm->image.buff);
     gwm->image.buff = NULL;
@@ -2119,6 +2147,8 @@ static void gwm_XPoint_to_xy(GWMdev *gwm, XPoint *xp, float *xy)
 static int gwm_image_line(GWMdev *gwm, XPoint *start, float *cells, int ncell)
 {
   int ndone;  /* The number of pixels drawn so far */
+  int row;    /* The line of gwm->image.xi to use */
+  unsigned char *line; /* The start of that line in gwm->image.buff[] */
   int i;
 /*
  * Device error?
@@ -2136,23 +2166,41 @@ static int gwm_image_line(GWMdev *gwm, XPoint *start, float *cells, int ncell)
     for(ndone=0; !gwm->bad_device && ndone<ncell; ndone += gwm->image.npix) {
       int ntodo = ncell-ndone;
       int nimage = ntodo < gwm->image.npix ? ntodo : gwm->image.npix;
+/*
+ * Pick the next unused line of the image. Once they have all been used,
+ * wait for the server to finish reading them before starting again.
+ */
+      if(gwm->image.row >= gwm->image.nrow) {
+	if(gwm->image.nrow > 1)
+	  XSync(gwm->display, False);
+	gwm->image.row = 0;
+      }
+      row = gwm->image.row++;
+      line = gwm->image.buff + row * gwm->image.xi->bytes_per_line;
 /*
  * Load the image buffer with the color cell indexes assigned to the
  * given PGPLOT color indexes.
  */
       if(gwm->color.vi->depth == 8) {
 	for(i=0; i<nimage; i++)
-	  gwm->image.buff[i] = gwm->color.pixel[(int) (cells[ndone+i] + 0.5)];
+	  line[i] = gwm->color.pixel[(int) (cells[ndone+i] + 0.5)];
       } else {
 	for(i=0; i<nimage; i++) {
-	  XPutPixel(gwm->image.xi, i, 0,
+	  XPutPixel(gwm->image.xi, i, row,
 		    gwm->color.pixel[(int) (cells[ndone+i] + 0.5)]);
 	}
       }
 /*
  * Display the image.
  */
-      XPutImage(gwm->display, gwm->pixmap, gwm->gc, gwm->image.xi, 0, 0,
+#ifdef HAVE_MITSHM
+      if(gwm->image.shm)
+	XShmPutImage(gwm->display, gwm->pixmap, gwm->gc, gwm->image.xi,
+		     0, row, start->x+ndone, start->y,
+		     (unsigned) nimage, (unsigned) 1, False);
+      else
+#endif
+      XPutImage(gwm->display, gwm->pixmap, gwm->gc, gwm->image.xi, 0, row,
 		start->x+ndone, start->y, (unsigned) nimage, (unsigned) 1);
     }
 /*
@@ -3076,6 +3124,15 @@ static int gwm_get_image(GWMdev *gwm, int npix)
   XPixmapFormatValues *pixmaps;
   int npixmap;
   int i, bpp;
+/*
+ * Use a shared memory image if the server allows it.
+ */
+  gwm->image.nrow = 1;
+  gwm->image.row = 0;
+#ifdef HAVE_MITSHM
+  if(gwm_get_shm_image(gwm, npix) == 0)
+    return 0;
+#endif
 /*
  * Determine the required size of the buffer. This is determined by
  * the size of a pixel (the depth of the window), the number of
@@ -3113,6 +3170,77 @@ static int gwm_get_image(GWMdev *gwm, int npix)
   return 0;
 }
 
+#ifdef HAVE_MITSHM
+/*.......................................................................
+ * Allocate gwm->image as a shared memory image of GWM_SHM_ROWS lines,
+ * if the X server supports the MIT-SHM extension and can attach to the
+ * shared memory (it cannot when it is on another machine). This is
+ * quietly abandoned on any failure, so that the caller can fall back
+ * to an ordinary image.
+ *
+ * Input:
+ *  gwm   GWMdev * The PGPLOT /gwm device descriptor.
+ *  npix    int   The length of each line in pixels.
+ * Output:
+ *  return  int   0 - OK.
+ *                1 - Shared memory is not available.
+ */
+static int gwm_get_shm_image(GWMdev *gwm, int npix)
+{
+  XShmSegmentInfo *shminfo = &gwm->image.shminfo;
+  XImage *xi;
+  int attached;
+
+  gwm->image.shm = 0;
+  if(!XShmQueryExtension(gwm->display))
+    return 1;
+/*
+ * Create the image container and a shared memory segment large enough
+ * for its data.
+ */
+  xi = XShmCreateImage(gwm->display, gwm->color.vi->visual,
+		       (unsigned)gwm->color.vi->depth, ZPixmap, NULL,
+		       shminfo, (unsigned)npix, GWM_SHM_ROWS);
+  if(xi == NULL)
+    return 1;
+  shminfo->shmid = shmget(IPC_PRIVATE,
+			  (size_t) xi->bytes_per_line * xi->height,
+			  IPC_CREAT | 0600);
+  if(shminfo->shmid < 0) {
+    XFree((char *)xi);
+    return 1;
+  }
+  shminfo->shmaddr = xi->data = (char *) shmat(shminfo->shmid, NULL, 0);
+  if(shminfo->shmaddr == (char *) -1) {
+    shmctl(shminfo->shmid, IPC_RMID, NULL);
+    XFree((char *)xi);
+    return 1;
+  }
+  shminfo->readOnly = False;
+/*
+ * Ask the server to attach to the segment, and wait to see whether an
+ * error is reported. The segment can be marked for removal straight
+ * away; it will go once both we and the server have detached from it.
+ */
+  gwm->last_error = 0;
+  attached = XShmAttach(gwm->display, shminfo);
+  XSync(gwm->display, False);
+  shmctl(shminfo->shmid, IPC_RMID, NULL);
+  if(!attached || gwm->last_error != 0 || gwm->bad_device) {
+    gwm->last_error = 0;
+    shmdt(shminfo->shmaddr);
+    XFree((char *)xi);
+    return 1;
+  }
+  gwm->image.npix = npix;
+  gwm->image.nrow = GWM_SHM_ROWS;
+  gwm->image.buff = (unsigned char *) shminfo->shmaddr;
+  gwm->image.xi = xi;
+  gwm->image.shm = 1;
+  return 0;
+}
+#endif
+
 /*.......................................................................
  * Limit pixmap coordinates to lie within the pixmap area.
  *
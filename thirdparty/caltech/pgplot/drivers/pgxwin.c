@@ -16,6 +16,7 @@
 
 #define PGX_IDENT "pgxwin"
 #define PGX_IMAGE_LEN 1280  /* Length of the line-of-pixels buffer */
+#define PGX_BATCH_LEN 1024  /* Number of lines or dots buffered */
 #define PGX_COLORMULT 65535 /* Normalized color intensity multiplier */
 #define PGX_NCOLORS 16      /* Number of pre-defined PGPLOT colors */
 #define PGX_QUERY_MAX 512   /* Max colormap query size in pgx_readonly_colors() */
@@ -90,6 +91,20 @@ typedef struct {
   XImage *xi;          /* Line of pixels Xlib image object */
 } XWimage;
 
+/*
+ * Declare a container used to buffer consecutive line segments and
+ * dots, so that they can be drawn with one X request per batch. Only
+ * one of the arrays is in use at a time.
+ */
+typedef struct {
+  XSegment segs[PGX_BATCH_LEN]; /* Buffered line segments */
+  int nseg;                     /* The number of segments in segs[] */
+  XPoint points[PGX_BATCH_LEN]; /* Buffered single pixel dots */
+  int npoint;                   /* The number of points in points[] */
+  XArc arcs[PGX_BATCH_LEN];     /* Buffered circular dots */
+  int narc;                     /* The number of arcs in arcs[] */
+} XWbatch;
+
 /*
  * Declare a function type, instances of which are to be called to flush
  * buffered opcodes, and return 0 if OK, or 1 on error.
@@ -108,6 +123,7 @@ struct PgxState {
   XWcursor cursor;   /* Cursor state context descriptor */
   XWworld world;     /* World-coordinate conversion descriptor */
   XWimage image;     /* Line of pixels container */
+  XWbatch batch;     /* Buffered lines and dots */
   XGCValues gcv;     /* Publicly visible contents of 'gc' */
   GC gc;             /* Graphical context descriptor */
   int last_opcode;   /* Index of last opcode */
@@ -130,6 +146,7 @@ static void pgx_XPoint_to_xy ARGS((PgxWin *pgx, XPoint *xp, float *xy));
 static void pgx_mark_modified ARGS((PgxWin *pgx, int x, int y, int diameter));
 static int pgx_init_colors ARGS((PgxWin *pgx));
 static int pgx_update_colors ARGS((PgxWin *pgx));
+static int pgx_flush_batch ARGS((PgxWin *pgx));
 static int pgx_flush_colors ARGS((PgxWin *pgx, int ci_start, int ncol));
 static int pgx_restore_line ARGS((PgxWin *pgx, int xa, int ya, int xb, int yb));
 static int pgx_handle_cursor ARGS((PgxWin *pgx, float *rbuf, char *key));
@@ -241,6 +258,9 @@ PgxState *pgx_open(pgx)
   state->world.xdiv = 1.0;
   state->world.ydiv = 1.0;
   state->image.xi = NULL;
+  state->batch.nseg = 0;
+  state->batch.npoint = 0;
+  state->batch.narc = 0;
   state->gc = NULL;
   state->last_opcode = 0;
   state->flush_opcode_fn = 0;
@@ -1873,13 +1893,21 @@ void pgx_draw_line(pgx, rbuf)
  */
     XPoint start;
     XPoint end;
+    XSegment *seg;
     pgx_xy_to_XPoint(pgx, &rbuf[0], &start);
     pgx_xy_to_XPoint(pgx, &rbuf[2], &end);
 /*
- * Draw the line segment.
+ * Add the line segment to the buffer of segments, which is drawn when
+ * it fills or when the next different opcode arrives.
  */
-    XDrawLine(pgx->display, pgx->pixmap, state->gc,
-	      start.x, start.y, end.x, end.y);
+    if(state->batch.nseg >= PGX_BATCH_LEN)
+      pgx_flush_batch(pgx);
+    seg = &state->batch.segs[state->batch.nseg++];
+    seg->x1 = start.x;
+    seg->y1 = start.y;
+    seg->x2 = end.x;
+    seg->y2 = end.y;
+    state->flush_opcode_fn = (Flush_Opcode_fn) pgx_flush_batch;
 /*
  * Record the extent of the modified region of the pixmap.
  */
@@ -1916,17 +1944,25 @@ void pgx_draw_dot(pgx, rbuf)
  */
     pgx_xy_to_XPoint(pgx, rbuf, &xp);
 /*
- * Draw a pixel-sized point, or a larger circular dot?
+ * Buffer a pixel-sized point, or a larger circular dot? The line width
+ * can only change with a new opcode, so all of the buffered dots are the
+ * same size.
  */
+    if(state->batch.npoint>=PGX_BATCH_LEN || state->batch.narc>=PGX_BATCH_LEN)
+      pgx_flush_batch(pgx);
     if(radius < 1) {
-      XDrawPoint(pgx->display, pgx->pixmap, state->gc, xp.x, xp.y);
+      state->batch.points[state->batch.npoint++] = xp;
     } else {
+      XArc *arc = &state->batch.arcs[state->batch.narc++];
       unsigned int diameter = radius*2;
-      int x = xp.x - radius;
-      int y = xp.y - radius;
-      XFillArc(pgx->display, pgx->pixmap, state->gc, x, y,
-	       diameter, diameter, 0, 23040);
+      arc->x = xp.x - radius;
+      arc->y = xp.y - radius;
+      arc->width = diameter;
+      arc->height = diameter;
+      arc->angle1 = 0;
+      arc->angle2 = 23040;
     };
+    state->flush_opcode_fn = (Flush_Opcode_fn) pgx_flush_batch;
 /*
  * Record the extent of the modified region of the pixmap.
  */
@@ -1935,6 +1971,43 @@ void pgx_draw_dot(pgx, rbuf)
   return;
 }
 
+/*.......................................................................
+ * Draw the lines and dots that have been buffered by pgx_draw_line()
+ * and pgx_draw_dot(). This is registered as the flush function of the
+ * line and dot opcodes.
+ *
+ * Input:
+ *  pgx    PgxWin *  The PGPLOT window context.
+ * Output:
+ *  return    int      0 - OK.
+ *                     1 - Error.
+ */
+#ifdef __STDC__
+static int pgx_flush_batch(PgxWin *pgx)
+#else
+static int pgx_flush_batch(pgx)
+     PgxWin *pgx;
+#endif
+{
+  if(pgx_ready(pgx, PGX_NEED_PGOPEN)) {
+    PgxState *state = pgx->state;
+    if(pgx->pixmap != None) {
+      if(state->batch.nseg > 0)
+	XDrawSegments(pgx->display, pgx->pixmap, state->gc, state->batch.segs,
+		      state->batch.nseg);
+      if(state->batch.npoint > 0)
+	XDrawPoints(pgx->display, pgx->pixmap, state->gc, state->batch.points,
+		    state->batch.npoint, CoordModeOrigin);
+      if(state->batch.narc > 0)
+	XFillArcs(pgx->display, pgx->pixmap, state->gc, state->batch.arcs,
+		  state->batch.narc);
+    };
+    state->batch.nseg = state->batch.npoint = state->batch.narc = 0;
+    return pgx->bad_device != 0;
+  };
+  return 1;
+}
+
 /*.......................................................................
  * Convert from the coordinates sent by PGPLOT in rbuf[...] to an
  * X-windows point in the coordinate system of the pixmap.
@@ -2977,6 +3050,12 @@ void pgx_new_pixmap(pgx, width, height)
 #endif
 {
   if(pgx_ready(pgx, PGX_NEED_COLOR | PGX_NEED_WINDOW)) {
+/*
+ * Any buffered lines and dots were destined for the old pixmap.
+ */
+    if(pgx->state)
+      pgx->state->batch.nseg = pgx->state->batch.npoint =
+	pgx->state->batch.narc = 0;
 /*
  * Bracket the pixmap acquisition with pgx_start/end_error() calls, to
  * determine whether any allocation errors occur.
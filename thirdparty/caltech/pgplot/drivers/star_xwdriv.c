@@ -36,6 +36,9 @@
  * Version 3.01 - 1999 Sep 09 - B. K. McIlwrath (bkm@star.rl.ac.uk).
  *                              Correct operation within Starlink
  *                              (alink) environment.
+ * Version 3.02 - 2026 Oct 14 - Consecutive lines and dots are buffered
+ *                              and sent with XDrawSegments, XDrawPoints
+ *                              or XFillArcs.
  *
  *  Scope: This driver should work with all unix workstations running
  *         X Windows (Version 11). It also works on VMS and OpenVMS
@@ -164,6 +167,7 @@ extern F77_SUBROUTINE(grwarn)( CHARACTER(text) TRAIL(text) );
 
 #define NCOLORS 16            /* Number of pre-defined PGPLOT colors */
 #define XW_IMAGE_LEN 1280     /* Length of the line-of-pixels buffer */
+#define XW_BATCH_LEN 1024     /* Number of lines or dots buffered */
 #define COLORMULT 65535       /* Normalized color intensity multiplier */
 
 #define XW_IDENT "PGPLOT /xw"      /* Name to prefix messages to user */
@@ -277,6 +281,20 @@ typedef struct {
   XImage *xi;          /* Line of pixels Xlib image object */
 } XWimage;
 
+/*
+ * Declare a container used to buffer consecutive line segments and
+ * dots, so that they can be drawn with one X request per batch. Only
+ * one of the arrays is in use at a time.
+ */
+typedef struct {
+  XSegment segs[XW_BATCH_LEN]; /* Buffered line segments */
+  int nseg;                    /* The number of segments in segs[] */
+  XPoint points[XW_BATCH_LEN]; /* Buffered single pixel dots */
+  int npoint;                  /* The number of points in points[] */
+  XArc arcs[XW_BATCH_LEN];     /* Buffered circular dots */
+  int narc;                    /* The number of arcs in arcs[] */
+} XWbatch;
+
 /*
  * Declare a container used to hold event state information.
  */
@@ -320,6 +338,7 @@ typedef struct XWdev {
   XWupdate update;   /* Descriptor of un-drawn area of pixmap */
   XWevent event;     /* Event state container */
   XWimage image;     /* Line of pixels container */
+  XWbatch batch;     /* Buffered lines and dots */
   XGCValues gcv;     /* Publicly visible contents of 'gc' */
   GC gc;             /* Graphical context descriptor */
   int last_opcode;   /* Index of last opcode */
@@ -400,6 +419,7 @@ static int xw_rem_events ARGS((XWdev *xw, long events));
 /* Functions used to flush buffered opcodes */
 
 static int xw_update_colors ARGS((XWdev *xw));
+static int xw_flush_batch ARGS((XWdev *xw));
 
 /*
  * Declare the head of the list of open XW device descriptors.
@@ -662,9 +682,21 @@ void XWDRIV(ifunc, rbuf, nbuf, chr, lchr, mode, len)
     if(xw_ok(xw) && xw->pixmap!=None) {
       XPoint start;
       XPoint end;
+      XSegment *seg;
       xw_xy_to_XPoint(xw, &rbuf[0], &start);
       xw_xy_to_XPoint(xw, &rbuf[2], &end);
-      XDrawLine(xw->display, xw->pixmap, xw->gc, start.x,start.y, end.x,end.y);
+/*
+ * Add the line to the buffer of segments, which is drawn when it fills
+ * or when the next different opcode arrives.
+ */
+      if(xw->batch.nseg >= XW_BATCH_LEN)
+	xw_flush_batch(xw);
+      seg = &xw->batch.segs[xw->batch.nseg++];
+      seg->x1 = start.x;
+      seg->y1 = start.y;
+      seg->x2 = end.x;
+      seg->y2 = end.y;
+      xw->flush_opcode_fn = (Flush_Opcode_fn) xw_flush_batch;
       xw_mark_modified(xw, start.x, start.y, xw->gcv.line_width);
       xw_mark_modified(xw, end.x, end.y, xw->gcv.line_width);
     };
@@ -677,15 +709,25 @@ void XWDRIV(ifunc, rbuf, nbuf, chr, lchr, mode, len)
       XPoint xp;
       int radius = xw->gcv.line_width/2;
       xw_xy_to_XPoint(xw, rbuf, &xp);
+/*
+ * Add the dot to the buffer of points or arcs. The line width can only
+ * change with a new opcode, so all of the buffered dots are the same size.
+ */
+      if(xw->batch.npoint >= XW_BATCH_LEN || xw->batch.narc >= XW_BATCH_LEN)
+	xw_flush_batch(xw);
       if(radius < 1) {
-	XDrawPoint(xw->display, xw->pixmap, xw->gc, xp.x, xp.y);
+	xw->batch.points[xw->batch.npoint++] = xp;
       } else {
+	XArc *arc = &xw->batch.arcs[xw->batch.narc++];
 	unsigned int diameter = radius*2;
-	int x = xp.x - radius;
-	int y = xp.y - radius;
-	XFillArc(xw->display, xw->pixmap, xw->gc, x, y, diameter, diameter,
-		 0, 23040);
+	arc->x = xp.x - radius;
+	arc->y = xp.y - radius;
+	arc->width = diameter;
+	arc->height = diameter;
+	arc->angle1 = 0;
+	arc->angle2 = 23040;
       };
+      xw->flush_opcode_fn = (Flush_Opcode_fn) xw_flush_batch;
       xw_mark_modified(xw, xp.x, xp.y, xw->gcv.line_width);
     };
     break;
@@ -991,6 +1033,45 @@ static int xw_set_rgb(xw, ci, red, green, blue)
   return 0;
 }
 
+/*.......................................................................
+ * Draw the lines and dots that have been buffered by the line and dot
+ * opcodes. This is registered as the flush function of those opcodes.
+ *
+ * Input:
+ *  xw      XWdev *  The PGPLOT /xw device descriptor.
+ * Output:
+ *  return    int    0 - OK.
+ *                   1 - Error.
+ */
+#ifdef __STDC__
+static int xw_flush_batch(XWdev *xw)
+#else
+static int xw_flush_batch(xw)
+     XWdev *xw;
+#endif
+{
+/*
+ * Device error? The buffered primitives are discarded.
+ */
+  if(xw->bad_device || xw->pixmap==None) {
+    xw->batch.nseg = xw->batch.npoint = xw->batch.narc = 0;
+    return 1;
+  };
+  if(xw->batch.nseg > 0)
+    XDrawSegments(xw->display, xw->pixmap, xw->gc, xw->batch.segs,
+		  xw->batch.nseg);
+  if(xw->batch.npoint > 0)
+    XDrawPoints(xw->display, xw->pixmap, xw->gc, xw->batch.points,
+		xw->batch.npoint, CoordModeOrigin);
+  if(xw->batch.narc > 0)
+    XFillArcs(xw->display, xw->pixmap, xw->gc, xw->batch.arcs,
+	      xw->batch.narc);
+  xw->batch.nseg = xw->batch.npoint = xw->batch.narc = 0;
+  if(xw->bad_device)
+    return 1;
+  return 0;
+}
+
 /*.......................................................................
  * Map floating point color intenisties between 0.0 and 1.0 to XColor
  * intensities between 0 to 65535. Numbers outside of this range are
@@ -1859,6 +1940,9 @@ static XWdev *new_XWdev(display, mode)
   xw->image.npix = 0;
   xw->image.buff = NULL;
   xw->image.xi = NULL;
+  xw->batch.nseg = 0;
+  xw->batch.npoint = 0;
+  xw->batch.narc = 0;
   xw->last_opcode = 0;
   xw->flush_opcode_fn = (Flush_Opcode_fn) 0;
 /*